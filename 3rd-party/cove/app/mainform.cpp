@@ -22,6 +22,7 @@
 #include "ui_mainform.h"
 
 // IWYU pragma: no_include <algorithm>
+#include <cstddef>
 #include <cstdlib>
 #include <ctime>
 #include <iosfwd>
@@ -51,6 +52,7 @@
 #include <QPushButton>
 #include <QSpinBox>
 #include <QTabWidget>
+#include <QTimer>
 #include <QUndoStack>
 
 #include "core/map.h"
@@ -66,6 +68,7 @@
 
 #include "libvectorizer/Concurrency.h"
 #include "libvectorizer/FIRFilter.h"
+#include "libvectorizer/GpuCompute.h"
 #include "libvectorizer/Polygons.h"
 #include "libvectorizer/Vectorizer.h"
 
@@ -103,6 +106,11 @@ class ProgressObserver;
   \sa Vectorizer
 */
 
+/*! \var GpuCompute* mainForm::gpuCompute
+  GPU backend for classification and morphology, or nullptr when the GPU
+  cannot be used.
+*/
+
 /*! \var QString mainForm::imageFileName
   Filename of the currently loaded image.
 */
@@ -149,6 +157,14 @@ class ProgressObserver;
 /*! \var QDoubleValidator mainForm::positiveDoubleValid
   Input validator for LineEdit.
 */
+/*! \var Concurrency::Job<QImage>* mainForm::classificationJob
+  The classification of the full-resolution image which runs in the
+  background, or nullptr.
+*/
+/*! \var int mainForm::PREVIEWSIZE
+  The maximum width and height of the image for the classification preview.
+*/
+const int mainForm::PREVIEWSIZE = 1024;
 
 //! Constructor initializing the menu, actions and connecting signals from
 //! actions
@@ -162,6 +178,9 @@ mainForm::mainForm(QWidget* parent, OpenOrienteering::Map* map,
 	ui.setupUi(this);
 
 	vectorizerApp = nullptr;
+	gpuCompute = std::make_unique<GpuCompute>();
+	if (!gpuCompute->isAvailable())
+		gpuCompute.reset();
 
 	setTabEnabled(ui.imageTab, true);
 	setTabEnabled(ui.thinningTab, false);
@@ -170,6 +189,9 @@ mainForm::mainForm(QWidget* parent, OpenOrienteering::Map* map,
 	ui.howManyColorsSpinBox->setValue(settings.getInt("nColors"));
 
 	bwBitmapUndo = new QUndoStack(this);
+	classificationTimer = new QTimer(this);
+	classificationTimer->setInterval(100);
+	connect(classificationTimer, &QTimer::timeout, this, &mainForm::classificationTimeout);
 	connect(bwBitmapUndo, SIGNAL(canUndoChanged(bool)), ui.bwImageHistoryBack, SLOT(setEnabled(bool)));
 	connect(bwBitmapUndo, SIGNAL(canRedoChanged(bool)), ui.bwImageHistoryForward, SLOT(setEnabled(bool)));
 
@@ -181,6 +203,7 @@ mainForm::mainForm(QWidget* parent, OpenOrienteering::Map* map,
 
 mainForm::~mainForm()
 {
+	cancelClassification();
 	clearColorButtonsGroup();
 }
 
@@ -197,6 +220,7 @@ void mainForm::clearBWImageTab()
 //! Clears the Colors tab, i.e. removes displayed image and color buttons
 void mainForm::clearColorsTab()
 {
+	cancelClassification();
 	if (!imageBitmap.isNull())
 	{
 		ui.classifiedColorsView->setImage(&imageBitmap);
@@ -286,10 +310,11 @@ QRgb mainForm::getColorFromImage(const QImage& image)
 void mainForm::on_runClassificationButton_clicked()
 {
 	ui.runClassificationButton->setEnabled(false);
+	cancelClassification();
 	vectorizerApp = std::make_unique<Vectorizer>(imageBitmap);
+	vectorizerApp->setGpuCompute(gpuCompute.get());
 	UIProgressDialog progressDialog(tr("Colors classification in progress"),
 	                                tr("Cancel"), this);
-	auto totalProgress = Concurrency::TransformedProgress{progressDialog, 0.5};
 	switch (settings.getInt("learnMethod"))
 	{
 	case 0:
@@ -299,16 +324,7 @@ void mainForm::on_runClassificationButton_clicked()
 		vectorizerApp->setClassificationMethod(Vectorizer::KOHONEN_BATCH);
 		break;
 	}
-	vectorizerApp->setP(settings.getDouble("p"));
-	switch (settings.getInt("colorSpace"))
-	{
-	case 0:
-		vectorizerApp->setColorSpace(Vectorizer::COLSPC_RGB);
-		break;
-	case 1:
-		vectorizerApp->setColorSpace(Vectorizer::COLSPC_HSV);
-		break;
-	}
+	applyColorSpaceSettings(*vectorizerApp);
 	switch (settings.getInt("alphaStrategy"))
 	{
 	case 0:
@@ -351,7 +367,7 @@ void mainForm::on_runClassificationButton_clicked()
 	auto classification = [](Vectorizer* v, ProgressObserver& o) -> bool {
 		return v->performClassification(&o);
 	};
-	Concurrency::process<bool>(&totalProgress, classification, vectorizerApp.get());
+	Concurrency::process<bool>(&progressDialog, classification, vectorizerApp.get());
 
 	auto colorsFound = vectorizerApp->getClassifiedColors();
 	setColorButtonsGroup(colorsFound);
@@ -359,20 +375,8 @@ void mainForm::on_runClassificationButton_clicked()
 	// in case there are some colors (learning was not aborted)
 	if (colorsFound.size())
 	{
-		double quality;
-		totalProgress.offset = 50.0;
-		QImage newClassifiedBitmap =
-			vectorizerApp->getClassifiedImage(&quality, &totalProgress);
-		if (!newClassifiedBitmap.isNull())
-		{
-			classifiedBitmap = newClassifiedBitmap;
-			ui.classifiedColorsView->setImage(&classifiedBitmap);
-			ui.learnQualityLabel->setText(QString("LQ: %1").arg(quality));
-		}
-		else
-		{
-			clearColorButtonsGroup();
-		}
+		showClassificationPreview();
+		startClassification();
 	}
 	else
 	{
@@ -381,6 +385,121 @@ void mainForm::on_runClassificationButton_clicked()
 	ui.runClassificationButton->setEnabled(true);
 }
 
+//! Applies the color space and metrics settings to the given vectorizer.
+void mainForm::applyColorSpaceSettings(Vectorizer& vectorizer)
+{
+	vectorizer.setP(settings.getDouble("p"));
+	switch (settings.getInt("colorSpace"))
+	{
+	case 0:
+		vectorizer.setColorSpace(Vectorizer::COLSPC_RGB);
+		break;
+	case 1:
+		vectorizer.setColorSpace(Vectorizer::COLSPC_HSV);
+		break;
+	}
+}
+
+/*! Shows the classification of a reduced copy of the image, for quick
+ * feedback while the full-resolution image is classified in the background.
+ * Small images are not previewed. */
+void mainForm::showClassificationPreview()
+{
+	auto const size = imageBitmap.size();
+	if (std::max(size.width(), size.height()) <= 2 * PREVIEWSIZE)
+		return;
+
+	auto previewBitmap = imageBitmap.scaled(PREVIEWSIZE, PREVIEWSIZE, Qt::KeepAspectRatio, Qt::FastTransformation);
+	auto const colors = vectorizerApp->getClassifiedColors();
+	Vectorizer preview(previewBitmap);
+	preview.setGpuCompute(gpuCompute.get());
+	applyColorSpaceSettings(preview);
+	preview.setNumberOfColors(int(colors.size()));
+	preview.setInitColors(colors);
+	auto const previewClassified = preview.getClassifiedImage();
+	if (previewClassified.isNull())
+		return;
+
+	// Scaling without smoothing keeps the color table.
+	showClassifiedImage(previewClassified.scaled(size, Qt::IgnoreAspectRatio, Qt::FastTransformation));
+}
+
+//! Shows the classified image, with the selected colors highlighted.
+void mainForm::showClassifiedImage(const QImage& image)
+{
+	classifiedBitmap = image;
+	colorButtonToggled(true);
+}
+
+/*! Starts the classification of the full-resolution image in the background.
+  \sa finishClassification() */
+void mainForm::startClassification()
+{
+	auto classification = [](Vectorizer* v, ProgressObserver& o) -> QImage {
+		return v->getClassifiedImage(nullptr, &o);
+	};
+	classificationJob = std::make_unique<Concurrency::Job<QImage>>(
+	                        Concurrency::run<QImage>(classification, vectorizerApp.get()));
+	ui.learnQualityLabel->setText(QString("LQ: ..."));
+	classificationTimer->start();
+}
+
+//! Shows the progress of the background classification, and its result.
+void mainForm::classificationTimeout()
+{
+	if (classificationJob && !classificationJob->future.isFinished())
+	{
+		ui.learnQualityLabel->setText(QString("LQ: %1%").arg(classificationJob->progress.getPercentage()));
+		return;
+	}
+	finishClassification();
+}
+
+/*! Waits for the background classification to finish, and shows its result.
+ * Returns false if there is no classified image, e.g. after cancellation. */
+bool mainForm::finishClassification()
+{
+	classificationTimer->stop();
+	if (!classificationJob)
+		return !classifiedBitmap.isNull();
+
+	if (!classificationJob->future.isFinished())
+	{
+		UIProgressDialog progressDialog(tr("Colors classification in progress"),
+		                                tr("Cancel"), this);
+		Concurrency::waitForFinished(&progressDialog, *classificationJob);
+	}
+	auto const newClassifiedBitmap = classificationJob->future.result();
+	classificationJob.reset();
+
+	if (newClassifiedBitmap.isNull())
+	{
+		clearColorButtonsGroup();
+		classifiedBitmap = {};
+		ui.classifiedColorsView->setImage(&imageBitmap);
+		ui.learnQualityLabel->setText(QString("LQ: -"));
+		return false;
+	}
+
+	double quality;
+	vectorizerApp->getClassifiedImage(&quality);  // cached
+	showClassifiedImage(newClassifiedBitmap);
+	ui.learnQualityLabel->setText(QString("LQ: %1").arg(quality));
+	return true;
+}
+
+//! Cancels the background classification, if any.
+void mainForm::cancelClassification()
+{
+	if (!classificationJob)
+		return;
+
+	classificationTimer->stop();
+	classificationJob->progress.requestInterruption();
+	classificationJob->future.waitForFinished();
+	classificationJob.reset();
+}
+
 /*! Removes all color buttons from the frame on Colors tab.
   \sa setColorButtonsGroup(QRgb* colors, int nColors) */
 void mainForm::clearColorButtonsGroup()
@@ -491,6 +610,13 @@ void mainForm::on_mainTabWidget_currentChanged(int tabindex)
 		return;
 	}
 	
+	if (!finishClassification())
+	{
+		clearBWImageTab();
+		setTabEnabled(ui.thinningTab, false);
+		return;
+	}
+	
 	auto selectedColors = getSelectedColors();
 	UIProgressDialog progressDialog(tr("Creating B/W image"), tr("Cancel"), this);
 	QImage newBWBitmap =
@@ -545,7 +671,7 @@ bool mainForm::performMorphologicalOperation(
 	}
 	UIProgressDialog progressDialog(text, tr("Cancel"), this);
 	QImage transBitmap =
-		Vectorizer::getTransformedImage(bwBitmap, mo, &progressDialog);
+		Vectorizer::getTransformedImage(bwBitmap, mo, &progressDialog, gpuCompute.get());
 
 	if (transBitmap.isNull())
 		return false;
@@ -758,15 +884,18 @@ void mainForm::on_saveVectorsButton_clicked()
 		if (polygon.isClosed())
 			newOOPolygon->closeAllParts();
 		newOOPolygon->setTag(QStringLiteral("generator"), QStringLiteral("cove")); /// \todo Configuration of tag
-		ooMap->addObject(newOOPolygon);
-		ooMap->addObjectToSelection(newOOPolygon, false);
 		result.push_back(newOOPolygon);
 	}
 
-	auto const* part = ooMap->getCurrentPart();
+	// Adding all objects at once lets the map create the renderables
+	// concurrently, and the indices of the new objects are consecutive.
+	auto const first_index = ooMap->addObjects(result);
 	auto* undo_step = new OpenOrienteering::DeleteObjectsUndoStep(ooMap);
-	for (auto const* object : result)
-		undo_step->addObject(part->findObjectIndex(object));
+	for (std::size_t i = 0; i < result.size(); ++i)
+	{
+		ooMap->addObjectToSelection(result[i], false);
+		undo_step->addObject(first_index + int(i));
+	}
 	ooMap->push(undo_step);
 
 	ooMap->setObjectsDirty();
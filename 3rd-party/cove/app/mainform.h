@@ -37,6 +37,7 @@
 #include "ui_mainform.h"
 
 class QPushButton;
+class QTimer;
 class QWidget;
 class QUndoStack;
 
@@ -48,6 +49,12 @@ class TemplateImage;
 
 namespace cove {
 
+class GpuCompute;
+
+namespace Concurrency {
+template <typename ResultType> struct Job;
+}  // namespace Concurrency
+
 class mainForm : public QDialog
 {
 	Q_OBJECT
@@ -68,6 +75,7 @@ public:
 
 protected:
 	std::unique_ptr<Vectorizer> vectorizerApp;
+	std::unique_ptr<GpuCompute> gpuCompute;
 	OpenOrienteering::Map* ooMap;
 	OpenOrienteering::Template* ooTempl;
 	QString imageFileName;
@@ -76,9 +84,19 @@ protected:
 	QImage bwBitmap;
 	bool bwBitmapVectorizable {};
 	QUndoStack* bwBitmapUndo {};
+	std::unique_ptr<Concurrency::Job<QImage>> classificationJob;
+	QTimer* classificationTimer {};
 	std::vector<QPushButton*> colorButtons;
 	Settings settings;
 	static const int MESSAGESHOWDELAY;
+	static const int PREVIEWSIZE;
+
+	void applyColorSpaceSettings(Vectorizer& vectorizer);
+	void showClassificationPreview();
+	void showClassifiedImage(const QImage& image);
+	void startClassification();
+	bool finishClassification();
+	void cancelClassification();
 
 	bool performMorphologicalOperation(Vectorizer::MorphologicalOperation mo);
 	void clearColorsTab();
@@ -100,6 +118,7 @@ public slots:
 	void aboutDialog();
 	void setInitialColors(bool on);
 	void colorButtonToggled(bool on);
+	void classificationTimeout();
 
 	void on_bwImageSaveButton_clicked();        // clazy:exclude=connect-by-name
 	void on_classificationOptionsButton_clicked();  // clazy:exclude=connect-by-name
@@ -19,14 +19,137 @@
 
 #include "FIRFilter.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
 #include <memory>
+#include <vector>
 
+#include <QtConcurrent>
+#include <QtGlobal>
+#include <QAtomicInt>
 #include <QImage>
+#include <QRgb>
+#include <QThread>
+#include <QThreadPool>
 
 #include "MapColor.h"
 #include "ProgressObserver.h"
 
 namespace cove {
+
+namespace {
+
+/*! The number of rows processed by a single concurrent job of the
+ * separable filter. */
+constexpr int stripe_height = 32;
+
+/*! Convolves a single channel row with a symmetric kernel.
+ *  The input row has kernel.size() / 2 extra elements at both ends. */
+void convolve(const double* input, double* output, int width, const std::vector<double>& kernel)
+{
+	auto const dimension = int(kernel.size());
+	auto const center = dimension / 2;
+	auto const k = kernel[std::size_t(center)];
+	for (int x = 0; x < width; ++x)
+		output[x] = k * input[x + center];
+	for (int i = 0; i < center; ++i)
+	{
+		auto const weight = kernel[std::size_t(i)];
+		auto const* left = input + i;
+		auto const* right = input + dimension - 1 - i;
+		for (int x = 0; x < width; ++x)
+			output[x] += weight * (left[x] + right[x]);
+	}
+}
+
+/*! Applies a separable filter with a symmetric kernel to the rows
+ *  [first, last) of the target image.
+ *
+ *  The channels are processed as separate planes of doubles, in simple loops
+ *  over contiguous arrays which the compiler can vectorize. The horizontal
+ *  pass covers the rows of the stripe and the rows above and below it which
+ *  are needed by the vertical pass. */
+void applySeparableStripe(const QImage& source, QImage& target, int first, int last,
+                          const std::vector<double>& kernel, QRgb outOfBoundsColor,
+                          const QAtomicInt& cancel)
+{
+	auto const width = source.width();
+	auto const height = source.height();
+	auto const dimension = int(kernel.size());
+	auto const border = dimension / 2;
+	auto const rows = last - first + 2 * border;
+	auto const plane = std::size_t(width);
+	double const outOfBounds[3] = { double(qRed(outOfBoundsColor)),
+	                                double(qGreen(outOfBoundsColor)),
+	                                double(qBlue(outOfBoundsColor)) };
+
+	// Horizontal pass
+	std::vector<double> line(std::size_t(width + 2 * border) * 3);
+	std::vector<double> horizontal(std::size_t(rows) * 3 * plane);
+	for (int r = 0; r < rows; ++r)
+	{
+		auto* output = horizontal.data() + std::size_t(r) * 3 * plane;
+		auto const y = first - border + r;
+		if (y < 0 || y >= height)
+		{
+			for (int c = 0; c < 3; ++c)
+				std::fill(output + c * plane, output + (c + 1) * plane, outOfBounds[c]);
+			continue;
+		}
+
+		auto* red = line.data();
+		auto* green = red + width + 2 * border;
+		auto* blue = green + width + 2 * border;
+		for (int b = 0; b < border; ++b)
+		{
+			red[b] = red[width + border + b] = outOfBounds[0];
+			green[b] = green[width + border + b] = outOfBounds[1];
+			blue[b] = blue[width + border + b] = outOfBounds[2];
+		}
+		auto const* pixels = reinterpret_cast<const QRgb*>(source.constScanLine(y));
+		for (int x = 0; x < width; ++x)
+		{
+			red[x + border] = qRed(pixels[x]);
+			green[x + border] = qGreen(pixels[x]);
+			blue[x + border] = qBlue(pixels[x]);
+		}
+		convolve(red, output, width, kernel);
+		convolve(green, output + plane, width, kernel);
+		convolve(blue, output + 2 * plane, width, kernel);
+	}
+
+	// Vertical pass
+	std::vector<double> sum(3 * plane);
+	auto const k = kernel[std::size_t(border)];
+	for (int y = first; y < last && !cancel.loadAcquire(); ++y)
+	{
+		auto const* window = horizontal.data() + std::size_t(y - first) * 3 * plane;
+		auto const* center = window + std::size_t(border) * 3 * plane;
+		for (std::size_t x = 0; x < 3 * plane; ++x)
+			sum[x] = k * center[x];
+		for (int i = 0; i < border; ++i)
+		{
+			auto const weight = kernel[std::size_t(i)];
+			auto const* top = window + std::size_t(i) * 3 * plane;
+			auto const* bottom = window + std::size_t(dimension - 1 - i) * 3 * plane;
+			for (std::size_t x = 0; x < 3 * plane; ++x)
+				sum[x] += weight * (top[x] + bottom[x]);
+		}
+
+		auto* output = reinterpret_cast<QRgb*>(target.scanLine(y));
+		for (std::size_t x = 0; x < plane; ++x)
+		{
+			output[x] = qRgb(qBound(0, qRound(sum[x]), 255),
+			                 qBound(0, qRound(sum[x + plane]), 255),
+			                 qBound(0, qRound(sum[x + 2 * plane]), 255));
+		}
+	}
+}
+
+}  // namespace
+
+
 //@{
 //! \ingroup libvectorizer
 
@@ -42,6 +165,11 @@ namespace cove {
 /*! \var double** FIRFilter::matrix
   FIR filter matrix. */
 
+/*! \var std::vector<double> FIRFilter::kernel
+  The symmetric one-dimensional kernel of a separable filter, i.e. the matrix
+  is the outer product of the kernel with itself. Empty if the filter is not
+  known to be separable. */
+
 /*! Constructor, allocates \a matrix.
   \param[in] radius Filter radius. 1 => matrix size 1x1, 2 => 3x3, 3 => 5x5, ...
   */
@@ -86,6 +214,12 @@ FIRFilter& FIRFilter::binomic()
 			divisor += matrix[i][j];
 		}
 
+	// the kernel is the normalized first row
+	kernel = matrix[0];
+	auto const kernelDivisor = std::sqrt(divisor);
+	for (auto& k : kernel)
+		k /= kernelDivisor;
+
 	// normalize matrix so that sum of all its elements gives 1
 	for (unsigned i = 0; i < dimension; i++)
 		for (unsigned j = 0; j < dimension; j++)
@@ -104,6 +238,8 @@ FIRFilter& FIRFilter::box()
 		for (unsigned j = 0; j < dimension; j++)
 			matrix[i][j] = q;
 
+	kernel.assign(dimension, 1.0 / dimension);
+
 	return *this;
 }
 
@@ -114,12 +250,17 @@ FIRFilter& FIRFilter::a(double /*center*/)
 }
 
 /*! Applies this FIR filter onto image and returns transformed image.
+  Separable filters are applied as a horizontal and a vertical pass,
+  concurrently in stripes of rows.
   \param[in] source Source image.
   \param[in] outOfBoundsColor Color that has the out-of-bounds area.
   \param[in] progressObserver Progress observer.  */
 QImage FIRFilter::apply(const QImage& source, QRgb outOfBoundsColor,
 						ProgressObserver* progressObserver)
 {
+	if (!kernel.empty() && kernel.size() == matrix.size())
+		return applySeparable(source, outOfBoundsColor, progressObserver);
+
 	int imwidth = source.width(), imheight = source.height();
 	bool cancel = false;
 	int progressHowOften = (imheight > 100) ? imheight / 75 : 1;
@@ -154,6 +295,48 @@ QImage FIRFilter::apply(const QImage& source, QRgb outOfBoundsColor,
 	}
 	return cancel ? QImage() : retimage;
 }
+
+/*! Applies this FIR filter as a separable filter, using \a kernel. */
+QImage FIRFilter::applySeparable(const QImage& source, QRgb outOfBoundsColor,
+                                 ProgressObserver* progressObserver) const
+{
+	auto const input = (source.format() == QImage::Format_RGB32 || source.format() == QImage::Format_ARGB32)
+	                   ? source : source.convertToFormat(QImage::Format_RGB32);
+	QImage retimage(input.width(), input.height(), QImage::Format_RGB32);
+	if (retimage.isNull())
+		return retimage;
+
+	std::vector<int> stripes;
+	for (int first = 0; first < input.height(); first += stripe_height)
+		stripes.push_back(first);
+
+	QAtomicInt cancel = 0;
+	QAtomicInt done = 0;
+	auto const height = input.height();
+	auto future = QtConcurrent::map(stripes, [&](int first) {
+		if (cancel.loadAcquire())
+			return;
+		applySeparableStripe(input, retimage, first, std::min(first + stripe_height, height),
+		                     kernel, outOfBoundsColor, cancel);
+		done.fetchAndAddRelaxed(1);
+	});
+
+	// The progress observer is served from this thread only.
+	QThreadPool::globalInstance()->releaseThread();
+	while (!future.isFinished())
+	{
+		if (progressObserver)
+		{
+			progressObserver->setPercentage(done.loadAcquire() * 100 / int(stripes.size()));
+			if (progressObserver->isInterruptionRequested())
+				cancel.storeRelease(1);
+		}
+		QThread::msleep(20);
+	}
+	QThreadPool::globalInstance()->reserveThread();
+
+	return cancel.loadAcquire() ? QImage() : retimage;
+}
 } // cove
 
 //@}
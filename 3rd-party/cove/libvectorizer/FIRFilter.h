@@ -32,6 +32,7 @@ class FIRFilter
 {
 protected:
 	std::vector<std::vector<double>> matrix;
+	std::vector<double> kernel;
 
 public:
 	FIRFilter(unsigned radius = 0);
@@ -41,6 +42,10 @@ public:
 	QImage apply(const QImage& source,
 	             QRgb outOfBoundsColor = qRgb(128, 128, 128),
 	             ProgressObserver* progressObserver = nullptr);
+
+protected:
+	QImage applySeparable(const QImage& source, QRgb outOfBoundsColor,
+	                      ProgressObserver* progressObserver) const;
 };
 } // cove
 
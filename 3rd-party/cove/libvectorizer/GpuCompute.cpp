@@ -0,0 +1,526 @@
+/*
+ * Copyright 2026 The OpenOrienteering developers
+ *
+ * This file is part of CoVe.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "GpuCompute.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <utility>
+
+#include <QtGlobal>
+#include <QByteArray>
+#include <QCoreApplication>
+#include <QGuiApplication>
+#include <QImage>
+#include <QOffscreenSurface>
+#include <QRgb>
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 6, 0) && !defined(QT_NO_OPENGL)
+#  define COVE_GPU_COMPUTE
+#  include <QOpenGLContext>
+#  include <QOpenGLExtraFunctions>
+#  include <QOpenGLShader>
+#  include <QOpenGLShaderProgram>
+#  include <QSurfaceFormat>
+#endif
+
+#include "MapColor.h"
+#include "ProgressObserver.h"
+
+namespace cove {
+
+#ifdef COVE_GPU_COMPUTE
+
+namespace {
+
+/// The local work group size of the shaders, in x direction.
+constexpr int local_size = 64;
+
+/// The maximum number of rows per dispatch.
+constexpr int max_dispatch_rows = 65535;
+
+/// The maximum size of a buffer which is used for image data.
+constexpr qint64 max_buffer_size = qint64(1) << 26;
+
+
+/*! The classification shader.
+ *
+ * Each invocation classifies four pixels of a row, and writes their color
+ * indices to a single word of the Format_Indexed8 output.  The squared
+ * distances of the pixels to their colors are summed up for each work group.
+ */
+const char* const classification_shader = R"GLSL(
+layout(std430, binding = 0) readonly buffer Pixels { uint pixels[]; };
+layout(std430, binding = 1) writeonly buffer Indices { uint indices[]; };
+layout(std430, binding = 2) readonly buffer Colors { vec4 colors[]; };
+layout(std430, binding = 3) writeonly buffer Partials { float partials[]; };
+
+uniform int width;
+uniform int height;
+uniform int stride;
+uniform int num_colors;
+
+shared float sums[gl_WorkGroupSize.x];
+
+void main()
+{
+	int w = int(gl_GlobalInvocationID.x);
+	int y = int(gl_GlobalInvocationID.y);
+	float sum = 0.0;
+	if (w < stride && y < height)
+	{
+		uint word = 0u;
+		for (int k = 0; k < 4; ++k)
+		{
+			int x = 4 * w + k;
+			if (x >= width)
+				break;
+			uint p = pixels[y * width + x];
+			vec3 c = vec3(float((p >> 16) & 255u), float((p >> 8) & 255u), float(p & 255u));
+			int best = 0;
+			float best_distance = 0.0;
+			for (int i = 0; i < num_colors; ++i)
+			{
+				vec3 d = colors[i].rgb - c;
+				float distance = dot(d, d);
+				if (i == 0 || distance < best_distance)
+				{
+					best = i;
+					best_distance = distance;
+				}
+			}
+			word |= uint(best) << uint(8 * k);
+			sum += best_distance;
+		}
+		indices[y * stride + w] = word;
+	}
+	
+	uint l = gl_LocalInvocationID.x;
+	sums[l] = sum;
+	memoryBarrierShared();
+	barrier();
+	for (uint s = gl_WorkGroupSize.x / 2u; s > 0u; s >>= 1)
+	{
+		if (l < s)
+			sums[l] += sums[l + s];
+		memoryBarrierShared();
+		barrier();
+	}
+	if (l == 0u)
+		partials[gl_WorkGroupID.y * gl_NumWorkGroups.x + gl_WorkGroupID.x] = sums[0];
+}
+)GLSL";
+
+
+/*! The morphology shader.
+ *
+ * Each invocation evaluates the neighborhood table for the 32 pixels of a
+ * word of the Format_Mono image, with the bit order of a little-endian
+ * host.  The neighborhood bits are the same as for the tables of Morphology.
+ */
+const char* const morphology_shader = R"GLSL(
+layout(std430, binding = 0) readonly buffer Source { uint source[]; };
+layout(std430, binding = 1) writeonly buffer Target { uint target[]; };
+layout(std430, binding = 2) buffer Counter { uint count; };
+
+uniform uint table[16];
+uniform int width;
+uniform int height;
+uniform int stride;
+uniform int first_row;
+uniform int insert;
+
+uint bitOffset(int i)
+{
+	return uint(8 * (i >> 3) + 7 - (i & 7));
+}
+
+uint pixel(int x, int y)
+{
+	if (x < 0 || y < 0 || x >= width || y >= height)
+		return 0u;
+	return (source[y * stride + (x >> 5)] >> bitOffset(x & 31)) & 1u;
+}
+
+void main()
+{
+	int w = int(gl_GlobalInvocationID.x);
+	int y = first_row + int(gl_GlobalInvocationID.y);
+	if (w >= stride || y >= height)
+		return;
+	
+	uint word = source[y * stride + w];
+	uint changes = 0u;
+	for (int i = 0; i < 32; ++i)
+	{
+		int x = 32 * w + i;
+		if (x >= width)
+			break;
+		uint p = 0u;
+		for (int dy = -1; dy <= 1; ++dy)
+		{
+			for (int dx = -1; dx <= 1; ++dx)
+				p = (p << 1) | pixel(x + dx, y + dy);
+		}
+		if (((table[p >> 5] >> (p & 31u)) & 1u) != 0u)
+		{
+			uint bit = 1u << bitOffset(i);
+			word = insert != 0 ? (word | bit) : (word & ~bit);
+			++changes;
+		}
+	}
+	target[y * stride + w] = word;
+	if (changes != 0u)
+		atomicAdd(count, changes);
+}
+)GLSL";
+
+
+/*! Returns the surface format which is needed for compute shaders. */
+QSurfaceFormat computeFormat()
+{
+	auto format = QSurfaceFormat::defaultFormat();
+	if (QOpenGLContext::openGLModuleType() == QOpenGLContext::LibGLES)
+	{
+		format.setVersion(3, 1);
+	}
+	else
+	{
+		format.setVersion(4, 3);
+		format.setProfile(QSurfaceFormat::CoreProfile);
+	}
+	return format;
+}
+
+
+/*! An OpenGL context which is current for the lifetime of this object.
+ *
+ * The buffers created by this object are deleted when it is destroyed.
+ */
+class ComputeContext
+{
+public:
+	explicit ComputeContext(QOffscreenSurface& surface)
+	{
+		context.setFormat(surface.format());
+		if (!context.create() || !context.makeCurrent(&surface))
+			return;
+		
+		auto const required = context.isOpenGLES() ? qMakePair(3, 1) : qMakePair(4, 3);
+		if (context.format().version() < required)
+		{
+			context.doneCurrent();
+			return;
+		}
+		
+		f = context.extraFunctions();
+		GLint64 size = 0;
+		f->glGetInteger64v(GL_MAX_SHADER_STORAGE_BLOCK_SIZE, &size);
+		max_storage_size = std::min(qint64(size), max_buffer_size);
+	}
+	
+	ComputeContext(const ComputeContext&) = delete;
+	ComputeContext& operator=(const ComputeContext&) = delete;
+	
+	~ComputeContext()
+	{
+		if (f)
+		{
+			if (!buffers.empty())
+				f->glDeleteBuffers(GLsizei(buffers.size()), buffers.data());
+			context.doneCurrent();
+		}
+	}
+	
+	bool isValid() const { return f != nullptr; }
+	
+	QOpenGLExtraFunctions& functions() const { return *f; }
+	
+	/// The maximum size of a storage buffer for image data.
+	qint64 maxStorageSize() const { return max_storage_size; }
+	
+	/// Compiles and links a compute shader program.
+	bool build(QOpenGLShaderProgram& program, const char* body) const
+	{
+		auto source = QByteArray(context.isOpenGLES() ? "#version 310 es\nprecision highp float;\n" : "#version 430\n");
+		source += "layout(local_size_x = " + QByteArray::number(local_size) + ") in;\n";
+		source += body;
+		return program.addShaderFromSourceCode(QOpenGLShader::Compute, source)
+		       && program.link();
+	}
+	
+	/// Creates a storage buffer and binds it to the given binding point.
+	GLuint buffer(GLuint binding, qint64 size, const void* data = nullptr)
+	{
+		GLuint id = 0;
+		f->glGenBuffers(1, &id);
+		buffers.push_back(id);
+		f->glBindBuffer(GL_SHADER_STORAGE_BUFFER, id);
+		f->glBufferData(GL_SHADER_STORAGE_BUFFER, GLsizeiptr(size), data, GL_DYNAMIC_COPY);
+		f->glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, id);
+		return id;
+	}
+	
+	/// Copies the beginning of a buffer to memory, after a dispatch.
+	bool read(GLuint id, qint64 size, void* data) const
+	{
+		f->glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+		f->glBindBuffer(GL_SHADER_STORAGE_BUFFER, id);
+		auto const* mapped = f->glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, GLsizeiptr(size), GL_MAP_READ_BIT);
+		if (!mapped)
+			return false;
+		std::memcpy(data, mapped, std::size_t(size));
+		return f->glUnmapBuffer(GL_SHADER_STORAGE_BUFFER) == GL_TRUE;
+	}
+	
+	/// Returns true if no OpenGL error was recorded.
+	bool noError() const
+	{
+		auto ok = true;
+		while (f->glGetError() != GL_NO_ERROR)
+			ok = false;
+		return ok;
+	}
+	
+private:
+	QOpenGLContext context;
+	QOpenGLExtraFunctions* f = nullptr;
+	std::vector<GLuint> buffers;
+	qint64 max_storage_size = 0;
+};
+
+
+}  // namespace
+
+#endif  // COVE_GPU_COMPUTE
+
+
+//@{
+//!\ingroup libvectorizer
+
+/*! \class GpuCompute
+  \brief Optional GPU implementation of classification and morphology.
+  */
+
+GpuCompute::GpuCompute()
+{
+#ifdef COVE_GPU_COMPUTE
+	// QOffscreenSurface needs a QGuiApplication, and the GUI thread.
+	if (!qobject_cast<QGuiApplication*>(QCoreApplication::instance()))
+		return;
+	
+	surface = std::make_unique<QOffscreenSurface>();
+	surface->setFormat(computeFormat());
+	surface->create();
+	if (surface->isValid())
+		available = ComputeContext(*surface).isValid();
+#endif
+}
+
+GpuCompute::~GpuCompute() = default;
+
+/*! Classifies the source image into target.
+  The image is processed in bands of rows which fit into a storage buffer. */
+bool GpuCompute::classify(const QImage& source, const std::vector<std::shared_ptr<MapColor>>& colors,
+                          QImage& target, double& quality) const
+{
+#ifdef COVE_GPU_COMPUTE
+	if (!available
+	    || colors.empty() || colors.size() > 256
+	    || target.format() != QImage::Format_Indexed8
+	    || target.size() != source.size())
+		return false;
+	
+	ComputeContext context(*surface);
+	if (!context.isValid())
+		return false;
+	
+	auto const width = source.width();
+	auto const height = source.height();
+	auto const row_size = qint64(4) * width;
+	auto const stride = target.bytesPerLine() / 4;
+	auto const band_height = int(std::min(qint64(std::min(height, max_dispatch_rows)),
+	                                      context.maxStorageSize() / std::max(row_size, qint64(1))));
+	if (band_height < 1)
+		return false;
+	
+	QOpenGLShaderProgram program;
+	if (!context.build(program, classification_shader) || !program.bind())
+		return false;
+	
+	std::vector<float> color_data(4 * colors.size());
+	for (std::size_t i = 0; i < colors.size(); i++)
+	{
+		double r, g, b;
+		colors[i]->getCoordinates(r, g, b);
+		color_data[4 * i] = float(r);
+		color_data[4 * i + 1] = float(g);
+		color_data[4 * i + 2] = float(b);
+	}
+	
+	auto const groups_x = (stride + local_size - 1) / local_size;
+	auto const num_partials = qint64(groups_x) * band_height;
+	auto const pixels = context.buffer(0, row_size * band_height);
+	auto const indices = context.buffer(1, qint64(target.bytesPerLine()) * band_height);
+	context.buffer(2, qint64(sizeof(float)) * qint64(color_data.size()), color_data.data());
+	auto const partials = context.buffer(3, qint64(sizeof(float)) * num_partials);
+	std::vector<float> partial_sums(std::size_t(num_partials));
+	
+	program.setUniformValue("width", width);
+	program.setUniformValue("stride", stride);
+	program.setUniformValue("num_colors", int(colors.size()));
+	
+	auto& f = context.functions();
+	double sum = 0;
+	for (int first = 0; first < height; first += band_height)
+	{
+		auto const rows = std::min(band_height, height - first);
+		auto const band = source.copy(0, first, width, rows).convertToFormat(QImage::Format_RGB32);
+		f.glBindBuffer(GL_SHADER_STORAGE_BUFFER, pixels);
+		f.glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, GLsizeiptr(row_size * rows), band.constBits());
+		
+		program.setUniformValue("height", rows);
+		f.glDispatchCompute(GLuint(groups_x), GLuint(rows), 1);
+		
+		auto const count = qint64(groups_x) * rows;
+		if (!context.read(indices, qint64(target.bytesPerLine()) * rows, target.scanLine(first))
+		    || !context.read(partials, qint64(sizeof(float)) * count, partial_sums.data()))
+			return false;
+		sum = std::accumulate(partial_sums.begin(), partial_sums.begin() + count, sum);
+	}
+	
+	if (!context.noError())
+		return false;
+	
+	quality = sum;
+	return true;
+#else
+	Q_UNUSED(source)
+	Q_UNUSED(colors)
+	Q_UNUSED(target)
+	Q_UNUSED(quality)
+	return false;
+#endif
+}
+
+/*! Applies neighborhood tables to image.
+  The whole image must fit into a storage buffer, because each table
+  depends on the neighbor rows.  The image is transferred only once, and the
+  tables are applied alternating between two buffers. */
+int GpuCompute::applyTables(QImage& image, const std::vector<const bool*>& tables, bool insert,
+                            bool repeat, ProgressObserver* progressObserver) const
+{
+#ifdef COVE_GPU_COMPUTE
+	if (!available || tables.empty() || image.format() != QImage::Format_Mono
+	    || Q_BYTE_ORDER != Q_LITTLE_ENDIAN)
+		return -1;
+	
+	ComputeContext context(*surface);
+	if (!context.isValid())
+		return -1;
+	
+	auto const width = image.width();
+	auto const height = image.height();
+	auto const size = qint64(image.bytesPerLine()) * height;
+	if (size == 0 || size > context.maxStorageSize())
+		return -1;
+	
+	QOpenGLShaderProgram program;
+	if (!context.build(program, morphology_shader) || !program.bind())
+		return -1;
+	
+	std::vector<std::vector<GLuint>> packed_tables(tables.size(), std::vector<GLuint>(16));
+	for (std::size_t i = 0; i < tables.size(); i++)
+	{
+		for (unsigned int p = 0; p < 512; p++)
+		{
+			if (tables[i][p])
+				packed_tables[i][p / 32] |= GLuint(1) << (p % 32);
+		}
+	}
+	
+	auto const stride = image.bytesPerLine() / 4;
+	auto const groups_x = (stride + local_size - 1) / local_size;
+	GLuint current = context.buffer(0, size, image.constBits());
+	GLuint next = context.buffer(1, size);
+	auto const counter = context.buffer(2, sizeof(GLuint));
+	
+	program.setUniformValue("width", width);
+	program.setUniformValue("height", height);
+	program.setUniformValue("stride", stride);
+	program.setUniformValue("insert", insert ? 1 : 0);
+	
+	auto& f = context.functions();
+	int total = 0;
+	int count;
+	do
+	{
+		count = 0;
+		for (auto const& table : packed_tables)
+		{
+			GLuint modified = 0;
+			f.glBindBuffer(GL_SHADER_STORAGE_BUFFER, counter);
+			f.glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(modified), &modified);
+			f.glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, current);
+			f.glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, next);
+			program.setUniformValueArray("table", table.data(), int(table.size()));
+			for (int first = 0; first < height; first += max_dispatch_rows)
+			{
+				program.setUniformValue("first_row", first);
+				f.glDispatchCompute(GLuint(groups_x), GLuint(std::min(max_dispatch_rows, height - first)), 1);
+				f.glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+			}
+			if (!context.read(counter, sizeof(modified), &modified))
+				return -1;
+			count += int(modified);
+			std::swap(current, next);
+		}
+		total += count;
+		if (progressObserver)
+			progressObserver->setPercentage(
+				100 -
+				static_cast<int>(
+					100 * std::pow(static_cast<float>(count) / (width * height),
+								   0.2)));
+	} while (
+		repeat && count &&
+		!(progressObserver && progressObserver->isInterruptionRequested()));
+	
+	auto result = image;
+	result.detach();
+	if (!context.read(current, size, result.bits()) || !context.noError())
+		return -1;
+	
+	image = result;
+	return total;
+#else
+	Q_UNUSED(image)
+	Q_UNUSED(tables)
+	Q_UNUSED(insert)
+	Q_UNUSED(repeat)
+	Q_UNUSED(progressObserver)
+	return -1;
+#endif
+}
+
+} // cove
+
+//@}
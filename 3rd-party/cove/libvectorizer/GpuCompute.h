@@ -0,0 +1,92 @@
+/*
+ * Copyright 2026 The OpenOrienteering developers
+ *
+ * This file is part of CoVe.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COVE_GPUCOMPUTE_H
+#define COVE_GPUCOMPUTE_H
+
+#include <memory>
+#include <vector>
+
+class QImage;
+class QOffscreenSurface;
+
+namespace cove {
+
+class MapColor;
+class ProgressObserver;
+
+/**
+ * Optional OpenGL compute shader backend for classification and morphology.
+ * 
+ * The functions return a failure indicator when the GPU cannot be used for
+ * the given input, and the callers fall back to the CPU implementation.
+ * A GpuCompute object must be created on the GUI thread, but its functions
+ * may be called from any thread. Each call creates its own OpenGL context.
+ */
+class GpuCompute
+{
+public:
+	/// Creates the offscreen surface and checks for compute shader support.
+	GpuCompute();
+	
+	GpuCompute(const GpuCompute&) = delete;
+	GpuCompute& operator=(const GpuCompute&) = delete;
+	
+	~GpuCompute();
+	
+	/// Returns true if OpenGL 4.3 or OpenGL ES 3.1 compute shaders are available.
+	bool isAvailable() const { return available; }
+	
+	/**
+	 * Classifies the pixels by the nearest color in RGB space, with
+	 * Euclidean metrics, like Vectorizer does for COLSPC_RGB and p = 2.
+	 * 
+	 * The target must be an Format_Indexed8 image of the size of the source.
+	 * The distances are computed in single precision, so pixels which are
+	 * (almost) equidistant to two colors may be assigned differently than
+	 * on the CPU.
+	 * 
+	 * Returns false if the GPU could not be used.
+	 */
+	bool classify(const QImage& source, const std::vector<std::shared_ptr<MapColor>>& colors,
+	              QImage& target, double& quality) const;
+	
+	/**
+	 * Applies neighborhood tables to a Format_Mono image, like
+	 * Morphology::modifyImage() does for a single table.
+	 * 
+	 * The tables are applied in sequence, each one to the result of the
+	 * previous one. If repeat is true, the sequence is repeated until no
+	 * pixel is changed, or until the interruption of the optional observer
+	 * is requested.
+	 * 
+	 * Returns the number of modified pixels, or -1 if the GPU could not be
+	 * used.
+	 */
+	int applyTables(QImage& image, const std::vector<const bool*>& tables, bool insert,
+	                bool repeat, ProgressObserver* progressObserver = nullptr) const;
+	
+private:
+	std::unique_ptr<QOffscreenSurface> surface;
+	bool available = false;
+};
+
+}  // namespace cove
+
+#endif
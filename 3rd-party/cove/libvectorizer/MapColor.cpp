@@ -94,6 +94,15 @@ double MapColor::getP()
 	return p;
 }
 
+/*! Returns the coordinates of the color, i.e. the unrounded components in
+ * the color space of the implementing class. */
+void MapColor::getCoordinates(double& c1, double& c2, double& c3) const
+{
+	c1 = x1;
+	c2 = x2;
+	c3 = x3;
+}
+
 double MapColor::distImplHamming(double y1, double y2, double y3) const
 {
 	return fabs(x1 - y1) + fabs(x2 - y2) + fabs(x3 - y3);
@@ -52,6 +52,7 @@ public:
 	virtual void setRGBTriplet(QRgb i) = 0;
 	void setP(double p);
 	double getP();
+	void getCoordinates(double& c1, double& c2, double& c3) const;
 };
 
 class MapColorRGB : public MapColor
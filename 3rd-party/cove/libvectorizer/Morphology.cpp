@@ -19,14 +19,240 @@
 
 #include "Morphology.h"
 
+#include <algorithm>
 #include <cmath>  // IWYU pragma: keep
+#include <cstddef>
+#include <numeric>
+#include <utility>
 #include <vector>
 
+#include <QtConcurrent>
 #include <QtGlobal>
+#include <QtAlgorithms>
+#include <QThread>
 
+#include "GpuCompute.h"
 #include "ProgressObserver.h"
 
 namespace cove {
+
+namespace {
+
+/*! A copy of a binary image with 64 pixels per word.
+ *
+ * Bit j of word w of a row is the pixel at x = 64 * (w - 1) + j.  Each row
+ * has an extra zero word at both ends, and there are extra zero rows above
+ * and below the image.  So the neighborhood of every pixel is available
+ * without special handling of the image borders.
+ */
+class PackedImage
+{
+public:
+	using Word = quint64;
+
+	explicit PackedImage(const QImage& image);
+
+	void writeTo(QImage& image) const;
+
+	int width() const { return image_width; }
+	int height() const { return image_height; }
+
+	/// The number of words holding pixels in each row.
+	std::size_t words() const { return stride - 2; }
+
+	/// Returns the given row, for y from -1 to height().
+	Word* row(int y) { return data.data() + std::size_t(y + 1) * stride; }
+	const Word* row(int y) const { return data.data() + std::size_t(y + 1) * stride; }
+
+	/// Returns the mask of the pixels within the image for word w.
+	Word validBits(std::size_t w) const { return w == words() ? last_word_mask : ~Word(0); }
+
+private:
+	std::vector<Word> data;
+	std::size_t stride;
+	Word last_word_mask;
+	int image_width;
+	int image_height;
+};
+
+unsigned char reversedBits(unsigned char b)
+{
+	b = static_cast<unsigned char>((b & 0xF0) >> 4 | (b & 0x0F) << 4);
+	b = static_cast<unsigned char>((b & 0xCC) >> 2 | (b & 0x33) << 2);
+	return static_cast<unsigned char>((b & 0xAA) >> 1 | (b & 0x55) << 1);
+}
+
+PackedImage::PackedImage(const QImage& image)
+	: stride(std::size_t(image.width() + 63) / 64 + 2)
+	, last_word_mask(image.width() % 64 ? (Word(1) << (image.width() % 64)) - 1 : ~Word(0))
+	, image_width(image.width())
+	, image_height(image.height())
+{
+	data.resize(stride * std::size_t(image_height + 2));
+	auto const mono = image.format() == QImage::Format_Mono;
+	auto const mono_lsb = image.format() == QImage::Format_MonoLSB;
+	auto const num_bytes = (image_width + 7) / 8;
+	for (int y = 0; y < image_height; y++)
+	{
+		auto* bits = row(y) + 1;
+		if (mono || mono_lsb)
+		{
+			auto const* line = image.constScanLine(y);
+			for (int i = 0; i < num_bytes; i++)
+			{
+				auto const byte = mono ? reversedBits(line[i]) : line[i];
+				bits[i / 8] |= Word(byte) << (8 * (i % 8));
+			}
+			if (num_bytes)
+				bits[words() - 1] &= last_word_mask;
+		}
+		else
+		{
+			for (int x = 0; x < image_width; x++)
+			{
+				if (image.pixelIndex(x, y))
+					bits[x / 64] |= Word(1) << (x % 64);
+			}
+		}
+	}
+}
+
+void PackedImage::writeTo(QImage& image) const
+{
+	auto const mono = image.format() == QImage::Format_Mono;
+	auto const mono_lsb = image.format() == QImage::Format_MonoLSB;
+	auto const num_bytes = (image_width + 7) / 8;
+	for (int y = 0; y < image_height; y++)
+	{
+		auto const* bits = row(y) + 1;
+		if (mono || mono_lsb)
+		{
+			auto* line = image.scanLine(y);
+			for (int i = 0; i < num_bytes; i++)
+			{
+				auto const byte = static_cast<unsigned char>(bits[i / 8] >> (8 * (i % 8)));
+				line[i] = mono ? reversedBits(byte) : byte;
+			}
+		}
+		else
+		{
+			for (int x = 0; x < image_width; x++)
+				image.setPixel(x, y, uint((bits[x / 64] >> (x % 64)) & 1));
+		}
+	}
+}
+
+
+/*! Evaluates a neighborhood table for the rows [first, last) of source.
+ *
+ * The neighborhood bits are the same as for the tables of Morphology.  The
+ * pixels where the table is true are set or reset in target, according to
+ * insert.  Each word of 64 pixels is evaluated with bitwise operations for
+ * the neighborhood bits which are the same in all true entries of the
+ * table, so that the table is looked up only for the remaining candidates.
+ * Only source is read, so the rows may be processed concurrently.
+ *
+ * \return The number of pixels where the table is true.
+ */
+int evaluateTable(const PackedImage& source, PackedImage& target, int first, int last, const bool* table, bool insert)
+{
+	using Word = PackedImage::Word;
+
+	// The bits which are set resp. unset in all true entries of the table
+	unsigned int all_set = 0777;
+	unsigned int all_unset = 0777;
+	for (unsigned int p = 0; p < 512; p++)
+	{
+		if (table[p])
+		{
+			all_set &= p;
+			all_unset &= ~p;
+		}
+	}
+	if (all_set & all_unset)
+		return 0;  // The table is never true.
+
+	int count = 0;
+	Word n[9];  // The neighborhood words, from bit 8 (a) to bit 0 (i)
+	for (int y = first; y < last; y++)
+	{
+		auto const* up = source.row(y - 1);
+		auto const* mid = source.row(y);
+		auto const* down = source.row(y + 1);
+		auto* out = target.row(y);
+		for (std::size_t w = 1; w <= source.words(); w++)
+		{
+			n[0] = (up[w] << 1) | (up[w - 1] >> 63);
+			n[1] = up[w];
+			n[2] = (up[w] >> 1) | (up[w + 1] << 63);
+			n[3] = (mid[w] << 1) | (mid[w - 1] >> 63);
+			n[4] = mid[w];
+			n[5] = (mid[w] >> 1) | (mid[w + 1] << 63);
+			n[6] = (down[w] << 1) | (down[w - 1] >> 63);
+			n[7] = down[w];
+			n[8] = (down[w] >> 1) | (down[w + 1] << 63);
+
+			auto candidates = source.validBits(w);
+			if (!table[0])
+				candidates &= n[0] | n[1] | n[2] | n[3] | n[4] | n[5] | n[6] | n[7] | n[8];
+			for (int k = 0; k < 9 && candidates; k++)
+			{
+				auto const bit = 0400u >> k;
+				if (all_set & bit)
+					candidates &= n[k];
+				else if (all_unset & bit)
+					candidates &= ~n[k];
+			}
+
+			while (candidates)
+			{
+				auto const j = qCountTrailingZeroBits(candidates);
+				auto const pixel = Word(1) << j;
+				candidates &= candidates - 1;
+
+				unsigned int p = 0;
+				for (auto const& word : n)
+					p = (p << 1) | unsigned((word >> j) & 1);
+				if (table[p])
+				{
+					if (insert)
+						out[w] |= pixel;
+					else
+						out[w] &= ~pixel;
+					count++;
+				}
+			}
+		}
+	}
+	return count;
+}
+
+/*! Evaluates a neighborhood table for all rows, concurrently in stripes.
+ *
+ * target must be a copy of source.
+ */
+int evaluateTable(const PackedImage& source, PackedImage& target, const bool* table, bool insert)
+{
+	auto const height = source.height();
+	auto const num_stripes = std::max(1, std::min(height, 4 * QThread::idealThreadCount()));
+	auto const stripe_height = (height + num_stripes - 1) / num_stripes;
+
+	std::vector<int> counts(std::size_t(num_stripes));
+	std::vector<int> stripes(counts.size());
+	for (std::size_t i = 0; i < stripes.size(); i++)
+		stripes[i] = int(i);
+	QtConcurrent::blockingMap(stripes, [&](int stripe) {
+		auto const first = stripe * stripe_height;
+		auto const last = std::min(height, first + stripe_height);
+		if (first < last)
+			counts[std::size_t(stripe)] = evaluateTable(source, target, first, last, table, insert);
+	});
+	return std::accumulate(begin(counts), end(counts), 0);
+}
+
+}  // namespace
+
+
 //@{
 //!\ingroup libvectorizer
 
@@ -44,14 +270,26 @@ namespace cove {
   Transformed image.
  */
 
+/*! \var const GpuCompute* Morphology::gpuCompute
+  Optional GPU backend.
+ */
+
 //! Constructor
 Morphology::Morphology(const QImage& img)
 	: image(img)
 	, thinnedImage(nullptr)
+	, gpuCompute(nullptr)
 {
 	if (image.depth() > 1) qWarning("Morphology:: can thin only 1bpp images");
 }
 
+/*! Sets the optional GPU backend.  The operations fall back to the CPU
+  when the backend cannot handle the image. */
+void Morphology::setGpuCompute(const GpuCompute* gpuCompute)
+{
+	this->gpuCompute = gpuCompute;
+}
+
 //! Returns the resulting image.
 QImage Morphology::getImage() const
 {
@@ -123,81 +361,47 @@ bool Morphology::todelete[512] = {
 	false, true,  true,  false, false, true,  true,  true,  true,  true,  true,
 	false, false, true,  true,  false, false};
 
-//! Rosenfeld thinning.
+/*! Rosenfeld thinning.
+  Each pass has a subpass for each direction mask.  The decisions in a
+  subpass depend on the image before the subpass only, so the rows are
+  evaluated concurrently on a bit-packed copy of the image. */
 bool Morphology::rosenfeld(ProgressObserver* progressObserver)
 {
 	bool cancel = false; // whether the thinning was canceled
-	unsigned int x, y;   // Pixel coordinates
-	unsigned int pc = 0; // Pass count
-	unsigned int count;  // Deleted pixel count
-	unsigned int p, q;   // Neighborhood maps of adjacent cells
-	unsigned int m;		 // Deletion direction mask
+	int count;           // Deleted pixel count
 
-	thinnedImage = image;
-	thinnedImage.detach();
-	unsigned int xsize = thinnedImage.width();
-	unsigned int ysize = thinnedImage.height();
-	// Neighborhood maps of previous scanline
-	std::vector<unsigned char> qb(xsize);
+	// The deletion table for each direction mask
+	bool directionTables[4][512];
+	for (std::size_t i = 0; i < 4; i++)
+	{
+		for (unsigned int p = 0; p < 512; p++)
+			directionTables[i][p] = (p & masks[i]) == 0 && todelete[p];
+	}
+
+	if (gpuCompute)
+	{
+		thinnedImage = image;
+		thinnedImage.detach();
+		std::vector<const bool*> tables;
+		for (auto const* table : directionTables)
+			tables.push_back(table);
+		if (gpuCompute->applyTables(thinnedImage, tables, false, true, progressObserver) >= 0)
+			return !(progressObserver && progressObserver->isInterruptionRequested());
+	}
 
-	qb[xsize - 1] = false; // Used for lower-right pixel
+	PackedImage current(image);
+	PackedImage next = current;
+	auto const xsize = current.width();
+	auto const ysize = current.height();
 
 	do
 	{ // Thin image lines until there are no deletions
-		pc++;
 		count = 0;
-
-		for (auto const m : masks)
+		for (auto const* table : directionTables)
 		{
-			// Build initial previous scan buffer.
-			p = !!thinnedImage.pixelIndex(0, 0);
-			for (x = 0; x < xsize - 1; x++)
-				qb[x] =
-					(unsigned char)(p = ((p << 1) & 0006) |
-										(!!thinnedImage.pixelIndex(x + 1, 0)));
-
-			// Scan image for pixel deletion candidates.
-			for (y = 0; y < ysize - 1; y++)
-			{
-				q = qb[0];
-				p = ((q << 2) & 0330) | (!!thinnedImage.pixelIndex(0, y + 1));
-
-				for (x = 0; x < xsize - 1; x++)
-				{
-					q = qb[x];
-					p = ((p << 1) & 0666) | ((q << 3) & 0110) |
-						(!!thinnedImage.pixelIndex(x + 1, y + 1));
-					qb[x] = (unsigned char)p;
-					if (((p & m) == 0) && todelete[p])
-					{
-						count++;
-						thinnedImage.setPixel(x, y, 0); // delete the pixel
-					}
-				}
-
-				// Process right edge pixel.
-				p = (p << 1) & 0666;
-				if ((p & m) == 0 && todelete[p])
-				{
-					count++;
-					thinnedImage.setPixel(x, y, 0); // delete the pixel
-				}
-			}
-
-			// Process bottom scan line.
-			q = qb[0];
-			p = ((q << 2) & 0330);
-
-			for (x = 0; x < xsize; x++)
-			{
-				q = qb[x];
-				p = ((p << 1) & 0666) | ((q << 3) & 0110);
-				if ((p & m) == 0 && todelete[p])
-				{
-					count++;
-					thinnedImage.setPixel(x, y, 0); // delete the pixel
-				}
-			}
+			next = current;
+			count += evaluateTable(current, next, table, false);
+			std::swap(current, next);
 		}
 		if (progressObserver)
 			progressObserver->setPercentage(
@@ -209,6 +413,10 @@ bool Morphology::rosenfeld(ProgressObserver* progressObserver)
 		count &&
 		!(progressObserver && (cancel = progressObserver->isInterruptionRequested())));
 
+	thinnedImage = image;
+	thinnedImage.detach();
+	current.writeTo(thinnedImage);
+
 	return !cancel;
 }
 
@@ -391,7 +599,8 @@ bool Morphology::runMorpholo(bool* table, bool insert,
 
 /*! Modifies thinnedImage according to given table.  Builds 3x3 neighborhood for
   every pixel and sets/resets (according to insert) the pixel in case the table
-  contains true.
+  contains true.  All decisions depend on the original image only, so the
+  rows are evaluated concurrently on a bit-packed copy of the image.
   \param[in] table Neighborhood table, e.g. isDeletable or isInsertable
   \param[in] insert Whether the pixel should be set or reset when the table
   contains true.
@@ -400,98 +609,25 @@ bool Morphology::runMorpholo(bool* table, bool insert,
 int Morphology::modifyImage(bool* table, bool insert,
 							ProgressObserver* progressObserver)
 {
-	int xSize = thinnedImage.width();
-	int ySize = thinnedImage.height();
-	int progressHowOften = (ySize > 100) ? ySize / 75 : 1;
-	std::vector<bool> topScanLine(xSize);
-	std::vector<bool> midScanLine(xSize);
-	std::vector<bool> botScanLine(xSize);
-	int p, modifications;
-	bool cancel = false;
-
-	modifications = 0;
-	// prepare buffers
-	for (int x = 0; x < xSize; x++)
-	{
-		midScanLine[x] = false;
-		botScanLine[x] = !!thinnedImage.pixelIndex(x, 0);
-	}
+	if (progressObserver && progressObserver->isInterruptionRequested())
+		return -1;
 
-	for (int y = 0; y < ySize - 1 && !cancel; y++)
+	if (gpuCompute)
 	{
-		// rotate buffers
-		auto& temp = topScanLine;
-		topScanLine = midScanLine;
-		midScanLine = botScanLine;
-		botScanLine = temp;
-		// initialize bottom line
-		botScanLine[0] = !!thinnedImage.pixelIndex(0, y + 1);
-		// create neighborhood
-		p = topScanLine[0] << 6 | topScanLine[1] << 5 | midScanLine[0] << 3 |
-			midScanLine[1] << 2 | botScanLine[0];
-
-		// process line
-		for (int x = 0; x < xSize - 1; x++)
-		{
-			botScanLine[x + 1] = !!thinnedImage.pixelIndex(x + 1, y + 1);
-			p = ((p << 1) & 0666) | (topScanLine[x + 1] << 6) |
-				(midScanLine[x + 1] << 3) | (botScanLine[x + 1]);
-			if (table[p])
-			{
-				thinnedImage.setPixel(x, y, insert ? 1 : 0); // set the pixel
-				// TTR midScanLine[x] = false;
-				modifications++;
-			}
-		}
-
-		// right margin line processing
-		p = (p << 1) & 0666;
-		if (table[p])
-		{
-			thinnedImage.setPixel(xSize - 1, y,
-								  insert ? 1 : 0); // set the pixel
-			// TTR midScanLine[xSize-1] = false;
-			modifications++;
-		}
-
-		if (progressObserver && !(y % progressHowOften))
-		{
-			progressObserver->setPercentage(y * 100 / ySize);
-			cancel = progressObserver->isInterruptionRequested();
-		}
+		auto const modifications = gpuCompute->applyTables(thinnedImage, {table}, insert, false);
+		if (modifications >= 0)
+			return modifications;
 	}
 
-	// bottom margin line processing
-	auto& temp = topScanLine;
-	topScanLine = midScanLine;
-	midScanLine = botScanLine;
-	botScanLine = temp;
-	p = topScanLine[0] << 7 | topScanLine[1] << 6 | midScanLine[0] << 4 |
-		midScanLine[1] << 3;
-	for (int x = 0; x < xSize - 1 && !cancel; x++)
-	{
-		p = ((p << 1) & 0666) | (topScanLine[x + 1] << 6) |
-			(midScanLine[x + 1] << 3);
-		if (table[p])
-		{
-			thinnedImage.setPixel(x, ySize - 1,
-								  insert ? 1 : 0); // set the pixel
-			// TTR midScanLine[x] = false;
-			modifications++;
-		}
-	}
+	PackedImage source(thinnedImage);
+	PackedImage target = source;
+	auto const modifications = evaluateTable(source, target, table, insert);
 
-	// bottom right pixel
-	p = (p << 1) & 0666;
-	if (table[p])
-	{
-		thinnedImage.setPixel(xSize - 1, ySize - 1,
-							  insert ? 1 : 0); // set the pixel
-		// TTR midScanLine[xSize-1] = false;
-		modifications++;
-	}
+	if (progressObserver && progressObserver->isInterruptionRequested())
+		return -1;
 
-	return cancel ? -1 : modifications;
+	target.writeTo(thinnedImage);
+	return modifications;
 }
 } // cove
 
@@ -23,6 +23,7 @@
 #include <QImage>
 
 namespace cove {
+class GpuCompute;
 class ProgressObserver;
 
 class Morphology
@@ -34,6 +35,7 @@ protected:
 	static bool isInsertable[];
 	static bool isPrunable[];
 	QImage image, thinnedImage;
+	const GpuCompute* gpuCompute;
 	bool runMorpholo(bool* table, bool insert,
 	                 ProgressObserver* progressObserver = nullptr);
 	int modifyImage(bool* table, bool insert,
@@ -41,6 +43,7 @@ protected:
 
 public:
 	Morphology(const QImage& img);
+	void setGpuCompute(const GpuCompute* gpuCompute);
 	bool rosenfeld(ProgressObserver* progressObserver = nullptr);
 	bool erosion(ProgressObserver* progressObserver = nullptr);
 	bool dilation(ProgressObserver* progressObserver = nullptr);
@@ -24,6 +24,7 @@
 
 #include <QtGlobal>
 #include <QImage>
+#include <QRect>
 #include <QRgb>
 
 
@@ -80,5 +81,22 @@ QImage HorizontalStripes::makeStripe(QImage& original, int scanline, int stripe_
 }
 
 
+
+// ### ImageTiles ###
+
+QImage ImageTiles::makeTile(QImage& original, const QRect& rect)
+{
+	Q_ASSERT(rect.x() * original.depth() % 8 == 0);
+	QImage result(original.scanLine(rect.y()) + rect.x() * original.depth() / 8,
+	              rect.width(),
+	              rect.height(),
+	              original.bytesPerLine(),
+	              original.format() );
+	if (original.colorCount() > 0)
+		result.setColorTable(original.colorTable());
+	return result;
+}
+
+
 }  // namespace cove
 
@@ -25,6 +25,7 @@
 #include <iosfwd>
 
 #include <QImage>
+#include <QRect>
 #include <QThreadPool>
 
 #include "Concurrency.h"
@@ -91,6 +92,67 @@ struct HorizontalStripes
 };
 
 
+/**
+ * Use concurrent image processing of overlapping tiles.
+ * 
+ * For each tile, the functor is called with the rectangle of the tile
+ * including a margin, with the rectangle of the tile without the margin,
+ * and with the part of the target image which corresponds to the latter.
+ * The functor is expected to load or compute the input data for the tile by
+ * itself. So only the data for the tiles which are processed at the moment
+ * needs to be held in memory, and operations which look at the neighborhood
+ * of a pixel see the same neighborhood as in the whole image, up to the width
+ * of the margin.
+ */
+struct ImageTiles
+{
+	/// The size of the tiles, without margin.
+	/// A multiple of 32 keeps the target tiles byte-aligned for all formats.
+	static constexpr int tile_size = 1024;
+	
+	/// The width of the margin around the tiles.
+	static constexpr int overlap = 32;
+	
+	/// Creates a QImage for in-place modification of a rectangle of the original image.
+	static QImage makeTile(QImage& original, const QRect& rect);
+	
+	/// A structure to describe the data of the job for a single tile.
+	struct TileData
+	{
+		QRect tile;
+		QRect core;
+		QImage& target;
+	};
+	
+	/// Creates concurrent jobs.
+	template <typename ResultType, typename Functor>
+	static Concurrency::JobList<ResultType> makeJobs(const Functor& functor, QImage& target)
+	{
+		Concurrency::JobList<ResultType> jobs;
+		
+		auto const bounds = target.rect();
+		for (int y = 0; y < bounds.height(); y += tile_size)
+		{
+			for (int x = 0; x < bounds.width(); x += tile_size)
+			{
+				// Like for HorizontalStripes, the target tile must be created
+				// inside the concurrent job.
+				auto runner = [](const Functor& functor, TileData& data, ProgressObserver& observer) -> ResultType {
+					auto output = ImageTiles::makeTile(data.target, data.core);
+					return functor(data.tile, data.core, output, observer);
+				};
+				auto const core = QRect(x, y, tile_size, tile_size) & bounds;
+				auto const tile = core.adjusted(-overlap, -overlap, overlap, overlap) & bounds;
+				auto data = TileData { tile, core, target };
+				jobs.emplace_back(Concurrency::run<ResultType>(runner, functor, data));
+			}
+		}
+		
+		return jobs;
+	}
+};
+
+
 }  // namespace cove
 
 #endif  // COVE_PARALLELIMAGEPROCESSING_H
@@ -21,6 +21,7 @@
 #include "Polygons.h"
 
 #include <algorithm>
+#include <array>
 #include <cerrno>
 #include <cmath>
 #include <cstdlib>
@@ -31,7 +32,10 @@
 #include <stdexcept>
 #include <utility>
 
+#include <QtConcurrent>
 #include <QtGlobal>
+#include <QtAlgorithms>
+#include <QAtomicInt>
 #include <QByteArray>
 #include <QPointF>
 #include <QString>
@@ -129,6 +133,100 @@ bool Polygons::Path::isClosed() const
 	return pathClosed;
 }
 
+/*! \class Polygons::PathImage
+   \brief A bit-packed copy of an image for tracing paths.
+
+   Each pixel is represented by a single bit, with the leftmost pixel in the
+   least significant bit of a word. The image is surrounded by a border of
+   unset pixels, so that the neighbors of every pixel in the image can be
+   examined without bounds checks, and the search for the next pixel can skip
+   64 unset pixels at once.
+   */
+/*! Creates a packed copy of the given image, where any non-zero pixel
+    index is a set pixel. */
+Polygons::PathImage::PathImage(const QImage& image)
+	: imageWidth(image.width())
+	, imageHeight(image.height())
+	, wordsPerLine((image.width() + 2 + 63) / 64)
+{
+	bits.resize(std::size_t(imageHeight + 2) * std::size_t(wordsPerLine));
+
+	auto const format = image.format();
+	if (format != QImage::Format_Mono && format != QImage::Format_MonoLSB)
+	{
+		for (int y = 0; y < imageHeight; y++)
+		{
+			for (int x = 0; x < imageWidth; x++)
+			{
+				if (image.pixelIndex(x, y))
+					bits[index(x, y)] |= mask(x);
+			}
+		}
+		return;
+	}
+
+	static auto const reversed = [] {
+		std::array<uchar, 256> table = {};
+		for (int i = 0; i < 256; i++)
+		{
+			for (int b = 0; b < 8; b++)
+			{
+				if (i & (1 << b))
+					table[std::size_t(i)] |= uchar(0x80 >> b);
+			}
+		}
+		return table;
+	}();
+
+	auto const bytes = (imageWidth + 7) / 8;
+	auto const lastMask = uchar(imageWidth % 8 ? (1 << (imageWidth % 8)) - 1 : 0xff);
+	for (int y = 0; y < imageHeight; y++)
+	{
+		auto const* line = image.constScanLine(y);
+		auto* row = bits.data() + index(-1, y);
+		for (int i = 0; i < bytes; i++)
+		{
+			quint64 value = format == QImage::Format_Mono ? reversed[line[i]] : line[i];
+			if (i == bytes - 1)
+				value &= lastMask;
+			if (!value)
+				continue;
+			auto const position = 8 * i + 1;
+			row[position / 64] |= value << (position % 64);
+			if (position % 64 > 56)
+				row[position / 64 + 1] |= value >> (64 - position % 64);
+		}
+	}
+}
+
+/*! Looks for the next set pixel, starting at [xp, yp].
+    \see Polygons::findNextPixel */
+bool Polygons::PathImage::findNextPixel(int& xp, int& yp) const
+{
+	auto position = xp + 1;
+	for (int y = yp; y < imageHeight; y++)
+	{
+		auto const* row = bits.data() + index(-1, y);
+		auto w = position / 64;
+		auto word = row[w] & (~quint64(0) << (position % 64));
+		for (;;)
+		{
+			if (word)
+			{
+				// The border and the padding bits are never set.
+				xp = w * 64 + int(qCountTrailingZeroBits(word)) - 1;
+				yp = y;
+				return true;
+			}
+			if (++w == wordsPerLine)
+				break;
+			word = row[w];
+		}
+		position = 0;
+	}
+	return false;
+}
+
 // -POLYGON--------------------
 /*! \class Polygon
    \brief Represents polygon in an image.
@@ -240,25 +338,9 @@ double Polygons::distDirRatio() const
  \param[in,out] yp y coordinate, similar to xp
  \return true when xp, yp contain valid coordinates of black pixel, false
  otherwise */
-bool Polygons::findNextPixel(const QImage& image, int& xp, int& yp)
+bool Polygons::findNextPixel(const PathImage& image, int& xp, int& yp)
 {
-	int x = xp;
-	for (int y = yp; y < image.height(); y++)
-	{
-		for (; x < image.width(); x++)
-		{
-			if (image.pixelIndex(x, y))
-			{
-				// we have found one
-				xp = x;
-				yp = y;
-				return true;
-			}
-		}
-		x = 0;
-	}
-	// there are no pixels left
-	return false;
+	return image.findNextPixel(xp, yp);
 }
 
 /*! \brief Follows path in an image.
@@ -270,43 +352,43 @@ bool Polygons::findNextPixel(const QImage& image, int& xp, int& yp)
   \param[in,out] path Pointer to Polygons::Path where the pixel coordinates will
   be stored. The variable can be nullptr in which case no coordinates are recorded.
  */
-void Polygons::followPath(const QImage& image, int& x, int& y, Path* path)
+void Polygons::followPath(const PathImage& image, int& x, int& y, Path* path)
 {
 	const int origX = x, origY = y;
 	int newx = 0, newy = 0;
-	int imWidth = image.width(), imHeight = image.height();
 	DIRECTION direction = NONE, newDirection;
 	int canProceed;
 	bool firstCycle = true;
 
+	// The pixels outside the image are unset, so there is no need for
+	// checking the bounds.
 	for (;;)
 	{
 		canProceed = 0;
 		newDirection = NONE;
 
-		if (x < imWidth - 1 && image.pixelIndex(x + 1, y) && direction != WEST)
+		if (image.pixel(x + 1, y) && direction != WEST)
 		{
 			newx = x + 1;
 			newy = y;
 			newDirection = EAST;
 			canProceed++;
 		}
-		if (x && image.pixelIndex(x - 1, y) && direction != EAST)
+		if (image.pixel(x - 1, y) && direction != EAST)
 		{
 			newx = x - 1;
 			newy = y;
 			newDirection = WEST;
 			canProceed++;
 		}
-		if (y < imHeight - 1 && image.pixelIndex(x, y + 1) &&
-			direction != NORTH)
+		if (image.pixel(x, y + 1) && direction != NORTH)
 		{
 			newx = x;
 			newy = y + 1;
 			newDirection = SOUTH;
 			canProceed++;
 		}
-		if (y && image.pixelIndex(x, y - 1) && direction != SOUTH)
+		if (image.pixel(x, y - 1) && direction != SOUTH)
 		{
 			newx = x;
 			newy = y - 1;
@@ -344,7 +426,7 @@ void Polygons::followPath(const QImage& image, int& x, int& y, Path* path)
  \param initX pixel coordinates where to start traversal
  \param initY see initX
  \return path found */
-Polygons::Path Polygons::recordPath(const QImage& image, const int initX,
+Polygons::Path Polygons::recordPath(const PathImage& image, const int initX,
 									const int initY)
 {
 	int x = initX, y = initY;
@@ -358,11 +440,11 @@ Polygons::Path Polygons::recordPath(const QImage& image, const int initX,
 }
 
 /*! Draw into the image so that original path disappears. */
-void Polygons::removePathFromImage(QImage& image, const Path& path)
+void Polygons::removePathFromImage(PathImage& image, const Path& path)
 {
 	for (auto const& i : path)
 	{
-		image.setPixel(i.x, i.y, 0); // delete the pixel
+		image.clearPixel(i.x, i.y); // delete the pixel
 	}
 }
 
@@ -372,7 +454,7 @@ Polygons::decomposeImageIntoPaths(const QImage& sourceImage,
 								  ProgressObserver* progressObserver) const
 {
 	PathList pathList;
-	QImage image = sourceImage;
+	PathImage image(sourceImage);
 	int height = sourceImage.height(),
 		progressHowOften = (height > 100) ? height / 45 : 1;
 	int x = 0, y = 0;
@@ -444,15 +526,31 @@ Polygons::getPathPolygons(const Polygons::PathList& constpaths,
 		}
 	}
 
-// create polygons for all paths
-#define TRY(x) \
-	if (x) goto try_error // NOLINT
+	// create polygons for all paths, concurrently: the potrace functions
+	// work on a single path and don't share any state.
+	std::vector<path_t*> paths;
+	paths.reserve(constpaths.size());
 	list_forall(p, plist)
 	{
-		TRY(calc_sums(p->priv));
-		TRY(calc_lon(p->priv));
-		TRY(bestpolygon(p->priv));
-		TRY(adjust_vertices(p->priv));
+		paths.push_back(p);
+	}
+	QAtomicInt error = 0;
+	QtConcurrent::blockingMap(paths, [&error](path_t* path) {
+		if (error.loadAcquire())
+			return;
+		auto* pp = path->priv;
+		if (calc_sums(pp) || calc_lon(pp) || bestpolygon(pp) || adjust_vertices(pp))
+			error.testAndSetOrdered(0, errno ? errno : ENOMEM);
+	});
+	paths.clear();
+	if (error.loadAcquire())
+	{
+		qWarning("process_path failed with errno %d", error.loadAcquire());
+		list_forall_unlink(p, plist)
+		{
+			path_free(p);
+		}
+		return {};
 	}
 
 	// do joining...
@@ -491,11 +589,6 @@ Polygons::getPathPolygons(const Polygons::PathList& constpaths,
 	}
 
 	return polylist;
-
-try_error:
-	qWarning("process_path failed with errno %d", errno);
-	path_free(p);
-	return {};
 }
 
 /*! Euclidean distance of two QPointFs. */
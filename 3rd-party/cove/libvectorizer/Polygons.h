@@ -22,6 +22,7 @@
 #define COVE_POLYGONS_H
 
 #include <algorithm>
+#include <cstddef>
 #include <functional>
 #include <limits>
 #include <vector>
@@ -92,6 +93,32 @@ protected:
 	{
 	};
 
+	class PathImage
+	{
+		std::vector<quint64> bits;
+		int imageWidth;
+		int imageHeight;
+		int wordsPerLine;
+
+		std::size_t index(int x, int y) const
+		{
+			return std::size_t(y + 1) * std::size_t(wordsPerLine) + std::size_t(x + 1) / 64;
+		}
+
+		static quint64 mask(int x)
+		{
+			return quint64(1) << ((x + 1) % 64);
+		}
+
+	public:
+		explicit PathImage(const QImage& image);
+		int width() const { return imageWidth; }
+		int height() const { return imageHeight; }
+		bool pixel(int x, int y) const { return bits[index(x, y)] & mask(x); }
+		void clearPixel(int x, int y) { bits[index(x, y)] &= ~mask(x); }
+		bool findNextPixel(int& xp, int& yp) const;
+	};
+
 private:
 	enum JOINEND
 	{
@@ -174,10 +201,10 @@ private:
 	                  ProgressObserver* progressObserver = nullptr) const;
 
 protected:
-	static bool findNextPixel(const QImage& image, int& xp, int& yp);
-	static void followPath(const QImage& image, int& x, int& y, Path* path = nullptr);
-	static Path recordPath(const QImage& image, int initX, int initY);
-	static void removePathFromImage(QImage& image, const Path& path);
+	static bool findNextPixel(const PathImage& image, int& xp, int& yp);
+	static void followPath(const PathImage& image, int& x, int& y, Path* path = nullptr);
+	static Path recordPath(const PathImage& image, int initX, int initY);
+	static void removePathFromImage(PathImage& image, const Path& path);
 	PathList decomposeImageIntoPaths(const QImage& sourceImage,
 	                                 ProgressObserver* progressObserver = nullptr) const;
 	PolygonList getPathPolygons(const PathList& constpaths,
@@ -21,7 +21,9 @@
 #include "Vectorizer.h"
 
 #include <algorithm>
+#include <cmath>
 #include <cstdlib>
+#include <cstring>
 #include <iosfwd>
 #include <iterator>
 #include <numeric>
@@ -33,10 +35,15 @@
 #include <QColor>
 #include <QException>
 #include <QImage>
+#include <QImageReader>
+#include <QRect>
+#include <QSize>
+#include <QString>
 #include <QVector>
 
 #include "AlphaGetter.h"
 #include "Concurrency.h"
+#include "GpuCompute.h"
 #include "ProgressObserver.h"
 #include "KohonenMap.h"
 #include "MapColor.h"
@@ -62,6 +69,10 @@ namespace cove {
  * - obtain the classified image with getClassifiedImage()
  * - after selecting the colors for separation call getBWImage()
  * - and in case of need thin the lines in the image with getThinnedImage()
+ *
+ * Scans which are too large for holding the source image and the
+ * intermediate images in memory can be processed by getTiledBWImage(),
+ * after learning the colors from a reduced copy of the scan.
  */
 
 /*!
@@ -163,6 +174,8 @@ namespace cove {
  Selected alpha selection strategy. \sa setAlphaStrategy */
 /*! \var PatternStrategy Vectorizer::patternStrategy
  Selected pattern selection strategy. \sa setPatternStrategy */
+/*! \var const GpuCompute* Vectorizer::gpuCompute
+ Optional GPU backend. \sa setGpuCompute */
 
 Vectorizer::Vectorizer()
 	: mc(std::make_unique<MapColorRGB>(2.0))
@@ -175,6 +188,7 @@ Vectorizer::Vectorizer()
 	, colorSpace(COLSPC_RGB)
 	, alphaStrategy(ALPHA_CLASSIC)
 	, patternStrategy(PATTERN_RANDOM)
+	, gpuCompute(nullptr)
 {
 }
 
@@ -297,6 +311,84 @@ void Vectorizer::setInitColors(const std::vector<QRgb>& initColors)
 	}
 }
 
+/*! Sets the optional GPU backend for classification and morphology.
+ * The backend is used for RGB classification with p = 2 and for the
+ * morphological operations, when it can handle the image.  Otherwise the
+ * CPU implementation is used.  Setting nullptr disables the GPU backend. */
+void Vectorizer::setGpuCompute(const GpuCompute* gpuCompute)
+{
+	this->gpuCompute = gpuCompute;
+}
+
+/*! Partial results of one stripe of the image in an epoch of batch
+ * learning. */
+struct BatchLearningSums
+{
+	std::vector<std::shared_ptr<OrganizableElement>> sums;
+	std::vector<unsigned int> counts;
+	int changes = 0;
+	double quality = 0;
+};
+
+/*! Assigns the pixels of the source image to the closest classes, for one
+ * epoch of batch learning.  The output image holds the class of each pixel,
+ * and the changes of classes are counted.  The pixels are summed up per
+ * class, so that the mean of each class can be computed after reducing the
+ * sums of all stripes. */
+class BatchLearningMapper
+{
+	const std::vector<std::unique_ptr<OrganizableElement>>& classes;
+	const KohonenMap& km;
+
+public:
+	BatchLearningMapper(const std::vector<std::unique_ptr<OrganizableElement>>& classes, const KohonenMap& km)
+		: classes(classes)
+		, km(km)
+	{}
+
+	BatchLearningSums operator()(const QImage& sourceImage, QImage& outputImage, ProgressObserver& observer) const
+	{
+		auto const width = outputImage.width();
+		auto const height = outputImage.height();
+
+		BatchLearningSums result;
+		result.counts.resize(classes.size());
+		result.sums.reserve(classes.size());
+		for (auto const& c : classes)
+		{
+			result.sums.emplace_back(c->clone());
+			result.sums.back()->multiply(0);
+		}
+
+		auto color = std::unique_ptr<MapColor>(
+			dynamic_cast<MapColor*>(classes[0]->clone()));
+
+		for (int y = 0; y < height && !observer.isInterruptionRequested(); y++)
+		{
+			auto* line = outputImage.scanLine(y);
+			for (int x = 0; x < width; x++)
+			{
+				double distance;
+				color->setRGBTriplet(sourceImage.pixel(x, y));
+				int index = km.findClosest(*color, distance);
+				result.sums[index]->add(*color);
+				result.counts[index]++;
+				if (line[x] != index)
+				{
+					line[x] = uchar(index);
+					result.changes++;
+				}
+				result.quality += color->squares(*classes[index]);
+			}
+			observer.setPercentage((100*y) / height);
+		}
+		return result;
+	}
+
+	using concurrent_processing = HorizontalStripes;
+};
+Q_STATIC_ASSERT((Concurrency::supported<BatchLearningMapper>::value));
+
 /*! Runs classfication.  The progress observer is called during work if set.
  * \param[in] progressObserver Pointer to class implementing ProgressObserver.
  * In case it is null pointer no calls take place.
@@ -346,10 +438,63 @@ bool Vectorizer::performClassification(ProgressObserver* progressObserver)
 	break;
 	case KOHONEN_BATCH:
 	{
-		auto bg = std::make_unique<SequentialPatternGetter>(
-			sourceImage, mc.get(), progressObserver);
-		quality = km.performBatchLearning(*bg);
-		classifiedImage = *bg->getClassifiedImage();
+		// Equivalent to KohonenMap::performBatchLearning, but each epoch
+		// processes stripes of the image concurrently.  The partial sums
+		// are reduced in the order of the stripes, so the result does not
+		// depend on the scheduling of the jobs.
+		classifiedImage = QImage(sourceImage.size(), QImage::Format_Indexed8);
+		classifiedImage.setColorCount(256);
+		classifiedImage.fill(255);
+
+		auto const numPixels = double(sourceImage.width()) * sourceImage.height();
+		auto percentage = 0;
+		for (;;)
+		{
+			auto currentClasses = km.getClasses();
+			auto mapFunctor = BatchLearningMapper(currentClasses, km);
+			// Progress is reported per epoch, not per job.
+			auto epochProgress = std::unique_ptr<Concurrency::TransformedProgress>();
+			if (progressObserver)
+				epochProgress = std::make_unique<Concurrency::TransformedProgress>(*progressObserver, 0.0, percentage);
+			auto results = Concurrency::process<BatchLearningSums>(epochProgress.get(), mapFunctor, sourceImage, classifiedImage);
+			if (results.empty()
+			    || (progressObserver && progressObserver->isInterruptionRequested()))
+			{
+				classifiedImage = QImage();
+				break;
+			}
+
+			auto total = results.front().future.result();
+			for (auto job = std::next(begin(results)); job != end(results); ++job)
+			{
+				auto const stripe = job->future.result();
+				for (std::size_t i = 0; i < total.sums.size(); i++)
+				{
+					total.sums[i]->add(*stripe.sums[i]);
+					total.counts[i] += stripe.counts[i];
+				}
+				total.changes += stripe.changes;
+				total.quality += stripe.quality;
+			}
+			quality = total.quality;
+			if (!total.changes)
+				break;
+
+			std::vector<OrganizableElement*> means(total.sums.size());
+			for (std::size_t i = 0; i < total.sums.size(); i++)
+			{
+				if (total.counts[i])
+					total.sums[i]->multiply(1.0 / total.counts[i]);
+				else
+					total.sums[i]->multiply(0);
+				means[i] = total.sums[i].get();
+			}
+			km.setClasses(means);
+
+			percentage = 100 - static_cast<int>(100 * std::pow(total.changes / numPixels, 0.2));
+			if (progressObserver)
+				progressObserver->setPercentage(percentage);
+		}
 	}
 	break;
 	default:
@@ -430,6 +575,83 @@ public:
 };
 Q_STATIC_ASSERT((Concurrency::supported<ClassificationMapper>::value));
 
+/*! Classifies pixels by the nearest color in RGB space with Euclidean
+ * metrics.  The result is the same as from ClassificationMapper with
+ * MapColorRGB colors and p = 2, but the pixels are read directly from the
+ * scanlines, and the distances to all colors are computed in a plain loop
+ * over contiguous arrays which the compiler can vectorize.  Ties are
+ * decided on the squared distances, in favor of the lowest index. */
+class RGBClassificationMapper
+{
+	std::vector<double> red;
+	std::vector<double> green;
+	std::vector<double> blue;
+
+public:
+	explicit RGBClassificationMapper(const std::vector<std::shared_ptr<MapColor>>& colors)
+	{
+		red.resize(colors.size());
+		green.resize(colors.size());
+		blue.resize(colors.size());
+		for (std::size_t i = 0; i < colors.size(); i++)
+			colors[i]->getCoordinates(red[i], green[i], blue[i]);
+	}
+
+	double operator()(const QImage& sourceImage, QImage& outputImage, ProgressObserver& observer) const
+	{
+		auto const width = outputImage.width();
+		auto const height = outputImage.height();
+		auto const num_colors = red.size();
+		auto const direct = sourceImage.format() == QImage::Format_RGB32
+		                    || sourceImage.format() == QImage::Format_ARGB32;
+
+		std::vector<QRgb> line(direct ? 0 : std::size_t(width));
+		std::vector<double> distances(num_colors);
+		auto* const d = distances.data();
+		auto const* const r = red.data();
+		auto const* const g = green.data();
+		auto const* const b = blue.data();
+
+		double quality = 0;
+		for (int y = 0; y < height && !observer.isInterruptionRequested(); y++)
+		{
+			auto const* pixels = line.data();
+			if (direct)
+			{
+				pixels = reinterpret_cast<const QRgb*>(sourceImage.constScanLine(y));
+			}
+			else
+			{
+				for (int x = 0; x < width; x++)
+					line[std::size_t(x)] = sourceImage.pixel(x, y);
+			}
+
+			auto* output = outputImage.scanLine(y);
+			for (int x = 0; x < width; x++)
+			{
+				auto const pr = double(qRed(pixels[x]));
+				auto const pg = double(qGreen(pixels[x]));
+				auto const pb = double(qBlue(pixels[x]));
+				for (std::size_t i = 0; i < num_colors; i++)
+				{
+					auto const dr = r[i] - pr;
+					auto const dg = g[i] - pg;
+					auto const db = b[i] - pb;
+					d[i] = dr * dr + dg * dg + db * db;
+				}
+				auto const best = std::min_element(d, d + num_colors);
+				output[x] = uchar(best - d);
+				quality += *best;
+			}
+			observer.setPercentage((100*y) / height);
+		}
+		return quality;
+	}
+
+	using concurrent_processing = HorizontalStripes;
+};
+Q_STATIC_ASSERT((Concurrency::supported<RGBClassificationMapper>::value));
+
 
 QImage Vectorizer::getClassifiedImage(double* qualityPtr,
 									  ProgressObserver* progressObserver)
@@ -450,14 +672,29 @@ QImage Vectorizer::getClassifiedImage(double* qualityPtr,
 		KohonenMap km;
 		km.setClasses(classes);
 
-		auto mapFunctor = ClassificationMapper(sourceImageColors, km);
-		auto results = Concurrency::process<double>(progressObserver, mapFunctor, sourceImage, classifiedImage);
+		Concurrency::JobList<double> results;
+		if (colorSpace == COLSPC_RGB && p == 2
+		    && gpuCompute && gpuCompute->classify(sourceImage, sourceImageColors, classifiedImage, quality))
+		{
+			if (progressObserver)
+				progressObserver->setPercentage(100);
+		}
+		else if (colorSpace == COLSPC_RGB && p == 2)
+		{
+			auto mapFunctor = RGBClassificationMapper(sourceImageColors);
+			results = Concurrency::process<double>(progressObserver, mapFunctor, sourceImage, classifiedImage);
+		}
+		else
+		{
+			auto mapFunctor = ClassificationMapper(sourceImageColors, km);
+			results = Concurrency::process<double>(progressObserver, mapFunctor, sourceImage, classifiedImage);
+		}
 		if (progressObserver && progressObserver->isInterruptionRequested())
 		{
 			classifiedImage = QImage();
 			quality = 0;
 		}
-		else
+		else if (!results.empty())
 		{
 			quality = std::accumulate(begin(results), end(results), 0.0, [](auto a, auto& b) { return a + b.future.result(); });
 		}
@@ -523,13 +760,34 @@ QImage Vectorizer::getBWImage(std::vector<bool> selectedColors,
 	return bwImage;
 }
 
+namespace {
+
+/*! Returns the member function of Morphology for the given operation. */
+auto morphologicalOperation(Vectorizer::MorphologicalOperation mo) -> bool (Morphology::*)(ProgressObserver*)
+{
+	switch (mo)
+	{
+	case Vectorizer::EROSION:
+		return &Morphology::erosion;
+	case Vectorizer::DILATION:
+		return &Morphology::dilation;
+	case Vectorizer::THINNING_ROSENFELD:
+		return &Morphology::rosenfeld;
+	case Vectorizer::PRUNING:
+		return &Morphology::pruning;
+	}
+	return nullptr;
+}
+
+}  // namespace
+
 /*! Performs selected Morphological operation on data member bwImage.
  \sa MorphologicalOperation getTransformedImage(QImage bwImage,
  MorphologicalOperation mo, ProgressObserver* progressObserver) */
 QImage Vectorizer::getTransformedImage(MorphologicalOperation mo,
 									   ProgressObserver* progressObserver)
 {
-	QImage i = Vectorizer::getTransformedImage(bwImage, mo, progressObserver);
+	QImage i = Vectorizer::getTransformedImage(bwImage, mo, progressObserver, gpuCompute);
 	if (!i.isNull()) bwImage = i;
 	return i;
 }
@@ -538,33 +796,21 @@ QImage Vectorizer::getTransformedImage(MorphologicalOperation mo,
   \param[in] bwImage BW image to be processed.
   \param[in] mo Morphological operation to be performed.
   \param[in] progressObserver Progress observer.
+  \param[in] gpuCompute Optional GPU backend.
   \return Transformed BW image.
  \sa MorphologicalOperation */
 QImage Vectorizer::getTransformedImage(const QImage& bwImage,
                                        MorphologicalOperation mo,
-                                       ProgressObserver* progressObserver)
+                                       ProgressObserver* progressObserver,
+                                       const GpuCompute* gpuCompute)
 {
 	QImage outputImage;
-	bool (Morphology::*operation)(ProgressObserver*) = nullptr;
-	switch (mo)
-	{
-	case EROSION:
-		operation = &Morphology::erosion;
-		break;
-	case DILATION:
-		operation = &Morphology::dilation;
-		break;
-	case THINNING_ROSENFELD:
-		operation = &Morphology::rosenfeld;
-		break;
-	case PRUNING:
-		operation = &Morphology::pruning;
-		break;
-	}
+	auto const operation = morphologicalOperation(mo);
 	if (operation)
 	{
-		auto functor = [operation](const QImage& source_image, ProgressObserver& progressObserver) -> QImage {
+		auto functor = [operation, gpuCompute](const QImage& source_image, ProgressObserver& progressObserver) -> QImage {
 			Morphology morphology(source_image);
+			morphology.setGpuCompute(gpuCompute);
 			auto ok = (morphology.*operation)(&progressObserver);
 			progressObserver.setPercentage(100);
 			return ok ? morphology.getImage() : QImage{};
@@ -575,6 +821,156 @@ QImage Vectorizer::getTransformedImage(const QImage& bwImage,
 	return outputImage;
 }
 
+/*! Classifies, separates and transforms a single tile of a large source
+ * image, and stores the tile without its margin in the output image.
+ * Returns false if reading the source fails, or on cancellation. */
+class TiledBWMapper
+{
+	const Vectorizer::SourceReader& reader;
+	const std::vector<std::shared_ptr<MapColor>>& colors;
+	const std::vector<bool>& selectedColors;
+	const std::vector<Vectorizer::MorphologicalOperation>& operations;
+	bool rgb;
+
+public:
+	TiledBWMapper(const Vectorizer::SourceReader& reader,
+	              const std::vector<std::shared_ptr<MapColor>>& colors,
+	              const std::vector<bool>& selectedColors,
+	              const std::vector<Vectorizer::MorphologicalOperation>& operations,
+	              bool rgb)
+		: reader(reader)
+		, colors(colors)
+		, selectedColors(selectedColors)
+		, operations(operations)
+		, rgb(rgb)
+	{}
+
+	bool operator()(const QRect& tile, const QRect& core, QImage& outputImage, ProgressObserver& observer) const
+	{
+		auto const sourceImage = reader(tile);
+		if (sourceImage.size() != tile.size())
+			return false;
+
+		auto const steps = 2.0 + operations.size();
+
+		QImage classifiedImage(tile.size(), QImage::Format_Indexed8);
+		{
+			Concurrency::TransformedProgress progress(observer, 1 / steps, 0);
+			if (rgb)
+			{
+				RGBClassificationMapper(colors)(sourceImage, classifiedImage, progress);
+			}
+			else
+			{
+				std::vector<OrganizableElement*> classes(colors.size());
+				for (std::size_t i = 0; i < colors.size(); i++)
+					classes[i] = colors[i].get();
+				KohonenMap km;
+				km.setClasses(classes);
+				ClassificationMapper(colors, km)(sourceImage, classifiedImage, progress);
+			}
+		}
+
+		QImage bwImage(tile.size(), QImage::Format_Mono);
+		bwImage.setColorTable(outputImage.colorTable());
+		{
+			Concurrency::TransformedProgress progress(observer, 1 / steps, 100 / steps);
+			BWMapper(selectedColors)(classifiedImage, bwImage, progress);
+		}
+		classifiedImage = {};
+
+		for (std::size_t i = 0; i < operations.size(); i++)
+		{
+			auto const operation = morphologicalOperation(operations[i]);
+			if (!operation)
+				continue;
+			Concurrency::TransformedProgress progress(observer, 1 / steps, (2 + i) * 100 / steps);
+			Morphology morphology(bwImage);
+			if (!(morphology.*operation)(&progress))
+				return false;
+			bwImage = morphology.getImage();
+		}
+		if (observer.isInterruptionRequested())
+			return false;
+
+		// The tiles are byte-aligned, cf. ImageTiles::tile_size.
+		auto const dx = core.x() - tile.x();
+		auto const dy = core.y() - tile.y();
+		Q_ASSERT(dx % 8 == 0);
+		auto const bytes = std::size_t((core.width() + 7) / 8);
+		for (int y = 0; y < core.height(); y++)
+			std::memcpy(outputImage.scanLine(y), bwImage.constScanLine(y + dy) + dx / 8, bytes);
+		observer.setPercentage(100);
+		return true;
+	}
+
+	using concurrent_processing = ImageTiles;
+};
+Q_STATIC_ASSERT((Concurrency::supported<TiledBWMapper>::value));
+
+/*! Creates the BW image for a large source image, processing the source in
+ * overlapping tiles.
+ *
+ * This combines the steps of getClassifiedImage(), getBWImage() and
+ * getTransformedImage() for each tile, using the colors which were already
+ * learned or set, e.g. by performClassification() on a reduced copy of the
+ * source image. Only the tiles which are processed at the moment are held
+ * in memory, together with the resulting image which uses a single bit per
+ * pixel. The tiles overlap by ImageTiles::overlap pixels, so erosion and
+ * dilation give exactly the same result as for the whole image, and
+ * thinning is not affected by the tile boundaries for lines which are
+ * narrower than the margin. The polygons are to be created from the
+ * resulting image, so that paths crossing tile boundaries stay continuous.
+ *
+ * \param[in] reader Function returning a region of the source image. It is
+ *            called concurrently from several threads.
+ * \param[in] size The size of the source image.
+ * \param[in] selectedColors Boolean array where true means color is selected.
+ * \param[in] operations The morphological operations to be applied in turn.
+ * \param[in] progressObserver Progress observer.
+ * 
+eturn The BW image, or a null image on error or cancellation.
+ */
+QImage Vectorizer::getTiledBWImage(const SourceReader& reader, const QSize& size,
+                                   const std::vector<bool>& selectedColors,
+                                   const std::vector<MorphologicalOperation>& operations,
+                                   ProgressObserver* progressObserver) const
+{
+	if (sourceImageColors.empty() || !sourceImageColors.front()
+	    || selectedColors.size() < sourceImageColors.size())
+		return {};
+
+	QImage outputImage(size, QImage::Format_Mono);
+	if (outputImage.isNull())
+		return outputImage;
+	outputImage.setColorTable(
+		QVector<QRgb>{QColor(Qt::white).rgb(), QColor(Qt::black).rgb()});
+
+	auto mapFunctor = TiledBWMapper(reader, sourceImageColors, selectedColors, operations,
+	                                colorSpace == COLSPC_RGB && p == 2);
+	auto results = Concurrency::process<bool>(progressObserver, mapFunctor, outputImage);
+	if ((progressObserver && progressObserver->isInterruptionRequested())
+	    || !std::all_of(begin(results), end(results), [](auto& job) { return job.future.result(); }))
+		outputImage = {};
+
+	return outputImage;
+}
+
+/*! Returns a SourceReader for an image file.
+ *
+ * The reader loads only the requested rectangle if the image format
+ * supports clipping while reading. Otherwise, Qt loads the whole image
+ * for each call, only to return the requested part.
+ */
+Vectorizer::SourceReader Vectorizer::fileReader(const QString& path)
+{
+	return [path](const QRect& rect) -> QImage {
+		QImageReader reader(path);
+		reader.setClipRect(rect);
+		return reader.read();
+	};
+}
+
 
 } // cove
 
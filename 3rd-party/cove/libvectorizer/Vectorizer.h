@@ -21,15 +21,21 @@
 #ifndef COVE_VECTORIZER_H
 #define COVE_VECTORIZER_H
 
+#include <functional>
 #include <memory>
 #include <vector>
 
 #include <QImage>
 #include <QRgb>
 
+class QRect;
+class QSize;
+class QString;
+
 #include "MapColor.h"
 
 namespace cove {
+class GpuCompute;
 class ProgressObserver;
 
 class Vectorizer
@@ -62,6 +68,8 @@ public:
 		THINNING_ROSENFELD,
 		PRUNING
 	};
+	/*! A function returning the given rectangle of a source image. */
+	using SourceReader = std::function<QImage (const QRect&)>;
 
 protected:
 	QImage sourceImage;
@@ -77,6 +85,7 @@ protected:
 	ColorSpace colorSpace;
 	AlphaStrategy alphaStrategy;
 	PatternStrategy patternStrategy;
+	const GpuCompute* gpuCompute;
 
 	void deleteColorsTable();
 
@@ -94,6 +103,7 @@ public:
 	virtual void setE(int E);
 	virtual void setNumberOfColors(int nColors);
 	virtual void setInitColors(const std::vector<QRgb>& initColors);
+	void setGpuCompute(const GpuCompute* gpuCompute);
 	virtual bool performClassification(ProgressObserver* progressObserver = nullptr);
 	std::vector<QRgb> getClassifiedColors();
 	virtual QImage getClassifiedImage(double* qualityPtr = nullptr,
@@ -103,7 +113,13 @@ public:
 	virtual QImage getTransformedImage(MorphologicalOperation mo,
 	                                   ProgressObserver* progressObserver = nullptr);
 	static QImage getTransformedImage(const QImage& bwImage, MorphologicalOperation mo,
-	                                  ProgressObserver* progressObserver = nullptr);
+	                                  ProgressObserver* progressObserver = nullptr,
+	                                  const GpuCompute* gpuCompute = nullptr);
+	QImage getTiledBWImage(const SourceReader& reader, const QSize& size,
+	                       const std::vector<bool>& selectedColors,
+	                       const std::vector<MorphologicalOperation>& operations,
+	                       ProgressObserver* progressObserver = nullptr) const;
+	static SourceReader fileReader(const QString& path);
 };
 } // cove
 
@@ -0,0 +1,119 @@
+/*
+ * Copyright 2026 The OpenOrienteering developers
+ *
+ * This file is part of CoVe.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <random>
+
+#include <QtTest>
+#include <QImage>
+#include <QObject>
+#include <QRgb>
+
+#include "libvectorizer/FIRFilter.h"
+
+using namespace cove;
+
+namespace {
+
+/**
+ * A filter which always applies the full matrix, pixel by pixel.
+ */
+class ReferenceFIRFilter : public FIRFilter
+{
+public:
+	explicit ReferenceFIRFilter(const FIRFilter& filter)
+	    : FIRFilter(filter)
+	{
+		kernel.clear();
+	}
+};
+
+
+QImage makeImage()
+{
+	// A height which is not a multiple of the stripe height, with noise
+	auto image = QImage(123, 77, QImage::Format_RGB32);
+	std::mt19937 generator(1);
+	std::uniform_int_distribution<int> noise(0, 255);
+	for (int y = 0; y < image.height(); ++y)
+	{
+		for (int x = 0; x < image.width(); ++x)
+			image.setPixel(x, y, qRgb(noise(generator), (x * 255) / image.width(), noise(generator) / 4));
+	}
+	return image;
+}
+
+int maxDifference(const QImage& a, const QImage& b)
+{
+	int result = 0;
+	for (int y = 0; y < a.height(); ++y)
+	{
+		for (int x = 0; x < a.width(); ++x)
+		{
+			auto const p = a.pixel(x, y);
+			auto const q = b.pixel(x, y);
+			result = std::max({ result,
+			                    std::abs(qRed(p) - qRed(q)),
+			                    std::abs(qGreen(p) - qGreen(q)),
+			                    std::abs(qBlue(p) - qBlue(q)) });
+		}
+	}
+	return result;
+}
+
+}  // namespace
+
+
+
+class FIRFilterTest : public QObject
+{
+	Q_OBJECT
+	
+private slots:
+	void separableTest_data()
+	{
+		QTest::addColumn<int>("radius");
+		QTest::addColumn<bool>("binomic");
+		QTest::newRow("binomic 3x3") << 2 << true;
+		QTest::newRow("binomic 5x5") << 3 << true;
+		QTest::newRow("box 3x3") << 2 << false;
+		QTest::newRow("box 5x5") << 3 << false;
+	}
+	
+	void separableTest()
+	{
+		QFETCH(int, radius);
+		QFETCH(bool, binomic);
+		
+		auto filter = binomic ? FIRFilter(unsigned(radius)).binomic() : FIRFilter(unsigned(radius)).box();
+		auto reference = ReferenceFIRFilter(filter);
+		
+		auto const image = makeImage();
+		auto const expected = reference.apply(image, qRgb(127, 127, 127));
+		auto const actual = filter.apply(image, qRgb(127, 127, 127));
+		QCOMPARE(actual.size(), expected.size());
+		// The order of summation differs.
+		QVERIFY(maxDifference(actual, expected) <= 1);
+	}
+	
+};
+
+QTEST_GUILESS_MAIN(FIRFilterTest)
+#include "FIRFilterTest.moc"  // IWYU pragma: keep
@@ -0,0 +1,146 @@
+/*
+ * Copyright 2026 The OpenOrienteering developers
+ *
+ * This file is part of CoVe.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <QtTest>
+#include <QImage>
+#include <QObject>
+#include <QRgb>
+
+#include "libvectorizer/GpuCompute.h"
+#include "libvectorizer/Morphology.h"
+#include "libvectorizer/Vectorizer.h"
+
+using namespace cove;
+
+namespace {
+
+QImage makeColorImage()
+{
+	auto image = QImage(301, 203, QImage::Format_RGB32);
+	std::mt19937 generator(1);
+	std::uniform_int_distribution<int> channel(0, 255);
+	for (int y = 0; y < image.height(); ++y)
+	{
+		for (int x = 0; x < image.width(); ++x)
+			image.setPixel(x, y, qRgb(channel(generator), channel(generator), channel(generator)));
+	}
+	return image;
+}
+
+QImage makeBWImage()
+{
+	// A width which is not a multiple of 32, with blobs and noise
+	auto image = QImage(150, 90, QImage::Format_Mono);
+	image.setColorCount(2);
+	image.setColor(0, qRgb(255, 255, 255));
+	image.setColor(1, qRgb(0, 0, 0));
+	image.fill(0);
+	
+	std::mt19937 generator(1);
+	std::uniform_int_distribution<int> noise(0, 9);
+	for (int y = 0; y < image.height(); ++y)
+	{
+		for (int x = 0; x < image.width(); ++x)
+		{
+			auto const in_blob = (x - 40) * (x - 40) + (y - 45) * (y - 45) < 900
+			                     || (x > 70 && x < 149 && y > 20 && y < 30);
+			if (in_blob || noise(generator) == 0)
+				image.setPixel(x, y, 1);
+		}
+	}
+	return image;
+}
+
+}  // namespace
+
+
+
+/**
+ * Tests that the GPU backend gives the same results as the CPU.
+ * 
+ * The colors have integer coordinates, so that the single precision
+ * distances of the GPU are exact.
+ */
+class GpuComputeTest : public QObject
+{
+	Q_OBJECT
+	
+	std::unique_ptr<GpuCompute> gpu;
+	
+private slots:
+	void initTestCase()
+	{
+		gpu = std::make_unique<GpuCompute>();
+	}
+	
+	void classificationTest()
+	{
+		if (!gpu->isAvailable())
+			QSKIP("No compute shader support");
+		
+		auto image = makeColorImage();
+		auto const colors = std::vector<QRgb> {
+			qRgb(10, 20, 30), qRgb(200, 100, 50), qRgb(90, 220, 160), qRgb(250, 250, 250), qRgb(128, 128, 128)
+		};
+		
+		Vectorizer cpu(image);
+		cpu.setNumberOfColors(int(colors.size()));
+		cpu.setInitColors(colors);
+		double cpu_quality = 0;
+		auto const expected = cpu.getClassifiedImage(&cpu_quality);
+		
+		Vectorizer vectorizer(image);
+		vectorizer.setNumberOfColors(int(colors.size()));
+		vectorizer.setInitColors(colors);
+		vectorizer.setGpuCompute(gpu.get());
+		double quality = 0;
+		auto const actual = vectorizer.getClassifiedImage(&quality);
+		
+		QCOMPARE(actual, expected);
+		QVERIFY(qAbs(quality - cpu_quality) <= 1e-5 * cpu_quality);
+	}
+	
+	void morphologyTest()
+	{
+		if (!gpu->isAvailable())
+			QSKIP("No compute shader support");
+		
+		auto const image = makeBWImage();
+		using Operation = bool (Morphology::*)(ProgressObserver*);
+		for (auto operation : { Operation(&Morphology::erosion), Operation(&Morphology::dilation),
+		                        Operation(&Morphology::pruning), Operation(&Morphology::rosenfeld) })
+		{
+			Morphology cpu(image);
+			QVERIFY((cpu.*operation)(nullptr));
+			
+			Morphology morphology(image);
+			morphology.setGpuCompute(gpu.get());
+			QVERIFY((morphology.*operation)(nullptr));
+			QCOMPARE(morphology.getImage(), cpu.getImage());
+		}
+	}
+	
+};
+
+QTEST_MAIN(GpuComputeTest)
+#include "GpuComputeTest.moc"  // IWYU pragma: keep
@@ -0,0 +1,175 @@
+/*
+ * Copyright 2026 The OpenOrienteering developers
+ *
+ * This file is part of CoVe.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <random>
+
+#include <QtTest>
+#include <QImage>
+#include <QObject>
+
+#include "libvectorizer/Morphology.h"
+
+using namespace cove;
+
+namespace {
+
+/**
+ * A straightforward implementation of the morphological operations,
+ * evaluating the tables pixel by pixel.
+ */
+class ReferenceMorphology : public Morphology
+{
+public:
+	static int pixel(const QImage& image, int x, int y)
+	{
+		if (x < 0 || y < 0 || x >= image.width() || y >= image.height())
+			return 0;
+		return image.pixelIndex(x, y) ? 1 : 0;
+	}
+	
+	static int apply(const QImage& source, QImage& target, const bool* table, bool insert, unsigned int mask = 0)
+	{
+		int count = 0;
+		for (int y = 0; y < source.height(); ++y)
+		{
+			for (int x = 0; x < source.width(); ++x)
+			{
+				unsigned int p = 0;
+				for (int dy = -1; dy <= 1; ++dy)
+				{
+					for (int dx = -1; dx <= 1; ++dx)
+						p = (p << 1) | unsigned(pixel(source, x + dx, y + dy));
+				}
+				if ((p & mask) == 0 && table[p])
+				{
+					target.setPixel(x, y, insert ? 1 : 0);
+					++count;
+				}
+			}
+		}
+		return count;
+	}
+	
+	static QImage erosion(const QImage& image)
+	{
+		auto result = image.copy();
+		apply(image, result, isDeletable, false);
+		return result;
+	}
+	
+	static QImage dilation(const QImage& image)
+	{
+		auto result = image.copy();
+		apply(image, result, isInsertable, true);
+		return result;
+	}
+	
+	static QImage pruning(const QImage& image)
+	{
+		auto result = image.copy();
+		apply(image, result, isPrunable, false);
+		return result;
+	}
+	
+	static QImage rosenfeld(const QImage& image)
+	{
+		auto current = image.copy();
+		int count;
+		do
+		{
+			count = 0;
+			for (auto const m : masks)
+			{
+				auto next = current.copy();
+				count += apply(current, next, todelete, false, m);
+				current = next;
+			}
+		}
+		while (count);
+		return current;
+	}
+};
+
+
+QImage makeImage(QImage::Format format)
+{
+	// A width which is not a multiple of 64, with blobs and noise
+	auto image = QImage(150, 90, format);
+	image.setColorCount(2);
+	image.setColor(0, qRgb(255, 255, 255));
+	image.setColor(1, qRgb(0, 0, 0));
+	image.fill(0);
+	
+	std::mt19937 generator(1);
+	std::uniform_int_distribution<int> noise(0, 9);
+	for (int y = 0; y < image.height(); ++y)
+	{
+		for (int x = 0; x < image.width(); ++x)
+		{
+			auto const in_blob = (x - 40) * (x - 40) + (y - 45) * (y - 45) < 900
+			                     || (x > 70 && x < 149 && y > 20 && y < 30);
+			if (in_blob || noise(generator) == 0)
+				image.setPixel(x, y, 1);
+		}
+	}
+	return image;
+}
+
+}  // namespace
+
+
+
+class MorphologyTest : public QObject
+{
+	Q_OBJECT
+	
+private slots:
+	void operationsTest_data()
+	{
+		QTest::addColumn<int>("format");
+		QTest::newRow("Mono") << int(QImage::Format_Mono);
+		QTest::newRow("MonoLSB") << int(QImage::Format_MonoLSB);
+	}
+	
+	void operationsTest()
+	{
+		QFETCH(int, format);
+		auto const image = makeImage(QImage::Format(format));
+		
+		Morphology erosion(image);
+		QVERIFY(erosion.erosion());
+		QCOMPARE(erosion.getImage(), ReferenceMorphology::erosion(image));
+		
+		Morphology dilation(image);
+		QVERIFY(dilation.dilation());
+		QCOMPARE(dilation.getImage(), ReferenceMorphology::dilation(image));
+		
+		Morphology pruning(image);
+		QVERIFY(pruning.pruning());
+		QCOMPARE(pruning.getImage(), ReferenceMorphology::pruning(image));
+		
+		Morphology thinning(image);
+		QVERIFY(thinning.rosenfeld());
+		QCOMPARE(thinning.getImage(), ReferenceMorphology::rosenfeld(image));
+	}
+	
+};
+
+QTEST_GUILESS_MAIN(MorphologyTest)
+#include "MorphologyTest.moc"  // IWYU pragma: keep
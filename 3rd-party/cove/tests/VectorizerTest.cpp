@@ -0,0 +1,126 @@
+/*
+ * Copyright 2026 The OpenOrienteering developers
+ *
+ * This file is part of CoVe.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <random>
+#include <vector>
+
+#include <QtTest>
+#include <QColor>
+#include <QImage>
+#include <QObject>
+#include <QRect>
+#include <QRgb>
+
+#include "libvectorizer/Vectorizer.h"
+
+using namespace cove;
+
+namespace {
+
+const std::vector<QRgb> colors = { qRgb(255, 255, 255), qRgb(0, 0, 0), qRgb(20, 60, 230), qRgb(230, 120, 30) };
+
+QImage makeImage()
+{
+	// Larger than a couple of tiles, with a size which is not a multiple of the tile size
+	auto image = QImage(2600, 1300, QImage::Format_RGB32);
+	std::mt19937 generator(1);
+	std::uniform_int_distribution<int> noise(-30, 30);
+	std::uniform_int_distribution<int> color(0, int(colors.size()) - 1);
+	for (int y = 0; y < image.height(); ++y)
+	{
+		auto* line = reinterpret_cast<QRgb*>(image.scanLine(y));
+		for (int x = 0; x < image.width(); ++x)
+		{
+			// Stripes crossing the tile boundaries, and noise
+			auto base = colors[0];
+			if ((x + 2 * y) % 97 < 5)
+				base = colors[1];
+			else if ((3 * x - y + 3000) % 211 < 40)
+				base = colors[2];
+			else if (noise(generator) > 28)
+				base = colors[std::size_t(color(generator))];
+			line[x] = qRgb(qBound(0, qRed(base) + noise(generator), 255),
+			               qBound(0, qGreen(base) + noise(generator), 255),
+			               qBound(0, qBlue(base) + noise(generator), 255));
+		}
+	}
+	return image;
+}
+
+}  // namespace
+
+
+
+class VectorizerTest : public QObject
+{
+	Q_OBJECT
+	
+private slots:
+	void tiledBWImageTest_data()
+	{
+		QTest::addColumn<int>("colorSpace");
+		QTest::addColumn<double>("p");
+		QTest::newRow("RGB, p=2") << int(Vectorizer::COLSPC_RGB) << 2.0;
+		QTest::newRow("RGB, p=1") << int(Vectorizer::COLSPC_RGB) << 1.0;
+		QTest::newRow("HSV, p=2") << int(Vectorizer::COLSPC_HSV) << 2.0;
+	}
+	
+	void tiledBWImageTest()
+	{
+		QFETCH(int, colorSpace);
+		QFETCH(double, p);
+		
+		auto image = makeImage();
+		Vectorizer vectorizer(image);
+		vectorizer.setColorSpace(Vectorizer::ColorSpace(colorSpace));
+		vectorizer.setP(p);
+		vectorizer.setNumberOfColors(int(colors.size()));
+		vectorizer.setInitColors(colors);
+		
+		auto const selectedColors = std::vector<bool> { false, true, true, false };
+		QVERIFY(!vectorizer.getClassifiedImage().isNull());
+		auto const bwImage = vectorizer.getBWImage(selectedColors);
+		QVERIFY(!bwImage.isNull());
+		
+		auto reader = [&image](const QRect& rect) { return image.copy(rect); };
+		QCOMPARE(vectorizer.getTiledBWImage(reader, image.size(), selectedColors, {}), bwImage);
+		
+		auto const operations = std::vector<Vectorizer::MorphologicalOperation> { Vectorizer::EROSION, Vectorizer::DILATION };
+		auto expected = bwImage;
+		for (auto const operation : operations)
+			expected = Vectorizer::getTransformedImage(expected, operation);
+		QCOMPARE(vectorizer.getTiledBWImage(reader, image.size(), selectedColors, operations), expected);
+	}
+	
+	void tiledBWImageErrorTest()
+	{
+		auto image = makeImage();
+		Vectorizer vectorizer(image);
+		vectorizer.setNumberOfColors(int(colors.size()));
+		vectorizer.setInitColors(colors);
+		
+		auto const selectedColors = std::vector<bool> { false, true, true, false };
+		auto failing_reader = [&image](const QRect& rect) { return rect.y() > 0 ? QImage() : image.copy(rect); };
+		QVERIFY(vectorizer.getTiledBWImage(failing_reader, image.size(), selectedColors, {}).isNull());
+	}
+	
+};
+
+QTEST_GUILESS_MAIN(VectorizerTest)
+#include "VectorizerTest.moc"  // IWYU pragma: keep
@@ -76,6 +76,37 @@ public class MapperActivity extends org.qtproject.qt5.android.bindings.QtActivit
 		setIntent(intent);
 	}
 	
+	/** Lets the native caches release memory when the system asks for it. */
+	@Override
+	public void onTrimMemory(int level)
+	{
+		super.onTrimMemory(level);
+		trimMemory(level);
+	}
+	
+	/** Lets the native caches release as much memory as possible. */
+	@Override
+	public void onLowMemory()
+	{
+		super.onLowMemory();
+		trimMemory(TRIM_MEMORY_COMPLETE);
+	}
+	
+	private static void trimMemory(int level)
+	{
+		try
+		{
+			trimMemoryNative(level);
+		}
+		catch (UnsatisfiedLinkError e)
+		{
+			// The native library is not loaded yet.
+		}
+	}
+	
+	/** Implemented in CacheManager. */
+	private static native void trimMemoryNative(int level);
+	
 	/** Returns the data string from the intent, and resets the intent. */
 	public String takeIntentPath()
 	{
@@ -25,6 +25,7 @@
 #include <utility>
 
 #include <QtGlobal>
+#include <QHash>
 #include <QLatin1Char>
 
 
@@ -111,29 +112,46 @@ QString CRSTemplate::coordinatesName(const std::vector<QString>& values) const
 
 // ### CRSTemplateRegistry ###
 
+/**
+ * The list of templates, and an index by template id.
+ */
+struct CRSTemplateRegistry::Directory
+{
+	TemplateList templates;
+	QHash<QString, const CRSTemplate*> index;
+	
+	Directory()
+	: templates(CRSTemplates::defaultList())
+	{
+		index.reserve(int(templates.size()));
+		for (auto const& temp : templates)
+			index.insert(temp->id(), temp.get());
+	}
+};
+
+
 CRSTemplateRegistry::CRSTemplateRegistry()
 {
-	static auto shared_list = CRSTemplates::defaultList();
-	this->templates = &shared_list;
+	static Directory shared_directory;
+	this->directory = &shared_directory;
+}
+
+const CRSTemplateRegistry::TemplateList& CRSTemplateRegistry::list() const
+{
+	return directory->templates;
 }
 
 const CRSTemplate* CRSTemplateRegistry::find(const QString& id) const
 {
-	const CRSTemplate* ret = nullptr;
-	for (auto&& temp : *templates)
-	{
-		if (temp->id() == id) {
-			ret = temp.get();
-			break;
-		}
-			
-	}
-	return ret;
+	return directory->index.value(id, nullptr);
 }
 
 void CRSTemplateRegistry::add(std::unique_ptr<const CRSTemplate> temp)
 {
-	templates->push_back(std::move(temp));
+	Q_ASSERT(temp);
+	if (!directory->index.contains(temp->id()))
+		directory->index.insert(temp->id(), temp.get());
+	directory->templates.push_back(std::move(temp));
 }
 
 
@@ -230,7 +230,9 @@ private:
 /**
  * A directory of known CRS templates.
  * 
- * All instances of this class provide access to the same list.
+ * All instances of this class provide access to the same list. The list is
+ * created when the directory is accessed for the first time, together with
+ * an index for finding templates by id.
  */
 class CRSTemplateRegistry
 {
@@ -250,6 +252,8 @@ public:
 	/**
 	 * Finds the registered CRS template with the given id,
 	 * or returns nullptr if the given id does not exist.
+	 * 
+	 * This is a lookup in the index, not a search of the list.
 	 */
 	const CRSTemplate* find(const QString& id) const;
 	
@@ -262,7 +266,9 @@ public:
 	void add(std::unique_ptr<const CRSTemplate> temp);
 	
 private:
-	TemplateList* templates;
+	struct Directory;
+	
+	Directory* directory;
 };
 
 
@@ -311,15 +317,6 @@ const CRSTemplate::ParameterList& CRSTemplate::parameters() const
 
 
 
-//### CRSTemplateRegistry inline code ###
-
-inline
-const CRSTemplateRegistry::TemplateList& CRSTemplateRegistry::list() const
-{
-	return *templates;
-}
-
-
 }  // namespace OpenOrienteering
 
 #endif
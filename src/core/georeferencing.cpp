@@ -22,7 +22,10 @@
 
 #include <algorithm>
 #include <cmath> // IWYU pragma: keep
+#include <cstddef>
 #include <iterator>
+#include <memory>
+#include <mutex>
 #include <utility>
 
 #include <QtGlobal>
@@ -31,6 +34,7 @@
 #include <QDebug>
 #include <QDir> // IWYU pragma: keep
 #include <QFileInfo>
+#include <QHash>
 #include <QLatin1String>
 #include <QLocale>
 #include <QPoint>
@@ -284,6 +288,39 @@ LatLon ProjTransform::inverse(const QPointF& projected_coords, bool* ok) const
 	return LatLon::fromRadiant(northing, easting);
 }
 
+bool ProjTransform::forward(double* x, double* y, std::size_t count) const
+{
+	static auto const geographic_crs = ProjTransform(Georeferencing::geographic_crs_spec);
+	
+	if (count == 0)
+		return true;
+	
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		x[i] = qDegreesToRadians(x[i]);
+		y[i] = qDegreesToRadians(y[i]);
+	}
+	return geographic_crs.isValid()
+	       && pj_transform(geographic_crs.pj, pj, long(count), 1, x, y, nullptr) == 0;
+}
+
+bool ProjTransform::inverse(double* x, double* y, std::size_t count) const
+{
+	static auto const geographic_crs = ProjTransform(Georeferencing::geographic_crs_spec);
+	
+	if (count == 0)
+		return true;
+	
+	auto const ok = geographic_crs.isValid()
+	                && pj_transform(pj, geographic_crs.pj, long(count), 1, x, y, nullptr) == 0;
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		x[i] = qRadiansToDegrees(x[i]);
+		y[i] = qRadiansToDegrees(y[i]);
+	}
+	return ok;
+}
+
 QString ProjTransform::errorText() const
 {
 	auto err_no = *pj_get_errno_ref();
@@ -292,9 +329,43 @@ QString ProjTransform::errorText() const
 
 #else
 
-ProjTransform::ProjTransform(ProjTransformData* pj) noexcept
-: pj{pj}
-{}
+namespace {
+
+/**
+ * The number of cached transformations which are kept while not being used.
+ */
+constexpr int max_unused_proj_transforms = 16;
+
+}  // namespace
+
+
+/**
+ * A PROJ transformation which is shared by ProjTransform objects.
+ * 
+ * Each transformation has its own PROJ context, so that different
+ * transformations can be used concurrently. The mutex serializes
+ * the use of a single transformation.
+ */
+struct ProjTransform::Shared
+{
+	PJ_CONTEXT* ctx = nullptr;
+	PJ* pj = nullptr;
+	QString error;
+	std::mutex mutex;
+	
+	Shared() = default;
+	Shared(const Shared&) = delete;
+	Shared& operator=(const Shared&) = delete;
+	
+	~Shared()
+	{
+		if (pj)
+			proj_destroy(pj);
+		if (ctx)
+			proj_context_destroy(ctx);
+	}
+};
+
 
 ProjTransform::ProjTransform(ProjTransform&& other) noexcept
 {
@@ -303,44 +374,93 @@ ProjTransform::ProjTransform(ProjTransform&& other) noexcept
 
 ProjTransform::ProjTransform(const QString& crs_spec)
 {
-	if (crs_spec.isEmpty())
-		return;
-	
-	auto spec_latin1 = crs_spec.toLatin1();
-#ifdef PROJ_ISSUE_1573
-	// Cf. https://github.com/OSGeo/PROJ/pull/1573
-	spec_latin1.replace("+datum=potsdam", "+ellps=bessel +nadgrids=@BETA2007.gsb");
-#endif
-	pj = proj_create_crs_to_crs(PJ_DEFAULT_CTX, Georeferencing::geographic_crs_spec.toLatin1(), spec_latin1, nullptr);
-	if (pj)
-		operator=({proj_normalize_for_visualization(PJ_DEFAULT_CTX, pj)});
+	if (!crs_spec.isEmpty())
+		shared = lookup(crs_spec);
 }
 
-ProjTransform::~ProjTransform()
-{
-	if (pj)
-		proj_destroy(pj);
-}
+ProjTransform::~ProjTransform() = default;
 
 ProjTransform& ProjTransform::operator=(ProjTransform&& other) noexcept
 {
-	std::swap(pj, other.pj);
+	std::swap(shared, other.shared);
 	return *this;
 }
 
+// static
+std::shared_ptr<ProjTransform::Shared> ProjTransform::lookup(const QString& crs_spec)
+{
+	static std::mutex cache_mutex;
+	static QHash<QString, std::shared_ptr<Shared>> cache;
+	
+	std::lock_guard<std::mutex> lock(cache_mutex);
+	auto found = cache.constFind(crs_spec);
+	if (found != cache.constEnd())
+		return found.value();
+	
+	if (cache.size() >= max_unused_proj_transforms)
+	{
+		for (auto it = cache.begin(); it != cache.end(); )
+		{
+			if (it.value().use_count() == 1)
+				it = cache.erase(it);
+			else
+				++it;
+		}
+	}
+	
+	// New contexts are initialized from the default context,
+	// i.e. they inherit ProjSetup's configuration.
+	auto result = std::make_shared<Shared>();
+	result->ctx = proj_context_create();
+	if (result->ctx)
+	{
+		auto spec_latin1 = crs_spec.toLatin1();
+#ifdef PROJ_ISSUE_1573
+		// Cf. https://github.com/OSGeo/PROJ/pull/1573
+		spec_latin1.replace("+datum=potsdam", "+ellps=bessel +nadgrids=@BETA2007.gsb");
+#endif
+		if (auto* pj = proj_create_crs_to_crs(result->ctx, Georeferencing::geographic_crs_spec.toLatin1(), spec_latin1, nullptr))
+		{
+			result->pj = proj_normalize_for_visualization(result->ctx, pj);
+			proj_destroy(pj);
+		}
+		if (!result->pj)
+		{
+			auto const err_no = proj_context_errno(result->ctx);
+			if (err_no != 0)
+				result->error = QString::fromLatin1(proj_errno_string(err_no));
+		}
+	}
+	cache.insert(crs_spec, result);
+	return result;
+}
+
 bool ProjTransform::isValid() const noexcept
 {
-	return pj != nullptr;
+	return shared && shared->pj;
 }
 
 bool ProjTransform::isGeographic() const
 {
+	if (!isValid())
+		return false;
+	
 	/// \todo Evaluate proj_get_type() instead
-	return isValid() && proj_angular_output(pj, PJ_FWD);
+	std::lock_guard<std::mutex> lock(shared->mutex);
+	return proj_angular_output(shared->pj, PJ_FWD);
 }
 
 QPointF ProjTransform::forward(const LatLon& lat_lon, bool* ok) const
 {
+	if (!isValid())
+	{
+		if (ok)
+			*ok = false;
+		return {};
+	}
+	
+	std::lock_guard<std::mutex> lock(shared->mutex);
+	auto* pj = shared->pj;
 	proj_errno_reset(pj);
 	auto pj_coord = proj_trans(pj, PJ_FWD, proj_coord(lat_lon.longitude(), lat_lon.latitude(), 0, HUGE_VAL));
 	if (ok)
@@ -350,6 +470,15 @@ QPointF ProjTransform::forward(const LatLon& lat_lon, bool* ok) const
 
 LatLon ProjTransform::inverse(const QPointF& projected_coords, bool* ok) const
 {
+	if (!isValid())
+	{
+		if (ok)
+			*ok = false;
+		return {};
+	}
+	
+	std::lock_guard<std::mutex> lock(shared->mutex);
+	auto* pj = shared->pj;
 	proj_errno_reset(pj);
 	auto pj_coord = proj_trans(pj, PJ_INV, proj_coord(projected_coords.x(), projected_coords.y(), 0, HUGE_VAL));
 	if (ok)
@@ -357,15 +486,94 @@ LatLon ProjTransform::inverse(const QPointF& projected_coords, bool* ok) const
 	return {pj_coord.lp.phi, pj_coord.lp.lam};
 }
 
+bool ProjTransform::forward(double* x, double* y, std::size_t count) const
+{
+	if (!isValid())
+		return false;
+	
+	std::lock_guard<std::mutex> lock(shared->mutex);
+	auto* pj = shared->pj;
+	proj_errno_reset(pj);
+	proj_trans_generic(pj, PJ_FWD,
+	                   x, sizeof(double), count,
+	                   y, sizeof(double), count,
+	                   nullptr, 0, 0,
+	                   nullptr, 0, 0);
+	return proj_errno(pj) == 0;
+}
+
+bool ProjTransform::inverse(double* x, double* y, std::size_t count) const
+{
+	if (!isValid())
+		return false;
+	
+	std::lock_guard<std::mutex> lock(shared->mutex);
+	auto* pj = shared->pj;
+	proj_errno_reset(pj);
+	proj_trans_generic(pj, PJ_INV,
+	                   x, sizeof(double), count,
+	                   y, sizeof(double), count,
+	                   nullptr, 0, 0,
+	                   nullptr, 0, 0);
+	return proj_errno(pj) == 0;
+}
+
 QString ProjTransform::errorText() const
 {
-	auto err_no = proj_errno(pj);
+	if (!shared)
+		return {};
+	
+	std::lock_guard<std::mutex> lock(shared->mutex);
+	if (!shared->pj)
+		return shared->error;
+	
+	auto err_no = proj_errno(shared->pj);
 	return (err_no == 0) ? QString() : QString::fromLatin1(proj_errno_string(err_no));
 }
 
 #endif
 
 
+bool ProjTransform::forward(const std::vector<LatLon>& lat_lon, std::vector<QPointF>& projected) const
+{
+	auto const count = lat_lon.size();
+	std::vector<double> x(count);
+	std::vector<double> y(count);
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		x[i] = lat_lon[i].longitude();
+		y[i] = lat_lon[i].latitude();
+	}
+	
+	auto const ok = forward(x.data(), y.data(), count);
+	
+	projected.resize(count);
+	for (std::size_t i = 0; i < count; ++i)
+		projected[i] = { x[i], y[i] };
+	return ok;
+}
+
+bool ProjTransform::inverse(const std::vector<QPointF>& projected, std::vector<LatLon>& lat_lon) const
+{
+	auto const count = projected.size();
+	std::vector<double> x(count);
+	std::vector<double> y(count);
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		x[i] = projected[i].x();
+		y[i] = projected[i].y();
+	}
+	
+	auto const ok = inverse(x.data(), y.data(), count);
+	
+	lat_lon.clear();
+	lat_lon.reserve(count);
+	for (std::size_t i = 0; i < count; ++i)
+		lat_lon.emplace_back(y[i], x[i]);
+	return ok;
+}
+
+
 
 //### Georeferencing ###
 
@@ -1049,6 +1257,15 @@ QPointF Georeferencing::toProjectedCoords(const MapCoordF& map_coords) const
 	return to_projected.map(map_coords);
 }
 
+std::vector<QPointF> Georeferencing::toProjectedCoords(const std::vector<MapCoordF>& map_coords) const
+{
+	std::vector<QPointF> projected;
+	projected.reserve(map_coords.size());
+	for (const auto& coord : map_coords)
+		projected.push_back(to_projected.map(coord));
+	return projected;
+}
+
 MapCoord Georeferencing::toMapCoords(const QPointF& projected_coords) const
 {
 	return MapCoord(from_projected.map(projected_coords));
@@ -1059,6 +1276,15 @@ MapCoordF Georeferencing::toMapCoordF(const QPointF& projected_coords) const
 	return MapCoordF(from_projected.map(projected_coords));
 }
 
+std::vector<MapCoordF> Georeferencing::toMapCoordF(const std::vector<QPointF>& projected_coords) const
+{
+	std::vector<MapCoordF> map_coords;
+	map_coords.reserve(projected_coords.size());
+	for (const auto& coord : projected_coords)
+		map_coords.emplace_back(from_projected.map(coord));
+	return map_coords;
+}
+
 LatLon Georeferencing::toGeographicCoords(const MapCoordF& map_coords, bool* ok) const
 {
 	return toGeographicCoords(toProjectedCoords(map_coords), ok);
@@ -1069,11 +1295,69 @@ LatLon Georeferencing::toGeographicCoords(const QPointF& projected_coords, bool*
 	return proj_transform.isValid() ? proj_transform.inverse(projected_coords, ok) : LatLon{};
 }
 
+std::vector<LatLon> Georeferencing::toGeographicCoords(const std::vector<MapCoordF>& map_coords, bool* ok) const
+{
+	auto const count = map_coords.size();
+	if (!proj_transform.isValid())
+	{
+		if (ok)
+			*ok = false;
+		return std::vector<LatLon>(count);
+	}
+	
+	std::vector<double> x(count);
+	std::vector<double> y(count);
+	for (std::size_t i = 0; i < count; ++i)
+		to_projected.map(map_coords[i].x(), map_coords[i].y(), &x[i], &y[i]);
+	
+	auto const transformed = proj_transform.inverse(x.data(), y.data(), count);
+	if (ok)
+		*ok = transformed;
+	
+	std::vector<LatLon> lat_lon;
+	lat_lon.reserve(count);
+	for (std::size_t i = 0; i < count; ++i)
+		lat_lon.emplace_back(y[i], x[i]);
+	return lat_lon;
+}
+
+std::vector<LatLon> Georeferencing::toGeographicCoords(const std::vector<QPointF>& projected_coords, bool* ok) const
+{
+	std::vector<LatLon> lat_lon;
+	if (!proj_transform.isValid())
+	{
+		if (ok)
+			*ok = false;
+		lat_lon.resize(projected_coords.size());
+		return lat_lon;
+	}
+	
+	auto const transformed = proj_transform.inverse(projected_coords, lat_lon);
+	if (ok)
+		*ok = transformed;
+	return lat_lon;
+}
+
 QPointF Georeferencing::toProjectedCoords(const LatLon& lat_lon, bool* ok) const
 {
 	return proj_transform.isValid() ? proj_transform.forward(lat_lon, ok) : QPointF{};
 }
 
+std::vector<QPointF> Georeferencing::toProjectedCoords(const std::vector<LatLon>& lat_lon, bool* ok) const
+{
+	std::vector<QPointF> projected;
+	if (!proj_transform.isValid())
+	{
+		projected.resize(lat_lon.size());
+		return projected;
+	}
+	
+	auto const transformed = proj_transform.forward(lat_lon, projected);
+	if (ok)
+		*ok = transformed;
+	return projected;
+}
+
 MapCoord Georeferencing::toMapCoords(const LatLon& lat_lon, bool* ok) const
 {
 	return toMapCoords(toProjectedCoords(lat_lon, ok));
@@ -1084,6 +1368,42 @@ MapCoordF Georeferencing::toMapCoordF(const LatLon& lat_lon, bool* ok) const
 	return toMapCoordF(toProjectedCoords(lat_lon, ok));
 }
 
+std::vector<MapCoordF> Georeferencing::toMapCoordF(const std::vector<LatLon>& lat_lon, bool* ok) const
+{
+	auto const count = lat_lon.size();
+	std::vector<double> x(count);
+	std::vector<double> y(count);
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		x[i] = lat_lon[i].longitude();
+		y[i] = lat_lon[i].latitude();
+	}
+	
+	auto transformed = proj_transform.isValid();
+	if (transformed)
+	{
+		transformed = proj_transform.forward(x.data(), y.data(), count);
+	}
+	else
+	{
+		x.assign(count, 0.0);
+		y.assign(count, 0.0);
+	}
+	if (ok)
+		*ok = transformed;
+	
+	// The affine transformation is applied while collecting the results.
+	std::vector<MapCoordF> map_coords;
+	map_coords.reserve(count);
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		qreal map_x, map_y;
+		from_projected.map(x[i], y[i], &map_x, &map_y);
+		map_coords.emplace_back(map_x, map_y);
+	}
+	return map_coords;
+}
+
 MapCoordF Georeferencing::toMapCoordF(const Georeferencing* other, const MapCoordF& map_coords, bool* ok) const
 {
 	if (!other)
@@ -1115,6 +1435,50 @@ MapCoordF Georeferencing::toMapCoordF(const Georeferencing* other, const MapCoor
 	return toMapCoordF(projected);
 }
 
+std::vector<MapCoordF> Georeferencing::toMapCoordF(const Georeferencing* other, const std::vector<MapCoordF>& map_coords, bool* ok) const
+{
+	if (!other)
+	{
+		if (ok)
+			*ok = true;
+		return map_coords;
+	}
+	
+	if (isLocal() || other->isLocal())
+	{
+		if (ok)
+			*ok = true;
+		return toMapCoordF(other->toProjectedCoords(map_coords));
+	}
+	
+	auto const count = map_coords.size();
+	std::vector<double> x(count);
+	std::vector<double> y(count);
+	for (std::size_t i = 0; i < count; ++i)
+		other->to_projected.map(map_coords[i].x(), map_coords[i].y(), &x[i], &y[i]);
+	
+	auto transformed = proj_transform.isValid() && other->proj_transform.isValid();
+	if (transformed)
+	{
+		// Cf. the intermediate WGS84 step in the single coordinate variant.
+		// The arrays hold geographic coordinates between the two calls.
+		transformed = other->proj_transform.inverse(x.data(), y.data(), count);
+		transformed = proj_transform.forward(x.data(), y.data(), count) && transformed;
+	}
+	if (ok)
+		*ok = transformed;
+	
+	std::vector<MapCoordF> result;
+	result.reserve(count);
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		qreal map_x, map_y;
+		from_projected.map(x[i], y[i], &map_x, &map_y);
+		result.emplace_back(map_x, map_y);
+	}
+	return result;
+}
+
 QString Georeferencing::getErrorText() const
 {
 	return proj_transform.errorText();
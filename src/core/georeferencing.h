@@ -22,6 +22,8 @@
 #define OPENORIENTEERING_GEOREFERENCING_H
 
 #include <cmath>
+#include <cstddef>
+#include <memory>
 #include <vector>
 
 #include <QObject>
@@ -48,6 +50,12 @@ namespace OpenOrienteering {
 
 /**
  * A utility which encapsulates PROJ API variants and resource management.
+ * 
+ * With the current PROJ API, the transformations are created once per CRS
+ * spec and shared by all ProjTransform objects for this spec, including
+ * the ones used by other threads. Creating transformations is expensive
+ * when grid files are involved, but Georeferencing objects are created and
+ * copied frequently, e.g. for templates.
  */
 struct ProjTransform
 {
@@ -66,12 +74,58 @@ struct ProjTransform
 	QPointF forward(const LatLon& lat_lon, bool* ok) const;
 	LatLon inverse(const QPointF& projected, bool* ok) const;
 	
+	/**
+	 * Transforms a batch of geographic coordinates in a single call to PROJ.
+	 * 
+	 * Returns false if any of the coordinates could not be transformed.
+	 */
+	bool forward(const std::vector<LatLon>& lat_lon, std::vector<QPointF>& projected) const;
+	
+	/**
+	 * Transforms a batch of projected coordinates in a single call to PROJ.
+	 * 
+	 * Returns false if any of the coordinates could not be transformed.
+	 */
+	bool inverse(const std::vector<QPointF>& projected, std::vector<LatLon>& lat_lon) const;
+	
+	/**
+	 * Transforms arrays of geographic coordinates in place.
+	 * 
+	 * On input, x and y hold longitudes and latitudes in degrees.
+	 * On output, they hold eastings and northings.
+	 * 
+	 * Returns false if any of the coordinates could not be transformed.
+	 */
+	bool forward(double* x, double* y, std::size_t count) const;
+	
+	/**
+	 * Transforms arrays of projected coordinates in place.
+	 * 
+	 * On input, x and y hold eastings and northings.
+	 * On output, they hold longitudes and latitudes in degrees.
+	 * 
+	 * Returns false if any of the coordinates could not be transformed.
+	 */
+	bool inverse(double* x, double* y, std::size_t count) const;
+	
 	QString errorText() const;
 	
 private:
+#ifdef ACCEPT_USE_OF_DEPRECATED_PROJ_API_H
 	ProjTransform(ProjTransformData* pj) noexcept;
 	
 	ProjTransformData* pj = nullptr;
+#else
+	struct Shared;
+	
+	/**
+	 * Returns the shared transformation for the given CRS spec,
+	 * creating it when needed.
+	 */
+	static std::shared_ptr<Shared> lookup(const QString& crs_spec);
+	
+	std::shared_ptr<Shared> shared;
+#endif
 	
 };
 
@@ -463,6 +517,11 @@ public:
 	 */
 	QPointF toProjectedCoords(const MapCoordF& map_coords) const;
 	
+	/**
+	 * Transforms a batch of map (paper) coordinates to projected coordinates.
+	 */
+	std::vector<QPointF> toProjectedCoords(const std::vector<MapCoordF>& map_coords) const;
+	
 	/**
 	 * Transforms projected coordinates to map (paper) coordinates.
 	 */
@@ -473,6 +532,11 @@ public:
 	 */
 	MapCoordF toMapCoordF(const QPointF& projected_coords) const;
 	
+	/**
+	 * Transforms a batch of projected coordinates to map (paper) coordinates.
+	 */
+	std::vector<MapCoordF> toMapCoordF(const std::vector<QPointF>& projected_coords) const;
+	
 	
 	/**
 	 * Transforms map (paper) coordinates to geographic coordinates (lat/lon).
@@ -484,11 +548,33 @@ public:
 	 */
 	LatLon toGeographicCoords(const QPointF& projected_coords, bool* ok = 0) const;
 	
+	/**
+	 * Transforms a batch of map (paper) coordinates to geographic coordinates (lat/lon).
+	 * 
+	 * The affine transformation to projected coordinates is applied while
+	 * preparing the data for PROJ, which transforms all points in one call.
+	 */
+	std::vector<LatLon> toGeographicCoords(const std::vector<MapCoordF>& map_coords, bool* ok = nullptr) const;
+	
+	/**
+	 * Transforms a batch of CRS coordinates to geographic coordinates (lat/lon).
+	 * 
+	 * This is much faster than transforming each coordinate on its own.
+	 */
+	std::vector<LatLon> toGeographicCoords(const std::vector<QPointF>& projected_coords, bool* ok = nullptr) const;
+	
 	/**
 	 * Transforms geographic coordinates (lat/lon) to CRS coordinates.
 	 */
 	QPointF toProjectedCoords(const LatLon& lat_lon, bool* ok = 0) const;
 	
+	/**
+	 * Transforms a batch of geographic coordinates (lat/lon) to CRS coordinates.
+	 * 
+	 * This is much faster than transforming each coordinate on its own.
+	 */
+	std::vector<QPointF> toProjectedCoords(const std::vector<LatLon>& lat_lon, bool* ok = nullptr) const;
+	
 	/**
 	 * Transforms geographic coordinates (lat/lon) to map coordinates.
 	 */
@@ -499,6 +585,13 @@ public:
 	 */
 	MapCoordF toMapCoordF(const LatLon& lat_lon, bool* ok = nullptr) const;
 	
+	/**
+	 * Transforms a batch of geographic coordinates (lat/lon) to map coordinates.
+	 * 
+	 * This is much faster than transforming each coordinate on its own.
+	 */
+	std::vector<MapCoordF> toMapCoordF(const std::vector<LatLon>& lat_lon, bool* ok = nullptr) const;
+	
 	
 	/**
 	 * Transforms map coordinates from the other georeferencing to
@@ -506,6 +599,12 @@ public:
 	 */
 	MapCoordF toMapCoordF(const Georeferencing* other, const MapCoordF& map_coords, bool* ok = nullptr) const;
 	
+	/**
+	 * Transforms a batch of map coordinates from the other georeferencing
+	 * to map coordinates of this georeferencing, if possible.
+	 */
+	std::vector<MapCoordF> toMapCoordF(const Georeferencing* other, const std::vector<MapCoordF>& map_coords, bool* ok = nullptr) const;
+	
 	
 	/**
 	 * Returns the current error text.
@@ -23,9 +23,13 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstddef>
 #include <iterator>
+#include <limits>
 #include <memory>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
 #include <Qt>
 #include <QtGlobal>
@@ -33,11 +37,16 @@
 #include <QByteArray>
 #include <QDebug>
 #include <QIODevice>
+#include <QImage>
 #include <QPaintEngine>
 #include <QPainter>
 #include <QPoint>
 #include <QPointF>
+#include <QSignalBlocker>
+#include <QSize>
+#include <QThread>
 #include <QTimer>
+#include <QTransform>
 #include <QTranslator>
 
 #include "core/georeferencing.h"
@@ -46,6 +55,7 @@
 #include "core/map_grid.h"
 #include "core/map_part.h"
 #include "core/map_printer.h"
+#include "core/map_snapshot.h"
 #include "core/map_view.h"
 #include "core/objects/object.h"
 #include "core/objects/object_operations.h"
@@ -58,12 +68,14 @@
 #include "fileformats/file_format_registry.h"
 #include "fileformats/file_import_export.h"
 #include "fileformats/xml_file_format_p.h"
+#include "gui/map/map_tile_cache.h"
 #include "gui/map/map_widget.h"
 #include "templates/template.h"
 #include "undo/map_part_undo.h"
 #include "undo/object_undo.h"
 #include "undo/undo.h"
 #include "undo/undo_manager.h"
+#include "util/concurrency.h"
 #include "util/util.h"
 #include "util/transformation.h"
 
@@ -116,10 +128,92 @@ struct MapColorSetMergeItem
 typedef std::vector<MapColorSetMergeItem> MapColorSetMergeList;
 
 
+// ### Dirty areas ###
+
+/**
+ * The number of rectangles which a DirtyAreaBatch keeps at most.
+ * 
+ * A few separate rectangles avoid repainting the whole space between
+ * distant changes, e.g. at opposite corners of the map.
+ */
+constexpr std::size_t max_pending_dirty_areas = 8;
+
+qreal area(const QRectF& rect)
+{
+	return rect.width() * rect.height();
+}
+
+/**
+ * Adds a rectangle to the list, merging it with one of the existing ones.
+ * 
+ * The rectangle is merged with the one for which the union grows the least.
+ * A new entry is added only when this growth is significant and the list
+ * is not full yet.
+ */
+void addDirtyArea(std::vector<QRectF>& areas, const QRectF& rect)
+{
+	auto best = end(areas);
+	auto best_growth = std::numeric_limits<qreal>::max();
+	for (auto it = begin(areas); it != end(areas); ++it)
+	{
+		auto const growth = area(it->united(rect)) - area(*it) - area(rect);
+		if (growth < best_growth)
+		{
+			best = it;
+			best_growth = growth;
+		}
+	}
+	
+	if (best != end(areas) && (best_growth <= 0 || areas.size() >= max_pending_dirty_areas))
+		*best = best->united(rect);
+	else
+		areas.push_back(rect);
+}
+
+
+// ### Selection cache ###
+
+/**
+ * The number of selected objects from which drawSelection() uses an image.
+ * 
+ * Smaller selections are cheap to draw directly and don't need the memory.
+ */
+constexpr std::size_t min_objects_for_selection_cache = 100;
+
+
 }  // namespace
 
 
 
+// ### Map::SelectionCache ###
+
+/**
+ * An image of the selection renderables, as drawn for a particular widget.
+ */
+struct Map::SelectionCache
+{
+	const MapWidget* widget = nullptr;
+	QTransform transform;
+	QPointF pan_offset;
+	QSize size;
+	RenderConfig::Options options;
+	qreal opacity = 1;
+	QImage image;
+	
+	bool matches(const MapWidget* widget, const QTransform& transform, const QPointF& pan_offset, RenderConfig::Options options, qreal opacity) const
+	{
+		return !image.isNull()
+		       && this->widget == widget
+		       && this->transform == transform
+		       && this->pan_offset == pan_offset
+		       && this->size == widget->size()
+		       && this->options == options
+		       && qFuzzyCompare(this->opacity, opacity);
+	}
+};
+
+
+
 // ### MapColorSet ###
 
 Map::MapColorSet::MapColorSet()
@@ -435,10 +529,35 @@ Map::Map()
 	connect(this, &Map::colorChanged, this, &Map::checkSpotColorPresence);
 	connect(this, &Map::colorDeleted, this, &Map::checkSpotColorPresence);
 	connect(undo_manager.data(), &UndoManager::cleanChanged, this, &Map::undoCleanChanged);
+	
+	icon_cache_registration = CacheManager::add({
+		[this]() {
+			qint64 bytes = 0;
+			for (const auto* symbol : symbols)
+				bytes += symbol->iconMemoryUsage();
+			return bytes;
+		},
+		[this](CacheManager::TrimLevel level) {
+			// Icons are recreated on demand, when the symbols are painted.
+			if (level == CacheManager::TrimCritical)
+			{
+				for (auto* symbol : symbols)
+					symbol->resetIcon();
+			}
+		}
+	});
+	
+	path_coords_cache_registration = CacheManager::add({
+		[this]() { return pathCoordsMemoryUsage(); },
+		[this](CacheManager::TrimLevel level) { releasePathCoords(level < CacheManager::TrimCritical); }
+	});
 }
 
 Map::~Map()
 {
+	// Nobody needs to observe the individual steps of the teardown.
+	QSignalBlocker const block_undo_signals(undo_manager.data());
+	QSignalBlocker const block_map_signals(this);
 	clear();  // properly destruct all children
 }
 
@@ -458,8 +577,12 @@ void Map::clear()
 	object_selection.clear();
 	first_selected_object = nullptr;
 	selection_renderables->clear();
+	invalidateSelectionCache();
+	invalidateColorUsage();
 	
 	renderables->clear();
+	tile_cache.reset();
+	last_snapshot.reset();
 	
 	for (MapPart* part : parts)
 		delete part;
@@ -631,16 +754,16 @@ QHash<const Symbol*, Symbol*> Map::importMap(
 		const auto& other_georef = imported_map.getGeoreferencing();
 		const auto src_origin = MapCoordF { other_georef.getMapRefPoint() };
 		
-		bool ok0, ok1, ok2;
+		bool ok;
 		PassPointList passpoints;
 		passpoints.resize(3);
 		passpoints[0].src_coords  = src_origin;
-		passpoints[0].dest_coords = georef.toMapCoordF(&other_georef, passpoints[0].src_coords, &ok0);
 		passpoints[1].src_coords  = src_origin + MapCoordF { 128.0, 0.0 }; // 128 mm off horizontally
-		passpoints[1].dest_coords = georef.toMapCoordF(&other_georef, passpoints[1].src_coords, &ok1);
 		passpoints[2].src_coords  = src_origin + MapCoordF { 0.0, 128.0 }; // 128 mm off vertically
-		passpoints[2].dest_coords = georef.toMapCoordF(&other_georef, passpoints[2].src_coords, &ok2);
-		if (ok0 && ok1 && ok2
+		auto const dest_coords = georef.toMapCoordF(&other_georef, { passpoints[0].src_coords, passpoints[1].src_coords, passpoints[2].src_coords }, &ok);
+		for (std::size_t i = 0; i < 3; ++i)
+			passpoints[i].dest_coords = dest_coords[i];
+		if (ok
 		    && !passpoints.estimateNonIsometricSimilarityTransform(&q_transform))
 		{
 			/// \todo proper error message
@@ -857,7 +980,76 @@ void Map::drawTemplates(QPainter* painter, const QRectF& bounding_box, int first
 void Map::updateObjects()
 {
 	// TODO: It maybe would be better if the objects entered themselves into a separate list when they get dirty so not all objects have to be traversed here
-	applyOnAllObjects(&Object::update);
+	std::vector<const Object*> dirty_objects;
+	for (const MapPart* part : parts)
+	{
+		for (int i = 0; i < part->getNumObjects(); ++i)
+		{
+			const Object* object = part->getObject(i);
+			if (object->isOutputDirty())
+				dirty_objects.push_back(object);
+		}
+	}
+	regenerateObjects(dirty_objects);
+}
+
+void Map::regenerateObjects(const std::vector<const Object*>& objects)
+{
+	// Printing and export call this from worker threads, after the dirty
+	// objects were updated. So there must not be any shared state touched
+	// when there is nothing to do.
+	if (objects.empty())
+		return;
+	
+	DirtyAreaBatch batch(*this);
+	
+	// Below this number, the thread pool overhead is not worth it.
+	constexpr std::size_t min_concurrent_objects = 64;
+	if (objects.size() < min_concurrent_objects || Concurrency::idealThreadCount() <= 1)
+	{
+		for (const Object* object : objects)
+			object->forceUpdate();
+		return;
+	}
+	
+	// Text layout uses QFont and QFontMetricsF, which must not be shared
+	// between threads. So text objects are updated on this thread.
+	std::vector<const Object*> concurrent_objects;
+	std::vector<QRectF> old_extents;
+	concurrent_objects.reserve(objects.size());
+	old_extents.reserve(objects.size());
+	for (const Object* object : objects)
+	{
+		if (object->getType() == Object::Text)
+		{
+			object->forceUpdate();
+		}
+		else
+		{
+			concurrent_objects.push_back(object);
+			old_extents.push_back(object->getExtent());
+		}
+	}
+	
+	Concurrency::parallelFor(0, int(concurrent_objects.size()), [&concurrent_objects](int i) {
+		concurrent_objects[std::size_t(i)]->regenerateOutput();
+	}, 16);
+	
+	// Only the insertion into the map's renderables is serialized.
+	for (std::size_t i = 0; i < concurrent_objects.size(); ++i)
+		concurrent_objects[i]->finishUpdate(old_extents[i]);
+}
+
+const MapRenderables& Map::getRenderables() const
+{
+	return *renderables;
+}
+
+MapTileCache& Map::getTileCache()
+{
+	if (!tile_cache)
+		tile_cache.reset(new MapTileCache());
+	return *tile_cache;
 }
 
 void Map::removeRenderablesOfObject(const Object* object, bool mark_area_as_dirty)
@@ -871,6 +1063,36 @@ void Map::insertRenderablesOfObject(const Object* object)
 	renderables->insertRenderablesOfObject(object);
 	if (isObjectSelected(object))
 		addSelectionRenderables(object);
+	objectExtentChanged(object);
+}
+
+void Map::objectExtentChanged(const Object* object)
+{
+	for (MapPart* part : parts)
+	{
+		if (part->objectExtentChanged(object))
+			break;
+	}
+}
+
+
+void Map::objectTagsChanged(const Object* object, const ObjectTags& old_tags)
+{
+	for (MapPart* part : parts)
+	{
+		if (part->objectTagsChanged(object, old_tags))
+			break;
+	}
+}
+
+
+void Map::objectSymbolChanged(const Object* object)
+{
+	for (MapPart* part : parts)
+	{
+		if (part->objectSymbolChanged(object))
+			break;
+	}
 }
 
 
@@ -935,6 +1157,8 @@ void Map::deleteSelectedObjects()
 	auto end = selectedObjectsEnd();
 	if (obj != end)
 	{
+		DirtyAreaBatch batch(*this);
+		
 		// FIXME: this is not ready for multiple map parts.
 		auto undo_step = new AddObjectsUndoStep(this);
 		MapPart* part = getCurrentPart();
@@ -965,13 +1189,14 @@ void Map::includeSelectionRect(QRectF& rect) const
 		rectIncludeSafe(rect, object->getExtent());
 }
 
-void Map::drawSelection(QPainter* painter, bool force_min_size, MapWidget* widget, MapRenderables* replacement_renderables, bool draw_normal)
+void Map::drawSelection(QPainter* painter, bool force_min_size, MapWidget* widget, MapRenderables* replacement_renderables, bool draw_normal, const QTransform& preview_transform)
 {
 	MapView* view = widget->getMapView();
 	
 	painter->save();
 	painter->translate(widget->width() / 2.0 + view->panOffset().x(), widget->height() / 2.0 + view->panOffset().y());
 	painter->setWorldTransform(view->worldTransform(), true);
+	painter->setWorldTransform(preview_transform, true);
 	
 	if (!replacement_renderables)
 		replacement_renderables = selection_renderables.data();
@@ -985,10 +1210,57 @@ void Map::drawSelection(QPainter* painter, bool force_min_size, MapWidget* widge
 		options |= RenderConfig::Highlighted;
 		selection_opacity = 0.4;
 	}
-	RenderConfig config = { *this, view->calculateViewedRect(widget->viewportToView(widget->rect())), view->calculateFinalZoomFactor(), options, selection_opacity };
-	replacement_renderables->draw(painter, config);
+	auto viewed_rect = view->calculateViewedRect(widget->viewportToView(widget->rect()));
+	RenderConfig config = { *this, viewed_rect, view->calculateFinalZoomFactor(), options, selection_opacity };
 	
+	if (replacement_renderables != selection_renderables.data()
+	    || object_selection.size() < min_objects_for_selection_cache)
+	{
+		invalidateSelectionCache();
+		if (!preview_transform.isIdentity())
+			config.bounding_box = preview_transform.inverted().mapRect(viewed_rect);
+		replacement_renderables->draw(painter, config);
+		painter->restore();
+		return;
+	}
+	
+	// Large selection: draw from an image, redrawn only after changes.
 	painter->restore();
+	auto const transform = view->worldTransform();
+	if (!selection_cache)
+		selection_cache.reset(new SelectionCache());
+	if (!selection_cache->matches(widget, transform, view->panOffset(), options, selection_opacity))
+	{
+		auto& cache = *selection_cache;
+		cache.widget = widget;
+		cache.transform = transform;
+		cache.pan_offset = view->panOffset();
+		cache.size = widget->size();
+		cache.options = options;
+		cache.opacity = selection_opacity;
+		if (cache.image.size() != cache.size)
+			cache.image = QImage(cache.size, QImage::Format_ARGB32_Premultiplied);
+		cache.image.fill(Qt::transparent);
+		
+		QPainter image_painter(&cache.image);
+		image_painter.setRenderHints(painter->renderHints());
+		image_painter.translate(widget->width() / 2.0 + cache.pan_offset.x(), widget->height() / 2.0 + cache.pan_offset.y());
+		image_painter.setWorldTransform(transform, true);
+		selection_renderables->draw(&image_painter, config);
+	}
+	if (preview_transform.isIdentity())
+	{
+		painter->drawImage(0, 0, selection_cache->image);
+	}
+	else
+	{
+		// Transform the image: viewport -> map -> preview -> viewport
+		auto const map_to_viewport = transform * QTransform::fromTranslate(widget->width() / 2.0 + view->panOffset().x(), widget->height() / 2.0 + view->panOffset().y());
+		painter->save();
+		painter->setTransform(map_to_viewport.inverted() * preview_transform * map_to_viewport, true);
+		painter->drawImage(0, 0, selection_cache->image);
+		painter->restore();
+	}
 }
 
 void Map::addObjectToSelection(Object* object, bool emit_selection_changed)
@@ -1066,6 +1338,7 @@ bool Map::toggleObjectSelection(Object* object, bool emit_selection_changed)
 void Map::clearObjectSelection(bool emit_selection_changed)
 {
 	selection_renderables->clear();
+	invalidateSelectionCache();
 	object_selection.clear();
 	first_selected_object = nullptr;
 	
@@ -1086,16 +1359,66 @@ void Map::emitSelectionEdited()
 void Map::addMapWidget(MapWidget* widget)
 {
 	widgets.push_back(widget);
+	
+	if (!path_coords_timer)
+	{
+		path_coords_timer = new QTimer(this);
+		path_coords_timer->setInterval(60000);  // ms
+		connect(path_coords_timer, &QTimer::timeout, this, [this]() { releasePathCoords(); });
+	}
+	path_coords_timer->start();
 }
 
 void Map::removeMapWidget(MapWidget* widget)
 {
 	widgets.erase(std::remove(begin(widgets), end(widgets), widget), end(widgets));
+	if (selection_cache && selection_cache->widget == widget)
+		invalidateSelectionCache();
+	if (widgets.empty())
+	{
+		tile_cache.reset();
+		if (path_coords_timer)
+			path_coords_timer->stop();
+	}
+}
+
+void Map::releasePathCoords(bool keep_visible)
+{
+	std::vector<QRectF> visible_areas;
+	if (keep_visible)
+	{
+		visible_areas.reserve(widgets.size());
+		for (const auto* widget : widgets)
+			visible_areas.push_back(widget->getMapView()->calculateViewedRect(widget->viewportToView(widget->rect())));
+	}
+	
+	applyOnAllObjects([this, &visible_areas](const Object* object) {
+		if (object->getType() != Object::Path || isObjectSelected(object))
+			return;
+		
+		auto const& extent = object->getExtent();
+		if (std::any_of(begin(visible_areas), end(visible_areas), [&extent](const QRectF& area) { return area.intersects(extent); }))
+			return;
+		
+		object->asPath()->releasePathCoords();
+	});
+}
+
+qint64 Map::pathCoordsMemoryUsage() const
+{
+	qint64 bytes = 0;
+	applyOnAllObjects([&bytes](const Object* object) {
+		if (object->getType() == Object::Path)
+			bytes += qint64(object->asPath()->pathCoordsMemoryUsage());
+	});
+	return bytes;
 }
 
 
 void Map::updateAllMapWidgets()
 {
+	if (tile_cache)
+		tile_cache->clear();
 	for (MapWidget* widget : widgets)
 		widget->updateEverything();
 }
@@ -1186,7 +1509,8 @@ QString Map::raw_translation(const QString& symbol_text) const
 
 void Map::setColor(MapColor* color, int pos)
 {
-	// MapColor* old_color = color_set->colors[pos];
+	if (color_set->colors[pos] != color)
+		invalidateColorUsage();
 	
 	color_set->colors[pos] = color;
 	color->setPriority(pos);
@@ -1235,6 +1559,7 @@ void Map::setColor(MapColor* color, int pos)
 void Map::addColor(MapColor* color, int pos)
 {
 	color_set->insert(pos, color);
+	invalidateColorUsage();
 	if (getNumColors() == 1)
 	{
 		// This is the first color - the help text in the map widget(s) should be updated
@@ -1262,6 +1587,11 @@ void Map::deleteColor(int pos)
 	}
 	
 	color_set->erase(pos);
+	if (color_usage_valid)
+	{
+		color_usage.remove(color);
+		--color_usage_num_colors;
+	}
 	
 	if (getNumColors() == 0)
 	{
@@ -1306,19 +1636,74 @@ void Map::setColorsDirty()
 	setHasUnsavedChanges(true);
 }
 
+void Map::updateColorAppearance()
+{
+	invalidateSelectionCache();
+	updateAllMapWidgets();
+}
+
+void Map::remapColorPriorities(const std::vector<int>& priorities)
+{
+	PointSymbol::invalidatePrototypes();
+	
+	applyOnAllObjects([&priorities](const Object* object) {
+		object->remapColorPriorities(priorities);
+	});
+	renderables->remapColorPriorities(priorities);
+	selection_renderables->remapColorPriorities(priorities);
+	updateColorAppearance();
+}
+
 void Map::useColorsFrom(Map* map)
 {
 	color_set = map->color_set;
+	invalidateColorUsage();
 }
 
 bool Map::isColorUsedByASymbol(const MapColor* color) const
 {
+	updateColorUsage();
+	return color_usage.value(color) > 0;
+}
+
+void Map::updateColorUsage() const
+{
+	if (color_usage_valid
+	    && color_usage_num_colors == color_set->colors.size()
+	    && color_usage_num_symbols == symbols.size())
+		return;
+	
+	color_usage.clear();
+	color_usage_num_colors = color_set->colors.size();
+	color_usage_num_symbols = 0;
+	color_usage_valid = true;
 	for (const Symbol* symbol : symbols)
-	{
-		if (symbol->containsColor(color))
-			return true;
-	}
-	return false;
+		addColorUsage(symbol, 1);
+}
+
+void Map::addColorUsage(const Symbol* symbol, int delta) const
+{
+	if (!color_usage_valid)
+		return;
+	
+	auto count = [this, symbol, delta](const MapColor* color) {
+		if (!symbol->containsColor(color))
+			return;
+		auto& usage = color_usage[color];
+		usage += delta;
+		if (usage <= 0)
+			color_usage.remove(color);
+	};
+	for (const MapColor* color : color_set->colors)
+		count(color);
+	count(getRegistrationColor());
+	color_usage_num_symbols += std::size_t(delta);
+}
+
+void Map::invalidateColorUsage()
+{
+	color_usage_valid = false;
+	color_usage.clear();
 }
 
 void Map::determineColorsInUse(const std::vector< bool >& by_which_symbols, std::vector< bool >& out) const
@@ -1331,14 +1716,22 @@ void Map::determineColorsInUse(const std::vector< bool >& by_which_symbols, std:
 	
 	Q_ASSERT(int(by_which_symbols.size()) == getNumSymbols());
 	out.assign(std::size_t(getNumColors()), false);
-	for (std::size_t c = 0, last = std::size_t(getNumColors()); c != last; ++c)
+	if (std::all_of(begin(by_which_symbols), end(by_which_symbols), [](bool b) { return b; }))
+	{
+		for (std::size_t c = 0, last = std::size_t(getNumColors()); c != last; ++c)
+			out[c] = isColorUsedByASymbol(getColor(int(c)));
+	}
+	else
 	{
-		for (std::size_t s = 0, last_s = std::size_t(getNumSymbols()); s != last_s; ++s)
+		for (std::size_t c = 0, last = std::size_t(getNumColors()); c != last; ++c)
 		{
-			if (by_which_symbols[s] && getSymbol(int(s))->containsColor(getColor(int(c))))
+			for (std::size_t s = 0, last_s = std::size_t(getNumSymbols()); s != last_s; ++s)
 			{
-				out[c] = true;
-				break;
+				if (by_which_symbols[s] && getSymbol(int(s))->containsColor(getColor(int(c))))
+				{
+					out[c] = true;
+					break;
+				}
 			}
 		}
 	}
@@ -1471,6 +1864,8 @@ QHash<const Symbol*, Symbol*> Map::importSymbols(
 			symbol->symbolChangedEvent(it.key(), it.value());
 		}
 	}
+	if (!created_symbols.empty())
+		invalidateColorUsage();  // combined symbols
 	
 	return out_pointermap;
 }
@@ -1481,6 +1876,7 @@ void Map::addSelectionRenderables(const Object* object)
 {
 	object->update();
 	selection_renderables->insertRenderablesOfObject(object);
+	invalidateSelectionCache();
 }
 
 void Map::updateSelectionRenderables(const Object* object)
@@ -1492,6 +1888,12 @@ void Map::updateSelectionRenderables(const Object* object)
 void Map::removeSelectionRenderables(const Object* object)
 {
 	selection_renderables->removeRenderablesOfObject(object, false);
+	invalidateSelectionCache();
+}
+
+void Map::invalidateSelectionCache()
+{
+	selection_cache.reset();
 }
 
 void Map::initStatic()
@@ -1530,6 +1932,7 @@ void Map::initStatic()
 void Map::addSymbol(Symbol* symbol, int pos)
 {
 	symbols.insert(symbols.begin() + pos, symbol);
+	addColorUsage(symbol, 1);
 	if (symbols.size() == 1)
 	{
 		// This is the first symbol - the help text in the map widget(s) should be updated
@@ -1574,6 +1977,9 @@ Symbol* Map::getSymbol(int i)
 
 void Map::setSymbol(Symbol* symbol, int pos)
 {
+	// Deferred undo steps refer to the symbols by pointer.
+	undo_manager->loadDeferredSteps();
+	
 	Symbol* old_symbol = symbols[pos];
 	
 	// Check if an object with this symbol is selected
@@ -1589,6 +1995,8 @@ void Map::setSymbol(Symbol* symbol, int pos)
 	
 	changeSymbolForAllObjects(old_symbol, symbol);
 	
+	// The dependent symbols must be determined before references are updated.
+	auto const dependent_symbols = dependentSymbols(old_symbol);
 	int size = (int)symbols.size();
 	for (int i = 0; i < size; ++i)
 	{
@@ -1596,11 +2004,14 @@ void Map::setSymbol(Symbol* symbol, int pos)
 			continue;
 		
 		if (symbols[i]->symbolChangedEvent(symbols[pos], symbol))
-			updateAllObjectsWithSymbol(symbols[i]);
+			invalidateColorUsage();  // combined symbols
 	}
+	updateAllObjectsWithSymbols(dependent_symbols);
 	
 	// Change the symbol
+	addColorUsage(old_symbol, -1);
 	symbols[pos] = symbol;
+	addColorUsage(symbol, 1);
 	emit symbolChanged(pos, symbol, old_symbol);
 	setSymbolsDirty();
 	delete old_symbol;
@@ -1611,9 +2022,14 @@ void Map::setSymbol(Symbol* symbol, int pos)
 
 void Map::deleteSymbol(int pos)
 {
+	// Deferred undo steps refer to the symbols by pointer.
+	undo_manager->loadDeferredSteps();
+	
 	if (deleteAllObjectsWithSymbol(symbols[pos]))
 		undo_manager->clear();
 	
+	// The dependent symbols must be determined before references are removed.
+	auto const dependent_symbols = dependentSymbols(symbols[pos]);
 	int size = (int)symbols.size();
 	for (int i = 0; i < size; ++i)
 	{
@@ -1621,10 +2037,12 @@ void Map::deleteSymbol(int pos)
 			continue;
 		
 		if (symbols[i]->symbolChangedEvent(symbols[pos], nullptr))
-			updateAllObjectsWithSymbol(symbols[i]);
+			invalidateColorUsage();  // combined symbols
 	}
+	updateAllObjectsWithSymbols(dependent_symbols);
 	
 	// Delete the symbol
+	addColorUsage(symbols[pos], -1);
 	Symbol* temp = symbols[pos];
 	delete symbols[pos];
 	symbols.erase(symbols.begin() + pos);
@@ -1756,6 +2174,36 @@ qreal Map::symbolIconZoom() const
 }
 
 
+void Map::prepareSymbolIcons(int side_length, bool use_custom_icons) const
+{
+	prepareSymbolIcons(0, getNumSymbols(), side_length, use_custom_icons);
+}
+
+void Map::prepareSymbolIcons(int first, int last, int side_length, bool use_custom_icons) const
+{
+	first = qMax(first, 0);
+	last = qMin(last, getNumSymbols());
+	
+	auto pending = std::vector<const Symbol*>();
+	pending.reserve(std::size_t(qMax(last - first, 0)));
+	for (auto i = first; i < last; ++i)
+	{
+		const auto* symbol = symbols[std::size_t(i)];
+		if (!symbol->hasIcon())
+			pending.push_back(symbol);
+	}
+	if (pending.empty())
+		return;
+	
+	// Not thread-safe: may update the cached zoom and emit a signal.
+	symbolIconZoom();
+	
+	Concurrency::parallelFor(0, int(pending.size()), [&](int i) {
+		pending[std::size_t(i)]->prepareIcon(*this, side_length, use_custom_icons);
+	});
+}
+
+
 void Map::updateSymbolIconZoom()
 {
 	// A simple heuristics which determines the symbol icon scale from
@@ -1843,12 +2291,18 @@ void Map::setTemplateAreaDirty(Template* temp, const QRectF& area, int pixel_bor
 	
 	for (MapWidget* widget : widgets)
 	{
+		// Hidden templates may still have a cached layer which must be refreshed.
 		const MapView* map_view = widget->getMapView();
-		if (map_view->isTemplateVisible(temp))
-			widget->markTemplateCacheDirty(map_view->calculateViewBoundingBox(area), pixel_border, front_cache);
+		widget->markTemplateCacheDirty(map_view->calculateViewBoundingBox(area), pixel_border, front_cache, temp);
 	}
 }
 
+void Map::setTemplateCompositionDirty()
+{
+	for (MapWidget* widget : widgets)
+		widget->markTemplateCompositionDirty();
+}
+
 void Map::setTemplateAreaDirty(int i)
 {
 	if (i == -1)
@@ -1941,6 +2395,11 @@ void Map::push(UndoStep *step)
 	undo_manager->push(std::unique_ptr<UndoStep>(step));
 }
 
+void Map::push(UndoStep* step, const QString& operation)
+{
+	undo_manager->push(std::unique_ptr<UndoStep>(step), operation);
+}
+
 
 void Map::addPart(MapPart* part, std::size_t index)
 {
@@ -1967,9 +2426,9 @@ void Map::removePart(std::size_t index)
 	
 	MapPart* part = parts[index];
 	
-	// FIXME: This loop should move to MapPart.
-	while(part->getNumObjects())
-		part->deleteObject(0);
+	// The part's destructor releases the objects in bulk.
+	for (int i = 0, size = part->getNumObjects(); i < size; ++i)
+		removeRenderablesOfObject(part->getObject(i), true);
 	
 	parts.erase(parts.begin() + index);
 	if (current_part_index >= index)
@@ -2090,6 +2549,16 @@ int Map::addObject(Object* object, int part_index)
 	return object_index;
 }
 
+int Map::addObjects(const std::vector<Object*>& objects, int part_index)
+{
+	MapPart* part = parts[(part_index < 0) ? current_part_index : part_index];
+	int object_index = part->getNumObjects();
+	part->addObjects(objects);
+	regenerateObjects({ objects.begin(), objects.end() });
+	
+	return object_index;
+}
+
 void Map::deleteObject(Object* object)
 {
 	delete releaseObject(object);
@@ -2141,10 +2610,39 @@ QRectF Map::calculateExtent(bool include_helper_symbols, bool include_templates,
 
 void Map::setObjectAreaDirty(const QRectF& map_coords_rect)
 {
+	if (dirty_area_batches > 0 && QThread::currentThread() == thread())
+	{
+		if (map_coords_rect.isValid())
+			addDirtyArea(pending_dirty_areas, map_coords_rect);
+		return;
+	}
+	
+	if (tile_cache)
+		tile_cache->invalidate(map_coords_rect);
 	for (MapWidget* widget : widgets)
 		widget->markObjectAreaDirty(map_coords_rect);
 }
 
+
+Map::DirtyAreaBatch::DirtyAreaBatch(Map& map) noexcept
+: map(map)
+, active(QThread::currentThread() == map.thread())
+{
+	if (active)
+		++map.dirty_area_batches;
+}
+
+Map::DirtyAreaBatch::~DirtyAreaBatch()
+{
+	if (!active || --map.dirty_area_batches > 0)
+		return;
+	
+	auto areas = std::move(map.pending_dirty_areas);
+	map.pending_dirty_areas.clear();
+	for (const auto& rect : areas)
+		map.setObjectAreaDirty(rect);
+}
+
 void Map::findObjectsAt(
         const MapCoordF& coord,
         qreal tolerance,
@@ -2170,6 +2668,17 @@ void Map::findAllObjectsAt(
 		part->findObjectsAt(coord, tolerance, treat_areas_as_paths, extended_selection, include_hidden_objects, include_protected_objects, out);
 }
 
+void Map::findAllObjectsNear(
+        const MapCoordF& coord,
+        qreal distance,
+        bool include_hidden_objects,
+        bool include_protected_objects,
+        std::vector<Object*>& out) const
+{
+	for (const MapPart* part : parts)
+		part->findObjectsNear(coord, distance, include_hidden_objects, include_protected_objects, out);
+}
+
 void Map::findObjectsAtBox(
         const MapCoordF& corner1,
         const MapCoordF& corner2,
@@ -2217,6 +2726,13 @@ void Map::applyOnMatchingObjects(const std::function<void (Object*, MapPart*, in
 }
 
 
+void Map::applyOnMatchingObjects(const std::function<void (Object*)>& operation, const ObjectQuery& query)
+{
+	for (auto part : parts)
+		part->applyOnMatchingObjects(operation, query);
+}
+
+
 void Map::applyOnAllObjects(const std::function<void (Object*)>& operation)
 {
 	for (auto part : parts)
@@ -2239,40 +2755,128 @@ void Map::applyOnAllObjects(const std::function<void (Object*, MapPart*, int)>&
 
 
 
+void Map::transformAllObjects(const std::function<void (Object*)>& operation)
+{
+	// Marking the objects as dirty notifies the map parts. This must be done
+	// here, so that it doesn't happen in the concurrent operation.
+	std::vector<Object*> objects;
+	objects.reserve(std::size_t(getNumObjects()));
+	applyOnAllObjects([&objects](Object* object) {
+		object->setOutputDirty();
+		objects.push_back(object);
+	});
+	
+	Concurrency::parallelFor(0, int(objects.size()), [&objects, &operation](int i) {
+		operation(objects[std::size_t(i)]);
+	}, 256);
+	
+	regenerateObjects(std::vector<const Object*>(begin(objects), end(objects)));
+}
+
 void Map::scaleAllObjects(double factor, const MapCoord& scaling_center)
 {
-	applyOnAllObjects(ObjectOp::Scale{factor, MapCoordF{scaling_center}});
+	auto const center = MapCoordF{scaling_center};
+	transformAllObjects([factor, center](Object* object) {
+		object->scale(center, factor);
+	});
 }
 
 void Map::rotateAllObjects(double rotation, const MapCoord& center)
 {
-	applyOnAllObjects(ObjectOp::Rotate{rotation, MapCoordF{center}});
+	auto const rotation_center = MapCoordF{center};
+	transformAllObjects([rotation, rotation_center](Object* object) {
+		object->rotateAround(rotation_center, rotation);
+	});
 }
 
 void Map::updateAllObjects()
 {
-	applyOnAllObjects(&Object::forceUpdate);
+	PointSymbol::invalidatePrototypes();
+	
+	std::vector<const Object*> objects;
+	applyOnAllObjects([&objects](const Object* object) {
+		objects.push_back(object);
+	});
+	regenerateObjects(objects);
 }
 
 void Map::updateAllObjectsWithSymbol(const Symbol* symbol)
 {
-	applyOnMatchingObjects(&Object::forceUpdate, ObjectOp::HasSymbol{symbol});
+	auto symbols = dependentSymbols(symbol);
+	symbols.push_back(symbol);
+	updateAllObjectsWithSymbols(symbols);
+}
+
+void Map::updateAllObjectsWithSymbols(const std::vector<const Symbol*>& symbols)
+{
+	PointSymbol::invalidatePrototypes();
+	
+	std::vector<const Object*> objects;
+	for (const MapPart* part : parts)
+	{
+		for (auto const* symbol : symbols)
+		{
+			auto const part_objects = part->objectsWithSymbol(symbol);
+			objects.insert(end(objects), begin(part_objects), end(part_objects));
+		}
+	}
+	if (!objects.empty())
+		regenerateObjects(objects);
+}
+
+std::vector<const Symbol*> Map::dependentSymbols(const Symbol* symbol) const
+{
+	// The graph links each symbol to the symbols which use it directly.
+	QHash<const Symbol*, std::vector<const Symbol*>> users;
+	std::set<const Symbol*> visited(begin(symbols), end(symbols));
+	std::vector<const Symbol*> pending(begin(symbols), end(symbols));
+	while (!pending.empty())
+	{
+		auto const* user = pending.back();
+		pending.pop_back();
+		for (auto const* sub_symbol : user->subSymbols())
+		{
+			users[sub_symbol].push_back(user);
+			if (visited.insert(sub_symbol).second)
+				pending.push_back(sub_symbol);
+		}
+	}
+	
+	std::vector<const Symbol*> result;
+	std::set<const Symbol*> found = { symbol };
+	pending = { symbol };
+	while (!pending.empty())
+	{
+		auto const* current = pending.back();
+		pending.pop_back();
+		for (auto const* user : users.value(current))
+		{
+			if (found.insert(user).second)
+			{
+				result.push_back(user);
+				pending.push_back(user);
+			}
+		}
+	}
+	return result;
 }
 
 void Map::changeSymbolForAllObjects(const Symbol* old_symbol, const Symbol* new_symbol)
 {
-	applyOnMatchingObjects(ObjectOp::ChangeSymbol{new_symbol}, ObjectOp::HasSymbol{old_symbol});
+	if (existsObjectWithSymbol(old_symbol))
+		applyOnMatchingObjects(ObjectOp::ChangeSymbol{new_symbol}, ObjectOp::HasSymbol{old_symbol});
 }
 
 bool Map::deleteAllObjectsWithSymbol(const Symbol* symbol)
 {
-	bool exists = existsObject(ObjectOp::HasSymbol{symbol});
+	bool exists = existsObjectWithSymbol(symbol);
 	if (exists)
 	{
 		// Remove objects from selection
 		removeSymbolFromSelection(symbol, true);
 	
 		// Delete objects from map
+		DirtyAreaBatch batch(*this);
 		applyOnMatchingObjects(ObjectOp::Delete(), ObjectOp::HasSymbol{symbol});
 	}
 	return exists;
@@ -2280,7 +2884,19 @@ bool Map::deleteAllObjectsWithSymbol(const Symbol* symbol)
 
 bool Map::existsObjectWithSymbol(const Symbol* symbol) const
 {
-	return existsObject(ObjectOp::HasSymbol{symbol});
+	return std::any_of(begin(parts), end(parts), [symbol](const MapPart* part) {
+		return part->existsObjectWithSymbol(symbol);
+	});
+}
+
+void Map::setObjectsWithSymbolAreaDirty(const Symbol* symbol)
+{
+	DirtyAreaBatch batch(*this);
+	for (const MapPart* part : parts)
+	{
+		for (const auto* object : part->objectsWithSymbol(symbol))
+			setObjectAreaDirty(object->getExtent());
+	}
 }
 
 void Map::setGeoreferencing(const Georeferencing& georeferencing)
@@ -2333,6 +2949,20 @@ void Map::setBaselineViewEnabled(bool enabled)
 }
 
 
+bool Map::isGeometricPatternClippingEnabled() const
+{
+	return renderable_options & Symbol::RenderPatternsClipped;
+}
+
+void Map::setGeometricPatternClippingEnabled(bool enabled)
+{
+	if (enabled)
+		renderable_options |= Symbol::RenderPatternsClipped;
+	else
+		renderable_options &= ~Symbol::RenderPatternsClipped;
+}
+
+
 const MapPrinterConfig& Map::printerConfig()
 {
 	if (printer_config.isNull())
@@ -2401,10 +3031,14 @@ void Map::setHasUnsavedChanges(bool has_unsaved_changes)
 			emit hasUnsavedChanged(unsaved_changes);
 		}
 	}
-	else if (!unsaved_changes)
+	else
 	{
-		unsaved_changes = true;
-		emit hasUnsavedChanged(unsaved_changes);
+		++change_count;
+		if (!unsaved_changes)
+		{
+			unsaved_changes = true;
+			emit hasUnsavedChanged(unsaved_changes);
+		}
 	}
 }
 
@@ -2414,6 +3048,19 @@ void Map::setOtherDirty()
 	setHasUnsavedChanges(true);
 }
 
+std::shared_ptr<const MapSnapshot> Map::snapshot()
+{
+	auto snapshot = last_snapshot.lock();
+	if (!snapshot
+	    || snapshot->generation() != change_count
+	    || snapshot->map().renderableOptions() != renderable_options)
+	{
+		snapshot = std::make_shared<const MapSnapshot>(*this);
+		last_snapshot = snapshot;
+	}
+	return snapshot;
+}
+
 // slot
 void Map::undoCleanChanged(bool is_clean)
 {
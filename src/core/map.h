@@ -25,6 +25,7 @@
 #include <algorithm>
 #include <cstddef>
 #include <functional>
+#include <memory>
 #include <set>
 #include <vector>
 
@@ -44,9 +45,11 @@
 #include "core/map_coord.h"
 #include "core/map_grid.h"
 #include "core/map_part.h"
+#include "util/cache_manager.h"
 
 class QIODevice;
 class QPainter;
+class QTimer;
 class QTranslator;
 class QWidget;
 // IWYU pragma: no_forward_declare QRectF
@@ -60,9 +63,13 @@ class MapColor;
 class MapColorMap;
 class MapPrinterConfig;
 class MapRenderables;
+class MapSnapshot;
+class MapTileCache;
 class MapView;
 class MapWidget;
 class Object;
+class ObjectQuery;
+class ObjectTags;
 class PointSymbol;
 class RenderConfig;
 class Symbol;
@@ -89,6 +96,8 @@ class Map : public QObject
 Q_OBJECT
 friend class MapTest;
 friend class MapRenderables;
+friend class MapPart;
+friend class MapSnapshot;
 friend class OCAD8FileImport;
 friend class XMLFileImporter;
 friend class XMLFileExporter;
@@ -297,9 +306,29 @@ public:
 	/**
 	 * Updates the renderables and extent of all objects which have changed.
 	 * This is automatically called by draw(), you normally do not need to call it directly.
+	 * 
+	 * The renderables are created concurrently when there are many changed objects.
 	 */
 	void updateObjects();
 	
+	/**
+	 * Returns the renderables of the map objects.
+	 * 
+	 * The renderables are up-to-date only after updateObjects(). As long as
+	 * the map is not modified, they may be drawn from multiple threads
+	 * concurrently.
+	 */
+	const MapRenderables& getRenderables() const;
+	
+	/**
+	 * Returns the cache of rendered map tiles which is shared by all map widgets.
+	 * 
+	 * The tiles are invalidated by setObjectAreaDirty() and
+	 * updateAllMapWidgets(). The cache is released when the last map widget
+	 * is removed.
+	 */
+	MapTileCache& getTileCache();
+	
 	/** 
 	 * Calculates the extent of all map elements. 
 	 * 
@@ -321,6 +350,25 @@ public:
 	 */
 	void removeMapWidget(MapWidget* widget);
 	
+	/**
+	 * Releases the path coords of path objects which are not in use.
+	 * 
+	 * Selected objects are kept, and unless keep_visible is false, objects
+	 * which are visible in one of the map widgets are kept, too. For large
+	 * maps, the path coords take much more memory than the coordinates.
+	 * They are rebuilt on demand.
+	 * 
+	 * While the map has widgets, this is called periodically.
+	 * 
+	 * \see PathObject::releasePathCoords()
+	 */
+	void releasePathCoords(bool keep_visible = true);
+	
+	/**
+	 * Returns the memory used by the path coords of all path objects, in bytes.
+	 */
+	qint64 pathCoordsMemoryUsage() const;
+	
 	/**
 	 * Redraws all map widgets completely - this can be slow!
 	 * Try to avoid this and do partial redraws instead, if possible.
@@ -457,6 +505,24 @@ public:
 	 */
 	void setColorsDirty();
 	
+	/**
+	 * Redraws the map after changes to the appearance of colors.
+	 * 
+	 * Renderables refer to colors by priority, so changes to the CMYK or RGB
+	 * values, the opacity, or the spot color settings don't need the objects
+	 * to be regenerated.
+	 */
+	void updateColorAppearance();
+	
+	/**
+	 * Updates the objects after a reordering of the colors.
+	 * 
+	 * priorities[i] is the new priority of the color which had the priority i.
+	 * Instead of regenerating the objects, their renderables are moved to the
+	 * new priorities.
+	 */
+	void remapColorPriorities(const std::vector<int>& priorities);
+	
 	/**
 	 * Makes this map use the color set from the given map.
 	 * Used to create the maps containing preview objects in the symbol editor.
@@ -580,6 +646,24 @@ public:
 	 */
 	qreal symbolIconZoom() const;
 	
+	/**
+	 * Creates the missing icons of all symbols.
+	 * 
+	 * The icons are created concurrently, and generated icons are taken from
+	 * the persistent SymbolIconCache when possible. Afterwards, getIcon()
+	 * returns the cached icons without further delay.
+	 * 
+	 * \see Symbol::prepareIcon()
+	 */
+	void prepareSymbolIcons(int side_length, bool use_custom_icons) const;
+	
+	/**
+	 * Creates the missing icons of the symbols in the index range [first, last).
+	 * 
+	 * This lets views restrict the work to the visible symbols.
+	 */
+	void prepareSymbolIcons(int first, int last, int side_length, bool use_custom_icons) const;
+	
 public slots:
 	/**
 	 * Updates the symbol icon zoom from the current set of symbols.
@@ -642,12 +726,17 @@ public:
 	 * in all map widgets.
 	 * 
 	 * For an explanation of the area and pixel border, see setDrawingBoundingBox().
-	 * 
-	 * Warning: does nothing if the template is not visible in a widget!
-	 * So make sure to call this and showing/hiding a template in the correct order!
 	 */
 	void setTemplateAreaDirty(Template* temp, const QRectF& area, int pixel_border);
 	
+	/**
+	 * Requests the map widgets to compose the templates again.
+	 * 
+	 * Use this after changing the order of templates: the cached template
+	 * layers remain valid.
+	 */
+	void setTemplateCompositionDirty();
+	
 	/**
 	 * Marks the whole area of the i-th template as "to be repainted".
 	 * See setTemplateAreaDirty().
@@ -729,6 +818,14 @@ public:
 	 */
 	void push(UndoStep* step);
 	
+	/**
+	 * Pushes a new undo step for the given operation to the map's undoManager.
+	 * 
+	 * Bursts of steps of the same operation may be coalesced.
+	 * \see UndoManager::push(std::unique_ptr<UndoStep>&&, const QString&)
+	 */
+	void push(UndoStep* step, const QString& operation);
+	
 	
 	// Map parts
 	
@@ -825,6 +922,16 @@ public:
 	 */
 	int addObject(Object* object, int part_index = -1);
 	
+	/**
+	 * Adds the objects as new objects in the part with the given index,
+	 * or in the current part if the default -1 is passed.
+	 * 
+	 * This is meant for adding many objects at once: The renderables are
+	 * created concurrently, after all objects were inserted.
+	 * Returns the index of the first added object in the part.
+	 */
+	int addObjects(const std::vector<Object*>& objects, int part_index = -1);
+	
 	/**
 	 * Deletes the given object from the map.
 	 * 
@@ -852,6 +959,38 @@ public:
 	 */
 	void setObjectAreaDirty(const QRectF& map_coords_rect);
 	
+	/**
+	 * A scope which defers the marking of dirty object areas.
+	 * 
+	 * While a batch exists, setObjectAreaDirty() only collects the areas.
+	 * They are coalesced into a few rectangles, which are passed on to the
+	 * map widgets when the outermost batch ends. This avoids a lot of
+	 * repeated work when many objects change at once.
+	 * 
+	 * Batches are effective only on the thread of the map. Elsewhere, they
+	 * do nothing, so that the batch state is never shared between threads.
+	 * 
+	 * Synopsis:
+	 * 
+	 *     {
+	 *         Map::DirtyAreaBatch batch(map);
+	 *         for (auto* object : objects)
+	 *             object->update();
+	 *     }
+	 */
+	class DirtyAreaBatch
+	{
+	public:
+		explicit DirtyAreaBatch(Map& map) noexcept;
+		DirtyAreaBatch(const DirtyAreaBatch&) = delete;
+		DirtyAreaBatch& operator=(const DirtyAreaBatch&) = delete;
+		~DirtyAreaBatch();
+		
+	private:
+		Map& map;
+		const bool active;
+	};
+	
 	/**
 	 * Finds and returns all objects at the given position in the current part.
 	 * 
@@ -889,6 +1028,24 @@ public:
 		bool extended_selection, bool include_hidden_objects,
 		bool include_protected_objects, SelectionInfoVector& out) const;
 	
+	/**
+	 * Finds all objects in all parts whose extent is within the given
+	 * distance from the given position.
+	 * 
+	 * Unlike findAllObjectsAt(), this does not test the actual object shapes.
+	 * This makes it suitable for callers which do their own distance
+	 * calculations anyway, such as snapping.
+	 * 
+	 * @param coord The query position.
+	 * @param distance The maximum distance from the position, in mm.
+	 * @param include_hidden_objects Set to true if you want to find hidden objects.
+	 * @param include_protected_objects Set to true if you want to find protected objects.
+	 * @param out Output parameter. Will be filled with an object list.
+	 */
+	void findAllObjectsNear(const MapCoordF& coord, qreal distance,
+		bool include_hidden_objects, bool include_protected_objects,
+		std::vector<Object*>& out) const;
+	
 	/**
 	 * Finds and returns all objects intersecting the given box in the current part.
 	 * 
@@ -936,6 +1093,13 @@ public:
 	 */
 	void applyOnMatchingObjects(const std::function<void (Object*, MapPart*, int)>& operation, const std::function<bool (const Object*)>& condition);
 	
+	/**
+	 * Applies an operation on all objects which match the given query.
+	 * 
+	 * Queries on tags are answered with the help of the parts' tag indexes.
+	 */
+	void applyOnMatchingObjects(const std::function<void (Object*)>& operation, const ObjectQuery& query);
+	
 	/**
 	 * Applies an operation on all objects.
 	 */
@@ -952,6 +1116,16 @@ public:
 	void applyOnAllObjects(const std::function<void (Object*, MapPart*, int)>& operation);
 	
 	
+	/**
+	 * Applies a geometric transformation on all objects concurrently.
+	 * 
+	 * The operation is called from multiple threads. It must only change
+	 * the coordinates and properties of the given object, and it must not
+	 * update the object. The output of all objects is regenerated
+	 * afterwards, in a single batch.
+	 */
+	void transformAllObjects(const std::function<void (Object*)>& operation);
+	
 	/** Scales all objects by the given factor. */
 	void scaleAllObjects(double factor, const MapCoord& scaling_center);
 	
@@ -961,9 +1135,27 @@ public:
 	/** Forces an update of all objects, i.e. calls update(true) on each map object. */
 	void updateAllObjects();
 	
-	/** Forces an update of all objects with the given symbol. */
+	/**
+	 * Forces an update of all objects with the given symbol, or with any
+	 * symbol which depends on it.
+	 * 
+	 * \see dependentSymbols()
+	 */
 	void updateAllObjectsWithSymbol(const Symbol* symbol);
 	
+	/**
+	 * Returns the symbols whose appearance depends on the given symbol.
+	 * 
+	 * These are the symbols which use the given symbol directly or indirectly
+	 * as a sub-symbol, e.g. a line symbol using it as a mid symbol, or a
+	 * combined symbol using it as a part, and any combined symbol containing
+	 * those. The given symbol may be a map symbol or a sub-symbol owned by
+	 * another symbol. The result does not contain the given symbol.
+	 * 
+	 * \see Symbol::subSymbols()
+	 */
+	std::vector<const Symbol*> dependentSymbols(const Symbol* symbol) const;
+	
 	/** For all symbols with old_symbol, replaces the symbol by new_symbol. */
 	void changeSymbolForAllObjects(const Symbol* old_symbol, const Symbol* new_symbol);
 	
@@ -981,6 +1173,14 @@ public:
 	 */
 	bool existsObjectWithSymbol(const Symbol* symbol) const;
 	
+	/**
+	 * Marks the areas of all objects with the given symbol as dirty.
+	 * 
+	 * Use this after changing a symbol property which affects the display
+	 * but not the renderables, such as the hidden state.
+	 */
+	void setObjectsWithSymbolAreaDirty(const Symbol* symbol);
+	
 	
 	/**
 	 * Removes the renderables of the given object from display (does not
@@ -993,6 +1193,27 @@ public:
 	 */
 	void insertRenderablesOfObject(const Object* object);
 	
+	/**
+	 * Notifies the map parts that the extent of the given object may have changed.
+	 * 
+	 * This keeps the spatial indexes of the parts up to date.
+	 */
+	void objectExtentChanged(const Object* object);
+	
+	/**
+	 * Notifies the map parts that the tags of the given object have changed.
+	 * 
+	 * This keeps the tag indexes of the parts up to date.
+	 */
+	void objectTagsChanged(const Object* object, const ObjectTags& old_tags);
+	
+	/**
+	 * Notifies the map parts that the symbol of the given object has changed.
+	 * 
+	 * This keeps the symbol indexes of the parts up to date.
+	 */
+	void objectSymbolChanged(const Object* object);
+	
 	
 	/**
 	 * Marks an object as irregular.
@@ -1074,9 +1295,17 @@ public:
 	 *     Of the selection renderables. TODO: HACK
 	 * @param draw_normal If set to true, draws the objects like normal objects,
 	 *     otherwise draws transparent highlights.
+	 * @param preview_transform A transformation in map coordinates which is
+	 *     applied to the renderables, e.g. for previewing a drag operation
+	 *     without regenerating the renderables.
+	 * 
+	 * For large selections, the selection renderables are drawn into an image
+	 * which is reused until the selection, the objects or the view change.
+	 * A preview transformation is then applied to this image.
 	 */
 	void drawSelection(QPainter* painter, bool force_min_size, MapWidget* widget,
-		MapRenderables* replacement_renderables = nullptr, bool draw_normal = false);
+		MapRenderables* replacement_renderables = nullptr, bool draw_normal = false,
+		const QTransform& preview_transform = {});
 	
 	/**
 	 * Adds the given object to the selection.
@@ -1223,6 +1452,24 @@ public:
 	void setBaselineViewEnabled(bool enabled);
 	
 	
+	/**
+	 * Returns if area fill patterns are clipped geometrically.
+	 * 
+	 * In this mode, pattern lines are clipped to the area when the renderables
+	 * are created, and only pattern points crossing the area boundary need a
+	 * clip path. This avoids most clip path changes in drawing, at the cost of
+	 * slightly less exact line ends at the area boundary.
+	 */
+	bool isGeometricPatternClippingEnabled() const;
+	
+	/**
+	 * Sets if area fill patterns are clipped geometrically.
+	 * 
+	 * Objects with area symbols need to be updated after changing this option.
+	 */
+	void setGeometricPatternClippingEnabled(bool enabled);
+	
+	
 	/** Returns the rendering options as an int representing Symbol::RenderableOptions. */
 	int renderableOptions() const;
 	
@@ -1304,6 +1551,28 @@ public:
 	 */
 	void setOtherDirty();
 	
+	/**
+	 * Returns a counter which is incremented whenever the map is marked as
+	 * having changes.
+	 * 
+	 * Unlike hasUnsavedChanges(), this counter is never reset. Comparing its
+	 * value allows to detect changes since a particular point in time,
+	 * e.g. since the last autosave.
+	 */
+	quint64 changeCount() const { return change_count; }
+	
+	/**
+	 * Returns a read-only snapshot of the current state of the map.
+	 * 
+	 * The snapshot may be read by other threads while this map is edited.
+	 * While the map is unchanged and a returned snapshot is still in use,
+	 * the same snapshot is returned again.
+	 * This must be called on the map's thread, while no edit is in progress.
+	 * 
+	 * \see MapSnapshot
+	 */
+	std::shared_ptr<const MapSnapshot> snapshot();
+	
 	
 	// Static
 	
@@ -1497,10 +1766,38 @@ private:
 	);
 	
 	
+	/**
+	 * Regenerates the output of the given objects, even if not dirty.
+	 * 
+	 * For large numbers of objects, the renderables are created concurrently,
+	 * while the map's renderables and widgets are updated on this thread.
+	 */
+	void regenerateObjects(const std::vector<const Object*>& objects);
+	
+	/**
+	 * Forces an update of all objects with any of the given symbols.
+	 */
+	void updateAllObjectsWithSymbols(const std::vector<const Symbol*>& symbols);
+	
 	void addSelectionRenderables(const Object* object);
 	void updateSelectionRenderables(const Object* object);
 	void removeSelectionRenderables(const Object* object);
 	
+	/** Discards the image of the selection drawn by drawSelection(). */
+	void invalidateSelectionCache();
+	
+	/**
+	 * Makes sure that color_usage counts the symbols using each color.
+	 * 
+	 * The counts are rebuilt when they were invalidated, or when colors or
+	 * symbols were added without the Map API, e.g. by file importers.
+	 */
+	void updateColorUsage() const;
+	/** Adds delta to the counts of the colors used by the symbol. */
+	void addColorUsage(const Symbol* symbol, int delta) const;
+	/** Discards the color usage counts. */
+	void invalidateColorUsage();
+	
 	static void initStatic();
 	
 	QExplicitlySharedDataPointer<MapColorSet> color_set;
@@ -1508,6 +1805,10 @@ private:
 	QString symbol_set_id;
 	SymbolVector symbols;
 	mutable qreal symbol_icon_scale = 0;
+	mutable QHash<const MapColor*, int> color_usage;  ///< The number of symbols using a color
+	mutable std::size_t color_usage_num_colors = 0;   ///< The number of colors counted in color_usage
+	mutable std::size_t color_usage_num_symbols = 0;  ///< The number of symbols counted in color_usage
+	mutable bool color_usage_valid = false;
 	TemplateVector templates;
 	TemplateVector closed_templates;
 	int first_front_template = 0;		// index of the first template in templates which should be drawn in front of the map
@@ -1519,6 +1820,10 @@ private:
 	WidgetVector widgets;
 	QScopedPointer<MapRenderables> renderables;
 	QScopedPointer<MapRenderables> selection_renderables;
+	struct SelectionCache;
+	std::unique_ptr<SelectionCache> selection_cache;
+	std::unique_ptr<MapTileCache> tile_cache;
+	std::weak_ptr<const MapSnapshot> last_snapshot;  ///< Reused while shared by someone
 	
 	QString map_notes;
 	
@@ -1541,9 +1846,22 @@ private:
 	bool objects_dirty;				//    ... for the objects?
 	bool other_dirty;				//    ... for any other settings?
 	bool unsaved_changes;			// are there unsaved changes for any component?
+	quint64 change_count = 0;		// incremented on every change
 	
 	std::set<Object*> irregular_objects;
 	
+	int dirty_area_batches = 0;              ///< The number of active DirtyAreaBatch objects, on the map's thread
+	std::vector<QRectF> pending_dirty_areas; ///< Dirty areas collected by a DirtyAreaBatch
+	
+	/// Lets the symbol icons be released when memory runs low.
+	CacheManager::Registration icon_cache_registration;
+	
+	/// Lets the path coords be released when memory runs low.
+	CacheManager::Registration path_coords_cache_registration;
+	
+	/// Periodically releases the path coords of objects which are not visible.
+	QTimer* path_coords_timer = nullptr;
+	
 	// Static
 	
 	static bool static_initialized;
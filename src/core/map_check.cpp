@@ -0,0 +1,480 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "map_check.h"
+
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+#include "core/map.h"
+#include "core/map_coord.h"
+#include "core/map_part.h"
+#include "core/path_coord.h"
+#include "core/spatial_index.h"
+#include "core/virtual_path.h"
+#include "core/objects/boolean_tool.h"
+#include "core/objects/object.h"
+#include "core/objects/text_object.h"
+#include "core/symbols/symbol.h"
+#include "undo/object_undo.h"
+#include "undo/undo.h"
+#include "util/concurrency.h"
+#include "util/util.h"
+
+
+namespace OpenOrienteering {
+
+namespace {
+
+/** Coordinates closer than this are regarded as connected, in mm. */
+constexpr qreal connect_tolerance = 0.005;
+
+
+/** The path objects with the same symbol in a single map part. */
+struct Group
+{
+	int part = 0;
+	std::vector<const PathObject*> objects;
+	SpatialIndex<std::size_t> index;
+};
+
+
+/**
+ * The objects which may duplicate each other: objects in the same map part,
+ * with the same symbol, type and number of coordinates.
+ */
+struct DuplicateGroup
+{
+	int part = 0;
+	std::vector<const Object*> objects;
+};
+
+
+QRectF around(const MapCoordF& pos, qreal radius)
+{
+	return { pos.x() - radius, pos.y() - radius, 2 * radius, 2 * radius };
+}
+
+
+/**
+ * Returns true if the given part of the object crosses the other object
+ * within the given distance from the part's start or end, respectively.
+ */
+bool overshoots(const PathObject& object, std::size_t part_index, bool at_start, const PathObject& other, qreal tolerance)
+{
+	PathObject::Intersections intersections;
+	object.calcAllIntersectionsWith(&other, intersections);
+	auto const& path_coords = object.parts()[part_index].path_coords;
+	return std::any_of(begin(intersections), end(intersections), [&](const PathObject::Intersection& intersection) {
+		if (intersection.part_index != part_index)
+			return false;
+		auto const distance = at_start ? intersection.length - path_coords.front().clen
+		                               : path_coords.back().clen - intersection.length;
+		return distance > connect_tolerance && distance <= tolerance;
+	});
+}
+
+
+/**
+ * Checks an end of an open part of a line object for gaps and overshoots.
+ */
+void checkLineEnd(const Group& group, std::size_t i, std::size_t part_index, bool at_start, qreal tolerance, std::vector<MapCheck::Issue>& issues)
+{
+	auto const& object = *group.objects[i];
+	auto const& part = object.parts()[part_index];
+	auto const& pos = at_start ? part.path_coords.front().pos : part.path_coords.back().pos;
+	
+	auto const tolerance_sq = tolerance * tolerance;
+	auto const connect_tolerance_sq = connect_tolerance * connect_tolerance;
+	
+	bool connected = false;
+	const PathObject* nearest = nullptr;
+	auto nearest_distance_sq = tolerance_sq;
+	const PathObject* overshot = nullptr;
+	
+	// An almost closed part leaves a gap between its ends.
+	// It is reported at the end only.
+	if (!at_start && part.length() > 2 * tolerance)
+	{
+		auto const distance_sq = pos.distanceSquaredTo(part.path_coords.front().pos);
+		if (distance_sq <= connect_tolerance_sq)
+		{
+			connected = true;
+		}
+		else if (distance_sq <= nearest_distance_sq)
+		{
+			nearest = &object;
+			nearest_distance_sq = distance_sq;
+		}
+	}
+	
+	group.index.query(around(pos, tolerance), [&](std::size_t j, const QRectF& /*extent*/) {
+		if (j == i)
+			return;
+		
+		auto const& other = *group.objects[j];
+		auto const distance_sq = other.findClosestPointTo(pos).distance_squared;
+		if (distance_sq > tolerance_sq)
+			return;
+		
+		if (distance_sq <= connect_tolerance_sq)
+		{
+			connected = true;
+		}
+		else if (distance_sq <= nearest_distance_sq)
+		{
+			nearest = &other;
+			nearest_distance_sq = distance_sq;
+		}
+		
+		// A crossing within the tolerance is close to the end, too.
+		if (!overshot && overshoots(object, part_index, at_start, other, tolerance))
+			overshot = &other;
+	});
+	
+	if (overshot)
+		issues.push_back({ MapCheck::DanglingLine, group.part, &object, overshot, around(pos, tolerance) });
+	else if (nearest && !connected)
+		issues.push_back({ MapCheck::Gap, group.part, &object, nearest == &object ? nullptr : nearest, around(pos, tolerance) });
+}
+
+
+/**
+ * Returns the extent of the overlap of two area objects.
+ * 
+ * Returns an invalid rect if the area of the overlap is less than min_area.
+ */
+QRectF overlap(const BooleanTool& tool, const PathObject& a, const PathObject& b, qreal min_area)
+{
+	// Shortcut for the common case of distinct areas
+	PathObject::Intersections intersections;
+	a.calcAllIntersectionsWith(&b, intersections);
+	if (intersections.empty()
+	    && !a.isPointInsideArea(b.parts().front().path_coords.front().pos)
+	    && !b.isPointInsideArea(a.parts().front().path_coords.front().pos))
+		return {};
+	
+	// BooleanTool doesn't modify the input objects.
+	BooleanTool::PathObjects in_objects = { const_cast<PathObject*>(&a), const_cast<PathObject*>(&b) };
+	BooleanTool::PathObjects out_objects;
+	if (!tool.executeForObjects(&a, in_objects, out_objects))
+		return {};
+	
+	qreal area = 0;
+	QRectF extent;
+	for (auto* object : out_objects)
+	{
+		object->updatePathCoords();
+		auto const& parts = object->parts();
+		if (!parts.empty())
+		{
+			// The first part is the outline, the other parts are holes.
+			area += parts.front().calculateArea();
+			std::for_each(begin(parts) + 1, end(parts), [&area](const PathPart& part) {
+				area -= part.calculateArea();
+			});
+			rectIncludeSafe(extent, parts.front().calculateExtent());
+		}
+		delete object;
+	}
+	return area >= min_area ? extent : QRectF();
+}
+
+
+/**
+ * Checks a single object, adding the issues to the given list.
+ */
+void checkObject(const Group& group, std::size_t i, const BooleanTool& tool, const MapCheck::Options& options, std::vector<MapCheck::Issue>& issues)
+{
+	auto const& object = *group.objects[i];
+	auto const& parts = object.parts();
+	auto const types = object.getSymbol()->getContainedTypes();
+	if (types & Symbol::Area)
+	{
+		for (auto const& part : parts)
+		{
+			if (!part.isClosed())
+			{
+				auto const extent = around(part.path_coords.front().pos, options.tolerance)
+				                    .united(around(part.path_coords.back().pos, options.tolerance));
+				issues.push_back({ MapCheck::UnclosedArea, group.part, &object, nullptr, extent });
+			}
+		}
+		
+		// Each pair is checked by the object with the lower index.
+		auto const& object_extent = object.getExtent();
+		group.index.query(object_extent, [&](std::size_t j, const QRectF& extent) {
+			if (j <= i || !extent.intersects(object_extent))
+				return;
+			
+			auto const& other = *group.objects[j];
+			auto const overlap_extent = overlap(tool, object, other, options.min_overlap_area);
+			if (overlap_extent.isValid())
+				issues.push_back({ MapCheck::OverlappingAreas, group.part, &object, &other, overlap_extent });
+		});
+	}
+	else if (types & Symbol::Line)
+	{
+		for (std::size_t part_index = 0; part_index < parts.size(); ++part_index)
+		{
+			if (parts[part_index].isClosed())
+				continue;
+			checkLineEnd(group, i, part_index, true, options.tolerance, issues);
+			checkLineEnd(group, i, part_index, false, options.tolerance, issues);
+		}
+	}
+}
+
+
+/**
+ * Returns true if the objects have the same geometry, up to the tolerance.
+ * 
+ * The objects must have the same symbol, type and number of coordinates.
+ */
+bool isDuplicate(const Object& object, const Object& other, qreal tolerance_sq)
+{
+	if (object.getType() == Object::Text)
+	{
+		auto const* text = object.asText();
+		auto const* other_text = other.asText();
+		if (text->getText() != other_text->getText()
+		    || text->getHorizontalAlignment() != other_text->getHorizontalAlignment()
+		    || text->getVerticalAlignment() != other_text->getVerticalAlignment()
+		    || text->hasSingleAnchor() != other_text->hasSingleAnchor()
+		    || (!text->hasSingleAnchor() && text->getBoxSize() != other_text->getBoxSize()))
+			return false;
+	}
+	if (object.getType() != Object::Path
+	    && qAbs(object.getRotation() - other.getRotation()) > 0.0001)
+		return false;
+	
+	auto const& coords = object.getRawCoordinateVector();
+	auto const& other_coords = other.getRawCoordinateVector();
+	return std::equal(begin(coords), end(coords), begin(other_coords), [tolerance_sq](const MapCoord& a, const MapCoord& b) {
+		return a.flags() == b.flags()
+		       && MapCoordF(a).distanceSquaredTo(MapCoordF(b)) <= tolerance_sq;
+	});
+}
+
+
+/**
+ * Finds the objects which duplicate an earlier object in the group.
+ * 
+ * Only objects which are not duplicates themselves are kept in the spatial
+ * index, keyed by their first coordinate. So each object is compared to
+ * the few distinct objects starting nearby, and stacks of copies don't
+ * lead to quadratic effort.
+ */
+void findDuplicates(const DuplicateGroup& group, qreal tolerance, std::vector<MapCheck::Issue>& issues)
+{
+	// Tiny boxes, so that exact duplicates are found with zero tolerance.
+	constexpr qreal box_size = 0.001;
+	auto const tolerance_sq = tolerance * tolerance;
+	
+	SpatialIndex<std::size_t> index;
+	for (std::size_t i = 0; i < group.objects.size(); ++i)
+	{
+		auto const& object = *group.objects[i];
+		auto const pos = MapCoordF(object.getRawCoordinateVector().front());
+		const Object* original = nullptr;
+		index.query(around(pos, tolerance + box_size), [&](std::size_t j, const QRectF& /*extent*/) {
+			if (!original && isDuplicate(object, *group.objects[j], tolerance_sq))
+				original = group.objects[j];
+		});
+		
+		if (original)
+			issues.push_back({ MapCheck::DuplicateObject, group.part, &object, original, object.getExtent() });
+		else
+			index.insert(i, around(pos, box_size));
+	}
+}
+
+
+/**
+ * Adds the duplicate objects in the map to the issues.
+ */
+void findDuplicates(const Map& map, qreal tolerance, std::vector<MapCheck::Issue>& issues)
+{
+	std::vector<DuplicateGroup> groups;
+	for (int part = 0; part < map.getNumParts(); ++part)
+	{
+		using Key = std::tuple<const Symbol*, Object::Type, std::size_t>;
+		std::map<Key, std::size_t> object_groups;
+		const auto* map_part = map.getPart(part);
+		map_part->applyOnAllObjects([&](const Object* object) {
+			auto const& coords = object->getRawCoordinateVector();
+			if (!object->getSymbol() || coords.empty())
+				return;
+			
+			auto const found = object_groups.emplace(Key{ object->getSymbol(), object->getType(), coords.size() }, groups.size());
+			if (found.second)
+			{
+				groups.emplace_back();
+				groups.back().part = part;
+			}
+			groups[found.first->second].objects.push_back(object);
+		});
+	}
+	
+	std::vector<std::vector<MapCheck::Issue>> group_issues(groups.size());
+	Concurrency::parallelFor(0, int(groups.size()), [&](int g) {
+		findDuplicates(groups[std::size_t(g)], tolerance, group_issues[std::size_t(g)]);
+	});
+	
+	for (auto const& duplicates : group_issues)
+		issues.insert(end(issues), begin(duplicates), end(duplicates));
+}
+
+
+}  // namespace
+
+
+
+// static
+MapCheck MapCheck::run(Map& map, const Options& options)
+{
+	// The objects must be up-to-date before they are used concurrently.
+	map.updateObjects();
+	
+	std::vector<Group> groups;
+	for (int part = 0; part < map.getNumParts(); ++part)
+	{
+		std::unordered_map<const Symbol*, std::size_t> symbol_groups;
+		const auto* map_part = map.getPart(part);
+		map_part->applyOnAllObjects([&](const Object* object) {
+			auto const* symbol = object->getSymbol();
+			if (object->getType() != Object::Path
+			    || !symbol
+			    || !(symbol->getContainedTypes() & (Symbol::Line | Symbol::Area))
+			    || object->asPath()->parts().empty())
+				return;
+			
+			auto const found = symbol_groups.emplace(symbol, groups.size());
+			if (found.second)
+			{
+				groups.emplace_back();
+				groups.back().part = part;
+			}
+			groups[found.first->second].objects.push_back(object->asPath());
+		});
+	}
+	
+	Concurrency::parallelFor(0, int(groups.size()), [&groups](int g) {
+		auto& group = groups[std::size_t(g)];
+		for (std::size_t i = 0; i < group.objects.size(); ++i)
+			group.index.insert(i, group.objects[i]->getExtent());
+	});
+	
+	// Work items are (group, object) pairs, in the order of the results.
+	std::vector<std::pair<std::size_t, std::size_t>> items;
+	for (std::size_t g = 0; g < groups.size(); ++g)
+	{
+		for (std::size_t i = 0; i < groups[g].objects.size(); ++i)
+			items.emplace_back(g, i);
+	}
+	
+	std::vector<std::vector<Issue>> item_issues(items.size());
+	BooleanTool const tool(BooleanTool::Intersection, &map);
+	Concurrency::parallelFor(0, int(items.size()), [&](int k) {
+		auto const& item = items[std::size_t(k)];
+		checkObject(groups[item.first], item.second, tool, options, item_issues[std::size_t(k)]);
+	}, 64);
+	
+	MapCheck result;
+	for (auto const& issues : item_issues)
+		result.issues.insert(end(result.issues), begin(issues), end(issues));
+	if (options.duplicate_tolerance >= 0)
+		findDuplicates(map, options.duplicate_tolerance, result.issues);
+	return result;
+}
+
+
+std::size_t MapCheck::count(IssueType type) const
+{
+	return std::size_t(std::count_if(begin(issues), end(issues), [type](const Issue& issue) {
+		return issue.type == type;
+	}));
+}
+
+
+std::size_t MapCheck::removeDuplicates(Map& map) const
+{
+	std::vector<std::vector<Object*>> duplicates(std::size_t(map.getNumParts()));
+	for (auto const& issue : issues)
+	{
+		if (issue.type == DuplicateObject && issue.part < map.getNumParts())
+			duplicates[std::size_t(issue.part)].push_back(const_cast<Object*>(issue.object));
+	}
+	
+	Map::DirtyAreaBatch batch(map);
+	auto* undo_step = new CombinedUndoStep(&map);
+	auto selection_changed = false;
+	std::size_t removed = 0;
+	for (std::size_t p = 0; p < duplicates.size(); ++p)
+	{
+		if (duplicates[p].empty())
+			continue;
+		
+		// Record the indices before releasing all objects in a single pass.
+		auto* part = map.getPart(p);
+		auto const candidates = std::unordered_set<const Object*>(begin(duplicates[p]), end(duplicates[p]));
+		auto* step = new AddObjectsUndoStep(&map);
+		step->setPartIndex(int(p));
+		for (int i = 0; i < part->getNumObjects(); ++i)
+		{
+			auto* object = part->getObject(i);
+			if (candidates.count(object) == 0)
+				continue;
+			
+			if (map.isObjectSelected(object))
+			{
+				map.removeObjectFromSelection(object, false);
+				selection_changed = true;
+			}
+			step->addObject(i, object);
+		}
+		removed += part->releaseObjects(duplicates[p]).size();
+		
+		if (step->isEmpty())
+			delete step;
+		else
+			undo_step->push(step);
+	}
+	
+	if (selection_changed)
+		map.emitSelectionChanged();
+	if (removed == 0)
+	{
+		delete undo_step;
+		return 0;
+	}
+	
+	map.setObjectsDirty();
+	map.push(undo_step);
+	return removed;
+}
+
+
+}  // namespace OpenOrienteering
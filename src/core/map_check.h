@@ -0,0 +1,128 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#ifndef OPENORIENTEERING_MAP_CHECK_H
+#define OPENORIENTEERING_MAP_CHECK_H
+
+#include <cstddef>
+#include <vector>
+
+#include <QtGlobal>
+#include <QRectF>
+
+namespace OpenOrienteering {
+
+class Map;
+class Object;
+
+
+/**
+ * A check of the map objects for common topology errors.
+ * 
+ * The check examines the path objects in each map part, and it compares
+ * objects with the same symbol only. It reports:
+ * 
+ * - Unclosed areas: Parts of area objects which are not closed.
+ * - Overlapping areas: Area objects which overlap each other.
+ * - Gaps: Line ends which are close to another line, or to the other end
+ *   of the same line, but not connected to it.
+ * - Dangling lines: Line ends which overshoot another line by a short
+ *   distance.
+ * - Duplicate objects: Objects of any type which repeat an earlier object
+ *   with the same symbol, up to a small tolerance.
+ * 
+ * Candidate pairs of objects are found via spatial indexes, and the
+ * objects are checked concurrently.
+ */
+struct MapCheck
+{
+	/** The kinds of issues found by the check. */
+	enum IssueType
+	{
+		UnclosedArea,
+		OverlappingAreas,
+		Gap,
+		DanglingLine,
+		DuplicateObject
+	};
+	
+	/** Parameters of the check. */
+	struct Options
+	{
+		/** The maximum size of gaps and overshoots, in mm. */
+		qreal tolerance = 0.5;
+		
+		/** The minimum size of reported overlaps, in mm². */
+		qreal min_overlap_area = 0.01;
+		
+		/**
+		 * The maximum distance of the coordinates of duplicate objects, in mm.
+		 * 
+		 * Zero finds exact duplicates only. A negative value disables the
+		 * search for duplicates.
+		 */
+		qreal duplicate_tolerance = 0.01;
+	};
+	
+	/** A single issue. */
+	struct Issue
+	{
+		IssueType type;
+		int part;                     ///< The index of the map part
+		const Object* object;         ///< The object with the issue
+		const Object* other;          ///< The other object involved, or nullptr
+		QRectF extent;                ///< The location of the issue, in map coordinates
+	};
+	
+	/**
+	 * The issues, ordered by map part, symbol and object.
+	 * 
+	 * Duplicate objects follow the other issues. For these issues, \c other
+	 * is the earlier object which is duplicated by \c object.
+	 */
+	std::vector<Issue> issues;
+	
+	
+	/**
+	 * Checks the given map.
+	 * 
+	 * This updates the objects first. The map must not be modified while
+	 * the check is running.
+	 */
+	static MapCheck run(Map& map, const Options& options);
+	
+	/** Returns the number of issues of the given type. */
+	std::size_t count(IssueType type) const;
+	
+	/**
+	 * Deletes the duplicate objects from the map, as a single undo step.
+	 * 
+	 * The map must not have been modified since the check.
+	 * Returns the number of deleted objects.
+	 */
+	std::size_t removeDuplicates(Map& map) const;
+	
+};
+
+
+}  // namespace OpenOrienteering
+
+#endif
@@ -217,6 +217,13 @@ MapCoord MapCoord::fromNative64withOffset(qint64 x64, qint64 y64)
 	return MapCoord { static_cast<qint32>(x64), static_cast<qint32>(y64), Flags() };
 }
 
+MapCoord MapCoord::loadNative(qint64 x64, qint64 y64, Flags flags)
+{
+	handleBoundsOffset(x64, y64);
+	ensureBoundsForQint32(x64, y64);
+	return MapCoord { static_cast<qint32>(x64), static_cast<qint32>(y64), flags };
+}
+
 void MapCoord::save(QXmlStreamWriter& xml) const
 {
 	XmlElementWriter element(xml, XmlStreamLiteral::coord);
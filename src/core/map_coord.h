@@ -246,6 +246,14 @@ public:
 	 */
 	static MapCoord fromNative64withOffset(qint64 x, qint64 y);
 	
+	/** Creates a MapCoord from native map coordinates, with offset handling.
+	 * 
+	 * This will initialize the boundsOffset() if necessary. Otherwise it will
+	 * apply the BoundsOffset() and throw a std::range_error if the adjusted
+	 * coordinates are out of bounds for qint32.
+	 */
+	static MapCoord loadNative(qint64 x, qint64 y, MapCoord::Flags flags);
+	
 	
 	/** Assignment operator */
 	MapCoord& operator= (const MapCoord& other) = default;
@@ -0,0 +1,550 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#include "map_diff.h"
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <unordered_set>
+#include <utility>
+
+#include <Qt>
+#include <QHash>
+#include <QLatin1Char>
+#include <QRectF>
+#include <QString>
+
+#include "core/map.h"
+#include "core/map_coord.h"
+#include "core/map_part.h"
+#include "core/spatial_index.h"
+#include "core/objects/object.h"
+#include "core/objects/text_object.h"
+#include "core/symbols/symbol.h"
+#include "undo/object_undo.h"
+#include "undo/undo.h"
+#include "util/concurrency.h"
+
+
+namespace OpenOrienteering {
+
+namespace {
+
+/** Coordinate extents are enlarged by this margin before comparing them, in mm. */
+constexpr qreal extent_margin = 0.5;
+
+/** The minimum ratio of common area to total area for a modified object. */
+constexpr qreal min_overlap = 0.5;
+
+
+quint64 combine(quint64 seed, quint64 value) noexcept
+{
+	return seed ^ (value + Q_UINT64_C(0x9e3779b97f4a7c15) + (seed << 6) + (seed >> 2));
+}
+
+quint64 coordHash(const MapCoord& coord) noexcept
+{
+	auto hash = combine(quint32(coord.nativeX()), quint32(coord.nativeY()));
+	return combine(hash, coord.flags());
+}
+
+/**
+ * Returns a hash of the object which is equal for objects which are equal
+ * in the sense of Object::equals(), and with symbols of the same class.
+ * 
+ * The rotation is ignored because Object::equals() uses a tolerance for it.
+ */
+quint64 objectHash(const Object& object, int symbol_class)
+{
+	auto hash = combine(quint64(object.getType()), quint64(qint64(symbol_class)));
+	
+	auto const& coords = object.getRawCoordinateVector();
+	if (object.getType() == Object::Text)
+	{
+		if (!coords.empty())
+			hash = combine(hash, coordHash(coords.front()));
+		
+		auto const& text = static_cast<const TextObject&>(object);
+		hash = combine(hash, qHash(text.getText()));
+		hash = combine(hash, coordHash(text.getBoxSize()));
+		hash = combine(hash, quint64(text.getHorizontalAlignment()) << 8 | quint64(text.getVerticalAlignment()));
+	}
+	else
+	{
+		for (auto const& coord : coords)
+			hash = combine(hash, coordHash(coord));
+		
+		if (object.getType() == Object::Path)
+			hash = combine(hash, coordHash(static_cast<const PathObject&>(object).getPatternOrigin()));
+	}
+	
+	// Independent of the order of the tags
+	quint64 tags_hash = 0;
+	for (auto tag = object.tags().begin(); tag != object.tags().end(); ++tag)
+		tags_hash += combine(qHash(tag.key()), qHash(tag.value()));
+	return combine(hash, tags_hash);
+}
+
+/** Returns the extent of the object's coordinates, with a margin. */
+QRectF coordsExtent(const Object& object)
+{
+	auto const& coords = object.getRawCoordinateVector();
+	if (coords.empty())
+		return {};
+	
+	auto left = std::numeric_limits<qreal>::max();
+	auto top = left;
+	auto right = std::numeric_limits<qreal>::lowest();
+	auto bottom = right;
+	for (auto const& coord : coords)
+	{
+		left = std::min(left, coord.x());
+		right = std::max(right, coord.x());
+		top = std::min(top, coord.y());
+		bottom = std::max(bottom, coord.y());
+	}
+	return QRectF(left, top, right - left, bottom - top)
+	        .adjusted(-extent_margin, -extent_margin, extent_margin, extent_margin);
+}
+
+/** Returns the ratio of the common area to the total area of both rects. */
+qreal overlap(const QRectF& a, const QRectF& b)
+{
+	auto const common = a.intersected(b);
+	if (common.isEmpty())
+		return 0;
+	auto const common_area = common.width() * common.height();
+	return common_area / (a.width() * a.height() + b.width() * b.height() - common_area);
+}
+
+
+/** The objects of a map, with the data needed for matching them. */
+struct ObjectTable
+{
+	std::vector<const Object*> objects;
+	std::vector<int> symbol_classes;
+	std::vector<quint64> hashes;
+	std::vector<QRectF> extents;
+	std::vector<bool> matched;
+	
+	ObjectTable(const Map& map, const std::unordered_map<const Symbol*, int>& classes)
+	{
+		objects.reserve(std::size_t(map.getNumObjects()));
+		for (int i = 0; i < map.getNumParts(); ++i)
+		{
+			auto const* part = map.getPart(std::size_t(i));
+			for (int j = 0; j < part->getNumObjects(); ++j)
+				objects.push_back(part->getObject(j));
+		}
+		
+		auto const size = objects.size();
+		symbol_classes.resize(size);
+		hashes.resize(size);
+		extents.resize(size);
+		matched.resize(size, false);
+		Concurrency::parallelFor(0, int(size), [this, &classes](int i) {
+			auto const index = std::size_t(i);
+			auto const* object = objects[index];
+			auto const symbol_class = classes.find(object->getSymbol());
+			symbol_classes[index] = symbol_class != classes.end() ? symbol_class->second : -1;
+			hashes[index] = objectHash(*object, symbol_classes[index]);
+			extents[index] = coordsExtent(*object);
+		}, 256);
+	}
+	
+	std::size_t size() const noexcept { return objects.size(); }
+};
+
+
+/**
+ * Assigns equal classes to the symbols which are equal in both maps.
+ * 
+ * The symbols of the new map get classes 0..n-1. The symbols of the old
+ * map get the class of an equal symbol in the new map, or n + their index.
+ */
+void classifySymbols(const Map& old_map, const Map& new_map,
+                     std::unordered_map<const Symbol*, int>& old_classes,
+                     std::unordered_map<const Symbol*, int>& new_classes)
+{
+	auto const key = [](const Symbol* symbol) {
+		return symbol->getNumberAsString() + QLatin1Char(' ') + QString::number(int(symbol->getType()));
+	};
+	
+	QHash<QString, std::vector<int>> candidates;
+	auto const num_new_symbols = new_map.getNumSymbols();
+	for (int i = 0; i < num_new_symbols; ++i)
+	{
+		auto const* symbol = new_map.getSymbol(i);
+		new_classes.emplace(symbol, i);
+		candidates[key(symbol)].push_back(i);
+	}
+	
+	for (int i = 0; i < old_map.getNumSymbols(); ++i)
+	{
+		auto const* symbol = old_map.getSymbol(i);
+		auto symbol_class = num_new_symbols + i;
+		auto const found = candidates.constFind(key(symbol));
+		if (found != candidates.constEnd())
+		{
+			for (auto j : *found)
+			{
+				if (symbol->equals(new_map.getSymbol(j)))
+				{
+					symbol_class = j;
+					break;
+				}
+			}
+		}
+		old_classes.emplace(symbol, symbol_class);
+	}
+}
+
+
+}  // namespace
+
+
+
+// ### MapDiff ###
+
+// static
+MapDiff MapDiff::compare(const Map& old_map, const Map& new_map)
+{
+	std::unordered_map<const Symbol*, int> old_classes;
+	std::unordered_map<const Symbol*, int> new_classes;
+	classifySymbols(old_map, new_map, old_classes, new_classes);
+	
+	ObjectTable old_table(old_map, old_classes);
+	ObjectTable new_table(new_map, new_classes);
+	
+	auto const equal = [&old_table, &new_table](std::size_t i, std::size_t j) {
+		return old_table.symbol_classes[i] == new_table.symbol_classes[j]
+		       && old_table.objects[i]->equals(new_table.objects[j], false);
+	};
+	
+	MapDiff diff;
+	diff.matches.reserve(old_table.size());
+	
+	// Unchanged objects, via the hashes
+	std::vector<std::pair<quint64, std::size_t>> new_hashes;
+	new_hashes.reserve(new_table.size());
+	for (std::size_t j = 0; j < new_table.size(); ++j)
+		new_hashes.emplace_back(new_table.hashes[j], j);
+	std::sort(begin(new_hashes), end(new_hashes));
+	
+	auto const by_hash = [](const std::pair<quint64, std::size_t>& a, const std::pair<quint64, std::size_t>& b) {
+		return a.first < b.first;
+	};
+	for (std::size_t i = 0; i < old_table.size(); ++i)
+	{
+		auto const range = std::equal_range(begin(new_hashes), end(new_hashes), std::make_pair(old_table.hashes[i], std::size_t(0)), by_hash);
+		for (auto candidate = range.first; candidate != range.second; ++candidate)
+		{
+			auto const j = candidate->second;
+			if (!new_table.matched[j] && equal(i, j))
+			{
+				old_table.matched[i] = new_table.matched[j] = true;
+				diff.matches.emplace(old_table.objects[i], Match{ new_table.objects[j], false });
+				++diff.unchanged;
+				break;
+			}
+		}
+	}
+	
+	// Modified objects, via the extents of the remaining objects
+	SpatialIndex<std::size_t> index;
+	for (std::size_t j = 0; j < new_table.size(); ++j)
+	{
+		if (!new_table.matched[j] && new_table.extents[j].isValid())
+			index.insert(j, new_table.extents[j]);
+	}
+	
+	for (std::size_t i = 0; i < old_table.size(); ++i)
+	{
+		if (old_table.matched[i] || index.empty())
+			continue;
+		
+		auto const* object = old_table.objects[i];
+		auto const& extent = old_table.extents[i];
+		auto best = std::numeric_limits<std::size_t>::max();
+		auto best_score = 0.0;
+		index.query(extent, [&](std::size_t j, const QRectF& other_extent) {
+			if (new_table.objects[j]->getType() != object->getType())
+				return;
+			auto const ratio = overlap(extent, other_extent);
+			if (ratio < min_overlap)
+				return;
+			auto const score = ratio + (old_table.symbol_classes[i] == new_table.symbol_classes[j] ? 1 : 0);
+			if (score > best_score)
+			{
+				best = j;
+				best_score = score;
+			}
+		});
+		if (best_score == 0)
+			continue;
+		
+		index.remove(best);
+		old_table.matched[i] = new_table.matched[best] = true;
+		// Most likely unequal, but the hash ignores the rotation.
+		auto const modified = !equal(i, best);
+		diff.matches.emplace(object, Match{ new_table.objects[best], modified });
+		if (modified)
+			diff.changes.push_back({ Modified, object, new_table.objects[best] });
+		else
+			++diff.unchanged;
+	}
+	
+	// Deleted and added objects, merged with the modified objects in old order
+	std::vector<Change> changes;
+	changes.reserve(diff.changes.size() + old_table.size() - diff.matches.size());
+	auto modified = begin(diff.changes);
+	for (std::size_t i = 0; i < old_table.size(); ++i)
+	{
+		auto const* object = old_table.objects[i];
+		if (!old_table.matched[i])
+			changes.push_back({ Deleted, object, nullptr });
+		else if (modified != end(diff.changes) && modified->old_object == object)
+			changes.push_back(*modified++);
+	}
+	for (std::size_t j = 0; j < new_table.size(); ++j)
+	{
+		if (!new_table.matched[j])
+			changes.push_back({ Added, nullptr, new_table.objects[j] });
+	}
+	diff.changes = std::move(changes);
+	
+	return diff;
+}
+
+
+std::size_t MapDiff::count(ChangeType type) const
+{
+	return std::size_t(std::count_if(begin(changes), end(changes), [type](const Change& change) {
+		return change.type == type;
+	}));
+}
+
+
+const Object* MapDiff::counterpart(const Object* old_object) const
+{
+	auto const match = matches.find(old_object);
+	return match != matches.end() ? match->second.object : nullptr;
+}
+
+
+bool MapDiff::isUnchanged(const Object* old_object) const
+{
+	auto const match = matches.find(old_object);
+	return match != matches.end() && !match->second.modified;
+}
+
+
+// static
+bool MapDiff::apply(Map& map, const Map& source, const std::vector<Change>& changes)
+{
+	if (changes.empty())
+		return false;
+	
+	// The symbols and colors needed by the new objects
+	std::vector<bool> symbol_filter(std::size_t(source.getNumSymbols()), false);
+	std::unordered_set<const Object*> added;
+	std::unordered_map<const Object*, const Change*> by_old_object;
+	for (auto const& change : changes)
+	{
+		if (change.new_object && change.new_object->getSymbol())
+		{
+			auto const symbol_index = source.findSymbolIndex(change.new_object->getSymbol());
+			if (symbol_index >= 0)
+				symbol_filter[std::size_t(symbol_index)] = true;
+		}
+		if (change.type == Added)
+			added.insert(change.new_object);
+		else
+			by_old_object.emplace(change.old_object, &change);
+	}
+	auto const symbol_map = map.importMap(source, Map::MinimalSymbolImport, &symbol_filter);
+	auto const copy = [&symbol_map](const Object* object) {
+		auto* new_object = object->duplicate();
+		auto const replacement = symbol_map.constFind(new_object->getSymbol());
+		if (replacement != symbol_map.constEnd())
+			new_object->setSymbol(*replacement, true);
+		return new_object;
+	};
+	
+	Map::DirtyAreaBatch batch(map);
+	auto* undo_step = new CombinedUndoStep(&map);
+	auto const push = [undo_step](ObjectModifyingUndoStep* step) {
+		if (step->isEmpty())
+			delete step;
+		else
+			undo_step->push(step);
+	};
+	auto selection_changed = false;
+	
+	// Replace and delete in descending order, so that the indices stay valid.
+	// Undoing the deletions first restores the indices for the replacements.
+	for (int p = 0; p < map.getNumParts() && !by_old_object.empty(); ++p)
+	{
+		auto* part = map.getPart(std::size_t(p));
+		auto* replace_step = new ReplaceObjectsUndoStep(&map);
+		replace_step->setPartIndex(p);
+		auto* add_step = new AddObjectsUndoStep(&map);
+		add_step->setPartIndex(p);
+		for (auto i = part->getNumObjects() - 1; i >= 0; --i)
+		{
+			auto* object = part->getObject(i);
+			auto const change = by_old_object.find(object);
+			if (change == by_old_object.end())
+				continue;
+			
+			if (map.isObjectSelected(object))
+			{
+				map.removeObjectFromSelection(object, false);
+				selection_changed = true;
+			}
+			if (change->second->type == Modified)
+			{
+				replace_step->addObject(i, object);
+				part->setObject(copy(change->second->new_object), i, false);
+			}
+			else
+			{
+				add_step->addObject(i, object);
+				part->releaseObject(i);
+			}
+			by_old_object.erase(change);
+		}
+		push(replace_step);
+		push(add_step);
+	}
+	
+	// Add the new objects, in the order of the source map
+	for (int p = 0; p < source.getNumParts() && !added.empty(); ++p)
+	{
+		auto const* source_part = source.getPart(std::size_t(p));
+		auto part_index = int(map.getCurrentPartIndex());
+		for (int i = 0; i < map.getNumParts(); ++i)
+		{
+			if (map.getPart(std::size_t(i))->getName().compare(source_part->getName(), Qt::CaseInsensitive) == 0)
+			{
+				part_index = i;
+				break;
+			}
+		}
+		auto* part = map.getPart(std::size_t(part_index));
+		
+		auto* delete_step = new DeleteObjectsUndoStep(&map);
+		delete_step->setPartIndex(part_index);
+		for (int i = 0; i < source_part->getNumObjects(); ++i)
+		{
+			auto const* object = source_part->getObject(i);
+			if (added.erase(object) == 0)
+				continue;
+			part->addObject(copy(object));
+			delete_step->addObject(part->getNumObjects() - 1);
+		}
+		push(delete_step);
+	}
+	
+	if (selection_changed)
+		map.emitSelectionChanged();
+	
+	if (undo_step->getNumSubSteps() == 0)
+	{
+		delete undo_step;
+		return false;
+	}
+	
+	map.setObjectsDirty();
+	map.push(undo_step);
+	return true;
+}
+
+
+
+// ### MapMerge ###
+
+// static
+MapMerge MapMerge::run(const Map& base, const Map& ours, const Map& theirs)
+{
+	auto const our_diff = MapDiff::compare(base, ours);
+	auto const their_diff = MapDiff::compare(base, theirs);
+	
+	// Objects added on our side, to avoid duplicates
+	std::unordered_multimap<quint64, const Object*> our_additions;
+	for (auto const& change : our_diff.changes)
+	{
+		if (change.type == MapDiff::Added)
+			our_additions.emplace(objectHash(*change.new_object, 0), change.new_object);
+	}
+	
+	MapMerge merge;
+	for (auto const& change : their_diff.changes)
+	{
+		switch (change.type)
+		{
+		case MapDiff::Added:
+			{
+				auto const range = our_additions.equal_range(objectHash(*change.new_object, 0));
+				auto const found = std::find_if(range.first, range.second, [&change](const std::pair<const quint64, const Object*>& entry) {
+					return entry.second->equals(change.new_object, true);
+				});
+				if (found != range.second)
+					our_additions.erase(found);
+				else
+					merge.changes.push_back(change);
+			}
+			break;
+			
+		case MapDiff::Deleted:
+			if (auto const* our_object = our_diff.counterpart(change.old_object))
+			{
+				if (our_diff.isUnchanged(change.old_object))
+					merge.changes.push_back({ MapDiff::Deleted, our_object, nullptr });
+				else
+					merge.conflicts.push_back({ change.old_object, our_object, nullptr });
+			}
+			break;
+			
+		case MapDiff::Modified:
+			{
+				auto const* our_object = our_diff.counterpart(change.old_object);
+				if (our_object && our_diff.isUnchanged(change.old_object))
+					merge.changes.push_back({ MapDiff::Modified, our_object, change.new_object });
+				else if (!our_object || !our_object->equals(change.new_object, true))
+					merge.conflicts.push_back({ change.old_object, our_object, change.new_object });
+			}
+			break;
+		}
+	}
+	
+	return merge;
+}
+
+
+bool MapMerge::apply(Map& ours, const Map& theirs) const
+{
+	return MapDiff::apply(ours, theirs, changes);
+}
+
+
+}  // namespace OpenOrienteering
@@ -0,0 +1,185 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef OPENORIENTEERING_MAP_DIFF_H
+#define OPENORIENTEERING_MAP_DIFF_H
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+#include <QtGlobal>
+
+namespace OpenOrienteering {
+
+class Map;
+class Object;
+
+
+/**
+ * The differences between the objects of two versions of a map.
+ * 
+ * Objects are matched regardless of their order and map part:
+ * 
+ * - Objects which are equal in the sense of Object::equals() are unchanged.
+ *   Candidates are found via a hash of the object's type, symbol,
+ *   coordinates, tags and type-specific properties, so the number of
+ *   comparisons grows linearly with the number of objects.
+ * - Among the remaining objects, an object of the same type whose
+ *   coordinates cover nearly the same area is regarded as a modified
+ *   version. Candidates are found via a spatial index. Objects with the same
+ *   symbol are preferred.
+ * - All other objects are deleted or added.
+ * 
+ * Symbols of the two maps are matched by Symbol::equals(), so the maps do
+ * not need to share the same symbol set.
+ */
+struct MapDiff
+{
+	/** The kinds of changes. */
+	enum ChangeType
+	{
+		Added,
+		Deleted,
+		Modified
+	};
+	
+	/** A single change. */
+	struct Change
+	{
+		ChangeType type;
+		const Object* old_object;     ///< The object in the old map, or nullptr when added
+		const Object* new_object;     ///< The object in the new map, or nullptr when deleted
+	};
+	
+	/** The changes, in the order of the objects in the old map, followed by the added objects. */
+	std::vector<Change> changes;
+	
+	/** The number of unchanged objects. */
+	std::size_t unchanged = 0;
+	
+	
+	/**
+	 * Compares two versions of a map.
+	 * 
+	 * This updates neither map. The maps must not be modified while the
+	 * result is in use.
+	 */
+	static MapDiff compare(const Map& old_map, const Map& new_map);
+	
+	/** Returns the number of changes of the given type. */
+	std::size_t count(ChangeType type) const;
+	
+	/**
+	 * Returns the object of the new map which corresponds to the given
+	 * object of the old map.
+	 * 
+	 * Returns nullptr if the object was deleted.
+	 */
+	const Object* counterpart(const Object* old_object) const;
+	
+	/** Returns true if the given object of the old map is unchanged. */
+	bool isUnchanged(const Object* old_object) const;
+	
+	
+	/**
+	 * Applies changes to a map, as a single undo step.
+	 * 
+	 * The old objects of the changes must be objects of the given map, and
+	 * the new objects must be objects of the source map. Added and modified
+	 * objects are copied from the source map, together with the symbols and
+	 * colors they need. Added objects go to the map part with the same name
+	 * as in the source map, or to the current part.
+	 * 
+	 * To make map equal to source, apply compare(map, source).changes.
+	 * 
+	 * Returns false if there was nothing to change.
+	 */
+	static bool apply(Map& map, const Map& source, const std::vector<Change>& changes);
+	
+private:
+	struct Match
+	{
+		const Object* object;
+		bool modified;
+	};
+	
+	/** Objects of the old map which have a counterpart in the new map. */
+	std::unordered_map<const Object*, Match> matches;
+	
+};
+
+
+
+/**
+ * A three-way merge of the objects of two versions of a map which share a
+ * common base version.
+ * 
+ * The merge brings the changes from the base version to "their" version
+ * into "our" version:
+ * 
+ * - Objects added by them are added, unless we added an equal object.
+ * - Objects deleted or modified by them are deleted or replaced, if we
+ *   didn't change them.
+ * - Objects changed by both sides are conflicts unless the results are
+ *   equal. Conflicts are not resolved: Our version is kept.
+ */
+struct MapMerge
+{
+	/** An object which was changed differently by both sides. */
+	struct Conflict
+	{
+		const Object* base_object;    ///< The object in the base version
+		const Object* our_object;     ///< The object in our version, or nullptr when deleted
+		const Object* their_object;   ///< The object in their version, or nullptr when deleted
+	};
+	
+	/**
+	 * The changes which bring their changes into our version.
+	 * 
+	 * The old objects are objects of our version, and the new objects are
+	 * objects of their version, cf. MapDiff::apply().
+	 */
+	std::vector<MapDiff::Change> changes;
+	
+	/** The conflicts, in the order of the objects in the base version. */
+	std::vector<Conflict> conflicts;
+	
+	
+	/**
+	 * Merges two versions of the base map.
+	 * 
+	 * The maps must not be modified while the result is in use.
+	 */
+	static MapMerge run(const Map& base, const Map& ours, const Map& theirs);
+	
+	/**
+	 * Applies the changes to our version, as a single undo step.
+	 * 
+	 * Returns false if there was nothing to change.
+	 */
+	bool apply(Map& ours, const Map& theirs) const;
+	
+};
+
+
+}  // namespace OpenOrienteering
+
+#endif
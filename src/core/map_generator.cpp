@@ -0,0 +1,213 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "map_generator.h"
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include <QLatin1String>
+#include <QString>
+
+#include "core/map.h"
+#include "core/map_coord.h"
+#include "core/map_part.h"
+#include "core/objects/object.h"
+#include "core/objects/text_object.h"
+#include "core/symbols/line_symbol.h"
+#include "core/symbols/symbol.h"
+
+
+namespace OpenOrienteering {
+
+namespace {
+
+enum Kind
+{
+	AreaKind,
+	LineKind,
+	DashedLineKind,
+	PointKind,
+	TextKind,
+	NumKinds
+};
+
+}  // namespace
+
+
+
+int MapGenerator::Options::numObjects() const
+{
+	return areas + lines + dashed_lines + points + texts;
+}
+
+
+// static
+MapGenerator::Options MapGenerator::mixedOptions(int num_objects)
+{
+	Options options;
+	options.areas = num_objects * 4 / 10;
+	options.lines = num_objects * 2 / 10;
+	options.dashed_lines = num_objects / 10;
+	options.points = num_objects * 2 / 10;
+	options.texts = num_objects - options.areas - options.lines - options.dashed_lines - options.points;
+	options.tags = 2;
+	return options;
+}
+
+
+
+MapGenerator::MapGenerator(const Options& options)
+: opts(options)
+{
+	// nothing else
+}
+
+
+bool MapGenerator::generate(Map& map) const
+{
+	std::array<int, NumKinds> const counts = {{
+	    opts.areas, opts.lines, opts.dashed_lines, opts.points, opts.texts
+	}};
+	
+	std::array<std::vector<const Symbol*>, NumKinds> symbols;
+	for (int i = 0; i < map.getNumSymbols(); ++i)
+	{
+		const auto* symbol = map.getSymbol(i);
+		if (symbol->isHelperSymbol() || symbol->isHidden())
+			continue;
+		switch (symbol->getType())
+		{
+		case Symbol::Area:
+			symbols[AreaKind].push_back(symbol);
+			break;
+		case Symbol::Line:
+			if (symbol->asLine()->isDashed())
+				symbols[DashedLineKind].push_back(symbol);
+			else
+				symbols[LineKind].push_back(symbol);
+			break;
+		case Symbol::Point:
+			symbols[PointKind].push_back(symbol);
+			break;
+		case Symbol::Text:
+			symbols[TextKind].push_back(symbol);
+			break;
+		default:
+			;  // nothing
+		}
+	}
+	for (int kind = 0; kind < NumKinds; ++kind)
+	{
+		if (counts[kind] > 0 && symbols[kind].empty())
+			return false;
+	}
+	
+	map.clearObjectSelection(false);
+	for (int i = 0; i < map.getNumParts(); ++i)
+	{
+		auto* part = map.getPart(i);
+		for (int j = part->getNumObjects() - 1; j >= 0; --j)
+			part->deleteObject(j);
+	}
+	
+	auto* part = map.getCurrentPart();
+	auto const num_objects = opts.numObjects();
+	auto const columns = qMax(1, int(std::ceil(std::sqrt(num_objects))));
+	auto const num_vertices = qMax(3, opts.vertices);
+	auto const cell_size = opts.spacing * 0.7;
+	auto const radius = cell_size / 2;
+	
+	std::array<int, NumKinds> emitted = {};
+	for (int i = 0; i < num_objects; ++i)
+	{
+		// Take the kind which is most behind its share, in order to
+		// spread each kind evenly over the map.
+		auto kind = -1;
+		for (int k = 0; k < NumKinds; ++k)
+		{
+			if (emitted[k] >= counts[k])
+				continue;
+			if (kind < 0
+			    || qint64(2 * emitted[k] + 1) * counts[kind] < qint64(2 * emitted[kind] + 1) * counts[k])
+				kind = k;
+		}
+		
+		auto const x = (i % columns) * opts.spacing;
+		auto const y = (i / columns) * opts.spacing;
+		auto const center = MapCoord(x + radius, y + radius);
+		const auto& kind_symbols = symbols[kind];
+		const auto* symbol = kind_symbols[std::size_t(emitted[kind]) % kind_symbols.size()];
+		++emitted[kind];
+		
+		Object* object = nullptr;
+		switch (kind)
+		{
+		case AreaKind:
+			{
+				auto* path = new PathObject(symbol);
+				for (int j = 0; j < num_vertices; ++j)
+				{
+					auto const angle = 2 * M_PI * j / num_vertices;
+					auto const r = (j % 2) ? radius * 0.6 : radius;
+					path->addCoordinate(MapCoord(x + radius + r * std::cos(angle), y + radius + r * std::sin(angle)));
+				}
+				path->closeAllParts();
+				object = path;
+			}
+			break;
+		case LineKind:
+		case DashedLineKind:
+			{
+				auto* path = new PathObject(symbol);
+				for (int j = 0; j < num_vertices; ++j)
+					path->addCoordinate(MapCoord(x + j * cell_size / (num_vertices - 1), y + (j % 2) * radius));
+				object = path;
+			}
+			break;
+		case PointKind:
+			{
+				auto* point = new PointObject(symbol);
+				point->setPosition(center);
+				object = point;
+			}
+			break;
+		default:
+			{
+				auto* text = new TextObject(symbol);
+				text->setAnchorPosition(center);
+				text->setText(QString::number(i));
+				object = text;
+			}
+		}
+		
+		if (opts.tags > 0)
+			object->setTag(QStringLiteral("id"), QString::number(i));
+		for (int j = 1; j < opts.tags; ++j)
+			object->setTag(QLatin1String("tag") + QString::number(j), QString::number((i + j) % 100));
+		part->addObject(object);
+	}
+	
+	return true;
+}
+
+
+}  // namespace OpenOrienteering
@@ -0,0 +1,90 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef OPENORIENTEERING_MAP_GENERATOR_H
+#define OPENORIENTEERING_MAP_GENERATOR_H
+
+#include <QtGlobal>
+
+namespace OpenOrienteering {
+
+class Map;
+
+
+/**
+ * Generates synthetic map content for scalability testing.
+ * 
+ * The generator replaces the objects of a map with a configurable number of
+ * areas, solid lines, dashed lines, points and texts, using the symbols which
+ * are already present in the map, e.g. from a symbol set. The result depends
+ * only on the options and on the symbols, so that benchmarks can be repeated
+ * with identical data.
+ * 
+ * The objects are placed on a square grid. The different kinds of objects
+ * are interleaved evenly, and each kind cycles through its symbols.
+ */
+class MapGenerator
+{
+public:
+	struct Options
+	{
+		int areas = 0;         ///< The number of area objects
+		int lines = 0;         ///< The number of lines with solid line symbols
+		int dashed_lines = 0;  ///< The number of lines with dashed line symbols
+		int points = 0;        ///< The number of point objects
+		int texts = 0;         ///< The number of text objects
+		int tags = 1;          ///< The number of tags per object, including an id tag
+		int vertices = 8;      ///< The number of vertices per line or area
+		qreal spacing = 10;    ///< The distance between grid cells, in mm
+		
+		/**
+		 * Returns the total number of objects.
+		 */
+		int numObjects() const;
+	};
+	
+	/**
+	 * Returns options for a typical mix of the given number of objects.
+	 */
+	static Options mixedOptions(int num_objects);
+	
+	
+	explicit MapGenerator(const Options& options);
+	
+	const Options& options() const { return opts; }
+	
+	/**
+	 * Replaces all objects in the given map with generated objects.
+	 * 
+	 * Helper symbols and hidden symbols are not used.
+	 * 
+	 * @return False if the map lacks the symbols for a requested kind of
+	 *         objects, true otherwise.
+	 */
+	bool generate(Map& map) const;
+	
+private:
+	Options opts;
+	
+};
+
+
+}  // namespace OpenOrienteering
+
+#endif
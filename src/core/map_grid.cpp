@@ -21,8 +21,15 @@
 
 #include "map_grid.h"
 
+#include <functional>
+#include <mutex>
+
 #include <QtMath>
+#include <QLineF>
 #include <QPainter>
+#include <QPointF>
+#include <QRectF>
+#include <QVector>
 #include <QXmlStreamReader>
 
 #include "core/georeferencing.h"
@@ -34,9 +41,48 @@
 
 namespace OpenOrienteering {
 
+// ### MapGrid::LineCache ###
+
+/**
+ * Grid lines generated for a particular area and set of final parameters.
+ */
+struct MapGrid::LineCache
+{
+	std::mutex mutex;
+	
+	QRectF area;
+	double horz_spacing = 0;
+	double vert_spacing = 0;
+	double horz_offset = 0;
+	double vert_offset = 0;
+	double rotation = 0;
+	DisplayMode display = AllLines;
+	
+	QVector<QLineF> lines;
+	
+	/**
+	 * Returns true if the cached lines can be used for the given bounding box.
+	 * 
+	 * On screen, the lines may extend beyond the bounding box, as long as
+	 * there is not too much excess. Otherwise, they must match exactly, so
+	 * that output to vector formats stays within the bounding box.
+	 */
+	bool covers(const QRectF& bounding_box, bool on_screen) const
+	{
+		if (!on_screen)
+			return area == bounding_box;
+		return area.contains(bounding_box)
+		       && area.width() <= 4 * bounding_box.width()
+		       && area.height() <= 4 * bounding_box.height();
+	}
+};
+
+
+
 // ### MapGrid ###
 
 MapGrid::MapGrid()
+: line_cache(std::make_shared<LineCache>())
 {
 	snapping_enabled = true;
 	color = qRgba(100, 100, 100, 128);
@@ -113,16 +159,49 @@ void MapGrid::draw(QPainter* painter, const QRectF& bounding_box, Map* map, qrea
 	painter->setBrush(Qt::NoBrush);
 	painter->setOpacity(qAlpha(color) / 255.0);
 	
-	auto draw_line = std::function<void (const QPointF&, const QPointF&)>{ [painter](const QPointF& p1, const QPointF& p2) {
-		painter->drawLine(p1, p2);
-	} };
+	auto const on_screen = qIsNull(scale_adjustment);
+	QVector<QLineF> lines;
+	{
+		std::lock_guard<std::mutex> lock(line_cache->mutex);
+		auto& cache = *line_cache;
+		if (!cache.covers(bounding_box, on_screen)
+		    || cache.display != display
+		    || cache.horz_spacing != final_horz_spacing
+		    || cache.vert_spacing != final_vert_spacing
+		    || cache.horz_offset != final_horz_offset
+		    || cache.vert_offset != final_vert_offset
+		    || cache.rotation != final_rotation)
+		{
+			// On screen, generate the lines for a larger area,
+			// so that they can be reused when the view is moved a little.
+			auto area = bounding_box;
+			if (on_screen)
+				area.adjust(-area.width() / 2, -area.height() / 2, area.width() / 2, area.height() / 2);
+			
+			cache.lines.clear();
+			auto add_line = std::function<void (const QPointF&, const QPointF&)>{ [&cache](const QPointF& p1, const QPointF& p2) {
+				cache.lines.push_back({p1, p2});
+			} };
+			
+			if (display == AllLines)
+				Util::gridOperation(area, final_horz_spacing, final_vert_spacing, final_horz_offset, final_vert_offset, final_rotation, add_line);
+			else if (display == HorizontalLines)
+				Util::hatchingOperation(area, final_vert_spacing, final_vert_offset, final_rotation - M_PI / 2, add_line);
+			else // if (display == VerticalLines)
+				Util::hatchingOperation(area, final_horz_spacing, final_horz_offset, final_rotation, add_line);
+			
+			cache.area = area;
+			cache.display = display;
+			cache.horz_spacing = final_horz_spacing;
+			cache.vert_spacing = final_vert_spacing;
+			cache.horz_offset = final_horz_offset;
+			cache.vert_offset = final_vert_offset;
+			cache.rotation = final_rotation;
+		}
+		lines = cache.lines;
+	}
 	
-	if (display == AllLines)
-		Util::gridOperation(bounding_box, final_horz_spacing, final_vert_spacing, final_horz_offset, final_vert_offset, final_rotation, draw_line);
-	else if (display == HorizontalLines)
-		Util::hatchingOperation(bounding_box, final_vert_spacing, final_vert_offset, final_rotation - M_PI / 2, draw_line);
-	else // if (display == VerticalLines)
-		Util::hatchingOperation(bounding_box, final_horz_spacing, final_horz_offset, final_rotation, draw_line);
+	painter->drawLines(lines);
 }
 
 void MapGrid::calculateFinalParameters(double& final_horz_spacing, double& final_vert_spacing, double& final_horz_offset, double& final_vert_offset, double& final_rotation, Map* map) const
@@ -22,6 +22,8 @@
 #ifndef OPENORIENTEERING_MAP_GRID_H
 #define OPENORIENTEERING_MAP_GRID_H
 
+#include <memory>
+
 #include <QRgb>
 
 class QPainter;
@@ -43,6 +45,11 @@ class MapCoordF;
  * 
  * Grid lines are thin. They are either drawn using a cosmetic pen (usually on
  * screen) or with 0.1 mm (usually on paper).
+ * 
+ * The lines generated for drawing are cached for an area around the last
+ * drawn bounding box, and reused as long as the grid parameters, including
+ * the ones derived from the georeferencing, remain unchanged. Copies of a
+ * grid share this cache.
  */
 class MapGrid
 {
@@ -139,6 +146,8 @@ public:
 	inline void setVerticalOffset(double offset) {vert_offset = offset;}
 	
 private:
+	struct LineCache;
+	
 	bool snapping_enabled;
 	QRgb color;
 	DisplayMode display;
@@ -152,6 +161,8 @@ private:
 	double horz_offset;
 	double vert_offset;
 	
+	std::shared_ptr<LineCache> line_cache;
+	
 	friend bool operator==(const MapGrid& lhs, const MapGrid& rhs);
 };
 
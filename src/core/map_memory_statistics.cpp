@@ -0,0 +1,101 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "map_memory_statistics.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include <QHash>
+
+#include "core/map.h"
+#include "core/map_part.h"
+#include "core/objects/object.h"
+#include "core/renderables/renderable.h"
+#include "core/symbols/symbol.h"
+#include "templates/template.h"
+#include "undo/undo_manager.h"
+
+
+namespace OpenOrienteering {
+
+// static
+MapMemoryStatistics MapMemoryStatistics::collect(const Map& map)
+{
+	MapMemoryStatistics stats;
+	
+	QHash<const Symbol*, SymbolUsage> symbols;
+	for (int i = 0; i < map.getNumParts(); ++i)
+	{
+		const auto* part = map.getPart(i);
+		for (int j = 0; j < part->getNumObjects(); ++j)
+		{
+			const auto* object = part->getObject(j);
+			auto const renderables = object->renderables().memoryUsage();
+			auto const object_bytes = object->memoryUsage() - renderables;
+			stats.objects += object_bytes;
+			stats.renderables += renderables;
+			
+			auto& usage = symbols[object->getSymbol()];
+			usage.symbol = object->getSymbol();
+			++usage.num_objects;
+			usage.objects += object_bytes;
+			usage.renderables += renderables;
+		}
+	}
+	stats.renderables_index = map.getRenderables().memoryUsage();
+	
+	for (int i = 0; i < map.getNumSymbols(); ++i)
+	{
+		const auto* symbol = map.getSymbol(i);
+		auto const icon = std::size_t(symbol->iconMemoryUsage());
+		stats.icons += icon;
+		auto usage = symbols.find(symbol);
+		if (usage != symbols.end())
+			usage->icon = icon;
+	}
+	
+	stats.symbols.reserve(std::size_t(symbols.size()));
+	std::copy(symbols.cbegin(), symbols.cend(), std::back_inserter(stats.symbols));
+	std::sort(begin(stats.symbols), end(stats.symbols), [](const SymbolUsage& a, const SymbolUsage& b) {
+		return a.total() > b.total();
+	});
+	
+	stats.undo = map.undoManager().memoryUsage();
+	
+	stats.template_usage.reserve(std::size_t(map.getNumTemplates()));
+	for (int i = 0; i < map.getNumTemplates(); ++i)
+	{
+		const auto* temp = map.getTemplate(i);
+		auto const bytes = temp->memoryUsage();
+		stats.templates += bytes;
+		stats.template_usage.push_back({ temp, bytes });
+	}
+	
+	return stats;
+}
+
+
+std::size_t MapMemoryStatistics::total() const
+{
+	return objects + renderables + renderables_index + undo + templates + icons;
+}
+
+
+}  // namespace OpenOrienteering
@@ -0,0 +1,94 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef OPENORIENTEERING_MAP_MEMORY_STATISTICS_H
+#define OPENORIENTEERING_MAP_MEMORY_STATISTICS_H
+
+#include <cstddef>
+#include <vector>
+
+namespace OpenOrienteering {
+
+class Map;
+class Symbol;
+class Template;
+
+
+/**
+ * An estimate of the memory used by a map, by category.
+ * 
+ * All figures are in bytes. They are estimates: Heap allocation overhead is
+ * ignored, and implicitly shared data is counted for each user.
+ * 
+ * The statistics per symbol allow to identify symbols which are expensive
+ * to render, e.g. area symbols with dense fill patterns on large areas.
+ */
+struct MapMemoryStatistics
+{
+	/** The memory used for the objects of a single symbol. */
+	struct SymbolUsage
+	{
+		const Symbol* symbol = nullptr;
+		int num_objects = 0;
+		std::size_t objects = 0;      ///< The objects, without renderables
+		std::size_t renderables = 0;  ///< The renderables of the objects
+		std::size_t icon = 0;         ///< The symbol's cached icon
+		
+		/** Returns the sum of all memory used for this symbol. */
+		std::size_t total() const { return objects + renderables + icon; }
+	};
+	
+	/** The memory used by a single template. */
+	struct TemplateUsage
+	{
+		const Template* temp;
+		std::size_t bytes;
+	};
+	
+	std::size_t objects = 0;            ///< The objects in all map parts, without renderables
+	std::size_t renderables = 0;        ///< The renderables of the objects
+	std::size_t renderables_index = 0;  ///< The map's containers and indexes of renderables
+	std::size_t undo = 0;               ///< The undo and redo steps
+	std::size_t templates = 0;          ///< The data of the loaded templates
+	std::size_t icons = 0;              ///< The cached symbol icons
+	
+	/** The memory used per symbol, largest first. Only used symbols are listed. */
+	std::vector<SymbolUsage> symbols;
+	
+	/** The memory used per template, in template order. */
+	std::vector<TemplateUsage> template_usage;
+	
+	
+	/**
+	 * Collects the statistics for the given map.
+	 * 
+	 * This visits all objects, so it takes time for large maps.
+	 * The object renderables are only up-to-date after Map::updateObjects().
+	 */
+	static MapMemoryStatistics collect(const Map& map);
+	
+	/** Returns the sum of all categories. */
+	std::size_t total() const;
+	
+};
+
+
+}  // namespace OpenOrienteering
+
+#endif
@@ -22,20 +22,33 @@
 #include "map_part.h"
 
 #include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <functional>
 #include <iterator>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include <QtGlobal>
+#include <QBuffer>
+#include <QByteArray>
+#include <QIODevice>
 #include <QLatin1String>
 #include <QObject>
 #include <QStringRef>
 #include <QTransform>
 #include <QXmlStreamReader>
+#include <QXmlStreamWriter>
 
 #include "core/map.h"
 #include "core/map_coord.h"
 #include "core/objects/object.h"
+#include "core/objects/object_query.h"
 #include "core/symbols/symbol.h"
 #include "undo/object_undo.h"
+#include "util/concurrency.h"
 #include "util/util.h"
 #include "util/xml_stream_util.h"
 
@@ -53,6 +66,17 @@ namespace literal
 
 namespace OpenOrienteering {
 
+namespace {
+
+/// The number of objects which are serialized together when saving concurrently.
+constexpr std::size_t objects_per_chunk = 256;
+
+}  // namespace
+
+
+
+
+
 MapPart::MapPart(const QString& name, Map* map)
 : name(name)
 , map(map)
@@ -63,8 +87,7 @@ MapPart::MapPart(const QString& name, Map* map)
 
 MapPart::~MapPart()
 {
-	for (Object* object : objects)
-		delete object;
+	Object::deleteObjects(std::move(objects));
 }
 
 
@@ -84,16 +107,48 @@ void MapPart::save(QXmlStreamWriter& xml) const
 	{
 		XmlElementWriter objects_element(xml, literal::objects);
 		objects_element.writeAttribute(literal::count, objects.size());
-		for (const Object* object : objects)
+		auto* device = xml.device();
+		if (device && !xml.autoFormatting() && objects.size() >= 2 * objects_per_chunk)
 		{
-			writeLineBreak(xml);
-			object->save(xml);
+			// Serialize chunks of objects concurrently, and write them in order.
+			// Without auto formatting, the output doesn't depend on the
+			// nesting level, so it is the same as from sequential writing.
+			auto const num_chunks = int((objects.size() + objects_per_chunk - 1) / objects_per_chunk);
+			std::vector<QByteArray> chunks(std::size_t(num_chunks));
+			Concurrency::parallelFor(0, num_chunks, [this, &chunks](int i) {
+				auto const first = std::size_t(i) * objects_per_chunk;
+				auto const last = std::min(first + objects_per_chunk, objects.size());
+				QBuffer buffer(&chunks[std::size_t(i)]);
+				buffer.open(QIODevice::WriteOnly);
+				QXmlStreamWriter chunk_xml(&buffer);
+				for (auto j = first; j < last; ++j)
+				{
+					writeLineBreak(chunk_xml);
+					objects[j]->save(chunk_xml);
+				}
+			});
+			
+			xml.writeCharacters({});  // Finish the start element
+			for (auto& chunk : chunks)
+			{
+				device->write(chunk);
+				chunk = {};
+			}
+		}
+		else
+		{
+			for (const Object* object : objects)
+			{
+				writeLineBreak(xml);
+				object->save(xml);
+			}
 		}
 		writeLineBreak(xml);
 	}
 }
 
-MapPart* MapPart::load(QXmlStreamReader& xml, Map& map, SymbolDictionary& symbol_dict)
+MapPart* MapPart::load(QXmlStreamReader& xml, Map& map, SymbolDictionary& symbol_dict,
+                       const std::function<void ()>& object_loaded)
 {
 	Q_ASSERT(xml.name() == literal::part);
 	
@@ -113,7 +168,11 @@ MapPart* MapPart::load(QXmlStreamReader& xml, Map& map, SymbolDictionary& symbol
 			while (xml.readNextStartElement())
 			{
 				if (xml.name() == literal::object)
+				{
 					part->objects.push_back(Object::load(xml, &map, symbol_dict));
+					if (object_loaded)
+						object_loaded();
+				}
 				else
 					xml.skipCurrentElement(); // unknown
 			}
@@ -140,12 +199,24 @@ int MapPart::findObjectIndex(const Object* object) const
 void MapPart::setObject(Object* object, int pos, bool delete_old)
 {
 	map->removeRenderablesOfObject(objects[pos], true);
+	object_index.remove(objects[pos]);
+	dirty_objects.erase(objects[pos]);
+	tag_index.remove(objects[pos]);
+	symbol_index.remove(objects[pos]);
+	if (std::size_t(pos) < object_positions.size())
+	{
+		object_positions.erase(objects[pos]);
+		object_positions.emplace(object, std::size_t(pos));
+	}
 	if (delete_old)
 		delete objects[pos];
 	
 	objects[pos] = object;
 	object->setMap(map);
 	object->update();
+	object_index.insert(object, object->getExtent());
+	tag_index.insert(object);
+	symbol_index.insert(object);
 	map->setObjectsDirty(); // TODO: remove from here, dirty state handling should be separate
 }
 
@@ -156,14 +227,39 @@ void MapPart::addObject(Object* object)
 
 void MapPart::addObject(Object* object, int pos)
 {
+	if (std::size_t(pos) < object_positions.size())
+		object_positions.clear();
 	objects.insert(objects.begin() + pos, object);
 	object->setMap(map);
 	object->update();
+	object_index.insert(object, object->getExtent());
+	tag_index.insert(object);
+	symbol_index.insert(object);
 	
 	if (objects.size() == 1 && map->getNumObjects() == 1)
 		map->updateAllMapWidgets();
 }
 
+void MapPart::addObjects(const std::vector<Object*>& new_objects)
+{
+	if (new_objects.empty())
+		return;
+	
+	objects.reserve(objects.size() + new_objects.size());
+	for (auto* object : new_objects)
+	{
+		objects.push_back(object);
+		object->setMap(map);
+		// The object enters the object index when it gets updated.
+		dirty_objects.insert(object);
+		tag_index.insert(object);
+		symbol_index.insert(object);
+	}
+	
+	if (objects.size() == new_objects.size() && map->getNumObjects() == int(new_objects.size()))
+		map->updateAllMapWidgets();
+}
+
 void MapPart::deleteObject(int pos)
 {
 	delete releaseObject(pos);
@@ -177,11 +273,23 @@ bool MapPart::deleteObject(Object* object)
 	return object_ptr;
 }
 
+void MapPart::deleteObjects(const std::vector<Object*>& objects_to_delete)
+{
+	for (auto* object : releaseObjects(objects_to_delete))
+		delete object;
+}
+
 Object* MapPart::releaseObject(int pos)
 {
 	map->removeRenderablesOfObject(objects[pos], true);
 	auto object_to_return = objects[pos];
+	if (std::size_t(pos) < object_positions.size())
+		object_positions.clear();
 	objects.erase(objects.begin() + pos);
+	object_index.remove(object_to_return);
+	dirty_objects.erase(object_to_return);
+	tag_index.remove(object_to_return);
+	symbol_index.remove(object_to_return);
 	
 	if (objects.empty() && map->getNumObjects() == 0)
 		map->updateAllMapWidgets();
@@ -189,6 +297,37 @@ Object* MapPart::releaseObject(int pos)
 	return object_to_return;
 }
 
+std::vector<Object*> MapPart::releaseObjects(const std::vector<Object*>& objects_to_release)
+{
+	std::vector<Object*> released;
+	if (objects_to_release.empty())
+		return released;
+	
+	auto const candidates = std::unordered_set<const Object*>(begin(objects_to_release), end(objects_to_release));
+	auto last = std::stable_partition(begin(objects), end(objects), [&candidates](const Object* object) {
+		return candidates.count(object) == 0;
+	});
+	if (last == end(objects))
+		return released;
+	
+	released.assign(last, end(objects));
+	objects.erase(last, end(objects));
+	object_positions.clear();
+	for (auto* object : released)
+	{
+		map->removeRenderablesOfObject(object, true);
+		object_index.remove(object);
+		dirty_objects.erase(object);
+		tag_index.remove(object);
+		symbol_index.remove(object);
+	}
+	
+	if (objects.empty() && map->getNumObjects() == 0)
+		map->updateAllMapWidgets();
+	
+	return released;
+}
+
 Object* MapPart::releaseObject(Object* object)
 {
 	int size = objects.size();
@@ -212,19 +351,35 @@ std::unique_ptr<UndoStep> MapPart::importPart(const MapPart* other, const QHash<
 	if (select_new_objects)
 		map->clearObjectSelection(false);
 	
-	objects.reserve(objects.size() + other->objects.size());
-	for (const Object* object: other->objects)
-	{
-		Object* new_object = object->duplicate();
-		if (symbol_map.contains(new_object->getSymbol()))
-			new_object->setSymbol(symbol_map.value(new_object->getSymbol()), true);
+	// The new objects do not belong to a map yet, so they can be prepared
+	// concurrently.
+	const auto& other_objects = other->objects;
+	std::vector<Object*> new_objects(other_objects.size());
+	Concurrency::parallelFor(0, int(other_objects.size()), [&other_objects, &new_objects, &symbol_map, &transform](int i) {
+		Object* new_object = other_objects[std::size_t(i)]->duplicate();
+		auto const replacement = symbol_map.constFind(new_object->getSymbol());
+		if (replacement != symbol_map.constEnd())
+			new_object->setSymbol(*replacement, true);
 		new_object->transform(transform);
-		
+		new_objects[std::size_t(i)] = new_object;
+	}, 64);
+	
+	objects.reserve(objects.size() + new_objects.size());
+	for (auto* new_object : new_objects)
+	{
 		objects.push_back(new_object);
 		new_object->setMap(map);
-		new_object->update();
+		tag_index.insert(new_object);
+		symbol_index.insert(new_object);
 		
 		undo_step->addObject((int)objects.size() - 1);
+	}
+	
+	// Create all renderables in one go, then index the extents.
+	map->regenerateObjects({ begin(new_objects), end(new_objects) });
+	for (auto* new_object : new_objects)
+	{
+		object_index.insert(new_object, new_object->getExtent());
 		if (select_new_objects)
 			map->addObjectToSelection(new_object, false);
 	}
@@ -251,14 +406,18 @@ void MapPart::findObjectsAt(
         bool include_protected_objects,
         SelectionInfoVector& out ) const
 {
-	for (Object* object : objects)
+	// Point objects are tested against the squared distance.
+	auto const margin = qMax(tolerance, std::sqrt(tolerance));
+	auto const rect = QRectF(coord.x() - margin, coord.y() - margin, 2 * margin, 2 * margin);
+	for (const Object* candidate : findCandidates(rect))
 	{
+		// The part owns its objects.
+		auto* object = const_cast<Object*>(candidate);
 		if (!include_hidden_objects && object->getSymbol()->isHidden())
 			continue;
 		if (!include_protected_objects && object->getSymbol()->isProtected())
 			continue;
 		
-		object->update();
 		int selected_type = object->isPointOnObject(coord, tolerance, treat_areas_as_paths, extended_selection);
 		if (selected_type != (int)Symbol::NoSymbol)
 			out.emplace_back(selected_type, object);
@@ -273,27 +432,49 @@ void MapPart::findObjectsAtBox(
         std::vector< Object* >& out ) const
 {
 	auto rect = QRectF(corner1, corner2).normalized();
-	for (Object* object : objects)
+	for (const Object* candidate : findCandidates(rect))
 	{
+		// The part owns its objects.
+		auto* object = const_cast<Object*>(candidate);
 		if (!include_hidden_objects && object->getSymbol()->isHidden())
 			continue;
 		if (!include_protected_objects && object->getSymbol()->isProtected())
 			continue;
 		
-		object->update();
 		if (rect.intersects(object->getExtent()) && object->intersectsBox(rect))
 			out.push_back(object);
 	}
 }
 
+void MapPart::findObjectsNear(
+        const MapCoordF& coord,
+        qreal distance,
+        bool include_hidden_objects,
+        bool include_protected_objects,
+        std::vector<Object*>& out) const
+{
+	auto const rect = QRectF(coord.x() - distance, coord.y() - distance, 2 * distance, 2 * distance);
+	for (const Object* candidate : findCandidates(rect))
+	{
+		// The part owns its objects.
+		auto* object = const_cast<Object*>(candidate);
+		if (!include_hidden_objects && object->getSymbol()->isHidden())
+			continue;
+		if (!include_protected_objects && object->getSymbol()->isProtected())
+			continue;
+		
+		if (rect.intersects(object->getExtent()))
+			out.push_back(object);
+	}
+}
+
 int MapPart::countObjectsInRect(const QRectF& map_coord_rect, bool include_hidden_objects) const
 {
 	int count = 0;
-	for (const Object* object : objects)
+	for (const Object* object : findCandidates(map_coord_rect))
 	{
 		if (object->getSymbol()->isHidden() && !include_hidden_objects)
 			continue;
-		object->update();
 		if (object->getExtent().intersects(map_coord_rect))
 			++count;
 	}
@@ -317,12 +498,132 @@ QRectF MapPart::calculateExtent(bool include_helper_symbols) const
 
 
 
+bool MapPart::objectExtentChanged(const Object* object)
+{
+	// The symbol may have been changed while the object was detached from the map.
+	symbol_index.update(object);
+	
+	if (object->isOutputDirty())
+	{
+		if (!object_index.remove(object) && dirty_objects.find(object) == dirty_objects.end())
+			return false;
+		dirty_objects.insert(object);
+	}
+	else
+	{
+		if (dirty_objects.erase(object) == 0 && !object_index.contains(object))
+			return false;
+		object_index.insert(object, object->getExtent());
+	}
+	return true;
+}
+
+bool MapPart::objectTagsChanged(const Object* object, const ObjectTags& old_tags)
+{
+	return tag_index.update(object, old_tags);
+}
+
+bool MapPart::objectSymbolChanged(const Object* object)
+{
+	return symbol_index.update(object);
+}
+
+void MapPart::updateObjectIndex() const
+{
+	if (object_index.size() + dirty_objects.size() != objects.size())
+	{
+		object_index.clear();
+		dirty_objects.clear();
+		dirty_objects.insert(begin(objects), end(objects));
+	}
+	
+	if (dirty_objects.empty())
+		return;
+	
+	// Object::update() calls back into objectExtentChanged().
+	auto pending = std::move(dirty_objects);
+	dirty_objects.clear();
+	for (const auto* object : pending)
+	{
+		object->update();
+		object_index.insert(object, object->getExtent());
+	}
+}
+
+void MapPart::updateObjectPositions() const
+{
+	if (object_positions.size() > objects.size())
+		object_positions.clear();
+	
+	object_positions.reserve(objects.size());
+	for (auto i = object_positions.size(); i < objects.size(); ++i)
+		object_positions.emplace(objects[i], i);
+}
+
+std::vector<const Object*> MapPart::findCandidates(const QRectF& rect) const
+{
+	updateObjectIndex();
+	updateObjectPositions();
+	
+	auto candidates = object_index.find(rect);
+	std::vector<std::pair<std::size_t, const Object*>> ordered;
+	ordered.reserve(candidates.size());
+	for (const auto* object : candidates)
+		ordered.emplace_back(object_positions.at(object), object);
+	std::sort(begin(ordered), end(ordered));
+	
+	std::transform(begin(ordered), end(ordered), begin(candidates), [](const auto& entry) {
+		return entry.second;
+	});
+	return candidates;
+}
+
+void MapPart::updateTagIndex() const
+{
+	if (!tag_index.isValid() || tag_index.size() != objects.size())
+		tag_index.build(objects);
+}
+
+void MapPart::updateSymbolIndex() const
+{
+	if (!symbol_index.isValid() || symbol_index.size() != objects.size())
+		symbol_index.build(objects);
+}
+
+
+
 bool MapPart::existsObject(const std::function<bool(const Object*)>& condition) const
 {
 	return std::any_of(begin(objects), end(objects), condition);
 }
 
 
+bool MapPart::existsObjectWithSymbol(const Symbol* symbol) const
+{
+	updateSymbolIndex();
+	const auto candidates = symbol_index.objects(symbol);
+	return std::any_of(candidates.begin(), candidates.end(), [symbol](const Object* object) {
+		return object->getSymbol() == symbol;
+	});
+}
+
+
+std::vector<Object*> MapPart::objectsWithSymbol(const Symbol* symbol) const
+{
+	updateSymbolIndex();
+	const auto candidates = symbol_index.objects(symbol);
+	auto result = std::vector<Object*>();
+	result.reserve(std::size_t(candidates.size()));
+	for (const auto* object : candidates)
+	{
+		// The index holds only objects of this part, which are not const.
+		if (object->getSymbol() == symbol)
+			result.push_back(const_cast<Object*>(object));
+	}
+	return result;
+}
+
+
 void MapPart::applyOnMatchingObjects(const std::function<void (Object*)>& operation, const std::function<bool (const Object*)>& condition)
 {
 	std::for_each(objects.rbegin(), objects.rend(), [&operation, &condition](auto object) {
@@ -353,6 +654,26 @@ void MapPart::applyOnMatchingObjects(const std::function<void (Object*, MapPart*
 }
 
 
+void MapPart::applyOnMatchingObjects(const std::function<void (Object*)>& operation, const ObjectQuery& query)
+{
+	if (!query.isIndexable())
+	{
+		applyOnMatchingObjects(operation, std::function<bool (const Object*)>{std::cref(query)});
+		return;
+	}
+	
+	updateTagIndex();
+	auto const candidates = tag_index.select(query);
+	if (candidates.isEmpty())
+		return;
+	
+	std::for_each(objects.rbegin(), objects.rend(), [&operation, &query, &candidates](auto object) {
+		if (candidates.contains(object) && query(object))
+			operation(object);
+	});
+}
+
+
 void MapPart::applyOnAllObjects(const std::function<void (Object*)>& operation)
 {
 	std::for_each(objects.rbegin(), objects.rend(), operation);
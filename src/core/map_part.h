@@ -25,6 +25,8 @@
 #include <cstddef>
 #include <functional>
 #include <memory>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include <utility>
 
@@ -32,6 +34,10 @@
 #include <QRectF>
 #include <QString>
 
+#include "core/spatial_index.h"
+#include "core/objects/symbol_index.h"
+#include "core/objects/tag_index.h"
+
 class QIODevice;
 class QTransform;
 class QXmlStreamReader;
@@ -43,6 +49,7 @@ namespace OpenOrienteering {
 class Map;
 class MapCoordF;
 class Object;
+class ObjectQuery;
 class Symbol;
 using SymbolDictionary = QHash<qint32, Symbol*>; // from symbol.h
 class UndoStep;
@@ -67,7 +74,9 @@ using SelectionInfoVector = std::vector<std::pair<int, Object*>> ;
  */
 class MapPart
 {
+friend class BinaryFileImporter;
 friend class OCAD8FileImport;
+friend class XMLFileImporter;
 public:
 	/**
 	 * Creates a new map part with the given name for a map.
@@ -87,6 +96,9 @@ public:
 	
 	/**
 	 * Saves the map part in xml format to the given stream.
+	 * 
+	 * When writing to a device without auto formatting, the objects of large
+	 * parts are serialized concurrently.
 	 */
 	void save(QXmlStreamWriter& xml) const;
 	
@@ -94,8 +106,10 @@ public:
 	 * Loads the map part in xml format from the given stream.
 	 * 
 	 * Needs a dictionary to map symbol ids to symbol pointers.
+	 * If given, object_loaded is called after each object which was loaded.
 	 */
-	static MapPart* load(QXmlStreamReader& xml, Map& map, SymbolDictionary& symbol_dict);
+	static MapPart* load(QXmlStreamReader& xml, Map& map, SymbolDictionary& symbol_dict,
+	                     const std::function<void ()>& object_loaded = {});
 	
 	/**
 	 * Returns the part's name.
@@ -150,6 +164,14 @@ public:
 	 */
 	void addObject(Object* object, int pos);
 	
+	/**
+	 * Adds the objects as new objects at the end.
+	 * 
+	 * Unlike addObject(), this does not update the objects. They are
+	 * updated by Map::addObjects(), or when they are needed.
+	 */
+	void addObjects(const std::vector<Object*>& new_objects);
+	
 	/**
 	 * Deleted the object from the given index.
 	 */
@@ -162,6 +184,14 @@ public:
 	 */
 	bool deleteObject(Object* object);
 	
+	/**
+	 * Deletes all given objects which are found in this part.
+	 * 
+	 * This is a single pass over the part's objects, so it is much faster
+	 * than deleting many objects one by one.
+	 */
+	void deleteObjects(const std::vector<Object*>& objects_to_delete);
+	
 	/**
 	  * Relinquish object ownership.
 	  *
@@ -177,6 +207,15 @@ public:
 	  * structures. Object deletion is caller's responsibility.
 	  */
 	Object* releaseObject(Object* object);
+	
+	/**
+	  * Relinquish ownership of all given objects which are found in this part.
+	  * 
+	  * This is a single pass over the part's objects, so it is much faster
+	  * than releasing many objects one by one. Returns the released objects,
+	  * in their former order. Object deletion is caller's responsibility.
+	  */
+	std::vector<Object*> releaseObjects(const std::vector<Object*>& objects_to_release);
 
 	
 	/**
@@ -204,6 +243,13 @@ public:
 		bool include_hidden_objects, bool include_protected_objects,
 		std::vector<Object*>& out) const;
 	
+	/**
+	 * @see Map::findAllObjectsNear().
+	 */
+	void findObjectsNear(const MapCoordF& coord, qreal distance,
+		bool include_hidden_objects, bool include_protected_objects,
+		std::vector<Object*>& out) const;
+	
 	/** 
 	 * @see Map::countObjectsInRect().
 	 */
@@ -214,6 +260,30 @@ public:
 	 */
 	QRectF calculateExtent(bool include_helper_symbols) const;
 	
+	/**
+	 * Updates the spatial index entry of an object after a change.
+	 * 
+	 * This is to be called when the object's output was regenerated, or when
+	 * the object was marked as dirty.
+	 * 
+	 * @return False if the object does not belong to this part, true otherwise.
+	 */
+	bool objectExtentChanged(const Object* object);
+	
+	/**
+	 * Updates the tag index entry of an object after a change of its tags.
+	 * 
+	 * @return False if the object is not indexed by this part, true otherwise.
+	 */
+	bool objectTagsChanged(const Object* object, const ObjectTags& old_tags);
+	
+	/**
+	 * Updates the symbol index entry of an object after a change of its symbol.
+	 * 
+	 * @return False if the object is not indexed by this part, true otherwise.
+	 */
+	bool objectSymbolChanged(const Object* object);
+	
 	
 	/**
 	 * Applies a condition on all objects (until the first match is found).
@@ -222,6 +292,19 @@ public:
 	 */
 	bool existsObject(const std::function<bool (const Object*)>& condition) const;
 	
+	/**
+	 * Returns true if there is an object with the given symbol.
+	 */
+	bool existsObjectWithSymbol(const Symbol* symbol) const;
+	
+	/**
+	 * Returns the objects with the given symbol.
+	 * 
+	 * The objects are taken from the symbol index, i.e. without testing all
+	 * objects. They are returned in no particular order.
+	 */
+	std::vector<Object*> objectsWithSymbol(const Symbol* symbol) const;
+	
 	/**
 	 * @copybrief   Map::applyOnMatchingObjects()
 	 * @copydetails Map::applyOnMatchingObjects()
@@ -240,6 +323,15 @@ public:
 	 */
 	void applyOnMatchingObjects(const std::function<void (Object*, MapPart*, int)>& operation, const std::function<bool (const Object*)>& condition);
 	
+	/**
+	 * Applies an operation on all objects which match the given query.
+	 * 
+	 * For indexable queries, only the candidates from the tag index are
+	 * evaluated, cf. ObjectQuery::isIndexable(). The objects are visited in
+	 * the same order as by the other variants of applyOnMatchingObjects().
+	 */
+	void applyOnMatchingObjects(const std::function<void (Object*)>& operation, const ObjectQuery& query);
+	
 	/**
 	 * @copybrief   Map::applyOnAllObjects()
 	 * @copydetails Map::applyOnAllObjects()
@@ -261,10 +353,65 @@ public:
 	
 private:
 	typedef std::vector<Object*> ObjectList;
-
+	
+	/**
+	 * Brings the spatial index up to date.
+	 * 
+	 * Updates the objects which were marked as dirty, and rebuilds the index
+	 * if objects were added to the list without going through addObject().
+	 */
+	void updateObjectIndex() const;
+	
+	/**
+	 * Brings the object positions up to date.
+	 * 
+	 * The positions cover a prefix of the list. Objects appended to the list
+	 * are added here, while other changes of positions clear the positions.
+	 */
+	void updateObjectPositions() const;
+	
+	/**
+	 * Returns the objects whose extent may intersect the given rect.
+	 * 
+	 * The candidates are in the order of the objects in this part, i.e. in
+	 * drawing order, like a linear search of the objects.
+	 */
+	std::vector<const Object*> findCandidates(const QRectF& rect) const;
+	
+	/**
+	 * Brings the tag index up to date.
+	 * 
+	 * Builds the index on first use, and rebuilds it if objects were added to
+	 * the list without going through addObject().
+	 */
+	void updateTagIndex() const;
+	
+	/**
+	 * Brings the symbol index up to date.
+	 * 
+	 * Builds the index on first use, and rebuilds it if objects were added to
+	 * the list without going through addObject().
+	 */
+	void updateSymbolIndex() const;
+	
 	QString name;
-	ObjectList objects;  ///< @todo This could be a spatial representation optimized for quick access
+	ObjectList objects;
 	Map* const map;
+	
+	/** The index of up-to-date object extents. */
+	mutable SpatialIndex<const Object*> object_index;
+	
+	/** Objects which need to be updated before they can be indexed. */
+	mutable std::unordered_set<const Object*> dirty_objects;
+	
+	/** The positions of the objects in the list, for ordering candidates. */
+	mutable std::unordered_map<const Object*, std::size_t> object_positions;
+	
+	/** The index of object tags, built on demand. */
+	mutable TagIndex tag_index;
+	
+	/** The index of object symbols, built on demand. */
+	mutable SymbolIndex symbol_index;
 };
 
 
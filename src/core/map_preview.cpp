@@ -0,0 +1,135 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "map_preview.h"
+
+#include <algorithm>
+#include <utility>
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFileInfo>
+#include <QIODevice>
+#include <QLatin1Char>
+#include <QLatin1String>
+#include <QPainter>
+#include <QRectF>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include "core/map.h"
+#include "core/renderables/renderable.h"
+
+
+namespace OpenOrienteering {
+
+namespace {
+
+const auto key_modified = QStringLiteral("Source-Modified");
+const auto key_size     = QStringLiteral("Source-Size");
+const auto key_scale    = QStringLiteral("Scale");
+const auto key_objects  = QStringLiteral("Objects");
+
+}  // namespace
+
+
+
+// static
+QImage MapPreview::render(Map& map, int side_length)
+{
+	QImage image(side_length, side_length, QImage::Format_ARGB32_Premultiplied);
+	image.fill(Qt::white);
+	
+	auto extent = map.calculateExtent();
+	if (!extent.isValid())
+		return image;
+	
+	// Keep the aspect ratio, and leave a small margin.
+	auto scaling = (side_length - 4) / std::max(extent.width(), extent.height());
+	
+	QPainter painter(&image);
+	painter.setRenderHint(QPainter::Antialiasing);
+	painter.translate(side_length / 2.0, side_length / 2.0);
+	painter.scale(scaling, scaling);
+	painter.translate(-extent.center());
+	
+	RenderConfig config = { map, extent, scaling, RenderConfig::Screen, 1.0 };
+	map.draw(&painter, config);
+	return image;
+}
+
+// static
+MapPreview::Info MapPreview::load(const QString& map_path)
+{
+	Info info;
+	
+	QFileInfo file_info(map_path);
+	if (!file_info.exists())
+		return info;
+	
+	QImage image;
+	if (!image.load(path(map_path), "PNG"))
+		return info;
+	
+	if (image.text(key_modified) != QString::number(file_info.lastModified().toMSecsSinceEpoch())
+	    || image.text(key_size) != QString::number(file_info.size()))
+		return info;
+	
+	info.last_modified = file_info.lastModified();
+	info.scale_denominator = image.text(key_scale).toUInt();
+	info.num_objects = image.text(key_objects).toInt();
+	info.image = std::move(image);
+	return info;
+}
+
+// static
+void MapPreview::store(const QString& map_path, const QImage& image, const Map& map)
+{
+	QFileInfo file_info(map_path);
+	if (image.isNull() || !file_info.exists() || !QDir().mkpath(directory()))
+		return;
+	
+	auto tagged = image;
+	tagged.setText(key_modified, QString::number(file_info.lastModified().toMSecsSinceEpoch()));
+	tagged.setText(key_size, QString::number(file_info.size()));
+	tagged.setText(key_scale, QString::number(map.getScaleDenominator()));
+	tagged.setText(key_objects, QString::number(map.getNumObjects()));
+	
+	QSaveFile file(path(map_path));
+	if (file.open(QIODevice::WriteOnly) && tagged.save(&file, "PNG"))
+		file.commit();
+}
+
+// static
+QString MapPreview::directory()
+{
+	return QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+	       + QLatin1String("/map-previews");
+}
+
+// static
+QString MapPreview::path(const QString& map_path)
+{
+	auto const key = QCryptographicHash::hash(QFileInfo(map_path).absoluteFilePath().toUtf8(),
+	                                          QCryptographicHash::Sha1).toHex();
+	return directory() + QLatin1Char('/') + QString::fromLatin1(key) + QLatin1String(".png");
+}
+
+
+}  // namespace OpenOrienteering
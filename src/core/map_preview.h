@@ -0,0 +1,95 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef OPENORIENTEERING_MAP_PREVIEW_H
+#define OPENORIENTEERING_MAP_PREVIEW_H
+
+#include <QtGlobal>
+#include <QDateTime>
+#include <QImage>
+#include <QString>
+
+
+namespace OpenOrienteering {
+
+class Map;
+
+
+/**
+ * A persistent cache of small map previews for the home screen.
+ * 
+ * Previews are stored as PNG files in the application's cache directory,
+ * under a name derived from the absolute path of the map file. A few
+ * properties of the map are kept in the PNG text chunks, together with the
+ * size and modification time of the map file at the time of saving. A
+ * preview is only returned while these still match the file on disk, so
+ * there is no need to parse the map file itself.
+ * 
+ * The functions may be called from any thread, except render() which must
+ * not run concurrently with modifications of the map.
+ */
+class MapPreview
+{
+public:
+	/** The side length of previews, in pixels. */
+	static constexpr int size = 96;
+	
+	/** The image and properties of a preview. */
+	struct Info
+	{
+		QImage image;
+		QDateTime last_modified;
+		unsigned int scale_denominator = 0;
+		int num_objects = 0;
+		
+		bool isNull() const { return image.isNull(); }
+	};
+	
+	/**
+	 * Draws the extent of the given map into a square image.
+	 */
+	static QImage render(Map& map, int side_length = size);
+	
+	/**
+	 * Returns the preview for the given map file, or a null Info.
+	 * 
+	 * The preview is ignored if the file was modified after storing it.
+	 */
+	static Info load(const QString& map_path);
+	
+	/**
+	 * Stores a preview for the given map file, in its current state on disk.
+	 * 
+	 * Failure is silently ignored.
+	 */
+	static void store(const QString& map_path, const QImage& image, const Map& map);
+	
+	/**
+	 * Returns the path of the directory which holds the cached previews.
+	 */
+	static QString directory();
+	
+private:
+	static QString path(const QString& map_path);
+};
+
+
+}  // namespace OpenOrienteering
+
+#endif
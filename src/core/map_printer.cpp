@@ -21,7 +21,12 @@
 
 #include "map_printer.h"
 
+#include <algorithm>
 #include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <utility>
+#include <vector>
 
 #include <Qt>
 #include <QtMath>
@@ -33,7 +38,11 @@
 #include <QPaintDevice>
 #include <QPaintEngine> // IWYU pragma: keep
 #include <QPainter>
+#include <QPicture>
+#include <QPoint>
 #include <QPointF>
+#include <QRect>
+#include <QRectF>
 #include <QStringRef>
 #include <QTransform>
 #include <QXmlStreamReader>
@@ -54,6 +63,8 @@
 #include "core/map_view.h"
 #include "core/renderables/renderable.h"
 #include "templates/template.h"
+#include "util/concurrency.h"
+#include "util/util.h"
 #include "util/xml_stream_util.h"
 
 
@@ -489,7 +500,12 @@ std::unique_ptr<QPrinter> MapPrinter::makePrinter() const
 	}
 	else if (options.color_mode == MapPrinterOptions::DeviceCmyk)
 	{
-		printer = std::make_unique<AdvancedPdfPrinter>(*target, QPrinter::HighResolution);
+		auto pdf_printer = std::make_unique<AdvancedPdfPrinter>(*target, QPrinter::HighResolution);
+		// Repeated symbol elements are written once and referenced.
+		pdf_printer->setSharedPathsEnabled(true);
+		// Page content goes to disk instead of growing in memory.
+		pdf_printer->setStreamingEnabled(true);
+		printer = std::move(pdf_printer);
 	}
 	else
 	{
@@ -921,6 +937,104 @@ void MapPrinter::takePrinterSettings(const QPrinter* printer)
 
 
 void MapPrinter::drawPage(QPainter* device_painter, const QRectF& page_extent, QImage* page_buffer) const
+{
+	drawPageRegion(device_painter, page_extent, page_extent, page_buffer);
+}
+
+bool MapPrinter::drawPageStrips(const QRectF& page_extent, const QSize& page_size, int strip_height,
+                                const std::function<bool (const QImage&, int)>& sink) const
+{
+	if (page_size.isEmpty() || strip_height <= 0)
+		return false;
+	
+	// Drawing updates dirty objects, which must not happen concurrently.
+	map.updateObjects();
+	
+	// Templates are not prepared for concurrent drawing.
+	const auto num_threads = (options.show_templates && map.getNumTemplates() > 0) ? 1 : Concurrency::idealThreadCount();
+	
+	const auto units_per_mm = options.resolution / 25.4;
+	const auto pixel_per_map_mm = units_per_mm * scale_adjustment;
+	const auto num_strips = (page_size.height() + strip_height - 1) / strip_height;
+	
+	std::vector<QImage> strips(std::size_t(num_threads));
+	std::vector<char> strip_ok(std::size_t(num_threads));
+	for (int first = 0; first < num_strips; first += num_threads)
+	{
+		const auto last = qMin(num_strips, first + num_threads);
+		Concurrency::parallelFor(first, last, [&](int i) {
+			const auto index = std::size_t(i - first);
+			const auto top = i * strip_height;
+			const auto height = qMin(strip_height, page_size.height() - top);
+			
+			auto& strip = strips[index];
+			if (strip.width() != page_size.width() || strip.height() != height)
+				strip = QImage(page_size.width(), height, QImage::Format_ARGB32_Premultiplied);
+			strip_ok[index] = !strip.isNull();
+			if (!strip_ok[index])
+				return;  // Allocation failed
+			
+			strip.setDotsPerMeterX(qRound(units_per_mm * 1000));
+			strip.setDotsPerMeterY(qRound(units_per_mm * 1000));
+			strip.fill(QColor(Qt::white));
+			
+			// Shifting the extent moves the strip's first row to the origin.
+			const auto strip_extent = page_extent.translated(0, top / pixel_per_map_mm);
+			const auto strip_region = QRectF(page_extent.left(),
+			                                 page_extent.top() + (top / units_per_mm - page_format.page_rect.top()) / scale_adjustment,
+			                                 page_extent.width(),
+			                                 height / pixel_per_map_mm).intersected(page_extent);
+			
+			QPainter painter(&strip);
+			drawPageRegion(&painter, strip_extent, strip_region, &strip);
+			strip_ok[index] = painter.isActive();  // Signals errors
+			if (painter.isActive())
+				painter.end();
+		});
+		
+		for (auto i = first; i < last; ++i)
+		{
+			const auto index = std::size_t(i - first);
+			if (!strip_ok[index] || !sink(strips[index], i * strip_height))
+				return false;
+		}
+	}
+	return true;
+}
+
+QImage MapPrinter::drawPrintAreaImage() const
+{
+	const auto pixel_per_mm = options.resolution / 25.4;
+	const auto print_width = qRound(getPrintAreaPaperSize().width() * pixel_per_mm);
+	const auto print_height = qRound(getPrintAreaPaperSize().height() * pixel_per_mm);
+	// The page is opaque, so three bytes per pixel are sufficient.
+	QImage image(print_width, print_height, QImage::Format_RGB888);
+	if (image.isNull())
+		return image;
+	
+	const auto dots_per_meter = qRound(pixel_per_mm * 1000);
+	image.setDotsPerMeterX(dots_per_meter);
+	image.setDotsPerMeterY(dots_per_meter);
+	
+	// Draw in strips, so that no second full-size buffer is needed.
+	constexpr int strip_bytes = 16 * 1024 * 1024;
+	const auto strip_height = qMax(16, strip_bytes / qMax(1, 4 * print_width));
+	const auto copy_strip = [&image](const QImage& strip, int top) {
+		const auto converted = strip.convertToFormat(QImage::Format_RGB888);
+		if (converted.isNull())
+			return false;
+		const auto bytes = std::size_t(qMin(converted.bytesPerLine(), image.bytesPerLine()));
+		for (int y = 0; y < converted.height() && top + y < image.height(); ++y)
+			std::memcpy(image.scanLine(top + y), converted.constScanLine(y), bytes);
+		return true;
+	};
+	if (!drawPageStrips(print_area, image.size(), strip_height, copy_strip))
+		return {};
+	
+	return image;
+}
+
+void MapPrinter::drawPageRegion(QPainter* device_painter, const QRectF& page_extent, const QRectF& page_region, QImage* page_buffer) const
 {
 	// Logical units per mm
 	const qreal units_per_mm = options.resolution / 25.4;
@@ -942,7 +1056,7 @@ void MapPrinter::drawPage(QPainter* device_painter, const QRectF& page_extent, Q
 		return transform;
 	}();
 	
-	const auto page_region_used = page_extent.intersected(print_area);
+	const auto page_region_used = page_region.intersected(print_area);
 	
 	
 	/*
@@ -991,10 +1105,17 @@ void MapPrinter::drawPage(QPainter* device_painter, const QRectF& page_extent, Q
 	
 	/*
 	 * Use a local "page painter", redirected to a local buffer if needed.
+	 * 
+	 * In vector mode, the local buffer only needs to cover the region of the
+	 * transparent background templates. The opaque templates below them are
+	 * drawn as vectors, and again into the buffer which is drawn opaque.
 	 */
 	auto* page_painter = device_painter;
 	QImage local_page_buffer;
+	QPoint local_page_offset;
 	QPainter local_page_painter;
+	auto partial_page_buffer = false;
+	auto first_alpha_template = 0;
 	if (use_page_buffer && !page_buffer)
 	{
 		int w = qCeil(page_format.paper_dimensions.width() * units_per_mm);
@@ -1012,18 +1133,48 @@ void MapPrinter::drawPage(QPainter* device_painter, const QRectF& page_extent, Q
 		}
 #endif
 		
-		local_page_buffer = QImage(w, h, QImage::Format_RGB32);
-		if (local_page_buffer.isNull())
+		auto buffer_rect = QRect(0, 0, w, h);
+		if (!use_buffer_for_map && device_painter->device()->physicalDpiX() != 0)
 		{
-			// Allocation failed
-			device_painter->end(); // Signal error
-			return;
+			partial_page_buffer = true;
+			while (first_alpha_template < first_front_template
+			       && !hasAlpha(map.getTemplate(first_alpha_template)))
+			{
+				++first_alpha_template;
+			}
+			
+			QRectF buffer_region;
+			for (int i = first_alpha_template; i < first_front_template; ++i)
+			{
+				const auto* temp = map.getTemplate(i);
+				if (temp->getTemplateState() == Template::Loaded)
+					rectIncludeSafe(buffer_region, temp->calculateTemplateBoundingBox());
+			}
+			// A margin for line widths etc. which exceed the bounding box
+			buffer_region = buffer_region.adjusted(-1, -1, 1, 1).intersected(page_region_used);
+			if (buffer_region.isEmpty())
+				buffer_rect = {};
+			else
+				buffer_rect &= page_extent_transform.mapRect(buffer_region).toAlignedRect();
 		}
-		local_page_buffer.fill(QColor(Qt::white));
-		local_page_painter.begin(&local_page_buffer);
 		
-		page_buffer = &local_page_buffer;
-		page_painter = &local_page_painter;
+		if (!buffer_rect.isEmpty())
+		{
+			local_page_buffer = QImage(buffer_rect.size(), QImage::Format_RGB32);
+			if (local_page_buffer.isNull())
+			{
+				// Allocation failed
+				device_painter->end(); // Signal error
+				return;
+			}
+			local_page_buffer.fill(QColor(Qt::white));
+			local_page_painter.begin(&local_page_buffer);
+			local_page_painter.translate(-buffer_rect.topLeft());
+			local_page_offset = buffer_rect.topLeft();
+			
+			page_buffer = &local_page_buffer;
+			page_painter = &local_page_painter;
+		}
 	}
 	
 	/*
@@ -1031,16 +1182,29 @@ void MapPrinter::drawPage(QPainter* device_painter, const QRectF& page_extent, Q
 	 */
 	if (options.show_templates)
 	{
-		// This is the first output, so it can be drawn directly to page_painter.
-		page_painter->save();
-		
-		page_painter->setRenderHints(render_hints);
-		page_painter->setTransform(page_extent_transform, /*combine*/ true);
-		page_painter->setClipRect(page_region_used, Qt::ReplaceClip);
-		
-		map.drawTemplates(page_painter, page_region_used, 0, first_front_template - 1, view, false);
+		const auto draw_templates = [&](QPainter* painter, int first, int last) {
+			painter->save();
+			
+			painter->setRenderHints(render_hints);
+			painter->setTransform(page_extent_transform, /*combine*/ true);
+			painter->setClipRect(page_region_used, Qt::ReplaceClip);
+			
+			map.drawTemplates(painter, page_region_used, first, last, view, false);
+			
+			painter->restore();
+		};
 		
-		page_painter->restore();
+		if (partial_page_buffer)
+		{
+			draw_templates(device_painter, 0, first_alpha_template - 1);
+			if (local_page_painter.isActive())
+				draw_templates(&local_page_painter, 0, first_front_template - 1);
+		}
+		else
+		{
+			// This is the first output, so it can be drawn directly to page_painter.
+			draw_templates(page_painter, 0, first_front_template - 1);
+		}
 	}
 	
 	if (local_page_painter.isActive() && !use_buffer_for_map)
@@ -1049,7 +1213,7 @@ void MapPrinter::drawPage(QPainter* device_painter, const QRectF& page_extent, Q
 		local_page_painter.end();
 		
 		device_painter->setRenderHint(QPainter::SmoothPixmapTransform, false);
-		device_painter->drawImage(0, 0, local_page_buffer);
+		device_painter->drawImage(local_page_offset, local_page_buffer);
 		
 		page_painter = device_painter;
 	}
@@ -1204,7 +1368,7 @@ void MapPrinter::drawPage(QPainter* device_painter, const QRectF& page_extent, Q
 		local_page_painter.end();
 		
 		device_painter->setRenderHint(QPainter::SmoothPixmapTransform, false);
-		device_painter->drawImage(0, 0, local_page_buffer);
+		device_painter->drawImage(local_page_offset, local_page_buffer);
 	}
 	
 	device_painter->setRenderHints(saved_hints);
@@ -1234,21 +1398,38 @@ void MapPrinter::drawSeparationPages(QPrinter* printer, QPainter* device_painter
 	device_painter->translate(-page_extent.left(), -page_extent.top());
 	device_painter->setClipRect(page_extent.intersected(print_area), Qt::ReplaceClip);
 	
-	bool need_new_page = false;
+	std::vector<const MapColor*> separations;
 	for (int i = map.getNumColors() - 1; i >= 0; --i)
 	{
 		const MapColor* color = map.getColor(i);
 		if (color->getSpotColorMethod() == MapColor::SpotColor)
+			separations.push_back(color);
+	}
+	
+	// The separations are recorded concurrently, sharing the renderables of
+	// the map, and then replayed to the printer in order. Drawing updates
+	// dirty objects, which must not happen concurrently.
+	map.updateObjects();
+	const auto clip_rect = page_extent.intersected(print_area);
+	std::vector<QPicture> pictures(separations.size());
+	Concurrency::parallelFor(0, int(separations.size()), [&](int i) {
+		QPainter painter(&pictures[std::size_t(i)]);
+		painter.setRenderHint(QPainter::Antialiasing);
+		painter.setClipRect(clip_rect, Qt::ReplaceClip);
+		RenderConfig config = { map, page_extent, scale, RenderConfig::NoOptions, 1.0 };
+		map.drawColorSeparation(&painter, config, separations[std::size_t(i)]);
+	});
+	
+	bool need_new_page = false;
+	for (const auto& picture : pictures)
+	{
+		if (need_new_page)
 		{
-			if (need_new_page)
-			{
-				printer->newPage();
-			}
-			
-			RenderConfig config = { map, page_extent, scale, RenderConfig::NoOptions, 1.0 };
-			map.drawColorSeparation(device_painter, config, color);
-			need_new_page = true;
+			printer->newPage();
 		}
+		
+		device_painter->drawPicture(0, 0, picture);
+		need_new_page = true;
 	}
 	
 	device_painter->restore();
@@ -1329,21 +1510,52 @@ bool MapPrinter::printMap(QPrinter* printer)
 	auto message = message_template.arg(1);
 	emit printProgress(0, message);
 	
-	bool need_new_page = false;
+	std::vector<QRectF> page_extents;
+	page_extents.reserve(num_steps);
 	for (auto vpos : v_page_pos)
+	{
+		for (auto hpos : h_page_pos)
+			page_extents.emplace_back(QPointF(hpos, vpos), extent_size);
+	}
+	
+	// Independent pages are recorded concurrently, and then replayed to
+	// the printer in order. Separations are already recorded concurrently
+	// per page. Templates are not prepared for concurrent drawing, and
+	// a device without physical resolution needs special treatment.
+	const auto concurrent_pages = !separationsModeSelected()
+	                              && !(options.show_templates && map.getNumTemplates() > 0)
+	                              && painter.isActive()
+	                              && painter.device()->physicalDpiX() != 0
+	                              && page_extents.size() > 1;
+	const auto batch_size = concurrent_pages ? std::size_t(Concurrency::idealThreadCount()) : std::size_t(1);
+	std::vector<QPicture> pages;
+	std::vector<char> page_ok;
+	
+	bool need_new_page = false;
+	for (std::size_t first = 0; first < page_extents.size(); first += batch_size)
 	{
 		if (!painter.isActive())
 		{
 			break;
 		}
 		
-		for (auto hpos : h_page_pos)
+		const auto last = std::min(page_extents.size(), first + batch_size);
+		if (concurrent_pages)
+		{
+			// Drawing updates dirty objects, which must not happen concurrently.
+			map.updateObjects();
+			pages.assign(last - first, QPicture());
+			page_ok.assign(last - first, false);
+			Concurrency::parallelFor(int(first), int(last), [&](int i) {
+				const auto index = std::size_t(i) - first;
+				QPainter page_painter(&pages[index]);
+				drawPage(&page_painter, page_extents[std::size_t(i)]);
+				page_ok[index] = page_painter.isActive();  // Signals errors
+			});
+		}
+		
+		for (auto i = first; i < last; ++i)
 		{
-			if (!painter.isActive())
-			{
-				break;
-			}
-			
 			++step;
 			auto progress = qMin(99, qMax(1, int((100 * static_cast<decltype(num_steps)>(step) - 50) / num_steps)));
 			emit printProgress(progress, message_template.arg(step));
@@ -1359,14 +1571,27 @@ bool MapPrinter::printMap(QPrinter* printer)
 				printer->newPage();
 			}
 			
-			QRectF page_extent = QRectF(QPointF(hpos, vpos), extent_size);
 			if (separationsModeSelected())
 			{
-				drawSeparationPages(printer, &painter, page_extent);
+				drawSeparationPages(printer, &painter, page_extents[i]);
+			}
+			else if (!concurrent_pages)
+			{
+				drawPage(&painter, page_extents[i]);
+			}
+			else if (page_ok[i - first])
+			{
+				painter.drawPicture(0, 0, pages[i - first]);
+				pages[i - first] = QPicture();  // Release memory early
 			}
 			else
 			{
-				drawPage(&painter, page_extent);
+				painter.end(); // Signal error
+			}
+			
+			if (!painter.isActive())
+			{
+				break;
 			}
 			
 			need_new_page = true;
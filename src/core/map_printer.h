@@ -22,6 +22,7 @@
 #ifndef OPENORIENTEERING_MAP_PRINTER_H
 #define OPENORIENTEERING_MAP_PRINTER_H
 
+#include <functional>
 #include <memory>
 #include <vector>
 
@@ -361,6 +362,27 @@ public:
 	 *  buffer but refers to the logical coordinates of device_painter. */
 	void drawPage(QPainter* device_painter, const QRectF& page_extent, QImage* page_buffer = nullptr) const;
 	
+	/** Draws a single page as a sequence of horizontal image strips.
+	 * 
+	 *  The page image has the given size in pixels. It is rendered in strips
+	 *  of at most strip_height rows, on multiple threads if possible.
+	 *  For each strip, in top-to-bottom order, the sink is called on the
+	 *  calling thread with the strip image and the page row of its first line.
+	 *  Peak memory depends on the strip size and the number of threads,
+	 *  not on the page size.
+	 * 
+	 *  @return true on success, false if a buffer could not be allocated or
+	 *          if the sink returned false. */
+	bool drawPageStrips(const QRectF& page_extent, const QSize& page_size, int strip_height,
+	                    const std::function<bool (const QImage&, int)>& sink) const;
+	
+	/** Draws the print area to an opaque image at the configured resolution.
+	 *
+	 *  The image is drawn in strips, cf. drawPageStrips().
+	 *
+	 *  @return the image, or a null image if it could not be allocated. */
+	QImage drawPrintAreaImage() const;
+	
 	/** Draws the separations as distinct pages to the printer. */
 	void drawSeparationPages(QPrinter* printer, QPainter* device_painter, const QRectF& page_extent) const;
 	
@@ -465,6 +487,12 @@ protected:
 		return options.mode == MapPrinterOptions::Separations;
 	}
 	
+	/** Draws the given region of a page to the painter.
+	 * 
+	 *  The page extent determines the transformation, and the drawing is
+	 *  restricted to the page region (in map coordinates). Cf. drawPage(). */
+	void drawPageRegion(QPainter* device_painter, const QRectF& page_extent, const QRectF& page_region, QImage* page_buffer) const;
+	
 	/** Updates the paper dimensions from paper format and orientation. */
 	void updatePaperDimensions();
 	
@@ -0,0 +1,83 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#include "map_snapshot.h"
+
+#include <cstddef>
+
+#include <QHash>
+#include <QThread>
+#include <QTransform>
+
+#include "core/map.h"
+#include "core/map_color.h"
+#include "core/map_part.h"
+#include "core/map_printer.h"
+#include "undo/undo.h"
+
+
+namespace OpenOrienteering {
+
+MapSnapshot::MapSnapshot(const Map& map)
+: copy(std::make_unique<Map>())
+, change_count(map.changeCount())
+{
+	copy->setScaleDenominator(map.getScaleDenominator());
+	copy->setGeoreferencing(map.getGeoreferencing());
+	copy->setGrid(map.getGrid());
+	copy->setMapNotes(map.getMapNotes());
+	copy->setSymbolSetId(map.symbolSetId());
+	copy->renderable_options = map.renderable_options;
+	if (map.hasPrinterConfig())
+		copy->setPrinterConfig(map.printerConfig());
+	
+	auto const color_map = copy->color_set->importSet(*map.color_set, nullptr, copy.get());
+	auto const symbol_map = copy->importSymbols(map, color_map, -1, false);
+	
+	for (std::size_t i = 0; i < map.parts.size(); ++i)
+	{
+		auto const* part = map.parts[i];
+		auto* part_copy = copy->getPart(0);
+		if (i == 0)
+		{
+			part_copy->setName(part->getName());
+		}
+		else
+		{
+			part_copy = new MapPart(part->getName(), copy.get());
+			copy->addPart(part_copy, i);
+		}
+		// The undo step is not needed.
+		part_copy->importPart(part, symbol_map, QTransform(), false);
+	}
+	copy->current_part_index = map.current_part_index;
+	copy->updateObjects();
+}
+
+
+MapSnapshot::~MapSnapshot()
+{
+	if (copy->thread() != QThread::currentThread())
+		copy.release()->deleteLater();
+}
+
+
+}  // namespace OpenOrienteering
@@ -0,0 +1,96 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#ifndef OPENORIENTEERING_MAP_SNAPSHOT_H
+#define OPENORIENTEERING_MAP_SNAPSHOT_H
+
+#include <memory>
+
+#include <QtGlobal>
+
+namespace OpenOrienteering {
+
+class Map;
+
+
+/**
+ * A read-only copy of a map's state, for use by background jobs.
+ * 
+ * The snapshot owns an independent Map with copies of the colors, symbols,
+ * map parts and objects of the original map, together with its scale,
+ * georeferencing, grid, notes, rendering options and print configuration.
+ * Templates, views and the undo history are not part of a snapshot.
+ * 
+ * All lazily computed state which is needed for drawing, e.g. the object
+ * renderables and extents, is prepared when the snapshot is created. After
+ * that, the snapshot is never modified, so that any number of threads may
+ * read it concurrently while the original map continues to be edited.
+ * Functions which fill caches on demand, e.g. Symbol::getIcon(), must still
+ * not be called concurrently.
+ * 
+ * Snapshots are shared via std::shared_ptr. Use Map::snapshot() to obtain
+ * the current snapshot of a map: While the map is unchanged, a snapshot which
+ * is still in use is returned again, so holding and requesting snapshots is
+ * cheap.
+ */
+class MapSnapshot
+{
+public:
+	/**
+	 * Creates a snapshot of the given map.
+	 * 
+	 * This must be called on the map's thread, while no edit is in progress.
+	 */
+	explicit MapSnapshot(const Map& map);
+	
+	MapSnapshot(const MapSnapshot&) = delete;
+	MapSnapshot& operator=(const MapSnapshot&) = delete;
+	
+	/**
+	 * Destroys the snapshot.
+	 * 
+	 * When called on another thread, the copy of the map is released on the
+	 * thread which created the snapshot.
+	 */
+	~MapSnapshot();
+	
+	/**
+	 * Returns the map's change count at the time of the snapshot.
+	 * 
+	 * \see Map::changeCount()
+	 */
+	quint64 generation() const noexcept { return change_count; }
+	
+	/**
+	 * Returns the read-only copy of the map.
+	 */
+	const Map& map() const noexcept { return *copy; }
+	
+private:
+	std::unique_ptr<Map> copy;
+	quint64 change_count;
+	
+};
+
+
+}  // namespace OpenOrienteering
+
+#endif
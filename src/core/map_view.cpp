@@ -409,6 +409,7 @@ void MapView::setTemplateVisibility(Template* temp, TemplateVisibility vis)
 	auto visible = vis.visible && vis.opacity > 0;
 	if (visible
 	    && temp->getTemplateState() != Template::Loaded
+	    && !temp->isLoadingInBackground()
 	    && !templateLoadingBlocked())
 	{
 		vis.visible = visible = temp->loadTemplateFile(false);
@@ -25,15 +25,18 @@
 #include <cmath>
 #include <cstddef>
 #include <memory>
+#include <numeric>
 #include <stdexcept>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 #include <QtGlobal>
 #include <QDebug>
 #include <QFlags>
 #include <QHash>
 #include <QHashFunctions>
+#include <QRectF>
 #include <QScopedPointer>
 
 #include <clipper.hpp>
@@ -42,12 +45,14 @@
 #include "core/map_coord.h"
 #include "core/map_part.h"
 #include "core/path_coord.h"
+#include "core/spatial_index.h"
 #include "core/virtual_path.h"
 #include "core/objects/object.h"
 #include "core/symbols/symbol.h"
 #include "undo/object_undo.h"
 #include "undo/undo.h"
 #include "util/backports.h"  // IWYU pragma: keep
+#include "util/concurrency.h"
 #include "util/util.h"
 
 
@@ -225,6 +230,69 @@ bool operator==(const ClipperLib::IntPoint& lhs, const MapCoord& rhs)
 	return rhs == lhs;
 }
 
+/**
+ * Partitions objects into clusters of objects with overlapping extents.
+ * 
+ * Objects in different clusters cannot overlap, so that the union can be
+ * calculated independently for each cluster. Clusters are ordered by their
+ * first object, and each cluster keeps the order of the given objects.
+ * 
+ * If an object has no valid extent, a single cluster is returned.
+ */
+std::vector<PathObjects> partitionByExtent(const PathObjects& objects)
+{
+	auto const is_invalid = [](const PathObject* object) { return !object->getExtent().isValid(); };
+	if (std::any_of(begin(objects), end(objects), is_invalid))
+		return { objects };
+	
+	// Union-find over the object indices
+	std::vector<std::size_t> parents(objects.size());
+	std::iota(begin(parents), end(parents), std::size_t(0));
+	auto const find = [&parents](std::size_t i) {
+		while (parents[i] != i)
+		{
+			parents[i] = parents[parents[i]];
+			i = parents[i];
+		}
+		return i;
+	};
+	
+	SpatialIndex<std::size_t> index;
+	for (std::size_t i = 0; i < objects.size(); ++i)
+	{
+		auto const& extent = objects[i]->getExtent();
+		index.query(extent, [&](std::size_t j, const QRectF& other) {
+			// Touching extents must end up in the same cluster.
+			if (extent.left() <= other.right() && other.left() <= extent.right()
+			    && extent.top() <= other.bottom() && other.top() <= extent.bottom())
+			{
+				auto const root_i = find(i);
+				auto const root_j = find(j);
+				parents[std::max(root_i, root_j)] = std::min(root_i, root_j);
+			}
+		});
+		index.insert(i, extent);
+	}
+	
+	std::vector<PathObjects> clusters;
+	std::vector<std::size_t> cluster_of(objects.size());
+	for (std::size_t i = 0; i < objects.size(); ++i)
+	{
+		auto const root = find(i);
+		if (root == i)
+		{
+			cluster_of[i] = clusters.size();
+			clusters.emplace_back();
+		}
+		else
+		{
+			cluster_of[i] = cluster_of[root];
+		}
+		clusters[cluster_of[i]].push_back(objects[i]);
+	}
+	return clusters;
+}
+
 }  // namespace
 
 
@@ -238,6 +306,11 @@ BooleanTool::BooleanTool(Operation op, Map* map)
 	; // nothing
 }
 
+void BooleanTool::setProgressHandler(const ProgressHandler& handler)
+{
+	progress_handler = handler;
+}
+
 bool BooleanTool::execute()
 {
 	// Check basic prerequisite
@@ -281,6 +354,8 @@ bool BooleanTool::execute()
 
 bool BooleanTool::executePerSymbol()
 {
+	canceled = false;
+	
 	PathObjects backlog;
 	backlog.reserve(map->getNumSelectedObjects());
 	
@@ -291,12 +366,15 @@ bool BooleanTool::executePerSymbol()
 			backlog.push_back(object->asPath());
 	}
 	
-	QScopedPointer<CombinedUndoStep> undo_step(new CombinedUndoStep(map));
+	struct Group
+	{
+		PathObject* primary_object;
+		PathObjects in_objects;
+	};
+	std::vector<Group> groups;
 	PathObjects new_backlog;
 	new_backlog.reserve(backlog.size()/2);
 	PathObjects in_objects;
-	in_objects.reserve(backlog.size()/2);
-	PathObjects out_objects;
 	while (!backlog.empty())
 	{
 		PathObject* const primary_object = backlog.front();
@@ -325,9 +403,92 @@ bool BooleanTool::executePerSymbol()
 		if (in_objects.size() == 1)
 			continue;
 		
-		// Perform the core operation
-		out_objects.clear();
-		executeForObjects(primary_object, in_objects, out_objects, *undo_step);
+		groups.push_back({ primary_object, in_objects });
+	}
+	
+	// Split the groups into independent tasks.
+	struct Task
+	{
+		std::size_t group;
+		const PathObject* subject;
+		PathObjects in_objects;
+		PathObjects out_objects;
+		bool success;
+	};
+	std::vector<Task> tasks;
+	std::size_t total_size = 0;
+	for (std::size_t group = 0; group < groups.size(); ++group)
+	{
+		auto const& in_objects = groups[group].in_objects;
+		groups[group].primary_object->update();
+		for (auto* object : in_objects)
+			object->update();
+		total_size += in_objects.size();
+		
+		if (op == Union)
+		{
+			for (auto& cluster : partitionByExtent(in_objects))
+			{
+				auto const* subject = cluster.front();
+				tasks.push_back({ group, subject, std::move(cluster), {}, false });
+			}
+		}
+		else
+		{
+			tasks.push_back({ group, groups[group].primary_object, in_objects, {}, false });
+		}
+	}
+	
+	// Larger tasks first, for better load balancing
+	std::stable_sort(begin(tasks), end(tasks), [](const Task& a, const Task& b) {
+		return a.in_objects.size() > b.in_objects.size();
+	});
+	
+	// Run the tasks in parallel batches, reporting progress in between.
+	auto const batch_size = std::size_t(4 * Concurrency::idealThreadCount());
+	std::size_t done_size = 0;
+	for (std::size_t first = 0; first < tasks.size() && !canceled; first += batch_size)
+	{
+		auto const last = std::min(tasks.size(), first + batch_size);
+		Concurrency::parallelFor(int(first), int(last), [this, &tasks, &groups](int i) {
+			auto& task = tasks[std::size_t(i)];
+			task.success = executeForObjects(task.subject, task.in_objects, task.out_objects, groups[task.group].primary_object);
+		});
+		
+		for (auto i = first; i < last; ++i)
+			done_size += tasks[i].in_objects.size();
+		if (progress_handler && !progress_handler(int(100 * done_size / std::max(total_size, std::size_t(1)))))
+			canceled = true;
+	}
+	
+	// Failure for any task leaves the whole group unchanged.
+	std::vector<bool> group_failed(groups.size(), canceled);
+	for (auto const& task : tasks)
+	{
+		if (!task.success)
+			group_failed[task.group] = true;
+	}
+	
+	QScopedPointer<CombinedUndoStep> undo_step(new CombinedUndoStep(map));
+	std::vector<PathObjects> group_out_objects(groups.size());
+	std::sort(begin(tasks), end(tasks), [](const Task& a, const Task& b) {
+		return a.group < b.group;
+	});
+	for (auto& task : tasks)
+	{
+		if (group_failed[task.group])
+		{
+			for (auto* object : task.out_objects)
+				delete object;
+			continue;
+		}
+		auto& out_objects = group_out_objects[task.group];
+		out_objects.insert(end(out_objects), begin(task.out_objects), end(task.out_objects));
+	}
+	for (std::size_t group = 0; group < groups.size(); ++group)
+	{
+		if (!group_failed[group])
+			replaceObjects(groups[group].primary_object, groups[group].in_objects, group_out_objects[group], *undo_step);
 	}
 	
 	bool const have_changes = undo_step->getNumSubSteps() > 0;
@@ -349,6 +510,12 @@ bool BooleanTool::executeForObjects(const PathObject* subject, const PathObjects
 		return false; // in release build
 	}
 	
+	replaceObjects(subject, in_objects, out_objects, undo_step);
+	return true;
+}
+
+void BooleanTool::replaceObjects(const PathObject* subject, const PathObjects& in_objects, const PathObjects& out_objects, CombinedUndoStep& undo_step)
+{
 	// Add original objects to undo step, and remove them from map.
 	QScopedPointer<AddObjectsUndoStep> add_step(new AddObjectsUndoStep(map));
 	for (PathObject* object : in_objects)
@@ -385,10 +552,14 @@ bool BooleanTool::executeForObjects(const PathObject* subject, const PathObjects
 	
 	undo_step.push(add_step.take());
 	undo_step.push(delete_step.take());
-	return true;
 }
 
 bool BooleanTool::executeForObjects(const PathObject* subject, const PathObjects& in_objects, PathObjects& out_objects) const
+{
+	return executeForObjects(subject, in_objects, out_objects, subject);
+}
+
+bool BooleanTool::executeForObjects(const PathObject* subject, const PathObjects& in_objects, PathObjects& out_objects, const PathObject* proto) const
 {
 	// Convert the objects to Clipper polygons and
 	// create a hash map, mapping point positions to the PathCoords.
@@ -436,7 +607,7 @@ bool BooleanTool::executeForObjects(const PathObject* subject, const PathObjects
 	if (success)
 	{
 		// Try to convert the solution polygons to objects again
-		polyTreeToPathObjects(solution, out_objects, subject, polymap);
+		polyTreeToPathObjects(solution, out_objects, proto, polymap);
 	}
 	
 	return success;
@@ -570,6 +741,11 @@ void pathObjectToPolygons(
 	
 	polygons.reserve(polygons.size() + object->parts().size());
 	
+	auto num_path_coords = 0;
+	for (const auto& part : object->parts())
+		num_path_coords += int(part.path_coords.size());
+	polymap.reserve(polymap.size() + num_path_coords);
+	
 	for (const auto& part : object->parts())
 	{
 		const PathCoordVector& path_coords = part.path_coords;
@@ -623,13 +799,13 @@ void polygonToPathPart(const ClipperLib::Path& polygon, const PolyMap& polymap,
 	// (because we cannot start in the middle of a curve)
 	for (; part_start_index < num_points; ++part_start_index)
 	{
-		auto current_point = polygon.at(part_start_index);
-		if (!polymap.contains(current_point))
+		auto info = polymap.constFind(polygon.at(part_start_index));
+		if (info == polymap.constEnd())
 			break;
 		
-		if (polymap.value(current_point).second->param == 0.0)
+		if (info->second->param == 0.0)
 		{
-			cur_info = polymap.value(current_point);
+			cur_info = *info;
 			break;
 		}
 	}
@@ -663,9 +839,9 @@ void polygonToPathPart(const ClipperLib::Path& polygon, const PolyMap& polymap,
 			i = 0;
 		
 		PathCoordInfo new_info{ nullptr, nullptr };
-		auto new_point = polygon.at(i);
-		if (polymap.contains(new_point))
-			new_info = polymap.value(new_point);
+		auto info = polymap.constFind(polygon.at(i));
+		if (info != polymap.constEnd())
+			new_info = *info;
 		
 		if (cur_info.first && cur_info.first == new_info.first)
 		{
@@ -801,14 +977,18 @@ void rebuildSegment(
 	const auto& second_last_point = polygon.at((end_index ? end_index : num_points) - 1);
 	const auto& end_point         = polygon.at(end_index);
 	
-	// Try to find the middle coordinates in the same part
+	// Try to find the middle coordinates in the same part.
+	// Only the entries for the given points are visited, so that the cost
+	// does not depend on the total number of path coords in the polymap.
 	bool found = false;
 	PathCoordInfo second_info{ nullptr, nullptr };
 	PathCoordInfo second_last_info{ nullptr, nullptr };
-	for (auto second_it = polymap.find(second_point); second_it != polymap.end(); ++second_it)
+	for (auto second_it = polymap.constFind(second_point);
+	     second_it != polymap.constEnd() && second_it.key() == second_point;
+	     ++second_it)
 	{
-		for (auto second_last_it = polymap.find(second_last_point);
-		     second_last_it != polymap.end() && second_last_it.key() == second_last_point;
+		for (auto second_last_it = polymap.constFind(second_last_point);
+		     second_last_it != polymap.constEnd() && second_last_it.key() == second_last_point;
 		     ++second_last_it)
 		{
 			if (second_it->first == second_last_it->first &&
@@ -837,8 +1017,8 @@ void rebuildSegment(
 	
 	// Try to find the outer coordinates in the same part
 	PathCoordInfo start_info{ nullptr, nullptr };
-	for (auto start_it = polymap.find(start_point);
-	     start_it != polymap.end() && start_it.key() == start_point;
+	for (auto start_it = polymap.constFind(start_point);
+	     start_it != polymap.constEnd() && start_it.key() == start_point;
 	     ++start_it)
 	{
 		if (start_it->first == original_path)
@@ -850,8 +1030,8 @@ void rebuildSegment(
 	Q_ASSERT(!start_info.first || start_info.first == second_info.first);
 	
 	PathCoordInfo end_info{ nullptr, nullptr };
-	for (auto end_it = polymap.find(end_point);
-	     end_it != polymap.end() && end_it.key() == end_point;
+	for (auto end_it = polymap.constFind(end_point);
+	     end_it != polymap.constEnd() && end_it.key() == end_point;
 	     ++end_it)
 	{
 		if (end_it->first == original_path)
@@ -1170,10 +1350,10 @@ void rebuildCoordinate(
         bool start_new_part)
 {
 	auto coord = MapCoord::fromNative64(polygon.at(index).X, polygon.at(index).Y);
-	if (polymap.contains(polygon.at(index)))
+	auto info = polymap.constFind(polygon.at(index));
+	if (info != polymap.constEnd())
 	{
-		PathCoordInfo info = polymap.value(polygon.at(index));
-		const auto original = info.first->path->getCoordinate(info.second->index);
+		const auto original = info->first->path->getCoordinate(info->second->index);
 		
 		if (original.isDashPoint())
 			coord.setDashPoint(true);
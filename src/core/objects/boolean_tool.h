@@ -22,6 +22,7 @@
 #ifndef OPENORIENTEERING_BOOLEAN_TOOL_H
 #define OPENORIENTEERING_BOOLEAN_TOOL_H
 
+#include <functional>
 #include <vector>
 
 // IWYU pragma: no_include <algorithm>
@@ -64,6 +65,13 @@ public:
 		MergeHoles
 	};
 	
+	/**
+	 * A function which receives the progress in percent.
+	 * 
+	 * It returns false in order to cancel the operation.
+	 */
+	using ProgressHandler = std::function<bool (int percent)>;
+	
 	/**
 	 * Constructs a tool for the given operation and map.
 	 * 
@@ -71,6 +79,18 @@ public:
 	 */
 	BooleanTool(Operation op, Map* map);
 	
+	/**
+	 * Sets a function which is called while executePerSymbol() makes progress.
+	 * 
+	 * The handler is called from the thread which runs executePerSymbol().
+	 */
+	void setProgressHandler(const ProgressHandler& handler);
+	
+	/**
+	 * Returns true if the last operation was canceled by the progress handler.
+	 */
+	bool wasCanceled() const { return canceled; }
+	
 	/**
 	 * Executes the operation on the selected objects in the map.
 	 * 
@@ -91,6 +111,13 @@ public:
 	 * operation failed for remain unchanged. The operation continues for other
 	 * groups of objects.
 	 * 
+	 * The groups are processed in parallel. For the Union operation, each
+	 * group is further partitioned into clusters of objects with overlapping
+	 * extents, and the clusters are processed in parallel, too.
+	 * 
+	 * If the progress handler cancels the operation, the map remains
+	 * unchanged, and wasCanceled() returns true.
+	 * 
 	 * @return True if the map was changed, false otherwise.
 	 */
 	bool executePerSymbol();
@@ -139,8 +166,35 @@ protected:
 	        PathObjects& out_objects,
 	        CombinedUndoStep& undo_step );
 	
+	/**
+	 * Replaces the affected original objects by the resulting objects,
+	 * and provides undo steps.
+	 * 
+	 * This function changes the collection of objects in the map and the selection.
+	 */
+	void replaceObjects(
+	        const PathObject* subject,
+	        const PathObjects& in_objects,
+	        const PathObjects& out_objects,
+	        CombinedUndoStep& undo_step );
+	
+	/**
+	 * Executes the operation on particular objects, using proto as the
+	 * prototype of the resulting objects.
+	 * 
+	 * This function is thread-safe as long as the objects are not modified.
+	 * The objects must be up-to-date.
+	 */
+	bool executeForObjects(
+	        const PathObject* subject,
+	        const PathObjects& in_objects,
+	        PathObjects& out_objects,
+	        const PathObject* proto ) const;
+	
 	Operation const op;
 	Map* const map;
+	ProgressHandler progress_handler;
+	bool canceled = false;
 };
 
 
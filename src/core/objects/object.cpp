@@ -26,9 +26,12 @@
 #include <cstddef>
 #include <iterator>
 #include <memory>
+#include <mutex>
 #include <numeric>
 #include <stdexcept>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
 #include <Qt>
 #include <QtNumeric>
@@ -47,6 +50,7 @@
 #include "settings.h"
 #include "core/map.h"
 #include "core/objects/text_object.h"
+#include "core/path_simplification.h"
 #include "core/renderables/renderable.h"
 #include "core/symbols/line_symbol.h"
 #include "core/symbols/point_symbol.h"
@@ -55,6 +59,8 @@
 #include "core/virtual_coord_vector.h"
 #include "fileformats/file_format.h"
 #include "fileformats/file_import_export.h"
+#include "util/concurrency.h"
+#include "util/profiler.h"
 #include "util/util.h"
 #include "util/xml_stream_util.h"
 
@@ -82,6 +88,16 @@ namespace literal
 
 namespace OpenOrienteering {
 
+namespace {
+
+/**
+ * The minimum number of objects which are deleted in the background.
+ */
+constexpr std::size_t min_background_deletion = 1000;
+
+}  // namespace
+
+
 // ### Object implementation ###
 
 Object::Object(Object::Type type, const Symbol* symbol)
@@ -124,13 +140,25 @@ void Object::copyFrom(const Object& other)
 	if (type != other.type)
 		throw std::invalid_argument(Q_FUNC_INFO);
 	
+	auto const symbol_changed = symbol != other.symbol;
 	symbol = other.symbol;
 	coords = other.coords;
 	rotation = other.rotation;
 	// map unchanged!
-	object_tags = other.object_tags;
-	output_dirty = true;
+	if (map && object_tags != other.object_tags)
+	{
+		auto const old_tags = object_tags;
+		object_tags = other.object_tags;
+		map->objectTagsChanged(this, old_tags);
+	}
+	else
+	{
+		object_tags = other.object_tags;
+	}
+	if (map && symbol_changed)
+		map->objectSymbolChanged(this);
 	extent = other.extent;
+	setOutputDirty();
 }
 
 bool Object::equals(const Object* other, bool compare_symbol) const
@@ -467,6 +495,22 @@ void Object::setRotation(qreal new_rotation)
 }
 
 
+void Object::setOutputDirty(bool dirty)
+{
+	auto const was_dirty = output_dirty;
+	output_dirty = dirty;
+	if (dirty && !was_dirty && map)
+		map->objectExtentChanged(this);
+}
+
+std::size_t Object::memoryUsage() const
+{
+	return sizeof(Object)
+	       + coords.capacity() * sizeof(MapCoord)
+	       + std::size_t(object_tags.size()) * sizeof(ObjectTag)
+	       + output.memoryUsage();
+}
+
 void Object::forceUpdate() const
 {
 	output_dirty = true;
@@ -478,13 +522,18 @@ bool Object::update() const
 	if (!output_dirty)
 		return false;
 	
+	Profiler::Scope profiler_scope(Profiler::ObjectUpdate);
+	const auto old_extent = extent;
+	regenerateOutput();
+	finishUpdate(old_extent);
+	return true;
+}
+
+void Object::regenerateOutput() const
+{
 	Symbol::RenderableOptions options = Symbol::RenderNormal;
 	if (map)
-	{
 		options = QFlag(map->renderableOptions());
-		if (extent.isValid())
-			map->setObjectAreaDirty(extent);
-	}
 	
 	output.deleteRenderables();
 	
@@ -495,16 +544,20 @@ bool Object::update() const
 	createRenderables(output, options);
 	
 	Q_ASSERT(extent.right() < 60000000);	// assert if bogus values are returned
+}
+
+void Object::finishUpdate(const QRectF& old_extent) const
+{
 	output_dirty = false;
 	
 	if (map)
 	{
+		if (old_extent.isValid())
+			map->setObjectAreaDirty(old_extent);
 		map->insertRenderablesOfObject(this);
 		if (extent.isValid())
 			map->setObjectAreaDirty(extent);
 	}
-	
-	return true;
 }
 
 void Object::updateEvent() const
@@ -637,6 +690,11 @@ void Object::takeRenderables()
 	output.takeRenderables();
 }
 
+void Object::remapColorPriorities(const std::vector<int>& priorities) const
+{
+	output.remapColorPriorities(priorities);
+}
+
 void Object::clearRenderables()
 {
 	output.deleteRenderables();
@@ -651,7 +709,15 @@ bool Object::setSymbol(const Symbol* new_symbol, bool no_checks)
 			return false;
 	}
 	
-	symbol = new_symbol;
+	if (map && symbol != new_symbol)
+	{
+		symbol = new_symbol;
+		map->objectSymbolChanged(this);
+	}
+	else
+	{
+		symbol = new_symbol;
+	}
 	setOutputDirty();
 	return true;
 }
@@ -670,13 +736,36 @@ Object* Object::getObjectForType(Object::Type type, const Symbol* symbol)
 	return nullptr;
 }
 
+void Object::deleteObjects(std::vector<Object*>&& objects)
+{
+	auto const first_text = std::partition(begin(objects), end(objects), [](const Object* object) {
+		return object->getType() != Object::Text;
+	});
+	std::for_each(first_text, end(objects), [](Object* object) { delete object; });
+	objects.erase(first_text, end(objects));
+	
+	if (objects.size() < min_background_deletion)
+	{
+		for (auto* object : objects)
+			delete object;
+		return;
+	}
+	
+	Concurrency::runInBackground([objects = std::move(objects)]() {
+		for (auto* object : objects)
+			delete object;
+	});
+}
+
 void Object::setTags(const Object::Tags& tags)
 {
 	if (object_tags != tags)
 	{
+		auto const old_tags = object_tags;
 		object_tags = tags;
 		if (map)
 		{
+			map->objectTagsChanged(this, old_tags);
 			map->setObjectsDirty();
 			if (map->isObjectSelected(this))
 				map->emitSelectionEdited();
@@ -686,11 +775,14 @@ void Object::setTags(const Object::Tags& tags)
 
 void Object::setTag(const QString& key, const QString& value)
 {
-	if (!object_tags.contains(key) || object_tags.value(key) != value)
+	auto const tag = object_tags.find(key);
+	if (tag == object_tags.end() || tag.value() != value)
 	{
+		auto const old_tags = map ? object_tags : Tags();
 		object_tags.insert(key, value);
 		if (map)
 		{
+			map->objectTagsChanged(this, old_tags);
 			map->setObjectsDirty();
 			if (map->isObjectSelected(this))
 				map->emitSelectionEdited();
@@ -702,9 +794,13 @@ void Object::removeTag(const QString& key)
 {
 	if (object_tags.contains(key))
 	{
+		auto const old_tags = map ? object_tags : Tags();
 		object_tags.remove(key);
 		if (map)
+		{
+			map->objectTagsChanged(this, old_tags);
 			map->setObjectsDirty();
+		}
 	}
 }
 
@@ -827,6 +923,45 @@ void PathPart::reverse()
 	path->setOutputDirty();
 }
 
+void PathPart::copySection(
+        PathCoord::length_type start_len,
+        PathCoord::length_type end_len,
+        MapCoordVector& out_coords) const
+{
+	Q_ASSERT(end_len > start_len || isClosed());
+	
+	auto part_begin = SplitPathCoord::begin(path_coords);
+	auto part_end   = SplitPathCoord::end(path_coords);
+	if (start_len == part_end.clen && end_len == part_begin.clen)
+		start_len = part_begin.clen;
+	auto start      = SplitPathCoord::at(start_len, part_begin);
+	
+	if (end_len <= start_len)
+	{
+		if (start_len < part_end.clen)
+		{
+			// Make sure part_end has the right curve end points for start.
+			part_end = SplitPathCoord::at(part_end.clen, start);
+			copy(start, part_end, out_coords);
+			out_coords.back().setHolePoint(false);
+			out_coords.back().setClosePoint(false);
+		}
+		
+		if (end_len > part_begin.clen)
+		{
+			auto end = SplitPathCoord::at(end_len, part_begin);
+			copy(part_begin, end, out_coords);
+		}
+		
+		Q_ASSERT(!out_coords.empty());
+	}
+	else
+	{
+		auto end = SplitPathCoord::at(end_len, start);
+		copy(start, end, out_coords);
+	}
+}
+
 // static
 PathPartVector PathPart::calculatePathParts(const VirtualCoordVector& coords)
 {
@@ -900,6 +1035,7 @@ PathObject::PathObject(const PathObject& proto)
 : Object(proto)
 , pattern_origin(proto.pattern_origin)
 {
+	proto.ensurePathCoords();
 	path_parts.reserve(proto.path_parts.size());
 	for (const PathPart& part : proto.path_parts)
 	{
@@ -911,6 +1047,7 @@ PathObject::PathObject(const PathPart &proto_part)
 : Object(*proto_part.path)
 , pattern_origin(proto_part.path->pattern_origin)
 {
+	proto_part.path->ensurePathCoords();
 	auto begin = proto_part.path->coords.begin();
 	coords.reserve(proto_part.size());
 	coords.assign(begin + proto_part.first_index, begin + (proto_part.last_index+1));
@@ -934,12 +1071,14 @@ void PathObject::copyFrom(const Object& other)
 	const PathObject& other_path = *other.asPath();
 	pattern_origin = other_path.getPatternOrigin();
 	
+	other_path.ensurePathCoords();
 	path_parts.clear();
 	path_parts.reserve(other_path.path_parts.size());
 	for (const PathPart& part : other_path.path_parts)
 	{
 		path_parts.emplace_back(*this, part);
 	}
+	path_coords_released.store(false, std::memory_order_release);
 }
 
 
@@ -988,8 +1127,42 @@ void PathObject::normalize()
 	}
 }
 
+std::size_t PathObject::memoryUsage() const
+{
+	return Object::memoryUsage() + sizeof(PathObject) - sizeof(Object)
+	       + path_parts.capacity() * sizeof(PathPart)
+	       + pathCoordsMemoryUsage();
+}
+
+std::size_t PathObject::pathCoordsMemoryUsage() const
+{
+	return std::accumulate(begin(path_parts), end(path_parts), std::size_t(0), [](auto bytes, const PathPart& part) {
+		return bytes + part.path_coords.memoryUsage();
+	});
+}
+
+void PathObject::releasePathCoords() const
+{
+	if (isOutputDirty() || hasReleasedPathCoords())
+		return;
+	
+	for (auto& part : path_parts)
+		part.path_coords.release();
+	path_coords_released.store(true, std::memory_order_release);
+}
+
+void PathObject::rebuildPathCoords() const
+{
+	// Released path coords are rare, so a single mutex is good enough.
+	static std::mutex mutex;
+	std::lock_guard<std::mutex> lock(mutex);
+	if (hasReleasedPathCoords())
+		updatePathCoords();
+}
+
 bool PathObject::intersectsBox(const QRectF& box) const
 {
+	ensurePathCoords();
 	// Check path parts for an intersection with box
 	if (std::any_of(begin(path_parts), end(path_parts), [&box](const PathPart& part) { return part.intersectsBox(box); }))
 	{
@@ -1007,11 +1180,14 @@ bool PathObject::intersectsBox(const QRectF& box) const
 
 PathPartVector::const_iterator PathObject::findPartForIndex(MapCoordVector::size_type coords_index) const
 {
+	// Callers may access the path coords of the part.
+	ensurePathCoords();
 	return std::lower_bound(begin(path_parts), end(path_parts), coords_index, PathPartVector::compareEndIndex);
 }
 
 PathPartVector::iterator PathObject::findPartForIndex(MapCoordVector::size_type coords_index)
 {
+	ensurePathCoords();
 	setOutputDirty();
 	return std::lower_bound(begin(path_parts), end(path_parts), coords_index, PathPartVector::compareEndIndex);
 }
@@ -1029,6 +1205,7 @@ PathPartVector::size_type PathObject::findPartIndexForIndex(MapCoordVector::size
 
 PathCoord PathObject::findPathCoordForIndex(MapCoordVector::size_type index) const
 {
+	ensurePathCoords();
 	auto part = findPartForIndex(index);
 	if (part != end(path_parts))
 	{
@@ -1109,6 +1286,7 @@ ClosestPathCoord PathObject::findClosestPointTo(
         MapCoordVector::size_type const end_index) const
 {
 	update();
+	ensurePathCoords();
 	
 	auto const op = [&](auto acc, auto const& part) {
 		if (part.first_index <= end_index && part.last_index >= start_index) /// \todo Legacy compatibility, review/remove
@@ -1133,6 +1311,7 @@ ClosestBorderPathCoord PathObject::findClosestPointOnBorder(
         const PathCoord& path_coord,
         double const distance_bound_squared) const
 {
+	ensurePathCoords();
 	Q_ASSERT(!isOutputDirty());  // implied by prerequisite to supply PathCoord
 	
 	if (!symbol)
@@ -1243,6 +1422,8 @@ MapCoordVector::size_type PathObject::subdivide(MapCoordVector::size_type index,
 
 bool PathObject::canBeConnected(const PathObject* other, double connect_threshold_sq) const
 {
+	ensurePathCoords();
+	other->ensurePathCoords();
 	for (const auto& part : path_parts)
 	{
 		if (part.isClosed())
@@ -1268,6 +1449,8 @@ bool PathObject::canBeConnected(const PathObject* other, double connect_threshol
 
 bool PathObject::connectIfClose(PathObject* other, double connect_threshold_sq)
 {
+	ensurePathCoords();
+	other->ensurePathCoords();
 	bool did_connect_path = false;
 	
 	auto num_parts = parts().size();
@@ -1328,6 +1511,8 @@ bool PathObject::connectIfClose(PathObject* other, double connect_threshold_sq)
 
 void PathObject::connectPathParts(PathPartVector::size_type part_index, const PathObject* other, PathPartVector::size_type other_part_index, bool prepend, bool merge_ends)
 {
+	ensurePathCoords();
+	other->ensurePathCoords();
 	Q_ASSERT(part_index < path_parts.size());
 	PathPart& part = path_parts[part_index];
 	PathPart& other_part = other->path_parts[other_part_index];
@@ -1394,6 +1579,7 @@ std::vector<PathObject*> PathObject::removeFromLine(
         PathCoord::length_type removal_begin,
         PathCoord::length_type removal_end) const
 {
+	ensurePathCoords();
 	Q_ASSERT(path_parts.size() == 1); // TODO
 	Q_ASSERT((symbol->getContainedTypes() & ~Symbol::Combined) == Symbol::Line);
 	
@@ -1437,6 +1623,7 @@ std::vector<PathObject*> PathObject::removeFromLine(
 
 std::vector<PathObject*> PathObject::splitLineAt(const PathCoord& split_pos) const
 {
+	ensurePathCoords();
 	Q_ASSERT(path_parts.size() == 1);
 	Q_ASSERT((symbol->getContainedTypes() & ~Symbol::Combined) == Symbol::Line);
 	
@@ -1481,45 +1668,14 @@ void PathObject::changePathBounds(
         PathCoord::length_type end_len)
 {
 	update();
+	ensurePathCoords();
 	
 	PathPart& part = path_parts[part_index];
-	Q_ASSERT(end_len > start_len || part.isClosed());
-	
 	auto part_size = part.size();
 	
 	MapCoordVector out_coords;
 	out_coords.reserve(part_size + 2);
-	
-	auto part_begin = SplitPathCoord::begin(part.path_coords);
-	auto part_end   = SplitPathCoord::end(part.path_coords);
-	if (start_len == part_end.clen && end_len == part_begin.clen)
-		start_len = part_begin.clen;
-	auto start      = SplitPathCoord::at(start_len, part_begin);
-	
-	if (end_len <= start_len)
-	{
-		if (start_len < part_end.clen)
-		{
-			// Make sure part_end has the right curve end points for start.
-			part_end = SplitPathCoord::at(part_end.clen, start);
-			part.copy(start, part_end, out_coords);
-			out_coords.back().setHolePoint(false);
-			out_coords.back().setClosePoint(false);
-		}
-		
-		if (end_len > part_begin.clen)
-		{
-			auto end = SplitPathCoord::at(end_len, part_begin);
-			part.copy(part_begin, end, out_coords);
-		}
-		
-		Q_ASSERT(!out_coords.empty());
-	}
-	else
-	{
-		auto end = SplitPathCoord::at(end_len, start);
-		part.copy(start, end, out_coords);
-	}
+	part.copySection(start_len, end_len, out_coords);
 	
 	out_coords.back().setHolePoint(true);
 	out_coords.back().setClosePoint(false);
@@ -2052,6 +2208,7 @@ void PathObject::appendPathPart(const PathPart &part)
 
 void PathObject::reverse()
 {
+	ensurePathCoords();
 	for (auto& part : path_parts)
 		part.reverse();
 		
@@ -2060,12 +2217,14 @@ void PathObject::reverse()
 
 void PathObject::closeAllParts()
 {
+	ensurePathCoords();
 	for (auto& part : path_parts)
 		part.setClosed(true, true);
 }
 
 bool PathObject::convertToCurves(PathObject** undo_duplicate)
 {
+	ensurePathCoords();
 	bool converted_a_range = false;
 	for (const auto& part : path_parts)
 	{
@@ -2194,6 +2353,7 @@ PathPart::size_type PathObject::convertRangeToCurves(const PathPart& part, PathP
 
 bool PathObject::simplify(PathObject** undo_duplicate, double threshold)
 {
+	ensurePathCoords();
 	// A copy for reference and undo while this is modified.
 	QScopedPointer<PathObject> original(new PathObject(*this));
 	
@@ -2222,6 +2382,34 @@ bool PathObject::simplify(PathObject** undo_duplicate, double threshold)
 	
 	for (auto part = path_parts.rbegin(); part != path_parts.rend(); ++part)
 	{
+		auto const part_begin = begin(coords) + part->first_index;
+		auto const part_end = begin(coords) + part->last_index;
+		if (std::none_of(part_begin, part_end, [](const MapCoord& coord) { return coord.isCurveStart(); }))
+		{
+			// Polylines such as GPS tracks are simplified by a dedicated faster algorithm.
+			auto const keep = PathSimplification::removeLeastSignificant(coords, part->first_index, part->last_index, threshold, part->isClosed() ? 4 : 2);
+			auto out = part->first_index;
+			for (auto i = part->first_index; i <= part->last_index; ++i)
+			{
+				if (!keep[i - part->first_index])
+					continue;
+				coords[out] = coords[i];
+				original_indices[out] = original_indices[i];
+				costs[out] = costs[i];
+				++out;
+			}
+			auto const removed = MapCoordVector::difference_type(part->last_index + 1 - out);
+			if (removed > 0)
+			{
+				coords.erase(begin(coords) + out, begin(coords) + out + removed);
+				original_indices.erase(begin(original_indices) + out, begin(original_indices) + out + removed);
+				costs.erase(begin(costs) + out, begin(costs) + out + removed);
+				setOutputDirty();
+				partSizeChanged(std::prev(part.base()), -removed);
+			}
+			continue;
+		}
+		
 		// Don't simplify parts which would get deleted.
 		MapCoordVector::size_type minimum_part_size = part->isClosed() ? 4 : 3;
 		auto minimumPartSizeReached = [&part, minimum_part_size]() -> bool
@@ -2407,6 +2595,7 @@ int PathObject::isPointOnPath(
         bool treat_areas_as_paths,
         bool extended_selection) const
 {
+	ensurePathCoords();
 	auto side_tolerance = tolerance;
 	if (extended_selection && map && (symbol->getType() == Symbol::Line || symbol->getType() == Symbol::Combined))
 	{
@@ -2418,15 +2607,20 @@ int PathObject::isPointOnPath(
 	if ((contained_types & Symbol::Line || treat_areas_as_paths) && tolerance > 0)
 	{
 		update();
+		
+		// Segments can only match when their bounding box is within the
+		// diagonal of tolerance and side_tolerance.
+		auto const max_distance_sq = tolerance*tolerance + side_tolerance*side_tolerance;
+		auto const descend = [&coord, max_distance_sq](const PathCoordTree::Box& box) {
+			return box.distanceSquaredTo(coord) <= max_distance_sq;
+		};
 		for (const auto& part : path_parts)
 		{
 			const auto& path_coords = part.path_coords;
-			auto size = path_coords.size();
-			for (PathCoordVector::size_type i = 0; i < size - 1; ++i)
-			{
+			auto const is_on_segment = [&](PathCoordVector::size_type i) {
 				Q_ASSERT(path_coords[i].index < coords.size());
 				if (coords[path_coords[i].index].isHolePoint())
-					continue;
+					return false;
 				
 				MapCoordF to_coord = coord - path_coords[i].pos;
 				MapCoordF to_next = path_coords[i+1].pos - path_coords[i].pos;
@@ -2435,27 +2629,28 @@ int PathObject::isPointOnPath(
 				
 				auto dist_along_line = MapCoordF::dotProduct(to_coord, tangent);
 				if (dist_along_line < -tolerance)
-					continue;
+					return false;
 				
 				if (dist_along_line < 0 && to_coord.lengthSquared() <= tolerance*tolerance)
-					return Symbol::Line;
+					return true;
 				
 				auto line_length = qreal(path_coords[i+1].clen) - qreal(path_coords[i].clen);
 				if (line_length < 1e-7)
-					continue;
+					return false;
 				
 				if (dist_along_line > line_length + tolerance)
-					continue;
+					return false;
 				
 				if (dist_along_line > line_length && coord.distanceSquaredTo(path_coords[i+1].pos) <= tolerance*tolerance)
-					return Symbol::Line;
+					return true;
 				
 				auto right = tangent.perpRight();
 				
 				auto dist_from_line = qAbs(MapCoordF::dotProduct(right, to_coord));
-				if (dist_from_line <= side_tolerance)
-					return Symbol::Line;
-			}
+				return dist_from_line <= side_tolerance;
+			};
+			if (path_coords.visitSegments(descend, is_on_segment))
+				return Symbol::Line;
 		}
 	}
 	
@@ -2472,6 +2667,7 @@ int PathObject::isPointOnPath(
 bool PathObject::isPointInsideArea(const MapCoordF& coord) const
 {
 	update();
+	ensurePathCoords();
 	bool inside = false;
 	for (const auto& part : path_parts)
 	{
@@ -2488,6 +2684,8 @@ double PathObject::calcMaximumDistanceTo(
         MapCoordVector::size_type other_start_index,
         MapCoordVector::size_type other_end_index) const
 {
+	ensurePathCoords();
+	other->ensurePathCoords();
 	update();
 	
 	Q_ASSERT(other_start_index == 0);
@@ -2561,8 +2759,106 @@ void PathObject::Intersections::normalize()
 	erase(std::unique(begin(), end()), end());
 }
 
+namespace {
+
+/**
+ * A pair of segment end indices, in the PathCoordVectors of two paths.
+ * 
+ * Segment k is the segment from path coord k-1 to path coord k.
+ */
+using SegmentPair = std::pair<PathCoordVector::size_type, PathCoordVector::size_type>;
+
+/**
+ * Finds all pairs of segments of a and b whose bounding boxes, extended
+ * by the given margin, overlap.
+ * 
+ * This is a batched sweep in x direction over the segments of both paths.
+ * The result is sorted.
+ */
+std::vector<SegmentPair> findSegmentPairCandidates(const PathCoordVector& a, const PathCoordVector& b, double margin)
+{
+	struct Interval
+	{
+		double left;
+		double right;
+		double top;
+		double bottom;
+		PathCoordVector::size_type index;
+	};
+	
+	auto const intervals = [](const PathCoordVector& path_coords, double extension) {
+		std::vector<Interval> result;
+		if (path_coords.size() > 1)
+		{
+			result.reserve(path_coords.size() - 1);
+			for (auto k = PathCoordVector::size_type { 1 }; k < path_coords.size(); ++k)
+			{
+				auto const& p0 = path_coords[k-1].pos;
+				auto const& p1 = path_coords[k].pos;
+				result.push_back({ std::min(p0.x(), p1.x()) - extension, std::max(p0.x(), p1.x()) + extension,
+				                   std::min(p0.y(), p1.y()) - extension, std::max(p0.y(), p1.y()) + extension,
+				                   k });
+			}
+			std::sort(begin(result), end(result), [](const Interval& lhs, const Interval& rhs) {
+				return lhs.left < rhs.left;
+			});
+		}
+		return result;
+	};
+	auto const a_intervals = intervals(a, margin);
+	auto const b_intervals = intervals(b, 0);
+	
+	std::vector<SegmentPair> result;
+	std::vector<Interval> a_active;
+	std::vector<Interval> b_active;
+	
+	// Removes the intervals which end before x, and emits the pairs with
+	// the remaining ones which overlap the interval in y direction.
+	auto const sweep = [](std::vector<Interval>& active, const Interval& current, const auto& emit) {
+		active.erase(std::remove_if(begin(active), end(active), [&current](const Interval& interval) {
+			return interval.right < current.left;
+		}), end(active));
+		for (auto const& interval : active)
+		{
+			if (interval.top <= current.bottom && current.top <= interval.bottom)
+				emit(interval);
+		}
+	};
+	
+	auto a_next = begin(a_intervals);
+	auto b_next = begin(b_intervals);
+	while (a_next != end(a_intervals) || b_next != end(b_intervals))
+	{
+		if (b_next == end(b_intervals) || (a_next != end(a_intervals) && a_next->left <= b_next->left))
+		{
+			auto const& current = *a_next++;
+			sweep(b_active, current, [&result, &current](const Interval& interval) {
+				result.emplace_back(current.index, interval.index);
+			});
+			a_active.push_back(current);
+		}
+		else
+		{
+			auto const& current = *b_next++;
+			sweep(a_active, current, [&result, &current](const Interval& interval) {
+				result.emplace_back(interval.index, current.index);
+			});
+			b_active.push_back(current);
+		}
+	}
+	
+	std::sort(begin(result), end(result));
+	return result;
+}
+
+}  // namespace
+
+
+
 void PathObject::calcAllIntersectionsWith(const PathObject* other, PathObject::Intersections& out) const
 {
+	ensurePathCoords();
+	other->ensurePathCoords();
 	update();
 	other->update();
 	
@@ -2570,9 +2866,18 @@ void PathObject::calcAllIntersectionsWith(const PathObject* other, PathObject::I
 	const double zero_minus_epsilon = 0 - epsilon;
 	const double one_plus_epsilon = 1 + epsilon;
 	
+	// Well above the tolerances of isPointOnSegment() and of the parameters.
+	const double collision_margin = 0.001;
+	
+	// Candidate segment pairs, for the current part and candidates_part.
+	std::vector<SegmentPair> candidates;
+	const PathPart* candidates_part = nullptr;
+	
+	std::vector<PathCoordVector::size_type> other_segments;
 	for (size_t part_index = 0; part_index < path_parts.size(); ++part_index)
 	{
 		const PathPart& part = path_parts[part_index];
+		candidates_part = nullptr;
 		auto path_coord_end_index = part.path_coords.size() - 1;
 		for (auto i = PathCoordVector::size_type { 1 }; i <= path_coord_end_index; ++i)
 		{
@@ -2614,12 +2919,43 @@ void PathObject::calcAllIntersectionsWith(const PathObject* other, PathObject::I
 			// when the next segment suddenly is not colliding anymore.
 			Intersection last_intersection;
 			
+			// Segments of the other path which are not near this segment
+			// cannot collide with it. Skipping them needs to end a
+			// collision just like when they were tested.
+			auto const skip_to = [&](PathCoordVector::size_type previous_k, PathCoordVector::size_type k) {
+				if (k > previous_k + 1)
+				{
+					// The first other segment resets the collision state.
+					if (colliding && previous_k > 0)
+						out.push_back(last_intersection);
+					colliding = false;
+				}
+			};
+			
 			for (size_t other_part_index = 0; other_part_index < other->path_parts.size(); ++other_part_index)
 			{
 				const PathPart& other_part = other->path_parts[part_index]; /// \todo FIXME: part_index or other_part_index ???
 				auto other_path_coord_end_index = other_part.path_coords.size() - 1;
-				for (auto k = PathCoordVector::size_type { 1 }; k <= other_path_coord_end_index; ++k)
+				
+				if (candidates_part != &other_part)
+				{
+					candidates = findSegmentPairCandidates(part.path_coords, other_part.path_coords, collision_margin);
+					candidates_part = &other_part;
+				}
+				other_segments.clear();
+				auto const first_candidate = std::lower_bound(begin(candidates), end(candidates), SegmentPair { i, 0 });
+				for (auto candidate = first_candidate; candidate != end(candidates) && candidate->first == i; ++candidate)
+					other_segments.push_back(candidate->second);
+				other_segments.push_back(other_path_coord_end_index + 1);
+				
+				auto previous_k = PathCoordVector::size_type { 0 };
+				for (auto const k : other_segments)
 				{
+					skip_to(previous_k, k);
+					previous_k = k;
+					if (k > other_path_coord_end_index)
+						break;
+					
 					// Test the two line segments against each other.
 					// Naming: segment in this path is a, segment in other path is b
 					const PathCoord& a0 = part.path_coords[i-1];
@@ -3090,6 +3426,7 @@ void PathObject::updatePathCoords() const
 		part.last_index  = part.path_coords.update(part_start);
 		part_start = part.last_index+1;
 	}
+	path_coords_released.store(false, std::memory_order_release);
 }
 
 void PathObject::recalculateParts()
@@ -3215,5 +3552,10 @@ bool PointObject::intersectsBox(const QRectF& box) const
 	return box.contains(QPointF(coords.front()));
 }
 
+std::size_t PointObject::memoryUsage() const
+{
+	return Object::memoryUsage() + sizeof(PointObject) - sizeof(Object);
+}
+
 
 }  // namespace OpenOrienteering
@@ -22,6 +22,8 @@
 #ifndef OPENORIENTEERING_OBJECT_H
 #define OPENORIENTEERING_OBJECT_H
 
+#include <atomic>
+#include <cstddef>
 #include <limits>
 #include <vector>
 #include <utility>
@@ -34,6 +36,7 @@
 
 #include "core/map_coord.h"
 #include "core/path_coord.h"
+#include "core/objects/object_tags.h"
 #include "core/virtual_path.h"
 #include "core/renderables/renderable.h"
 #include "core/symbols/symbol.h"
@@ -65,8 +68,11 @@ class VirtualCoordVector;
  */
 class Object  // clazy:exclude=copyable-polymorphic
 {
+friend class BinaryFileImporter;
 friend class ObjectRenderables;
 friend class OCAD8FileImport;
+friend class ObjectCoordsUndoStep;
+friend class ObjectTagsUndoStep;
 friend class XMLImportExport;
 public:
 	/** Enumeration of possible object types. */
@@ -191,6 +197,31 @@ public:
 	 */
 	void forceUpdate() const;
 	
+	/**
+	 * Returns an estimate of the memory used by this object, in bytes.
+	 * 
+	 * This includes the coordinates and the renderables. Tag keys and values
+	 * are shared between objects, so they are not included.
+	 */
+	virtual std::size_t memoryUsage() const;
+	
+	/**
+	 * Regenerates output and extent, but does not update the object's map.
+	 * 
+	 * Apart from text objects, this may be called concurrently for different
+	 * objects of the same map, as long as the map is not modified otherwise.
+	 * It must be followed by finishUpdate() on the map's thread.
+	 */
+	void regenerateOutput() const;
+	
+	/**
+	 * Clears the output_dirty flag and updates the object's map (if set)
+	 * after regenerateOutput().
+	 * 
+	 * @param old_extent The extent from before regenerateOutput().
+	 */
+	void finishUpdate(const QRectF& old_extent) const;
+	
 	
 	/** Moves the whole object
 	 * @param dx X offset in native map coordinates.
@@ -247,6 +278,13 @@ public:
 	/** Deletes the renderables (and extent), undoing update() */
 	void clearRenderables();
 	
+	/**
+	 * Moves the renderables to new color priorities, without regenerating them.
+	 * 
+	 * \see ObjectRenderables::remapColorPriorities()
+	 */
+	void remapColorPriorities(const std::vector<int>& priorities) const;
+	
 	/** Returns the renderables, read-only */
 	const ObjectRenderables& renderables() const;
 	
@@ -290,9 +328,18 @@ public:
 	/** Constructs an object of the given type with the given symbol. */
 	static Object* getObjectForType(Type type, const Symbol* symbol = nullptr);
 	
+	/**
+	 * Deletes the given objects, which must not belong to a map part.
+	 * 
+	 * Releasing the memory of many objects takes noticeable time, so this
+	 * work is moved to the thread pool. Text objects hold font data which
+	 * belongs to the current thread, so they are deleted immediately.
+	 */
+	static void deleteObjects(std::vector<Object*>&& objects);
+	
 	
 	/** Defines a type which maps keys to values, to be used for tagging objects. */
-	typedef QHash<QString, QString> Tags;
+	typedef ObjectTags Tags;
 	
 	/** Returns a const reference to the object's tags. */
 	const Tags& tags() const;
@@ -398,6 +445,19 @@ public:
 	 */
 	void reverse();
 	
+	/**
+	 * Appends the coordinates between the given lengths to out_coords.
+	 * 
+	 * For closed parts, end_len may be less than or equal to start_len,
+	 * wrapping around at the end of the part. The path coords must be
+	 * up to date. Flags of the last coordinate are not adjusted.
+	 */
+	void copySection(
+	        PathCoord::length_type start_len,
+	        PathCoord::length_type end_len,
+	        MapCoordVector& out_coords
+	) const;
+	
 	static PathPartVector calculatePathParts(const VirtualCoordVector& coords);
 };
 
@@ -531,6 +591,30 @@ public:
 	
 	bool intersectsBox(const QRectF& box) const override;
 	
+	std::size_t memoryUsage() const override;
+	
+	/**
+	 * Returns the memory used by the path coords of the parts, in bytes.
+	 */
+	std::size_t pathCoordsMemoryUsage() const;
+	
+	/**
+	 * Releases the memory used by the path coords of the parts.
+	 * 
+	 * This is meant for objects which are not in use, e.g. outside the
+	 * visible area of large maps. The renderables are kept. The path coords
+	 * are rebuilt on demand, by the functions which need them.
+	 * Nothing is released while the output is dirty.
+	 * 
+	 * Must not be called concurrently with other functions of this object.
+	 */
+	void releasePathCoords() const;
+	
+	/**
+	 * Returns true if the path coords were released and not rebuilt yet.
+	 */
+	bool hasReleasedPathCoords() const;
+	
 	
 	// Coordinate access methods
 	
@@ -887,6 +971,13 @@ public:
 	/** Called by Object::update() */
 	void updatePathCoords() const;
 	
+	/**
+	 * Rebuilds the path coords if they were released.
+	 * 
+	 * This function may be called concurrently from multiple threads.
+	 */
+	void ensurePathCoords() const;
+	
 	/** Called by Object::load() */
 	void recalculateParts();
 	
@@ -973,8 +1064,13 @@ private:
 	 */
 	MapCoord pattern_origin = {};
 	
+	void rebuildPathCoords() const;
+	
 	/** Path parts list */
 	mutable PathPartVector path_parts;
+	
+	/** Set by releasePathCoords(), cleared by updatePathCoords(). */
+	mutable std::atomic<bool> path_coords_released { false };
 };
 
 
@@ -1053,6 +1149,8 @@ public:
 	
 	
 	bool intersectsBox(const QRectF& box) const override;
+	
+	std::size_t memoryUsage() const override;
 };
 
 
@@ -1118,12 +1216,6 @@ const MapCoordVector& Object::getRawCoordinateVector() const
 	return coords;
 }
 
-inline
-void Object::setOutputDirty(bool dirty)
-{
-	output_dirty = dirty;
-}
-
 inline
 bool Object::isOutputDirty() const
 {
@@ -1207,16 +1299,31 @@ PathPart& PathPart::operator=(const PathPart& rhs)
 inline
 const PathPartVector& PathObject::parts() const
 {
+	ensurePathCoords();
 	return path_parts;
 }
 
 inline
 PathPartVector& PathObject::parts()
 {
+	ensurePathCoords();
 	setOutputDirty();
 	return path_parts;
 }
 
+inline
+bool PathObject::hasReleasedPathCoords() const
+{
+	return path_coords_released.load(std::memory_order_acquire);
+}
+
+inline
+void PathObject::ensurePathCoords() const
+{
+	if (Q_UNLIKELY(hasReleasedPathCoords()))
+		rebuildPathCoords();
+}
+
 inline
 qreal PathObject::getPatternRotation() const
 {
@@ -92,6 +92,16 @@ public:
 	/** Overload of move() taking delta values. */
 	void move(qint32 dx, qint32 dy, HandleOpMode move_opposite_handles);
 	
+	/**
+	 * Returns true if only whole objects are moved, i.e. no single points
+	 * and no text handles.
+	 * 
+	 * Then a move is a plain translation of the objects, and tools may
+	 * display it by translating the objects' existing renderables, instead
+	 * of regenerating them after each move.
+	 */
+	bool movesObjectsOnly() const { return points.empty() && text_handles.empty(); }
+	
 private:
 	using ObjectSet = std::unordered_set<Object*>;
 	using CoordIndexSet = std::unordered_set<MapCoordVector::size_type>;
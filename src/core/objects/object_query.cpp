@@ -334,12 +334,21 @@ bool ObjectQuery::operator()(const Object* object) const
 	switch(op)
 	{
 	case OperatorIs:
-		return object_tags.contains(tags.key) && object_tags.value(tags.key) == tags.value;
+		{
+			auto const tag = object_tags.find(tags.key);
+			return tag != object_tags.end() && tag.value() == tags.value;
+		}
 	case OperatorIsNot:
-		// If the object does have the tag, not is true
-		return !object_tags.contains(tags.key) || object_tags.value(tags.key) != tags.value;
+		{
+			// If the object does have the tag, not is true
+			auto const tag = object_tags.find(tags.key);
+			return tag == object_tags.end() || tag.value() != tags.value;
+		}
 	case OperatorContains:
-		return object_tags.contains(tags.key) && object_tags.value(tags.key).contains(tags.value);
+		{
+			auto const tag = object_tags.find(tags.key);
+			return tag != object_tags.end() && tag.value().contains(tags.value);
+		}
 	case OperatorSearch:
 		if (object->getSymbol() && object->getSymbol()->getName().contains(tags.value, Qt::CaseInsensitive))
 			return true;
@@ -371,6 +380,25 @@ bool ObjectQuery::operator()(const Object* object) const
 }
 
 
+bool ObjectQuery::isIndexable() const noexcept
+{
+	switch(op)
+	{
+	case OperatorIs:
+	case OperatorContains:
+		return true;
+		
+	case OperatorAnd:
+		return subqueries.first->isIndexable() || subqueries.second->isIndexable();
+	case OperatorOr:
+		return subqueries.first->isIndexable() && subqueries.second->isIndexable();
+		
+	default:
+		return false;
+	}
+}
+
+
 
 const ObjectQuery::LogicalOperands* ObjectQuery::logicalOperands() const
 {
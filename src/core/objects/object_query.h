@@ -152,6 +152,15 @@ public:
 	 */
 	bool operator()(const Object* object) const;
 	
+	/**
+	 * Returns true if candidates for this query can be taken from a TagIndex.
+	 * 
+	 * This is true for tests for tag equality or containment, for And-chains
+	 * with at least one indexable sub-query, and for Or-chains of indexable
+	 * sub-queries. Other queries need to be evaluated on all objects.
+	 */
+	bool isIndexable() const noexcept;
+	
 	
 	/**
 	 * Returns the operands of logical query operations.
@@ -0,0 +1,193 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "object_tags.h"
+
+#include <algorithm>
+
+#include <QReadLocker>
+#include <QReadWriteLock>
+#include <QSet>
+#include <QWriteLocker>
+
+
+namespace OpenOrienteering {
+
+namespace {
+
+/**
+ * Values up to this length are interned.
+ * 
+ * Common values such as "yes", "residential" or "asphalt" are short, while
+ * long values tend to be names and descriptions.
+ */
+constexpr int max_interned_value_length = 24;
+
+/**
+ * The pool stops growing at this size.
+ * 
+ * This limits the memory which is bound by data which never repeats, such as
+ * identifiers.
+ */
+constexpr int max_pool_size = 100000;
+
+
+class StringPool
+{
+public:
+	QString intern(const QString& string)
+	{
+		if (string.isEmpty())
+			return {};
+		
+		{
+			QReadLocker locker(&lock);
+			auto found = pool.constFind(string);
+			if (found != pool.constEnd())
+				return *found;
+			if (pool.size() >= max_pool_size)
+				return string;
+		}
+		
+		QWriteLocker locker(&lock);
+		return *pool.insert(string);
+	}
+	
+private:
+	QReadWriteLock lock;
+	QSet<QString> pool;
+};
+
+StringPool& keyPool()
+{
+	static StringPool pool;
+	return pool;
+}
+
+StringPool& valuePool()
+{
+	static StringPool pool;
+	return pool;
+}
+
+
+bool isSame(const QString& a, const QString& b)
+{
+	return a.constData() == b.constData() || a == b;
+}
+
+
+}  // namespace
+
+
+
+ObjectTags::ObjectTags(std::initializer_list<std::pair<QString, QString>> list)
+{
+	tags.reserve(int(list.size()));
+	for (const auto& tag : list)
+		insert(tag.first, tag.second);
+}
+
+
+ObjectTags::const_iterator ObjectTags::find(const QString& key) const
+{
+	auto it = lowerBound(key);
+	if (it != tags.constEnd() && isSame(it->key, key))
+		return const_iterator(it);
+	return end();
+}
+
+
+QString ObjectTags::value(const QString& key) const
+{
+	auto it = lowerBound(key);
+	if (it != tags.constEnd() && isSame(it->key, key))
+		return it->value;
+	return {};
+}
+
+
+void ObjectTags::insert(const QString& key, const QString& value)
+{
+	auto it = lowerBound(key);
+	if (it != tags.end() && isSame(it->key, key))
+	{
+		if (!isSame(it->value, value))
+			it->value = internValue(value);
+		return;
+	}
+	tags.insert(it, { internKey(key), internValue(value) });
+}
+
+
+int ObjectTags::remove(const QString& key)
+{
+	auto it = lowerBound(key);
+	if (it == tags.end() || !isSame(it->key, key))
+		return 0;
+	tags.erase(it);
+	return 1;
+}
+
+
+// static
+QString ObjectTags::internKey(const QString& key)
+{
+	return keyPool().intern(key);
+}
+
+
+// static
+QString ObjectTags::internValue(const QString& value)
+{
+	if (value.size() > max_interned_value_length)
+		return value;
+	return valuePool().intern(value);
+}
+
+
+QVector<ObjectTags::Tag>::iterator ObjectTags::lowerBound(const QString& key)
+{
+	return std::lower_bound(tags.begin(), tags.end(), key, [](const Tag& tag, const QString& key) {
+		return tag.key < key;
+	});
+}
+
+
+QVector<ObjectTags::Tag>::const_iterator ObjectTags::lowerBound(const QString& key) const
+{
+	return std::lower_bound(tags.constBegin(), tags.constEnd(), key, [](const Tag& tag, const QString& key) {
+		return tag.key < key;
+	});
+}
+
+
+
+bool operator==(const ObjectTags& lhs, const ObjectTags& rhs)
+{
+	return std::equal(lhs.tags.constBegin(), lhs.tags.constEnd(),
+	                  rhs.tags.constBegin(), rhs.tags.constEnd(),
+	                  [](const ObjectTags::Tag& a, const ObjectTags::Tag& b) {
+		return isSame(a.key, b.key) && isSame(a.value, b.value);
+	});
+}
+
+
+}  // namespace OpenOrienteering
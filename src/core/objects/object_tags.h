@@ -0,0 +1,172 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef OPENORIENTEERING_OBJECT_TAGS_H
+#define OPENORIENTEERING_OBJECT_TAGS_H
+
+#include <initializer_list>
+#include <utility>
+
+#include <QtGlobal>
+#include <QString>
+#include <QVector>
+
+namespace OpenOrienteering {
+
+/**
+ * A single object tag.
+ */
+struct ObjectTag
+{
+	QString key;
+	QString value;
+};
+
+}  // namespace OpenOrienteering
+
+Q_DECLARE_TYPEINFO(OpenOrienteering::ObjectTag, Q_MOVABLE_TYPE);
+
+
+namespace OpenOrienteering {
+
+/**
+ * The tags of a map object, i.e. a set of key-value pairs.
+ * 
+ * This container implements the part of the QHash API which was used for
+ * object tags. The tags are stored in a vector which is sorted by key, and
+ * keys and short values are interned: All tags with the same key refer to a
+ * single shared string in a global pool. Imported data typically carries the
+ * same keys and values on many objects, so this saves a lot of memory, and
+ * comparing tags can often be done by comparing pointers.
+ * 
+ * Like QHash, this class is implicitly shared.
+ */
+class ObjectTags
+{
+public:
+	using Tag = ObjectTag;
+	
+	/**
+	 * An iterator over the tags, providing key() and value() like QHash.
+	 */
+	class const_iterator
+	{
+	public:
+		using base_iterator = QVector<Tag>::const_iterator;
+		
+		const_iterator() = default;
+		explicit const_iterator(base_iterator it) noexcept : it(it) {}
+		
+		const QString& key() const { return it->key; }
+		const QString& value() const { return it->value; }
+		
+		const QString& operator*() const { return it->value; }
+		
+		const_iterator& operator++() { ++it; return *this; }
+		const_iterator operator++(int) { auto old = *this; ++it; return old; }
+		
+		bool operator==(const const_iterator& other) const noexcept { return it == other.it; }
+		bool operator!=(const const_iterator& other) const noexcept { return it != other.it; }
+		
+	private:
+		base_iterator it = {};
+	};
+	
+	ObjectTags() noexcept = default;
+	ObjectTags(std::initializer_list<std::pair<QString, QString>> list);
+	
+	int size() const noexcept { return tags.size(); }
+	bool isEmpty() const noexcept { return tags.isEmpty(); }
+	bool empty() const noexcept { return tags.isEmpty(); }
+	
+	void clear() { tags.clear(); }
+	void reserve(int size) { tags.reserve(size); }
+	
+	const_iterator begin() const noexcept { return const_iterator(tags.constBegin()); }
+	const_iterator end() const noexcept { return const_iterator(tags.constEnd()); }
+	const_iterator constBegin() const noexcept { return begin(); }
+	const_iterator constEnd() const noexcept { return end(); }
+	
+	/**
+	 * Returns an iterator to the tag with the given key, or end().
+	 */
+	const_iterator find(const QString& key) const;
+	
+	/**
+	 * Returns true if there is a tag with the given key.
+	 */
+	bool contains(const QString& key) const { return find(key) != end(); }
+	
+	/**
+	 * Returns the value of the tag with the given key, or a null string.
+	 */
+	QString value(const QString& key) const;
+	
+	/**
+	 * Sets the value of the tag with the given key.
+	 */
+	void insert(const QString& key, const QString& value);
+	
+	/**
+	 * Removes the tag with the given key.
+	 * 
+	 * Returns the number of removed tags, i.e. 0 or 1.
+	 */
+	int remove(const QString& key);
+	
+	
+	/**
+	 * Returns the pooled copy of a string which is used as tag key.
+	 * 
+	 * This function is thread-safe.
+	 */
+	static QString internKey(const QString& key);
+	
+	/**
+	 * Returns the pooled copy of a string which is used as tag value.
+	 * 
+	 * Only short values are interned. Other values are returned unchanged.
+	 * This function is thread-safe.
+	 */
+	static QString internValue(const QString& value);
+	
+	
+	friend bool operator==(const ObjectTags& lhs, const ObjectTags& rhs);
+	
+private:
+	QVector<Tag>::iterator lowerBound(const QString& key);
+	QVector<Tag>::const_iterator lowerBound(const QString& key) const;
+	
+	QVector<Tag> tags;  ///< Sorted by key
+	
+};
+
+bool operator==(const ObjectTags& lhs, const ObjectTags& rhs);
+
+inline
+bool operator!=(const ObjectTags& lhs, const ObjectTags& rhs)
+{
+	return !(lhs == rhs);
+}
+
+
+}  // namespace OpenOrienteering
+
+#endif
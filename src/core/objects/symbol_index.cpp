@@ -0,0 +1,93 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "symbol_index.h"
+
+#include "core/objects/object.h"
+
+
+namespace OpenOrienteering {
+
+void SymbolIndex::build(const std::vector<Object*>& objects)
+{
+	entries.clear();
+	indexed.clear();
+	indexed.reserve(int(objects.size()));
+	valid = true;
+	for (const auto* object : objects)
+		insert(object);
+}
+
+
+void SymbolIndex::clear()
+{
+	entries.clear();
+	indexed.clear();
+	valid = false;
+}
+
+
+void SymbolIndex::insert(const Object* object)
+{
+	if (!valid || indexed.contains(object))
+		return;
+	
+	auto const* symbol = object->getSymbol();
+	indexed.insert(object, symbol);
+	entries[symbol].insert(object);
+}
+
+
+bool SymbolIndex::remove(const Object* object)
+{
+	auto const it = indexed.find(object);
+	if (it == indexed.end())
+		return false;
+	
+	auto const entry = entries.find(it.value());
+	entry->remove(object);
+	if (entry->isEmpty())
+		entries.erase(entry);
+	indexed.erase(it);
+	return true;
+}
+
+
+bool SymbolIndex::update(const Object* object)
+{
+	auto const it = indexed.find(object);
+	if (it == indexed.end())
+		return false;
+	
+	auto const* symbol = object->getSymbol();
+	if (it.value() != symbol)
+	{
+		auto const entry = entries.find(it.value());
+		entry->remove(object);
+		if (entry->isEmpty())
+			entries.erase(entry);
+		it.value() = symbol;
+		entries[symbol].insert(object);
+	}
+	return true;
+}
+
+
+}  // namespace OpenOrienteering
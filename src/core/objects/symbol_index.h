@@ -0,0 +1,112 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef OPENORIENTEERING_SYMBOL_INDEX_H
+#define OPENORIENTEERING_SYMBOL_INDEX_H
+
+#include <cstddef>
+#include <vector>
+
+#include <QHash>
+#include <QSet>
+
+namespace OpenOrienteering {
+
+class Object;
+class Symbol;
+
+
+/**
+ * A reverse index from symbols to the objects using them.
+ * 
+ * The index is meant to be owned by a MapPart. It starts invalid, and it is
+ * built on first use. Once valid, insert(), remove() and update() keep it up
+ * to date. These functions do nothing while the index is invalid.
+ * 
+ * For each object, the index records the symbol it was indexed with, so that
+ * update() can move the object when its symbol was changed.
+ */
+class SymbolIndex
+{
+public:
+	using ObjectSet = QSet<const Object*>;
+	
+	/**
+	 * Returns true if the index was built and may be used for queries.
+	 */
+	bool isValid() const noexcept { return valid; }
+	
+	/**
+	 * Returns the number of indexed objects.
+	 */
+	std::size_t size() const noexcept { return std::size_t(indexed.size()); }
+	
+	/**
+	 * Builds the index for the given objects, making it valid.
+	 */
+	void build(const std::vector<Object*>& objects);
+	
+	/**
+	 * Clears the index, making it invalid.
+	 */
+	void clear();
+	
+	/**
+	 * Adds an object to a valid index.
+	 */
+	void insert(const Object* object);
+	
+	/**
+	 * Removes an object from a valid index.
+	 * 
+	 * @return False if the object was not indexed, true otherwise.
+	 */
+	bool remove(const Object* object);
+	
+	/**
+	 * Moves an indexed object to the entry of its current symbol.
+	 * 
+	 * @return False if the object was not indexed, true otherwise.
+	 */
+	bool update(const Object* object);
+	
+	/**
+	 * Returns the objects which were indexed with the given symbol.
+	 */
+	ObjectSet objects(const Symbol* symbol) const { return entries.value(symbol); }
+	
+	/**
+	 * Returns true if there is an object indexed with the given symbol.
+	 */
+	bool contains(const Symbol* symbol) const { return entries.contains(symbol); }
+	
+private:
+	/** Objects by symbol */
+	QHash<const Symbol*, ObjectSet> entries;
+	/** Symbols by object */
+	QHash<const Object*, const Symbol*> indexed;
+	bool valid = false;
+	
+};
+
+
+}  // namespace OpenOrienteering
+
+#endif
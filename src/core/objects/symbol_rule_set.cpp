@@ -28,6 +28,7 @@
 #include <type_traits>
 #include <unordered_set>
 #include <utility>
+#include <vector>
 
 #include <QtGlobal>
 #include <QChar>
@@ -41,6 +42,7 @@
 #include "core/objects/object.h"
 #include "core/symbols/symbol.h"
 #include "undo/undo_manager.h"
+#include "util/concurrency.h"
 
 
 namespace OpenOrienteering {
@@ -416,15 +418,120 @@ const Symbol* SymbolRuleSet::findDuplicateSymbolPattern() const
 
 
 void SymbolRuleSet::operator()(Object* object) const
+{
+	if (auto const* symbol = match(object))
+		object->setSymbol(symbol, false);
+}
+
+
+const Symbol* SymbolRuleSet::match(const Object* object) const
 {
 	for (const auto& item : *this)
 	{
 		if (item.symbol && item.query(object))
+			return item.symbol;
+	}
+	return nullptr;
+}
+
+
+void SymbolRuleSet::applyToObjects(Map& object_map) const
+{
+	auto const symbol_rules_only = std::all_of(begin(), end(), [](const auto& item) {
+		return !item.symbol || item.query.getOperator() == ObjectQuery::OperatorSymbol;
+	});
+	if (symbol_rules_only)
+	{
+		// The first rule for a particular symbol wins.
+		QHash<const Symbol*, const Symbol*> replacements;
+		for (const auto& item : *this)
 		{
-			object->setSymbol(item.symbol, false);
-			break;
+			if (item.symbol && !replacements.contains(item.query.symbolOperand()))
+				replacements.insert(item.query.symbolOperand(), item.symbol);
+		}
+		object_map.applyOnAllObjects([&replacements](Object* object) {
+			auto const replacement = replacements.constFind(object->getSymbol());
+			if (replacement != replacements.constEnd())
+				object->setSymbol(*replacement, false);
+		});
+		return;
+	}
+	
+	auto const indexable = std::all_of(begin(), end(), [](const auto& item) {
+		return !item.symbol || item.query.isIndexable();
+	});
+	if (indexable)
+	{
+		// Visit only the candidates of each rule. Each object still gets the
+		// symbol of the first matching rule.
+		std::unordered_set<const Object*> assigned_objects;
+		for (const auto& item : *this)
+		{
+			if (!item.symbol)
+				continue;
+			auto* symbol = item.symbol;
+			object_map.applyOnMatchingObjects([&assigned_objects, symbol](Object* object) {
+				if (assigned_objects.insert(object).second)
+					object->setSymbol(symbol, false);
+			}, item.query);
+		}
+		return;
+	}
+	
+	// For each symbol, the rules which may match its objects, in order.
+	// A rule for the symbol itself matches all remaining objects, so it ends
+	// the list. Rules for other symbols are dropped.
+	QHash<const Symbol*, std::vector<const SymbolRule*>> candidates;
+	candidates.reserve(object_map.getNumSymbols());
+	for (int i = 0; i < object_map.getNumSymbols(); ++i)
+	{
+		auto const* symbol = object_map.getSymbol(i);
+		auto& rules = candidates[symbol];
+		for (const auto& item : *this)
+		{
+			if (!item.symbol)
+				continue;
+			if (item.query.getOperator() != ObjectQuery::OperatorSymbol)
+			{
+				rules.push_back(&item);
+			}
+			else if (item.query.symbolOperand() == symbol)
+			{
+				rules.push_back(&item);
+				break;
+			}
 		}
 	}
+	
+	// Matching is read-only, but changing symbols updates the map's indexes.
+	std::vector<Object*> objects;
+	objects.reserve(std::size_t(object_map.getNumObjects()));
+	object_map.applyOnAllObjects([&objects](Object* object) { objects.push_back(object); });
+	
+	std::vector<const Symbol*> symbols(objects.size());
+	Concurrency::parallelFor(0, int(objects.size()), [this, &candidates, &objects, &symbols](int i) {
+		auto const* object = objects[std::size_t(i)];
+		auto const rules = candidates.constFind(object->getSymbol());
+		if (rules == candidates.constEnd())
+		{
+			symbols[std::size_t(i)] = match(object);
+			return;
+		}
+		for (auto const* rule : *rules)
+		{
+			if (rule->query.getOperator() == ObjectQuery::OperatorSymbol || rule->query(object))
+			{
+				symbols[std::size_t(i)] = rule->symbol;
+				break;
+			}
+		}
+	}, 64);
+	
+	for (std::size_t i = 0; i < objects.size(); ++i)
+	{
+		if (symbols[i])
+			objects[i]->setSymbol(symbols[i], false);
+	}
 }
 
 
@@ -484,7 +591,7 @@ void SymbolRuleSet::apply(Map& object_map, const Map& symbol_set, Options option
 	}
 	
 	// Change symbols for all objects
-	object_map.applyOnAllObjects(std::cref(*this));
+	applyToObjects(object_map);
 	
 	// Delete unused old symbols
 	if (!old_symbols.empty())
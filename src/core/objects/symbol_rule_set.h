@@ -220,6 +220,14 @@ public:
 	 */
 	void operator()(Object* object) const;
 	
+	/**
+	 * Returns the symbol assigned by the first rule which matches the object.
+	 * 
+	 * Returns nullptr if no rule with a symbol matches the object.
+	 * This function may be called concurrently.
+	 */
+	const Symbol* match(const Object* object) const;
+	
 	
 	/**
 	 * Options for importing of new colors and symbols in to a map.
@@ -263,6 +271,17 @@ public:
 	 */
 	void apply(Map& object_map, const Map& symbol_set, Options options) &&;
 	
+private:
+	/**
+	 * Applies the matching rules to all objects of the map.
+	 * 
+	 * Rules which test only symbols are resolved through a lookup table.
+	 * Rules on tags take their candidates from the tag index. Otherwise,
+	 * the rules are evaluated concurrently for all objects, testing only
+	 * the rules which can match the object's symbol.
+	 */
+	void applyToObjects(Map& object_map) const;
+	
 };
 
 
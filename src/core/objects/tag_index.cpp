@@ -0,0 +1,177 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "tag_index.h"
+
+#include <utility>
+
+#include <QtGlobal>
+
+#include "core/objects/object.h"
+#include "core/objects/object_query.h"
+
+
+namespace OpenOrienteering {
+
+void TagIndex::build(const std::vector<Object*>& objects)
+{
+	entries.clear();
+	indexed.clear();
+	indexed.reserve(int(objects.size()));
+	for (const auto* object : objects)
+	{
+		indexed.insert(object);
+		insertTags(object, object->tags());
+	}
+	valid = true;
+}
+
+
+void TagIndex::clear()
+{
+	entries.clear();
+	indexed.clear();
+	valid = false;
+}
+
+
+void TagIndex::insert(const Object* object)
+{
+	if (!valid || indexed.contains(object))
+		return;
+	
+	indexed.insert(object);
+	insertTags(object, object->tags());
+}
+
+
+bool TagIndex::remove(const Object* object)
+{
+	if (!indexed.remove(object))
+		return false;
+	
+	removeTags(object, object->tags());
+	return true;
+}
+
+
+bool TagIndex::update(const Object* object, const Tags& old_tags)
+{
+	if (!indexed.contains(object))
+		return false;
+	
+	removeTags(object, old_tags);
+	insertTags(object, object->tags());
+	return true;
+}
+
+
+TagIndex::ObjectSet TagIndex::select(const ObjectQuery& query) const
+{
+	Q_ASSERT(query.isIndexable());
+	
+	switch (query.getOperator())
+	{
+	case ObjectQuery::OperatorIs:
+		{
+			const auto* operands = query.tagOperands();
+			return entries.value(operands->key).value(operands->value);
+		}
+		
+	case ObjectQuery::OperatorContains:
+		{
+			const auto* operands = query.tagOperands();
+			auto result = ObjectSet{};
+			const auto values = entries.find(operands->key);
+			if (values != entries.end())
+			{
+				for (auto it = values->begin(); it != values->end(); ++it)
+				{
+					if (it.key().contains(operands->value))
+						result.unite(it.value());
+				}
+			}
+			return result;
+		}
+		
+	case ObjectQuery::OperatorAnd:
+		{
+			const auto* operands = query.logicalOperands();
+			if (!operands->second->isIndexable())
+				return select(*operands->first);
+			if (!operands->first->isIndexable())
+				return select(*operands->second);
+			
+			auto result = select(*operands->first);
+			if (!result.isEmpty())
+			{
+				auto other = select(*operands->second);
+				if (other.size() < result.size())
+					std::swap(result, other);
+				result.intersect(other);
+			}
+			return result;
+		}
+		
+	case ObjectQuery::OperatorOr:
+		{
+			const auto* operands = query.logicalOperands();
+			auto result = select(*operands->first);
+			auto other = select(*operands->second);
+			if (other.size() > result.size())
+				std::swap(result, other);
+			return result.unite(other);
+		}
+		
+	default:
+		Q_UNREACHABLE();
+	}
+}
+
+
+void TagIndex::insertTags(const Object* object, const Tags& tags)
+{
+	for (auto it = tags.begin(); it != tags.end(); ++it)
+		entries[it.key()][it.value()].insert(object);
+}
+
+
+void TagIndex::removeTags(const Object* object, const Tags& tags)
+{
+	for (auto it = tags.begin(); it != tags.end(); ++it)
+	{
+		auto values = entries.find(it.key());
+		if (values == entries.end())
+			continue;
+		auto objects = values->find(it.value());
+		if (objects == values->end())
+			continue;
+		objects->remove(object);
+		if (objects->isEmpty())
+		{
+			values->erase(objects);
+			if (values->isEmpty())
+				entries.erase(values);
+		}
+	}
+}
+
+
+}  // namespace OpenOrienteering
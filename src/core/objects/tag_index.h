@@ -0,0 +1,125 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef OPENORIENTEERING_TAG_INDEX_H
+#define OPENORIENTEERING_TAG_INDEX_H
+
+#include <cstddef>
+#include <vector>
+
+#include <QHash>
+#include <QSet>
+#include <QString>
+
+#include "core/objects/object_tags.h"
+
+namespace OpenOrienteering {
+
+class Object;
+class ObjectQuery;
+
+
+/**
+ * An inverted index from object tags to objects.
+ * 
+ * For every tag key and value, the index holds the set of objects which have
+ * this tag. This allows to answer ObjectQuery trees on tags without testing
+ * every single object.
+ * 
+ * The index is meant to be owned by a MapPart. It starts invalid, and it is
+ * built on first use. Once valid, insert(), remove() and update() keep it up
+ * to date. These functions do nothing while the index is invalid.
+ */
+class TagIndex
+{
+public:
+	using ObjectSet = QSet<const Object*>;
+	using Tags = ObjectTags;
+	
+	/**
+	 * Returns true if the index was built and may be used for queries.
+	 */
+	bool isValid() const noexcept { return valid; }
+	
+	/**
+	 * Returns the number of indexed objects.
+	 */
+	std::size_t size() const noexcept { return std::size_t(indexed.size()); }
+	
+	/**
+	 * Returns true if the object is indexed.
+	 */
+	bool contains(const Object* object) const { return indexed.contains(object); }
+	
+	/**
+	 * Builds the index for the given objects, making it valid.
+	 */
+	void build(const std::vector<Object*>& objects);
+	
+	/**
+	 * Clears the index, making it invalid.
+	 */
+	void clear();
+	
+	/**
+	 * Adds an object to a valid index.
+	 */
+	void insert(const Object* object);
+	
+	/**
+	 * Removes an object from a valid index.
+	 * 
+	 * @return False if the object was not indexed, true otherwise.
+	 */
+	bool remove(const Object* object);
+	
+	/**
+	 * Updates the entries of an indexed object after a change of its tags.
+	 * 
+	 * @return False if the object was not indexed, true otherwise.
+	 */
+	bool update(const Object* object, const Tags& old_tags);
+	
+	/**
+	 * Collects the candidates for matching the given query.
+	 * 
+	 * The candidates are a superset of the objects which match the query:
+	 * Sub-queries which cannot be answered from the index are ignored, so
+	 * the query still needs to be evaluated for each candidate.
+	 * 
+	 * The query must be indexable, cf. ObjectQuery::isIndexable().
+	 */
+	ObjectSet select(const ObjectQuery& query) const;
+	
+private:
+	void insertTags(const Object* object, const Tags& tags);
+	void removeTags(const Object* object, const Tags& tags);
+	
+	/** Objects by tag key and value */
+	QHash<QString, QHash<QString, ObjectSet>> entries;
+	ObjectSet indexed;
+	bool valid = false;
+	
+};
+
+
+}  // namespace OpenOrienteering
+
+#endif
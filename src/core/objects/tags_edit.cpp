@@ -0,0 +1,209 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "tags_edit.h"
+
+#include <cstddef>
+#include <iterator>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "core/map.h"
+#include "core/map_part.h"
+#include "core/objects/object.h"
+#include "core/objects/object_query.h"
+#include "core/objects/object_tags.h"
+#include "undo/object_undo.h"
+#include "util/concurrency.h"
+
+
+namespace OpenOrienteering {
+
+namespace {
+
+/**
+ * The number of objects which are handed out to a thread at once.
+ */
+constexpr int tags_edit_grain = 256;
+
+}  // namespace
+
+
+
+TagsEdit::TagsEdit(Operation operation, const QString& key, const QString& argument)
+: tag_key(key)
+, argument(argument)
+, op(operation)
+{
+	// nothing else
+}
+
+TagsEdit::TagsEdit(const QString& key, const QRegularExpression& pattern, const QString& replacement)
+: tag_key(key)
+, argument(replacement)
+, pattern(pattern)
+, op(ReplaceValue)
+{
+	// Compile the pattern now, before it is used from several threads.
+	this->pattern.optimize();
+}
+
+TagsEdit::~TagsEdit() = default;
+
+
+bool TagsEdit::isValid() const
+{
+	switch (op)
+	{
+	case SetValue:
+	case RemoveKey:
+		return !tag_key.isEmpty();
+	case RenameKey:
+		return !tag_key.isEmpty() && !argument.isEmpty();
+	case ReplaceValue:
+		return pattern.isValid() && !pattern.pattern().isEmpty();
+	}
+	return false;
+}
+
+
+bool TagsEdit::apply(ObjectTags& tags) const
+{
+	switch (op)
+	{
+	case SetValue:
+		{
+			auto const tag = tags.find(tag_key);
+			if (tag != tags.end() && tag.value() == argument)
+				return false;
+			tags.insert(tag_key, argument);
+			return true;
+		}
+		
+	case RenameKey:
+		{
+			auto const tag = tags.find(tag_key);
+			if (tag == tags.end() || tag_key == argument)
+				return false;
+			auto const value = tag.value();
+			tags.remove(tag_key);
+			tags.insert(argument, value);
+			return true;
+		}
+		
+	case RemoveKey:
+		return tags.remove(tag_key) > 0;
+		
+	case ReplaceValue:
+		{
+			// Collect the changes first: inserting invalidates the iterators.
+			std::vector<ObjectTag> changes;
+			auto replace = [this, &changes](const QString& key, const QString& value) {
+				auto new_value = value;
+				new_value.replace(pattern, argument);
+				if (new_value != value)
+					changes.push_back({ key, new_value });
+			};
+			if (!tag_key.isEmpty())
+			{
+				auto const tag = tags.find(tag_key);
+				if (tag != tags.end())
+					replace(tag.key(), tag.value());
+			}
+			else
+			{
+				for (auto tag = tags.begin(); tag != tags.end(); ++tag)
+					replace(tag.key(), tag.value());
+			}
+			for (const auto& change : changes)
+				tags.insert(change.key, change.value);
+			return !changes.empty();
+		}
+	}
+	
+	return false;
+}
+
+
+int TagsEdit::apply(Map& map, const std::function<bool (const Object*)>& condition) const
+{
+	if (!isValid())
+		return 0;
+	
+	const MapPart* const part = map.getCurrentPart();
+	std::vector<std::pair<int, Object::Tags>> changes;
+	for (int i = 0, count = part->getNumObjects(); i < count; ++i)
+	{
+		if (condition(part->getObject(i)))
+			changes.emplace_back(i, Object::Tags{});
+	}
+	
+	// Computing the new tags is independent for each object.
+	std::vector<char> modified(changes.size());
+	Concurrency::parallelFor(0, int(changes.size()), [this, part, &changes, &modified](int i) {
+		auto& change = changes[std::size_t(i)];
+		change.second = part->getObject(change.first)->tags();
+		modified[std::size_t(i)] = apply(change.second);
+	}, tags_edit_grain);
+	
+	auto last = begin(changes);
+	for (std::size_t i = 0; i < changes.size(); ++i)
+	{
+		if (modified[i])
+			*last++ = std::move(changes[i]);
+	}
+	changes.erase(last, end(changes));
+	if (changes.empty())
+		return 0;
+	
+	auto* undo_step = new ObjectTagsUndoStep(&map);
+	undo_step->replaceTags(changes);
+	map.push(undo_step);
+	return int(changes.size());
+}
+
+
+int TagsEdit::apply(Map& map, const ObjectQuery& query) const
+{
+	if (!query.isIndexable())
+		return apply(map, std::cref(query));
+	
+	// Let the part use its tag index.
+	std::unordered_set<const Object*> matching;
+	map.getCurrentPart()->applyOnMatchingObjects([&matching](Object* object) {
+		matching.insert(object);
+	}, query);
+	return apply(map, [&matching](const Object* object) {
+		return matching.count(object) > 0;
+	});
+}
+
+
+int TagsEdit::applyToSelection(Map& map) const
+{
+	auto const& selection = map.selectedObjects();
+	return apply(map, [&selection](const Object* object) {
+		return selection.count(const_cast<Object*>(object)) > 0;
+	});
+}
+
+
+}  // namespace OpenOrienteering
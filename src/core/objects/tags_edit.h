@@ -0,0 +1,129 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef OPENORIENTEERING_TAGS_EDIT_H
+#define OPENORIENTEERING_TAGS_EDIT_H
+
+#include <functional>
+
+#include <QRegularExpression>
+#include <QString>
+
+namespace OpenOrienteering {
+
+class Map;
+class Object;
+class ObjectQuery;
+class ObjectTags;
+
+
+/**
+ * A modification of object tags which can be applied to many objects.
+ * 
+ * Applying an edit to objects of a map computes the new tags concurrently,
+ * then replaces the tags of all modified objects at once. This is recorded
+ * as a single ObjectTagsUndoStep.
+ */
+class TagsEdit
+{
+public:
+	enum Operation
+	{
+		SetValue,     ///< Sets the value of the key, adding the tag if needed.
+		RenameKey,    ///< Renames the key, replacing any tag of the new key.
+		RemoveKey,    ///< Removes the tag of the key.
+		ReplaceValue  ///< Replaces pattern matches in the value of the key, or in all values if the key is empty.
+	};
+	
+	/**
+	 * Constructs an edit which sets a value, renames a key, or removes a key.
+	 * 
+	 * The argument is the new value for SetValue, and the new key for
+	 * RenameKey. It is ignored by RemoveKey.
+	 */
+	TagsEdit(Operation operation, const QString& key, const QString& argument = {});
+	
+	/**
+	 * Constructs an edit which replaces matches of the pattern in tag values.
+	 * 
+	 * The replacement may refer to captured groups, cf. QString::replace().
+	 */
+	TagsEdit(const QString& key, const QRegularExpression& pattern, const QString& replacement);
+	
+	TagsEdit(const TagsEdit&) = default;
+	TagsEdit& operator=(const TagsEdit&) = default;
+	~TagsEdit();
+	
+	
+	Operation operation() const { return op; }
+	
+	const QString& key() const { return tag_key; }
+	
+	/**
+	 * Returns true if the edit can be applied.
+	 * 
+	 * Keys must not be empty, except for ReplaceValue, and the pattern must
+	 * be valid.
+	 */
+	bool isValid() const;
+	
+	
+	/**
+	 * Applies the edit to the given tags.
+	 * 
+	 * Returns true if the tags were modified.
+	 * This function is thread-safe.
+	 */
+	bool apply(ObjectTags& tags) const;
+	
+	/**
+	 * Applies the edit to the objects of the map's current part which match
+	 * the given condition.
+	 * 
+	 * The modification is pushed to the map's undo manager as a single step.
+	 * 
+	 * Returns the number of modified objects.
+	 */
+	int apply(Map& map, const std::function<bool (const Object*)>& condition) const;
+	
+	/**
+	 * Applies the edit to the objects of the map's current part which match
+	 * the given query.
+	 * 
+	 * Indexable queries use the tag index for finding candidates.
+	 */
+	int apply(Map& map, const ObjectQuery& query) const;
+	
+	/**
+	 * Applies the edit to the selected objects.
+	 */
+	int applyToSelection(Map& map) const;
+	
+private:
+	QString tag_key;
+	QString argument;
+	QRegularExpression pattern;
+	Operation op;
+};
+
+
+}  // namespace OpenOrienteering
+
+#endif
@@ -21,6 +21,11 @@
 
 #include "text_object.h"
 
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <utility>
+
 #include <QtMath>
 #include <QChar>
 #include <QLatin1Char>
@@ -140,6 +145,8 @@ TextObject::TextObject(const TextObject& proto)
  , has_single_anchor(proto.has_single_anchor)
  , size(proto.size)
  , line_infos(proto.line_infos)
+ , layout_text(proto.layout_text)
+ , layout_parameters(proto.layout_parameters)
 {
 	// nothing
 }
@@ -162,6 +169,8 @@ void TextObject::copyFrom(const Object& other)
 	has_single_anchor = other_text.has_single_anchor;
 	size = other_text.size;
 	line_infos = other_text.line_infos;
+	layout_text = other_text.layout_text;
+	layout_parameters = other_text.layout_parameters;
 }
 
 void TextObject::setAnchorPosition(qint32 x, qint32 y)
@@ -324,6 +333,20 @@ bool TextObject::intersectsBox(const QRectF& box) const
 	return getExtent().intersects(box);
 }
 
+std::size_t TextObject::memoryUsage() const
+{
+	auto bytes = Object::memoryUsage() + sizeof(TextObject) - sizeof(Object)
+	             + std::size_t(text.capacity()) * sizeof(QChar)
+	             + line_infos.capacity() * sizeof(TextObjectLineInfo);
+	for (const auto& line_info : line_infos)
+	{
+		bytes += line_info.part_infos.capacity() * sizeof(TextObjectPartInfo);
+		for (const auto& part_info : line_info.part_infos)
+			bytes += std::size_t(part_info.part_text.capacity()) * sizeof(QChar);
+	}
+	return bytes;
+}
+
 int TextObject::calcTextPositionAt(const MapCoordF& coord, bool find_line_only) const
 {
 	return calcTextPositionAt(calcMapToTextTransform().map(coord), find_line_only);
@@ -379,6 +402,18 @@ const TextObjectLineInfo& TextObject::findLineInfoForIndex(int index) const
 	return *line_info;
 }
 
+bool TextObject::LayoutParameters::operator==(const LayoutParameters& other) const
+{
+	return symbol == other.symbol
+	       && scaling == other.scaling
+	       && box_width == other.box_width
+	       && first_tab == other.first_tab
+	       && h_align == other.h_align
+	       && word_wrap == other.word_wrap
+	       && custom_tabs == other.custom_tabs
+	       && font == other.font;
+}
+
 void TextObject::prepareLineInfos() const
 {
 	const TextSymbol* text_symbol = reinterpret_cast<const TextSymbol*>(symbol);
@@ -398,7 +433,39 @@ void TextObject::prepareLineInfos() const
 	const QLatin1Char part_break('\t');
 	const QLatin1Char word_break(' ');
 	
-	line_infos.clear();
+	LayoutParameters parameters;
+	parameters.symbol = symbol;
+	parameters.font = text_symbol->getQFont();
+	parameters.scaling = scaling;
+	parameters.box_width = box_width;
+	parameters.first_tab = text_symbol->getNextTab(0);
+	parameters.custom_tabs.reserve(std::size_t(text_symbol->getNumCustomTabs()));
+	for (int i = 0; i < text_symbol->getNumCustomTabs(); ++i)
+		parameters.custom_tabs.push_back(text_symbol->getCustomTab(i));
+	parameters.h_align = h_align;
+	parameters.word_wrap = word_wrap;
+	
+	// Paragraphs which are entirely in the common prefix or suffix of the
+	// previous and the current text keep their horizontal layout.
+	LineInfoContainer old_line_infos;
+	old_line_infos.swap(line_infos);
+	auto old_line_info = begin(old_line_infos);
+	int prefix_length = 0;
+	int suffix_length = 0;
+	if (!old_line_infos.empty() && parameters == layout_parameters)
+	{
+		int max_length = std::min(text_end, layout_text.length());
+		while (prefix_length < max_length && text[prefix_length] == layout_text[prefix_length])
+			++prefix_length;
+		max_length -= prefix_length;
+		while (suffix_length < max_length
+		       && text[text_end - 1 - suffix_length] == layout_text[layout_text.length() - 1 - suffix_length])
+			++suffix_length;
+	}
+	const int suffix_start = text_end - suffix_length;
+	const int index_delta  = text_end - layout_text.length();
+	
+	line_infos.reserve(old_line_infos.size());
 	
 	// Initialize offsets
 	
@@ -420,8 +487,56 @@ void TextObject::prepareLineInfos() const
 	int num_paragraphs = 0;
 	int line_num = 0;
 	int line_start = 0;
+	bool paragraph_start = true;
 	while (line_start <= text_end) 
 	{
+		if (paragraph_start && old_line_info != end(old_line_infos))
+		{
+			// Try to reuse the layout of an unchanged paragraph
+			int paragraph_stop = text.indexOf(line_break, line_start);
+			if (paragraph_stop == -1)
+				paragraph_stop = text_end;
+			
+			int old_start = -1;
+			if (paragraph_stop < prefix_length)
+				old_start = line_start;
+			else if (line_start > suffix_start)
+				old_start = line_start - index_delta;
+			
+			while (old_line_info != end(old_line_infos) && old_line_info->start_index < old_start)
+				++old_line_info;
+			
+			if (old_start >= 0 && old_line_info != end(old_line_infos) && old_line_info->start_index == old_start)
+			{
+				const int shift = line_start - old_start;
+				for (; old_line_info != end(old_line_infos); ++old_line_info)
+				{
+					line_infos.push_back(std::move(*old_line_info));
+					auto& line_info = line_infos.back();
+					line_info.start_index += shift;
+					line_info.end_index += shift;
+					line_info.line_y = line_y;
+					for (auto& part_info : line_info.part_infos)
+					{
+						part_info.start_index += shift;
+						part_info.end_index += shift;
+					}
+					
+					line_y += line_spacing;
+					line_num++;
+					if (line_info.paragraph_end)
+					{
+						line_y += paragraph_spacing;
+						num_paragraphs++;
+						++old_line_info;
+						break;
+					}
+				}
+				line_start = paragraph_stop + 1;
+				continue;
+			}
+		}
+		
 		// Initialize input line
 		double line_width = 0.0;
 		int line_end = text.indexOf(line_break, line_start);
@@ -504,7 +619,16 @@ void TextObject::prepareLineInfos() const
 			++next_line_start;
 		}*/
 		
-		line_infos.push_back( { line_start, line_end, paragraph_end, line_x, line_y, line_width, metrics.ascent(), metrics.descent(), part_infos } );
+		// Apply the horizontal alignment
+		double delta_x = 0.0;
+		if (h_align == TextObject::AlignHCenter)
+			delta_x = -0.5 * line_width;
+		else if (h_align == TextObject::AlignRight)
+			delta_x -= line_width;
+		for (auto& part_info : part_infos)
+			part_info.part_x += delta_x;
+		
+		line_infos.push_back( { line_start, line_end, paragraph_end, line_x + delta_x, line_y, line_width, metrics.ascent(), metrics.descent(), std::move(part_infos) } );
 		
 		// Advance to next line
 		line_y += line_spacing;
@@ -515,9 +639,13 @@ void TextObject::prepareLineInfos() const
 		}
 		line_num++;
 		line_start = next_line_start;
+		paragraph_start = paragraph_end;
 	}
 	
-	// Update the line and part offset for every other alignment than top-left or baseline-left
+	layout_text = text;
+	layout_parameters = std::move(parameters);
+	
+	// Update the line offset for every other alignment than top or baseline
 	
 	double delta_y = 0.0;
 	if (v_align == TextObject::AlignBottom || v_align == TextObject::AlignVCenter)
@@ -531,28 +659,10 @@ void TextObject::prepareLineInfos() const
 			delta_y = -height + 0.5 * box_height;
 	}
 	
-	if (delta_y != 0.0 || h_align != TextObject::AlignLeft)
+	if (delta_y != 0.0)
 	{
-		int num_lines = getNumLines();
-		for (int i = 0; i < num_lines; i++)
-		{
-			TextObjectLineInfo* line_info = &line_infos[i];
-			
-			double delta_x = 0.0;
-			if (h_align == TextObject::AlignHCenter)
-				delta_x = -0.5 * line_info->width;
-			else if (h_align == TextObject::AlignRight)
-				delta_x -= line_info->width;
-			
-			line_info->line_x += delta_x;
-			line_info->line_y += delta_y;
-			
-			int num_parts = line_info->part_infos.size();
-			for (int j = 0; j < num_parts; j++)
-			{
-				line_info->part_infos.at(j).part_x += delta_x;
-			}
-		}
+		for (auto& line_info : line_infos)
+			line_info.line_y += delta_y;
 	}
 }
 
@@ -22,10 +22,12 @@
 #ifndef OPENORIENTEERING_OBJECT_TEXT_H
 #define OPENORIENTEERING_OBJECT_TEXT_H
 
+#include <cstddef>
 #include <memory>
 #include <vector>
 
 #include <QtGlobal>
+#include <QFont>
 #include <QString>
 #include <QFontMetricsF>
 #include <QPointF>
@@ -260,6 +262,8 @@ public:
 	
 	bool intersectsBox(const QRectF& box) const override;
 	
+	std::size_t memoryUsage() const override;
+	
 	
 	/** Returns a QTransform from text coordinates to map coordinates.
 	 */
@@ -305,10 +309,31 @@ public:
 	const TextObjectLineInfo& findLineInfoForIndex(int index) const;
 	
 	/** Prepare the text layout information.
+	 * 
+	 * When only the text changed since the last call, the layout of the
+	 * unchanged paragraphs at the beginning and at the end of the text is
+	 * reused. So the time needed while editing a long text depends mostly
+	 * on the length of the edited paragraph.
 	 */
 	void prepareLineInfos() const;
 	
 private:
+	/** The parameters of the horizontal text layout of a paragraph.
+	 */
+	struct LayoutParameters
+	{
+		const Symbol* symbol = nullptr;
+		QFont font;
+		double scaling = 0;
+		double box_width = 0;
+		double first_tab = 0;
+		std::vector<int> custom_tabs;
+		HorizontalAlignment h_align = AlignLeft;
+		bool word_wrap = false;
+		
+		bool operator==(const LayoutParameters& other) const;
+	};
+	
 	QString text;
 	HorizontalAlignment h_align;
 	VerticalAlignment v_align;
@@ -319,6 +344,11 @@ private:
 	/** Information about the text layout.
 	 */
 	mutable LineInfoContainer line_infos;
+	
+	/** The text and parameters of the current line_infos.
+	 */
+	mutable QString layout_text;
+	mutable LayoutParameters layout_parameters;
 };
 
 
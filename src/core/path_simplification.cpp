@@ -0,0 +1,179 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#include "path_simplification.h"
+
+#include <algorithm>
+#include <functional>
+#include <initializer_list>
+#include <queue>
+#include <utility>
+
+#include <QtGlobal>
+
+
+namespace OpenOrienteering {
+
+namespace PathSimplification {
+
+namespace {
+
+/**
+ * Returns the squared distance of pos from the segment from start to end.
+ */
+double distanceSquaredToSegment(const MapCoordF& pos, const MapCoordF& start, const MapCoordF& end)
+{
+	auto const segment = end - start;
+	auto const to_pos = pos - start;
+	auto const length_sq = segment.lengthSquared();
+	if (length_sq == 0)
+		return to_pos.lengthSquared();
+	
+	auto const t = MapCoordF::dotProduct(to_pos, segment) / length_sq;
+	if (t <= 0)
+		return to_pos.lengthSquared();
+	if (t >= 1)
+		return pos.distanceSquaredTo(end);
+	
+	auto const cross = segment.x() * to_pos.y() - segment.y() * to_pos.x();
+	return cross * cross / length_sq;
+}
+
+}  // namespace
+
+
+
+std::vector<bool> douglasPeucker(const MapCoordVector& coords, size_type first, size_type last, double tolerance)
+{
+	Q_ASSERT(first <= last);
+	Q_ASSERT(last < coords.size());
+	
+	std::vector<bool> keep(last - first + 1, false);
+	keep.front() = true;
+	keep.back() = true;
+	
+	auto const tolerance_sq = tolerance * tolerance;
+	std::vector<std::pair<size_type, size_type>> ranges;
+	ranges.emplace_back(first, last);
+	while (!ranges.empty())
+	{
+		auto const range = ranges.back();
+		ranges.pop_back();
+		if (range.second <= range.first + 1)
+			continue;
+		
+		// Find the coordinate with the largest distance from the segment.
+		auto const start = MapCoordF(coords[range.first]);
+		auto const end = MapCoordF(coords[range.second]);
+		auto max_distance_sq = 0.0;
+		auto best_index = range.first;
+		for (auto i = range.first + 1; i < range.second; ++i)
+		{
+			auto const distance_sq = distanceSquaredToSegment(MapCoordF(coords[i]), start, end);
+			if (distance_sq > max_distance_sq)
+			{
+				max_distance_sq = distance_sq;
+				best_index = i;
+			}
+		}
+		
+		if (max_distance_sq < tolerance_sq)
+			continue;
+		
+		keep[best_index - first] = true;
+		ranges.emplace_back(best_index, range.second);
+		ranges.emplace_back(range.first, best_index);
+	}
+	return keep;
+}
+
+
+std::vector<bool> removeLeastSignificant(const MapCoordVector& coords, size_type first, size_type last, double tolerance, size_type min_coords)
+{
+	Q_ASSERT(first <= last);
+	Q_ASSERT(last < coords.size());
+	
+	auto const num_coords = last - first + 1;
+	std::vector<bool> keep(num_coords, true);
+	if (num_coords <= 2 || num_coords <= min_coords)
+		return keep;
+	
+	// A doubly linked list of the remaining coordinates, in local indices
+	std::vector<size_type> prev(num_coords);
+	std::vector<size_type> next(num_coords);
+	for (size_type i = 0; i < num_coords; ++i)
+	{
+		prev[i] = i - 1;
+		next[i] = i + 1;
+	}
+	
+	// The cost of removing a coordinate, as squared distance
+	auto const cost = [&coords, first, &prev, &next](size_type i) {
+		auto const start = MapCoordF(coords[first + prev[i]]);
+		auto const end = MapCoordF(coords[first + next[i]]);
+		auto max_distance_sq = 0.0;
+		for (auto k = prev[i] + 1; k < next[i]; ++k)
+			max_distance_sq = std::max(max_distance_sq, distanceSquaredToSegment(MapCoordF(coords[first + k]), start, end));
+		return max_distance_sq;
+	};
+	
+	// Heap entries become stale when the cost of a coordinate changes.
+	auto const tolerance_sq = tolerance * tolerance;
+	using Candidate = std::pair<double, size_type>;
+	std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> candidates;
+	std::vector<double> costs(num_coords);
+	for (size_type i = 1; i < num_coords - 1; ++i)
+	{
+		costs[i] = cost(i);
+		if (costs[i] <= tolerance_sq)
+			candidates.emplace(costs[i], i);
+	}
+	
+	auto remaining = num_coords;
+	while (!candidates.empty() && remaining > min_coords)
+	{
+		auto const candidate = candidates.top();
+		candidates.pop();
+		auto const i = candidate.second;
+		if (!keep[i] || candidate.first != costs[i])
+			continue;
+		
+		keep[i] = false;
+		--remaining;
+		next[prev[i]] = next[i];
+		prev[next[i]] = prev[i];
+		
+		for (auto neighbour : { prev[i], next[i] })
+		{
+			if (neighbour == 0 || neighbour == num_coords - 1)
+				continue;
+			costs[neighbour] = cost(neighbour);
+			if (costs[neighbour] <= tolerance_sq)
+				candidates.emplace(costs[neighbour], neighbour);
+		}
+	}
+	return keep;
+}
+
+
+}  // namespace PathSimplification
+
+}  // namespace OpenOrienteering
@@ -0,0 +1,72 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#ifndef OPENORIENTEERING_PATH_SIMPLIFICATION_H
+#define OPENORIENTEERING_PATH_SIMPLIFICATION_H
+
+#include <vector>
+
+#include "core/map_coord.h"
+
+
+namespace OpenOrienteering {
+
+/**
+ * Algorithms for reducing the number of coordinates of polylines.
+ * 
+ * The functions operate on the range [first, last] of a MapCoordVector,
+ * taken as a polyline. Curve flags are not taken into account. The functions
+ * return a mask with one element for each coordinate in the range, telling
+ * whether the coordinate is to be kept. The first and the last coordinate
+ * are always kept.
+ */
+namespace PathSimplification {
+
+using size_type = MapCoordVector::size_type;
+
+/**
+ * Simplifies the polyline with the Douglas-Peucker algorithm.
+ * 
+ * Ranges are split at the coordinate with the largest distance from the
+ * segment between the range's end points, as long as this distance is not
+ * less than the tolerance.
+ * The implementation uses an explicit stack instead of recursion.
+ */
+std::vector<bool> douglasPeucker(const MapCoordVector& coords, size_type first, size_type last, double tolerance);
+
+/**
+ * Simplifies the polyline by repeatedly removing the least significant coordinate.
+ * 
+ * This works like the Visvalingam-Whyatt algorithm, but the significance of
+ * a coordinate is the largest distance of the original coordinates from the
+ * segment which would replace it, instead of a triangle area. Coordinates are
+ * removed while this distance does not exceed the tolerance, and while more
+ * than min_coords coordinates remain. The candidates are kept in a heap, so
+ * that each removal takes logarithmic time in the number of coordinates.
+ */
+std::vector<bool> removeLeastSignificant(const MapCoordVector& coords, size_type first, size_type last, double tolerance, size_type min_coords = 2);
+
+
+}  // namespace PathSimplification
+
+}  // namespace OpenOrienteering
+
+#endif
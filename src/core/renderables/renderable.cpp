@@ -21,16 +21,25 @@
 #include "renderable.h"
 
 #include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
 #include <iterator>
+#include <unordered_map>
 #include <utility>
 
 #include <Qt>
+#include <QtGlobal>
 #include <QBrush>
 #include <QColor>
 #include <QImage>
 #include <QPainter>
 #include <QPainterPath>
 #include <QPen>
+#include <QPoint>
+#include <QPointF>
+#include <QRect>
+#include <QRectF>
 #include <QRgb>
 #include <QTransform>
 
@@ -39,6 +48,7 @@
 #include "core/map.h"
 #include "core/objects/object.h"
 #include "core/symbols/symbol.h"
+#include "util/profiler.h"
 #include "util/util.h"
 
 #if defined(Q_OS_ANDROID) && defined(QT_PRINTSUPPORT_LIB)
@@ -90,6 +100,69 @@ Renderable::~Renderable() = default;
 
 
 
+namespace {
+
+/**
+ * Divides a value in the range 0..255*255 by 255, with rounding.
+ */
+constexpr quint32 div255(quint32 value)
+{
+	return (value + 128 + ((value + 128) >> 8)) >> 8;
+}
+
+/**
+ * Composes the source onto the destination with multiplication.
+ *
+ * This is equivalent to QPainter::CompositionMode_Multiply for images of
+ * QImage::Format_ARGB32_Premultiplied, but it skips transparent source
+ * pixels. These are the majority of the pixels in a single separation.
+ * It also avoids the QPainter setup cost, and it doesn't produce the
+ * artifacts which need ImageTransparencyFixup.
+ */
+void multiplyImage(QImage& dest, const QImage& source)
+{
+	Q_ASSERT(dest.format() == QImage::Format_ARGB32_Premultiplied);
+	Q_ASSERT(source.format() == QImage::Format_ARGB32_Premultiplied);
+	
+	const auto width = qMin(dest.width(), source.width());
+	const auto height = qMin(dest.height(), source.height());
+	for (int y = 0; y < height; ++y)
+	{
+		auto* d = reinterpret_cast<QRgb*>(dest.scanLine(y));
+		const auto* s = reinterpret_cast<const QRgb*>(source.constScanLine(y));
+		for (int x = 0; x < width; ++x)
+		{
+			const auto src = s[x];
+			if (src == 0)
+				continue;
+			
+			const auto dst = d[x];
+			if (dst == 0)
+			{
+				d[x] = src;
+				continue;
+			}
+			
+			// result = src * dst + src * (1 - dst_alpha) + dst * (1 - src_alpha),
+			// for each of the four premultiplied channels.
+			const auto src_inv_alpha = 255 - qAlpha(src);
+			const auto dst_inv_alpha = 255 - qAlpha(dst);
+			quint32 result = 0;
+			for (auto shift : { 0, 8, 16, 24 })
+			{
+				const auto sc = (src >> shift) & 0xff;
+				const auto dc = (dst >> shift) & 0xff;
+				result |= div255(sc * (dc + dst_inv_alpha) + dc * src_inv_alpha) << shift;
+			}
+			d[x] = result;
+		}
+	}
+}
+
+}  // namespace
+
+
+
 // ### SharedRenderables ###
 
 SharedRenderables::~SharedRenderables()
@@ -97,32 +170,59 @@ SharedRenderables::~SharedRenderables()
 	deleteRenderables();
 }
 
+RenderableVector& SharedRenderables::operator[](const PainterConfig& state)
+{
+	auto group = std::lower_bound(begin(), end(), state, [](const value_type& item, const PainterConfig& value) {
+		return item.first < value;
+	});
+	if (group == end() || state < group->first)
+		group = emplace(group, state, RenderableVector());
+	return group->second;
+}
+
 void SharedRenderables::deleteRenderables()
 {
-	for (auto renderables = begin(); renderables != end(); )
+	for (auto& renderables : *this)
 	{
-		for (auto renderable : renderables->second)
+		for (auto renderable : renderables.second)
 		{
 			delete renderable;
 		}
+		renderables.second.clear();
+	}
+	erase(std::remove_if(begin(), end(), [](const value_type& item) {
+		return item.first.clip_path != nullptr;
+	}), end());
+}
+
+void SharedRenderables::remapColorPriority(int old_priority, int new_priority)
+{
+	// Within a container, all groups share the same color priority,
+	// so changing it uniformly keeps the groups sorted.
+	for (auto& renderables : *this)
+	{
+		if (renderables.first.color_priority != old_priority)
+			continue;
 		
-		renderables->second.clear();
-		if (renderables->first.clip_path)
-			renderables = erase(renderables);
-		else
-			++renderables;
+		renderables.first.color_priority = new_priority;
+		for (auto* renderable : renderables.second)
+		{
+			if (renderable->color_priority == old_priority)
+				renderable->color_priority = new_priority;
+		}
 	}
 }
 
-void SharedRenderables::compact()
+std::size_t SharedRenderables::memoryUsage() const
 {
-	for (auto renderables = begin(); renderables != end(); )
+	auto bytes = sizeof(*this) + capacity() * sizeof(value_type);
+	for (const auto& renderables : *this)
 	{
-		if (renderables->second.empty())
-			renderables = erase(renderables);
-		else
-			++renderables;
+		bytes += renderables.second.capacity() * sizeof(Renderable*);
+		for (const auto* renderable : renderables.second)
+			bytes += renderable->memoryUsage();
 	}
+	return bytes;
 }
 
 
@@ -141,10 +241,10 @@ void ObjectRenderables::draw(int map_color, const QColor& color, QPainter* paint
 	if (!extent.intersects(config.bounding_box))
 		return;
 	
-	auto color_renderables = std::find_if(begin(), end(), [map_color](auto item) { 
-		return item.first == map_color; 
+	auto color_renderables = std::lower_bound(begin(), end(), map_color, [](const value_type& item, int value) {
+		return item.first < value;
 	});
-	if (color_renderables == end())
+	if (color_renderables == end() || color_renderables->first != map_color)
 		return;
 	
 	const QPainterPath initial_clip = clip_path ? *clip_path : painter->clipPath();
@@ -175,10 +275,7 @@ void ObjectRenderables::setClipPath(const QPainterPath* path)
 
 void ObjectRenderables::insertRenderable(Renderable* r, const PainterConfig& state)
 {
-	SharedRenderables::Pointer& container(operator[](state.color_priority));
-	if (!container)
-		container = new SharedRenderables();
-	container->operator[](state).push_back(r);
+	container(state.color_priority)[state].push_back(r);
 	if (!clip_path)
 	{
 		if (extent.isValid())
@@ -188,6 +285,28 @@ void ObjectRenderables::insertRenderable(Renderable* r, const PainterConfig& sta
 	}
 }
 
+SharedRenderables& ObjectRenderables::container(int color_priority)
+{
+	auto color = std::lower_bound(begin(), end(), color_priority, [](const value_type& item, int value) {
+		return item.first < value;
+	});
+	if (color == end() || color->first != color_priority)
+		color = emplace(color, color_priority, new SharedRenderables());
+	return *color->second;
+}
+
+void ObjectRenderables::insertTranslated(const ObjectRenderables& prototype, const QPointF& offset)
+{
+	for (const auto& color : prototype)
+	{
+		for (const auto& renderables : *color.second)
+		{
+			for (const auto* renderable : renderables.second)
+				insertRenderable(renderable->translated(offset));
+		}
+	}
+}
+
 void ObjectRenderables::clear()
 {
 	for (auto& renderables : *this)
@@ -196,21 +315,55 @@ void ObjectRenderables::clear()
 	}
 }
 
+std::size_t ObjectRenderables::memoryUsage() const
+{
+	auto bytes = capacity() * sizeof(value_type);
+	for (const auto& color : *this)
+		bytes += color.second->memoryUsage();
+	return bytes;
+}
+
 void ObjectRenderables::takeRenderables()
 {
 	for (auto& color : *this)
 	{
 		auto new_container = new SharedRenderables();
+		new_container->reserve(color.second->size());
 		
 		// Pre-allocate as much space as in the original container
 		for (const auto& renderables : *color.second)
 		{
-			(*new_container)[renderables.first].reserve(renderables.second.size());
+			new_container->emplace_back(renderables.first, RenderableVector());
+			new_container->back().second.reserve(renderables.second.size());
 		}
 		color.second = new_container;
 	}
 }
 
+void ObjectRenderables::remapColorPriorities(const std::vector<int>& priorities)
+{
+	auto changed = false;
+	for (auto& color : *this)
+	{
+		if (color.first < 0 || std::size_t(color.first) >= priorities.size())
+			continue;
+		
+		auto const priority = priorities[std::size_t(color.first)];
+		if (priority == color.first)
+			continue;
+		
+		color.second->remapColorPriority(color.first, priority);
+		color.first = priority;
+		changed = true;
+	}
+	if (changed)
+	{
+		std::sort(begin(), end(), [](const value_type& lhs, const value_type& rhs) {
+			return lhs.first < rhs.first;
+		});
+	}
+}
+
 void ObjectRenderables::deleteRenderables()
 {
 	for (auto& color : *this)
@@ -223,6 +376,244 @@ void ObjectRenderables::deleteRenderables()
 
 // ### MapRenderables ###
 
+namespace {
+
+/**
+ * On screen, renderables smaller than this size in pixels are skipped.
+ */
+#ifdef Q_OS_ANDROID
+constexpr qreal lod_min_pixels = 1.0;
+#else
+constexpr qreal lod_min_pixels = 0.5;
+#endif
+
+/**
+ * On screen, clipped fill patterns are replaced by a tinted fill when their
+ * elements are smaller than this size and closer than lod_pattern_spacing,
+ * in pixels.
+ */
+constexpr qreal lod_pattern_element_pixels = 2.0;
+constexpr qreal lod_pattern_spacing = 4.0;
+constexpr std::size_t lod_min_pattern_elements = 16;
+
+/**
+ * Draws a collection of renderables which share a painter configuration.
+ * 
+ * The painter configuration must be activated already. For the screen,
+ * level-of-detail simplifications are applied, depending on config.scaling.
+ * Returns true if anything was drawn.
+ */
+bool drawRenderables(QPainter* painter, const RenderConfig& config, const PainterConfig& state, const RenderableVector& renderables)
+{
+	auto drawn = false;
+	if (!config.testFlag(RenderConfig::Screen))
+	{
+		for (const auto* renderable : renderables)
+		{
+			if (renderable->intersects(config.bounding_box))
+			{
+				renderable->render(*painter, config);
+				drawn = true;
+			}
+		}
+		return drawn;
+	}
+	
+	if (state.clip_path && renderables.size() >= lod_min_pattern_elements)
+	{
+		const auto max_element_size = lod_pattern_element_pixels / config.scaling;
+		QRectF pattern_extent;
+		qreal element_area = 0;
+		auto small_elements = true;
+		for (const auto* renderable : renderables)
+		{
+			const auto& extent = renderable->getExtent();
+			if (extent.width() >= max_element_size || extent.height() >= max_element_size)
+			{
+				small_elements = false;
+				break;
+			}
+			rectIncludeSafe(pattern_extent, extent);
+			element_area += extent.width() * extent.height();
+		}
+		
+		const auto spacing = lod_pattern_spacing / config.scaling;
+		const auto pattern_area = pattern_extent.width() * pattern_extent.height();
+		if (small_elements && pattern_area > 0
+		    && qreal(renderables.size()) * spacing * spacing > pattern_area)
+		{
+			// Elements are assumed to be roughly round.
+			const auto coverage = qMin(qreal(1), element_area * qreal(M_PI / 4) / pattern_area);
+			QColor tint = (state.mode == PainterConfig::PenOnly) ? painter->pen().color() : painter->brush().color();
+			tint.setAlphaF(tint.alphaF() * coverage);
+			// The area is given by the clip path.
+			painter->fillRect(pattern_extent.intersected(config.bounding_box), tint);
+			return true;
+		}
+	}
+	
+	const auto min_size = lod_min_pixels / config.scaling;
+	for (const auto* renderable : renderables)
+	{
+		const QRectF& extent = renderable->getExtent();
+		if (extent.width() < min_size && extent.height() < min_size)
+			continue;
+		if (renderable->intersects(config.bounding_box))
+		{
+			renderable->render(*painter, config);
+			drawn = true;
+		}
+	}
+	return drawn;
+}
+
+
+
+/**
+ * On screen, sprites are used for point objects up to this size in pixels.
+ */
+constexpr int max_sprite_size = 128;
+
+/**
+ * Draws unrotated point objects on screen by blitting prerendered images.
+ * 
+ * The renderables of such point objects are identical up to translation.
+ * So for each symbol, the renderables of the current color are drawn once
+ * into a sprite at the painter's scale, and the sprite is blitted at the
+ * positions of the other objects. Positions are rounded to full pixels.
+ * 
+ * Objects with clip paths or translucent colors, and printing, keep using
+ * the vector renderables.
+ */
+class PointSprites
+{
+public:
+	PointSprites(QPainter* painter, const RenderConfig& config)
+	: painter(painter)
+	, sprite_config(config)
+	, transform(painter->deviceTransform())
+	{
+		sprite_config.opacity = 1;
+		enabled = config.testFlag(RenderConfig::Screen)
+		          && config.opacity >= 1
+		          && transform.type() != QTransform::TxProject
+		          && transform == painter->worldTransform();
+	}
+	
+	/**
+	 * Starts drawing of a new color.
+	 * 
+	 * Sprites are only used for opaque non-special colors.
+	 */
+	void setColor(int color_priority, const QColor& color)
+	{
+		sprites.clear();
+		this->color = color;
+		color_enabled = enabled && color_priority >= 0 && color.alpha() == 255;
+	}
+	
+	/**
+	 * Draws the object's renderables of the current color from a sprite.
+	 * 
+	 * Returns false if the renderables must be drawn directly.
+	 */
+	bool draw(const Object* object, const SharedRenderables& renderables, const QPainterPath*& current_clip, const QPainterPath& initial_clip)
+	{
+		if (!color_enabled || object->getType() != Object::Point)
+			return false;
+		
+		const auto* symbol = object->getSymbol();
+		if (symbol->isRotatable() && !qIsNull(object->getRotation()))
+			return false;
+		if (std::any_of(begin(renderables), end(renderables), [](const auto& item) { return item.first.clip_path; }))
+			return false;
+		
+		auto& sprite = sprites[symbol];
+		++sprite.uses;
+		if (sprite.uses == 1 || sprite.unusable)
+			return false;  // A single instance is not worth a sprite.
+		
+		const auto position = object->asPoint()->getCoordF();
+		if (sprite.image.isNull() && !createSprite(sprite, position, renderables))
+		{
+			sprite.unusable = true;
+			return false;
+		}
+		
+		// Like PainterConfig::activate() for a state without clip path
+		if (current_clip)
+		{
+			painter->setClipPath(initial_clip, initial_clip.isEmpty() ? Qt::NoClip : Qt::ReplaceClip);
+			current_clip = nullptr;
+		}
+		painter->setOpacity(1);
+		
+		const auto device_pos = transform.map(QPointF(position));
+		const auto target = QPoint(qRound(device_pos.x()), qRound(device_pos.y())) + sprite.offset;
+		painter->setWorldMatrixEnabled(false);
+		painter->drawImage(target, sprite.image);
+		painter->setWorldMatrixEnabled(true);
+		return true;
+	}
+	
+private:
+	struct Sprite
+	{
+		QImage image;
+		QPoint offset;
+		int uses = 0;
+		bool unusable = false;
+	};
+	
+	bool createSprite(Sprite& sprite, const MapCoordF& position, const SharedRenderables& renderables)
+	{
+		QRectF extent;
+		for (const auto& item : renderables)
+		{
+			for (const auto* renderable : item.second)
+				rectIncludeSafe(extent, renderable->getExtent());
+		}
+		if (!extent.isValid())
+			return false;
+		
+		const auto linear = QTransform(transform.m11(), transform.m12(), transform.m21(), transform.m22(), 0, 0);
+		const auto rect = linear.mapRect(extent.translated(-position)).toAlignedRect().adjusted(-2, -2, 2, 2);
+		if (rect.width() > max_sprite_size || rect.height() > max_sprite_size)
+			return false;
+		
+		sprite.image = QImage(rect.size(), QImage::Format_ARGB32_Premultiplied);
+		sprite.image.fill(Qt::transparent);
+		sprite.offset = rect.topLeft();
+		
+		QPainter sprite_painter(&sprite.image);
+		sprite_painter.setRenderHints(painter->renderHints());
+		sprite_painter.setTransform(QTransform::fromTranslate(-position.x(), -position.y())
+		                            * linear
+		                            * QTransform::fromTranslate(-rect.left(), -rect.top()));
+		sprite_config.bounding_box = extent;
+		const QPainterPath no_clip;
+		const QPainterPath* sprite_clip = nullptr;
+		for (const auto& item : renderables)
+		{
+			if (item.first.activate(&sprite_painter, sprite_clip, sprite_config, color, no_clip))
+				drawRenderables(&sprite_painter, sprite_config, item.first, item.second);
+		}
+		return true;
+	}
+	
+	QPainter* const painter;
+	RenderConfig sprite_config;
+	const QTransform transform;
+	QColor color;
+	std::unordered_map<const Symbol*, Sprite> sprites;
+	bool enabled = false;
+	bool color_enabled = false;
+};
+
+}  // namespace
+
+
+
 void MapRenderables::ObjectDeleter::operator()(Object* object) const
 {
 	renderables.removeRenderablesOfObject(object, false);
@@ -235,77 +626,153 @@ MapRenderables::MapRenderables(Map* map)
 	; // nothing
 }
 
-void MapRenderables::draw(QPainter *painter, const RenderConfig &config) const
+MapRenderables::ColorBucket* MapRenderables::bucket(int color_priority)
 {
-	// TODO: improve performance by using some spatial acceleration structure?
+	auto color = std::lower_bound(begin(colors), end(colors), color_priority, [](const ColorBucket& item, int value) {
+		return item.color_priority < value;
+	});
+	if (color == end(colors) || color->color_priority != color_priority)
+		return nullptr;
+	return &*color;
+}
+
+MapRenderables::ColorBucket& MapRenderables::insertBucket(int color_priority)
+{
+	auto color = std::lower_bound(begin(colors), end(colors), color_priority, [](const ColorBucket& item, int value) {
+		return item.color_priority < value;
+	});
+	if (color == end(colors) || color->color_priority != color_priority)
+	{
+		color = colors.insert(color, ColorBucket());
+		color->color_priority = color_priority;
+	}
+	return *color;
+}
+
+std::vector<const MapRenderables::ObjectSlot*> MapRenderables::objectsInRect(const ColorBucket& bucket, const QRectF& bounding_box) const
+{
+	std::vector<const ObjectSlot*> result;
 	
-#ifdef Q_OS_ANDROID
-	const qreal min_dimension = 1.0/config.scaling;
-#endif
+	if (bounding_box.contains(bucket.index.bounds()))
+	{
+		// Without effective spatial filtering, a linear scan is cheaper.
+		result.reserve(bucket.slots.size() - bucket.free_slots.size());
+		for (const auto& slot : bucket.slots)
+		{
+			if (slot.object)
+				result.push_back(&slot);
+		}
+		return result;
+	}
 	
+	auto candidates = bucket.index.find(bounding_box);
+	// Keep the drawing order of the slots.
+	std::sort(begin(candidates), end(candidates));
+	result.reserve(candidates.size());
+	for (auto candidate : candidates)
+	{
+		result.push_back(&bucket.slots[candidate]);
+	}
+	return result;
+}
+
+void MapRenderables::draw(QPainter *painter, const RenderConfig &config) const
+{
 	QPainterPath initial_clip = painter->clipPath();
 	const QPainterPath* current_clip = nullptr;
 	
 	painter->save();
-	auto end_of_colors = rend();
-	auto color = rbegin();
-	while (color != end_of_colors && color->first >= map->getNumColors())
+	PointSprites sprites(painter, config);
+	
+	// The renderables which are to be drawn next, grouped by state.
+	std::vector<const SharedRenderables::value_type*> batch;
+	const auto batch_states = config.testFlag(RenderConfig::BatchStates);
+	auto drawBatch = [this, painter, &config, &initial_clip, &current_clip, &batch]() {
+		const PainterConfig* active_state = nullptr;
+		auto active = false;
+		for (const auto* renderables : batch)
+		{
+			// Render the renderables
+			const PainterConfig& state = renderables->first;
+			if (!active_state || *active_state != state)
+			{
+				active_state = &state;
+				active = false;
+				const MapColor* map_color = map->getColor(state.color_priority);
+				if (!map_color)
+				{
+					Q_ASSERT(state.color_priority == MapColor::Reserved);
+					continue; // in release build
+				}
+				QColor color = *map_color;
+				if (state.color_priority >= 0 && map_color->getOpacity() < 1)
+					color.setAlphaF(map_color->getOpacity());
+				active = state.activate(painter, current_clip, config, color, initial_clip);
+			}
+			if (active)
+				drawRenderables(painter, config, state, renderables->second);
+		}
+		batch.clear();
+	};
+	
+	auto end_of_colors = colors.rend();
+	auto color = colors.rbegin();
+	while (color != end_of_colors && color->color_priority >= map->getNumColors())
 	{
 		++color;
 	}
 	for (; color != end_of_colors; ++color)
 	{
 		if ( config.testFlag(RenderConfig::RequireSpotColor) &&
-		     (color->first < 0 || map->getColor(color->first)->getSpotColorMethod() == MapColor::UndefinedMethod) )
+		     (color->color_priority < 0 || map->getColor(color->color_priority)->getSpotColorMethod() == MapColor::UndefinedMethod) )
 		{
 			continue;
 		}
 		
-		for (const auto& object : color->second)
+		if (const MapColor* map_color = map->getColor(color->color_priority))
+		{
+			QColor layer_color = *map_color;
+			if (color->color_priority >= 0 && map_color->getOpacity() < 1)
+				layer_color.setAlphaF(map_color->getOpacity());
+			sprites.setColor(color->color_priority, layer_color);
+		}
+		else
+		{
+			sprites.setColor(MapColor::Reserved, {});
+		}
+		
+		for (const auto& object : objectsInRect(*color, config.bounding_box))
 		{
 			// Settings check
-			const Symbol* symbol = object.first->getSymbol();
+			const Symbol* symbol = object->object->getSymbol();
 			if (!config.testFlag(RenderConfig::HelperSymbols) && symbol->isHelperSymbol())
 				continue;
 			if (symbol->isHidden())
 				continue;
 			
-			if (!object.first->getExtent().intersects(config.bounding_box))
+			if (!object->object->getExtent().intersects(config.bounding_box))
 				continue;
 			
-			for (const auto& renderables : *object.second)
-			{
-				// Render the renderables
-				const PainterConfig& state = renderables.first;
-				const MapColor* map_color = map->getColor(state.color_priority);
-				if (!map_color)
-				{
-					Q_ASSERT(state.color_priority == MapColor::Reserved);
-					continue; // in release build
-				}
-				QColor color = *map_color;
-				if (state.color_priority >= 0 && map_color->getOpacity() < 1)
-					color.setAlphaF(map_color->getOpacity());
-				if (!state.activate(painter, current_clip, config, color, initial_clip))
-				    continue;
-				
-				for (const auto* renderable : renderables.second)
-				{
-#ifdef Q_OS_ANDROID
-					const QRectF& extent = renderable->getExtent();
-					if (extent.width() < min_dimension && extent.height() < min_dimension)
-						continue;
-#endif
-					if (renderable->intersects(config.bounding_box))
-					{
-						renderable->render(*painter, config);
-					}
-				}
-				
-			} // each common render attributes
+			if (sprites.draw(object->object, *object->renderables, current_clip, initial_clip))
+				continue;
+			
+			for (const auto& renderables : *object->renderables)
+				batch.push_back(&renderables);
+			if (!batch_states)
+				drawBatch();
 			
 		} // each object
 		
+		if (batch_states)
+		{
+			// Same-color renderables compose equally in any order, so the
+			// order of objects only needs to be kept for equal states.
+			std::stable_sort(begin(batch), end(batch), [](const auto* lhs, const auto* rhs) {
+				return lhs->first < rhs->first;
+			});
+			drawBatch();
+		}
+		
 	} // each map color
 	
 	painter->restore();
@@ -315,10 +782,16 @@ void MapRenderables::drawOverprintingSimulation(QPainter* painter, const RenderC
 {
 	// NOTE: painter must be a QPainter on a QImage of Format_ARGB32_Premultiplied.
 	QImage* image = static_cast<QImage*>(painter->device());
+#if MAPPER_OVERPRINTING_CORRECTION == -1
 	ImageTransparencyFixup image_fixup(image);
+#endif
 	
 	QPainter::RenderHints hints = painter->renderHints();
 	QTransform t = painter->worldTransform();
+	// The separations are composed without the painter,
+	// so they must be clipped when they are drawn.
+	const auto has_clipping = painter->hasClipping();
+	const auto clip_path = has_clipping ? painter->clipPath() : QPainterPath();
 	painter->save();
 	
 	painter->resetTransform();
@@ -338,15 +811,17 @@ void MapRenderables::drawOverprintingSimulation(QPainter* painter, const RenderC
 			QPainter p(&separation);
 			p.setRenderHints(hints);
 			p.setWorldTransform(t, false);
+			if (has_clipping)
+				p.setClipPath(clip_path);
 			drawColorSeparation(&p, config, *map_color, true);
 			p.end();
 			
 			// Add this separation to the composition with multiplication.
-			painter->setCompositionMode(QPainter::CompositionMode_Multiply);
-			painter->drawImage(0, 0, separation);
-			image_fixup();
+			multiplyImage(*image, separation);
 			
 #if MAPPER_OVERPRINTING_CORRECTION == -1
+			image_fixup();
+			
 			// Add some opacity to the multiplication, but not for black,
 			// since halftones (i.e. grey) might unduly lighten the composition.
 			if (static_cast<QRgb>(**map_color) != 0xff000000)
@@ -427,18 +902,18 @@ void MapRenderables::drawColorSeparation(QPainter* painter, const RenderConfig&
 	bool drawing_started = false;
 	
 	// For each pair of color priority and its renderables collection...
-	auto end_of_colors = rend();
-	auto color = rbegin();
-	while (color != end_of_colors && color->first >= map->getNumColors())
+	auto end_of_colors = colors.rend();
+	auto color = colors.rbegin();
+	while (color != end_of_colors && color->color_priority >= map->getNumColors())
 	{
 		++color;
 	}
 	for (; color != end_of_colors; ++color)
 	{
-		SpotColorComponent drawing_color(map->getColor(color->first), 1.0f);
+		SpotColorComponent drawing_color(map->getColor(color->color_priority), 1.0f);
 		
 		// Check whether the current color [priority] applies to the current separation.
-		if (color->first > MapColor::Reserved)
+		if (color->color_priority > MapColor::Reserved)
 		{
 			if (separation->getPriority() == MapColor::Reserved)
 			{
@@ -503,9 +978,9 @@ void MapRenderables::drawColorSeparation(QPainter* painter, const RenderConfig&
 		}
 		else if (separation->getPriority() == MapColor::Reserved)
 		{
-			if (color->first == MapColor::Registration)
+			if (color->color_priority == MapColor::Registration)
 				continue; // treated per spot color
-			else if (color->first == MapColor::Reserved)
+			else if (color->color_priority == MapColor::Reserved)
 				continue; // never drawn
 			else if (!drawing_color.spot_color)
 			{
@@ -514,7 +989,7 @@ void MapRenderables::drawColorSeparation(QPainter* painter, const RenderConfig&
 			}
 			painter->setRenderHint(QPainter::Antialiasing, true);
 		}
-		else if (color->first == MapColor::Registration)
+		else if (color->color_priority == MapColor::Registration)
 		{
 			// Draw Registration Black as fulltone of regular spot color
 			drawing_color.spot_color = separation;
@@ -526,20 +1001,20 @@ void MapRenderables::drawColorSeparation(QPainter* painter, const RenderConfig&
 		}
 		
 		// For each pair of object and its renderables [states] for a particular map color...
-		for (const auto& object : color->second)
+		for (const auto& object : objectsInRect(*color, config.bounding_box))
 		{
 			// Check whether the symbol and object is to be drawn at all.
-			const Symbol* symbol = object.first->getSymbol();
+			const Symbol* symbol = object->object->getSymbol();
 			if (!config.testFlag(RenderConfig::HelperSymbols) && symbol->isHelperSymbol())
 				continue;
 			if (symbol->isHidden())
 				continue;
 			
-			if (!object.first->getExtent().intersects(config.bounding_box))
+			if (!object->object->getExtent().intersects(config.bounding_box))
 				continue;
 			
 			// For each pair of common rendering attributes and collection of renderables...
-			for (const auto& renderables : *object.second)
+			for (const auto& renderables : *object->renderables)
 			{
 				const PainterConfig& state = renderables.first;
 				
@@ -565,16 +1040,9 @@ void MapRenderables::drawColorSeparation(QPainter* painter, const RenderConfig&
 				if (!state.activate(painter, current_clip, config, color, initial_clip))
 					continue;
 				
-				// For each renderable that uses the current painter configuration...
-				// Render the renderable
-				for (const auto* renderable : renderables.second)
-				{
-					if (renderable->intersects(config.bounding_box))
-					{
-						renderable->render(*painter, config);
-						drawing_started |= drawing;
-					}
-				}
+				// Render each renderable that uses the current painter configuration
+				if (drawRenderables(painter, config, state, renderables.second))
+					drawing_started |= drawing;
 				
 			} // each common render attributes
 			
@@ -587,53 +1055,136 @@ void MapRenderables::drawColorSeparation(QPainter* painter, const RenderConfig&
 
 void MapRenderables::insertRenderablesOfObject(const Object* object)
 {
-	auto end_of_colors = object->renderables().end();
-	auto color = object->renderables().begin();
-	for (; color != end_of_colors; ++color)
+	auto& locations = object_slots[object];
+	for (const auto& color : object->renderables())
 	{
-		operator[](color->first)[object] = color->second;
+		auto& bucket = insertBucket(color.first);
+		auto location = std::find_if(begin(locations), end(locations), [&color](const SlotLocation& item) {
+			return item.color_priority == color.first;
+		});
+		if (location == end(locations))
+		{
+			if (bucket.free_slots.empty())
+			{
+				locations.push_back({ color.first, bucket.slots.size() });
+				bucket.slots.push_back({ nullptr, {} });
+			}
+			else
+			{
+				locations.push_back({ color.first, bucket.free_slots.back() });
+				bucket.free_slots.pop_back();
+			}
+			location = std::prev(end(locations));
+		}
+		bucket.slots[location->slot] = { object, color.second };
+		bucket.index.insert(location->slot, object->getExtent());
 	}
+	if (locations.empty())
+		object_slots.erase(object);
 }
 
 void MapRenderables::removeRenderablesOfObject(const Object* object, bool mark_area_as_dirty)
 {
-	for (auto& color : *this)
+	auto locations = object_slots.find(object);
+	if (locations == object_slots.end())
+		return;
+	
+	for (const auto& location : locations->second)
 	{
-		auto obj = color.second.find(object);
-		if (obj != color.second.end())
+		auto* color = bucket(location.color_priority);
+		Q_ASSERT(color);
+		auto& slot = color->slots[location.slot];
+		if (mark_area_as_dirty)
 		{
-			if (mark_area_as_dirty)
+			// We don't want to loop over every dot in an area ...
+			QRectF extent = object->getExtent();
+			if (!extent.isValid())
 			{
-				// We don't want to loop over every dot in an area ...
-				QRectF extent = object->getExtent();
-				if (!extent.isValid())
+				// ... because here it gets expensive
+				for (const auto& renderables : *slot.renderables)
 				{
-					// ... because here it gets expensive
-					for (const auto& renderables : *obj->second)
+					for (const auto* renderable : renderables.second)
 					{
-						for (const auto* renderable : renderables.second)
-						{
-							extent = extent.isValid() ? extent.united(renderable->getExtent()) : renderable->getExtent();
-						}
+						extent = extent.isValid() ? extent.united(renderable->getExtent()) : renderable->getExtent();
 					}
 				}
-				map->setObjectAreaDirty(extent);
 			}
-			
-			color.second.erase(obj);
+			map->setObjectAreaDirty(extent);
+		}
+		
+		slot = { nullptr, {} };
+		color->free_slots.push_back(location.slot);
+		color->index.remove(location.slot);
+	}
+	object_slots.erase(locations);
+}
+
+void MapRenderables::remapColorPriorities(const std::vector<int>& priorities)
+{
+	auto remapped = [&priorities](int color_priority) {
+		if (color_priority < 0 || std::size_t(color_priority) >= priorities.size())
+			return color_priority;
+		return priorities[std::size_t(color_priority)];
+	};
+	
+	auto changed = false;
+	for (auto& color : colors)
+	{
+		auto const priority = remapped(color.color_priority);
+		if (priority == color.color_priority)
+			continue;
+		
+		// The containers are shared with the objects. Remapping is
+		// idempotent, so it doesn't matter who gets there first.
+		for (auto& slot : color.slots)
+		{
+			if (slot.object)
+				slot.renderables->remapColorPriority(color.color_priority, priority);
 		}
+		color.color_priority = priority;
+		changed = true;
 	}
+	if (!changed)
+		return;
+	
+	std::sort(begin(colors), end(colors), [](const ColorBucket& lhs, const ColorBucket& rhs) {
+		return lhs.color_priority < rhs.color_priority;
+	});
+	for (auto& object : object_slots)
+	{
+		for (auto& location : object.second)
+			location.color_priority = remapped(location.color_priority);
+	}
+}
+
+std::size_t MapRenderables::memoryUsage() const
+{
+	auto bytes = colors.capacity() * sizeof(ColorBucket);
+	for (const auto& color : colors)
+	{
+		bytes += color.slots.capacity() * sizeof(ObjectSlot)
+		         + color.free_slots.capacity() * sizeof(std::size_t)
+		         + color.index.memoryUsage() - sizeof(color.index);
+	}
+	constexpr auto node_overhead = 2 * sizeof(void*);
+	bytes += object_slots.bucket_count() * sizeof(void*);
+	for (const auto& object : object_slots)
+		bytes += sizeof(object) + node_overhead + object.second.capacity() * sizeof(SlotLocation);
+	return bytes;
 }
 
 void MapRenderables::clear(bool mark_area_as_dirty)
 {
 	if (mark_area_as_dirty)
 	{
-		for (const auto& color : *this)
+		Map::DirtyAreaBatch batch(*map);
+		for (const auto& color : colors)
 		{
-			for (const auto& object : color.second)
+			for (const auto& slot : color.slots)
 			{
-				for (const auto& renderables : *object.second)
+				if (!slot.object)
+					continue;
+				for (const auto& renderables : *slot.renderables)
 				{
 					for (const auto* renderable : renderables.second)
 					{
@@ -643,7 +1194,8 @@ void MapRenderables::clear(bool mark_area_as_dirty)
 			}
 		}
 	}
-	std::map<int, ObjectRenderablesMap>::clear();
+	colors.clear();
+	object_slots.clear();
 }
 
 // ### PainterConfig ###
@@ -671,6 +1223,7 @@ bool PainterConfig::activate(QPainter* painter, const QPainterPath*& current_cli
 {
 	if (current_clip != clip_path)
 	{
+		Profiler::Scope profiler_scope(Profiler::ClipChange);
 		if (initial_clip.isEmpty())
 		{
 			if (clip_path)
@@ -21,16 +21,20 @@
 #ifndef OPENORIENTEERING_RENDERABLE_H
 #define OPENORIENTEERING_RENDERABLE_H
 
-#include <map>
+#include <cstddef>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include <QtGlobal>
 #include <QFlags>
+#include <QPointF>
 #include <QRectF>
 #include <QSharedData>
 #include <QExplicitlySharedDataPointer>
 
 #include "core/map_color.h"
+#include "core/spatial_index.h"
 
 class QColor;
 class QPainter;
@@ -66,12 +70,17 @@ public:
 		                            ///  Can turn on optimizations which result in slightly
 		                            ///  lower display quality (e.g. disable antialiasing
 		                            ///  for texts) for the benefit of speed.
+		                            ///  This includes level-of-detail simplifications
+		                            ///  at small scales.
 		DisableAntialiasing = 1<<1, ///< Forces disabling of Antialiasing.
 		ForceMinSize        = 1<<2, ///< Forces a minimum size of app. 1 pixel for objects. 
 		                            ///  Makes maps look better at small zoom levels without antialiasing.
 		HelperSymbols       = 1<<3, ///< Activates display of symbols with the "helper symbol" flag.
 		Highlighted         = 1<<4, ///< Makes the color appear highlighted.
 		RequireSpotColor    = 1<<5, ///< Skips colors which do not have a spot color definition.
+		BatchStates         = 1<<6, ///< Draws the renderables of all objects of a color
+		                            ///  grouped by painter configuration, in order to
+		                            ///  reduce the number of painter state changes.
 		Tool                = Screen | ForceMinSize | HelperSymbols, ///< The recommended flags for tools.
 		NoOptions           = 0     ///< No option activated.
 	};
@@ -120,6 +129,9 @@ protected:
 	/** The constructor for new renderables. */
 	explicit Renderable(const MapColor* color);
 	
+	/** The constructor for translated copies of renderables. */
+	Renderable(const Renderable& proto, const QPointF& offset);
+	
 public:
 	Renderable(const Renderable&) = delete;
 	Renderable(Renderable&&) = delete;
@@ -154,9 +166,28 @@ public:
 	 */
 	virtual void render(QPainter& painter, const RenderConfig& config) const = 0;
 	
+	/**
+	 * Returns a copy of this renderable, translated by the given offset.
+	 * 
+	 * The caller takes ownership of the returned object.
+	 */
+	virtual Renderable* translated(const QPointF& offset) const = 0;
+	
+	/**
+	 * Returns an estimate of the memory used by this renderable, in bytes.
+	 */
+	virtual std::size_t memoryUsage() const = 0;
+	
 protected:
-	/** The color priority is a major attribute and cannot be modified. */
-	const int color_priority;
+	/**
+	 * The color priority is a major attribute.
+	 * 
+	 * It is only changed when the map's colors are reordered,
+	 * cf. SharedRenderables::remapColorPriority().
+	 */
+	int color_priority;
+	
+	friend class SharedRenderables;
 	
 	/** The extent must be set by inheriting classes. */
 	QRectF extent;
@@ -170,7 +201,9 @@ protected:
  * When painting a renderable item, the QPainter shall be configured according
  * to this information.
  * 
- * A PainterConfig is an immutable values, constructed with initializer lists.
+ * A PainterConfig is an immutable value, constructed with initializer lists.
+ * The members are not declared const so that configurations can be kept in
+ * contiguous, sorted containers.
  */
 class PainterConfig
 {
@@ -182,9 +215,9 @@ public:
 		Reserved  = -1	///< Not used.
 	};
 	
-	const int color_priority;       ///< The color priority which determines rendering order
-	const PainterMode mode;         ///< The mode of painting
-	const qreal pen_width;          ///< The width of the pen
+	int color_priority;             ///< The color priority which determines rendering order
+	PainterMode mode;               ///< The mode of painting
+	qreal pen_width;                ///< The width of the pen
 	const QPainterPath* clip_path;  ///< A clip_path which may be shared by several Renderables
 	
 	/**
@@ -234,10 +267,13 @@ typedef std::vector<Renderable*> RenderableVector;
  * A shared high-level container for renderables
  * grouped by common render attributes.
  * 
+ * The groups are stored contiguously, sorted by their PainterConfig, so that
+ * drawing iterates over a single array instead of a tree of nodes.
+ * 
  * This shared container can be used in different collections. When the last
  * reference to this container is dropped, it will delete the renderables.
  */
-class SharedRenderables : public QSharedData, public std::map< PainterConfig, RenderableVector >
+class SharedRenderables : public QSharedData, public std::vector< std::pair<PainterConfig, RenderableVector> >
 {
 public:
 	typedef QExplicitlySharedDataPointer<SharedRenderables> Pointer;
@@ -245,8 +281,30 @@ public:
 	SharedRenderables(const SharedRenderables&) = delete;
 	SharedRenderables& operator=(const SharedRenderables&) = delete;
 	~SharedRenderables();
+	
+	/**
+	 * Returns the renderables for the given configuration,
+	 * inserting an empty group if necessary.
+	 */
+	RenderableVector& operator[](const PainterConfig& state);
+	
 	void deleteRenderables();
-	void compact(); // release memory which is occupied by unused PainterConfig, FIXME: maybe call this regularly...
+	
+	/**
+	 * Moves the groups and renderables of the given color priority
+	 * to another color priority.
+	 * 
+	 * Groups which already have a different color priority are left
+	 * unchanged. This makes it safe to remap a container which is shared
+	 * by several collections.
+	 */
+	void remapColorPriority(int old_priority, int new_priority);
+	
+	/**
+	 * Returns an estimate of the memory used by this container
+	 * and its renderables, in bytes.
+	 */
+	std::size_t memoryUsage() const;
 };
 
 
@@ -255,7 +313,7 @@ public:
  * A high-level container for all renderables of a single object, 
  * grouped by color priority and common render attributes.
  */
-class ObjectRenderables : protected std::map<int, SharedRenderables::Pointer>
+class ObjectRenderables : protected std::vector< std::pair<int, SharedRenderables::Pointer> >
 {
 friend class MapRenderables;
 public:
@@ -267,10 +325,26 @@ public:
 	inline void insertRenderable(Renderable* r);
 	void insertRenderable(Renderable* r, const PainterConfig& state);
 	
+	/**
+	 * Inserts translated copies of all renderables of the given prototype.
+	 * 
+	 * The copies are inserted with this object's clip path.
+	 */
+	void insertTranslated(const ObjectRenderables& prototype, const QPointF& offset);
+	
 	void clear();
 	void deleteRenderables();
 	void takeRenderables();
 	
+	/**
+	 * Moves the renderables to new color priorities.
+	 * 
+	 * The renderables of the color priority i are moved to the color priority
+	 * priorities[i]. The priorities must be a permutation. Negative and
+	 * unmapped color priorities are left unchanged.
+	 */
+	void remapColorPriorities(const std::vector<int>& priorities);
+	
 	/**
 	 * Draws all renderables matching the given map color with the given color.
 	 * 
@@ -285,7 +359,20 @@ public:
 	
 	const QRectF& getExtent() const;
 	
+	/**
+	 * Returns an estimate of the memory used by the renderables, in bytes.
+	 * 
+	 * Containers which are shared with other objects are counted in full.
+	 */
+	std::size_t memoryUsage() const;
+	
 private:
+	/**
+	 * Returns the container for the given color priority,
+	 * creating it if necessary.
+	 */
+	SharedRenderables& container(int color_priority);
+	
 	QRectF& extent;
 	const QPainterPath* clip_path = nullptr; // no memory management here!
 };
@@ -293,23 +380,18 @@ private:
 
 
 /**
- * A low-level container for renderables of multiple objects
- * grouped by object and common render attributes.
- * 
- * This container uses a smart pointer to the renderable collection
- * of each single object.
- */
-typedef std::map<const Object*, SharedRenderables::Pointer> ObjectRenderablesMap;
-
-
-
-/** 
  * A high-level container for renderables of multiple objects
  * grouped by color priority, object and common render attributes.
  * 
+ * The renderables are kept in a flat, sorted array of color buckets. Each
+ * bucket stores its objects in dense slots, and slots which are released by
+ * removing an object are reused by the next insertion. The slots of each
+ * object are recorded, so that removing an object does not need to search
+ * the buckets.
+ * 
  * This container is able to draw the renderables.
  */
-class MapRenderables : protected std::map<int, ObjectRenderablesMap>
+class MapRenderables
 {
 public:
 	/**
@@ -366,10 +448,82 @@ public:
 	
 	void clear(bool mark_area_as_dirty = false);
 	
+	/**
+	 * Moves the renderables to new color priorities, without regenerating them.
+	 * 
+	 * This is used when the map's colors are reordered.
+	 * \see ObjectRenderables::remapColorPriorities()
+	 */
+	void remapColorPriorities(const std::vector<int>& priorities);
+	
 	inline bool empty() const;
 	
+	/**
+	 * Returns an estimate of the memory used by the buckets, slots and
+	 * spatial indexes, in bytes.
+	 * 
+	 * The renderables are owned by the objects, and they are not included.
+	 * Cf. ObjectRenderables::memoryUsage().
+	 */
+	std::size_t memoryUsage() const;
+	
 private:
+	/**
+	 * The renderables of a single object in a color bucket.
+	 * 
+	 * A null object marks a free slot.
+	 */
+	struct ObjectSlot
+	{
+		const Object* object;
+		SharedRenderables::Pointer renderables;
+	};
+	
+	/**
+	 * The objects with renderables of a single color priority.
+	 */
+	struct ColorBucket
+	{
+		int color_priority;
+		std::vector<ObjectSlot> slots;
+		std::vector<std::size_t> free_slots;
+		
+		/** Spatial index of the object extents, by slot. */
+		SpatialIndex<std::size_t> index;
+	};
+	
+	/**
+	 * The location of an object's renderables.
+	 */
+	struct SlotLocation
+	{
+		int color_priority;
+		std::size_t slot;
+	};
+	
+	/**
+	 * Returns the bucket for the given color priority, or nullptr.
+	 */
+	ColorBucket* bucket(int color_priority);
+	
+	/**
+	 * Returns the bucket for the given color priority, creating it if necessary.
+	 */
+	ColorBucket& insertBucket(int color_priority);
+	
+	/**
+	 * Returns the objects of the given bucket which may intersect
+	 * the given bounding box, in the order of the slots.
+	 */
+	std::vector<const ObjectSlot*> objectsInRect(const ColorBucket& bucket, const QRectF& bounding_box) const;
+	
 	Map* const map;
+	
+	/** The color buckets, sorted by color priority. */
+	std::vector<ColorBucket> colors;
+	
+	/** The slots occupied by each object. */
+	std::unordered_map<const Object*, std::vector<SlotLocation>> object_slots;
 };
 
 
@@ -393,6 +547,14 @@ Renderable::Renderable(const MapColor* color)
 	; // nothing
 }
 
+inline
+Renderable::Renderable(const Renderable& proto, const QPointF& offset)
+ : color_priority(proto.color_priority)
+ , extent(proto.extent.translated(offset))
+{
+	; // nothing
+}
+
 inline
 const QRectF&Renderable::getExtent() const
 {
@@ -473,7 +635,7 @@ const QRectF &ObjectRenderables::getExtent() const
 inline
 bool MapRenderables::empty() const
 {
-	return std::map<int, ObjectRenderablesMap>::empty();
+	return object_slots.empty();
 }
 
 
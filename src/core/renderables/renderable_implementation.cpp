@@ -20,19 +20,30 @@
 
 #include "renderable_implementation.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <iterator>
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include <QtMath>
 #include <QtNumeric>
+#include <QBrush>
+#include <QCache>
 #include <QFont>
 #include <QFontMetricsF>
+#include <QImage>
+#include <QLatin1Char>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QPaintEngine>
 #include <QPainter>
 #include <QPen>
 #include <QPoint>
+#include <QPair>
+#include <QPointF>
+#include <QString>
 #include <QTransform>
 // IWYU pragma: no_include <QVariant>
 
@@ -85,6 +96,78 @@ inline void fixPenForPdf(QPen& pen, const QPainter& painter)
 #endif
 }
 
+
+/**
+ * A cache of text outlines, shared by all TextRenderables.
+ * 
+ * Converting text to a QPainterPath is expensive, and maps often contain
+ * many identical labels. The paths are cached at the origin, keyed by font
+ * and text. The cost of an entry is its number of path elements.
+ */
+class TextPathCache
+{
+public:
+	/** Returns the path of the text, with the baseline starting at the origin. */
+	QPainterPath path(const QFont& font, const QString& text)
+	{
+		auto key = qMakePair(fontKey(font), text);
+		
+		QMutexLocker lock(&mutex);
+		if (auto const* cached = cache.object(key))
+			return *cached;
+		lock.unlock();
+		
+		auto path = QPainterPath();
+		path.addText(0, 0, font, text);
+		
+		lock.relock();
+		cache.insert(key, new QPainterPath(path), qMax(1, path.elementCount()));
+		return path;
+	}
+	
+private:
+	/**
+	 * Returns a key for all font properties which affect the text path.
+	 * 
+	 * QFont::key() does not cover spacing and kerning in Qt5.
+	 */
+	static QString fontKey(const QFont& font)
+	{
+		return font.key()
+		       + QLatin1Char('/') + QString::number(int(font.letterSpacingType()))
+		       + QLatin1Char('/') + QString::number(font.letterSpacing(), 'g', 17)
+		       + QLatin1Char('/') + QString::number(font.wordSpacing(), 'g', 17)
+		       + QLatin1Char('/') + QString::number(int(font.kerning()))
+		       + QLatin1Char('/') + QString::number(int(font.hintingPreference()));
+	}
+	
+	/** The maximum total number of cached path elements. */
+	static constexpr int max_cost = 1000000;
+	
+	QMutex mutex;
+	QCache<QPair<QString, QString>, QPainterPath> cache { max_cost };
+};
+
+TextPathCache& textPathCache()
+{
+	static TextPathCache cache;
+	return cache;
+}
+
+
+/** The innermost active LinePathSharing scope of the current thread. */
+thread_local OpenOrienteering::LinePathSharing* line_path_sharing = nullptr;
+
+/**
+ * Returns an estimate of the memory used by the elements of a painter path.
+ * 
+ * Implicitly shared paths are counted for each user.
+ */
+std::size_t pathMemoryUsage(const QPainterPath& path)
+{
+	return std::size_t(path.elementCount()) * sizeof(QPainterPath::Element);
+}
+
 }  // namespace
 
 
@@ -94,7 +177,13 @@ namespace OpenOrienteering {
 // ### DotRenderable ###
 
 DotRenderable::DotRenderable(const PointSymbol* symbol, MapCoordF coord)
- : Renderable(symbol->getInnerColor())
+ : DotRenderable(symbol, symbol->getInnerColor(), coord)
+{
+	// nothing else
+}
+
+DotRenderable::DotRenderable(const PointSymbol* symbol, const MapColor* color, MapCoordF coord)
+ : Renderable(color)
 {
 	double x = coord.x();
 	double y = coord.y();
@@ -102,6 +191,22 @@ DotRenderable::DotRenderable(const PointSymbol* symbol, MapCoordF coord)
 	extent = QRectF(x - radius, y - radius, 2 * radius, 2 * radius);
 }
 
+DotRenderable::DotRenderable(const DotRenderable& proto, const QPointF& offset)
+ : Renderable(proto, offset)
+{
+	// nothing else
+}
+
+Renderable* DotRenderable::translated(const QPointF& offset) const
+{
+	return new DotRenderable(*this, offset);
+}
+
+std::size_t DotRenderable::memoryUsage() const
+{
+	return sizeof(*this);
+}
+
 PainterConfig DotRenderable::getPainterConfig(const QPainterPath* clip_path) const
 {
 	return { color_priority, PainterConfig::BrushOnly, 0, clip_path };
@@ -130,6 +235,24 @@ CircleRenderable::CircleRenderable(const PointSymbol* symbol, MapCoordF coord)
 	extent = QRectF(rect.x() - 0.5*line_width, rect.y() - 0.5*line_width, rect.width() + line_width, rect.height() + line_width);
 }
 
+CircleRenderable::CircleRenderable(const CircleRenderable& proto, const QPointF& offset)
+ : Renderable(proto, offset)
+ , line_width(proto.line_width)
+ , rect(proto.rect.translated(offset))
+{
+	// nothing else
+}
+
+Renderable* CircleRenderable::translated(const QPointF& offset) const
+{
+	return new CircleRenderable(*this, offset);
+}
+
+std::size_t CircleRenderable::memoryUsage() const
+{
+	return sizeof(*this);
+}
+
 PainterConfig CircleRenderable::getPainterConfig(const QPainterPath* clip_path) const
 {
 	return { color_priority, PainterConfig::PenOnly, line_width, clip_path };
@@ -145,9 +268,72 @@ void CircleRenderable::render(QPainter &painter, const RenderConfig &config) con
 
 
 
+// ### LinePathSharing ###
+
+LinePathSharing::LinePathSharing()
+: previous(line_path_sharing)
+{
+	line_path_sharing = this;
+}
+
+LinePathSharing::~LinePathSharing()
+{
+	line_path_sharing = previous;
+}
+
+// static
+bool LinePathSharing::matches(const Entry& entry, const VirtualPath& virtual_path, bool closed)
+{
+	if (entry.closed != closed || entry.coords.size() != virtual_path.size())
+		return false;
+	
+	auto i = virtual_path.first_index;
+	for (std::size_t k = 0; k < entry.coords.size(); ++k, ++i)
+	{
+		const auto coord = virtual_path.coords[i];
+		if (entry.flags[k] != virtual_path.coords.flags[i]
+		    || entry.coords[k].x() != coord.x() || entry.coords[k].y() != coord.y())
+			return false;
+	}
+	return true;
+}
+
+// static
+const QPainterPath* LinePathSharing::find(const VirtualPath& virtual_path, bool closed)
+{
+	if (!line_path_sharing)
+		return nullptr;
+	
+	for (const auto& entry : line_path_sharing->entries)
+	{
+		if (matches(entry, virtual_path, closed))
+			return &entry.path;
+	}
+	return nullptr;
+}
+
+// static
+void LinePathSharing::insert(const VirtualPath& virtual_path, bool closed, const QPainterPath& path)
+{
+	if (!line_path_sharing)
+		return;
+	
+	Entry entry { {}, {}, closed, path };
+	entry.coords.reserve(virtual_path.size());
+	entry.flags.reserve(virtual_path.size());
+	for (auto i = virtual_path.first_index; i <= virtual_path.last_index; ++i)
+	{
+		entry.coords.push_back(virtual_path.coords[i]);
+		entry.flags.push_back(virtual_path.coords.flags[i]);
+	}
+	line_path_sharing->entries.push_back(std::move(entry));
+}
+
+
+
 // ### LineRenderable ###
 
-LineRenderable::LineRenderable(const LineSymbol* symbol, const VirtualPath& virtual_path, bool closed)
+LineRenderable::LineRenderable(const LineSymbol* symbol, const VirtualPath& virtual_path, bool closed, bool share_path)
  : Renderable(symbol->getColor())
  , line_width(0.001 * symbol->getLineWidth())
 {
@@ -172,13 +358,17 @@ LineRenderable::LineRenderable(const LineSymbol* symbol, const VirtualPath& virt
 	auto& flags  = virtual_path.coords.flags;
 	auto& coords = virtual_path.coords;
 	
+	const auto* shared_path = share_path ? LinePathSharing::find(virtual_path, closed) : nullptr;
+	const auto build_path = !shared_path;
+	
 	bool has_curve = false;
 	bool hole = false;
 	QPainterPath first_subpath;
 	
 	auto i = virtual_path.first_index;
 	bool gap = flags[i].isGapPoint();  // Line may start with a gap
-	path.moveTo(coords[i]);
+	if (build_path)
+		path.moveTo(coords[i]);
 	extent = QRectF(coords[i].x(), coords[i].y(), 0.0001, 0.0001);
 	extentIncludeCap(i, half_line_width, false, symbol, virtual_path);
 	
@@ -194,12 +384,15 @@ LineRenderable::LineRenderable(const LineSymbol* symbol, const VirtualPath& virt
 			else if (flags[i].isGapPoint())
 			{
 				gap = false;
-				if (first_subpath.isEmpty() && closed)
+				if (build_path)
 				{
-					first_subpath = path;
-					path = QPainterPath();
+					if (first_subpath.isEmpty() && closed)
+					{
+						first_subpath = path;
+						path = QPainterPath();
+					}
+					path.moveTo(coords[i]);
 				}
-				path.moveTo(coords[i]);
 				extentIncludeCap(i, half_line_width, false, symbol, virtual_path);
 			}
 			continue;
@@ -208,12 +401,15 @@ LineRenderable::LineRenderable(const LineSymbol* symbol, const VirtualPath& virt
 		if (hole)
 		{
 			Q_ASSERT(!flags[i].isHolePoint() && "Two hole points in a row!");
-			if (first_subpath.isEmpty() && closed)
+			if (build_path)
 			{
-				first_subpath = path;
-				path = QPainterPath();
+				if (first_subpath.isEmpty() && closed)
+				{
+					first_subpath = path;
+					path = QPainterPath();
+				}
+				path.moveTo(coords[i]);
 			}
-			path.moveTo(coords[i]);
 			extentIncludeCap(i, half_line_width, false, symbol, virtual_path);
 			hole = false;
 			continue;
@@ -223,10 +419,11 @@ LineRenderable::LineRenderable(const LineSymbol* symbol, const VirtualPath& virt
 		{
 			Q_ASSERT(i < virtual_path.last_index-1);
 			has_curve = true;
-			path.cubicTo(coords[i], coords[i+1], coords[i+2]);
+			if (build_path)
+				path.cubicTo(coords[i], coords[i+1], coords[i+2]);
 			i += 2;
 		}
-		else
+		else if (build_path)
 			path.lineTo(coords[i]);
 		
 		if (flags[i].isHolePoint())
@@ -240,12 +437,21 @@ LineRenderable::LineRenderable(const LineSymbol* symbol, const VirtualPath& virt
 			extentIncludeCap(i, half_line_width, true, symbol, virtual_path);
 	}
 	
-	if (closed)
+	if (!build_path)
 	{
-		if (first_subpath.isEmpty())
-			path.closeSubpath();
-		else
-			path.connectPath(first_subpath);
+		path = *shared_path;
+	}
+	else
+	{
+		if (closed)
+		{
+			if (first_subpath.isEmpty())
+				path.closeSubpath();
+			else
+				path.connectPath(first_subpath);
+		}
+		if (share_path)
+			LinePathSharing::insert(virtual_path, closed, path);
 	}
 	
 	// If we do not have the path coords, but there was a curve, calculate path coords.
@@ -444,6 +650,26 @@ void LineRenderable::extentIncludeJoin(quint32 i, qreal half_line_width, const L
 	}
 }
 
+LineRenderable::LineRenderable(const LineRenderable& proto, const QPointF& offset)
+ : Renderable(proto, offset)
+ , line_width(proto.line_width)
+ , path(proto.path.translated(offset))
+ , cap_style(proto.cap_style)
+ , join_style(proto.join_style)
+{
+	// nothing else
+}
+
+Renderable* LineRenderable::translated(const QPointF& offset) const
+{
+	return new LineRenderable(*this, offset);
+}
+
+std::size_t LineRenderable::memoryUsage() const
+{
+	return sizeof(*this) + pathMemoryUsage(path);
+}
+
 PainterConfig LineRenderable::getPainterConfig(const QPainterPath* clip_path) const
 {
 	return { color_priority, PainterConfig::PenOnly, line_width, clip_path };
@@ -461,9 +687,23 @@ void LineRenderable::render(QPainter &painter, const RenderConfig &config) const
 	}
 	painter.setPen(pen);
 	
+	const int count = path.elementCount();
+	
+	// On screen, the course of tiny open lines doesn't matter.
+	if (count > 2 && config.testFlag(RenderConfig::Screen)
+	    && qMax(extent.width(), extent.height()) * config.scaling < 2)
+	{
+		const QPointF first = path.elementAt(0);
+		const QPointF last = path.elementAt(count-1);
+		if (first != last)
+		{
+			painter.drawLine(first, last);
+			return;
+		}
+	}
+	
 	// One-time adjustment for line width
 	QRectF bounding_box = config.bounding_box.adjusted(-line_width, -line_width, line_width, line_width);
-	const int count = path.elementCount();
 	if (count <= 2 || bounding_box.contains(path.controlPointRect()))
 	{
 		// path fully contained
@@ -612,6 +852,234 @@ void LineRenderable::render(QPainter &painter, const RenderConfig &config) const
 	painter.setPen(pen);*/
 }
 
+// ### LinePatternRenderable ###
+
+namespace {
+
+/**
+ * Line patterns are drawn with a texture when the line spacing on screen
+ * is not more than this number of pixels.
+ */
+constexpr qreal max_texture_spacing = 64;
+
+}  // namespace
+
+
+LinePatternRenderable::LinePatternRenderable(const MapColor* color, qreal line_width, qreal line_spacing, bool clipped)
+ : Renderable(color)
+ , line_width(line_width)
+ , line_spacing(line_spacing)
+ , clipped(clipped)
+{
+	// Extent is set by addLine().
+}
+
+LinePatternRenderable::LinePatternRenderable(const LinePatternRenderable& proto, const QPointF& offset)
+ : Renderable(proto, offset)
+ , line_width(proto.line_width)
+ , line_spacing(proto.line_spacing)
+ , clipped(proto.clipped)
+ , path(proto.path.translated(offset))
+ , origin(proto.origin + offset)
+ , direction(proto.direction)
+{
+	// nothing else
+}
+
+Renderable* LinePatternRenderable::translated(const QPointF& offset) const
+{
+	return new LinePatternRenderable(*this, offset);
+}
+
+std::size_t LinePatternRenderable::memoryUsage() const
+{
+	return sizeof(*this) + pathMemoryUsage(path);
+}
+
+void LinePatternRenderable::addLine(QPointF first, QPointF second)
+{
+	qreal half_line_width = (color_priority < 0) ? 0 : line_width/2;
+	
+	auto right = MapCoordF(second - first).perpRight();
+	right.normalize();
+	right *= half_line_width;
+	
+	if (path.isEmpty())
+	{
+		auto tangent = MapCoordF(second - first);
+		tangent.normalize();
+		origin = first;
+		direction = tangent;
+		extent = QRectF(first + right, first + right);
+	}
+	rectInclude(extent, first + right);
+	rectInclude(extent, first - right);
+	rectInclude(extent, second - right);
+	rectInclude(extent, second + right);
+	
+	path.moveTo(first);
+	path.lineTo(second);
+}
+
+void LinePatternRenderable::clipTo(const QPainterPath& area)
+{
+	Q_ASSERT(!clipped);
+	if (path.isEmpty())
+		return;
+	
+	// All lines are parallel. In a frame where the lines are horizontal,
+	// n is the position across the lines, and t is the position along them.
+	auto const normal = QPointF(-direction.y(), direction.x());
+	auto const across = [&normal](const QPointF& p) { return QPointF::dotProduct(normal, p); };
+	auto const along = [this](const QPointF& p) { return QPointF::dotProduct(direction, p); };
+	
+	struct Line
+	{
+		qreal n;
+		qreal t_min;
+		qreal t_max;
+	};
+	std::vector<Line> lines;
+	lines.reserve(std::size_t(path.elementCount() / 2));
+	for (int i = 0; i + 1 < path.elementCount(); i += 2)
+	{
+		QPointF const first = path.elementAt(i);
+		QPointF const second = path.elementAt(i + 1);
+		auto const t0 = along(first);
+		auto const t1 = along(second);
+		lines.push_back({ across(first), qMin(t0, t1), qMax(t0, t1) });
+	}
+	std::sort(begin(lines), end(lines), [](const Line& a, const Line& b) { return a.n < b.n; });
+	
+	// The sorted edge table. Flattening curves at a fine scale gives a precise outline.
+	struct Edge
+	{
+		qreal n_min;
+		qreal n_max;
+		qreal n0;
+		qreal t0;
+		qreal dt_dn;
+		int winding;
+	};
+	std::vector<Edge> edges;
+	for (const auto& polygon : area.toSubpathPolygons(QTransform::fromScale(1000, 1000)))
+	{
+		auto const size = polygon.size();
+		for (int i = 0; i < size; ++i)
+		{
+			auto const p0 = polygon[i] / 1000;
+			auto const p1 = polygon[(i + 1) % size] / 1000;
+			auto const n0 = across(p0);
+			auto const n1 = across(p1);
+			if (n0 == n1)
+				continue;  // parallel to the lines
+			auto const t0 = along(p0);
+			edges.push_back({ qMin(n0, n1), qMax(n0, n1), n0, t0, (along(p1) - t0) / (n1 - n0), n1 > n0 ? 1 : -1 });
+		}
+	}
+	std::sort(begin(edges), end(edges), [](const Edge& a, const Edge& b) { return a.n_min < b.n_min; });
+	
+	path = {};
+	extent = {};
+	
+	// Sweep across the lines, with the active edges crossing the current line.
+	auto const even_odd = area.fillRule() == Qt::OddEvenFill;
+	std::vector<const Edge*> active;
+	std::vector<std::pair<qreal, int>> crossings;
+	auto next_edge = begin(edges);
+	for (const auto& line : lines)
+	{
+		for (; next_edge != end(edges) && next_edge->n_min <= line.n; ++next_edge)
+			active.push_back(&*next_edge);
+		active.erase(std::remove_if(begin(active), end(active), [&line](const Edge* e) { return e->n_max <= line.n; }),
+		             end(active));
+		
+		crossings.clear();
+		for (const auto* edge : active)
+			crossings.emplace_back(edge->t0 + (line.n - edge->n0) * edge->dt_dn, edge->winding);
+		std::sort(begin(crossings), end(crossings));
+		
+		auto winding = 0;
+		auto start = qreal(0);
+		for (const auto& crossing : crossings)
+		{
+			auto const was_inside = even_odd ? (winding % 2 != 0) : (winding != 0);
+			winding += crossing.second;
+			auto const is_inside = even_odd ? (winding % 2 != 0) : (winding != 0);
+			if (!was_inside && is_inside)
+			{
+				start = crossing.first;
+			}
+			else if (was_inside && !is_inside)
+			{
+				auto const t_start = qMax(start, line.t_min);
+				auto const t_end = qMin(crossing.first, line.t_max);
+				if (t_start < t_end)
+					addLine(normal * line.n + direction * t_start, normal * line.n + direction * t_end);
+			}
+		}
+	}
+}
+
+PainterConfig LinePatternRenderable::getPainterConfig(const QPainterPath* clip_path) const
+{
+	return { color_priority, PainterConfig::PenOnly, line_width, clip_path };
+}
+
+void LinePatternRenderable::render(QPainter& painter, const RenderConfig& config) const
+{
+	if (clipped && config.testFlag(RenderConfig::Screen)
+	    && line_spacing * config.scaling <= max_texture_spacing)
+	{
+		renderTexture(painter, config);
+		return;
+	}
+	
+	QPen pen(painter.pen());
+	pen.setCapStyle(Qt::FlatCap);
+	painter.setPen(pen);
+	painter.drawPath(path);
+}
+
+void LinePatternRenderable::renderTexture(QPainter& painter, const RenderConfig& config) const
+{
+	// One period of the pattern, with the line centered at row 0.
+	const int height = qMax(4, qCeil(line_spacing * config.scaling));
+	const qreal texel_size = line_spacing / height;
+	auto pen_width = painter.pen().widthF();
+	if (qIsNull(pen_width))
+		pen_width = 1 / config.scaling;  // cosmetic pen
+	const qreal half_band = qMin(qreal(height), pen_width / texel_size) / 2;
+	
+	QImage texture(4, height, QImage::Format_ARGB32_Premultiplied);
+	texture.fill(Qt::transparent);
+	{
+		QPainter texture_painter(&texture);
+		texture_painter.setRenderHint(QPainter::Antialiasing, painter.testRenderHint(QPainter::Antialiasing));
+		texture_painter.setPen(Qt::NoPen);
+		texture_painter.setBrush(painter.pen().color());
+		texture_painter.drawRect(QRectF(0, 0, texture.width(), half_band));
+		texture_painter.drawRect(QRectF(0, height - half_band, texture.width(), half_band));
+	}
+	
+	// Texture x runs along the lines, texture y across the lines.
+	const auto normal = QPointF(-direction.y(), direction.x());
+	QBrush brush(texture);
+	brush.setTransform(QTransform(texel_size * direction.x(), texel_size * direction.y(),
+	                              texel_size * normal.x(), texel_size * normal.y(),
+	                              origin.x(), origin.y()));
+	
+	painter.save();
+	painter.setRenderHint(QPainter::SmoothPixmapTransform, true);
+	painter.setPen(Qt::NoPen);
+	painter.setBrush(brush);
+	// The area is given by the clip path.
+	painter.drawRect(extent.intersected(config.bounding_box));
+	painter.restore();
+}
+
+
+
 // ### AreaRenderable ###
 
 AreaRenderable::AreaRenderable(const AreaSymbol* symbol, const PathPartVector& path_parts)
@@ -667,13 +1135,38 @@ void AreaRenderable::addSubpath(const VirtualPath& virtual_path)
 	path.closeSubpath();
 }
 
+AreaRenderable::AreaRenderable(const AreaRenderable& proto, const QPointF& offset)
+ : Renderable(proto, offset)
+ , path(proto.path.translated(offset))
+{
+	// nothing else
+}
+
+Renderable* AreaRenderable::translated(const QPointF& offset) const
+{
+	return new AreaRenderable(*this, offset);
+}
+
+std::size_t AreaRenderable::memoryUsage() const
+{
+	return sizeof(*this) + pathMemoryUsage(path);
+}
+
 PainterConfig AreaRenderable::getPainterConfig(const QPainterPath* clip_path) const
 {
 	return { color_priority, PainterConfig::BrushOnly, 0, clip_path };
 }
 
-void AreaRenderable::render(QPainter &painter, const RenderConfig &/*config*/) const
+void AreaRenderable::render(QPainter &painter, const RenderConfig &config) const
 {
+	// On screen, the outline of tiny areas doesn't matter.
+	if (config.testFlag(RenderConfig::Screen)
+	    && qMax(extent.width(), extent.height()) * config.scaling < 2)
+	{
+		painter.drawRect(extent);
+		return;
+	}
+	
 	painter.drawPath(path);
 	
 	// DEBUG: show all control points
@@ -706,6 +1199,7 @@ TextRenderable::TextRenderable(const TextSymbol* symbol, const TextObject* text_
 	
 	const QFont& font(symbol->getQFont());
 	const QFontMetricsF& metrics(symbol->getFontMetrics());
+	auto& text_paths = textPathCache();
 	
 	int num_lines = text_object->getNumLines();
 	for (int i=0; i < num_lines; i++)
@@ -736,7 +1230,7 @@ TextRenderable::TextRenderable(const TextSymbol* symbol, const TextObject* text_
 				}
 				underline_x0 = part.part_x;
 			}
-			path.addText(part.part_x, line_y, font, part.part_text);
+			path.addPath(text_paths.path(font, part.part_text).translated(part.part_x, line_y));
 		}
 	}
 	
@@ -753,6 +1247,27 @@ TextRenderable::TextRenderable(const TextSymbol* symbol, const TextObject* text_
 	extent = t.mapRect(path.controlPointRect());
 }
 
+TextRenderable::TextRenderable(const TextRenderable& proto, const QPointF& offset)
+: Renderable { proto, offset }
+, path       { proto.path }
+, anchor_x   { proto.anchor_x + offset.x() }
+, anchor_y   { proto.anchor_y + offset.y() }
+, rotation   { proto.rotation }
+, scale_factor { proto.scale_factor }
+{
+	// nothing else
+}
+
+Renderable* TextRenderable::translated(const QPointF& offset) const
+{
+	return new TextRenderable(*this, offset);
+}
+
+std::size_t TextRenderable::memoryUsage() const
+{
+	return sizeof(*this) + pathMemoryUsage(path);
+}
+
 PainterConfig TextRenderable::getPainterConfig(const QPainterPath* clip_path) const
 {
 	return { color_priority, PainterConfig::BrushOnly, 0.0, clip_path };
@@ -793,6 +1308,23 @@ TextFramingRenderable::TextFramingRenderable(const TextSymbol* symbol, const Tex
 	extent.adjust(-adjustment, -adjustment, +adjustment, +adjustment);
 }
 
+TextFramingRenderable::TextFramingRenderable(const TextFramingRenderable& proto, const QPointF& offset)
+: TextRenderable { proto, offset }
+, framing_line_width { proto.framing_line_width }
+{
+	// nothing else
+}
+
+Renderable* TextFramingRenderable::translated(const QPointF& offset) const
+{
+	return new TextFramingRenderable(*this, offset);
+}
+
+std::size_t TextFramingRenderable::memoryUsage() const
+{
+	return sizeof(*this) + pathMemoryUsage(path);
+}
+
 PainterConfig TextFramingRenderable::getPainterConfig(const QPainterPath* clip_path) const
 {
 	return { color_priority, PainterConfig::PenOnly, framing_line_width, clip_path };
@@ -22,6 +22,9 @@
 #ifndef OPENORIENTEERING_RENDERABLE_IMPLENTATION_H
 #define OPENORIENTEERING_RENDERABLE_IMPLENTATION_H
 
+#include <cstddef>
+#include <vector>
+
 #include <Qt>
 #include <QtGlobal>
 #include <QPainterPath>
@@ -29,6 +32,7 @@
 #include <QRectF>
 
 #include "renderable.h"
+#include "core/map_coord.h"
 
 class QPainter;
 class QPointF;
@@ -38,7 +42,6 @@ namespace OpenOrienteering {
 class AreaSymbol;
 class LineSymbol;
 class MapColor;
-class MapCoordF;
 class PathPartVector;
 class PointSymbol;
 class TextObject;
@@ -51,8 +54,15 @@ class DotRenderable : public Renderable
 {
 public:
 	DotRenderable(const PointSymbol* symbol, MapCoordF coord);
+	/** Creates a dot of the symbol's inner radius, but in the given color. */
+	DotRenderable(const PointSymbol* symbol, const MapColor* color, MapCoordF coord);
 	void render(QPainter& painter, const RenderConfig& config) const override;
 	PainterConfig getPainterConfig(const QPainterPath* clip_path = nullptr) const override;
+	Renderable* translated(const QPointF& offset) const override;
+	std::size_t memoryUsage() const override;
+	
+protected:
+	DotRenderable(const DotRenderable& proto, const QPointF& offset);
 };
 
 /** Renderable for displaying a circle. */
@@ -62,8 +72,12 @@ public:
 	CircleRenderable(const PointSymbol* symbol, MapCoordF coord);
 	void render(QPainter& painter, const RenderConfig& config) const override;
 	PainterConfig getPainterConfig(const QPainterPath* clip_path = nullptr) const override;
+	Renderable* translated(const QPointF& offset) const override;
+	std::size_t memoryUsage() const override;
 	
 protected:
+	CircleRenderable(const CircleRenderable& proto, const QPointF& offset);
+	
 	const qreal line_width;
 	QRectF rect;
 };
@@ -72,12 +86,22 @@ protected:
 class LineRenderable : public Renderable
 {
 public:
-	LineRenderable(const LineSymbol* symbol, const VirtualPath& virtual_path, bool closed);
+	/**
+	 * Constructs a line renderable for the given path.
+	 * 
+	 * If share_path is true, the painter path may be shared with other line
+	 * renderables for the same coordinates, cf. LinePathSharing.
+	 */
+	LineRenderable(const LineSymbol* symbol, const VirtualPath& virtual_path, bool closed, bool share_path = false);
 	LineRenderable(const LineSymbol* symbol, QPointF first, QPointF second);
 	void render(QPainter& painter, const RenderConfig& config) const override;
 	PainterConfig getPainterConfig(const QPainterPath* clip_path = nullptr) const override;
+	Renderable* translated(const QPointF& offset) const override;
+	std::size_t memoryUsage() const override;
 	
 protected:
+	LineRenderable(const LineRenderable& proto, const QPointF& offset);
+	
 	void extentIncludeCap(quint32 i, qreal half_line_width, bool end_cap, const LineSymbol* symbol, const VirtualPath& path);
 	
 	void extentIncludeJoin(quint32 i, qreal half_line_width, const LineSymbol* symbol, const VirtualPath& path);
@@ -88,6 +112,101 @@ protected:
 	Qt::PenJoinStyle join_style;
 };
 
+/**
+ * Lets line renderables share painter paths within a scope.
+ * 
+ * The line parts of a combined symbol create line renderables from the same
+ * path. For plain lines, the resulting painter paths are identical. While an
+ * object of this class exists, such a path is built once by the current
+ * thread, and further line renderables which opt in for the same coordinates
+ * use an implicitly shared copy. Scopes may be nested.
+ */
+class LinePathSharing
+{
+public:
+	LinePathSharing();
+	LinePathSharing(const LinePathSharing&) = delete;
+	LinePathSharing& operator=(const LinePathSharing&) = delete;
+	~LinePathSharing();
+	
+	/**
+	 * Returns the shared painter path for the given virtual path,
+	 * or nullptr if there is none or if no scope is active.
+	 */
+	static const QPainterPath* find(const VirtualPath& virtual_path, bool closed);
+	
+	/**
+	 * Records the painter path which was built for the given virtual path,
+	 * if a scope is active.
+	 */
+	static void insert(const VirtualPath& virtual_path, bool closed, const QPainterPath& path);
+	
+private:
+	struct Entry
+	{
+		std::vector<MapCoordF> coords;
+		std::vector<MapCoord> flags;
+		bool closed;
+		QPainterPath path;
+	};
+	
+	static bool matches(const Entry& entry, const VirtualPath& virtual_path, bool closed);
+	
+	std::vector<Entry> entries;
+	LinePathSharing* const previous;
+};
+
+/**
+ * Renderable for displaying all lines of a line fill pattern.
+ * 
+ * On screen, clipped patterns with small line spacing are drawn by filling
+ * the clip path with a texture brush which holds a single period of the
+ * pattern. Otherwise, the lines are drawn as a path.
+ */
+class LinePatternRenderable : public Renderable
+{
+public:
+	LinePatternRenderable(const MapColor* color, qreal line_width, qreal line_spacing, bool clipped);
+	void render(QPainter& painter, const RenderConfig& config) const override;
+	PainterConfig getPainterConfig(const QPainterPath* clip_path = nullptr) const override;
+	Renderable* translated(const QPointF& offset) const override;
+	std::size_t memoryUsage() const override;
+	
+	/**
+	 * Adds a line to the pattern.
+	 * 
+	 * All lines must be parallel, at multiples of the line spacing.
+	 */
+	void addLine(QPointF first, QPointF second);
+	
+	/**
+	 * Clips the lines to the given area, geometrically.
+	 * 
+	 * The intersections of the lines with the area outline are computed in a
+	 * single sweep across the parallel lines, using a sorted edge table.
+	 * After clipping, the pattern does not need a clip path for drawing.
+	 * The ends of the clipped lines are perpendicular to the lines, so they
+	 * may deviate from the area boundary by up to half the line width.
+	 * This must not be used for patterns created with clipped = true.
+	 */
+	void clipTo(const QPainterPath& area);
+	
+	/** Returns true if no line was added. */
+	bool isEmpty() const { return path.isEmpty(); }
+	
+protected:
+	LinePatternRenderable(const LinePatternRenderable& proto, const QPointF& offset);
+	
+	void renderTexture(QPainter& painter, const RenderConfig& config) const;
+	
+	const qreal line_width;
+	const qreal line_spacing;
+	const bool clipped;
+	QPainterPath path;
+	QPointF origin;     ///< A point on the first line
+	QPointF direction;  ///< The unit vector along the lines
+};
+
 /** Renderable for displaying an area. */
 class AreaRenderable : public Renderable
 {
@@ -96,10 +215,14 @@ public:
 	AreaRenderable(const AreaSymbol* symbol, const VirtualPath& path);
 	void render(QPainter& painter, const RenderConfig& config) const override;
 	PainterConfig getPainterConfig(const QPainterPath* clip_path = nullptr) const override;
+	Renderable* translated(const QPointF& offset) const override;
+	std::size_t memoryUsage() const override;
 	
 	inline const QPainterPath* painterPath() const;
 	
 protected:
+	AreaRenderable(const AreaRenderable& proto, const QPointF& offset);
+	
 	void addSubpath(const VirtualPath& virtual_path);
 	
 	QPainterPath path;
@@ -112,8 +235,12 @@ public:
 	TextRenderable(const TextSymbol* symbol, const TextObject* text_object, const MapColor* color, double anchor_x, double anchor_y);
 	PainterConfig getPainterConfig(const QPainterPath* clip_path = nullptr) const override;
 	void render(QPainter& painter, const RenderConfig& config) const override;
+	Renderable* translated(const QPointF& offset) const override;
+	std::size_t memoryUsage() const override;
 	
 protected:
+	TextRenderable(const TextRenderable& proto, const QPointF& offset);
+	
 	void renderCommon(QPainter& painter, const RenderConfig& config) const;
 	
 	QPainterPath path;
@@ -130,8 +257,12 @@ public:
 	TextFramingRenderable(const TextSymbol* symbol, const TextObject* text_object, const MapColor* color, double anchor_x, double anchor_y);
 	PainterConfig getPainterConfig(const QPainterPath* clip_path = nullptr) const override;
 	void render(QPainter& painter, const RenderConfig& config) const override;
+	Renderable* translated(const QPointF& offset) const override;
+	std::size_t memoryUsage() const override;
 	
 protected:
+	TextFramingRenderable(const TextFramingRenderable& proto, const QPointF& offset);
+	
 	qreal framing_line_width;
 };
 
@@ -0,0 +1,458 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef OPENORIENTEERING_SPATIAL_INDEX_H
+#define OPENORIENTEERING_SPATIAL_INDEX_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <QtGlobal>
+#include <QRectF>
+
+
+namespace OpenOrienteering {
+
+
+/**
+ * A spatial index for values with rectangular extents.
+ *
+ * The index is a hierarchy of uniform grids. Each value is stored on the
+ * finest level where the cell size is not smaller than the larger dimension
+ * of the value's extent, so that a value occupies at most 2x2 cells. Only
+ * non-empty cells are allocated.
+ *
+ * Values with an invalid extent are kept in a separate list, and they are
+ * reported by every query. Query results are a superset of the values whose
+ * extent intersects the query rectangle, i.e. callers still need to do their
+ * own precise tests.
+ *
+ * The value type must be hashable, e.g. a pointer.
+ */
+template <class T>
+class SpatialIndex
+{
+public:
+	using value_type = T;
+	using size_type  = std::size_t;
+
+	/**
+	 * Constructs an empty index.
+	 *
+	 * @param cell_size The size of the cells of the finest grid,
+	 *                  in the units of the extents (i.e. normally mm).
+	 */
+	explicit SpatialIndex(qreal cell_size = 4.0);
+
+	SpatialIndex(const SpatialIndex&) = default;
+	SpatialIndex(SpatialIndex&&) = default;
+	~SpatialIndex() = default;
+	SpatialIndex& operator=(const SpatialIndex&) = default;
+	SpatialIndex& operator=(SpatialIndex&&) = default;
+
+
+	/** Returns true if the index has no values. */
+	bool empty() const noexcept { return entries.empty(); }
+
+	/** Returns the number of values in the index. */
+	size_type size() const noexcept { return entries.size(); }
+
+	/**
+	 * Returns the union of the extents of all values inserted since the
+	 * last clear().
+	 *
+	 * The bounds do not shrink when values are removed.
+	 */
+	const QRectF& bounds() const noexcept { return total_bounds; }
+
+	/** Returns true if the index contains the given value. */
+	bool contains(T value) const { return entries.find(value) != entries.end(); }
+
+	/**
+	 * Returns the extent which was recorded for the given value,
+	 * or an invalid rectangle if the value is not in the index.
+	 */
+	QRectF extent(T value) const;
+
+	/**
+	 * Returns an estimate of the memory used by the index, in bytes.
+	 *
+	 * The estimate includes the typical overhead of hash table nodes.
+	 */
+	std::size_t memoryUsage() const noexcept;
+
+
+	/**
+	 * Inserts a value with the given extent.
+	 *
+	 * If the value is already in the index, the old entry is replaced.
+	 */
+	void insert(T value, const QRectF& extent);
+
+	/**
+	 * Removes a value.
+	 *
+	 * Returns false if the value was not in the index.
+	 */
+	bool remove(T value);
+
+	/** Removes all values. */
+	void clear();
+
+
+	/**
+	 * Calls function(value, extent) once for each value which may intersect
+	 * the given rectangle.
+	 *
+	 * Intersection is tested inclusively, i.e. values which only touch the
+	 * rectangle are reported, too. The function must not modify the index.
+	 */
+	template <class Function>
+	void query(const QRectF& rect, Function&& function) const;
+
+	/**
+	 * Returns the values which may intersect the given rectangle.
+	 *
+	 * The result is not sorted.
+	 */
+	std::vector<T> find(const QRectF& rect) const;
+
+
+private:
+	struct Entry
+	{
+		QRectF extent;
+		int level;
+	};
+
+	struct Item
+	{
+		QRectF extent;
+		T value;
+	};
+
+	struct CellRange
+	{
+		qint32 left;
+		qint32 top;
+		qint32 right;
+		qint32 bottom;
+	};
+
+	using Bucket = std::vector<Item>;
+	using Grid = std::unordered_map<quint64, Bucket>;
+
+	static constexpr int max_level = 24;
+	static constexpr qint32 max_cell = 1 << 30;
+
+	qreal cellSize(int level) const noexcept;
+	int levelFor(const QRectF& extent) const noexcept;
+	qint32 cellCoord(qreal value, int level) const noexcept;
+	CellRange cellRange(const QRectF& rect, int level) const noexcept;
+
+	static quint64 key(qint32 x, qint32 y) noexcept;
+	static qint32 keyX(quint64 key) noexcept;
+	static qint32 keyY(quint64 key) noexcept;
+	static bool overlaps(const QRectF& a, const QRectF& b) noexcept;
+
+	template <class Function>
+	void queryLevel(const Grid& grid, int level, const QRectF& rect, Function& function) const;
+
+	qreal base_cell_size;
+	std::unordered_map<T, Entry> entries;
+	std::vector<Grid> levels;
+	std::vector<T> unbounded;
+	QRectF total_bounds;
+};
+
+
+
+// ### SpatialIndex inline and template code ###
+
+template <class T>
+SpatialIndex<T>::SpatialIndex(qreal cell_size)
+: base_cell_size(cell_size > 0 ? cell_size : 4.0)
+{
+	// nothing else
+}
+
+
+template <class T>
+QRectF SpatialIndex<T>::extent(T value) const
+{
+	auto entry = entries.find(value);
+	return entry == entries.end() ? QRectF() : entry->second.extent;
+}
+
+
+template <class T>
+std::size_t SpatialIndex<T>::memoryUsage() const noexcept
+{
+	constexpr auto node_overhead = 2 * sizeof(void*);
+	auto bytes = sizeof(*this)
+	             + entries.size() * (sizeof(typename decltype(entries)::value_type) + node_overhead)
+	             + entries.bucket_count() * sizeof(void*)
+	             + levels.capacity() * sizeof(Grid)
+	             + unbounded.capacity() * sizeof(T);
+	for (const auto& grid : levels)
+	{
+		bytes += grid.size() * (sizeof(typename Grid::value_type) + node_overhead)
+		         + grid.bucket_count() * sizeof(void*);
+		for (const auto& cell : grid)
+			bytes += cell.second.capacity() * sizeof(Item);
+	}
+	return bytes;
+}
+
+
+template <class T>
+void SpatialIndex<T>::insert(T value, const QRectF& extent)
+{
+	remove(value);
+
+	if (!extent.isValid())
+	{
+		entries.emplace(value, Entry{ extent, -1 });
+		unbounded.push_back(value);
+		return;
+	}
+
+	auto const level = levelFor(extent);
+	entries.emplace(value, Entry{ extent, level });
+	if (levels.size() <= std::size_t(level))
+		levels.resize(std::size_t(level) + 1);
+
+	auto& grid = levels[std::size_t(level)];
+	auto const range = cellRange(extent, level);
+	for (auto y = range.top; y <= range.bottom; ++y)
+	{
+		for (auto x = range.left; x <= range.right; ++x)
+		{
+			grid[key(x, y)].push_back(Item{ extent, value });
+		}
+	}
+
+	total_bounds = total_bounds.isValid() ? total_bounds.united(extent) : extent;
+}
+
+
+template <class T>
+bool SpatialIndex<T>::remove(T value)
+{
+	auto entry = entries.find(value);
+	if (entry == entries.end())
+		return false;
+
+	auto const level = entry->second.level;
+	if (level < 0)
+	{
+		auto item = std::find(begin(unbounded), end(unbounded), value);
+		Q_ASSERT(item != end(unbounded));
+		*item = unbounded.back();
+		unbounded.pop_back();
+	}
+	else
+	{
+		auto& grid = levels[std::size_t(level)];
+		auto const range = cellRange(entry->second.extent, level);
+		for (auto y = range.top; y <= range.bottom; ++y)
+		{
+			for (auto x = range.left; x <= range.right; ++x)
+			{
+				auto bucket = grid.find(key(x, y));
+				Q_ASSERT(bucket != grid.end());
+				auto& items = bucket->second;
+				auto item = std::find_if(begin(items), end(items), [value](const Item& i) {
+					return i.value == value;
+				});
+				Q_ASSERT(item != end(items));
+				*item = items.back();
+				items.pop_back();
+				if (items.empty())
+					grid.erase(bucket);
+			}
+		}
+	}
+
+	entries.erase(entry);
+	return true;
+}
+
+
+template <class T>
+void SpatialIndex<T>::clear()
+{
+	entries.clear();
+	levels.clear();
+	unbounded.clear();
+	total_bounds = {};
+}
+
+
+template <class T>
+template <class Function>
+void SpatialIndex<T>::query(const QRectF& rect, Function&& function) const
+{
+	for (auto value : unbounded)
+		function(value, entries.at(value).extent);
+
+	if (!rect.isValid())
+		return;
+
+	for (std::size_t level = 0; level < levels.size(); ++level)
+	{
+		auto const& grid = levels[level];
+		if (!grid.empty())
+			queryLevel(grid, int(level), rect, function);
+	}
+}
+
+
+template <class T>
+template <class Function>
+void SpatialIndex<T>::queryLevel(const Grid& grid, int level, const QRectF& rect, Function& function) const
+{
+	// A value may be stored in up to four cells. It is reported only from
+	// the cell which contains the top-left corner of the intersection.
+	auto const visit = [this, level, &rect, &function](qint32 x, qint32 y, const Bucket& items) {
+		for (auto const& item : items)
+		{
+			if (!overlaps(item.extent, rect))
+				continue;
+			if (x != cellCoord(qMax(item.extent.left(), rect.left()), level)
+			    || y != cellCoord(qMax(item.extent.top(), rect.top()), level))
+				continue;
+			function(item.value, item.extent);
+		}
+	};
+
+	auto const range = cellRange(rect, level);
+	auto const num_cells = (qint64(range.right) - range.left + 1) * (qint64(range.bottom) - range.top + 1);
+	if (num_cells > qint64(grid.size()))
+	{
+		// Sparse grid: visiting the allocated cells is cheaper.
+		for (auto const& bucket : grid)
+		{
+			auto const x = keyX(bucket.first);
+			auto const y = keyY(bucket.first);
+			if (x >= range.left && x <= range.right && y >= range.top && y <= range.bottom)
+				visit(x, y, bucket.second);
+		}
+	}
+	else
+	{
+		for (auto y = range.top; y <= range.bottom; ++y)
+		{
+			for (auto x = range.left; x <= range.right; ++x)
+			{
+				auto bucket = grid.find(key(x, y));
+				if (bucket != grid.end())
+					visit(x, y, bucket->second);
+			}
+		}
+	}
+}
+
+
+template <class T>
+std::vector<T> SpatialIndex<T>::find(const QRectF& rect) const
+{
+	std::vector<T> result;
+	query(rect, [&result](T value, const QRectF& /*extent*/) {
+		result.push_back(value);
+	});
+	return result;
+}
+
+
+template <class T>
+qreal SpatialIndex<T>::cellSize(int level) const noexcept
+{
+	return std::ldexp(base_cell_size, level);
+}
+
+
+template <class T>
+int SpatialIndex<T>::levelFor(const QRectF& extent) const noexcept
+{
+	auto const size = qMax(extent.width(), extent.height());
+	auto level = 0;
+	while (level < max_level && cellSize(level) < size)
+		++level;
+	return level;
+}
+
+
+template <class T>
+qint32 SpatialIndex<T>::cellCoord(qreal value, int level) const noexcept
+{
+	auto const cell = std::floor(value / cellSize(level));
+	return qint32(qBound(qreal(-max_cell), cell, qreal(max_cell)));
+}
+
+
+template <class T>
+typename SpatialIndex<T>::CellRange SpatialIndex<T>::cellRange(const QRectF& rect, int level) const noexcept
+{
+	return { cellCoord(rect.left(), level), cellCoord(rect.top(), level),
+	         cellCoord(rect.right(), level), cellCoord(rect.bottom(), level) };
+}
+
+
+// static
+template <class T>
+quint64 SpatialIndex<T>::key(qint32 x, qint32 y) noexcept
+{
+	return (quint64(quint32(x)) << 32) | quint64(quint32(y));
+}
+
+
+// static
+template <class T>
+qint32 SpatialIndex<T>::keyX(quint64 key) noexcept
+{
+	return qint32(quint32(key >> 32));
+}
+
+
+// static
+template <class T>
+qint32 SpatialIndex<T>::keyY(quint64 key) noexcept
+{
+	return qint32(quint32(key & 0xffffffffu));
+}
+
+
+// static
+template <class T>
+bool SpatialIndex<T>::overlaps(const QRectF& a, const QRectF& b) noexcept
+{
+	return a.left() <= b.right() && b.left() <= a.right()
+	       && a.top() <= b.bottom() && b.top() <= a.bottom();
+}
+
+
+}  // namespace OpenOrienteering
+
+#endif
@@ -37,7 +37,6 @@
 #include "core/objects/object.h"
 #include "core/renderables/renderable.h"
 #include "core/renderables/renderable_implementation.h"
-#include "core/symbols/line_symbol.h"
 #include "core/symbols/point_symbol.h"
 #include "core/symbols/symbol.h"
 #include "core/virtual_coord_vector.h"
@@ -238,13 +237,13 @@ inline
 void AreaSymbol::FillPattern::createLine<AreaSymbol::FillPattern::LinePattern>(
         MapCoordF first, MapCoordF second,
         qreal,
-        LineSymbol* line,
+        LinePatternRenderable* lines,
         qreal,
         const AreaRenderable&,
-        ObjectRenderables& output ) const
+        const QRectF*,
+        ObjectRenderables& ) const
 {
-	// out of inlining
-	output.insertRenderable(new LineRenderable(line, first, second));
+	lines->addLine(first, second);
 }
 
 
@@ -253,13 +252,14 @@ inline
 void AreaSymbol::FillPattern::createLine<AreaSymbol::FillPattern::PointPattern>(
         MapCoordF first, MapCoordF second,
         qreal delta_offset,
-        LineSymbol*,
+        LinePatternRenderable*,
         qreal rotation,
         const AreaRenderable& outline,
+        const QRectF* point_bounds,
         ObjectRenderables& output ) const
 {
 	// out of inlining
-	createPointPatternLine(first, second, delta_offset, rotation, outline, output);
+	createPointPatternLine(first, second, delta_offset, rotation, outline, point_bounds, output);
 }
 
 
@@ -275,8 +275,9 @@ void AreaSymbol::FillPattern::createRenderables(
         qreal delta_rotation,
         const MapCoord& pattern_origin,
         const QRectF& point_extent,
-        LineSymbol* line,
+        LinePatternRenderable* lines,
         qreal rotation,
+        const QRectF* point_bounds,
         ObjectRenderables& output ) const
 {
 	// Canvas is the entire rectangle which will be filled with renderables.
@@ -315,7 +316,7 @@ void AreaSymbol::FillPattern::createRenderables(
 		{
 			first = MapCoordF(cur, canvas.top());
 			second = MapCoordF(cur, canvas.bottom());
-			createLine<T>(first, second, delta_along_line_offset, line, delta_rotation, outline, output);
+			createLine<T>(first, second, delta_along_line_offset, lines, delta_rotation, outline, point_bounds, output);
 		}
 	}
 	else if (qAbs(rotation - 0) < 0.0001)
@@ -326,7 +327,7 @@ void AreaSymbol::FillPattern::createRenderables(
 		{
 			first = MapCoordF(canvas.left(), cur);
 			second = MapCoordF(canvas.right(), cur);
-			createLine<T>(first, second, delta_along_line_offset, line, delta_rotation, outline, output);
+			createLine<T>(first, second, delta_along_line_offset, lines, delta_rotation, outline, point_bounds, output);
 		}
 	}
 	else
@@ -373,7 +374,7 @@ void AreaSymbol::FillPattern::createRenderables(
 				// Create the renderable(s)
 				first = MapCoordF(start_x, start_y);
 				second = MapCoordF(end_x, end_y);
-				createLine<T>(first, second, delta_along_line_offset, line, delta_rotation, outline, output);
+				createLine<T>(first, second, delta_along_line_offset, lines, delta_rotation, outline, point_bounds, output);
 				
 				// Move to next position
 				start_x += dist_x;
@@ -410,7 +411,7 @@ void AreaSymbol::FillPattern::createRenderables(
 				// Create the renderable(s)
 				first = MapCoordF(start_x, start_y);
 				second = MapCoordF(end_x, end_y);
-				createLine<T>(first, second, delta_along_line_offset, line, delta_rotation, outline, output);
+				createLine<T>(first, second, delta_along_line_offset, lines, delta_rotation, outline, point_bounds, output);
 				
 				// Move to next position
 				start_x += dist_x;
@@ -421,7 +422,7 @@ void AreaSymbol::FillPattern::createRenderables(
 }
 
 
-void AreaSymbol::FillPattern::createRenderables(const AreaRenderable& outline, qreal delta_rotation, const MapCoord& pattern_origin, ObjectRenderables& output) const
+void AreaSymbol::FillPattern::createRenderables(const AreaRenderable& outline, qreal delta_rotation, const MapCoord& pattern_origin, ObjectRenderables& output, bool clip_geometrically) const
 {
 	if (line_spacing <= 0)
 		return;
@@ -438,24 +439,29 @@ void AreaSymbol::FillPattern::createRenderables(const AreaRenderable& outline, q
 	
 	// Handle clipping
 	const auto old_clip_path = output.getClipPath();
-	if (!(flags & Option::AlternativeToClipping))
-	{
+	const auto clip_by_path = !(flags & Option::AlternativeToClipping);
+	if (!clip_by_path)
+		clip_geometrically = false;
+	else if (!clip_geometrically)
 		output.setClipPath(outline.painterPath());
-	}
 	
 	switch (type)
 	{
 	case LinePattern:
 		{
-			LineSymbol line;
-			line.setColor(line_color);
-			
 			auto line_width_f = 0.001*line_width;
-			line.setLineWidth(line_width_f);
-			
 			auto margin = line_width_f / 2;
 			auto point_extent = QRectF{-margin, -margin, line_width_f, line_width_f};
-			createRenderables<LinePattern>(outline, delta_rotation, pattern_origin, point_extent, &line, rotation, output);
+			
+			// All lines go into a single renderable.
+			auto lines = new LinePatternRenderable(line_color, line_width_f, 0.001*line_spacing, clip_by_path && !clip_geometrically);
+			createRenderables<LinePattern>(outline, delta_rotation, pattern_origin, point_extent, lines, rotation, nullptr, output);
+			if (clip_geometrically)
+				lines->clipTo(*outline.painterPath());
+			if (lines->isEmpty())
+				delete lines;
+			else
+				output.insertRenderable(lines);
 		}
 		break;
 	case PointPattern:
@@ -465,7 +471,18 @@ void AreaSymbol::FillPattern::createRenderables(const AreaRenderable& outline, q
 			point_object.setRotation(delta_rotation);
 			point_object.update();
 			auto point_extent = point_object.getExtent();
-			createRenderables<PointPattern>(outline, delta_rotation, pattern_origin, point_extent, nullptr, rotation, output);
+			
+			// A square around the circle which covers the point at any rotation
+			QRectF point_bounds;
+			if (clip_geometrically)
+			{
+				auto radius = qMax(MapCoordF(point_extent.topLeft()).length(), MapCoordF(point_extent.bottomRight()).length());
+				radius = qMax(radius, MapCoordF(point_extent.topRight()).length());
+				radius = qMax(radius, MapCoordF(point_extent.bottomLeft()).length());
+				point_bounds = QRectF(-radius, -radius, 2 * radius, 2 * radius);
+			}
+			createRenderables<PointPattern>(outline, delta_rotation, pattern_origin, point_extent, nullptr, rotation,
+			                                clip_geometrically ? &point_bounds : nullptr, output);
 		}
 		break;
 	}
@@ -479,6 +496,7 @@ void AreaSymbol::FillPattern::createPointPatternLine(
         qreal delta_offset,
         qreal rotation,
         const AreaRenderable& outline,
+        const QRectF* point_bounds,
         ObjectRenderables& output ) const
 {
 	auto direction = second - first;
@@ -504,6 +522,25 @@ void AreaSymbol::FillPattern::createPointPatternLine(
 			point->createRenderablesIfCompletelyInside(coord, -rotation, outline.painterPath(), output);
 		break;
 	case Option::Default:
+		if (point_bounds)
+		{
+			// Only points crossing the outline need the clip path.
+			const auto* area = outline.painterPath();
+			const auto* outer_clip_path = output.getClipPath();
+			for (auto cur = start_length; cur < length; cur += step_length, coord += to_next)
+			{
+				auto const bounds = point_bounds->translated(coord);
+				if (area->contains(bounds))
+					output.setClipPath(outer_clip_path);
+				else if (area->intersects(bounds))
+					output.setClipPath(area);
+				else
+					continue;
+				point->createRenderablesScaled(coord, -rotation, output);
+			}
+			output.setClipPath(outer_clip_path);
+			break;
+		}
 #if 1
 		// Avoids expensive check, but may create objects which won't be rendered.
 		for (auto cur = start_length; cur < length; cur += step_length, coord += to_next)
@@ -619,9 +656,9 @@ void AreaSymbol::createRenderables(
         ObjectRenderables &output,
         Symbol::RenderableOptions options) const
 {
-	if (options == Symbol::RenderNormal)
+	if (!(options & (Symbol::RenderBaselines | Symbol::RenderAreasHatched)))
 	{
-		createRenderablesNormal(object, path_parts, output);
+		createRenderablesNormal(object, path_parts, output, options);
 	}
 	else
 	{
@@ -638,7 +675,8 @@ void AreaSymbol::createRenderables(
 void AreaSymbol::createRenderablesNormal(
         const PathObject* object,
         const PathPartVector& path_parts,
-        ObjectRenderables& output) const
+        ObjectRenderables& output,
+        Symbol::RenderableOptions options) const
 {
 	// The shape output is even created if the area is not filled with a color
 	// because the QPainterPath created by it is needed as clip path for the fill objects
@@ -649,7 +687,7 @@ void AreaSymbol::createRenderablesNormal(
 	auto origin = object->getPatternOrigin();
 	for (const auto& pattern : patterns)
 	{
-		pattern.createRenderables(*color_fill, rotation, origin, output);
+		pattern.createRenderables(*color_fill, rotation, origin, output, options.testFlag(Symbol::RenderPatternsClipped));
 	}
 }
 
@@ -692,7 +730,8 @@ void AreaSymbol::createHatchingRenderables(
 			}
 		}
 		
-		area_symbol.createRenderablesNormal(object, path_parts, output);
+		// Hatching lines are always clipped when they are created.
+		area_symbol.createRenderablesNormal(object, path_parts, output, Symbol::RenderPatternsClipped);
 	}
 }
 
@@ -718,6 +757,18 @@ bool AreaSymbol::containsColor(const MapColor* color) const
 }
 
 
+std::vector<const Symbol*> AreaSymbol::subSymbols() const
+{
+	std::vector<const Symbol*> result;
+	for (const auto& pattern : patterns)
+	{
+		if (pattern.type == FillPattern::PointPattern && pattern.point)
+			result.push_back(pattern.point);
+	}
+	return result;
+}
+
+
 const MapColor* AreaSymbol::guessDominantColor() const
 {
 	auto color = this->color;
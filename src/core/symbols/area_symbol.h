@@ -40,6 +40,7 @@ class QXmlStreamWriter;
 namespace OpenOrienteering {
 
 class AreaRenderable;
+class LinePatternRenderable;
 class LineSymbol;
 class Map;
 class MapColor;
@@ -184,23 +185,33 @@ public:
 		 * @param delta_rotation Rotation offset which is added to the pattern angle.
 		 * @param pattern_origin Origin point for line / point placement.
 		 * @param output Created renderables will be inserted here.
+		 * @param clip_geometrically If true, pattern lines are clipped to the
+		 *        outline when they are created, and only pattern points which
+		 *        cross the outline need a clip path.
 		 */
 		void createRenderables(
 			const AreaRenderable& outline,
 			qreal delta_rotation,
 			const MapCoord& pattern_origin,
-			ObjectRenderables& output
+			ObjectRenderables& output,
+			bool clip_geometrically = false
 		) const;
 		
-		/** Does the heavy-lifting in loops over lines. */
+		/**
+		 * Does the heavy-lifting in loops over lines.
+		 * 
+		 * When point_bounds is not null, point patterns are clipped
+		 * geometrically, cf. createPointPatternLine().
+		 */
 		template <int type>
 		void createRenderables(
 			const AreaRenderable& outline,
 			qreal delta_rotation,
 			const MapCoord& pattern_origin,
 			const QRectF& point_extent,
-			LineSymbol* line,
+			LinePatternRenderable* lines,
 			qreal rotation,
+			const QRectF* point_bounds,
 			ObjectRenderables& output
 		) const;
 		
@@ -209,18 +220,28 @@ public:
 		void createLine(
 			MapCoordF first, MapCoordF second,
 			qreal delta_offset,
-			LineSymbol* line,
+			LinePatternRenderable* lines,
 			qreal rotation,
 			const AreaRenderable& outline,
+			const QRectF* point_bounds,
 			ObjectRenderables& output
 		) const;
 		
-		/** Creates a single line of renderables for a PointPattern. */
+		/**
+		 * Creates a single line of renderables for a PointPattern.
+		 * 
+		 * When point_bounds is not null, it must contain a point's extent
+		 * relative to its position, for any rotation. Then points which are
+		 * outside of the outline are skipped, points inside of the outline
+		 * are created without clip path, and only the remaining points are
+		 * clipped by the outline.
+		 */
 		void createPointPatternLine(
 			MapCoordF first, MapCoordF second,
 			qreal delta_offset,
 			qreal rotation,
 			const AreaRenderable& outline,
+			const QRectF* point_bounds,
 			ObjectRenderables& output
 		) const;
 		
@@ -252,10 +273,16 @@ public:
 	        ObjectRenderables &output,
 	        Symbol::RenderableOptions options) const override;
 	
+	/**
+	 * Creates the regular renderables for a path object.
+	 * 
+	 * Only the Symbol::RenderPatternsClipped flag of the options is used.
+	 */
 	void createRenderablesNormal(
 	        const PathObject* object,
 	        const PathPartVector& path_parts,
-	        ObjectRenderables& output) const;
+	        ObjectRenderables& output,
+	        Symbol::RenderableOptions options = Symbol::RenderNormal) const;
 	
 	/**
 	 * Creates area hatching renderables for a path object.
@@ -271,6 +298,7 @@ public:
 	bool containsColor(const MapColor* color) const override;
 	const MapColor* guessDominantColor() const override;
 	void replaceColors(const MapColorMap& color_map) override;
+	std::vector<const Symbol*> subSymbols() const override;
 	void scale(double factor) override;
 	
 	qreal dimensionForIcon() const override;
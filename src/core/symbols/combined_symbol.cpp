@@ -40,6 +40,7 @@
 #include "core/map.h"
 #include "core/map_color.h"
 #include "core/objects/object.h"
+#include "core/renderables/renderable_implementation.h"
 #include "core/symbols/symbol.h"
 
 
@@ -107,6 +108,8 @@ void CombinedSymbol::createRenderables(
         ObjectRenderables &output,
         Symbol::RenderableOptions options) const
 {
+	// The parts share the path parts, and plain line parts share their painter paths.
+	LinePathSharing path_sharing;
 	for (auto subsymbol : parts)
 	{
 		if (subsymbol)
@@ -215,6 +218,14 @@ bool CombinedSymbol::containsSymbol(const Symbol* symbol) const
 	return false;
 }
 
+std::vector<const Symbol*> CombinedSymbol::subSymbols() const
+{
+	std::vector<const Symbol*> result;
+	result.reserve(parts.size());
+	std::copy_if(begin(parts), end(parts), std::back_inserter(result), [](auto part) { return part != nullptr; });
+	return result;
+}
+
 void CombinedSymbol::scale(double factor)
 {
 	auto is_private = begin(private_parts);
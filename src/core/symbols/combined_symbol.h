@@ -88,6 +88,7 @@ public:
 	void replaceColors(const MapColorMap& color_map) override;
 	bool symbolChangedEvent(const Symbol* old_symbol, const Symbol* new_symbol) override;
 	bool containsSymbol(const Symbol* symbol) const override;
+	std::vector<const Symbol*> subSymbols() const override;
 	void scale(double factor) override;
 	TypeCombination getContainedTypes() const override;
 	
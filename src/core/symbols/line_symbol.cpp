@@ -23,6 +23,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstddef>
 #include <initializer_list>
 #include <iterator>
 #include <memory>
@@ -129,6 +130,30 @@ bool equalDimensions(const LineSymbolBorder& lhs, const LineSymbolBorder& rhs)
 	               && lhs.break_length == rhs.break_length) );
 }
 
+
+/**
+ * Reusable coordinate buffers for border lines.
+ * 
+ * Border lines are created for every update of objects with roads and
+ * double lines. Reusing the buffers avoids repeated allocations. Objects
+ * are updated concurrently, so each thread has its own buffers.
+ */
+struct BorderBuffers
+{
+	MapCoordVector flags;
+	MapCoordVectorF coords;
+	MapCoordVector dashed_flags;
+	MapCoordVectorF dashed_coords;
+};
+
+BorderBuffers& borderBuffers()
+{
+	thread_local BorderBuffers buffers;
+	buffers.dashed_flags.clear();
+	buffers.dashed_coords.clear();
+	return buffers;
+}
+
 }  // namespace
 
 bool LineSymbolBorder::equals(const LineSymbolBorder& other) const
@@ -304,9 +329,10 @@ void LineSymbol::createSinglePathRenderables(const VirtualPath& path, bool path_
 	if (!use_offset && !dashed)
 	{
 		// This is a simple plain line (no pointed line ends, no dashes).
-		// It may be drawn directly from the given path.
+		// It may be drawn directly from the given path, sharing the painter
+		// path with other parts of a combined symbol.
 		if (create_line)
-			output.insertRenderable(new LineRenderable(this, path, path_closed));
+			output.insertRenderable(new LineRenderable(this, path, path_closed, true));
 		
 		auto create_mid_symbols = mid_symbol && !mid_symbol->isEmpty() && segment_length > 0;
 		if (create_mid_symbols || create_border)
@@ -403,7 +429,12 @@ void LineSymbol::createSinglePathRenderables(const VirtualPath& path, bool path_
 	if ((create_line || create_border) && processed_coords.size() > 1)
 	{
 		VirtualPath processed_path = { processed_flags, processed_coords };
-		processed_path.path_coords.update(path.first_index);
+		// LineRenderable needs the path coords only for curves.
+		if (create_border
+		    || std::any_of(begin(processed_flags), end(processed_flags), [](const MapCoord& flags) { return flags.isCurveStart(); }))
+		{
+			processed_path.path_coords.update(path.first_index);
+		}
 		if (create_line)
 		{
 			output.insertRenderable(new LineRenderable(this, processed_path, path_closed));
@@ -427,16 +458,15 @@ void LineSymbol::createBorderLines(
 	const auto main_shift = 0.0005 * line_width;
 	const auto path_closed = path.isClosed();
 	
-	MapCoordVector border_flags;
-	MapCoordVectorF border_coords;
+	// The buffers are shared between symmetrical dashed borders,
+	// and reused for different dash patterns and between calls.
+	auto& buffers = borderBuffers();
+	auto& border_flags = buffers.flags;
+	auto& border_coords = buffers.coords;
 	
 	auto border_dashed = false;
-	// The following variables are needed for dashed borders only, but default
-	// initialization should be cheap enough so that we can always create them
-	// on the stack for easy sharing of state between symmetrical dashed borders,
-	// and even for reusing allocated memory in case of different dash patterns.
-	MapCoordVector dashed_flags;
-	MapCoordVectorF dashed_coords;
+	auto& dashed_flags = buffers.dashed_flags;
+	auto& dashed_coords = buffers.dashed_coords;
 	
 	LineSymbol border_symbol;
 	border_symbol.setJoinStyle(join_style == RoundJoin ? RoundJoin : MiterJoin);
@@ -511,7 +541,8 @@ void LineSymbol::shiftCoordinates(const VirtualPath& path, double main_shift, do
 	// sign of shift and main shift indicates left or right border
 	auto const shift = main_shift + border_shift;
 	
-	auto size = path.size();
+	// Outer corners add up to two points.
+	auto size = 3 * path.size();
 	out_flags.clear();
 	out_coords.clear();
 	out_flags.reserve(size);
@@ -1013,7 +1044,12 @@ void LineSymbol::processDashedLine(
 	auto& path_coords = path.path_coords;
 	Q_ASSERT(!path_coords.empty());
 	
-	auto out_coords_size = path.size() * 4;
+	// Each dash adds a start and an end, and up to two split curves.
+	auto const group_length = length_type(0.001) * (dashes_in_group * dash_length
+	                                                 + (dashes_in_group - 1) * in_group_break_length
+	                                                 + break_length);
+	auto const num_dashes = (group_length > 0) ? std::size_t((end.clen - start.clen) / group_length + 2) * std::size_t(qMax(1, dashes_in_group)) : 0;
+	auto out_coords_size = path.size() + 4 * num_dashes;
 	out_flags.reserve(out_coords_size);
 	out_coords.reserve(out_coords_size);
 	
@@ -1548,6 +1584,17 @@ bool LineSymbol::containsColor(const MapColor* color) const
     return false;
 }
 
+std::vector<const Symbol*> LineSymbol::subSymbols() const
+{
+	std::vector<const Symbol*> result;
+	for (const auto* symbol : { start_symbol, mid_symbol, end_symbol, dash_symbol })
+	{
+		if (symbol)
+			result.push_back(symbol);
+	}
+	return result;
+}
+
 const MapColor* LineSymbol::guessDominantColor() const
 {
 	bool has_main_line = line_width > 0 && color;
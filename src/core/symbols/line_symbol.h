@@ -162,6 +162,7 @@ public:
 	bool containsColor(const MapColor* color) const override;
 	const MapColor* guessDominantColor() const override;
 	void replaceColors(const MapColorMap& color_map) override;
+	std::vector<const Symbol*> subSymbols() const override;
 	void scale(double factor) override;
 	
 	/**
@@ -22,6 +22,7 @@
 #include "point_symbol.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <cstddef>
 #include <iterator>
@@ -30,6 +31,7 @@
 
 #include <QtMath>
 #include <QLatin1String>
+#include <QMutexLocker>
 #include <QPainterPath>
 #include <QRectF>
 #include <QString>
@@ -44,6 +46,8 @@
 #include "core/objects/object.h"
 #include "core/renderables/renderable.h"
 #include "core/renderables/renderable_implementation.h"
+#include "core/symbols/area_symbol.h"
+#include "core/symbols/line_symbol.h"
 #include "core/symbols/symbol.h"
 #include "core/virtual_coord_vector.h"
 #include "util/util.h"
@@ -55,6 +59,74 @@
 
 namespace OpenOrienteering {
 
+namespace {
+
+/**
+ * The current generation of prototypes.
+ * 
+ * Prototypes from other generations are outdated.
+ */
+std::atomic<unsigned int> prototype_generation { 0 };
+
+
+/**
+ * Returns true if the symbol's renderables for an object can be created by
+ * translating the renderables for the object at another position.
+ * 
+ * This is not the case for area symbols with fill patterns: The patterns are
+ * aligned to the map, and they use the area renderable as clip path.
+ */
+bool isTranslationInvariant(const Symbol* symbol)
+{
+	if (!symbol)
+		return true;
+	
+	switch (symbol->getType())
+	{
+	case Symbol::Point:
+		{
+			auto const* point = static_cast<const PointSymbol*>(symbol);
+			for (int i = 0; i < point->getNumElements(); ++i)
+			{
+				if (!isTranslationInvariant(point->getElementSymbol(i)))
+					return false;
+			}
+			return true;
+		}
+	case Symbol::Line:
+		{
+			auto const* line = static_cast<const LineSymbol*>(symbol);
+			return isTranslationInvariant(line->getStartSymbol())
+			       && isTranslationInvariant(line->getMidSymbol())
+			       && isTranslationInvariant(line->getEndSymbol())
+			       && isTranslationInvariant(line->getDashSymbol());
+		}
+	case Symbol::Area:
+		return static_cast<const AreaSymbol*>(symbol)->getNumFillPatterns() == 0;
+	default:
+		return false;
+	}
+}
+
+}  // namespace
+
+
+
+/**
+ * The renderables of a point symbol at the origin, without rotation.
+ */
+struct PointSymbol::Prototype
+{
+	unsigned int generation;
+	bool usable;
+	PointObject object;
+	ObjectRenderables renderables { object };
+	
+	Prototype(unsigned int generation, bool usable) : generation(generation), usable(usable) {}
+};
+
+
+
 PointSymbol::PointSymbol() noexcept
 : Symbol { Symbol::Point }
 , inner_color { nullptr }
@@ -113,17 +185,11 @@ void PointSymbol::createRenderables(
 	
 	if (options.testFlag(Symbol::RenderBaselines))
 	{
+		// The shared undefined point symbol only provides the dot size.
+		// It must not be modified: objects are updated concurrently.
 		const MapColor* dominant_color = guessDominantColor();
 		if (dominant_color)
-		{
-			PointSymbol* point = Map::getUndefinedPoint();
-			const MapColor* temp_color = point->getInnerColor();
-			point->setInnerColor(dominant_color);
-			
-			point->createRenderablesScaled(coords[0], rotation, output);
-			
-			point->setInnerColor(temp_color);
-		}
+			output.insertRenderable(new DotRenderable(Map::getUndefinedPoint(), dominant_color, coords[0]));
 	}
 	else
 	{
@@ -132,6 +198,21 @@ void PointSymbol::createRenderables(
 }
 
 void PointSymbol::createRenderablesScaled(const MapCoordF& coord, qreal rotation, ObjectRenderables& output, qreal coord_scale) const
+{
+	// Symbols without elements are cheap enough to create directly.
+	if (!elements.empty() && qIsNull(rotation) && coord_scale == 1)
+	{
+		if (auto const instance = prototype())
+		{
+			output.insertTranslated(instance->renderables, coord);
+			return;
+		}
+	}
+	
+	createRenderablesDirectly(coord, rotation, output, coord_scale);
+}
+
+void PointSymbol::createRenderablesDirectly(const MapCoordF& coord, qreal rotation, ObjectRenderables& output, qreal coord_scale) const
 {
 	if (inner_color && inner_radius > 0)
 		output.insertRenderable(new DotRenderable(this, coord));
@@ -176,6 +257,30 @@ void PointSymbol::createRenderablesScaled(const MapCoordF& coord, qreal rotation
 }
 
 
+// static
+void PointSymbol::invalidatePrototypes()
+{
+	++prototype_generation;
+}
+
+std::shared_ptr<const PointSymbol::Prototype> PointSymbol::prototype() const
+{
+	auto const generation = prototype_generation.load();
+	
+	QMutexLocker lock(&prototype_mutex);
+	if (!cached_prototype || cached_prototype->generation != generation)
+	{
+		auto prototype = std::make_shared<Prototype>(generation, isTranslationInvariant(this));
+		if (prototype->usable)
+			createRenderablesDirectly(MapCoordF{0, 0}, 0, prototype->renderables, 1);
+		cached_prototype = std::move(prototype);
+	}
+	if (!cached_prototype->usable)
+		return {};
+	return cached_prototype;
+}
+
+
 void PointSymbol::createRenderablesIfCenterInside(const MapCoordF& point_coord, qreal rotation, const QPainterPath* outline, ObjectRenderables& output) const
 {
 	if (outline->contains(point_coord))
@@ -497,6 +602,15 @@ bool PointSymbol::containsColor(const MapColor* color) const
 	});
 }
 
+std::vector<const Symbol*> PointSymbol::subSymbols() const
+{
+	std::vector<const Symbol*> result;
+	result.reserve(elements.size());
+	for (const auto& element : elements)
+		result.push_back(element.symbol.get());
+	return result;
+}
+
 const MapColor* PointSymbol::guessDominantColor() const
 {
 	bool have_inner_color = inner_color && inner_radius > 0;
@@ -527,6 +641,8 @@ void PointSymbol::replaceColors(const MapColorMap& color_map)
 	outer_color = color_map.value(outer_color);
 	for (auto& element : elements)
 		element.symbol->replaceColors(color_map);
+	
+	invalidatePrototypes();
 }
 
 
@@ -27,6 +27,7 @@
 
 #include <Qt>
 #include <QtGlobal>
+#include <QMutex>
 
 #include "symbol.h"
 
@@ -84,6 +85,16 @@ public:
 	
 	void createRenderablesScaled(const MapCoordF& coord, qreal rotation, ObjectRenderables& output, qreal coord_scale = 1) const;
 	
+	/**
+	 * Marks the prototype renderables of all point symbols as outdated.
+	 * 
+	 * Point symbols with elements cache their renderables at the origin and
+	 * create unrotated instances by translation. The cached renderables depend
+	 * on the symbol's settings, on its elements, and on the map's colors.
+	 * This function must be called after changing any of these.
+	 */
+	static void invalidatePrototypes();
+	
 	void createRenderablesIfCenterInside(const MapCoordF& point_coord, qreal rotation, const QPainterPath* outline, ObjectRenderables& output) const;
 	void createPrimitivesIfCompletelyInside(const MapCoordF& point_coord, const QPainterPath* outline, ObjectRenderables& output) const;
 	void createRenderablesIfCompletelyInside(const MapCoordF& point_coord, qreal rotation, const QPainterPath* outline, ObjectRenderables& output) const;
@@ -94,6 +105,7 @@ public:
 	bool containsColor(const MapColor* color) const override;
 	const MapColor* guessDominantColor() const override;
 	void replaceColors(const MapColorMap& color_map) override;
+	std::vector<const Symbol*> subSymbols() const override;
 	void scale(double factor) override;
 	
 	qreal dimensionForIcon() const override;
@@ -146,6 +158,21 @@ protected:
 	bool loadImpl(QXmlStreamReader& xml, const Map& map, SymbolDictionary& symbol_dict, int version) override;
 	bool equalsImpl(const Symbol* other, Qt::CaseSensitivity case_sensitivity) const override;
 	
+	/**
+	 * Creates the renderables without using the prototype.
+	 */
+	void createRenderablesDirectly(const MapCoordF& coord, qreal rotation, ObjectRenderables& output, qreal coord_scale) const;
+	
+	struct Prototype;
+	
+	/**
+	 * Returns the current prototype, creating it if necessary.
+	 * 
+	 * Returns nullptr if the elements cannot be instantiated by translation.
+	 * This function is thread-safe.
+	 */
+	std::shared_ptr<const Prototype> prototype() const;
+	
 	
 	/// \todo Expose elements more directly in PointSymbol API.
 	struct Element
@@ -159,6 +186,9 @@ protected:
 	const MapColor* outer_color;
 	int inner_radius;		// in 1/1000 mm
 	int outer_width;		// in 1/1000 mm
+	
+	mutable std::shared_ptr<const Prototype> cached_prototype;
+	mutable QMutex prototype_mutex;
 };
 
 
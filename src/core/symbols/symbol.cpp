@@ -38,6 +38,7 @@
 #include <QPoint>
 #include <QPointF>
 #include <QRectF>
+#include <QSize>
 #include <QStringRef>
 #include <QVariant>
 #include <QXmlStreamReader>
@@ -55,6 +56,7 @@
 #include "core/symbols/combined_symbol.h"
 #include "core/symbols/line_symbol.h"
 #include "core/symbols/point_symbol.h"
+#include "core/symbols/symbol_icon_cache.h"
 #include "core/symbols/text_symbol.h"
 #include "fileformats/file_format.h"
 #include "fileformats/file_import_export.h"
@@ -453,6 +455,12 @@ bool Symbol::containsSymbol(const Symbol* /*symbol*/) const
 }
 
 
+std::vector<const Symbol*> Symbol::subSymbols() const
+{
+	return {};
+}
+
+
 
 void Symbol::setCustomIcon(const QImage& image)
 {
@@ -466,16 +474,38 @@ QImage Symbol::getIcon(const Map* map) const
 	if (icon.isNull())
 	{
 		auto size = Settings::getInstance().getSymbolWidgetIconSizePx();
-		if (Settings::getInstance().getSetting(Settings::SymbolWidget_ShowCustomIcons).toBool()
-		    && !custom_icon.isNull())
+		auto use_custom_icon = Settings::getInstance().getSetting(Settings::SymbolWidget_ShowCustomIcons).toBool();
+		if (map)
+			prepareIcon(*map, size, use_custom_icon);
+		else if (use_custom_icon && !custom_icon.isNull())
 			icon = custom_icon.scaled(size, size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
-		else if (map)
-			icon = createIcon(*map, size);
 	}
 	return icon;
 }
 
 
+void Symbol::prepareIcon(const Map& map, int side_length, bool use_custom_icon) const
+{
+	if (!icon.isNull())
+		return;
+	
+	if (use_custom_icon && !custom_icon.isNull())
+	{
+		icon = custom_icon.scaled(side_length, side_length, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+		return;
+	}
+	
+	auto const zoom = map.symbolIconZoom();
+	auto const key = SymbolIconCache::key(*this, map, side_length, zoom);
+	icon = SymbolIconCache::load(key);
+	if (icon.size() != QSize(side_length, side_length))
+	{
+		icon = createIcon(map, side_length, true, zoom);
+		SymbolIconCache::store(key, icon);
+	}
+}
+
+
 QImage Symbol::createIcon(const Map& map, int side_length, bool antialiasing, qreal zoom) const
 {
 	// Desktop default used to be 2x zoom at 8 mm side length, plus/minus
@@ -824,6 +854,8 @@ QImage Symbol::createIcon(const Map& map, int side_length, bool antialiasing, qr
 void Symbol::resetIcon()
 {
 	icon = {};
+	// The icon is reset whenever the symbol's appearance changes.
+	PointSymbol::invalidatePrototypes();
 }
 
 
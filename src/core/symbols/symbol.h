@@ -96,6 +96,7 @@ public:
 	{
 		RenderBaselines    = 1 << 0,   ///< Paint cosmetique contours and baselines
 		RenderAreasHatched = 1 << 1,   ///< Paint hatching instead of opaque fill
+		RenderPatternsClipped = 1 << 2,  ///< Clip area fill patterns geometrically instead of by clip paths
 		RenderNormal       = 0         ///< Paint normally
 	};
 	Q_DECLARE_FLAGS(RenderableOptions, RenderableOption)
@@ -337,6 +338,16 @@ public:
 	 */
 	virtual bool containsSymbol(const Symbol* symbol) const;
 	
+	/**
+	 * Returns the symbols which are used directly for drawing this symbol.
+	 * 
+	 * These are the parts of combined symbols, the start, mid, end and dash
+	 * symbols of line symbols, the point symbols of area fill patterns, and
+	 * the element symbols of point symbols. Most of them are owned by this
+	 * symbol, but combined symbols may also use other symbols of the map.
+	 */
+	virtual std::vector<const Symbol*> subSymbols() const;
+	
 	
 	/**
 	 * Scales the symbol.
@@ -371,6 +382,22 @@ public:
 	 */
 	QImage getIcon(const Map* map) const;
 	
+	/**
+	 * Creates the symbol's cached icon unless it already exists.
+	 * 
+	 * Generated icons are looked up in the persistent SymbolIconCache first,
+	 * and stored there after creation. This function does not access the
+	 * settings or modify the map, so it may be called concurrently for
+	 * different symbols of the same map, provided that the map's
+	 * symbolIconZoom() is up-to-date.
+	 */
+	void prepareIcon(const Map& map, int side_length, bool use_custom_icon) const;
+	
+	/**
+	 * Returns true if the symbol's icon is cached.
+	 */
+	bool hasIcon() const { return !icon.isNull(); }
+	
 	/**
 	 * Creates a symbol icon with the given side length (pixels).
 	 * 
@@ -389,6 +416,11 @@ public:
 	 */
 	void resetIcon();
 	
+	/**
+	 * Returns the memory used by the cached icon, in bytes.
+	 */
+	qint64 iconMemoryUsage() const { return qint64(icon.bytesPerLine()) * icon.height(); }
+	
 	/**
 	 * Returns the dimension which shall considered when scaling the icon.
 	 */
@@ -0,0 +1,110 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "symbol_icon_cache.h"
+
+#include <QtGlobal>
+#include <QBuffer>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QIODevice>
+#include <QLatin1Char>
+#include <QLatin1String>
+#include <QRgb>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QXmlStreamWriter>
+
+#include "mapper_config.h"
+#include "core/map.h"
+#include "core/map_color.h"
+#include "core/symbols/symbol.h"
+
+
+namespace OpenOrienteering {
+
+// static
+QByteArray SymbolIconCache::key(const Symbol& symbol, const Map& map, int side_length, qreal zoom)
+{
+	QCryptographicHash hash(QCryptographicHash::Sha1);
+	
+	QByteArray definition;
+	{
+		QBuffer buffer(&definition);
+		buffer.open(QIODevice::WriteOnly);
+		QXmlStreamWriter xml(&buffer);
+		symbol.save(xml, map);
+	}
+	hash.addData(definition);
+	
+	QByteArray parameters;
+	{
+		QDataStream stream(&parameters, QIODevice::WriteOnly);
+		stream << QByteArray(APP_VERSION) << qint32(side_length) << double(zoom)
+		       << quint32(map.getScaleDenominator());
+		for (int i = 0; i < map.getNumColors(); ++i)
+		{
+			const auto* color = map.getColor(i);
+			if (symbol.containsColor(color))
+				stream << qint32(i) << qint32(color->getPriority())
+				       << quint32(QRgb(*color)) << double(color->getOpacity());
+		}
+	}
+	hash.addData(parameters);
+	
+	return hash.result().toHex();
+}
+
+// static
+QImage SymbolIconCache::load(const QByteArray& key)
+{
+	QImage icon;
+	if (!icon.load(path(key), "PNG"))
+		return {};
+	return icon.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+}
+
+// static
+void SymbolIconCache::store(const QByteArray& key, const QImage& icon)
+{
+	if (icon.isNull() || !QDir().mkpath(directory()))
+		return;
+	
+	QSaveFile file(path(key));
+	if (file.open(QIODevice::WriteOnly) && icon.save(&file, "PNG"))
+		file.commit();
+}
+
+// static
+QString SymbolIconCache::directory()
+{
+	return QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+	       + QLatin1String("/symbol-icons");
+}
+
+// static
+QString SymbolIconCache::path(const QByteArray& key)
+{
+	return directory() + QLatin1Char('/') + QString::fromLatin1(key) + QLatin1String(".png");
+}
+
+
+}  // namespace OpenOrienteering
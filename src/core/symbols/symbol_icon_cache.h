@@ -0,0 +1,81 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef OPENORIENTEERING_SYMBOL_ICON_CACHE_H
+#define OPENORIENTEERING_SYMBOL_ICON_CACHE_H
+
+#include <QtGlobal>
+#include <QByteArray>
+#include <QImage>
+#include <QString>
+
+
+namespace OpenOrienteering {
+
+class Map;
+class Symbol;
+
+
+/**
+ * A persistent cache of generated symbol icons.
+ * 
+ * Icons are stored as PNG files in the application's cache directory, so
+ * that they are available immediately when a map is opened again. They are
+ * identified by a hash of everything which determines their appearance:
+ * the symbol definition, the definitions of the colors which the symbol
+ * uses, the icon size and zoom, the map scale, and the program version.
+ * 
+ * The functions may be called from any thread.
+ */
+class SymbolIconCache
+{
+public:
+	/**
+	 * Returns the key for the icon of the given symbol.
+	 * 
+	 * The symbol must be a symbol of the map, or of its symbol set.
+	 */
+	static QByteArray key(const Symbol& symbol, const Map& map, int side_length, qreal zoom);
+	
+	/**
+	 * Returns the icon for the given key, or a null image.
+	 */
+	static QImage load(const QByteArray& key);
+	
+	/**
+	 * Stores the icon for the given key.
+	 * 
+	 * Failure is silently ignored.
+	 */
+	static void store(const QByteArray& key, const QImage& icon);
+	
+	/**
+	 * Returns the path of the directory which holds the cached icons.
+	 */
+	static QString directory();
+	
+private:
+	static QString path(const QByteArray& key);
+};
+
+
+}  // namespace OpenOrienteering
+
+#endif  // OPENORIENTEERING_SYMBOL_ICON_CACHE_H
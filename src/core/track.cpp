@@ -21,12 +21,15 @@
 
 #include "track.h"
 
+#include <iterator>
 #include <memory>
+#include <vector>
 
 #include <Qt>
 #include <QtGlobal>
 #include <QtNumeric>
 #include <QApplication>
+#include <QByteArray>
 #include <QFile>
 #include <QFileInfo>  // IWYU pragma: keep
 #include <QIODevice>
@@ -318,8 +321,6 @@ bool Track::loadGpxFrom(QIODevice& device, bool project_points)
 			{
 				point = TrackPoint{LatLon{stream.attributes().value(QLatin1String("lat")).toDouble(),
 				                          stream.attributes().value(QLatin1String("lon")).toDouble()}};
-				if (project_points)
-					point.map_coord = map_georef.toMapCoordF(point.latlon); // TODO: check for errors
 				point_name.clear();
 			}
 			else if (stream.name().compare(QLatin1String("trkseg"), Qt::CaseInsensitive) == 0
@@ -361,16 +362,29 @@ bool Track::loadGpxFrom(QIODevice& device, bool project_points)
 		segment_starts.pop_back();
 	}
 	
+	// Projecting all points at once is much faster than one by one.
+	if (project_points)
+		projectPoints();
+	
 	return !stream.hasError();
 }
 
 void Track::projectPoints()
 {
+	std::vector<LatLon> lat_lon;
+	lat_lon.reserve(waypoints.size() + segment_points.size());
+	for (auto const& waypoint : waypoints)
+		lat_lon.push_back(waypoint.latlon);
+	for (auto const& segment_point : segment_points)
+		lat_lon.push_back(segment_point.latlon);
+	
 	/// \todo Check for errors from Georeferencing::toMapCoordF()
+	auto const map_coords = map_georef.toMapCoordF(lat_lon);
+	auto map_coord = begin(map_coords);
 	for (auto& waypoint : waypoints)
-		waypoint.map_coord = map_georef.toMapCoordF(waypoint.latlon, nullptr); 
+		waypoint.map_coord = *map_coord++;
 	for (auto& segment_point : segment_points)
-		segment_point.map_coord = map_georef.toMapCoordF(segment_point.latlon, nullptr); 
+		segment_point.map_coord = *map_coord++;
 }
 
 
@@ -384,4 +398,128 @@ bool operator==(const Track& lhs, const Track& rhs)
 }
 
 
+
+// ### TrackJournal ###
+
+/*
+ * Journal lines:
+ * 
+ *   p <latitude> <longitude> <elevation> <hDOP> <msecs since epoch>
+ *   s
+ * 
+ * The first form is a track point, the second one finishes the current
+ * segment. Invalid attributes are written as "-". Incomplete lines,
+ * e.g. from a crash while writing, are ignored.
+ */
+
+namespace {
+
+QByteArray journalNumber(float value)
+{
+	return qIsNaN(value) ? QByteArray("-") : QByteArray::number(double(value), 'g', 7);
+}
+
+float journalFloat(const QByteArray& field)
+{
+	bool ok = false;
+	auto const value = field.toFloat(&ok);
+	return ok ? value : NAN;
+}
+
+}  // namespace
+
+
+// static
+QString TrackJournal::pathFor(const QString& track_path)
+{
+	return track_path + QLatin1String(".journal");
+}
+
+// static
+int TrackJournal::recover(const QString& track_path, Track& track)
+{
+	QFile file(pathFor(track_path));
+	if (!file.open(QIODevice::ReadOnly))
+		return 0;
+	
+	auto count = 0;
+	while (!file.atEnd())
+	{
+		auto line = file.readLine();
+		if (!line.endsWith('\n'))
+			break;
+		
+		auto const fields = line.trimmed().split(' ');
+		if (fields.front() == "s")
+		{
+			track.finishCurrentSegment();
+		}
+		else if (fields.front() == "p" && fields.size() == 6)
+		{
+			bool lat_ok = false;
+			bool lon_ok = false;
+			auto const latitude = fields[1].toDouble(&lat_ok);
+			auto const longitude = fields[2].toDouble(&lon_ok);
+			if (!lat_ok || !lon_ok)
+				continue;
+			
+			auto point = TrackPoint { LatLon(latitude, longitude) };
+			point.elevation = journalFloat(fields[3]);
+			point.hDOP = journalFloat(fields[4]);
+			bool time_ok = false;
+			auto const msecs = fields[5].toLongLong(&time_ok);
+			if (time_ok)
+				point.datetime = QDateTime::fromMSecsSinceEpoch(msecs, Qt::UTC);
+			track.appendTrackPoint(point);
+			++count;
+		}
+	}
+	return count;
+}
+
+
+TrackJournal::TrackJournal(const QString& track_path)
+: file(pathFor(track_path))
+{}
+
+TrackJournal::~TrackJournal() = default;
+
+bool TrackJournal::append(const TrackPoint& point)
+{
+	QByteArray line;
+	line.reserve(80);
+	line.append("p ");
+	line.append(QByteArray::number(point.latlon.latitude(), 'f', 9));
+	line.append(' ');
+	line.append(QByteArray::number(point.latlon.longitude(), 'f', 9));
+	line.append(' ');
+	line.append(journalNumber(point.elevation));
+	line.append(' ');
+	line.append(journalNumber(point.hDOP));
+	line.append(' ');
+	line.append(point.datetime.isValid() ? QByteArray::number(point.datetime.toMSecsSinceEpoch()) : QByteArray("-"));
+	line.append('\n');
+	return write(line);
+}
+
+bool TrackJournal::finishCurrentSegment()
+{
+	return write(QByteArray("s\n"));
+}
+
+void TrackJournal::remove()
+{
+	file.close();
+	file.remove();
+}
+
+bool TrackJournal::write(const QByteArray& line)
+{
+	if (!file.isOpen() && !file.open(QIODevice::WriteOnly | QIODevice::Append))
+		return false;
+	
+	return file.write(line) == line.size() && file.flush();
+}
+
+
 }  // namespace OpenOrienteering
@@ -26,12 +26,14 @@
 #include <vector>
 
 #include <QDateTime>
+#include <QFile>
 #include <QString>
 
 #include "core/georeferencing.h"
 #include "core/latlon.h"
 #include "core/map_coord.h"
 
+class QByteArray;
 class QIODevice;
 class QXmlStreamWriter;
 
@@ -165,6 +167,56 @@ bool operator==(const Track& lhs, const Track& rhs);
 inline bool operator!=(const Track& lhs, const Track& rhs) { return !(lhs==rhs); }
 
 
+
+/**
+ * An append-only log of recorded track points.
+ * 
+ * While recording, each point is appended to a line-based text file next
+ * to the track file, and flushed immediately. This has a constant cost per
+ * point, in contrast to rewriting the full GPX file. After a crash, the
+ * points which were not saved to the track file can be recovered from the
+ * journal.
+ * 
+ * The journal is meant to be removed when the track is saved.
+ */
+class TrackJournal
+{
+public:
+	/// Returns the path of the journal for the given track file.
+	static QString pathFor(const QString& track_path);
+	
+	/**
+	 * Appends the points from the journal for the given track file.
+	 * 
+	 * Returns the number of points which were appended.
+	 */
+	static int recover(const QString& track_path, Track& track);
+	
+	
+	/// Constructs a journal for the given track file.
+	explicit TrackJournal(const QString& track_path);
+	
+	TrackJournal(const TrackJournal&) = delete;
+	TrackJournal& operator=(const TrackJournal&) = delete;
+	
+	~TrackJournal();
+	
+	/// Appends a track point. Returns false on error.
+	bool append(const TrackPoint& point);
+	
+	/// Records the end of the current track segment. Returns false on error.
+	bool finishCurrentSegment();
+	
+	/// Closes and removes the journal file.
+	void remove();
+	
+private:
+	bool write(const QByteArray& line);
+	
+	QFile file;
+};
+
+
 }  // namespace OpenOrienteering
 
 #endif  // OPENORIENTEERING_TRACK_H
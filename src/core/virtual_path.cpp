@@ -21,6 +21,13 @@
 
 #include "virtual_path.h"
 
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <vector>
+
 #include "util/util.h"
 
 
@@ -46,6 +53,21 @@ namespace
 	 */
 	const double bezier_segment_maxlen_squared = 1.0;
 	
+	/**
+	 * The maximum depth of bezier curve subdivision.
+	 * 
+	 * This is far beyond the precision of the curve parameter, and it
+	 * bounds the stack used by PathCoordVector::curveToPathCoord().
+	 */
+	constexpr int max_bezier_split_depth = 48;
+	
+	/**
+	 * The minimum number of path coords for building a PathCoordTree.
+	 * 
+	 * Shorter paths are scanned linearly.
+	 */
+	const std::size_t min_tree_size = 64;
+	
 	
 }  // namespace
 
@@ -61,6 +83,50 @@ double PathCoord::bezierError()
 
 
 
+// ### PathCoordTree ###
+
+PathCoordTree::PathCoordTree(const std::vector<PathCoord>& path_coords)
+: data(path_coords.data())
+, num_coords(path_coords.size())
+{
+	Q_ASSERT(num_coords >= 2);
+	
+	auto const num_segments = num_coords - 1;
+	num_leaves = (num_segments + leaf_size - 1) / leaf_size;
+	num_slots = 1;
+	while (num_slots < num_leaves)
+		num_slots *= 2;
+	
+	auto const infinity = std::numeric_limits<double>::infinity();
+	boxes.assign(2 * num_slots, Box { infinity, infinity, -infinity, -infinity });
+	
+	for (std::size_t leaf = 0; leaf < num_leaves; ++leaf)
+	{
+		auto& box = boxes[num_slots + leaf];
+		auto const last = std::min(num_segments, (leaf + 1) * leaf_size);
+		for (auto i = leaf * leaf_size; i <= last; ++i)
+		{
+			auto const& pos = path_coords[i].pos;
+			box.left   = std::min(box.left, pos.x());
+			box.top    = std::min(box.top, pos.y());
+			box.right  = std::max(box.right, pos.x());
+			box.bottom = std::max(box.bottom, pos.y());
+		}
+	}
+	
+	for (auto node = num_slots - 1; node > 0; --node)
+	{
+		auto const& first = boxes[2 * node];
+		auto const& second = boxes[2 * node + 1];
+		boxes[node] = { std::min(first.left, second.left),
+		                std::min(first.top, second.top),
+		                std::max(first.right, second.right),
+		                std::max(first.bottom, second.bottom) };
+	}
+}
+
+
+
 // ### PathCoordVector ###
 
 PathCoordVector::PathCoordVector(const MapCoordVector& coords)
@@ -96,7 +162,11 @@ VirtualCoordVector::size_type PathCoordVector::update(VirtualCoordVector::size_t
 			         pos.x(), -pos.y(), part_start);
 		}
 		
+		if (updateMovedCoords(part_start))
+			return last_update.last;
+		
 		clear();
+		segment_tree.reset();
 		if (empty() || (part_start > 0 && flags[part_start-1].isHolePoint()))
 		{
 			emplace_back(virtual_coords[part_start], part_start, 0.0, 0.0);
@@ -124,10 +194,132 @@ VirtualCoordVector::size_type PathCoordVector::update(VirtualCoordVector::size_t
 				part_end = index;
 			}
 		}
+		
+		saveUpdateState(part_start, part_end);
 	}
 	return part_end;
 }
 
+bool PathCoordVector::updateMovedCoords(VirtualCoordVector::size_type part_start)
+{
+	auto& state = last_update;
+	if (state.coords.empty()
+	    || state.first != part_start
+	    || state.num_coords != virtual_coords.size()
+	    || state.num_path_coords != size())
+		return false;
+	
+	// Find the range of moved coordinates.
+	// Changed flags may change the structure of the path.
+	auto const& flags = virtual_coords.flags;
+	auto first_moved = state.last + 1;
+	auto last_moved = part_start;
+	for (auto index = part_start; index <= state.last; ++index)
+	{
+		auto const k = index - part_start;
+		if (flags[index].flags() != state.flags[k])
+			return false;
+		
+		// Exact comparison: QPointF::operator== is fuzzy.
+		auto const pos = virtual_coords[index];
+		if (pos.x() != state.coords[k].x() || pos.y() != state.coords[k].y())
+		{
+			state.coords[k] = pos;
+			if (first_moved > state.last)
+				first_moved = index;
+			last_moved = index;
+		}
+	}
+	if (first_moved > state.last)
+		return true;  // nothing moved
+	if (first_moved == part_start)
+		return false;
+	
+	// Path coords are ordered by index, and the path coord for a vertex
+	// comes before the ones from the edge starting at this vertex.
+	// Keep everything up to the last vertex before first_moved,
+	// and everything from the first vertex after last_moved.
+	auto first = std::lower_bound(begin(), end(), first_moved, [](const PathCoord& pc, VirtualCoordVector::size_type index) {
+		return pc.index < index;
+	});
+	Q_ASSERT(first != begin());
+	auto const start_vertex = std::prev(first)->index;
+	first = std::lower_bound(begin(), first, start_vertex, [](const PathCoord& pc, VirtualCoordVector::size_type index) {
+		return pc.index < index;
+	});
+	auto last = std::upper_bound(first, end(), last_moved, [](VirtualCoordVector::size_type index, const PathCoord& pc) {
+		return index < pc.index;
+	});
+	auto const end_vertex = (last == end()) ? state.last : last->index;
+	Q_ASSERT(last == end() || last->param == 0);
+	
+	std::vector<PathCoord> tail;
+	if (last != end())
+		tail.assign(std::next(last), end());
+	erase(std::next(first), end());
+	
+	for (auto index = start_vertex + 1; index <= end_vertex; ++index)
+	{
+		if (flags[index-1].isCurveStart())
+		{
+			curveToPathCoord(virtual_coords[index-1], virtual_coords[index], virtual_coords[index+1], virtual_coords[index+2], index-1, 0, 1);
+			index += 2;
+		}
+		
+		const PathCoord& prev = back();
+		emplace_back(virtual_coords[index], index, 0.0, prev.clen + prev.pos.distanceTo(virtual_coords[index]));
+	}
+	
+	// Adjust the cumulative lengths, computed the same way as for new path coords.
+	for (auto path_coord : tail)
+	{
+		const PathCoord& prev = back();
+		if (path_coord.param == 0)
+			path_coord.clen = PathCoord::length_type(prev.clen + prev.pos.distanceTo(path_coord.pos));
+		else
+			path_coord.clen = prev.clen + PathCoord::length_type(prev.pos.distanceTo(path_coord.pos));
+		push_back(path_coord);
+	}
+	
+	segment_tree.reset();
+	state.num_path_coords = size();
+	return true;
+}
+
+std::size_t PathCoordVector::memoryUsage() const
+{
+	auto bytes = capacity() * sizeof(PathCoord)
+	             + last_update.coords.capacity() * sizeof(MapCoordF)
+	             + last_update.flags.capacity() * sizeof(MapCoord::Flags::Int);
+	if (auto tree = std::atomic_load(&segment_tree))
+		bytes += tree->memoryUsage();
+	return bytes;
+}
+
+void PathCoordVector::release()
+{
+	clear();
+	shrink_to_fit();
+	std::atomic_store(&segment_tree, std::shared_ptr<const PathCoordTree>());
+	last_update = {};
+}
+
+void PathCoordVector::saveUpdateState(VirtualCoordVector::size_type part_start, VirtualCoordVector::size_type part_end)
+{
+	auto& state = last_update;
+	state.first = part_start;
+	state.last = part_end;
+	state.num_coords = virtual_coords.size();
+	state.num_path_coords = size();
+	state.coords.resize(part_end - part_start + 1);
+	state.flags.resize(state.coords.size());
+	for (auto index = part_start; index <= part_end; ++index)
+	{
+		state.coords[index - part_start] = virtual_coords[index];
+		state.flags[index - part_start] = virtual_coords.flags[index].flags();
+	}
+}
+
 bool PathCoordVector::isClosed() const
 {
 	return virtual_coords.flags[back().index].isClosePoint();
@@ -199,42 +391,54 @@ QRectF PathCoordVector::calculateExtent() const
 
 bool PathCoordVector::intersectsBox(const QRectF& box) const
 {
-	bool result = false;
-	if (!empty())
-	{
-		auto last_pos = front().pos;
-		result = std::any_of(begin()+1, end(), [&box, &last_pos](const PathCoord& pc)
-		{
-			auto pos = pc.pos;
-			auto result = lineIntersectsRect(box, last_pos, pos); /// \todo Implement this here, used nowhere else
-			last_pos = pos;
-			return result;
-		});
-	}
-	return result;
+	auto const descend = [&box](const PathCoordTree::Box& node) {
+		return node.intersects(box);
+	};
+	return visitSegments(descend, [this, &box](size_type i) {
+		return lineIntersectsRect(box, (*this)[i].pos, (*this)[i+1].pos); /// \todo Implement this here, used nowhere else
+	});
 }
 
 bool PathCoordVector::isPointInside(const MapCoordF& coord) const
 {
+	auto const crosses = [&coord](MapCoordF pos, MapCoordF last_pos) {
+		return ((pos.y() > coord.y()) != (last_pos.y() > coord.y())) &&
+		       (coord.x() < (last_pos.x() - pos.x()) *
+		        (coord.y() - pos.y()) / (last_pos.y() - pos.y()) + pos.x());
+	};
+	
 	bool inside = false;
 	if (size() > 2)
 	{
-		auto last_pos = back().pos;
-		for(const auto& path_coord : *this)
-		{
-			auto pos = path_coord.pos;
-			if ( ((pos.y() > coord.y()) != (last_pos.y() > coord.y())) &&
-			     (coord.x() < (last_pos.x() - pos.x()) *
-			      (coord.y() - pos.y()) / (last_pos.y() - pos.y()) + pos.x()) )
-			{
+		// The ray from coord runs in positive x direction.
+		// Only segments which span coord.y() can cross it.
+		auto const descend = [&coord](const PathCoordTree::Box& node) {
+			return node.top <= coord.y() && coord.y() <= node.bottom;
+		};
+		inside = crosses(front().pos, back().pos);
+		visitSegments(descend, [this, &crosses, &inside](size_type i) {
+			if (crosses((*this)[i+1].pos, (*this)[i].pos))
 				inside = !inside;
-			}
-			last_pos = pos;
-		}
+			return false;
+		});
 	}
 	return inside;
 }
 
+std::shared_ptr<const PathCoordTree> PathCoordVector::segmentTree() const
+{
+	if (size() < min_tree_size)
+		return {};
+	
+	auto tree = std::atomic_load(&segment_tree);
+	if (!tree || !tree->matches(*this))
+	{
+		tree = std::make_shared<const PathCoordTree>(*this);
+		std::atomic_store(&segment_tree, tree);
+	}
+	return tree;
+}
+
 void PathCoordVector::curveToPathCoord(
         MapCoordF c0,
         MapCoordF c1,
@@ -244,28 +448,48 @@ void PathCoordVector::curveToPathCoord(
         float p0,
         float p1 )
 {
-	// Common
-	auto p_half = (double(p0) + double(p1)) * 0.5;
-	MapCoordF c12((c1.x() + c2.x()) * 0.5, (c1.y() + c2.y()) * 0.5);
-	
-	auto inner_len_sq = c0.distanceSquaredTo(c3);
-	auto outer_len    = [&]() { return c0.distanceTo(c1) + c1.distanceTo(c2) + c2.distanceTo(c3); };
-	if (inner_len_sq <= bezier_segment_maxlen_squared && outer_len() - sqrt(inner_len_sq) <= bezier_error)
+	// The curve is subdivided depth-first, left part first, using an
+	// explicit stack of the pending right parts instead of recursion.
+	// The generated path coords are the same as from recursive subdivision.
+	struct Piece
 	{
-		const PathCoord& prev = back();
-		emplace_back(c12, edge_start, p_half, prev.clen + float(prev.pos.distanceTo(c12)));
-	}
-	else
+		MapCoordF c0, c1, c2, c3;
+		float p0, p1;
+	};
+	Piece stack[max_bezier_split_depth];
+	auto depth = 0;
+	
+	auto piece = Piece{ c0, c1, c2, c3, p0, p1 };
+	for (;;)
 	{
-		// Split in two
-		MapCoordF c01((c0.x() + c1.x()) * 0.5, (c0.y() + c1.y()) * 0.5);
-		MapCoordF c23((c2.x() + c3.x()) * 0.5, (c2.y() + c3.y()) * 0.5);
-		MapCoordF c012((c01.x() + c12.x()) * 0.5, (c01.y() + c12.y()) * 0.5);
-		MapCoordF c123((c12.x() + c23.x()) * 0.5, (c12.y() + c23.y()) * 0.5);
-		MapCoordF c0123((c012.x() + c123.x()) * 0.5, (c012.y() + c123.y()) * 0.5);
+		// Common
+		auto p_half = (double(piece.p0) + double(piece.p1)) * 0.5;
+		MapCoordF c12((piece.c1.x() + piece.c2.x()) * 0.5, (piece.c1.y() + piece.c2.y()) * 0.5);
 		
-		curveToPathCoord(c0, c01, c012, c0123, edge_start, p0, p_half);
-		curveToPathCoord(c0123, c123, c23, c3, edge_start, p_half, p1);
+		auto inner_len_sq = piece.c0.distanceSquaredTo(piece.c3);
+		auto outer_len    = [&piece]() { return piece.c0.distanceTo(piece.c1) + piece.c1.distanceTo(piece.c2) + piece.c2.distanceTo(piece.c3); };
+		if (depth == max_bezier_split_depth
+		    || (inner_len_sq <= bezier_segment_maxlen_squared && outer_len() - sqrt(inner_len_sq) <= bezier_error))
+		{
+			const PathCoord& prev = back();
+			emplace_back(c12, edge_start, p_half, prev.clen + float(prev.pos.distanceTo(c12)));
+			
+			if (depth == 0)
+				break;
+			piece = stack[--depth];
+		}
+		else
+		{
+			// Split in two
+			MapCoordF c01((piece.c0.x() + piece.c1.x()) * 0.5, (piece.c0.y() + piece.c1.y()) * 0.5);
+			MapCoordF c23((piece.c2.x() + piece.c3.x()) * 0.5, (piece.c2.y() + piece.c3.y()) * 0.5);
+			MapCoordF c012((c01.x() + c12.x()) * 0.5, (c01.y() + c12.y()) * 0.5);
+			MapCoordF c123((c12.x() + c23.x()) * 0.5, (c12.y() + c23.y()) * 0.5);
+			MapCoordF c0123((c012.x() + c123.x()) * 0.5, (c012.y() + c123.y()) * 0.5);
+			
+			stack[depth++] = { c0123, c123, c23, piece.c3, float(p_half), piece.p1 };
+			piece = { piece.c0, c01, c012, c0123, piece.p0, float(p_half) };
+		}
 	}
 }
 
@@ -351,32 +575,49 @@ ClosestPathCoord VirtualPath::findClosestPointTo(
 	
 	auto result = ClosestPathCoord { path_coords.front(), distance_bound_squared };
 	
-	// Find upper bound for distance.
-	for (const auto& path_coord : path_coords)
-	{
-		if (path_coord.index > end_index)
-			break;
-		if (path_coord.index < start_index)
-			continue;
+	// The candidates are ranked as if all path coords were checked first,
+	// followed by all segments, in sequence. Among candidates at the same
+	// distance, the first one in this sequence wins, regardless of the
+	// order in which the segments are visited.
+	auto const num_path_coords = path_coords.size();
+	auto const no_rank = std::numeric_limits<PathCoordVector::size_type>::max();
+	auto result_rank = no_rank;
+	auto const improves = [&result, &result_rank, no_rank](double dist_sq, PathCoordVector::size_type rank) {
+		return dist_sq < result.distance_squared
+		       || (dist_sq == result.distance_squared && rank < result_rank && result_rank != no_rank);
+	};
+	
+	auto const check_path_coord = [&](PathCoordVector::size_type i) {
+		const auto& path_coord = path_coords[i];
+		if (path_coord.index > end_index || path_coord.index < start_index)
+			return;
 		
 		auto to_coord = coord - path_coord.pos;
 		auto dist_sq = to_coord.lengthSquared();
-		if (dist_sq < result.distance_squared)
+		if (improves(dist_sq, i))
 		{
 			result.distance_squared = dist_sq;
 			result.path_coord = path_coord;
+			result_rank = i;
 		}
-	}
+	};
 	
-	// Check between this coord and the next one.
-	auto last = end(path_coords)-1;
-	for (auto pc = begin(path_coords); pc != last; ++pc)
+	if (num_path_coords == 1)
 	{
-		if (pc->index > end_index)
-			break;
-		if (pc->index < start_index)
-			continue;
+		check_path_coord(0);
+		return result;
+	}
+	
+	path_coords.visitSegmentsNear(coord, result.distance_squared, [&](PathCoordVector::size_type i) {
+		check_path_coord(i);
+		check_path_coord(i+1);
+		
+		// Check between this coord and the next one.
+		auto pc = begin(path_coords) + std::ptrdiff_t(i);
+		if (pc->index > end_index || pc->index < start_index)
+			return false;
 		
+		auto const rank = num_path_coords + i;
 		auto pos = pc->pos;
 		auto next_pc = pc+1;
 		auto next_pos = next_pc->pos;
@@ -388,32 +629,35 @@ ClosestPathCoord VirtualPath::findClosestPointTo(
 		auto dist_along_line = float(MapCoordF::dotProduct(to_coord, tangent));
 		if (dist_along_line <= 0)
 		{
-			if (to_coord.lengthSquared() < result.distance_squared)
+			if (improves(to_coord.lengthSquared(), rank))
 			{
 				result.distance_squared = to_coord.lengthSquared();
 				result.path_coord = *pc;
+				result_rank = rank;
 			}
-			continue;
+			return false;
 		}
 		
 		auto line_length = next_pc->clen - pc->clen;
 		if (dist_along_line >= line_length)
 		{
-			if (coord.distanceSquaredTo(next_pos) < result.distance_squared)
+			if (improves(coord.distanceSquaredTo(next_pos), rank))
 			{
 				result.distance_squared = coord.distanceSquaredTo(next_pos);
 				result.path_coord = *next_pc;
+				result_rank = rank;
 			}
-			continue;
+			return false;
 		}
 		
 		auto right = tangent.perpRight();
 		
 		auto dist_from_line = MapCoordF::dotProduct(right, to_coord);
 		auto dist_from_line_sq = dist_from_line * dist_from_line;
-		if (dist_from_line_sq < result.distance_squared)
+		if (improves(dist_from_line_sq, rank))
 		{
 			result.distance_squared = dist_from_line_sq;
+			result_rank = rank;
 			result.path_coord.clen = pc->clen + dist_along_line;
 			result.path_coord.index = pc->index;
 			auto factor = dist_along_line / line_length;
@@ -434,7 +678,8 @@ ClosestPathCoord VirtualPath::findClosestPointTo(
 				result.path_coord.pos = pos + (next_pos - pos) * double(factor);
 			}
 		}
-	}
+		return false;
+	});
 	return result;
 }
 
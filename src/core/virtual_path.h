@@ -22,6 +22,9 @@
 #ifndef OPENORIENTEERING_VIRTUAL_PATH_H
 #define OPENORIENTEERING_VIRTUAL_PATH_H
 
+#include <algorithm>
+#include <cstddef>
+#include <limits>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -36,6 +39,75 @@
 
 namespace OpenOrienteering {
 
+/**
+ * A bounding volume hierarchy over the segments of a PathCoordVector.
+ * 
+ * Segment i is the straight edge from path coord i to path coord i+1.
+ * Consecutive segments are grouped into leaves, and the leaves form a
+ * complete binary tree of bounding boxes. The tree is a snapshot: it does
+ * not keep a reference to the path coords it was built from, and it does
+ * not follow their changes.
+ * 
+ * \see PathCoordVector::visitSegments()
+ */
+class PathCoordTree
+{
+public:
+	/** An axis-aligned, inclusive bounding box. */
+	struct Box
+	{
+		double left;
+		double top;
+		double right;
+		double bottom;
+		
+		/** Returns true if the box shares at least one point with the rectangle. */
+		bool intersects(const QRectF& rect) const noexcept;
+		
+		/** Returns the squared distance from the coord to the box, or 0 when inside. */
+		double distanceSquaredTo(const MapCoordF& coord) const noexcept;
+	};
+	
+	/** Builds the tree for the given path coords. */
+	explicit PathCoordTree(const std::vector<PathCoord>& path_coords);
+	
+	/** Returns true if the tree was built from exactly this vector state. */
+	bool matches(const std::vector<PathCoord>& path_coords) const noexcept;
+	
+	/** Returns the memory used by the tree, in bytes. */
+	std::size_t memoryUsage() const noexcept;
+	
+	/** \see PathCoordVector::visitSegments() */
+	template <class Descend, class Function>
+	bool visit(Descend& descend, Function& function) const;
+	
+	/** \see PathCoordVector::visitSegmentsNear() */
+	template <class Function>
+	bool visitNear(const MapCoordF& coord, const double& distance_bound_squared, Function& function) const;
+	
+private:
+	/** The number of segments in a leaf. */
+	static constexpr std::size_t leaf_size = 8;
+	
+	template <class Descend, class Function>
+	bool visitNode(std::size_t node, std::size_t first_leaf, std::size_t span, Descend& descend, Function& function) const;
+	
+	template <class Function>
+	bool visitNodeNear(std::size_t node, std::size_t first_leaf, std::size_t span, const MapCoordF& coord, const double& distance_bound_squared, Function& function) const;
+	
+	template <class Function>
+	bool visitLeaf(std::size_t leaf, Function& function) const;
+	
+	/// The boxes in heap order, root at index 1, leaves from index num_slots.
+	std::vector<Box> boxes;
+	const PathCoord* data;
+	std::size_t num_coords;
+	std::size_t num_leaves;
+	std::size_t num_slots;
+};
+
+
+
 class PathCoordVector : public std::vector<PathCoord>
 {
 private:
@@ -44,6 +116,26 @@ private:
 	
 	VirtualCoordVector virtual_coords;
 	
+	/// Lazily built, accessed via std::atomic_load/std::atomic_store.
+	mutable std::shared_ptr<const PathCoordTree> segment_tree;
+	
+	/**
+	 * The state of the virtual coords at the last full update().
+	 * 
+	 * It allows update() to re-flatten only the edges whose coordinates
+	 * changed, as long as the size and the flags stay the same.
+	 */
+	struct UpdateState
+	{
+		std::vector<MapCoordF> coords;
+		std::vector<MapCoord::Flags::Int> flags;
+		VirtualCoordVector::size_type first = 0;
+		VirtualCoordVector::size_type last = 0;
+		VirtualCoordVector::size_type num_coords = 0;
+		std::size_t num_path_coords = 0;
+	};
+	UpdateState last_update;
+	
 public:
 	PathCoordVector(const MapCoordVector& coords);
 	
@@ -73,10 +165,27 @@ public:
 	/**
 	 * Updates the path coords from the flags/coords, starting at first.
 	 * 
+	 * When only some coordinates were moved since the last update, only
+	 * the affected edges are flattened again, and the cumulative lengths
+	 * of the following path coords are adjusted.
+	 * 
 	 * \return The index after the last element of this part.
 	 */
 	VirtualCoordVector::size_type update(VirtualCoordVector::size_type first);
 	
+	/**
+	 * Returns the memory used by the path coords and the derived data, in bytes.
+	 */
+	std::size_t memoryUsage() const;
+	
+	/**
+	 * Releases the memory of the path coords and the derived data.
+	 * 
+	 * The path coords are empty until the next update(), which rebuilds
+	 * them from the flags/coords.
+	 */
+	void release();
+	
 	
 	/**
 	 * Finds the index of the next dash point after first, or returns size()-1.
@@ -121,9 +230,59 @@ public:
 	
 	bool isPointInside(const MapCoordF& coord) const;
 	
+	
+	/**
+	 * Calls function(i) for the segments from path coord i to path coord i+1
+	 * which may be of interest, until the function returns true.
+	 * 
+	 * For long paths, the segments are organized in a lazily built
+	 * PathCoordTree, and descend(box) decides whether the segments within a
+	 * PathCoordTree::Box need to be visited. For short paths, all segments
+	 * are visited. Either way, the segments are visited in ascending order.
+	 * 
+	 * 
+eturn True if the function returned true.
+	 */
+	template <class Descend, class Function>
+	bool visitSegments(Descend&& descend, Function&& function) const;
+	
+	/**
+	 * Calls function(i) for the segments from path coord i to path coord i+1
+	 * whose bounding box is not farther from coord than the distance bound,
+	 * until the function returns true.
+	 * 
+	 * The distance bound is taken by reference, and the function may lower
+	 * it. For long paths, closer subtrees are visited first. The order of the
+	 * segments is unspecified.
+	 * 
+	 * 
+eturn True if the function returned true.
+	 */
+	template <class Function>
+	bool visitSegmentsNear(const MapCoordF& coord, const double& distance_bound_squared, Function&& function) const;
+	
 private:
 	/**
-	 * Recursive approximation of a bezier curve by polygonal segments.
+	 * Returns the segment tree, building it if needed.
+	 * 
+	 * Returns nullptr for paths which are too short to benefit from a tree.
+	 */
+	std::shared_ptr<const PathCoordTree> segmentTree() const;
+	
+	/**
+	 * Updates the path coords for the edges with moved coordinates only.
+	 * 
+	 * Returns false if a full update is needed.
+	 */
+	bool updateMovedCoords(VirtualCoordVector::size_type part_start);
+	
+	/**
+	 * Records the state of the virtual coords for updateMovedCoords().
+	 */
+	void saveUpdateState(VirtualCoordVector::size_type part_start, VirtualCoordVector::size_type part_end);
+	
+	/**
+	 * Approximation of a bezier curve by polygonal segments, using recursive subdivision.
 	 */
 	void curveToPathCoord(
 		MapCoordF c0,
@@ -325,6 +484,105 @@ public:
 
 
 
+// ### PathCoordTree inline code ###
+
+inline
+bool PathCoordTree::Box::intersects(const QRectF& rect) const noexcept
+{
+	return left <= rect.right() && rect.left() <= right
+	       && top <= rect.bottom() && rect.top() <= bottom;
+}
+
+inline
+double PathCoordTree::Box::distanceSquaredTo(const MapCoordF& coord) const noexcept
+{
+	auto const dx = std::max(0.0, std::max(left - coord.x(), coord.x() - right));
+	auto const dy = std::max(0.0, std::max(top - coord.y(), coord.y() - bottom));
+	return dx * dx + dy * dy;
+}
+
+inline
+bool PathCoordTree::matches(const std::vector<PathCoord>& path_coords) const noexcept
+{
+	return data == path_coords.data() && num_coords == path_coords.size();
+}
+
+inline
+std::size_t PathCoordTree::memoryUsage() const noexcept
+{
+	return sizeof(PathCoordTree) + boxes.capacity() * sizeof(Box);
+}
+
+template <class Descend, class Function>
+bool PathCoordTree::visit(Descend& descend, Function& function) const
+{
+	return visitNode(1, 0, num_slots, descend, function);
+}
+
+template <class Function>
+bool PathCoordTree::visitNear(const MapCoordF& coord, const double& distance_bound_squared, Function& function) const
+{
+	if (boxes[1].distanceSquaredTo(coord) > distance_bound_squared)
+		return false;
+	return visitNodeNear(1, 0, num_slots, coord, distance_bound_squared, function);
+}
+
+template <class Descend, class Function>
+bool PathCoordTree::visitNode(std::size_t node, std::size_t first_leaf, std::size_t span, Descend& descend, Function& function) const
+{
+	if (first_leaf >= num_leaves || !descend(boxes[node]))
+		return false;
+	if (span == 1)
+		return visitLeaf(first_leaf, function);
+	
+	span /= 2;
+	return visitNode(2 * node, first_leaf, span, descend, function)
+	       || visitNode(2 * node + 1, first_leaf + span, span, descend, function);
+}
+
+template <class Function>
+bool PathCoordTree::visitNodeNear(std::size_t node, std::size_t first_leaf, std::size_t span, const MapCoordF& coord, const double& distance_bound_squared, Function& function) const
+{
+	if (span == 1)
+		return visitLeaf(first_leaf, function);
+	
+	span /= 2;
+	auto near_node = 2 * node;
+	auto near_leaf = first_leaf;
+	auto far_node = near_node + 1;
+	auto far_leaf = first_leaf + span;
+	auto near_distance_sq = boxes[near_node].distanceSquaredTo(coord);
+	auto far_distance_sq = far_leaf < num_leaves ? boxes[far_node].distanceSquaredTo(coord) : std::numeric_limits<double>::infinity();
+	if (far_distance_sq < near_distance_sq)
+	{
+		std::swap(near_node, far_node);
+		std::swap(near_leaf, far_leaf);
+		std::swap(near_distance_sq, far_distance_sq);
+	}
+	
+	if (near_distance_sq <= distance_bound_squared
+	    && visitNodeNear(near_node, near_leaf, span, coord, distance_bound_squared, function))
+		return true;
+	// The bound may have been lowered meanwhile.
+	return far_distance_sq <= distance_bound_squared
+	       && visitNodeNear(far_node, far_leaf, span, coord, distance_bound_squared, function);
+}
+
+template <class Function>
+bool PathCoordTree::visitLeaf(std::size_t leaf, Function& function) const
+{
+	auto const num_segments = num_coords - 1;
+	auto const last = std::min(num_segments, (leaf + 1) * leaf_size);
+	for (auto i = leaf * leaf_size; i < last; ++i)
+	{
+		if (function(i))
+			return true;
+	}
+	return false;
+}
+
+
+
 // ### PathCoordVector inline code ###
 
 inline
@@ -339,6 +597,34 @@ const VirtualCoordVector& PathCoordVector::coords() const
 	return virtual_coords;
 }
 
+template <class Descend, class Function>
+bool PathCoordVector::visitSegments(Descend&& descend, Function&& function) const
+{
+	if (auto tree = segmentTree())
+		return tree->visit(descend, function);
+	
+	for (size_type i = 0; i + 1 < size(); ++i)
+	{
+		if (function(i))
+			return true;
+	}
+	return false;
+}
+
+template <class Function>
+bool PathCoordVector::visitSegmentsNear(const MapCoordF& coord, const double& distance_bound_squared, Function&& function) const
+{
+	if (auto tree = segmentTree())
+		return tree->visitNear(coord, distance_bound_squared, function);
+	
+	for (size_type i = 0; i + 1 < size(); ++i)
+	{
+		if (function(i))
+			return true;
+	}
+	return false;
+}
+
 inline
 PathCoordVector::size_type PathCoordVector::lowerBound(
 	PathCoord::length_type length,
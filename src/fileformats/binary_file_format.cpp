@@ -0,0 +1,666 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "binary_file_format.h"
+#include "binary_file_format_p.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include <QtGlobal>
+#include <QtEndian>
+#include <QBuffer>
+#include <QByteArray>
+#include <QHash>
+#include <QIODevice>
+#include <QLatin1String>
+#include <QString>
+#include <QXmlStreamWriter>
+
+#include "core/map.h"
+#include "core/map_coord.h"
+#include "core/map_part.h"
+#include "core/objects/object.h"
+#include "core/objects/text_object.h"
+#include "core/symbols/symbol.h"
+#include "fileformats/file_format.h"
+#include "fileformats/file_import_export.h"
+#include "util/xml_stream_util.h"
+
+
+namespace OpenOrienteering {
+
+namespace literal
+{
+	static const QLatin1String parts("parts");
+	static const QLatin1String part("part");
+	static const QLatin1String name("name");
+	static const QLatin1String count("count");
+	static const QLatin1String current("current");
+}
+
+
+namespace {
+
+/// Object flag: A rotation value follows.
+constexpr quint64 flag_rotation = 0x01;
+/// Object flag: A list of tags follows.
+constexpr quint64 flag_tags     = 0x02;
+/// Object flag: A text box size follows.
+constexpr quint64 flag_box_size = 0x04;
+
+
+quint64 zigzag(qint64 value) noexcept
+{
+	return (quint64(value) << 1) ^ quint64(value >> 63);
+}
+
+qint64 unzigzag(quint64 value) noexcept
+{
+	return qint64(value >> 1) ^ -qint64(value & 1);
+}
+
+
+/**
+ * Appends primitive values to a byte array.
+ */
+class ByteWriter
+{
+public:
+	explicit ByteWriter(QByteArray& data) noexcept
+	: data(data)
+	{}
+
+	void writeUnsigned(quint64 value)
+	{
+		while (value >= 0x80)
+		{
+			data.append(char(value | 0x80));
+			value >>= 7;
+		}
+		data.append(char(value));
+	}
+
+	void writeSigned(qint64 value)
+	{
+		writeUnsigned(zigzag(value));
+	}
+
+	void writeDouble(double value)
+	{
+		quint64 bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		bits = qToLittleEndian(bits);
+		data.append(reinterpret_cast<const char*>(&bits), int(sizeof(bits)));
+	}
+
+	void writeString(const QString& value)
+	{
+		auto const utf8 = value.toUtf8();
+		writeUnsigned(quint64(utf8.size()));
+		data.append(utf8);
+	}
+
+private:
+	QByteArray& data;
+};
+
+
+/**
+ * Reads primitive values from a byte array.
+ *
+ * Throws a FileFormatException when reading beyond the end of the data.
+ */
+class ByteReader
+{
+public:
+	ByteReader(const QByteArray& data, int pos) noexcept
+	: current(data.constData() + pos)
+	, end(data.constData() + data.size())
+	{}
+
+	quint64 readUnsigned()
+	{
+		quint64 value = 0;
+		for (int shift = 0; shift < 64; shift += 7)
+		{
+			if (current == end)
+				invalidData();
+			auto const byte = quint8(*current++);
+			value |= quint64(byte & 0x7f) << shift;
+			if (!(byte & 0x80))
+				return value;
+		}
+		invalidData();
+	}
+
+	qint64 readSigned()
+	{
+		return unzigzag(readUnsigned());
+	}
+
+	/** Reads an unsigned value which must not exceed the given limit. */
+	quint64 readCount(quint64 limit)
+	{
+		auto const value = readUnsigned();
+		if (value > limit)
+			invalidData();
+		return value;
+	}
+
+	qint32 readNative()
+	{
+		auto const value = readSigned();
+		if (value < std::numeric_limits<qint32>::min() || value > std::numeric_limits<qint32>::max())
+			invalidData();
+		return qint32(value);
+	}
+
+	double readDouble()
+	{
+		if (end - current < qint64(sizeof(quint64)))
+			invalidData();
+		quint64 bits = qFromLittleEndian<quint64>(reinterpret_cast<const uchar*>(current));
+		current += sizeof(bits);
+		double value;
+		std::memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+
+	QString readString()
+	{
+		auto const size = readCount(quint64(end - current));
+		auto const* first = current;
+		current += size;
+		return QString::fromUtf8(first, int(size));
+	}
+
+	/** Returns the number of bytes which are left. */
+	quint64 remaining() const noexcept
+	{
+		return quint64(end - current);
+	}
+
+	[[noreturn]] static void invalidData()
+	{
+		throw FileFormatException(::OpenOrienteering::BinaryFileImporter::tr("Invalid data."));
+	}
+
+private:
+	const char* current;
+	const char* end;
+};
+
+
+/**
+ * Assigns indices to strings in the order of first use.
+ */
+class StringTable
+{
+public:
+	quint64 index(const QString& value)
+	{
+		auto const found = indices.constFind(value);
+		if (found != indices.constEnd())
+			return found.value();
+
+		auto const new_index = quint64(strings.size());
+		indices.insert(value, new_index);
+		strings.push_back(value);
+		return new_index;
+	}
+
+	void write(ByteWriter& out) const
+	{
+		out.writeUnsigned(quint64(strings.size()));
+		for (auto const& value : strings)
+			out.writeString(value);
+	}
+
+private:
+	QHash<QString, quint64> indices;
+	std::vector<QString> strings;
+};
+
+
+void writeCoords(ByteWriter& out, const MapCoordVector& coords, std::size_t count)
+{
+	out.writeUnsigned(count);
+	qint64 last_x = 0;
+	qint64 last_y = 0;
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		auto const& coord = coords[i];
+		auto const flags = quint64(coord.flags());
+		// The lowest bit of the x delta indicates that flags follow.
+		out.writeUnsigned((zigzag(coord.nativeX() - last_x) << 1) | (flags ? 1 : 0));
+		out.writeSigned(coord.nativeY() - last_y);
+		if (flags)
+			out.writeUnsigned(flags);
+		last_x = coord.nativeX();
+		last_y = coord.nativeY();
+	}
+}
+
+MapCoordVector readCoords(ByteReader& in)
+{
+	// Each coordinate needs at least two bytes.
+	auto const count = in.readCount(in.remaining() / 2);
+	MapCoordVector coords;
+	coords.reserve(count);
+	qint64 x = 0;
+	qint64 y = 0;
+	for (quint64 i = 0; i < count; ++i)
+	{
+		auto const x_value = in.readUnsigned();
+		x += unzigzag(x_value >> 1);
+		y += in.readSigned();
+		auto const flags = (x_value & 1) ? in.readCount(0xff) : 0;
+		if (x < std::numeric_limits<qint32>::min() || x > std::numeric_limits<qint32>::max()
+		    || y < std::numeric_limits<qint32>::min() || y > std::numeric_limits<qint32>::max())
+		{
+			ByteReader::invalidData();
+		}
+		coords.push_back(MapCoord::fromNative(qint32(x), qint32(y)));
+		coords.back().setFlags(MapCoord::Flags::Int(flags));
+	}
+	return coords;
+}
+
+
+}  // namespace
+
+
+
+// ### BinaryFileFormat ###
+
+const char BinaryFileFormat::magic[4] = { 'O', 'O', 'M', 'B' };
+
+const int BinaryFileFormat::current_version = 1;
+
+
+BinaryFileFormat::BinaryFileFormat()
+ : FileFormat(MapFile,
+              "Binary",
+              ::OpenOrienteering::ImportExport::tr("OpenOrienteering Mapper (binary)"),
+              QString::fromLatin1("omapb"),
+              Feature::FileOpen | Feature::FileImport |
+              Feature::FileSave | Feature::FileSaveAs )
+{
+	// nothing else
+}
+
+
+FileFormat::ImportSupportAssumption BinaryFileFormat::understands(const char* buffer, int size) const
+{
+	if (size < int(sizeof(magic)))
+		return Unknown;
+	if (std::memcmp(buffer, magic, sizeof(magic)) == 0)
+		return FullySupported;
+	return NotSupported;
+}
+
+
+std::unique_ptr<Importer> BinaryFileFormat::makeImporter(const QString& path, Map* map, MapView* view) const
+{
+	return std::make_unique<BinaryFileImporter>(path, map, view);
+}
+
+std::unique_ptr<Exporter> BinaryFileFormat::makeExporter(const QString& path, const Map* map, const MapView* view) const
+{
+	return std::make_unique<BinaryFileExporter>(path, map, view);
+}
+
+
+
+// ### BinaryFileExporter ###
+
+BinaryFileExporter::BinaryFileExporter(const QString& path, const Map* map, const MapView* view)
+: XMLFileExporter(path, map, view)
+{
+	setOption(QString::fromLatin1("autoFormatting"), false);
+	setOption(QString::fromLatin1("compressed"), false);
+}
+
+BinaryFileExporter::~BinaryFileExporter() = default;
+
+
+bool BinaryFileExporter::exportImplementation()
+{
+	auto* const target = device();
+
+	// The XML document is written to a buffer first.
+	QBuffer xml_buffer;
+	xml_buffer.open(QIODevice::WriteOnly);
+	setDevice(&xml_buffer);
+	try
+	{
+		if (!XMLFileExporter::exportImplementation())
+		{
+			setDevice(target);
+			return false;
+		}
+	}
+	catch (...)
+	{
+		setDevice(target);
+		throw;
+	}
+	setDevice(target);
+	xml_buffer.close();
+
+	QHash<const Symbol*, qint64> symbol_indices;
+	for (int i = 0; i < map->getNumSymbols(); ++i)
+		symbol_indices.insert(map->getSymbol(i), i);
+	symbol_indices.insert(Map::getUndefinedPoint(), -2);
+	symbol_indices.insert(Map::getUndefinedLine(), -3);
+	symbol_indices.insert(Map::getUndefinedText(), -4);
+
+	QByteArray objects_data;
+	ByteWriter objects_out(objects_data);
+	StringTable strings;
+
+	auto const num_parts = map->getNumParts();
+	objects_out.writeUnsigned(quint64(num_parts));
+	for (int p = 0; p < num_parts; ++p)
+	{
+		auto const* part = map->getPart(p);
+		auto const num_objects = part->getNumObjects();
+		objects_out.writeUnsigned(quint64(num_objects));
+		for (int o = 0; o < num_objects; ++o)
+		{
+			auto const* object = part->getObject(o);
+			auto const type = object->getType();
+			auto const* symbol = object->getSymbol();
+			auto const* text = (type == Object::Text) ? static_cast<const TextObject*>(object) : nullptr;
+
+			quint64 flags = 0;
+			if (symbol && symbol->isRotatable() && !qIsNull(object->getRotation()))
+				flags |= flag_rotation;
+			if (!object->tags().empty())
+				flags |= flag_tags;
+			if (text && !text->hasSingleAnchor())
+				flags |= flag_box_size;
+
+			objects_out.writeUnsigned(quint64(type));
+			objects_out.writeSigned(symbol_indices.value(symbol, -1));
+			objects_out.writeUnsigned(flags);
+
+			if (flags & flag_rotation)
+				objects_out.writeDouble(object->getRotation());
+
+			if (flags & flag_tags)
+			{
+				auto const& tags = object->tags();
+				objects_out.writeUnsigned(quint64(tags.size()));
+				for (auto tag = tags.begin(); tag != tags.end(); ++tag)
+				{
+					objects_out.writeUnsigned(strings.index(tag.key()));
+					objects_out.writeUnsigned(strings.index(tag.value()));
+				}
+			}
+
+			auto const& coords = object->getRawCoordinateVector();
+			if (text)
+			{
+				// Only the anchor. The box size is written separately.
+				writeCoords(objects_out, coords, std::min(coords.size(), std::size_t(1)));
+				objects_out.writeUnsigned(text->getHorizontalAlignment());
+				objects_out.writeUnsigned(text->getVerticalAlignment());
+				if (flags & flag_box_size)
+				{
+					auto const size = text->getBoxSize();
+					objects_out.writeSigned(size.nativeX());
+					objects_out.writeSigned(size.nativeY());
+				}
+				objects_out.writeString(text->getText());
+			}
+			else
+			{
+				writeCoords(objects_out, coords, coords.size());
+			}
+
+			if (type == Object::Path)
+			{
+				auto const* path = static_cast<const PathObject*>(object);
+				auto const origin = path->getPatternOrigin();
+				objects_out.writeDouble(path->getPatternRotation());
+				objects_out.writeSigned(origin.nativeX());
+				objects_out.writeSigned(origin.nativeY());
+			}
+		}
+	}
+
+	QByteArray header;
+	ByteWriter header_out(header);
+	header.append(BinaryFileFormat::magic, int(sizeof(BinaryFileFormat::magic)));
+	header_out.writeUnsigned(quint64(BinaryFileFormat::current_version));
+	header_out.writeUnsigned(quint64(xml_buffer.data().size()));
+
+	QByteArray string_data;
+	ByteWriter string_out(string_data);
+	strings.write(string_out);
+
+	for (auto const* chunk : std::initializer_list<const QByteArray*>{ &header, &xml_buffer.data(), &string_data, &objects_data })
+	{
+		if (target->write(*chunk) != chunk->size())
+			throw FileFormatException(target->errorString());
+	}
+	return true;
+}
+
+
+void BinaryFileExporter::exportMapParts()
+{
+	XmlElementWriter parts_element(xml, literal::parts);
+
+	auto num_parts = std::size_t(map->getNumParts());
+	parts_element.writeAttribute(literal::count, num_parts);
+	parts_element.writeAttribute(literal::current, map->getCurrentPartIndex());
+	for (auto i = 0lu; i < num_parts; ++i)
+	{
+		XmlElementWriter part_element(xml, literal::part);
+		part_element.writeAttribute(literal::name, map->getPart(int(i))->getName());
+	}
+}
+
+
+
+// ### BinaryFileImporter ###
+
+BinaryFileImporter::BinaryFileImporter(const QString& path, Map* map, MapView* view)
+: XMLFileImporter(path, map, view)
+{
+	// nothing else
+}
+
+BinaryFileImporter::~BinaryFileImporter() = default;
+
+
+bool BinaryFileImporter::importImplementation()
+{
+	auto* const source = device();
+	auto const data = source->readAll();
+	if (data.size() < int(sizeof(BinaryFileFormat::magic))
+	    || std::memcmp(data.constData(), BinaryFileFormat::magic, sizeof(BinaryFileFormat::magic)) != 0)
+	{
+		throw FileFormatException(::OpenOrienteering::Importer::tr("Unsupported file format."));
+	}
+
+	ByteReader header(data, int(sizeof(BinaryFileFormat::magic)));
+	auto const version = header.readUnsigned();
+	if (version > quint64(BinaryFileFormat::current_version))
+		throw FileFormatException(::OpenOrienteering::Importer::tr("Unsupported new file format version. Some map features will not be loaded or saved by this version of the program."));
+	auto const xml_size = header.readCount(header.remaining());
+	auto const xml_pos = data.size() - int(header.remaining());
+
+	// The XML document is read by the XML importer.
+	auto xml_data = QByteArray::fromRawData(data.constData() + xml_pos, int(xml_size));
+	QBuffer xml_buffer(&xml_data);
+	xml_buffer.open(QIODevice::ReadOnly);
+	setDevice(&xml_buffer);
+	try
+	{
+		if (!XMLFileImporter::importImplementation())
+		{
+			setDevice(source);
+			return false;
+		}
+	}
+	catch (...)
+	{
+		setDevice(source);
+		throw;
+	}
+	setDevice(source);
+
+	if (!loadSymbolsOnly())
+		importObjects(data, xml_pos + int(xml_size));
+
+	return true;
+}
+
+
+void BinaryFileImporter::importObjects(const QByteArray& data, int pos)
+{
+	ByteReader in(data, pos);
+
+	std::vector<QString> strings(in.readCount(in.remaining()));
+	for (auto& value : strings)
+		value = in.readString();
+	auto const string = [&in, &strings]() -> const QString& {
+		auto const index = in.readUnsigned();
+		if (index >= strings.size())
+			ByteReader::invalidData();
+		return strings[index];
+	};
+
+	auto const num_parts = in.readUnsigned();
+	if (num_parts != quint64(map->getNumParts()))
+		ByteReader::invalidData();
+
+	for (int p = 0; p < map->getNumParts(); ++p)
+	{
+		auto* part = map->getPart(p);
+		auto const num_objects = in.readCount(in.remaining());
+		part->objects.reserve(num_objects);
+		for (quint64 o = 0; o < num_objects; ++o)
+		{
+			auto const type = Object::Type(in.readCount(Object::Text));
+			auto* object = Object::getObjectForType(type);
+			if (!object)
+				ByteReader::invalidData();
+			part->objects.push_back(object);
+			object->map = map;
+
+			auto const symbol_index = in.readSigned();
+			if (symbol_index >= 0 && symbol_index < map->getNumSymbols())
+				object->symbol = map->getSymbol(int(symbol_index));
+			else if (symbol_index == -2)
+				object->symbol = Map::getUndefinedPoint();
+			else if (symbol_index == -3)
+				object->symbol = Map::getUndefinedLine();
+			else if (symbol_index == -4)
+				object->symbol = Map::getUndefinedText();
+
+			if (!object->symbol || !object->symbol->isTypeCompatibleTo(object))
+			{
+				// Cf. Object::load()
+				switch (type)
+				{
+				case Object::Point:
+					object->symbol = Map::getUndefinedPoint();
+					break;
+				case Object::Path:
+					object->symbol = Map::getUndefinedLine();
+					break;
+				case Object::Text:
+					object->symbol = Map::getUndefinedText();
+					break;
+				}
+			}
+
+			auto const flags = in.readUnsigned();
+			if (flags & flag_rotation)
+			{
+				auto const rotation = in.readDouble();
+				if (object->symbol->isRotatable())
+					object->rotation = rotation;
+			}
+
+			if (flags & flag_tags)
+			{
+				auto const num_tags = in.readCount(in.remaining() / 2);
+				object->object_tags.reserve(int(num_tags));
+				for (quint64 t = 0; t < num_tags; ++t)
+				{
+					auto const& key = string();
+					object->object_tags.insert(key, string());
+				}
+			}
+
+			object->coords = readCoords(in);
+
+			if (type == Object::Text)
+			{
+				if (object->coords.empty())
+					ByteReader::invalidData();
+				auto* text = static_cast<TextObject*>(object);
+				text->setHorizontalAlignment(TextObject::HorizontalAlignment(in.readCount(TextObject::AlignRight)));
+				text->setVerticalAlignment(TextObject::VerticalAlignment(in.readCount(TextObject::AlignBottom)));
+				if (flags & flag_box_size)
+				{
+					auto const width = in.readNative();
+					auto const height = in.readNative();
+					auto const size = MapCoord::fromNative(width, height);
+					// Cf. Object::load(): The box size is kept in the second coord.
+					object->coords.resize(1);
+					object->coords.push_back(size);
+					text->setBoxSize(size);
+				}
+				text->setText(in.readString());
+			}
+			else if (type == Object::Path)
+			{
+				auto* path = static_cast<PathObject*>(object);
+				path->setPatternRotation(in.readDouble());
+				auto const origin_x = in.readNative();
+				auto const origin_y = in.readNative();
+				path->setPatternOrigin(MapCoord::fromNative(origin_x, origin_y));
+				path->recalculateParts();
+			}
+			object->output_dirty = true;
+
+			if ( object->coords.empty()
+			     || !object->coords.front().isRegular()
+			     || !object->coords.back().isRegular() )
+			{
+				map->markAsIrregular(object);
+			}
+		}
+	}
+}
+
+
+}  // namespace OpenOrienteering
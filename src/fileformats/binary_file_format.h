@@ -0,0 +1,75 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef OPENORIENTEERING_BINARY_FILE_FORMAT_H
+#define OPENORIENTEERING_BINARY_FILE_FORMAT_H
+
+#include <memory>
+
+#include <QString>
+
+#include "fileformats/file_format.h"
+
+namespace OpenOrienteering {
+
+class Exporter;
+class Importer;
+class Map;
+class MapView;
+
+
+/**
+ * A compact binary variant of the native map format.
+ * 
+ * A file starts with a magic number and a container version. It is followed
+ * by a regular XML map document which holds everything but the map objects,
+ * and by a binary section which holds the objects of all map parts.
+ * The binary section uses variable-length integers, delta-encoded
+ * coordinates, and a string table for object tags.
+ */
+class BinaryFileFormat : public FileFormat
+{
+public:
+	/** The magic number at the start of a file. */
+	static const char magic[4];
+	
+	/** The container version created by this implementation. */
+	static const int current_version;
+	
+	
+	/** Creates a new file format of type Binary. */
+	BinaryFileFormat();
+	
+	
+	/** Returns true for data starting with the magic number. */
+	ImportSupportAssumption understands(const char* buffer, int size) const override;
+	
+	
+	/** Creates an importer for binary map files. */
+	std::unique_ptr<Importer> makeImporter(const QString& path, Map* map, MapView* view) const override;
+	
+	/** Creates an exporter for binary map files. */
+	std::unique_ptr<Exporter> makeExporter(const QString& path, const Map* map, const MapView* view) const override;
+	
+};
+
+
+}  // namespace OpenOrienteering
+
+#endif // OPENORIENTEERING_BINARY_FILE_FORMAT_H
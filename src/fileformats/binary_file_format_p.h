@@ -0,0 +1,85 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef OPENORIENTEERING_BINARY_FILE_FORMAT_P_H
+#define OPENORIENTEERING_BINARY_FILE_FORMAT_P_H
+
+#include <QByteArray>
+#include <QCoreApplication>
+#include <QString>
+
+#include "fileformats/xml_file_format_p.h"
+
+namespace OpenOrienteering {
+
+class Map;
+class MapView;
+class Object;
+
+
+/**
+ * Map exporter for the binary map format.
+ * 
+ * Everything but the map objects is written by the XML exporter.
+ */
+class BinaryFileExporter : public XMLFileExporter
+{
+	Q_DECLARE_TR_FUNCTIONS(OpenOrienteering::BinaryFileExporter)
+	
+public:
+	BinaryFileExporter(const QString& path, const Map* map, const MapView* view);
+	~BinaryFileExporter() override;
+	
+protected:
+	bool exportImplementation() override;
+	
+	/** Writes the map parts without their objects. */
+	void exportMapParts() override;
+	
+};
+
+
+/**
+ * Map importer for the binary map format.
+ * 
+ * Everything but the map objects is read by the XML importer.
+ */
+class BinaryFileImporter : public XMLFileImporter
+{
+	Q_DECLARE_TR_FUNCTIONS(OpenOrienteering::BinaryFileImporter)
+	
+public:
+	BinaryFileImporter(const QString& path, Map* map, MapView* view);
+	~BinaryFileImporter() override;
+	
+protected:
+	bool importImplementation() override;
+	
+	/**
+	 * Reads the objects of all map parts from the binary section
+	 * which starts at the given position.
+	 */
+	void importObjects(const QByteArray& data, int pos);
+	
+};
+
+
+}  // namespace OpenOrienteering
+
+#endif // OPENORIENTEERING_BINARY_FILE_FORMAT_P_H
@@ -20,6 +20,8 @@
 
 #include "file_format.h"
 
+#include <utility>
+
 #include "file_import_export.h"
 
 
@@ -62,6 +64,22 @@ void FileFormat::addExtension(const QString& file_extension)
 	format_filter = QString::fromLatin1("%1 (*.%2)").arg(format_description, file_extensions.join(QString::fromLatin1(" *.")));
 }
 
+void FileFormat::deferExtensions(std::function<QStringList ()> loader)
+{
+	extension_loader = std::move(loader);
+}
+
+void FileFormat::loadDeferredExtensions() const
+{
+	std::call_once(extensions_loaded, [this]() {
+		// Formats are created non-const, and the extensions are logically
+		// part of the constant state.
+		auto* self = const_cast<FileFormat*>(this);
+		for (const auto& extension : extension_loader())
+			self->addExtension(extension);
+	});
+}
+
 
 bool FileFormat::supportsReading() const
 {
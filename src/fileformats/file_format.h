@@ -22,7 +22,9 @@
 #define OPENORIENTEERING_FILE_FORMAT_H
 
 #include <exception>
+#include <functional>
 #include <memory>
+#include <mutex>
 
 #include <QtGlobal>
 #include <QByteArray>
@@ -184,6 +186,21 @@ public:
 	 */
 	void addExtension(const QString& file_extension);
 	
+	/** Defers the registration of file name extensions until first use.
+	 * 
+	 *  The given function is called at most once, when the extensions or the
+	 *  filter are needed for the first time. The returned extensions are
+	 *  added with addExtension(). This avoids expensive setup at program
+	 *  start, e.g. of GDAL drivers, for formats which are not used.
+	 * 
+	 *  This must be called from the constructor of the derived class.
+	 */
+	void deferExtensions(std::function<QStringList ()> loader);
+	
+	/** Returns true if the extensions are determined by deferExtensions().
+	 */
+	bool hasDeferredExtensions() const { return bool(extension_loader); }
+	
 	/** Returns the type of file.
 	 */
 	FileType fileType() const;
@@ -286,12 +303,16 @@ public:
 	virtual std::unique_ptr<Exporter> makeExporter(const QString& path, const Map* map, const MapView* view) const;
 	
 private:
+	void loadDeferredExtensions() const;
+	
 	FileType file_type;
 	const char* format_id;
 	QString format_description;
 	QStringList file_extensions;
 	QString format_filter;
 	Features format_features;
+	std::function<QStringList ()> extension_loader;
+	mutable std::once_flag extensions_loaded;
 };
 
 
@@ -351,6 +372,8 @@ const QString& FileFormat::description() const
 inline
 const QString& FileFormat::primaryExtension() const
 {
+	if (extension_loader)
+		loadDeferredExtensions();
 	Q_ASSERT(file_extensions.size() > 0); // by constructor
 	return file_extensions[0];
 }
@@ -358,12 +381,16 @@ const QString& FileFormat::primaryExtension() const
 inline
 const QStringList& FileFormat::fileExtensions() const
 {
+	if (extension_loader)
+		loadDeferredExtensions();
 	return file_extensions;
 }
 
 inline
 const QString& FileFormat::filter() const
 {
+	if (extension_loader)
+		loadDeferredExtensions();
 	return format_filter;
 }
 
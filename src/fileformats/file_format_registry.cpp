@@ -52,6 +52,11 @@ void FileFormatRegistry::registerFormat(FileFormat *format)
 {
 	fmts.push_back(format);
 	if (fmts.size() == 1) default_format_id = format->id();
+	if (format->hasDeferredExtensions())
+	{
+		// Checking the extensions would defeat deferring them.
+		return;
+	}
 	if (format->supportsReading())
 	{
 		// There must be at least one one format for a filename with the registered extension.
@@ -49,6 +49,7 @@
 #include "fileformats/file_format.h"
 #include "templates/template.h"
 #include "templates/template_placeholder.h"
+#include "util/block_buffered_device.h"
 
 
 namespace OpenOrienteering {
@@ -93,17 +94,43 @@ void Importer::setLoadSymbolsOnly(bool value)
 	load_symbols_only = value;
 }
 
+void Importer::setLoadTemplatesInBackground(bool value)
+{
+	load_templates_in_background = value;
+}
+
+
+void Importer::setProgressHandler(const ProgressHandler& handler)
+{
+	progress_handler = handler;
+}
+
+
+void Importer::reportProgress(int percent)
+{
+	percent = qBound(0, percent, 100);
+	if (progress_handler && percent != last_progress)
+	{
+		last_progress = percent;
+		progress_handler(percent);
+	}
+}
+
 
 bool Importer::doImport()
 {
 	std::unique_ptr<QFile> managed_file;
+	std::unique_ptr<BlockBufferedDevice> buffered_file;
 	QScopedValueRollback<QIODevice*> original_device{device_};
 	if (supportsQIODevice())
 	{
 		if (!device_)
 		{
+			// Large blocks and read-ahead make slow storage fast enough.
 			managed_file = std::make_unique<QFile>(path);
-			device_ = managed_file.get();
+			buffered_file = std::make_unique<BlockBufferedDevice>(managed_file.get());
+			buffered_file->setReadAhead(true);
+			device_ = buffered_file.get();
 		}
 		if (!device_->isOpen() && !device_->open(QIODevice::ReadOnly))
 		{
@@ -122,6 +149,7 @@ bool Importer::doImport()
 			return false;
 		}
 		validate();
+		reportProgress(100);
 	}
 	catch (std::exception &e)
 	{
@@ -249,7 +277,9 @@ void Importer::validate()
 			continue;
 		}
 		
-		if (!temp->loadTemplateFile(false))
+		auto const loaded = load_templates_in_background ? temp->loadTemplateFileInBackground()
+		                                                 : temp->loadTemplateFile(false);
+		if (!loaded)
 		{
 			addWarning(tr("Failed to load template '%1', reason: %2")
 			           .arg(temp->getTemplateFilename(), temp->errorString()));
@@ -302,13 +332,15 @@ Exporter::~Exporter() = default;
 bool Exporter::doExport()
 {
 	std::unique_ptr<QSaveFile> managed_file;
+	std::unique_ptr<BlockBufferedDevice> buffered_file;
 	QScopedValueRollback<QIODevice*> original_device{device_};
 	if (supportsQIODevice())
 	{
 		if (!device_)
 		{
 			managed_file = std::make_unique<QSaveFile>(path);
-			device_ = managed_file.get();
+			buffered_file = std::make_unique<BlockBufferedDevice>(managed_file.get());
+			device_ = buffered_file.get();
 		}
 		if (!device_->isOpen() && !device_->open(QIODevice::WriteOnly))
 		{
@@ -324,6 +356,11 @@ bool Exporter::doExport()
 			Q_ASSERT(!warnings().empty());
 			return false;
 		}
+		if (buffered_file && !buffered_file->flush())
+		{
+			addWarning(tr("Cannot save file\n%1:\n%2").arg(path, buffered_file->errorString()));
+			return false;
+		}
 		if (managed_file && !managed_file->commit())
 		{
 			addWarning(tr("Cannot save file\n%1:\n%2").arg(path, managed_file->errorString()));
@@ -331,7 +368,8 @@ bool Exporter::doExport()
 		}
 #ifdef Q_OS_ANDROID
 		// Make the MediaScanner aware of the *updated* file.
-		if (auto* file_device = qobject_cast<QFileDevice*>(device_))
+		auto* file_device = managed_file ? managed_file.get() : qobject_cast<QFileDevice*>(device_);
+		if (file_device)
 		{
 			const auto file_info = QFileInfo(file_device->fileName());
 			Android::mediaScannerScanFile(file_info.absolutePath());
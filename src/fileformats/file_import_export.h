@@ -21,6 +21,7 @@
 #ifndef OPENORIENTEERING_IMPORT_EXPORT_H
 #define OPENORIENTEERING_IMPORT_EXPORT_H
 
+#include <functional>
 #include <vector>
 
 #include <QCoreApplication>
@@ -174,6 +175,34 @@ public:
 	 */
 	void setLoadSymbolsOnly(bool value);
 	
+	/**
+	 * Returns true if templates are to be loaded in the background.
+	 */
+	bool loadTemplatesInBackground() const noexcept { return load_templates_in_background; }
+	
+	/**
+	 * If set to true, visible templates are loaded on worker threads when the
+	 * import is finished, so that the map can be used before all templates
+	 * are loaded. Errors are not reported as warnings then.
+	 * 
+	 * \see Template::loadTemplateFileInBackground()
+	 */
+	void setLoadTemplatesInBackground(bool value);
+	
+	
+	/**
+	 * A function which receives the import progress in percent.
+	 */
+	using ProgressHandler = std::function<void (int percent)>;
+	
+	/**
+	 * Sets a function which is called while the import makes progress.
+	 * 
+	 * The handler is called from the thread running doImport(). It may process
+	 * events, but it must not access the map which is being imported.
+	 */
+	void setProgressHandler(const ProgressHandler& handler);
+	
 	
 	/**
 	 * Imports the map and view.
@@ -237,6 +266,13 @@ protected:
 	 */
 	virtual void importFailed();
 	
+	/**
+	 * Reports the progress of the import, in percent.
+	 * 
+	 * The progress handler is called only when the value changed.
+	 */
+	void reportProgress(int percent);
+	
 	
 protected:
 	/// The input path
@@ -253,6 +289,15 @@ private:
 	/// A flag which controls whether only symbols and colors are imported.
 	bool load_symbols_only = false;
 	
+	/// A flag which controls whether templates are loaded in the background.
+	bool load_templates_in_background = false;
+	
+	/// The function receiving the progress, if any.
+	ProgressHandler progress_handler;
+	
+	/// The last progress value passed to the progress handler.
+	int last_progress = -1;
+	
 };
 
 
@@ -51,6 +51,7 @@
 #include "templates/template.h"
 #include "templates/template_image.h"
 #include "templates/template_map.h"
+#include "util/concurrency.h"
 #include "util/encoding.h"
 #include "util/util.h"
 
@@ -306,6 +307,9 @@ bool OCAD8FileImport::importImplementation()
 
 		// Place all objects into a single OCAD import part
 		MapPart* part = new MapPart(tr("OCAD import layer"), map);
+		
+		// Buffer the object index, so that objects may be converted concurrently.
+		std::vector<const OCADObject*> ocad_objects;
 		for (OCADObjectIndex *idx = ocad_objidx_first(file); idx; idx = ocad_objidx_next(file, idx))
 		{
 			for (int i = 0; i < 256; i++)
@@ -313,14 +317,10 @@ bool OCAD8FileImport::importImplementation()
 				OCADObjectEntry *entry = ocad_object_entry_at(file, idx, i);
 				OCADObject *ocad_obj = ocad_object(file, entry);
 				if (ocad_obj)
-				{
-					Object *object = importObject(ocad_obj, part);
-					if (object) {
-						part->objects.push_back(object);
-					}
-				}
+					ocad_objects.push_back(ocad_obj);
 			}
 		}
+		importObjectList(ocad_objects, part);
 		delete map->parts[0];
 		map->parts[0] = part;
 		map->current_part_index = 0;
@@ -955,7 +955,58 @@ void OCAD8FileImport::fillCommonSymbolFields(Symbol *symbol, const OCADSymbol *o
 		symbol->setHidden(true);
 }
 
-Object *OCAD8FileImport::importObject(const OCADObject* ocad_object, MapPart* part)
+void OCAD8FileImport::importObjectList(const std::vector<const OCADObject*>& ocad_objects, MapPart* part)
+{
+	auto const num_objects = ocad_objects.size();
+	std::vector<Object*> converted(num_objects, nullptr);
+	std::vector<bool> concurrent(num_objects);
+	for (std::size_t i = 0; i < num_objects; ++i)
+		concurrent[i] = canImportConcurrently(*ocad_objects[i]);
+	
+	// Independent objects are converted concurrently, in chunks.
+	Concurrency::parallelFor(0, int(num_objects), [&](int i) {
+		auto const index = std::size_t(i);
+		if (concurrent[index])
+			converted[index] = importObject(ocad_objects[index], nullptr);
+	}, 64);
+	
+	// The other objects may need to add warnings or to modify symbols.
+	// They are converted in file order, so that rectangle objects keep their position.
+	std::vector<Object*> objects;
+	objects.reserve(num_objects);
+	for (std::size_t i = 0; i < num_objects; ++i)
+	{
+		auto* object = concurrent[i] ? converted[i] : importObject(ocad_objects[i], &objects);
+		if (object)
+			objects.push_back(object);
+	}
+	part->addObjects(objects);
+}
+
+bool OCAD8FileImport::canImportConcurrently(const OCADObject& ocad_object) const
+{
+	auto const* symbol = symbol_index.value(ocad_object.symbol);
+	if (!symbol)
+		return false;
+	
+	switch (symbol->getType())
+	{
+	case Symbol::Point:
+		// Not when importObject() needs to make the symbol rotatable.
+		return ocad_object.angle == 0
+		       || symbol->asPoint()->isRotatable()
+		       || symbol->asPoint()->isSymmetrical();
+	case Symbol::Line:
+	case Symbol::Area:
+	case Symbol::Combined:
+		return true;
+	default:
+		// Text objects may need to add warnings.
+		return false;
+	}
+}
+
+Object *OCAD8FileImport::importObject(const OCADObject* ocad_object, std::vector<Object*>* objects)
 {
 	Symbol* symbol;
     if (!symbol_index.contains(ocad_object->symbol))
@@ -976,7 +1027,8 @@ Object *OCAD8FileImport::importObject(const OCADObject* ocad_object, MapPart* pa
 		}
 		else
 		{
-			if (!importRectangleObject(ocad_object, part, rectangle_info[ocad_object->symbol]))
+			Q_ASSERT(objects);
+			if (!importRectangleObject(ocad_object, *objects, rectangle_info[ocad_object->symbol]))
 				addWarning(tr("Unable to import rectangle object"));
 			return nullptr;
 		}
@@ -1047,7 +1099,7 @@ Object *OCAD8FileImport::importObject(const OCADObject* ocad_object, MapPart* pa
     return nullptr;
 }
 
-bool OCAD8FileImport::importRectangleObject(const OCADObject* ocad_object, MapPart* part, const OCAD8FileImport::RectangleInfo& rect)
+bool OCAD8FileImport::importRectangleObject(const OCADObject* ocad_object, std::vector<Object*>& objects, const OCAD8FileImport::RectangleInfo& rect)
 {
 	if (ocad_object->npts != 4)
 		return false;
@@ -1115,7 +1167,7 @@ bool OCAD8FileImport::importRectangleObject(const OCADObject* ocad_object, MapPa
 	}
 	PathObject *border_path = new PathObject(rect.border_line, coords, map);
 	border_path->parts().front().setClosed(true, false);
-	part->objects.push_back(border_path);
+	objects.push_back(border_path);
 	
 	if (rect.has_grid && rect.cell_width > 0 && rect.cell_height > 0)
 	{
@@ -1136,7 +1188,7 @@ bool OCAD8FileImport::importRectangleObject(const OCADObject* ocad_object, MapPa
 			coords[1] = MapCoord(bottom_left_f + x * cell_width * right);
 			
 			PathObject *path = new PathObject(rect.inner_line, coords, map);
-			part->objects.push_back(path);
+			objects.push_back(path);
 		}
 		for (int y = 1; y < num_cells_y; ++y)
 		{
@@ -1144,7 +1196,7 @@ bool OCAD8FileImport::importRectangleObject(const OCADObject* ocad_object, MapPa
 			coords[1] = MapCoord(top_right_f + y * cell_height * down);
 			
 			PathObject *path = new PathObject(rect.inner_line, coords, map);
-			part->objects.push_back(path);
+			objects.push_back(path);
 		}
 		
 		// Create grid text
@@ -1176,7 +1228,7 @@ bool OCAD8FileImport::importRectangleObject(const OCADObject* ocad_object, MapPa
 					double position_x = (x + 0.07f) * cell_width;
 					double position_y = (y + 0.04f) * cell_height + rect.text->getFontMetrics().ascent() / rect.text->calculateInternalScaling() - rect.text->getFontSize();
 					object->setAnchorPosition(top_left_f + position_x * right + position_y * down);
-					part->objects.push_back(object);
+					objects.push_back(object);
 					
 					//pts[0].Y -= rectinfo.gridText.FontAscent - rectinfo.gridText.FontEmHeight;
 				}
@@ -1455,7 +1507,7 @@ bool OCAD8FileImport::fillTextPathCoords(TextObject *object, TextSymbol *symbol,
  */
 QString OCAD8FileImport::convertPascalString(const char *p) {
     int len = *((unsigned char *)p);
-    return encoding_1byte->toUnicode((p + 1), len);
+    return Util::toUnicode(encoding_1byte, p + 1, len);
 }
 
 /** Converts a single-byte-per-character, zero-terminated string to a QString.
@@ -1475,7 +1527,7 @@ QString OCAD8FileImport::convertCString(const char *p, std::size_t n, bool ignor
 		p += 2;
 		i -= 2;
 	}
-    return encoding_1byte->toUnicode(p, i);
+    return Util::toUnicode(encoding_1byte, p, int(i));
 }
 
 /** Converts a two-byte-per-character, zero-terminated string to a QString. By default,
@@ -1498,7 +1550,7 @@ QString OCAD8FileImport::convertWideCString(const char *p, std::size_t n, bool i
 		p += 4;
 		i -= 2;
 	}
-    return encoding_2byte->toUnicode(p, i * 2);
+    return Util::toUnicode(encoding_2byte, p, int(i * 2));
 }
 
 float OCAD8FileImport::convertRotation(int angle) {
@@ -22,6 +22,7 @@
 #define OPENORIENTEERING_FILE_FORMAT_OCAD_P_H
 
 #include <set>
+#include <vector>
 
 #include <QCoreApplication>
 #include <QRgb>
@@ -89,8 +90,11 @@ protected:
 	RectangleInfo *importRectSymbol(const OCADRectSymbol *ocad_symbol);
 
 	// Object import
-	Object *importObject(const OCADObject *ocad_object, MapPart* part);
-	bool importRectangleObject(const OCADObject* ocad_object, MapPart* part, const RectangleInfo& rect);
+	void importObjectList(const std::vector<const OCADObject*>& ocad_objects, MapPart* part);
+	bool canImportConcurrently(const OCADObject& ocad_object) const;
+	/// Rectangle objects are appended to objects, which must not be null for them.
+	Object *importObject(const OCADObject *ocad_object, std::vector<Object*>* objects);
+	bool importRectangleObject(const OCADObject* ocad_object, std::vector<Object*>& objects, const RectangleInfo& rect);
 
 	// String import
 	virtual void importString(OCADStringEntry *entry);
@@ -79,6 +79,7 @@
 #include "fileformats/ocd_types_v11.h"  // IWYU pragma: keep
 #include "fileformats/ocd_types_v12.h"  // IWYU pragma: keep
 #include "templates/template.h"
+#include "util/concurrency.h"
 #include "util/encoding.h"
 #include "util/util.h"
 
@@ -989,6 +990,7 @@ void OcdFileExport::exportSymbols(OcdFile<Format>& file)
 	}
 	
 	// Third pass: Actual export
+	OcdIcon::prepareIcons(*map);
 	for (int i = 0; i < num_symbols; ++i)
 	{
 		QByteArray ocd_symbol;
@@ -2173,6 +2175,10 @@ QByteArray OcdFileExport::exportCombinedLineSymbol(
 template<class Format>
 void OcdFileExport::exportObjects(OcdFile<Format>& file)
 {
+	// Prepare the objects on this thread: Updating objects is not thread-safe.
+	std::vector<const Object*> objects;
+	std::vector<std::unique_ptr<Object>> duplicates;
+	objects.reserve(std::size_t(map->getNumObjects()));
 	for (int l = 0; l < map->getNumParts(); ++l)
 	{
 		auto part = map->getPart(std::size_t(l));
@@ -2180,40 +2186,87 @@ void OcdFileExport::exportObjects(OcdFile<Format>& file)
 		{
 			const auto* object = part->getObject(o);
 			
-			std::unique_ptr<Object> duplicate;
 			if (area_offset.nativeX() != 0 || area_offset.nativeY() != 0)
 			{
 				// Create a safely managed duplicate and move it as needed.
-				duplicate.reset(object->duplicate());
-				duplicate->move(-area_offset);  /// \todo move pattern origin etc.
-				object = duplicate.get();
+				duplicates.emplace_back(object->duplicate());
+				duplicates.back()->move(-area_offset);  /// \todo move pattern origin etc.
+				object = duplicates.back().get();
 			}
 			object->update();
+			objects.push_back(object);
 			
-			QByteArray ocd_object;
-			auto entry = typename Format::Object::IndexEntryType {};
-			
-			switch (object->getType())
+			if (object->getType() == Object::Path
+			    && object->getSymbol()
+			    && object->getSymbol()->getType() == Symbol::Area
+			    && static_cast<const PathObject*>(object)->getPatternOrigin() != MapCoord(0, 0))
 			{
-			case Object::Point:
-				ocd_object = exportPointObject<typename Format::Object>(static_cast<const PointObject*>(object), entry);
-				Q_ASSERT(!ocd_object.isEmpty());
-				file.objects().insert(ocd_object, entry);
-				break;
-				
-			case Object::Path:
-				exportPathObject<Format>(file, static_cast<const PathObject*>(object));
-				break;
-				
-			case Object::Text:
-				ocd_object = exportTextObject<typename Format::Object>(static_cast<const TextObject*>(object), entry);
-				Q_ASSERT(!ocd_object.isEmpty());
-				file.objects().insert(ocd_object, entry);
-				break;
+				addWarning(::OpenOrienteering::OcdFileExport::tr("Unable to export fill pattern shift for an area object"));
 			}
-			
 		}
 	}
+	
+	dominant_colors.clear();
+	for (int i = 0; i < map->getNumSymbols(); ++i)
+	{
+		auto const* symbol = map->getSymbol(i);
+		dominant_colors[symbol] = convertColor(symbol->guessDominantColor());
+	}
+	
+	// Point and path objects are encoded concurrently, in chunks.
+	// Text objects use the text layout and may add warnings.
+	auto const num_objects = objects.size();
+	std::vector<ObjectRecords<Format>> records(num_objects);
+	Concurrency::parallelFor(0, int(num_objects), [this, &objects, &records](int i) {
+		auto const index = std::size_t(i);
+		if (objects[index]->getType() != Object::Text)
+			exportObject<Format>(records[index], objects[index]);
+	}, 64);
+	for (std::size_t i = 0; i < num_objects; ++i)
+	{
+		if (objects[i]->getType() == Object::Text)
+			exportObject<Format>(records[i], objects[i]);
+	}
+	
+	// Insert all objects in map order, in a single layout pass.
+	std::size_t num_records = 0;
+	for (const auto& object_records : records)
+		num_records += object_records.size();
+	ObjectRecords<Format> all_records;
+	all_records.reserve(num_records);
+	for (auto& object_records : records)
+	{
+		std::move(begin(object_records), end(object_records), std::back_inserter(all_records));
+		object_records = {};
+	}
+	file.objects().insert(all_records);
+}
+
+
+template<class Format>
+void OcdFileExport::exportObject(ObjectRecords<Format>& records, const Object* object)
+{
+	QByteArray ocd_object;
+	auto entry = typename Format::Object::IndexEntryType {};
+	
+	switch (object->getType())
+	{
+	case Object::Point:
+		ocd_object = exportPointObject<typename Format::Object>(static_cast<const PointObject*>(object), entry);
+		Q_ASSERT(!ocd_object.isEmpty());
+		records.emplace_back(ocd_object, entry);
+		break;
+		
+	case Object::Path:
+		exportPathObject<Format>(records, static_cast<const PathObject*>(object));
+		break;
+		
+	case Object::Text:
+		ocd_object = exportTextObject<typename Format::Object>(static_cast<const TextObject*>(object), entry);
+		Q_ASSERT(!ocd_object.isEmpty());
+		records.emplace_back(ocd_object, entry);
+		break;
+	}
 }
 
 
@@ -2226,7 +2279,10 @@ void OcdFileExport::handleObjectExtras(const Object* object, OcdObject& ocd_obje
 	// Extra entry members since V9
 	entry.type = ocd_object.type;
 	entry.status = Ocd::ObjectNormal;
-	entry.color = convertColor(object->getSymbol()->guessDominantColor());
+	auto const dominant_color = dominant_colors.find(object->getSymbol());
+	entry.color = (dominant_color != end(dominant_colors))
+	              ? dominant_color->second
+	              : convertColor(object->getSymbol()->guessDominantColor());
 }
 
 
@@ -2250,14 +2306,14 @@ QByteArray OcdFileExport::exportPointObject(const PointObject* point, typename O
 {
 	OcdObject ocd_object = {};
 	ocd_object.type = 1;
-	ocd_object.symbol = entry.symbol = decltype(entry.symbol)(symbol_numbers[point->getSymbol()]);
+	ocd_object.symbol = entry.symbol = decltype(entry.symbol)(symbolNumber(point->getSymbol()));
 	ocd_object.angle = decltype(ocd_object.angle)(convertRotation(point->getRotation()));
 	return exportObjectCommon(point, ocd_object, entry);
 }
 
 
 template< class Format >
-void OcdFileExport::exportPathObject(OcdFile<Format>& file, const PathObject* path, bool lines_only)
+void OcdFileExport::exportPathObject(ObjectRecords<Format>& records, const PathObject* path, bool lines_only)
 {
 	typename Format::Object ocd_object = {};
 	typename Format::Object::IndexEntryType entry = {};
@@ -2273,8 +2329,7 @@ void OcdFileExport::exportPathObject(OcdFile<Format>& file, const PathObject* pa
 		{
 			if (static_cast<const AreaSymbol*>(symbol)->hasRotatableFillPattern())
 				ocd_object.angle = decltype(ocd_object.angle)(convertRotation(path->getPatternRotation()));
-			if (path->getPatternOrigin() != MapCoord(0, 0))
-				addWarning(::OpenOrienteering::OcdFileExport::tr("Unable to export fill pattern shift for an area object"));
+			// A pattern shift is reported by exportObjects().
 		}
 	}
 	else
@@ -2286,7 +2341,7 @@ void OcdFileExport::exportPathObject(OcdFile<Format>& file, const PathObject* pa
 	
 	if (!need_split_lines)
 	{
-		ocd_object.symbol = entry.symbol = decltype(entry.symbol)(symbol_numbers[symbol]);
+		ocd_object.symbol = entry.symbol = decltype(entry.symbol)(symbolNumber(symbol));
 		auto data = exportObjectCommon(path, ocd_object, entry);
 		Q_ASSERT(!data.isEmpty());
 		
@@ -2294,7 +2349,7 @@ void OcdFileExport::exportPathObject(OcdFile<Format>& file, const PathObject* pa
 		if (breakdown_index_entry == end(breakdown_index))
 		{
 			// Regular symbol which does not need to be split
-			file.objects().insert(data, entry);
+			records.emplace_back(data, entry);
 			return;
 		}
 		
@@ -2329,7 +2384,7 @@ void OcdFileExport::exportPathObject(OcdFile<Format>& file, const PathObject* pa
 				exported_ocd_object.symbol = entry.symbol = decltype(entry.symbol)(breakdown->number);
 				exported_ocd_object.type = decltype(exported_ocd_object.type)(breakdown->type);
 				handleObjectExtras(path, exported_ocd_object, entry);  // update entry.type if it exists
-				file.objects().insert(data, entry);
+				records.emplace_back(data, entry);
 			}
 			
 			if (backlog.empty())
@@ -2347,7 +2402,7 @@ void OcdFileExport::exportPathObject(OcdFile<Format>& file, const PathObject* pa
 			PathObject split_line{part};
 			split_line.setSymbol(path->getSymbol(), true);
 			split_line.update();
-			exportPathObject(file, &split_line, true);
+			exportPathObject<Format>(records, &split_line, true);
 		}
 	}
 	
@@ -2521,6 +2576,13 @@ quint16 OcdFileExport::convertColor(const MapColor* color) const
 }
 
 
+quint32 OcdFileExport::symbolNumber(const Symbol* symbol) const
+{
+	auto const number = symbol_numbers.find(symbol);
+	return (number != end(symbol_numbers)) ? number->second : 0;
+}
+
+
 quint16 OcdFileExport::getPointSymbolExtent(const PointSymbol* symbol) const
 {
 	if (!symbol)
@@ -27,6 +27,7 @@
 #include <functional>
 #include <memory>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include <QtGlobal>
@@ -251,9 +252,17 @@ protected:
 	        const LineSymbol* double_line );
 	
 	
+	/// Encoded objects and their index entries, ready for insertion.
+	template< class Format >
+	using ObjectRecords = std::vector<std::pair<QByteArray, typename Format::Object::IndexEntryType>>;
+	
 	template< class Format >
 	void exportObjects(OcdFile<Format>& file);
 	
+	/// Encodes a single object. Thread-safe except for text objects.
+	template< class Format >
+	void exportObject(ObjectRecords<Format>& records, const Object* object);
+	
 	template< class OcdObject >
 	void handleObjectExtras(const Object* object, OcdObject& ocd_object, typename OcdObject::IndexEntryType& entry);
 	
@@ -261,7 +270,7 @@ protected:
 	QByteArray exportPointObject(const PointObject* point, typename OcdObject::IndexEntryType& entry);
 	
 	template< class Format >
-	void exportPathObject(OcdFile<Format>& file, const PathObject* path, bool lines_only = false);
+	void exportPathObject(ObjectRecords<Format>& records, const PathObject* path, bool lines_only = false);
 	
 	template< class OcdObject >
 	QByteArray exportTextObject(const TextObject* text, typename OcdObject::IndexEntryType& entry);
@@ -284,6 +293,9 @@ protected:
 	
 	quint16 convertColor(const MapColor* color) const;
 	
+	/// Returns the OCD symbol number, or 0 for unknown symbols.
+	quint32 symbolNumber(const Symbol* symbol) const;
+	
 	quint16 getPointSymbolExtent(const PointSymbol* symbol) const;
 	
 	quint16 exportCoordinates(const MapCoordVector& coords, const Symbol* symbol, QByteArray& byte_array);
@@ -316,6 +328,9 @@ private:
 	
 	std::unordered_map<const Symbol*, quint32> symbol_numbers;
 	
+	/// The converted dominant colors of the map's symbols, for object index entries.
+	std::unordered_map<const Symbol*, quint16> dominant_colors;
+	
 	struct TextFormatMapping
 	{
 		const Symbol* symbol;
@@ -26,7 +26,6 @@
 #include <cmath>
 #include <iterator>
 #include <limits>
-#include <memory>
 #include <stdexcept>
 #include <type_traits>
 #include <vector>
@@ -38,6 +37,7 @@
 #include <QCoreApplication>
 #include <QDebug>
 #include <QDir>
+#include <QFileDevice>
 #include <QFileInfo>
 #include <QFlags>
 #include <QFontMetricsF>
@@ -48,8 +48,8 @@
 #include <QLatin1String>
 #include <QList>
 #include <QPointF>
+#include <QRectF>
 #include <QTextCodec>
-#include <QTextDecoder>
 #include <QVariant>
 
 #include "settings.h"
@@ -79,6 +79,8 @@
 #include "templates/template.h"
 #include "templates/template_image.h"
 #include "templates/template_map.h"
+#include "util/block_buffered_device.h"
+#include "util/concurrency.h"
 #include "util/encoding.h"
 #include "util/util.h"
 
@@ -95,6 +97,62 @@ static QTextCodec* codecFromSettings()
 }	
 
 
+/**
+ * Maps the remaining data of a file device into memory, and sets up a byte
+ * array which refers to the mapped data without copying.
+ * 
+ * The byte array is cleared before the data is unmapped on destruction.
+ * Nothing is mapped if the device is not a file, or if mapping fails.
+ * A file behind a BlockBufferedDevice is mapped, too.
+ */
+class MappedBuffer
+{
+public:
+	MappedBuffer(QIODevice* device, QByteArray& buffer)
+	: file { qobject_cast<QFileDevice*>(sourceDevice(device)) }
+	, buffer { buffer }
+	{
+		if (!file || file->isSequential())
+			return;
+		
+		auto const offset = device->pos();
+		auto const size = file->size() - offset;
+		if (size <= 0 || size > std::numeric_limits<int>::max())
+			return;
+		
+		data = file->map(offset, size);
+		if (data)
+			buffer = QByteArray::fromRawData(reinterpret_cast<const char*>(data), int(size));
+	}
+	
+	MappedBuffer(const MappedBuffer&) = delete;
+	MappedBuffer& operator=(const MappedBuffer&) = delete;
+	
+	~MappedBuffer()
+	{
+		if (data)
+		{
+			buffer.clear();
+			file->unmap(data);
+		}
+	}
+	
+	bool isMapped() const noexcept { return data != nullptr; }
+	
+private:
+	static QIODevice* sourceDevice(QIODevice* device)
+	{
+		if (auto* buffered = qobject_cast<BlockBufferedDevice*>(device))
+			return buffered->sourceDevice();
+		return device;
+	}
+	
+	QFileDevice* file;
+	QByteArray& buffer;
+	uchar* data = nullptr;
+};
+
+
 }  // namespace
 
 
@@ -113,6 +171,7 @@ OcdFileImport::OcdFileImport(const QString& path, Map* map, MapView* view)
 		addWarning(tr("Encoding '%1' is not available. Check the settings."));
 		custom_8bit_encoding = QTextCodec::codecForLocale();
 	}
+	setOption(QString::fromLatin1("importArea"), QRectF());
 }
 
 OcdFileImport::~OcdFileImport() = default;
@@ -127,7 +186,7 @@ void OcdFileImport::setCustom8BitEncoding(QTextCodec* encoding)
 template< unsigned char N >
 QString OcdFileImport::convertOcdString(const Ocd::PascalString<N>& src) const
 {
-	return custom_8bit_encoding->toUnicode(src.data, src.length);
+	return Util::toUnicode(custom_8bit_encoding, src.data, src.length);
 }
 
 template< unsigned char N >
@@ -147,7 +206,7 @@ template< >
 QString OcdFileImport::convertOcdString< Ocd::Custom8BitEncoding >(const char* src, uint len) const
 {
 	len = qMin(uint(std::numeric_limits<int>::max()), qstrnlen(src, len));
-	return custom_8bit_encoding->toUnicode(src, int(len));
+	return Util::toUnicode(custom_8bit_encoding, src, int(len));
 }
 
 template< >
@@ -174,11 +233,7 @@ QString OcdFileImport::convertOcdString(const QChar* src, uint maxlen) const
 			--maxlen;
 		}
 	}
-	/// \todo Create and use static decoder
-	QTextCodec* utf16 = QTextCodec::codecForName("UTF-16LE");
-	Q_ASSERT(utf16);
-	auto decoder = std::unique_ptr<QTextDecoder>(utf16->makeDecoder(QTextCodec::ConvertInvalidToNull));
-	return decoder->toUnicode(reinterpret_cast<const char*>(src), 2*int(last - src));
+	return Util::fromUtf16LE(reinterpret_cast<const char*>(src), int(last - src));
 }
 
 
@@ -853,14 +908,13 @@ void OcdFileImport::importObjects(const OcdFile<Ocd::FormatV8>& file)
 	MapPart* part = map->getCurrentPart();
 	Q_ASSERT(part);
 	
+	std::vector<const Ocd::FormatV8::Object*> ocd_objects;
 	for (auto ocd_object : file.objects())
 	{
-		if (ocd_object.entry->symbol)
-		{
-			if (auto object = importObject(*ocd_object.entity, part))
-				part->addObject(object, part->getNumObjects());
-		}
+		if (ocd_object.entry->symbol && isInImportArea(*ocd_object.entry))
+			ocd_objects.push_back(ocd_object.entity);
 	}
+	importObjectList(ocd_objects, part);
 }
 
 template< class F >
@@ -869,16 +923,97 @@ void OcdFileImport::importObjects(const OcdFile< F >& file)
 	MapPart* part = map->getCurrentPart();
 	Q_ASSERT(part);
 	
+	std::vector<const typename F::Object*> ocd_objects;
 	for (auto ocd_object : file.objects())
 	{
 		if ( ocd_object.entry->symbol
 		     && ocd_object.entry->status != Ocd::ObjectDeleted
-		     && ocd_object.entry->status != Ocd::ObjectDeletedForUndo )
+		     && ocd_object.entry->status != Ocd::ObjectDeletedForUndo
+		     && isInImportArea(*ocd_object.entry) )
 		{
-			if (auto object = importObject(*ocd_object.entity, part))
-				part->addObject(object, part->getNumObjects());
+			ocd_objects.push_back(ocd_object.entity);
 		}
 	}
+	importObjectList(ocd_objects, part);
+}
+
+template< class O >
+void OcdFileImport::importObjectList(const std::vector<const O*>& ocd_objects, MapPart* part)
+{
+	auto const num_objects = ocd_objects.size();
+	std::vector<Object*> objects(num_objects, nullptr);
+	std::vector<bool> concurrent(num_objects);
+	for (std::size_t i = 0; i < num_objects; ++i)
+		concurrent[i] = canImportConcurrently(*ocd_objects[i]);
+	
+	// Independent objects are decoded concurrently, in chunks.
+	Concurrency::parallelFor(0, int(num_objects), [&](int i) {
+		auto const index = std::size_t(i);
+		if (concurrent[index])
+			objects[index] = importObject(*ocd_objects[index], part);
+	}, 64);
+	
+	// The other objects may need to add warnings or to modify symbols.
+	for (std::size_t i = 0; i < num_objects; ++i)
+	{
+		if (!concurrent[i])
+			objects[i] = importObject(*ocd_objects[i], part);
+	}
+	
+	// Attach all objects in file order.
+	for (auto* object : objects)
+	{
+		if (object)
+			part->addObject(object, part->getNumObjects());
+	}
+}
+
+template< class E >
+bool OcdFileImport::isInImportArea(const E& entry) const
+{
+	if (!import_area.isValid())
+		return true;
+	
+	// Some writers leave the bounding box empty.
+	if (entry.bottom_left_bound.x == 0 && entry.bottom_left_bound.y == 0
+	    && entry.top_right_bound.x == 0 && entry.top_right_bound.y == 0)
+		return true;
+	
+	// OCD y axis points up, map y axis points down.
+	auto const bottom_left = MapCoordF(convertOcdPoint(entry.bottom_left_bound));
+	auto const top_right = MapCoordF(convertOcdPoint(entry.top_right_bound));
+	return bottom_left.x() <= import_area.right()
+	       && top_right.x() >= import_area.left()
+	       && top_right.y() <= import_area.bottom()
+	       && bottom_left.y() >= import_area.top();
+}
+
+template< class O >
+bool OcdFileImport::canImportConcurrently(const O& ocd_object) const
+{
+	if (ocd_object.symbol < 0)
+		return false;
+	
+	auto const* symbol = symbol_index.value(ocd_object.symbol);
+	if (!symbol)
+		return false;
+	
+	switch (symbol->getType())
+	{
+	case Symbol::Point:
+		// Not when importObject() needs to make the symbol rotatable.
+		return ocd_object.angle == 0
+		       || symbol->asPoint()->isRotatable()
+		       || symbol->asPoint()->isSymmetrical();
+	case Symbol::Line:
+		return !rectangle_info.contains(ocd_object.symbol);
+	case Symbol::Area:
+	case Symbol::Combined:
+		return true;
+	default:
+		// Text objects may need to add warnings.
+		return false;
+	}
 }
 
 
@@ -1878,7 +2013,7 @@ Object* OcdFileImport::importObject(const O& ocd_object, MapPart* part)
 	Symbol* symbol = nullptr;
 	if (ocd_object.symbol >= 0)
 	{
-		symbol = symbol_index[ocd_object.symbol];
+		symbol = symbol_index.value(ocd_object.symbol);
 	}
 	
 	if (!symbol)
@@ -2376,7 +2511,10 @@ void OcdFileImport::setFraming(OcdFileImport::OcdImportedTextSymbol* symbol, con
 
 bool OcdFileImport::importImplementation()
 {
-	buffer = device()->readAll();
+	// Decode straight from the mapped file when possible, without copying.
+	MappedBuffer mapped_buffer(device(), buffer);
+	if (!mapped_buffer.isMapped())
+		buffer = device()->readAll();
 	if (buffer.isEmpty())
 		throw FileFormatException(device()->errorString());
 	
@@ -2388,6 +2526,7 @@ bool OcdFileImport::importImplementation()
 		throw FileFormatException(tr("Invalid data."));
 	
 	ocd_version = header->version;
+	import_area = option(QString::fromLatin1("importArea")).toRectF();
 	map->setSymbolSetId(QStringLiteral("OCD"));
 	map->setProperty(OcdFileFormat::versionProperty(), ocd_version);
 	switch (ocd_version)
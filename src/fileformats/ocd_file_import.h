@@ -32,6 +32,7 @@
 #include <QCoreApplication>
 #include <QHash>
 #include <QLocale>
+#include <QRectF>
 #include <QString>
 
 #include "core/map_coord.h"
@@ -212,6 +213,31 @@ protected:
 	template< class F >
 	void importObjects(const OcdFile< F >& file);
 	
+	/**
+	 * Imports the given objects into the given part, in the given order.
+	 * 
+	 * Objects which do not depend on shared state are decoded concurrently.
+	 */
+	template< class O >
+	void importObjectList(const std::vector<const O*>& ocd_objects, MapPart* part);
+	
+	/**
+	 * Returns true if an object can be imported without adding warnings or
+	 * modifying symbols, i.e. concurrently with other such objects.
+	 */
+	template< class O >
+	bool canImportConcurrently(const O& ocd_object) const;
+	
+	/**
+	 * Returns true if the object with the given index entry is to be imported.
+	 * 
+	 * When the "importArea" option is set to a valid rectangle in map
+	 * coordinates, only objects whose index entry bounding box intersects
+	 * this area are imported. The other objects are not decoded at all.
+	 */
+	template< class E >
+	bool isInImportArea(const E& entry) const;
+	
 	
 	template< class F >
 	void importTemplates(const OcdFile< F >& file);
@@ -333,6 +359,11 @@ protected:
 	/// The locale is used for number formatting.
 	QLocale locale;
 	
+	/**
+	 * The file data.
+	 * 
+	 * During import, this may refer to a memory-mapped file.
+	 */
 	QByteArray buffer;
 	
 	/// Character encoding to use for 1-byte (narrow) strings
@@ -358,6 +389,9 @@ protected:
 	
 	/// The actual format version of the imported file
 	int ocd_version;
+	
+	/// The area of the objects to be imported, or a null rect for all objects
+	QRectF import_area;
 };
 
 
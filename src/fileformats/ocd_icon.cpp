@@ -29,14 +29,22 @@
 
 #include <Qt>
 #include <QtGlobal>
+#include <QByteArray>
 #include <QColor>
+#include <QHash>
 #include <QImage>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QRgb>
 #include <QSize>
 
+#include "core/map.h"
 #include "core/symbols/symbol.h"
+#include "core/symbols/symbol_icon_cache.h"
 #include "fileformats/ocd_types_v8.h"
 #include "fileformats/ocd_types_v9.h"
+#include "util/cache_manager.h"
+#include "util/concurrency.h"
 
 
 namespace OpenOrienteering {
@@ -164,14 +172,10 @@ quint8 getPaletteColorV9(int r, int g, int b)
 	return best_index;
 }
 
-} // namespace
-
 
-
-OcdIcon::operator Ocd::IconV8() const
+Ocd::IconV8 convertIconV8(const QImage& image)
 {
 	Ocd::IconV8 icon;
-	auto image = iconForExport(map, symbol, icon.width(), icon.height());
 	auto process_pixel = [&image](int x, int y)->quint8 {
 		// Apply premultiplied pixel on white background
 		auto premultiplied = image.pixel(x, y);
@@ -223,10 +227,9 @@ OcdIcon::operator Ocd::IconV8() const
 }
 
 
-OcdIcon::operator Ocd::IconV9() const
+Ocd::IconV9 convertIconV9(const QImage& image)
 {
 	Ocd::IconV9 icon;
-	auto image = iconForExport(map, symbol, icon.width(), icon.height());
 	auto process_pixel = [&image](int x, int y)->quint8 {
 		// Apply premultiplied pixel on white background
 		auto premultiplied = image.pixel(x, y);
@@ -249,6 +252,115 @@ OcdIcon::operator Ocd::IconV9() const
 }
 
 
+/**
+ * A process-wide cache of converted icons.
+ * 
+ * The icons are identified by SymbolIconCache::key(), i.e. by the symbol
+ * definition, the colors it uses, and the icon size and zoom. So repeated
+ * exports of the same map find the icons of unchanged symbols here.
+ * 
+ * The member functions may be called from any thread.
+ */
+template <class Icon>
+class ConvertedIconCache
+{
+public:
+	static ConvertedIconCache& instance()
+	{
+		static ConvertedIconCache cache;
+		return cache;
+	}
+	
+	bool find(const QByteArray& key, Icon& icon) const
+	{
+		QMutexLocker locker(&mutex);
+		auto const match = icons.constFind(key);
+		if (match == icons.constEnd())
+			return false;
+		icon = *match;
+		return true;
+	}
+	
+	void insert(const QByteArray& key, const Icon& icon)
+	{
+		QMutexLocker locker(&mutex);
+		// A simple bound for long sessions with many different symbol sets.
+		if (icons.size() >= max_icons)
+			icons.clear();
+		icons.insert(key, icon);
+	}
+	
+private:
+	ConvertedIconCache()
+	{
+		registration = CacheManager::add({
+			[this]() {
+				QMutexLocker locker(&mutex);
+				// Icon data plus hexadecimal SHA-1 key
+				return qint64(icons.size()) * qint64(sizeof(Icon) + 40);
+			},
+			[this](CacheManager::TrimLevel level) {
+				// Icons are converted again on demand.
+				if (level == CacheManager::TrimCritical)
+				{
+					QMutexLocker locker(&mutex);
+					icons.clear();
+				}
+			}
+		});
+	}
+	
+	static constexpr int max_icons = 4096;
+	
+	mutable QMutex mutex;
+	QHash<QByteArray, Icon> icons;
+	CacheManager::Registration registration;
+};
+
+
+template <class Icon>
+Icon cachedIcon(const Map& map, const Symbol& symbol, Icon (*convert)(const QImage&))
+{
+	Icon icon;
+	auto const side_length = std::max(icon.width(), icon.height());
+	auto const key = SymbolIconCache::key(symbol, map, side_length, map.symbolIconZoom());
+	auto& cache = ConvertedIconCache<Icon>::instance();
+	if (!cache.find(key, icon))
+	{
+		icon = convert(iconForExport(map, symbol, icon.width(), icon.height()));
+		cache.insert(key, icon);
+	}
+	return icon;
+}
+
+} // namespace
+
+
+
+OcdIcon::operator Ocd::IconV8() const
+{
+	return cachedIcon<Ocd::IconV8>(map, symbol, &convertIconV8);
+}
+
+
+OcdIcon::operator Ocd::IconV9() const
+{
+	return cachedIcon<Ocd::IconV9>(map, symbol, &convertIconV9);
+}
+
+
+// static
+void OcdIcon::prepareIcons(const Map& map)
+{
+	// Not thread-safe: may update the cached zoom and emit a signal.
+	map.symbolIconZoom();
+	
+	Concurrency::parallelFor(0, map.getNumSymbols(), [&map](int i) {
+		cachedIcon<Ocd::IconV9>(map, *map.getSymbol(i), &convertIconV9);
+	});
+}
+
+
 // static
 QImage OcdIcon::toQImage(const Ocd::IconV8& icon)
 {
@@ -46,6 +46,10 @@ class Symbol;
  * ocd_base_symbol.icon = OcdIcon{map, symbol};
  * 
  * symbol->setCustomIcon(OcdIcon::toQImage(ocd_base_symbol.icon));
+ * 
+ * Converted icons are kept in a process-wide cache, keyed by the symbol
+ * definition (cf. SymbolIconCache::key()), so that unchanged symbols are
+ * neither rendered nor quantized again when a map is exported repeatedly.
  */
 struct OcdIcon
 {
@@ -57,6 +61,15 @@ struct OcdIcon
 	operator Ocd::IconV8() const;
 	operator Ocd::IconV9() const;
 	
+	/**
+	 * Converts the version 9 icons of all symbols of the map concurrently,
+	 * unless they are cached already.
+	 * 
+	 * Afterwards, the conversion to Ocd::IconV9 returns the cached icons.
+	 * Version 8 icons are compressed from version 9 icons by the exporter.
+	 */
+	static void prepareIcons(const Map& map);
+	
 	/**
 	 * Creates a QImage for the given uncompressed icon data.
 	 * 
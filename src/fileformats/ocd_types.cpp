@@ -521,6 +521,74 @@ typename OcdEntityIndex<F,T>::EntryType& OcdEntityIndex<F,T>::insert(const QByte
 	return block->entries[index];
 }
 
+template< class F, class T >
+void OcdEntityIndex<F,T>::insert(const std::vector<std::pair<QByteArray, EntryType>>& entities)
+{
+	if (entities.empty())
+		return;
+	
+	auto& byte_array = Ocd::addPadding(file.byteArray());
+	IndexBlock* block;
+	auto next_block_pos = firstBlock<typename T::IndexEntryType>();
+	auto block_pos = decltype(next_block_pos)(0);
+	do
+	{
+		block_pos = next_block_pos;
+		block = Ocd::getBlockChecked<IndexBlock>(byte_array, block_pos);
+		if (Q_UNLIKELY(!block))
+		{
+			///  \todo Throw exception
+			qFatal("OcdEntityIndexIterator: Next index block is out of bounds");
+		}
+		next_block_pos = block->next_block;
+	}
+	while (next_block_pos != 0);
+	
+	quint16 first_index = 0;
+	while (first_index < 256 && block->entries[first_index].pos)
+		++first_index;
+	
+	// Precompute the layout, with the same padding as for single insertion.
+	auto total_size = byte_array.size();
+	auto index = first_index;
+	for (const auto& entity : entities)
+	{
+		total_size += (0x7ffffff8 - total_size) % 8;
+		if (index == 256)
+		{
+			total_size += int(sizeof(IndexBlock));
+			index = 0;
+		}
+		total_size += entity.first.size();
+		++index;
+	}
+	byte_array.reserve(total_size);
+	
+	index = first_index;
+	for (const auto& entity : entities)
+	{
+		Ocd::addPadding(byte_array);
+		if (Q_UNLIKELY(index == 256))
+		{
+			auto const new_block_pos = decltype(block->next_block)(byte_array.size());
+			Ocd::getBlockChecked<IndexBlock>(byte_array, block_pos)->next_block = new_block_pos;
+			block_pos = new_block_pos;
+			auto new_block = IndexBlock {};
+			byte_array.append(reinterpret_cast<const char*>(&new_block), sizeof(IndexBlock));
+			index = 0;
+		}
+		
+		auto entity_pos = decltype(block->entries[index].pos)(byte_array.size());
+		byte_array.append(entity.first);
+		block = Ocd::getBlockChecked<IndexBlock>(byte_array, block_pos);
+		Q_ASSERT(block);
+		block->entries[index] = entity.second;
+		block->entries[index].pos = entity_pos;
+		++index;
+	}
+	Q_ASSERT(byte_array.size() == total_size);
+}
+
 
 
 // ### OcdFile implementation ###
@@ -23,6 +23,8 @@
 #include <cstddef>
 #include <iterator>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
 #include <QtGlobal>
 #include <QByteArray>
@@ -518,6 +520,15 @@ public:
 	 */
 	EntryType& insert(qint32 string_type, const QByteArray& string_data);
 	
+	/**
+	 * Inserts multiple entities with the given entry prototypes, in order.
+	 * 
+	 * The result is the same as for inserting the entities one by one,
+	 * but the last index block is located only once, and the byte array
+	 * is allocated once for all entities and new index blocks.
+	 */
+	void insert(const std::vector<std::pair<QByteArray, EntryType>>& entities);
+	
 	
 private:
 	template< class X = EntryType, typename std::enable_if<std::is_same<X, typename Ocd::ParameterString::IndexEntryType>::value, int>::type = 0 >
@@ -670,6 +681,9 @@ private:
 	typename OcdEntityIndex<F, F::Object>::EntryType& OcdEntityIndex<F, F::Object>::insert(const QByteArray&, const EntryType&); \
 	\
 	keywords \
+	void OcdEntityIndex<F, F::Object>::insert(const std::vector<std::pair<QByteArray, EntryType>>&); \
+	\
+	keywords \
 	OcdFile<F>::OcdFile();
 
 
@@ -24,11 +24,16 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <exception>
 #include <functional>
+#include <initializer_list>
+#include <limits>
 #include <memory>
 #include <vector>
 
 #include <QtGlobal>
+#include <QtEndian>
+#include <QBuffer>
 #include <QByteArray>
 #include <QDir>
 #include <QExplicitlySharedDataPointer>
@@ -55,12 +60,14 @@
 #include "core/map_part.h"
 #include "core/map_printer.h"  // IWYU pragma: keep
 #include "core/map_view.h"
+#include "core/objects/object.h"
 #include "core/symbols/line_symbol.h"
 #include "core/symbols/point_symbol.h"
 #include "core/symbols/symbol.h"
 #include "fileformats/file_import_export.h"
 #include "templates/template.h"
 #include "undo/undo_manager.h"
+#include "util/concurrency.h"
 #include "util/xml_stream_util.h"
 
 
@@ -69,7 +76,7 @@ namespace OpenOrienteering {
 // ### XMLFileFormat definition ###
 
 constexpr int XMLFileFormat::minimum_version = 2;
-constexpr int XMLFileFormat::current_version = 9;
+constexpr int XMLFileFormat::current_version = 10;
 
 int XMLFileFormat::active_version = 5; // updated by XMLFileExporter::doExport()
 
@@ -84,6 +91,132 @@ QString mapperNamespace()
 }
 
 
+/**
+ * The identification of the compressed container.
+ * 
+ * The container holds a little-endian 32 bit version number, followed by
+ * blocks of the XML document compressed by qCompress(). Each block is preceded
+ * by its compressed size as a little-endian 32 bit number. A size of zero
+ * terminates the container.
+ */
+constexpr char compressed_magic[4] = { 'O', 'O', 'M', 'Z' };
+
+/// The current version of the compressed container.
+constexpr quint32 compressed_version = 1;
+
+/// The size of the uncompressed blocks, except for the last one.
+constexpr int compressed_block_size = 1 << 20;
+
+
+bool isCompressed(const char* data, int size)
+{
+	return size >= int(sizeof(compressed_magic))
+	       && std::equal(data, data + sizeof(compressed_magic), compressed_magic);
+}
+
+bool isCompressed(const QByteArray& data)
+{
+	return isCompressed(data.constData(), data.size());
+}
+
+void appendUInt32(QByteArray& data, quint32 value)
+{
+	uchar bytes[4];
+	qToLittleEndian(value, bytes);
+	data.append(reinterpret_cast<const char*>(bytes), 4);
+}
+
+quint32 readUInt32(const QByteArray& data, int pos)
+{
+	if (pos < 0 || data.size() - pos < 4)
+		throw FileFormatException(::OpenOrienteering::Importer::tr("Invalid compressed data."));
+	return qFromLittleEndian<quint32>(reinterpret_cast<const uchar*>(data.constData() + pos));
+}
+
+/**
+ * Compresses the data into the compressed container.
+ * 
+ * The blocks are compressed concurrently.
+ */
+QByteArray compressBlocks(const QByteArray& data)
+{
+	auto const num_blocks = (data.size() + compressed_block_size - 1) / compressed_block_size;
+	std::vector<QByteArray> blocks(std::size_t(num_blocks));
+	Concurrency::parallelFor(0, num_blocks, [&data, &blocks](int i) {
+		auto const begin = i * compressed_block_size;
+		auto const size = qMin(compressed_block_size, data.size() - begin);
+		blocks[std::size_t(i)] = qCompress(reinterpret_cast<const uchar*>(data.constData() + begin), size);
+	});
+	
+	auto container_size = int(sizeof(compressed_magic)) + 8;
+	for (auto const& block : blocks)
+		container_size += 4 + block.size();
+	
+	QByteArray container;
+	container.reserve(container_size);
+	container.append(compressed_magic, int(sizeof(compressed_magic)));
+	appendUInt32(container, compressed_version);
+	for (auto const& block : blocks)
+	{
+		appendUInt32(container, quint32(block.size()));
+		container.append(block);
+	}
+	appendUInt32(container, 0);
+	return container;
+}
+
+/**
+ * Uncompresses the data from the compressed container.
+ * 
+ * The blocks are uncompressed concurrently.
+ */
+QByteArray uncompressBlocks(const QByteArray& container)
+{
+	auto pos = int(sizeof(compressed_magic));
+	if (readUInt32(container, pos) > compressed_version)
+		throw FileFormatException(::OpenOrienteering::Importer::tr("Unsupported new file format version. Some map features will not be loaded or saved by this version of the program."));
+	pos += 4;
+	
+	struct Block
+	{
+		int begin;
+		int size;
+	};
+	std::vector<Block> blocks;
+	for (auto size = readUInt32(container, pos); size != 0; size = readUInt32(container, pos))
+	{
+		pos += 4;
+		if (size > quint32(container.size() - pos))
+			throw FileFormatException(::OpenOrienteering::Importer::tr("Invalid compressed data."));
+		blocks.push_back({ pos, int(size) });
+		pos += int(size);
+	}
+	
+	std::vector<QByteArray> data(blocks.size());
+	Concurrency::parallelFor(0, int(blocks.size()), [&container, &blocks, &data](int i) {
+		auto const& block = blocks[std::size_t(i)];
+		data[std::size_t(i)] = qUncompress(reinterpret_cast<const uchar*>(container.constData() + block.begin), block.size);
+	});
+	
+	auto size = qint64(0);
+	for (auto const& block : data)
+	{
+		// Blocks are never empty, so an empty result indicates an error.
+		if (block.isEmpty())
+			throw FileFormatException(::OpenOrienteering::Importer::tr("Invalid compressed data."));
+		size += block.size();
+	}
+	if (size > std::numeric_limits<int>::max())
+		throw FileFormatException(::OpenOrienteering::Importer::tr("Invalid compressed data."));
+	
+	QByteArray result;
+	result.reserve(int(size));
+	for (auto const& block : data)
+		result.append(block);
+	return result;
+}
+
+
 }  // namespace
 
 
@@ -105,6 +238,8 @@ FileFormat::ImportSupportAssumption XMLFileFormat::understands(const char* buffe
 	const auto data = QByteArray::fromRawData(buffer, size);
 	if (size >= 4 && qstrncmp(buffer, "OMAP", 4) == 0)
 	    return FullySupported;  // Legacy binary format. Final error raised in doImport().
+	if (isCompressed(buffer, size))
+		return FullySupported;
 	
 	if (size > 38)  // length of "<?xml ...>"
 	{
@@ -188,6 +323,9 @@ namespace literal
 	
 	static const QLatin1String parts("parts");
 	static const QLatin1String part("part");
+	static const QLatin1String objects("objects");
+	static const QLatin1String object("object");
+	static const QLatin1String chunks("chunks");
 	
 	static const QLatin1String templates("templates");
 	static const QLatin1String template_string("template");
@@ -221,6 +359,17 @@ XMLFileExporter::XMLFileExporter(const QString& path, const Map* map, const MapV
 	// Determine auto-formatting default from filename, if possible.
 	bool auto_formatting = path.endsWith(QLatin1String(".xmap"));
 	setOption(QString::fromLatin1("autoFormatting"), auto_formatting);
+	
+	// Compression is meant for saving map files, not for human-readable
+	// .xmap files or for in-memory documents.
+	bool compressed = !auto_formatting && !path.isEmpty()
+	                  && Settings::getInstance().getSetting(Settings::General_CompressMapFiles).toBool();
+	setOption(QString::fromLatin1("compressed"), compressed);
+	
+	// The compact coordinate encoding requires format version 10.
+	bool compact_coords = !auto_formatting && !path.isEmpty()
+	                      && Settings::getInstance().getSetting(Settings::General_CompactCoordinates).toBool();
+	setOption(QString::fromLatin1("compactCoordinates"), compact_coords);
 }
 
 XMLFileExporter::~XMLFileExporter() = default;
@@ -229,13 +378,24 @@ XMLFileExporter::~XMLFileExporter() = default;
 
 bool XMLFileExporter::exportImplementation()
 {
-	xml.setDevice(device());
+	QBuffer uncompressed;
+	auto const compressed = option(QString::fromLatin1("compressed")).toBool();
+	if (compressed)
+	{
+		uncompressed.open(QIODevice::WriteOnly);
+		xml.setDevice(&uncompressed);
+	}
+	else
+	{
+		xml.setDevice(device());
+	}
 	
 	if (option(QString::fromLatin1("autoFormatting")).toBool())
 		xml.setAutoFormatting(true);
 	
+	// Without the compact coordinate encoding, version 9 is sufficient.
+	int current_version = option(QString::fromLatin1("compactCoordinates")).toBool() ? XMLFileFormat::current_version : 9;
 #ifdef MAPPER_ENABLE_COMPATIBILITY
-	int current_version = XMLFileFormat::current_version;
 	bool retain_compatibility = Settings::getInstance().getSetting(Settings::General_RetainCompatiblity).toBool();
 	XMLFileFormat::active_version = retain_compatibility ? 5 : current_version;
 	
@@ -244,7 +404,7 @@ bool XMLFileExporter::exportImplementation()
 		throw FileFormatException(tr("Older versions of Mapper do not support multiple map parts. To save the map in compatibility mode, you must first merge all map parts."));
 	}
 #else
-	XMLFileFormat::active_version = XMLFileFormat::current_version;
+	XMLFileFormat::active_version = current_version;
 #endif
 	
 	xml.writeDefaultNamespace(mapperNamespace());
@@ -305,6 +465,14 @@ bool XMLFileExporter::exportImplementation()
 	}
 	
 	xml.writeEndDocument();
+	
+	if (compressed)
+	{
+		xml.setDevice(nullptr);
+		auto const container = compressBlocks(uncompressed.data());
+		if (device()->write(container) != container.size())
+			throw FileFormatException(device()->errorString());
+	}
 	return true;
 }
 
@@ -516,9 +684,58 @@ void XMLFileExporter::exportRedo()
 
 // ### XMLFileImporter definition ###
 
+namespace {
+
+/**
+ * Loads the object elements in the given range of the raw data.
+ * 
+ * The range is parsed as a document of its own. The line is the line number
+ * of the beginning of the range, for error messages.
+ */
+std::vector<std::unique_ptr<Object>> loadObjectChunk(const QByteArray& data, int begin, int end, int line,
+                                                     Map* map, const SymbolDictionary& symbol_dict)
+{
+	auto const start_tag = QByteArray::fromRawData("<objects>", 9);
+	auto const end_tag = QByteArray::fromRawData("</objects>", 10);
+	
+	QByteArray document;
+	document.reserve(start_tag.size() + end - begin + end_tag.size());
+	document.append(start_tag).append(data.constData() + begin, end - begin).append(end_tag);
+	
+	std::vector<std::unique_ptr<Object>> objects;
+	QXmlStreamReader xml(document);
+	if (xml.readNextStartElement())
+	{
+		while (xml.readNextStartElement())
+		{
+			if (xml.name() == literal::object)
+				objects.emplace_back(Object::load(xml, map, symbol_dict));
+			else
+				xml.skipCurrentElement(); // unknown
+		}
+	}
+	
+	if (xml.hasError())
+		throw FileFormatException(
+		        ::OpenOrienteering::XMLFileImporter::tr("Error at line %1 column %2: %3")
+		        .arg(line + xml.lineNumber() - 1)
+		        .arg(xml.columnNumber())
+		        .arg(xml.errorString()) );
+	
+	return objects;
+}
+
+
+}  // namespace
+
+
+
 XMLFileImporter::XMLFileImporter(const QString& path, Map *map, MapView *view)
 : Importer(path, map, view)
-{}
+{
+	// A threshold of zero forces the parallel mode, even on a single core.
+	setOption(QString::fromLatin1("parallelThreshold"), 1 << 20);
+}
 
 XMLFileImporter::~XMLFileImporter() = default;
 
@@ -535,7 +752,36 @@ void XMLFileImporter::addWarningUnsupportedElement()
 
 bool XMLFileImporter::importImplementation()
 {
-	xml.setDevice(device());
+	auto* const source = device();
+	if (!isCompressed(source->peek(int(sizeof(compressed_magic)))))
+		return importDocument();
+	
+	// The XML document is read from the uncompressed data.
+	QBuffer uncompressed;
+	uncompressed.setData(uncompressBlocks(source->readAll()));
+	uncompressed.open(QIODevice::ReadOnly);
+	setDevice(&uncompressed);
+	try
+	{
+		auto const result = importDocument();
+		setDevice(source);
+		return result;
+	}
+	catch (...)
+	{
+		setDevice(source);
+		throw;
+	}
+}
+
+bool XMLFileImporter::importDocument()
+{
+	prepareSymbolsOnlyImport();
+	prepareParallelImport();
+	if (parallel_input)
+		xml.setDevice(parallel_input.get());
+	else
+		xml.setDevice(device());
 	if (!xml.readNextStartElement() || xml.name() != literal::map)
 	{
 		if (device()->seek(0))
@@ -567,6 +813,10 @@ bool XMLFileImporter::importImplementation()
 	georef_offset_adjusted = false;
 	importElements();
 	
+	// The raw object data is no longer needed.
+	parallel_data = {};
+	object_chunks.clear();
+	
 	auto offset = MapCoord::boundsOffset();
 	if (!loadSymbolsOnly() && !offset.isZero())
 	{
@@ -638,6 +888,8 @@ void XMLFileImporter::importElements()
 			addWarningUnsupportedElement();
 			xml.skipCurrentElement();
 		}
+		
+		reportDeviceProgress();
 	}
 	
 	if (xml.error())
@@ -648,6 +900,341 @@ void XMLFileImporter::importElements()
 		        .arg(xml.errorString()) );
 }
 
+void XMLFileImporter::reportDeviceProgress()
+{
+	// The stream reader reads ahead in blocks, so this is an estimate.
+	auto const* input = xml.device();
+	auto const size = input ? input->size() : 0;
+	if (size > 0 && !input->isSequential())
+		reportProgress(int(100 * input->pos() / size));
+}
+
+void XMLFileImporter::prepareParallelImport()
+{
+	auto* input = device();
+	auto const threshold = option(QString::fromLatin1("parallelThreshold")).toLongLong();
+	if (loadSymbolsOnly()
+	    || input->isSequential()
+	    || input->size() - input->pos() < threshold
+	    || input->size() - input->pos() > std::numeric_limits<int>::max() / 2
+	    || (threshold > 0 && Concurrency::idealThreadCount() < 2))
+	{
+		return;
+	}
+	
+	auto const start = input->pos();
+	auto data = input->readAll();
+	std::vector<Splice> splices;
+	if (!scanObjectChunks(data, splices))
+	{
+		object_chunks.clear();
+		input->seek(start);
+		return;
+	}
+	
+	auto remainder_size = data.size();
+	for (auto const& splice : splices)
+		remainder_size += splice.replacement.size() - (splice.end - splice.begin);
+	QByteArray remainder;
+	remainder.reserve(remainder_size);
+	auto last = 0;
+	for (auto const& splice : splices)
+	{
+		remainder.append(data.constData() + last, splice.begin - last);
+		remainder.append(splice.replacement);
+		last = splice.end;
+	}
+	remainder.append(data.constData() + last, data.size() - last);
+	
+	parallel_data = data;
+	parallel_input = std::make_unique<QBuffer>();
+	parallel_input->setData(remainder);
+	parallel_input->open(QIODevice::ReadOnly);
+}
+
+void XMLFileImporter::prepareSymbolsOnlyImport()
+{
+	auto* input = device();
+	if (!loadSymbolsOnly()
+	    || input->isSequential()
+	    || input->size() - input->pos() > std::numeric_limits<int>::max() / 2)
+	{
+		return;
+	}
+	
+	auto const start = input->pos();
+	auto data = input->readAll();
+	
+	// The output of XMLFileExporter escapes '<' in text and in attributes,
+	// and it doesn't contain comments or CDATA sections.
+	auto removed = false;
+	for (auto const& name : { literal::parts, literal::templates, literal::undo, literal::redo })
+	{
+		auto const start_tag = '<' + QByteArray(name.latin1());
+		auto const end_tag = "</" + QByteArray(name.latin1()) + '>';
+		auto const begin = data.indexOf(start_tag);
+		if (begin < 0 || begin + start_tag.size() >= data.size())
+			continue;
+		auto const next = data.at(begin + start_tag.size());
+		if (next != '>' && next != ' ')
+			continue;
+		auto const end = data.indexOf(end_tag, begin);
+		if (end < 0)
+			continue;
+		data.remove(begin, end + end_tag.size() - begin);
+		removed = true;
+	}
+	
+	if (!removed)
+	{
+		input->seek(start);
+		return;
+	}
+	
+	parallel_input = std::make_unique<QBuffer>();
+	parallel_input->setData(data);
+	parallel_input->open(QIODevice::ReadOnly);
+}
+
+bool XMLFileImporter::scanObjectChunks(const QByteArray& data, std::vector<Splice>& splices)
+{
+	// Large enough to make the per-chunk overhead negligible,
+	// small enough to balance the work between threads.
+	constexpr int max_chunk_objects = 256;
+	
+	// This is a minimal scanner for the output of XMLFileExporter.
+	// It gives up on anything else, e.g. on comments, CDATA sections,
+	// encodings other than UTF-8, and on characters which are invalid in XML
+	// (which need the XmlRecoveryHelper).
+	auto const* const raw = data.constData();
+	auto const size = data.size();
+	auto pos = 0;
+	if (data.startsWith("<?xml"))
+	{
+		auto const end = data.indexOf("?>");
+		if (end < 0)
+			return false;
+		auto const prolog = data.left(end).toLower();
+		auto const encoding = prolog.indexOf("encoding=");
+		if (encoding >= 0
+		    && prolog.indexOf("\"utf-8\"", encoding) != encoding + 9
+		    && prolog.indexOf("'utf-8'", encoding) != encoding + 9)
+		{
+			return false;
+		}
+		pos = end + 2;
+	}
+	
+	object_chunks.clear();
+	splices.clear();
+	
+	// Map parts are found in the map element, possibly nested in barriers.
+	// plain_depth is the depth of the innermost of these elements.
+	auto depth = 0;
+	auto plain_depth = 0;
+	auto parts_depth = -1;
+	auto line = 1;
+	auto num_objects = 0;
+	auto in_objects = false;
+	auto new_chunk = true;
+	auto objects_begin = 0;
+	auto object_begin = -1;
+	auto object_line = 0;
+	auto object_text = false;
+	
+	auto matches = [raw](int name_begin, int name_end, const QLatin1String& name) {
+		return name_end - name_begin == name.size()
+		       && qstrncmp(raw + name_begin, name.data(), uint(name.size())) == 0;
+	};
+	
+	auto startElement = [&](int name_begin, int name_end, int tag_begin, int tag_end, int tag_line) {
+		if (parts_depth < 0 && depth == plain_depth + 1)
+		{
+			if (matches(name_begin, name_end, depth == 1 ? literal::map : literal::barrier))
+				plain_depth = depth;
+			else if (depth > 1 && matches(name_begin, name_end, literal::parts))
+				parts_depth = depth;
+		}
+		else if (depth == parts_depth + 1 && matches(name_begin, name_end, literal::part))
+		{
+			// Tag the part with the index of its chunks.
+			auto const index = QByteArray::number(int(object_chunks.size()));
+			splices.push_back({ name_end, name_end, " " + QByteArray(literal::chunks.latin1()) + "=\"" + index + '"' });
+			object_chunks.emplace_back();
+		}
+		else if (depth == parts_depth + 2 && matches(name_begin, name_end, literal::objects))
+		{
+			in_objects = true;
+			objects_begin = tag_end;
+			new_chunk = true;
+		}
+		else if (in_objects && depth == parts_depth + 3 && matches(name_begin, name_end, literal::object))
+		{
+			object_begin = tag_begin;
+			object_line = tag_line;
+			auto const tag = QByteArray::fromRawData(raw + tag_begin, tag_end - tag_begin);
+			object_text = tag.contains(" type=\"4\"") || tag.contains(" type='4'");
+		}
+	};
+	
+	auto endElement = [&](int tag_begin, int tag_end) {
+		if (in_objects && depth == parts_depth + 3 && object_begin >= 0)
+		{
+			auto& chunks = object_chunks.back();
+			if (new_chunk || chunks.back().text != object_text || chunks.back().count == max_chunk_objects)
+			{
+				chunks.push_back({ object_begin, tag_end, object_line, 1, object_text });
+				new_chunk = false;
+			}
+			else
+			{
+				chunks.back().end = tag_end;
+				++chunks.back().count;
+			}
+			object_begin = -1;
+			++num_objects;
+		}
+		else if (in_objects && depth == parts_depth + 2)
+		{
+			if (tag_begin > objects_begin)
+				splices.push_back({ objects_begin, tag_begin, {} });
+			in_objects = false;
+		}
+		else if (depth == parts_depth)
+		{
+			parts_depth = -1;
+		}
+		else if (depth == plain_depth)
+		{
+			--plain_depth;
+		}
+	};
+	
+	while (pos < size)
+	{
+		auto const c = raw[pos];
+		if (c != '<')
+		{
+			if (c == '\n')
+				++line;
+			else if (uchar(c) < 0x20 && c != '\t' && c != '\r')
+				return false;
+			++pos;
+			continue;
+		}
+		
+		auto const tag_begin = pos;
+		auto const tag_line = line;
+		auto const closing = pos + 1 < size && raw[pos + 1] == '/';
+		if (pos + 1 < size && (raw[pos + 1] == '!' || raw[pos + 1] == '?'))
+			return false;
+		
+		auto const name_begin = pos + (closing ? 2 : 1);
+		auto name_end = name_begin;
+		while (name_end < size && raw[name_end] != '>' && raw[name_end] != '/'
+		       && uchar(raw[name_end]) > 0x20)
+			++name_end;
+		
+		// Find the end of the tag, skipping quoted attribute values.
+		auto quote = '\0';
+		for (pos = name_end; pos < size; ++pos)
+		{
+			auto const t = raw[pos];
+			if (t == '\n')
+				++line;
+			else if (uchar(t) < 0x20 && t != '\t' && t != '\r')
+				return false;
+			else if (quote)
+				quote = (t == quote) ? '\0' : quote;
+			else if (t == '"' || t == '\'')
+				quote = t;
+			else if (t == '>')
+				break;
+		}
+		if (pos >= size)
+			return false;
+		auto const tag_end = ++pos;
+		
+		if (closing)
+		{
+			endElement(tag_begin, tag_end);
+			--depth;
+		}
+		else
+		{
+			++depth;
+			startElement(name_begin, name_end, tag_begin, tag_end, tag_line);
+			if (raw[tag_end - 2] == '/')
+			{
+				endElement(tag_begin, tag_end);
+				--depth;
+			}
+		}
+		if (depth < 0)
+			return false;
+	}
+	
+	return depth == 0 && num_objects > 0;
+}
+
+void XMLFileImporter::importObjectChunks(MapPart* part, std::size_t index)
+{
+	if (index >= object_chunks.size())
+		return;
+	
+	auto const& chunks = object_chunks[index];
+	auto const num_chunks = int(chunks.size());
+	
+	struct Result
+	{
+		std::vector<std::unique_ptr<Object>> objects;
+		std::exception_ptr error;
+	};
+	std::vector<Result> results(chunks.size());
+	auto load = [this, &chunks, &results](int i) {
+		auto const& chunk = chunks[std::size_t(i)];
+		auto& result = results[std::size_t(i)];
+		try
+		{
+			result.objects = loadObjectChunk(parallel_data, chunk.begin, chunk.end, chunk.line, map, symbol_dict);
+		}
+		catch (...)
+		{
+			result.error = std::current_exception();
+		}
+	};
+	
+	// The first coordinates may still have to initialize the bounds offset.
+	auto first = 0;
+	for (; first < num_chunks && MapCoord::boundsOffset().check_for_offset; ++first)
+		load(first);
+	
+	// Object::load() only reads shared data for objects other than text.
+	Concurrency::parallelFor(first, num_chunks, [&chunks, &load](int i) {
+		if (!chunks[std::size_t(i)].text)
+			load(i);
+	});
+	for (auto i = first; i < num_chunks; ++i)
+	{
+		if (chunks[std::size_t(i)].text)
+			load(i);
+	}
+	
+	auto num_objects = part->objects.size();
+	for (auto const& chunk : chunks)
+		num_objects += std::size_t(chunk.count);
+	part->objects.reserve(num_objects);
+	for (auto& result : results)
+	{
+		if (result.error)
+			std::rethrow_exception(result.error);
+		for (auto& object : result.objects)
+			part->objects.push_back(object.release());
+	}
+	
+	reportDeviceProgress();
+}
+
 void XMLFileImporter::handleBarrier(const std::function<void ()>& reader)
 {
 	{
@@ -957,19 +1544,31 @@ void XMLFileImporter::importMapParts()
 	map->parts.clear();
 	map->parts.reserve(qMin(num_parts, std::size_t(20))); // 20 is not a limit
 	
+	// Objects make up most of a map file. Report progress in batches.
+	auto num_objects = 0u;
+	auto object_loaded = [this, &num_objects]() {
+		if (++num_objects % 1000 == 0)
+			reportDeviceProgress();
+	};
+	
 	while (xml.readNextStartElement())
 	{
 		if (xml.name() == literal::part)
 		{
+			// Set by prepareParallelImport()
+			auto const chunks = parallel_input ? xml.attributes().value(literal::chunks).toInt() : -1;
+			
 			auto recovery = XmlRecoveryHelper(xml);
-			auto part = MapPart::load(xml, *map, symbol_dict);
+			auto part = MapPart::load(xml, *map, symbol_dict, object_loaded);
 			if (xml.hasError() && recovery())
 			{
 				addWarning(tr("Some invalid characters had to be removed."));
 				delete part;
-				part = MapPart::load(xml, *map, symbol_dict);
+				part = MapPart::load(xml, *map, symbol_dict, object_loaded);
 			}
 			map->parts.push_back(part);
+			if (chunks >= 0)
+				importObjectChunks(part, std::size_t(chunks));
 		}
 		else
 		{
@@ -1086,7 +1685,7 @@ void XMLFileImporter::importUndo()
 	
 	try
 	{
-		map->undoManager().loadUndo(xml, symbol_dict);
+		map->undoManager().deferUndo(xml, symbol_dict);
 	}
 	catch (FileFormatException& e)
 	{
@@ -1106,7 +1705,7 @@ void XMLFileImporter::importRedo()
 	
 	try
 	{
-		map->undoManager().loadRedo(xml, symbol_dict);
+		map->undoManager().deferRedo(xml, symbol_dict);
 	}
 	catch (FileFormatException& e)
 	{
@@ -46,6 +46,9 @@ public:
 	
 	
 	/** @brief Returns true for an XML file using the Mapper namespace.
+	 * 
+	 * This includes the compressed container which is written when
+	 * the exporter's "compressed" option is set.
 	 */
 	ImportSupportAssumption understands(const char* buffer, int size) const override;
 	
@@ -93,6 +96,10 @@ public:
 
 \subsection version-10 (Planned for) Version 10 (Mapper 1.0)
 
+- 2026-10-14 Added a compact encoding of coordinates: `coords` elements with
+             attribute `encoding="base64"` contain a base64 encoded sequence
+             of zigzag varint coordinate deltas and flags. It is written
+             only when requested, otherwise version 9 is written.
 - For writing, drop compatibility with Mapper versions before 0.9.
 - Use the streaming variant when writing `barrier` elements.
 - Stop writing text object box sizes to the coordinates stream.
@@ -108,6 +115,9 @@ public:
 - 2019-10-02 Added a text symbol `rotatable` property. This must be exported as
              `true` now when the text symbol is rotatable, but default to `true`
              when reading previous versions of the format.
+- 2026-10-14 Added undo step type 11 which stores the changed range of an
+             object's coordinates in `ref` elements with `first` and `length`
+             attributes. Older versions treat it as an invalid undo step.
 
 
 \subsection version-8 Version 8
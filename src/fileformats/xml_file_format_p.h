@@ -21,8 +21,12 @@
 #ifndef OPENORIENTEERING_FILE_FORMAT_XML_P_H
 #define OPENORIENTEERING_FILE_FORMAT_XML_P_H
 
+#include <cstddef>
 #include <functional>
+#include <memory>
+#include <vector>
 
+#include <QByteArray>
 #include <QCoreApplication>
 #include <QXmlStreamReader>
 #include <QXmlStreamWriter>
@@ -30,8 +34,12 @@
 #include "core/symbols/symbol.h"
 #include "fileformats/file_import_export.h"
 
+class QBuffer;
+
 namespace OpenOrienteering {
 
+class MapPart;
+
 /** Map exporter for the xml based map format. */
 class XMLFileExporter : public Exporter
 {
@@ -53,14 +61,13 @@ protected:
 	void exportGeoreferencing();
 	void exportColors();
 	void exportSymbols();
-	void exportMapParts();
+	virtual void exportMapParts();
 	void exportTemplates();
 	void exportView();
 	void exportPrint();
 	void exportUndo();
 	void exportRedo();
 	
-private:
 	QXmlStreamWriter xml;
 };
 
@@ -81,8 +88,16 @@ public:
 	XMLFileImporter& operator=(XMLFileImporter&&) = delete;	
 	
 protected:
+	/**
+	 * Imports the XML document, after uncompressing it if necessary.
+	 */
 	bool importImplementation() override;
 	
+	/**
+	 * Imports the XML document from the device.
+	 */
+	bool importDocument();
+	
 	void importElements();
 	
 	void handleBarrier(const std::function<void()>& reader);
@@ -100,11 +115,80 @@ protected:
 	void importUndo();
 	void importRedo();
 	
+	/**
+	 * Reports the progress from the position in the input device.
+	 */
+	void reportDeviceProgress();
+	
+	/**
+	 * Prepares loading the objects of the map parts concurrently.
+	 * 
+	 * For input larger than the "parallelThreshold" option, the raw data is
+	 * scanned for the objects in the map parts. On success, the objects' data
+	 * is cut from the XML document, each part element is tagged with the index
+	 * of its chunks, and the remaining document is provided by parallel_input.
+	 * Otherwise, the input device is left unchanged.
+	 */
+	void prepareParallelImport();
+	
+	/**
+	 * Prepares loading only the symbols.
+	 * 
+	 * The map parts, templates, and undo and redo steps are cut from the raw
+	 * data, which is much faster than skipping them with the XML reader.
+	 * Like in prepareParallelImport(), the remaining document is provided by
+	 * parallel_input. Otherwise, the input device is left unchanged.
+	 */
+	void prepareSymbolsOnlyImport();
+	
+	/**
+	 * Loads the objects of a map part from the chunks found by
+	 * prepareParallelImport(), and appends them to the given part.
+	 */
+	void importObjectChunks(MapPart* part, std::size_t index);
+	
 private:
+	/**
+	 * A range of consecutive object elements in the raw data.
+	 * 
+	 * Chunks with text objects must be loaded on the main thread because
+	 * text coordinates temporarily modify the global MapCoord::boundsOffset().
+	 */
+	struct ObjectChunk
+	{
+		int begin;
+		int end;
+		int line;
+		int count;
+		bool text;
+	};
+	
+	/**
+	 * A replacement of a range of the raw data.
+	 */
+	struct Splice
+	{
+		int begin;
+		int end;
+		QByteArray replacement;
+	};
+	
+	/**
+	 * Finds the chunks of objects in the map parts of the raw data.
+	 * 
+	 * On success, splices receives the changes which turn the raw data into
+	 * the document which is read serially.
+	 */
+	bool scanObjectChunks(const QByteArray& data, std::vector<Splice>& splices);
+	
 	QXmlStreamReader xml;
 	SymbolDictionary symbol_dict;
 	int version = -1;
 	bool georef_offset_adjusted;
+	
+	QByteArray parallel_data;
+	std::unique_ptr<QBuffer> parallel_input;
+	std::vector<std::vector<ObjectChunk>> object_chunks;
 };
 
 
@@ -0,0 +1,286 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#include "gdal_contours.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include <QtGlobal>
+#include <QtConcurrent>
+#include <QByteArray>
+#include <QFile>
+#include <QFuture>
+#include <QPointF>
+#include <QRect>
+
+#include <cpl_error.h>
+#include <gdal.h>
+#include <gdal_alg.h>
+#include <ogr_api.h>
+#include <ogr_srs_api.h>
+
+#include "gdal/gdal_image_reader.h"
+#include "gdal/gdal_manager.h"
+#include "gdal/ogr_file_format_p.h"
+
+
+namespace OpenOrienteering {
+
+namespace {
+
+/** A contour line in raster pixel coordinates. */
+struct ContourLine
+{
+	double elevation;
+	std::vector<QPointF> points;
+};
+
+/** The contour lines of a tile. */
+struct ContourTile
+{
+	std::vector<ContourLine> lines;
+	QString error;
+};
+
+/** The settings which are shared by all tile jobs. */
+struct ContourJob
+{
+	QString path;
+	int band;
+	double interval;
+	double base;
+	const std::atomic_bool* canceled;
+};
+
+
+/** The GDALContourWriter which collects the lines of a tile. */
+CPLErr collectLine(double level, int num_points, double* x, double* y, void* data)
+{
+	auto& lines = *static_cast<std::vector<ContourLine>*>(data);
+	lines.push_back({ level, {} });
+	auto& points = lines.back().points;
+	points.reserve(std::size_t(num_points));
+	for (int i = 0; i < num_points; ++i)
+		points.emplace_back(x[i], y[i]);
+	return CE_None;
+}
+
+/**
+ * Traces the contours of the given tile.
+ * 
+ * The points are returned in raster pixel coordinates, in the same way as
+ * GDALContourGenerate() passes them to the geotransform.
+ */
+ContourTile traceTile(const ContourJob& job, const QRect& tile_rect)
+{
+	auto tile = ContourTile {};
+	if (*job.canceled)
+		return tile;
+	
+	GdalImageReader reader(job.path);
+	auto const width = tile_rect.width();
+	auto const height = tile_rect.height();
+	auto values = std::vector<double>(std::size_t(width) * std::size_t(height));
+	if (!reader.readValues(job.band, tile_rect, values.data()))
+	{
+		tile.error = QString::fromUtf8(CPLGetLastErrorMsg());
+		return tile;
+	}
+	
+	double no_data = 0;
+	auto const has_no_data = reader.readNoDataValue(job.band, &no_data);
+	auto generator = GDAL_CG_Create(width, height, has_no_data, no_data,
+	                                job.interval, job.base, &collectLine, &tile.lines);
+	for (int y = 0; y < height && !*job.canceled; ++y)
+	{
+		if (GDAL_CG_FeedLine(generator, values.data() + std::size_t(y) * std::size_t(width)) != CE_None)
+		{
+			tile.error = QString::fromUtf8(CPLGetLastErrorMsg());
+			break;
+		}
+	}
+	GDAL_CG_Destroy(generator);  // Flushes the remaining lines.
+	
+	for (auto& line : tile.lines)
+	{
+		for (auto& point : line.points)
+			point += QPointF(tile_rect.topLeft());
+	}
+	return tile;
+}
+
+/**
+ * Returns the tiles for a raster of the given size.
+ * 
+ * Each tile includes the first row and column of its neighbors.
+ */
+std::vector<QRect> makeTiles(int width, int height, int tile_size)
+{
+	std::vector<QRect> tiles;
+	for (int y = 0; y + 1 < height; y += tile_size)
+	{
+		for (int x = 0; x + 1 < width; x += tile_size)
+			tiles.emplace_back(x, y, std::min(tile_size + 1, width - x), std::min(tile_size + 1, height - y));
+	}
+	return tiles;
+}
+
+
+}  // namespace
+
+
+
+GdalContourGenerator::GdalContourGenerator(const QString& raster_path)
+: raster_path(raster_path)
+{}
+
+void GdalContourGenerator::setInterval(double interval)
+{
+	Q_ASSERT(interval > 0);
+	contour_interval = interval;
+}
+
+void GdalContourGenerator::setBase(double base)
+{
+	contour_base = base;
+}
+
+void GdalContourGenerator::setBand(int band)
+{
+	raster_band = band;
+}
+
+
+bool GdalContourGenerator::generate(const QString& vector_path, const ProgressFunction& progress)
+{
+	error_string.clear();
+	
+	GdalManager();
+	GdalImageReader reader(raster_path);
+	if (!reader.canRead())
+	{
+		error_string = reader.errorString();
+		return false;
+	}
+	
+	QByteArray projection;
+	auto const geo_transform = reader.readRawGeoTransform(&projection);
+	auto const size = reader.readRasterInfo().size;
+	
+	auto po_driver = OGRGetDriverByName("GPKG");
+	if (!po_driver)
+	{
+		error_string = tr("The GeoPackage driver is not available.");
+		return false;
+	}
+	
+	auto po_ds = ogr::unique_datasource(OGR_Dr_CreateDataSource(po_driver, vector_path.toUtf8(), nullptr));
+	if (!po_ds)
+	{
+		error_string = tr("Failed to create dataset: %1").arg(QString::fromUtf8(CPLGetLastErrorMsg()));
+		return false;
+	}
+	
+	auto srs = ogr::unique_srs(projection.isEmpty() ? nullptr : OSRNewSpatialReference(projection));
+	auto po_layer = GDALDatasetCreateLayer(po_ds.get(), "contour", srs.get(), wkbLineString, nullptr);
+	auto elevation_field = ogr::unique_fielddefn(OGR_Fld_Create("ELEV", OFTReal));
+	if (!po_layer || OGR_L_CreateField(po_layer, elevation_field.get(), 1) != OGRERR_NONE)
+	{
+		error_string = tr("Failed to create layer %1: %2").arg(QStringLiteral("contour"), QString::fromUtf8(CPLGetLastErrorMsg()));
+		po_ds.reset();
+		QFile::remove(vector_path);
+		return false;
+	}
+	
+	// Drivers with native transactions, e.g. for GeoPackage, are much faster
+	// when all features are written in a single transaction.
+	auto const transaction = GDALDatasetStartTransaction(po_ds.get(), false) == OGRERR_NONE;
+	
+	std::atomic_bool canceled { false };
+	auto const job = ContourJob { raster_path, raster_band, contour_interval, contour_base, &canceled };
+	auto const tiles = makeTiles(size.width(), size.height(), tile_size);
+	std::vector<QFuture<ContourTile>> futures;
+	futures.reserve(tiles.size());
+	for (auto const& tile_rect : tiles)
+		futures.push_back(QtConcurrent::run(&traceTile, job, tile_rect));
+	
+	// Write the tiles in order, while the following ones are traced.
+	auto const layer_defn = OGR_L_GetLayerDefn(po_layer);
+	for (std::size_t i = 0; i < futures.size(); ++i)
+	{
+		auto const tile = futures[i].result();
+		if (!tile.error.isEmpty() && error_string.isEmpty())
+		{
+			error_string = tr("Failed to read image data: %1").arg(tile.error);
+			canceled = true;
+		}
+		if (canceled)
+			continue;
+		
+		for (auto const& line : tile.lines)
+		{
+			auto geometry = ogr::unique_geometry(OGR_G_CreateGeometry(wkbLineString));
+			OGR_G_SetPointCount(geometry.get(), int(line.points.size()));
+			for (std::size_t j = 0; j < line.points.size(); ++j)
+			{
+				auto const& point = line.points[j];
+				OGR_G_SetPoint_2D(geometry.get(), int(j),
+				                  geo_transform[0] + geo_transform[1] * point.x() + geo_transform[2] * point.y(),
+				                  geo_transform[3] + geo_transform[4] * point.x() + geo_transform[5] * point.y());
+			}
+			
+			auto feature = ogr::unique_feature(OGR_F_Create(layer_defn));
+			OGR_F_SetFieldDouble(feature.get(), 0, line.elevation);
+			OGR_F_SetGeometryDirectly(feature.get(), geometry.release());
+			if (OGR_L_CreateFeature(po_layer, feature.get()) != OGRERR_NONE)
+			{
+				error_string = tr("Failed to create feature: %1").arg(QString::fromUtf8(CPLGetLastErrorMsg()));
+				canceled = true;
+				break;
+			}
+		}
+		
+		if (progress && !canceled && !progress(int(100 * (i + 1) / futures.size())))
+			canceled = true;
+	}
+	
+	if (!canceled && transaction && GDALDatasetCommitTransaction(po_ds.get()) != OGRERR_NONE)
+	{
+		error_string = tr("Failed to write the contours: %1").arg(QString::fromUtf8(CPLGetLastErrorMsg()));
+		canceled = true;
+	}
+	
+	po_ds.reset();
+	if (canceled)
+	{
+		QFile::remove(vector_path);
+		return false;
+	}
+	return true;
+}
+
+
+}  // namespace OpenOrienteering
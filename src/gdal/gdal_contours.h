@@ -0,0 +1,110 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#ifndef OPENORIENTEERING_GDAL_CONTOURS_H
+#define OPENORIENTEERING_GDAL_CONTOURS_H
+
+#include <functional>
+
+#include <QCoreApplication>
+#include <QString>
+
+namespace OpenOrienteering {
+
+
+/**
+ * Generates contour lines from an elevation raster, e.g. a lidar DEM.
+ * 
+ * The raster is read through GdalImageReader and traced by GDAL's contour
+ * generator in tiles which are processed concurrently. Each tile opens its
+ * own reader, because GDAL dataset handles must not be shared between
+ * threads. Adjacent tiles share a row or column of raster pixels, so the
+ * contour lines of neighboring tiles meet at the tile boundaries.
+ * 
+ * The lines are written to a GeoPackage file while the remaining tiles are
+ * still being traced. The file can be opened as an OgrTemplate, and imported
+ * into the map from there.
+ */
+class GdalContourGenerator
+{
+	Q_DECLARE_TR_FUNCTIONS(OpenOrienteering::GdalContourGenerator)
+	
+public:
+	/** The width and height of the tiles, in raster pixels. */
+	static constexpr int tile_size = 1024;
+	
+	/**
+	 * A function which receives the progress in percent.
+	 * 
+	 * It returns false in order to cancel the generation.
+	 */
+	using ProgressFunction = std::function<bool (int)>;
+	
+	
+	explicit GdalContourGenerator(const QString& raster_path);
+	
+	/** Returns the elevation difference between contours. */
+	double interval() const { return contour_interval; }
+	
+	/** Sets the elevation difference between contours. It must be positive. */
+	void setInterval(double interval);
+	
+	/** Returns the elevation of a contour, relative to which the others are placed. */
+	double base() const { return contour_base; }
+	
+	/** Sets the elevation of a contour, relative to which the others are placed. */
+	void setBase(double base);
+	
+	/** Returns the raster band which holds the elevation. */
+	int band() const { return raster_band; }
+	
+	/** Sets the raster band which holds the elevation. */
+	void setBand(int band);
+	
+	
+	/**
+	 * Generates the contours and writes them to a new GeoPackage file.
+	 * 
+	 * The file gets a single line layer "contour", with the elevation in the
+	 * field "ELEV", and with the spatial reference system of the raster.
+	 * 
+	 * Returns false on error or when canceled. For now, an empty error
+	 * string means that the generation was canceled.
+	 */
+	bool generate(const QString& vector_path, const ProgressFunction& progress = {});
+	
+	/** Returns a description of the last error. */
+	const QString& errorString() const { return error_string; }
+	
+	
+private:
+	QString raster_path;
+	QString error_string;
+	double contour_interval = 10;
+	double contour_base = 0;
+	int raster_band = 1;
+	
+};
+
+
+}  // namespace OpenOrienteering
+
+#endif // OPENORIENTEERING_GDAL_CONTOURS_H
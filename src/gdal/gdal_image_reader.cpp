@@ -25,9 +25,12 @@
 
 #include <Qt>
 #include <QtGlobal>
+#include <QByteArray>
 #include <QCoreApplication>
 #include <QImage>
 #include <QImageReader>
+#include <QPoint>
+#include <QRect>
 #include <QRgb>
 #include <QSize>
 #include <QString>
@@ -45,11 +48,24 @@
 namespace OpenOrienteering {
 
 GdalImageReader::GdalImageReader(const QString& path)
+: GdalImageReader(path, 0)
+{}
+
+GdalImageReader::GdalImageReader(const QString& path, double document_dpi)
 : path(path)
 {
 	GdalManager();
 	CPLErrorReset();
-	dataset = GDALOpen(path.toUtf8(), GA_ReadOnly);
+	if (document_dpi > 0)
+	{
+		auto const dpi_option = "DPI=" + QByteArray::number(document_dpi);
+		const char* const open_options[] = { dpi_option.constData(), nullptr };
+		dataset = GDALOpenEx(path.toUtf8(), GDAL_OF_RASTER | GDAL_OF_READONLY, nullptr, open_options, nullptr);
+	}
+	else
+	{
+		dataset = GDALOpen(path.toUtf8(), GA_ReadOnly);
+	}
 	if (dataset)
 		raster_count = GDALGetRasterCount(dataset);
 	if (!canRead())
@@ -128,14 +144,23 @@ bool GdalImageReader::read(QImage* image)
 		return false;
 	}
 	
+	return read(image, raster, QRect(QPoint(0, 0), raster.size));
+}
+
+bool GdalImageReader::read(QImage* image, const RasterInfo& raster, const QRect& raster_rect)
+{
+	Q_ASSERT(image);
+	Q_ASSERT(image->format() == raster.image_format);
+	
+	// GDAL wants a non-const band map.
+	auto bands = raster.bands;
+	
 	image->fill(Qt::white);
-	auto const width = raster.size.width();
-	auto const height = raster.size.height();
 	CPLErrorReset();
 	auto result = GDALDatasetRasterIO(dataset, GF_Read, 
-	                                  0, 0, width, height,
-	                                  image->bits() + raster.band_offset, width, height,
-	                                  GDT_Byte, raster.bands.count(), raster.bands.data(),
+	                                  raster_rect.x(), raster_rect.y(), raster_rect.width(), raster_rect.height(),
+	                                  image->bits() + raster.band_offset, image->width(), image->height(),
+	                                  GDT_Byte, bands.count(), bands.data(),
 	                                  raster.pixel_space, image->bytesPerLine(), raster.band_space);
 	if (result >= CE_Warning)
 	{
@@ -295,6 +320,48 @@ TemplateImage::GeoreferencingOption GdalImageReader::readGeoTransform()
 }
 
 
+bool GdalImageReader::readValues(int band, const QRect& raster_rect, double* values) const
+{
+	if (band < 1 || band > raster_count)
+		return false;
+	
+	auto const raster_band = GDALGetRasterBand(dataset, band);
+	CPLErrorReset();
+	auto const result = GDALRasterIO(raster_band, GF_Read,
+	                                 raster_rect.x(), raster_rect.y(), raster_rect.width(), raster_rect.height(),
+	                                 values, raster_rect.width(), raster_rect.height(), GDT_Float64,
+	                                 0, 0);
+	return result < CE_Warning;
+}
+
+bool GdalImageReader::readNoDataValue(int band, double* value) const
+{
+	if (band < 1 || band > raster_count)
+		return false;
+	
+	int has_no_data = 0;
+	auto const no_data = GDALGetRasterNoDataValue(GDALGetRasterBand(dataset, band), &has_no_data);
+	if (has_no_data)
+		*value = no_data;
+	return has_no_data != 0;
+}
+
+std::array<double, 6> GdalImageReader::readRawGeoTransform(QByteArray* projection) const
+{
+	auto geo_transform = std::array<double, 6> { 0, 1, 0, 0, 0, 1 };
+	if (projection)
+		projection->clear();
+	if (dataset != nullptr)
+	{
+		if (GDALGetGeoTransform(dataset, geo_transform.data()) != CE_None)
+			geo_transform = { 0, 1, 0, 0, 0, 1 };
+		else if (projection)
+			*projection = GDALGetProjectionRef(dataset);
+	}
+	return geo_transform;
+}
+
+
 // static
 QString GdalImageReader::toProjSpec(const QByteArray& gdal_spec)
 {
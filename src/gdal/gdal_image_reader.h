@@ -20,12 +20,14 @@
 #ifndef OPENORIENTEERING_GDAL_IMAGE_READER_H
 #define OPENORIENTEERING_GDAL_IMAGE_READER_H
 
+#include <array>
 #include <functional>
 
 #include <QByteArray>
 #include <QCoreApplication>
 #include <QImage>
 #include <QImageReader>
+#include <QRect>
 #include <QRgb>
 #include <QSize>
 #include <QString>
@@ -55,6 +57,14 @@ public:
 	
 	explicit GdalImageReader(const QString& path);
 	
+	/**
+	 * Opens the given file, rasterizing documents at the given resolution.
+	 * 
+	 * The resolution is passed to drivers for vector documents, such as PDF.
+	 * It is ignored for regular rasters, and when it is not positive.
+	 */
+	GdalImageReader(const QString& path, double document_dpi);
+	
 	~GdalImageReader();
 	
 	bool canRead() const;
@@ -93,8 +103,38 @@ public:
 	
 	RasterInfo readRasterInfo() const;
 	
+	/**
+	 * Reads a part of the raster into the given image.
+	 * 
+	 * The image must be allocated with the raster's image format before.
+	 * The raster_rect, given in raster pixels, is scaled to the size of the
+	 * image. When this means downsampling, GDAL may use overviews.
+	 */
+	bool read(QImage* image, const RasterInfo& raster, const QRect& raster_rect);
+	
 	QVector<QRgb> readColorTable(int band) const;
 	
+	/**
+	 * Reads a part of a raster band, e.g. elevation data, as double values.
+	 * 
+	 * The values are stored row by row, and the buffer must be large enough
+	 * for the raster_rect, given in raster pixels.
+	 */
+	bool readValues(int band, const QRect& raster_rect, double* values) const;
+	
+	/**
+	 * Returns true if the raster band has a nodata value, and stores it.
+	 */
+	bool readNoDataValue(int band, double* value) const;
+	
+	/**
+	 * Returns the file's raw GDAL geotransform and projection.
+	 * 
+	 * Without a valid geotransform, the result is GDAL's default identity
+	 * transform, and the projection is empty.
+	 */
+	std::array<double, 6> readRawGeoTransform(QByteArray* projection = nullptr) const;
+	
 	/**
 	 * Returns the file's geotransform in a type suitable for TemplateImage.
 	 * 
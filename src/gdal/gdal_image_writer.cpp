@@ -0,0 +1,212 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "gdal_image_writer.h"
+
+#include <vector>
+
+#include <QtGlobal>
+#include <QByteArray>
+#include <QFile>
+#include <QImage>
+#include <QString>
+#include <QTransform>
+
+#include <cpl_conv.h>
+#include <cpl_error.h>
+#include <cpl_string.h>
+#include <gdal.h>
+#include <ogr_srs_api.h>
+
+#include "gdal/gdal_manager.h"
+
+
+namespace OpenOrienteering {
+
+namespace {
+
+/// The width and height of the tiles in the GeoTIFF file.
+constexpr int tile_size = 256;
+
+QString lastErrorMessage()
+{
+	return QString::fromUtf8(CPLGetLastErrorMsg());
+}
+
+}  // namespace
+
+
+
+GdalImageWriter::GdalImageWriter(const QString& path)
+: path(path)
+{
+	GdalManager();
+}
+
+GdalImageWriter::~GdalImageWriter()
+{
+	if (dataset)
+	{
+		close();
+		QFile::remove(path);
+	}
+}
+
+bool GdalImageWriter::open(const QSize& size, int dots_per_meter)
+{
+	Q_ASSERT(!dataset);
+	
+	auto* driver = GDALGetDriverByName("GTiff");
+	if (!driver)
+	{
+		error_string = tr("The GeoTIFF driver is not available.");
+		return false;
+	}
+	
+	char** options = nullptr;
+	options = CSLSetNameValue(options, "TILED", "YES");
+	options = CSLSetNameValue(options, "BLOCKXSIZE", QByteArray::number(tile_size));
+	options = CSLSetNameValue(options, "BLOCKYSIZE", QByteArray::number(tile_size));
+	options = CSLSetNameValue(options, "COMPRESS", "DEFLATE");
+	options = CSLSetNameValue(options, "PREDICTOR", "2");
+	options = CSLSetNameValue(options, "PHOTOMETRIC", "RGB");
+	options = CSLSetNameValue(options, "BIGTIFF", "IF_SAFER");
+	CPLErrorReset();
+	dataset = GDALCreate(driver, path.toUtf8(), size.width(), size.height(), 3, GDT_Byte, options);
+	CSLDestroy(options);
+	if (!dataset)
+	{
+		error_string = tr("Failed to create the image file: %1").arg(lastErrorMessage());
+		return false;
+	}
+	this->size = size;
+	
+	if (dots_per_meter > 0)
+	{
+		// TIFF resolution unit 3 is centimeter.
+		const auto resolution = QByteArray::number(dots_per_meter / 100.0);
+		GDALSetMetadataItem(dataset, "TIFFTAG_XRESOLUTION", resolution, nullptr);
+		GDALSetMetadataItem(dataset, "TIFFTAG_YRESOLUTION", resolution, nullptr);
+		GDALSetMetadataItem(dataset, "TIFFTAG_RESOLUTIONUNIT", "3", nullptr);
+	}
+	return true;
+}
+
+bool GdalImageWriter::setGeoreferencing(const QTransform& pixel_to_projected, const QString& crs_spec)
+{
+	Q_ASSERT(dataset);
+	
+	double geo_transform[6] = {
+	    pixel_to_projected.dx(),  pixel_to_projected.m11(), pixel_to_projected.m21(),
+	    pixel_to_projected.dy(),  pixel_to_projected.m12(), pixel_to_projected.m22()
+	};
+	CPLErrorReset();
+	if (GDALSetGeoTransform(dataset, geo_transform) != CE_None)
+	{
+		error_string = tr("Failed to set the georeferencing: %1").arg(lastErrorMessage());
+		return false;
+	}
+	
+	if (crs_spec.isEmpty())
+		return true;
+	
+	auto srs = OSRNewSpatialReference(nullptr);
+	char* wkt = nullptr;
+	auto ok = OSRImportFromProj4(srs, crs_spec.toLatin1()) == OGRERR_NONE
+	          && OSRExportToWkt(srs, &wkt) == OGRERR_NONE
+	          && GDALSetProjection(dataset, wkt) == CE_None;
+	CPLFree(wkt);
+	OSRDestroySpatialReference(srs);
+	if (!ok)
+		error_string = tr("Failed to set the coordinate reference system: %1").arg(lastErrorMessage());
+	return ok;
+}
+
+bool GdalImageWriter::write(const QImage& strip, int top)
+{
+	Q_ASSERT(dataset);
+	
+	const auto height = qMin(strip.height(), size.height() - top);
+	if (top < 0 || height <= 0 || strip.width() != size.width())
+	{
+		error_string = tr("Invalid image data.");
+		return false;
+	}
+	
+	const auto rgb = strip.convertToFormat(QImage::Format_RGB888);
+	if (rgb.isNull())
+	{
+		error_string = tr("Not enough memory.");
+		return false;
+	}
+	
+	CPLErrorReset();
+	// GF_Write does not modify the buffer.
+	auto* data = const_cast<uchar*>(rgb.constBits());
+	if (GDALDatasetRasterIO(dataset, GF_Write, 0, top, size.width(), height,
+	                        data, size.width(), height, GDT_Byte,
+	                        3, nullptr, 3, rgb.bytesPerLine(), 1) != CE_None)
+	{
+		error_string = tr("Failed to write the image data: %1").arg(lastErrorMessage());
+		return false;
+	}
+	return true;
+}
+
+bool GdalImageWriter::finish()
+{
+	Q_ASSERT(dataset);
+	
+	// Overviews down to a single tile
+	std::vector<int> levels;
+	for (auto level = 2; qMax(size.width(), size.height()) / (level / 2) > tile_size; level *= 2)
+		levels.push_back(level);
+	
+	CPLErrorReset();
+	if (!levels.empty()
+	    && GDALBuildOverviews(dataset, "AVERAGE", int(levels.size()), levels.data(), 0, nullptr, nullptr, nullptr) != CE_None)
+	{
+		error_string = tr("Failed to build the overviews: %1").arg(lastErrorMessage());
+		return false;
+	}
+	
+	close();
+	if (CPLGetLastErrorType() >= CE_Failure)
+	{
+		error_string = tr("Failed to write the image data: %1").arg(lastErrorMessage());
+		QFile::remove(path);
+		return false;
+	}
+	return true;
+}
+
+QString GdalImageWriter::errorString() const
+{
+	return error_string;
+}
+
+void GdalImageWriter::close()
+{
+	GDALClose(dataset);
+	dataset = nullptr;
+}
+
+
+}  // namespace OpenOrienteering
@@ -0,0 +1,103 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef OPENORIENTEERING_GDAL_IMAGE_WRITER_H
+#define OPENORIENTEERING_GDAL_IMAGE_WRITER_H
+
+#include <QCoreApplication>
+#include <QSize>
+#include <QString>
+
+class QImage;
+class QTransform;
+
+namespace OpenOrienteering {
+
+
+/**
+ * A GDAL writer for tiled GeoTIFF images which are produced in strips.
+ * 
+ * The image is written to a tiled, compressed GeoTIFF file while it is
+ * produced, so that the full image never needs to be held in memory.
+ * Overviews are built when finishing the file.
+ */
+class GdalImageWriter
+{
+public:
+	GdalImageWriter() = delete;
+	GdalImageWriter(const GdalImageWriter&) = delete;
+	GdalImageWriter(GdalImageWriter&&) = delete;
+	GdalImageWriter& operator=(const GdalImageWriter&) = delete;
+	GdalImageWriter& operator=(GdalImageWriter&&) = delete;
+	
+	explicit GdalImageWriter(const QString& path);
+	
+	/**
+	 * Closes the file if necessary.
+	 * 
+	 * An unfinished file is removed.
+	 */
+	~GdalImageWriter();
+	
+	/**
+	 * Creates an RGB image file of the given size.
+	 */
+	bool open(const QSize& size, int dots_per_meter);
+	
+	/**
+	 * Sets the georeferencing of the image.
+	 * 
+	 * The transform maps pixel corner coordinates to projected coordinates.
+	 * The CRS is given as a PROJ specification. It is not set if empty.
+	 */
+	bool setGeoreferencing(const QTransform& pixel_to_projected, const QString& crs_spec);
+	
+	/**
+	 * Writes a strip of the image, starting at the given row.
+	 */
+	bool write(const QImage& strip, int top);
+	
+	/**
+	 * Builds the overviews and closes the file.
+	 */
+	bool finish();
+	
+	QString errorString() const;
+	
+	
+	// Translation
+	
+	Q_DECLARE_TR_FUNCTIONS(OpenOrienteering::GdalImageWriter)
+	
+	
+private:
+	void close();
+	
+	QString path;
+	QString error_string;
+	QSize size;
+	void* dataset = nullptr;  // GDALDatasetH
+	
+};
+
+
+}  // namespace OpenOrienteering
+
+#endif  // OPENORIENTEERING_GDAL_IMAGE_WRITER_H
@@ -39,6 +39,7 @@
 #include <QVariant>
 
 #include "gdal/gdal_extensions.h"
+#include "util/profiler.h"
 #include "util/backports.h"  // IWYU pragma: keep
 
 
@@ -70,6 +71,7 @@ public:
 	GdalManagerPrivate()
 	: dirty{ true }
 	{
+		Profiler::Scope scope(Profiler::GdalSetup);
 		GDALAllRegister();
 
 		// Prefer LIBMKL driver to the KML driver if available
@@ -397,6 +399,7 @@ private:
 		
 	void update()
 	{
+		Profiler::Scope scope(Profiler::GdalSetup);
 		QSettings settings;
 		updateExtensions(settings);
 		updateConfig(settings);
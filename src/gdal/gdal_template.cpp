@@ -19,18 +19,64 @@
 
 #include "gdal_template.h"
 
+#include <cmath>
+
 #include <QtGlobal>
 #include <QByteArray>
 #include <QChar>
+#include <QImage>
 #include <QImageReader>
+#include <QObject>
+#include <QPaintDevice>
+#include <QPainter>
+#include <QPointF>
+#include <QRect>
+#include <QRectF>
 #include <QString>
+#include <QTransform>
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
+
+#include <gdal.h>
 
+#include "core/georeferencing.h"
+#include "core/map.h"
+#include "core/map_coord.h"
 #include "gdal/gdal_image_reader.h"
 #include "gdal/gdal_manager.h"
+#include "gdal/gdal_tiled_raster.h"
+#include "gdal/gdal_warped_raster.h"
+#include "util/util.h"
 
 
 namespace OpenOrienteering {
 
+namespace {
+
+/**
+ * Rasters which need more memory than this are loaded in tiles, on demand.
+ */
+constexpr qint64 max_image_bytes = 256 * 1024 * 1024;
+
+/**
+ * The resolution of the most detailed tiles of documents.
+ */
+constexpr double document_dpi = 600;
+
+/**
+ * Returns true if the file is a vector document which GDAL rasterizes.
+ */
+bool isDocument(const QString& path)
+{
+	GdalManager();
+	auto const driver = GDALIdentifyDriver(path.toUtf8(), nullptr);
+	return driver && qstrcmp(GDALGetDriverShortName(driver), "PDF") == 0;
+}
+
+}  // namespace
+
+
+
 // static
 bool GdalTemplate::canRead(const QString& path)
 {
@@ -47,9 +93,24 @@ const std::vector<QByteArray>& GdalTemplate::supportedExtensions()
 
 GdalTemplate::GdalTemplate(const QString& path, Map* map)
 : TemplateImage(path, map)
-{}
+{
+	const Georeferencing& georef = map->getGeoreferencing();
+	QObject::connect(&georef, &Georeferencing::projectionChanged, this, [this]() { updateWarping(); });
+	QObject::connect(&georef, &Georeferencing::stateChanged, this, [this]() { updateWarping(); });
+}
 
-GdalTemplate::GdalTemplate(const GdalTemplate& proto) = default;
+GdalTemplate::GdalTemplate(const GdalTemplate& proto)
+: TemplateImage(proto)
+, warp_crs_spec(proto.warp_crs_spec)
+, warped_raster(proto.warped_raster)
+{
+	if (proto.tiled_raster)
+		setupTiledRaster(proto.tiled_raster->path(), proto.tiled_raster->size(), proto.tiled_raster->documentDpi());
+	
+	const Georeferencing& georef = map->getGeoreferencing();
+	QObject::connect(&georef, &Georeferencing::projectionChanged, this, [this]() { updateWarping(); });
+	QObject::connect(&georef, &Georeferencing::stateChanged, this, [this]() { updateWarping(); });
+}
 
 GdalTemplate::~GdalTemplate() = default;
 
@@ -65,7 +126,23 @@ const char* GdalTemplate::getTemplateType() const
 
 bool GdalTemplate::loadTemplateFileImpl(bool configuring)
 {
-	GdalImageReader reader(template_path);
+	if (configuring)
+		warp_crs_spec = warpTarget();
+	warped_raster.reset();
+	if (!warp_crs_spec.isEmpty())
+	{
+		auto warped = std::make_shared<GdalWarpedRaster>(template_path, warp_crs_spec);
+		if (!warped->isValid())
+		{
+			setErrorString(warped->errorString());
+			return false;
+		}
+		warped_raster = std::move(warped);
+	}
+	
+	auto const& raster_path = warped_raster ? warped_raster->path() : template_path;
+	auto const dpi = (!warped_raster && isDocument(raster_path)) ? document_dpi : 0.0;
+	GdalImageReader reader(raster_path, dpi);
 	if (!reader.canRead())
 	{
 		setErrorString(reader.errorString());
@@ -74,7 +151,32 @@ bool GdalTemplate::loadTemplateFileImpl(bool configuring)
 	
 	qDebug("GdalTemplate: Using GDAL driver '%s'", reader.format().constData());
 	
-	if (!reader.read(&image))
+	auto const raster = reader.readRasterInfo();
+	if (raster.image_format != QImage::Format_Invalid && dpi > 0)
+	{
+		// Documents are rasterized for the visible tiles at the current zoom.
+		qDebug("GdalTemplate: Rasterizing tiles on demand for %dx%d pixels",
+		       raster.size.width(), raster.size.height());
+		image = QImage();
+		setupTiledRaster(raster_path, raster.size, dpi);
+	}
+	else if (raster.image_format != QImage::Format_Invalid && warped_raster)
+	{
+		// Warping the full raster would take too long.
+		qDebug("GdalTemplate: Warping tiles on demand for %dx%d pixels",
+		       raster.size.width(), raster.size.height());
+		image = QImage();
+		setupTiledRaster(raster_path, raster.size);
+	}
+	else if (raster.image_format != QImage::Format_Invalid
+	    && qint64(raster.size.width()) * raster.size.height() * 4 > max_image_bytes)
+	{
+		qDebug("GdalTemplate: Loading tiles on demand for %dx%d pixels",
+		       raster.size.width(), raster.size.height());
+		image = QImage();
+		setupTiledRaster(raster_path, raster.size);
+	}
+	else if (!reader.read(&image))
 	{
 		setErrorString(reader.errorString());
 		
@@ -90,8 +192,17 @@ bool GdalTemplate::loadTemplateFileImpl(bool configuring)
 		}
 	}
 	
+	if (!tiled_raster)
+		buildPyramid();
+	
 	// Duplicated from TemplateImage, for compatibility
 	available_georef = findAvailableGeoreferencing(reader.readGeoTransform());
+	if (warped_raster)
+	{
+		// A world file would refer to the original raster.
+		available_georef.effective.crs_spec = warp_crs_spec;
+		available_georef.effective.transform = available_georef.template_file.transform;
+	}
 	if (!configuring && is_georeferenced)
 	{
 		if (!isGeoreferencingUsable())
@@ -107,5 +218,172 @@ bool GdalTemplate::loadTemplateFileImpl(bool configuring)
 	return true;
 }
 
+std::function<void ()> GdalTemplate::makeBackgroundLoader()
+{
+	return {};
+}
+
+
+void GdalTemplate::unloadTemplateFileImpl()
+{
+	tiled_raster.reset();
+	warped_raster.reset();
+	TemplateImage::unloadTemplateFileImpl();
+}
+
+
+void GdalTemplate::saveTypeSpecificTemplateConfiguration(QXmlStreamWriter& xml) const
+{
+	TemplateImage::saveTypeSpecificTemplateConfiguration(xml);
+	if (!warp_crs_spec.isEmpty())
+	{
+		xml.writeStartElement(QString::fromLatin1("warp_crs_spec"));
+		xml.writeCharacters(warp_crs_spec);
+		xml.writeEndElement(/*warp_crs_spec*/);
+	}
+}
+
+bool GdalTemplate::loadTypeSpecificTemplateConfiguration(QXmlStreamReader& xml)
+{
+	if (xml.name() == QLatin1String("warp_crs_spec"))
+	{
+		warp_crs_spec = xml.readElementText();
+		return true;
+	}
+	return TemplateImage::loadTypeSpecificTemplateConfiguration(xml);
+}
+
+
+QSize GdalTemplate::imageSize() const
+{
+	if (tiled_raster)
+		return tiled_raster->size();
+	return TemplateImage::imageSize();
+}
+
+double GdalTemplate::imageDpi() const
+{
+	return tiled_raster ? tiled_raster->documentDpi() : 0;
+}
+
+
+void GdalTemplate::drawTemplate(QPainter* painter, const QRectF& clip_rect, double scale, bool on_screen, qreal opacity) const
+{
+	if (!tiled_raster)
+	{
+		TemplateImage::drawTemplate(painter, clip_rect, scale, on_screen, opacity);
+		return;
+	}
+	
+	applyTemplateTransform(painter);
+	
+	// Determine the visible part of the raster, in raster pixels.
+	auto const size = tiled_raster->size();
+	auto const origin = QPointF(-size.width() * 0.5, -size.height() * 0.5);
+	auto const transform = painter->combinedTransform();
+	auto const* device = painter->device();
+	auto visible_rect = transform.inverted().mapRect(QRectF(0, 0, device->width(), device->height()));
+	if (painter->hasClipping())
+		visible_rect = visible_rect.intersected(painter->clipBoundingRect());
+	auto const raster_rect = visible_rect.translated(-origin).toAlignedRect();
+	
+	// Use the coarsest level which still has at least the resolution of the device.
+	auto const device_pixels_per_raster_pixel = std::sqrt(std::abs(transform.determinant()));
+	auto const level = tiled_raster->levelForResolution(device_pixels_per_raster_pixel);
+	auto const range = tiled_raster->tileRange(level, raster_rect);
+	if (range.isEmpty())
+		return;
+	
+	painter->setRenderHint(QPainter::SmoothPixmapTransform);
+	painter->setOpacity(opacity);
+	for (auto y = range.top(); y <= range.bottom(); ++y)
+	{
+		for (auto x = range.left(); x <= range.right(); ++x)
+		{
+			auto const tile_rect = tiled_raster->tileRasterRect(level, x, y);
+			auto const target = QRectF(tile_rect).translated(origin);
+			auto const tile = on_screen ? tiled_raster->tile(level, x, y) : tiled_raster->loadTile(level, x, y);
+			if (!tile.isNull())
+			{
+				painter->drawImage(target, tile);
+				continue;
+			}
+			
+			// Until the tile is loaded, draw the matching part of a coarser tile.
+			for (auto coarse_level = level + 1; coarse_level <= tiled_raster->maxLevel(); ++coarse_level)
+			{
+				auto const shift = coarse_level - level;
+				auto const coarse_tile = tiled_raster->cachedTile(coarse_level, x >> shift, y >> shift);
+				if (coarse_tile.isNull())
+					continue;
+				
+				auto const coarse_rect = tiled_raster->tileRasterRect(coarse_level, x >> shift, y >> shift);
+				auto const factor = std::ldexp(1.0, -coarse_level);
+				auto const source = QRectF((tile_rect.x() - coarse_rect.x()) * factor,
+				                           (tile_rect.y() - coarse_rect.y()) * factor,
+				                           tile_rect.width() * factor,
+				                           tile_rect.height() * factor);
+				painter->drawImage(target, coarse_tile, source);
+				break;
+			}
+		}
+	}
+	painter->setRenderHint(QPainter::SmoothPixmapTransform, false);
+}
+
+
+void GdalTemplate::setupTiledRaster(const QString& path, const QSize& size, double document_dpi)
+{
+	if (document_dpi > 0)
+		tiled_raster.reset(new GdalTiledRaster(path, document_dpi, size));
+	else
+		tiled_raster.reset(new GdalTiledRaster(path, size));
+	QObject::connect(tiled_raster.get(), &GdalTiledRaster::tileLoaded, this, [this](const QRect& raster_rect) {
+		tileLoaded(raster_rect);
+	});
+}
+
+
+QString GdalTemplate::warpTarget() const
+{
+	auto const& georef = map->getGeoreferencing();
+	if (!georef.isValid() || georef.isLocal()
+	    || !GdalWarpedRaster::needsWarping(template_path, georef.getProjectedCRSSpec()))
+		return {};
+	return georef.getProjectedCRSSpec();
+}
+
+
+void GdalTemplate::updateWarping()
+{
+	if (!is_georeferenced || template_state != Template::Loaded)
+		return;
+	
+	auto const target = warpTarget();
+	if (target == warp_crs_spec)
+		return;
+	
+	setTemplateAreaDirty();
+	unloadTemplateFile();
+	warp_crs_spec = target;
+	available_georef.effective.crs_spec.clear();
+	if (loadTemplateFile(false))
+		setTemplateAreaDirty();
+	map->setTemplatesDirty();
+}
+
+
+void GdalTemplate::tileLoaded(const QRect& raster_rect)
+{
+	auto const size = tiled_raster->size();
+	auto const rect = QRectF(raster_rect).translated(-size.width() * 0.5, -size.height() * 0.5);
+	QRectF map_bbox;
+	rectIncludeSafe(map_bbox, templateToMap(rect.topLeft()));
+	rectIncludeSafe(map_bbox, templateToMap(rect.topRight()));
+	rectIncludeSafe(map_bbox, templateToMap(rect.bottomLeft()));
+	rectIncludeSafe(map_bbox, templateToMap(rect.bottomRight()));
+	map->setTemplateAreaDirty(this, map_bbox, 0);
+}
+
 
 }  // namespace OpenOrienteering
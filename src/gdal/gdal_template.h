@@ -20,21 +20,47 @@
 #ifndef OPENORIENTEERING_GDAL_TEMPLATE_H
 #define OPENORIENTEERING_GDAL_TEMPLATE_H
 
+#include <functional>
+#include <memory>
 #include <vector>
 
+#include <QtGlobal>
+#include <QSize>
 #include <QString>
 
 #include "templates/template_image.h"
 
 class QByteArray;
+class QPainter;
+class QRect;
+class QRectF;
+class QXmlStreamReader;
+class QXmlStreamWriter;
 
 namespace OpenOrienteering {
 
+class GdalTiledRaster;
+class GdalWarpedRaster;
 class Map;
 
 
 /**
  * Support for geospatial raster data.
+ * 
+ * Rasters which are too large to be held in memory are not loaded as a
+ * whole. Instead, tiles at a suitable resolution are loaded on demand
+ * by a GdalTiledRaster. Such templates cannot be drawn onto.
+ * 
+ * Rasters in a CRS other than the map's CRS are warped into the map's CRS
+ * on the fly, by a GdalWarpedRaster which is read in tiles on demand, too.
+ * The CRS of the warped raster is stored in the template configuration, so
+ * that the template keeps its geometry when the map is reopened. When the
+ * map's CRS changes, a georeferenced template is warped to the new CRS.
+ * 
+ * Vector documents, i.e. PDF files, are rasterized by GDAL in tiles on
+ * demand, too. Each tile level is rasterized at its own resolution, so that
+ * the document is rendered for the current zoom instead of being loaded as
+ * a fixed-resolution image.
  */
 class GdalTemplate : public TemplateImage
 {
@@ -53,9 +79,50 @@ protected:
 public:
 	const char* getTemplateType() const override;
 	
+	QSize imageSize() const override;
+	
+	double imageDpi() const override;
+	
+	void drawTemplate(QPainter* painter, const QRectF& clip_rect, double scale, bool on_screen, qreal opacity) const override;
+	
 protected:
 	bool loadTemplateFileImpl(bool configuring) override;
 	
+	/**
+	 * Returns an empty function.
+	 * 
+	 * The raster is loaded on demand, by tiles, on a worker thread.
+	 */
+	std::function<void ()> makeBackgroundLoader() override;
+	
+	void unloadTemplateFileImpl() override;
+	
+	void saveTypeSpecificTemplateConfiguration(QXmlStreamWriter& xml) const override;
+	
+	bool loadTypeSpecificTemplateConfiguration(QXmlStreamReader& xml) override;
+	
+private:
+	/**
+	 * Sets up on-demand loading of the raster at path which has the given size.
+	 * 
+	 * For documents, document_dpi is the resolution of the given size.
+	 */
+	void setupTiledRaster(const QString& path, const QSize& size, double document_dpi = 0);
+	
+	/** Returns the CRS the raster needs to be warped to for the current map CRS, or an empty string. */
+	QString warpTarget() const;
+	
+	/** Warps a georeferenced raster to the map's CRS after changes of the map's CRS. */
+	void updateWarping();
+	
+	/** Marks the map area covered by the given raster pixels as dirty. */
+	void tileLoaded(const QRect& raster_rect);
+	
+	/// The CRS which the raster is warped to, or empty.
+	QString warp_crs_spec;
+	std::shared_ptr<GdalWarpedRaster> warped_raster;  // Must be destroyed after tiled_raster.
+	std::unique_ptr<GdalTiledRaster> tiled_raster;
+	
 };
 
 
@@ -0,0 +1,339 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gdal_tiled_raster.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iterator>
+#include <utility>
+
+#include <Qt>
+#include <QMetaObject>
+#include <QMutexLocker>
+#include <QPoint>
+#include <QThread>
+
+#include "gdal/gdal_image_reader.h"
+
+
+namespace OpenOrienteering {
+
+namespace {
+
+qint64 imageBytes(const QImage& image)
+{
+	return qint64(image.bytesPerLine()) * image.height();
+}
+
+GdalImageReader::RasterInfo readRasterInfo(const GdalImageReader& reader)
+{
+	if (!reader.canRead())
+		return {};
+	return reader.readRasterInfo();
+}
+
+}  // namespace
+
+
+
+struct GdalTiledRaster::SyncReader
+{
+	SyncReader(const QString& path, double document_dpi)
+	: reader(path, document_dpi)
+	, raster(readRasterInfo(reader))
+	{}
+	
+	GdalImageReader reader;
+	GdalImageReader::RasterInfo raster;
+};
+
+
+
+/**
+ * The worker thread which reads the requested tiles.
+ */
+class GdalTileLoader : public QThread
+{
+	// no Q_OBJECT, results are passed to the raster via a queued invocation.
+public:
+	explicit GdalTileLoader(GdalTiledRaster& raster)
+	: raster(raster)
+	{}
+	
+protected:
+	void run() override
+	{
+		// GDAL datasets must not be shared between threads.
+		std::vector<std::unique_ptr<GdalTiledRaster::SyncReader>> readers;
+		while (true)
+		{
+			GdalTiledRaster::TileRequest request {};
+			{
+				QMutexLocker lock(&raster.mutex);
+				while (!raster.stopping && raster.requests.empty())
+					raster.condition.wait(&raster.mutex);
+				if (raster.stopping)
+					return;
+				request = raster.requests.back();
+				raster.requests.pop_back();
+			}
+			
+			auto const image = raster.readTile(readers, request);
+			
+			QMutexLocker lock(&raster.mutex);
+			auto const notify = raster.loaded_tiles.empty();
+			raster.loaded_tiles.push_back({ request, image });
+			if (notify)
+				QMetaObject::invokeMethod(&raster, "processLoadedTiles", Qt::QueuedConnection);
+		}
+	}
+	
+private:
+	GdalTiledRaster& raster;
+};
+
+
+
+GdalTiledRaster::GdalTiledRaster(const QString& path, const QSize& size, qint64 max_bytes)
+: file_path(path)
+, raster_size(size)
+, max_bytes(max_bytes)
+{
+	startWorker();
+}
+
+GdalTiledRaster::GdalTiledRaster(const QString& path, double document_dpi, const QSize& size, qint64 max_bytes)
+: file_path(path)
+, raster_size(size)
+, document_dpi(document_dpi)
+, max_bytes(max_bytes)
+{
+	startWorker();
+}
+
+void GdalTiledRaster::startWorker()
+{
+	auto const max_dimension = std::max(raster_size.width(), raster_size.height());
+	while ((qint64(tile_size) << max_level) < max_dimension)
+		++max_level;
+	
+	worker.reset(new GdalTileLoader(*this));
+	worker->start(QThread::LowPriority);
+	
+	// The coarsest tile serves as a fallback for all other tiles.
+	tile(max_level, 0, 0);
+	
+	cache_registration = CacheManager::add({
+		[this]() { return bytes; },
+		[this](CacheManager::TrimLevel level) { trim(level); }
+	});
+}
+
+GdalTiledRaster::~GdalTiledRaster()
+{
+	{
+		QMutexLocker lock(&mutex);
+		stopping = true;
+		condition.wakeAll();
+	}
+	worker->wait();
+}
+
+
+int GdalTiledRaster::levelForResolution(qreal pixels_per_raster_pixel) const
+{
+	auto level = 0;
+	while (level < max_level && std::ldexp(1.0, -(level + 1)) >= pixels_per_raster_pixel)
+		++level;
+	return level;
+}
+
+QRect GdalTiledRaster::tileRange(int level, const QRect& raster_rect) const
+{
+	auto const rect = raster_rect.intersected(QRect(QPoint(0, 0), raster_size));
+	if (rect.isEmpty())
+		return {};
+	
+	auto const span = tile_size << level;
+	return QRect(QPoint(rect.left() / span, rect.top() / span),
+	             QPoint(rect.right() / span, rect.bottom() / span));
+}
+
+QRect GdalTiledRaster::tileRasterRect(int level, int x, int y) const
+{
+	auto const span = tile_size << level;
+	return QRect(x * span, y * span, span, span).intersected(QRect(QPoint(0, 0), raster_size));
+}
+
+
+QImage GdalTiledRaster::tile(int level, int x, int y)
+{
+	auto const tile_key = key(level, x, y);
+	auto image = cachedTile(level, x, y);
+	if (image.isNull() && pending.insert(tile_key).second)
+	{
+		QMutexLocker lock(&mutex);
+		requests.push_back(makeRequest(level, x, y));
+		condition.wakeOne();
+	}
+	return image;
+}
+
+QImage GdalTiledRaster::cachedTile(int level, int x, int y)
+{
+	auto entry = cache.find(key(level, x, y));
+	if (entry == cache.end())
+		return {};
+	
+	entry->second.last_use = ++use_counter;
+	return entry->second.image;
+}
+
+QImage GdalTiledRaster::loadTile(int level, int x, int y)
+{
+	auto image = cachedTile(level, x, y);
+	if (!image.isNull())
+		return image;
+	
+	image = readTile(sync_readers, makeRequest(level, x, y));
+	if (image.isNull())
+		return {};
+	
+	insert(key(level, x, y), image);
+	return image;
+}
+
+
+void GdalTiledRaster::processLoadedTiles()
+{
+	std::vector<LoadedTile> tiles;
+	{
+		QMutexLocker lock(&mutex);
+		tiles.swap(loaded_tiles);
+	}
+	
+	for (auto const& loaded : tiles)
+	{
+		auto const& request = loaded.request;
+		auto const tile_key = key(request.level, request.x, request.y);
+		pending.erase(tile_key);
+		if (loaded.image.isNull())
+			continue;
+		
+		insert(tile_key, loaded.image);
+		emit tileLoaded(request.raster_rect);
+	}
+}
+
+
+// static
+quint64 GdalTiledRaster::key(int level, int x, int y)
+{
+	return (quint64(level) << 48) | (quint64(quint32(x) & 0xffffffu) << 24) | quint64(quint32(y) & 0xffffffu);
+}
+
+GdalTiledRaster::TileRequest GdalTiledRaster::makeRequest(int level, int x, int y) const
+{
+	auto const raster_rect = tileRasterRect(level, x, y);
+	auto const image_size = QSize(((raster_rect.width() - 1) >> level) + 1,
+	                              ((raster_rect.height() - 1) >> level) + 1);
+	return { level, x, y, raster_rect, image_size };
+}
+
+QImage GdalTiledRaster::readTile(std::vector<std::unique_ptr<SyncReader>>& readers, const TileRequest& request) const
+{
+	auto const index = document_dpi > 0 ? std::size_t(request.level) : std::size_t(0);
+	if (readers.size() <= index)
+		readers.resize(index + 1);
+	auto& reader = readers[index];
+	if (!reader)
+	{
+		auto const dpi = document_dpi > 0 ? std::ldexp(document_dpi, -request.level) : 0.0;
+		reader.reset(new SyncReader(file_path, dpi));
+		if (reader->raster.image_format == QImage::Format_Invalid)
+			qDebug("GdalTiledRaster: Cannot read raster data: %s", qPrintable(reader->reader.errorString()));
+	}
+	auto const& raster = reader->raster;
+	if (raster.image_format == QImage::Format_Invalid)
+		return {};
+	
+	auto raster_rect = request.raster_rect;
+	if (document_dpi > 0)
+	{
+		// The document is rasterized at the resolution of the level.
+		raster_rect = QRect(QPoint(raster_rect.left() >> request.level, raster_rect.top() >> request.level), request.image_size)
+		              .intersected(QRect(QPoint(0, 0), raster.size));
+		if (raster_rect.isEmpty())
+			return {};
+	}
+	
+	QImage image(request.image_size, raster.image_format);
+	if (image.isNull() || !reader->reader.read(&image, raster, raster_rect))
+		return {};
+	return image;
+}
+
+void GdalTiledRaster::insert(quint64 key, const QImage& image)
+{
+	auto& entry = cache[key];
+	bytes += imageBytes(image) - imageBytes(entry.image);
+	entry.image = image;
+	entry.last_use = ++use_counter;
+	
+	// Drop half of the budget at once,
+	// so that eviction does not happen for every new tile.
+	if (bytes > max_bytes)
+		evict(max_bytes / 2);
+}
+
+void GdalTiledRaster::trim(CacheManager::TrimLevel level)
+{
+	// Lower resolution is better than being killed by the system.
+	constexpr qint64 min_max_bytes = 16 * 1024 * 1024;
+	if (level == CacheManager::TrimCritical)
+		max_bytes = std::max(max_bytes / 2, min_max_bytes);
+	evict(CacheManager::trimTarget(level, bytes));
+}
+
+void GdalTiledRaster::evict(qint64 target_bytes)
+{
+	std::vector<std::pair<quint64, quint64>> candidates;
+	candidates.reserve(cache.size());
+	auto const fallback_key = key(max_level, 0, 0);
+	for (auto const& entry : cache)
+	{
+		if (entry.first != fallback_key)
+			candidates.emplace_back(entry.second.last_use, entry.first);
+	}
+	std::sort(begin(candidates), end(candidates));
+	
+	for (auto const& candidate : candidates)
+	{
+		if (bytes <= target_bytes)
+			break;
+		auto entry = cache.find(candidate.second);
+		bytes -= imageBytes(entry->second.image);
+		cache.erase(entry);
+	}
+}
+
+
+}  // namespace OpenOrienteering
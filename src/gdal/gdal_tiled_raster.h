@@ -0,0 +1,237 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef OPENORIENTEERING_GDAL_TILED_RASTER_H
+#define OPENORIENTEERING_GDAL_TILED_RASTER_H
+
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <QtGlobal>
+#include <QImage>
+#include <QMutex>
+#include <QObject>
+#include <QRect>
+#include <QSize>
+#include <QString>
+#include <QWaitCondition>
+
+#include "util/cache_manager.h"
+
+class QThread;
+
+namespace OpenOrienteering {
+
+
+
+/**
+ * On-demand access to a raster file which is too large to be held in memory.
+ * 
+ * The raster is divided into square tiles of tile_size pixels at a number of
+ * levels. At level 0, a tile covers tile_size raster pixels in each direction.
+ * At each following level, a tile covers twice the width and height of the
+ * previous level, at the same image size. At maxLevel(), a single tile covers
+ * the whole raster. GDAL uses the file's overviews for the higher levels
+ * when available. Documents such as PDF files are rasterized by GDAL at the
+ * resolution of each level instead.
+ * 
+ * Tiles are read asynchronously by a worker thread which has its own GDAL
+ * dataset, because GDAL dataset handles must not be shared between threads.
+ * Most recently requested tiles are read first. When a tile is ready, the
+ * tileLoaded() signal is emitted. The loaded tiles are kept in a cache which
+ * is limited in size. When memory runs low, the CacheManager makes it drop
+ * tiles, and after critical situations, the limit is reduced for the rest
+ * of the raster's life-time, so that more areas are drawn from coarser tiles.
+ * 
+ * Apart from the worker thread, this class must be used from the thread
+ * which created the object.
+ */
+class GdalTiledRaster : public QObject
+{
+Q_OBJECT
+public:
+	/** The width and height of the tile images, in pixels. */
+	static constexpr int tile_size = 512;
+	
+	/**
+	 * Constructs a tiled raster for the given file which has the given size.
+	 * 
+	 * The coarsest tile is requested immediately.
+	 */
+	GdalTiledRaster(const QString& path, const QSize& size, qint64 max_bytes = 256 * 1024 * 1024);
+	
+	/**
+	 * Constructs a tiled raster for a document, e.g. a PDF file, which GDAL
+	 * rasterizes at a chosen resolution.
+	 * 
+	 * The size is the size of the document rasterized at document_dpi, which
+	 * is the resolution of level 0. Each level is rasterized from the
+	 * document at its own resolution, instead of being derived from a
+	 * higher resolution.
+	 */
+	GdalTiledRaster(const QString& path, double document_dpi, const QSize& size, qint64 max_bytes = 256 * 1024 * 1024);
+	
+	GdalTiledRaster(const GdalTiledRaster&) = delete;
+	GdalTiledRaster& operator=(const GdalTiledRaster&) = delete;
+	
+	~GdalTiledRaster() override;
+	
+	
+	/** Returns the path of the raster file. */
+	const QString& path() const { return file_path; }
+	
+	/** Returns the size of the raster, in raster pixels. */
+	const QSize& size() const { return raster_size; }
+	
+	/** Returns the resolution of level 0 for documents, or 0 for regular rasters. */
+	double documentDpi() const { return document_dpi; }
+	
+	/** Returns the level at which a single tile covers the whole raster. */
+	int maxLevel() const { return max_level; }
+	
+	/**
+	 * Returns the most detailed level which still has at least the given
+	 * resolution, in tile pixels per raster pixel.
+	 */
+	int levelForResolution(qreal pixels_per_raster_pixel) const;
+	
+	/** Returns the range of tiles at the given level which intersect the given rect in raster pixels. */
+	QRect tileRange(int level, const QRect& raster_rect) const;
+	
+	/** Returns the area in raster pixels which is covered by the given tile. */
+	QRect tileRasterRect(int level, int x, int y) const;
+	
+	
+	/**
+	 * Returns the given tile if it is cached.
+	 * 
+	 * Otherwise, returns a null image and requests the tile from the worker
+	 * thread.
+	 */
+	QImage tile(int level, int x, int y);
+	
+	/**
+	 * Returns the given tile if it is cached, or a null image.
+	 */
+	QImage cachedTile(int level, int x, int y);
+	
+	/**
+	 * Returns the given tile, reading it synchronously if it is not cached.
+	 * 
+	 * Returns a null image if the tile cannot be read.
+	 */
+	QImage loadTile(int level, int x, int y);
+	
+	
+signals:
+	/**
+	 * Indicates that a tile covering the given area in raster pixels
+	 * was loaded by the worker thread.
+	 */
+	void tileLoaded(const QRect& raster_rect);
+	
+	
+private slots:
+	/** Moves the tiles loaded by the worker thread into the cache. */
+	void processLoadedTiles();
+	
+	
+private:
+	friend class GdalTileLoader;
+	
+	struct SyncReader;
+	
+	struct TileRequest
+	{
+		int level;
+		int x;
+		int y;
+		QRect raster_rect;
+		QSize image_size;
+	};
+	
+	struct LoadedTile
+	{
+		TileRequest request;
+		QImage image;
+	};
+	
+	struct CacheEntry
+	{
+		QImage image;
+		quint64 last_use;
+	};
+	
+	static quint64 key(int level, int x, int y);
+	
+	TileRequest makeRequest(int level, int x, int y) const;
+	
+	/**
+	 * Reads the requested tile, using and opening the given readers.
+	 * 
+	 * For regular rasters, a single reader serves all levels. For
+	 * documents, there is a reader for each level.
+	 */
+	QImage readTile(std::vector<std::unique_ptr<SyncReader>>& readers, const TileRequest& request) const;
+	
+	void startWorker();
+	
+	void insert(quint64 key, const QImage& image);
+	
+	/**
+	 * Drops the least recently used tiles until at most target_bytes remain,
+	 * but keeps the coarsest tile which serves as fallback.
+	 */
+	void evict(qint64 target_bytes);
+	
+	void trim(CacheManager::TrimLevel level);
+	
+	
+	QString file_path;
+	QSize raster_size;
+	int max_level = 0;
+	double document_dpi = 0;
+	
+	std::unordered_map<quint64, CacheEntry> cache;
+	std::unordered_set<quint64> pending;
+	qint64 max_bytes;
+	qint64 bytes = 0;
+	quint64 use_counter = 0;
+	
+	/// Readers for synchronous loading, created on demand.
+	std::vector<std::unique_ptr<SyncReader>> sync_readers;
+	
+	// Shared with the worker thread, guarded by the mutex.
+	QMutex mutex;
+	QWaitCondition condition;
+	std::vector<TileRequest> requests;
+	std::vector<LoadedTile> loaded_tiles;
+	bool stopping = false;
+	
+	std::unique_ptr<QThread> worker;
+	
+	CacheManager::Registration cache_registration;
+};
+
+
+}  // namespace OpenOrienteering
+
+#endif // OPENORIENTEERING_GDAL_TILED_RASTER_H
@@ -0,0 +1,127 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#include "gdal_warped_raster.h"
+
+#include <atomic>
+
+#include <QByteArray>
+
+#include <cpl_conv.h>
+#include <cpl_error.h>
+#include <cpl_vsi.h>
+#include <gdal.h>
+#include <gdalwarper.h>
+#include <ogr_srs_api.h>
+
+#include "gdal/gdal_manager.h"
+
+
+namespace OpenOrienteering {
+
+namespace {
+
+/** The maximum error of the approximated transformation, in pixels (as in gdalwarp). */
+constexpr double max_warp_error = 0.125;
+
+/**
+ * Returns a new spatial reference for the given PROJ specification,
+ * or nullptr.
+ */
+OGRSpatialReferenceH srsFromProjSpec(const QString& crs_spec)
+{
+	auto srs = OSRNewSpatialReference(nullptr);
+	if (OSRImportFromProj4(srs, crs_spec.toLatin1()) != OGRERR_NONE)
+	{
+		OSRDestroySpatialReference(srs);
+		srs = nullptr;
+	}
+	return srs;
+}
+
+}  // namespace
+
+
+
+// static
+bool GdalWarpedRaster::needsWarping(const QString& source_path, const QString& target_crs_spec)
+{
+	GdalManager();
+	auto source = GDALOpen(source_path.toUtf8(), GA_ReadOnly);
+	if (!source)
+		return false;
+	
+	auto result = false;
+	auto const projection = GDALGetProjectionRef(source);
+	double geo_transform[6];
+	if (projection && *projection && GDALGetGeoTransform(source, geo_transform) == CE_None)
+	{
+		auto source_srs = OSRNewSpatialReference(projection);
+		auto target_srs = srsFromProjSpec(target_crs_spec);
+		result = source_srs && target_srs && !OSRIsSame(source_srs, target_srs);
+		OSRDestroySpatialReference(target_srs);
+		OSRDestroySpatialReference(source_srs);
+	}
+	GDALClose(source);
+	return result;
+}
+
+
+GdalWarpedRaster::GdalWarpedRaster(const QString& source_path, const QString& target_crs_spec)
+: crs_spec(target_crs_spec)
+{
+	GdalManager();
+	CPLErrorReset();
+	auto source = GDALOpen(source_path.toUtf8(), GA_ReadOnly);
+	auto srs = srsFromProjSpec(target_crs_spec);
+	char* wkt = nullptr;
+	if (source && srs && OSRExportToWkt(srs, &wkt) == OGRERR_NONE)
+	{
+		if (auto warped = GDALAutoCreateWarpedVRT(source, nullptr, wkt, GRA_Bilinear, max_warp_error, nullptr))
+		{
+			// The VRT driver writes a VRT source dataset as XML.
+			static std::atomic<int> counter { 0 };
+			auto const path = QStringLiteral("/vsimem/mapper-warped-%1.vrt").arg(++counter);
+			if (auto copy = GDALCreateCopy(GDALGetDriverByName("VRT"), path.toUtf8(), warped, FALSE, nullptr, nullptr, nullptr))
+			{
+				GDALClose(copy);
+				vrt_path = path;
+			}
+			GDALClose(warped);
+		}
+	}
+	CPLFree(wkt);
+	OSRDestroySpatialReference(srs);
+	if (source)
+		GDALClose(source);
+	
+	if (vrt_path.isEmpty())
+		error_string = tr("Failed to warp the raster: %1").arg(QString::fromUtf8(CPLGetLastErrorMsg()));
+}
+
+GdalWarpedRaster::~GdalWarpedRaster()
+{
+	if (!vrt_path.isEmpty())
+		VSIUnlink(vrt_path.toUtf8());
+}
+
+
+}  // namespace OpenOrienteering
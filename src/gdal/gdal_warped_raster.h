@@ -0,0 +1,86 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#ifndef OPENORIENTEERING_GDAL_WARPED_RASTER_H
+#define OPENORIENTEERING_GDAL_WARPED_RASTER_H
+
+#include <QCoreApplication>
+#include <QString>
+
+namespace OpenOrienteering {
+
+
+/**
+ * A raster file which is warped into another CRS on the fly.
+ * 
+ * The warped raster is a GDAL warped VRT in GDAL's in-memory file system.
+ * It can be opened by its path like a regular raster file, also from
+ * multiple threads at the same time. It is removed when this object is
+ * destroyed, so the objects reading it must be destroyed before.
+ * 
+ * Reading a part of the VRT reprojects only this part. When the VRT is read
+ * by a GdalTiledRaster, the reprojection is done once per tile and tile level,
+ * and the warped tiles are cached at each level.
+ */
+class GdalWarpedRaster
+{
+	Q_DECLARE_TR_FUNCTIONS(OpenOrienteering::GdalWarpedRaster)
+	
+public:
+	/**
+	 * Returns true if the raster file has a CRS which differs from the given one.
+	 */
+	static bool needsWarping(const QString& source_path, const QString& target_crs_spec);
+	
+	/**
+	 * Creates a VRT which warps the given source raster to the given CRS.
+	 * 
+	 * The CRS is given as a PROJ specification.
+	 */
+	GdalWarpedRaster(const QString& source_path, const QString& target_crs_spec);
+	
+	GdalWarpedRaster(const GdalWarpedRaster&) = delete;
+	GdalWarpedRaster& operator=(const GdalWarpedRaster&) = delete;
+	
+	~GdalWarpedRaster();
+	
+	/** Returns true if the VRT was created. */
+	bool isValid() const { return !vrt_path.isEmpty(); }
+	
+	/** Returns the path of the VRT. */
+	const QString& path() const { return vrt_path; }
+	
+	/** Returns the CRS of the VRT. */
+	const QString& crsSpec() const { return crs_spec; }
+	
+	QString errorString() const { return error_string; }
+	
+private:
+	QString vrt_path;
+	QString crs_spec;
+	QString error_string;
+	
+};
+
+
+}  // namespace OpenOrienteering
+
+#endif // OPENORIENTEERING_GDAL_WARPED_RASTER_H
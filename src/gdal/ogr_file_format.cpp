@@ -23,6 +23,7 @@
 #include <algorithm>
 #include <cmath>
 #include <cstddef>
+#include <deque>
 #include <functional>
 #include <iterator>
 #include <memory>
@@ -40,11 +41,14 @@
 #include <QtMath>
 #include <QByteArray>
 #include <QColor>
+#include <QCryptographicHash>
 #include <QFileInfo>
 #include <QFlags>
 #include <QHash>
 #include <QLatin1Char>
 #include <QLatin1String>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QPointF>
 #include <QRectF>
 #include <QRegularExpression>
@@ -52,7 +56,10 @@
 #include <QScopedValueRollback>
 #include <QString>
 #include <QStringRef>
+#include <QStringList>
+#include <QThread>
 #include <QVariant>
+#include <QWaitCondition>
 
 #include "core/georeferencing.h"
 #include "core/latlon.h"
@@ -73,6 +80,7 @@
 #include "core/symbols/text_symbol.h"
 #include "fileformats/file_import_export.h"
 #include "gdal/gdal_manager.h"
+#include "util/concurrency.h"
 
 // IWYU pragma: no_forward_declare QFile
 
@@ -609,8 +617,13 @@ OgrFileImportFormat::OgrFileImportFormat()
               QString{},
               Feature::FileOpen | Feature::FileImport | Feature::ReadingLossy )
 {
-	for (const auto& extension : GdalManager().supportedVectorImportExtensions())
-		addExtension(QString::fromLatin1(extension));
+	// GDAL driver registration is deferred until the extensions are needed.
+	deferExtensions([]() {
+		QStringList extensions;
+		for (const auto& extension : GdalManager().supportedVectorImportExtensions())
+			extensions << QString::fromLatin1(extension);
+		return extensions;
+	});
 }
 
 
@@ -628,8 +641,13 @@ OgrFileExportFormat::OgrFileExportFormat()
               QString{},
               Feature::FileExport | Feature::WritingLossy )
 {
-	for (const auto& extension : GdalManager().supportedVectorExportExtensions())
-		addExtension(QString::fromLatin1(extension));
+	// GDAL driver registration is deferred until the extensions are needed.
+	deferExtensions([]() {
+		QStringList extensions;
+		for (const auto& extension : GdalManager().supportedVectorExportExtensions())
+			extensions << QString::fromLatin1(extension);
+		return extensions;
+	});
 }
 
 std::unique_ptr<Exporter> OgrFileExportFormat::makeExporter(const QString& path, const Map* map, const MapView* view) const
@@ -639,12 +657,237 @@ std::unique_ptr<Exporter> OgrFileExportFormat::makeExporter(const QString& path,
 
 
 
+namespace {
+
+/**
+ * Reads the features of a layer on a worker thread.
+ * 
+ * The features are handed out in batches. Only a few batches are buffered,
+ * so that memory use doesn't depend on the size of the layer. The layer must
+ * not be accessed by other threads until the reader is destroyed.
+ */
+class FeatureReader : public QThread
+{
+public:
+	using Batch = std::vector<ogr::unique_feature>;
+	
+	explicit FeatureReader(OGRLayerH layer)
+	: layer(layer)
+	{
+		OGR_L_ResetReading(layer);
+		start();
+	}
+	
+	FeatureReader(const FeatureReader&) = delete;
+	FeatureReader& operator=(const FeatureReader&) = delete;
+	
+	~FeatureReader() override
+	{
+		{
+			QMutexLocker locker(&mutex);
+			canceled = true;
+		}
+		batch_taken.wakeAll();
+		wait();
+	}
+	
+	/**
+	 * Returns the next batch of features.
+	 * 
+	 * Blocks until a batch is available. Returns an empty batch
+	 * when all features were read.
+	 */
+	Batch next()
+	{
+		QMutexLocker locker(&mutex);
+		while (batches.empty() && !finished)
+			batch_added.wait(&mutex);
+		if (batches.empty())
+			return {};
+		
+		auto batch = std::move(batches.front());
+		batches.pop_front();
+		batch_taken.wakeAll();
+		return batch;
+	}
+	
+protected:
+	void run() override
+	{
+		Batch batch;
+		batch.reserve(batch_size);
+		for (auto feature = ogr::unique_feature(OGR_L_GetNextFeature(layer)); feature; )
+		{
+			batch.push_back(std::move(feature));
+			feature.reset(OGR_L_GetNextFeature(layer));
+			if (feature && batch.size() < batch_size)
+				continue;
+			
+			QMutexLocker locker(&mutex);
+			while (batches.size() >= max_batches && !canceled)
+				batch_taken.wait(&mutex);
+			if (canceled)
+				break;
+			batches.push_back(std::move(batch));
+			batch_added.wakeAll();
+			
+			batch = {};
+			batch.reserve(batch_size);
+		}
+		
+		QMutexLocker locker(&mutex);
+		finished = true;
+		batch_added.wakeAll();
+	}
+	
+private:
+	static constexpr std::size_t batch_size = 1000;
+	static constexpr std::size_t max_batches = 4;
+	
+	OGRLayerH const layer;
+	QMutex mutex;
+	QWaitCondition batch_added;
+	QWaitCondition batch_taken;
+	std::deque<Batch> batches;
+	bool canceled = false;
+	bool finished = false;
+};
+
+std::vector<QString> fieldNames(OGRFeatureDefnH feature_definition)
+{
+	std::vector<QString> names;
+	if (feature_definition)
+	{
+		auto num_fields = OGR_FD_GetFieldCount(feature_definition);
+		names.reserve(std::size_t(num_fields));
+		for (int i = 0; i < num_fields; ++i)
+		{
+			auto field_definition = OGR_FD_GetFieldDefn(feature_definition, i);
+			names.push_back(QString::fromUtf8(OGR_Fld_GetNameRef(field_definition)));
+		}
+	}
+	return names;
+}
+
+/**
+ * Sets the points of a line string or linear ring from path coordinates.
+ * 
+ * The coordinates are transformed to projected coordinates as a batch,
+ * and they are passed to OGR in a single call.
+ */
+void setPoints(OGRGeometryH geometry, const Georeferencing& georef, const PathCoordVector& path_coords)
+{
+	std::vector<MapCoordF> map_coords;
+	map_coords.reserve(path_coords.size());
+	for (const auto& coord : path_coords)
+		map_coords.push_back(coord.pos);
+	
+	const auto projected = georef.toProjectedCoords(map_coords);
+	std::vector<double> x;
+	std::vector<double> y;
+	x.reserve(projected.size());
+	y.reserve(projected.size());
+	for (const auto& coord : projected)
+	{
+		x.push_back(coord.x());
+		y.push_back(coord.y());
+	}
+	OGR_G_SetPoints(geometry, int(projected.size()), x.data(), sizeof(double), y.data(), sizeof(double), nullptr, 0);
+}
+
+Object::Tags readTags(const std::vector<QString>& field_names, OGRFeatureH feature)
+{
+	Object::Tags tags;
+	for (std::size_t i = 0; i < field_names.size(); ++i)
+	{
+		auto value = OGR_F_GetFieldAsString(feature, int(i));
+		if (value && qstrlen(value) > 0)
+			tags.insert(field_names[i], QString::fromUtf8(value));
+	}
+	return tags;
+}
+
+}  // namespace
+
+
+
+// ### OgrTransformationPool ###
+
+/**
+ * A set of coordinate transformations for concurrent use.
+ * 
+ * OGR coordinate transformations must not be used by multiple threads at the
+ * same time. This pool holds one transformation per thread. The transformations
+ * are created on the constructing thread, because the spatial references are
+ * not thread-safe.
+ */
+class OgrTransformationPool
+{
+public:
+	TransformationPool(OGRSpatialReferenceH source, OGRSpatialReferenceH target)
+	: source(source)
+	{
+		const auto size = Concurrency::idealThreadCount();
+		spare.reserve(std::size_t(size));
+		for (int i = 0; i < size; ++i)
+		{
+			auto transformation = ogr::unique_transformation{ OCTNewCoordinateTransformation(source, target) };
+			if (!transformation)
+				break;
+			spare.push_back(std::move(transformation));
+		}
+		size = spare.size();
+	}
+	
+	OGRSpatialReferenceH sourceSrs() const { return source; }
+	
+	/**
+	 * Takes a transformation from the pool.
+	 * 
+	 * Blocks while all transformations are in use.
+	 * Returns nullptr if the transformation could not be created.
+	 */
+	ogr::unique_transformation acquire()
+	{
+		QMutexLocker locker(&mutex);
+		if (size == 0)
+			return {};
+		while (spare.empty())
+			released.wait(&mutex);
+		auto transformation = std::move(spare.back());
+		spare.pop_back();
+		return transformation;
+	}
+	
+	/**
+	 * Returns a transformation to the pool.
+	 */
+	void release(ogr::unique_transformation&& transformation)
+	{
+		QMutexLocker locker(&mutex);
+		spare.push_back(std::move(transformation));
+		released.wakeOne();
+	}
+	
+private:
+	OGRSpatialReferenceH const source;
+	QMutex mutex;
+	QWaitCondition released;
+	std::vector<ogr::unique_transformation> spare;
+	std::size_t size = 0;
+};
+
+
+
 // ### OgrFileImport ###
 
 
 // not inline
 OgrFileImport::Clipping::~Clipping() = default;
 
+// not inline
+OgrFileImport::FeatureFilter::~FeatureFilter() = default;
+
 
 // static
 bool OgrFileImport::canRead(const QString& path)
@@ -731,6 +974,34 @@ void OgrFileImport::setGeoreferencingImportEnabled(bool enabled)
 	georeferencing_import_enabled = enabled;
 }
 
+void OgrFileImport::setFeatureFilter(FeatureFilter* filter)
+{
+	feature_filter = filter;
+}
+
+// static
+QByteArray OgrFileImport::fingerprint(OGRFeatureH feature)
+{
+	QCryptographicHash hash(QCryptographicHash::Md5);
+	if (auto geometry = OGR_F_GetGeometryRef(feature))
+	{
+		QByteArray wkb(OGR_G_WkbSize(geometry), Qt::Uninitialized);
+		OGR_G_ExportToWkb(geometry, wkbNDR, reinterpret_cast<unsigned char*>(wkb.data()));
+		hash.addData(wkb);
+	}
+	if (auto style_string = OGR_F_GetStyleString(feature))
+	{
+		hash.addData(style_string, int(qstrlen(style_string)));
+	}
+	auto const num_fields = OGR_F_GetFieldCount(feature);
+	for (int i = 0; i < num_fields; ++i)
+	{
+		auto const value = OGR_F_GetFieldAsString(feature, i);
+		hash.addData(value, int(qstrlen(value)) + 1);  // including the terminator
+	}
+	return hash.result();
+}
+
 
 
 ogr::unique_srs OgrFileImport::srsFromMap()
@@ -765,6 +1036,7 @@ void OgrFileImport::prepare()
 {
 	Importer::prepare();
 	clip_layers = option(QString::fromLatin1("Clip layers")).toBool();
+	spatial_filter = option(QString::fromLatin1("Spatial filter")).toRectF();
 }
 
 bool OgrFileImport::importImplementation()
@@ -803,9 +1075,12 @@ bool OgrFileImport::importImplementation()
 		QScopedValueRollback<MapCoord::BoundsOffset> rollback { MapCoord::boundsOffset() };
 		MapCoord::boundsOffset().reset(true);
 		
-		auto num_layers = OGR_DS_GetLayerCount(data_source.get());
+		num_layers = OGR_DS_GetLayerCount(data_source.get());
 		for (int i = 0; i < num_layers; ++i)
 		{
+			current_layer = i;
+			reportProgress(100 * i / num_layers);
+			
 			auto layer = OGR_DS_GetLayer(data_source.get(), i);
 			if (!layer)
 			{
@@ -1000,7 +1275,7 @@ void OgrFileImport::importLayer(MapPart* map_part, OGRLayerH layer)
 {
 	Q_ASSERT(map_part);
 	
-	auto feature_definition = OGR_L_GetLayerDefn(layer);
+	const auto field_names = fieldNames(OGR_L_GetLayerDefn(layer));
 	
 	std::unique_ptr<Clipping> clipping;
 	if (clip_layers && OGR_L_TestCapability(layer, OLCFastGetExtent))
@@ -1008,8 +1283,81 @@ void OgrFileImport::importLayer(MapPart* map_part, OGRLayerH layer)
 		clipping = getLayerClipping(layer);
 	}
 	
-	OGR_L_ResetReading(layer);
-	while (auto feature = ogr::unique_feature(OGR_L_GetNextFeature(layer)))
+	if (spatial_filter.isValid() && !setSpatialFilter(layer))
+		return;
+	
+	// A cheap feature count is used for progress reporting only.
+	const auto num_features = OGR_L_GetFeatureCount(layer, false);
+	GIntBig num_read = 0;
+	
+	FeatureReader reader(layer);
+	for (auto batch = reader.next(); !batch.empty(); batch = reader.next())
+	{
+		importFeatures(map_part, field_names, batch, clipping.get());
+		
+		num_read += GIntBig(batch.size());
+		if (num_features > 0 && num_layers > 0)
+			reportProgress(int(100 * (current_layer + qMin(1.0, double(num_read) / num_features)) / num_layers));
+	}
+}
+
+bool OgrFileImport::setSpatialFilter(OGRLayerH layer)
+{
+	const auto& georef = map->getGeoreferencing();
+	if (!georef.isValid() || georef.isLocal() || OSRIsLocal(map_srs.get()))
+	{
+		addWarning(tr("Unable to filter layer %1 by area: %2")
+		           .arg(QString::fromUtf8(OGR_L_GetName(layer)), tr("The map is not georeferenced.")));
+		OGR_L_SetSpatialFilter(layer, nullptr);
+		return true;
+	}
+	
+	auto outline = ogr::unique_geometry(OGR_G_CreateGeometry(wkbLinearRing));
+	for (auto corner : { spatial_filter.topLeft(), spatial_filter.topRight(),
+	                     spatial_filter.bottomRight(), spatial_filter.bottomLeft(), spatial_filter.topLeft() })
+	{
+		auto projected = georef.toProjectedCoords(MapCoordF(corner));
+		OGR_G_AddPoint_2D(outline.get(), projected.x(), projected.y());
+	}
+	// Curved edges after transformation to geographic coordinates
+	OGR_G_Segmentize(outline.get(), OGR_G_Length(outline.get()) / 64);
+	
+	auto area = ogr::unique_geometry(OGR_G_CreateGeometry(wkbPolygon));
+	OGR_G_AddGeometry(area.get(), outline.get());
+	
+	if (auto layer_srs = OGR_L_GetSpatialRef(layer))
+	{
+		auto transformation = ogr::unique_transformation{ OCTNewCoordinateTransformation(map_srs.get(), layer_srs) };
+		if (!transformation || OGR_G_Transform(area.get(), transformation.get()) != OGRERR_NONE)
+		{
+			addWarning(tr("Unable to filter layer %1 by area: %2")
+			           .arg(QString::fromUtf8(OGR_L_GetName(layer)), tr("Failed to transform the coordinates.")));
+			return false;
+		}
+	}
+	
+	// The filter is applied to the bounding boxes of the features,
+	// and it takes effect when reading starts.
+	OGR_L_SetSpatialFilter(layer, area.get());
+	return true;
+}
+
+void OgrFileImport::importFeatures(MapPart* map_part, const std::vector<QString>& field_names, std::vector<ogr::unique_feature>& features, const Clipping* clipping)
+{
+	struct Item
+	{
+		OGRFeatureH feature;
+		OGRGeometryH geometry;
+		Object::Tags tags;
+		QByteArray fingerprint;
+		OGRErr error;
+		bool transformed;
+	};
+	std::vector<Item> items;
+	items.reserve(features.size());
+	
+	OGRSpatialReferenceH srs = nullptr;
+	for (auto& feature : features)
 	{
 		auto geometry = OGR_F_GetGeometryRef(feature.get());
 		if (!geometry || OGR_G_IsEmpty(geometry))
@@ -1018,11 +1366,73 @@ void OgrFileImport::importLayer(MapPart* map_part, OGRLayerH layer)
 			continue;
 		}
 		
-		importFeature(map_part, feature_definition, feature.get(), geometry, clipping.get());
+		QByteArray feature_fingerprint;
+		if (feature_filter)
+		{
+			feature_fingerprint = fingerprint(feature.get());
+			if (!feature_filter->accept(current_layer, OGR_F_GetFID(feature.get()), feature_fingerprint))
+				continue;
+		}
+		
+		auto geometry_srs = OGR_G_GetSpatialReference(geometry);
+		if (items.empty())
+		{
+			srs = geometry_srs;
+		}
+		else if (geometry_srs != srs)
+		{
+			// Mixed spatial references are rare. Keep it simple.
+			for (auto& item : items)
+				importFeature(map_part, field_names, item.feature, item.geometry, item.fingerprint, clipping);
+			items.clear();
+			srs = geometry_srs;
+		}
+		items.push_back({ feature.get(), geometry, {}, feature_fingerprint, OGRERR_NONE, false });
+	}
+	
+	if (items.empty())
+		return;
+	
+	if (!setSRS(srs))
+	{
+		// setSRS() counted the first feature.
+		no_transformation += int(items.size()) - 1;
+		return;
+	}
+	
+	if (srs && (!transformation_pool || transformation_pool->sourceSrs() != srs))
+		transformation_pool = std::make_unique<OgrTransformationPool>(srs, map_srs.get());
+	
+	Concurrency::parallelFor(0, int(items.size()), [this, srs, &items, &field_names](int i) {
+		auto& item = items[std::size_t(i)];
+		item.tags = readTags(field_names, item.feature);
+		if (srs)
+		{
+			if (auto transformation = transformation_pool->acquire())
+			{
+				item.error = OGR_G_Transform(item.geometry, transformation.get());
+				item.transformed = true;
+				transformation_pool->release(std::move(transformation));
+			}
+		}
+	}, 16);
+	
+	// Symbols and map coordinates are not thread-safe.
+	for (auto& item : items)
+	{
+		if (srs && !item.transformed)
+			item.error = OGR_G_Transform(item.geometry, data_transform.get());
+		if (item.error)
+		{
+			++failed_transformation;
+			continue;
+		}
+		
+		addObjects(map_part, item.feature, item.fingerprint, importGeometry(item.feature, item.geometry), item.tags, clipping);
 	}
 }
 
-void OgrFileImport::importFeature(MapPart* map_part, OGRFeatureDefnH feature_definition, OGRFeatureH feature, OGRGeometryH geometry, const Clipping* clipping)
+void OgrFileImport::importFeature(MapPart* map_part, const std::vector<QString>& field_names, OGRFeatureH feature, OGRGeometryH geometry, const QByteArray& fingerprint, const Clipping* clipping)
 {
 	auto new_srs = OGR_G_GetSpatialReference(geometry);
 	if (!setSRS(new_srs))
@@ -1038,7 +1448,11 @@ void OgrFileImport::importFeature(MapPart* map_part, OGRFeatureDefnH feature_def
 		}
 	}
 	
-	auto objects = importGeometry(feature, geometry);
+	addObjects(map_part, feature, fingerprint, importGeometry(feature, geometry), readTags(field_names, feature), clipping);
+}
+
+void OgrFileImport::addObjects(MapPart* map_part, OGRFeatureH feature, const QByteArray& fingerprint, ObjectList objects, const ObjectTags& tags, const Clipping* clipping)
+{
 	if (clipping)
 	{
 		auto clipped_objects = clipping->process(objects);
@@ -1047,21 +1461,12 @@ void OgrFileImport::importFeature(MapPart* map_part, OGRFeatureDefnH feature_def
 	
 	for (auto* object : objects)
 	{
+		object->setTags(tags);
 		map_part->addObject(object);
-		if (!feature_definition)
-			continue;
-		
-		auto num_fields = OGR_FD_GetFieldCount(feature_definition);
-		for (int i = 0; i < num_fields; ++i)
-		{
-			auto value = OGR_F_GetFieldAsString(feature, i);
-			if (value && qstrlen(value) > 0)
-			{
-				auto field_definition = OGR_FD_GetFieldDefn(feature_definition, i);
-				object->setTag(QString::fromUtf8(OGR_Fld_GetNameRef(field_definition)), QString::fromUtf8(value));
-			}
-		}
 	}
+	
+	if (feature_filter)
+		feature_filter->imported(current_layer, OGR_F_GetFID(feature), fingerprint, objects);
 }
 
 OgrFileImport::ObjectList OgrFileImport::importGeometry(OGRFeatureH feature, OGRGeometryH geometry)
@@ -1188,12 +1593,7 @@ PathObject* OgrFileImport::importLineStringGeometry(OGRFeatureH feature, OGRGeom
 	}
 	
 	auto style = OGR_F_GetStyleString(feature);
-	auto object = new PathObject(getSymbol(Symbol::Line, style));
-	for (int i = 0; i < num_points; ++i)
-	{
-		object->addCoordinate(toMapCoord(OGR_G_GetX(geometry, i), OGR_G_GetY(geometry, i)));
-	}
-	return object;
+	return new PathObject(getSymbol(Symbol::Line, style), toMapCoords(geometry));
 }
 
 PathObject* OgrFileImport::importPolygonGeometry(OGRFeatureH feature, OGRGeometryH geometry)
@@ -1220,20 +1620,15 @@ PathObject* OgrFileImport::importPolygonGeometry(OGRFeatureH feature, OGRGeometr
 	}
 	
 	auto style = OGR_F_GetStyleString(feature);
-	auto object = new PathObject(getSymbol(Symbol::Area, style));
-	for (int i = 0; i < num_points; ++i)
-	{
-		object->addCoordinate(toMapCoord(OGR_G_GetX(outline, i), OGR_G_GetY(outline, i)));
-	}
+	auto object = new PathObject(getSymbol(Symbol::Area, style), toMapCoords(outline));
 	
 	for (int g = 1; g < num_geometries; ++g)
 	{
 		bool start_new_part = true;
 		auto hole = /*OGR_G_ForceToLineString*/(OGR_G_GetGeometryRef(geometry, g));
-		auto num_points = OGR_G_GetPointCount(hole);
-		for (int i = 0; i < num_points; ++i)
+		for (const auto& coord : toMapCoords(hole))
 		{
-			object->addCoordinate(toMapCoord(OGR_G_GetX(hole, i), OGR_G_GetY(hole, i)), start_new_part);
+			object->addCoordinate(coord, start_new_part);
 			start_new_part = false;
 		}
 	}
@@ -1714,6 +2109,36 @@ MapCoord OgrFileImport::fromProjected(double x, double y) const
 	return MapCoord::load(map->getGeoreferencing().toMapCoordF(QPointF{ x, y }), MapCoord::Flags{});
 }
 
+MapCoordVector OgrFileImport::toMapCoords(OGRGeometryH geometry) const
+{
+	MapCoordVector coords;
+	const auto num_points = OGR_G_GetPointCount(geometry);
+	if (num_points <= 0)
+		return coords;
+	
+	const auto count = std::size_t(num_points);
+	std::vector<double> x(count);
+	std::vector<double> y(count);
+	OGR_G_GetPoints(geometry, x.data(), sizeof(double), y.data(), sizeof(double), nullptr, 0);
+	
+	coords.reserve(count);
+	if (to_map_coord == &OgrFileImport::fromProjected)
+	{
+		std::vector<QPointF> projected;
+		projected.reserve(count);
+		for (std::size_t i = 0; i < count; ++i)
+			projected.emplace_back(x[i], y[i]);
+		for (const auto& coord : map->getGeoreferencing().toMapCoordF(projected))
+			coords.push_back(MapCoord::load(coord, MapCoord::Flags{}));
+	}
+	else
+	{
+		for (std::size_t i = 0; i < count; ++i)
+			coords.push_back(toMapCoord(x[i], y[i]));
+	}
+	return coords;
+}
+
 
 // static
 bool OgrFileImport::checkGeoreferencing(const QString& path, const Georeferencing& georef)
@@ -1870,13 +2295,23 @@ bool OgrFileExport::exportImplementation()
 	setupGeoreferencing(po_driver);
 
 	// Create output dataset
+	auto options = datasetOptions();
+	std::vector<char*> option_list;
+	option_list.reserve(options.size() + 1);
+	for (auto& option : options)
+		option_list.push_back(option.data());
+	option_list.push_back(nullptr);
 	po_ds = ogr::unique_datasource(OGR_Dr_CreateDataSource(
 	                                   po_driver,
 	                                   path.toLatin1(),
-	                                   nullptr));
+	                                   option_list.data()));
 	if (!po_ds)
 		throw FileFormatException(tr("Failed to create dataset: %1").arg(QString::fromLatin1(CPLGetLastErrorMsg())));
 
+	// Drivers with native transactions, e.g. for GeoPackage, are much faster
+	// when all features are written in a single transaction.
+	const auto transaction = GDALDatasetStartTransaction(po_ds.get(), false) == OGRERR_NONE;
+
 	// Name field definition
 	if (quirks.testFlag(UseLayerField))
 	{
@@ -2025,6 +2460,9 @@ bool OgrFileExport::exportImplementation()
 			addAreasToLayer(area_layer, is_area_object);
 	}
 
+	if (transaction && GDALDatasetCommitTransaction(po_ds.get()) != OGRERR_NONE)
+		throw FileFormatException(tr("Failed to write the data: %1").arg(QString::fromLatin1(CPLGetLastErrorMsg())));
+
 	return true;
 }
 
@@ -2093,7 +2531,7 @@ void OgrFileExport::setupGeoreferencing(GDALDriverH po_driver)
 #if GDAL_VERSION_MAJOR >= 3
 		OSRSetAxisMappingStrategy(geo_srs.get(), OAMS_TRADITIONAL_GIS_ORDER);
 #endif
-		transformation = ogr::unique_transformation { OCTNewCoordinateTransformation(map_srs.get(), geo_srs.get()) };
+		transformations = std::make_unique<OgrTransformationPool>(map_srs.get(), geo_srs.get());
 	}
 }
 
@@ -2114,6 +2552,8 @@ void OgrFileExport::setupQuirks(GDALDriverH po_driver)
 	    { "GPX",           NeedsWgs84 },
 	    { "INGRES",        GeorefOptional },
 	    { "LIBKML",        NeedsWgs84 },
+	    { "MBTiles",       WebMapTiles },
+	    { "MVT",           WebMapTiles },
 	    { "ODS",           GeorefOptional },
 	    { "OpenJUMP .jml", GeorefOptional },
 	    { "REC",           GeorefOptional },
@@ -2131,13 +2571,41 @@ void OgrFileExport::setupQuirks(GDALDriverH po_driver)
 		quirks |= driver_info->quirks;
 }
 
+std::vector<QByteArray> OgrFileExport::datasetOptions() const
+{
+	std::vector<QByteArray> options;
+	if (quirks & WebMapTiles)
+	{
+		// The driver reprojects to EPSG:3857, clips the features to the tiles,
+		// and quantizes and simplifies them for each zoom level.
+		// The most detailed zoom level shall show the map at about its
+		// nominal scale, with the OGC standard pixel size of 0.28 mm.
+		// Each coarser level halves the resolution.
+		const auto& georef = map->getGeoreferencing();
+		const auto meters_per_pixel = georef.getScaleDenominator() * 0.00028;
+		const auto latitude = qDegreesToRadians(georef.getGeographicRefPoint().latitude());
+		const auto equator_meters_per_pixel = 156543.03392804097;  // zoom level 0, 256 pixel tiles
+		const auto zoom = std::log2(equator_meters_per_pixel * std::cos(latitude) / meters_per_pixel);
+		const auto max_zoom = qBound(0, int(std::ceil(zoom)) + 1, 22);
+		const auto min_zoom = qMax(0, max_zoom - 6);
+		options.push_back("MINZOOM=" + QByteArray::number(min_zoom));
+		options.push_back("MAXZOOM=" + QByteArray::number(max_zoom));
+		// Simplify by one tile unit at all but the most detailed level.
+		options.push_back("SIMPLIFICATION=1");
+		options.push_back("SIMPLIFICATION_MAX_ZOOM=0");
+		options.push_back("NAME=" + QFileInfo(path).baseName().toUtf8());
+	}
+	return options;
+}
+
 void OgrFileExport::addPointsToLayer(OGRLayerH layer, const std::function<bool (const Object*)>& condition)
 {
 	const auto& georef = map->getGeoreferencing();
+	const auto feature_definition = OGR_L_GetLayerDefn(layer);
 
-	auto add_feature = [&](const Object* object) {
+	auto make_features = [&](const Object* object, std::vector<ogr::unique_feature>& features) {
 		auto symbol = object->getSymbol();
-		auto po_feature = ogr::unique_feature(OGR_F_Create(OGR_L_GetLayerDefn(layer)));
+		auto po_feature = ogr::unique_feature(OGR_F_Create(feature_definition));
 
 		QString sym_name = symbol->getPlainTextName();
 		sym_name.truncate(32);
@@ -2149,26 +2617,26 @@ void OgrFileExport::addPointsToLayer(OGRLayerH layer, const std::function<bool (
 		OGR_G_SetPoint_2D(pt.get(), 0, proj_cord.x(), proj_cord.y());
 
 		if (quirks & NeedsWgs84)
-			OGR_G_Transform(pt.get(), transformation.get());
+			transformGeometry(pt.get());
 
 		OGR_F_SetGeometry(po_feature.get(), pt.get());
 
 		OGR_F_SetStyleString(po_feature.get(), OGR_STBL_Find(table.get(), symbolId(symbol)));
 
-		if (OGR_L_CreateFeature(layer, po_feature.get()) != OGRERR_NONE)
-			throw FileFormatException(tr("Failed to create feature in layer: %1").arg(QString::fromLatin1(CPLGetLastErrorMsg())));
+		features.push_back(std::move(po_feature));
 	};
 
-	map->applyOnMatchingObjects(add_feature, condition);
+	addFeaturesToLayer(layer, condition, make_features);
 }
 
 void OgrFileExport::addTextToLayer(OGRLayerH layer, const std::function<bool (const Object*)>& condition)
 {
 	const auto& georef = map->getGeoreferencing();
+	const auto feature_definition = OGR_L_GetLayerDefn(layer);
 
-	auto add_feature = [&](const Object* object) {
+	auto make_features = [&](const Object* object, std::vector<ogr::unique_feature>& features) {
 		auto symbol = object->getSymbol();
-		auto po_feature = ogr::unique_feature(OGR_F_Create(OGR_L_GetLayerDefn(layer)));
+		auto po_feature = ogr::unique_feature(OGR_F_Create(feature_definition));
 
 		QString sym_name = symbol->getPlainTextName();
 		sym_name.truncate(32);
@@ -2190,7 +2658,7 @@ void OgrFileExport::addTextToLayer(OGRLayerH layer, const std::function<bool (co
 		OGR_G_SetPoint_2D(pt.get(), 0, proj_cord.x(), proj_cord.y());
 
 		if (quirks & NeedsWgs84)
-			OGR_G_Transform(pt.get(), transformation.get());
+			transformGeometry(pt.get());
 
 		OGR_F_SetGeometry(po_feature.get(), pt.get());
 
@@ -2204,18 +2672,18 @@ void OgrFileExport::addTextToLayer(OGRLayerH layer, const std::function<bool (co
 		}
 		OGR_F_SetStyleString(po_feature.get(), style);
 
-		if (OGR_L_CreateFeature(layer, po_feature.get()) != OGRERR_NONE)
-			throw FileFormatException(tr("Failed to create feature in layer: %1").arg(QString::fromLatin1(CPLGetLastErrorMsg())));
+		features.push_back(std::move(po_feature));
 	};
 
-	map->applyOnMatchingObjects(add_feature, condition);
+	addFeaturesToLayer(layer, condition, make_features);
 }
 
 void OgrFileExport::addLinesToLayer(OGRLayerH layer, const std::function<bool (const Object*)>& condition)
 {
 	const auto& georef = map->getGeoreferencing();
+	const auto feature_definition = OGR_L_GetLayerDefn(layer);
 
-	auto add_feature = [&](const Object* object) {
+	auto make_features = [&](const Object* object, std::vector<ogr::unique_feature>& features) {
 		const auto* symbol = object->getSymbol();
 		const auto* path = object->asPath();
 		if (path->parts().empty())
@@ -2224,77 +2692,105 @@ void OgrFileExport::addLinesToLayer(OGRLayerH layer, const std::function<bool (c
 		QString sym_name = symbol->getPlainTextName();
 		sym_name.truncate(32);
 
-		auto line_string = ogr::unique_geometry(OGR_G_CreateGeometry(wkbLineString));
 		const auto& parts = path->parts();
 		for (const auto& part : parts)
 		{
-			auto po_feature = ogr::unique_feature(OGR_F_Create(OGR_L_GetLayerDefn(layer)));
+			auto po_feature = ogr::unique_feature(OGR_F_Create(feature_definition));
 			OGR_F_SetFieldString(po_feature.get(), OGR_F_GetFieldIndex(po_feature.get(), symbol_field), sym_name.toLatin1().constData());
 
-			for (const auto& coord : part.path_coords)
-			{
-				QPointF proj_cord = georef.toProjectedCoords(coord.pos);
-				OGR_G_AddPoint_2D(line_string.get(), proj_cord.x(), proj_cord.y());
-			}
+			// Each part is a separate feature.
+			auto line_string = ogr::unique_geometry(OGR_G_CreateGeometry(wkbLineString));
+			setPoints(line_string.get(), georef, part.path_coords);
 
 			if (quirks & NeedsWgs84)
-				OGR_G_Transform(line_string.get(), transformation.get());
+				transformGeometry(line_string.get());
 
 			OGR_F_SetGeometry(po_feature.get(), line_string.get());
 
 			OGR_F_SetStyleString(po_feature.get(), OGR_STBL_Find(table.get(), symbolId(symbol)));
 
-			if (OGR_L_CreateFeature(layer, po_feature.get()) != OGRERR_NONE)
-				throw FileFormatException(tr("Failed to create feature in layer: %1").arg(QString::fromLatin1(CPLGetLastErrorMsg())));
+			features.push_back(std::move(po_feature));
 		}
 	};
 
-	map->applyOnMatchingObjects(add_feature, condition);
+	addFeaturesToLayer(layer, condition, make_features);
 }
 
 void OgrFileExport::addAreasToLayer(OGRLayerH layer, const std::function<bool (const Object*)>& condition)
 {
 	const auto& georef = map->getGeoreferencing();
+	const auto feature_definition = OGR_L_GetLayerDefn(layer);
 
-	auto add_feature = [&](const Object* object) {
+	auto make_features = [&](const Object* object, std::vector<ogr::unique_feature>& features) {
 		const auto* symbol = object->getSymbol();
 		const auto* path = object->asPath();
 		if (path->parts().empty())
 			return;
 
-		auto po_feature = ogr::unique_feature(OGR_F_Create(OGR_L_GetLayerDefn(layer)));
+		auto po_feature = ogr::unique_feature(OGR_F_Create(feature_definition));
 
 		QString sym_name = symbol->getPlainTextName();
 		sym_name.truncate(32);
 		OGR_F_SetFieldString(po_feature.get(), OGR_F_GetFieldIndex(po_feature.get(), symbol_field), sym_name.toLatin1().constData());
 
 		auto polygon = ogr::unique_geometry(OGR_G_CreateGeometry(wkbPolygon));
-		auto cur_ring = ogr::unique_geometry(OGR_G_CreateGeometry(wkbLinearRing));
 
 		const auto& parts = path->parts();
 		for (const auto& part : parts)
 		{
-			for (const auto& coord : part.path_coords)
-			{
-				QPointF proj_cord = georef.toProjectedCoords(coord.pos);
-				OGR_G_AddPoint_2D(cur_ring.get(), proj_cord.x(), proj_cord.y());
-			}
+			auto cur_ring = ogr::unique_geometry(OGR_G_CreateGeometry(wkbLinearRing));
+			setPoints(cur_ring.get(), georef, part.path_coords);
 			OGR_G_CloseRings(cur_ring.get());
 			if (quirks & NeedsWgs84)
-				OGR_G_Transform(cur_ring.get(), transformation.get());
+				transformGeometry(cur_ring.get());
 			OGR_G_AddGeometry(polygon.get(), cur_ring.get());
-			cur_ring.reset(OGR_G_CreateGeometry(wkbLinearRing));
 		}
 
 		OGR_F_SetGeometry(po_feature.get(), polygon.get());
 
 		OGR_F_SetStyleString(po_feature.get(), OGR_STBL_Find(table.get(), symbolId(symbol)));
 
-		if (OGR_L_CreateFeature(layer, po_feature.get()) != OGRERR_NONE)
-			throw FileFormatException(tr("Failed to create feature in layer: %1").arg(QString::fromLatin1(CPLGetLastErrorMsg())));
+		features.push_back(std::move(po_feature));
 	};
 
-	map->applyOnMatchingObjects(add_feature, condition);
+	addFeaturesToLayer(layer, condition, make_features);
+}
+
+void OgrFileExport::addFeaturesToLayer(OGRLayerH layer, const std::function<bool (const Object*)>& condition, const FeatureMaker& make_features)
+{
+	std::vector<const Object*> objects;
+	map->applyOnMatchingObjects([&objects](const Object* object) { objects.push_back(object); }, condition);
+
+	// The chunks limit the memory used by pending features.
+	constexpr std::size_t chunk_size = 4096;
+	std::vector<std::vector<ogr::unique_feature>> features;
+	for (std::size_t first = 0; first < objects.size(); first += chunk_size)
+	{
+		const auto count = std::min(chunk_size, objects.size() - first);
+		features.clear();
+		features.resize(count);
+		Concurrency::parallelFor(0, int(count), [&](int i) {
+			make_features(objects[first + std::size_t(i)], features[std::size_t(i)]);
+		}, 16);
+
+		for (const auto& object_features : features)
+		{
+			for (const auto& feature : object_features)
+			{
+				if (OGR_L_CreateFeature(layer, feature.get()) != OGRERR_NONE)
+					throw FileFormatException(tr("Failed to create feature in layer: %1").arg(QString::fromLatin1(CPLGetLastErrorMsg())));
+			}
+		}
+	}
+}
+
+void OgrFileExport::transformGeometry(OGRGeometryH geometry) const
+{
+	if (auto transformation = transformations->acquire())
+	{
+		OGR_G_Transform(geometry, transformation.get());
+		transformations->release(std::move(transformation));
+	}
 }
 
 OGRLayerH OgrFileExport::createLayer(const char* layer_name, OGRwkbGeometryType type)
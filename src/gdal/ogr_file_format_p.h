@@ -29,6 +29,7 @@
 #include <QCoreApplication>
 #include <QFlags>
 #include <QHash>
+#include <QRectF>
 #include <QString>
 #include <QtGlobal>
 
@@ -55,6 +56,8 @@ class MapView;
 class MapColor;
 class MapPart;
 class Object;
+class ObjectTags;
+class OgrTransformationPool;
 class PathObject;
 class PointSymbol;
 class TextSymbol;
@@ -179,6 +182,13 @@ namespace ogr
  * 
  * The option "separate_layers" will cause OGR layers to be imported as distinct
  * map parts if set to true.
+ * 
+ * The option "Spatial filter" takes a QRectF in map coordinates. If it is
+ * valid, only the features which intersect this area are imported. This
+ * requires a map which is georeferenced before the import.
+ * 
+ * Features are read in batches on a worker thread while the previous batch
+ * is converted, so memory use doesn't depend on the size of the layers.
  */
 class OgrFileImport : public Importer
 {
@@ -204,6 +214,36 @@ public:
 		virtual ObjectList process(const ObjectList& objects) const = 0;
 	};
 	
+	/**
+	 * An interface for selecting the features to be imported.
+	 * 
+	 * This allows to update the objects from a previous import incrementally.
+	 * Features are identified by layer index and FID, and their content is
+	 * summarized by a fingerprint, cf. fingerprint().
+	 */
+	class FeatureFilter
+	{
+	public:
+		virtual ~FeatureFilter();
+		
+		/**
+		 * Returns true if the given feature shall be imported.
+		 * 
+		 * This function is called before the feature's geometry is
+		 * transformed. The FID may be OGRNullFID.
+		 */
+		virtual bool accept(int layer, GIntBig fid, const QByteArray& fingerprint) = 0;
+		
+		/**
+		 * Receives the objects which were created for an accepted feature.
+		 * 
+		 * The objects are owned by the map. Note that the final validation
+		 * of the import may still drop irregular objects.
+		 */
+		virtual void imported(int layer, GIntBig fid, const QByteArray& fingerprint, const ObjectList& objects) = 0;
+	};
+	
+	
 	
 	static bool canRead(const QString& path);
 	
@@ -240,6 +280,21 @@ public:
 	 */
 	void setGeoreferencingImportEnabled(bool enabled);
 	
+	/**
+	 * Sets a filter which selects the features to be imported.
+	 * 
+	 * The filter must remain valid during the import. A nullptr (the default)
+	 * imports all features.
+	 */
+	void setFeatureFilter(FeatureFilter* filter);
+	
+	/**
+	 * Returns a fingerprint of the feature's raw geometry, style and fields.
+	 * 
+	 * Features with equal fingerprints result in equal objects.
+	 */
+	static QByteArray fingerprint(OGRFeatureH feature);
+	
 	
 	/**
 	 * Tests if the file's spatial references can be used with the given georeferencing.
@@ -278,7 +333,25 @@ protected:
 	
 	void importLayer(MapPart* map_part, OGRLayerH layer);
 	
-	void importFeature(MapPart* map_part, OGRFeatureDefnH feature_definition, OGRFeatureH feature, OGRGeometryH geometry, const Clipping* clipping);
+	/**
+	 * Restricts reading of the layer to the area of the spatial filter.
+	 * 
+	 * Returns false if the layer cannot be filtered.
+	 */
+	bool setSpatialFilter(OGRLayerH layer);
+	
+	/**
+	 * Imports a batch of features.
+	 * 
+	 * The coordinate transformation and the reading of the field values
+	 * are done concurrently. The objects are created in the order of the
+	 * features.
+	 */
+	void importFeatures(MapPart* map_part, const std::vector<QString>& field_names, std::vector<ogr::unique_feature>& features, const Clipping* clipping);
+	
+	void importFeature(MapPart* map_part, const std::vector<QString>& field_names, OGRFeatureH feature, OGRGeometryH geometry, const QByteArray& fingerprint, const Clipping* clipping);
+	
+	void addObjects(MapPart* map_part, OGRFeatureH feature, const QByteArray& fingerprint, ObjectList objects, const ObjectTags& tags, const Clipping* clipping);
 	
 	
 	ObjectList importGeometry(OGRFeatureH feature, OGRGeometryH geometry);
@@ -308,6 +381,13 @@ protected:
 	
 	MapCoord toMapCoord(double x, double y) const;
 	
+	/**
+	 * Returns the map coordinates for all points of the given geometry.
+	 * 
+	 * The coordinates are read and transformed as a batch.
+	 */
+	MapCoordVector toMapCoords(OGRGeometryH geometry) const;
+	
 	/**
 	 * A MapCoordConstructor which interprets the given coordinates in millimeters on paper.
 	 */
@@ -353,18 +433,26 @@ private:
 	
 	ogr::unique_transformation data_transform;
 	
+	std::unique_ptr<OgrTransformationPool> transformation_pool;
+	
 	ogr::unique_stylemanager manager;
 	
+	FeatureFilter* feature_filter = nullptr;
+	
 	int empty_geometries = 0;
 	int no_transformation = 0;
 	int failed_transformation = 0;
 	int unsupported_geometry_type = 0;
 	int too_few_coordinates = 0;
 	
+	int current_layer = 0;
+	int num_layers = 0;
+	
 	UnitType unit_type;
 	
 	bool georeferencing_import_enabled = true;
 	bool clip_layers;
+	QRectF spatial_filter;
 };
 
 
@@ -400,6 +488,7 @@ public:
 		NeedsWgs84     = 0x02,   ///< The driver needs WGS84 geographic coordinates.
 		SingleLayer    = 0x04,   ///< The driver supports just a single layer.
 		UseLayerField  = 0x08,   ///< Write the symbol names to the layer field.
+		WebMapTiles    = 0x10,   ///< The driver writes tiles for web maps.
 	};
 
 	/**
@@ -422,6 +511,28 @@ protected:
 	void addLinesToLayer(OGRLayerH layer, const std::function<bool (const Object*)>& condition);
 	void addAreasToLayer(OGRLayerH layer, const std::function<bool (const Object*)>& condition);
 
+	/**
+	 * A function which creates the OGR features for a single object.
+	 *
+	 * This function is called concurrently for different objects.
+	 */
+	using FeatureMaker = std::function<void (const Object* object, std::vector<ogr::unique_feature>& features)>;
+
+	/**
+	 * Adds the features for all objects matching the condition to the layer.
+	 *
+	 * The objects are processed in chunks. The features of a chunk are
+	 * prepared concurrently, and then written to the layer in object order.
+	 */
+	void addFeaturesToLayer(OGRLayerH layer, const std::function<bool (const Object*)>& condition, const FeatureMaker& make_features);
+
+	/**
+	 * Transforms the geometry to WGS84, for drivers with the NeedsWgs84 quirk.
+	 *
+	 * This function is thread-safe.
+	 */
+	void transformGeometry(OGRGeometryH geometry) const;
+
 	OGRLayerH createLayer(const char* layer_name, OGRwkbGeometryType type);
 
 	static QByteArray symbolId(const Symbol* symbol) { return QByteArray::number(quint64(symbol), 16); }
@@ -430,13 +541,20 @@ protected:
 
 	void setupGeoreferencing(GDALDriverH po_driver);
 	void setupQuirks(GDALDriverH po_driver);
+	
+	/**
+	 * Returns the dataset creation options for the current driver.
+	 * 
+	 * For WebMapTiles, this selects the zoom levels which match the map scale.
+	 */
+	std::vector<QByteArray> datasetOptions() const;
 
 private:
 	ogr::unique_datasource po_ds;
 	ogr::unique_fielddefn o_name_field;
 	ogr::unique_srs map_srs;
 	ogr::unique_styletable table;
-	ogr::unique_transformation transformation;
+	std::unique_ptr<OgrTransformationPool> transformations;
 	
 	const char* symbol_field;
 
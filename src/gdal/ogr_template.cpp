@@ -23,15 +23,19 @@
 #include <iosfwd>
 #include <iterator>
 #include <memory>
+#include <unordered_set>
 #include <utility>
 
 #include <Qt>
 #include <QtGlobal>
 #include <QByteArray>
 #include <QDialog>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
 #include <QLatin1String>
 #include <QPoint>
 #include <QPointF>
+#include <QStringList>
 #include <QStringRef>
 #include <QTimer>
 #include <QTransform>
@@ -43,6 +47,7 @@
 #include "core/latlon.h"
 #include "core/map.h"
 #include "core/map_coord.h"
+#include "core/map_part.h"
 #include "core/track.h"
 #include "core/objects/object.h"
 #include "fileformats/file_format.h"
@@ -52,6 +57,7 @@
 #include "templates/template.h"
 #include "templates/template_positioning_dialog.h"
 #include "templates/template_track.h"
+#include "util/util.h"
 
 
 #ifdef __clang_analyzer__
@@ -100,6 +106,79 @@ namespace {
 
 
 
+/**
+ * A feature filter which skips the features which are unchanged since the
+ * previous import, and which records the objects of the imported features.
+ */
+class OgrTemplate::FeatureTracker : public OgrFileImport::FeatureFilter
+{
+public:
+	explicit FeatureTracker(FeatureIndex&& previous)
+	: previous(std::move(previous))
+	{}
+	
+	bool accept(int layer, GIntBig fid, const QByteArray& fingerprint) override
+	{
+		if (fid == OGRNullFID)
+			return true;
+		
+		auto const key = FeatureKey{ layer, fid };
+		if (current.count(key))
+			return true;  // duplicate FID
+		
+		auto found = previous.find(key);
+		if (found == previous.end() || found->second.fingerprint != fingerprint)
+			return true;
+		
+		current.insert(std::move(*found));
+		previous.erase(found);
+		return false;
+	}
+	
+	void imported(int layer, GIntBig fid, const QByteArray& fingerprint, const OgrFileImport::ObjectList& objects) override
+	{
+		added.insert(added.end(), objects.begin(), objects.end());
+		if (fid == OGRNullFID)
+		{
+			unidentified.insert(unidentified.end(), objects.begin(), objects.end());
+			return;
+		}
+		
+		auto& entry = current[{ layer, fid }];
+		entry.fingerprint = fingerprint;
+		entry.objects.insert(entry.objects.end(), objects.begin(), objects.end());
+	}
+	
+	/**
+	 * Forgets the added objects which are no longer in the imported map.
+	 * 
+	 * The importer's final validation may delete irregular objects.
+	 */
+	void dropMissingObjects(const Map& imported_map)
+	{
+		std::unordered_set<const Object*> existing;
+		existing.reserve(added.size());
+		imported_map.applyOnAllObjects([&existing](const Object* object) { existing.insert(object); });
+		if (existing.size() == added.size())
+			return;
+		
+		auto const is_missing = [&existing](const Object* object) { return existing.count(object) == 0; };
+		for (auto& entry : current)
+		{
+			auto& objects = entry.second.objects;
+			objects.erase(std::remove_if(begin(objects), end(objects), is_missing), end(objects));
+		}
+		unidentified.erase(std::remove_if(begin(unidentified), end(unidentified), is_missing), end(unidentified));
+	}
+	
+	FeatureIndex previous;  ///< Features which were neither found unchanged nor imported again.
+	FeatureIndex current;   ///< Features which were unchanged or imported.
+	std::vector<Object*> unidentified;
+	std::vector<Object*> added;
+};
+
+
+
 // static
 bool OgrTemplate::canRead(const QString& path)
 {
@@ -292,12 +371,25 @@ catch (FileFormatException& e)
 }
 
 
+void OgrTemplate::setImportArea(const QRectF& map_rect)
+{
+	import_area = map_rect;
+}
+
+void OgrTemplate::setImportProgressHandler(const Importer::ProgressHandler& handler)
+{
+	import_progress_handler = handler;
+}
+
+
 bool OgrTemplate::loadTemplateFileImpl(bool configuring)
 try
 {
 	auto new_template_map = std::make_unique<Map>();
 	auto unit_type = use_real_coords ? OgrFileImport::UnitOnGround : OgrFileImport::UnitOnPaper;
 	OgrFileImport importer{template_path, new_template_map.get(), nullptr, unit_type };
+	FeatureTracker tracker{ FeatureIndex{} };
+	importer.setFeatureFilter(&tracker);
 	
 	// Configure generation of renderables.
 	updateView(*new_template_map);
@@ -384,12 +476,14 @@ try
 	}
 	
 	const auto pp0 = new_template_map->getGeoreferencing().getProjectedRefPoint();
-	importer.setGeoreferencingImportEnabled(false);
+	setupImporter(importer);
+	importer.setProgressHandler(import_progress_handler);
 	if (!importer.doImport())
 	{
 		setErrorString(importer.warnings().back());
 		return false;
 	}
+	tracker.dropMissingObjects(*new_template_map);
 	
 	// MapCoord bounds handling may have moved the paper position of the
 	// template data during import. The template position might need to be
@@ -401,6 +495,9 @@ try
 	setTemplatePositionOffset(pm1 - pm0);
 	
 	setTemplateMap(std::move(new_template_map));
+	feature_index = std::move(tracker.current);
+	unidentified_objects = std::move(tracker.unidentified);
+	watchFile();
 	
 	const auto& warnings = importer.warnings();
 	if (!warnings.empty())
@@ -424,6 +521,11 @@ catch (FileFormatException& e)
 	return false;
 }
 
+std::function<void ()> OgrTemplate::makeBackgroundLoader()
+{
+	return {};
+}
+
 
 bool OgrTemplate::postLoadConfiguration(QWidget* dialog_parent, bool& out_center_in_view)
 {
@@ -433,6 +535,87 @@ bool OgrTemplate::postLoadConfiguration(QWidget* dialog_parent, bool& out_center
 }
 
 
+void OgrTemplate::updateChangedFeatures()
+try
+{
+	update_pending = false;
+	if (template_state != Template::Loaded || reload_pending)
+		return;
+	
+	// Editors and GIS software may replace the file instead of modifying it.
+	watchFile();
+	if (!QFileInfo::exists(template_path))
+		return;
+	
+	auto* template_map = templateMap();
+	Map changes;
+	changes.setGeoreferencing(template_map->getGeoreferencing());
+	auto unit_type = use_real_coords ? OgrFileImport::UnitOnGround : OgrFileImport::UnitOnPaper;
+	OgrFileImport importer{template_path, &changes, nullptr, unit_type };
+	FeatureTracker tracker{ std::move(feature_index) };
+	feature_index.clear();
+	importer.setFeatureFilter(&tracker);
+	setupImporter(importer);
+	if (!importer.doImport())
+	{
+		reloadLater();
+		return;
+	}
+	tracker.dropMissingObjects(changes);
+	
+	QRectF dirty_area;
+	
+	// Remove the objects of the features which were changed or removed.
+	auto obsolete = std::move(unidentified_objects);
+	for (auto const& entry : tracker.previous)
+		obsolete.insert(obsolete.end(), entry.second.objects.begin(), entry.second.objects.end());
+	for (auto const* object : obsolete)
+		rectIncludeSafe(dirty_area, object->getExtent());
+	for (int i = 0; i < template_map->getNumParts(); ++i)
+		template_map->getPart(i)->deleteObjects(obsolete);
+	
+	// Move the objects of the features which were changed or added.
+	if (changes.getNumObjects() > 0)
+	{
+		auto const symbol_map = template_map->importMap(changes, Map::SymbolImport);
+		auto const transform = changes.getGeoreferencing().mapToProjected() * template_map->getGeoreferencing().projectedToMap();
+		for (int i = 0; i < changes.getNumParts(); ++i)
+		{
+			auto* part = changes.getPart(i);
+			auto* dest_part = template_map->getCurrentPart();
+			for (int j = 0; j < template_map->getNumParts(); ++j)
+			{
+				if (template_map->getPart(j)->getName() == part->getName())
+					dest_part = template_map->getPart(j);
+			}
+			
+			std::vector<Object*> objects;
+			objects.reserve(std::size_t(part->getNumObjects()));
+			for (auto j = part->getNumObjects(); j > 0; --j)
+			{
+				auto* object = part->getObject(j - 1);
+				object->setSymbol(symbol_map.value(object->getSymbol()), true);
+				if (!transform.isIdentity())
+					object->transform(transform);
+				objects.push_back(part->releaseObject(j - 1));
+			}
+			std::for_each(objects.rbegin(), objects.rend(), [dest_part, &dirty_area](Object* object) {
+				dest_part->addObject(object);
+				rectIncludeSafe(dirty_area, object->getExtent());
+			});
+		}
+	}
+	
+	feature_index = std::move(tracker.current);
+	unidentified_objects = std::move(tracker.unidentified);
+	setAreaDirty(dirty_area);
+}
+catch (FileFormatException&)
+{
+	reloadLater();
+}
+
+
 
 void OgrTemplate::mapProjectionChanged()
 {
@@ -491,6 +674,8 @@ void OgrTemplate::reloadLater()
 	setTemplateAreaDirty();
 	if (template_state == Loaded)
 		templateMap()->clear(); // no expensive operations before reloading
+	feature_index.clear();
+	unidentified_objects.clear();
 	QTimer::singleShot(0, this, &OgrTemplate::reload);
 	reload_pending = true;
 }
@@ -512,6 +697,16 @@ void OgrTemplate::applySettings()
 		updateView(*template_map);
 }
 
+void OgrTemplate::fileChanged()
+{
+	// The file may be written in several steps.
+	// The update waits for a quiet moment.
+	if (update_pending)
+		return;
+	QTimer::singleShot(1000, this, &OgrTemplate::updateChangedFeatures);
+	update_pending = true;
+}
+
 void OgrTemplate::updateView(Map& template_map)
 {
 	GdalManager manager;
@@ -580,4 +775,42 @@ void OgrTemplate::saveTypeSpecificTemplateConfiguration(QXmlStreamWriter& xml) c
 }
 
 
+void OgrTemplate::setupImporter(OgrFileImport& importer) const
+{
+	importer.setGeoreferencingImportEnabled(false);
+	if (is_georeferenced && import_area.isValid())
+		importer.setOption(QStringLiteral("Spatial filter"), import_area);
+}
+
+void OgrTemplate::watchFile()
+{
+	if (!file_watcher)
+	{
+		file_watcher = new QFileSystemWatcher(this);
+		connect(file_watcher, &QFileSystemWatcher::fileChanged, this, &OgrTemplate::fileChanged);
+	}
+	if (!file_watcher->files().contains(template_path) && QFileInfo::exists(template_path))
+		file_watcher->addPath(template_path);
+}
+
+void OgrTemplate::setAreaDirty(const QRectF& template_area)
+{
+	if (!template_area.isValid())
+		return;
+	
+	if (is_georeferenced)
+	{
+		map->setTemplateAreaDirty(this, template_area, 0);
+		return;
+	}
+	
+	QRectF map_bbox;
+	rectIncludeSafe(map_bbox, templateToMap(template_area.topLeft()));
+	rectIncludeSafe(map_bbox, templateToMap(template_area.topRight()));
+	rectIncludeSafe(map_bbox, templateToMap(template_area.bottomLeft()));
+	rectIncludeSafe(map_bbox, templateToMap(template_area.bottomRight()));
+	map->setTemplateAreaDirty(this, map_bbox, 0);
+}
+
+
 }  // namespace OpenOrienteering
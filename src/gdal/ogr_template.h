@@ -20,15 +20,22 @@
 #ifndef OPENORIENTEERING_OGR_TEMPLATE_H
 #define OPENORIENTEERING_OGR_TEMPLATE_H
 
+#include <functional>
+#include <map>
 #include <memory>
+#include <utility>
 #include <vector>
 
+#include <QtGlobal>
+#include <QByteArray>
 #include <QObject>
+#include <QRectF>
 #include <QString>
 
+#include "fileformats/file_import_export.h"
 #include "templates/template_map.h"
 
-class QByteArray;
+class QFileSystemWatcher;
 class QWidget;
 class QXmlStreamReader;
 class QXmlStreamWriter;
@@ -37,11 +44,18 @@ namespace OpenOrienteering {
 
 class Georeferencing;
 class Map;
+class Object;
+class OgrFileImport;
 
 
 /**
  * A Template which displays a file supported by OGR
  * (geospatial vector data).
+ * 
+ * When the file is modified, the template updates only the objects of those
+ * features which were added, changed or removed. Features are identified by
+ * their layer and FID, and changes are detected by a fingerprint of their
+ * raw data.
  */
 class OgrTemplate : public TemplateMap
 {
@@ -71,6 +85,20 @@ public:
 	
 	bool preLoadConfiguration(QWidget* dialog_parent) override;
 	
+	/**
+	 * Restricts loading to the features which intersect the given area.
+	 * 
+	 * The area is given in map coordinates. It is used only when the template
+	 * is georeferenced. An invalid rect disables the restriction.
+	 * This setting is not saved with the template configuration.
+	 */
+	void setImportArea(const QRectF& map_rect);
+	
+	/**
+	 * Sets a function which receives the progress of loading the data.
+	 */
+	void setImportProgressHandler(const Importer::ProgressHandler& handler);
+	
 	/**
 	 * Loads the geospatial vector data into the template_map.
 	 * 
@@ -87,8 +115,25 @@ public:
 	 */
 	bool loadTemplateFileImpl(bool configuring) override;
 	
+	/**
+	 * Returns an empty function.
+	 * 
+	 * The import depends on the georeferencing of the map, so it is done
+	 * on the main thread.
+	 */
+	std::function<void ()> makeBackgroundLoader() override;
+	
 	bool postLoadConfiguration(QWidget* dialog_parent, bool& out_center_in_view) override;
 	
+	/**
+	 * Updates the template map for the features which changed in the file.
+	 * 
+	 * Only the changed features are transformed and turned into objects.
+	 * If the incremental update fails, the template is reloaded completely.
+	 * This is called automatically when the file is modified.
+	 */
+	void updateChangedFeatures();
+	
 protected:
 	void reloadLater();
 	
@@ -97,6 +142,8 @@ protected slots:
 	
 	void applySettings();
 	
+	void fileChanged();
+	
 protected:
 	void updateView(Map& template_map);
 	
@@ -108,7 +155,30 @@ protected:
 	
 	void saveTypeSpecificTemplateConfiguration(QXmlStreamWriter& xml) const override;
 	
+	/**
+	 * Configures an importer for the current settings.
+	 */
+	void setupImporter(OgrFileImport& importer) const;
+	
+	void watchFile();
+	
+	void setAreaDirty(const QRectF& template_area);
+	
 private:
+	/** The objects which were created from a single feature. */
+	struct FeatureObjects
+	{
+		QByteArray fingerprint;
+		std::vector<Object*> objects;
+	};
+	
+	/** Layer index and FID */
+	using FeatureKey = std::pair<int, qint64>;
+	
+	using FeatureIndex = std::map<FeatureKey, FeatureObjects>;
+	
+	class FeatureTracker;
+	
 	std::unique_ptr<Georeferencing> explicit_georef;
 	QString track_crs_spec;           // (limited) TemplateTrack compatibility
 	QString projected_crs_spec;       // (limited) TemplateTrack compatibility
@@ -116,6 +186,12 @@ private:
 	bool use_real_coords              { true };   //  transient
 	bool center_in_view               { false };  //  transient
 	bool reload_pending               { false };  //  transient
+	bool update_pending               { false };  //  transient
+	QRectF import_area;                                 //  transient
+	Importer::ProgressHandler import_progress_handler;  //  transient
+	FeatureIndex feature_index;                         //  transient
+	std::vector<Object*> unidentified_objects;          //  transient, features without FID
+	QFileSystemWatcher* file_watcher = nullptr;         //  transient
 };
 
 
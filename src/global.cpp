@@ -23,18 +23,23 @@
 
 #include "mapper_config.h" // IWYU pragma: keep
 
+#include "fileformats/binary_file_format.h"
 #include "fileformats/file_format_registry.h"
 #include "fileformats/xml_file_format.h"
 #include "fileformats/ocd_file_format.h"
 #include "gdal/ogr_file_format.h"
+#include "util/profiler.h"
 
 
 namespace OpenOrienteering {
 
 void doStaticInitializations()
 {
+	Profiler::initialize();
+	
 	// Register the supported file formats
 	FileFormats.registerFormat(new XMLFileFormat());
+	FileFormats.registerFormat(new BinaryFileFormat());
 #ifndef MAPPER_BIG_ENDIAN
 	for (auto&& format : OcdFileFormat::makeAll())
 		FileFormats.registerFormat(format.release());
@@ -512,6 +512,8 @@ void GeoreferencingDialog::reset()
 
 void GeoreferencingDialog::accept()
 {
+	crs_selector->commitParameterEdits();
+	
 	auto const declination_change_degrees = georef->getDeclination() - initial_georef->getDeclination();
 	auto const scale_factor_change = georef->getAuxiliaryScaleFactor() / initial_georef->getAuxiliaryScaleFactor();
 	if (grivation_locked)
@@ -1045,6 +1045,8 @@ bool MainWindow::removeAutosaveFile() const
 {
 	if (!currentPath().isEmpty() && !has_autosave_conflict)
 	{
+		if (controller)
+			controller->finishAutosave();
 		QFile autosave_file(autosavePath(currentPath()));
 		return !autosave_file.exists() || autosave_file.remove();
 	}
@@ -1066,18 +1068,12 @@ Autosave::AutosaveResult MainWindow::autosave()
 	else
 	{
 		showStatusBarMessageImmediately(tr("Autosaving..."), 0);
-		if (controller->exportTo(autosavePath(currentPath()), *autosave_format))
-		{
-			// Success
-			clearStatusBarMessage();
-			return Autosave::Success;
-		}
-		else
-		{
-			// Failure
+		auto const result = controller->autosaveTo(autosavePath(currentPath()), *autosave_format);
+		if (result == Autosave::PermanentFailure)
 			showStatusBarMessage(tr("Autosaving failed!"), 6000);
-			return Autosave::PermanentFailure;
-		}
+		else
+			clearStatusBarMessage();
+		return result;
 	}
 }
 
@@ -83,6 +83,16 @@ bool MainWindowController::exportTo(const QString& /*path*/, const FileFormat& /
 	return false;
 }
 
+Autosave::AutosaveResult MainWindowController::autosaveTo(const QString& path, const FileFormat& format)
+{
+	return exportTo(path, format) ? Autosave::Success : Autosave::PermanentFailure;
+}
+
+void MainWindowController::finishAutosave()
+{
+	// nothing
+}
+
 bool MainWindowController::loadFrom(const QString& /*path*/, const FileFormat& /*format*/, QWidget* /*dialog_parent*/)
 {
 	return false;
@@ -25,6 +25,8 @@
 #include <QObject>
 #include <QString>
 
+#include "core/autosave.h"
+
 class QKeyEvent;
 class QWidget;
 
@@ -84,6 +86,22 @@ public:
 	 *  @return true if saving was successful, false on errors
 	 */
 	virtual bool exportTo(const QString& path, const FileFormat& format);
+	
+	/**
+	 * Saves a backup copy of the document to the given path.
+	 * 
+	 * Implementations may skip writing when the document did not change since
+	 * the last autosave, and they may finish writing in the background.
+	 * The default implementation calls exportTo().
+	 */
+	virtual Autosave::AutosaveResult autosaveTo(const QString& path, const FileFormat& format);
+	
+	/**
+	 * Waits until autosaving in the background is finished.
+	 * 
+	 * The default implementation does nothing.
+	 */
+	virtual void finishAutosave();
 
 	/** Load from a file.
 	 *  @param path the path to load from
@@ -0,0 +1,205 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "map_dialog_check.h"
+
+#include <cstddef>
+
+#include <Qt>
+#include <QAbstractButton>
+#include <QAbstractItemView>
+#include <QApplication>
+#include <QDialogButtonBox>
+#include <QDoubleSpinBox>
+#include <QFormLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QLatin1Char>
+#include <QPushButton>
+#include <QTableWidget>
+#include <QTableWidgetItem>
+#include <QVBoxLayout>
+
+#include "core/map.h"
+#include "core/map_part.h"
+#include "core/objects/object.h"
+#include "core/symbols/symbol.h"
+#include "gui/util_gui.h"
+#include "gui/map/map_editor.h"
+#include "gui/map/map_widget.h"
+
+
+namespace OpenOrienteering {
+
+MapCheckDialog::MapCheckDialog(QWidget* parent, MapEditorController* controller)
+: QDialog(parent, Qt::WindowSystemMenuHint | Qt::WindowTitleHint)
+, controller(controller)
+, map(controller->getMap())
+{
+	setWindowTitle(tr("Check map"));
+	
+	tolerance_edit = Util::SpinBox::create(2, 0.01, 10.0, tr("mm"));
+	tolerance_edit->setValue(MapCheck::Options{}.tolerance);
+	
+	auto* options_layout = new QFormLayout();
+	options_layout->addRow(tr("Gap tolerance:"), tolerance_edit);
+	
+	summary_label = new QLabel();
+	
+	issue_table = new QTableWidget(0, 3);
+	issue_table->setHorizontalHeaderLabels({ tr("Issue"), tr("Symbol"), tr("Map part") });
+	issue_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+	issue_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+	issue_table->setSelectionMode(QAbstractItemView::SingleSelection);
+	issue_table->verticalHeader()->setVisible(false);
+	issue_table->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+	issue_table->horizontalHeader()->setSectionResizeMode(1, QHeaderView::Stretch);
+	
+	auto* button_box = new QDialogButtonBox(QDialogButtonBox::Close, Qt::Horizontal);
+	auto* check_button = button_box->addButton(tr("Check"), QDialogButtonBox::ActionRole);
+	remove_duplicates_button = button_box->addButton(tr("Remove duplicates"), QDialogButtonBox::ActionRole);
+	remove_duplicates_button->setEnabled(false);
+	
+	auto* layout = new QVBoxLayout();
+	layout->addLayout(options_layout);
+	layout->addWidget(summary_label);
+	layout->addWidget(issue_table, 1);
+	layout->addWidget(button_box);
+	setLayout(layout);
+	
+	connect(check_button, &QAbstractButton::clicked, this, &MapCheckDialog::runCheck);
+	connect(remove_duplicates_button, &QAbstractButton::clicked, this, &MapCheckDialog::removeDuplicates);
+	connect(button_box, &QDialogButtonBox::rejected, this, &QDialog::hide);
+	connect(issue_table, &QTableWidget::currentCellChanged, this, [this](int row) {
+		showIssue(row);
+	});
+	
+	resize(480, 480);
+}
+
+MapCheckDialog::~MapCheckDialog() = default;
+
+
+
+// static
+QString MapCheckDialog::description(MapCheck::IssueType type)
+{
+	switch (type)
+	{
+	case MapCheck::UnclosedArea:
+		return tr("Unclosed area");
+	case MapCheck::OverlappingAreas:
+		return tr("Overlapping areas");
+	case MapCheck::Gap:
+		return tr("Gap");
+	case MapCheck::DanglingLine:
+		return tr("Dangling line");
+	case MapCheck::DuplicateObject:
+		return tr("Duplicate object");
+	}
+	return {};
+}
+
+
+
+void MapCheckDialog::runCheck()
+{
+	MapCheck::Options options;
+	options.tolerance = tolerance_edit->value();
+	
+	QApplication::setOverrideCursor(Qt::WaitCursor);
+	result = MapCheck::run(*map, options);
+	change_count = map->changeCount();
+	QApplication::restoreOverrideCursor();
+	
+	issue_table->clearContents();
+	issue_table->setRowCount(int(result.issues.size()));
+	auto row = 0;
+	for (const auto& issue : result.issues)
+	{
+		const auto* symbol = issue.object->getSymbol();
+		issue_table->setItem(row, 0, new QTableWidgetItem(description(issue.type)));
+		issue_table->setItem(row, 1, new QTableWidgetItem(symbol->getNumberAsString() + QLatin1Char(' ') + symbol->getPlainTextName()));
+		issue_table->setItem(row, 2, new QTableWidgetItem(map->getPart(issue.part)->getName()));
+		++row;
+	}
+	
+	if (result.issues.empty())
+		summary_label->setText(tr("No issues found."));
+	else
+		summary_label->setText(tr("%n issue(s) found.", nullptr, int(result.issues.size())));
+	remove_duplicates_button->setEnabled(result.count(MapCheck::DuplicateObject) > 0);
+}
+
+
+void MapCheckDialog::removeDuplicates()
+{
+	if (controller->isEditingInProgress())
+		return;
+	
+	// The issues must refer to the current state of the map.
+	if (map->changeCount() != change_count)
+		runCheck();
+	
+	QApplication::setOverrideCursor(Qt::WaitCursor);
+	result.removeDuplicates(*map);
+	QApplication::restoreOverrideCursor();
+	runCheck();
+}
+
+
+void MapCheckDialog::showIssue(int row)
+{
+	if (row < 0 || row >= int(result.issues.size()) || controller->isEditingInProgress())
+		return;
+	
+	const auto& issue = result.issues[std::size_t(row)];
+	if (!exists(issue.object, issue.part) || (issue.other && !exists(issue.other, issue.part)))
+	{
+		summary_label->setText(tr("The map has been modified. Please run the check again."));
+		return;
+	}
+	
+	if (map->getCurrentPartIndex() != std::size_t(issue.part))
+		map->setCurrentPartIndex(std::size_t(issue.part));
+	
+	// The selection API is not const, but selecting doesn't modify the objects.
+	map->clearObjectSelection(false);
+	map->addObjectToSelection(const_cast<Object*>(issue.object), false);
+	if (issue.other)
+		map->addObjectToSelection(const_cast<Object*>(issue.other), false);
+	map->emitSelectionChanged();
+	controller->setEditTool();
+	
+	controller->getMainWidget()->ensureVisibilityOfRect(issue.extent, MapWidget::DiscreteZoom);
+}
+
+
+bool MapCheckDialog::exists(const Object* object, int part) const
+{
+	if (map->changeCount() == change_count)
+		return true;
+	
+	return part < map->getNumParts()
+	       && map->getPart(part)->existsObject([object](const Object* other) { return other == object; });
+}
+
+
+}  // namespace OpenOrienteering
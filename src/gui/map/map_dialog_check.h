@@ -0,0 +1,98 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#ifndef OPENORIENTEERING_MAP_DIALOG_CHECK_H
+#define OPENORIENTEERING_MAP_DIALOG_CHECK_H
+
+#include <QtGlobal>
+#include <QDialog>
+#include <QObject>
+#include <QString>
+
+#include "core/map_check.h"
+
+class QDoubleSpinBox;
+class QLabel;
+class QPushButton;
+class QTableWidget;
+class QWidget;
+
+namespace OpenOrienteering {
+
+class Map;
+class MapEditorController;
+class Object;
+
+
+/**
+ * Dialog for checking the map for topology errors.
+ * 
+ * The dialog runs a MapCheck and lists the issues. Selecting an issue
+ * selects the objects involved and moves the view to the issue.
+ * Duplicate objects can be removed all at once.
+ */
+class MapCheckDialog : public QDialog
+{
+Q_OBJECT
+public:
+	/** Creates a new MapCheckDialog. */
+	MapCheckDialog(QWidget* parent, MapEditorController* controller);
+	
+	~MapCheckDialog() override;
+	
+	/** Returns a human-readable description of the given type of issue. */
+	static QString description(MapCheck::IssueType type);
+	
+private slots:
+	/** Runs the check and updates the list of issues. */
+	void runCheck();
+	
+	/** Selects the objects of the issue in the given row, and shows them. */
+	void showIssue(int row);
+	
+	/** Deletes the duplicate objects, and runs the check again. */
+	void removeDuplicates();
+	
+private:
+	/**
+	 * Returns true if the object still exists in the map part.
+	 * 
+	 * The objects of the issues may be gone when the map has been modified
+	 * since the check.
+	 */
+	bool exists(const Object* object, int part) const;
+	
+	MapEditorController* controller;
+	Map* map;
+	
+	MapCheck result;
+	quint64 change_count = 0;
+	
+	QDoubleSpinBox* tolerance_edit;
+	QLabel* summary_label;
+	QTableWidget* issue_table;
+	QPushButton* remove_duplicates_button;
+};
+
+
+}  // namespace OpenOrienteering
+
+#endif
@@ -0,0 +1,229 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "map_dialog_memory.h"
+
+#include <Qt>
+#include <QAbstractItemView>
+#include <QDialogButtonBox>
+#include <QFormLayout>
+#include <QHeaderView>
+#include <QIcon>
+#include <QImage>
+#include <QLabel>
+#include <QLocale>
+#include <QPixmap>
+#include <QPushButton>
+#include <QStringList>
+#include <QTableWidget>
+#include <QTableWidgetItem>
+#include <QVBoxLayout>
+#include <QVariant>
+
+#include "core/map.h"
+#include "core/map_memory_statistics.h"
+#include "core/symbols/symbol.h"
+#include "templates/template.h"
+#include "gui/util_gui.h"
+
+
+namespace OpenOrienteering {
+
+namespace {
+
+/**
+ * A table item which shows a number of bytes, and sorts by the number.
+ */
+class BytesItem : public QTableWidgetItem
+{
+public:
+	explicit BytesItem(std::size_t bytes)
+	: QTableWidgetItem(MemoryStatisticsDialog::formatBytes(bytes))
+	{
+		setData(Qt::UserRole, QVariant::fromValue(qulonglong(bytes)));
+		setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+	}
+	
+	bool operator<(const QTableWidgetItem& other) const override
+	{
+		return data(Qt::UserRole).toULongLong() < other.data(Qt::UserRole).toULongLong();
+	}
+};
+
+
+/**
+ * A table item which shows an integer, and sorts by the number.
+ */
+class CountItem : public QTableWidgetItem
+{
+public:
+	explicit CountItem(int count)
+	: QTableWidgetItem(QLocale().toString(count))
+	{
+		setData(Qt::UserRole, count);
+		setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+	}
+	
+	bool operator<(const QTableWidgetItem& other) const override
+	{
+		return data(Qt::UserRole).toInt() < other.data(Qt::UserRole).toInt();
+	}
+};
+
+
+QTableWidget* createTable(const QStringList& labels)
+{
+	auto* table = new QTableWidget(0, labels.size());
+	table->setHorizontalHeaderLabels(labels);
+	table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+	table->setSelectionBehavior(QAbstractItemView::SelectRows);
+	table->verticalHeader()->setVisible(false);
+	table->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+	table->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
+	return table;
+}
+
+
+}  // namespace
+
+
+
+MemoryStatisticsDialog::MemoryStatisticsDialog(QWidget* parent, Map* map)
+: QDialog(parent, Qt::WindowSystemMenuHint | Qt::WindowTitleHint)
+, map(map)
+{
+	setWindowTitle(tr("Memory statistics"));
+	
+	auto* summary_layout = new QFormLayout();
+	summary_layout->addRow(Util::Headline::create(tr("Estimated memory usage")));
+	const QString categories[] = {
+	    tr("Objects:"),
+	    tr("Renderables:"),
+	    tr("Renderables index:"),
+	    tr("Undo history:"),
+	    tr("Templates:"),
+	    tr("Symbol icons:"),
+	    tr("Total:"),
+	};
+	for (const auto& category : categories)
+	{
+		auto* label = new QLabel();
+		label->setAlignment(Qt::AlignRight | Qt::AlignVCenter);
+		summary_layout->addRow(category, label);
+		summary_labels.push_back(label);
+	}
+	
+	symbol_table = createTable({ tr("Symbol"), tr("Objects"), tr("Object memory"), tr("Renderables"), tr("Icon"), tr("Total") });
+	template_table = createTable({ tr("Template"), tr("Memory") });
+	
+	auto* button_box = new QDialogButtonBox(QDialogButtonBox::Close, Qt::Horizontal);
+	auto* refresh_button = button_box->addButton(tr("Refresh"), QDialogButtonBox::ActionRole);
+	
+	auto* layout = new QVBoxLayout();
+	layout->addLayout(summary_layout);
+	layout->addItem(Util::SpacerItem::create(this));
+	layout->addWidget(Util::Headline::create(tr("Symbols")));
+	layout->addWidget(symbol_table, 3);
+	layout->addWidget(Util::Headline::create(tr("Templates")));
+	layout->addWidget(template_table, 1);
+	layout->addWidget(button_box);
+	setLayout(layout);
+	
+	connect(refresh_button, &QAbstractButton::clicked, this, &MemoryStatisticsDialog::refresh);
+	connect(button_box, &QDialogButtonBox::rejected, this, &QDialog::reject);
+	
+	resize(640, 560);
+	refresh();
+}
+
+MemoryStatisticsDialog::~MemoryStatisticsDialog() = default;
+
+
+
+// static
+QString MemoryStatisticsDialog::formatBytes(std::size_t bytes)
+{
+	// QLocale::formattedDataSize requires Qt 5.10.
+	auto const locale = QLocale();
+	if (bytes < 1024)
+		return tr("%1 B").arg(locale.toString(qulonglong(bytes)));
+	if (bytes < 1024 * 1024)
+		return tr("%1 KiB").arg(locale.toString(bytes / 1024.0, 'f', 1));
+	if (bytes < std::size_t(1024) * 1024 * 1024)
+		return tr("%1 MiB").arg(locale.toString(bytes / (1024.0 * 1024.0), 'f', 1));
+	return tr("%1 GiB").arg(locale.toString(bytes / (1024.0 * 1024.0 * 1024.0), 'f', 2));
+}
+
+
+
+void MemoryStatisticsDialog::refresh()
+{
+	map->updateObjects();
+	auto const statistics = MapMemoryStatistics::collect(*map);
+	
+	const std::size_t values[] = {
+	    statistics.objects,
+	    statistics.renderables,
+	    statistics.renderables_index,
+	    statistics.undo,
+	    statistics.templates,
+	    statistics.icons,
+	    statistics.total(),
+	};
+	Q_ASSERT(summary_labels.size() == sizeof(values) / sizeof(values[0]));
+	for (std::size_t i = 0; i < summary_labels.size(); ++i)
+		summary_labels[i]->setText(formatBytes(values[i]));
+	
+	symbol_table->setSortingEnabled(false);
+	symbol_table->setRowCount(int(statistics.symbols.size()));
+	auto row = 0;
+	for (const auto& usage : statistics.symbols)
+	{
+		auto* symbol_item = new QTableWidgetItem();
+		if (usage.symbol)
+		{
+			symbol_item->setText(usage.symbol->getNumberAsString() + QLatin1Char(' ') + usage.symbol->getPlainTextName());
+			symbol_item->setIcon(QPixmap::fromImage(usage.symbol->getIcon(map)));
+		}
+		symbol_table->setItem(row, 0, symbol_item);
+		symbol_table->setItem(row, 1, new CountItem(usage.num_objects));
+		symbol_table->setItem(row, 2, new BytesItem(usage.objects));
+		symbol_table->setItem(row, 3, new BytesItem(usage.renderables));
+		symbol_table->setItem(row, 4, new BytesItem(usage.icon));
+		symbol_table->setItem(row, 5, new BytesItem(usage.total()));
+		++row;
+	}
+	symbol_table->setSortingEnabled(true);
+	symbol_table->sortByColumn(5, Qt::DescendingOrder);
+	
+	template_table->setSortingEnabled(false);
+	template_table->setRowCount(int(statistics.template_usage.size()));
+	row = 0;
+	for (const auto& usage : statistics.template_usage)
+	{
+		template_table->setItem(row, 0, new QTableWidgetItem(usage.temp->getTemplateFilename()));
+		template_table->setItem(row, 1, new BytesItem(usage.bytes));
+		++row;
+	}
+	template_table->setSortingEnabled(true);
+}
+
+
+}  // namespace OpenOrienteering
@@ -0,0 +1,74 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef OPENORIENTEERING_MAP_DIALOG_MEMORY_H
+#define OPENORIENTEERING_MAP_DIALOG_MEMORY_H
+
+#include <cstddef>
+#include <vector>
+
+#include <QDialog>
+#include <QObject>
+#include <QString>
+
+class QLabel;
+class QTableWidget;
+class QWidget;
+
+namespace OpenOrienteering {
+
+class Map;
+
+
+/**
+ * Dialog showing an estimate of the memory used by a map.
+ * 
+ * The dialog lists the memory used by the objects, their renderables,
+ * the undo history, the templates and the symbol icons, and the memory
+ * used per symbol and per template.
+ */
+class MemoryStatisticsDialog : public QDialog
+{
+Q_OBJECT
+public:
+	/** Creates a new MemoryStatisticsDialog. */
+	MemoryStatisticsDialog(QWidget* parent, Map* map);
+	
+	~MemoryStatisticsDialog() override;
+	
+	/** Returns a human-readable representation of the given number of bytes. */
+	static QString formatBytes(std::size_t bytes);
+	
+private slots:
+	/** Collects the statistics again and updates the widgets. */
+	void refresh();
+	
+private:
+	Map* map;
+	
+	std::vector<QLabel*> summary_labels;
+	QTableWidget* symbol_table;
+	QTableWidget* template_table;
+};
+
+
+}  // namespace OpenOrienteering
+
+#endif
@@ -23,11 +23,14 @@
 #include "map_editor_p.h"
 
 #include <algorithm>
+#include <cmath>
 #include <cstddef>
 #include <functional>
 #include <iterator>
 #include <limits>
+#include <memory>
 #include <set>
+#include <utility>
 #include <vector>
 // IWYU pragma: no_include <type_traits>
 
@@ -41,11 +44,13 @@
 #include <QBuffer>
 #include <QByteArray>
 #include <QComboBox>
+#include <QDataStream>
 #include <QDate>
 #include <QDialog>
 #include <QDir>
 #include <QDockWidget>
 #include <QEvent>
+#include <QFile>
 #include <QFileInfo>
 #include <QFlags>
 #include <QFont>
@@ -72,9 +77,11 @@
 #include <QPainter>
 #include <QPixmap>
 #include <QPoint>
+#include <QProgressDialog>
 #include <QPushButton>
 #include <QRect>
 #include <QRectF>
+#include <QSaveFile>
 #include <QSettings>
 #include <QSignalBlocker>
 #include <QSignalMapper>
@@ -86,6 +93,7 @@
 #include <QStringList>
 #include <QTextEdit>
 #include <QToolBar>
+#include <QTransform>
 #include <QToolButton>
 #include <QVariant>
 #include <QVBoxLayout>
@@ -100,6 +108,7 @@
 #include "core/map.h"
 #include "core/map_coord.h"
 #include "core/map_part.h"
+#include "core/map_preview.h"
 #include "core/map_view.h"
 #include "core/objects/boolean_tool.h"
 #include "core/objects/object.h"
@@ -117,10 +126,13 @@
 #include "gui/print_widget.h"
 #include "gui/text_browser_dialog.h"
 #include "gui/util_gui.h"
+#include "gui/map/map_dialog_check.h"
+#include "gui/map/map_dialog_memory.h"
 #include "gui/map/map_dialog_rotate.h"
 #include "gui/map/map_dialog_scale.h"
 #include "gui/map/map_editor_activity.h"
 #include "gui/map/map_find_feature.h"
+#include "gui/map/map_tile_cache.h"
 #include "gui/map/map_widget.h"
 #include "gui/symbols/symbol_replacement.h"
 #include "gui/widgets/action_grid_bar.h"
@@ -163,6 +175,7 @@
 #include "undo/object_undo.h"
 #include "undo/undo.h"
 #include "undo/undo_manager.h"
+#include "util/background_file_writer.h"
 #include "util/backports.h" // IWYU pragma: keep
 
 #ifdef MAPPER_USE_GDAL
@@ -232,17 +245,6 @@ namespace {
 
 
 
-namespace MimeType {
-
-/// The MIME type of Mapper data
-QString OpenOrienteeringObjects()
-{
-	return QStringLiteral("openorienteering/objects");
-}
-
-
-}  // namespace MimeType
-
 
 
 // ### MapEditorController ###
@@ -266,6 +268,7 @@ MapEditorController::MapEditorController(OperatingMode mode, Map* map, MapView*
 	symbol_widget = nullptr;
 	window = nullptr;
 	editing_in_progress = false;
+	autosave_change_count = 0;
 	
 	cut_hole_menu = nullptr;
 	
@@ -462,6 +465,7 @@ void MapEditorController::setEditingInProgress(bool value)
 		scale_map_act->setEnabled(!editing_in_progress);
 		rotate_map_act->setEnabled(!editing_in_progress);
 		map_notes_act->setEnabled(!editing_in_progress);
+		map_check_act->setEnabled(!editing_in_progress);
 		
 		// Map menu, continued
 		const int num_parts = map->getNumParts();
@@ -577,17 +581,63 @@ bool MapEditorController::saveTo(const QString& path, const FileFormat& format)
 		return false;
 	}
 	
-	if (!exportTo(path, format))
+	QByteArray data;
+	if (!exportTo(path, format, &data))
 		return false;
 	
 	map->setHasUnsavedChanges(false);
 	map->undoManager().setClean();
-	window->showStatusBarMessage(tr("Map saved"), 1000);
+	save_preview = MapPreview::render(*map);
+	if (data.isNull())
+	{
+		MapPreview::store(path, save_preview, *map);
+		save_preview = {};
+		window->showStatusBarMessage(tr("Map saved"), 1000);
+		return true;
+	}
+	
+	// The serialized map is a snapshot: Editing may continue
+	// while it is written to the disk.
+	if (!save_writer)
+	{
+		save_writer = std::make_unique<BackgroundFileWriter>();
+		connect(save_writer.get(), &BackgroundFileWriter::finished, this, &MapEditorController::saveFinished);
+	}
+	save_writer->write(path, data);
+	window->showStatusBarMessage(tr("Saving..."), 0);
 	return true;
 }
 
 
+void MapEditorController::saveFinished(const QString& path, const QString& error_string)
+{
+	if (error_string.isEmpty())
+	{
+		if (map)
+			MapPreview::store(path, save_preview, *map);
+		save_preview = {};
+		if (window)
+			window->showStatusBarMessage(tr("Map saved"), 1000);
+		return;
+	}
+	
+	// The map's state on disk is unknown now.
+	save_preview = {};
+	if (map)
+		map->setOtherDirty();
+	if (window)
+		window->clearStatusBarMessage();
+	QMessageBox::warning(window, tr("Error"), tr("Cannot save file\n%1:\n%2").arg(path, error_string));
+}
+
+
 bool MapEditorController::exportTo(const QString& path, const FileFormat& format)
+{
+	return exportTo(path, format, nullptr);
+}
+
+
+bool MapEditorController::exportTo(const QString& path, const FileFormat& format, QByteArray* data)
 {
 	if (!map || editing_in_progress)
 		return false;
@@ -606,6 +656,16 @@ bool MapEditorController::exportTo(const QString& path, const FileFormat& format
 		return false;
 	}
 	
+	QBuffer buffer;
+#ifndef Q_OS_ANDROID
+	// On Android, the MediaScanner needs to be informed by the exporter.
+	if (data && exporter->supportsQIODevice())
+	{
+		buffer.open(QIODevice::WriteOnly);
+		exporter->setDevice(&buffer);
+	}
+#endif
+	
 	if (!exporter->doExport())
 	{
 		auto message = tr("Cannot save file\n%1:\n%2")
@@ -622,10 +682,63 @@ bool MapEditorController::exportTo(const QString& path, const FileFormat& format
 		                           exporter->warnings() );
 	}
 	
+	if (data && buffer.isOpen())
+		*data = buffer.data();
+	
 	return true;
 }
 
 
+Autosave::AutosaveResult MapEditorController::autosaveTo(const QString& path, const FileFormat& format)
+{
+	if (!map)
+		return Autosave::PermanentFailure;
+	
+	if (editing_in_progress || (autosave_writer && autosave_writer->isBusy()))
+		return Autosave::TemporaryFailure;
+	
+	if (path == autosave_path && map->changeCount() == autosave_change_count)
+		return Autosave::Success;  // nothing changed since the last autosave
+	
+	auto exporter = format.makeExporter(path, map, main_view);
+	if (!exporter || !exporter->supportsQIODevice())
+		return MainWindowController::autosaveTo(path, format);
+	
+	// Serialize the map to memory, and leave the slow part,
+	// writing to the disk, to a background thread.
+	QBuffer buffer;
+	buffer.open(QIODevice::WriteOnly);
+	exporter->setDevice(&buffer);
+	if (!exporter->doExport())
+		return Autosave::PermanentFailure;
+	
+	if (!autosave_writer)
+	{
+		autosave_writer = std::make_unique<BackgroundFileWriter>();
+		connect(autosave_writer.get(), &BackgroundFileWriter::finished, this, [this](const QString& path, const QString& error_string) {
+			if (error_string.isEmpty())
+				return;
+			if (path == autosave_path)
+				autosave_path.clear();  // Don't skip the next attempt.
+			if (window)
+				window->showStatusBarMessage(::OpenOrienteering::MainWindow::tr("Autosaving failed!"), 6000);
+		});
+	}
+	autosave_writer->write(path, buffer.data());
+	autosave_path = path;
+	autosave_change_count = map->changeCount();
+	
+	return Autosave::Success;
+}
+
+
+void MapEditorController::finishAutosave()
+{
+	if (autosave_writer)
+		autosave_writer->waitForFinished();
+}
+
+
 bool MapEditorController::loadFrom(const QString& path, const FileFormat& format, QWidget* dialog_parent)
 {
 	if (!dialog_parent)
@@ -651,7 +764,22 @@ bool MapEditorController::loadFrom(const QString& path, const FileFormat& format
 		return false;
 	}
 	
-	if (!importer->doImport())
+	// Loading large maps takes a while. QProgressDialog::setValue() processes
+	// events for modal dialogs, so the application stays responsive.
+	QProgressDialog progress(dialog_parent);
+	progress.setWindowModality(Qt::ApplicationModal);
+	progress.setLabelText(tr("Loading %1...").arg(QFileInfo(path).fileName()));
+	progress.setCancelButton(nullptr);
+	progress.setAutoReset(false);
+	importer->setProgressHandler([&progress](int percent) { progress.setValue(percent); });
+	// Don't wait for slow templates, e.g. from network drives.
+	importer->setLoadTemplatesInBackground(true);
+	
+	auto const imported = importer->doImport();
+	importer->setProgressHandler({});
+	progress.reset();
+	
+	if (!imported)
 	{
 		delete map;
 		map = nullptr;
@@ -664,6 +792,8 @@ bool MapEditorController::loadFrom(const QString& path, const FileFormat& format
 	
 	setMapAndView(map, main_view);
 	map->setHasUnsavedChanges(false);
+	if (mode == MapEditor)
+		restoreViewTiles(path);
 	if (!importer->warnings().empty())
 		MainWindow::showMessageBox(dialog_parent, tr("Warning"), tr("The map import generated warnings."), importer->warnings());
 	return true;
@@ -783,6 +913,8 @@ void MapEditorController::attach(MainWindow* window)
 	// ... and make sure it is kept up to date for copy/paste
 	connect(QApplication::clipboard(), &QClipboard::changed, this, &MapEditorController::clipboardChanged);
 	clipboardChanged(QClipboard::Clipboard);
+	connect(&Settings::getInstance(), &Settings::settingsChanged, this, &MapEditorController::updatePatternClipping);
+	updatePatternClipping();
 	
 	if (mode == MapEditor)
 	{
@@ -980,6 +1112,8 @@ void MapEditorController::createActions()
 	scale_map_act = newAction("scalemap", tr("Change map scale..."), this, SLOT(scaleMapClicked()), "tool-scale.png", tr("Change the map scale and adjust map objects and symbol sizes"), "map_menu.html");
 	rotate_map_act = newAction("rotatemap", tr("Rotate map..."), this, SLOT(rotateMapClicked()), "tool-rotate.png", tr("Rotate the whole map"), "map_menu.html");
 	map_notes_act = newAction("mapnotes", tr("Map notes..."), this, SLOT(mapNotesClicked()), nullptr, QString{}, "map_menu.html");
+	memory_statistics_act = newAction("memorystatistics", tr("Memory statistics..."), this, SLOT(memoryStatisticsClicked()), nullptr, QString{}, "map_menu.html");
+	map_check_act = newAction("checkmap", tr("Check map..."), this, SLOT(mapCheckClicked()), nullptr, tr("Find gaps, overlapping areas, unclosed areas and dangling lines"), "map_menu.html");
 	
 	template_window_act = newCheckAction("templatewindow", tr("Template setup window"), this, SLOT(showTemplateWindow(bool)), "templates", tr("Show/Hide the template window"), "templates_menu.html");
 	//QAction* template_config_window_act = newCheckAction("templateconfigwindow", tr("Template configurations window"), this, SLOT(showTemplateConfigurationsWindow(bool)), "window-new", tr("Show/Hide the template configurations window"));
@@ -1213,6 +1347,8 @@ void MapEditorController::createMenuAndToolbars()
 	map_menu->addAction(scale_map_act);
 	map_menu->addAction(rotate_map_act);
 	map_menu->addAction(map_notes_act);
+	map_menu->addAction(memory_statistics_act);
+	map_menu->addAction(map_check_act);
 	map_menu->addSeparator();
 	updateMapPartsUI();
 	map_menu->addAction(mappart_add_act);
@@ -1398,9 +1534,9 @@ void MapEditorController::createMobileGUI()
 	connect(hide_symbol_action, &QAction::triggered, this, [this](bool value) {
 		auto* symbol = symbol_widget->getSingleSelectedSymbol();
 		symbol->setHidden(value);
-		if (!value && map->removeSymbolFromSelection(symbol, false))
+		if (value && map->removeSymbolFromSelection(symbol, false))
 		    map->emitSelectionChanged();
-		map->updateAllMapWidgets();
+		map->setObjectsWithSymbolAreaDirty(symbol);
 		map->setSymbolsDirty();
 		selectedSymbolsChanged();
 	});
@@ -1409,7 +1545,7 @@ void MapEditorController::createMobileGUI()
 	connect(protected_symbol_action, &QAction::triggered, this, [this](bool value) {
 		auto* symbol = symbol_widget->getSingleSelectedSymbol();
 		symbol->setProtected(value);
-		if (!value && map->removeSymbolFromSelection(symbol, false))
+		if (value && map->removeSymbolFromSelection(symbol, false))
 		    map->emitSelectionChanged();
 		map->setSymbolsDirty();
 		selectedSymbolsChanged();
@@ -1589,11 +1725,19 @@ void MapEditorController::createMobileGUI()
 
 void MapEditorController::detach()
 {
+	// Report the result of a pending save while the window still exists.
+	if (save_writer)
+	{
+		save_writer->waitForFinished();
+		QCoreApplication::sendPostedEvents(this, QEvent::MetaCall);
+	}
+	
 	// Terminate all editing
 	setTool(nullptr);
 	setOverrideTool(nullptr);
 	
 	saveWindowState();
+	saveViewTiles();
 	
 	// Avoid a crash triggered by pressing Ctrl-W during loading.
 	if (nullptr != symbol_dock_widget)
@@ -1649,6 +1793,53 @@ void MapEditorController::saveWindowState()
 	}
 }
 
+void MapEditorController::saveViewTiles()
+{
+	auto const path = window->currentPath();
+	if (mode != MapEditor || !map || !main_view || path.isEmpty() || map->hasUnsavedChanges())
+		return;
+	
+	auto const tiles_path = MapTileCache::persistentPath(path);
+	if (!QDir().mkpath(QFileInfo(tiles_path).absolutePath()))
+		return;
+	
+	QSaveFile file(tiles_path);
+	if (!file.open(QIODevice::WriteOnly))
+		return;
+	
+	QDataStream stream(&file);
+	stream.setVersion(QDataStream::Qt_5_6);
+	auto const center = main_view->center();
+	stream << qint32(center.nativeX()) << qint32(center.nativeY())
+	       << main_view->getZoom() << main_view->getRotation();
+	if (stream.status() == QDataStream::Ok
+	    && map->getTileCache().saveLevel(file, MapTileCache::persistentKey(path)))
+		file.commit();
+	
+	MapTileCache::prunePersistentTiles();
+}
+
+void MapEditorController::restoreViewTiles(const QString& path)
+{
+	QFile file(MapTileCache::persistentPath(path));
+	if (!file.open(QIODevice::ReadOnly))
+		return;
+	
+	QDataStream stream(&file);
+	stream.setVersion(QDataStream::Qt_5_6);
+	qint32 center_x, center_y;
+	double zoom, rotation;
+	stream >> center_x >> center_y >> zoom >> rotation;
+	if (stream.status() != QDataStream::Ok
+	    || !map->getTileCache().restoreLevel(file, MapTileCache::persistentKey(path)))
+		return;
+	
+	// The tiles match this view.
+	main_view->setZoom(zoom);
+	main_view->setRotation(rotation);
+	main_view->setCenter(MapCoord::fromNative(center_x, center_y));
+}
+
 void MapEditorController::restoreWindowState()
 {
 	if (!mobile_mode && mode != SymbolEditor)
@@ -1798,7 +1989,8 @@ void MapEditorController::copy()
 		return;
 	
 	// Create map containing required objects and their symbol and color dependencies
-	Map copy_map;
+	auto shared_copy_map = std::make_shared<Map>();
+	auto& copy_map = *shared_copy_map;
 	copy_map.setScaleDenominator(map->getScaleDenominator());
 	
 	std::vector<bool> symbol_filter;
@@ -1826,18 +2018,8 @@ void MapEditorController::copy()
 		copy_map.addObject(new_object);
 	}
 	
-	// Save map to memory
-	QBuffer buffer;
-	if (!copy_map.exportToIODevice(buffer))
-	{
-		QMessageBox::warning(nullptr, tr("Error"), tr("An internal error occurred, sorry!"));
-		return;
-	}
-	
-	// Put buffer into clipboard
-	auto* mime_data = new QMimeData();
-	mime_data->setData(MimeType::OpenOrienteeringObjects(), buffer.data());
-	QApplication::clipboard()->setMimeData(mime_data);
+	// Put map into clipboard. It is serialized only when requested by another process.
+	QApplication::clipboard()->setMimeData(new MapObjectsMimeData(std::move(shared_copy_map)));
 	
 	// Show message
 	window->showStatusBarMessage(tr("Copied %n object(s)", nullptr, map->getNumSelectedObjects()), 2000);
@@ -1848,20 +2030,47 @@ void MapEditorController::paste()
 {
 	if (editing_in_progress)
 		return;
-	if (!QApplication::clipboard()->mimeData()->hasFormat(MimeType::OpenOrienteeringObjects()))
+	auto const* mime_data = QApplication::clipboard()->mimeData();
+	if (!MapObjectsMimeData::hasMapObjects(mime_data))
 	{
 		QMessageBox::warning(nullptr, tr("Error"), tr("There are no objects in clipboard which could be pasted!"));
 		return;
 	}
 	
-	// Get buffer from clipboard
-	QByteArray byte_array = QApplication::clipboard()->mimeData()->data(MimeType::OpenOrienteeringObjects());
+	// Objects copied in this process are imported directly from the shared map,
+	// unless the scale question of importMap() needs a private copy.
+	auto const* objects_data = qobject_cast<const MapObjectsMimeData*>(mime_data);
+	if (objects_data
+	    && objects_data->map()->getScaleDenominator() == map->getScaleDenominator())
+	{
+		auto const& source_map = *objects_data->map();
+		QRectF paste_extent = source_map.calculateExtent(true, false, nullptr);
+		auto offset = main_view->center() - paste_extent.center();
+		map->importMap(source_map, Map::MinimalObjectImport, QTransform::fromTranslate(offset.x(), offset.y()));
+		window->showStatusBarMessage(tr("Pasted %n object(s)", nullptr, source_map.getNumObjects()), 2000);
+		return;
+	}
+	
+	// Get buffer from clipboard, preferring the compact format
+	auto const binary = mime_data->hasFormat(MapObjectsMimeData::binaryFormat());
+	QByteArray byte_array = mime_data->data(binary ? MapObjectsMimeData::binaryFormat() : MapObjectsMimeData::xmlFormat());
 	QBuffer buffer(&byte_array);
 	buffer.open(QIODevice::ReadOnly);
 	
 	// Create map from buffer
 	Map paste_map;
-	if (!paste_map.importFromIODevice(buffer))
+	auto success = false;
+	if (binary)
+	{
+		auto importer = FileFormats.findFormat("Binary")->makeImporter({}, &paste_map, nullptr);
+		importer->setDevice(&buffer);
+		success = importer->doImport();
+	}
+	else
+	{
+		success = paste_map.importFromIODevice(buffer);
+	}
+	if (!success)
 	{
 		QMessageBox::warning(nullptr, tr("Error"), tr("An internal error occurred, sorry!"));
 		return;
@@ -2141,6 +2350,22 @@ void MapEditorController::mapNotesClicked()
 	}
 }
 
+void MapEditorController::memoryStatisticsClicked()
+{
+	MemoryStatisticsDialog dialog(window, map);
+	dialog.setWindowModality(Qt::WindowModal);
+	dialog.exec();
+}
+
+void MapEditorController::mapCheckClicked()
+{
+	if (!map_check_dialog)
+		map_check_dialog = new MapCheckDialog(window, this);
+	map_check_dialog->show();
+	map_check_dialog->raise();
+	map_check_dialog->activateWindow();
+}
+
 void MapEditorController::createTemplateWindow()
 {
 	Q_ASSERT(!template_dock_widget);
@@ -2589,12 +2814,21 @@ void MapEditorController::updatePasteAvailability()
 	if (paste_act)
 	{
 		paste_act->setEnabled(
-			QApplication::clipboard()->mimeData()
-			&& QApplication::clipboard()->mimeData()->hasFormat(MimeType::OpenOrienteeringObjects())
+			MapObjectsMimeData::hasMapObjects(QApplication::clipboard()->mimeData())
 			&& !editing_in_progress);
 	}
 }
 
+void MapEditorController::updatePatternClipping()
+{
+	auto const enabled = Settings::getInstance().getSettingCached(Settings::MapDisplay_GeometricPatternClipping).toBool();
+	if (map->isGeometricPatternClippingEnabled() != enabled)
+	{
+		map->setGeometricPatternClippingEnabled(enabled);
+		map->applyOnMatchingObjects(&Object::forceUpdate, ObjectOp::ContainsSymbolType{Symbol::Area});
+	}
+}
+
 void MapEditorController::showWholeMap()
 {
 	QRectF map_extent = map->calculateExtent(true, !main_view->areAllTemplatesHidden(), main_view);
@@ -2870,13 +3104,19 @@ void MapEditorController::selectObjectsClicked(bool select_exclusively)
 
 	bool object_selected = false;	
 	MapPart* part = map->getCurrentPart();
-	for (int i = 0, size = part->getNumObjects(); i < size; ++i)
+	for (int i = 0, size = map->getNumSymbols(); i < size; ++i)
 	{
-		Object* object = part->getObject(i);
-		if (symbol_widget->isSymbolSelected(object->getSymbol()) && !(!select_exclusively && map->isObjectSelected(object)))
+		const Symbol* symbol = map->getSymbol(i);
+		if (!symbol_widget->isSymbolSelected(symbol))
+			continue;
+		
+		for (Object* object : part->objectsWithSymbol(symbol))
 		{
-			map->addObjectToSelection(object, false);
-			object_selected = true;
+			if (!(!select_exclusively && map->isObjectSelected(object)))
+			{
+				map->addObjectToSelection(object, false);
+				object_selected = true;
+			}
 		}
 	}
 	
@@ -2900,13 +3140,19 @@ void MapEditorController::deselectObjectsClicked()
 	bool selection_changed = false;
 	
 	MapPart* part = map->getCurrentPart();
-	for (int i = 0, size = part->getNumObjects(); i < size; ++i)
+	for (int i = 0, size = map->getNumSymbols(); i < size; ++i)
 	{
-		Object* object = part->getObject(i);
-		if (symbol_widget->isSymbolSelected(object->getSymbol()) && map->isObjectSelected(object))
+		const Symbol* symbol = map->getSymbol(i);
+		if (!symbol_widget->isSymbolSelected(symbol))
+			continue;
+		
+		for (Object* object : part->objectsWithSymbol(symbol))
 		{
-			map->removeObjectFromSelection(object, false);
-			selection_changed = true;
+			if (map->isObjectSelected(object))
+			{
+				map->removeObjectFromSelection(object, false);
+				selection_changed = true;
+			}
 		}
 	}
 	
@@ -3265,7 +3511,22 @@ void MapEditorController::measureClicked(bool checked)
 
 void MapEditorController::booleanUnionClicked()
 {
-	if (!BooleanTool(BooleanTool::Union, map).executePerSymbol())
+	// Uniting many objects takes a while. The dialog is shown only
+	// after its minimum duration.
+	QProgressDialog progress(window);
+	progress.setWindowModality(Qt::ApplicationModal);
+	progress.setLabelText(tr("Uniting areas..."));
+	progress.setAutoReset(false);
+	
+	BooleanTool tool(BooleanTool::Union, map);
+	tool.setProgressHandler([&progress](int percent) {
+		progress.setValue(percent);
+		return !progress.wasCanceled();
+	});
+	auto const changed = tool.executePerSymbol();
+	progress.reset();
+	
+	if (!changed && !tool.wasCanceled())
 		QMessageBox::warning(window, tr("Error"), tr("Unification failed."));
 }
 
@@ -3378,28 +3639,27 @@ void MapEditorController::distributePointsClicked()
 		return;
 	
 	// Create points along paths
-	std::vector<PointObject*> created_objects;
+	std::vector<const PathObject*> paths;
 	for (const auto* object : map->selectedObjects())
 	{
 		if (object->getType() == Object::Path)
-			DistributePointsTool::execute(object->asPath(), point, settings, created_objects);
+			paths.push_back(object->asPath());
 	}
+	std::vector<Object*> created_objects;
+	DistributePointsTool::execute(paths, point, settings, created_objects);
 	if (created_objects.empty())
 		return;
 	
-	// Add points to map
-	for (auto* o : created_objects)
-		map->addObject(o);
+	// Add points to map, in a single batch
+	auto const first_index = map->addObjects(created_objects);
 	
 	// Create undo step and select new objects
 	map->clearObjectSelection(false);
-	MapPart* part = map->getCurrentPart();
 	auto* delete_step = new DeleteObjectsUndoStep(map);
 	for (std::size_t i = 0; i < created_objects.size(); ++i)
 	{
-		Object* object = created_objects[i];
-		delete_step->addObject(part->findObjectIndex(object));
-		map->addObjectToSelection(object, i == created_objects.size() - 1);
+		delete_step->addObject(first_index + int(i));
+		map->addObjectToSelection(created_objects[i], i == created_objects.size() - 1);
 	}
 	map->push(delete_step);
 	map->setObjectsDirty();
@@ -3634,8 +3894,12 @@ void MapEditorController::alignMapWithNorthUpdate()
 	if (map_widget->getTimeSinceLastInteraction() < interaction_time_threshold)
 		return;
 	
-	// Set map rotation
-	main_view->setRotation(M_PI / -180.0 * Compass::getInstance().getCurrentAzimuth());
+	// Set map rotation, unless the change is too small to justify
+	// redrawing the whole map.
+	const auto min_rotation_change = qDegreesToRadians(1.0);
+	const auto rotation = M_PI / -180.0 * Compass::getInstance().getCurrentAzimuth();
+	if (std::abs(std::remainder(rotation - main_view->getRotation(), 2 * M_PI)) >= min_rotation_change)
+		main_view->setRotation(rotation);
 }
 
 void MapEditorController::hideTopActionBar()
@@ -4144,7 +4408,46 @@ bool MapEditorController::importOgrFile(const QString& filename)
 {
 #if MAPPER_USE_GDAL
 	OgrTemplate ogr_template {filename, map};
-	if (!ogr_template.configureAndLoad(window, main_view))
+	
+	// Large data sets are often needed only for the area of interest.
+	const auto& georef = map->getGeoreferencing();
+	if (georef.isValid() && !georef.isLocal()
+	    && QFileInfo(filename).size() > 32 * 1024 * 1024)
+	{
+		QMessageBox message_box(QMessageBox::Question, tr("Import %1").arg(QFileInfo(filename).fileName()),
+		                        tr("This is a large file. Do you want to import only the features in a particular area?"),
+		                        QMessageBox::NoButton, window);
+		auto* view_button = message_box.addButton(tr("Visible area"), QMessageBox::AcceptRole);
+		QAbstractButton* selection_button = nullptr;
+		if (map->getNumSelectedObjects() > 0)
+			selection_button = message_box.addButton(tr("Selected objects"), QMessageBox::AcceptRole);
+		auto* all_button = message_box.addButton(tr("Everything"), QMessageBox::AcceptRole);
+		message_box.setDefaultButton(all_button);
+		message_box.exec();
+		if (message_box.clickedButton() == view_button)
+		{
+			ogr_template.setImportArea(main_view->calculateViewedRect(map_widget->viewportToView(map_widget->rect())));
+		}
+		else if (selection_button && message_box.clickedButton() == selection_button)
+		{
+			QRectF area;
+			map->includeSelectionRect(area);
+			ogr_template.setImportArea(area);
+		}
+	}
+	
+	QProgressDialog progress(window);
+	progress.setWindowModality(Qt::ApplicationModal);
+	progress.setLabelText(tr("Importing %1...").arg(QFileInfo(filename).fileName()));
+	progress.setCancelButton(nullptr);
+	progress.setAutoReset(false);
+	progress.setMinimumDuration(500);
+	progress.reset();  // Not to be shown during the configuration dialogs
+	ogr_template.setImportProgressHandler([&progress](int percent) { progress.setValue(percent); });
+	auto const loaded = ogr_template.configureAndLoad(window, main_view);
+	ogr_template.setImportProgressHandler({});
+	progress.reset();
+	if (!loaded)
 		return false;
 	
 	auto template_map = ogr_template.takeTemplateMap();
@@ -4334,4 +4637,72 @@ void MapEditorToolAction::triggeredImpl(bool checked)
 }
 
 
+
+// ### MapObjectsMimeData ###
+
+QString MapObjectsMimeData::binaryFormat()
+{
+	return QStringLiteral("openorienteering/objects-binary");
+}
+
+QString MapObjectsMimeData::xmlFormat()
+{
+	return QStringLiteral("openorienteering/objects");
+}
+
+bool MapObjectsMimeData::hasMapObjects(const QMimeData* mime_data)
+{
+	return mime_data
+	       && (mime_data->hasFormat(binaryFormat()) || mime_data->hasFormat(xmlFormat()));
+}
+
+
+MapObjectsMimeData::MapObjectsMimeData(std::shared_ptr<const Map> map)
+: copied_map(std::move(map))
+{
+	// nothing else
+}
+
+MapObjectsMimeData::~MapObjectsMimeData() = default;
+
+
+QStringList MapObjectsMimeData::formats() const
+{
+	return { binaryFormat(), xmlFormat() };
+}
+
+bool MapObjectsMimeData::hasFormat(const QString& mime_type) const
+{
+	return mime_type == binaryFormat() || mime_type == xmlFormat();
+}
+
+
+QVariant MapObjectsMimeData::retrieveData(const QString& mime_type, QVariant::Type type) const
+{
+	if (mime_type == binaryFormat())
+	{
+		if (binary_data.isEmpty())
+		{
+			QBuffer buffer(&binary_data);
+			auto exporter = FileFormats.findFormat("Binary")->makeExporter({}, copied_map.get(), nullptr);
+			exporter->setDevice(&buffer);
+			if (!exporter->doExport())
+				binary_data.clear();
+		}
+		return binary_data;
+	}
+	if (mime_type == xmlFormat())
+	{
+		if (xml_data.isEmpty())
+		{
+			QBuffer buffer(&xml_data);
+			if (!copied_map->exportToIODevice(buffer))
+				xml_data.clear();
+		}
+		return xml_data;
+	}
+	return QMimeData::retrieveData(mime_type, type);
+}
+
+
 }  // namespace OpenOrienteering
@@ -27,6 +27,7 @@
 
 #include <QClipboard>
 #include <QHash>
+#include <QImage>
 #include <QObject>
 #include <QPointer>
 #include <QScopedPointer>
@@ -53,6 +54,7 @@ class QWidget;
 namespace OpenOrienteering {
 
 class ActionGridBar;
+class BackgroundFileWriter;
 class CompassDisplay;
 class EditorDockWidget;
 class FileFormat;
@@ -61,6 +63,7 @@ class GPSTemporaryMarkers;
 class GPSTrackRecorder;
 class GeoreferencingDialog;
 class MainWindow;
+class MapCheckDialog;
 class MapEditorActivity;
 class MapEditorTool;
 class MapFindFeature;
@@ -239,6 +242,10 @@ public:
 	/** Override from MainWindowController */
 	bool exportTo(const QString& path, const FileFormat& format) override;
 	/** Override from MainWindowController */
+	Autosave::AutosaveResult autosaveTo(const QString& path, const FileFormat& format) override;
+	/** Override from MainWindowController */
+	void finishAutosave() override;
+	/** Override from MainWindowController */
 	bool loadFrom(const QString& path, const FileFormat& format, QWidget* dialog_parent = nullptr) override;
 	
 	/** Override from MainWindowController */
@@ -334,6 +341,10 @@ public slots:
 	void rotateMapClicked();
 	/** Shows the dialog to enter map notes. */
 	void mapNotesClicked();
+	/** Shows the MemoryStatisticsDialog. */
+	void memoryStatisticsClicked();
+	/** Shows the MapCheckDialog. */
+	void mapCheckClicked();
 	
 	/** Shows or hides the template setup dock widget. */
 	void showTemplateWindow(bool show);
@@ -369,6 +380,9 @@ public slots:
 	/** Adjusts the enabled state of the paste action. */
 	void updatePasteAvailability();
 	
+	/** Applies the pattern clipping setting to the map, updating areas when it changes. */
+	void updatePatternClipping();
+	
 	/**
 	 * Checks the presence of spot colors,
 	 * and to disables overprinting simulation if there are no spot colors.
@@ -588,6 +602,23 @@ private:
 	 */
 	void restoreWindowState();
 	
+	/**
+	 * Saves the view and the current map tiles to the cache directory.
+	 * 
+	 * This does nothing when the map has unsaved changes, because the tiles
+	 * must match the content of the map file.
+	 */
+	void saveViewTiles();
+	
+	/**
+	 * Restores the view and the map tiles saved for the given map file.
+	 * 
+	 * This does nothing when the file was modified since the tiles were
+	 * saved. Otherwise the last view of the map is shown immediately,
+	 * without rendering it first.
+	 */
+	void restoreViewTiles(const QString& path);
+	
 signals:
 	/**
 	 * @brief Indicates a change of the active symbol.
@@ -643,6 +674,18 @@ protected slots:
 private:
 	void setMapAndView(Map* map, MapView* map_view);
 	
+	/**
+	 * Exports the map to a file, or to memory.
+	 * 
+	 * If data is not nullptr and the format supports it, the exported file
+	 * is not written to the disk but returned in data. Otherwise data is
+	 * left unchanged.
+	 */
+	bool exportTo(const QString& path, const FileFormat& format, QByteArray* data);
+	
+	/** Reports the result of writing a saved file in the background. */
+	void saveFinished(const QString& path, const QString& error_string);
+	
 	/// Updates enabled state of all widgets
 	void updateWidgets();
 	
@@ -684,6 +727,12 @@ private:
 	
 	bool editing_in_progress;
 	
+	std::unique_ptr<BackgroundFileWriter> save_writer;
+	QImage save_preview;            ///< The preview to be stored when saving finished
+	std::unique_ptr<BackgroundFileWriter> autosave_writer;
+	QString autosave_path;          ///< The path of the last successful autosave
+	quint64 autosave_change_count;  ///< The map's change count at the last autosave
+	
 	// Action handling
 	QHash<QByteArray, QAction*> actionsById;
 	
@@ -734,6 +783,9 @@ private:
 	QAction* scale_map_act;
 	QAction* rotate_map_act;
 	QAction* map_notes_act;
+	QAction* memory_statistics_act;
+	QAction* map_check_act;
+	QPointer<MapCheckDialog> map_check_dialog;
 	QAction* symbol_set_id_act;
 	
 	QAction* color_window_act;
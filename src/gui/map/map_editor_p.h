@@ -22,8 +22,14 @@
 #ifndef OPENORIENTEERING_MAP_EDITOR_P_H
 #define OPENORIENTEERING_MAP_EDITOR_P_H
 
+#include <memory>
+
 #include <QAction>
+#include <QByteArray>
 #include <QDockWidget>
+#include <QMimeData>
+#include <QStringList>
+#include <QVariant>
 
 class QEvent;
 class QIcon;
@@ -35,6 +41,7 @@ class QWidget;
 
 namespace OpenOrienteering {
 
+class Map;
 class MapEditorController;
 class Template;
 
@@ -82,6 +89,49 @@ private slots:
 };
 
 
+
+/**
+ * Clipboard data for copied map objects.
+ * 
+ * The copied objects, symbols and colors are held in a map which is shared
+ * with every paste in this process. The serialized representations for other
+ * processes are created only when they are requested: a compact binary
+ * format, and the XML format which is understood by older versions.
+ */
+class MapObjectsMimeData : public QMimeData
+{
+Q_OBJECT
+public:
+	/** The MIME type of the binary representation. */
+	static QString binaryFormat();
+	
+	/** The MIME type of the XML representation. */
+	static QString xmlFormat();
+	
+	/** Returns true if the data holds map objects in any representation. */
+	static bool hasMapObjects(const QMimeData* mime_data);
+	
+	
+	explicit MapObjectsMimeData(std::shared_ptr<const Map> map);
+	~MapObjectsMimeData() override;
+	
+	/** Returns the map holding the copied objects. */
+	const std::shared_ptr<const Map>& map() const { return copied_map; }
+	
+	QStringList formats() const override;
+	
+	bool hasFormat(const QString& mime_type) const override;
+	
+protected:
+	QVariant retrieveData(const QString& mime_type, QVariant::Type type) const override;
+	
+private:
+	std::shared_ptr<const Map> copied_map;
+	mutable QByteArray binary_data;
+	mutable QByteArray xml_data;
+};
+
+
 }  // namespace OpenOrienteering
 
 #endif
@@ -226,7 +226,7 @@ void MapFindFeature::findAll()
 	
 	map->getCurrentPart()->applyOnMatchingObjects([map](Object* object) {
 		map->addObjectToSelection(object, false);
-	}, std::cref(query));
+	}, query);
 	map->emitSelectionChanged();
 	controller.getWindow()->showStatusBarMessage(OpenOrienteering::TagSelectWidget::tr("%n object(s) selected", nullptr, map->getNumSelectedObjects()), 2000);
 	
@@ -0,0 +1,506 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "map_tile_cache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <utility>
+
+#include <QByteArray>
+#include <QColor>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QIODevice>
+#include <QLatin1Char>
+#include <QLatin1String>
+#include <QPainter>
+#include <QRectF>
+#include <QSize>
+#include <QStandardPaths>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+
+#include "mapper_config.h"
+#include "settings.h"
+#include "util/concurrency.h"
+
+
+namespace OpenOrienteering {
+
+namespace {
+
+/**
+ * The fractional part of the translation is snapped to this fraction
+ * of a pixel, so that panning by whole pixels selects the same level.
+ */
+constexpr qreal subpixel_steps = 16;
+
+qint64 imageBytes(const QImage& image)
+{
+	return qint64(image.bytesPerLine()) * image.height();
+}
+
+/**
+ * Levels with a resolution differing by more than this factor are not used
+ * for previews.
+ */
+constexpr qreal max_preview_scale_factor = 8;
+
+qreal linearScale(const QTransform& transform)
+{
+	return std::sqrt(std::abs(transform.determinant()));
+}
+
+int floorDiv(int value, int divisor)
+{
+	return (value >= 0) ? value / divisor : -((-value + divisor - 1) / divisor);
+}
+
+/** Identifies the data written by MapTileCache::saveLevel(). */
+constexpr quint32 persistent_magic = 0x4d544331;  // "MTC1"
+
+/** The compression level for saved tiles: fast, sufficient for flat colors. */
+constexpr int persistent_compression = 1;
+
+}  // namespace
+
+
+
+MapTileCache::MapTileCache(qint64 max_bytes)
+: max_bytes(max_bytes)
+{
+	cache_registration = CacheManager::add({
+		[this]() { return bytes; },
+		[this](CacheManager::TrimLevel level) { trim(level); }
+	});
+}
+
+MapTileCache::~MapTileCache() = default;
+
+
+QPoint MapTileCache::setLevel(const QTransform& map_to_viewport, int flags)
+{
+	auto origin_x = std::floor(map_to_viewport.dx());
+	auto origin_y = std::floor(map_to_viewport.dy());
+	auto fraction_x = std::round((map_to_viewport.dx() - origin_x) * subpixel_steps) / subpixel_steps;
+	auto fraction_y = std::round((map_to_viewport.dy() - origin_y) * subpixel_steps) / subpixel_steps;
+	if (fraction_x >= 1)
+	{
+		fraction_x = 0;
+		origin_x += 1;
+	}
+	if (fraction_y >= 1)
+	{
+		fraction_y = 0;
+		origin_y += 1;
+	}
+
+	current_transform = QTransform(map_to_viewport.m11(), map_to_viewport.m12(),
+	                               map_to_viewport.m21(), map_to_viewport.m22(),
+	                               fraction_x, fraction_y);
+
+	levels.erase(std::remove_if(begin(levels), end(levels), [](const Level& l) {
+		return l.tiles.empty();
+	}), end(levels));
+
+	auto level = std::find_if(begin(levels), end(levels), [this, flags](const Level& l) {
+		// Exact comparison: QTransform::operator== is too fuzzy for tiles.
+		return l.flags == flags
+		       && l.transform.m11() == current_transform.m11()
+		       && l.transform.m12() == current_transform.m12()
+		       && l.transform.m21() == current_transform.m21()
+		       && l.transform.m22() == current_transform.m22()
+		       && l.transform.dx() == current_transform.dx()
+		       && l.transform.dy() == current_transform.dy();
+	});
+	if (level == end(levels))
+	{
+		levels.push_back({ current_transform, flags, {} });
+		level = std::prev(end(levels));
+	}
+	current = std::size_t(std::distance(begin(levels), level));
+
+	return { int(origin_x), int(origin_y) };
+}
+
+
+// static
+QRect MapTileCache::tileRange(const QRect& level_rect)
+{
+	return QRect(QPoint(floorDiv(level_rect.left(), tile_size), floorDiv(level_rect.top(), tile_size)),
+	             QPoint(floorDiv(level_rect.right(), tile_size), floorDiv(level_rect.bottom(), tile_size)));
+}
+
+// static
+QRect MapTileCache::tileRect(int x, int y)
+{
+	return { x * tile_size, y * tile_size, tile_size, tile_size };
+}
+
+
+QImage MapTileCache::tile(int x, int y)
+{
+	if (current >= levels.size())
+		return {};
+
+	auto& tiles = levels[current].tiles;
+	auto tile = tiles.find(key(x, y));
+	if (tile == tiles.end())
+		return {};
+
+	tile->second.last_use = ++use_counter;
+	return tile->second.image;
+}
+
+
+void MapTileCache::insert(int x, int y, const QImage& image)
+{
+	if (current >= levels.size())
+		return;
+
+	auto& tile = levels[current].tiles[key(x, y)];
+	bytes += imageBytes(image) - imageBytes(tile.image);
+	tile.image = image;
+	tile.last_use = ++use_counter;
+
+	// Drop half of the budget at once,
+	// so that eviction does not happen for every new tile.
+	if (bytes > max_bytes)
+		evict(max_bytes / 2);
+}
+
+
+void MapTileCache::invalidate(const QRectF& map_rect, int pixel_border)
+{
+	for (auto& level : levels)
+	{
+		if (level.tiles.empty())
+			continue;
+
+		auto const level_rect = level.transform.mapRect(map_rect).toAlignedRect()
+		                        .adjusted(-pixel_border, -pixel_border, pixel_border, pixel_border);
+		auto const range = tileRange(level_rect);
+		if (qint64(range.width()) * range.height() > qint64(level.tiles.size()))
+		{
+			for (auto tile = level.tiles.begin(); tile != level.tiles.end(); )
+			{
+				auto const x = int(qint32(quint32(tile->first >> 32)));
+				auto const y = int(qint32(quint32(tile->first & 0xffffffffu)));
+				if (range.contains(x, y))
+				{
+					bytes -= imageBytes(tile->second.image);
+					tile = level.tiles.erase(tile);
+				}
+				else
+				{
+					++tile;
+				}
+			}
+		}
+		else
+		{
+			for (auto y = range.top(); y <= range.bottom(); ++y)
+			{
+				for (auto x = range.left(); x <= range.right(); ++x)
+				{
+					auto tile = level.tiles.find(key(x, y));
+					if (tile != level.tiles.end())
+					{
+						bytes -= imageBytes(tile->second.image);
+						level.tiles.erase(tile);
+					}
+				}
+			}
+		}
+	}
+}
+
+
+void MapTileCache::clear()
+{
+	levels.clear();
+	current = 0;
+	bytes = 0;
+}
+
+
+void MapTileCache::drawLevels(QPainter* painter, const QRectF& map_rect, int flags, const QColor& background) const
+{
+	auto const target_scale = linearScale(painter->worldTransform());
+	if (target_scale <= 0)
+		return;
+
+	struct Candidate
+	{
+		const Level* level;
+		qreal mismatch;
+	};
+	std::vector<Candidate> candidates;
+	for (auto const& level : levels)
+	{
+		if (level.flags != flags || level.tiles.empty())
+			continue;
+		auto const mismatch = std::abs(std::log(linearScale(level.transform) / target_scale));
+		if (mismatch <= std::log(max_preview_scale_factor))
+			candidates.push_back({ &level, mismatch });
+	}
+	std::sort(begin(candidates), end(candidates), [](const Candidate& a, const Candidate& b) {
+		return a.mismatch > b.mismatch;
+	});
+
+	for (auto const& candidate : candidates)
+	{
+		auto const& level = *candidate.level;
+		auto const range = tileRange(level.transform.mapRect(map_rect).toAlignedRect());
+
+		painter->save();
+		painter->setWorldTransform(level.transform.inverted(), true);
+		auto draw_tile = [painter, &background](int x, int y, const QImage& image) {
+			painter->fillRect(tileRect(x, y), background);
+			painter->drawImage(tileRect(x, y).topLeft(), image);
+		};
+		if (qint64(range.width()) * range.height() > qint64(level.tiles.size()))
+		{
+			for (auto const& tile : level.tiles)
+			{
+				auto const x = int(qint32(quint32(tile.first >> 32)));
+				auto const y = int(qint32(quint32(tile.first & 0xffffffffu)));
+				if (range.contains(x, y))
+					draw_tile(x, y, tile.second.image);
+			}
+		}
+		else
+		{
+			for (auto y = range.top(); y <= range.bottom(); ++y)
+			{
+				for (auto x = range.left(); x <= range.right(); ++x)
+				{
+					auto tile = level.tiles.find(key(x, y));
+					if (tile != level.tiles.end())
+						draw_tile(x, y, tile->second.image);
+				}
+			}
+		}
+		painter->restore();
+	}
+}
+
+
+bool MapTileCache::saveLevel(QIODevice& device, const QByteArray& key, std::size_t max_tiles) const
+{
+	if (current >= levels.size())
+		return false;
+
+	auto const& level = levels[current];
+	struct SavedTile
+	{
+		quint64 key;
+		quint64 last_use;
+		const QImage* image;
+		QByteArray data;
+	};
+	std::vector<SavedTile> saved_tiles;
+	saved_tiles.reserve(level.tiles.size());
+	for (auto const& tile : level.tiles)
+	{
+		if (tile.second.image.format() == QImage::Format_ARGB32_Premultiplied
+		    && tile.second.image.size() == QSize(tile_size, tile_size))
+			saved_tiles.push_back({ tile.first, tile.second.last_use, &tile.second.image, {} });
+	}
+	std::sort(begin(saved_tiles), end(saved_tiles), [](const SavedTile& a, const SavedTile& b) {
+		return a.last_use > b.last_use;
+	});
+	if (saved_tiles.size() > max_tiles)
+		saved_tiles.resize(max_tiles);
+
+	Concurrency::parallelFor(0, int(saved_tiles.size()), [&saved_tiles](int i) {
+		auto& tile = saved_tiles[std::size_t(i)];
+		auto const& image = *tile.image;
+		tile.data = qCompress(image.constBits(), int(imageBytes(image)), persistent_compression);
+	});
+
+	QDataStream stream(&device);
+	stream.setVersion(QDataStream::Qt_5_6);
+	stream << persistent_magic << key << level.transform << qint32(level.flags)
+	       << quint32(saved_tiles.size());
+	for (auto const& tile : saved_tiles)
+		stream << tile.key << tile.data;
+	return stream.status() == QDataStream::Ok;
+}
+
+
+bool MapTileCache::restoreLevel(QIODevice& device, const QByteArray& key)
+{
+	QDataStream stream(&device);
+	stream.setVersion(QDataStream::Qt_5_6);
+	quint32 magic;
+	QByteArray saved_key;
+	stream >> magic >> saved_key;
+	if (stream.status() != QDataStream::Ok || magic != persistent_magic || saved_key != key)
+		return false;
+
+	QTransform transform;
+	qint32 flags;
+	quint32 count;
+	stream >> transform >> flags >> count;
+	struct RestoredTile
+	{
+		quint64 key;
+		QByteArray data;
+		QImage image;
+	};
+	std::vector<RestoredTile> restored_tiles;
+	for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i)
+	{
+		restored_tiles.emplace_back();
+		stream >> restored_tiles.back().key >> restored_tiles.back().data;
+	}
+	if (stream.status() != QDataStream::Ok || restored_tiles.empty())
+		return false;
+
+	Concurrency::parallelFor(0, int(restored_tiles.size()), [&restored_tiles](int i) {
+		auto& tile = restored_tiles[std::size_t(i)];
+		auto const data = qUncompress(tile.data);
+		QImage image(tile_size, tile_size, QImage::Format_ARGB32_Premultiplied);
+		if (data.size() == imageBytes(image))
+		{
+			std::copy(data.constBegin(), data.constEnd(), reinterpret_cast<char*>(image.bits()));
+			tile.image = image;
+		}
+		tile.data.clear();
+	});
+
+	// The restored tiles are older than any tile rendered in this session.
+	Level level = { transform, flags, {} };
+	for (auto& tile : restored_tiles)
+	{
+		if (tile.image.isNull())
+			continue;
+		bytes += imageBytes(tile.image);
+		level.tiles.emplace(tile.key, Tile{ std::move(tile.image), 0 });
+	}
+	if (level.tiles.empty())
+		return false;
+
+	levels.push_back(std::move(level));
+	if (bytes > max_bytes)
+		evict(max_bytes / 2);
+	return true;
+}
+
+
+// static
+QByteArray MapTileCache::persistentKey(const QString& map_path)
+{
+	auto const info = QFileInfo(map_path);
+	QByteArray parameters;
+	{
+		QDataStream stream(&parameters, QIODevice::WriteOnly);
+		stream << QByteArray(APP_VERSION) << info.canonicalFilePath() << qint64(info.size())
+		       << qint64(info.lastModified().toMSecsSinceEpoch())
+		       << Settings::getInstance().getSettingCached(Settings::MapDisplay_TextAntialiasing).toBool();
+	}
+	return QCryptographicHash::hash(parameters, QCryptographicHash::Sha1).toHex();
+}
+
+// static
+QString MapTileCache::persistentPath(const QString& map_path)
+{
+	auto const name = QCryptographicHash::hash(QFileInfo(map_path).canonicalFilePath().toUtf8(), QCryptographicHash::Sha1).toHex();
+	return QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+	       + QLatin1String("/map-tiles/") + QString::fromLatin1(name) + QLatin1String(".tiles");
+}
+
+// static
+void MapTileCache::prunePersistentTiles(int max_age_days)
+{
+	auto const directory = QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QLatin1String("/map-tiles"));
+	auto const oldest = QDateTime::currentDateTime().addDays(-max_age_days);
+	for (auto const& info : directory.entryInfoList({ QStringLiteral("*.tiles") }, QDir::Files))
+	{
+		if (info.lastModified() < oldest)
+			QFile::remove(info.absoluteFilePath());
+	}
+}
+
+
+// static
+quint64 MapTileCache::key(int x, int y)
+{
+	return (quint64(quint32(x)) << 32) | quint64(quint32(y));
+}
+
+
+void MapTileCache::trim(CacheManager::TrimLevel level)
+{
+	evict(CacheManager::trimTarget(level, bytes));
+}
+
+
+void MapTileCache::evict(qint64 target_bytes)
+{
+	struct Candidate
+	{
+		quint64 last_use;
+		std::size_t level;
+		quint64 key;
+	};
+	std::vector<Candidate> candidates;
+	for (std::size_t i = 0; i < levels.size(); ++i)
+	{
+		for (auto const& tile : levels[i].tiles)
+			candidates.push_back({ tile.second.last_use, i, tile.first });
+	}
+	std::sort(begin(candidates), end(candidates), [](const Candidate& a, const Candidate& b) {
+		return a.last_use < b.last_use;
+	});
+
+	for (auto const& candidate : candidates)
+	{
+		if (bytes <= target_bytes)
+			break;
+		auto& tiles = levels[candidate.level].tiles;
+		auto tile = tiles.find(candidate.key);
+		bytes -= imageBytes(tile->second.image);
+		tiles.erase(tile);
+	}
+
+	// Remove empty levels, except for the current one.
+	for (auto i = levels.size(); i > 0; --i)
+	{
+		auto const index = i - 1;
+		if (index != current && levels[index].tiles.empty())
+		{
+			levels.erase(begin(levels) + std::ptrdiff_t(index));
+			if (current > index)
+				--current;
+		}
+	}
+}
+
+
+}  // namespace OpenOrienteering
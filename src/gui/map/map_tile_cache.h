@@ -0,0 +1,208 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef OPENORIENTEERING_MAP_TILE_CACHE_H
+#define OPENORIENTEERING_MAP_TILE_CACHE_H
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+#include <QtGlobal>
+#include <QImage>
+#include <QPoint>
+#include <QRect>
+#include <QTransform>
+
+#include "util/cache_manager.h"
+
+class QByteArray;
+class QColor;
+class QIODevice;
+class QPainter;
+class QRectF;
+class QString;
+
+
+namespace OpenOrienteering {
+
+/**
+ * A cache of rendered map tiles.
+ *
+ * Tiles are square images of tile_size pixels. They are organized in levels.
+ * A level is identified by the linear part of the map-to-viewport transform,
+ * the fractional part of its translation, and a set of rendering flags.
+ * Within a level, tile (x, y) covers the pixels from (x, y) * tile_size to
+ * (x + 1, y + 1) * tile_size - 1 of the level's pixel space. Panning the view
+ * by whole pixels keeps the level, so that the tiles can be reused.
+ *
+ * The total size of the cached images is limited. When the limit is exceeded,
+ * the least recently used tiles are evicted. The cache is registered with
+ * the CacheManager, and it releases tiles when memory runs low.
+ *
+ * The tiles of the current level can be saved and restored, so that a map
+ * which is opened again can be shown without rendering it first.
+ *
+ * This class is not thread-safe.
+ */
+class MapTileCache
+{
+public:
+	/** The width and height of the tiles, in pixels. */
+	static constexpr int tile_size = 256;
+
+	/** Constructs an empty cache, limited to the given size in bytes. */
+	explicit MapTileCache(qint64 max_bytes = 128 * 1024 * 1024);
+
+	MapTileCache(const MapTileCache&) = delete;
+	MapTileCache& operator=(const MapTileCache&) = delete;
+
+	~MapTileCache();
+
+
+	/**
+	 * Selects the level for the given map-to-viewport transform and flags.
+	 *
+	 * The transform must not contain perspective or non-uniform projection.
+	 * Returns the offset of the level's pixel space origin in viewport
+	 * coordinates.
+	 */
+	QPoint setLevel(const QTransform& map_to_viewport, int flags);
+
+	/** Returns the transform from map coordinates to the current level's pixel space. */
+	const QTransform& levelTransform() const { return current_transform; }
+
+	/** Returns the range of tiles in the current level which intersect the given pixel rect. */
+	static QRect tileRange(const QRect& level_rect);
+
+	/** Returns the rect in pixels which is covered by the given tile. */
+	static QRect tileRect(int x, int y);
+
+
+	/**
+	 * Returns the tile at the given position in the current level.
+	 *
+	 * Returns a null image if the tile is not cached.
+	 */
+	QImage tile(int x, int y);
+
+	/** Stores a tile at the given position in the current level. */
+	void insert(int x, int y, const QImage& image);
+
+	/**
+	 * Removes all tiles which intersect the given area in map coordinates,
+	 * extended by the given border in pixels.
+	 */
+	void invalidate(const QRectF& map_rect, int pixel_border = 2);
+
+	/** Removes all tiles. */
+	void clear();
+
+	/** Returns the memory used by the cached images, in bytes. */
+	qint64 memoryUsage() const { return bytes; }
+
+
+	/**
+	 * Draws the cached tiles of all levels with the given flags as a preview.
+	 *
+	 * The painter's world transform must map map coordinates to device
+	 * coordinates. Levels are drawn in the order of their resolution's
+	 * similarity to the painter's scale, so that the best match ends up on
+	 * top. Each tile is drawn onto the given background color. Levels with a
+	 * resolution very different from the painter's scale are skipped.
+	 *
+	 * This does not change the current level or the tiles' recent use.
+	 */
+	void drawLevels(QPainter* painter, const QRectF& map_rect, int flags, const QColor& background) const;
+
+
+	/**
+	 * Writes the most recently used tiles of the current level to the device.
+	 *
+	 * The data starts with the given key, so that restoreLevel() can tell
+	 * whether the tiles still match the map. The images are stored without
+	 * loss. Returns false on error.
+	 */
+	bool saveLevel(QIODevice& device, const QByteArray& key, std::size_t max_tiles = 256) const;
+
+	/**
+	 * Adds the tiles written by saveLevel(), if they were saved with the given key.
+	 *
+	 * The restored tiles are used when the current level is set to their
+	 * transform and flags again. Returns false if nothing was restored.
+	 */
+	bool restoreLevel(QIODevice& device, const QByteArray& key);
+
+	/**
+	 * Returns a key which identifies the content of the given map file.
+	 *
+	 * The key changes when the file is modified, and with the program
+	 * version and the display settings which affect rendering without
+	 * being part of the tile flags.
+	 */
+	static QByteArray persistentKey(const QString& map_path);
+
+	/**
+	 * Returns the path of the file which holds the saved tiles for the given map file.
+	 *
+	 * This is located in the application's cache directory.
+	 */
+	static QString persistentPath(const QString& map_path);
+
+	/**
+	 * Removes saved tiles which were not used for the given number of days.
+	 */
+	static void prunePersistentTiles(int max_age_days = 30);
+
+
+private:
+	struct Tile
+	{
+		QImage image;
+		quint64 last_use;
+	};
+
+	struct Level
+	{
+		QTransform transform;
+		int flags;
+		std::unordered_map<quint64, Tile> tiles;
+	};
+
+	static quint64 key(int x, int y);
+
+	/** Drops the least recently used tiles until at most target_bytes remain. */
+	void evict(qint64 target_bytes);
+
+	void trim(CacheManager::TrimLevel level);
+
+	std::vector<Level> levels;
+	std::size_t current = 0;
+	QTransform current_transform;
+	qint64 max_bytes;
+	qint64 bytes = 0;
+	quint64 use_counter = 0;
+	CacheManager::Registration cache_registration;
+};
+
+
+}  // namespace OpenOrienteering
+
+#endif
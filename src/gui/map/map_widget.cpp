@@ -21,12 +21,17 @@
 
 #include "map_widget.h"
 
+#include <algorithm>
+#include <array>
 #include <cmath>
+#include <cstddef>
 #include <stdexcept>
+#include <vector>
 
 #include <QApplication>
 #include <QColor>
 #include <QContextMenuEvent>
+#include <QElapsedTimer>
 #include <QEvent>
 #include <QFlags>
 #include <QFont>
@@ -44,6 +49,7 @@
 #include <QPixmap>
 #include <QResizeEvent>
 #include <QSizePolicy>
+#include <QString>
 #include <QTimer>
 #include <QTouchEvent>
 #include <QTransform>
@@ -57,6 +63,7 @@
 #include "core/renderables/renderable.h"
 #include "gui/touch_cursor.h"
 #include "gui/map/map_editor_activity.h"
+#include "gui/map/map_tile_cache.h"
 #include "gui/widgets/action_grid_bar.h"
 #include "gui/widgets/key_button_bar.h"
 #include "gui/widgets/pie_menu.h"
@@ -65,6 +72,8 @@
 #include "templates/template.h" // IWYU pragma: keep
 #include "tools/tool.h"
 #include "util/backports.h" // IWYU pragma: keep
+#include "util/concurrency.h"
+#include "util/profiler.h"
 #include "util/util.h"
 
 class QGesture;
@@ -78,6 +87,22 @@ class QGesture;
 
 namespace OpenOrienteering {
 
+namespace {
+
+/** Flags for the levels of the tile cache */
+enum TileFlags
+{
+	TileAntialiasing = 1<<0,
+	TileOverprinting = 1<<1,
+};
+
+/** The time after the last interaction before drafts are refined, in ms. */
+constexpr int refine_delay = 300;
+
+}  // namespace
+
+
+
 MapWidget::MapWidget(bool show_help, bool force_antialiasing, QWidget* parent)
  : QWidget(parent)
  , view(nullptr)
@@ -111,6 +136,19 @@ MapWidget::MapWidget(bool show_help, bool force_antialiasing, QWidget* parent)
 	setMouseTracking(true);
 	setFocusPolicy(Qt::ClickFocus);
 	setSizePolicy(QSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding));
+	
+	cache_update_timer = new QTimer(this);
+	cache_update_timer->setSingleShot(true);
+	connect(cache_update_timer, &QTimer::timeout, this, &MapWidget::deferredCacheUpdate);
+	
+	refine_timer = new QTimer(this);
+	refine_timer->setSingleShot(true);
+	connect(refine_timer, &QTimer::timeout, this, &MapWidget::refineDraft);
+	
+	cache_registration = CacheManager::add({
+		[this]() { return cacheMemoryUsage(); },
+		[this](CacheManager::TrimLevel level) { trimCaches(level); }
+	});
 }
 
 MapWidget::~MapWidget()
@@ -129,18 +167,21 @@ void MapWidget::setMapView(MapView* view)
 			
 			disconnect(this->view, &MapView::viewChanged, this, &MapWidget::viewChanged);
 			disconnect(this->view, &MapView::panOffsetChanged, this, &MapWidget::setPanOffset);
-			disconnect(this->view, &MapView::visibilityChanged, this, &MapWidget::updateEverything);
+			disconnect(this->view, &MapView::visibilityChanged, this, &MapWidget::visibilityChanged);
+			disconnect(this->view->getMap(), &Map::templateDeleted, this, &MapWidget::removeTemplateLayer);
 		}
 		
 		this->view = view;
+		template_layers.clear();
 		
 		if (view)
 		{
 			connect(this->view, &MapView::viewChanged, this, &MapWidget::viewChanged);
 			connect(this->view, &MapView::panOffsetChanged, this, &MapWidget::setPanOffset);
-			connect(this->view, &MapView::visibilityChanged, this, &MapWidget::updateEverything);
+			connect(this->view, &MapView::visibilityChanged, this, &MapWidget::visibilityChanged);
 			
 			auto map = this->view->getMap();
+			connect(map, &Map::templateDeleted, this, &MapWidget::removeTemplateLayer);
 			map->addMapWidget(this);
 		}
 		
@@ -273,7 +314,7 @@ void MapWidget::viewChanged(MapView::ChangeFlags changes)
 {
 	setDrawingBoundingBox(drawing_dirty_rect_map, drawing_dirty_rect_border, true);
 	setActivityBoundingBox(activity_dirty_rect_map, activity_dirty_rect_border, true);
-	updateEverything();
+	updateCachesForViewChange();
 	if (changes.testFlag(MapView::ZoomChange))
 		updateZoomDisplay();
 }
@@ -429,7 +470,7 @@ void MapWidget::moveDirtyRect(QRect& dirty_rect, qreal x, qreal y)
 		dirty_rect = dirty_rect.translated(x, y).intersected(rect());
 }
 
-void MapWidget::markTemplateCacheDirty(const QRectF& view_rect, int pixel_border, bool front_cache)
+void MapWidget::markTemplateCacheDirty(const QRectF& view_rect, int pixel_border, bool front_cache, const Template* temp)
 {
 	QRect& cache_dirty_rect = front_cache ? above_template_cache_dirty_rect : below_template_cache_dirty_rect;
 	QRectF viewport_rect = viewToViewport(view_rect);
@@ -443,10 +484,19 @@ void MapWidget::markTemplateCacheDirty(const QRectF& view_rect, int pixel_border
 		cache_dirty_rect = cache_dirty_rect.united(integer_rect);
 	else
 		cache_dirty_rect = integer_rect;
+	markTemplateLayersDirty(integer_rect, temp);
 	
 	update(integer_rect);
 }
 
+void MapWidget::markTemplateCompositionDirty()
+{
+	below_template_cache_dirty_rect = rect();
+	above_template_cache_dirty_rect = rect();
+	display_cache_dirty_rect = rect();
+	update();
+}
+
 void MapWidget::markObjectAreaDirty(const QRectF& map_rect)
 {
 	updateMapRect(map_rect, 0, map_cache_dirty_rect);
@@ -548,9 +598,19 @@ void MapWidget::updateDrawingLaterSlot()
 
 void MapWidget::updateEverything()
 {
+	invalidateAllCaches();
+}
+
+void MapWidget::invalidateAllCaches()
+{
+	cache_update_timer->stop();
+	if (view)
+		cache_transform = mapToViewportTransform();
+	
 	map_cache_dirty_rect = rect();
 	below_template_cache_dirty_rect = map_cache_dirty_rect;
 	above_template_cache_dirty_rect = map_cache_dirty_rect;
+	markTemplateLayersDirty(map_cache_dirty_rect);
 	update(map_cache_dirty_rect);
 }
 
@@ -559,6 +619,7 @@ void MapWidget::updateEverythingInRect(const QRect& dirty_rect)
 	rectIncludeSafe(map_cache_dirty_rect, dirty_rect);
 	rectIncludeSafe(below_template_cache_dirty_rect, dirty_rect);
 	rectIncludeSafe(above_template_cache_dirty_rect, dirty_rect);
+	markTemplateLayersDirty(dirty_rect);
 	update(dirty_rect);
 }
 
@@ -714,6 +775,53 @@ void MapWidget::showHelpMessage(QPainter* painter, const QString& text) const
 	painter->drawText(QRect(0, 0, width(), height()), Qt::AlignCenter, text);
 }
 
+void MapWidget::drawProfilerOverlay(QPainter* painter) const
+{
+	auto const frames = Profiler::recentFrames();
+	if (frames.empty())
+		return;
+	
+	qint64 total_ns = 0;
+	qint64 max_ns = 0;
+	std::array<Profiler::Statistics, Profiler::NumPhases> phases = {};
+	for (const auto& frame : frames)
+	{
+		total_ns += frame.duration_ns;
+		max_ns = std::max(max_ns, frame.duration_ns);
+		for (std::size_t i = 0; i < phases.size(); ++i)
+		{
+			phases[i].count += frame.phases[i].count;
+			phases[i].total_ns += frame.phases[i].total_ns;
+		}
+	}
+	
+	auto const num_frames = double(frames.size());
+	auto const ms = [](double ns) { return QString::number(ns / 1000000.0, 'f', 1); };
+	auto text = QString::fromLatin1("Frame: %1 ms, avg. %2 ms, max. %3 ms (%4 frames)")
+	            .arg(ms(frames.back().duration_ns), ms(total_ns / num_frames), ms(max_ns))
+	            .arg(frames.size());
+	for (int i = Profiler::TemplateCache; i <= Profiler::ClipChange; ++i)
+	{
+		text += QString::fromLatin1("\n%1: avg. %2 ms, %3 calls per frame")
+		        .arg(QLatin1String(Profiler::name(Profiler::Phase(i))),
+		             ms(phases[std::size_t(i)].total_ns / num_frames),
+		             QString::number(phases[std::size_t(i)].count / num_frames, 'f', 0));
+	}
+	
+	painter->save();
+	QFont font = painter->font();
+	font.setFamily(QStringLiteral("monospace"));
+	font.setStyleHint(QFont::Monospace);
+	painter->setFont(font);
+	auto const margin = 4;
+	auto const box = painter->boundingRect(QRect(2 * margin, 2 * margin, width(), height()), Qt::AlignLeft | Qt::AlignTop, text)
+	                 .adjusted(-margin, -margin, margin, margin);
+	painter->fillRect(box, QColor(0, 0, 0, 160));
+	painter->setPen(Qt::white);
+	painter->drawText(box.adjusted(margin, margin, -margin, -margin), Qt::AlignLeft | Qt::AlignTop, text);
+	painter->restore();
+}
+
 bool MapWidget::event(QEvent* event)
 {
 	switch (event->type())
@@ -791,6 +899,8 @@ void MapWidget::gestureEvent(QGestureEvent* event)
 
 void MapWidget::paintEvent(QPaintEvent* event)
 {
+	Profiler::Scope profiler_scope(Profiler::Frame);
+	
 	// Draw on the widget
 	QPainter painter(this);
 	QRect exposed = event->rect();
@@ -806,10 +916,12 @@ void MapWidget::paintEvent(QPaintEvent* event)
 	
 	QTransform transform = painter.worldTransform();
 	
-	// Update all dirty caches
-	// TODO: It would be an idea to do these updates in a background thread and use the old caches in the meantime
-	updateAllDirtyCaches();
+	// Update all dirty caches, unless deferred after a view change.
+	const bool caches_outdated = cache_update_timer->isActive();
+	if (!caches_outdated)
+		updateAllDirtyCaches();
 	
+	QRect source = exposed;
 	QRect target = exposed;
 	if (pinching)
 	{
@@ -835,11 +947,26 @@ void MapWidget::paintEvent(QPaintEvent* event)
 		target.translate(pan_offset);
 	}
 	
-	if (!view->areAllTemplatesHidden() && isBelowTemplateVisible() && !below_template_cache.isNull() && view->getMap()->getFirstFrontTemplate() > 0)
+	const QTransform caches_base_transform = painter.worldTransform();
+	if (pinching || caches_outdated)
+		painter.setRenderHint(QPainter::SmoothPixmapTransform);
+	if (caches_outdated)
+	{
+		// Show the previous caches, transformed to the current view,
+		// on top of a preview from the tiles of other zoom levels.
+		if (!pinching)
+			painter.fillRect(exposed, QColor(Qt::gray));
+		painter.translate(target.topLeft() - source.topLeft());
+		drawTilePreview(&painter, exposed);
+		painter.setWorldTransform(cache_transform.inverted() * mapToViewportTransform(), true);
+		source = target = rect();
+	}
+	else if (pinching)
 	{
-		painter.drawImage(target, below_template_cache, exposed);
+		drawTilePreview(&painter, exposed);
 	}
-	else if (show_help && no_contents)
+	
+	if (show_help && no_contents)
 	{
 		painter.save();
 		painter.setTransform(transform);
@@ -851,22 +978,19 @@ void MapWidget::paintEvent(QPaintEvent* event)
 			showHelpMessage(&painter, tr("Ready to draw!\n\nStart drawing or load a base map.\nTo load a base map, click\nTemplates -> Open template...") + QLatin1String("\n\n") + tr("Hint: Hold the middle mouse button to drag the map,\nzoom using the mouse wheel, if available."));
 		painter.restore();
 	}
-	else
+	else if (!display_cache.isNull())
 	{
-		painter.fillRect(target, Qt::white);
+		painter.drawPixmap(target, display_cache, source);
 	}
-	
-	const auto map_visibility = view->effectiveMapVisibility();
-	if (!map_cache.isNull() && map_visibility.visible)
+	else
 	{
-		qreal saved_opacity = painter.opacity();
-		painter.setOpacity(map_visibility.opacity);
-		painter.drawImage(target, map_cache, exposed);
-		painter.setOpacity(saved_opacity);
+		painter.fillRect(target, Qt::white);
 	}
 	
-	if (!view->areAllTemplatesHidden() && isAboveTemplateVisible() && !above_template_cache.isNull() && view->getMap()->getNumTemplates() - view->getMap()->getFirstFrontTemplate() > 0)
-		painter.drawImage(target, above_template_cache, exposed);
+	if (pinching || caches_outdated)
+		painter.setRenderHint(QPainter::SmoothPixmapTransform, false);
+	if (caches_outdated)
+		painter.setWorldTransform(caches_base_transform, false);
 	
 	//painter.setClipRect(exposed);
 	
@@ -892,13 +1016,21 @@ void MapWidget::paintEvent(QPaintEvent* event)
 	
 	
 	painter.setWorldTransform(transform, false);
+	
+	if (Profiler::isEnabled())
+		drawProfilerOverlay(&painter);
 }
 
 void MapWidget::resizeEvent(QResizeEvent* event)
 {
+	cache_update_timer->stop();
+	if (view)
+		cache_transform = mapToViewportTransform();
+	
 	map_cache_dirty_rect = rect();
 	below_template_cache_dirty_rect = map_cache_dirty_rect;
 	above_template_cache_dirty_rect = map_cache_dirty_rect;
+	markTemplateLayersDirty(map_cache_dirty_rect);
 	
 	if (map_cache.width() < map_cache_dirty_rect.width() ||
 	    map_cache.height() < map_cache_dirty_rect.height())
@@ -907,6 +1039,7 @@ void MapWidget::resizeEvent(QResizeEvent* event)
 		below_template_cache = QImage();
 		above_template_cache = QImage();
 	}
+	display_cache = QPixmap();
 	
 	for (QObject* const child : children())
 	{
@@ -1226,10 +1359,61 @@ bool MapWidget::isBelowTemplateVisible() const
 	return containsVisibleTemplate(0, view->getMap()->getFirstFrontTemplate() - 1);
 }
 
+MapWidget::TemplateLayer& MapWidget::templateLayer(const Template* temp)
+{
+	auto layer = std::find_if(begin(template_layers), end(template_layers), [temp](const auto& layer) {
+		return layer.temp == temp;
+	});
+	if (layer != end(template_layers))
+		return *layer;
+	
+	template_layers.push_back({ temp, {}, rect() });
+	return template_layers.back();
+}
+
+void MapWidget::markTemplateLayersDirty(const QRect& dirty_rect, const Template* temp)
+{
+	for (auto& layer : template_layers)
+	{
+		if (!temp || layer.temp == temp)
+			rectIncludeSafe(layer.dirty_rect, dirty_rect);
+	}
+}
+
+void MapWidget::updateTemplateLayer(TemplateLayer& layer)
+{
+	if (layer.image.size() != size())
+	{
+		layer.image = QImage(size(), QImage::Format_ARGB32_Premultiplied);
+		layer.dirty_rect = rect();
+	}
+	else
+	{
+		layer.dirty_rect = layer.dirty_rect.intersected(rect());
+	}
+	
+	QPainter painter(&layer.image);
+	painter.setClipRect(layer.dirty_rect);
+	painter.setCompositionMode(QPainter::CompositionMode_Clear);
+	painter.fillRect(layer.dirty_rect, Qt::transparent);
+	painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+	
+	painter.translate(width() / 2.0, height() / 2.0);
+	painter.setWorldTransform(view->worldTransform(), true);
+	
+	const auto map_view_rect = view->calculateViewedRect(viewportToView(layer.dirty_rect));
+	const auto scale = std::max(layer.temp->getTemplateScaleX(), layer.temp->getTemplateScaleY()) * view->getZoom();
+	layer.temp->drawTemplate(&painter, map_view_rect, scale, true, 1.0);
+	
+	layer.dirty_rect.setWidth(-1); // => !dirty_rect.isValid()
+}
+
 void MapWidget::updateTemplateCache(QImage& cache, QRect& dirty_rect, int first_template, int last_template, bool use_background)
 {
 	Q_ASSERT(containsVisibleTemplate(first_template, last_template));
 	
+	Profiler::Scope profiler_scope(Profiler::TemplateCache);
+	
 	if (cache.isNull())
 	{
 		// Lazy allocation of cache image
@@ -1257,20 +1441,33 @@ void MapWidget::updateTemplateCache(QImage& cache, QRect& dirty_rect, int first_
 		painter.setCompositionMode(mode);
 	}
 	
-	// Draw templates
-	painter.translate(width() / 2.0, height() / 2.0);
-	painter.setWorldTransform(view->worldTransform(), true);
-	
+	// Compose the template layers
 	Map* map = view->getMap();
-	QRectF map_view_rect = view->calculateViewedRect(viewportToView(dirty_rect));
-	
-	map->drawTemplates(&painter, map_view_rect, first_template, last_template, view, true);
+	for (int i = first_template; i <= last_template; ++i)
+	{
+		const Template* temp = map->getTemplate(i);
+		const auto visibility = view->getTemplateVisibility(temp);
+		if (temp->getTemplateState() != Template::Loaded || !visibility.visible || visibility.opacity <= 0)
+			continue;
+		
+		auto& layer = templateLayer(temp);
+		if (layer.dirty_rect.isValid())
+			updateTemplateLayer(layer);
+		painter.setOpacity(visibility.opacity);
+		painter.drawImage(dirty_rect, layer.image, dirty_rect);
+	}
 	
 	dirty_rect.setWidth(-1); // => !dirty_rect.isValid()
 }
 
 void MapWidget::updateMapCache(bool use_background)
 {
+	Profiler::Scope profiler_scope(Profiler::MapCache);
+	
+	// Update the renderables of all objects marked as dirty. This may extend
+	// the dirty rect, and it must be done before drawing tiles concurrently.
+	view->getMap()->updateObjects();
+	
 	if (map_cache.isNull())
 	{
 		// Lazy allocation of cache image
@@ -1301,8 +1498,26 @@ void MapWidget::updateMapCache(bool use_background)
 		painter.setCompositionMode(mode);
 	}
 	
-	RenderConfig::Options options(RenderConfig::Screen | RenderConfig::HelperSymbols);
+	// Small areas are drawn directly, large areas are composed from tiles.
+	constexpr auto min_tiled_area = 2 * MapTileCache::tile_size * MapTileCache::tile_size;
+	const bool tiled = map_cache_dirty_rect.width() * map_cache_dirty_rect.height() >= min_tiled_area;
+	
+	RenderConfig::Options options(RenderConfig::Screen | RenderConfig::HelperSymbols | RenderConfig::BatchStates);
 	bool use_antialiasing = force_antialiasing || Settings::getInstance().getSettingCached(Settings::MapDisplay_Antialiasing).toBool();
+	
+	// During interaction, large areas are drawn as a fast draft first.
+	drawing_draft = use_antialiasing && tiled && isInteracting();
+	if (drawing_draft)
+	{
+		use_antialiasing = false;
+		rectIncludeSafe(draft_rect, map_cache_dirty_rect);
+		refine_timer->start(refine_delay);
+	}
+	else if (map_cache_dirty_rect.contains(draft_rect))
+	{
+		draft_rect = QRect();
+	}
+	
 	if (use_antialiasing)
 		painter.setRenderHint(QPainter::Antialiasing);
 	else
@@ -1310,40 +1525,349 @@ void MapWidget::updateMapCache(bool use_background)
 		
 	Map* map = view->getMap();
 	QRectF map_view_rect = view->calculateViewedRect(viewportToView(map_cache_dirty_rect));
-
-	RenderConfig config = { *map, map_view_rect, view->calculateFinalZoomFactor(), options, 1.0 };
 	
-	painter.translate(width() / 2.0, height() / 2.0);
-	painter.setWorldTransform(view->worldTransform(), true);
-#ifndef Q_OS_ANDROID
-	if (view->isOverprintingSimulationEnabled())
-		map->drawOverprintingSimulation(&painter, config);
+	if (tiled)
+	{
+		drawMapTiles(&painter, options);
+	}
 	else
-#endif
-		map->draw(&painter, config);
+	{
+		RenderConfig config = { *map, map_view_rect, view->calculateFinalZoomFactor(), options, 1.0 };
+		
+		painter.save();
+		painter.translate(width() / 2.0, height() / 2.0);
+		painter.setWorldTransform(view->worldTransform(), true);
+		if (view->isOverprintingSimulationEnabled())
+			map->drawOverprintingSimulation(&painter, config);
+		else
+			map->draw(&painter, config);
+		painter.restore();
+	}
 	
 	if (view->isGridVisible())
+	{
+		painter.translate(width() / 2.0, height() / 2.0);
+		painter.setWorldTransform(view->worldTransform(), true);
 		map->drawGrid(&painter, map_view_rect);
+	}
 	
 	// Finish drawing
 	painter.end();
 	
+	drawing_draft = false;
 	map_cache_dirty_rect.setWidth(-1); // => !map_cache_dirty_rect.isValid()
 }
 
+void MapWidget::drawMapTiles(QPainter* painter, RenderConfig::Options options)
+{
+	const auto flags = tileFlags();
+	Q_ASSERT(bool(flags & TileAntialiasing) == !options.testFlag(RenderConfig::DisableAntialiasing));
+	
+	auto& tile_cache = view->getMap()->getTileCache();
+	const auto origin = tile_cache.setLevel(mapToViewportTransform(), flags);
+	const auto range = MapTileCache::tileRange(map_cache_dirty_rect.translated(-origin));
+	
+	struct PendingTile
+	{
+		int x;
+		int y;
+		QImage image;
+	};
+	std::vector<PendingTile> missing_tiles;
+	for (int y = range.top(); y <= range.bottom(); ++y)
+	{
+		for (int x = range.left(); x <= range.right(); ++x)
+		{
+			auto image = tile_cache.tile(x, y);
+			if (image.isNull())
+				missing_tiles.push_back({ x, y, {} });
+			else
+				painter->drawImage(MapTileCache::tileRect(x, y).topLeft() + origin, image);
+		}
+	}
+	
+	if (missing_tiles.empty())
+		return;
+	
+	// Render the missing tiles concurrently. Drawing the renderables doesn't
+	// modify the map, and this thread waits until all tiles are done, so
+	// that the map cannot be modified in the meantime.
+	// Settings::getSettingCached() is not thread-safe while filling its cache.
+	Settings::getInstance().getSettingCached(Settings::MapDisplay_TextAntialiasing);
+	
+	Map* map = view->getMap();
+	const auto& renderables = map->getRenderables();
+	const auto level_transform = tile_cache.levelTransform();
+	const auto inverse_transform = level_transform.inverted();
+	const auto scaling = view->calculateFinalZoomFactor();
+	Concurrency::parallelFor(0, int(missing_tiles.size()), [&](int i) {
+		auto& tile = missing_tiles[std::size_t(i)];
+		const auto tile_rect = MapTileCache::tileRect(tile.x, tile.y);
+		tile.image = QImage(tile_rect.size(), QImage::Format_ARGB32_Premultiplied);
+		tile.image.fill(Qt::transparent);
+		
+		QPainter tile_painter(&tile.image);
+		if (flags & TileAntialiasing)
+			tile_painter.setRenderHint(QPainter::Antialiasing);
+		tile_painter.translate(-tile_rect.left(), -tile_rect.top());
+		tile_painter.setWorldTransform(level_transform, true);
+		
+		// An extra pixel for antialiasing at the tile border
+		const auto bounding_box = inverse_transform.mapRect(QRectF(tile_rect.adjusted(-1, -1, 1, 1)));
+		RenderConfig config = { *map, bounding_box, scaling, options, 1.0 };
+		if (flags & TileOverprinting)
+			renderables.drawOverprintingSimulation(&tile_painter, config);
+		else
+			renderables.draw(&tile_painter, config);
+	}, 1, Concurrency::Priority::Interactive);
+	
+	for (auto& tile : missing_tiles)
+	{
+		painter->drawImage(MapTileCache::tileRect(tile.x, tile.y).topLeft() + origin, tile.image);
+		tile_cache.insert(tile.x, tile.y, tile.image);
+	}
+}
+
+int MapWidget::tileFlags() const
+{
+	int flags = 0;
+	if (!drawing_draft
+	    && (force_antialiasing || Settings::getInstance().getSettingCached(Settings::MapDisplay_Antialiasing).toBool()))
+		flags |= TileAntialiasing;
+	if (view->isOverprintingSimulationEnabled())
+		flags |= TileOverprinting;
+	return flags;
+}
+
+bool MapWidget::isInteracting()
+{
+	return getTimeSinceLastInteraction() < refine_delay
+	       || (last_view_change.isValid() && last_view_change.elapsed() < refine_delay);
+}
+
+void MapWidget::refineDraft()
+{
+	if (!draft_rect.isValid())
+		return;
+	
+	if (isInteracting())
+	{
+		refine_timer->start(refine_delay);
+		return;
+	}
+	
+	rectIncludeSafe(map_cache_dirty_rect, draft_rect);
+	update(draft_rect);
+}
+
+void MapWidget::drawTilePreview(QPainter* painter, const QRect& exposed) const
+{
+	if (!view->effectiveMapVisibility().visible)
+		return;
+	
+	painter->save();
+	painter->setWorldTransform(mapToViewportTransform(), true);
+	const auto map_rect = painter->worldTransform().inverted().mapRect(QRectF(exposed));
+	view->getMap()->getTileCache().drawLevels(painter, map_rect, tileFlags(), Qt::white);
+	painter->restore();
+}
+
 void MapWidget::updateAllDirtyCaches()
 {
+	QElapsedTimer timer;
+	const bool full_update = map_cache_dirty_rect.contains(rect());
+	if (full_update)
+		timer.start();
+	
 	if (map_cache_dirty_rect.isValid())
+	{
+		// The map cache's dirty rect may grow while updating the objects.
+		view->getMap()->updateObjects();
+		rectIncludeSafe(display_cache_dirty_rect, map_cache_dirty_rect);
 		updateMapCache(false);
+	}
 	
 	if (!view->areAllTemplatesHidden())
 	{
 		if (below_template_cache_dirty_rect.isValid() && isBelowTemplateVisible())
+		{
+			rectIncludeSafe(display_cache_dirty_rect, below_template_cache_dirty_rect);
 			updateTemplateCache(below_template_cache, below_template_cache_dirty_rect, 0, view->getMap()->getFirstFrontTemplate() - 1, true);
+		}
 		
 		if (above_template_cache_dirty_rect.isValid() && isAboveTemplateVisible())
+		{
+			rectIncludeSafe(display_cache_dirty_rect, above_template_cache_dirty_rect);
 			updateTemplateCache(above_template_cache, above_template_cache_dirty_rect, view->getMap()->getFirstFrontTemplate(), view->getMap()->getNumTemplates() - 1, false);
+		}
+	}
+	
+	if (display_cache_dirty_rect.isValid() || display_cache.isNull())
+		updateDisplayCache();
+	
+	if (full_update)
+		last_cache_update_duration = timer.elapsed();
+}
+
+void MapWidget::updateDisplayCache()
+{
+	if (display_cache.size() != size())
+	{
+		// Lazy allocation of the pixmap
+		display_cache = QPixmap(size());
+		display_cache_dirty_rect = rect();
+	}
+	else
+	{
+		display_cache_dirty_rect = display_cache_dirty_rect.intersected(rect());
+	}
+	
+	QPainter painter(&display_cache);
+	painter.setCompositionMode(QPainter::CompositionMode_Source);
+	
+	const auto& dirty_rect = display_cache_dirty_rect;
+	if (!view->areAllTemplatesHidden() && isBelowTemplateVisible() && !below_template_cache.isNull() && view->getMap()->getFirstFrontTemplate() > 0)
+		painter.drawImage(dirty_rect, below_template_cache, dirty_rect);
+	else
+		painter.fillRect(dirty_rect, Qt::white);
+	painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+	
+	const auto map_visibility = view->effectiveMapVisibility();
+	if (!map_cache.isNull() && map_visibility.visible)
+	{
+		painter.setOpacity(map_visibility.opacity);
+		painter.drawImage(dirty_rect, map_cache, dirty_rect);
+		painter.setOpacity(1.0);
 	}
+	
+	if (!view->areAllTemplatesHidden() && isAboveTemplateVisible() && !above_template_cache.isNull() && view->getMap()->getNumTemplates() - view->getMap()->getFirstFrontTemplate() > 0)
+		painter.drawImage(dirty_rect, above_template_cache, dirty_rect);
+	
+	display_cache_dirty_rect.setWidth(-1); // => !display_cache_dirty_rect.isValid()
+}
+
+qint64 MapWidget::cacheMemoryUsage() const
+{
+	auto bytes = [](const QImage& image) { return qint64(image.bytesPerLine()) * image.height(); };
+	auto layer_bytes = qint64(0);
+	for (const auto& layer : template_layers)
+		layer_bytes += bytes(layer.image);
+	return bytes(map_cache) + bytes(below_template_cache) + bytes(above_template_cache) + layer_bytes
+	       + qint64(display_cache.width()) * display_cache.height() * display_cache.depth() / 8;
+}
+
+void MapWidget::trimCaches(CacheManager::TrimLevel level)
+{
+	if (level < CacheManager::TrimLow)
+		return;
+	
+	if (isVisible())
+	{
+		// The layers of hidden templates are only kept for showing them quickly.
+		template_layers.erase(std::remove_if(begin(template_layers), end(template_layers), [this](const auto& layer) {
+			return !view || !view->isTemplateVisible(layer.temp);
+		}), end(template_layers));
+		return;
+	}
+	
+	map_cache = {};
+	below_template_cache = {};
+	above_template_cache = {};
+	template_layers.clear();
+	display_cache = {};
+	invalidateAllCaches();
+}
+
+QTransform MapWidget::mapToViewportTransform() const
+{
+	return view->worldTransform() * QTransform::fromTranslate(width() / 2.0, height() / 2.0);
+}
+
+void MapWidget::updateCachesForViewChange()
+{
+	// Caches which render fast enough are updated synchronously.
+	constexpr qint64 max_synchronous_duration = 40; // ms
+	constexpr int deferred_update_delay = 150; // ms
+	
+	last_view_change.start();
+	
+	if (map_cache.isNull()
+	    || (!cache_update_timer->isActive() && last_cache_update_duration <= max_synchronous_duration))
+	{
+		invalidateAllCaches();
+		return;
+	}
+	
+	if (!cache_update_timer->isActive())
+	{
+		const auto delta = cache_transform.inverted() * mapToViewportTransform();
+		const auto dx = qRound(delta.dx());
+		const auto dy = qRound(delta.dy());
+		if (delta.type() <= QTransform::TxTranslate
+		    && std::abs(delta.dx() - dx) < 0.05
+		    && std::abs(delta.dy() - dy) < 0.05)
+		{
+			// Pure translation: reuse the shifted caches.
+			shiftCache(dx, dy, map_cache);
+			shiftCache(dx, dy, below_template_cache);
+			shiftCache(dx, dy, above_template_cache);
+			for (auto& layer : template_layers)
+			{
+				shiftCache(dx, dy, layer.image);
+				moveDirtyRect(layer.dirty_rect, dx, dy);
+			}
+			shiftCache(dx, dy, display_cache);
+			moveDirtyRect(map_cache_dirty_rect, dx, dy);
+			moveDirtyRect(draft_rect, dx, dy);
+			moveDirtyRect(display_cache_dirty_rect, dx, dy);
+			moveDirtyRect(below_template_cache_dirty_rect, dx, dy);
+			moveDirtyRect(above_template_cache_dirty_rect, dx, dy);
+			cache_transform = mapToViewportTransform();
+			
+			const auto uncovered_x = (dx > 0) ? QRect(0, 0, dx, height()) : QRect(width() + dx, 0, -dx, height());
+			const auto uncovered_y = (dy > 0) ? QRect(0, 0, width(), dy) : QRect(0, height() + dy, width(), -dy);
+			if (dx != 0)
+				updateEverythingInRect(uncovered_x);
+			if (dy != 0)
+				updateEverythingInRect(uncovered_y);
+			update();
+			return;
+		}
+	}
+	
+	// Restarting the timer cancels a pending update.
+	cache_update_timer->start(deferred_update_delay);
+	update();
+}
+
+void MapWidget::deferredCacheUpdate()
+{
+	invalidateAllCaches();
+}
+
+void MapWidget::visibilityChanged(MapView::VisibilityFeature feature, bool /*active*/, const Template* /*temp*/)
+{
+	switch (feature)
+	{
+	case MapView::TemplateVisible:
+	case MapView::AllTemplatesHidden:
+		// The template layers are still valid.
+		markTemplateCompositionDirty();
+		break;
+	case MapView::MapVisible:
+		display_cache_dirty_rect = rect();
+		update();
+		break;
+	default:
+		updateEverything();
+	}
+}
+
+void MapWidget::removeTemplateLayer(int /*pos*/, const Template* temp)
+{
+	template_layers.erase(std::remove_if(begin(template_layers), end(template_layers), [temp](const auto& layer) {
+		return layer.temp == temp;
+	}), end(template_layers));
 }
 
 void MapWidget::shiftCache(int sx, int sy, QImage& cache)
@@ -23,12 +23,15 @@
 #define OPENORIENTEERING_MAP_WIDGET_H
 
 #include <functional>
+#include <vector>
 
 #include <Qt>
 #include <QtGlobal>
 #include <QCursor>
+#include <QElapsedTimer>
 #include <QImage>
 #include <QObject>
+#include <QPixmap>
 #include <QPoint>
 #include <QPointF>
 #include <QRect>
@@ -37,11 +40,14 @@
 #include <QSize>
 #include <QString>
 #include <QTime>
+#include <QTransform>
 #include <QVariant>
 #include <QWidget>
 
 #include "core/map_coord.h"
 #include "core/map_view.h"
+#include "core/renderables/renderable.h"
+#include "util/cache_manager.h"
 
 class QContextMenuEvent;
 class QEvent;
@@ -53,8 +59,8 @@ class QLabel;
 class QMouseEvent;
 class QPaintEvent;
 class QPainter;
-class QPixmap;
 class QResizeEvent;
+class QTimer;
 class QWheelEvent;
 
 namespace OpenOrienteering {
@@ -64,6 +70,7 @@ class GPSTemporaryMarkers;
 class MapEditorActivity;
 class MapEditorTool;
 class PieMenu;
+class Template;
 class TouchCursor;
 
 
@@ -80,7 +87,12 @@ class TouchCursor;
  *     visible part of all templates below the map</li>
  * <li>The <b>above template cache</b> contains the currently
  *     visible part of all templates above the map</li>
+ * <li>The <b>display cache</b> is the composition of the other caches,
+ *     with the map opacity applied</li>
  * </ul>
+ * The display cache is a QPixmap, which is in the native format of the
+ * window system and may be held by the graphics hardware. Painting the widget
+ * only needs to copy or transform this single pixmap.
  */
 class MapWidget : public QWidget
 {
@@ -225,8 +237,18 @@ public:
 	 *     pixels. Allows to specify zoom-independent extents.
 	 * @param front_cache If set to true, invalidates the cache for templates
 	 *     in front of the map, else invalidates the cache for templates behind the map.
+	 * @param temp The template which needs to be redrawn. If nullptr, all
+	 *     templates are redrawn in this rect.
 	 */
-	void markTemplateCacheDirty(const QRectF& view_rect, int pixel_border, bool front_cache);
+	void markTemplateCacheDirty(const QRectF& view_rect, int pixel_border, bool front_cache, const Template* temp = nullptr);
+	
+	/**
+	 * Recomposes the template caches from the cached template layers.
+	 * 
+	 * This is sufficient after changing the order of templates, or the
+	 * visibility or opacity of a template.
+	 */
+	void markTemplateCompositionDirty();
 	
 	/**
 	 * Mark a rectangular region given in map coordinates of the map cache
@@ -359,6 +381,12 @@ signals:
 private slots:
 	void updateDrawingLaterSlot();
 	
+	/** Handles visibility changes of the map, the templates and the grid. */
+	void visibilityChanged(OpenOrienteering::MapView::VisibilityFeature feature, bool active, const OpenOrienteering::Template* temp);
+	
+	/** Releases the cached layer of a template removed from the map. */
+	void removeTemplateLayer(int pos, const OpenOrienteering::Template* temp);
+	
 protected:
 	bool event(QEvent *event) override;
 	
@@ -393,8 +421,29 @@ private:
 	bool isAboveTemplateVisible() const;
 	/** Checks if there is any visible template below the map. */
 	bool isBelowTemplateVisible() const;
+	/** A cached image of a single template, drawn for the current view. */
+	struct TemplateLayer
+	{
+		const Template* temp;
+		QImage image;       ///< The template at full opacity on transparent background
+		QRect dirty_rect;   ///< The area which needs to be redrawn
+	};
+	/**
+	 * Returns the cached layer for the given template, creating it if needed.
+	 */
+	TemplateLayer& templateLayer(const Template* temp);
 	/**
-	 * Redraws the template cache.
+	 * Marks the given area of the template layers as dirty.
+	 * 
+	 * If temp is not nullptr, only the layer of this template is affected.
+	 */
+	void markTemplateLayersDirty(const QRect& dirty_rect, const Template* temp = nullptr);
+	/** Redraws a template layer in its dirty rect. */
+	void updateTemplateLayer(TemplateLayer& layer);
+	/**
+	 * Composes the template cache from the template layers.
+	 * 
+	 * Dirty template layers are redrawn first.
 	 * @param cache Reference to pointer to the cache.
 	 * @param dirty_rect Rectangle of the cache to redraw, in viewport coordinates.
 	 * @param first_template Lowest template index to draw.
@@ -409,8 +458,72 @@ private:
 	 *     drawing the map, else makes it transparent.
 	 */
 	void updateMapCache(bool use_background);
+	/**
+	 * Draws the map into the map cache dirty rect from cached tiles.
+	 * 
+	 * Missing tiles are rendered concurrently and added to the tile cache.
+	 * The objects' renderables must be up-to-date.
+	 */
+	void drawMapTiles(QPainter* painter, RenderConfig::Options options);
+	/** Returns the tile cache flags for the current map display settings. */
+	int tileFlags() const;
+	/**
+	 * Returns true while the user is interacting with the map.
+	 * 
+	 * This is the case while a mouse button is pressed, and for a short time
+	 * after the last mouse button release or view change.
+	 */
+	bool isInteracting();
+	/**
+	 * Redraws the areas of the map cache which were drawn as a draft.
+	 * 
+	 * While the user is still interacting, refinement is postponed.
+	 */
+	void refineDraft();
+	/**
+	 * Draws a preview of the map from the cached tiles of all zoom levels.
+	 * 
+	 * This is used while the caches do not match the current view, i.e.
+	 * while pinching and during deferred cache updates. The painter must be
+	 * set up for viewport coordinates of the current view.
+	 */
+	void drawTilePreview(QPainter* painter, const QRect& exposed) const;
 	/** Redraws all dirty caches. */
 	void updateAllDirtyCaches();
+	/** Composes the other caches into the display cache in its dirty rect. */
+	void updateDisplayCache();
+	/** Returns the memory used by the map, template and display caches. */
+	qint64 cacheMemoryUsage() const;
+	/**
+	 * Releases memory when the system runs low on memory.
+	 * 
+	 * The map tiles manage themselves. Hidden widgets release the other
+	 * caches, which are redrawn when the widget becomes visible again.
+	 */
+	void trimCaches(CacheManager::TrimLevel level);
+	/**
+	 * Returns the transformation from map coordinates to viewport coordinates
+	 * for the current view.
+	 */
+	QTransform mapToViewportTransform() const;
+	/**
+	 * Handles a view change without synchronously redrawing the caches.
+	 * 
+	 * A change which is a pure integer translation shifts the caches and
+	 * marks only the uncovered areas as dirty. Other changes are deferred:
+	 * Until cache_update_timer fires, paintEvent() shows the previous caches
+	 * transformed to the current view. Each new view change restarts the
+	 * timer, i.e. cancels the pending update.
+	 */
+	void updateCachesForViewChange();
+	/**
+	 * Invalidates the map and template caches, but keeps the map tiles.
+	 * 
+	 * This is to be used for view changes which do not change the map content.
+	 */
+	void invalidateAllCaches();
+	/** Finishes a deferred cache update, invalidating all caches. */
+	void deferredCacheUpdate();
 	/** Shifts the content in the cache by the given amount of pixels. */
 	void shiftCache(int sx, int sy, QImage& cache);
 	void shiftCache(int sx, int sy, QPixmap& cache);
@@ -453,6 +566,9 @@ private:
 	/** Draws a help message at the center of the MapWidget. */
 	void showHelpMessage(QPainter* painter, const QString& text) const;
 	
+	/** Draws the statistics of the profiler in the top left corner. */
+	void drawProfilerOverlay(QPainter* painter) const;
+	
 	/**
 	 * Updates the content of the zoom display.
 	 * 
@@ -499,10 +615,49 @@ private:
 	QImage above_template_cache;
 	QRect above_template_cache_dirty_rect;
 	
+	/**
+	 * The layers of the templates, from which the template caches are composed.
+	 * 
+	 * Layers are kept for hidden templates, too, so that they can be shown
+	 * again without redrawing as long as the view does not change.
+	 */
+	std::vector<TemplateLayer> template_layers;
+	
 	/** Map layer cache  */
 	QImage map_cache;
 	QRect map_cache_dirty_rect;
 	
+	/** Composition of the template and map caches */
+	QPixmap display_cache;
+	QRect display_cache_dirty_rect;
+	
+	/** The map-to-viewport transformation which the caches were drawn for. */
+	QTransform cache_transform;
+	
+	/** Triggers the deferred update of the caches after view changes. */
+	QTimer* cache_update_timer;
+	
+	/** The duration of the last full update of all caches, in milliseconds. */
+	qint64 last_cache_update_duration = 0;
+	
+	/**
+	 * The area of the map cache which was drawn as a fast draft.
+	 * 
+	 * Large areas are drawn without antialiasing during interaction.
+	 * They are redrawn in full quality when refine_timer fires and the user
+	 * paused.
+	 */
+	QRect draft_rect;
+	
+	/** Triggers the refinement of the draft area. */
+	QTimer* refine_timer;
+	
+	/** Measures the time since the last view change. */
+	QElapsedTimer last_view_change;
+	
+	/** Set while the map cache is drawn as a draft. */
+	bool drawing_draft = false;
+	
 	// Dirty regions for drawings (tools) and activities
 	/** Dirty rect for the current tool, in viewport coordinates (pixels). */
 	QRect drawing_dirty_rect;
@@ -545,6 +700,8 @@ private:
 	
 	/** @brief Indicates whether gesture recognition is enabled. */
 	bool gestures_enabled;
+	
+	CacheManager::Registration cache_registration;
 };
 
 
@@ -40,6 +40,7 @@
 #include <QList>
 #include <QListWidget>
 #include <QListWidgetItem>
+#include <QPixmap>
 #include <QPushButton>
 #include <QRegExp>
 #include <QSettings>
@@ -52,6 +53,7 @@
 #include "fileformats/file_format_registry.h"
 #include "gui/file_dialog.h"
 #include "gui/util_gui.h"
+#include "gui/map/symbol_set_catalog.h"
 #include "util/util.h"
 
 // IWYU pragma: no_forward_declare QLabel
@@ -97,12 +99,18 @@ NewMapDialog::NewMapDialog(QWidget* parent) : QDialog(parent, Qt::WindowSystemMe
 	
 	setLayout(layout);
 	
+	catalog = new SymbolSetCatalog(this);
+	connect(catalog, &SymbolSetCatalog::entryAdded, this, &NewMapDialog::symbolSetIndexed);
+	
 	loadSymbolSetMap();
+	QFileInfoList symbol_set_files;
 	for (auto& item : symbol_set_map)
 	{
 		if (item.first.toInt() != 0)
 			scale_combo->addItem(item.first);
+		symbol_set_files.append(item.second);
 	}
+	catalog->index(symbol_set_files);
 	
 	QSettings settings;
 	settings.beginGroup(QString::fromLatin1("NewMapDialog"));
@@ -173,17 +181,11 @@ void NewMapDialog::updateSymbolSetList()
 	item->setIcon(QIcon(QString::fromLatin1(":/images/new.png")));
 	symbol_set_list->addItem(item);
 	
-	QIcon control(QString::fromLatin1(":/images/control.png"));
 	auto it = symbol_set_map.find(scale);
 	if (it != symbol_set_map.end())
 	{
 		for (auto&& symbol_set : it->second)
-		{
-			item = new QListWidgetItem(symbol_set.completeBaseName());
-			item->setData(Qt::UserRole, symbol_set.canonicalFilePath());
-			item->setIcon(control);
-			symbol_set_list->addItem(item);
-		}
+			addSymbolSetItem(symbol_set, {});
 	}
 	
 	if (! symbol_set_matching->isChecked())
@@ -197,12 +199,7 @@ void NewMapDialog::updateSymbolSetList()
 			QString remark = QLatin1String(" (") + QLatin1String(is_scale ? ("1 : ") : "") + it->first + QLatin1Char(')');
 			
 			for (auto&& symbol_set : it->second)
-			{
-				item = new QListWidgetItem(symbol_set.completeBaseName() + remark);
-				item->setData(Qt::UserRole, symbol_set.canonicalFilePath());
-				item->setIcon(control);
-				symbol_set_list->addItem(item);
-			}
+				addSymbolSetItem(symbol_set, remark);
 		}
 	}
 	
@@ -215,6 +212,33 @@ void NewMapDialog::updateSymbolSetList()
 	symbol_set_list->setCurrentRow(1);
 }
 
+void NewMapDialog::addSymbolSetItem(const QFileInfo& symbol_set, const QString& remark)
+{
+	auto* item = new QListWidgetItem(symbol_set.completeBaseName() + remark);
+	item->setData(Qt::UserRole, symbol_set.canonicalFilePath());
+	item->setIcon(QIcon(QString::fromLatin1(":/images/control.png")));
+	symbol_set_list->addItem(item);
+	symbolSetIndexed(symbol_set.canonicalFilePath());
+}
+
+void NewMapDialog::symbolSetIndexed(const QString& path)
+{
+	auto const* entry = catalog->find(QFileInfo(path));
+	if (!entry)
+		return;
+	
+	for (int i = 0; i < symbol_set_list->count(); ++i)
+	{
+		auto* item = symbol_set_list->item(i);
+		if (item->data(Qt::UserRole).toString() != path)
+			continue;
+		
+		if (!entry->icon.isNull())
+			item->setIcon(QIcon(QPixmap::fromImage(entry->icon)));
+		item->setToolTip(tr("%n symbols, nominal scale 1:%1", nullptr, entry->symbol_count).arg(entry->scale));
+	}
+}
+
 void NewMapDialog::symbolSetDoubleClicked(QListWidgetItem* item)
 {
 	symbol_set_list->setCurrentItem(item);
@@ -39,6 +39,8 @@ class QWidget;
 
 namespace OpenOrienteering {
 
+class SymbolSetCatalog;
+
 
 /**
  * Dialog for creating a new map.
@@ -113,6 +115,12 @@ protected:
 	/** Open a dialog for loading a symbol set from a file. */
 	void showFileDialog();
 	
+	/** Adds a list item for the given symbol set file. */
+	void addSymbolSetItem(const QFileInfo& symbol_set, const QString& remark);
+	
+	/** Updates icon and tooltip of the items for the given symbol set path. */
+	void symbolSetIndexed(const QString& path);
+	
 private:
 	/** A mapping from map scales to lists of matching symbol set. */
 	SymbolSetMap symbol_set_map;	// scale to vector of symbol set names; TODO: store that globally / dir watcher
@@ -131,6 +139,9 @@ private:
 	
 	/** The button for accepting the selected map scale and symbol set. */
 	QPushButton* create_button;
+	
+	/** Scale, symbol count and icon of the symbol sets. */
+	SymbolSetCatalog* catalog;
 };
 
 
@@ -0,0 +1,236 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "symbol_set_catalog.h"
+
+#include <utility>
+#include <vector>
+
+#include <Qt>
+#include <QByteArray>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QIODevice>
+#include <QLatin1String>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include "mapper_config.h"
+#include "core/map.h"
+#include "core/symbols/symbol.h"
+#include "fileformats/file_format_registry.h"
+#include "fileformats/file_import_export.h"
+
+
+namespace OpenOrienteering {
+
+namespace {
+
+/// The identification of the catalog file.
+constexpr quint32 catalog_magic = 0x4f4d5343;  // "OMSC"
+
+/// The side length of the preview icons.
+constexpr int icon_size = 32;
+
+
+bool isCurrent(const SymbolSetCatalog::Entry& entry, const QFileInfo& file)
+{
+	return entry.size == file.size() && entry.last_modified == file.lastModified();
+}
+
+
+}  // namespace
+
+
+
+SymbolSetCatalog::SymbolSetCatalog(QObject* parent)
+: QObject(parent)
+{
+	static const int registered = qRegisterMetaType<SymbolSetCatalog::Entry>();
+	Q_UNUSED(registered)
+	
+	connect(this, &SymbolSetCatalog::entryRead, this, &SymbolSetCatalog::addEntry, Qt::QueuedConnection);
+	load();
+}
+
+SymbolSetCatalog::~SymbolSetCatalog()
+{
+	stopIndexing();
+	if (modified)
+		save();
+}
+
+
+const SymbolSetCatalog::Entry* SymbolSetCatalog::find(const QFileInfo& file) const
+{
+	auto const it = entries.find(file.canonicalFilePath());
+	if (it == entries.end() || !isCurrent(it->second, file))
+		return nullptr;
+	return &it->second;
+}
+
+
+void SymbolSetCatalog::index(const QFileInfoList& files)
+{
+	stopIndexing();
+	
+	QStringList paths;
+	for (auto const& file : files)
+	{
+		if (!find(file))
+			paths.push_back(file.canonicalFilePath());
+	}
+	if (paths.isEmpty())
+		return;
+	
+	thread = std::thread([this, paths]() {
+		for (auto const& path : paths)
+		{
+			if (stop_requested)
+				break;
+			auto entry = readEntry(path);
+			if (!entry.path.isEmpty())
+				emit entryRead(entry);
+		}
+	});
+}
+
+void SymbolSetCatalog::stopIndexing()
+{
+	if (thread.joinable())
+	{
+		stop_requested = true;
+		thread.join();
+	}
+	stop_requested = false;
+}
+
+
+void SymbolSetCatalog::addEntry(const SymbolSetCatalog::Entry& entry)
+{
+	entries[entry.path] = entry;
+	modified = true;
+	emit entryAdded(entry.path);
+}
+
+
+// static
+SymbolSetCatalog::Entry SymbolSetCatalog::readEntry(const QString& path)
+{
+	Entry entry;
+	
+	Map map;
+	auto importer = FileFormats.makeImporter(path, map);
+	if (!importer)
+		return entry;
+	importer->setLoadSymbolsOnly(true);
+	if (!importer->doImport())
+		return entry;
+	
+	auto const file = QFileInfo(path);
+	entry.path = file.canonicalFilePath();
+	entry.size = file.size();
+	entry.last_modified = file.lastModified();
+	entry.scale = map.getScaleDenominator();
+	for (int i = 0; i < map.getNumSymbols(); ++i)
+	{
+		auto const* symbol = map.getSymbol(i);
+		if (symbol->isHidden())
+			continue;
+		if (entry.icon.isNull())
+			entry.icon = symbol->createIcon(map, icon_size);
+		++entry.symbol_count;
+	}
+	return entry;
+}
+
+
+// static
+QString SymbolSetCatalog::cachePath()
+{
+	return QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+	       + QLatin1String("/symbol-sets.catalog");
+}
+
+
+void SymbolSetCatalog::load()
+{
+	QFile file(cachePath());
+	if (!file.open(QIODevice::ReadOnly))
+		return;
+	
+	QDataStream stream(&file);
+	stream.setVersion(QDataStream::Qt_5_5);
+	
+	quint32 magic;
+	QByteArray version;
+	qint32 count;
+	stream >> magic >> version >> count;
+	// The icons depend on the program version.
+	if (stream.status() != QDataStream::Ok || magic != catalog_magic || version != APP_VERSION)
+		return;
+	
+	for (qint32 i = 0; i < count; ++i)
+	{
+		Entry entry;
+		stream >> entry.path >> entry.size >> entry.last_modified
+		       >> entry.scale >> entry.symbol_count >> entry.icon;
+		if (stream.status() != QDataStream::Ok)
+			break;
+		auto key = entry.path;
+		entries[std::move(key)] = std::move(entry);
+	}
+}
+
+void SymbolSetCatalog::save() const
+{
+	auto const path = cachePath();
+	if (!QDir().mkpath(QFileInfo(path).absolutePath()))
+		return;
+	
+	QSaveFile file(path);
+	if (!file.open(QIODevice::WriteOnly))
+		return;
+	
+	QDataStream stream(&file);
+	stream.setVersion(QDataStream::Qt_5_5);
+	
+	// Entries of removed files are dropped.
+	std::vector<const Entry*> existing;
+	for (auto const& item : entries)
+	{
+		if (QFileInfo::exists(item.first))
+			existing.push_back(&item.second);
+	}
+	
+	stream << catalog_magic << QByteArray(APP_VERSION) << qint32(existing.size());
+	for (auto const* entry : existing)
+	{
+		stream << entry->path << entry->size << entry->last_modified
+		       << entry->scale << entry->symbol_count << entry->icon;
+	}
+	if (stream.status() == QDataStream::Ok)
+		file.commit();
+}
+
+
+}  // namespace OpenOrienteering
@@ -0,0 +1,132 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef OPENORIENTEERING_SYMBOL_SET_CATALOG_H
+#define OPENORIENTEERING_SYMBOL_SET_CATALOG_H
+
+#include <atomic>
+#include <map>
+#include <thread>
+
+#include <QtGlobal>
+#include <QDateTime>
+#include <QFileInfoList>
+#include <QImage>
+#include <QMetaType>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+
+class QFileInfo;
+
+
+namespace OpenOrienteering {
+
+/**
+ * A cached catalog of symbol set files.
+ * 
+ * For each symbol set, the catalog provides the nominal scale, the number of
+ * symbols, and a preview icon. The catalog is stored in the cache directory.
+ * Entries remain valid as long as the size and the modification time of
+ * their files are unchanged. Other files are indexed on a background thread,
+ * reporting each new entry by entryAdded().
+ */
+class SymbolSetCatalog : public QObject
+{
+	Q_OBJECT
+	
+public:
+	/** The catalog information about a symbol set file. */
+	struct Entry
+	{
+		QString path;              ///< The canonical file path.
+		qint64 size = -1;
+		QDateTime last_modified;
+		quint32 scale = 0;         ///< The nominal scale denominator.
+		qint32 symbol_count = 0;
+		QImage icon;               ///< May be null.
+	};
+	
+	explicit SymbolSetCatalog(QObject* parent = nullptr);
+	
+	SymbolSetCatalog(const SymbolSetCatalog&) = delete;
+	SymbolSetCatalog& operator=(const SymbolSetCatalog&) = delete;
+	
+	/**
+	 * Stops indexing, and saves the catalog if it was modified.
+	 */
+	~SymbolSetCatalog() override;
+	
+	/**
+	 * Returns the up-to-date entry for the given file, or nullptr.
+	 */
+	const Entry* find(const QFileInfo& file) const;
+	
+	/**
+	 * Starts indexing those of the given files which have no up-to-date entry.
+	 * 
+	 * Indexing which is still running is stopped first.
+	 */
+	void index(const QFileInfoList& files);
+	
+	/**
+	 * Reads the catalog information from the given file.
+	 * 
+	 * This uses a symbols-only import. It may be called from any thread.
+	 * On error, the returned entry has an empty path.
+	 */
+	static Entry readEntry(const QString& path);
+	
+	/**
+	 * Returns the path of the file which stores the catalog.
+	 */
+	static QString cachePath();
+	
+signals:
+	/**
+	 * Reports a new entry.
+	 */
+	void entryAdded(const QString& path);
+	
+	/**
+	 * Forwards an entry from the indexing thread.
+	 */
+	void entryRead(const SymbolSetCatalog::Entry& entry);
+	
+private:
+	void load();
+	void save() const;
+	
+	void addEntry(const SymbolSetCatalog::Entry& entry);
+	
+	void stopIndexing();
+	
+	std::map<QString, Entry> entries;
+	std::thread thread;
+	std::atomic<bool> stop_requested { false };
+	bool modified = false;
+};
+
+
+}  // namespace OpenOrienteering
+
+Q_DECLARE_METATYPE(OpenOrienteering::SymbolSetCatalog::Entry)
+
+#endif
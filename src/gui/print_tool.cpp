@@ -25,6 +25,9 @@
 
 #include <QMouseEvent>
 #include <QPainter>
+#include <QPointF>
+#include <QRectF>
+#include <QSizeF>
 
 #include "core/map.h"
 #include "core/map_printer.h"
@@ -57,7 +60,10 @@ PrintTool::~PrintTool()
 void PrintTool::init()
 {
 	setStatusBarText(tr("<b>Drag</b>: Move the map, the print area or the area's borders. "));
-	updatePrintArea();
+	// The region outside the print area is darkened,
+	// so the whole map area needs to be redrawn initially.
+	// TODO: Replace with a more explicit way of marking the whole map area as dirty.
+	editor->getMap()->setDrawingBoundingBox(QRectF(-1000000, -1000000, 2000000, 2000000), 0);
 	
 	MapEditorTool::init();
 }
@@ -247,9 +253,19 @@ void PrintTool::draw(QPainter* painter, MapWidget* widget)
 
 void PrintTool::updatePrintArea()
 {
-	// The print area visualization is updated by redrawing the whole map.
-	// TODO: Replace with a more explicit way of marking the whole map area as dirty.
-	editor->getMap()->setDrawingBoundingBox(QRectF(-1000000, -1000000, 2000000, 2000000), 0);
+	// Only the print area and the page breaks change. The map widget
+	// redraws the previous and the new drawing rect from its map cache.
+	QRectF area = map_printer->getPrintArea();
+	const auto& h_page_pos = map_printer->horizontalPagePositions();
+	const auto& v_page_pos = map_printer->verticalPagePositions();
+	if (!h_page_pos.empty() && !v_page_pos.empty())
+	{
+		const auto page_size = map_printer->getPageFormat().page_rect.size() / map_printer->getScaleAdjustment();
+		area = area.united(QRectF(QPointF(h_page_pos.front(), v_page_pos.front()),
+		                          QPointF(h_page_pos.back() + page_size.width(), v_page_pos.back() + page_size.height())));
+	}
+	// The border covers the width of the marker pen.
+	editor->getMap()->setDrawingBoundingBox(area, 4);
 }
 
 void PrintTool::updateDragging(const MapCoordF& mouse_pos_map)
@@ -64,6 +64,7 @@
 #include <QScrollArea>
 #include <QScrollBar>
 #include <QSignalBlocker>
+#include <QSize>
 #include <QSizeF>
 #include <QSpacerItem>
 #include <QSpinBox>
@@ -96,6 +97,10 @@
 #include "util/backports.h"  // IWYU pragma: keep
 #include "util/scoped_signals_blocker.h"
 
+#ifdef MAPPER_USE_GDAL
+#  include "gdal/gdal_image_writer.h"
+#endif
+
 
 namespace OpenOrienteering {
 
@@ -1193,31 +1198,29 @@ void PrintWidget::exportToImage()
 		path.append(QString::fromLatin1(".png"));
 	}
 	
-	qreal pixel_per_mm = map_printer->getOptions().resolution / 25.4;
-	int print_width = qRound(map_printer->getPrintAreaPaperSize().width() * pixel_per_mm);
-	int print_height = qRound(map_printer->getPrintAreaPaperSize().height() * pixel_per_mm);
-	QImage image(print_width, print_height, QImage::Format_ARGB32_Premultiplied);
-	if (image.isNull())
+#ifdef MAPPER_USE_GDAL
+	if (path.endsWith(QLatin1String(".tif"), Qt::CaseInsensitive) || path.endsWith(QLatin1String(".tiff"), Qt::CaseInsensitive))
 	{
-		QMessageBox::warning(this, tr("Error"), tr("Failed to prepare the image. Not enough memory."));
+		qreal pixel_per_mm = map_printer->getOptions().resolution / 25.4;
+		int print_width = qRound(map_printer->getPrintAreaPaperSize().width() * pixel_per_mm);
+		int print_height = qRound(map_printer->getPrintAreaPaperSize().height() * pixel_per_mm);
+		int dots_per_meter = qRound(pixel_per_mm * 1000);
+		exportToGeoTiff(path, QSize(print_width, print_height), dots_per_meter);
 		return;
 	}
-	
-	int dots_per_meter = qRound(pixel_per_mm * 1000);
-	image.setDotsPerMeterX(dots_per_meter);
-	image.setDotsPerMeterY(dots_per_meter);
-	
-	image.fill(QColor(Qt::white));
+#endif
 	
 #if 0  // Pointless unless drawPage drives the event loop and sends progress
 	PrintProgressDialog progress(map_printer, main_window);
 	progress.setWindowTitle(tr("Export map ..."));
 #endif
 	
-	// Export the map
-	QPainter p(&image);
-	map_printer->drawPage(&p, map_printer->getPrintArea(), &image);
-	p.end();
+	QImage image = map_printer->drawPrintAreaImage();
+	if (image.isNull())
+	{
+		QMessageBox::warning(this, tr("Error"), tr("Failed to prepare the image. Not enough memory."));
+		return;
+	}
 	if (!image.save(path))
 	{
 		QMessageBox::warning(this, tr("Error"), tr("Failed to save the image. Does the path exist? Do you have sufficient rights?"));
@@ -1231,7 +1234,41 @@ void PrintWidget::exportToImage()
 	}
 }
 
-void PrintWidget::exportWorldFile(const QString& path) const
+#ifdef MAPPER_USE_GDAL
+
+void PrintWidget::exportToGeoTiff(const QString& path, const QSize& size, int dots_per_meter)
+{
+	// Tiles are written as soon as a strip of full tile rows is complete.
+	constexpr int tile_size = 256;
+	constexpr int strip_bytes = 16 * 1024 * 1024;
+	const auto strip_height = tile_size * qMax(1, strip_bytes / qMax(1, 4 * size.width() * tile_size));
+	
+	const auto& georef = map->getGeoreferencing();
+	GdalImageWriter writer(path);
+	auto ok = writer.open(size, dots_per_meter)
+	          && writer.setGeoreferencing(imagePixelToWorld(), georef.isLocal() ? QString{} : georef.getProjectedCRSSpec())
+	          && map_printer->drawPageStrips(map_printer->getPrintArea(), size, strip_height, [&writer](const QImage& strip, int top) {
+	                 return writer.write(strip, top);
+	             })
+	          && writer.finish();
+	if (!ok)
+	{
+		auto message = writer.errorString();
+		if (message.isEmpty())
+			message = tr("Failed to prepare the image. Not enough memory.");
+		QMessageBox::warning(this, tr("Error"), message);
+		return;
+	}
+	
+	main_window->showStatusBarMessage(tr("Exported successfully to %1").arg(path), 4000);
+	if (world_file_check->isChecked())
+		exportWorldFile(path);  /// \todo Handle errors
+	emit finished(0);
+}
+
+#endif
+
+QTransform PrintWidget::imagePixelToWorld() const
 {
 	const auto& georef = map->getGeoreferencing();
 	const auto& mm_to_world = georef.mapToProjected();
@@ -1241,8 +1278,12 @@ void PrintWidget::exportWorldFile(const QString& path) const
 	const auto xskew  = mm_to_world.m12() / pixel_per_mm;
 	const auto yskew  = mm_to_world.m21() / pixel_per_mm;
 	const auto top_left = georef.toProjectedCoords(MapCoord{map_printer->getPrintArea().topLeft()});
-	const QTransform pixel_to_world(xscale, yskew, 0, xskew, yscale, 0, top_left.x(), top_left.y());
-	const WorldFile world_file(pixel_to_world);
+	return { xscale, yskew, 0, xskew, yscale, 0, top_left.x(), top_left.y() };
+}
+
+void PrintWidget::exportWorldFile(const QString& path) const
+{
+	const WorldFile world_file(imagePixelToWorld());
 	world_file.save(WorldFile::pathForImage(path));
 }
 
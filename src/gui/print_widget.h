@@ -49,6 +49,7 @@ class QRectF;
 class QScrollArea;
 class QSpinBox;
 class QToolButton;
+class QTransform;
 
 namespace OpenOrienteering {
 
@@ -257,6 +258,14 @@ protected:
 	/** Exports to an image file. */
 	void exportToImage();
 
+#ifdef MAPPER_USE_GDAL
+	/** Exports to a tiled GeoTIFF file, writing the image while it is drawn. */
+	void exportToGeoTiff(const QString& path, const QSize& size, int dots_per_meter);
+#endif
+	
+	/** Returns the transformation from image pixels to projected coordinates. */
+	QTransform imagePixelToWorld() const;
+	
 	/** Export a world file */
 	void exportWorldFile(const QString& path) const;
 	
@@ -112,7 +112,12 @@ SelectCRSDialog::SelectCRSDialog(
 	setLayout(layout);
 	
 	connect(crs_selector, &CRSSelector::crsChanged, this, &SelectCRSDialog::updateWidgets);
-	connect(button_box, &QDialogButtonBox::accepted, this, &SelectCRSDialog::accept);
+	connect(button_box, &QDialogButtonBox::accepted, this, [this]() {
+		// Validates pending parameter edits, updating the OK button.
+		crs_selector->commitParameterEdits();
+		if (button_box->button(QDialogButtonBox::Ok)->isEnabled())
+			accept();
+	});
 	connect(button_box, &QDialogButtonBox::rejected, this, &SelectCRSDialog::reject);
 	
 	updateWidgets();
@@ -380,7 +380,7 @@ void SymbolReplacementDialog::updateMappingTable()
 					}
 				}
 			};
-			object_map.applyOnMatchingObjects(update_matching, std::cref(item.query));
+			object_map.applyOnMatchingObjects(update_matching, item.query);
 			if (matching_types != Symbol::NoSymbol)
 			{
 				compatible_symbols = matching_types;
@@ -21,14 +21,22 @@
 
 #include "symbol_setting_dialog.h"
 
+#include <utility>
+
+#include <Qt>
 #include <QColorDialog>
 #include <QDialogButtonBox>
 #include <QGridLayout>
 #include <QHBoxLayout>
+#include <QImage>
 #include <QLabel>
 #include <QMenu>
+#include <QMetaObject>
+#include <QPixmap>
 #include <QPushButton>
 #include <QSplitter>
+#include <QThread>
+#include <QTimer>
 #include <QToolButton>
 #include <QVBoxLayout>
 
@@ -45,12 +53,68 @@
 #include "gui/map/map_widget.h"
 #include "gui/symbols/symbol_properties_widget.h"
 #include "gui/widgets/template_list_widget.h"
+#include "settings.h"
 #include "templates/template.h"
 #include "templates/template_image.h"
 
 
 namespace OpenOrienteering {
 
+namespace {
+
+/**
+ * The time to wait for further modifications before updating the preview,
+ * in milliseconds.
+ */
+constexpr int preview_update_delay = 150;
+
+}  // namespace
+
+
+
+/**
+ * Renders the icon of a snapshot of the edited symbol.
+ * 
+ * Icons of complex symbols may take long to render, so this is done in a
+ * separate thread. The thread works on its own copy of the symbol, so the
+ * dialog may continue to modify the edited symbol.
+ */
+class SymbolSettingDialog::IconRenderer : public QThread
+{
+	// no Q_OBJECT, completion is signaled via a queued invocation.
+public:
+	IconRenderer(SymbolSettingDialog& dialog, std::unique_ptr<Symbol> symbol)
+	: dialog(dialog)
+	, symbol(std::move(symbol))
+	, side_length(Settings::getInstance().getSymbolWidgetIconSizePx())
+	, use_custom_icon(Settings::getInstance().getSetting(Settings::SymbolWidget_ShowCustomIcons).toBool())
+	{}
+	
+	/** Returns the rendered icon. Valid after the thread finished. */
+	const QImage& result() const { return icon; }
+	
+protected:
+	void run() override
+	{
+		// Intermediate states are not stored in the persistent icon cache.
+		auto const custom_icon = symbol->getCustomIcon();
+		if (use_custom_icon && !custom_icon.isNull())
+			icon = custom_icon.scaled(side_length, side_length, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+		else
+			icon = symbol->createIcon(*dialog.source_map, side_length);
+		QMetaObject::invokeMethod(&dialog, "finishIconRendering", Qt::QueuedConnection);
+	}
+	
+private:
+	SymbolSettingDialog& dialog;
+	std::unique_ptr<Symbol> symbol;
+	int side_length;
+	bool use_custom_icon;
+	QImage icon;
+};
+
+
+
 SymbolSettingDialog::SymbolSettingDialog(const Symbol* source_symbol, Map* source_map, QWidget* parent)
 : QDialog(parent, Qt::CustomizeWindowHint | Qt::WindowTitleHint | Qt::WindowMaximizeButtonHint)
 , source_map(source_map)
@@ -62,6 +126,11 @@ SymbolSettingDialog::SymbolSettingDialog(const Symbol* source_symbol, Map* sourc
 	setWindowTitle(tr("Symbol settings"));
 	setSizeGripEnabled(true);
 	
+	preview_timer = new QTimer(this);
+	preview_timer->setSingleShot(true);
+	preview_timer->setInterval(preview_update_delay);
+	connect(preview_timer, &QTimer::timeout, this, &SymbolSettingDialog::updatePreview);
+	
 	symbol->setHidden(false);
 	
 	symbol_icon_label = new QLabel();
@@ -173,7 +242,11 @@ SymbolSettingDialog::SymbolSettingDialog(const Symbol* source_symbol, Map* sourc
 	updateButtons();
 }
 
-SymbolSettingDialog::~SymbolSettingDialog() = default; // not inlined
+SymbolSettingDialog::~SymbolSettingDialog()
+{
+	if (icon_renderer)
+		icon_renderer->wait();
+}
 
 
 
@@ -186,11 +259,38 @@ std::unique_ptr<Symbol> SymbolSettingDialog::getNewSymbol() const
 
 void SymbolSettingDialog::updatePreview()
 {
+	preview_timer->stop();
 	symbol->resetIcon();
-	symbol_icon_label->setPixmap(QPixmap::fromImage(symbol->getIcon(source_map)));
+	startIconRendering();
 	preview_map->updateAllObjects();
 }
 
+void SymbolSettingDialog::startIconRendering()
+{
+	if (icon_renderer)
+	{
+		// Render again when the current rendering is finished.
+		icon_outdated = true;
+		return;
+	}
+	
+	icon_outdated = false;
+	icon_renderer = std::make_unique<IconRenderer>(*this, duplicate(*symbol));
+	icon_renderer->start(QThread::LowPriority);
+}
+
+void SymbolSettingDialog::finishIconRendering()
+{
+	if (!icon_renderer)
+		return;
+	
+	icon_renderer->wait();
+	symbol_icon_label->setPixmap(QPixmap::fromImage(icon_renderer->result()));
+	icon_renderer.reset();
+	if (icon_outdated)
+		startIconRendering();
+}
+
 void SymbolSettingDialog::loadTemplateClicked()
 {
 	auto new_template = TemplateListWidget::showOpenTemplateDialog(this, preview_controller);
@@ -481,7 +581,7 @@ void SymbolSettingDialog::setSymbolModified(bool modified)
 {
 	symbol_modified = modified;
 	updateSymbolLabel();
-	updatePreview();
+	preview_timer->start();
 	updateButtons();
 }
 
@@ -30,6 +30,7 @@
 
 class QLabel;
 class QPushButton;
+class QTimer;
 class QToolButton;
 class QWidget;
 
@@ -111,7 +112,11 @@ public slots:
 	void reset();
 	
 	/**
-	 * Sets the modification status of the dialog, and triggers a screen update.
+	 * Sets the modification status of the dialog, and schedules an update
+	 * of the preview.
+	 * 
+	 * Consecutive modifications, e.g. while typing a value, are collected
+	 * into a single update.
 	 */
 	void setSymbolModified(bool modified = true);
 	
@@ -122,6 +127,8 @@ public slots:
 	
 	/** 
 	 * Updates the preview from the current symbol settings.
+	 * 
+	 * The symbol icon is rendered in the background.
 	 */
 	void updatePreview();
 	
@@ -147,6 +154,13 @@ protected slots:
 	 */
 	void centerTemplateGravity();
 	
+private slots:
+	/**
+	 * Shows the icon from the icon renderer, and starts another
+	 * rendering if the symbol was modified in the meantime.
+	 */
+	void finishIconRendering();
+	
 protected:
 	/**
 	 * Populates the preview map for the symbol.
@@ -154,6 +168,13 @@ protected:
 	void createPreviewMap();
 	
 private:
+	class IconRenderer;
+	
+	/**
+	 * Starts rendering the icon of the current symbol in the background.
+	 */
+	void startIconRendering();
+	
 	Map* source_map;
 	const Symbol* source_symbol;
 	std::unique_ptr<const Symbol> source_symbol_copy;
@@ -177,6 +198,10 @@ private:
 	QLabel* symbol_icon_label;
 	QLabel* symbol_text_label;
 	
+	QTimer* preview_timer;
+	std::unique_ptr<IconRenderer> icon_renderer;
+	bool icon_outdated = false;
+	
 	bool symbol_modified;
 };
 
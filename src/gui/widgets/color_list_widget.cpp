@@ -21,6 +21,11 @@
 
 #include "color_list_widget.h"
 
+#include <cstddef>
+#include <numeric>
+#include <utility>
+#include <vector>
+
 #include <Qt>
 #include <QtGlobal>
 #include <QAbstractButton>
@@ -64,6 +69,23 @@
 
 namespace OpenOrienteering {
 
+namespace {
+
+/**
+ * Returns the mapping of color priorities for swapping two adjacent colors.
+ */
+std::vector<int> swappedPriorities(int num_colors, int first, int second)
+{
+	std::vector<int> priorities(std::size_t(num_colors));
+	std::iota(begin(priorities), end(priorities), 0);
+	std::swap(priorities[std::size_t(first)], priorities[std::size_t(second)]);
+	return priorities;
+}
+
+}  // namespace
+
+
+
 ColorListWidget::ColorListWidget(Map* map, MainWindow* window, QWidget* parent)
 : QWidget(parent)
 , map(map)
@@ -272,7 +294,7 @@ void ColorListWidget::moveColorUp()
 	color_table->setCurrentCell(row - 1, color_table->currentColumn());
 	
 	map->setColorsDirty();
-	map->updateAllObjects();
+	map->remapColorPriorities(swappedPriorities(map->getNumColors(), row - 1, row));
 }
 
 void ColorListWidget::moveColorDown()
@@ -291,7 +313,7 @@ void ColorListWidget::moveColorDown()
 	color_table->setCurrentCell(row + 1, color_table->currentColumn());
 	
 	map->setColorsDirty();
-	map->updateAllObjects();
+	map->remapColorPriorities(swappedPriorities(map->getNumColors(), row, row + 1));
 }
 
 // slot
@@ -309,7 +331,7 @@ void ColorListWidget::editCurrentColor()
 			*color = dialog.getColor();
 			map->setColor(color, row); // trigger colorChanged signal
 			map->setColorsDirty();
-			map->updateAllObjects();
+			map->updateColorAppearance();
 		}
 	}
 }
@@ -352,7 +374,7 @@ void ColorListWidget::cellChange(int row, int column)
 	
 	map->setColor(color, row); // trigger colorChanged signal
 	map->setColorsDirty();
-	map->updateAllObjects();
+	map->updateColorAppearance();
 }
 
 void ColorListWidget::currentCellChange(int current_row, int current_column, int previous_row, int previous_column)
@@ -31,6 +31,7 @@
 #include <QLatin1Char>
 #include <QLayoutItem>
 #include <QSignalBlocker>
+#include <QTimer>
 #include <QVariant>
 #include <QWidget>
 
@@ -70,6 +71,11 @@ QString ParameterKey(const QWidget* w)
 	return w->property(crsParameterKeyProperty).toString();
 }
 
+/**
+ * The pause in parameter editing after which crsChanged() is emitted, in ms.
+ */
+constexpr int edit_delay = 400;
+
 }  // namespace
 
 
@@ -80,11 +86,16 @@ CRSSelector::CRSSelector(const Georeferencing& georef, QWidget* parent)
  , dialog_layout(nullptr)
  , num_custom_items(0)
  , configured_crs(nullptr)
+ , edit_timer(new QTimer(this))
 {
 	for (auto&& crs : CRSTemplateRegistry().list())
 	{
 		addItem(crs->name(), QVariant(crs->id()));
 	}
+	
+	edit_timer->setSingleShot(true);
+	edit_timer->setInterval(edit_delay);
+	connect(edit_timer, &QTimer::timeout, this, &CRSSelector::crsChanged);
 }
 
 CRSSelector::~CRSSelector() = default;
@@ -155,6 +166,7 @@ void CRSSelector::setCurrentCRS(const CRSTemplate* crs, const std::vector<QStrin
 	{
 		Q_ASSERT(crs->parameters().size() == values.size());
 		
+		edit_timer->stop();
 		int index = findData(QVariant(crs->id()));
 		setCurrentIndex(index);
 		
@@ -169,6 +181,7 @@ void CRSSelector::setCurrentCRS(const CRSTemplate* crs, const std::vector<QStrin
 void CRSSelector::setCurrentItem(unsigned short id)
 {
 	QSignalBlocker block(this);
+	edit_timer->stop();
 	int index = findData(QVariant(id));
 	setCurrentIndex(index);
 	
@@ -209,6 +222,15 @@ std::vector<QString> CRSSelector::parameters() const
 	return values;
 }
 
+void CRSSelector::commitParameterEdits()
+{
+	if (edit_timer->isActive())
+	{
+		edit_timer->stop();
+		emit crsChanged();
+	}
+}
+
 const Georeferencing& CRSSelector::georeferencing() const
 {
 	return georef;
@@ -216,13 +238,14 @@ const Georeferencing& CRSSelector::georeferencing() const
 
 void CRSSelector::crsSelectionChanged()
 {
+	edit_timer->stop();
 	configureParameterFields();
 	emit crsChanged();
 }
 
 void CRSSelector::crsParameterEdited()
 {
-	emit crsChanged();
+	edit_timer->start();
 }
 
 
@@ -32,6 +32,7 @@
 
 class QEvent;
 class QFormLayout;
+class QTimer;
 class QWidget;
 
 namespace OpenOrienteering {
@@ -50,6 +51,11 @@ class Georeferencing;
  * into a QFormLayout. Upon CRS selection changes it will add and remove extra
  * lines below itself, for editing CRS parameters.
  * 
+ * Each crsChanged() signal typically makes the receiver validate the new CRS
+ * spec through PROJ. While the user is typing parameter values, the signal is
+ * delayed until the editing pauses, so that only the CRS which the user
+ * eventually selects is validated, not every intermediate value.
+ * 
  * \todo Consider making this a QWidget which has got a QCombobox - the public
  *       QComboBox API should better not be exposed. The combobox' signals could
  *       no longer be block from clients.
@@ -125,6 +131,13 @@ public:
 	 */
 	std::vector<QString> parameters() const;
 	
+	/**
+	 * Emits a delayed crsChanged() signal for parameter edits now.
+	 * 
+	 * Dialogs shall call this before they use the CRS of their georeferencing.
+	 */
+	void commitParameterEdits();
+	
 	
 	/** 
 	 * Provides the current georeferencing.
@@ -135,6 +148,8 @@ public:
 signals:
 	/** 
 	 * Emitted when the user changes the CRS or its parameters.
+	 * 
+	 * For parameter edits, it is emitted when the editing pauses.
 	 */
 	void crsChanged();
 	
@@ -186,6 +201,7 @@ private:
 	QFormLayout* dialog_layout;
 	int num_custom_items;
 	const CRSTemplate* configured_crs;
+	QTimer* edit_timer;
 };
 
 
@@ -61,6 +61,10 @@ EditorSettingsPage::EditorSettingsPage(QWidget* parent)
 	text_antialiasing->setToolTip(tr("Antialiasing makes the map look much better, but also slows down the map display"));
 	layout->addRow(text_antialiasing);
 	
+	geometric_pattern_clipping = new QCheckBox(tr("Fast display of area patterns, less exact at the boundary"), this);
+	geometric_pattern_clipping->setToolTip(tr("Area patterns are cut to the area once, instead of on every display update"));
+	layout->addRow(geometric_pattern_clipping);
+	
 	tolerance = Util::SpinBox::create(0, 50, tr("mm", "millimeters"));
 	layout->addRow(tr("Click tolerance:"), tolerance);
 	
@@ -132,6 +136,7 @@ void EditorSettingsPage::apply()
 	setSetting(Settings::SymbolWidget_IconSizeMM, icon_size->value());
 	setSetting(Settings::MapDisplay_Antialiasing, antialiasing->isChecked());
 	setSetting(Settings::MapDisplay_TextAntialiasing, text_antialiasing->isChecked());
+	setSetting(Settings::MapDisplay_GeometricPatternClipping, geometric_pattern_clipping->isChecked());
 	setSetting(Settings::MapEditor_ClickToleranceMM, tolerance->value());
 	setSetting(Settings::MapEditor_SnapDistanceMM, snap_distance->value());
 	setSetting(Settings::MapEditor_FixedAngleStepping, fixed_angle_stepping->value());
@@ -158,6 +163,7 @@ void EditorSettingsPage::updateWidgets()
 	antialiasing->setChecked(getSetting(Settings::MapDisplay_Antialiasing).toBool());
 	text_antialiasing->setEnabled(antialiasing->isChecked());
 	text_antialiasing->setChecked(getSetting(Settings::MapDisplay_TextAntialiasing).toBool());
+	geometric_pattern_clipping->setChecked(getSetting(Settings::MapDisplay_GeometricPatternClipping).toBool());
 	tolerance->setValue(getSetting(Settings::MapEditor_ClickToleranceMM).toInt());
 	snap_distance->setValue(getSetting(Settings::MapEditor_SnapDistanceMM).toInt());
 	fixed_angle_stepping->setValue(getSetting(Settings::MapEditor_FixedAngleStepping).toInt());
@@ -57,6 +57,7 @@ private:
 	QSpinBox* icon_size;
 	QCheckBox* antialiasing;
 	QCheckBox* text_antialiasing;
+	QCheckBox* geometric_pattern_clipping;
 	QSpinBox* tolerance;
 	QSpinBox* snap_distance;
 	QDoubleSpinBox* fixed_angle_stepping;
@@ -119,6 +119,13 @@ GeneralSettingsPage::GeneralSettingsPage(QWidget* parent)
 	tips_visible_check = new QCheckBox(::OpenOrienteering::AbstractHomeScreenWidget::tr("Show tip of the day"));
 	layout->addRow(tips_visible_check);
 	
+	layout->addItem(Util::SpacerItem::create(this));
+	layout->addRow(Util::Headline::create(tr("Memory")));
+	
+	undo_memory_edit = Util::SpinBox::create(16, 16384, tr("MiB"), 16);
+	undo_memory_edit->setToolTip(tr("Older undo steps are moved to a temporary file when they need more memory."));
+	layout->addRow(tr("Undo history:"), undo_memory_edit);
+	
 	layout->addItem(Util::SpacerItem::create(this));
 	layout->addRow(Util::Headline::create(tr("Saving files")));
 	
@@ -133,6 +140,12 @@ GeneralSettingsPage::GeneralSettingsPage(QWidget* parent)
 	undo_check = new QCheckBox(tr("Save undo/redo history"));
 	layout->addRow(undo_check);
 	
+	compress_check = new QCheckBox(tr("Compress map files (.omap)"));
+	layout->addRow(compress_check);
+	
+	compact_coords_check = new QCheckBox(tr("Save coordinates in compact format (not readable by older versions)"));
+	layout->addRow(compact_coords_check);
+	
 	autosave_check = new QCheckBox(tr("Save information for automatic recovery"));
 	layout->addRow(autosave_check);
 	
@@ -225,8 +238,11 @@ void GeneralSettingsPage::apply()
 	
 	setSetting(Settings::General_OpenMRUFile, open_mru_check->isChecked());
 	setSetting(Settings::HomeScreen_TipsVisible, tips_visible_check->isChecked());
+	setSetting(Settings::General_UndoMemoryLimit, undo_memory_edit->value());
 	setSetting(Settings::General_RetainCompatiblity, compatibility_check->isChecked());
 	setSetting(Settings::General_SaveUndoRedo, undo_check->isChecked());
+	setSetting(Settings::General_CompressMapFiles, compress_check->isChecked());
+	setSetting(Settings::General_CompactCoordinates, compact_coords_check->isChecked());
 	setSetting(Settings::General_PixelsPerInch, ppi_edit->value());
 	
 	auto encoding = encoding_box->currentText().toLatin1();
@@ -285,8 +301,11 @@ void GeneralSettingsPage::updateWidgets()
 	ppi_edit->setValue(getSetting(Settings::General_PixelsPerInch).toDouble());
 	open_mru_check->setChecked(getSetting(Settings::General_OpenMRUFile).toBool());
 	tips_visible_check->setChecked(getSetting(Settings::HomeScreen_TipsVisible).toBool());
+	undo_memory_edit->setValue(getSetting(Settings::General_UndoMemoryLimit).toInt());
 	compatibility_check->setChecked(getSetting(Settings::General_RetainCompatiblity).toBool());
 	undo_check->setChecked(getSetting(Settings::General_SaveUndoRedo).toBool());
+	compress_check->setChecked(getSetting(Settings::General_CompressMapFiles).toBool());
+	compact_coords_check->setChecked(getSetting(Settings::General_CompactCoordinates).toBool());
 	int autosave_interval = getSetting(Settings::General_AutosaveInterval).toInt();
 	autosave_check->setChecked(autosave_interval > 0);
 	autosave_interval_edit->setEnabled(autosave_interval > 0);
@@ -83,8 +83,12 @@ private:
 	QCheckBox* open_mru_check;
 	QCheckBox* tips_visible_check;
 	
+	QSpinBox*  undo_memory_edit;
+	
 	QCheckBox* compatibility_check;
 	QCheckBox* undo_check;
+	QCheckBox* compress_check;
+	QCheckBox* compact_coords_check;
 	QCheckBox* autosave_check;
 	QSpinBox*  autosave_interval_edit;
 	
@@ -26,8 +26,13 @@
 #include <QCheckBox>
 #include <QCommandLinkButton>
 #include <QDirIterator>
+#include <QDateTime>
 #include <QFileInfo>
+#include <QIcon>
+#include <QLocale>
+#include <QPixmap>
 #include <QLabel>
+#include <QLatin1Char>
 #include <QListWidget>
 #include <QMessageBox>
 #include <QPainter>
@@ -37,6 +42,7 @@
 
 #include "settings.h"
 #include "core/app_permissions.h"
+#include "core/map_preview.h"
 #include "core/storage_location.h" // IWYU pragma: keep
 #include "fileformats/file_format_registry.h"
 #include "gui/home_screen_controller.h"
@@ -207,6 +213,7 @@ QWidget* HomeScreenWidgetDesktop::makeRecentFilesWidget(HomeScreenController* co
 	recent_files_list->setFont(list_font);
 	recent_files_list->setSpacing(pixel_size/2);
 	recent_files_list->setCursor(Qt::PointingHandCursor);
+	recent_files_list->setIconSize({ MapPreview::size, MapPreview::size });
 	recent_files_list->setStyleSheet(QString::fromLatin1(" \
 	  QListWidget::item:hover { \
 	    color: palette(highlighted-text); \
@@ -279,6 +286,16 @@ void HomeScreenWidgetDesktop::setRecentFiles(const QStringList& files)
 		QListWidgetItem* new_item = new QListWidgetItem(QFileInfo(file).fileName());
 		new_item->setData(pathRole(), file);
 		new_item->setToolTip(file);
+		// Cached previews avoid loading the map file.
+		auto const preview = MapPreview::load(file);
+		if (!preview.isNull())
+		{
+			new_item->setIcon(QIcon(QPixmap::fromImage(preview.image)));
+			new_item->setToolTip(file + QLatin1Char('\n')
+			                     + tr("Scale: 1:%1").arg(preview.scale_denominator) + QLatin1Char('\n')
+			                     + tr("Objects: %1").arg(preview.num_objects) + QLatin1Char('\n')
+			                     + tr("Modified: %1").arg(QLocale().toString(preview.last_modified, QLocale::ShortFormat)));
+		}
 		recent_files_list->addItem(new_item);
 	}
 }
@@ -21,8 +21,14 @@
 
 #include "measure_widget.h"
 
+#include <algorithm>
+#include <cstddef>
+
+#include <QLatin1Char>
+#include <QLatin1String>
 #include <QLocale>
 #include <QScroller>
+#include <QString>
 
 #include "core/map.h"
 #include "core/objects/object.h"
@@ -33,15 +39,75 @@
 
 namespace OpenOrienteering {
 
+namespace {
+
+/**
+ * The number of objects which are measured in a single step.
+ */
+constexpr std::size_t measure_step_size = 256;
+
+const QString& tableRow()
+{
+	static const QString table_row{ QLatin1String{
+	  "<tr><td>%1</td><td align=\"center\">%2 %3</td><td align=\"center\">(%4 %5)</td></tr>" 
+	} };
+	return table_row;
+}
+
+/**
+ * Returns the area of the path in mm².
+ * 
+ * The first part is taken as the outline, all other parts as holes.
+ */
+double calculatePaperArea(const PathPartVector& parts)
+{
+	auto paper_area = parts.front().calculateArea();
+	if (parts.size() > 1)
+	{
+		paper_area *= 2;
+		for (const auto& part : parts)
+			paper_area -= part.calculateArea();
+	}
+	return paper_area;
+}
+
+}  // namespace
+
+
+
+MeasureWidget::Measurement& MeasureWidget::Measurement::operator+=(const Measurement& other)
+{
+	length += other.length;
+	area   += other.area;
+	lines  += other.lines;
+	areas  += other.areas;
+	return *this;
+}
+
+MeasureWidget::Measurement& MeasureWidget::Measurement::operator-=(const Measurement& other)
+{
+	length -= other.length;
+	area   -= other.area;
+	lines  -= other.lines;
+	areas  -= other.areas;
+	return *this;
+}
+
+
+
 MeasureWidget::MeasureWidget(Map* map, QWidget* parent)
 : QTextBrowser(parent)
 , map(map)
 {
 	QScroller::grabGesture(viewport(), QScroller::TouchGesture);
 	
+	measure_timer.setSingleShot(true);
+	measure_timer.setInterval(0);
+	connect(&measure_timer, &QTimer::timeout, this, &MeasureWidget::measureNextStep);
+	
 	connect(map, &Map::objectSelectionChanged, this, &MeasureWidget::objectSelectionChanged);
-	connect(map, &Map::selectedObjectEdited, this, &MeasureWidget::objectSelectionChanged);
-	connect(map, &Map::symbolChanged, this, &MeasureWidget::objectSelectionChanged);
+	connect(map, &Map::selectedObjectEdited, this, &MeasureWidget::objectsModified);
+	connect(map, &Map::symbolChanged, this, &MeasureWidget::objectsModified);
 	
 	objectSelectionChanged();
 }
@@ -50,11 +116,110 @@ MeasureWidget::~MeasureWidget() = default;
 
 
 void MeasureWidget::objectSelectionChanged()
+{
+	updateMeasurements();
+	updateContent();
+}
+
+
+void MeasureWidget::objectsModified()
+{
+	measurements.clear();
+	pending.clear();
+	totals = {};
+	objectSelectionChanged();
+}
+
+
+void MeasureWidget::updateMeasurements()
+{
+	const auto& selected_objects = map->selectedObjects();
+	pending.clear();
+	
+	// Both containers are ordered by pointer value.
+	auto selected = begin(selected_objects);
+	auto measured = begin(measurements);
+	while (selected != end(selected_objects) || measured != end(measurements))
+	{
+		if (measured == end(measurements)
+		    || (selected != end(selected_objects) && *selected < measured->first))
+		{
+			if ((*selected)->getType() == Object::Path)
+				pending.push_back(*selected);
+			++selected;
+		}
+		else if (selected == end(selected_objects) || measured->first < *selected)
+		{
+			totals -= measured->second;
+			measured = measurements.erase(measured);
+		}
+		else
+		{
+			++selected;
+			++measured;
+		}
+	}
+	
+	if (measurements.empty())
+		totals = {};  // Drop accumulated rounding errors.
+	
+	measurePending(measure_step_size);
+	if (!pending.empty())
+		measure_timer.start();
+	else
+		measure_timer.stop();
+}
+
+
+void MeasureWidget::measurePending(std::size_t max_count)
+{
+	auto count = std::min(max_count, pending.size());
+	for (auto it = pending.end() - std::ptrdiff_t(count); it != pending.end(); ++it)
+	{
+		auto* object = *it;
+		object->update();
+		
+		Measurement measurement;
+		const PathPartVector& parts = static_cast<const PathObject*>(object)->parts();
+		if (!parts.empty())
+		{
+			measurement.length = parts.front().length();
+			if (object->getSymbol()->getContainedTypes() & Symbol::Area)
+			{
+				measurement.area = calculatePaperArea(parts);
+				measurement.areas = 1;
+			}
+			else
+			{
+				measurement.lines = 1;
+			}
+		}
+		measurements.emplace(object, measurement);
+		totals += measurement;
+	}
+	pending.resize(pending.size() - count);
+}
+
+
+void MeasureWidget::measureNextStep()
+{
+	measurePending(measure_step_size);
+	if (!pending.empty())
+		measure_timer.start();
+	else
+		updateContent();
+}
+
+
+void MeasureWidget::updateContent()
 {
 	QString headline;   // inline HTML
 	QString body;       // HTML blocks
 	QString extra_text; // inline HTML
 	
+	const auto& table_row = tableRow();
+	double paper_to_real = 0.001 * map->getScaleDenominator();
+	
 	auto& selected_objects = map->selectedObjects();
 	if (selected_objects.empty())
 	{
@@ -63,6 +228,27 @@ void MeasureWidget::objectSelectionChanged()
 	else if (selected_objects.size() > 1)
 	{
 		extra_text = tr("%1 objects selected.").arg(locale().toString(map->getNumSelectedObjects()));
+		if (!pending.empty())
+		{
+			extra_text.append(QLatin1String("<br/>") + tr("Calculating..."));
+		}
+		else if (totals.lines > 0 || totals.areas > 0)
+		{
+			body = QLatin1String{ "<table>" };
+			if (totals.lines > 0)
+			{
+				body.append(table_row.arg(tr("Total length:"),
+				                          locale().toString(totals.length, 'f', 2), tr("mm", "millimeters"),
+				                          locale().toString(totals.length * paper_to_real, 'f', 0), tr("m", "meters")));
+			}
+			if (totals.areas > 0)
+			{
+				body.append(table_row.arg(tr("Total area:"),
+				                          locale().toString(totals.area, 'f', 2), trUtf8("mm²", "square millimeters"),
+				                          locale().toString(totals.area * paper_to_real * paper_to_real, 'f', 0), trUtf8("m²", "square meters")));
+			}
+			body.append(QLatin1String("</table>"));
+		}
 	}
 	else
 	{
@@ -77,11 +263,6 @@ void MeasureWidget::objectSelectionChanged()
 		else
 		{
 			body = QLatin1String{ "<table>" };
-			static const QString table_row{ QLatin1String{
-			  "<tr><td>%1</td><td align=\"center\">%2 %3</td><td align=\"center\">(%4 %5)</td></tr>" 
-			} };
-			
-			double paper_to_real = 0.001 * map->getScaleDenominator();
 			
 			object->update();
 			const PathPartVector& parts = static_cast<const PathObject*>(object)->parts();
@@ -99,13 +280,7 @@ void MeasureWidget::objectSelectionChanged()
 				                          paper_length_text, tr("mm", "millimeters"),
 				                          real_length_text, tr("m", "meters")));
 				
-				auto paper_area = parts.front().calculateArea();
-				if (parts.size() > 1)
-				{
-					paper_area *= 2;
-					for (const auto& part : parts)
-						paper_area -= part.calculateArea();
-				}
+				auto paper_area = calculatePaperArea(parts);
 				double real_area = paper_area * paper_to_real * paper_to_real;
 				
 				auto paper_area_text = locale().toString(paper_area, 'f', 2);
@@ -22,14 +22,20 @@
 #ifndef OPENORIENTEERING_MEASURE_WIDGET_H
 #define OPENORIENTEERING_MEASURE_WIDGET_H
 
+#include <cstddef>
+#include <map>
+#include <vector>
+
 #include <QObject>
 #include <QTextBrowser>
+#include <QTimer>
 
 class QWidget;
 
 namespace OpenOrienteering {
 
 class Map;
+class Object;
 
 
 /**
@@ -53,8 +59,54 @@ protected slots:
 	 */
 	void objectSelectionChanged();
 	
+	/**
+	 * Is called when selected objects or symbols are modified.
+	 * Discards the measurements, and updates the widget content.
+	 */
+	void objectsModified();
+	
 private:
+	/** Lengths and areas in paper units (mm, mm²). */
+	struct Measurement
+	{
+		double length = 0;
+		double area = 0;
+		int lines = 0;
+		int areas = 0;
+		
+		Measurement& operator+=(const Measurement& other);
+		Measurement& operator-=(const Measurement& other);
+	};
+	
+	/**
+	 * Updates the measurements from the difference between the measured
+	 * objects and the current selection.
+	 * 
+	 * Small numbers of new objects are measured immediately, the others
+	 * are measured in steps from the event loop.
+	 */
+	void updateMeasurements();
+	
+	/**
+	 * Measures up to the given number of pending objects.
+	 */
+	void measurePending(std::size_t max_count);
+	
+	/**
+	 * Continues measuring pending objects, and updates the content.
+	 */
+	void measureNextStep();
+	
+	/**
+	 * Updates the widget content.
+	 */
+	void updateContent();
+	
 	Map* map;
+	std::map<const Object*, Measurement> measurements;
+	std::vector<Object*> pending;
+	Measurement totals;
+	QTimer measure_timer;
 };
 
 
@@ -469,27 +469,30 @@ void SymbolRenderWidget::paintEvent(QPaintEvent* event)
 {
 	QRect event_rect = event->rect().adjusted(-icon_size, -icon_size, 0, 0);
 	
+	// Only the rows touched by the event rect need to be painted.
+	auto const first_row = qMax(0, event->rect().top() / icon_size);
+	auto const last_row = event->rect().bottom() / icon_size;
+	auto const first_index = first_row * icons_per_row;
+	auto const last_index = qMin((last_row + 1) * icons_per_row, map->getNumSymbols());
+	
+	// Create the missing visible icons at once, instead of one after the other.
+	map->prepareSymbolIcons(first_index, last_index,
+	                        Settings::getInstance().getSymbolWidgetIconSizePx(),
+	                        Settings::getInstance().getSetting(Settings::SymbolWidget_ShowCustomIcons).toBool());
+	
 	QPainter painter(this);
 	painter.setPen(Qt::gray);
 	
-	int x = 0;
-	int y = 0;
-	for (int i = 0; i < map->getNumSymbols(); ++i)
+	for (int i = first_index; i < last_index; ++i)
 	{
-		if (event_rect.contains(x,y))
+		auto const pos = iconPosition(i);
+		if (event_rect.contains(pos))
 		{
 			painter.save();
-			painter.translate(x, y);
+			painter.translate(pos);
 			drawIcon(painter, i);
 			painter.restore();
 		}
-		
-		x += icon_size;
-		if (x >= icons_per_row * icon_size)
-		{
-			x = 0;
-			y +=  icon_size;
-		}
 	}
 	
 	// Drop indicator?
@@ -967,13 +970,13 @@ void SymbolRenderWidget::setSelectedSymbolVisibility(bool checked)
 		{
 			symbol->setHidden(checked);
 			updateSingleIcon(symbol_index);
+			map->setObjectsWithSymbolAreaDirty(symbol);
 			if (checked)
 				selection_changed |= map->removeSymbolFromSelection(symbol, false);
 		}
 	}
 	if (selection_changed)
 		map->emitSelectionChanged();
-	map->updateAllMapWidgets();
 	map->setSymbolsDirty();
 	emitGuarded_selectedSymbolsChanged();
 }
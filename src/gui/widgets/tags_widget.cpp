@@ -20,15 +20,24 @@
 
 #include "tags_widget.h"
 
+#include <QComboBox>
+#include <QDialog>
+#include <QDialogButtonBox>
+#include <QFormLayout>
 #include <QHeaderView>
 #include <QLabel>
+#include <QLineEdit>
 #include <QMessageBox>
+#include <QPushButton>
+#include <QRegularExpression>
+#include <QString>
 #include <QTableWidget>
 #include <QToolButton>
 #include <QVBoxLayout>
 
 #include "core/map.h"
 #include "core/objects/object.h"
+#include "core/objects/tags_edit.h"
 #include "gui/main_window.h"
 #include "gui/util_gui.h"
 #include "gui/map/map_editor.h"
@@ -62,6 +71,9 @@ TagsWidget::TagsWidget(Map* map, MapView* main_view, MapEditorController* contro
 	
 	layout->addWidget(tags_table);
 	
+	bulk_edit_button = newToolButton(QIcon(QString::fromLatin1(":/images/tag-selector.png")), tr("Edit tags of all selected objects..."));
+	bulk_edit_button->setAutoRaise(true);
+	
 	auto help_button = newToolButton(QIcon(QString::fromLatin1(":/images/help.png")), tr("Help"));
 	help_button->setAutoRaise(true);
 	
@@ -73,6 +85,7 @@ TagsWidget::TagsWidget(Map* map, MapView* main_view, MapEditorController* contro
 		style()->pixelMetric(QStyle::PM_LayoutRightMargin, &style_option) / 2,
 		style()->pixelMetric(QStyle::PM_LayoutBottomMargin, &style_option) / 2
 	);
+	all_buttons_layout->addWidget(bulk_edit_button);
 	all_buttons_layout->addWidget(new QLabel(QString::fromLatin1("   ")), 1);
 	all_buttons_layout->addWidget(help_button);
 	
@@ -81,12 +94,15 @@ TagsWidget::TagsWidget(Map* map, MapView* main_view, MapEditorController* contro
 	setLayout(layout);
 	
 	connect(tags_table, &QTableWidget::cellChanged, this, &TagsWidget::cellChange);
+	connect(bulk_edit_button, &QAbstractButton::clicked, this, &TagsWidget::editSelectionTags);
 	
 	connect(map, &Map::objectSelectionChanged, this, &TagsWidget::objectTagsChanged);
+	connect(map, &Map::objectSelectionChanged, this, &TagsWidget::updateBulkEditButton);
 	connect(map, &Map::selectedObjectEdited, this, &TagsWidget::objectTagsChanged);
 	
 	react_to_changes = true;
 	objectTagsChanged();
+	updateBulkEditButton();
 }
 
 TagsWidget::~TagsWidget() = default;
@@ -109,6 +125,89 @@ void TagsWidget::showHelp()
 	Util::showHelp(controller->getWindow(), "tag_editor.html");
 }
 
+// slot
+void TagsWidget::updateBulkEditButton()
+{
+	bulk_edit_button->setEnabled(map->getNumSelectedObjects() > 0);
+}
+
+// slot
+void TagsWidget::editSelectionTags()
+{
+	if (map->getNumSelectedObjects() == 0)
+		return;
+	
+	QDialog dialog(window());
+	dialog.setWindowTitle(tr("Edit tags of selected objects"));
+	
+	auto operation_box = new QComboBox();
+	operation_box->addItem(tr("Set value"), int(TagsEdit::SetValue));
+	operation_box->addItem(tr("Rename key"), int(TagsEdit::RenameKey));
+	operation_box->addItem(tr("Remove key"), int(TagsEdit::RemoveKey));
+	operation_box->addItem(tr("Replace in values"), int(TagsEdit::ReplaceValue));
+	
+	auto key_edit = new QLineEdit();
+	auto argument_edit = new QLineEdit();
+	auto replacement_edit = new QLineEdit();
+	
+	auto layout = new QFormLayout();
+	layout->addRow(tr("Operation:"), operation_box);
+	layout->addRow(tr("Key:"), key_edit);
+	layout->addRow(tr("Value:"), argument_edit);
+	layout->addRow(tr("Replacement:"), replacement_edit);
+	
+	auto button_box = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
+	layout->addRow(button_box);
+	dialog.setLayout(layout);
+	
+	auto operation = [operation_box]() {
+		return TagsEdit::Operation(operation_box->currentData().toInt());
+	};
+	auto makeEdit = [&]() {
+		auto const key = key_edit->text().trimmed();
+		if (operation() == TagsEdit::ReplaceValue)
+			return TagsEdit(key, QRegularExpression(argument_edit->text()), replacement_edit->text());
+		if (operation() == TagsEdit::RenameKey)
+			return TagsEdit(operation(), key, argument_edit->text().trimmed());
+		return TagsEdit(operation(), key, argument_edit->text());
+	};
+	auto updateDialog = [&]() {
+		auto* argument_label = qobject_cast<QLabel*>(layout->labelForField(argument_edit));
+		switch (operation())
+		{
+		case TagsEdit::SetValue:
+			argument_label->setText(tr("Value:"));
+			break;
+		case TagsEdit::RenameKey:
+			argument_label->setText(tr("New key:"));
+			break;
+		case TagsEdit::RemoveKey:
+			break;
+		case TagsEdit::ReplaceValue:
+			argument_label->setText(tr("Regular expression:"));
+			break;
+		}
+		key_edit->setPlaceholderText(operation() == TagsEdit::ReplaceValue ? tr("All keys") : QString{});
+		argument_edit->setVisible(operation() != TagsEdit::RemoveKey);
+		argument_label->setVisible(operation() != TagsEdit::RemoveKey);
+		replacement_edit->setVisible(operation() == TagsEdit::ReplaceValue);
+		layout->labelForField(replacement_edit)->setVisible(operation() == TagsEdit::ReplaceValue);
+		button_box->button(QDialogButtonBox::Ok)->setEnabled(makeEdit().isValid());
+	};
+	void (QComboBox::* index_changed)(int) = &QComboBox::currentIndexChanged;
+	connect(operation_box, index_changed, &dialog, updateDialog);
+	connect(key_edit, &QLineEdit::textChanged, &dialog, updateDialog);
+	connect(argument_edit, &QLineEdit::textChanged, &dialog, updateDialog);
+	connect(button_box, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+	connect(button_box, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+	updateDialog();
+	
+	if (dialog.exec() != QDialog::Accepted)
+		return;
+	
+	makeEdit().applyToSelection(*map);
+}
+
 void TagsWidget::setupLastRow()
 {
 	const int row = tags_table->rowCount() - 1;
@@ -124,7 +223,8 @@ void TagsWidget::createUndoStep(Object* object)
 	
 	auto undo_step = new ObjectTagsUndoStep(map);
 	undo_step->addObject(map->getCurrentPart()->findObjectIndex(object));
-	map->push(undo_step);
+	// Editing several tags of an object in a row is a single step.
+	map->push(undo_step, QStringLiteral("tags"));
 }
 
 // slot
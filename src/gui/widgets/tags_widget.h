@@ -70,6 +70,16 @@ protected slots:
 	 */
 	void showHelp();
 	
+	/**
+	 * Shows a dialog for editing the tags of all selected objects at once.
+	 */
+	void editSelectionTags();
+	
+	/**
+	 * Enables the bulk edit button when objects are selected.
+	 */
+	void updateBulkEditButton();
+	
 protected:
 	/**
 	 * Returns a new QToolButton with a unified appearance.
@@ -95,6 +105,7 @@ private:
 	bool react_to_changes;
 	
 	QTableWidget* tags_table;
+	QToolButton* bulk_edit_button;
 };
 
 
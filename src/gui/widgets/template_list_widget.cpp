@@ -39,6 +39,7 @@
 #include <QDir>
 #include <QEvent>
 #include <QEventLoop>
+#include <QFile>
 #include <QFileInfo>
 #include <QFlags>
 #include <QHBoxLayout>
@@ -57,6 +58,7 @@
 #include <QPainter>
 #include <QPalette>
 #include <QPixmap>
+#include <QProgressDialog>
 #include <QRect>
 #include <QRectF>
 #include <QScroller>
@@ -86,6 +88,8 @@
 #include "core/map_coord.h"
 #include "fileformats/file_format_registry.h"
 #include "fileformats/file_import_export.h"
+#include "gdal/gdal_contours.h"
+#include "gdal/gdal_template.h"
 #include "gui/file_dialog.h"
 #include "gui/main_window.h"
 #include "gui/util_gui.h"
@@ -270,6 +274,11 @@ TemplateListWidget::TemplateListWidget(Map* map, MapView* main_view, MapEditorCo
 #else
 	vectorize_action = nullptr;
 #endif /* WITH_COVE */
+#ifdef MAPPER_USE_GDAL
+	contours_action = edit_menu->addAction(tr("Generate contours..."), this, SLOT(generateContoursClicked()));
+#else
+	contours_action = nullptr;
+#endif /* MAPPER_USE_GDAL */
 
 	edit_button = newToolButton(QIcon(QString::fromLatin1(":/images/settings.png")),
 	                            ::OpenOrienteering::MapEditorController::tr("&Edit").remove(QLatin1Char('&')));
@@ -347,6 +356,7 @@ TemplateListWidget::TemplateListWidget(Map* map, MapView* main_view, MapEditorCo
 	//connect(more_button_menu, SIGNAL(triggered(QAction*)), this, SLOT(moreActionClicked(QAction*)));
 	
 	connect(main_view, &MapView::visibilityChanged, this, &TemplateListWidget::updateVisibility);
+	connect(map, &Map::templateChanged, this, &TemplateListWidget::templateChanged);
 	connect(controller, &MapEditorController::templatePositionDockWidgetClosed, this, &TemplateListWidget::templatePositionDockWidgetClosed);
 }
 
@@ -588,9 +598,6 @@ void TemplateListWidget::moveTemplateUp()
 	
 	int cur_pos = posFromRow(row);
 	int above_pos = posFromRow(row - 1);
-	map->setTemplateAreaDirty(cur_pos);
-	map->setTemplateAreaDirty(above_pos);
-	
 	if (cur_pos < 0)
 	{
 		// Moving the map layer up
@@ -610,8 +617,8 @@ void TemplateListWidget::moveTemplateUp()
 		map->setTemplate(above_template, cur_pos);
 	}
 	
-	map->setTemplateAreaDirty(cur_pos);
-	map->setTemplateAreaDirty(above_pos);
+	// The templates' cached layers are unaffected by the order.
+	map->setTemplateCompositionDirty();
 	updateRow(row - 1);
 	updateRow(row);
 	
@@ -633,9 +640,6 @@ void TemplateListWidget::moveTemplateDown()
 	
 	int cur_pos = posFromRow(row);
 	int below_pos = posFromRow(row + 1);
-	map->setTemplateAreaDirty(cur_pos);
-	map->setTemplateAreaDirty(below_pos);
-	
 	if (cur_pos < 0)
 	{
 		// Moving the map layer down
@@ -655,8 +659,8 @@ void TemplateListWidget::moveTemplateDown()
 		map->setTemplate(below_template, cur_pos);
 	}
 	
-	map->setTemplateAreaDirty(cur_pos);
-	map->setTemplateAreaDirty(below_pos);
+	// The templates' cached layers are unaffected by the order.
+	map->setTemplateCompositionDirty();
 	updateRow(row + 1);
 	updateRow(row);
 	
@@ -839,6 +843,7 @@ void TemplateListWidget::updateButtons()
 		bool custom_enabled = false;
 		bool import_enabled = false;
 		bool vectorize_enabled  = false;
+		bool contours_enabled   = false;
 		if (single_template_selected)
 		{
 			auto temp = map->getTemplate(posFromRow(visited_row));
@@ -849,8 +854,14 @@ void TemplateListWidget::updateButtons()
 				georef_enabled = temp->canChangeTemplateGeoreferenced();
 				custom_enabled = !is_georeferenced;
 				import_enabled = bool(qobject_cast<TemplateMap*>(getCurrentTemplate()));
-				vectorize_enabled = qobject_cast<TemplateImage*>(getCurrentTemplate())
-									&& getCurrentTemplate()->getTemplateState() == Template::Loaded;
+				auto const* image_template = qobject_cast<TemplateImage*>(getCurrentTemplate());
+				vectorize_enabled = image_template
+									&& image_template->getTemplateState() == Template::Loaded
+									&& !image_template->getImage().isNull();
+#ifdef MAPPER_USE_GDAL
+				contours_enabled = dynamic_cast<GdalTemplate*>(temp)
+				                   && temp->getTemplateState() == Template::Loaded;
+#endif /* MAPPER_USE_GDAL */
 			}
 		}
 		else if (single_row_selected)
@@ -868,6 +879,8 @@ void TemplateListWidget::updateButtons()
 		import_action->setEnabled(import_enabled);
 		if (vectorize_action)
 			vectorize_action->setEnabled(vectorize_enabled);
+		if (contours_action)
+			contours_action->setEnabled(contours_enabled);
 	}
 }
 
@@ -1120,6 +1133,68 @@ void TemplateListWidget::vectorizeClicked()
 #endif /* WITH_COVE */
 }
 
+void TemplateListWidget::generateContoursClicked()
+{
+#ifdef MAPPER_USE_GDAL
+	auto const* templ = dynamic_cast<GdalTemplate*>(getCurrentTemplate());
+	if (!templ)
+		return;
+	
+	bool ok = false;
+	auto const interval = QInputDialog::getDouble(window(), tr("Generate contours"), tr("Contour interval:"),
+	                                              5, 0.01, 10000, 2, &ok);
+	if (!ok)
+		return;
+	
+	auto const raster_info = QFileInfo(templ->getTemplatePath());
+	auto path = FileDialog::getSaveFileName(window(), tr("Generate contours"),
+	                                        raster_info.dir().filePath(raster_info.completeBaseName() + QLatin1String("_contours.gpkg")),
+	                                        QString::fromLatin1("%1 (*.gpkg)").arg(tr("GeoPackage")));
+	if (path.isEmpty())
+		return;
+	if (!path.endsWith(QLatin1String(".gpkg"), Qt::CaseInsensitive))
+		path.append(QLatin1String(".gpkg"));
+	if (QFile::exists(path) && !QFile::remove(path))
+	{
+		QMessageBox::warning(this, tr("Error"), tr("Cannot replace the file %1.").arg(path));
+		return;
+	}
+	
+	QProgressDialog progress_dialog(tr("Generating contours..."), tr("Cancel"), 0, 100, window());
+	progress_dialog.setWindowModality(Qt::WindowModal);
+	progress_dialog.setMinimumDuration(0);
+	
+	GdalContourGenerator generator(templ->getTemplatePath());
+	generator.setInterval(interval);
+	auto const generated = generator.generate(path, [&progress_dialog](int percent) {
+		progress_dialog.setValue(percent);
+		return !progress_dialog.wasCanceled();
+	});
+	progress_dialog.reset();
+	if (!generated)
+	{
+		// An empty error string means the generation was canceled by the user.
+		if (!generator.errorString().isEmpty())
+			QMessageBox::warning(this, tr("Error"), generator.errorString());
+		return;
+	}
+	
+	auto new_template = Template::templateForPath(path, map);
+	auto center_in_view = false;
+	if (!new_template
+	    || !new_template->loadTemplateFile(true)
+	    || !new_template->postLoadConfiguration(window(), center_in_view))
+	{
+		auto const error = new_template ? new_template->errorString() : tr("File format not recognized.");
+		if (!error.isEmpty())
+			QMessageBox::warning(this, tr("Error"), tr("Cannot open template\n%1:\n%2").arg(path, error));
+		return;
+	}
+	
+	addTemplateAt(new_template.release(), posFromRow(template_table->currentRow()));
+#endif /* MAPPER_USE_GDAL */
+}
+
 void TemplateListWidget::moreActionClicked(QAction* action)
 {
 	Q_UNUSED(action);
@@ -1135,6 +1210,23 @@ void TemplateListWidget::templateAdded(int pos, const Template* temp)
 	template_table->setCurrentCell(row, 0);
 }
 
+void TemplateListWidget::templateChanged(int pos, const Template* temp)
+{
+	Q_UNUSED(temp);
+	if (pos < 0)
+		return;
+	
+	if (template_table->rowCount() == map->getNumTemplates() + 1)
+	{
+		updateRow(rowFromPos(pos));
+		updateButtons();
+	}
+	else
+	{
+		updateAll();
+	}
+}
+
 void TemplateListWidget::templatePositionDockWidgetClosed(Template* temp)
 {
 	auto current_temp = getCurrentTemplate();
@@ -1151,15 +1243,19 @@ void TemplateListWidget::updateVisibility(MapView::VisibilityFeature feature, bo
 		break;
 		
 	case MapView::MapVisible:
-		updateRow(map->getFirstFrontTemplate());
-		break;
+		if (template_table->rowCount() == map->getNumTemplates() + 1)
+		{
+			updateRow(map->getNumTemplates() - map->getFirstFrontTemplate());
+			break;
+		}
+		Q_FALLTHROUGH();
 		
 	case MapView::TemplateVisible:
-		if (map->getNumTemplates() == template_table->rowCount()+1)
+		if (template_table->rowCount() == map->getNumTemplates() + 1)
 		{
-			auto row = map->findTemplateIndex(temp);
-			if (row >= 0)
-				updateRow(posFromRow(row));
+			auto pos = map->findTemplateIndex(temp);
+			if (pos >= 0)
+				updateRow(rowFromPos(pos));
 			break;
 		}
 		Q_FALLTHROUGH();
@@ -1210,6 +1306,7 @@ void TemplateListWidget::updateRow(int row)
 	QString name;
 	QString path;
 	bool valid = true;
+	bool loading = false;
 	
 	TemplateVisibility vis;
 	
@@ -1227,6 +1324,7 @@ void TemplateListWidget::updateRow(int row)
 		name = temp->getTemplateFilename();
 		path = temp->getTemplatePath();
 		valid = temp->getTemplateState() != Template::Invalid;
+		loading = temp->isLoadingInBackground();
 		/// @todo Get visibility values from the MapView of the active MapWidget (instead of always main_view)
 		vis = main_view->getTemplateVisibility(temp);
 	}
@@ -1287,6 +1385,17 @@ void TemplateListWidget::updateRow(int row)
 		editable   = Qt::NoItemFlags;
 	}
 	
+	if (loading)
+	{
+		// A placeholder until the template is loaded in the background
+		if (vis.visible)
+			check_state = Qt::PartiallyChecked;
+		text_color = QPalette().color(QPalette::Disabled, QPalette::Foreground);
+		checkable  = Qt::NoItemFlags;
+		editable   = Qt::NoItemFlags;
+		path       = qApp->translate("OpenOrienteering::MainWindow", "Opening %1").arg(name);
+	}
+	
 	auto foreground = QBrush(text_color);
 	auto background = QBrush(background_color);
 	
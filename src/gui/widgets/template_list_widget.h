@@ -105,8 +105,10 @@ protected slots:
 	void changeGeorefClicked();
 	void moreActionClicked(QAction* action);
 	void vectorizeClicked();
+	void generateContoursClicked();
 	
 	void templateAdded(int pos, const OpenOrienteering::Template* temp);
+	void templateChanged(int pos, const OpenOrienteering::Template* temp);
 	void templatePositionDockWidgetClosed(OpenOrienteering::Template* temp);
 	
 	void changeTemplateFile(int pos);
@@ -144,6 +146,7 @@ private:
 	QAction* import_action;
 	QAction* georef_action;
 	QAction* vectorize_action;
+	QAction* contours_action;
 	
 	// Buttons
 	QWidget* list_buttons_group;
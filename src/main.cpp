@@ -54,6 +54,7 @@
 #include "gui/home_screen_controller.h"
 #include "gui/main_window.h"
 #include "gui/widgets/mapper_proxystyle.h"
+#include "util/profiler.h"
 #include "util/recording_translator.h"  // IWYU pragma: keep
 #include "util/translation_util.h"
 
@@ -66,6 +67,10 @@ using namespace OpenOrienteering;
 Q_IMPORT_PLUGIN(PowershellPositionPlugin)
 #endif
 
+#if defined(Q_OS_WIN) && defined(MAPPER_USE_WINRT_POSITION_PLUGIN)
+Q_IMPORT_PLUGIN(WinrtPositionPlugin)
+#endif
+
 #if (defined(Q_OS_LINUX) || defined(Q_OS_MACOS)) && defined(MAPPER_USE_NMEA_POSITION_PLUGIN)
 Q_IMPORT_PLUGIN(NmeaPositionPlugin)
 #endif
@@ -115,8 +120,22 @@ void resetActivationWindow(QtSingleApplication& app)
 #endif
 
 
+/**
+ * Records a startup phase which began at start, and returns the current time.
+ */
+qint64 recordStartupPhase(Profiler::Phase phase, qint64 start)
+{
+	auto const end = Profiler::now();
+	if (Profiler::isEnabled())
+		Profiler::record(phase, start, end);
+	return end;
+}
+
+
 int main(int argc, char** argv)
 {
+	auto const startup_start = Profiler::now();
+	
 #ifdef MAPPER_USE_QTSINGLEAPPLICATION
 	// Create single-instance application.
 	// Use "oo-mapper" instead of the executable as identifier, in case we launch from different paths.
@@ -136,6 +155,9 @@ int main(int argc, char** argv)
 	qputenv("QT_USE_ANDROID_NATIVE_STYLE", "1");
 #endif
 	
+	// Enable profiling of the startup phases, if requested.
+	Profiler::initialize();
+	
 	// Load resources
 	Q_INIT_RESOURCE(resources);
 	
@@ -152,6 +174,7 @@ int main(int argc, char** argv)
 	MapperResource::setSeachPaths();
 	
 	// Localization
+	auto phase_start = Profiler::now();
 	QSettings settings;
 	TranslationUtil::setBaseName(QLatin1String("OpenOrienteering"));
 	TranslationUtil translation(settings);
@@ -174,12 +197,15 @@ int main(int argc, char** argv)
 	map_symbol_translator = translation.load(QString::fromLatin1("map_symbols")).release();
 	if (map_symbol_translator)
 		map_symbol_translator->setParent(&qapp);
+	phase_start = recordStartupPhase(Profiler::Translations, phase_start);
 	
 	// Avoid numeric issues in libraries such as GDAL
 	setlocale(LC_NUMERIC, "C");
 	
 	// Initialize static things like the file format registry.
+	// GDAL is set up on first use.
 	doStaticInitializations();
+	phase_start = recordStartupPhase(Profiler::FileFormats, phase_start);
 	
 	auto const palette = QApplication::palette();
 	QApplication::setStyle(new MapperProxyStyle());
@@ -208,5 +234,7 @@ int main(int argc, char** argv)
 	// Let application run
 	first_window->setVisible(true);
 	first_window->raise();
+	recordStartupPhase(Profiler::FirstWindow, phase_start);
+	recordStartupPhase(Profiler::Startup, startup_start);
 	return QApplication::exec();
 }
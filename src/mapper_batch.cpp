@@ -0,0 +1,446 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Converts and exports maps without a graphical user interface.
+ * 
+ * Each input file is loaded with the registered file formats, and then
+ * either saved in another map file format, or exported with MapPrinter
+ * to PDF or raster images. Multiple files are processed in parallel.
+ */
+
+#include <atomic>
+#include <clocale>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+
+#include <Qt>
+#include <QtGlobal>
+#include <QByteArray>
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+#include <QGuiApplication>
+#include <QImage>
+#include <QLatin1String>
+#include <QRectF>
+#include <QSize>
+#include <QString>
+#include <QStringList>
+#include <QTransform>
+
+#ifdef QT_PRINTSUPPORT_LIB
+#  include <QFile>
+#  include <QPrinter>
+#endif
+
+#include "global.h"
+#include "core/georeferencing.h"
+#include "core/map.h"
+#include "core/map_coord.h"
+#include "core/map_printer.h"
+#include "core/map_view.h"
+#include "fileformats/file_format.h"
+#include "fileformats/file_format_registry.h"
+#include "fileformats/file_import_export.h"
+#include "templates/world_file.h"
+#include "util/concurrency.h"
+
+#ifdef MAPPER_USE_GDAL
+#  include "gdal/gdal_image_writer.h"
+#endif
+
+using namespace OpenOrienteering;
+
+
+namespace {
+
+/// The kinds of output produced by this tool.
+enum OutputKind
+{
+	MapFileOutput,
+	PdfOutput,
+	ImageOutput,
+	GeoTiffOutput,
+};
+
+
+/// The settings which apply to all input files.
+struct Settings
+{
+	OutputKind kind = MapFileOutput;
+	const FileFormat* format = nullptr;  ///< For MapFileOutput
+	QString extension;
+	QString output_dir;
+	int resolution = 0;                  ///< In dpi, 0 for the map's setting
+	bool map_extent = false;
+	bool world_file = false;
+};
+
+
+std::mutex output_mutex;
+
+void printError(const QString& message)
+{
+	std::lock_guard<std::mutex> lock(output_mutex);
+	std::fprintf(stderr, "%s\n", qPrintable(message));
+}
+
+void printMessage(const QString& message)
+{
+	std::lock_guard<std::mutex> lock(output_mutex);
+	std::printf("%s\n", qPrintable(message));
+	std::fflush(stdout);
+}
+
+
+/**
+ * Determines the kind of output, and the map file format, for a format
+ * argument which is either a file extension or a file format ID.
+ */
+bool resolveFormat(const QString& name, Settings& settings)
+{
+	auto const extension = name.toLower();
+	settings.extension = extension;
+	if (extension == QLatin1String("pdf"))
+	{
+#ifdef QT_PRINTSUPPORT_LIB
+		settings.kind = PdfOutput;
+		return true;
+#else
+		return false;
+#endif
+	}
+	if (extension == QLatin1String("tif") || extension == QLatin1String("tiff"))
+	{
+#ifdef MAPPER_USE_GDAL
+		settings.kind = GeoTiffOutput;
+#else
+		settings.kind = ImageOutput;
+#endif
+		return true;
+	}
+	if (extension == QLatin1String("png") || extension == QLatin1String("bmp")
+	    || extension == QLatin1String("jpg") || extension == QLatin1String("jpeg"))
+	{
+		settings.kind = ImageOutput;
+		return true;
+	}
+	
+	settings.kind = MapFileOutput;
+	settings.format = FileFormats.findFormat(name.toLatin1().constData());
+	if (settings.format)
+		settings.extension = settings.format->primaryExtension();
+	else
+		settings.format = FileFormats.findFormatForFilename(QLatin1String("map.") + extension, &FileFormat::supportsWriting);
+	return settings.format && settings.format->supportsWriting();
+}
+
+
+QString outputPath(const QString& input, const Settings& settings)
+{
+	QFileInfo const info(input);
+	auto const dir = settings.output_dir.isEmpty() ? info.absoluteDir() : QDir(settings.output_dir);
+	return dir.absoluteFilePath(info.completeBaseName() + QLatin1Char('.') + settings.extension);
+}
+
+
+/**
+ * Returns the transformation from image pixels to projected coordinates.
+ */
+QTransform imagePixelToWorld(const Map& map, const MapPrinter& printer)
+{
+	const auto& georef = map.getGeoreferencing();
+	const auto& mm_to_world = georef.mapToProjected();
+	qreal pixel_per_mm = (printer.getOptions().resolution / 25.4) * printer.getScaleAdjustment();
+	const auto xscale = mm_to_world.m11() / pixel_per_mm;
+	const auto yscale = mm_to_world.m22() / pixel_per_mm;
+	const auto xskew  = mm_to_world.m12() / pixel_per_mm;
+	const auto yskew  = mm_to_world.m21() / pixel_per_mm;
+	const auto top_left = georef.toProjectedCoords(MapCoord{printer.getPrintArea().topLeft()});
+	return { xscale, yskew, 0, xskew, yscale, 0, top_left.x(), top_left.y() };
+}
+
+
+bool exportWithPrinter(Map& map, const MapView& view, const Settings& settings, const QString& path, QString& error)
+{
+	MapPrinter printer(map, &view);
+	printer.setTarget(settings.kind == PdfOutput ? MapPrinter::pdfTarget() : MapPrinter::imageTarget());
+	if (settings.resolution > 0)
+		printer.setResolution(settings.resolution);
+	if (settings.map_extent)
+	{
+		printer.setPrintArea(map.calculateExtent(false, printer.getOptions().show_templates, &view));
+		printer.setCustomPageSize(printer.getPrintAreaPaperSize());
+	}
+	
+	auto const pixel_per_mm = printer.getOptions().resolution / 25.4;
+	auto const size = QSize(qRound(printer.getPrintAreaPaperSize().width() * pixel_per_mm),
+	                        qRound(printer.getPrintAreaPaperSize().height() * pixel_per_mm));
+	auto const dots_per_meter = qRound(pixel_per_mm * 1000);
+	
+	switch (settings.kind)
+	{
+	case PdfOutput:
+#ifdef QT_PRINTSUPPORT_LIB
+		{
+			auto qprinter = printer.makePrinter();
+			if (!qprinter)
+			{
+				error = QStringLiteral("Failed to prepare the PDF export.");
+				return false;
+			}
+			qprinter->setOutputFormat(QPrinter::PdfFormat);
+			qprinter->setCreator(QCoreApplication::applicationName());
+			qprinter->setDocName(QFileInfo(path).completeBaseName());
+			qprinter->setOutputFileName(path);
+			if (!printer.printMap(qprinter.get()))
+			{
+				QFile(path).remove();
+				error = QStringLiteral("Failed to finish the PDF export.");
+				return false;
+			}
+		}
+		break;
+#else
+		Q_UNREACHABLE();
+#endif
+		
+	case GeoTiffOutput:
+#ifdef MAPPER_USE_GDAL
+		{
+			// Tiles are written as soon as a strip of full tile rows is complete.
+			constexpr int tile_size = 256;
+			constexpr int strip_bytes = 16 * 1024 * 1024;
+			const auto strip_height = tile_size * qMax(1, strip_bytes / qMax(1, 4 * size.width() * tile_size));
+			
+			const auto& georef = map.getGeoreferencing();
+			GdalImageWriter writer(path);
+			auto ok = writer.open(size, dots_per_meter)
+			          && writer.setGeoreferencing(imagePixelToWorld(map, printer), georef.isLocal() ? QString{} : georef.getProjectedCRSSpec())
+			          && printer.drawPageStrips(printer.getPrintArea(), size, strip_height, [&writer](const QImage& strip, int top) {
+			                 return writer.write(strip, top);
+			             })
+			          && writer.finish();
+			if (!ok)
+			{
+				error = writer.errorString();
+				if (error.isEmpty())
+					error = QStringLiteral("Failed to prepare the image. Not enough memory.");
+				return false;
+			}
+		}
+		break;
+#else
+		Q_UNREACHABLE();
+#endif
+		
+	case ImageOutput:
+		{
+			auto image = printer.drawPrintAreaImage();
+			if (image.isNull())
+			{
+				error = QStringLiteral("Failed to prepare the image. Not enough memory.");
+				return false;
+			}
+			image.setDotsPerMeterX(dots_per_meter);
+			image.setDotsPerMeterY(dots_per_meter);
+			if (!image.save(path))
+			{
+				error = QStringLiteral("Failed to save the image.");
+				return false;
+			}
+		}
+		break;
+		
+	case MapFileOutput:
+		Q_UNREACHABLE();
+	}
+	
+	if (settings.world_file && settings.kind != PdfOutput)
+		WorldFile(imagePixelToWorld(map, printer)).save(WorldFile::pathForImage(path));
+	
+	return true;
+}
+
+
+/**
+ * Converts or exports a single file.
+ * 
+ * This function is called concurrently for different files.
+ */
+bool processFile(const QString& input, const Settings& settings)
+{
+	auto const output = outputPath(input, settings);
+	if (QFileInfo(output) == QFileInfo(input))
+	{
+		printError(input + QLatin1String(": The output would overwrite the input file."));
+		return false;
+	}
+	
+	Map map;
+	MapView view{ &map };
+	auto importer = FileFormats.makeImporter(input, map, &view);
+	auto const loaded = importer && importer->doImport();
+	if (importer)
+	{
+		for (auto const& warning : importer->warnings())
+			printError(input + QLatin1String(": ") + warning);
+	}
+	if (!loaded)
+	{
+		printError(input + QLatin1String(": Cannot load the file."));
+		return false;
+	}
+	
+	QString error;
+	auto success = false;
+	if (settings.kind == MapFileOutput)
+	{
+		auto exporter = settings.format->makeExporter(output, &map, &view);
+		success = exporter && exporter->doExport();
+		if (exporter)
+		{
+			for (auto const& warning : exporter->warnings())
+				printError(output + QLatin1String(": ") + warning);
+		}
+	}
+	else
+	{
+		success = exportWithPrinter(map, view, settings, output, error);
+	}
+	
+	if (!success)
+	{
+		printError(output + QLatin1String(": ") + (error.isEmpty() ? QStringLiteral("Cannot save the file.") : error));
+		return false;
+	}
+	
+	printMessage(input + QLatin1String(" -> ") + output);
+	return true;
+}
+
+}  // namespace
+
+
+
+int main(int argc, char** argv)
+{
+	// Text objects need fonts, but no display.
+	if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+		qputenv("QT_QPA_PLATFORM", "minimal");
+	
+	QGuiApplication qapp(argc, argv);
+	QCoreApplication::setApplicationName(QStringLiteral("mapper-batch"));
+	
+	QCommandLineParser parser;
+	parser.setApplicationDescription(QStringLiteral(
+	    "Converts maps to other file formats, or exports them to PDF or\n"
+	    "raster images, without a graphical user interface.\n"
+	    "The format is either a file extension or the ID of a file format.\n"
+	    "PDF and raster exports use the print settings stored in each map."));
+	parser.addHelpOption();
+	parser.addPositionalArgument(QStringLiteral("files"), QStringLiteral("The files to be processed."), QStringLiteral("files..."));
+	
+	auto const c = [](const char* name, const char* description, const char* value_name) {
+		return QCommandLineOption(QString::fromLatin1(name), QString::fromLatin1(description), QString::fromLatin1(value_name));
+	};
+	parser.addOptions({
+	    c("format",     "The output format, e.g. omap, ocd, pdf, png, tif, gpkg (required).", "format"),
+	    c("output-dir", "The directory for the output files (default: next to the input files).", "dir"),
+	    c("resolution", "The resolution of PDF and raster exports in dpi (default: from the map).", "dpi"),
+	    c("jobs",       "The number of files to process in parallel (default: number of cores).", "count"),
+	});
+	parser.addOption({ QStringLiteral("map-extent"), QStringLiteral("Export the extent of all objects on a single page, instead of the stored print area.") });
+	parser.addOption({ QStringLiteral("world-file"), QStringLiteral("Write a world file for raster exports.") });
+	parser.process(qapp);
+	
+	auto const inputs = parser.positionalArguments();
+	if (inputs.isEmpty() || !parser.isSet(QStringLiteral("format")))
+	{
+		parser.showHelp(1);
+	}
+	
+	// Avoid numeric issues in libraries such as GDAL
+	setlocale(LC_NUMERIC, "C");
+	
+	doStaticInitializations();
+	
+	Settings settings;
+	if (!resolveFormat(parser.value(QStringLiteral("format")), settings))
+	{
+		printError(QLatin1String("Unsupported output format: ") + parser.value(QStringLiteral("format")));
+		return 1;
+	}
+	
+	settings.output_dir = parser.value(QStringLiteral("output-dir"));
+	if (!settings.output_dir.isEmpty() && !QDir().mkpath(settings.output_dir))
+	{
+		printError(QLatin1String("Cannot create the output directory ") + settings.output_dir);
+		return 1;
+	}
+	
+	if (parser.isSet(QStringLiteral("resolution")))
+	{
+		bool ok = false;
+		settings.resolution = parser.value(QStringLiteral("resolution")).toInt(&ok);
+		if (!ok || settings.resolution <= 0)
+		{
+			printError(QLatin1String("Invalid value for --resolution: ") + parser.value(QStringLiteral("resolution")));
+			return 1;
+		}
+	}
+	settings.map_extent = parser.isSet(QStringLiteral("map-extent"));
+	settings.world_file = parser.isSet(QStringLiteral("world-file"));
+	
+	auto num_jobs = Concurrency::idealThreadCount();
+	if (parser.isSet(QStringLiteral("jobs")))
+	{
+		bool ok = false;
+		num_jobs = parser.value(QStringLiteral("jobs")).toInt(&ok);
+		if (!ok || num_jobs <= 0)
+		{
+			printError(QLatin1String("Invalid value for --jobs: ") + parser.value(QStringLiteral("jobs")));
+			return 1;
+		}
+	}
+	num_jobs = qMin(num_jobs, inputs.size());
+	
+	// Each file is loaded into its own Map, so that the jobs share nothing
+	// but the file format registry and the static initializations.
+	std::atomic<int> next { 0 };
+	std::atomic<int> failures { 0 };
+	Concurrency::runOnThreads(num_jobs, [&]() {
+		for (auto i = next.fetch_add(1); i < inputs.size(); i = next.fetch_add(1))
+		{
+			if (!processFile(inputs[i], settings))
+				++failures;
+		}
+	});
+	
+	if (failures > 0)
+	{
+		printError(QStringLiteral("%1 of %2 files failed.").arg(failures.load()).arg(inputs.size()));
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,196 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Generates synthetic maps for scalability testing.
+ * 
+ * The symbols are taken from an existing map, normally from one of the
+ * symbol sets, and the objects are created by MapGenerator.
+ */
+
+#include <clocale>
+#include <cstdio>
+#include <memory>
+
+#include <QtGlobal>
+#include <QByteArray>
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QGuiApplication>
+#include <QLatin1String>
+#include <QString>
+#include <QStringList>
+
+#include "global.h"
+#include "core/map.h"
+#include "core/map_generator.h"
+#include "fileformats/file_format.h"
+#include "fileformats/file_format_registry.h"
+#include "fileformats/file_import_export.h"
+
+using namespace OpenOrienteering;
+
+
+namespace {
+
+void printError(const QString& message)
+{
+	std::fprintf(stderr, "%s\n", qPrintable(message));
+}
+
+bool readCount(const QCommandLineParser& parser, const QString& name, int& value)
+{
+	if (!parser.isSet(name))
+		return true;
+	
+	bool ok = false;
+	value = parser.value(name).toInt(&ok);
+	if (!ok || value < 0)
+	{
+		printError(QLatin1String("Invalid value for --") + name + QLatin1String(": ") + parser.value(name));
+		return false;
+	}
+	return true;
+}
+
+}  // namespace
+
+
+
+int main(int argc, char** argv)
+{
+	// Text objects need fonts, but no display.
+	if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+		qputenv("QT_QPA_PLATFORM", "minimal");
+	
+	QGuiApplication qapp(argc, argv);
+	QCoreApplication::setApplicationName(QStringLiteral("mapper-generate-map"));
+	
+	QCommandLineParser parser;
+	parser.setApplicationDescription(QStringLiteral(
+	    "Generates a synthetic map for scalability testing.\n"
+	    "The symbols are taken from the given symbol set. Explicit object\n"
+	    "counts replace the default mix of objects."));
+	parser.addHelpOption();
+	parser.addPositionalArgument(QStringLiteral("output"), QStringLiteral("The file to be written."));
+	
+	auto const c = [](const char* name, const char* description, const char* value_name) {
+		return QCommandLineOption(QString::fromLatin1(name), QString::fromLatin1(description), QString::fromLatin1(value_name));
+	};
+	parser.addOptions({
+	    c("symbol-set",   "The map providing the symbols (required).", "file"),
+	    c("objects",      "The total number of objects in the default mix (default: 10000).", "count"),
+	    c("areas",        "The number of area objects.", "count"),
+	    c("lines",        "The number of lines with solid line symbols.", "count"),
+	    c("dashed-lines", "The number of lines with dashed line symbols.", "count"),
+	    c("points",       "The number of point objects.", "count"),
+	    c("texts",        "The number of text objects.", "count"),
+	    c("tags",         "The number of tags per object (default: 2).", "count"),
+	    c("vertices",     "The number of vertices per line or area (default: 8).", "count"),
+	    c("spacing",      "The distance between objects in mm (default: 10).", "mm"),
+	    c("format",       "The ID of the output file format (default: by extension).", "id"),
+	});
+	parser.process(qapp);
+	
+	auto const positional = parser.positionalArguments();
+	if (positional.size() != 1 || !parser.isSet(QStringLiteral("symbol-set")))
+	{
+		parser.showHelp(1);
+	}
+	auto const output_path = positional.front();
+	
+	int num_objects = 10000;
+	if (!readCount(parser, QStringLiteral("objects"), num_objects))
+		return 1;
+	auto options = MapGenerator::mixedOptions(num_objects);
+	
+	auto const explicit_counts = parser.isSet(QStringLiteral("areas"))
+	                             || parser.isSet(QStringLiteral("lines"))
+	                             || parser.isSet(QStringLiteral("dashed-lines"))
+	                             || parser.isSet(QStringLiteral("points"))
+	                             || parser.isSet(QStringLiteral("texts"));
+	if (explicit_counts)
+		options.areas = options.lines = options.dashed_lines = options.points = options.texts = 0;
+	
+	if (!readCount(parser, QStringLiteral("areas"), options.areas)
+	    || !readCount(parser, QStringLiteral("lines"), options.lines)
+	    || !readCount(parser, QStringLiteral("dashed-lines"), options.dashed_lines)
+	    || !readCount(parser, QStringLiteral("points"), options.points)
+	    || !readCount(parser, QStringLiteral("texts"), options.texts)
+	    || !readCount(parser, QStringLiteral("tags"), options.tags)
+	    || !readCount(parser, QStringLiteral("vertices"), options.vertices))
+		return 1;
+	
+	if (parser.isSet(QStringLiteral("spacing")))
+	{
+		bool ok = false;
+		options.spacing = parser.value(QStringLiteral("spacing")).toDouble(&ok);
+		if (!ok || options.spacing <= 0)
+		{
+			printError(QLatin1String("Invalid value for --spacing: ") + parser.value(QStringLiteral("spacing")));
+			return 1;
+		}
+	}
+	
+	// Avoid numeric issues in libraries such as GDAL
+	setlocale(LC_NUMERIC, "C");
+	
+	doStaticInitializations();
+	
+	const FileFormat* format = nullptr;
+	if (parser.isSet(QStringLiteral("format")))
+		format = FileFormats.findFormat(parser.value(QStringLiteral("format")).toLatin1().constData());
+	else
+		format = FileFormats.findFormatForFilename(output_path, &FileFormat::supportsWriting);
+	if (!format || !format->supportsWriting())
+	{
+		printError(QLatin1String("No suitable file format for ") + output_path);
+		return 1;
+	}
+	
+	Map map;
+	if (!map.loadFrom(parser.value(QStringLiteral("symbol-set"))))
+	{
+		printError(QLatin1String("Cannot load the symbol set ") + parser.value(QStringLiteral("symbol-set")));
+		return 1;
+	}
+	
+	if (!MapGenerator(options).generate(map))
+	{
+		printError(QStringLiteral("The symbol set lacks symbols for the requested objects."));
+		return 1;
+	}
+	
+	auto exporter = format->makeExporter(output_path, &map, nullptr);
+	auto const success = exporter && exporter->doExport();
+	if (exporter)
+	{
+		for (auto const& warning : exporter->warnings())
+			printError(warning);
+	}
+	if (!success)
+	{
+		printError(QLatin1String("Cannot save ") + output_path);
+		return 1;
+	}
+	
+	std::printf("%d objects written to %s\n", options.numObjects(), qPrintable(output_path));
+	return 0;
+}
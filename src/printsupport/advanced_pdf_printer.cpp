@@ -50,3 +50,13 @@ QPaintEngine::Type AdvancedPdfPrinter::paintEngineType()
 {
 	return AdvancedPdfEngine::PaintEngineType;
 }
+
+void AdvancedPdfPrinter::setSharedPathsEnabled(bool enabled)
+{
+	engine->setSharedPathsEnabled(enabled);
+}
+
+void AdvancedPdfPrinter::setStreamingEnabled(bool enabled)
+{
+	engine->setStreamingEnabled(enabled);
+}
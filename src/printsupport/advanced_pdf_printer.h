@@ -43,6 +43,25 @@ public:
 	/** Returns the paint engine type which is used for advanced pdf generation. */
 	static QPaintEngine::Type paintEngineType();
 	
+	/**
+	 * Enables or disables the sharing of repeated paths.
+	 * 
+	 * When enabled, small paths which are drawn repeatedly, such as point
+	 * symbols and pattern elements, are written once as form XObjects and
+	 * referenced per instance. This is disabled by default.
+	 */
+	void setSharedPathsEnabled(bool enabled);
+	
+	/**
+	 * Enables or disables streaming of page content.
+	 * 
+	 * When enabled, the content of the current page is moved to a temporary
+	 * file as soon as it exceeds a few megabytes, so that the memory needed
+	 * for large pages doesn't grow with the number of objects. Otherwise,
+	 * this happens only for very large pages. This is disabled by default.
+	 */
+	void setStreamingEnabled(bool enabled);
+	
 private:
 	void init();
 	
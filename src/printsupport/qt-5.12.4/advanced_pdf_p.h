@@ -82,16 +82,24 @@ namespace AdvancedPdf {
         static inline int maxMemorySize() { return 100000000; }
         static inline int chunkSize()     { return 10000000; }
 
+        // Sets the size above which a file backed stream moves to disk.
+        void setMemoryLimit(qint64 limit) { memoryLimit = limit; }
+
     protected:
         void constructor_helper(QIODevice *dev);
         void constructor_helper(QByteArray *ba);
 
     private:
+        inline bool needsPreparation() const {
+            return handleDirty
+                    || (fileBackingEnabled && !fileBackingActive && dev->size() > memoryLimit);
+        }
         void prepareBuffer();
 
     private:
         QIODevice *dev;
         QByteArray ba;
+        qint64 memoryLimit;
         bool fileBackingEnabled;
         bool fileBackingActive;
         bool handleDirty;
@@ -133,7 +141,7 @@ namespace AdvancedPdf {
 class AdvancedPdfPage : public AdvancedPdf::ByteStream
 {
 public:
-    AdvancedPdfPage();
+    explicit AdvancedPdfPage(bool streaming = false);
 
     QVector<uint> images;
     QVector<uint> graphicStates;
@@ -178,6 +186,9 @@ public:
     void setResolution(int resolution);
     int resolution() const;
 
+    void setSharedPathsEnabled(bool enabled);
+    void setStreamingEnabled(bool enabled);
+
     void setPdfVersion(PdfVersion version);
 
     // reimplementations QPaintEngine
@@ -239,6 +250,7 @@ public:
     int addImage(const QImage &image, bool *bitmap, qint64 serial_no);
     int addConstantAlphaObject(int brushAlpha, int penAlpha = 255);
     int addBrushPattern(const QTransform &matrix, bool *specifyColor, int *gStateObject);
+    bool drawSharedPath(const QPainterPath &path, AdvancedPdf::PathFlags flags);
 
     void drawTextItem(const QPointF &p, const QTextItemInt &ti);
 
@@ -278,6 +290,8 @@ public:
     bool embedFonts;
     int resolution;
     bool grayscale;
+    bool sharePaths;
+    bool streamPages;
 
     // Page layout: size, orientation and margins
     QPageLayout m_pageLayout;
@@ -321,6 +335,7 @@ private:
     int pageRoot, catalog, info, graphicsState, patternColorSpace;
     QVector<uint> pages;
     QHash<qint64, uint> imageCache;
+    QHash<QByteArray, int> sharedPathCache;
     QHash<QPair<uint, uint>, uint > alphaCache;
 };
 
@@ -28,6 +28,9 @@
 #include <qdebug.h>
 #include <qendian.h>
 #include <qpainterpath.h>
+#include <qcache.h>
+#include <qdatastream.h>
+#include <qmutex.h>
 #include "advanced_pdf_p.h"
 
 #include "qfontsubset_agl.cpp"
@@ -1149,7 +1152,61 @@ static QByteArray bindFont(const QVector<QTtfTable>& _tables)
   if really required.
 */
 
+namespace {
+
+/*
+ * Font programs which were generated in the current session.
+ *
+ * Repeated exports usually embed the same fonts with the same glyphs.
+ * The generated data does not depend on the document, so it is cached
+ * across exports, keyed by font face, size and glyph set.
+ */
+struct TruetypeCacheEntry
+{
+    QByteArray data;
+    QVector<QFixed> widths;
+};
+
+QMutex truetype_cache_mutex;
+QCache<QByteArray, TruetypeCacheEntry> truetype_cache(32 * 1024 * 1024);
+
+} // namespace
+
 QByteArray QFontSubset::toTruetype() const
+{
+    const QFontEngine::FaceId face_id = fontEngine->faceId();
+    if (face_id.filename.isEmpty() && face_id.uuid.isEmpty())
+        return generateTruetype();
+
+    QByteArray key;
+    {
+        QDataStream stream(&key, QIODevice::WriteOnly);
+        stream << face_id.filename << face_id.uuid << face_id.index << face_id.encoding
+               << fontEngine->fontDef.pixelSize << noEmbed << glyph_indices;
+    }
+
+    {
+        QMutexLocker locker(&truetype_cache_mutex);
+        if (const TruetypeCacheEntry *entry = truetype_cache.object(key)) {
+            // Cf. the initialization at the beginning of generateTruetype()
+            emSquare = 2048;
+            widths = entry->widths;
+            return entry->data;
+        }
+    }
+
+    TruetypeCacheEntry *entry = new TruetypeCacheEntry;
+    entry->data = generateTruetype();
+    entry->widths = widths;
+    const QByteArray data = entry->data;
+    {
+        QMutexLocker locker(&truetype_cache_mutex);
+        truetype_cache.insert(key, entry, data.size() + key.size());
+    }
+    return data;
+}
+
+QByteArray QFontSubset::generateTruetype() const
 {
     qttf_font_tables font;
     memset(&font, 0, sizeof(qttf_font_tables));
@@ -60,6 +60,7 @@ public:
     }
 
     QByteArray toTruetype() const;
+    QByteArray generateTruetype() const;
 #ifndef QT_NO_PDF
     QByteArray widthArray() const;
     QByteArray createToUnicodeMap() const;
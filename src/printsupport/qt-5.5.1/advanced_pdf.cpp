@@ -157,6 +157,7 @@ const char *qt_int_to_string(int val, char *buf) {
 namespace AdvancedPdf {
     ByteStream::ByteStream(QByteArray *byteArray, bool fileBacking)
             : dev(new QBuffer(byteArray)),
+            memoryLimit(maxMemorySize()),
             fileBackingEnabled(fileBacking),
             fileBackingActive(false),
             handleDirty(false)
@@ -166,6 +167,7 @@ namespace AdvancedPdf {
 
     ByteStream::ByteStream(bool fileBacking)
             : dev(new QBuffer(&ba)),
+            memoryLimit(maxMemorySize()),
             fileBackingEnabled(fileBacking),
             fileBackingActive(false),
             handleDirty(false)
@@ -180,21 +182,21 @@ namespace AdvancedPdf {
 
     ByteStream &ByteStream::operator <<(char chr)
     {
-        if (handleDirty) prepareBuffer();
+        if (needsPreparation()) prepareBuffer();
         dev->write(&chr, 1);
         return *this;
     }
 
     ByteStream &ByteStream::operator <<(const char *str)
     {
-        if (handleDirty) prepareBuffer();
+        if (needsPreparation()) prepareBuffer();
         dev->write(str, strlen(str));
         return *this;
     }
 
     ByteStream &ByteStream::operator <<(const QByteArray &str)
     {
-        if (handleDirty) prepareBuffer();
+        if (needsPreparation()) prepareBuffer();
         dev->write(str);
         return *this;
     }
@@ -202,7 +204,7 @@ namespace AdvancedPdf {
     ByteStream &ByteStream::operator <<(const ByteStream &src)
     {
         Q_ASSERT(!src.dev->isSequential());
-        if (handleDirty) prepareBuffer();
+        if (needsPreparation()) prepareBuffer();
         // We do play nice here, even though it looks ugly.
         // We save the position and restore it afterwards.
         ByteStream &s = const_cast<ByteStream&>(src);
@@ -263,7 +265,7 @@ namespace AdvancedPdf {
         Q_ASSERT(!dev->isSequential());
         qint64 size = dev->size();
         if (fileBackingEnabled && !fileBackingActive
-                && size > maxMemorySize()) {
+                && size > memoryLimit) {
             // Switch to file backing.
             QTemporaryFile *newFile = new QTemporaryFile;
             newFile->open();
@@ -277,10 +279,9 @@ namespace AdvancedPdf {
             ba.clear();
             fileBackingActive = true;
         }
-        if (dev->pos() != size) {
+        if (dev->pos() != size)
             dev->seek(size);
-            handleDirty = false;
-        }
+        handleDirty = false;
     }
 }
 
@@ -726,9 +727,12 @@ const char *AdvancedPdf::toHex(uchar u, char *buffer)
 }
 
 
-AdvancedPdfPage::AdvancedPdfPage()
+AdvancedPdfPage::AdvancedPdfPage(bool streaming)
     : AdvancedPdf::ByteStream(true) // Enable file backing
 {
+    // When streaming, at most one chunk of content is kept in memory.
+    if (streaming)
+        setMemoryLimit(chunkSize());
 }
 
 void AdvancedPdfPage::streamImage(int w, int h, int object)
@@ -868,9 +872,11 @@ void AdvancedPdfEngine::drawPath (const QPainterPath &p)
 
     if (d->simplePen) {
         // draw strokes natively in this case for better output
-        *d->currentPage << AdvancedPdf::generatePath(p, QTransform(), d->hasBrush ? AdvancedPdf::FillAndStrokePath : AdvancedPdf::StrokePath);
+        const AdvancedPdf::PathFlags flags = d->hasBrush ? AdvancedPdf::FillAndStrokePath : AdvancedPdf::StrokePath;
+        if (!d->drawSharedPath(p, flags))
+            *d->currentPage << AdvancedPdf::generatePath(p, QTransform(), flags);
     } else {
-        if (d->hasBrush)
+        if (d->hasBrush && (d->hasPen || !d->drawSharedPath(d->stroker.matrix.map(p), AdvancedPdf::FillPath)))
             *d->currentPage << AdvancedPdf::generatePath(p, d->stroker.matrix, AdvancedPdf::FillPath);
         if (d->hasPen) {
             *d->currentPage << "q\n";
@@ -1257,6 +1263,18 @@ int AdvancedPdfEngine::resolution() const
     return d->resolution;
 }
 
+void AdvancedPdfEngine::setSharedPathsEnabled(bool enabled)
+{
+    Q_D(AdvancedPdfEngine);
+    d->sharePaths = enabled;
+}
+
+void AdvancedPdfEngine::setStreamingEnabled(bool enabled)
+{
+    Q_D(AdvancedPdfEngine);
+    d->streamPages = enabled;
+}
+
 void AdvancedPdfEngine::setPageLayout(const QPageLayout &pageLayout)
 {
     Q_D(AdvancedPdfEngine);
@@ -1335,6 +1353,8 @@ AdvancedPdfEnginePrivate::AdvancedPdfEnginePrivate()
       outDevice(0), ownsDevice(false),
       embedFonts(true),
       grayscale(false),
+      sharePaths(false),
+      streamPages(false),
       m_pageLayout(QPageSize(QPageSize::A4), QPageLayout::Portrait, QMarginsF(10, 10, 10, 10))
 {
     resolution = 1200;
@@ -1368,7 +1388,7 @@ bool AdvancedPdfEngine::begin(QPaintDevice *pdev)
 
     d->currentObject = 1;
 
-    d->currentPage = new AdvancedPdfPage;
+    d->currentPage = new AdvancedPdfPage(d->streamPages);
     d->stroker.stream = d->currentPage;
     d->opacity = 1.0;
 
@@ -1390,6 +1410,7 @@ bool AdvancedPdfEngine::begin(QPaintDevice *pdev)
 
     d->pages.clear();
     d->imageCache.clear();
+    d->sharedPathCache.clear();
     d->alphaCache.clear();
 
     setActive(true);
@@ -2264,6 +2285,66 @@ int AdvancedPdfEnginePrivate::gradientBrush(const QBrush &b, const QTransform &m
     return patternObj;
 }
 
+/*!
+ * Draws a path which is repeated in the document via a shared form XObject.
+ *
+ * The path is identified by its shape relative to its first point and by the
+ * painting operator. Its first occurrence is drawn inline. For the following
+ * occurrences, the path is written once as a form XObject, and each instance
+ * only references this object with a translation. The form inherits color,
+ * line width and clipping from the invoking content stream.
+ *
+ * Returns false if the caller must draw the path inline.
+ */
+bool AdvancedPdfEnginePrivate::drawSharedPath(const QPainterPath &path, AdvancedPdf::PathFlags flags)
+{
+    if (!sharePaths)
+        return false;
+    // Large paths are rarely repeated. Tiling patterns and gradients
+    // would change when drawn from the form's coordinate system.
+    const int count = path.elementCount();
+    if (count < 4 || count > 256)
+        return false;
+    if (flags != AdvancedPdf::StrokePath && brush.style() != Qt::SolidPattern)
+        return false;
+
+    const QPointF origin = path.elementAt(0);
+    const QByteArray content = AdvancedPdf::generatePath(path, QTransform::fromTranslate(-origin.x(), -origin.y()), flags);
+    int &object = sharedPathCache[content];
+    if (object == 0) {
+        object = -1;
+        return false;
+    }
+
+    if (object < 0) {
+        QRectF bbox = path.controlPointRect().translated(-origin);
+        qreal margin = 1;
+        if (flags != AdvancedPdf::FillPath)
+            margin += pen.widthF() * qMax(qreal(1), qreal(pen.miterLimit()));
+        bbox.adjust(-margin, -margin, margin, margin);
+
+        QByteArray form;
+        AdvancedPdf::ByteStream f(&form);
+        f << "<<\n"
+            "/Type /XObject\n"
+            "/Subtype /Form\n"
+            "/BBox [" << bbox.left() << bbox.top() << bbox.right() << bbox.bottom() << "]\n"
+            "/Length " << content.length() << "\n"
+            ">>\n"
+            "stream\n"
+          << content
+          << "\nendstream\n"
+            "endobj\n";
+        object = addXrefEntry(-1);
+        write(form);
+    }
+
+    if (currentPage->images.indexOf(uint(object)) < 0)
+        currentPage->images.append(uint(object));
+    *currentPage << "q 1 0 0 1 " << origin.x() << origin.y() << "cm /Im" << object << "Do\nQ\n";
+    return true;
+}
+
 int AdvancedPdfEnginePrivate::addConstantAlphaObject(int brushAlpha, int penAlpha)
 {
     if (brushAlpha == 255 && penAlpha == 255)
@@ -2678,7 +2759,7 @@ void AdvancedPdfEnginePrivate::newPage()
     writePage();
 
     delete currentPage;
-    currentPage = new AdvancedPdfPage;
+    currentPage = new AdvancedPdfPage(streamPages);
     currentPage->pageSize = m_pageLayout.fullRectPoints().size();
     stroker.stream = currentPage;
     pages.append(requestObject());
@@ -88,16 +88,24 @@ namespace AdvancedPdf {
         static inline int maxMemorySize() { return 100000000; }
         static inline int chunkSize()     { return 10000000; }
 
+        // Sets the size above which a file backed stream moves to disk.
+        void setMemoryLimit(qint64 limit) { memoryLimit = limit; }
+
     protected:
         void constructor_helper(QIODevice *dev);
         void constructor_helper(QByteArray *ba);
 
     private:
+        inline bool needsPreparation() const {
+            return handleDirty
+                    || (fileBackingEnabled && !fileBackingActive && dev->size() > memoryLimit);
+        }
         void prepareBuffer();
 
     private:
         QIODevice *dev;
         QByteArray ba;
+        qint64 memoryLimit;
         bool fileBackingEnabled;
         bool fileBackingActive;
         bool handleDirty;
@@ -139,7 +147,7 @@ namespace AdvancedPdf {
 class AdvancedPdfPage : public AdvancedPdf::ByteStream
 {
 public:
-    AdvancedPdfPage();
+    explicit AdvancedPdfPage(bool streaming = false);
 
     QVector<uint> images;
     QVector<uint> graphicStates;
@@ -177,6 +185,9 @@ public:
     void setResolution(int resolution);
     int resolution() const;
 
+    void setSharedPathsEnabled(bool enabled);
+    void setStreamingEnabled(bool enabled);
+
     // reimplementations QPaintEngine
     bool begin(QPaintDevice *pdev) Q_DECL_OVERRIDE;
     bool end() Q_DECL_OVERRIDE;
@@ -234,6 +245,7 @@ public:
     int addImage(const QImage &image, bool *bitmap, qint64 serial_no);
     int addConstantAlphaObject(int brushAlpha, int penAlpha = 255);
     int addBrushPattern(const QTransform &matrix, bool *specifyColor, int *gStateObject);
+    bool drawSharedPath(const QPainterPath &path, AdvancedPdf::PathFlags flags);
 
     void drawTextItem(const QPointF &p, const QTextItemInt &ti);
 
@@ -272,6 +284,8 @@ public:
     bool embedFonts;
     int resolution;
     bool grayscale;
+    bool sharePaths;
+    bool streamPages;
 
     // Page layout: size, orientation and margins
     QPageLayout m_pageLayout;
@@ -312,6 +326,7 @@ private:
     int pageRoot, catalog, info, graphicsState, patternColorSpace;
     QVector<uint> pages;
     QHash<qint64, uint> imageCache;
+    QHash<QByteArray, int> sharedPathCache;
     QHash<QPair<uint, uint>, uint > alphaCache;
 };
 
@@ -26,6 +26,7 @@
 
 #ifdef QT_SENSORS_LIB
 
+#include <algorithm>
 #include <cmath>
 #include <cstring>
 
@@ -61,6 +62,23 @@
 namespace OpenOrienteering {
 
 #ifdef QT_SENSORS_LIB
+
+namespace {
+
+/// Sensor polling interval while the azimuth changes, in milliseconds.
+constexpr unsigned long active_interval = 30;
+
+/// Sensor polling interval while the device is held still, in milliseconds.
+constexpr unsigned long stationary_interval = 250;
+
+/// Time without relevant changes before switching to the stationary interval.
+constexpr unsigned long stationary_delay = 2000;
+
+/// Azimuth changes below this value (in degrees) are not reported.
+constexpr float min_azimuth_change = 0.25f;
+
+}  // namespace
+
 	
 namespace SensorHelpers {
 	
@@ -395,11 +413,16 @@ private:
             return result;
 		}
 		
-		void filter()
+		/**
+		 * Updates the azimuth from the latest readings.
+		 * 
+		 * Returns true if receivers were notified about a changed azimuth.
+		 */
+		bool filter()
 		{
 			if (p->accelerometer.reading() == nullptr ||
 				p->magnetometer.reading() == nullptr)
-				return;
+				return false;
 			
 			// Make copies of the sensor readings (and hope that the reading thread
 			// does not overwrite parts of them while they are being copied)
@@ -418,7 +441,7 @@ private:
 			float R[9];
 			bool ok = SensorHelpers::getRotationMatrix(R, acceleration, geomagnetic);
 			if (!ok)
-				return;
+				return false;
 			
 			float acc_mag_orientation[3];
 			SensorHelpers::getOrientation(R, acc_mag_orientation);
@@ -476,8 +499,15 @@ private:
 			}
 #endif
 
-			// Send update to receivers
+			// Send update to receivers, unless the change is negligible
+			auto delta = std::abs(p->latest_azimuth - last_emitted_azimuth);
+			delta = std::min(delta, 360 - delta);
+			if (delta < min_azimuth_change)
+				return false;
+			
+			last_emitted_azimuth = p->latest_azimuth;
 			p->compass->emitAzimuthChanged(p->latest_azimuth);
+			return true;
 		}
 		
 		void run() override
@@ -485,6 +515,8 @@ private:
 			// Wait until sensors are initialized
 			QThread::msleep(1000);
 			
+			// Time without reported changes, in milliseconds
+			unsigned long stationary_time = 0;
 			while (keep_running)
 			{
 				if (! p->enabled)
@@ -495,14 +527,22 @@ private:
 					wait_mutex.unlock();
 					
 					// May do initializations after (re-)enabling here
+					stationary_time = 0;
+					last_emitted_azimuth = -1000;
 				}
 				
-				filter();
+				// Poll less frequently while the device is held still.
+				auto interval = (stationary_time < stationary_delay) ? active_interval : stationary_interval;
+				if (filter())
+					stationary_time = 0;
+				else if (stationary_time < stationary_delay)
+					stationary_time += interval;
 				
-				QThread::msleep(30);
+				QThread::msleep(interval);
 			}
 		}
 		
+		float last_emitted_azimuth = -1000;
 		QMutex wait_mutex;
 		QWaitCondition condition;
 		bool keep_running;
@@ -52,12 +52,14 @@ public:
 	void stopUsage();
 	
 	/** Returns the most recent azimuth value
-	 *  (in degrees clockwise from north; updated approx. every 30 milliseconds). */
+	 *  (in degrees clockwise from north; updated approx. every 30 milliseconds,
+	 *  or every 250 milliseconds while the device is held still). */
 	float getCurrentAzimuth();
 	
 	/** Connects to the azimuthChanged(float azimuth_degrees) signal. This ensures to use a queued
 	 *  connection, which is important because the data provider runs on another
-	 *  thread. Updates are delivered approx. every 30 milliseconds. */
+	 *  thread. Updates are delivered approx. every 30 milliseconds, but only
+	 *  when the azimuth changes by at least a quarter degree. */
 	void connectToAzimuthChanges(const QObject* receiver, const char* slot);
 	
 	/** Disconnects the given receiver from azimuth changes. */
@@ -47,11 +47,14 @@ Q_DECLARE_METATYPE(QGeoPositionInfo)  // QTBUG-65937
 #include <QPen>
 #include <QPoint>
 #include <QPointF>
+#include <QRectF>
+#include <QSizeF>
 #if MAPPER_DEVELOPMENT_BUILD
 #  include <QTime>
 #endif
 #include <QTimer>  // IWYU pragma: keep
 #include <QTimerEvent>
+#include <QTransform>
 
 #include "settings.h"
 #include "core/georeferencing.h"
@@ -70,6 +73,33 @@ namespace {
 // Opacities as understood by QPainter::setOpacity().
 static qreal opacity_curve[] = { 0.8, 1.0, 0.8, 0.5, 0.2, 0.0, 0.2, 0.5 };
 
+// The regular interval of position updates, in milliseconds.
+constexpr int regular_update_interval = 1000;
+
+// The interval of position updates while stationary and idle, in milliseconds.
+constexpr int low_power_update_interval = 5000;
+
+// The number of fixes without movement before switching to low power updates.
+constexpr int low_power_fix_count = 30;
+
+// The time without user interaction before switching to low power updates,
+// in milliseconds.
+constexpr int low_power_idle_time = 30000;
+
+// Movements below this distance (or below the accuracy), in meters,
+// are regarded as noise.
+constexpr qreal stationary_distance = 3;
+
+// The interval of marker updates between position updates, in milliseconds.
+constexpr int prediction_interval = 100;
+
+// The maximum time for moving the marker after a fix, in milliseconds.
+constexpr qint64 max_prediction_time = 1500;
+
+// The minimum speed for moving the marker, in meters per second.
+// Below this speed, the movement is dominated by noise.
+constexpr qreal min_prediction_speed = 0.5;
+
 }  // namespace
 
 
@@ -141,7 +171,7 @@ GPSDisplay::GPSDisplay(MapWidget* widget, const Georeferencing& georeferencing,
 	}
 	
 	source->setPreferredPositioningMethods(QGeoPositionInfoSource::SatellitePositioningMethods);
-	source->setUpdateInterval(1000);
+	source->setUpdateInterval(regular_update_interval);
 	connect(source, &QGeoPositionInfoSource::positionUpdated, this, &GPSDisplay::positionUpdated, Qt::QueuedConnection);
 	connect(source, QOverload<QGeoPositionInfoSource::Error>::of(&QGeoPositionInfoSource::error), this, &GPSDisplay::error);
 	connect(source, &QGeoPositionInfoSource::updateTimeout, this, &GPSDisplay::updateTimeout);
@@ -208,6 +238,9 @@ void GPSDisplay::stopUpdates()
 		has_valid_position = false;
 	}
 #endif
+	stopPrediction();
+	setLowPowerUpdates(false);
+	stationary_fixes = 0;
 }
 
 void GPSDisplay::setVisible(bool visible)
@@ -238,6 +271,7 @@ void GPSDisplay::enableHeadingIndicator(bool enable)
 
 void GPSDisplay::paint(QPainter* painter)
 {
+	marker_rect = {};
 	if (!visible || !has_valid_position)
 		return;
 	
@@ -246,7 +280,8 @@ void GPSDisplay::paint(QPainter* painter)
 	MapCoordF gps_coord = calcLatestGPSCoord(ok);
 	if (!ok)
 		return;
-	QPointF gps_pos = widget->mapToViewport(gps_coord);
+	QPointF gps_pos = widget->mapToViewport(gps_coord + prediction_offset);
+	marker_rect = painter->worldTransform().mapRect(QRectF(markerRect(gps_pos))).toAlignedRect();
 	
 	const auto one_mm = Util::mmToPixelLogical(1);
 	const auto mmToPixelLogical = [one_mm](qreal mm) { return mm * one_mm; };
@@ -370,12 +405,25 @@ void GPSDisplay::timerEvent(QTimerEvent* e)
 		}
 		updateMapWidget();
 	}
+	else if (e->timerId() == prediction_timer_id)
+	{
+		// Keep the marker at the last predicted position when the timer stops.
+		if (!fix_timer.isValid() || fix_timer.elapsed() > max_prediction_time)
+		{
+			killTimer(prediction_timer_id);
+			prediction_timer_id = 0;
+		}
+		updateMapWidget();
+	}
 }
 
 
 void GPSDisplay::positionUpdated(const QGeoPositionInfo& info)
 {
 #if defined(QT_POSITIONING_LIB)
+	auto const previous_coord = latest_gps_coord;
+	auto const had_previous_coord = has_valid_position && !tracking_lost;
+	
 	gps_updated = true;
 	tracking_lost = false;
 	has_valid_position = true;
@@ -384,6 +432,12 @@ void GPSDisplay::positionUpdated(const QGeoPositionInfo& info)
 	calcLatestGPSCoord(ok);
 	if (ok)
 	{
+		auto const speed = info.hasAttribute(QGeoPositionInfo::GroundSpeed)
+		                   ? float(info.attribute(QGeoPositionInfo::GroundSpeed))
+		                   : -1;
+		updateVelocity(previous_coord, had_previous_coord, speed);
+		adaptUpdateInterval(previous_coord, had_previous_coord);
+		
 		emit mapPositionUpdated(latest_gps_coord, latest_gps_coord_accuracy);
 		emit latLonUpdated(
 			info.coordinate().latitude(),
@@ -405,6 +459,7 @@ void GPSDisplay::error()
 		if (!tracking_lost)
 		{
 			tracking_lost = true;
+			stopPrediction();
 			emit positionUpdatesInterrupted();
 			updateMapWidget();
 		}
@@ -418,6 +473,7 @@ void GPSDisplay::updateTimeout()
 	if (!tracking_lost)
 	{
 		tracking_lost = true;
+		stopPrediction();
 		emit positionUpdatesInterrupted();
 		updateMapWidget();
 	}
@@ -450,8 +506,10 @@ void GPSDisplay::debugPositionUpdate()
 	gps_updated = true;
 	tracking_lost = false;
 	has_valid_position = true;
+	auto const previous_coord = latest_gps_coord;
 	latest_gps_coord = coord;
 	latest_gps_coord_accuracy = accuracy;
+	updateVelocity(previous_coord, true, -1);
 	updateMapWidget();
 #endif
 }
@@ -500,8 +558,99 @@ MapCoordF GPSDisplay::calcLatestGPSCoord(bool& ok)
 
 void GPSDisplay::updateMapWidget()
 {
-	// TODO: Limit update region to union of old and new bounding rect
-	widget->update();
+	prediction_offset = {};
+	if (fix_timer.isValid())
+		prediction_offset = velocity * (std::min(fix_timer.elapsed(), max_prediction_time) / qreal(1000));
+	
+	auto dirty_rect = marker_rect;
+	if (visible && has_valid_position)
+	{
+		bool ok = true;
+		auto const gps_coord = calcLatestGPSCoord(ok);
+		if (ok)
+			dirty_rect |= markerRect(widget->mapToViewport(gps_coord + prediction_offset));
+	}
+	if (!dirty_rect.isEmpty())
+		widget->update(dirty_rect);
+}
+
+void GPSDisplay::updateVelocity(const MapCoordF& previous_coord, bool had_previous_coord, float speed)
+{
+	auto const elapsed = fix_timer.isValid() ? fix_timer.restart() : 0;
+	if (!fix_timer.isValid())
+		fix_timer.start();
+	
+	stopPrediction();
+	if (!Settings::getInstance().positionPrediction()
+	    || !had_previous_coord
+	    || elapsed <= 0
+	    || elapsed > 2 * max_prediction_time)
+	{
+		return;
+	}
+	
+	auto const seconds = elapsed / qreal(1000);
+	auto const movement = latest_gps_coord - previous_coord;
+	if (speed < 0)
+		speed = float(movement.length() * georeferencing.getScaleDenominator() / 1000 / seconds);
+	if (qreal(speed) < min_prediction_speed)
+		return;
+	
+	velocity = movement * (1 / seconds);
+	prediction_timer_id = startTimer(prediction_interval);
+}
+
+void GPSDisplay::stopPrediction()
+{
+	if (prediction_timer_id)
+	{
+		killTimer(prediction_timer_id);
+		prediction_timer_id = 0;
+	}
+	velocity = {};
+	prediction_offset = {};
+}
+
+void GPSDisplay::adaptUpdateInterval(const MapCoordF& previous_coord, bool had_previous_coord)
+{
+	auto const meters = (latest_gps_coord - previous_coord).length() * georeferencing.getScaleDenominator() / 1000;
+	auto const stationary = had_previous_coord
+	                        && meters < std::max(qreal(latest_gps_coord_accuracy), stationary_distance);
+	stationary_fixes = stationary ? std::min(stationary_fixes + 1, low_power_fix_count) : 0;
+	setLowPowerUpdates(stationary_fixes >= low_power_fix_count
+	                   && widget->getTimeSinceLastInteraction() >= low_power_idle_time);
+}
+
+void GPSDisplay::setLowPowerUpdates(bool enabled)
+{
+	if (low_power_updates == enabled)
+		return;
+	
+	low_power_updates = enabled;
+#if defined(QT_POSITIONING_LIB)
+	if (source)
+		source->setUpdateInterval(enabled ? low_power_update_interval : regular_update_interval);
+#endif
+}
+
+QRect GPSDisplay::markerRect(const QPointF& gps_pos) const
+{
+	// The heading line is very long.
+	if (heading_indicator_enabled)
+		return widget->rect();
+	
+	const auto one_mm = Util::mmToPixelLogical(1);
+	auto const meters_to_pixels = widget->getMapView()->lengthToPixel(qreal(1000000) / georeferencing.getScaleDenominator());
+	
+	// Crosshairs and framing
+	auto radius = 10.5 * one_mm;
+	if (distance_rings_enabled)
+		radius = std::max(radius, 20 * meters_to_pixels + one_mm);
+	if (latest_gps_coord_accuracy >= 0)
+		radius = std::max(radius, qreal(latest_gps_coord_accuracy) * meters_to_pixels + one_mm);
+	radius += 2;  // antialiasing
+	
+	return QRectF(gps_pos - QPointF(radius, radius), QSizeF(2 * radius, 2 * radius)).toAlignedRect();
 }
 
 
@@ -23,7 +23,9 @@
 #define OPENORIENTEERING_GPS_DISPLAY_H
 
 #include <QtGlobal>
+#include <QElapsedTimer>
 #include <QObject>
+#include <QRect>
 #include <QString>
 
 #include "core/map_coord.h"
@@ -31,6 +33,7 @@
 class QGeoPositionInfo;
 class QGeoPositionInfoSource;
 class QPainter;
+class QPointF;
 class QTimerEvent;
 
 namespace OpenOrienteering {
@@ -42,6 +45,17 @@ class MapWidget;
 /**
  * Retrieves the GPS position and displays a marker at this position on a MapWidget.
  * 
+ * Updates of the marker only repaint the area covered by the old and the new
+ * marker. The map widget's caches are not affected.
+ * 
+ * If enabled in the settings, the marker is moved between two position
+ * updates, extrapolating the movement between the last two fixes. This
+ * affects only the display: getLatestGPSCoord() and the signals always
+ * report the received positions.
+ * 
+ * To save battery, position updates are requested less frequently while the
+ * position does not change and the user does not interact with the map.
+ * 
  * \todo Use qreal instead of float (in all sensor code) for consistency with Qt.
  */
 class GPSDisplay : public QObject
@@ -128,6 +142,19 @@ private:
 	MapCoordF calcLatestGPSCoord(bool& ok);
 	void updateMapWidget();
 	
+	/// Updates the movement estimate from the latest fix.
+	void updateVelocity(const MapCoordF& previous_coord, bool had_previous_coord, float speed);
+	/// Stops moving the marker between position updates.
+	void stopPrediction();
+	
+	/// Adjusts the position update interval to movement and user interaction.
+	void adaptUpdateInterval(const MapCoordF& previous_coord, bool had_previous_coord);
+	/// Switches between the regular and the low-power update interval.
+	void setLowPowerUpdates(bool enabled);
+	
+	/// Returns the viewport area covered by a marker at the given position.
+	QRect markerRect(const QPointF& gps_pos) const;
+	
 	/**
 	 * A lightweight utility for sinusoidal pulsating opacity.
 	 * 
@@ -165,12 +192,19 @@ private:
 	float latest_gps_coord_accuracy = 0;
 	PulsatingOpacity pulsating_opacity;
 	int blink_count = 0;
+	QRect marker_rect;                 ///< The area of the last painted marker.
+	MapCoordF velocity;                ///< Estimated movement in map mm per second.
+	MapCoordF prediction_offset;       ///< The offset of the displayed marker from the latest fix.
+	QElapsedTimer fix_timer;           ///< Measures the time since the latest fix.
+	int prediction_timer_id = 0;
+	int stationary_fixes = 0;          ///< The number of fixes without relevant movement.
 	bool tracking_lost             = false;
 	bool has_valid_position        = false;
 	bool gps_updated               = false;
 	bool visible                   = false;
 	bool distance_rings_enabled    = false;
 	bool heading_indicator_enabled = false;
+	bool low_power_updates         = false;
 };
 
 
@@ -45,7 +45,7 @@ GPSTrackRecorder::GPSTrackRecorder(GPSDisplay* gps_display, TemplateTrack* targe
 	is_active = true;
 	
 	// Start with a new segment
-	target_template->getTrack().finishCurrentSegment();
+	target_template->finishRecordedSegment();
 	
 	connect(gps_display, &GPSDisplay::latLonUpdated, this, &GPSTrackRecorder::newPosition);
 	connect(gps_display, &GPSDisplay::positionUpdatesInterrupted, this, &GPSTrackRecorder::positionUpdatesInterrupted);
@@ -66,15 +66,13 @@ void GPSTrackRecorder::newPosition(double latitude, double longitude, double alt
 		static_cast<float>(altitude),
 		accuracy
 	};
-	target_template->getTrack().appendTrackPoint(new_point);
-	target_template->setHasUnsavedChanges(true);
+	target_template->appendRecordedPoint(new_point);
 	track_changed_since_last_update = true;
 }
 
 void GPSTrackRecorder::positionUpdatesInterrupted()
 {
-	target_template->getTrack().finishCurrentSegment();
-	target_template->setHasUnsavedChanges(true);
+	target_template->finishRecordedSegment();
 	track_changed_since_last_update = true;
 }
 
@@ -101,7 +99,7 @@ void GPSTrackRecorder::drawUpdate()
 	if (track_changed_since_last_update)
 	{
 		if (widget->getMapView()->isTemplateVisible(target_template))
-			target_template->setTemplateAreaDirty();
+			target_template->setRecordedAreaDirty();
 		
 		track_changed_since_last_update = false;
 	}
@@ -0,0 +1,354 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "nmea_parser.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#include <QDateTime>
+#include <QGeoCoordinate>
+#include <QGeoPositionInfo>
+
+
+namespace OpenOrienteering
+{
+
+namespace
+{
+
+/// Meters per second for one knot.
+constexpr double knots_to_mps = 1852.0 / 3600.0;
+
+/// User equivalent range error for estimating the accuracy from HDOP, in meters.
+constexpr double user_equivalent_range_error = 5.0;
+
+/// The maximum time difference between a position and its attributes.
+constexpr int max_attribute_age = 2000;  // ms
+
+/// Returns true if the sentence type matches the given three letters.
+bool isType(const char* type, const char* expected) noexcept
+{
+	return std::strncmp(type, expected, 3) == 0;
+}
+
+int hexValue(char c) noexcept
+{
+	if (c >= '0' && c <= '9')
+		return c - '0';
+	if (c >= 'A' && c <= 'F')
+		return c - 'A' + 10;
+	if (c >= 'a' && c <= 'f')
+		return c - 'a' + 10;
+	return -1;
+}
+
+}  // namespace
+
+
+
+// static
+bool NmeaParser::hasValidChecksum(const char* data, int size) noexcept
+{
+	if (size < 1 || (data[0] != '$' && data[0] != '!'))
+		return false;
+	
+	auto const* end = data + size;
+	while (end != data && (end[-1] == '\n' || end[-1] == '\r'))
+		--end;
+	
+	auto const* star = static_cast<const char*>(std::memchr(data, '*', std::size_t(end - data)));
+	if (!star)
+		return true;  // The checksum is optional.
+	if (end - star != 3)
+		return false;
+	
+	auto checksum = 0;
+	for (auto const* c = data + 1; c != star; ++c)
+		checksum ^= static_cast<unsigned char>(*c);
+	auto const high = hexValue(star[1]);
+	auto const low = hexValue(star[2]);
+	return high >= 0 && low >= 0 && checksum == 16 * high + low;
+}
+
+// static
+int NmeaParser::split(const char* data, int size, Field (&fields)[max_fields]) noexcept
+{
+	auto const* end = data + size;
+	while (end != data && (end[-1] == '\n' || end[-1] == '\r'))
+		--end;
+	if (auto const* star = static_cast<const char*>(std::memchr(data, '*', std::size_t(end - data))))
+		end = star;
+	
+	auto count = 0;
+	auto const* begin = data + 1;  // after '$'
+	for (auto const* c = begin; count < max_fields; ++c)
+	{
+		if (c == end || *c == ',')
+		{
+			fields[count++] = { begin, c };
+			if (c == end)
+				break;
+			begin = c + 1;
+		}
+	}
+	return count;
+}
+
+// static
+bool NmeaParser::toDouble(const Field& field, double& value) noexcept
+{
+	auto const* c = field.begin;
+	auto const negative = (c != field.end && *c == '-');
+	if (negative || (c != field.end && *c == '+'))
+		++c;
+	if (c == field.end)
+		return false;
+	
+	auto result = 0.0;
+	for (; c != field.end && *c >= '0' && *c <= '9'; ++c)
+		result = 10 * result + (*c - '0');
+	if (c != field.end && *c == '.')
+	{
+		auto scale = 0.1;
+		for (++c; c != field.end && *c >= '0' && *c <= '9'; ++c)
+		{
+			result += scale * (*c - '0');
+			scale /= 10;
+		}
+	}
+	if (c != field.end)
+		return false;
+	
+	value = negative ? -result : result;
+	return true;
+}
+
+// static
+bool NmeaParser::toCoordinate(const Field& value, const Field& hemisphere, double& degrees) noexcept
+{
+	double raw;
+	if (!toDouble(value, raw))
+		return false;
+	
+	// [d]ddmm.mmmm
+	auto const whole_degrees = std::floor(raw / 100);
+	degrees = whole_degrees + (raw - 100 * whole_degrees) / 60;
+	switch (hemisphere.front())
+	{
+	case 'S':
+	case 'W':
+		degrees = -degrees;
+		return true;
+	case 'N':
+	case 'E':
+		return true;
+	default:
+		return false;
+	}
+}
+
+// static
+QTime NmeaParser::toTime(const Field& field)
+{
+	// hhmmss[.sss]
+	double raw;
+	if (field.end - field.begin < 6 || !toDouble(field, raw) || raw < 0)
+		return {};
+	
+	auto const seconds = int(raw) % 100;
+	auto const minutes = int(raw) / 100 % 100;
+	auto const hours = int(raw) / 10000;
+	auto const msecs = int(std::round((raw - std::floor(raw)) * 1000));
+	return QTime(hours, minutes, seconds, std::min(msecs, 999));
+}
+
+// static
+QDate NmeaParser::toDate(const Field& field)
+{
+	// ddmmyy
+	double raw;
+	if (field.end - field.begin != 6 || !toDouble(field, raw) || raw < 0)
+		return {};
+	
+	auto const year = int(raw) % 100;
+	auto const month = int(raw) / 100 % 100;
+	auto const day = int(raw) / 10000;
+	return QDate((year < 80 ? 2000 : 1900) + year, month, day);
+}
+
+
+void NmeaParser::reset()
+{
+	*this = {};
+}
+
+bool NmeaParser::parse(const char* data, int size, QGeoPositionInfo& info, bool& has_fix)
+{
+	if (!hasValidChecksum(data, size))
+		return false;
+	
+	Field fields[max_fields];
+	auto const count = split(data, size, fields);
+	
+	// The address field is the talker ID followed by the sentence type.
+	// Proprietary sentences ("$P...") are not supported.
+	auto const& address = fields[0];
+	if (address.end - address.begin != 5 || address.front() == 'P')
+		return false;
+	
+	auto const* type = address.begin + 2;
+	if (isType(type, "GGA"))
+		return parseGga(fields, count, info, has_fix);
+	if (isType(type, "RMC"))
+		return parseRmc(fields, count, info, has_fix);
+	if (isType(type, "VTG"))
+		parseVtg(fields, count);
+	else if (isType(type, "GST"))
+		parseGst(fields, count);
+	return false;
+}
+
+bool NmeaParser::parseGga(const Field* fields, int count, QGeoPositionInfo& info, bool& has_fix)
+{
+	// GGA,time,lat,N/S,lon,E/W,quality,satellites,hdop,altitude,M,...
+	if (count < 10)
+		return false;
+	
+	has_gga = true;
+	double quality;
+	fix_quality = toDouble(fields[6], quality) ? FixQuality(int(quality)) : NoFix;
+	
+	double latitude, longitude;
+	if (!toCoordinate(fields[2], fields[3], latitude) || !toCoordinate(fields[4], fields[5], longitude))
+		return false;
+	
+	auto coordinate = QGeoCoordinate(latitude, longitude);
+	double altitude;
+	if (toDouble(fields[9], altitude))
+		coordinate.setAltitude(altitude);
+	
+	auto const time = toTime(fields[1]);
+	auto const current_date = date.isValid() ? date : QDateTime::currentDateTimeUtc().date();
+	info = QGeoPositionInfo(coordinate, QDateTime(current_date, time, Qt::UTC));
+	
+	double hdop;
+	if (!toDouble(fields[8], hdop))
+		hdop = -1;
+	setAttributes(info, time, hdop);
+	
+	has_fix = fix_quality != NoFix;
+	return true;
+}
+
+bool NmeaParser::parseRmc(const Field* fields, int count, QGeoPositionInfo& info, bool& has_fix)
+{
+	// RMC,time,status,lat,N/S,lon,E/W,speed,course,date,...
+	if (count < 10)
+		return false;
+	
+	auto const time = toTime(fields[1]);
+	auto const new_date = toDate(fields[9]);
+	if (new_date.isValid())
+		date = new_date;
+	
+	velocity_time = time;
+	double value;
+	ground_speed = toDouble(fields[7], value) ? value * knots_to_mps : -1;
+	direction = toDouble(fields[8], value) ? value : -1;
+	
+	// GGA carries more information for the same position.
+	if (has_gga)
+		return false;
+	
+	double latitude, longitude;
+	if (!toCoordinate(fields[3], fields[4], latitude) || !toCoordinate(fields[5], fields[6], longitude))
+		return false;
+	
+	auto const current_date = date.isValid() ? date : QDateTime::currentDateTimeUtc().date();
+	info = QGeoPositionInfo(QGeoCoordinate(latitude, longitude), QDateTime(current_date, time, Qt::UTC));
+	setAttributes(info, time, -1);
+	
+	has_fix = fields[2].front() == 'A';
+	return true;
+}
+
+void NmeaParser::parseVtg(const Field* fields, int count)
+{
+	// VTG,course,T,course,M,speed,N,speed,K,...
+	// VTG has no time. It belongs to the epoch of the latest position.
+	if (count < 8)
+		return;
+	
+	double value;
+	direction = toDouble(fields[1], value) ? value : -1;
+	if (toDouble(fields[7], value))
+		ground_speed = value / 3.6;
+	else if (toDouble(fields[5], value))
+		ground_speed = value * knots_to_mps;
+	else
+		ground_speed = -1;
+	velocity_time = {};
+}
+
+void NmeaParser::parseGst(const Field* fields, int count)
+{
+	// GST,time,rms,major,minor,orientation,lat error,lon error,alt error
+	if (count < 9)
+		return;
+	
+	gst_time = toTime(fields[1]);
+	double lat_error, lon_error, alt_error;
+	if (toDouble(fields[6], lat_error) && toDouble(fields[7], lon_error))
+		horizontal_error = std::sqrt(lat_error * lat_error + lon_error * lon_error);
+	else
+		horizontal_error = -1;
+	vertical_error = toDouble(fields[8], alt_error) ? alt_error : -1;
+}
+
+void NmeaParser::setAttributes(QGeoPositionInfo& info, const QTime& time, double hdop) const
+{
+	auto const is_recent = [&time](const QTime& attribute_time) {
+		return attribute_time.isValid() && time.isValid()
+		       && std::abs(attribute_time.msecsTo(time)) <= max_attribute_age;
+	};
+	
+	if (is_recent(gst_time) && horizontal_error >= 0)
+		info.setAttribute(QGeoPositionInfo::HorizontalAccuracy, horizontal_error);
+	else if (hdop >= 0 && fix_quality != RtkFixed && fix_quality != RtkFloat)
+		info.setAttribute(QGeoPositionInfo::HorizontalAccuracy, hdop * user_equivalent_range_error);
+	
+	if (is_recent(gst_time) && vertical_error >= 0)
+		info.setAttribute(QGeoPositionInfo::VerticalAccuracy, vertical_error);
+	
+	// VTG leaves velocity_time invalid, attaching it to the next position.
+	if (!velocity_time.isValid() || is_recent(velocity_time))
+	{
+		if (ground_speed >= 0)
+			info.setAttribute(QGeoPositionInfo::GroundSpeed, ground_speed);
+		if (direction >= 0)
+			info.setAttribute(QGeoPositionInfo::Direction, direction);
+	}
+}
+
+
+}  // namespace OpenOrienteering
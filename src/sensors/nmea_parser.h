@@ -0,0 +1,131 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef OPENORIENTEERING_NMEA_PARSER_H
+#define OPENORIENTEERING_NMEA_PARSER_H
+
+#include <QtGlobal>
+#include <QDate>
+#include <QTime>
+
+class QGeoPositionInfo;
+
+namespace OpenOrienteering
+{
+
+/**
+ * A streaming parser for NMEA 0183 sentences.
+ * 
+ * The parser is fed one sentence at a time. It validates the checksum and
+ * splits the fields in place, without allocating memory. It keeps the
+ * relevant data from the sentences of the current epoch, so that each
+ * position update carries the best available attributes:
+ * 
+ * - GGA provides position, altitude, fix quality and HDOP.
+ * - RMC provides position, date, ground speed and course.
+ * - VTG provides ground speed and course.
+ * - GST provides the error estimates of the position.
+ * 
+ * GGA sentences complete a position update. RMC sentences complete a
+ * position update only when the receiver does not send GGA sentences.
+ * 
+ * The horizontal accuracy is taken from the latitude and longitude errors
+ * in GST sentences, when available. This reflects the quality of RTK and
+ * other corrected fixes. Otherwise it is estimated from HDOP, except for
+ * RTK fixes where this estimate would be meaningless.
+ */
+class NmeaParser
+{
+public:
+	/// The fix quality indicator from GGA sentences.
+	enum FixQuality
+	{
+		NoFix      = 0,
+		GpsFix     = 1,
+		DgpsFix    = 2,
+		PpsFix     = 3,
+		RtkFixed   = 4,
+		RtkFloat   = 5,
+		Estimated  = 6,
+		Manual     = 7,
+		Simulation = 8,
+	};
+	
+	/**
+	 * Parses a single sentence.
+	 * 
+	 * Returns true if the sentence completes a position update. In this case,
+	 * info is set to the new position, and has_fix indicates whether the
+	 * receiver reports a valid fix.
+	 */
+	bool parse(const char* data, int size, QGeoPositionInfo& info, bool& has_fix);
+	
+	/// Returns the fix quality from the latest GGA sentence.
+	FixQuality fixQuality() const noexcept { return fix_quality; }
+	
+	/// Resets the parser's state.
+	void reset();
+	
+	/// Returns true if the sentence has a valid checksum.
+	static bool hasValidChecksum(const char* data, int size) noexcept;
+	
+private:
+	struct Field
+	{
+		const char* begin;
+		const char* end;
+		
+		bool isEmpty() const noexcept { return begin == end; }
+		char front() const noexcept { return isEmpty() ? '\0' : *begin; }
+	};
+	
+	static constexpr int max_fields = 24;
+	
+	/// Splits the sentence into fields. Returns the number of fields.
+	static int split(const char* data, int size, Field (&fields)[max_fields]) noexcept;
+	
+	static bool toDouble(const Field& field, double& value) noexcept;
+	static bool toCoordinate(const Field& value, const Field& hemisphere, double& degrees) noexcept;
+	static QTime toTime(const Field& field);
+	static QDate toDate(const Field& field);
+	
+	bool parseGga(const Field* fields, int count, QGeoPositionInfo& info, bool& has_fix);
+	bool parseRmc(const Field* fields, int count, QGeoPositionInfo& info, bool& has_fix);
+	void parseVtg(const Field* fields, int count);
+	void parseGst(const Field* fields, int count);
+	
+	void setAttributes(QGeoPositionInfo& info, const QTime& time, double hdop) const;
+	
+	QDate date;
+	QTime velocity_time;
+	double ground_speed = -1;  ///< m/s, negative if unknown
+	double direction = -1;     ///< degrees, negative if unknown
+	QTime gst_time;
+	double horizontal_error = -1;  ///< m, negative if unknown
+	double vertical_error = -1;    ///< m, negative if unknown
+	FixQuality fix_quality = NoFix;
+	bool has_gga = false;
+	
+};
+
+
+}  // namespace OpenOrienteering
+
+#endif  // OPENORIENTEERING_NMEA_PARSER_H
@@ -22,6 +22,7 @@
 #include <QtGlobal>
 #include <QByteArray>
 #include <QFileInfo>
+#include <QGeoPositionInfo>
 #include <QGeoPositionInfoSource>
 #include <QLatin1Char>
 #include <QList>
@@ -32,6 +33,8 @@
 #  include <QSerialPortInfo>
 #endif
 
+#include "nmea_parser.h"
+
 
 namespace OpenOrienteering
 {
@@ -93,6 +96,7 @@ public:
 			return;
 		}
 		process.setArguments({device});
+		parser.reset();
 		if (process.state() == QProcess::NotRunning)
 			process.start();
 		QNmeaPositionInfoSource::startUpdates();
@@ -145,6 +149,21 @@ public:
 	using QGeoPositionInfoSource::error;  // the signal
 
 protected:
+	/**
+	 * Parses a single NMEA sentence.
+	 * 
+	 * This replaces the stateless parsing in Qt with NmeaParser, which
+	 * combines the sentences of an epoch and works without temporary strings.
+	 */
+	bool parsePosInfoFromNmeaData(const char* data, int size, QGeoPositionInfo* pos_info, bool* has_fix) override
+	{
+		auto fix = false;
+		auto const result = parser.parse(data, size, *pos_info, fix);
+		if (has_fix)
+			*has_fix = fix;
+		return result;
+	}
+	
 	/**
 	 * Sets the error and emits the error signal (unless NoError).
 	 */
@@ -166,6 +185,7 @@ protected:
 	
 private:
 	QProcess process;
+	NmeaParser parser;
 	Error position_error = NoError;
 };
 
@@ -20,6 +20,7 @@
 
 #include "sensors_settings_page.h"
 
+#include <QCheckBox>
 #include <QComboBox>
 #include <QFormLayout>
 #include <QLabel>
@@ -65,6 +66,9 @@ SensorsSettingsPage::SensorsSettingsPage(QWidget* parent)
 	}
 #endif
 	
+	position_prediction_check = new QCheckBox(tr("Move the marker between position updates"));
+	form_layout->addRow(position_prediction_check);
+	
 	form_layout->addItem(Util::SpacerItem::create(this));
 #endif
 	
@@ -90,6 +94,8 @@ void SensorsSettingsPage::apply()
 		auto const port = nmea_serialport_box->currentText().trimmed();
 		settings.setNmeaSerialPort(port == tr("Default") ? QString{} : port);
 	}
+	if (position_prediction_check)
+		settings.setPositionPrediction(position_prediction_check->isChecked());
 	
 	Settings::getInstance().applySettings();
 }
@@ -105,6 +111,7 @@ void SensorsSettingsPage::updateWidgets()
 {
 #ifdef QT_POSITIONING_LIB
 	position_source_box->clear();
+	position_prediction_check->setChecked(Settings::getInstance().positionPrediction());
 	
 	auto const current_source_name = Settings::getInstance().positionSource();
 	auto add_position_source = [this, &current_source_name](const QString& id) {
@@ -121,6 +128,9 @@ void SensorsSettingsPage::updateWidgets()
 		else if (display_name == QLatin1String("Windows"))
 			//: Position source; product name, do not translate literally.
 			display_name = tr("Windows");
+		else if (display_name == QLatin1String("Windows Geolocation"))
+			//: Position source; product name, do not translate literally.
+			display_name = tr("Windows Geolocation");
 		else if (display_name == QLatin1String("geoclue"))
 			//: Position source; product name, do not translate literally.
 			display_name = tr("GeoClue");
@@ -25,6 +25,7 @@
 
 #include "gui/widgets/settings_page.h"
 
+class QCheckBox;
 class QComboBox;
 class QWidget;
 
@@ -51,6 +52,7 @@ protected:
 private:
 	QComboBox* position_source_box = nullptr;
 	QComboBox* nmea_serialport_box = nullptr;
+	QCheckBox* position_prediction_check = nullptr;
 	
 };
 
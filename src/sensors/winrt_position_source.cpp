@@ -0,0 +1,338 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "winrt_position_source.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+
+#include <winrt/Windows.Foundation.h>
+#include <winrt/Windows.Devices.Geolocation.h>
+
+#include <Qt>
+#include <QtGlobal>
+#include <QtNumeric>
+#include <QDateTime>
+#include <QGeoCoordinate>
+#include <QMetaType>
+#include <QString>
+
+
+namespace OpenOrienteering
+{
+
+namespace {
+
+namespace Geo = winrt::Windows::Devices::Geolocation;
+using winrt::Windows::Foundation::AsyncStatus;
+using winrt::Windows::Foundation::IAsyncOperation;
+
+
+/**
+ * Calls the function, reporting C++/WinRT errors instead of throwing.
+ * 
+ * Returns false on error.
+ */
+template <class Function>
+bool tryWinrt(Function&& function)
+{
+	try
+	{
+		function();
+		return true;
+	}
+	catch (const winrt::hresult_error& e)
+	{
+		qDebug("WinrtPositionSource: %s", qPrintable(QString::fromWCharArray(e.message().c_str())));
+		return false;
+	}
+}
+
+
+QGeoPositionInfo toPositionInfo(const Geo::Geoposition& geoposition)
+{
+	auto const coordinate = geoposition.Coordinate();
+	auto const point = coordinate.Point().Position();
+	auto const altitude_accuracy = coordinate.AltitudeAccuracy();
+	
+	auto geo_coord = QGeoCoordinate{point.Latitude, point.Longitude};
+	if (altitude_accuracy)
+		geo_coord.setAltitude(point.Altitude);
+	
+	auto const time_since_epoch = winrt::clock::to_sys(coordinate.Timestamp()).time_since_epoch();
+	auto const msecs = std::chrono::duration_cast<std::chrono::milliseconds>(time_since_epoch).count();
+	auto position = QGeoPositionInfo{geo_coord, QDateTime::fromMSecsSinceEpoch(msecs, Qt::UTC)};
+	position.setAttribute(QGeoPositionInfo::HorizontalAccuracy, coordinate.Accuracy());
+	if (altitude_accuracy)
+		position.setAttribute(QGeoPositionInfo::VerticalAccuracy, altitude_accuracy.Value());
+	
+	// The heading is NaN when the device doesn't move.
+	auto const heading = coordinate.Heading();
+	if (heading && !qIsNaN(heading.Value()))
+		position.setAttribute(QGeoPositionInfo::Direction, heading.Value());
+	auto const speed = coordinate.Speed();
+	if (speed && !qIsNaN(speed.Value()))
+		position.setAttribute(QGeoPositionInfo::GroundSpeed, speed.Value());
+	
+	return position;
+}
+
+
+QGeoPositionInfoSource::Error toError(Geo::PositionStatus status)
+{
+	// Cf. https://docs.microsoft.com/en-us/uwp/api/windows.devices.geolocation.positionstatus
+	switch (status)
+	{
+	case Geo::PositionStatus::Ready:
+	case Geo::PositionStatus::Initializing:
+	case Geo::PositionStatus::NotInitialized:
+		return QGeoPositionInfoSource::NoError;
+	case Geo::PositionStatus::Disabled:
+		return QGeoPositionInfoSource::AccessError;
+	case Geo::PositionStatus::NoData:
+	case Geo::PositionStatus::NotAvailable:
+		break;
+	}
+	return QGeoPositionInfoSource::UnknownSourceError;
+}
+
+
+}  // namespace
+
+
+/**
+ * The C++/WinRT objects of a WinrtPositionSource.
+ * 
+ * The revokers unregister the event handlers on destruction.
+ */
+struct WinrtPositionSource::Geolocator
+{
+	Geo::Geolocator geolocator;
+	Geo::Geolocator::PositionChanged_revoker position_changed;
+	Geo::Geolocator::StatusChanged_revoker status_changed;
+	IAsyncOperation<Geo::Geoposition> pending_request = nullptr;
+};
+
+
+WinrtPositionSource::WinrtPositionSource(QObject* parent)
+: QGeoPositionInfoSource(parent)
+{
+	static const int register_position = qRegisterMetaType<QGeoPositionInfo>();
+	static const int register_error = qRegisterMetaType<QGeoPositionInfoSource::Error>("QGeoPositionInfoSource::Error");
+	Q_UNUSED(register_position)
+	Q_UNUSED(register_error)
+	
+	connect(this, &WinrtPositionSource::nativePositionReceived, this, &WinrtPositionSource::nativePositionUpdate, Qt::QueuedConnection);
+	connect(this, &WinrtPositionSource::nativeErrorReceived, this, &WinrtPositionSource::setError, Qt::QueuedConnection);
+	
+	single_update_timer.setSingleShot(true);
+	connect(&single_update_timer, &QTimer::timeout, this, &WinrtPositionSource::singleUpdateTimeout);
+	
+	auto const ok = tryWinrt([this]() {
+		geolocator = std::make_unique<Geolocator>();
+		geolocator->geolocator.DesiredAccuracy(Geo::PositionAccuracy::High);
+		setError(toError(geolocator->geolocator.LocationStatus()));
+	});
+	if (!ok)
+	{
+		geolocator.reset();
+		setError(UnknownSourceError);
+	}
+}
+
+WinrtPositionSource::~WinrtPositionSource()
+{
+	// Unregister the event handlers before anything else is destroyed.
+	if (geolocator && geolocator->pending_request)
+		tryWinrt([this]() { geolocator->pending_request.Cancel(); });
+	geolocator.reset();
+}
+
+
+QGeoPositionInfoSource::Error WinrtPositionSource::error() const
+{
+	return position_error;
+}
+
+void WinrtPositionSource::setError(QGeoPositionInfoSource::Error value)
+{
+	if (this->position_error == value)
+		return;
+	
+	this->position_error = value;
+	if (value != NoError)
+		emit this->QGeoPositionInfoSource::error(value);
+}
+
+
+void WinrtPositionSource::setUpdateInterval(int msec)
+{
+	if (msec > 0)
+		msec = std::max(msec, minimumUpdateInterval());
+	QGeoPositionInfoSource::setUpdateInterval(msec);
+	
+	// Zero lets the system choose the interval.
+	if (geolocator)
+		tryWinrt([this]() { geolocator->geolocator.ReportInterval(std::uint32_t(updateInterval())); });
+}
+
+QGeoPositionInfo WinrtPositionSource::lastKnownPosition(bool /* satellite_only */) const
+{
+	return last_position;
+}
+
+QGeoPositionInfoSource::PositioningMethods WinrtPositionSource::supportedPositioningMethods() const
+{
+	switch (position_error)
+	{
+	case NoError:
+		return AllPositioningMethods;
+	default:
+		return NoPositioningMethods;
+	}
+}
+
+int WinrtPositionSource::minimumUpdateInterval() const
+{
+	return 1000;
+}
+
+// slot
+void WinrtPositionSource::startUpdates()
+{
+	if (!geolocator)
+	{
+		setError(UnknownSourceError);
+		return;
+	}
+	if (updates_ongoing)
+		return;
+	
+	// The handlers are called on system threads.
+	auto const ok = tryWinrt([this]() {
+		auto& g = geolocator->geolocator;
+		g.ReportInterval(std::uint32_t(updateInterval()));
+		geolocator->status_changed = g.StatusChanged(winrt::auto_revoke, [this](const Geo::Geolocator& /* sender */, const Geo::StatusChangedEventArgs& args) {
+			tryWinrt([this, &args]() { emit nativeErrorReceived(toError(args.Status())); });
+		});
+		geolocator->position_changed = g.PositionChanged(winrt::auto_revoke, [this](const Geo::Geolocator& /* sender */, const Geo::PositionChangedEventArgs& args) {
+			tryWinrt([this, &args]() { emit nativePositionReceived(toPositionInfo(args.Position())); });
+		});
+	});
+	if (!ok)
+	{
+		geolocator->status_changed.revoke();
+		geolocator->position_changed.revoke();
+		setError(UnknownSourceError);
+		return;
+	}
+	
+	updates_ongoing = true;
+}
+
+// slot
+void WinrtPositionSource::stopUpdates()
+{
+	if (!updates_ongoing)
+		return;
+	
+	updates_ongoing = false;
+	geolocator->status_changed.revoke();
+	geolocator->position_changed.revoke();
+}
+
+// slot
+void WinrtPositionSource::requestUpdate(int timeout)
+{
+	if (!geolocator)
+	{
+		setError(UnknownSourceError);
+		return;
+	}
+	
+	setError(QGeoPositionInfoSource::NoError);
+	if (timeout == 0)
+	{
+		timeout = 120000; // 2 min for cold start
+	}
+	else if (timeout < minimumUpdateInterval())
+	{
+		emit updateTimeout();
+		return;
+	}
+	
+	single_update_timer.start(timeout);
+	
+	// With ongoing updates, the next position serves the request.
+	if (updates_ongoing || geolocator->pending_request)
+		return;
+	
+	auto const ok = tryWinrt([this]() {
+		auto request = geolocator->geolocator.GetGeopositionAsync();
+		request.Completed([this](const IAsyncOperation<Geo::Geoposition>& operation, AsyncStatus status) {
+			if (status == AsyncStatus::Canceled)
+				return;
+			try
+			{
+				emit nativePositionReceived(toPositionInfo(operation.GetResults()));
+			}
+			catch (const winrt::hresult_access_denied& /* e */)
+			{
+				emit nativeErrorReceived(AccessError);
+			}
+			catch (const winrt::hresult_error& /* e */)
+			{
+				emit nativeErrorReceived(UnknownSourceError);
+			}
+		});
+		geolocator->pending_request = request;
+	});
+	if (!ok)
+	{
+		single_update_timer.stop();
+		setError(UnknownSourceError);
+	}
+}
+
+
+void WinrtPositionSource::nativePositionUpdate(const QGeoPositionInfo& position)
+{
+	// Positions may still be queued after stopping.
+	if (!updates_ongoing && !single_update_timer.isActive())
+		return;
+	
+	single_update_timer.stop();
+	geolocator->pending_request = nullptr;
+	last_position = position;
+	setError(NoError);
+	emit positionUpdated(last_position);
+}
+
+void WinrtPositionSource::singleUpdateTimeout()
+{
+	if (geolocator->pending_request)
+	{
+		tryWinrt([this]() { geolocator->pending_request.Cancel(); });
+		geolocator->pending_request = nullptr;
+	}
+	emit updateTimeout();
+}
+
+}  // namespace OpenOrienteering
@@ -0,0 +1,115 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef OPENORIENTEERING_WINRT_POSITION_SOURCE_H
+#define OPENORIENTEERING_WINRT_POSITION_SOURCE_H
+
+#include <memory>
+
+#include <QGeoPositionInfo>
+#include <QGeoPositionInfoSource>
+#include <QObject>
+#include <QTimer>
+
+namespace OpenOrienteering
+{
+
+/**
+ * A Windows position source based on Windows.Devices.Geolocation.
+ * 
+ * In contrast to PowershellPositionSource, this source talks to the
+ * Geolocator directly, via C++/WinRT. Positions are pushed by the system
+ * as soon as they are available. The system's callbacks arrive on worker
+ * threads and are forwarded to this object's thread by queued signals.
+ * 
+ * The C++/WinRT types are kept in the implementation, so that this header
+ * doesn't require C++17.
+ */
+class WinrtPositionSource : public QGeoPositionInfoSource
+{
+	Q_OBJECT
+	
+public:
+	WinrtPositionSource(QObject* parent = nullptr);
+	
+	WinrtPositionSource(const WinrtPositionSource&) = delete;
+	WinrtPositionSource(WinrtPositionSource&&) = delete;
+	WinrtPositionSource& operator=(const WinrtPositionSource&) = delete;
+	WinrtPositionSource& operator=(WinrtPositionSource&&) = delete;
+	
+	~WinrtPositionSource() override;
+	
+	
+	QGeoPositionInfoSource::Error error() const override;
+	
+	using QGeoPositionInfoSource::error;  // the signal
+
+private:
+	/**
+	 * Sets the error and emits the error signal (unless NoError).
+	 */
+	void setError(QGeoPositionInfoSource::Error value);
+
+
+public:
+	void setUpdateInterval(int msec) override;
+	
+	QGeoPositionInfo lastKnownPosition(bool satellite_only) const override;
+	
+	PositioningMethods supportedPositioningMethods() const override;
+	
+	int minimumUpdateInterval() const override;
+	
+
+public slots:
+	void startUpdates() override;
+	
+	void stopUpdates() override;
+	
+	void requestUpdate(int timeout) override;
+	
+signals:
+	/**
+	 * Forwards a position from a system thread.
+	 */
+	void nativePositionReceived(const QGeoPositionInfo& position);
+	
+	/**
+	 * Forwards a status change or error from a system thread.
+	 */
+	void nativeErrorReceived(QGeoPositionInfoSource::Error error);
+	
+private:
+	void nativePositionUpdate(const QGeoPositionInfo& position);
+	
+	void singleUpdateTimeout();
+	
+	struct Geolocator;
+	std::unique_ptr<Geolocator> geolocator;
+	QGeoPositionInfo last_position;
+	QTimer single_update_timer;
+	Error position_error = NoError;
+	bool updates_ongoing = false;
+	bool update_requested = false;
+};
+
+
+}  // namespace OpenOrienteering
+
+#endif  // OPENORIENTEERING_WINRT_POSITION_SOURCE_H
@@ -124,6 +124,7 @@ Settings::Settings()
 		ppi = QGuiApplication::primaryScreen()->logicalDotsPerInch();
 	
 	registerSetting(MapDisplay_TextAntialiasing, "MapDisplay/text_antialiasing", false);
+	registerSetting(MapDisplay_GeometricPatternClipping, "MapDisplay/geometric_pattern_clipping", false);
 	registerSetting(MapEditor_ClickToleranceMM, "MapEditor/click_tolerance_mm", map_editor_click_tolerance_default);
 	registerSetting(MapEditor_SnapDistanceMM, "MapEditor/snap_distance_mm", map_editor_snap_distance_default);
 	registerSetting(MapEditor_FixedAngleStepping, "MapEditor/fixed_angle_stepping", 15);
@@ -146,6 +147,8 @@ Settings::Settings()
 	
 	registerSetting(General_RetainCompatiblity, "retainCompatiblity", false);
 	registerSetting(General_SaveUndoRedo, "saveUndoRedo", true);
+	registerSetting(General_CompressMapFiles, "compressMapFiles", false);
+	registerSetting(General_CompactCoordinates, "compactCoordinates", false);
 	registerSetting(General_AutosaveInterval, "autosave", 15); // unit: minutes
 	registerSetting(General_Language, "language", QLocale::system().name().left(2));
 	registerSetting(General_PixelsPerInch, "pixelsPerInch", ppi);
@@ -154,6 +157,7 @@ Settings::Settings()
 	registerSetting(General_OpenMRUFile, "openMRUFile", false);
 	registerSetting(General_Local8BitEncoding, "local_8bit_encoding", QLatin1String("Default"));
 	registerSetting(General_StartDragDistance, "startDragDistance", start_drag_distance_default);
+	registerSetting(General_UndoMemoryLimit, "undoMemoryLimit", 256); // unit: MiB
 	
 	registerSetting(HomeScreen_TipsVisible, "HomeScreen/tipsVisible", true);
 	registerSetting(HomeScreen_CurrentTip, "HomeScreen/currentTip", -1);
@@ -170,6 +174,7 @@ Settings::Settings()
 	
 	sensors.position_source = settings.value(QLatin1String("Sensors/position_source"), sensors.position_source).toString();
 	sensors.nmea_serialport = settings.value(QLatin1String("Sensors/nmea_serialport"), sensors.nmea_serialport).toString();
+	sensors.position_prediction = settings.value(QLatin1String("Sensors/position_prediction"), sensors.position_prediction).toBool();
 	
 	// Migrate old settings
 	static bool migration_checked = false;
@@ -393,5 +398,15 @@ void Settings::setNmeaSerialPort(const QString& name)
 	}
 }
 
+void Settings::setPositionPrediction(bool enabled)
+{
+	if (enabled != sensors.position_prediction)
+	{
+		sensors.position_prediction = enabled;
+		QSettings().setValue(QLatin1String("Sensors/position_prediction"), enabled);
+		emit settingsChanged();
+	}
+}
+
 
 }  // namespace OpenOrienteering
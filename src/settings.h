@@ -45,6 +45,7 @@ public:
 	{
 		MapDisplay_Antialiasing = 0,
 		MapDisplay_TextAntialiasing,
+		MapDisplay_GeometricPatternClipping,
 		MapEditor_ClickToleranceMM,
 		MapEditor_SnapDistanceMM,
 		MapEditor_FixedAngleStepping,
@@ -62,6 +63,8 @@ public:
 		ActionGridBar_ButtonSizeMM,
 		General_RetainCompatiblity,
 		General_SaveUndoRedo,
+		General_CompressMapFiles,
+		General_CompactCoordinates,
 		General_AutosaveInterval,
 		General_Language,
 		General_PixelsPerInch,
@@ -70,6 +73,7 @@ public:
 		General_OpenMRUFile,
 		General_Local8BitEncoding,
 		General_StartDragDistance,
+		General_UndoMemoryLimit,
 		HomeScreen_TipsVisible,
 		HomeScreen_CurrentTip,
 		END_OF_SETTINGSENUM /* Don't add items below this line. */
@@ -208,6 +212,18 @@ public:
 	void setNmeaSerialPort(const QString& name);
 	
 	
+	/**
+	 * Returns true if the position marker shall be moved between two
+	 * position updates, based on the recent movement.
+	 */
+	bool positionPrediction() const { return sensors.position_prediction; }
+	
+	/**
+	 * Enables or disables the prediction of the position between updates.
+	 */
+	void setPositionPrediction(bool enabled);
+	
+	
 signals:
 	void settingsChanged();
 	
@@ -229,6 +245,7 @@ private:
 	struct {
 		QString position_source = {};
 		QString nmea_serialport = {};
+		bool position_prediction = false;
 	} sensors;
 	
 #ifndef Q_OS_ANDROID
@@ -27,6 +27,7 @@
 #include <iterator>
 #include <new>
 #include <type_traits>
+#include <utility>
 
 #include <Qt>
 #include <QtMath>
@@ -39,9 +40,11 @@
 #include <QLatin1Char>
 #include <QLatin1String>
 #include <QMessageBox>
+#include <QMetaObject>
 #include <QPainter>
 #include <QRectF>
 #include <QStringRef>
+#include <QThread>
 #include <QTransform>
 #include <QXmlStreamAttributes>
 #include <QXmlStreamReader>
@@ -58,7 +61,9 @@
 #include "templates/template_image.h"
 #include "templates/template_map.h"
 #include "templates/template_placeholder.h"
+#include "templates/template_sketch.h"
 #include "templates/template_track.h"
+#include "templates/template_web_tiles.h"
 #include "util/backports.h"  // IWYU pragma: keep
 #include "util/util.h"
 #include "util/xml_stream_util.h"
@@ -66,6 +71,37 @@
 
 namespace OpenOrienteering {
 
+class Template::BackgroundLoader : public QThread
+{
+	// no Q_OBJECT, completion is signaled via a queued invocation.
+public:
+	BackgroundLoader(Template& temp, std::function<void ()> function)
+	: temp(temp)
+	, function(std::move(function))
+	{}
+	
+protected:
+	void run() override
+	{
+		try
+		{
+			function();
+		}
+		catch (...)
+		{
+			// Without data, loadTemplateFile() will read the file again,
+			// and report the error.
+		}
+		QMetaObject::invokeMethod(&temp, "finishBackgroundLoading", Qt::QueuedConnection);
+	}
+	
+private:
+	Template& temp;
+	std::function<void ()> function;
+};
+
+
+
 class Template::ScopedOffsetReversal
 {
 public:
@@ -261,6 +297,8 @@ Template::Template(const Template& proto)
 Template::~Template()
 {
 	Q_ASSERT(template_state != Loaded);
+	if (background_loader)
+		background_loader->wait();
 }
 
 QString Template::errorString() const
@@ -612,6 +650,13 @@ bool Template::loadTemplateFile(bool configuring)
 {
 	Q_ASSERT(template_state != Loaded);
 	
+	if (background_loader)
+	{
+		// Pick up the data from the worker thread.
+		background_loader->wait();
+		background_loader.reset();
+	}
+	
 	const State old_state = template_state;
 	
 	setErrorString(QString());
@@ -655,6 +700,38 @@ bool Template::loadTemplateFile(bool configuring)
 	return template_state == Loaded;
 }
 
+bool Template::loadTemplateFileInBackground()
+{
+	Q_ASSERT(template_state != Loaded);
+	
+	if (background_loader)
+		return true;
+	
+	auto loader = QFileInfo::exists(template_path) ? makeBackgroundLoader() : std::function<void ()>();
+	if (!loader)
+		return loadTemplateFile(false);
+	
+	background_loader = std::make_unique<BackgroundLoader>(*this, std::move(loader));
+	background_loader->start(QThread::LowPriority);
+	return true;
+}
+
+void Template::finishBackgroundLoading()
+{
+	if (!background_loader)
+		return;  // Already completed by loadTemplateFile().
+	
+	if (template_state != Loaded)
+		loadTemplateFile(false);
+	setTemplateAreaDirty();
+	map->emitTemplateChanged(this);
+}
+
+std::function<void ()> Template::makeBackgroundLoader()
+{
+	return {};
+}
+
 bool Template::postLoadConfiguration(QWidget* /*dialog_parent*/, bool& /*out_center_in_view*/)
 {
 	return true;
@@ -880,6 +957,11 @@ bool Template::hasAlpha() const
 	return template_state == Template::Loaded;
 }
 
+std::size_t Template::memoryUsage() const
+{
+	return 0;
+}
+
 
 
 const std::vector<QByteArray>& Template::supportedExtensions()
@@ -897,16 +979,22 @@ const std::vector<QByteArray>& Template::supportedExtensions()
 		auto const& ogr_extensions = gdal_extensions;
 #endif
 		auto& track_extensions = TemplateTrack::supportedExtensions();
+		auto& sketch_extensions = TemplateSketch::supportedExtensions();
+		auto& tiles_extensions = TemplateWebTiles::supportedExtensions();
 		extensions.reserve(image_extensions.size()
 		                   + map_extensions.size()
 		                   + gdal_extensions.size()
 		                   + ogr_extensions.size()
-		                   + track_extensions.size());
+		                   + track_extensions.size()
+		                   + sketch_extensions.size()
+		                   + tiles_extensions.size());
 		extensions.insert(end(extensions), begin(image_extensions), end(image_extensions));
 		extensions.insert(end(extensions), begin(map_extensions), end(map_extensions));
 		extensions.insert(end(extensions), begin(gdal_extensions), end(gdal_extensions));
 		extensions.insert(end(extensions), begin(ogr_extensions), end(ogr_extensions));
 		extensions.insert(end(extensions), begin(track_extensions), end(track_extensions));
+		extensions.insert(end(extensions), begin(sketch_extensions), end(sketch_extensions));
+		extensions.insert(end(extensions), begin(tiles_extensions), end(tiles_extensions));
 	}
 	return extensions;
 }
@@ -942,6 +1030,10 @@ std::unique_ptr<Template> Template::templateForPath(const QString& path, Map* ma
 	else if (endsWithAnyOf(path, TemplateTrack::supportedExtensions())
 	         && !HANDLED_BY_GDAL(endsWithAnyOf(path, OgrTemplate::supportedExtensions())))
 		t = std::make_unique<TemplateTrack>(path, map);
+	else if (endsWithAnyOf(path, TemplateSketch::supportedExtensions()))
+		t = std::make_unique<TemplateSketch>(path, map);
+	else if (endsWithAnyOf(path, TemplateWebTiles::supportedExtensions()))
+		t = std::make_unique<TemplateWebTiles>(path, map);
 #ifdef MAPPER_USE_GDAL
 	else if (GdalTemplate::canRead(path))
 		t = std::make_unique<GdalTemplate>(path, map);
@@ -982,6 +1074,10 @@ std::unique_ptr<Template> Template::templateForType(const QStringRef& type, cons
 #endif
 	else if (type_cstring == "TemplateTrack" && !track_with_gdal)
 		t = std::make_unique<TemplateTrack>(path, map);
+	else if (type_cstring == "TemplateSketch")
+		t = std::make_unique<TemplateSketch>(path, map);
+	else if (type_cstring == "TemplateWebTiles")
+		t = std::make_unique<TemplateWebTiles>(path, map);
 #ifdef MAPPER_USE_GDAL
 	else if (type_cstring == "GdalTemplate")
 		t = std::make_unique<GdalTemplate>(path, map);
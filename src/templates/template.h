@@ -22,6 +22,7 @@
 #ifndef OPENORIENTEERING_TEMPLATE_H
 #define OPENORIENTEERING_TEMPLATE_H
 
+#include <cstddef>
 #include <functional>
 #include <memory>
 #include <vector>
@@ -310,6 +311,27 @@ public:
 	 */
 	bool loadTemplateFile(bool configuring);
 	
+	/**
+	 * Starts loading the template file in the background.
+	 * 
+	 * This function can be called if the template state is Invalid or Unloaded.
+	 * If the template type supports it, the template data is read on a worker
+	 * thread. When the data is available, the template is loaded on the main
+	 * thread as by loadTemplateFile(false), the template area is marked dirty,
+	 * and the map's templateChanged() signal is emitted. Until then, the state
+	 * is left unchanged, and isLoadingInBackground() returns true. Calling
+	 * loadTemplateFile() in the meantime waits for the data.
+	 * 
+	 * Other template types are loaded immediately. In this case, the function
+	 * returns false if loading failed. Otherwise it returns true.
+	 */
+	bool loadTemplateFileInBackground();
+	
+	/**
+	 * Returns true while the template data is read on a worker thread.
+	 */
+	bool isLoadingInBackground() const { return bool(background_loader); }
+	
 	/**
 	 * Does configuration after the actual template is loaded.
 	 * 
@@ -566,6 +588,13 @@ public:
 	 */
 	virtual bool hasAlpha() const;
 	
+	/**
+	 * Returns an estimate of the memory used by the template data, in bytes.
+	 * 
+	 * The default implementation returns 0.
+	 */
+	virtual std::size_t memoryUsage() const;
+	
 	
 	// Static
 	/**
@@ -611,6 +640,13 @@ signals:
 	void templateStateChanged();
 	
 	
+private slots:
+	/**
+	 * Completes loading the template after the background loader finished.
+	 */
+	void finishBackgroundLoading();
+	
+	
 protected:
 	/**
 	 * Sets the error description which will be returned by errorString().
@@ -646,6 +682,19 @@ protected:
 	 */
 	virtual bool loadTemplateFileImpl(bool configuring) = 0;
 	
+	/**
+	 * Hook for reading the template data on a worker thread.
+	 * 
+	 * Returns a function which reads the template data to a location where a
+	 * subsequent call to loadTemplateFileImpl() will pick it up. The function
+	 * must not access this object. Its result must be ignored if it doesn't
+	 * match the template_path at the time of loadTemplateFileImpl().
+	 * 
+	 * The default implementation returns an empty function, i.e. the template
+	 * type doesn't support loading in the background.
+	 */
+	virtual std::function<void ()> makeBackgroundLoader();
+	
 	/**
 	 * Hook for unloading the template file.
 	 */
@@ -708,6 +757,14 @@ private:
 	 */
 	class ScopedOffsetReversal;
 	
+	/**
+	 * The worker thread which runs the function from makeBackgroundLoader().
+	 */
+	class BackgroundLoader;
+	
+	/// The active background loader, if any
+	std::unique_ptr<BackgroundLoader> background_loader;
+	
 protected:
 	/// Currently active transformation. NOTE: after direct changes here call updateTransformationMatrices()
 	TemplateTransform transform;
@@ -0,0 +1,106 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#include "template_data_cache.h"
+
+#include <QtGlobal>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QHash>
+#include <QLatin1Char>
+#include <QMutex>
+#include <QMutexLocker>
+
+
+namespace OpenOrienteering {
+
+namespace {
+
+struct CacheEntry
+{
+	QDateTime last_modified;
+	qint64 size;
+	std::weak_ptr<void> data;
+};
+
+QMutex cache_mutex;
+QHash<QString, CacheEntry> cache;
+
+/**
+ * Returns the cache key for the given kind and path, or an empty string
+ * if the file doesn't exist.
+ */
+QString cacheKey(const char* kind, const QFileInfo& info)
+{
+	auto const path = info.canonicalFilePath();
+	if (path.isEmpty())
+		return path;
+	return QLatin1String(kind) + QLatin1Char('\n') + path;
+}
+
+}  // namespace
+
+
+
+// static
+std::shared_ptr<void> TemplateDataCache::findData(const char* kind, const QString& path)
+{
+	QFileInfo info(path);
+	auto const key = cacheKey(kind, info);
+	if (key.isEmpty())
+		return {};
+	
+	QMutexLocker locker(&cache_mutex);
+	auto entry = cache.find(key);
+	if (entry == cache.end())
+		return {};
+	
+	auto data = entry->data.lock();
+	if (!data || entry->last_modified != info.lastModified() || entry->size != info.size())
+	{
+		cache.erase(entry);
+		return {};
+	}
+	return data;
+}
+
+// static
+void TemplateDataCache::insertData(const char* kind, const QString& path, const std::shared_ptr<void>& data)
+{
+	QFileInfo info(path);
+	auto const key = cacheKey(kind, info);
+	if (key.isEmpty() || !data)
+		return;
+	
+	QMutexLocker locker(&cache_mutex);
+	// Drop the entries for data which was released.
+	for (auto entry = cache.begin(); entry != cache.end(); )
+	{
+		if (entry->data.expired())
+			entry = cache.erase(entry);
+		else
+			++entry;
+	}
+	cache.insert(key, { info.lastModified(), info.size(), data });
+}
+
+
+}  // namespace OpenOrienteering
@@ -0,0 +1,78 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#ifndef OPENORIENTEERING_TEMPLATE_DATA_CACHE_H
+#define OPENORIENTEERING_TEMPLATE_DATA_CACHE_H
+
+#include <memory>
+
+#include <QString>
+
+
+namespace OpenOrienteering {
+
+/**
+ * A process-wide cache of template data which is shared between templates.
+ * 
+ * Templates in different maps often refer to the same files, e.g. a large
+ * orthophoto or a base map. This cache allows them to share the loaded data
+ * instead of loading separate copies. The data must be treated as read-only.
+ * 
+ * Entries are identified by a kind, chosen by the template type, and by the
+ * canonical path of the file. They are valid only as long as the file's
+ * modification time and size are unchanged. The cache holds weak references
+ * only, so the data is released when the last template drops it.
+ * 
+ * The functions may be called from any thread.
+ */
+class TemplateDataCache
+{
+public:
+	/**
+	 * Returns the data for the given kind and path, or nullptr.
+	 */
+	template <class T>
+	static std::shared_ptr<T> find(const char* kind, const QString& path)
+	{
+		return std::static_pointer_cast<T>(findData(kind, path));
+	}
+	
+	/**
+	 * Stores the data for the given kind and path.
+	 * 
+	 * The file's current modification time and size are recorded.
+	 */
+	template <class T>
+	static void insert(const char* kind, const QString& path, const std::shared_ptr<T>& data)
+	{
+		insertData(kind, path, data);
+	}
+	
+private:
+	static std::shared_ptr<void> findData(const char* kind, const QString& path);
+	
+	static void insertData(const char* kind, const QString& path, const std::shared_ptr<void>& data);
+};
+
+
+}  // namespace OpenOrienteering
+
+#endif
@@ -21,8 +21,11 @@
 
 #include "template_image.h"
 
+#include <algorithm>
+#include <cmath>
 #include <iosfwd>
 #include <iterator>
+#include <memory>
 #include <utility>
 
 #include <Qt>
@@ -55,6 +58,7 @@
 #ifdef QT_PRINTSUPPORT_LIB
 #include "printsupport/advanced_pdf_printer.h"
 #endif
+#include "templates/template_data_cache.h"
 #include "templates/template_image_open_dialog.h"
 #include "templates/world_file.h"
 #include "util/transformation.h"
@@ -72,6 +76,46 @@ TemplateImage::GeoreferencingOption readGdalGeoTransform(const QString& filepath
 #endif
 
 
+namespace {
+
+/** Pyramid levels are added until the image is not larger than this size. */
+constexpr int pyramid_min_size = 256;
+
+/** The size of the image tiles saved for the paint-on-template undo. */
+constexpr int undo_tile_size = 64;
+
+QImage halfSize(const QImage& source)
+{
+	return source.scaled(qMax(1, source.width() / 2), qMax(1, source.height() / 2),
+	                     Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+}
+
+std::vector<QImage> makePyramid(const QImage& image)
+{
+	std::vector<QImage> pyramid;
+	auto level = image;
+	while (qMax(level.width(), level.height()) > pyramid_min_size)
+	{
+		level = halfSize(level);
+		pyramid.push_back(level);
+	}
+	return pyramid;
+}
+
+}  // namespace
+
+
+
+struct TemplateImage::LoadedImage
+{
+	QString path;
+	QImage image;
+	std::vector<QImage> pyramid;
+	bool drawable = false;
+};
+
+
+
 const std::vector<QByteArray>& TemplateImage::supportedExtensions()
 {
 	static std::vector<QByteArray> extensions;
@@ -92,11 +136,13 @@ TemplateImage::TemplateImage(const QString& path, Map* map)
 	const Georeferencing& georef = map->getGeoreferencing();
 	connect(&georef, &Georeferencing::projectionChanged, this, &TemplateImage::updateGeoreferencing);
 	connect(&georef, &Georeferencing::transformationChanged, this, &TemplateImage::updateGeoreferencing);
+	registerCache();
 }
 
 TemplateImage::TemplateImage(const TemplateImage& proto)
 : Template(proto)
 , image(proto.image)
+, pyramid(proto.pyramid)
 // not copied: undo_steps
 // not copied: undo_index
 , available_georef(proto.available_georef)
@@ -105,6 +151,7 @@ TemplateImage::TemplateImage(const TemplateImage& proto)
 	const Georeferencing& georef = map->getGeoreferencing();
 	connect(&georef, &Georeferencing::projectionChanged, this, &TemplateImage::updateGeoreferencing);
 	connect(&georef, &Georeferencing::transformationChanged, this, &TemplateImage::updateGeoreferencing);
+	registerCache();
 }
 
 TemplateImage::~TemplateImage()
@@ -157,39 +204,77 @@ bool TemplateImage::loadTypeSpecificTemplateConfiguration(QXmlStreamReader& xml)
 	return true;
 }
 
-bool TemplateImage::loadTemplateFileImpl(bool configuring)
+QString TemplateImage::readImage(LoadedImage& data)
 {
-	QImageReader reader(template_path);
+	QImageReader reader(data.path);
 	
 	// QImageReader::format() cannot be called after reading.
-	drawable = QImageWriter::supportedImageFormats().contains(reader.format());
+	data.drawable = QImageWriter::supportedImageFormats().contains(reader.format());
 	
 	const QSize size = reader.size();
 	const QImage::Format format = reader.imageFormat();
 	if (size.isEmpty() || format == QImage::Format_Invalid)
 	{
 		// Leave memory allocation to QImageReader
-		image = reader.read();
+		data.image = reader.read();
 	}
 	else
 	{
 		// Pre-allocate the memory in order to catch errors
-		image = QImage(size, format);
-		if (image.isNull())
-		{
-			setErrorString(tr("Not enough free memory (image size: %1x%2 pixels)").arg(size.width()).arg(size.height()));
-			return false;
-		}
+		data.image = QImage(size, format);
+		if (data.image.isNull())
+			return tr("Not enough free memory (image size: %1x%2 pixels)").arg(size.width()).arg(size.height());
 		// Read into pre-allocated image
-		reader.read(&image);
+		reader.read(&data.image);
 	}
 	
-	if (image.isNull())
+	if (data.image.isNull())
+		return reader.errorString();
+	
+	data.pyramid = makePyramid(data.image);
+	return {};
+}
+
+std::function<void ()> TemplateImage::makeBackgroundLoader()
+{
+	if (TemplateDataCache::find<LoadedImage>(getTemplateType(), template_path))
+		return {};  // Loading will be fast.
+	
+	auto data = std::make_shared<LoadedImage>();
+	data->path = template_path;
+	loaded_image = data;
+	return [data]() { readImage(*data); };
+}
+
+bool TemplateImage::loadTemplateFileImpl(bool configuring)
+{
+	auto data = std::move(loaded_image);
+	if (auto cached = TemplateDataCache::find<LoadedImage>(getTemplateType(), template_path))
+	{
+		data = std::move(cached);
+	}
+	else
 	{
-		setErrorString(reader.errorString());
-		return false;
+		if (!data || data->path != template_path || data->image.isNull())
+		{
+			data = std::make_shared<LoadedImage>();
+			data->path = template_path;
+			auto const error = readImage(*data);
+			if (data->image.isNull())
+			{
+				setErrorString(error);
+				return false;
+			}
+		}
+		TemplateDataCache::insert(getTemplateType(), template_path, data);
 	}
 	
+	// The images are implicitly shared with other templates using the data.
+	shared_image = data;
+	drawable = data->drawable;
+	image = data->image;
+	pyramid = data->pyramid;
+	
 #ifdef MAPPER_USE_GDAL
 	available_georef = findAvailableGeoreferencing(readGdalGeoTransform(template_path));
 #else
@@ -233,7 +318,8 @@ bool TemplateImage::postLoadConfiguration(QWidget* dialog_parent, bool& out_cent
 			{
 				// Use the center coordinates of the image as initial reference point.
 				calculateGeoreferencing();
-				auto const center_pixel = MapCoordF(0.5 * (image.width() - 1), 0.5 * (image.height() - 1));
+				auto const size = imageSize();
+				auto const center_pixel = MapCoordF(0.5 * (size.width() - 1), 0.5 * (size.height() - 1));
 				initial_georef.setProjectedRefPoint(georef->toProjectedCoords(center_pixel));
 			}
 			
@@ -296,9 +382,11 @@ bool TemplateImage::postLoadConfiguration(QWidget* dialog_parent, bool& out_cent
 void TemplateImage::unloadTemplateFileImpl()
 {
 	image = QImage();
+	pyramid.clear();
+	shared_image.reset();
 }
 
-void TemplateImage::drawTemplate(QPainter* painter, const QRectF& /*clip_rect*/, double /*scale*/, bool /*on_screen*/, qreal opacity) const
+void TemplateImage::drawTemplate(QPainter* painter, const QRectF& /*clip_rect*/, double /*scale*/, bool on_screen, qreal opacity) const
 {
 	applyTemplateTransform(painter);
 	
@@ -320,15 +408,44 @@ void TemplateImage::drawTemplate(QPainter* painter, const QRectF& /*clip_rect*/,
 			painter->setBrush(Qt::white);
 	}
 #endif
-	painter->drawImage(QPointF(-image.width() * 0.5, -image.height() * 0.5), image);
+	
+	// On screen, use the smallest level which still has at least
+	// the resolution of the device.
+	const QImage* level = &image;
+	if (on_screen && !pyramid.empty())
+	{
+		auto const t = painter->worldTransform();
+		auto const device_pixels_per_image_pixel = std::sqrt(std::abs(t.m11() * t.m22() - t.m12() * t.m21()));
+		auto level_pixels_per_image_pixel = 1.0;
+		for (auto const& candidate : pyramid)
+		{
+			level_pixels_per_image_pixel *= 0.5;
+			if (level_pixels_per_image_pixel < device_pixels_per_image_pixel)
+				break;
+			level = &candidate;
+		}
+	}
+	
+	if (level == &image)
+	{
+		painter->drawImage(QPointF(-image.width() * 0.5, -image.height() * 0.5), image);
+	}
+	else
+	{
+		painter->save();
+		painter->scale(qreal(image.width()) / level->width(), qreal(image.height()) / level->height());
+		painter->drawImage(QPointF(-level->width() * 0.5, -level->height() * 0.5), *level);
+		painter->restore();
+	}
 	painter->setRenderHint(QPainter::SmoothPixmapTransform, false);
 }
 QRectF TemplateImage::getTemplateExtent() const
 {
     // If the image is invalid, the extent is an empty rectangle.
-    if (image.isNull())
+	auto const size = imageSize();
+	if (size.isEmpty())
 		return QRectF();
-	return QRectF(-image.width() * 0.5, -image.height() * 0.5, image.width(), image.height());
+	return QRectF(-size.width() * 0.5, -size.height() * 0.5, size.width(), size.height());
 }
 
 QPointF TemplateImage::calcCenterOfGravity(QRgb background_color)
@@ -548,12 +665,45 @@ void TemplateImage::drawOntoTemplateImpl(MapCoordF* coords, int num_coords, cons
 		radius_bbox = radius_bbox.intersected(QRect(0, 0, image.width(), image.height()));
 	}
 	
-	// Create undo step
+	// Create undo step from the tiles touched by the stroke
+	std::vector<QPoint> touched_tiles;
+	auto const add_touched_tiles = [&touched_tiles](const QRect& rect) {
+		for (int y = rect.top() / undo_tile_size; y <= rect.bottom() / undo_tile_size; ++y)
+		{
+			for (int x = rect.left() / undo_tile_size; x <= rect.right() / undo_tile_size; ++x)
+				touched_tiles.emplace_back(x, y);
+		}
+	};
+	auto const image_rect = image.rect();
+	if (all_coords_equal)
+	{
+		add_touched_tiles(radius_bbox.intersected(image_rect));
+	}
+	else
+	{
+		for (int i = 1; i < num_coords; ++i)
+		{
+			auto const segment_rect = QRectF(points[i-1], points[i]).normalized()
+			                          .adjusted(-width - 1, -width - 1, width + 1, width + 1);
+			add_touched_tiles(segment_rect.toAlignedRect().intersected(image_rect));
+		}
+	}
+	std::sort(begin(touched_tiles), end(touched_tiles), [](const QPoint& a, const QPoint& b) {
+		return a.y() < b.y() || (a.y() == b.y() && a.x() < b.x());
+	});
+	touched_tiles.erase(std::unique(begin(touched_tiles), end(touched_tiles)), end(touched_tiles));
+	
 	DrawOnImageUndoStep undo_step;
-	undo_step.x = radius_bbox.left();
-	undo_step.y = radius_bbox.top();
-	undo_step.image = image.copy(radius_bbox);
-	addUndoStep(undo_step);
+	undo_step.tiles.reserve(touched_tiles.size());
+	for (auto const& tile : touched_tiles)
+	{
+		DrawOnImageUndoTile undo_tile;
+		undo_tile.rect = QRect(tile * undo_tile_size, QSize(undo_tile_size, undo_tile_size)).intersected(image_rect);
+		if (undo_tile.rect.isEmpty())
+			continue;
+		undo_tile.image = image.copy(undo_tile.rect);
+		undo_step.tiles.push_back(std::move(undo_tile));
+	}
 	
 	// This conversion is to prevent a very strange bug where the behavior of the
 	// default QPainter composition mode seems to be incorrect for images which are
@@ -579,6 +729,10 @@ void TemplateImage::drawOntoTemplateImpl(MapCoordF* coords, int num_coords, cons
 	
 	painter.end();
 	delete[] points;
+	
+	for (auto const& tile : undo_step.tiles)
+		updatePyramid(tile.rect);
+	addUndoStep(std::move(undo_step));
 }
 
 void TemplateImage::drawOntoTemplateUndo(bool redo)
@@ -598,40 +752,173 @@ void TemplateImage::drawOntoTemplateUndo(bool redo)
 	}
 	
 	DrawOnImageUndoStep& step = undo_steps[step_index];
-	QImage undo_image = step.image.copy();
-	step.image = image.copy(step.x, step.y, step.image.width(), step.image.height());
 	QPainter painter(&image);
 	painter.setCompositionMode(QPainter::CompositionMode_Source);
-	painter.drawImage(step.x, step.y, undo_image);
+	for (auto& tile : step.tiles)
+	{
+		auto const undo_image = tile.pixels();
+		tile.image = image.copy(tile.rect);
+		tile.data.clear();
+		painter.drawImage(tile.rect.topLeft(), undo_image);
+	}
+	painter.end();
+	for (auto const& tile : step.tiles)
+		updatePyramid(tile.rect);
 	
 	undo_index += redo ? 1 : -1;
 	
-	qreal template_left = step.x - 0.5 * image.width();
-	qreal template_top = step.y - 0.5 * image.height();
+	auto const step_rect = step.boundingRect();
+	qreal template_left = step_rect.left() - 0.5 * image.width();
+	qreal template_top = step_rect.top() - 0.5 * image.height();
 	QRectF map_bbox;
 	rectIncludeSafe(map_bbox, templateToMap(QPointF(template_left, template_top)));
-	rectIncludeSafe(map_bbox, templateToMap(QPointF(template_left + step.image.width(), template_top)));
-	rectIncludeSafe(map_bbox, templateToMap(QPointF(template_left, template_top + step.image.height())));
-	rectIncludeSafe(map_bbox, templateToMap(QPointF(template_left + step.image.width(), template_top + step.image.height())));
+	rectIncludeSafe(map_bbox, templateToMap(QPointF(template_left + step_rect.width(), template_top)));
+	rectIncludeSafe(map_bbox, templateToMap(QPointF(template_left, template_top + step_rect.height())));
+	rectIncludeSafe(map_bbox, templateToMap(QPointF(template_left + step_rect.width(), template_top + step_rect.height())));
 	map->setTemplateAreaDirty(this, map_bbox, 0);
 	
 	setHasUnsavedChanges(true);
 }
 
-void TemplateImage::addUndoStep(const TemplateImage::DrawOnImageUndoStep& new_step)
+void TemplateImage::addUndoStep(TemplateImage::DrawOnImageUndoStep&& new_step)
 {
-	// TODO: undo step limitation based on used memory
-	const int max_undo_steps = 5;
+	const int max_undo_steps = 20;
+	const qint64 max_undo_bytes = 32 * 1024 * 1024;
 	
 	while (static_cast<int>(undo_steps.size()) > undo_index)
 		undo_steps.pop_back();
 	while (static_cast<int>(undo_steps.size()) >= max_undo_steps)
 		undo_steps.erase(undo_steps.begin());
 	
-	undo_steps.push_back(new_step);
+	// The most recent step is kept uncompressed, for a quick undo.
+	if (!undo_steps.empty())
+	{
+		for (auto& tile : undo_steps.back().tiles)
+			tile.compress();
+	}
+	undo_steps.push_back(std::move(new_step));
+	
+	qint64 bytes = 0;
+	for (auto const& step : undo_steps)
+	{
+		for (auto const& tile : step.tiles)
+			bytes += tile.bytes();
+	}
+	while (undo_steps.size() > 1 && bytes > max_undo_bytes)
+	{
+		for (auto const& tile : undo_steps.front().tiles)
+			bytes -= tile.bytes();
+		undo_steps.erase(undo_steps.begin());
+	}
 	undo_index = static_cast<int>(undo_steps.size());
 }
 
+
+void TemplateImage::registerCache()
+{
+	cache_registration = CacheManager::add({
+		[this]() { return cacheMemoryUsage(); },
+		[this](CacheManager::TrimLevel level) { trimCaches(level); }
+	});
+}
+
+qint64 TemplateImage::cacheMemoryUsage() const
+{
+	// Shared images are counted for each template.
+	auto bytes = qint64(image.bytesPerLine()) * image.height();
+	for (auto const& level : pyramid)
+		bytes += qint64(level.bytesPerLine()) * level.height();
+	for (auto const& step : undo_steps)
+	{
+		for (auto const& tile : step.tiles)
+			bytes += tile.bytes();
+	}
+	return bytes;
+}
+
+void TemplateImage::trimCaches(CacheManager::TrimLevel /*level*/)
+{
+	// The image and its pyramid are needed for drawing, and they are shared
+	// with other templates and TemplateDataCache. But the undo steps can be
+	// compressed, at the expense of a slower undo.
+	for (auto& step : undo_steps)
+	{
+		for (auto& tile : step.tiles)
+			tile.compress();
+	}
+}
+
+
+void TemplateImage::DrawOnImageUndoTile::compress()
+{
+	if (image.isNull())
+		return;
+	
+	format = image.format();
+	data = qCompress(image.constBits(), image.bytesPerLine() * image.height(), 1);
+	image = {};
+}
+
+QImage TemplateImage::DrawOnImageUndoTile::pixels() const
+{
+	if (!image.isNull())
+		return image;
+	
+	QImage result(rect.size(), format);
+	auto const raw = qUncompress(data);
+	if (!result.isNull() && raw.size() == result.bytesPerLine() * result.height())
+		std::copy(raw.constBegin(), raw.constEnd(), reinterpret_cast<char*>(result.bits()));
+	return result;
+}
+
+qint64 TemplateImage::DrawOnImageUndoTile::bytes() const
+{
+	return image.isNull() ? qint64(data.size()) : qint64(image.bytesPerLine()) * image.height();
+}
+
+QRect TemplateImage::DrawOnImageUndoStep::boundingRect() const
+{
+	QRect rect;
+	for (auto const& tile : tiles)
+		rect |= tile.rect;
+	return rect;
+}
+
+void TemplateImage::buildPyramid()
+{
+	pyramid = makePyramid(image);
+}
+
+void TemplateImage::updatePyramid(const QRect& image_rect)
+{
+	// The image was modified, so it no longer matches the shared data.
+	shared_image.reset();
+	
+	auto rect = image_rect.intersected(image.rect());
+	const QImage* source = &image;
+	for (auto& level : pyramid)
+	{
+		// Each target pixel is made from a block of 2x2 source pixels.
+		rect = QRect(QPoint(rect.left() & ~1, rect.top() & ~1), QPoint(rect.right() | 1, rect.bottom() | 1))
+		       .intersected(source->rect());
+		auto const target = QRect(rect.left() / 2, rect.top() / 2, qMax(1, rect.width() / 2), qMax(1, rect.height() / 2))
+		                    .intersected(level.rect());
+		if (target.isEmpty())
+			break;
+		
+		if (source->hasAlphaChannel() && !level.hasAlphaChannel())
+			level = level.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+		
+		QPainter painter(&level);
+		painter.setCompositionMode(QPainter::CompositionMode_Source);
+		painter.drawImage(target.topLeft(), source->copy(rect).scaled(target.size(), Qt::IgnoreAspectRatio, Qt::SmoothTransformation));
+		painter.end();
+		
+		rect = target;
+		source = &level;
+	}
+}
+
 void TemplateImage::calculateGeoreferencing()
 {
 	if (!isGeoreferencingUsable())
@@ -654,6 +941,7 @@ void TemplateImage::updatePosFromGeoreferencing()
 {
 	// Determine map coords of three image corner points
 	// by transforming the points from one Georeferencing into the other
+	auto const size = imageSize();
 	bool ok;
 	MapCoordF top_left = map->getGeoreferencing().toMapCoordF(georef.get(), MapCoordF(0.0, 0.0), &ok);
 	if (!ok)
@@ -661,13 +949,13 @@ void TemplateImage::updatePosFromGeoreferencing()
 		qDebug("%s failed", Q_FUNC_INFO);
 		return; // TODO: proper error message?
 	}
-	MapCoordF top_right = map->getGeoreferencing().toMapCoordF(georef.get(), MapCoordF(image.width(), 0.0), &ok);
+	MapCoordF top_right = map->getGeoreferencing().toMapCoordF(georef.get(), MapCoordF(size.width(), 0.0), &ok);
 	if (!ok)
 	{
 		qDebug("%s failed", Q_FUNC_INFO);
 		return; // TODO: proper error message?
 	}
-	MapCoordF bottom_left = map->getGeoreferencing().toMapCoordF(georef.get(), MapCoordF(0.0, image.height()), &ok);
+	MapCoordF bottom_left = map->getGeoreferencing().toMapCoordF(georef.get(), MapCoordF(0.0, size.height()), &ok);
 	if (!ok)
 	{
 		qDebug("%s failed", Q_FUNC_INFO);
@@ -678,13 +966,13 @@ void TemplateImage::updatePosFromGeoreferencing()
 	PassPointList pp_list;
 	
 	PassPoint pp;
-	pp.src_coords = MapCoordF(-0.5 * image.width(), -0.5 * image.height());
+	pp.src_coords = MapCoordF(-0.5 * size.width(), -0.5 * size.height());
 	pp.dest_coords = top_left;
 	pp_list.push_back(pp);
-	pp.src_coords = MapCoordF(0.5 * image.width(), -0.5 * image.height());
+	pp.src_coords = MapCoordF(0.5 * size.width(), -0.5 * size.height());
 	pp.dest_coords = top_right;
 	pp_list.push_back(pp);
-	pp.src_coords = MapCoordF(-0.5 * image.width(), 0.5 * image.height());
+	pp.src_coords = MapCoordF(-0.5 * size.width(), 0.5 * size.height());
 	pp.dest_coords = bottom_left;
 	pp_list.push_back(pp);
 	
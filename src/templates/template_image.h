@@ -22,6 +22,8 @@
 #ifndef OPENORIENTEERING_TEMPLATE_IMAGE_H
 #define OPENORIENTEERING_TEMPLATE_IMAGE_H
 
+#include <cstddef>
+#include <functional>
 #include <memory>
 #include <vector>
 
@@ -31,12 +33,15 @@
 #include <QImage>
 #include <QObject>
 #include <QPointF>
+#include <QRect>
 #include <QRectF>
 #include <QRgb>
+#include <QSize>
 #include <QString>
 #include <QTransform>
 
 #include "templates/template.h"
+#include "util/cache_manager.h"
 
 class QPainter;
 class QPointF;
@@ -111,12 +116,14 @@ public:
 	bool loadTypeSpecificTemplateConfiguration(QXmlStreamReader& xml) override;
 
 	bool loadTemplateFileImpl(bool configuring) override;
+	std::function<void ()> makeBackgroundLoader() override;
 	bool postLoadConfiguration(QWidget* dialog_parent, bool& out_center_in_view) override;
 	void unloadTemplateFileImpl() override;
 	
     void drawTemplate(QPainter* painter, const QRectF& clip_rect, double scale, bool on_screen, qreal opacity) const override;
 	QRectF getTemplateExtent() const override;
 	bool canBeDrawnOnto() const override { return drawable; }
+	std::size_t memoryUsage() const override { return std::size_t(cacheMemoryUsage()); }
 
 	/**
 	 * Calculates the image's center of gravity in template coordinates by
@@ -124,9 +131,29 @@ public:
 	 */
 	QPointF calcCenterOfGravity(QRgb background_color);
 	
-	/** Returns the internal QImage. */
+	/**
+	 * Returns the internal QImage.
+	 * 
+	 * This may be a null image for loaded templates which do not keep the
+	 * full image in memory, cf. imageSize().
+	 */
 	inline const QImage& getImage() const {return image;}
 	
+	/**
+	 * Returns the size of the image in pixels.
+	 * 
+	 * This is the size of the internal image by default, but subclasses may
+	 * provide image data without holding the full image in memory.
+	 */
+	virtual QSize imageSize() const { return image.size(); }
+	
+	/**
+	 * Returns the resolution at which a document was rasterized, or 0.
+	 * 
+	 * Regular images have no inherent resolution.
+	 */
+	virtual double imageDpi() const { return 0; }
+	
 	/**
 	 * Returns which georeferencing methods are known to be available.
 	 * 
@@ -167,27 +194,97 @@ protected:
 	 */
 	bool isGeoreferencingUsable() const;
 	
-	/** Information about an undo step for the paint-on-template functionality. */
-	struct DrawOnImageUndoStep
+	/**
+	 * A tile of the image, saved for the paint-on-template undo.
+	 * 
+	 * Only the tiles touched by a stroke are saved.
+	 * Tiles which are not likely to be needed soon are compressed.
+	 */
+	struct DrawOnImageUndoTile
 	{
-		/** Copy of previous image part */
+		/** Area of the tile in the image */
+		QRect rect;
+		
+		/** Copy of the previous pixels, unless compressed */
 		QImage image;
 		
-		/** X position of image part origin */
-		int x;
+		/** Compressed copy of the previous pixels */
+		QByteArray data;
+		
+		/** Pixel format of the compressed data */
+		QImage::Format format = QImage::Format_Invalid;
+		
+		/** Compresses the pixels. */
+		void compress();
+		
+		/** Returns the previous pixels. */
+		QImage pixels() const;
+		
+		/** Returns the approximate memory used by this tile. */
+		qint64 bytes() const;
+	};
+	
+	/** Information about an undo step for the paint-on-template functionality. */
+	struct DrawOnImageUndoStep
+	{
+		/** Copies of the previous image tiles */
+		std::vector<DrawOnImageUndoTile> tiles;
 		
-		/** Y position of image part origin */
-		int y;
+		/** Returns the bounding box of the tiles. */
+		QRect boundingRect() const;
 	};
 	
 	void drawOntoTemplateImpl(MapCoordF* coords, int num_coords, const QColor& color, qreal width) override;
 	void drawOntoTemplateUndo(bool redo) override;
-	void addUndoStep(const DrawOnImageUndoStep& new_step);
+	void addUndoStep(DrawOnImageUndoStep&& new_step);
 	void calculateGeoreferencing();
 	void updatePosFromGeoreferencing();
+	
+	/**
+	 * Rebuilds the downscaled copies of the image.
+	 * 
+	 * This must be called after loading the image.
+	 */
+	void buildPyramid();
+	
+	/**
+	 * Image data as read from the file.
+	 */
+	struct LoadedImage;
+	
+	/**
+	 * Reads the image file at the data's path, and builds the pyramid.
+	 * 
+	 * This function may be called on a worker thread.
+	 * On error, it returns an error message, and the image is null.
+	 */
+	static QString readImage(LoadedImage& data);
+	
+	/**
+	 * Updates the downscaled copies of the image in the given area,
+	 * given in image pixels.
+	 */
+	void updatePyramid(const QRect& image_rect);
+	
+	/** Registers the image data with the CacheManager. */
+	void registerCache();
+	
+	/** Returns the memory used by the image, the pyramid and the undo steps. */
+	qint64 cacheMemoryUsage() const;
+	
+	/** Compresses all undo steps. */
+	void trimCaches(CacheManager::TrimLevel level);
 
 	QImage image;
 	
+	/**
+	 * Downscaled copies of the image for drawing at low zoom.
+	 * 
+	 * Each level has half the width and height of the previous one,
+	 * starting with half the size of the image.
+	 */
+	std::vector<QImage> pyramid;
+	
 	std::vector< DrawOnImageUndoStep > undo_steps;
 	/// Current index in undo_steps, where 0 means before the first item.
 	int undo_index = 0;
@@ -196,6 +293,14 @@ protected:
 	
 	GeoreferencingOptions available_georef;
 	std::unique_ptr<Georeferencing> georef;
+	
+	/// Data from the background loader, if any
+	std::shared_ptr<LoadedImage> loaded_image;
+	
+	/// The data shared with other templates via TemplateDataCache, while unmodified
+	std::shared_ptr<const LoadedImage> shared_image;
+	
+	CacheManager::Registration cache_registration;
 };
 
 
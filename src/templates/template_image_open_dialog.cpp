@@ -50,8 +50,8 @@ TemplateImageOpenDialog::TemplateImageOpenDialog(TemplateImage* templ, QWidget*
 	setWindowTitle(tr("Opening %1").arg(templ->getTemplateFilename()));
 	
 	QLabel* size_label = new QLabel(QLatin1String("<b>") + tr("Image size:") + QLatin1String("</b> ")
-	                                + QString::number(templ->getImage().width()) + QLatin1String(" x ")
-	                                + QString::number(templ->getImage().height()));
+	                                + QString::number(templ->imageSize().width()) + QLatin1String(" x ")
+	                                + QString::number(templ->imageSize().height()));
 	QLabel* desc_label = new QLabel(tr("Specify how to position or scale the image:"));
 	
 	bool use_meters_per_pixel;
@@ -59,6 +59,12 @@ TemplateImageOpenDialog::TemplateImageOpenDialog(TemplateImage* templ, QWidget*
 	double dpi;
 	double scale;
 	templ->getMap()->getImageTemplateDefaults(use_meters_per_pixel, meters_per_pixel, dpi, scale);
+	if (templ->imageDpi() > 0)
+	{
+		// Documents are rasterized at a known resolution.
+		use_meters_per_pixel = false;
+		dpi = templ->imageDpi();
+	}
 	
 	auto georef_source = templ->availableGeoreferencing().effective.transform.source;
 	auto const georef_radio_enabled = !georef_source.isEmpty();
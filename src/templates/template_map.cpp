@@ -21,12 +21,18 @@
 
 #include "template_map.h"
 
+#include <cstddef>
+#include <memory>
 #include <utility>
+#include <vector>
 
 #include <QtGlobal>
 #include <QByteArray>
+#include <QImage>
 #include <QPaintDevice>
 #include <QPainter>
+#include <QPoint>
+#include <QRect>
 #include <QRectF>
 #include <QStringList>
 #include <QTransform>
@@ -36,17 +42,29 @@
 #include "core/georeferencing.h"
 #include "core/map.h"
 #include "core/map_coord.h"
+#include "core/map_memory_statistics.h"
 #include "core/renderables/renderable.h"
 #include "fileformats/file_format_registry.h"
 #include "fileformats/file_import_export.h"
+#include "templates/template_data_cache.h"
 #include "gui/util_gui.h"
+#include "gui/map/map_tile_cache.h"
+#include "util/concurrency.h"
 #include "util/transformation.h"
 #include "util/util.h"
 
 
 namespace OpenOrienteering {
 
-QStringList TemplateMap::locked_maps;
+thread_local QStringList TemplateMap::locked_maps;
+
+
+struct TemplateMap::LoadedMap
+{
+	QString path;
+	std::unique_ptr<Map> map;
+};
+
 
 const std::vector<QByteArray>& TemplateMap::supportedExtensions()
 {
@@ -87,38 +105,86 @@ bool TemplateMap::isRasterGraphics() const
 	return false;
 }
 
+std::unique_ptr<Map> TemplateMap::importMap(const QString& path, QString& error_string)
+{
+	auto new_template_map = std::make_unique<Map>(); 
+	auto importer = FileFormats.makeImporter(path, *new_template_map, nullptr);
+	locked_maps.append(path);  /// \todo Convert to RAII
+	auto new_template_valid = importer && importer->doImport();
+	locked_maps.removeAll(path);
+	
+	if (!new_template_valid)
+	{
+		if (importer)
+			error_string = importer->warnings().back();
+		else
+			error_string = tr("Cannot load map file, aborting.");
+		return nullptr;
+	}
+	
+	// Remove all template's templates from memory
+	/// \todo prevent loading and/or let user decide
+	for (int i = new_template_map->getNumTemplates()-1; i >= 0; i--)
+	{
+		new_template_map->deleteTemplate(i);
+	}
+	
+	// Shared maps are drawn, but not modified.
+	new_template_map->updateObjects();
+	
+	return new_template_map;
+}
+
+std::function<void ()> TemplateMap::makeBackgroundLoader()
+{
+	if (TemplateDataCache::find<Map>(getTemplateType(), template_path))
+		return {};  // Loading will be fast.
+	
+	auto data = std::make_shared<LoadedMap>();
+	data->path = template_path;
+	loaded_map = data;
+	auto* main_thread = thread();
+	return [data, main_thread]() {
+		QString error_string;
+		data->map = importMap(data->path, error_string);
+		if (data->map)
+			data->map->moveToThread(main_thread);
+	};
+}
+
 bool TemplateMap::loadTemplateFileImpl(bool configuring)
 {
 	// Prevent unbounded recursive template loading
 	if (locked_maps.contains(template_path))
 		return true;
 	
-	auto new_template_map = std::make_unique<Map>(); 
-	auto importer = FileFormats.makeImporter(template_path, *new_template_map, nullptr);
-	locked_maps.append(template_path);  /// \todo Convert to RAII
-	auto new_template_valid = importer && importer->doImport();
-	locked_maps.removeAll(template_path);
+	tile_cache.reset();
+	auto data = std::move(loaded_map);
+	if (auto cached = TemplateDataCache::find<Map>(getTemplateType(), template_path))
+	{
+		template_map = std::move(cached);
+		return true;
+	}
 	
-	if (new_template_valid)
+	if (data && data->path == template_path && data->map)
+	{
+		template_map = std::move(data->map);
+	}
+	else
 	{
-		// Remove all template's templates from memory
-		/// \todo prevent loading and/or let user decide
-		for (int i = new_template_map->getNumTemplates()-1; i >= 0; i--)
+		QString error_string;
+		auto new_template_map = importMap(template_path, error_string);
+		if (!new_template_map)
 		{
-			new_template_map->deleteTemplate(i);
+			if (configuring)
+				setErrorString(error_string);
+			return false;
 		}
-		
 		template_map = std::move(new_template_map);
 	}
-	else if (configuring)
-	{
-		if (importer)
-			setErrorString(importer->warnings().back());
-		else
-			setErrorString(tr("Cannot load map file, aborting."));
-	}
 	
-	return new_template_valid;
+	TemplateDataCache::insert(getTemplateType(), template_path, template_map);
+	return true;
 }
 
 bool TemplateMap::postLoadConfiguration(QWidget* /* dialog_parent */, bool& out_center_in_view)
@@ -138,6 +204,7 @@ bool TemplateMap::postLoadConfiguration(QWidget* /* dialog_parent */, bool& out_
 void TemplateMap::unloadTemplateFileImpl()
 {
 	template_map.reset();
+	tile_cache.reset();
 }
 
 void TemplateMap::drawTemplate(QPainter* painter, const QRectF& clip_rect, double scale, bool on_screen, qreal opacity) const
@@ -179,7 +246,89 @@ void TemplateMap::drawTemplate(QPainter* painter, const QRectF& clip_rect, doubl
 	}
 	RenderConfig config = { *template_map, transformed_clip_rect, scaling, options, qreal(opacity) };
 	// TODO: introduce template-specific options, adjustable by the user, to allow changing some of these parameters
-	template_map->draw(painter, config);
+	if (on_screen && painter->worldTransform().type() < QTransform::TxProject)
+		drawTiles(painter, config);
+	else
+		template_map->draw(painter, config);
+}
+
+void TemplateMap::drawTiles(QPainter* painter, const RenderConfig& config) const
+{
+	// The opacity is applied to the individual objects,
+	// so it cannot be applied to the finished tiles.
+	const auto antialiasing = painter->testRenderHint(QPainter::Antialiasing);
+	auto flags = qRound(config.opacity * 255) << 1;
+	if (antialiasing)
+		flags |= 1;
+	
+	if (!tile_cache)
+		tile_cache = std::make_unique<MapTileCache>(32 * 1024 * 1024);
+	const auto origin = tile_cache->setLevel(painter->worldTransform(), flags);
+	
+	const auto* device = painter->device();
+	const auto device_rect = painter->worldTransform().mapRect(config.bounding_box).toAlignedRect()
+	                         .intersected(QRect(0, 0, device->width(), device->height()));
+	if (device_rect.isEmpty())
+		return;
+	
+	struct Tile
+	{
+		int x;
+		int y;
+		QImage image;
+	};
+	std::vector<Tile> tiles;
+	std::vector<std::size_t> missing_tiles;
+	const auto range = MapTileCache::tileRange(device_rect.translated(-origin));
+	for (int y = range.top(); y <= range.bottom(); ++y)
+	{
+		for (int x = range.left(); x <= range.right(); ++x)
+		{
+			tiles.push_back({ x, y, tile_cache->tile(x, y) });
+			if (tiles.back().image.isNull())
+				missing_tiles.push_back(tiles.size() - 1);
+		}
+	}
+	
+	if (!missing_tiles.empty())
+	{
+		// Render the missing tiles concurrently. The renderables must be
+		// up-to-date, and they are not modified while drawing.
+		// Settings::getSettingCached() is not thread-safe while filling its cache.
+		template_map->updateObjects();
+		Settings::getInstance().getSettingCached(Settings::MapDisplay_TextAntialiasing);
+		
+		const auto& renderables = template_map->getRenderables();
+		const auto level_transform = tile_cache->levelTransform();
+		const auto inverse_transform = level_transform.inverted();
+		Concurrency::parallelFor(0, int(missing_tiles.size()), [&](int i) {
+			auto& tile = tiles[missing_tiles[std::size_t(i)]];
+			const auto tile_rect = MapTileCache::tileRect(tile.x, tile.y);
+			tile.image = QImage(tile_rect.size(), QImage::Format_ARGB32_Premultiplied);
+			tile.image.fill(Qt::transparent);
+			
+			QPainter tile_painter(&tile.image);
+			if (antialiasing)
+				tile_painter.setRenderHint(QPainter::Antialiasing);
+			tile_painter.translate(-tile_rect.left(), -tile_rect.top());
+			tile_painter.setWorldTransform(level_transform, true);
+			
+			// An extra pixel for antialiasing at the tile border
+			const auto bounding_box = inverse_transform.mapRect(QRectF(tile_rect.adjusted(-1, -1, 1, 1)));
+			RenderConfig tile_config = { config.map, bounding_box, config.scaling, config.options, config.opacity };
+			renderables.draw(&tile_painter, tile_config);
+		}, 1, Concurrency::Priority::Interactive);
+		
+		for (auto index : missing_tiles)
+			tile_cache->insert(tiles[index].x, tiles[index].y, tiles[index].image);
+	}
+	
+	painter->save();
+	painter->resetTransform();
+	painter->setOpacity(1);
+	for (const auto& tile : tiles)
+		painter->drawImage(MapTileCache::tileRect(tile.x, tile.y).topLeft() + origin, tile.image);
+	painter->restore();
 }
 
 QRectF TemplateMap::getTemplateExtent() const
@@ -197,6 +346,12 @@ bool TemplateMap::hasAlpha() const
 	return template_map && template_map->hasAlpha();
 }
 
+std::size_t TemplateMap::memoryUsage() const
+{
+	// A map which is shared with other templates is counted for each template.
+	return template_map ? MapMemoryStatistics::collect(*template_map).total() : 0;
+}
+
 
 const Map* TemplateMap::templateMap() const
 {
@@ -205,12 +360,14 @@ const Map* TemplateMap::templateMap() const
 
 Map* TemplateMap::templateMap()
 {
+	// The caller may modify the map.
+	tile_cache.reset();
 	return template_map.get();
 }
 
-std::unique_ptr<Map> TemplateMap::takeTemplateMap()
+std::shared_ptr<Map> TemplateMap::takeTemplateMap()
 {
-	std::unique_ptr<Map> result;
+	std::shared_ptr<Map> result;
 	if (template_state == Loaded)
 	{
 		swap(result, template_map);
@@ -223,6 +380,7 @@ std::unique_ptr<Map> TemplateMap::takeTemplateMap()
 void TemplateMap::setTemplateMap(std::unique_ptr<Map>&& map)
 {
 	template_map = std::move(map);
+	tile_cache.reset();
 }
 
 void TemplateMap::calculateTransformation()
@@ -230,17 +388,17 @@ void TemplateMap::calculateTransformation()
 	const auto& georef = template_map->getGeoreferencing();
 	const auto src_origin = MapCoordF { georef.getMapRefPoint() };
 	
-	bool ok0, ok1, ok2;
+	bool ok;
 	QTransform q_transform;
 	PassPointList passpoints;
 	passpoints.resize(3);
 	passpoints[0].src_coords  = src_origin;
-	passpoints[0].dest_coords = map->getGeoreferencing().toMapCoordF(&georef, passpoints[0].src_coords, &ok0);
 	passpoints[1].src_coords  = src_origin + MapCoordF { 128.0, 0.0 }; // 128 mm off horizontally
-	passpoints[1].dest_coords = map->getGeoreferencing().toMapCoordF(&georef, passpoints[1].src_coords, &ok1);
 	passpoints[2].src_coords  = src_origin + MapCoordF { 0.0, 128.0 }; // 128 mm off vertically
-	passpoints[2].dest_coords = map->getGeoreferencing().toMapCoordF(&georef, passpoints[2].src_coords, &ok2);
-	if (ok0 && ok1 && ok2
+	auto const dest_coords = map->getGeoreferencing().toMapCoordF(&georef, { passpoints[0].src_coords, passpoints[1].src_coords, passpoints[2].src_coords }, &ok);
+	for (std::size_t i = 0; i < 3; ++i)
+		passpoints[i].dest_coords = dest_coords[i];
+	if (ok
 	    && passpoints.estimateNonIsometricSimilarityTransform(&q_transform))
 	{
 		transform = TemplateTransform::fromQTransform(q_transform);
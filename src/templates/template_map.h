@@ -22,6 +22,8 @@
 #ifndef OPENORIENTEERING_TEMPLATE_MAP_H
 #define OPENORIENTEERING_TEMPLATE_MAP_H
 
+#include <cstddef>
+#include <functional>
 #include <memory>
 #include <vector>
 
@@ -40,6 +42,8 @@ class QWidget;
 namespace OpenOrienteering {
 
 class Map;
+class MapTileCache;
+class RenderConfig;
 
 
 /**
@@ -73,6 +77,8 @@ public:
 	
 	bool loadTemplateFileImpl(bool configuring) override;
 	
+	std::function<void ()> makeBackgroundLoader() override;
+	
 	bool postLoadConfiguration(QWidget* dialog_parent, bool& out_center_in_view) override;
 	
 	void unloadTemplateFileImpl() override;
@@ -85,6 +91,8 @@ public:
 	
 	bool hasAlpha() const override;
 	
+	std::size_t memoryUsage() const override;
+	
 	
 	const Map* templateMap() const;
 	
@@ -93,8 +101,12 @@ public:
 	 * 
 	 * The template must be in loaded state before calling this method.
 	 * The template will be in unloaded state afterwards.
+	 * 
+	 * \note Maps which are loaded by TemplateMap itself may be shared
+	 *       with other templates, cf. TemplateDataCache. They must not
+	 *       be modified.
 	 */
-	std::unique_ptr<Map> takeTemplateMap();
+	std::shared_ptr<Map> takeTemplateMap();
 	
 protected:
 	Map* templateMap();
@@ -104,9 +116,39 @@ protected:
 	void calculateTransformation();
 	
 private:
-	std::unique_ptr<Map> template_map;
+	/**
+	 * A map which was imported by the background loader.
+	 */
+	struct LoadedMap;
+	
+	/**
+	 * Imports the map file at the given path, without its templates.
+	 * 
+	 * This function may be called on a worker thread.
+	 * On error, it returns nullptr and sets the error string.
+	 */
+	static std::unique_ptr<Map> importMap(const QString& path, QString& error_string);
+	
+	/**
+	 * Draws the template map from cached tiles.
+	 * 
+	 * The tiles are rendered in the painter's device coordinates, so that
+	 * panning the view reuses them. Missing tiles are rendered concurrently.
+	 * The painter's world transform must not contain perspective.
+	 */
+	void drawTiles(QPainter* painter, const RenderConfig& config) const;
+	
+	/// The template's map, possibly shared with other templates
+	std::shared_ptr<Map> template_map;
+	
+	/// Data from the background loader, if any
+	std::shared_ptr<LoadedMap> loaded_map;
+	
+	/// Tiles for on-screen drawing, created on demand
+	mutable std::unique_ptr<MapTileCache> tile_cache;
 	
-	static QStringList locked_maps;
+	/// The paths of the maps which are being imported on the current thread
+	static thread_local QStringList locked_maps;
 };
 
 
@@ -0,0 +1,513 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "template_sketch.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <utility>
+
+#include <Qt>
+#include <QtGlobal>
+#include <QByteArray>
+#include <QColor>
+#include <QDataStream>
+#include <QFile>
+#include <QIODevice>
+#include <QLineF>
+#include <QPainter>
+#include <QPen>
+#include <QSaveFile>
+
+#include "core/map.h"
+#include "core/map_coord.h"
+#include "util/util.h"
+
+
+namespace OpenOrienteering {
+
+namespace {
+
+/** Identifies sketch files. */
+constexpr quint32 sketch_magic = 0x4f4d534b;  // "OMSK"
+
+/** The current version of the sketch file format. */
+constexpr quint16 sketch_version = 1;
+
+/** The maximum number of undo steps. */
+constexpr std::size_t max_undo_steps = 128;
+
+
+qreal distance(const QPointF& point, const QPointF& a, const QPointF& b)
+{
+	auto const ab = b - a;
+	auto const length_squared = QPointF::dotProduct(ab, ab);
+	auto const t = (length_squared > 0) ? qBound(0.0, QPointF::dotProduct(point - a, ab) / length_squared, 1.0) : 0.0;
+	return QLineF(point, a + t * ab).length();
+}
+
+qreal distance(const QPointF& a, const QPointF& b, const QPointF& c, const QPointF& d)
+{
+	if (QLineF(a, b).intersect(QLineF(c, d), nullptr) == QLineF::BoundedIntersection)
+		return 0;
+	return std::min({ distance(a, c, d), distance(b, c, d), distance(c, a, b), distance(d, a, b) });
+}
+
+QRectF boundingRect(const QPointF& a, const QPointF& b)
+{
+	return QRectF(a, b).normalized();
+}
+
+
+}  // namespace
+
+
+
+// ### TemplateSketch::Stroke ###
+
+QRectF TemplateSketch::Stroke::extent() const
+{
+	QRectF rect;
+	for (auto const& point : points)
+		rectIncludeSafe(rect, point);
+	auto const margin = qreal(width) / 2;
+	return rect.adjusted(-margin, -margin, margin, margin);
+}
+
+
+
+// ### TemplateSketch ###
+
+const std::vector<QByteArray>& TemplateSketch::supportedExtensions()
+{
+	static std::vector<QByteArray> extensions = { "sketch" };
+	return extensions;
+}
+
+// static
+bool TemplateSketch::createFile(const QString& path)
+{
+	QSaveFile file(path);
+	if (!file.open(QIODevice::WriteOnly))
+		return false;
+	
+	QDataStream stream(&file);
+	stream.setVersion(QDataStream::Qt_5_5);
+	stream << sketch_magic << sketch_version << quint32(0);
+	return stream.status() == QDataStream::Ok && file.commit();
+}
+
+
+TemplateSketch::TemplateSketch(const QString& path, Map* map)
+: Template(path, map)
+{
+	// nothing else
+}
+
+TemplateSketch::TemplateSketch(const TemplateSketch& proto)
+: Template(proto)
+, strokes(proto.strokes)
+, index(proto.index)
+, next_id(proto.next_id)
+{
+	// nothing else
+}
+
+TemplateSketch::~TemplateSketch()
+{
+	if (template_state == Loaded)
+		unloadTemplateFile();
+}
+
+TemplateSketch* TemplateSketch::duplicate() const
+{
+	return new TemplateSketch(*this);
+}
+
+const char* TemplateSketch::getTemplateType() const
+{
+	return "TemplateSketch";
+}
+
+bool TemplateSketch::isRasterGraphics() const
+{
+	return false;
+}
+
+
+
+bool TemplateSketch::saveTemplateFile() const
+{
+	QSaveFile file(template_path);
+	if (!file.open(QIODevice::WriteOnly))
+		return false;
+	
+	QDataStream stream(&file);
+	stream.setVersion(QDataStream::Qt_5_5);
+	stream << sketch_magic << sketch_version << quint32(strokes.size());
+	for (auto const& entry : strokes)
+	{
+		auto const& stroke = entry.second;
+		stream << quint32(stroke.color) << stroke.width << quint32(stroke.points.size());
+		for (auto const& point : stroke.points)
+			stream << point.x() << point.y();
+	}
+	return stream.status() == QDataStream::Ok && file.commit();
+}
+
+bool TemplateSketch::loadTemplateFileImpl(bool /*configuring*/)
+{
+	QFile file(template_path);
+	if (!file.open(QIODevice::ReadOnly))
+	{
+		setErrorString(file.errorString());
+		return false;
+	}
+	
+	QDataStream stream(&file);
+	stream.setVersion(QDataStream::Qt_5_5);
+	quint32 magic = 0;
+	quint16 version = 0;
+	quint32 count = 0;
+	stream >> magic >> version >> count;
+	if (stream.status() != QDataStream::Ok || magic != sketch_magic)
+	{
+		setErrorString(tr("Not a sketch file."));
+		return false;
+	}
+	if (version > sketch_version)
+	{
+		setErrorString(tr("The sketch file was created by a newer version of this program."));
+		return false;
+	}
+	
+	strokes.clear();
+	index.clear();
+	for (quint32 id = 0; id < count && stream.status() == QDataStream::Ok; ++id)
+	{
+		quint32 color = 0;
+		quint32 num_points = 0;
+		Stroke stroke;
+		stream >> color >> stroke.width >> num_points;
+		stroke.color = QRgb(color);
+		// The number of points is not trusted for preallocation.
+		for (quint32 i = 0; i < num_points && stream.status() == QDataStream::Ok; ++i)
+		{
+			qreal x, y;
+			stream >> x >> y;
+			stroke.points.emplace_back(x, y);
+		}
+		if (!stroke.points.empty())
+			addStroke(id, stroke);
+	}
+	if (stream.status() != QDataStream::Ok)
+	{
+		strokes.clear();
+		index.clear();
+		setErrorString(tr("The sketch file is truncated or damaged."));
+		return false;
+	}
+	
+	next_id = count;
+	undo_steps.clear();
+	undo_index = 0;
+	return true;
+}
+
+void TemplateSketch::unloadTemplateFileImpl()
+{
+	strokes.clear();
+	index.clear();
+	next_id = 0;
+	undo_steps.clear();
+	undo_index = 0;
+}
+
+
+
+void TemplateSketch::drawTemplate(QPainter* painter, const QRectF& clip_rect, double /*scale*/, bool /*on_screen*/, qreal opacity) const
+{
+	QRectF template_clip_rect;
+	rectIncludeSafe(template_clip_rect, mapToTemplate(MapCoordF(clip_rect.topLeft())));
+	rectIncludeSafe(template_clip_rect, mapToTemplate(MapCoordF(clip_rect.topRight())));
+	rectIncludeSafe(template_clip_rect, mapToTemplate(MapCoordF(clip_rect.bottomLeft())));
+	rectIncludeSafe(template_clip_rect, mapToTemplate(MapCoordF(clip_rect.bottomRight())));
+	
+	auto ids = index.find(template_clip_rect);
+	if (ids.empty())
+		return;
+	std::sort(begin(ids), end(ids));
+	
+	painter->save();
+	applyTemplateTransform(painter);
+	painter->setOpacity(opacity);
+	painter->setRenderHint(QPainter::Antialiasing);
+	
+	QPen pen;
+	pen.setCapStyle(Qt::RoundCap);
+	pen.setJoinStyle(Qt::RoundJoin);
+	for (auto id : ids)
+	{
+		auto const& stroke = strokes.at(id);
+		auto const color = QColor::fromRgba(stroke.color);
+		if (stroke.points.size() == 1)
+		{
+			// drawPolyline() draws nothing for a single point.
+			auto const radius = qreal(stroke.width) / 2;
+			painter->setPen(Qt::NoPen);
+			painter->setBrush(color);
+			painter->drawEllipse(stroke.points.front(), radius, radius);
+			continue;
+		}
+		
+		pen.setColor(color);
+		pen.setWidthF(qreal(stroke.width));
+		painter->setPen(pen);
+		painter->setBrush(Qt::NoBrush);
+		painter->drawPolyline(stroke.points.data(), int(stroke.points.size()));
+	}
+	
+	painter->restore();
+}
+
+QRectF TemplateSketch::getTemplateExtent() const
+{
+	// The bounds of the index may be larger than the actual extent
+	// after erasing, but they are good enough for a bounding box.
+	return index.bounds();
+}
+
+bool TemplateSketch::canBeDrawnOnto() const
+{
+	return true;
+}
+
+
+
+void TemplateSketch::drawOntoTemplateImpl(MapCoordF* coords, int num_coords, const QColor& color, qreal width)
+{
+	std::vector<QPointF> points;
+	points.reserve(std::size_t(num_coords));
+	for (int i = 0; i < num_coords; ++i)
+	{
+		auto const point = QPointF(mapToTemplate(coords[i]));
+		if (points.empty() || point != points.back())
+			points.push_back(point);
+	}
+	
+	UndoStep step;
+	if (color.alpha() == 0)
+	{
+		erase(points, width / 2, step);
+		if (step.added.empty() && step.removed.empty())
+			return;
+	}
+	else
+	{
+		// Cf. the rendering of strokes in TemplateImage::drawOntoTemplateImpl
+		Stroke stroke;
+		stroke.color = color.rgba();
+		stroke.width = float(qMax(width, 1.0));
+		if (points.size() == 1)
+			stroke.width = float(2 * qMax(width, 1.0) + 1.6);
+		stroke.points = std::move(points);
+		
+		auto const id = next_id++;
+		addStroke(id, stroke);
+		step.added.emplace_back(id, std::move(stroke));
+	}
+	
+	undo_steps.erase(begin(undo_steps) + std::ptrdiff_t(undo_index), end(undo_steps));
+	if (undo_steps.size() >= max_undo_steps)
+		undo_steps.erase(begin(undo_steps));
+	undo_steps.push_back(std::move(step));
+	undo_index = undo_steps.size();
+}
+
+void TemplateSketch::drawOntoTemplateUndo(bool redo)
+{
+	if (redo ? undo_index >= undo_steps.size() : undo_index == 0)
+		return;
+	
+	if (!redo)
+		--undo_index;
+	auto const& step = undo_steps[undo_index];
+	auto const& removed = redo ? step.removed : step.added;
+	auto const& added = redo ? step.added : step.removed;
+	
+	QRectF area;
+	for (auto const& entry : removed)
+	{
+		rectIncludeSafe(area, entry.second.extent());
+		removeStroke(entry.first);
+	}
+	for (auto const& entry : added)
+	{
+		rectIncludeSafe(area, entry.second.extent());
+		addStroke(entry.first, entry.second);
+	}
+	if (redo)
+		++undo_index;
+	
+	setAreaDirty(area);
+	setHasUnsavedChanges(true);
+}
+
+std::size_t TemplateSketch::memoryUsage() const
+{
+	// A tree node holds the value and three pointers.
+	constexpr auto node_overhead = 3 * sizeof(void*);
+	auto const stroke_bytes = [](const Stroke& stroke) {
+		return stroke.points.capacity() * sizeof(QPointF);
+	};
+	
+	auto bytes = index.memoryUsage() + undo_steps.capacity() * sizeof(UndoStep);
+	for (const auto& stroke : strokes)
+		bytes += sizeof(stroke) + node_overhead + stroke_bytes(stroke.second);
+	for (const auto& step : undo_steps)
+	{
+		bytes += (step.added.capacity() + step.removed.capacity()) * sizeof(std::pair<StrokeId, Stroke>);
+		for (const auto& item : step.added)
+			bytes += stroke_bytes(item.second);
+		for (const auto& item : step.removed)
+			bytes += stroke_bytes(item.second);
+	}
+	return bytes;
+}
+
+
+
+void TemplateSketch::addStroke(StrokeId id, const Stroke& stroke)
+{
+	index.insert(id, stroke.extent());
+	strokes[id] = stroke;
+}
+
+void TemplateSketch::removeStroke(StrokeId id)
+{
+	index.remove(id);
+	strokes.erase(id);
+}
+
+void TemplateSketch::erase(const std::vector<QPointF>& eraser, qreal radius, UndoStep& step)
+{
+	if (eraser.empty())
+		return;
+	
+	QRectF eraser_rect;
+	for (auto const& point : eraser)
+		rectIncludeSafe(eraser_rect, point);
+	eraser_rect.adjust(-radius, -radius, radius, radius);
+	
+	auto ids = index.find(eraser_rect);
+	std::sort(begin(ids), end(ids));
+	
+	QRectF area;
+	std::vector<bool> erased_points;
+	std::vector<bool> erased_segments;
+	for (auto id : ids)
+	{
+		auto const& stroke = strokes.at(id);
+		auto const reach = radius + qreal(stroke.width) / 2;
+		auto const stroke_rect = stroke.extent().adjusted(-radius, -radius, radius, radius);
+		
+		// Only the eraser segments near the stroke need to be tested.
+		std::vector<std::size_t> eraser_segments;
+		for (std::size_t i = 0; i < eraser.size(); ++i)
+		{
+			auto const& next = eraser[std::min(i + 1, eraser.size() - 1)];
+			if (boundingRect(eraser[i], next).intersects(stroke_rect)
+			    || stroke_rect.contains(eraser[i]))
+				eraser_segments.push_back(i);
+		}
+		if (eraser_segments.empty())
+			continue;
+		
+		auto const& points = stroke.points;
+		auto const point_distance = [&](const QPointF& point) {
+			auto result = std::numeric_limits<qreal>::infinity();
+			for (auto i : eraser_segments)
+				result = std::min(result, distance(point, eraser[i], eraser[std::min(i + 1, eraser.size() - 1)]));
+			return result;
+		};
+		auto const segment_distance = [&](const QPointF& a, const QPointF& b) {
+			auto result = std::numeric_limits<qreal>::infinity();
+			for (auto i : eraser_segments)
+				result = std::min(result, distance(a, b, eraser[i], eraser[std::min(i + 1, eraser.size() - 1)]));
+			return result;
+		};
+		
+		erased_points.assign(points.size(), false);
+		erased_segments.assign(points.size(), false);
+		auto touched = false;
+		for (std::size_t i = 0; i < points.size(); ++i)
+		{
+			erased_points[i] = point_distance(points[i]) <= reach;
+			if (i + 1 < points.size())
+				erased_segments[i] = segment_distance(points[i], points[i + 1]) <= reach;
+			touched = touched || erased_points[i] || erased_segments[i];
+		}
+		if (!touched)
+			continue;
+		
+		// Split the stroke into the pieces which are not erased.
+		std::vector<Stroke> pieces;
+		for (std::size_t i = 0; i < points.size(); ++i)
+		{
+			if (erased_points[i])
+				continue;
+			if (i == 0 || erased_points[i - 1] || erased_segments[i - 1])
+				pieces.push_back({ {}, stroke.color, stroke.width });
+			pieces.back().points.push_back(points[i]);
+		}
+		
+		rectIncludeSafe(area, stroke.extent());
+		step.removed.emplace_back(id, stroke);
+		removeStroke(id);
+		for (auto& piece : pieces)
+		{
+			if (piece.points.size() < 2)
+				continue;
+			auto const piece_id = next_id++;
+			addStroke(piece_id, piece);
+			step.added.emplace_back(piece_id, std::move(piece));
+		}
+	}
+	
+	setAreaDirty(area);
+}
+
+void TemplateSketch::setAreaDirty(const QRectF& template_area)
+{
+	if (!template_area.isValid())
+		return;
+	
+	QRectF map_bbox;
+	rectIncludeSafe(map_bbox, templateToMap(template_area.topLeft()));
+	rectIncludeSafe(map_bbox, templateToMap(template_area.topRight()));
+	rectIncludeSafe(map_bbox, templateToMap(template_area.bottomLeft()));
+	rectIncludeSafe(map_bbox, templateToMap(template_area.bottomRight()));
+	map->setTemplateAreaDirty(this, map_bbox, 0);
+}
+
+
+}  // namespace OpenOrienteering
@@ -0,0 +1,162 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef OPENORIENTEERING_TEMPLATE_SKETCH_H
+#define OPENORIENTEERING_TEMPLATE_SKETCH_H
+
+#include <cstddef>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include <QtGlobal>
+#include <QObject>
+#include <QPointF>
+#include <QRectF>
+#include <QRgb>
+#include <QString>
+
+#include "core/spatial_index.h"
+#include "templates/template.h"
+
+class QByteArray;
+class QColor;
+class QPainter;
+
+namespace OpenOrienteering {
+
+class Map;
+class MapCoordF;
+
+
+/**
+ * A template for freehand sketches, stored as vector strokes.
+ *
+ * Painting onto this template adds polylines instead of changing pixels.
+ * Erasing removes the parts of the strokes which are touched by the eraser.
+ * The strokes are kept in a spatial index, so that drawing only visits the
+ * strokes in the visible area, and changes only affect the area of the
+ * changed strokes.
+ *
+ * Template coordinates are measured in the same units as the pixels of
+ * images from PaintOnTemplateSelectDialog, i.e. the template scale sets the
+ * size of a unit in mm. Stroke widths use the same units.
+ */
+class TemplateSketch : public Template
+{
+Q_OBJECT
+public:
+	/**
+	 * Returns the filename extensions supported by this template class.
+	 */
+	static const std::vector<QByteArray>& supportedExtensions();
+	
+	/**
+	 * Creates an empty sketch file at the given path.
+	 *
+	 * Returns false on error.
+	 */
+	static bool createFile(const QString& path);
+	
+	
+	TemplateSketch(const QString& path, Map* map);
+
+protected:
+	TemplateSketch(const TemplateSketch& proto);
+
+public:
+	~TemplateSketch() override;
+	
+	TemplateSketch* duplicate() const override;
+	
+	const char* getTemplateType() const override;
+	
+	bool isRasterGraphics() const override;
+	
+	
+	bool saveTemplateFile() const override;
+	
+	bool loadTemplateFileImpl(bool configuring) override;
+	
+	void unloadTemplateFileImpl() override;
+	
+	
+	void drawTemplate(QPainter* painter, const QRectF& clip_rect, double scale, bool on_screen, qreal opacity) const override;
+	
+	QRectF getTemplateExtent() const override;
+	
+	bool canBeDrawnOnto() const override;
+	
+	void drawOntoTemplateUndo(bool redo) override;
+	
+	std::size_t memoryUsage() const override;
+	
+	
+	/**
+	 * Returns the number of strokes.
+	 */
+	std::size_t strokeCount() const { return strokes.size(); }
+
+
+protected:
+	void drawOntoTemplateImpl(MapCoordF* coords, int num_coords, const QColor& color, qreal width) override;
+
+private:
+	/** A polyline in template coordinates. */
+	struct Stroke
+	{
+		std::vector<QPointF> points;
+		QRgb color;
+		float width;
+		
+		/** Returns the extent of the stroke, including the pen width. */
+		QRectF extent() const;
+	};
+	
+	using StrokeId = quint32;
+	
+	/** The strokes added and removed by a single paint or erase operation. */
+	struct UndoStep
+	{
+		std::vector<std::pair<StrokeId, Stroke>> added;
+		std::vector<std::pair<StrokeId, Stroke>> removed;
+	};
+	
+	void addStroke(StrokeId id, const Stroke& stroke);
+	void removeStroke(StrokeId id);
+	
+	void erase(const std::vector<QPointF>& eraser, qreal radius, UndoStep& step);
+	
+	void setAreaDirty(const QRectF& template_area);
+	
+	/** Strokes ordered by id, i.e. in drawing order. */
+	std::map<StrokeId, Stroke> strokes;
+	SpatialIndex<StrokeId> index;
+	StrokeId next_id = 0;
+	
+	std::vector<UndoStep> undo_steps;
+	std::size_t undo_index = 0;
+	
+};
+
+
+}  // namespace OpenOrienteering
+
+#endif
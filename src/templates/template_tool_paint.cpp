@@ -31,10 +31,8 @@
 #include <QCursor>
 #include <QDir>
 #include <QFileInfo>
-#include <QFontMetrics>
 #include <QHBoxLayout>
 #include <QIcon>
-#include <QImage>
 #include <QLatin1Char>
 #include <QLatin1String>
 #include <QListWidget>
@@ -61,7 +59,7 @@
 #include "gui/map/map_editor.h"
 #include "gui/map/map_widget.h"
 #include "templates/template.h"
-#include "templates/template_image.h"
+#include "templates/template_sketch.h"
 #include "util/util.h"
 
 
@@ -530,11 +528,10 @@ Template* PaintOnTemplateSelectDialog::addNewTemplate() const
 #endif
 	};
 	
-	// 1000 pixel, 10 pixel per mm, 100 mm per image
+	// 10 units per mm, 100 mm per sketch
 	// When these parameters are changed, alignmentBase() needs to be reviewed.
-	constexpr auto pixel_per_mm = 10;
+	constexpr auto units_per_mm = 10;
 	constexpr auto size_mm      = 100;  // multiple of 2
-	constexpr auto size_pixel   = size_mm * pixel_per_mm;
 	
 	// Determine aligned top-left position
 	auto top_left = view->center() - MapCoord{size_mm/2, size_mm/2};
@@ -549,34 +546,26 @@ Template* PaintOnTemplateSelectDialog::addNewTemplate() const
 	                          + QString::number(qRound64(projected_top_left.x()))
 	                          + QLatin1Char(',')
 			                  + QString::number(qRound64(projected_top_left.y()))
-	                          + QLatin1String(".png");
-	QString image_file_path = QFileInfo(window->currentPath()).absoluteDir().canonicalPath()
+	                          + QLatin1String(".sketch");
+	QString sketch_file_path = QFileInfo(window->currentPath()).absoluteDir().canonicalPath()
 	                          + QLatin1Char('/')
 	                          + filename;
-	if (QFileInfo::exists(image_file_path))
+	if (QFileInfo::exists(sketch_file_path))
 	{
 		show_message(tr("Template file exists: '%1'").arg(filename));
 		return nullptr;
 	}
 	
-	auto image = QImage(size_pixel, size_pixel, QImage::Format_ARGB32);
-	image.fill(QColor(Qt::transparent));
-	QPainter p(&image);
-	p.setPen(QColor(Qt::red));
-	p.drawRect(0, 0, size_pixel-1, size_pixel-1);
-	p.drawText(pixel_per_mm/2, pixel_per_mm/2 + QFontMetrics(p.font()).ascent(),
-	           QFileInfo(image_file_path).fileName());
-	p.end();
-	if (!image.save(image_file_path))
+	if (!TemplateSketch::createFile(sketch_file_path))
 	{
 		show_message(OpenOrienteering::Map::tr("Cannot save file\n%1:\n%2").arg(filename, QString{}));
 		return nullptr;
 	}
 	
-	auto temp = new TemplateImage{image_file_path, map};
+	auto temp = new TemplateSketch{sketch_file_path, map};
 	temp->setTemplatePosition(MapCoord{top_left + MapCoordF{size_mm/2, size_mm/2}});
-	temp->setTemplateScaleX(1.0/pixel_per_mm);
-	temp->setTemplateScaleY(1.0/pixel_per_mm);
+	temp->setTemplateScaleX(1.0/units_per_mm);
+	temp->setTemplateScaleY(1.0/units_per_mm);
 	temp->setTemplateShear(0);
 	temp->setTemplateRotation(0);
 	temp->loadTemplateFile(false);
@@ -21,6 +21,9 @@
 
 #include "template_track.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
 #include <utility>
 
 #include <Qt>
@@ -35,11 +38,11 @@
 #include <QLatin1String>
 #include <QMessageBox>
 #include <QPainter>
-#include <QPainterPath>
 #include <QPen>
 #include <QRect>
 #include <QRgb>
 #include <QStringRef>
+#include <QTransform>
 #include <QXmlStreamReader>
 #include <QXmlStreamWriter>
 
@@ -127,6 +130,73 @@ PathObject* importPath(Map& map, const Symbol& symbol, MapCoordVector coords)
 	return path;
 }
 
+/// The maximum number of points in a TemplateTrack::TrackChunk.
+constexpr std::size_t track_chunk_size = 256;
+
+/// The maximum number of simplification levels in the cache.
+constexpr std::size_t max_simplified_levels = 4;
+
+/**
+ * Simplifies a polyline with the Douglas-Peucker algorithm.
+ * 
+ * The first and last point are always kept.
+ */
+std::vector<QPointF> simplify(const std::vector<QPointF>& points, qreal tolerance)
+{
+	if (points.size() < 3)
+		return points;
+	
+	std::vector<bool> keep(points.size(), false);
+	keep.front() = true;
+	keep.back() = true;
+	
+	auto const tolerance_squared = tolerance * tolerance;
+	std::vector<std::pair<std::size_t, std::size_t>> ranges = { { 0, points.size() - 1 } };
+	while (!ranges.empty())
+	{
+		auto const first = ranges.back().first;
+		auto const last = ranges.back().second;
+		ranges.pop_back();
+		
+		auto const& a = points[first];
+		auto const ab = points[last] - a;
+		auto const length_squared = QPointF::dotProduct(ab, ab);
+		auto max_distance_squared = qreal(0);
+		auto max_index = first;
+		for (auto i = first + 1; i < last; ++i)
+		{
+			auto const ap = points[i] - a;
+			auto distance_squared = QPointF::dotProduct(ap, ap);
+			if (length_squared > 0)
+			{
+				auto const cross = ab.x() * ap.y() - ab.y() * ap.x();
+				distance_squared = cross * cross / length_squared;
+			}
+			if (distance_squared > max_distance_squared)
+			{
+				max_distance_squared = distance_squared;
+				max_index = i;
+			}
+		}
+		if (max_distance_squared > tolerance_squared)
+		{
+			keep[max_index] = true;
+			if (max_index - first > 1)
+				ranges.emplace_back(first, max_index);
+			if (last - max_index > 1)
+				ranges.emplace_back(max_index, last);
+		}
+	}
+	
+	std::vector<QPointF> result;
+	for (std::size_t i = 0; i < points.size(); ++i)
+	{
+		if (keep[i])
+			result.push_back(points[i]);
+	}
+	return result;
+}
+
 PointObject* importPoint(Map& map, const Symbol& symbol, const MapCoordF& position, const QString& name)
 {
 	auto* point = new PointObject(&symbol);
@@ -180,6 +250,10 @@ TemplateTrack::~TemplateTrack()
 {
 	if (template_state == Loaded)
 		unloadTemplateFile();
+	
+	// Recovery is only needed after abnormal termination.
+	if (journal)
+		journal->remove();
 }
 
 
@@ -241,7 +315,13 @@ bool TemplateTrack::loadTypeSpecificTemplateConfiguration(QXmlStreamReader& xml)
 
 bool TemplateTrack::saveTemplateFile() const
 {
-    return track.saveTo(template_path);
+	if (!track.saveTo(template_path))
+		return false;
+	
+	// The journal's points are saved now.
+	if (journal)
+		journal->remove();
+	return true;
 }
 
 bool TemplateTrack::loadTemplateFileImpl(bool configuring)
@@ -260,6 +340,7 @@ bool TemplateTrack::loadTemplateFileImpl(bool configuring)
 	
 	if (!track.loadFrom(template_path, false))
 		return false;
+	recoverJournal();
 	
 	if (!configuring)
 	{
@@ -273,6 +354,7 @@ bool TemplateTrack::loadTemplateFileImpl(bool configuring)
 		{
 			projected_crs_spec.clear();
 			track.changeMapGeoreferencing(map->getGeoreferencing());
+			invalidateTrackCache();
 		}
 	}
 	
@@ -332,6 +414,7 @@ bool TemplateTrack::postLoadConfiguration(QWidget* dialog_parent, bool& /*out_ce
 	{
 		projected_crs_spec.clear();
 		track.changeMapGeoreferencing(map->getGeoreferencing());
+		invalidateTrackCache();
 	}
 	
 	return true;
@@ -340,22 +423,35 @@ bool TemplateTrack::postLoadConfiguration(QWidget* dialog_parent, bool& /*out_ce
 void TemplateTrack::unloadTemplateFileImpl()
 {
 	track.clear();
+	invalidateTrackCache();
 }
 
-void TemplateTrack::drawTemplate(QPainter* painter, const QRectF& /*clip_rect*/, double /*scale*/, bool on_screen, qreal opacity) const
+void TemplateTrack::drawTemplate(QPainter* painter, const QRectF& clip_rect, double /*scale*/, bool on_screen, qreal opacity) const
 {
 	painter->save();
 	painter->setOpacity(opacity);
-	drawTracks(painter, on_screen);
+	drawTracks(painter, clip_rect, on_screen);
 	drawWaypoints(painter);
 	painter->restore();
 }
 
-void TemplateTrack::drawTracks(QPainter* painter, bool on_screen) const
+void TemplateTrack::drawTracks(QPainter* painter, const QRectF& clip_rect, bool on_screen) const
 {
+	updateTrackCache();
+	if (track_chunks.empty())
+		return;
+	
 	painter->save();
+	auto track_clip_rect = clip_rect;
 	if (!is_georeferenced)
+	{
 		applyTemplateTransform(painter);
+		track_clip_rect = QRectF();
+		rectIncludeSafe(track_clip_rect, mapToTemplate(MapCoordF(clip_rect.topLeft())));
+		rectIncludeSafe(track_clip_rect, mapToTemplate(MapCoordF(clip_rect.topRight())));
+		rectIncludeSafe(track_clip_rect, mapToTemplate(MapCoordF(clip_rect.bottomLeft())));
+		rectIncludeSafe(track_clip_rect, mapToTemplate(MapCoordF(clip_rect.bottomRight())));
+	}
 	
 	// Tracks
 	QPen pen(qRgb(212, 0, 244));
@@ -366,26 +462,131 @@ void TemplateTrack::drawTracks(QPainter* painter, bool on_screen) const
 	painter->setPen(pen);
 	painter->setBrush(Qt::NoBrush);
 	
-	// TODO: could speed that up by storing the template coords of the GPS points in a separate vector or caching the painter paths
-	for (int i = 0; i < track.getNumSegments(); ++i)
+	// On screen, details below half a pixel are not visible. The tolerance
+	// is rounded down to a power of two, so that the levels can be cached.
+	std::vector<std::vector<QPointF>>* simplified = nullptr;
+	auto level = 0;
+	auto const pixel_size = 1 / std::sqrt(std::abs(painter->worldTransform().determinant()));
+	if (on_screen && std::isfinite(pixel_size))
 	{
-		QPainterPath path;
-		int size = track.getSegmentPointCount(i);
-		for (int k = 0; k < size; ++k)
+		level = int(std::floor(std::log2(pixel_size / 2)));
+		auto cached = simplified_chunks.find(level);
+		if (cached == simplified_chunks.end())
 		{
-			const TrackPoint& point = track.getSegmentPoint(i, k);
-			
-			if (k > 0)
-				path.lineTo(point.map_coord.x(), point.map_coord.y());
-			else
-				path.moveTo(point.map_coord.x(), point.map_coord.y());
+			if (simplified_chunks.size() >= max_simplified_levels)
+			{
+				// Drop the level which is most different from the current one.
+				auto const& front = *simplified_chunks.begin();
+				auto const& back = *simplified_chunks.rbegin();
+				simplified_chunks.erase(level - front.first > back.first - level ? front.first : back.first);
+			}
+			cached = simplified_chunks.emplace(level, std::vector<std::vector<QPointF>>(track_chunks.size())).first;
+		}
+		simplified = &cached->second;
+	}
+	
+	for (std::size_t i = 0; i < track_chunks.size(); ++i)
+	{
+		auto const& chunk = track_chunks[i];
+		// Inclusive test, for horizontal and vertical chunks
+		if (chunk.extent.left() > track_clip_rect.right() || chunk.extent.right() < track_clip_rect.left()
+		    || chunk.extent.top() > track_clip_rect.bottom() || chunk.extent.bottom() < track_clip_rect.top())
+			continue;
+		
+		auto const* points = &chunk.points;
+		if (simplified)
+		{
+			auto& simplified_points = (*simplified)[i];
+			if (simplified_points.empty())
+				simplified_points = simplify(chunk.points, std::ldexp(1.0, level));
+			points = &simplified_points;
 		}
-		painter->drawPath(path);
+		painter->drawPolyline(points->data(), int(points->size()));
 	}
 	
 	painter->restore();
 }
 
+void TemplateTrack::invalidateTrackCache()
+{
+	track_chunks.clear();
+	simplified_chunks.clear();
+	cached_num_segments = -1;
+	cached_num_points = -1;
+	cached_last_segment_size = 0;
+}
+
+void TemplateTrack::updateTrackCache() const
+{
+	// Recording a GPS track modifies the track via getTrack().
+	// Such changes are detected by the number of points.
+	auto const num_segments = track.getNumSegments();
+	auto num_points = qint64(0);
+	auto num_points_before_last = qint64(0);
+	for (int i = 0; i < num_segments; ++i)
+	{
+		if (i == cached_num_segments - 1)
+			num_points_before_last = num_points;
+		num_points += track.getSegmentPointCount(i);
+	}
+	if (num_segments == cached_num_segments && num_points == cached_num_points)
+		return;
+	
+	// When points were only appended, e.g. while recording, only the
+	// chunks from the last chunk of the previous state need to be built.
+	auto const appended = !track_chunks.empty()
+	                      && num_segments >= cached_num_segments
+	                      && num_points_before_last == cached_num_points - cached_last_segment_size
+	                      && track.getSegmentPointCount(cached_num_segments - 1) >= cached_last_segment_size;
+	if (appended)
+	{
+		auto const restart = track_chunks.back();
+		track_chunks.pop_back();
+		for (auto& level : simplified_chunks)
+			level.second.resize(track_chunks.size());
+		
+		appendTrackChunks(restart.segment, restart.first);
+		for (int i = restart.segment + 1; i < num_segments; ++i)
+			appendTrackChunks(i, 0);
+		
+		for (auto& level : simplified_chunks)
+			level.second.resize(track_chunks.size());
+	}
+	else
+	{
+		track_chunks.clear();
+		simplified_chunks.clear();
+		for (int i = 0; i < num_segments; ++i)
+			appendTrackChunks(i, 0);
+	}
+	cached_num_segments = num_segments;
+	cached_num_points = num_points;
+	cached_last_segment_size = num_segments > 0 ? track.getSegmentPointCount(num_segments - 1) : 0;
+}
+
+void TemplateTrack::appendTrackChunks(int segment, int first) const
+{
+	auto const size = track.getSegmentPointCount(segment);
+	for (int k = first; k < size; )
+	{
+		// Consecutive chunks share a point, for continuous polylines.
+		TrackChunk chunk;
+		chunk.segment = segment;
+		chunk.first = k;
+		auto const last = std::min(size, k + int(track_chunk_size));
+		chunk.points.reserve(std::size_t(last - k + 1));
+		if (k > 0)
+			chunk.points.push_back(track.getSegmentPoint(segment, k - 1).map_coord);
+		for (; k < last; ++k)
+			chunk.points.push_back(track.getSegmentPoint(segment, k).map_coord);
+		if (chunk.points.size() == 1)
+			chunk.points.push_back(chunk.points.front());
+		for (auto const& point : chunk.points)
+			rectIncludeSafe(chunk.extent, point);
+		track_chunks.push_back(std::move(chunk));
+	}
+}
+
 void TemplateTrack::drawWaypoints(QPainter* painter) const
 {
 	painter->save();
@@ -580,16 +781,65 @@ void TemplateTrack::configureForGPSTrack()
 	
 	projected_crs_spec.clear();
 	track.changeMapGeoreferencing(map->getGeoreferencing());
+	recoverJournal();
+	invalidateTrackCache();
 	
 	template_state = Template::Loaded;
 }
 
+void TemplateTrack::appendRecordedPoint(const TrackPoint& point)
+{
+	track.appendTrackPoint(point);
+	if (!journal)
+		journal = std::make_unique<TrackJournal>(template_path);
+	journal->append(point);
+	
+	// The new point and the line from the previous point
+	auto const segment = track.getNumSegments() - 1;
+	auto const size = track.getSegmentPointCount(segment);
+	for (auto i = std::max(0, size - 2); i < size; ++i)
+	{
+		auto const& coord = track.getSegmentPoint(segment, i).map_coord;
+		rectIncludeSafe(recorded_area, is_georeferenced ? coord : templateToMap(coord));
+	}
+	setHasUnsavedChanges(true);
+}
+
+void TemplateTrack::finishRecordedSegment()
+{
+	track.finishCurrentSegment();
+	if (!journal)
+		journal = std::make_unique<TrackJournal>(template_path);
+	journal->finishCurrentSegment();
+	setHasUnsavedChanges(true);
+}
+
+void TemplateTrack::setRecordedAreaDirty()
+{
+	if (recorded_area.isValid())
+	{
+		map->setTemplateAreaDirty(this, recorded_area, 1);
+		recorded_area = {};
+	}
+}
+
+void TemplateTrack::recoverJournal()
+{
+	if (TrackJournal::recover(template_path, track) > 0)
+	{
+		if (!journal)
+			journal = std::make_unique<TrackJournal>(template_path);
+		setHasUnsavedChanges(true);
+	}
+}
+
 void TemplateTrack::updateGeoreferencing()
 {
 	if (is_georeferenced && template_state == Template::Loaded)
 	{
 		projected_crs_spec.clear();
 		track.changeMapGeoreferencing(map->getGeoreferencing());
+		invalidateTrackCache();
 		map->updateAllMapWidgets();
 	}
 }
@@ -610,6 +860,7 @@ void TemplateTrack::applyProjectedCrsSpec()
 	georef.setProjectedCRS(QString{}, projected_crs_spec);
 	georef.setProjectedRefPoint({});
 	track.changeMapGeoreferencing(georef);
+	invalidateTrackCache();
 }
 
 
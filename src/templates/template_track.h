@@ -22,11 +22,13 @@
 #ifndef OPENORIENTEERING_TEMPLATE_TRACK_H
 #define OPENORIENTEERING_TEMPLATE_TRACK_H
 
+#include <map>
 #include <memory>
 #include <vector>
 
 #include <QtGlobal>
 #include <QObject>
+#include <QPointF>
 #include <QRectF>
 #include <QString>
 
@@ -86,8 +88,9 @@ public:
 	
 	bool hasAlpha() const override;
 	
-	/// Draws all tracks.
-	void drawTracks(QPainter* painter, bool on_screen) const;
+	/// Draws the tracks which intersect the clip rect (in map coordinates).
+	/// On screen, the tracks are simplified according to the painter's resolution.
+	void drawTracks(QPainter* painter, const QRectF& clip_rect, bool on_screen) const;
 	
 	/// Draws all waypoints.
 	void drawWaypoints(QPainter* painter) const;
@@ -103,6 +106,20 @@ public:
 	/// Returns the Track data object.
 	inline Track& getTrack() {return track;}
 	
+	/**
+	 * Appends a recorded point to the track.
+	 * 
+	 * The point is also written to the track's journal, so that it can be
+	 * recovered if the program terminates before the track is saved.
+	 */
+	void appendRecordedPoint(const TrackPoint& point);
+	
+	/// Finishes the current segment of the recorded track.
+	void finishRecordedSegment();
+	
+	/// Marks the area of the points recorded since the last call as dirty.
+	void setRecordedAreaDirty();
+	
 public slots:
 	void updateGeoreferencing();
 	
@@ -115,12 +132,44 @@ protected:
 	
 	void applyProjectedCrsSpec();
 	
+	/// Discards the cached track polylines.
+	void invalidateTrackCache();
+	
+	/// Rebuilds the cached track polylines if the track has changed.
+	void updateTrackCache() const;
+	
+	/// Appends the chunks for the given segment, starting at the given point.
+	void appendTrackChunks(int segment, int first) const;
+	
+	/// Appends the points from the journal after loading the track.
+	void recoverJournal();
+	
 private:
+	/// A part of a track segment, for culling and simplification.
+	struct TrackChunk
+	{
+		QRectF extent;
+		std::vector<QPointF> points;
+		int segment;  ///< The index of the segment.
+		int first;    ///< The index of the first point in the segment, excluding the shared point.
+	};
+	
 	Track track;
 	QString track_crs_spec;
 	QString projected_crs_spec;
 	friend class OgrTemplate; // for migration
 	std::unique_ptr<Georeferencing> preserved_georef;
+	
+	mutable std::vector<TrackChunk> track_chunks;
+	/// Simplified points for each chunk, by level of simplification.
+	/// An empty vector means that the chunk is not simplified yet.
+	mutable std::map<int, std::vector<std::vector<QPointF>>> simplified_chunks;
+	mutable int cached_num_segments = -1;
+	mutable qint64 cached_num_points = -1;
+	mutable int cached_last_segment_size = 0;
+	
+	mutable std::unique_ptr<TrackJournal> journal;
+	QRectF recorded_area;
 };
 
 
@@ -0,0 +1,548 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#include "template_web_tiles.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+#include <Qt>
+#include <QByteArray>
+#include <QCoreApplication>
+#include <QIODevice>
+#include <QLatin1String>
+#include <QMutexLocker>
+#include <QNetworkAccessManager>
+#include <QNetworkDiskCache>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QPainter>
+#include <QPointF>
+#include <QPolygonF>
+#include <QSettings>
+#include <QStandardPaths>
+#include <QThread>
+#include <QTransform>
+#include <QtMath>
+#include <QUrl>
+#include <QVariant>
+
+#include "core/georeferencing.h"
+#include "core/latlon.h"
+#include "core/map.h"
+#include "core/map_coord.h"
+#include "util/util.h"
+
+
+namespace OpenOrienteering {
+
+namespace {
+
+/** The size of the tiles, in pixels. */
+constexpr int tile_size = 256;
+
+/** The highest supported zoom level. */
+constexpr int max_tile_zoom = 24;
+
+/** The highest latitude covered by Web Mercator tiles. */
+constexpr double max_latitude = 85.0511287798;
+
+/** The equatorial circumference of the Web Mercator sphere, in meters. */
+constexpr double earth_circumference = 40075016.686;
+
+/** The maximum number of tiles drawn in a single call. */
+constexpr int max_drawn_tiles = 256;
+
+/** The maximum number of pending requests per template. */
+constexpr int max_pending_requests = 64;
+
+/** The size of the memory cache per template, in KiB. */
+constexpr int memory_cache_size = 64 * 1024;
+
+/** The size of the shared disk cache, in bytes. */
+constexpr qint64 disk_cache_size = 512 * 1024 * 1024;
+
+
+/** Returns the cost of an image in the memory cache. */
+int cacheCost(const QImage& image)
+{
+	return std::max(1, image.bytesPerLine() * image.height() / 1024);
+}
+
+
+double tileX(double longitude, int zoom)
+{
+	return (longitude + 180) / 360 * (1 << zoom);
+}
+
+double tileY(double latitude, int zoom)
+{
+	auto const phi = qDegreesToRadians(latitude);
+	return (1 - std::log(std::tan(phi) + 1 / std::cos(phi)) / M_PI) / 2 * (1 << zoom);
+}
+
+LatLon tileCorner(int zoom, int x, int y)
+{
+	auto const n = double(1 << zoom);
+	auto const longitude = x / n * 360 - 180;
+	auto const latitude = qRadiansToDegrees(std::atan(std::sinh(M_PI * (1 - 2 * y / n))));
+	return { latitude, longitude };
+}
+
+
+/**
+ * Returns the network access manager for all tile templates.
+ * 
+ * It uses a persistent disk cache, so that tiles remain available offline.
+ */
+QNetworkAccessManager* tileNetwork()
+{
+	static QNetworkAccessManager* network = nullptr;
+	if (!network)
+	{
+		network = new QNetworkAccessManager(QCoreApplication::instance());
+		auto cache = new QNetworkDiskCache(network);
+		cache->setCacheDirectory(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QLatin1String("/tiles"));
+		cache->setMaximumCacheSize(disk_cache_size);
+		network->setCache(cache);
+	}
+	return network;
+}
+
+QByteArray userAgent()
+{
+	return QCoreApplication::applicationName().toUtf8() + '/' + QCoreApplication::applicationVersion().toUtf8();
+}
+
+
+}  // namespace
+
+
+
+// ### TemplateWebTiles ###
+
+const std::vector<QByteArray>& TemplateWebTiles::supportedExtensions()
+{
+	static std::vector<QByteArray> extensions = { "tiles" };
+	return extensions;
+}
+
+// static
+bool TemplateWebTiles::createFile(const QString& path, const QString& url_pattern, int min_zoom, int max_zoom)
+{
+	QSettings settings(path, QSettings::IniFormat);
+	settings.beginGroup(QStringLiteral("Tiles"));
+	settings.setValue(QStringLiteral("url"), url_pattern);
+	settings.setValue(QStringLiteral("min_zoom"), min_zoom);
+	settings.setValue(QStringLiteral("max_zoom"), max_zoom);
+	settings.endGroup();
+	settings.sync();
+	return settings.status() == QSettings::NoError;
+}
+
+// static
+QString TemplateWebTiles::tileUrl(const QString& url_pattern, int zoom, int x, int y)
+{
+	auto url = url_pattern;
+	url.replace(QLatin1String("{z}"), QString::number(zoom));
+	url.replace(QLatin1String("{x}"), QString::number(x));
+	url.replace(QLatin1String("{y}"), QString::number(y));
+	url.replace(QLatin1String("{-y}"), QString::number((1 << zoom) - 1 - y));
+	url.replace(QLatin1String("{TileMatrix}"), QString::number(zoom));
+	url.replace(QLatin1String("{TileCol}"), QString::number(x));
+	url.replace(QLatin1String("{TileRow}"), QString::number(y));
+	return url;
+}
+
+
+TemplateWebTiles::TemplateWebTiles(const QString& path, Map* map)
+: Template(path, map)
+{
+	is_georeferenced = true;
+	
+	const Georeferencing& georef = map->getGeoreferencing();
+	connect(&georef, &Georeferencing::projectionChanged, this, &TemplateWebTiles::updateGeoreferencing);
+	connect(&georef, &Georeferencing::transformationChanged, this, &TemplateWebTiles::updateGeoreferencing);
+	connect(&georef, &Georeferencing::stateChanged, this, &TemplateWebTiles::updateGeoreferencing);
+	connect(&georef, &Georeferencing::declinationChanged, this, &TemplateWebTiles::updateGeoreferencing);
+}
+
+TemplateWebTiles::TemplateWebTiles(const TemplateWebTiles& proto)
+: Template(proto)
+, url_pattern(proto.url_pattern)
+, attribution_text(proto.attribution_text)
+, min_zoom(proto.min_zoom)
+, max_zoom(proto.max_zoom)
+{
+	tiles.setMaxCost(memory_cache_size);
+	
+	const Georeferencing& georef = map->getGeoreferencing();
+	connect(&georef, &Georeferencing::projectionChanged, this, &TemplateWebTiles::updateGeoreferencing);
+	connect(&georef, &Georeferencing::transformationChanged, this, &TemplateWebTiles::updateGeoreferencing);
+	connect(&georef, &Georeferencing::stateChanged, this, &TemplateWebTiles::updateGeoreferencing);
+	connect(&georef, &Georeferencing::declinationChanged, this, &TemplateWebTiles::updateGeoreferencing);
+}
+
+TemplateWebTiles::~TemplateWebTiles()
+{
+	if (template_state == Loaded)
+		unloadTemplateFile();
+	abortRequests();
+}
+
+TemplateWebTiles* TemplateWebTiles::duplicate() const
+{
+	return new TemplateWebTiles(*this);
+}
+
+const char* TemplateWebTiles::getTemplateType() const
+{
+	return "TemplateWebTiles";
+}
+
+bool TemplateWebTiles::isRasterGraphics() const
+{
+	return true;
+}
+
+
+
+bool TemplateWebTiles::preLoadConfiguration(QWidget* /*dialog_parent*/)
+{
+	is_georeferenced = true;
+	return true;
+}
+
+bool TemplateWebTiles::loadTemplateFileImpl(bool /*configuring*/)
+{
+	QSettings settings(template_path, QSettings::IniFormat);
+	settings.beginGroup(QStringLiteral("Tiles"));
+	url_pattern = settings.value(QStringLiteral("url")).toString();
+	min_zoom = qBound(0, settings.value(QStringLiteral("min_zoom"), 0).toInt(), max_tile_zoom);
+	max_zoom = qBound(min_zoom, settings.value(QStringLiteral("max_zoom"), 19).toInt(), max_tile_zoom);
+	attribution_text = settings.value(QStringLiteral("attribution")).toString();
+	settings.endGroup();
+	if (settings.status() != QSettings::NoError || url_pattern.isEmpty())
+	{
+		url_pattern.clear();
+		setErrorString(tr("Not a tile service definition."));
+		return false;
+	}
+	
+	const auto& georef = map->getGeoreferencing();
+	if (!georef.isValid() || georef.isLocal())
+	{
+		setErrorString(tr("Online tiles can only be shown in a georeferenced map."));
+		return false;
+	}
+	
+	tiles.setMaxCost(memory_cache_size);
+	return true;
+}
+
+void TemplateWebTiles::unloadTemplateFileImpl()
+{
+	abortRequests();
+	failed.clear();
+	QMutexLocker lock(&tiles_mutex);
+	tiles.clear();
+}
+
+
+
+void TemplateWebTiles::drawTemplate(QPainter* painter, const QRectF& clip_rect, double /*scale*/, bool on_screen, qreal opacity) const
+{
+	const auto& georef = map->getGeoreferencing();
+	if (url_pattern.isEmpty() || !georef.isValid() || georef.isLocal())
+		return;
+	
+	// The geographic extent of the clip rect, sampled at corners and edges
+	std::vector<MapCoordF> samples;
+	samples.reserve(9);
+	for (int i = 0; i <= 2; ++i)
+	{
+		for (int j = 0; j <= 2; ++j)
+			samples.emplace_back(clip_rect.left() + i * clip_rect.width() / 2, clip_rect.top() + j * clip_rect.height() / 2);
+	}
+	bool ok = true;
+	auto const lat_lon = georef.toGeographicCoords(samples, &ok);
+	if (!ok)
+		return;
+	
+	auto const lat_range = std::minmax_element(begin(lat_lon), end(lat_lon), [](const LatLon& a, const LatLon& b) {
+		return a.latitude() < b.latitude();
+	});
+	auto const lon_range = std::minmax_element(begin(lat_lon), end(lat_lon), [](const LatLon& a, const LatLon& b) {
+		return a.longitude() < b.longitude();
+	});
+	auto const north = qBound(-max_latitude, lat_range.second->latitude(), max_latitude);
+	auto const south = qBound(-max_latitude, lat_range.first->latitude(), max_latitude);
+	auto const west = qBound(-180.0, lon_range.first->longitude(), 180.0);
+	auto const east = qBound(-180.0, lon_range.second->longitude(), 180.0);
+	
+	auto zoom = zoomLevel(painter, (north + south) / 2);
+	int x0 = 0, x1 = 0, y0 = 0, y1 = 0;
+	auto const tile_range = [&]() {
+		auto const last = (1 << zoom) - 1;
+		x0 = qBound(0, int(std::floor(tileX(west, zoom))), last);
+		x1 = qBound(0, int(std::floor(tileX(east, zoom))), last);
+		y0 = qBound(0, int(std::floor(tileY(north, zoom))), last);
+		y1 = qBound(0, int(std::floor(tileY(south, zoom))), last);
+		return (x1 - x0 + 1) * (y1 - y0 + 1);
+	};
+	while (tile_range() > max_drawn_tiles && zoom > min_zoom)
+		--zoom;
+	
+	// The corners of all tiles, reprojected in a single batch
+	auto const columns = x1 - x0 + 2;
+	auto const rows = y1 - y0 + 2;
+	std::vector<LatLon> corners;
+	corners.reserve(std::size_t(columns * rows));
+	for (int y = y0; y <= y1 + 1; ++y)
+	{
+		for (int x = x0; x <= x1 + 1; ++x)
+			corners.push_back(tileCorner(zoom, x, y));
+	}
+	auto const map_corners = georef.toMapCoordF(corners, &ok);
+	if (!ok)
+		return;
+	auto const corner = [&](int x, int y) {
+		return QPointF(map_corners[std::size_t((y - y0) * columns + (x - x0))]);
+	};
+	
+	// Network requests are only made for the screen, and from the thread
+	// which owns this object.
+	auto const can_fetch = on_screen && QThread::currentThread() == thread();
+	auto const can_read_cache = QThread::currentThread() == thread();
+	
+	painter->save();
+	painter->setOpacity(opacity);
+	painter->setRenderHint(QPainter::SmoothPixmapTransform);
+	auto const map_transform = painter->worldTransform();
+	for (int y = y0; y <= y1; ++y)
+	{
+		for (int x = x0; x <= x1; ++x)
+		{
+			auto source_zoom = zoom;
+			auto source_x = x;
+			auto source_y = y;
+			auto image = memoryTile(source_zoom, source_x, source_y, min_zoom);
+			if (image.isNull() || source_zoom != zoom)
+			{
+				if (can_fetch)
+				{
+					fetchTile(zoom, x, y, false);
+				}
+				else if (can_read_cache)
+				{
+					auto cached = cachedTile(zoom, x, y);
+					if (!cached.isNull())
+					{
+						image = cached;
+						source_zoom = zoom;
+						source_x = x;
+						source_y = y;
+					}
+				}
+			}
+			if (image.isNull())
+				continue;
+			
+			// The part of the (ancestor) image which covers this tile
+			auto const levels = zoom - source_zoom;
+			auto const size = qreal(image.width()) / (1 << levels);
+			auto const source = QRectF((x - (source_x << levels)) * size, (y - (source_y << levels)) * size, size, size);
+			
+			QPolygonF source_quad;
+			source_quad << source.topLeft() << source.topRight() << source.bottomRight() << source.bottomLeft();
+			QPolygonF quad;
+			quad << corner(x, y) << corner(x + 1, y) << corner(x + 1, y + 1) << corner(x, y + 1);
+			QTransform transform;
+			if (!QTransform::quadToQuad(source_quad, quad, transform))
+				continue;
+			painter->setWorldTransform(transform * map_transform);
+			painter->drawImage(source, image, source);
+		}
+	}
+	painter->restore();
+	
+	if (can_fetch)
+	{
+		// Prefetch a ring of tiles around the visible tiles.
+		auto const last = (1 << zoom) - 1;
+		for (int y = std::max(0, y0 - 1); y <= std::min(last, y1 + 1); ++y)
+		{
+			for (int x = std::max(0, x0 - 1); x <= std::min(last, x1 + 1); ++x)
+			{
+				if (x >= x0 && x <= x1 && y >= y0 && y <= y1)
+					continue;
+				auto source_zoom = zoom;
+				auto source_x = x;
+				auto source_y = y;
+				if (memoryTile(source_zoom, source_x, source_y, zoom).isNull())
+					fetchTile(zoom, x, y, true);
+			}
+		}
+	}
+}
+
+QRectF TemplateWebTiles::calculateTemplateBoundingBox() const
+{
+	return infiniteRectF();
+}
+
+std::size_t TemplateWebTiles::memoryUsage() const
+{
+	QMutexLocker lock(&tiles_mutex);
+	return std::size_t(tiles.totalCost()) * 1024;
+}
+
+
+
+void TemplateWebTiles::updateGeoreferencing()
+{
+	if (template_state == Loaded)
+		setTemplateAreaDirty();
+}
+
+
+
+// static
+TemplateWebTiles::TileKey TemplateWebTiles::tileKey(int zoom, int x, int y)
+{
+	return (TileKey(zoom) << 48) | (TileKey(x) << 24) | TileKey(y);
+}
+
+int TemplateWebTiles::zoomLevel(const QPainter* painter, double latitude) const
+{
+	// The painter uses map coordinates, i.e. millimeters on paper.
+	auto const pixels_per_mm = std::sqrt(std::abs(painter->deviceTransform().determinant()));
+	if (pixels_per_mm <= 0)
+		return min_zoom;
+	
+	auto const meters_per_pixel = map->getGeoreferencing().getScaleDenominator() / 1000.0 / pixels_per_mm;
+	auto const tile_meters_per_pixel = earth_circumference * std::cos(qDegreesToRadians(latitude)) / tile_size;
+	auto const zoom = int(std::lround(std::log2(tile_meters_per_pixel / meters_per_pixel)));
+	return qBound(min_zoom, zoom, max_zoom);
+}
+
+void TemplateWebTiles::fetchTile(int zoom, int x, int y, bool prefetch) const
+{
+	auto const key = tileKey(zoom, x, y);
+	if (pending.contains(key) || failed.contains(key) || pending.size() >= max_pending_requests)
+		return;
+	
+	QNetworkRequest request(QUrl(tileUrl(url_pattern, zoom, x, y)));
+	request.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::PreferCache);
+#if QT_VERSION >= QT_VERSION_CHECK(5, 6, 0)
+	request.setAttribute(QNetworkRequest::FollowRedirectsAttribute, true);
+#endif
+	request.setPriority(prefetch ? QNetworkRequest::LowPriority : QNetworkRequest::NormalPriority);
+	request.setHeader(QNetworkRequest::UserAgentHeader, userAgent());
+	
+	auto reply = tileNetwork()->get(request);
+	pending.insert(key, reply);
+	auto self = const_cast<TemplateWebTiles*>(this);
+	connect(reply, &QNetworkReply::finished, self, [self, reply, zoom, x, y]() {
+		self->tileFetched(reply, zoom, x, y);
+	});
+}
+
+void TemplateWebTiles::tileFetched(QNetworkReply* reply, int zoom, int x, int y)
+{
+	auto const key = tileKey(zoom, x, y);
+	pending.remove(key);
+	reply->deleteLater();
+	
+	QImage image;
+	if (reply->error() == QNetworkReply::NoError && image.loadFromData(reply->readAll()))
+	{
+		QMutexLocker lock(&tiles_mutex);
+		tiles.insert(key, new QImage(image.convertToFormat(QImage::Format_ARGB32_Premultiplied)), cacheCost(image));
+	}
+	else if (cachedTile(zoom, x, y).isNull())  // offline
+	{
+		failed.insert(key);
+		return;
+	}
+	map->setTemplateAreaDirty(this, tileExtent(zoom, x, y), 1);
+}
+
+QRectF TemplateWebTiles::tileExtent(int zoom, int x, int y) const
+{
+	auto const corners = std::vector<LatLon> {
+	    tileCorner(zoom, x, y), tileCorner(zoom, x + 1, y),
+	    tileCorner(zoom, x + 1, y + 1), tileCorner(zoom, x, y + 1)
+	};
+	bool ok = true;
+	auto const map_corners = map->getGeoreferencing().toMapCoordF(corners, &ok);
+	if (!ok)
+		return infiniteRectF();
+	
+	QRectF extent;
+	for (auto const& corner : map_corners)
+		rectIncludeSafe(extent, QPointF(corner));
+	return extent;
+}
+
+QImage TemplateWebTiles::cachedTile(int zoom, int x, int y) const
+{
+	QImage image;
+	auto cache = tileNetwork()->cache();
+	if (auto data = cache ? cache->data(QUrl(tileUrl(url_pattern, zoom, x, y))) : nullptr)
+	{
+		image.load(data, nullptr);
+		delete data;
+	}
+	if (!image.isNull())
+	{
+		QMutexLocker lock(&tiles_mutex);
+		image = image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+		tiles.insert(tileKey(zoom, x, y), new QImage(image), cacheCost(image));
+	}
+	return image;
+}
+
+QImage TemplateWebTiles::memoryTile(int& zoom, int& x, int& y, int lowest_zoom) const
+{
+	QMutexLocker lock(&tiles_mutex);
+	for ( ; zoom >= lowest_zoom; --zoom, x /= 2, y /= 2)
+	{
+		if (auto image = tiles.object(tileKey(zoom, x, y)))
+			return *image;
+	}
+	return {};
+}
+
+void TemplateWebTiles::abortRequests() const
+{
+	for (auto reply : pending)
+	{
+		reply->disconnect(this);
+		reply->abort();
+		reply->deleteLater();
+	}
+	pending.clear();
+}
+
+
+}  // namespace OpenOrienteering
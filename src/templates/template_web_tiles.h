@@ -0,0 +1,206 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#ifndef OPENORIENTEERING_TEMPLATE_WEB_TILES_H
+#define OPENORIENTEERING_TEMPLATE_WEB_TILES_H
+
+#include <cstddef>
+#include <vector>
+
+#include <QtGlobal>
+#include <QCache>
+#include <QHash>
+#include <QImage>
+#include <QMutex>
+#include <QObject>
+#include <QRectF>
+#include <QSet>
+#include <QString>
+
+#include "templates/template.h"
+
+class QByteArray;
+class QNetworkReply;
+class QPainter;
+class QWidget;
+
+namespace OpenOrienteering {
+
+class Map;
+
+
+/**
+ * A template showing tiles from an online map service.
+ * 
+ * The template file is a small INI file which describes the tile service:
+ * 
+ *     [Tiles]
+ *     url=https://tile.example.org/{z}/{x}/{y}.png
+ *     min_zoom=0
+ *     max_zoom=19
+ *     attribution=...
+ * 
+ * The URL may use the XYZ placeholders {z}, {x}, {y}, the TMS variant {-y},
+ * or the RESTful WMTS placeholders {TileMatrix}, {TileCol}, {TileRow} for
+ * the GoogleMapsCompatible tile matrix set. In each case, the tiles are
+ * expected in Web Mercator with 256x256 pixels.
+ * 
+ * Only the tiles in the visible area are requested, plus a ring of tiles
+ * around it in order to make panning smooth. The requests are asynchronous:
+ * the template marks the area of a tile dirty when the tile arrives. Until
+ * then, parent tiles from the memory cache are shown scaled up.
+ * 
+ * Tiles are kept in a persistent disk cache which is shared by all tile
+ * templates. When the network is not available, the cached tiles are used,
+ * so that the imagery remains available for offline field work.
+ * 
+ * The tile corners are reprojected into the map's CRS in one batch per draw
+ * call, and each tile is drawn with the projective transformation given by
+ * its corners.
+ */
+class TemplateWebTiles : public Template
+{
+Q_OBJECT
+public:
+	/**
+	 * Returns the filename extensions supported by this template class.
+	 */
+	static const std::vector<QByteArray>& supportedExtensions();
+	
+	/**
+	 * Creates a tile service definition file at the given path.
+	 * 
+	 * Returns false on error.
+	 */
+	static bool createFile(const QString& path, const QString& url_pattern, int min_zoom = 0, int max_zoom = 19);
+	
+	/**
+	 * Returns the URL of the given tile, for the given URL pattern.
+	 */
+	static QString tileUrl(const QString& url_pattern, int zoom, int x, int y);
+	
+	
+	TemplateWebTiles(const QString& path, Map* map);
+
+protected:
+	TemplateWebTiles(const TemplateWebTiles& proto);
+
+public:
+	~TemplateWebTiles() override;
+	
+	TemplateWebTiles* duplicate() const override;
+	
+	const char* getTemplateType() const override;
+	
+	bool isRasterGraphics() const override;
+	
+	
+	bool preLoadConfiguration(QWidget* dialog_parent) override;
+	
+	bool loadTemplateFileImpl(bool configuring) override;
+	
+	void unloadTemplateFileImpl() override;
+	
+	
+	void drawTemplate(QPainter* painter, const QRectF& clip_rect, double scale, bool on_screen, qreal opacity) const override;
+	
+	QRectF calculateTemplateBoundingBox() const override;
+	
+	std::size_t memoryUsage() const override;
+	
+	
+	/**
+	 * Returns the URL pattern of the tile service.
+	 */
+	const QString& urlPattern() const { return url_pattern; }
+	
+	/**
+	 * Returns the attribution text required by the tile service.
+	 */
+	const QString& attribution() const { return attribution_text; }
+	
+	
+protected slots:
+	void updateGeoreferencing();
+	
+private:
+	/** Identifies a tile by zoom level and tile column and row. */
+	using TileKey = quint64;
+	
+	static TileKey tileKey(int zoom, int x, int y);
+	
+	/**
+	 * Returns the zoom level for drawing with the given painter at the given
+	 * latitude.
+	 */
+	int zoomLevel(const QPainter* painter, double latitude) const;
+	
+	/**
+	 * Requests the given tile from the network or the disk cache.
+	 */
+	void fetchTile(int zoom, int x, int y, bool prefetch) const;
+	
+	/**
+	 * Stores a fetched tile and marks its area dirty.
+	 */
+	void tileFetched(QNetworkReply* reply, int zoom, int x, int y);
+	
+	/**
+	 * Returns the bounding box of a tile in map coordinates.
+	 */
+	QRectF tileExtent(int zoom, int x, int y) const;
+	
+	/**
+	 * Loads a tile from the disk cache, without network access.
+	 */
+	QImage cachedTile(int zoom, int x, int y) const;
+	
+	/**
+	 * Returns a tile or one of its ancestors from the memory cache.
+	 * 
+	 * Ancestors are searched down to the lowest_zoom level. On return, zoom,
+	 * x and y identify the returned tile.
+	 */
+	QImage memoryTile(int& zoom, int& x, int& y, int lowest_zoom) const;
+	
+	void abortRequests() const;
+	
+	
+	QString url_pattern;
+	QString attribution_text;
+	int min_zoom = 0;
+	int max_zoom = 19;
+	
+	/** Decoded tiles, with the size in KiB as cost. */
+	mutable QCache<TileKey, QImage> tiles;
+	mutable QMutex tiles_mutex;
+	
+	/** Pending network requests. */
+	mutable QHash<TileKey, QNetworkReply*> pending;
+	/** Tiles which are neither online nor in the disk cache. */
+	mutable QSet<TileKey> failed;
+	
+};
+
+
+}  // namespace OpenOrienteering
+
+#endif
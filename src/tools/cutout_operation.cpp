@@ -21,7 +21,8 @@
 
 #include "cutout_operation.h"
 
-// IWYU pragma: no_include <algorithm>
+#include <algorithm>
+#include <cstddef>
 #include <iterator>
 #include <vector>
 
@@ -37,6 +38,7 @@
 #include "core/symbols/symbol.h"
 #include "undo/object_undo.h"
 #include "undo/undo.h"
+#include "util/concurrency.h"
 
 
 namespace OpenOrienteering {
@@ -58,6 +60,12 @@ CutoutOperation::~CutoutOperation()
 }
 
 
+void CutoutOperation::setProgressHandler(const ProgressHandler& handler)
+{
+	progress_handler = handler;
+}
+
+
 void CutoutOperation::operator()(Object* object)
 {
 	// If there is a selection, only clip selected objects
@@ -68,25 +76,98 @@ void CutoutOperation::operator()(Object* object)
 	if (object == cutout_object)
 		return;
 	
-	// Early out
-	if (!object->getExtent().intersects(cutout_object->getExtent()))
+	object->update();
+	cutout_object->update();
+	BooleanTool::PathObjects out_objects;
+	if (clip(object, out_objects))
 	{
-		if (!cut_away)
-			add_step->addObject(object, object);
+		addResult(object, out_objects);
 		return;
 	}
+	for (auto* out_object : out_objects)
+		delete out_object;
+}
+
+
+void CutoutOperation::apply(MapPart* part)
+{
+	canceled = false;
+	cutout_object->update();
+	
+	// Objects which are not found near the cutout object cannot intersect it.
+	auto const extent = cutout_object->getExtent();
+	std::vector<Object*> candidates;
+	part->findObjectsNear(MapCoordF(extent.center()), qMax(extent.width(), extent.height()) / 2, true, true, candidates);
+	std::sort(begin(candidates), end(candidates));
+	
+	struct Item
+	{
+		Object* object;
+		bool replace;
+		BooleanTool::PathObjects out_objects;
+	};
+	std::vector<Item> items;
+	std::vector<std::size_t> work;
+	auto const have_selection = !map->selectedObjects().empty();
+	for (int i = 0; i < part->getNumObjects(); ++i)
+	{
+		auto* object = part->getObject(i);
+		if (object == cutout_object)
+			continue;
+		if (have_selection && !map->isObjectSelected(object))
+			continue;
+		
+		auto const candidate = std::binary_search(begin(candidates), end(candidates), object);
+		if (candidate)
+		{
+			object->update();
+			work.push_back(items.size());
+		}
+		// Non-candidates are outside of the cutout object.
+		items.push_back({ object, !candidate && !cut_away, {} });
+	}
+	
+	// Clip in parallel batches, reporting progress in between.
+	auto const batch_size = std::size_t(256 * Concurrency::idealThreadCount());
+	for (std::size_t first = 0; first < work.size() && !canceled; first += batch_size)
+	{
+		auto const last = std::min(work.size(), first + batch_size);
+		Concurrency::parallelFor(int(first), int(last), [this, &items, &work](int i) {
+			auto& item = items[work[std::size_t(i)]];
+			item.replace = clip(item.object, item.out_objects);
+		}, 16);
+		
+		if (progress_handler && !progress_handler(int(100 * last / work.size())))
+			canceled = true;
+	}
+	
+	for (auto& item : items)
+	{
+		if (!canceled && item.replace)
+		{
+			addResult(item.object, item.out_objects);
+			continue;
+		}
+		for (auto* object : item.out_objects)
+			delete object;
+	}
+}
+
+
+bool CutoutOperation::clip(Object* object, BooleanTool::PathObjects& out_objects) const
+{
+	// Early out
+	if (!object->getExtent().intersects(cutout_object->getExtent()))
+		return !cut_away;
 	
 	switch (object->getType())
 	{
 	case Object::Point:
 	case Object::Text:
 		// Simple check if the (first) point is inside the area
-		if (cutout_object->isPointInsideArea(MapCoordF(object->getRawCoordinateVector().at(0))) == cut_away)
-			add_step->addObject(object, object);
-		break;
+		return cutout_object->isPointInsideArea(MapCoordF(object->getRawCoordinateVector().at(0))) == cut_away;
 		
 	case Object::Path:
-		out_objects.clear();
 		if (object->getSymbol()->getContainedTypes() & Symbol::Area)
 		{
 			// Use the Clipper library to clip the area
@@ -94,20 +175,24 @@ void CutoutOperation::operator()(Object* object)
 			in_objects.push_back(cutout_object);
 			in_objects.push_back(object->asPath());
 			if (!boolean_tool.executeForObjects(object->asPath(), in_objects, out_objects))
-				break;
+				return false;
 		}
 		else
 		{
 			// Use some custom code to clip the line
 			boolean_tool.executeForLine(cutout_object, object->asPath(), out_objects);
 		}
-		
-		add_step->addObject(object, object);
-		new_objects.insert(end(new_objects), begin(out_objects), end(out_objects));
-		break;
+		return true;
 	}
 	
-	return;
+	return false;
+}
+
+
+void CutoutOperation::addResult(Object* object, const BooleanTool::PathObjects& out_objects)
+{
+	add_step->addObject(object, object);
+	new_objects.insert(end(new_objects), begin(out_objects), end(out_objects));
 }
 
 
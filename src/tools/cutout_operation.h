@@ -22,6 +22,7 @@
 #ifndef OPENORIENTEERING_CUTOUT_OPERATION_H
 #define OPENORIENTEERING_CUTOUT_OPERATION_H
 
+#include <functional>
 #include <vector>
 
 #include "core/objects/boolean_tool.h"
@@ -30,6 +31,7 @@ namespace OpenOrienteering {
 
 class AddObjectsUndoStep;
 class Map;
+class MapPart;
 class Object;
 class PathObject;
 class UndoStep;
@@ -45,6 +47,13 @@ class UndoStep;
 class CutoutOperation
 {
 public:
+	/**
+	 * A function which receives the progress of apply() in percent.
+	 * 
+	 * It returns false in order to cancel the operation.
+	 */
+	using ProgressHandler = std::function<bool (int percent)>;
+	
 	/**
 	 * Function object constructor.
 	 * 
@@ -74,11 +83,35 @@ public:
 	 */
 	CutoutOperation& operator=(const CutoutOperation&) = delete;
 	
+	/**
+	 * Sets a function which is called while apply() makes progress.
+	 * 
+	 * The handler is called from the thread which runs apply().
+	 */
+	void setProgressHandler(const ProgressHandler& handler);
+	
+	/**
+	 * Returns true if the last call to apply() was canceled by the progress handler.
+	 */
+	bool wasCanceled() const { return canceled; }
+	
 	/**
 	 * Applies the configured cutting operation on the given object.
 	 */
 	void operator()(Object* object);
 	
+	/**
+	 * Applies the configured cutting operation on all objects in the given part.
+	 * 
+	 * This has the same effect as calling operator() for each object, but
+	 * only the objects found near the cutout object in the part's spatial
+	 * index are clipped, and the clipping runs in parallel.
+	 * 
+	 * If the progress handler cancels the operation, no object is changed,
+	 * and wasCanceled() returns true.
+	 */
+	void apply(MapPart* part);
+	
 	/**
 	 * Commits the changes.
 	 * 
@@ -88,6 +121,20 @@ public:
 	void commit();
 	
 private:
+	/**
+	 * Clips the given object, without changing the map or the undo step.
+	 * 
+	 * Returns true if the object is to be replaced by out_objects, which
+	 * may be empty. The object and the cutout object must be up to date.
+	 * This function is thread-safe.
+	 */
+	bool clip(Object* object, BooleanTool::PathObjects& out_objects) const;
+	
+	/**
+	 * Records the result of clip() for the given object.
+	 */
+	void addResult(Object* object, const BooleanTool::PathObjects& out_objects);
+	
 	UndoStep* finish();
 	
 	Map* map;
@@ -95,8 +142,9 @@ private:
 	std::vector<PathObject*> new_objects;
 	AddObjectsUndoStep* add_step;
 	BooleanTool boolean_tool;
-	BooleanTool::PathObjects out_objects;
+	ProgressHandler progress_handler;
 	bool cut_away;
+	bool canceled = false;
 };
 
 
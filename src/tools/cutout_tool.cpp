@@ -21,14 +21,13 @@
 
 #include "cutout_tool.h"
 
-#include <functional>
-
 #include <Qt>
 #include <QtGlobal>
 #include <QCursor>
 #include <QFlags>
 #include <QKeyEvent>
 #include <QPixmap>
+#include <QProgressDialog>
 #include <QString>
 
 #include "core/map.h"
@@ -112,7 +111,7 @@ bool CutoutTool::keyPress(QKeyEvent* event)
 		cutout_object_index = -1;
 		
 		// Apply tool via static function and deselect this tool
-		apply(map(), cutout_object, cut_away);
+		apply(map(), cutout_object, cut_away, window());
 		editor->setEditTool();
 		return true;
 		
@@ -185,11 +184,23 @@ void CutoutTool::dragFinish()
 }
 
 
-void CutoutTool::apply(Map* map, PathObject* cutout_object, bool cut_away)
+void CutoutTool::apply(Map* map, PathObject* cutout_object, bool cut_away, QWidget* dialog_parent)
 {
+	// Clipping a whole map takes a while. The dialog is shown only
+	// after its minimum duration.
+	QProgressDialog progress(dialog_parent);
+	progress.setWindowModality(Qt::ApplicationModal);
+	progress.setLabelText(cut_away ? tr("Cutting away...") : tr("Cutting out..."));
+	progress.setAutoReset(false);
+	
 	CutoutOperation operation(map, cutout_object, cut_away);
-	map->getCurrentPart()->applyOnAllObjects(std::ref(operation));
+	operation.setProgressHandler([&progress](int percent) {
+		progress.setValue(percent);
+		return !progress.wasCanceled();
+	});
+	operation.apply(map->getCurrentPart());
 	operation.commit();
+	progress.reset();
 }
 
 
@@ -33,6 +33,7 @@ class QAction;
 class QKeyEvent;
 class QPainter;
 class QRectF;
+class QWidget;
 
 namespace OpenOrienteering {
 
@@ -69,8 +70,10 @@ public:
 	 * 
 	 * Setting cut_away to true inverts the effect, cutting the
 	 * part inside the cut shape away instead of the part outside.
+	 * 
+	 * A cancelable progress dialog is shown for long-running operations.
 	 */
-	static void apply(Map* map, PathObject* cutout_object, bool cut_away);
+	static void apply(Map* map, PathObject* cutout_object, bool cut_away, QWidget* dialog_parent = nullptr);
 	
 	
 protected:
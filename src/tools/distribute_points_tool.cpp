@@ -21,6 +21,9 @@
 
 #include "distribute_points_tool.h"
 
+#include <cstddef>
+#include <iterator>
+
 #include <Qt>
 #include <QtMath>
 #include <QCheckBox>
@@ -37,6 +40,7 @@
 #include "core/symbols/point_symbol.h"
 #include "core/objects/object.h"
 #include "gui/util_gui.h"
+#include "util/concurrency.h"
 
 
 namespace OpenOrienteering {
@@ -55,14 +59,19 @@ bool DistributePointsTool::showSettingsDialog(
 	return true;
 }
 
-void DistributePointsTool::execute(
+namespace {
+
+/**
+ * Creates the points on a path which is up to date.
+ * 
+ * This function is thread-safe for distinct output vectors.
+ */
+void distributePoints(
         const PathObject* path,
         PointSymbol* point,
         const DistributePointsTool::Settings& settings,
         std::vector<PointObject*>& out_objects )
 {
-	path->update();
-	
 	// This places the points only on the first part.
 	const auto& part = path->parts().front();
 	
@@ -118,6 +127,39 @@ void DistributePointsTool::execute(
 	}
 }
 
+}  // namespace
+
+
+void DistributePointsTool::execute(
+        const PathObject* path,
+        PointSymbol* point,
+        const DistributePointsTool::Settings& settings,
+        std::vector<PointObject*>& out_objects )
+{
+	path->update();
+	distributePoints(path, point, settings, out_objects);
+}
+
+void DistributePointsTool::execute(
+        const std::vector<const PathObject*>& paths,
+        PointSymbol* point,
+        const DistributePointsTool::Settings& settings,
+        std::vector<Object*>& out_objects )
+{
+	// Updating objects is not thread-safe.
+	for (const auto* path : paths)
+		path->update();
+	
+	std::vector<std::vector<PointObject*>> objects_per_path(paths.size());
+	Concurrency::parallelFor(0, int(paths.size()), [&](int i) {
+		auto const index = std::size_t(i);
+		distributePoints(paths[index], point, settings, objects_per_path[index]);
+	});
+	
+	for (const auto& objects : objects_per_path)
+		out_objects.insert(end(out_objects), begin(objects), end(objects));
+}
+
 
 DistributePointsSettingsDialog::DistributePointsSettingsDialog(
         QWidget* parent,
@@ -35,6 +35,7 @@ class QWidget;
 
 namespace OpenOrienteering {
 
+class Object;
 class PathObject;
 class PointObject;
 class PointSymbol;
@@ -103,6 +104,20 @@ public:
 	        const DistributePointsTool::Settings& settings,
 	        std::vector<PointObject*>& out_objects
 	);
+	
+	/** 
+	 * Executes the tool on multiple paths, creating points according to settings.
+	 * 
+	 * The points are computed concurrently. The created objects are appended
+	 * to the out_objects vector in the order of the paths, ready for
+	 * Map::addObjects(), but they are not added to the map.
+	 */
+	static void execute(
+	        const std::vector<const PathObject*>& paths,
+	        PointSymbol* point,
+	        const DistributePointsTool::Settings& settings,
+	        std::vector<Object*>& out_objects
+	);
 };
 
 
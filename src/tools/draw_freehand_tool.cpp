@@ -21,6 +21,12 @@
 
 #include "draw_freehand_tool.h"
 
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <utility>
+#include <vector>
+
 #include <Qt>
 #include <QCursor>
 #include <QKeyEvent>
@@ -31,6 +37,7 @@
 
 #include "core/map.h"
 #include "core/map_view.h"
+#include "core/path_simplification.h"
 #include "core/objects/object.h"
 #include "gui/modifier_key.h"
 #include "gui/map/map_editor.h"
@@ -159,19 +166,22 @@ void DrawFreehandTool::finishDrawing()
 	if (preview_path->getCoordinateCount() > 2)
 	{
 		// Use 999 instead of 1000, and save the rounding.
-		split_distance_sq = editor->getMainWidget()->getMapView()->pixelToLength(1) / 999;
-		split_distance_sq *= split_distance_sq;
+		auto const split_distance = editor->getMainWidget()->getMapView()->pixelToLength(1) / 999;
 		
-		point_mask.assign(preview_path->getCoordinateCount(), false);
-		point_mask.front() = true;
-		point_mask.back() = true;
-		checkLineSegment(0, point_mask.size() - 1);
+		const auto& coords = preview_path->getRawCoordinateVector();
+		auto const keep = PathSimplification::douglasPeucker(coords, 0, coords.size() - 1, split_distance);
+		MapCoordVector simplified;
+		simplified.reserve(std::size_t(std::count(begin(keep), end(keep), true)));
+		for (std::size_t i = 0; i < coords.size(); ++i)
+		{
+			if (keep[i])
+				simplified.push_back(coords[i]);
+		}
 		
-		for (auto i = point_mask.size() - 1; i != 0; )
+		if (simplified.size() != coords.size())
 		{
-			--i;
-			if (!point_mask[i])
-				preview_path->deleteCoordinate(i, false);
+			PathObject simplified_path { preview_path->getSymbol(), std::move(simplified) };
+			preview_path->assignCoordinates(simplified_path, 0, simplified_path.getCoordinateCount() - 1);
 		}
 	}
 	
@@ -189,65 +199,6 @@ void DrawFreehandTool::abortDrawing()
 
 
 
-void DrawFreehandTool::checkLineSegment(std::size_t first, std::size_t last)
-{
-	if (last <= first + 1)
-		return;
-	
-	// 'best_index' indicates the point on the path between first and last
-	// with the highest distance from the direct line between first and last.
-	auto best_index = first;
-	
-	// This block ensures the stack is cleaned up before going into recursion.
-	{
-		auto max_distance_sq = qreal(0);
-		const auto start_coord = MapCoordF(preview_path->getRawCoordinateVector()[first]);
-		const auto end_coord = MapCoordF(preview_path->getRawCoordinateVector()[last]);
-		auto tangent = end_coord - start_coord;
-		tangent.normalize();
-		
-		for (auto i = first + 1; i < last; ++i)
-		{
-			const auto coord = MapCoordF(preview_path->getRawCoordinateVector()[i]);
-			const auto to_coord = coord - start_coord;
-			
-			qreal distance_sq;
-			
-			auto dist_along_line = MapCoordF::dotProduct(to_coord, tangent);
-			if (dist_along_line <= 0)
-			{
-				distance_sq = to_coord.lengthSquared();
-			}
-			else if (dist_along_line >= end_coord.distanceTo(start_coord))
-			{
-				distance_sq = coord.distanceSquaredTo(end_coord);
-			}
-			else
-			{
-				auto right = tangent.perpRight();
-				distance_sq = qAbs(MapCoordF::dotProduct(right, to_coord));
-				distance_sq = distance_sq*distance_sq;
-			}
-			
-			if (distance_sq > max_distance_sq)
-			{
-				max_distance_sq = distance_sq;
-				best_index = i;
-			}
-		}
-		
-		// Make new segment?
-		if (max_distance_sq < split_distance_sq)
-			return;
-	}		
-	
-	point_mask[best_index] = true;
-	checkLineSegment(first, best_index);
-	checkLineSegment(best_index, last);
-}
-
-
-
 void DrawFreehandTool::updatePath()
 {
 	if ((last_pos - cur_pos).manhattanLength() <= 2)
@@ -22,9 +22,6 @@
 #ifndef OPENORIENTEERING_DRAW_FREEHAND_TOOL_H
 #define OPENORIENTEERING_DRAW_FREEHAND_TOOL_H
 
-#include <cstddef>
-#include <vector>
-
 #include <QtGlobal>
 #include <QObject>
 #include <QPoint>
@@ -73,11 +70,6 @@ protected:
 	void updateStatusText();
 	
 private:
-	void checkLineSegment(std::size_t first, std::size_t last);
-	
-	std::vector<bool> point_mask;
-	qreal split_distance_sq;
-	
 	QPoint last_pos;
 	QPoint cur_pos;
 	MapCoordF cur_pos_map;
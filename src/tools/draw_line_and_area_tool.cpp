@@ -24,6 +24,7 @@
 #include <algorithm>
 #include <cstddef>
 #include <iterator>
+#include <utility>
 
 #include <QtGlobal>
 #include <QFlags>
@@ -163,7 +164,11 @@ void DrawLineAndAreaTool::hidePreviewPoints()
 
 void DrawLineAndAreaTool::includePreviewRects(QRectF& rect)
 {
-	if (preview_path)
+	if (preview_path_head)
+		rectIncludeSafe(rect, preview_path_head->getExtent());
+	if (preview_path_tail)
+		rectIncludeSafe(rect, preview_path_tail->getExtent());
+	else if (preview_path)
 		rectIncludeSafe(rect, preview_path->getExtent());
 	
 	if (preview_points_shown)
@@ -213,14 +218,81 @@ void DrawLineAndAreaTool::startDrawing()
 
 void DrawLineAndAreaTool::updatePreviewPath()
 {
-	renderables->removeRenderablesOfObject(preview_path, false);
+	if (incremental_preview && updatePreviewPathIncrementally())
+		return;
+	
+	removePreviewPathRenderables();
 	preview_path->update();
 	renderables->insertRenderablesOfObject(preview_path);
 }
 
-void DrawLineAndAreaTool::abortDrawing()
+bool DrawLineAndAreaTool::updatePreviewPathIncrementally()
 {
+	// Areas and closed paths depend on all coordinates.
+	if (preview_path->parts().size() != 1
+	    || preview_path->parts().front().isClosed()
+	    || (drawing_symbol && (drawing_symbol->getContainedTypes() & Symbol::Area)))
+		return false;
+	
+	const auto& coords = preview_path->getRawCoordinateVector();
+	if (coords.size() < min_coords_for_incremental_preview)
+		return false;
+	
+	// The head ends where the last segment starts.
+	auto const last = coords.size() - 1;
+	auto const split = (coords[last - 3].isCurveStart()) ? last - 3 : last - 1;
+	
 	renderables->removeRenderablesOfObject(preview_path, false);
+	
+	auto const head_matches = [&coords, split](const PathObject& head) {
+		const auto& head_coords = head.getRawCoordinateVector();
+		return head_coords.size() == split + 1
+		       && std::equal(begin(head_coords), end(head_coords) - 1, begin(coords))
+		       && head_coords.back().isPositionEqualTo(coords[split]);
+	};
+	if (!preview_path_head || !head_matches(*preview_path_head))
+	{
+		if (preview_path_head)
+			renderables->removeRenderablesOfObject(preview_path_head.get(), false);
+		auto head_coords = MapCoordVector(begin(coords), begin(coords) + std::ptrdiff_t(split + 1));
+		head_coords.back().setCurveStart(false);
+		head_coords.back().setClosePoint(false);
+		preview_path_head.reset(new PathObject(preview_path->getSymbol(), std::move(head_coords)));
+		preview_path_head->update();
+		renderables->insertRenderablesOfObject(preview_path_head.get());
+	}
+	
+	if (preview_path_tail)
+		renderables->removeRenderablesOfObject(preview_path_tail.get(), false);
+	preview_path_tail.reset(new PathObject(preview_path->getSymbol(), MapCoordVector(begin(coords) + std::ptrdiff_t(split), end(coords))));
+	preview_path_tail->update();
+	renderables->insertRenderablesOfObject(preview_path_tail.get());
+	
+	// Path coords are needed for length and following,
+	// but the full renderables are created only when finishing.
+	preview_path->updatePathCoords();
+	return true;
+}
+
+void DrawLineAndAreaTool::removePreviewPathRenderables()
+{
+	if (preview_path)
+		renderables->removeRenderablesOfObject(preview_path, false);
+	if (preview_path_head)
+	{
+		renderables->removeRenderablesOfObject(preview_path_head.get(), false);
+		preview_path_head.reset();
+	}
+	if (preview_path_tail)
+	{
+		renderables->removeRenderablesOfObject(preview_path_tail.get(), false);
+		preview_path_tail.reset();
+	}
+}
+
+void DrawLineAndAreaTool::abortDrawing()
+{
+	removePreviewPathRenderables();
 	delete preview_path;
 	map()->clearDrawingBoundingBox();
 	
@@ -240,7 +312,7 @@ void DrawLineAndAreaTool::finishDrawing(PathObject* append_to_object)
 {
 	if (preview_path)
 	{
-		renderables->removeRenderablesOfObject(preview_path, false);
+		removePreviewPathRenderables();
 	
 		if (preview_path->getRawCoordinateVector().empty())
 		{
@@ -293,6 +365,7 @@ void DrawLineAndAreaTool::finishDrawing(PathObject* append_to_object)
 			// Ugly HACK to make it possible to delete this tool as response to pathFinished
 			PathObject* temp_path = preview_path;
 			preview_path = nullptr;
+			temp_path->update();
 			emit pathFinished(temp_path);
 			delete temp_path;
 		}
@@ -324,7 +397,7 @@ void DrawLineAndAreaTool::deletePreviewObjects()
 
 	if (preview_path)
 	{
-		renderables->removeRenderablesOfObject(preview_path, false);
+		removePreviewPathRenderables();
 		delete preview_path;
 		preview_path = nullptr;
 	}
@@ -22,6 +22,7 @@
 #ifndef OPENORIENTEERING_DRAW_LINE_AND_AREA_H
 #define OPENORIENTEERING_DRAW_LINE_AND_AREA_H
 
+#include <cstddef>
 #include <memory>
 #include <vector>
 
@@ -105,6 +106,19 @@ protected:
 	/** Calls update() on the preview path, correctly handling its renderables. */
 	virtual void updatePreviewPath();
 	
+	/**
+	 * Updates only the renderables of the last segment of the preview path,
+	 * if incremental_preview is set and the path allows it.
+	 * 
+	 * The renderables of all previous segments are reused as long as their
+	 * coordinates do not change. Returns false if the preview path must be
+	 * updated completely.
+	 */
+	bool updatePreviewPathIncrementally();
+	
+	/** Removes the renderables of the preview path, including partial previews. */
+	void removePreviewPathRenderables();
+	
 	/** Aborts drawing. */
 	virtual void abortDrawing();
 	
@@ -135,9 +149,15 @@ protected:
 	
 	const Symbol* drawing_symbol = nullptr;
 	PathObject* preview_path     = nullptr;
+	std::unique_ptr<PathObject> preview_path_head;  ///< The unchanged start of an incremental preview
+	std::unique_ptr<PathObject> preview_path_tail;  ///< The last segment of an incremental preview
 	int preview_point_radius     = 0;
 	bool preview_points_shown    = false;
 	bool is_helper_tool          = false;
+	bool incremental_preview     = false;
+	
+	/** Shorter paths are always updated completely. */
+	static constexpr std::size_t min_coords_for_incremental_preview = 8;
 	
 };
 
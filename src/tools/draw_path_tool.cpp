@@ -75,6 +75,7 @@ DrawPathTool::DrawPathTool(MapEditorController* editor, QAction* tool_action, bo
 , follow_helper(new FollowPathToolHelper())
 , allow_closing_paths(allow_closing_paths)
 {
+	incremental_preview = true;
 	angle_helper->setActive(false);
 	connect(angle_helper.get(), &ConstrainAngleToolHelper::displayChanged, this, &DrawPathTool::updateDirtyRect);
 	
@@ -876,7 +877,7 @@ void DrawPathTool::finishDrawing()
 	
 	if (preview_path->getCoordinateCount() < (contains_only_areas ? 3 : 2))
 	{
-		renderables->removeRenderablesOfObject(preview_path, false);
+		removePreviewPathRenderables();
 		delete preview_path;
 		preview_path = nullptr;
 	}
@@ -132,7 +132,11 @@ void DrawTextTool::startEditing()
 
 	// Create the TextObjectEditor
 	text_editor.reset(new TextObjectEditorHelper(preview_text.get(), editor));
-	connect(text_editor.get(), &TextObjectEditorHelper::stateChanged, this, &DrawTextTool::updatePreviewText);
+	connect(text_editor.get(), &TextObjectEditorHelper::stateChanged, this, [this]() {
+		// The layout is already up-to-date, rebuilding the renderables can wait.
+		updateDirtyRect();
+		updatePreviewObjectsAsynchronously();
+	});
 	connect(text_editor.get(), &TextObjectEditorHelper::finished, this, &DrawTextTool::finishEditing);
 	
 	MapEditorToolBase::startEditing();
@@ -394,6 +398,11 @@ void DrawTextTool::updatePreview()
 	}
 }
 
+void DrawTextTool::updatePreviewObjects()
+{
+	updatePreviewText();
+}
+
 void DrawTextTool::updatePreviewText()
 {
 	auto text = preview_text.get();
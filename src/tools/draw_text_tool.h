@@ -94,6 +94,7 @@ protected:
 	void resetWaitingForMouseRelease();
 	void updatePreview();
 	void updatePreviewText();
+	void updatePreviewObjects() override;
 	int updateDirtyRectImpl(QRectF& rect) override;
 	void drawImpl(QPainter* painter, MapWidget* widget) override;
 	void updateStatusText() override;
@@ -297,7 +297,11 @@ void EditLineTool::dragMove()
 			highlight_renderables->insertRenderablesOfObject(highlight_object);
 		}
 		
-		updatePreviewObjectsAsynchronously();
+		// Plain translations are displayed without regenerating the renderables.
+		if (object_mover->movesObjectsOnly())
+			translatePreviewObjects(dx, dy);
+		else
+			updatePreviewObjectsAsynchronously();
 	}
 	else if (box_selection)
 	{
@@ -600,6 +604,12 @@ void EditLineTool::updateHoverState(const MapCoordF& cursor_pos)
 	    new_hover_line   != hover_line  ||
 		new_hover_object != hover_object)
 	{
+		// Cf. drawImpl(): Unless the frame changes, only the highlight needs to be repainted.
+		auto const repaint_all = (new_hover_state == OverFrame) != (hover_state == OverFrame);
+		auto const pixel_border = pointHandles().displayRadius();
+		if (!repaint_all && highlight_object)
+			map()->updateDrawing(highlight_object->getExtent(), pixel_border);
+		
 		deleteHighlightObject();
 		
 		hover_state  = new_hover_state;
@@ -618,7 +628,10 @@ void EditLineTool::updateHoverState(const MapCoordF& cursor_pos)
 		}
 		
 		effective_start_drag_distance = (hover_state == OverNothing) ? startDragDistance() : 0;
-		updateDirtyRect();
+		if (repaint_all)
+			updateDirtyRect();
+		else if (highlight_object)
+			map()->updateDrawing(highlight_object->getExtent(), pixel_border);
 	}
 }
 
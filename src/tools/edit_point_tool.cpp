@@ -302,7 +302,11 @@ void EditPointTool::clickPress()
 		old_horz_alignment = (int)hover_object->getHorizontalAlignment();
 		old_vert_alignment = (int)hover_object->getVerticalAlignment();
 		text_editor = new TextObjectEditorHelper(hover_object, editor);
-		connect(text_editor, &TextObjectEditorHelper::stateChanged, this, &EditPointTool::updatePreviewObjects);
+		connect(text_editor, &TextObjectEditorHelper::stateChanged, this, [this]() {
+			// The layout is already up-to-date, rebuilding the renderables can wait.
+			updateDirtyRect();
+			updatePreviewObjectsAsynchronously();
+		});
 		connect(text_editor, &TextObjectEditorHelper::finished, this, &EditPointTool::finishEditing);
 		
 		// Send clicked position
@@ -364,9 +368,15 @@ void EditPointTool::dragMove()
 			handle_offset = MapCoordF(0, 0);
 		}
 		
+		qint32 dx, dy;
 		object_mover->move(constrained_pos_map, 
-		                   moveOppositeHandle() ? ObjectMover::HandleOpMode::Click : ObjectMover::HandleOpMode::Never);
-		updatePreviewObjectsAsynchronously();
+		                   moveOppositeHandle() ? ObjectMover::HandleOpMode::Click : ObjectMover::HandleOpMode::Never,
+		                   &dx, &dy);
+		// Plain translations are displayed without regenerating the renderables.
+		if (object_mover->movesObjectsOnly())
+			translatePreviewObjects(dx, dy);
+		else
+			updatePreviewObjectsAsynchronously();
 	}
 	else if (box_selection)
 	{
@@ -553,6 +563,7 @@ void EditPointTool::objectSelectionChangedImpl()
 		return;
 	}
 	
+	invalidateHoverCache();
 	if (isDragging())
 	{
 		cancelDragging();
@@ -567,6 +578,9 @@ void EditPointTool::objectSelectionChangedImpl()
 
 int EditPointTool::updateDirtyRectImpl(QRectF& rect)
 {
+	// Called whenever the selected objects change.
+	invalidateHoverCache();
+	
 	bool show_object_points = map()->selectedObjects().size() <= max_objects_for_handle_display;
 	
 	selection_extent = QRectF();
@@ -788,7 +802,7 @@ void EditPointTool::updateHoverState(const MapCoordF& cursor_pos)
 			for (const auto* object : map()->selectedObjects())
 			{
 				MapCoordF handle_pos;
-				auto hover_point = findHoverPoint(cur_map_widget->mapToViewport(cursor_pos), cur_map_widget, object, true, &handle_pos);
+				auto hover_point = findHoverPointCached(cursor_pos, cur_map_widget, object, true, &handle_pos);
 				if (hover_point == no_point)
 					continue;
 				
@@ -846,12 +860,25 @@ void EditPointTool::updateHoverState(const MapCoordF& cursor_pos)
 	    new_hover_object != hover_object ||
 	    new_hover_point  != hover_point)
 	{
+		// Cf. drawImpl(): Unless the frame changes, only the active handles need to be repainted.
+		auto const frame_state = [](HoverState state) {
+			return state & (OverFrame | OverObjectNode);
+		};
+		auto const repaint_all = frame_state(new_hover_state) != frame_state(hover_state)
+		                         && (new_hover_state.testFlag(OverFrame) || hover_state.testFlag(OverFrame));
+		if (!repaint_all && hover_state.testFlag(OverObjectNode) && map()->isObjectSelected(hover_object))
+			updateHandleDrawing(hover_object, hover_point);
+		
 		hover_state = new_hover_state;
 		// We have got a Map*, so we may get an non-const Object*.
 		hover_object = const_cast<Object*>(new_hover_object);
 		hover_point  = new_hover_point;
 		effective_start_drag_distance = (hover_state == OverNothing) ? startDragDistance() : 0;
-		updateDirtyRect();
+		
+		if (repaint_all)
+			updateDirtyRect();
+		else if (hover_state.testFlag(OverObjectNode))
+			updateHandleDrawing(hover_object, hover_point);
 	}
 	
 	Q_ASSERT((hover_state.testFlag(OverObjectNode) || hover_state.testFlag(OverPathEdge)) == bool(hover_object));
@@ -20,7 +20,9 @@
 
 #include "edit_tool.h"
 
+#include <algorithm>
 #include <cstddef>
+#include <functional>
 #include <limits>
 #include <map>
 #include <memory>
@@ -36,6 +38,7 @@
 #include <QString>
 
 #include "core/map.h"
+#include "core/map_view.h"
 #include "core/virtual_path.h"
 #include "core/objects/object.h"
 #include "core/objects/text_object.h"
@@ -48,6 +51,22 @@
 
 namespace OpenOrienteering {
 
+namespace {
+
+/**
+ * Paths with fewer coordinates are searched directly by findHoverPointCached().
+ */
+constexpr MapCoordVector::size_type min_coords_for_hover_cache = 64;
+
+/**
+ * The extent of a single point in the hover cache: one native map unit.
+ */
+constexpr qreal hover_cache_point_size = 0.001;
+
+}  // namespace
+
+
+
 EditTool::EditTool(MapEditorController* editor, MapEditorTool::Type type, QAction* tool_action)
  : MapEditorToolBase { QCursor(QPixmap(QString::fromLatin1(":/images/cursor-hollow.png")), 1, 1), type, editor, tool_action }
  , object_selector { new ObjectSelector(map()) }
@@ -254,6 +273,100 @@ void EditTool::drawBoundingBox(QPainter* painter, MapWidget* widget, const QRect
 }
 
 
+MapCoordVector::size_type EditTool::findHoverPointCached(const MapCoordF& cursor_pos, const MapWidget* widget, const Object* object, bool include_curve_handles, MapCoordF* out_handle_pos)
+{
+	auto const cursor = widget->mapToViewport(cursor_pos);
+	if (object->getType() != Object::Path
+	    || object->asPath()->getCoordinateCount() < min_coords_for_hover_cache)
+	{
+		return findHoverPoint(cursor, widget, object, include_curve_handles, out_handle_pos);
+	}
+	
+	const auto* path = object->asPath();
+	auto const coord_count = path->getCoordinateCount();
+	auto cache = hover_caches.find(object);
+	if (cache == end(hover_caches) || cache->second.coord_count != coord_count)
+	{
+		auto index = SpatialIndex<MapCoordVector::size_type>();
+		for (MapCoordVector::size_type i = 0; i < coord_count; ++i)
+		{
+			auto const& coord = path->getCoordinate(i);
+			if (!coord.isClosePoint())
+				index.insert(i, { coord.x(), coord.y(), hover_cache_point_size, hover_cache_point_size });
+		}
+		hover_caches.erase(object);
+		cache = hover_caches.emplace(object, HoverCache{ coord_count, std::move(index) }).first;
+	}
+	
+	// The query is a superset of the circle tested by findHoverPoint().
+	auto const tolerance = 0.001 * widget->getMapView()->pixelToLength(clickTolerance()) + hover_cache_point_size;
+	auto candidates = cache->second.index.find({ cursor_pos.x() - tolerance, cursor_pos.y() - tolerance, 2 * tolerance, 2 * tolerance });
+	
+	// Same ranking as in findHoverPoint(), which visits the points backwards.
+	std::sort(begin(candidates), end(candidates), std::greater<MapCoordVector::size_type>());
+	auto best_index = std::numeric_limits<MapCoordVector::size_type>::max();
+	auto best_dist_sq = clickTolerance() * clickTolerance();
+	for (auto i : candidates)
+	{
+		bool is_handle = (i >= 1 && path->getCoordinate(i - 1).isCurveStart())
+		                 || (i >= 2 && path->getCoordinate(i - 2).isCurveStart());
+		if (is_handle && !include_curve_handles)
+			continue;
+		
+		auto const delta = widget->mapToViewport(path->getCoordinate(i)) - cursor;
+		auto const distance_sq = QPointF::dotProduct(delta, delta);
+		if (distance_sq < best_dist_sq || (is_handle && qIsNull(distance_sq - best_dist_sq)))
+		{
+			best_index = i;
+			best_dist_sq = distance_sq;
+		}
+	}
+	
+	if (out_handle_pos && best_index < coord_count)
+		*out_handle_pos = MapCoordF(path->getCoordinate(best_index));
+	return best_index;
+}
+
+
+void EditTool::invalidateHoverCache()
+{
+	hover_caches.clear();
+}
+
+
+void EditTool::updateHandleDrawing(const Object* object, MapCoordVector::size_type index)
+{
+	QRectF rect;
+	switch (object->getType())
+	{
+	case Object::Point:
+		rectIncludeSafe(rect, object->asPoint()->getCoordF());
+		break;
+		
+	case Object::Text:
+		for (const auto& point : object->asText()->controlPoints())
+			rectIncludeSafe(rect, point);
+		break;
+		
+	case Object::Path:
+		{
+			// An active point also activates its curve handles.
+			const auto* path = object->asPath();
+			auto const last = std::min(index + 2, path->getCoordinateCount() - 1);
+			for (auto i = index >= 2 ? index - 2 : 0; i <= last; ++i)
+				rectIncludeSafe(rect, QPointF(path->getCoordinate(i)));
+			auto const part = path->findPartForIndex(index);
+			if (index == part->first_index && part->isClosed() && part->size() > 3)
+				rectIncludeSafe(rect, QPointF(path->getCoordinate(part->last_index - 1)));
+		}
+		break;
+	}
+	
+	if (rect.isValid())
+		map()->updateDrawing(rect, pointHandles().displayRadius() + 1);
+}
+
+
 void EditTool::drawBoundingPath(QPainter* painter, MapWidget* widget, const std::vector<QPointF>& bounding_path, const QRgb& color)
 {
 	Q_ASSERT(!bounding_path.empty());
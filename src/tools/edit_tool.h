@@ -21,6 +21,7 @@
 #ifndef OPENORIENTEERING_EDIT_TOOL_H
 #define OPENORIENTEERING_EDIT_TOOL_H
 
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -34,6 +35,7 @@
 #include <QString>
 
 #include "core/map_coord.h"
+#include "core/spatial_index.h"
 #include "tools/tool.h"
 #include "tools/tool_base.h"
 
@@ -144,10 +146,44 @@ protected:
 	 */
 	void drawBoundingPath(QPainter* painter, MapWidget* widget, const std::vector<QPointF>& bounding_path, const QRgb& color);
 	
+	/**
+	 * Returns the index of the object's point which is under the cursor,
+	 * like MapEditorTool::findHoverPoint().
+	 * 
+	 * For long paths, the point positions are kept in a spatial index which
+	 * is reused until invalidateHoverCache() is called, or until the number
+	 * of coordinates changes.
+	 */
+	MapCoordVector::size_type findHoverPointCached(const MapCoordF& cursor_pos, const MapWidget* widget, const Object* object, bool include_curve_handles, MapCoordF* out_handle_pos = nullptr);
+	
+	/**
+	 * Discards the cached point positions.
+	 * 
+	 * This must be called when the selection changes or when objects are
+	 * modified.
+	 */
+	void invalidateHoverCache();
+	
+	/**
+	 * Triggers a repaint of the handle of the given point,
+	 * including the adjacent curve handles.
+	 */
+	void updateHandleDrawing(const Object* object, MapCoordVector::size_type index);
+	
 	/**
 	 * An utility implementing object selection logic.
 	 */
 	QScopedPointer<ObjectSelector> object_selector;
+	
+private:
+	/** The point positions of a path, for findHoverPointCached(). */
+	struct HoverCache
+	{
+		MapCoordVector::size_type coord_count;
+		SpatialIndex<MapCoordVector::size_type> index;
+	};
+	
+	std::unordered_map<const Object*, HoverCache> hover_caches;
 };
 
 
@@ -27,6 +27,7 @@
 #include <limits>
 #include <memory>
 #include <type_traits>
+#include <vector>
 
 #include <QtGlobal>
 #include <QCursor>
@@ -41,6 +42,7 @@
 #include <QRgb>
 #include <QSize>
 #include <QString>
+#include <QTransform>
 
 #include "core/map.h"
 #include "core/map_color.h"
@@ -57,6 +59,7 @@
 #include "tools/tool.h"
 #include "tools/tool_base.h"
 #include "undo/object_undo.h"
+#include "util/concurrency.h"
 
 
 // Uncomment this to generate an image file of the rasterized map
@@ -87,6 +90,61 @@ struct PathSection
 
 constexpr auto background = QRgb(0xffffffffu);
 
+/**
+ * The height of the horizontal bands of the image which are rasterized
+ * concurrently.
+ */
+constexpr auto band_height = 128;
+
+
+/**
+ * Fast read access to the pixels of a Format_RGB32 image.
+ * 
+ * Unlike QImage::pixel(), this does no format conversion and no bounds
+ * checking, and it allows scanning a row of pixels as a plain array.
+ */
+class PixelReader
+{
+public:
+	explicit PixelReader(const QImage& image)
+	: bits(reinterpret_cast<const QRgb*>(image.constBits()))
+	, stride(image.bytesPerLine() / int(sizeof(QRgb)))
+	, width(image.width())
+	{
+		Q_ASSERT(image.format() == QImage::Format_RGB32);
+	}
+	
+	QRgb operator()(const QPoint& pos) const
+	{
+		return bits[pos.y() * stride + pos.x()];
+	}
+	
+	/**
+	 * Returns the x coordinate of the first pixel in row y, starting at x,
+	 * which is not background, or the image width if there is none.
+	 */
+	int findObstructed(int x, int y) const
+	{
+		auto const* row = bits + y * stride;
+		return int(std::find_if(row + x, row + width, [](QRgb pixel) { return pixel != background; }) - row);
+	}
+	
+	/**
+	 * Returns the x coordinate of the first background pixel in row y,
+	 * starting at x, or the image width if there is none.
+	 */
+	int findFree(int x, int y) const
+	{
+		auto const* row = bits + y * stride;
+		return int(std::find(row + x, row + width, background) - row);
+	}
+	
+private:
+	const QRgb* bits;
+	int stride;
+	int width;
+};
+
 }  // namespace
 
 
@@ -183,12 +241,15 @@ int FillTool::fill(const QRectF& extent)
 	// For every collision, trace the boundary of the collision object
 	// and check whether the click position is inside the boundary.
 	// If it is, the correct outline was found which is then filled.
+	const PixelReader pixels(image);
 	for (QPoint free_pixel = clicked_pixel; free_pixel.x() < image.width() - 1; free_pixel += QPoint(1, 0))
 	{
-		// Check if there is a collision to the right
+		// Find the next collision to the right
+		auto const collision_x = pixels.findObstructed(free_pixel.x() + 1, free_pixel.y());
+		if (collision_x >= image.width())
+			break;
+		free_pixel.setX(collision_x - 1);
 		QPoint boundary_pixel = free_pixel + QPoint(1, 0);
-		if (image.pixel(boundary_pixel) == background)
-			continue;
 		
 		// Found a collision, trace outline of hit object
 		// and check whether the outline contains start_pixel
@@ -208,18 +269,15 @@ int FillTool::fill(const QRectF& extent)
 			}
 			
 			// Skip over the rest of the floating object.
-			free_pixel += QPoint(1, 0);
-			while (free_pixel.x() < image.width() - 1
-				&& image.pixel(free_pixel) != background)
-				free_pixel += QPoint(1, 0);
-			free_pixel -= QPoint(1, 0);
+			auto const free_x = pixels.findFree(free_pixel.x() + 1, free_pixel.y());
+			free_pixel.setX(qMin(free_x, image.width() - 1) - 1);
 			continue;
 		}
 		
 		// Don't let the boundary start in the midde of an object
-		const auto id = image.pixel(boundary.front());
-		auto new_object = std::find_if(begin(boundary), end(boundary), [&image, id](auto pos) {
-			return image.pixel(pos) != id;
+		const auto id = pixels(boundary.front());
+		auto new_object = std::find_if(begin(boundary), end(boundary), [&pixels, id](auto pos) {
+			return pixels(pos) != id;
 		});
 		std::rotate(begin(boundary), new_object, end(boundary));
 		
@@ -268,14 +326,54 @@ QImage FillTool::rasterizeMap(const QRectF& extent, QTransform& out_transform)
 	QImage image = QImage(image_size, QImage::Format_RGB32);
 	image.fill(background);
 	
-	// Draw map
-	RenderConfig::Options options = RenderConfig::DisableAntialiasing | RenderConfig::ForceMinSize;
-	RenderConfig config = { *map(), extent, view.calculateFinalZoomFactor(), options, 1.0 };
+	out_transform = view.worldTransform() * QTransform::fromTranslate(image_size.width() / 2.0, image_size.height() / 2.0);
+	
+	// Only path objects which may intersect the extent are relevant.
+	// The other objects are neither updated nor drawn.
+	auto part = map()->getCurrentPart();
+	auto num_objects = qMin(part->getNumObjects(), int(RGB_MASK));
+	std::vector<int> object_ids;
+	for (int o = 0; o < num_objects; ++o)
+	{
+		auto object = part->getObject(o);
+		if (object->getType() != Object::Path)
+			continue;
+		if (object->getSymbol() && object->getSymbol()->isHidden())
+			continue;
+		
+		object->update();
+		if (object->getExtent().intersects(extent))
+			object_ids.push_back(o);
+	}
+	auto force_update = [part, &object_ids]() {
+		for (auto o : object_ids)
+			part->getObject(o)->forceUpdate();
+	};
 	
-	QPainter painter;
-	painter.begin(&image);
-	painter.translate(image_size.width() / 2.0, image_size.height() / 2.0);
-	painter.setWorldTransform(view.worldTransform(), true);
+	// Draw the objects concurrently in horizontal bands of the image.
+	// Each band is painted through its own QImage which shares the pixel
+	// data of the full image.
+	auto const inverse_transform = out_transform.inverted();
+	auto const scaling = view.calculateFinalZoomFactor();
+	auto const options = RenderConfig::Options(RenderConfig::DisableAntialiasing | RenderConfig::ForceMinSize);
+	auto const num_bands = (image_size.height() + band_height - 1) / band_height;
+	auto* bits = image.bits();  // detach only once
+	auto draw_object_ids = [&]() {
+		Concurrency::parallelFor(0, num_bands, [&](int i) {
+			auto const top = i * band_height;
+			auto const height = qMin(band_height, image_size.height() - top);
+			QImage band(bits + top * image.bytesPerLine(), image_size.width(), height, image.bytesPerLine(), image.format());
+			
+			QPainter painter(&band);
+			painter.translate(0, -top);
+			painter.setWorldTransform(out_transform, true);
+			
+			// An extra pixel at the band border
+			auto const bounding_box = inverse_transform.mapRect(QRectF(-1, top - 1, image_size.width() + 2, height + 2));
+			RenderConfig config = { *map(), bounding_box, scaling, options, 1.0 };
+			drawObjectIDs(map(), object_ids, &painter, config);
+		});
+	};
 	
 	auto original_area_hatching = map()->isAreaHatchingEnabled();
 	if (original_area_hatching)
@@ -287,28 +385,25 @@ QImage FillTool::rasterizeMap(const QRectF& extent, QTransform& out_transform)
 	{
 		// Temporarily enable baseline view and draw map once.
 		map()->setBaselineViewEnabled(true);
-		map()->getCurrentPart()->applyOnAllObjects(&Object::forceUpdate);
-		drawObjectIDs(map(), &painter, config);
+		force_update();
+		draw_object_ids();
 		map()->setBaselineViewEnabled(false);
-		map()->getCurrentPart()->applyOnAllObjects(&Object::forceUpdate);
+		force_update();
 	}
 	else if (original_area_hatching)
 	{
-		map()->getCurrentPart()->applyOnAllObjects(&Object::forceUpdate);
+		force_update();
 	}
 	
 	// Draw the map in original mode (but without area hatching)
-	drawObjectIDs(map(), &painter, config);
+	draw_object_ids();
 	
 	if (original_area_hatching)
 	{
 		map()->setAreaHatchingEnabled(original_area_hatching);
-		map()->getCurrentPart()->applyOnAllObjects(&Object::forceUpdate);
+		force_update();
 	}
 	
-	out_transform = painter.combinedTransform();
-	painter.end();
-	
 #ifdef FILLTOOL_DEBUG_IMAGE
 	image.save(QDir::temp().absoluteFilePath(QString::fromLatin1(FILLTOOL_DEBUG_IMAGE)));
 #endif
@@ -316,32 +411,26 @@ QImage FillTool::rasterizeMap(const QRectF& extent, QTransform& out_transform)
 	return image;
 }
 
-void FillTool::drawObjectIDs(Map* map, QPainter* painter, const RenderConfig &config)
+void FillTool::drawObjectIDs(Map* map, const std::vector<int>& object_ids, QPainter* painter, const RenderConfig &config) const
 {
 	Q_STATIC_ASSERT(MapColor::Reserved == -1);
 	Q_ASSERT(!map->isAreaHatchingEnabled());
 	
 	auto part = map->getCurrentPart();
-	auto num_objects = qMin(part->getNumObjects(), int(RGB_MASK));
 	auto num_colors = map->getNumColors();
 	for (auto c = num_colors-1; c >= MapColor::Reserved; --c)
 	{
 		auto map_color = map->getColor(c);
-		for (int o = 0; o < num_objects; ++o)
+		for (auto o : object_ids)
 		{
 			auto object = part->getObject(o);
-			if (object->getType() != Object::Path)
-				continue;
 			if (auto symbol = object->getSymbol())
 			{
-				if (symbol->isHidden())
-					continue;
 				if (symbol->getType() == Symbol::Area
 				    && static_cast<const AreaSymbol*>(symbol)->getColor() != map_color)
 					continue;
 			}
 			
-			object->update();
 			object->renderables().draw(c, QRgb(o) | ~RGB_MASK, painter, config);
 		}
 	}
@@ -360,6 +449,7 @@ int FillTool::traceBoundary(const QImage& image, const QPoint& free_pixel, const
 	}
 #endif
 	
+	const PixelReader pixels(image);
 	out_boundary.clear();
 	out_boundary.reserve(4096);
 	out_boundary.push_back(boundary_pixel);
@@ -381,20 +471,22 @@ int FillTool::traceBoundary(const QImage& image, const QPoint& free_pixel, const
 		// Now analysing a 2x2 pixel block:
 		// | cur_free_pixel | cur_boundary_pixel |
 		// |  right_pixel   |     diag_pixel     |
+		// diag_pixel is inside the image when right_pixel is.
 		const auto diag_pixel = cur_boundary_pixel + right_vector;
-		if (image.pixel(right_pixel) == image.pixel(cur_boundary_pixel))
+		const auto right = pixels(right_pixel);
+		if (right == pixels(cur_boundary_pixel))
 		{
 			out_boundary.push_back(right_pixel);
 		}
-		else if (image.pixel(diag_pixel) != background)
+		else if (pixels(diag_pixel) != background)
 		{
 			out_boundary.push_back(diag_pixel);
-			if (image.pixel(right_pixel) == background)
+			if (right == background)
 				cur_free_pixel = right_pixel;
 			else
 				out_boundary.push_back(right_pixel);
 		}
-		else if (image.pixel(right_pixel) != background)
+		else if (right != background)
 		{
 			out_boundary.push_back(right_pixel);
 		}
@@ -451,13 +543,14 @@ bool FillTool::fillBoundary(const QImage& image, const std::vector<QPoint>& boun
 			path->connectPathParts(0, &part_copy, 0, false, false);
 	};
 	
+	const PixelReader pixels(image);
 	auto last_pixel = background; // no object
 	const auto pixel_length = PathCoord::length_type((image_to_map.map(QPointF(0, 0)) - image_to_map.map(QPointF(1, 1))).manhattanLength());
 	auto threshold = std::numeric_limits<PathCoord::length_type>::max();
 	auto section = PathSection{ nullptr, 0, 0, 0 };
 	for (const auto& point : boundary)
 	{
-		auto pixel = image.pixel(point);
+		auto pixel = pixels(point);
 		if (pixel == background)
 			continue;
 		
@@ -81,8 +81,12 @@ protected:
 	
 	/**
 	 * Helper method for rasterizeMap().
+	 * 
+	 * Draws the objects with the given indices in the current map part,
+	 * encoding the indices in the colors. The objects must be up to date.
+	 * This function may be called concurrently for different painters.
 	 */
-	void drawObjectIDs(Map* map, QPainter* painter, const RenderConfig& config);
+	void drawObjectIDs(Map* map, const std::vector<int>& object_ids, QPainter* painter, const RenderConfig& config) const;
 	
 	/**
 	 * Constructs the boundary around an area of free pixels in the given image.
@@ -21,9 +21,11 @@
 #include "object_selector.h"
 
 #include <algorithm>
-#include <cstddef>
+#include <iterator>
 #include <map>
 #include <memory>
+#include <set>
+#include <vector>
 
 #include <QRectF>
 
@@ -139,24 +141,37 @@ bool ObjectSelector::selectBox(const MapCoordF& corner1, const MapCoordF& corner
 	std::vector<Object*> objects;
 	map->findObjectsAtBox(corner1, corner2, false, false, objects);
 	
-	if (!toggle)
+	if (toggle)
 	{
-		if (map->getNumSelectedObjects() > 0)
-			selection_changed = true;
-		map->clearObjectSelection(false);
+		for (auto* object : objects)
+			map->toggleObjectSelection(object, false);
+		selection_changed = !objects.empty();
 	}
-	
-	auto size = objects.size();
-	for (std::size_t i = 0; i < size; ++i)
+	else
 	{
-		if (toggle)
-			map->toggleObjectSelection(objects[i], i == size - 1);
-		else
-			map->addObjectToSelection(objects[i], i == size - 1);
-			
-		selection_changed = true;
+		// Apply only the difference to the current selection, so that the
+		// selection renderables of unchanged objects are kept.
+		std::sort(begin(objects), end(objects));
+		auto const& selected_objects = map->selectedObjects();
+		std::vector<Object*> deselected;
+		std::set_difference(selected_objects.begin(), selected_objects.end(),
+		                    begin(objects), end(objects),
+		                    std::back_inserter(deselected));
+		for (auto* object : deselected)
+			map->removeObjectFromSelection(object, false);
+		
+		std::vector<Object*> selected;
+		std::set_difference(begin(objects), end(objects),
+		                    selected_objects.begin(), selected_objects.end(),
+		                    std::back_inserter(selected));
+		for (auto* object : selected)
+			map->addObjectToSelection(object, false);
+		
+		selection_changed = !deselected.empty() || !selected.empty();
 	}
 	
+	if (selection_changed)
+		map->emitSelectionChanged();
 	return selection_changed;
 }
 
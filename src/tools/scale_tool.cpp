@@ -29,6 +29,7 @@
 #include <QPixmap>
 #include <QRectF>
 #include <QString>
+#include <QTransform>
 
 #include "core/map.h"
 #include "core/map_view.h"
@@ -96,13 +97,13 @@ void ScaleTool::dragStart()
 	// WARNING: reference_length may become 0.
 	reference_length = (click_pos_map - scaling_center).length();
 	startEditing(map()->selectedObjects());
+	scaling_factor = 1;
+	objects_scaled = false;
 }
 
 
 void ScaleTool::dragMove()
 {
-	resetEditedObjects();
-	
 	// minimum_length will replace any shorter length, 
 	// in order to avoid extreme values and division by zero.
 	auto minimum_length = 1.0 / cur_map_widget->getMapView()->getZoom();
@@ -112,22 +113,40 @@ void ScaleTool::dragMove()
 
 	if (using_scaling_center)
 	{
-		for (auto* object : editedObjects())
-			object->scale(scaling_center, scaling_factor);		
+		// Common center: Display the scaled renderables from the start of
+		// editing. The objects are scaled in dragFinish().
+		if (objects_scaled)
+		{
+			resetEditedObjects();
+			updatePreviewObjects();
+			objects_scaled = false;
+		}
+		QTransform transform;
+		transform.translate(scaling_center.x(), scaling_center.y());
+		transform.scale(scaling_factor, scaling_factor);
+		transform.translate(-scaling_center.x(), -scaling_center.y());
+		setPreviewTransform(transform);
 	}
 	else
 	{
+		resetEditedObjects();
 		for (auto* object : editedObjects())
 			object->scale(MapCoordF(object->getExtent().center()), scaling_factor);
+		updatePreviewObjects();
+		objects_scaled = true;
 	}
 	
-	updatePreviewObjects();
 	updateStatusText();
 }
 
 
 void ScaleTool::dragFinish()
 {
+	if (!objects_scaled)
+	{
+		for (auto* object : editedObjects())
+			object->scale(scaling_center, scaling_factor);
+	}
 	finishEditing();
 	updateStatusText();
 }
@@ -71,6 +71,7 @@ protected:
 	double reference_length = 0;
 	double scaling_factor   = 1;
 	bool using_scaling_center = true;
+	bool objects_scaled = false;  ///< True when the edited objects are scaled individually.
 };
 
 
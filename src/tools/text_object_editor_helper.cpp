@@ -270,6 +270,9 @@ void TextObjectEditorHelper::updateDisplayText()
 	if (text_object->getText() != displayed_text)
 	{
 		text_object->setText(displayed_text);
+		// Keep the layout current for the cursor and selection geometry,
+		// even when the renderables are updated later.
+		text_object->prepareLineInfos();
 	}
 }
 
@@ -24,6 +24,7 @@
 #include <algorithm>
 #include <cstdlib>  // IWYU pragma: keep
 #include <iterator>
+#include <memory>
 #include <type_traits>
 
 #include <QtGlobal>
@@ -33,6 +34,7 @@
 #include <QEvent>
 #include <QKeyEvent>
 #include <QRectF>
+#include <QTransform>
 
 #include "core/map.h"
 #include "core/objects/object.h"
@@ -42,6 +44,8 @@
 #include "gui/widgets/key_button_bar.h"  // IWYU pragma: keep
 #include "tools/tool_helpers.h"
 #include "undo/object_undo.h"
+#include "undo/undo.h"
+#include "util/util.h"
 
 
 #ifdef __clang_analyzer__
@@ -331,6 +335,8 @@ void MapEditorToolBase::updateDirtyRect()
 	QRectF rect;
 	
 	map()->includeSelectionRect(rect);
+	if (!preview_transform.isIdentity() && rect.isValid())
+		rectInclude(rect, preview_transform.mapRect(rect));
 	if (angle_helper->isActive())
 	{
 		angle_helper->includeDirtyRect(rect);
@@ -463,6 +469,7 @@ void MapEditorToolBase::updatePreviewObjects()
 		qWarning("MapEditorToolBase::updatePreviewObjects() called but editing == false");
 		return;
 	}
+	preview_transform.reset();
 	for (auto object : editedObjects())
 	{
 		object->forceUpdate(); /// @todo get rid of force if possible;
@@ -487,9 +494,26 @@ void MapEditorToolBase::updatePreviewObjectsAsynchronously()
 	}
 }
 
+void MapEditorToolBase::setPreviewTransform(const QTransform& transform)
+{
+	if (!editingInProgress())
+	{
+		qWarning("MapEditorToolBase::setPreviewTransform() called but editing == false");
+		return;
+	}
+	
+	preview_transform = transform;
+	updateDirtyRect();
+}
+
+void MapEditorToolBase::translatePreviewObjects(qint32 dx, qint32 dy)
+{
+	setPreviewTransform(preview_transform * QTransform::fromTranslate(dx / 1000.0, dy / 1000.0));
+}
+
 void MapEditorToolBase::drawSelectionOrPreviewObjects(QPainter* painter, MapWidget* widget, bool draw_opaque)
 {
-	map()->drawSelection(painter, true, widget, renderables->empty() ? nullptr : renderables.get(), draw_opaque);
+	map()->drawSelection(painter, true, widget, renderables->empty() ? nullptr : renderables.get(), draw_opaque, preview_transform);
 }
 
 
@@ -557,6 +581,7 @@ void MapEditorToolBase::abortEditing()
 	edited_items.clear();
 	renderables->clear();
 	old_renderables->clear(true);
+	preview_transform.reset();
 	MapEditorTool::setEditingInProgress(false);
 }
 
@@ -567,19 +592,38 @@ void MapEditorToolBase::finishEditing()
 	
 	if (!edited_items.empty())
 	{
-		auto undo_step = new ReplaceObjectsUndoStep(map());
+		// Edits which only touch coordinates are recorded as deltas,
+		// avoiding full object copies in the undo history.
+		auto coords_step = std::make_unique<ObjectCoordsUndoStep>(map());
+		auto replace_step = std::make_unique<ReplaceObjectsUndoStep>(map());
 		for (auto& edited_item : edited_items)
 		{
 			auto object = edited_item.active_object;
 			object->setMap(map());
 			object->update();
-			undo_step->addObject(object, edited_item.duplicate.release());
+			if (!coords_step->addObject(object, *edited_item.duplicate))
+				replace_step->addObject(object, edited_item.duplicate.release());
 		}
 		edited_items.clear();
-		map()->push(undo_step);
+		if (replace_step->isEmpty())
+		{
+			map()->push(coords_step.release());
+		}
+		else if (coords_step->isEmpty())
+		{
+			map()->push(replace_step.release());
+		}
+		else
+		{
+			auto undo_step = new CombinedUndoStep(map());
+			undo_step->push(coords_step.release());
+			undo_step->push(replace_step.release());
+			map()->push(undo_step);
+		}
 	}
 	renderables->clear();
 	old_renderables->clear(true);
+	preview_transform.reset();
 	
 	MapEditorTool::finishEditing();
 	map()->setObjectsDirty();
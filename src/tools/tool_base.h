@@ -33,6 +33,7 @@
 #include <QPoint>
 #include <QPointF>
 #include <QString>
+#include <QTransform>
 
 #include <QPointer>
 
@@ -243,6 +244,16 @@ protected:
 	/// This method delays the actual redraw by a short amount of time to reduce the load when editing many objects.
 	void updatePreviewObjectsAsynchronously();
 	
+	/// Call this to display a transformation of the preview objects, in map coordinates, without modifying them.
+	/// The latest preview renderables, or the selection renderables from the start of editing, are drawn with
+	/// the transformation instead of being regenerated. Thus the cost does not depend on the number of objects.
+	/// updatePreviewObjects() and finish/abortEditing() reset the transformation.
+	void setPreviewTransform(const QTransform& transform);
+	
+	/// Call this to display a translation of the preview objects by the given offset, in native map coordinates,
+	/// after they have been moved by this offset. Cf. setPreviewTransform().
+	void translatePreviewObjects(qint32 dx, qint32 dy);
+	
 	/// If the tool created custom renderables (e.g. with updatePreviewObjects()), draws the preview renderables,
 	/// else draws the renderables of the selected map objects.
 	void drawSelectionOrPreviewObjects(QPainter* painter, MapWidget* widget, bool draw_opaque = false);
@@ -340,6 +351,8 @@ private:
 	bool dragging_canceled        = false;
 	std::unique_ptr<MapRenderables> renderables;
 	std::unique_ptr<MapRenderables> old_renderables;
+	/// The transformation from the drawn renderables to the preview objects.
+	QTransform preview_transform;
 	std::vector<EditedItem> edited_items;
 };
 
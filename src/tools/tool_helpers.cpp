@@ -21,7 +21,9 @@
 
 #include "tool_helpers.h"
 
+#include <algorithm>
 #include <cmath>
+#include <iterator>
 #include <limits>
 #include <utility>
 #include <vector>
@@ -337,17 +339,37 @@ MapCoord SnappingToolHelper::snapToObject(const MapCoordF& position, MapWidget*
 	
 	if (filter & (ObjectCorners | ObjectPaths))
 	{
-		// Find map objects at the given position
-		SelectionInfoVector objects;
-		map->findAllObjectsAt(position, snap_distance, true, false, false, true, objects);
+		// Find map objects near the given position. Only the spatial index
+		// is queried here: the distance calculations below are precise.
+		std::vector<Object*> objects;
+		map->findAllObjectsNear(position, snap_distance, false, true, objects);
+		
+		// Visit the candidates by the distance of their extent, so that the
+		// remaining ones can be skipped as soon as a closer spot was found.
+		auto const extent_distance_sq = [&position](const Object* object) {
+			auto const& extent = object->getExtent();
+			auto const dx = qMax(qreal(0), qMax(extent.left() - position.x(), position.x() - extent.right()));
+			auto const dy = qMax(qreal(0), qMax(extent.top() - position.y(), position.y() - extent.bottom()));
+			return dx * dx + dy * dy;
+		};
+		std::vector<std::pair<qreal, Object*>> candidates;
+		candidates.reserve(objects.size());
+		for (auto* object : objects)
+		{
+			if (object != exclude_object && object->getType() != Object::Text)
+				candidates.emplace_back(extent_distance_sq(object), object);
+		}
+		std::stable_sort(begin(candidates), end(candidates), [](const auto& a, const auto& b) {
+			return a.first < b.first;
+		});
 		
 		// Find closest snap spot from map objects
-		for (const auto& info : objects)
+		for (const auto& candidate : candidates)
 		{
-			Object* object = info.second;
-			if (object == exclude_object)
-				continue;
+			if (candidate.first >= closest_distance_sq)
+				break;
 			
+			Object* object = candidate.second;
 			if (object->getType() == Object::Point && filter & ObjectCorners)
 			{
 				PointObject* point = object->asPoint();
@@ -580,6 +602,8 @@ std::unique_ptr<PathObject> FollowPathToolHelper::updateFollowing(const PathCoor
 	
 	if (path && path->findPartIndexForIndex(end_coord.index) == part_index)
 	{
+		path->ensurePathCoords();
+		
 		// Update end_clen
 		auto const new_end_clen = end_coord.clen;
 		const auto& part = path->parts()[part_index];
@@ -614,17 +638,19 @@ std::unique_ptr<PathObject> FollowPathToolHelper::updateFollowing(const PathCoor
 		end_clen = new_end_clen;
 		if (end_clen != start_clen)
 		{
-			// Create output path
-			result = std::make_unique<PathObject>(part);
+			// Create output path from the followed section only,
+			// without copying the whole part or updating the copy.
+			MapCoordVector coords;
 			if (drag_forward)
-			{
-				result->changePathBounds(0, start_clen, end_clen);
-			}
+				part.copySection(start_clen, end_clen, coords);
 			else
-			{
-				result->changePathBounds(0, end_clen, start_clen);
+				part.copySection(end_clen, start_clen, coords);
+			coords.back().setHolePoint(true);
+			coords.back().setClosePoint(false);
+			
+			result = std::make_unique<PathObject>(path->getSymbol(), std::move(coords));
+			if (!drag_forward)
 				result->reverse();
-			}
 		}
 	}
 	
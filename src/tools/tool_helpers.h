@@ -317,6 +317,9 @@ public:
 	 * Returns a pointer that owns nothing if the following failed, e.g.
 	 * because the path coord is on another path part than the beginning or
 	 * path and end are the same.
+	 * 
+	 * The result is built from the followed section only, so the cost
+	 * does not depend on the size of the followed path. It is not updated.
 	 */
 	std::unique_ptr<PathObject> updateFollowing(const PathCoord& end_coord);
 	
@@ -22,6 +22,9 @@
 #include "object_undo.h"
 
 #include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <utility>
 
 #include "core/map.h"
 #include "core/objects/object.h"
@@ -36,6 +39,8 @@ namespace literal
 	const QLatin1String source("source");
 	const QLatin1String part("part");
 	const QLatin1String reverse("reverse");
+	const QLatin1String first("first");
+	const QLatin1String length("length");
 }
 
 
@@ -98,6 +103,28 @@ void ObjectModifyingUndoStep::getModifiedObjects(int part_index, ObjectSet& out)
 	}
 }
 
+std::size_t ObjectModifyingUndoStep::memoryUsage() const
+{
+	return sizeof(ObjectModifyingUndoStep) + modified_objects.capacity() * sizeof(int);
+}
+
+
+bool ObjectModifyingUndoStep::modifiesSameObjects(const UndoStep& other) const
+{
+	if (other.getType() != getType())
+		return false;
+	
+	auto const& other_step = static_cast<const ObjectModifyingUndoStep&>(other);
+	if (other_step.part_index != part_index || other_step.modified_objects.size() != modified_objects.size())
+		return false;
+	
+	auto objects = modified_objects;
+	auto other_objects = other_step.modified_objects;
+	std::sort(begin(objects), end(objects));
+	std::sort(begin(other_objects), end(other_objects));
+	return objects == other_objects;
+}
+
 
 
 void ObjectModifyingUndoStep::saveImpl(QXmlStreamWriter& xml) const
@@ -173,9 +200,7 @@ ObjectCreatingUndoStep::ObjectCreatingUndoStep(Type type, Map* map)
 
 ObjectCreatingUndoStep::~ObjectCreatingUndoStep()
 {
-	int size = (int)objects.size();
-	for (int i = 0; i < size; ++i)
-		delete objects[i];
+	Object::deleteObjects(std::move(objects));
 }
 
 bool ObjectCreatingUndoStep::isValid() const
@@ -209,6 +234,16 @@ void ObjectCreatingUndoStep::getModifiedObjects(int part_index, ObjectSet& out)
 		out.insert(objects.begin(), objects.end());
 }
 
+std::size_t ObjectCreatingUndoStep::memoryUsage() const
+{
+	auto bytes = ObjectModifyingUndoStep::memoryUsage()
+	             + sizeof(ObjectCreatingUndoStep) - sizeof(ObjectModifyingUndoStep)
+	             + objects.capacity() * sizeof(Object*);
+	for (const auto* object : objects)
+		bytes += object->memoryUsage();
+	return bytes;
+}
+
 void ObjectCreatingUndoStep::saveImpl(QXmlStreamWriter& xml) const
 {
 	ObjectModifyingUndoStep::saveImpl(xml);
@@ -304,6 +339,12 @@ UndoStep* ReplaceObjectsUndoStep::undo()
 	return undo_step;
 }
 
+bool ReplaceObjectsUndoStep::absorbs(const UndoStep& other) const
+{
+	// This step holds complete copies of the objects.
+	return modifiesSameObjects(other);
+}
+
 
 
 // ### DeleteObjectsUndoStep ###
@@ -579,6 +620,13 @@ UndoStep* SwitchSymbolUndoStep::undo()
 	return undo_step;
 }
 
+std::size_t SwitchSymbolUndoStep::memoryUsage() const
+{
+	return ObjectModifyingUndoStep::memoryUsage()
+	       + sizeof(SwitchSymbolUndoStep) - sizeof(ObjectModifyingUndoStep)
+	       + target_symbols.capacity() * sizeof(const Symbol*);
+}
+
 
 
 void SwitchSymbolUndoStep::saveImpl(QXmlStreamWriter& xml) const
@@ -707,23 +755,61 @@ void ObjectTagsUndoStep::addObject(int index)
 	object_tags_map[index] = map_part->getObject(index)->tags();
 }
 
+void ObjectTagsUndoStep::replaceTags(const std::vector<std::pair<int, Object::Tags>>& new_tags)
+{
+	MapPart* const map_part = map->getPart(getPartIndex());
+	
+	// Unlike Object::setTags(), this doesn't emit a signal for each object.
+	auto modified = false;
+	auto selection_edited = false;
+	for (const auto& object_tags : new_tags)
+	{
+		addObject(object_tags.first);
+		Object* const object = map_part->getObject(object_tags.first);
+		if (object->object_tags != object_tags.second)
+		{
+			auto const old_tags = object->object_tags;
+			object->object_tags = object_tags.second;
+			map->objectTagsChanged(object, old_tags);
+			modified = true;
+			selection_edited = selection_edited || map->isObjectSelected(object);
+		}
+	}
+	
+	if (modified)
+		map->setObjectsDirty();
+	if (selection_edited)
+		map->emitSelectionEdited();
+}
+
 UndoStep* ObjectTagsUndoStep::undo()
 {
 	int const part_index = getPartIndex();
 	
 	ObjectTagsUndoStep* redo_step = new ObjectTagsUndoStep(map);
-	MapPart* const map_part = map->getPart(part_index);
-	
 	redo_step->setPartIndex(part_index);
-	for (const auto& object_tags : object_tags_map)
-	{
-		redo_step->addObject(object_tags.first);
-		map_part->getObject(object_tags.first)->setTags(object_tags.second);
-	}
+	redo_step->replaceTags({ begin(object_tags_map), end(object_tags_map) });
 	
 	return redo_step;
 }
 
+std::size_t ObjectTagsUndoStep::memoryUsage() const
+{
+	// A tree node holds the value and three pointers.
+	constexpr auto node_overhead = 3 * sizeof(void*);
+	auto bytes = ObjectModifyingUndoStep::memoryUsage()
+	             + sizeof(ObjectTagsUndoStep) - sizeof(ObjectModifyingUndoStep);
+	for (const auto& entry : object_tags_map)
+		bytes += sizeof(entry) + node_overhead + std::size_t(entry.second.size()) * sizeof(ObjectTag);
+	return bytes;
+}
+
+bool ObjectTagsUndoStep::absorbs(const UndoStep& other) const
+{
+	// This step holds complete copies of the tags.
+	return modifiesSameObjects(other);
+}
+
 void ObjectTagsUndoStep::saveObject(XmlElementWriter& xml, int index) const
 {
 	/// \todo Write tags in deterministic order
@@ -736,4 +822,127 @@ void ObjectTagsUndoStep::loadObject(XmlElementReader& xml, int index)
 }
 
 
+
+
+// ### ObjectCoordsUndoStep ###
+
+ObjectCoordsUndoStep::ObjectCoordsUndoStep(Map* map)
+: ObjectModifyingUndoStep(ObjectCoordsUndoStepType, map)
+{
+	; // nothing else
+}
+
+ObjectCoordsUndoStep::~ObjectCoordsUndoStep()
+{
+	; // nothing
+}
+
+void ObjectCoordsUndoStep::addObject(int)
+{
+	qWarning("This implementation must not be called");
+}
+
+bool ObjectCoordsUndoStep::addObject(const Object* existing, const Object& original)
+{
+	if (existing->getType() != Object::Path
+	    || original.getType() != Object::Path
+	    || existing->getSymbol() != original.getSymbol()
+	    || existing->getRotation() != original.getRotation()
+	    || existing->tags() != original.tags())
+	{
+		return false;
+	}
+	
+	auto const* path = existing->asPath();
+	auto const* original_path = original.asPath();
+	if (path->getPatternRotation() != original_path->getPatternRotation()
+	    || path->getPatternOrigin() != original_path->getPatternOrigin())
+	{
+		return false;
+	}
+	
+	auto const index = map->getPart(getPartIndex())->findObjectIndex(existing);
+	if (index < 0 || deltas.find(index) != deltas.end())
+		return false;
+	
+	// Find the common prefix and suffix of the coordinates.
+	auto const& current = existing->getRawCoordinateVector();
+	auto const& old = original.getRawCoordinateVector();
+	auto const common = std::min(current.size(), old.size());
+	auto const first = MapCoordVector::size_type(std::mismatch(begin(current), begin(current) + common, begin(old)).first - begin(current));
+	auto last = MapCoordVector::size_type(0);
+	while (last < common - first && current[current.size() - 1 - last] == old[old.size() - 1 - last])
+		++last;
+	
+	addDelta(index, { first, current.size() - first - last, MapCoordVector(begin(old) + first, end(old) - last) });
+	return true;
+}
+
+void ObjectCoordsUndoStep::addDelta(int index, CoordsDelta delta)
+{
+	ObjectModifyingUndoStep::addObject(index);
+	deltas[index] = std::move(delta);
+}
+
+UndoStep* ObjectCoordsUndoStep::undo()
+{
+	int const part_index = getPartIndex();
+	
+	auto* redo_step = new ObjectCoordsUndoStep(map);
+	redo_step->setPartIndex(part_index);
+	
+	MapPart* const map_part = map->getPart(part_index);
+	for (auto& item : deltas)
+	{
+		auto* object = map_part->getObject(item.first);
+		auto& coords = object->coords;
+		auto const& delta = item.second;
+		if (delta.first > coords.size() || delta.length > coords.size() - delta.first)
+		{
+			qWarning("Invalid coordinates range in undo step");
+			continue;
+		}
+		
+		auto const range_begin = begin(coords) + std::ptrdiff_t(delta.first);
+		auto const range_end = range_begin + std::ptrdiff_t(delta.length);
+		redo_step->addDelta(item.first, { delta.first, delta.coords.size(), MapCoordVector(range_begin, range_end) });
+		coords.insert(coords.erase(range_begin, range_end), begin(delta.coords), end(delta.coords));
+		
+		auto* path = object->asPath();
+		path->recalculateParts();
+		path->setOutputDirty();
+		path->update();
+	}
+	
+	return redo_step;
+}
+
+std::size_t ObjectCoordsUndoStep::memoryUsage() const
+{
+	// A tree node holds the value and three pointers.
+	constexpr auto node_overhead = 3 * sizeof(void*);
+	auto bytes = ObjectModifyingUndoStep::memoryUsage()
+	             + sizeof(ObjectCoordsUndoStep) - sizeof(ObjectModifyingUndoStep);
+	for (const auto& entry : deltas)
+		bytes += sizeof(entry) + node_overhead + entry.second.coords.capacity() * sizeof(MapCoord);
+	return bytes;
+}
+
+void ObjectCoordsUndoStep::saveObject(XmlElementWriter& xml, int index) const
+{
+	auto const& delta = deltas.at(index);
+	xml.writeAttribute(literal::first, delta.first);
+	xml.writeAttribute(literal::length, delta.length);
+	xml.write(delta.coords);
+}
+
+void ObjectCoordsUndoStep::loadObject(XmlElementReader& xml, int index)
+{
+	auto& delta = deltas[index];
+	delta.first = xml.attribute<MapCoordVector::size_type>(literal::first);
+	delta.length = xml.attribute<MapCoordVector::size_type>(literal::length);
+	xml.read(delta.coords);
+}
+
+
 }  // namespace OpenOrienteering
@@ -105,6 +105,8 @@ public:
 	 */
 	void getModifiedObjects(int part_index, ObjectSet& out) const override;
 	
+	std::size_t memoryUsage() const override;
+	
 	
 protected:
 	/**
@@ -138,6 +140,12 @@ protected:
 	 */
 	virtual void loadObject(XmlElementReader& xml, int index);
 	
+	/**
+	 * Returns true if the other step has the same type as this step, and
+	 * if it modifies the same objects.
+	 */
+	bool modifiesSameObjects(const UndoStep& other) const;
+	
 	
 private:
 	/**
@@ -213,6 +221,11 @@ public:
 	 */
 	void getModifiedObjects(int, ObjectSet&) const override;
 	
+	/**
+	 * Returns the memory used by this step, including the objects it holds.
+	 */
+	std::size_t memoryUsage() const override;
+	
 	
 public slots:
 	/**
@@ -262,6 +275,11 @@ public:
 	
 	UndoStep* undo() override;
 	
+	/**
+	 * Returns true if the other step replaces the same objects.
+	 */
+	bool absorbs(const UndoStep& other) const override;
+	
 private:
 	bool undone;
 };
@@ -369,6 +387,8 @@ public:
 	
 	UndoStep* undo() override;
 	
+	std::size_t memoryUsage() const override;
+	
 	
 public slots:
 	virtual void symbolChanged(int pos, const OpenOrienteering::Symbol* new_symbol, const OpenOrienteering::Symbol* old_symbol);
@@ -416,8 +436,24 @@ public:
 	
 	void addObject(int index) override;
 	
+	/**
+	 * Replaces the tags of objects of the step's part.
+	 * 
+	 * The current tags of the objects are added to this step. When any
+	 * selected object is modified, Map::selectedObjectEdited() is emitted
+	 * once, after all objects are modified.
+	 */
+	void replaceTags(const std::vector<std::pair<int, Object::Tags>>& new_tags);
+	
 	UndoStep* undo() override;
 	
+	std::size_t memoryUsage() const override;
+	
+	/**
+	 * Returns true if the other step modifies the tags of the same objects.
+	 */
+	bool absorbs(const UndoStep& other) const override;
+	
 protected:
 	void saveObject(XmlElementWriter& xml, int index) const override;
 	
@@ -429,6 +465,67 @@ protected:
 };
 
 
+/**
+ * Undo step which restores the coordinates of path objects.
+ * 
+ * Instead of a full copy of each object, this step stores only the range of
+ * coordinates which differs between the object's current and original state.
+ * Thus its size is proportional to the modification.
+ */
+class ObjectCoordsUndoStep : public ObjectModifyingUndoStep
+{
+public:
+	ObjectCoordsUndoStep(Map* map);
+	
+	~ObjectCoordsUndoStep() override;
+	
+	/**
+	 * Must not be called.
+	 * 
+	 * Use the two-parameter signature instead of this one.
+	 */
+	void addObject(int index) override;
+	
+	/**
+	 * Adds the difference between an existing path object of the step's part
+	 * and its original state.
+	 * 
+	 * Returns false, and does not add the object, if the objects are not paths,
+	 * or if they differ in anything but their coordinates.
+	 */
+	bool addObject(const Object* existing, const Object& original);
+	
+	UndoStep* undo() override;
+	
+	std::size_t memoryUsage() const override;
+	
+protected:
+	void saveObject(XmlElementWriter& xml, int index) const override;
+	
+	void loadObject(XmlElementReader& xml, int index) override;
+	
+	/**
+	 * A range of coordinates to be restored.
+	 * 
+	 * When undoing, length coordinates starting at first are replaced by
+	 * the given coords.
+	 */
+	struct CoordsDelta
+	{
+		MapCoordVector::size_type first;
+		MapCoordVector::size_type length;
+		MapCoordVector coords;
+	};
+	
+	void addDelta(int index, CoordsDelta delta);
+	
+	typedef std::map<int, CoordsDelta> CoordsDeltaMap;
+	
+	CoordsDeltaMap deltas;
+};
+
+
+
 // ### ObjectModifyingUndoStep inline code ###
 
 inline
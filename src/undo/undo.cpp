@@ -21,6 +21,7 @@
 
 #include "undo.h"
 
+#include <cstddef>
 #include <vector>
 
 #include <QXmlStreamReader>
@@ -71,6 +72,9 @@ UndoStep* UndoStep::getUndoStepForType(Type type, Map* map)
 	case ObjectTagsUndoStepType:
 		return new ObjectTagsUndoStep(map);
 		
+	case ObjectCoordsUndoStepType:
+		return new ObjectCoordsUndoStep(map);
+		
 	case SwitchPartUndoStepType:
 		return new SwitchPartUndoStep(map);
 		
@@ -114,6 +118,16 @@ void UndoStep::getModifiedObjects(int, ObjectSet&) const
 	; // nothing
 }
 
+std::size_t UndoStep::memoryUsage() const
+{
+	return sizeof(UndoStep);
+}
+
+bool UndoStep::absorbs(const UndoStep& /*other*/) const
+{
+	return false;
+}
+
 // static
 UndoStep* UndoStep::load(QXmlStreamReader& xml, Map* map, SymbolDictionary& symbol_dict)
 {
@@ -197,6 +211,14 @@ void CombinedUndoStep::getModifiedObjects(int part_index, ObjectSet &out) const
 	}
 }
 
+std::size_t CombinedUndoStep::memoryUsage() const
+{
+	auto bytes = sizeof(CombinedUndoStep) + steps.capacity() * sizeof(UndoStep*);
+	for (const auto* step : steps)
+		bytes += step->memoryUsage();
+	return bytes;
+}
+
 
 
 void CombinedUndoStep::saveImpl(QXmlStreamWriter& xml) const
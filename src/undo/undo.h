@@ -24,6 +24,7 @@
 
 #include "core/symbols/symbol.h"
 
+#include <cstddef>
 #include <set>
 #include <vector>
 
@@ -67,6 +68,7 @@ public:
 		MapPartUndoStepType        =   8,
 		SwitchPartUndoStepTypeV0   =   9,
 		SwitchPartUndoStepType     =  10,
+		ObjectCoordsUndoStepType   =  11,
 		InvalidUndoStepType        = 999
 	};
 	
@@ -156,6 +158,27 @@ public:
 	virtual void getModifiedObjects(int part_index, ObjectSet& out) const;
 	
 	
+	/**
+	 * Returns an estimate of the memory used by this step, in bytes.
+	 * 
+	 * The default implementation returns the size of the UndoStep object.
+	 */
+	virtual std::size_t memoryUsage() const;
+	
+	
+	/**
+	 * Returns true if undoing this step also undoes the given step,
+	 * which was pushed just after this one.
+	 * 
+	 * This is the case when this step restores the complete state of all
+	 * objects which are modified by the other step. Then the other step
+	 * can be dropped in order to coalesce the steps.
+	 * 
+	 * The default implementation returns false.
+	 */
+	virtual bool absorbs(const UndoStep& other) const;
+	
+	
 	/**
 	 * Loads the undo step from the stream in xml format.
 	 */
@@ -243,6 +266,11 @@ public:
 	 */
 	void getModifiedObjects(int part_index, ObjectSet& out) const override;
 	
+	/**
+	 * Returns the memory used by this step and by all sub steps.
+	 */
+	std::size_t memoryUsage() const override;
+	
 	
 	/** 
 	 * Returns the number of sub steps.
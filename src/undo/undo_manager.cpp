@@ -22,6 +22,7 @@
 #include "undo_manager.h"
 
 #include <algorithm>
+#include <cstddef>
 #include <iterator>
 #include <limits>
 #include <set>
@@ -29,12 +30,18 @@
 
 #include <Qt>
 #include <QtGlobal>
+#include <QDir>
 #include <QLatin1String>
 #include <QMessageBox>
 #include <QStringRef>
+#include <QTemporaryFile>
+#include <QVariant>
 #include <QXmlStreamReader>
+#include <QXmlStreamWriter>
 
+#include "settings.h"
 #include "core/map.h"
+#include "fileformats/file_format.h"
 #include "undo/undo.h"
 #include "util/xml_stream_util.h"
 
@@ -42,6 +49,21 @@
 namespace OpenOrienteering {
 
 Q_STATIC_ASSERT(UndoManager::max_undo_steps < std::numeric_limits<int>::max());
+Q_STATIC_ASSERT(UndoManager::max_saved_steps <= UndoManager::max_undo_steps);
+
+
+namespace {
+
+/** The compression level for spilled steps: fast, and good for XML. */
+constexpr int spill_compression = 1;
+
+std::size_t budgetFromSettings()
+{
+	auto const mebibytes = Settings::getInstance().getSetting(Settings::General_UndoMemoryLimit).toInt();
+	return mebibytes > 0 ? std::size_t(mebibytes) * 1024 * 1024 : UndoManager::default_memory_budget;
+}
+
+}  // namespace
 
 
 // ### UndoManager::State ###
@@ -57,6 +79,14 @@ UndoManager::State::State(UndoManager const *manager)
 
 
 
+// ### UndoManager::DeferredSteps ###
+
+UndoManager::DeferredSteps::DeferredSteps() = default;
+
+UndoManager::DeferredSteps::~DeferredSteps() = default;
+
+
+
 // ### UndoManager ###
 
 UndoManager::UndoManager(Map* map)
@@ -73,6 +103,11 @@ UndoManager::UndoManager(Map* map)
 			validateUndoSteps();
 			validateRedoSteps();
 		}, Qt::QueuedConnection);
+		
+		memory_budget = budgetFromSettings();
+		connect(&Settings::getInstance(), &Settings::settingsChanged, this, [this]() {
+			setMemoryBudget(budgetFromSettings());
+		});
 	}
 }
 
@@ -86,11 +121,13 @@ UndoManager::~UndoManager()
 
 void UndoManager::clear()
 {
-	if (!undo_steps.empty())
+	if (!undo_steps.empty() || deferred)
 	{
 		UndoManager::State const old_state(this);
 		
 		undo_steps.erase(begin(undo_steps), end(undo_steps));
+		deferred.reset();
+		coalescing_operation.clear();
 		current_index = 0;
 		clean_state_index = old_state.is_clean ? 0 : -1;
 		loaded_state_index = old_state.is_loaded ? 0 : -1;
@@ -99,6 +136,7 @@ void UndoManager::clear()
 	}
 	
 	Q_ASSERT(undo_steps.empty());
+	Q_ASSERT(!deferred);
 }
 
 
@@ -113,19 +151,59 @@ void UndoManager::push(std::unique_ptr<UndoStep>&& step)
 	undo_steps.emplace_back(std::move(step));
 	++current_index;
 	validateUndoSteps();
+	spillUndoSteps();
+	coalescing_operation.clear();
 	emitChangedSignals(old_state);
 }
 
 
+void UndoManager::push(std::unique_ptr<UndoStep>&& step, const QString& operation)
+{
+	Q_ASSERT(step);
+	
+	if (!operation.isEmpty()
+	    && operation == coalescing_operation
+	    && coalescing_timer.elapsed() < coalescing_interval
+	    && current_index > 0
+	    && redoStepCount() == 0
+	    && !isClean()
+	    && !isLoaded()
+	    && undo_steps[StepList::size_type(current_index) - 1]->absorbs(*step))
+	{
+		// Undoing the previous step also reverts this step.
+		coalescing_timer.start();
+		return;
+	}
+	
+	push(std::move(step));
+	coalescing_operation = operation;
+	coalescing_timer.start();
+}
+
+
 
 bool UndoManager::canUndo() const
 {
-	return current_index > 0 && nextUndoStep()->isValid();
+	if (current_index == 0)
+		return deferred && deferred->undo.num_steps > 0;
+	return nextUndoStep()->isValid();
 }
 
 
 bool UndoManager::undo(QWidget* dialog_parent)
 {
+	// Spilled steps are loaded when undo reaches them.
+	if (deferred && (!deferred->spill_file || current_index == 0))
+	{
+		if (!loadDeferredSteps())
+		{
+			QMessageBox::warning(dialog_parent, tr("Error"), tr("Cannot undo because the saved undo steps could not be loaded."));
+			return false;
+		}
+		if (!canUndo())
+			return false;
+	}
+	
 	UndoManager::State const old_state(this);
 	
 	if (!old_state.can_undo)
@@ -150,9 +228,14 @@ bool UndoManager::undo(QWidget* dialog_parent)
 		}
 	}
 	
-	UndoStep* redo_step = step->undo();
+	UndoStep* redo_step = nullptr;
+	{
+		Map::DirtyAreaBatch batch(*map);
+		redo_step = step->undo();
+	}
 	updateMapState(step);
 	
+	coalescing_operation.clear();
 	--current_index;
 	undo_steps[StepList::size_type(current_index)].reset(redo_step);
 	
@@ -165,12 +248,26 @@ bool UndoManager::undo(QWidget* dialog_parent)
 
 bool UndoManager::canRedo() const
 {
-	return current_index < int(undo_steps.size()) && nextRedoStep()->isValid();
+	if (current_index == int(undo_steps.size()))
+		return deferred && deferred->redo.num_steps > 0;
+	return nextRedoStep()->isValid();
 }
 
 
 bool UndoManager::redo(QWidget* dialog_parent)
 {
+	// Spilled steps imply that there are no deferred redo steps.
+	if (deferred && !deferred->spill_file)
+	{
+		if (!loadDeferredSteps())
+		{
+			QMessageBox::warning(dialog_parent, tr("Error"), tr("Cannot redo because the saved redo steps could not be loaded."));
+			return false;
+		}
+		if (!canRedo())
+			return false;
+	}
+	
 	UndoManager::State const old_state(this);
 	
 	if (!old_state.can_redo)
@@ -187,9 +284,14 @@ bool UndoManager::redo(QWidget* dialog_parent)
 		return false;
 	}
 	
-	UndoStep* undo_step = step->undo();
+	UndoStep* undo_step = nullptr;
+	{
+		Map::DirtyAreaBatch batch(*map);
+		undo_step = step->undo();
+	}
 	updateMapState(step);
 	
+	coalescing_operation.clear();
 	undo_steps[StepList::size_type(current_index)].reset(undo_step);
 	++current_index;
 	
@@ -208,6 +310,8 @@ bool UndoManager::isClean() const
 
 void UndoManager::setClean()
 {
+	if (deferred)
+		deferred->clean_state_offset = 0;
 	if (!isClean())
 	{
 		clean_state_index = current_index;
@@ -225,6 +329,8 @@ bool UndoManager::isLoaded() const
 
 void UndoManager::setLoaded()
 {
+	if (deferred)
+		deferred->loaded_state_offset = 0;
 	if (!isLoaded())
 	{
 		loaded_state_index = current_index;
@@ -236,12 +342,14 @@ void UndoManager::setLoaded()
 
 int UndoManager::undoStepCount() const
 {
-	return current_index;
+	return current_index + (deferred ? deferred->undo.num_steps : 0);
 }
 
 
 UndoStep* UndoManager::nextUndoStep() const
 {
+	if (current_index == 0 && deferred)
+		const_cast<UndoManager*>(this)->loadDeferredSteps();
 	Q_ASSERT(current_index > 0);
 	return undo_steps[StepList::size_type(current_index) - 1].get();
 }
@@ -250,17 +358,42 @@ UndoStep* UndoManager::nextUndoStep() const
 
 int UndoManager::redoStepCount() const
 {
-	return int(undo_steps.size()) - current_index;
+	return int(undo_steps.size()) - current_index + (deferred ? deferred->redo.num_steps : 0);
 }
 
 
 UndoStep* UndoManager::nextRedoStep() const
 {
+	if (StepList::size_type(current_index) == undo_steps.size() && deferred)
+		const_cast<UndoManager*>(this)->loadDeferredSteps();
 	Q_ASSERT(StepList::size_type(current_index) < undo_steps.size());
 	return undo_steps[StepList::size_type(current_index)].get();
 }
 
 
+std::size_t UndoManager::memoryUsage() const
+{
+	auto bytes = undo_steps.capacity() * sizeof(StepList::value_type);
+	for (const auto& step : undo_steps)
+		bytes += step->memoryUsage();
+	if (deferred)
+		bytes += sizeof(DeferredSteps) + std::size_t(deferred->undo.xml.capacity() + deferred->redo.xml.capacity());
+	return bytes;
+}
+
+
+void UndoManager::setMemoryBudget(std::size_t bytes)
+{
+	memory_budget = bytes;
+}
+
+
+bool UndoManager::hasSpilledSteps() const
+{
+	return deferred && deferred->spill_file;
+}
+
+
 
 void UndoManager::updateMapState(const UndoStep *step) const
 {
@@ -268,6 +401,10 @@ void UndoManager::updateMapState(const UndoStep *step) const
 	if (!map)
 		return;
 	
+	// Let the map register the change. Its unsaved state is updated
+	// by the cleanChanged() signal.
+	map->setObjectsDirty();
+	
 	// Make a modified part the current one
 	UndoStep::PartSet result_parts;
 	bool have_modified_objects = step->getModifiedParts(result_parts);
@@ -288,6 +425,13 @@ void UndoManager::updateMapState(const UndoStep *step) const
 
 void UndoManager::clearRedoSteps()
 {
+	if (deferred && deferred->redo.num_steps > 0)
+	{
+		// Deferred redo steps imply that there are no loaded redo steps.
+		clearDeferredRedoSteps();
+		emit canRedoChanged(false);
+	}
+	
 	if (current_index < int(undo_steps.size()))
 	{
 		undo_steps.erase(begin(undo_steps) + StepList::difference_type(current_index), end(undo_steps));
@@ -303,6 +447,23 @@ void UndoManager::clearRedoSteps()
 
 void UndoManager::validateUndoSteps()
 {
+	if (deferred && deferred->undo.num_steps > 0)
+	{
+		// The deferred undo steps are reachable only via valid loaded steps.
+		auto const last = begin(undo_steps) + current_index;
+		if (std::any_of(begin(undo_steps), last, [](auto&& step) { return !step->isValid(); }))
+			deferred->undo.num_steps = 0;
+		else
+			deferred->undo.num_steps = std::min(deferred->undo.num_steps, int(max_undo_steps) - current_index);
+		
+		if (deferred->undo.num_steps <= 0)
+		{
+			clearDeferredUndoSteps();
+			if (current_index == 0)
+				emit canUndoChanged(false);
+		}
+	}
+	
 	if (current_index > 0)
 	{
 		int num_removed_undo_steps = 0;
@@ -334,6 +495,105 @@ void UndoManager::validateUndoSteps()
 	}
 }
 
+void UndoManager::spillUndoSteps()
+{
+	// The latest undo step stays in memory.
+	if (!map || current_index <= 1)
+		return;
+	
+	auto const loaded_bytes = [this]() {
+		auto bytes = std::size_t(0);
+		for (const auto& step : undo_steps)
+			bytes += step->memoryUsage();
+		return bytes;
+	};
+	auto bytes = loaded_bytes();
+	if (bytes <= memory_budget)
+		return;
+	
+	// Deferred steps from a file, or spilled steps with outdated symbol
+	// indices, cannot be combined with the new spilled steps.
+	if (deferred && (!deferred->spill_file || !spilledSymbolsUnchanged()))
+	{
+		if (!loadDeferredSteps())
+			return;
+		bytes = loaded_bytes();
+	}
+	
+	int num_spilled = 0;
+	while (num_spilled < current_index - 1 && bytes > memory_budget / 2)
+	{
+		bytes -= undo_steps[StepList::size_type(num_spilled)]->memoryUsage();
+		++num_spilled;
+	}
+	if (num_spilled == 0)
+		return;
+	
+	auto list = DeferredStepList();
+	{
+		QXmlStreamWriter xml(&list.xml);
+		XmlElementWriter undo_element(xml, QLatin1String("undo"));
+		writeLineBreak(xml);
+		if (deferred)
+			saveSteps(xml, undoSteps(*deferred));
+		std::for_each(begin(undo_steps), begin(undo_steps) + num_spilled, [&xml](auto& step) {
+			step->save(xml);
+			writeLineBreak(xml);
+		});
+	}
+	list.num_saved = (deferred ? deferred->undo.num_steps : 0) + num_spilled;
+	list.num_steps = list.num_saved;
+	
+	if (!deferred)
+	{
+		deferred = std::make_unique<DeferredSteps>();
+		for (int i = 0; i < map->getNumSymbols(); ++i)
+			deferred->symbol_dict[i] = map->getSymbol(i);
+	}
+	if (!deferred->spill_file)
+	{
+		deferred->spill_file = std::make_unique<QTemporaryFile>(QDir::tempPath() + QLatin1String("/undo-XXXXXX"));
+		if (!deferred->spill_file->open())
+		{
+			qWarning("Cannot create a file for undo steps");
+			clearDeferredUndoSteps();
+			return;
+		}
+	}
+	auto& file = *deferred->spill_file;
+	auto const data = qCompress(list.xml, spill_compression);
+	if (!file.seek(0) || file.write(data) != data.size() || !file.resize(data.size()) || !file.flush())
+	{
+		// The previously spilled steps may be damaged now.
+		qWarning("Cannot write the undo steps to %s", qPrintable(file.fileName()));
+		clearDeferredUndoSteps();
+		return;
+	}
+	deferred->undo.num_saved = list.num_saved;
+	deferred->undo.num_steps = list.num_steps;
+	
+	// Keep the clean and the loaded state reachable.
+	auto const shift = [num_spilled](int& index, int& offset) {
+		if (offset > 0)
+			offset += num_spilled;
+		if (index >= num_spilled)
+		{
+			index -= num_spilled;
+		}
+		else if (index >= 0)
+		{
+			offset = num_spilled - index;
+			index = -1;
+		}
+	};
+	shift(clean_state_index, deferred->clean_state_offset);
+	shift(loaded_state_index, deferred->loaded_state_offset);
+	
+	undo_steps.erase(begin(undo_steps), begin(undo_steps) + num_spilled);
+	current_index -= num_spilled;
+}
+
+
 void UndoManager::validateRedoSteps()
 {
 	if (current_index < int(undo_steps.size()))
@@ -385,12 +645,12 @@ void UndoManager::emitChangedSignals(const UndoManager::State& old_state)
 
 void UndoManager::saveUndo(QXmlStreamWriter& xml) const
 {
-	auto count = undoStepCount();
+	auto count = current_index;  // without deferred steps
 	auto first = begin(undo_steps);
 	auto last  = first + count;
 	
 	// limit number of saved steps
-	first += qMax(0, count - int(max_undo_steps));
+	first += qMax(0, count - int(max_saved_steps));
 	// limit to valid steps
 	auto first_valid = last;
 	for (auto prev = first_valid; first_valid != first; first_valid = prev)
@@ -402,6 +662,40 @@ void UndoManager::saveUndo(QXmlStreamWriter& xml) const
 	
 	XmlElementWriter undo_element(xml, QLatin1String("undo"));
 	writeLineBreak(xml);
+	if (deferred && first_valid == begin(undo_steps))
+	{
+		// The deferred steps precede the loaded steps.
+		auto const num_deferred = std::min(deferred->undo.num_steps, int(max_saved_steps) - count);
+		if (num_deferred <= 0)
+		{
+			// Nothing to save
+		}
+		else if (!deferred->spill_file)
+		{
+			saveSteps(xml, deferred->undo, deferred->undo.num_steps - num_deferred);
+		}
+		else if (spilledSymbolsUnchanged())
+		{
+			saveSteps(xml, undoSteps(*deferred), deferred->undo.num_steps - num_deferred);
+		}
+		else
+		{
+			// The spilled steps must be saved with the current symbol indices.
+			auto symbol_dict = deferred->symbol_dict;
+			try
+			{
+				auto const steps = loadSteps(undoSteps(*deferred), symbol_dict);
+				std::for_each(end(steps) - std::min(num_deferred, int(steps.size())), end(steps), [&xml](auto& step) {
+					step->save(xml);
+					writeLineBreak(xml);
+				});
+			}
+			catch (FileFormatException&)
+			{
+				qWarning("Cannot save the spilled undo steps");
+			}
+		}
+	}
 	std::for_each(first_valid, last, [&xml](auto& step) {
 		step->save(xml);
 		writeLineBreak(xml);
@@ -410,12 +704,12 @@ void UndoManager::saveUndo(QXmlStreamWriter& xml) const
 
 void UndoManager::saveRedo(QXmlStreamWriter& xml) const
 {
-	auto count = redoStepCount();
+	auto count = int(undo_steps.size()) - current_index;  // without deferred steps
 	auto first = undo_steps.rbegin();
 	auto last  = first + count;
 	
 	// limit number of saved steps
-	first += qMax(0, count - int(max_undo_steps));
+	first += qMax(0, count - int(max_saved_steps));
 	// limit to valid steps
 	auto first_valid = last;
 	for (auto prev = first_valid; first_valid != first; first_valid = prev)
@@ -427,6 +721,8 @@ void UndoManager::saveRedo(QXmlStreamWriter& xml) const
 	
 	XmlElementWriter redo_element(xml, QLatin1String("redo"));
 	writeLineBreak(xml);
+	if (deferred && count == 0)
+		saveSteps(xml, deferred->redo);
 	std::for_each(first_valid, last, [&xml](auto& step) {
 		step->save(xml);
 		writeLineBreak(xml);
@@ -439,8 +735,8 @@ void UndoManager::loadUndo(QXmlStreamReader& xml, SymbolDictionary& symbol_dict)
 	Q_ASSERT(xml.name() == QLatin1String("undo"));
 	
 	auto loaded_steps = loadSteps(xml, symbol_dict);
-	if (loaded_steps.size() > max_undo_steps)
-		loaded_steps.erase(begin(loaded_steps), begin(loaded_steps) + StepList::difference_type(loaded_steps.size() - max_undo_steps));
+	if (loaded_steps.size() > max_saved_steps)
+		loaded_steps.erase(begin(loaded_steps), begin(loaded_steps) + StepList::difference_type(loaded_steps.size() - max_saved_steps));
 	
 	clear();
 	UndoManager::State old_state(this);
@@ -458,9 +754,9 @@ void UndoManager::loadRedo(QXmlStreamReader& xml, SymbolDictionary& symbol_dict)
 	Q_ASSERT(xml.name() == QLatin1String("redo"));
 	
 	auto loaded_steps = loadSteps(xml, symbol_dict);
-	auto capacity = max_undo_steps - undo_steps.size();
+	auto capacity = max_saved_steps - std::min(max_saved_steps, undo_steps.size());
 	if (loaded_steps.size() > capacity)
-		loaded_steps.erase(begin(loaded_steps) + StepList::difference_type(loaded_steps.size() - capacity), end(loaded_steps));
+		loaded_steps.erase(begin(loaded_steps), begin(loaded_steps) + StepList::difference_type(loaded_steps.size() - capacity));
 		
 	clearRedoSteps();
 	UndoManager::State old_state(this);
@@ -484,4 +780,233 @@ UndoManager::StepList UndoManager::loadSteps(QXmlStreamReader& xml, SymbolDictio
 }
 
 
+void UndoManager::deferUndo(QXmlStreamReader& xml, const SymbolDictionary& symbol_dict)
+{
+	Q_ASSERT(xml.name() == QLatin1String("undo"));
+	
+	auto list = copySteps(xml);
+	list.num_steps = std::min(list.num_saved, int(max_saved_steps));
+	
+	clear();
+	UndoManager::State old_state(this);
+	if (list.num_steps > 0)
+	{
+		deferred = std::make_unique<DeferredSteps>();
+		deferred->undo = std::move(list);
+		deferred->symbol_dict = symbol_dict;
+	}
+	setLoaded();
+	setClean();
+	emitChangedSignals(old_state);
+}
+
+
+void UndoManager::deferRedo(QXmlStreamReader& xml, const SymbolDictionary& symbol_dict)
+{
+	Q_ASSERT(xml.name() == QLatin1String("redo"));
+	
+	auto list = copySteps(xml);
+	
+	clearRedoSteps();
+	UndoManager::State old_state(this);
+	list.num_steps = qBound(0, list.num_saved, int(max_saved_steps) - undoStepCount());
+	if (list.num_steps > 0)
+	{
+		if (!deferred)
+			deferred = std::make_unique<DeferredSteps>();
+		deferred->redo = std::move(list);
+		deferred->symbol_dict = symbol_dict;
+	}
+	emitChangedSignals(old_state);
+}
+
+
+bool UndoManager::loadDeferredSteps()
+{
+	if (!deferred)
+		return true;
+	
+	UndoManager::State const old_state(this);
+	auto const steps = std::move(deferred);
+	
+	StepList loaded_undo_steps;
+	StepList loaded_redo_steps;
+	try
+	{
+		loaded_undo_steps = loadSteps(undoSteps(*steps), steps->symbol_dict);
+		loaded_redo_steps = loadSteps(steps->redo, steps->symbol_dict);
+	}
+	catch (FileFormatException&)
+	{
+		emitChangedSignals(old_state);
+		return false;
+	}
+	
+	auto const num_undo_steps = int(loaded_undo_steps.size());
+	undo_steps.insert(begin(undo_steps),
+	                  std::make_move_iterator(begin(loaded_undo_steps)),
+	                  std::make_move_iterator(end(loaded_undo_steps)));
+	current_index += num_undo_steps;
+	auto const shift = [num_undo_steps](int& index, int offset) {
+		if (index >= 0)
+			index += num_undo_steps;
+		else if (offset > 0 && offset <= num_undo_steps)
+			index = num_undo_steps - offset;
+	};
+	shift(clean_state_index, steps->clean_state_offset);
+	shift(loaded_state_index, steps->loaded_state_offset);
+	
+	std::move(loaded_redo_steps.rbegin(), loaded_redo_steps.rend(), std::back_inserter(undo_steps));
+	
+	emitChangedSignals(old_state);
+	return true;
+}
+
+
+UndoManager::StepList UndoManager::loadSteps(const DeferredStepList& list, SymbolDictionary& symbol_dict) const
+{
+	if (list.num_steps <= 0)
+		return {};
+	
+	QXmlStreamReader xml(list.xml);
+	if (!xml.readNextStartElement())
+		throw FileFormatException(xml.errorString());
+	
+	auto steps = loadSteps(xml, symbol_dict);
+	if (xml.hasError())
+		throw FileFormatException(xml.errorString());
+	
+	// Only the last steps are used.
+	auto const num_unused = StepList::difference_type(steps.size()) - list.num_steps;
+	if (num_unused > 0)
+		steps.erase(begin(steps), begin(steps) + num_unused);
+	return steps;
+}
+
+
+// static
+UndoManager::DeferredStepList UndoManager::copySteps(QXmlStreamReader& xml)
+{
+	DeferredStepList list;
+	QXmlStreamWriter writer(&list.xml);
+	writer.writeCurrentToken(xml);
+	for (int depth = 1; depth > 0 && !xml.atEnd(); )
+	{
+		switch (xml.readNext())
+		{
+		case QXmlStreamReader::StartElement:
+			if (depth == 1 && xml.name() == QLatin1String("step"))
+				++list.num_saved;
+			++depth;
+			break;
+		case QXmlStreamReader::EndElement:
+			--depth;
+			break;
+		default:
+			break;
+		}
+		writer.writeCurrentToken(xml);
+	}
+	if (xml.hasError())
+		throw FileFormatException(xml.errorString());
+	
+	return list;
+}
+
+
+// static
+void UndoManager::saveSteps(QXmlStreamWriter& xml, const DeferredStepList& list, int num_skipped)
+{
+	if (list.num_steps <= 0)
+		return;
+	
+	num_skipped += list.num_saved - list.num_steps;
+	QXmlStreamReader reader(list.xml);
+	if (!reader.readNextStartElement())
+		return;
+	
+	while (reader.readNextStartElement())
+	{
+		if (reader.name() != QLatin1String("step"))
+		{
+			reader.skipCurrentElement(); // unknown
+			continue;
+		}
+		if (num_skipped > 0)
+		{
+			--num_skipped;
+			reader.skipCurrentElement();
+			continue;
+		}
+		
+		xml.writeCurrentToken(reader);
+		for (int depth = 1; depth > 0 && !reader.atEnd(); )
+		{
+			reader.readNext();
+			if (reader.isStartElement())
+				++depth;
+			else if (reader.isEndElement())
+				--depth;
+			xml.writeCurrentToken(reader);
+		}
+		writeLineBreak(xml);
+	}
+}
+
+
+// static
+UndoManager::DeferredStepList UndoManager::undoSteps(const DeferredSteps& steps)
+{
+	if (!steps.spill_file)
+		return steps.undo;
+	
+	auto list = steps.undo;
+	auto& file = *steps.spill_file;
+	if (file.seek(0))
+		list.xml = qUncompress(file.readAll());
+	return list;
+}
+
+
+bool UndoManager::spilledSymbolsUnchanged() const
+{
+	Q_ASSERT(deferred);
+	auto const& symbol_dict = deferred->symbol_dict;
+	if (symbol_dict.size() != map->getNumSymbols())
+		return false;
+	
+	for (auto entry = symbol_dict.constBegin(); entry != symbol_dict.constEnd(); ++entry)
+	{
+		if (map->getSymbol(entry.key()) != entry.value())
+			return false;
+	}
+	return true;
+}
+
+
+void UndoManager::clearDeferredUndoSteps()
+{
+	if (!deferred)
+		return;
+	
+	deferred->undo = {};
+	deferred->spill_file.reset();
+	deferred->clean_state_offset = 0;
+	deferred->loaded_state_offset = 0;
+	if (deferred->redo.num_steps == 0)
+		deferred.reset();
+}
+
+
+void UndoManager::clearDeferredRedoSteps()
+{
+	if (!deferred)
+		return;
+	
+	deferred->redo = {};
+	if (deferred->undo.num_steps == 0)
+		deferred.reset();
+}
+
+
 }  // namespace OpenOrienteering
@@ -27,11 +27,14 @@
 #include <memory>
 #include <vector>
 
+#include <QByteArray>
+#include <QElapsedTimer>
 #include <QObject>
 #include <QString>
 
 #include "core/symbols/symbol.h"
 
+class QTemporaryFile;
 class QWidget;
 class QXmlStreamReader;
 class QXmlStreamWriter;
@@ -45,6 +48,10 @@ class UndoStep;
 /**
  * Manages the history of steps for undoing and redoing changes to a map.
  * 
+ * The memory used by the steps is limited by a budget. When the loaded steps
+ * exceed the budget, the oldest undo steps are spilled to a compressed
+ * temporary file, and they are loaded again when they are needed.
+ * 
  * This API is intentionally similar to QUndoStack.
  * (QUndoStack is part of Qt since 4.2 and available under the GPL3.)
  */
@@ -79,6 +86,23 @@ public:
 	 */
 	void push(std::unique_ptr<UndoStep>&& step);
 	
+	/**
+	 * Adds a new undo step for the given operation, coalescing bursts.
+	 * 
+	 * When the previous step was pushed for the same operation less than
+	 * coalescing_interval ago, and when it absorbs the new step, the new
+	 * step is dropped. Then a single undo() reverts the whole burst.
+	 * Steps are not coalesced across the clean or the loaded state.
+	 * 
+	 * An empty operation never coalesces.
+	 */
+	void push(std::unique_ptr<UndoStep>&& step, const QString& operation);
+	
+	/**
+	 * The maximum time between coalesced steps, in milliseconds.
+	 */
+	static constexpr int coalescing_interval = 2000;
+	
 	
 	/**
 	 * Returns true iff valid undo steps are available.
@@ -152,6 +176,8 @@ public:
 	
 	/**
 	 * Returns the step performed by the next call to undo().
+	 * 
+	 * Loads deferred steps if necessary.
 	 */
 	UndoStep* nextUndoStep() const;
 	
@@ -166,10 +192,40 @@ public:
 	
 	/**
 	 * Returns the step performed by the next call to redo().
+	 * 
+	 * Loads deferred steps if necessary.
 	 */
 	UndoStep* nextRedoStep() const;
 	
 	
+	/**
+	 * Returns an estimate of the memory used by all undo and redo steps,
+	 * in bytes.
+	 * 
+	 * Steps which are spilled to disk are not included.
+	 */
+	std::size_t memoryUsage() const;
+	
+	/**
+	 * Returns the memory budget for the loaded undo and redo steps, in bytes.
+	 */
+	std::size_t memoryBudget() const { return memory_budget; }
+	
+	/**
+	 * Sets the memory budget for the loaded undo and redo steps, in bytes.
+	 * 
+	 * When a new step makes the loaded steps exceed the budget, the oldest
+	 * undo steps are spilled to disk. The latest undo step is always kept
+	 * in memory. For a map, the budget is taken from the settings.
+	 */
+	void setMemoryBudget(std::size_t bytes);
+	
+	/**
+	 * Returns true if there are undo steps which are spilled to disk.
+	 */
+	bool hasSpilledSteps() const;
+	
+	
 	/**
 	 * Saves the undo steps to the file in xml format.
 	 */
@@ -194,15 +250,58 @@ public:
 	 */
 	void loadRedo(QXmlStreamReader& xml, SymbolDictionary& symbol_dict);
 	
+	/**
+	 * Stores the undo steps from the file in xml format, to be loaded on demand.
+	 * 
+	 * The steps are parsed when they are needed for the first time, e.g. by
+	 * undo(). Until then, the deferred steps count as valid steps.
+	 * The symbols in symbol_dict must not be deleted or replaced before
+	 * loadDeferredSteps() is called.
+	 * 
+	 * Any existing undo steps and redo steps will be deleted first.
+	 */
+	void deferUndo(QXmlStreamReader& xml, const SymbolDictionary& symbol_dict);
 	
 	/**
-	 * The maximum number of steps kept for undo() and redo(), respectively.
+	 * Stores the redo steps from the file in xml format, to be loaded on demand.
+	 * 
+	 * Any existing redo steps will be deleted first, but undo steps are left untouched.
+	 * \see deferUndo()
+	 */
+	void deferRedo(QXmlStreamReader& xml, const SymbolDictionary& symbol_dict);
+	
+	/**
+	 * Returns true if there are undo or redo steps which are not loaded yet.
+	 */
+	bool hasDeferredSteps() const { return bool(deferred); }
+	
+	/**
+	 * Loads all deferred undo and redo steps.
 	 * 
-	 * This limits the amount of memory occupied by undo steps.
+	 * Returns false if the steps could not be loaded. In this case, the
+	 * deferred steps are discarded.
+	 */
+	bool loadDeferredSteps();
+	
+	
+	/**
+	 * The maximum number of steps kept for undo() and redo(), respectively.
 	 * 
-	 * @todo Make this configurable (maybe by used memory instead of step count)
+	 * The memory occupied by undo steps is limited by the memory budget.
+	 * This limit only bounds the size of the spill file.
 	 */
-	static constexpr std::size_t max_undo_steps = 128;
+	static constexpr std::size_t max_undo_steps = 1024;
+	
+	/**
+	 * The maximum number of undo and redo steps saved with the map file,
+	 * respectively.
+	 */
+	static constexpr std::size_t max_saved_steps = 128;
+	
+	/**
+	 * The default memory budget, in bytes.
+	 */
+	static constexpr std::size_t default_memory_budget = 256 * 1024 * 1024;
 	
 signals:
 	/**
@@ -248,6 +347,14 @@ protected:
 	 */
 	void validateUndoSteps();
 	
+	/**
+	 * Spills the oldest undo steps to disk if the memory budget is exceeded.
+	 * 
+	 * Steps are spilled until the loaded steps use half of the budget,
+	 * so that the spill file is not rewritten for every new step.
+	 */
+	void spillUndoSteps();
+	
 	/**
 	 * Validates the list of steps available for redo().
 	 * 
@@ -292,8 +399,89 @@ protected:
 	void updateMapState(const UndoStep* step) const;
 	
 private:
+	/**
+	 * Undo or redo steps which are kept in xml format until they are needed.
+	 */
+	struct DeferredStepList
+	{
+		QByteArray xml;         ///< A copy of the undo or redo element.
+		int num_saved = 0;      ///< The number of steps in the element.
+		int num_steps = 0;      ///< The number of steps which are used.
+	};
+	
+	/**
+	 * The deferred undo and redo steps.
+	 * 
+	 * The deferred undo steps precede the steps in undo_steps. The deferred
+	 * redo steps follow the steps in undo_steps, which implies that there are
+	 * no loaded redo steps.
+	 * 
+	 * Spilled undo steps are kept in the spill file instead of undo.xml.
+	 * Their symbol dictionary maps the symbol indices at the time of
+	 * spilling. Spilled steps never come with deferred redo steps.
+	 */
+	struct DeferredSteps
+	{
+		DeferredStepList undo;
+		DeferredStepList redo;
+		SymbolDictionary symbol_dict;
+		std::unique_ptr<QTemporaryFile> spill_file;
+		
+		/** The number of deferred undo steps after the clean state, or 0. */
+		int clean_state_offset = 0;
+		/** The number of deferred undo steps after the loaded state, or 0. */
+		int loaded_state_offset = 0;
+		
+		DeferredSteps();
+		~DeferredSteps();
+	};
+	
 	StepList loadSteps(QXmlStreamReader& xml, SymbolDictionary& symbol_dict) const;
 	
+	/**
+	 * Loads the used steps from a deferred step list.
+	 */
+	StepList loadSteps(const DeferredStepList& list, SymbolDictionary& symbol_dict) const;
+	
+	/**
+	 * Copies the current element of the reader to a deferred step list.
+	 */
+	static DeferredStepList copySteps(QXmlStreamReader& xml);
+	
+	/**
+	 * Writes the used steps from a deferred step list.
+	 * 
+	 * The first num_skipped of the used steps are not written.
+	 */
+	static void saveSteps(QXmlStreamWriter& xml, const DeferredStepList& list, int num_skipped = 0);
+	
+	/**
+	 * Returns the undo steps of the given deferred steps, reading them
+	 * from the spill file if necessary.
+	 */
+	static DeferredStepList undoSteps(const DeferredSteps& steps);
+	
+	/**
+	 * Returns true if the symbol dictionary of spilled steps still matches
+	 * the map's symbol indices.
+	 */
+	bool spilledSymbolsUnchanged() const;
+	
+	/**
+	 * Discards the deferred undo steps.
+	 */
+	void clearDeferredUndoSteps();
+	
+	/**
+	 * Discards the deferred redo steps.
+	 */
+	void clearDeferredRedoSteps();
+	
+	/**
+	 * Undo and redo steps which are not loaded yet.
+	 */
+	std::unique_ptr<DeferredSteps> deferred;
+	
 	/**
 	 * The list of all steps available for undo() and redo().
 	 * 
@@ -335,6 +523,21 @@ private:
 	 */
 	int loaded_state_index;
 	
+	/**
+	 * The memory budget for the loaded steps, in bytes.
+	 */
+	std::size_t memory_budget = default_memory_budget;
+	
+	/**
+	 * The operation of the latest step, if it may absorb the next step.
+	 */
+	QString coalescing_operation;
+	
+	/**
+	 * Measures the time since the latest step of coalescing_operation.
+	 */
+	QElapsedTimer coalescing_timer;
+	
 };
 
 
@@ -0,0 +1,72 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#include "background_file_writer.h"
+
+#include <QIODevice>
+#include <QSaveFile>
+
+
+namespace OpenOrienteering {
+
+BackgroundFileWriter::BackgroundFileWriter(QObject* parent)
+: QObject(parent)
+{
+	// nothing else
+}
+
+BackgroundFileWriter::~BackgroundFileWriter()
+{
+	waitForFinished();
+}
+
+
+void BackgroundFileWriter::write(const QString& path, const QByteArray& data)
+{
+	waitForFinished();
+	busy = true;
+	thread = std::thread(&BackgroundFileWriter::run, this, path, data);
+}
+
+
+void BackgroundFileWriter::waitForFinished()
+{
+	if (thread.joinable())
+		thread.join();
+}
+
+
+void BackgroundFileWriter::run(const QString& path, const QByteArray& data)
+{
+	QSaveFile file(path);
+	QString error_string;
+	if (!file.open(QIODevice::WriteOnly)
+	    || file.write(data) != data.size()
+	    || !file.commit())
+	{
+		error_string = file.errorString();
+	}
+	busy = false;
+	emit finished(path, error_string);
+}
+
+
+}  // namespace OpenOrienteering
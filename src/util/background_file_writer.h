@@ -0,0 +1,87 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef OPENORIENTEERING_BACKGROUND_FILE_WRITER_H
+#define OPENORIENTEERING_BACKGROUND_FILE_WRITER_H
+
+#include <atomic>
+#include <thread>
+
+#include <QObject>
+#include <QByteArray>
+#include <QString>
+
+
+namespace OpenOrienteering {
+
+/**
+ * Writes data to files on a background thread.
+ * 
+ * The data is written via QSaveFile, so that an existing file is replaced
+ * only when the new data was written completely. At most one write is
+ * pending at a time. The destructor waits for a pending write to finish.
+ * 
+ * The finished() signal is emitted from the background thread. It is
+ * delivered as a queued signal to receivers in other threads.
+ */
+class BackgroundFileWriter : public QObject
+{
+	Q_OBJECT
+	
+public:
+	explicit BackgroundFileWriter(QObject* parent = nullptr);
+	
+	BackgroundFileWriter(const BackgroundFileWriter&) = delete;
+	BackgroundFileWriter& operator=(const BackgroundFileWriter&) = delete;
+	
+	~BackgroundFileWriter() override;
+	
+	/** Returns true while a write is pending. */
+	bool isBusy() const { return busy; }
+	
+	/**
+	 * Starts writing the data to the file at the given path.
+	 * 
+	 * If another write is pending, waits for it to finish first.
+	 */
+	void write(const QString& path, const QByteArray& data);
+	
+	/** Waits until a pending write is finished. */
+	void waitForFinished();
+	
+signals:
+	/**
+	 * Reports the end of a write.
+	 * 
+	 * The error string is empty on success.
+	 */
+	void finished(const QString& path, const QString& error_string);
+	
+private:
+	void run(const QString& path, const QByteArray& data);
+	
+	std::thread thread;
+	std::atomic<bool> busy { false };
+};
+
+
+}  // namespace OpenOrienteering
+
+#endif
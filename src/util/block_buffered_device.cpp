@@ -0,0 +1,247 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "block_buffered_device.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include <Qt>
+#include <QFlags>
+
+
+namespace OpenOrienteering {
+
+constexpr qint64 BlockBufferedDevice::default_block_size;
+
+
+BlockBufferedDevice::BlockBufferedDevice(QIODevice* source, qint64 block_size, QObject* parent)
+: QIODevice(parent)
+, source(source)
+, block_size(qBound(qint64(4096), block_size, qint64(std::numeric_limits<int>::max() / 2)))
+{
+	Q_ASSERT(source);
+}
+
+BlockBufferedDevice::~BlockBufferedDevice()
+{
+	if (isOpen())
+		close();
+	waitForReadAhead();
+}
+
+
+void BlockBufferedDevice::setReadAhead(bool enabled)
+{
+	read_ahead_enabled = enabled;
+}
+
+
+bool BlockBufferedDevice::open(OpenMode mode)
+{
+	if ((mode & ReadWrite) == ReadWrite || (mode & ReadWrite) == 0)
+	{
+		setErrorString(tr("Unsupported open mode"));
+		return false;
+	}
+	
+	auto const source_mode = mode & ~Unbuffered;
+	if (!source->isOpen())
+	{
+		// Our buffer replaces the source's buffer.
+		if (!source->open(source_mode | Unbuffered))
+		{
+			setErrorString(source->errorString());
+			return false;
+		}
+	}
+	else if ((source->openMode() & source_mode) != source_mode)
+	{
+		setErrorString(tr("Unsupported open mode"));
+		return false;
+	}
+	
+	buffer.clear();
+	buffer.reserve(int(block_size));
+	buffer_pos = 0;
+	return QIODevice::open(mode | Unbuffered);
+}
+
+void BlockBufferedDevice::close()
+{
+	flush();
+	waitForReadAhead();
+	QIODevice::close();
+	buffer.clear();
+	buffer_pos = 0;
+}
+
+bool BlockBufferedDevice::flush()
+{
+	if (!(openMode() & WriteOnly) || buffer.isEmpty())
+		return true;
+	
+	auto const size = buffer.size();
+	auto const written = source->write(buffer);
+	buffer.resize(0);  // keeps the reserved capacity
+	if (written != size)
+	{
+		setErrorString(source->errorString());
+		return false;
+	}
+	return true;
+}
+
+
+bool BlockBufferedDevice::isSequential() const
+{
+	return source->isSequential();
+}
+
+qint64 BlockBufferedDevice::size() const
+{
+	if (openMode() & WriteOnly)
+		return std::max(source->size(), pos());
+	return source->size();
+}
+
+bool BlockBufferedDevice::seek(qint64 pos)
+{
+	if (openMode() & WriteOnly)
+	{
+		if (!flush())
+			return false;
+	}
+	else
+	{
+		// Within the current block, the buffer remains valid.
+		auto const block_start = this->pos() - buffer_pos;
+		if (pos >= block_start && pos <= block_start + buffer.size())
+		{
+			buffer_pos = int(pos - block_start);
+			return QIODevice::seek(pos);
+		}
+		waitForReadAhead();
+		buffer.resize(0);
+		buffer_pos = 0;
+	}
+	
+	if (!source->seek(pos))
+	{
+		setErrorString(source->errorString());
+		return false;
+	}
+	return QIODevice::seek(pos);
+}
+
+qint64 BlockBufferedDevice::bytesAvailable() const
+{
+	if (!isSequential() || !(openMode() & ReadOnly))
+		return QIODevice::bytesAvailable();
+	return QIODevice::bytesAvailable() + (buffer.size() - buffer_pos) + source->bytesAvailable();
+}
+
+
+qint64 BlockBufferedDevice::readData(char* data, qint64 maxlen)
+{
+	qint64 total = 0;
+	while (total < maxlen)
+	{
+		if (buffer_pos == buffer.size())
+		{
+			if (!next_block.valid() && maxlen - total >= block_size)
+			{
+				// Large reads bypass the buffer.
+				auto const count = source->read(data + total, maxlen - total);
+				if (count < 0)
+				{
+					setErrorString(source->errorString());
+					return total > 0 ? total : -1;
+				}
+				total += count;
+				break;
+			}
+			if (!fillBuffer())
+				return total > 0 ? total : -1;
+			if (buffer.isEmpty())
+				break;  // end of data
+		}
+		
+		auto const count = std::min(qint64(buffer.size() - buffer_pos), maxlen - total);
+		std::memcpy(data + total, buffer.constData() + buffer_pos, std::size_t(count));
+		buffer_pos += int(count);
+		total += count;
+	}
+	return total;
+}
+
+qint64 BlockBufferedDevice::writeData(const char* data, qint64 len)
+{
+	if (buffer.size() + len > block_size && !flush())
+		return -1;
+	
+	if (len >= block_size)
+	{
+		// Large writes bypass the buffer.
+		auto const written = source->write(data, len);
+		if (written < 0)
+			setErrorString(source->errorString());
+		return written;
+	}
+	
+	buffer.append(data, int(len));
+	return len;
+}
+
+
+BlockBufferedDevice::Block BlockBufferedDevice::readBlock()
+{
+	Block block { QByteArray(int(block_size), Qt::Uninitialized), true };
+	auto const count = source->read(block.data.data(), block_size);
+	block.ok = count >= 0;
+	block.data.resize(block.ok ? int(count) : 0);
+	return block;
+}
+
+bool BlockBufferedDevice::fillBuffer()
+{
+	auto block = next_block.valid() ? next_block.get() : readBlock();
+	buffer = std::move(block.data);
+	buffer_pos = 0;
+	if (!block.ok)
+	{
+		setErrorString(source->errorString());
+		return false;
+	}
+	
+	if (read_ahead_enabled && !buffer.isEmpty() && !source->isSequential())
+		next_block = std::async(std::launch::async, [this]() { return readBlock(); });
+	return true;
+}
+
+void BlockBufferedDevice::waitForReadAhead()
+{
+	if (next_block.valid())
+		next_block.get();
+}
+
+
+}  // namespace OpenOrienteering
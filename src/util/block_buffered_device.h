@@ -0,0 +1,139 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef OPENORIENTEERING_BLOCK_BUFFERED_DEVICE_H
+#define OPENORIENTEERING_BLOCK_BUFFERED_DEVICE_H
+
+#include <future>
+
+#include <QtGlobal>
+#include <QByteArray>
+#include <QIODevice>
+#include <QObject>
+
+
+namespace OpenOrienteering {
+
+/**
+ * A device which accesses another device in large blocks.
+ * 
+ * QFile reads and writes in small chunks, and stream readers and writers
+ * access their device in even smaller pieces. On slow storage such as SD
+ * cards, each access has a high cost. This device collects the data in
+ * blocks of a fixed size instead. Larger reads and writes bypass the buffer.
+ * 
+ * With read-ahead enabled, the next block is read on a background thread
+ * while the current one is consumed. During read-ahead, the source device
+ * must not be used by other code.
+ * 
+ * The device can be opened either for reading or for writing. Closing this
+ * device does not close the source device, so that e.g. a QSaveFile can be
+ * committed after closing.
+ */
+class BlockBufferedDevice : public QIODevice
+{
+	Q_OBJECT
+	
+public:
+	/** The default size of the blocks, in bytes. */
+	static constexpr qint64 default_block_size = 1024 * 1024;
+	
+	explicit BlockBufferedDevice(QIODevice* source, qint64 block_size = default_block_size, QObject* parent = nullptr);
+	
+	BlockBufferedDevice(const BlockBufferedDevice&) = delete;
+	BlockBufferedDevice& operator=(const BlockBufferedDevice&) = delete;
+	
+	~BlockBufferedDevice() override;
+	
+	/** Returns the device which this device reads from or writes to. */
+	QIODevice* sourceDevice() const { return source; }
+	
+	/** Returns true if the next block is read in the background. */
+	bool readAhead() const { return read_ahead_enabled; }
+	
+	/**
+	 * Enables or disables reading the next block in the background.
+	 * 
+	 * Read-ahead is used for non-sequential sources only.
+	 */
+	void setReadAhead(bool enabled);
+	
+	
+	/**
+	 * Opens this device, and the source device if it is not open yet.
+	 * 
+	 * Opening in ReadWrite mode is not supported.
+	 */
+	bool open(OpenMode mode) override;
+	
+	/**
+	 * Writes pending data, and closes this device.
+	 * 
+	 * Use flush() before closing in order to detect write errors.
+	 */
+	void close() override;
+	
+	/**
+	 * Writes the pending data to the source device.
+	 * 
+	 * Returns false on error.
+	 */
+	bool flush();
+	
+	bool isSequential() const override;
+	
+	qint64 size() const override;
+	
+	bool seek(qint64 pos) override;
+	
+	qint64 bytesAvailable() const override;
+	
+protected:
+	qint64 readData(char* data, qint64 maxlen) override;
+	
+	qint64 writeData(const char* data, qint64 len) override;
+	
+private:
+	/** The result of reading a block from the source. */
+	struct Block
+	{
+		QByteArray data;
+		bool ok;
+	};
+	
+	Block readBlock();
+	
+	bool fillBuffer();
+	
+	void waitForReadAhead();
+	
+	QIODevice* source;
+	qint64 block_size;
+	QByteArray buffer;     ///< The current block, or the pending data.
+	int buffer_pos = 0;    ///< The read position in the current block.
+	std::future<Block> next_block;
+	bool read_ahead_enabled = false;
+	
+};
+
+
+}  // namespace OpenOrienteering
+
+#endif
@@ -0,0 +1,233 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "cache_manager.h"
+
+#include <algorithm>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include <Qt>
+#include <QCoreApplication>
+#include <QMetaObject>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+
+#ifdef Q_OS_ANDROID
+#  include <jni.h>
+#endif
+
+
+namespace OpenOrienteering {
+
+namespace {
+
+/**
+ * The registered caches.
+ * 
+ * The mutex is recursive, so that the caches' functions may register
+ * other caches. They must not unregister themselves.
+ */
+struct Registry
+{
+	QMutex mutex { QMutex::Recursive };
+	std::map<quint64, CacheManager::Cache> caches;
+	quint64 last_id = 0;
+};
+
+Registry& registry()
+{
+	static Registry instance;
+	return instance;
+}
+
+}  // namespace
+
+
+
+CacheManager::Registration::Registration(Registration&& other) noexcept
+: id(other.id)
+{
+	other.id = 0;
+}
+
+CacheManager::Registration& CacheManager::Registration::operator=(Registration&& other) noexcept
+{
+	if (this != &other)
+	{
+		reset();
+		std::swap(id, other.id);
+	}
+	return *this;
+}
+
+CacheManager::Registration::~Registration()
+{
+	reset();
+}
+
+void CacheManager::Registration::reset()
+{
+	if (id)
+	{
+		auto& r = registry();
+		QMutexLocker lock(&r.mutex);
+		r.caches.erase(id);
+		id = 0;
+	}
+}
+
+
+
+CacheManager::CacheManager()
+{
+	if (auto* app = QCoreApplication::instance())
+		moveToThread(app->thread());
+}
+
+CacheManager::~CacheManager() = default;
+
+// static
+CacheManager& CacheManager::instance()
+{
+	static CacheManager manager;
+	return manager;
+}
+
+
+// static
+CacheManager::Registration CacheManager::add(Cache cache)
+{
+	auto& r = registry();
+	QMutexLocker lock(&r.mutex);
+	auto const id = ++r.last_id;
+	r.caches.emplace(id, std::move(cache));
+	return Registration(id);
+}
+
+// static
+qint64 CacheManager::memoryUsage()
+{
+	auto& r = registry();
+	QMutexLocker lock(&r.mutex);
+	qint64 bytes = 0;
+	for (auto const& cache : r.caches)
+	{
+		if (cache.second.memory_usage)
+			bytes += cache.second.memory_usage();
+	}
+	return bytes;
+}
+
+// static
+void CacheManager::trim(TrimLevel level)
+{
+	Q_ASSERT(!QCoreApplication::instance() || QThread::currentThread() == QCoreApplication::instance()->thread());
+	
+	auto& r = registry();
+	QMutexLocker lock(&r.mutex);
+	
+	std::vector<std::pair<qint64, quint64>> order;
+	order.reserve(r.caches.size());
+	qint64 bytes_before = 0;
+	for (auto const& cache : r.caches)
+	{
+		auto const bytes = cache.second.memory_usage ? cache.second.memory_usage() : 0;
+		order.emplace_back(bytes, cache.first);
+		bytes_before += bytes;
+	}
+	std::sort(begin(order), end(order), [](const auto& a, const auto& b) {
+		return a.first > b.first;
+	});
+	
+	for (auto const& item : order)
+	{
+		auto cache = r.caches.find(item.second);
+		if (cache != r.caches.end() && cache->second.trim)
+			cache->second.trim(level);
+	}
+	
+	qDebug("CacheManager: Trimmed caches at level %d from %lld to %lld bytes",
+	       int(level), bytes_before, memoryUsage());
+}
+
+// static
+void CacheManager::requestTrim(TrimLevel level)
+{
+	QMetaObject::invokeMethod(&instance(), "trimLater", Qt::QueuedConnection, Q_ARG(int, int(level)));
+}
+
+void CacheManager::trimLater(int level)
+{
+	trim(TrimLevel(level));
+}
+
+// static
+qint64 CacheManager::trimTarget(TrimLevel level, qint64 bytes) noexcept
+{
+	switch (level)
+	{
+	case TrimModerate:
+		return bytes / 2;
+	case TrimLow:
+		return bytes / 4;
+	case TrimCritical:
+		break;
+	}
+	return 0;
+}
+
+
+}  // namespace OpenOrienteering
+
+
+
+#ifdef Q_OS_ANDROID
+
+/**
+ * Receives onTrimMemory() and onLowMemory() notifications from MapperActivity.
+ * 
+ * This is called on the Android UI thread.
+ */
+extern "C" JNIEXPORT void JNICALL
+Java_org_openorienteering_mapper_MapperActivity_trimMemoryNative(JNIEnv* /*env*/, jclass /*clazz*/, jint level)
+{
+	using OpenOrienteering::CacheManager;
+	
+	// Levels from android.content.ComponentCallbacks2
+	switch (level)
+	{
+	case 5:   // TRIM_MEMORY_RUNNING_MODERATE
+	case 20:  // TRIM_MEMORY_UI_HIDDEN
+		CacheManager::requestTrim(CacheManager::TrimModerate);
+		break;
+	case 10:  // TRIM_MEMORY_RUNNING_LOW
+	case 40:  // TRIM_MEMORY_BACKGROUND
+		CacheManager::requestTrim(CacheManager::TrimLow);
+		break;
+	default:  // TRIM_MEMORY_RUNNING_CRITICAL, TRIM_MEMORY_MODERATE, TRIM_MEMORY_COMPLETE
+		CacheManager::requestTrim(CacheManager::TrimCritical);
+		break;
+	}
+}
+
+#endif  // Q_OS_ANDROID
@@ -0,0 +1,131 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef OPENORIENTEERING_CACHE_MANAGER_H
+#define OPENORIENTEERING_CACHE_MANAGER_H
+
+#include <functional>
+
+#include <QtGlobal>
+#include <QObject>
+
+
+namespace OpenOrienteering {
+
+/**
+ * A central registry of caches which can release memory on demand.
+ * 
+ * Caches register a function which reports their memory usage, and a
+ * function which releases memory when the system runs low on memory, e.g.
+ * when Android calls onTrimMemory() for MapperActivity. The caches must be
+ * able to restore their content when needed, possibly at lower quality.
+ * 
+ * Caches may be registered and unregistered from any thread, but the
+ * functions are called on the thread of the application object.
+ */
+class CacheManager : public QObject
+{
+	Q_OBJECT
+	
+public:
+	/** How much memory shall be released. */
+	enum TrimLevel
+	{
+		TrimModerate = 1,  ///< Release a part of the memory which is not needed right now.
+		TrimLow      = 2,  ///< Release most of the memory which is not needed right now.
+		TrimCritical = 3,  ///< Release as much as possible, and reduce future usage.
+	};
+	
+	/** The functions provided by a registered cache. */
+	struct Cache
+	{
+		/** Returns the memory used by the cache, in bytes. */
+		std::function<qint64()> memory_usage;
+		
+		/** Releases memory, according to the given level. May be empty. */
+		std::function<void(TrimLevel)> trim;
+	};
+	
+	/**
+	 * A handle for a registered cache.
+	 * 
+	 * The cache is unregistered when the handle is destroyed.
+	 */
+	class Registration
+	{
+	public:
+		Registration() noexcept = default;
+		Registration(const Registration&) = delete;
+		Registration(Registration&& other) noexcept;
+		Registration& operator=(const Registration&) = delete;
+		Registration& operator=(Registration&& other) noexcept;
+		~Registration();
+		
+		/** Unregisters the cache now. */
+		void reset();
+		
+	private:
+		friend class CacheManager;
+		explicit Registration(quint64 id) noexcept : id(id) {}
+		quint64 id = 0;
+	};
+	
+	
+	/** Registers a cache. */
+	static Registration add(Cache cache);
+	
+	/** Returns the memory used by all registered caches, in bytes. */
+	static qint64 memoryUsage();
+	
+	/**
+	 * Asks all registered caches to release memory, largest first.
+	 * 
+	 * This must be called on the thread of the application object.
+	 */
+	static void trim(TrimLevel level);
+	
+	/**
+	 * Requests trimming from any thread.
+	 * 
+	 * The trimming is done later, on the thread of the application object.
+	 */
+	static void requestTrim(TrimLevel level);
+	
+	/**
+	 * Returns the number of bytes which a cache should keep at the given level.
+	 * 
+	 * This is a common policy for caches which evict their least recently
+	 * used items.
+	 */
+	static qint64 trimTarget(TrimLevel level, qint64 bytes) noexcept;
+	
+private:
+	CacheManager();
+	~CacheManager() override;
+	
+	static CacheManager& instance();
+	
+	Q_INVOKABLE void trimLater(int level);
+};
+
+
+}  // namespace OpenOrienteering
+
+#endif  // OPENORIENTEERING_CACHE_MANAGER_H
@@ -0,0 +1,243 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "concurrency.h"
+
+#include <array>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThread>
+#include <QThreadPool>
+
+
+namespace OpenOrienteering {
+
+namespace Concurrency {
+
+namespace {
+
+/**
+ * The number of runOnThreads() calls in progress, per priority.
+ */
+std::array<std::atomic<int>, 3> active_work = {};
+
+/**
+ * The priority of the work running on this thread.
+ */
+thread_local Priority current_priority = Priority::Normal;
+
+
+/**
+ * Sets the current thread's priority for its lifetime.
+ */
+class PriorityScope
+{
+public:
+	explicit PriorityScope(Priority priority)
+	: previous(current_priority)
+	{
+		current_priority = priority;
+	}
+	
+	PriorityScope(const PriorityScope&) = delete;
+	PriorityScope& operator=(const PriorityScope&) = delete;
+	
+	~PriorityScope()
+	{
+		current_priority = previous;
+	}
+	
+private:
+	Priority previous;
+};
+
+
+/**
+ * Counts a runOnThreads() call for its duration.
+ */
+class ActiveWork
+{
+public:
+	explicit ActiveWork(Priority priority)
+	: counter(active_work[std::size_t(priority)])
+	{
+		++counter;
+	}
+	
+	ActiveWork(const ActiveWork&) = delete;
+	ActiveWork& operator=(const ActiveWork&) = delete;
+	
+	~ActiveWork()
+	{
+		--counter;
+	}
+	
+private:
+	std::atomic<int>& counter;
+};
+
+
+/**
+ * A task which runs a function and releases a semaphore when done.
+ *
+ * Tasks are owned by runOnThreads(), not by the thread pool.
+ */
+class Task : public QRunnable
+{
+public:
+	Task(const std::function<void ()>& function, Priority priority, QSemaphore& done)
+	: function(function)
+	, done(done)
+	, priority(priority)
+	{
+		setAutoDelete(false);
+	}
+
+	void run() override
+	{
+		{
+			PriorityScope const scope(priority);
+			function();
+		}
+		done.release();
+	}
+
+private:
+	const std::function<void ()>& function;
+	QSemaphore& done;
+	Priority priority;
+};
+
+
+/**
+ * A task which runs a function and is deleted by the thread pool.
+ */
+class BackgroundTask : public QRunnable
+{
+public:
+	BackgroundTask(std::function<void ()> function, Priority priority)
+	: function(std::move(function))
+	, priority(priority)
+	{}
+
+	void run() override
+	{
+		PriorityScope const scope(priority);
+		function();
+	}
+
+private:
+	std::function<void ()> function;
+	Priority priority;
+};
+
+}  // namespace
+
+
+
+Progress::Progress()
+: data(std::make_shared<Data>())
+{}
+
+int Progress::percentage() const noexcept
+{
+	return data->percentage.load(std::memory_order_relaxed);
+}
+
+void Progress::setPercentage(int percentage) noexcept
+{
+	data->percentage.store(qBound(0, percentage, 100), std::memory_order_relaxed);
+}
+
+bool Progress::isInterruptionRequested() const noexcept
+{
+	return data->canceled.load();
+}
+
+void Progress::requestInterruption() noexcept
+{
+	data->canceled.store(true);
+}
+
+
+
+int idealThreadCount()
+{
+	return qMax(1, QThread::idealThreadCount());
+}
+
+
+Priority currentPriority() noexcept
+{
+	return current_priority;
+}
+
+
+void runOnThreads(int num_threads, const std::function<void ()>& function, Priority priority)
+{
+	ActiveWork const active(priority);
+	PriorityScope const scope(priority);
+	QSemaphore done;
+	std::vector<std::unique_ptr<Task>> tasks;
+
+	auto* pool = QThreadPool::globalInstance();
+	for (int i = 1; i < num_threads; ++i)
+	{
+		tasks.emplace_back(new Task(function, priority, done));
+		if (!pool->tryStart(tasks.back().get()))
+		{
+			tasks.pop_back();
+			break;
+		}
+	}
+
+	function();
+	done.acquire(int(tasks.size()));
+}
+
+
+void runInBackground(std::function<void ()> function, Priority priority)
+{
+	QThreadPool::globalInstance()->start(new BackgroundTask(std::move(function), priority), int(priority));
+}
+
+
+namespace detail {
+
+bool isPreempted(Priority priority) noexcept
+{
+	for (auto p = std::size_t(priority) + 1; p < active_work.size(); ++p)
+	{
+		if (active_work[p].load(std::memory_order_relaxed) > 0)
+			return true;
+	}
+	return false;
+}
+
+}  // namespace detail
+
+
+}  // namespace Concurrency
+
+}  // namespace OpenOrienteering
@@ -0,0 +1,220 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef OPENORIENTEERING_CONCURRENCY_H
+#define OPENORIENTEERING_CONCURRENCY_H
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <utility>
+
+#include <QtGlobal>
+
+
+namespace OpenOrienteering {
+
+/**
+ * Utilities for running work on the global thread pool.
+ *
+ * Unless noted otherwise, the functions in this namespace block until all
+ * work is done. The calling thread takes part in the work, so nested use
+ * cannot deadlock even when the pool is exhausted.
+ *
+ * Loops are scheduled in chunks from a shared counter, so idle threads keep
+ * taking work from busy ones until the loop is done. Helper threads of a loop
+ * return to the pool between chunks when work of a higher Priority is running,
+ * leaving the rest of the loop to its calling thread.
+ */
+namespace Concurrency {
+
+/**
+ * The priority of concurrent work.
+ */
+enum class Priority
+{
+	Background  = 0,  ///< Work the user is not waiting for, e.g. batch export
+	Normal      = 1,  ///< The default
+	Interactive = 2,  ///< Work the user is waiting for, e.g. screen rendering
+};
+
+
+/**
+ * Shared progress and cancellation state for concurrent work.
+ *
+ * Copies share the same state, and all member functions are thread-safe.
+ * The interface matches cove::ProgressObserver, so either can be passed as
+ * an observer to parallelFor().
+ */
+class Progress
+{
+public:
+	Progress();
+
+	int percentage() const noexcept;
+	void setPercentage(int percentage) noexcept;
+
+	bool isInterruptionRequested() const noexcept;
+	void requestInterruption() noexcept;
+
+private:
+	struct Data
+	{
+		std::atomic<int> percentage { 0 };
+		std::atomic<bool> canceled { false };
+	};
+	std::shared_ptr<Data> data;
+};
+
+
+/**
+ * Returns the number of threads which shall be used for parallel work.
+ *
+ * This is never less than one.
+ */
+int idealThreadCount();
+
+/**
+ * Returns the priority of the work which is running on the current thread.
+ *
+ * This is the default priority for nested concurrent work. It is
+ * Priority::Normal outside of work started by this namespace.
+ */
+Priority currentPriority() noexcept;
+
+/**
+ * Runs the given function concurrently on up to num_threads threads,
+ * including the calling thread, and waits until all calls returned.
+ *
+ * Fewer threads are used when the global thread pool is busy.
+ * While the function runs, lower-priority loops release their helper threads.
+ * The function must be thread-safe.
+ */
+void runOnThreads(int num_threads, const std::function<void ()>& function, Priority priority = currentPriority());
+
+/**
+ * Runs the given function on the global thread pool, without waiting
+ * for it to finish.
+ *
+ * Queued functions of higher priority are started first.
+ * The function must not refer to data which may be destroyed before it
+ * finishes. The global thread pool waits for all work when it is destroyed
+ * at application exit.
+ */
+void runInBackground(std::function<void ()> function, Priority priority = Priority::Background);
+
+
+namespace detail {
+
+/**
+ * Returns true when work of higher priority than the given one is running.
+ */
+bool isPreempted(Priority priority) noexcept;
+
+/**
+ * An observer for parallelFor() which does nothing.
+ */
+struct NoProgress
+{
+	void setPercentage(int /*percentage*/) noexcept {}
+	bool isInterruptionRequested() const noexcept { return false; }
+};
+
+}  // namespace detail
+
+/**
+ * Calls function(i) for each i in [first, last), distributing the calls
+ * over idealThreadCount() threads, and waits until all calls returned.
+ *
+ * Indices are handed out in chunks of grain consecutive values. The order
+ * of the calls is unspecified. The function must be thread-safe.
+ *
+ * The observer may be nullptr. Otherwise it must provide setPercentage(int)
+ * and isInterruptionRequested(), like Progress and cove::ProgressObserver.
+ * It is used from the calling thread only, around each chunk done by that
+ * thread. When it requests interruption, no further chunks are started.
+ *
+ * Returns false if the loop was interrupted.
+ */
+template <class Function, class Observer>
+bool parallelFor(int first, int last, Function&& function, Observer* observer, int grain = 1, Priority priority = currentPriority())
+{
+	if (last <= first)
+		return true;
+
+	grain = qMax(1, grain);
+	auto const total = qint64(last) - first;
+	auto const num_chunks = int((total + grain - 1) / grain);
+	auto const num_threads = qMin(idealThreadCount(), num_chunks);
+
+	std::atomic<int> next { first };
+	std::atomic<int> done { 0 };
+	std::atomic<bool> canceled { false };
+	auto const caller = std::this_thread::get_id();
+	auto work = [&]() {
+		auto const is_caller = std::this_thread::get_id() == caller;
+		while (!canceled.load(std::memory_order_relaxed))
+		{
+			if (is_caller && observer && observer->isInterruptionRequested())
+			{
+				canceled = true;
+				break;
+			}
+			if (!is_caller && detail::isPreempted(priority))
+				break;
+
+			auto const start = next.fetch_add(grain);
+			if (start >= last)
+				break;
+
+			auto const end = qMin(last, start + grain);
+			for (auto i = start; i < end; ++i)
+				function(i);
+
+			auto const finished = done.fetch_add(end - start) + (end - start);
+			if (is_caller && observer)
+				observer->setPercentage(int(100 * finished / total));
+		}
+	};
+	if (num_threads <= 1)
+		work();
+	else
+		runOnThreads(num_threads, work, priority);
+
+	return !canceled;
+}
+
+/**
+ * Calls function(i) for each i in [first, last), like the variant above,
+ * but without progress and cancellation.
+ */
+template <class Function>
+void parallelFor(int first, int last, Function&& function, int grain = 1, Priority priority = currentPriority())
+{
+	parallelFor(first, last, std::forward<Function>(function), static_cast<detail::NoProgress*>(nullptr), grain, priority);
+}
+
+
+}  // namespace Concurrency
+
+}  // namespace OpenOrienteering
+
+#endif
@@ -19,7 +19,9 @@
 
 #include "encoding.h"
 
+#include <QtEndian>
 #include <QByteArray>
+#include <QChar>
 #include <QLocale>
 #include <QString>
 #include <QStringRef>
@@ -49,6 +51,46 @@ const LanguageMapping mappings[] = {
 #endif
 };
 
+/// The MIB enum of UTF-16LE, cf. QTextCodec::mibEnum().
+constexpr int mib_utf16le = 1014;
+
+/**
+ * Returns true if the data can be converted without a codec
+ * when the codec is ASCII compatible.
+ */
+bool isPlainAscii(const char* data, int length)
+{
+	for (auto const* end = data + length; data != end; ++data)
+	{
+		auto const c = static_cast<unsigned char>(*data);
+		if ((c < 0x20 && c != '\t' && c != '\n' && c != '\r') || c > 0x7e)
+			return false;
+	}
+	return true;
+}
+
+/**
+ * Converts UTF-16LE data which has neither a byte order mark nor surrogates.
+ * 
+ * Returns a null string for other data.
+ */
+QString simpleUtf16LE(const char* data, int length)
+{
+	QString result(length, Qt::Uninitialized);
+	auto* out = result.data();
+	auto const* in = reinterpret_cast<const uchar*>(data);
+	for (int i = 0; i < length; ++i)
+	{
+		auto const unit = qFromLittleEndian<quint16>(in + 2 * i);
+		if (QChar::isSurrogate(unit))
+			return {};
+		out[i] = QChar(unit);
+	}
+	if (length > 0 && out[0] == QChar::ByteOrderMark)
+		return {};
+	return result;
+}
+
 }  // namespace
 
 
@@ -80,4 +122,49 @@ QTextCodec* Util::codecForName(const char* name)
 }
 
 
+bool Util::isAsciiCompatible(const QTextCodec* codec)
+{
+	thread_local const QTextCodec* cached_codec = nullptr;
+	thread_local bool cached_result = false;
+	if (codec != cached_codec)
+	{
+		char ascii[0x7f - 0x20 + 3] = { '\t', '\n', '\r' };
+		for (int i = 3; i < int(sizeof(ascii)); ++i)
+			ascii[i] = char(0x20 + i - 3);
+		cached_result = codec
+		                && codec->mibEnum() != mib_utf16le
+		                && codec->toUnicode(ascii, int(sizeof(ascii))) == QString::fromLatin1(ascii, int(sizeof(ascii)));
+		cached_codec = codec;
+	}
+	return cached_result;
+}
+
+
+QString Util::toUnicode(const QTextCodec* codec, const char* data, int length)
+{
+	if (codec->mibEnum() == mib_utf16le)
+	{
+		auto result = simpleUtf16LE(data, length / 2);
+		if (!result.isNull() && length % 2 == 0)
+			return result;
+	}
+	else if (isPlainAscii(data, length) && isAsciiCompatible(codec))
+		return QString::fromLatin1(data, length);
+	return codec->toUnicode(data, length);
+}
+
+
+QString Util::fromUtf16LE(const char* data, int length)
+{
+	auto result = simpleUtf16LE(data, length);
+	if (!result.isNull())
+		return result;
+	
+	static QTextCodec* const utf16 = QTextCodec::codecForMib(mib_utf16le);
+	Q_ASSERT(utf16);
+	QTextCodec::ConverterState state(QTextCodec::ConvertInvalidToNull);
+	return utf16->toUnicode(data, 2 * length, &state);
+}
+
+
 }  // namespace OpenOrienteering
@@ -50,6 +50,32 @@ const char* codepageForLanguage(const QString& language_name);
 QTextCodec* codecForName(const char* name);
 
 
+/**
+ * Returns true if the codec maps printable ASCII characters, tab, CR and LF
+ * to the same Unicode characters.
+ * 
+ * The result for the most recently queried codec is cached per thread.
+ */
+bool isAsciiCompatible(const QTextCodec* codec);
+
+/**
+ * Converts encoded text to Unicode.
+ * 
+ * This is equivalent to codec->toUnicode(data, length), but it takes shortcuts
+ * for UTF-16LE codecs, and for pure ASCII data with ASCII compatible codecs.
+ */
+QString toUnicode(const QTextCodec* codec, const char* data, int length);
+
+/**
+ * Converts UTF-16LE text to Unicode.
+ * 
+ * The length is given in 16-bit code units. The data does not need to be
+ * aligned. Invalid data is converted to null characters, and a leading byte
+ * order mark is skipped, like with QTextCodec::ConvertInvalidToNull.
+ */
+QString fromUtf16LE(const char* data, int length);
+
+
 }  // namespace Util
 
 }  // namespace OpenOrienteering
@@ -0,0 +1,365 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "profiler.h"
+
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <utility>
+
+#include <QtGlobal>
+#include <QByteArray>
+#include <QCoreApplication>
+#include <QFile>
+#include <QHash>
+#include <QIODevice>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLatin1String>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QString>
+#include <QThread>
+
+
+namespace OpenOrienteering {
+
+namespace {
+
+/// The number of frames kept for recentFrames().
+constexpr std::size_t max_recent_frames = 120;
+
+/// The maximum number of trace events. Later events are dropped.
+constexpr std::size_t max_trace_events = 100000;
+
+struct PhaseData
+{
+	std::atomic<qint64> count { 0 };
+	std::atomic<qint64> total_ns { 0 };
+	std::atomic<qint64> max_ns { 0 };
+};
+
+struct TraceEvent
+{
+	Profiler::Phase phase;
+	int thread;
+	qint64 start_ns;
+	qint64 duration_ns;
+	qint64 object_updates;  // for frames
+	qint64 clip_changes;    // for frames
+};
+
+struct ProfilerData
+{
+	std::array<PhaseData, Profiler::NumPhases> phases;
+	
+	QMutex mutex;  // protects the members below
+	std::array<Profiler::Statistics, Profiler::NumPhases> last_frame_totals;
+	std::deque<Profiler::FrameStatistics> recent_frames;
+	std::vector<TraceEvent> trace_events;
+	qint64 dropped_events = 0;
+	QHash<Qt::HANDLE, int> threads;
+	
+	QString output_path;
+};
+
+ProfilerData& profilerData()
+{
+	static ProfilerData profiler_data;
+	return profiler_data;
+}
+
+bool isTraced(Profiler::Phase phase)
+{
+	return phase == Profiler::Frame
+	       || phase == Profiler::TemplateCache
+	       || phase == Profiler::MapCache
+	       || phase >= Profiler::Startup;
+}
+
+double toMs(qint64 ns)
+{
+	return ns / 1000000.0;
+}
+
+double toUs(qint64 ns)
+{
+	return ns / 1000.0;
+}
+
+QJsonObject totalsObject()
+{
+	QJsonObject phases;
+	for (int i = 0; i < Profiler::NumPhases; ++i)
+	{
+		auto const phase = Profiler::Phase(i);
+		auto const stats = Profiler::totals(phase);
+		phases.insert(QLatin1String(Profiler::name(phase)), QJsonObject {
+		    { QStringLiteral("count"), double(stats.count) },
+		    { QStringLiteral("total_ms"), toMs(stats.total_ns) },
+		    { QStringLiteral("max_ms"), toMs(stats.max_ns) },
+		});
+	}
+	return phases;
+}
+
+bool write(QIODevice& device, const QJsonObject& object)
+{
+	auto const json = QJsonDocument(object).toJson(QJsonDocument::Compact);
+	return device.write(json) == json.size();
+}
+
+void writeTraceOnExit()
+{
+	QFile file(profilerData().output_path);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)
+	    || !Profiler::writeChromeTrace(file))
+	{
+		qWarning("Cannot write the profiler data to %s", qPrintable(profilerData().output_path));
+	}
+}
+
+}  // namespace
+
+
+
+std::atomic<bool> Profiler::enabled { false };
+
+
+// static
+void Profiler::initialize()
+{
+	static bool initialized = false;
+	if (initialized)
+		return;
+	initialized = true;
+	
+	if (!qEnvironmentVariableIsSet("MAPPER_PROFILE"))
+		return;
+	
+	auto const value = qgetenv("MAPPER_PROFILE");
+	if (value == "0")
+		return;
+	
+	setEnabled(true);
+	if (!value.isEmpty() && value != "1")
+	{
+		profilerData().output_path = QString::fromLocal8Bit(value);
+		qAddPostRoutine(&writeTraceOnExit);
+	}
+}
+
+
+// static
+void Profiler::setEnabled(bool value) noexcept
+{
+	enabled.store(value, std::memory_order_relaxed);
+}
+
+
+// static
+void Profiler::reset()
+{
+	auto& d = profilerData();
+	for (auto& phase : d.phases)
+	{
+		phase.count = 0;
+		phase.total_ns = 0;
+		phase.max_ns = 0;
+	}
+	
+	QMutexLocker lock(&d.mutex);
+	d.last_frame_totals = {};
+	d.recent_frames.clear();
+	d.trace_events.clear();
+	d.dropped_events = 0;
+}
+
+
+// static
+const char* Profiler::name(Phase phase) noexcept
+{
+	switch (phase)
+	{
+	case Frame:
+		return "Frame";
+	case TemplateCache:
+		return "Template cache";
+	case MapCache:
+		return "Map cache";
+	case ObjectUpdate:
+		return "Object update";
+	case ClipChange:
+		return "Clip change";
+	case Startup:
+		return "Startup";
+	case Translations:
+		return "Translations";
+	case FileFormats:
+		return "File formats";
+	case FirstWindow:
+		return "First window";
+	case GdalSetup:
+		return "GDAL setup";
+	case NumPhases:
+		break;
+	}
+	Q_UNREACHABLE();
+	return "";
+}
+
+
+// static
+Profiler::Statistics Profiler::totals(Phase phase) noexcept
+{
+	const auto& phase_data = profilerData().phases[std::size_t(phase)];
+	Statistics stats;
+	stats.count = phase_data.count.load(std::memory_order_relaxed);
+	stats.total_ns = phase_data.total_ns.load(std::memory_order_relaxed);
+	stats.max_ns = phase_data.max_ns.load(std::memory_order_relaxed);
+	return stats;
+}
+
+
+// static
+std::vector<Profiler::FrameStatistics> Profiler::recentFrames()
+{
+	auto& d = profilerData();
+	QMutexLocker lock(&d.mutex);
+	return { begin(d.recent_frames), end(d.recent_frames) };
+}
+
+
+// static
+bool Profiler::writeJson(QIODevice& device)
+{
+	return write(device, QJsonObject { { QStringLiteral("phases"), totalsObject() } });
+}
+
+
+// static
+bool Profiler::writeChromeTrace(QIODevice& device)
+{
+	auto& d = profilerData();
+	auto const pid = double(QCoreApplication::applicationPid());
+	
+	QJsonArray events;
+	qint64 dropped_events = 0;
+	{
+		QMutexLocker lock(&d.mutex);
+		for (const auto& event : d.trace_events)
+		{
+			QJsonObject json_event {
+			    { QStringLiteral("name"), QLatin1String(name(event.phase)) },
+			    { QStringLiteral("cat"), QStringLiteral("mapper") },
+			    { QStringLiteral("ph"), QStringLiteral("X") },
+			    { QStringLiteral("ts"), toUs(event.start_ns) },
+			    { QStringLiteral("dur"), toUs(event.duration_ns) },
+			    { QStringLiteral("pid"), pid },
+			    { QStringLiteral("tid"), event.thread },
+			};
+			if (event.phase == Frame)
+			{
+				json_event.insert(QStringLiteral("args"), QJsonObject {
+				    { QStringLiteral("object_updates"), double(event.object_updates) },
+				    { QStringLiteral("clip_changes"), double(event.clip_changes) },
+				});
+			}
+			events.append(json_event);
+		}
+		dropped_events = d.dropped_events;
+	}
+	
+	return write(device, QJsonObject {
+	    { QStringLiteral("traceEvents"), events },
+	    { QStringLiteral("displayTimeUnit"), QStringLiteral("ms") },
+	    { QStringLiteral("otherData"), QJsonObject {
+	          { QStringLiteral("phases"), totalsObject() },
+	          { QStringLiteral("dropped_events"), double(dropped_events) },
+	    } },
+	});
+}
+
+
+// static
+qint64 Profiler::now() noexcept
+{
+	using namespace std::chrono;
+	static auto const reference = steady_clock::now();
+	return duration_cast<nanoseconds>(steady_clock::now() - reference).count();
+}
+
+
+// static
+void Profiler::record(Phase phase, qint64 start_ns, qint64 end_ns)
+{
+	auto& d = profilerData();
+	auto const duration = end_ns - start_ns;
+	auto& phase_data = d.phases[std::size_t(phase)];
+	phase_data.count.fetch_add(1, std::memory_order_relaxed);
+	phase_data.total_ns.fetch_add(duration, std::memory_order_relaxed);
+	auto max = phase_data.max_ns.load(std::memory_order_relaxed);
+	while (duration > max && !phase_data.max_ns.compare_exchange_weak(max, duration, std::memory_order_relaxed))
+	{
+		// max was updated, try again
+	}
+	
+	if (!isTraced(phase))
+		return;
+	
+	QMutexLocker lock(&d.mutex);
+	
+	TraceEvent event { phase, 0, start_ns, duration, 0, 0 };
+	auto const thread = QThread::currentThreadId();
+	auto found = d.threads.constFind(thread);
+	if (found == d.threads.constEnd())
+		found = d.threads.insert(thread, d.threads.size() + 1);
+	event.thread = *found;
+	
+	if (phase == Frame)
+	{
+		// Attribute the work since the previous frame to this frame.
+		FrameStatistics frame;
+		frame.duration_ns = duration;
+		for (std::size_t i = 0; i < frame.phases.size(); ++i)
+		{
+			auto const current = totals(Phase(i));
+			auto& last = d.last_frame_totals[i];
+			frame.phases[i].count = current.count - last.count;
+			frame.phases[i].total_ns = current.total_ns - last.total_ns;
+			last = current;
+		}
+		event.object_updates = frame.phases[ObjectUpdate].count;
+		event.clip_changes = frame.phases[ClipChange].count;
+		
+		if (d.recent_frames.size() >= max_recent_frames)
+			d.recent_frames.pop_front();
+		d.recent_frames.push_back(std::move(frame));
+	}
+	
+	if (d.trace_events.size() < max_trace_events)
+		d.trace_events.push_back(event);
+	else
+		++d.dropped_events;
+}
+
+
+}  // namespace OpenOrienteering
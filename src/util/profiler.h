@@ -0,0 +1,193 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef OPENORIENTEERING_PROFILER_H
+#define OPENORIENTEERING_PROFILER_H
+
+#include <array>
+#include <atomic>
+#include <vector>
+
+#include <QtGlobal>
+
+class QIODevice;
+
+namespace OpenOrienteering {
+
+
+/**
+ * An opt-in profiler for the rendering hot paths and for program startup.
+ * 
+ * The profiler accumulates the time spent in a fixed set of phases, measured
+ * by Profiler::Scope objects. While the profiler is disabled, a scope costs
+ * no more than a relaxed atomic load. Scopes may be used on any thread.
+ * 
+ * Paint events of map widgets are recorded as frames. For each frame, the
+ * profiler keeps the time spent in each phase, so that a map widget can show
+ * the statistics of the last frames in an overlay. Frames and cache updates
+ * are also recorded as trace events, up to a limit, while the other phases
+ * are only accumulated.
+ * 
+ * The startup phases are recorded once by the application's main function,
+ * except for GdalSetup which happens on first use of GDAL.
+ * 
+ * The profiler is enabled by setting the environment variable MAPPER_PROFILE.
+ * If its value is a file path instead of "1", the data is written to this
+ * file in Chrome trace format when the application terminates.
+ */
+class Profiler
+{
+public:
+	/**
+	 * The phases accounted by the profiler.
+	 */
+	enum Phase
+	{
+		Frame,          ///< A MapWidget paint event
+		TemplateCache,  ///< MapWidget::updateTemplateCache()
+		MapCache,       ///< MapWidget::updateMapCache()
+		ObjectUpdate,   ///< Object::update() regenerating renderables
+		ClipChange,     ///< PainterConfig::activate() changing the clip path
+		Startup,        ///< From entering main() until the first window is shown
+		Translations,   ///< Loading the translations at startup
+		FileFormats,    ///< doStaticInitializations() at startup
+		FirstWindow,    ///< Creating and showing the first window at startup
+		GdalSetup,      ///< GDAL driver registration and configuration
+		NumPhases
+	};
+	
+	/**
+	 * Accumulated timing for a phase.
+	 */
+	struct Statistics
+	{
+		qint64 count = 0;     ///< The number of measurements
+		qint64 total_ns = 0;  ///< The sum of the durations, in nanoseconds
+		qint64 max_ns = 0;    ///< The maximum duration, in nanoseconds
+	};
+	
+	/**
+	 * The timing of a single frame.
+	 * 
+	 * The phases cover the work since the previous frame. Their maximum
+	 * durations are not tracked.
+	 */
+	struct FrameStatistics
+	{
+		qint64 duration_ns = 0;
+		std::array<Statistics, NumPhases> phases;
+	};
+	
+	/**
+	 * Measures the time between construction and destruction for a phase.
+	 */
+	class Scope
+	{
+	public:
+		explicit Scope(Phase phase) noexcept
+		: phase(phase)
+		, start(isEnabled() ? now() : -1)
+		{}
+		
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+		
+		~Scope()
+		{
+			if (start >= 0)
+				record(phase, start, now());
+		}
+		
+	private:
+		Phase phase;
+		qint64 start;
+	};
+	
+	
+	/**
+	 * Enables the profiler if requested by the environment.
+	 * 
+	 * This is called by doStaticInitializations(), and it may be called
+	 * earlier in order to measure the startup. Repeated calls have no effect.
+	 */
+	static void initialize();
+	
+	/**
+	 * Returns true if the profiler is enabled.
+	 */
+	static bool isEnabled() noexcept { return enabled.load(std::memory_order_relaxed); }
+	
+	/**
+	 * Enables or disables the profiler.
+	 */
+	static void setEnabled(bool value) noexcept;
+	
+	/**
+	 * Discards all recorded data.
+	 */
+	static void reset();
+	
+	/**
+	 * Returns the name of the phase, for reports.
+	 */
+	static const char* name(Phase phase) noexcept;
+	
+	/**
+	 * Returns the accumulated timing of a phase.
+	 */
+	static Statistics totals(Phase phase) noexcept;
+	
+	/**
+	 * Returns the timing of the most recent frames, oldest first.
+	 */
+	static std::vector<FrameStatistics> recentFrames();
+	
+	/**
+	 * Writes the accumulated timing of all phases as a JSON object.
+	 */
+	static bool writeJson(QIODevice& device);
+	
+	/**
+	 * Writes the trace events in Chrome trace format, to be loaded in
+	 * chrome://tracing or similar viewers.
+	 * 
+	 * The accumulated timing is included as metadata.
+	 */
+	static bool writeChromeTrace(QIODevice& device);
+	
+	
+	/**
+	 * Returns the time since the profiler's reference point, in nanoseconds.
+	 */
+	static qint64 now() noexcept;
+	
+	/**
+	 * Records a measurement.
+	 */
+	static void record(Phase phase, qint64 start_ns, qint64 end_ns);
+	
+private:
+	static std::atomic<bool> enabled;
+	
+};
+
+
+}  // namespace OpenOrienteering
+
+#endif
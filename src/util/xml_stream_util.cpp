@@ -22,7 +22,9 @@
 
 #include <algorithm>
 #include <array>
+#include <cstddef>
 #include <exception>
+#include <iterator>
 #include <limits>
 #include <stdexcept>
 
@@ -37,6 +39,7 @@
 // IWYU pragma: no_include <qxmlstream.h>
 
 #include "core/map_coord.h"
+#include "core/objects/object_tags.h"
 #include "fileformats/file_format.h"
 #include "fileformats/file_import_export.h"
 #include "fileformats/xml_file_format.h"
@@ -44,6 +47,169 @@
 
 namespace OpenOrienteering {
 
+namespace {
+
+/*
+ * The compact encoding of coordinates is a byte sequence which is written
+ * as base64 text. For each coordinate, it contains the difference to the
+ * previous coordinate (or to the origin, for the first one) as unsigned
+ * LEB128 varints of zigzag-encoded values: first the x difference, shifted
+ * left by one bit and with the lowest bit set when flags follow, then the
+ * y difference, and then the flags, if not zero.
+ */
+
+void appendVarint(QByteArray& data, quint64 value)
+{
+	while (value >= 0x80)
+	{
+		data.append(char(value | 0x80));
+		value >>= 7;
+	}
+	data.append(char(value));
+}
+
+QByteArray encodeCoords(const MapCoordVector& coords)
+{
+	QByteArray data;
+	data.reserve(int(std::min(coords.size() * 4, std::size_t(std::numeric_limits<int>::max() / 2))));
+	qint64 last_x = 0;
+	qint64 last_y = 0;
+	for (auto const& coord : coords)
+	{
+		auto const dx = coord.nativeX() - last_x;
+		auto const dy = coord.nativeY() - last_y;
+		auto const flags = quint64(coord.flags());
+		appendVarint(data, (((quint64(dx) << 1) ^ quint64(dx >> 63)) << 1) | (flags ? 1 : 0));
+		appendVarint(data, (quint64(dy) << 1) ^ quint64(dy >> 63));
+		if (flags)
+			appendVarint(data, flags);
+		last_x = coord.nativeX();
+		last_y = coord.nativeY();
+	}
+	return data.toBase64();
+}
+
+[[noreturn]] void invalidCoords()
+{
+	throw FileFormatException(::OpenOrienteering::ImportExport::tr("Could not parse the coordinates."));
+}
+
+quint64 readVarint(const char*& current, const char* end)
+{
+	quint64 value = 0;
+	for (int shift = 0; shift < 64; shift += 7)
+	{
+		if (current == end)
+			invalidCoords();
+		auto const byte = quint8(*current++);
+		value |= quint64(byte & 0x7f) << shift;
+		if (!(byte & 0x80))
+			return value;
+	}
+	invalidCoords();
+}
+
+qint64 unzigzag(quint64 value) noexcept
+{
+	return qint64(value >> 1) ^ -qint64(value & 1);
+}
+
+/**
+ * Collects the text content of the current element, until its end.
+ */
+QByteArray readBase64Text(QXmlStreamReader& xml)
+{
+	QByteArray text;
+	for (xml.readNext(); xml.tokenType() != QXmlStreamReader::EndElement; xml.readNext())
+	{
+		const QXmlStreamReader::TokenType token = xml.tokenType();
+		if (xml.error() || token == QXmlStreamReader::EndDocument)
+			invalidCoords();
+		else if (token == QXmlStreamReader::Characters)
+			text.append(xml.text().toLatin1());
+		else if (token == QXmlStreamReader::StartElement)
+			xml.skipCurrentElement();
+	}
+	return text;
+}
+
+/**
+ * Decodes coordinates in the compact encoding, appending them to coords.
+ * 
+ * before_coord() is called before each coordinate is created.
+ */
+template <class Function>
+void decodeCoords(const QByteArray& base64, MapCoordVector& coords, Function before_coord)
+{
+	auto const data = QByteArray::fromBase64(base64);
+	auto const* current = data.constData();
+	auto const* const end = current + data.size();
+	qint64 x = 0;
+	qint64 y = 0;
+	while (current != end)
+	{
+		auto const x_value = readVarint(current, end);
+		x += unzigzag(x_value >> 1);
+		y += unzigzag(readVarint(current, end));
+		auto const flags = (x_value & 1) ? readVarint(current, end) : 0;
+		if (flags > 0xff
+		    || x < std::numeric_limits<qint32>::min() || x > std::numeric_limits<qint32>::max()
+		    || y < std::numeric_limits<qint32>::min() || y > std::numeric_limits<qint32>::max())
+		{
+			invalidCoords();
+		}
+		before_coord();
+		coords.push_back(MapCoord::loadNative(x, y, MapCoord::Flags{MapCoord::Flags::Int(flags)}));
+	}
+}
+
+/**
+ * A buffer for an attribute name or a decimal integer value.
+ * 
+ * 20 digits and a sign hold any 64 bit integer.
+ */
+using AttributeBuffer = std::array<QChar, 32>;
+
+/**
+ * Returns a string for the given name, using the given buffer.
+ * 
+ * Names which fit into the buffer are returned using QString::fromRawData(),
+ * so the string is valid for the lifetime of the buffer only.
+ */
+QString attributeName(const QLatin1String& name, AttributeBuffer& buffer)
+{
+	if (name.size() > int(buffer.size()))
+		return name;
+	std::copy(name.data(), name.data() + name.size(), begin(buffer));
+	return QString::fromRawData(buffer.data(), name.size());
+}
+
+/**
+ * Returns a string for the given value, using the given buffer.
+ * 
+ * The string is created using QString::fromRawData(), so it is valid for
+ * the lifetime of the buffer only.
+ */
+QString attributeValue(quint64 value, bool negative, AttributeBuffer& buffer)
+{
+	// For efficiency, we construct the string from the back.
+	auto const last = end(buffer);
+	auto first = last;
+	do
+	{
+		*--first = QLatin1Char(char('0' + value % 10));
+		value /= 10;
+	}
+	while (value != 0);
+	if (negative)
+		*--first = QLatin1Char('-');
+	return QString::fromRawData(&*first, int(std::distance(first, last)));
+}
+
+}  // namespace
+
+
+
 void writeLineBreak(QXmlStreamWriter& xml)
 {
 	if (!xml.autoFormatting())
@@ -171,6 +337,25 @@ bool XmlRecoveryHelper::operator() ()
 
 //### XmlElementWriter ###
 
+void XmlElementWriter::writeInteger(const QLatin1String& qualifiedName, qint64 value)
+{
+	// The magnitude of the minimum value is representable as quint64.
+	auto const magnitude = value < 0 ? quint64(0) - quint64(value) : quint64(value);
+	AttributeBuffer name_buffer;
+	AttributeBuffer value_buffer;
+	xml.writeAttribute(attributeName(qualifiedName, name_buffer),
+	                   attributeValue(magnitude, value < 0, value_buffer));
+}
+
+void XmlElementWriter::writeInteger(const QLatin1String& qualifiedName, quint64 value)
+{
+	AttributeBuffer name_buffer;
+	AttributeBuffer value_buffer;
+	xml.writeAttribute(attributeName(qualifiedName, name_buffer),
+	                   attributeValue(value, false, value_buffer));
+}
+
+
 void XmlElementWriter::write(const MapCoordVector& coords)
 {
 	namespace literal = XmlStreamLiteral;
@@ -183,6 +368,21 @@ void XmlElementWriter::write(const MapCoordVector& coords)
 		for (auto& coord : coords)
 			coord.save(xml);
 	}
+	else if (XMLFileFormat::active_version >= 10)
+	{
+		// Compact binary encoding
+		writeAttribute(literal::encoding, QString(literal::base64));
+		auto const encoded = encodeCoords(coords);
+		if (auto* device = xml.device())
+		{
+			xml.writeCharacters({});  // Finish the start element
+			device->write(encoded);
+		}
+		else
+		{
+			xml.writeCharacters(QString::fromLatin1(encoded));
+		}
+	}
 	else if (auto* device = xml.device())
 	{
 		// Default: efficient plain text format
@@ -203,6 +403,19 @@ void XmlElementWriter::write(const MapCoordVector& coords)
 }
 
 
+void XmlElementWriter::write(const ObjectTags& tags)
+{
+	namespace literal = XmlStreamLiteral;
+	
+	for (auto tag = tags.constBegin(), end = tags.constEnd(); tag != end; ++tag)
+	{
+		XmlElementWriter tag_element(xml, literal::t);
+		tag_element.writeAttribute(literal::k, tag.key());
+		xml.writeCharacters(tag.value());
+	}
+}
+
+
 
 //### XmlElementReader ###
 
@@ -214,45 +427,51 @@ void XmlElementReader::read(MapCoordVector& coords)
 	
 	const auto num_coords = attribute<unsigned int>(literal::count);
 	coords.reserve(std::min(num_coords, 500000u));
+	const auto encoded = attribute<QStringRef>(literal::encoding) == literal::base64;
 	
 	try
 	{
-		for( xml.readNext(); xml.tokenType() != QXmlStreamReader::EndElement; xml.readNext() )
+		if (encoded)
+			decodeCoords(readBase64Text(xml), coords, []() {});
+		else
 		{
-			const QXmlStreamReader::TokenType token = xml.tokenType();
-			if (xml.error() || token == QXmlStreamReader::EndDocument)
+			for( xml.readNext(); xml.tokenType() != QXmlStreamReader::EndElement; xml.readNext() )
 			{
-				throw FileFormatException(::OpenOrienteering::ImportExport::tr("Could not parse the coordinates."));
-			}
-			else if (token == QXmlStreamReader::Characters && !xml.isWhitespace())
-			{
-				QStringRef text = xml.text();
-				try
-				{
-					while (text.length())
-					{
-						coords.emplace_back(text);
-					}
-				}
-				catch (std::exception& e)
+				const QXmlStreamReader::TokenType token = xml.tokenType();
+				if (xml.error() || token == QXmlStreamReader::EndDocument)
 				{
-					Q_UNUSED(e)
-					qDebug("Could not parse the coordinates: %s", e.what());
 					throw FileFormatException(::OpenOrienteering::ImportExport::tr("Could not parse the coordinates."));
 				}
-			}
-			else if (token == QXmlStreamReader::StartElement)
-			{
-				if (xml.name() == literal::coord)
+				else if (token == QXmlStreamReader::Characters && !xml.isWhitespace())
 				{
-					coords.emplace_back(MapCoord::load(xml));
+					QStringRef text = xml.text();
+					try
+					{
+						while (text.length())
+						{
+							coords.emplace_back(text);
+						}
+					}
+					catch (std::exception& e)
+					{
+						Q_UNUSED(e)
+						qDebug("Could not parse the coordinates: %s", e.what());
+						throw FileFormatException(::OpenOrienteering::ImportExport::tr("Could not parse the coordinates."));
+					}
 				}
-				else
+				else if (token == QXmlStreamReader::StartElement)
 				{
-					xml.skipCurrentElement();
+					if (xml.name() == literal::coord)
+					{
+						coords.emplace_back(MapCoord::load(xml));
+					}
+					else
+					{
+						xml.skipCurrentElement();
+					}
 				}
+				// otherwise: ignore element
 			}
-			// otherwise: ignore element
 		}
 	}
 	catch (std::range_error &e)
@@ -275,24 +494,58 @@ void XmlElementReader::readForText(MapCoordVector& coords)
 	coords.reserve(2);
 	
 	const auto num_coords = attribute<unsigned int>(literal::count);
+	const auto encoded = attribute<QStringRef>(literal::encoding) == literal::base64;
 	
 	QScopedValueRollback<MapCoord::BoundsOffset> offset{MapCoord::boundsOffset()};
 	
 	try
 	{
-		for( xml.readNext(); xml.tokenType() != QXmlStreamReader::EndElement; xml.readNext() )
+		if (encoded)
 		{
-			const QXmlStreamReader::TokenType token = xml.tokenType();
-			if (xml.error() || token == QXmlStreamReader::EndDocument)
-			{
-				throw FileFormatException(::OpenOrienteering::ImportExport::tr("Could not parse the coordinates."));
-			}
-			else if (token == QXmlStreamReader::Characters && !xml.isWhitespace())
+			decodeCoords(readBase64Text(xml), coords, [&coords, &offset]() {
+				if (coords.size() == 1)
+				{
+					// Don't apply an offset to text box size.
+					offset.commit();
+					MapCoord::boundsOffset().reset(false);
+				}
+			});
+		}
+		else
+		{
+			for( xml.readNext(); xml.tokenType() != QXmlStreamReader::EndElement; xml.readNext() )
 			{
-				QStringRef text = xml.text();
-				try
+				const QXmlStreamReader::TokenType token = xml.tokenType();
+				if (xml.error() || token == QXmlStreamReader::EndDocument)
 				{
-					while (text.length())
+					throw FileFormatException(::OpenOrienteering::ImportExport::tr("Could not parse the coordinates."));
+				}
+				else if (token == QXmlStreamReader::Characters && !xml.isWhitespace())
+				{
+					QStringRef text = xml.text();
+					try
+					{
+						while (text.length())
+						{
+							if (coords.size() == 1)
+							{
+								// Don't apply an offset to text box size.
+								offset.commit();
+								MapCoord::boundsOffset().reset(false);
+							}
+							coords.emplace_back(text);
+						}
+					}
+					catch (std::exception& e)
+					{
+						Q_UNUSED(e)
+						qDebug("Could not parse the coordinates: %s", e.what());
+						throw FileFormatException(::OpenOrienteering::ImportExport::tr("Could not parse the coordinates."));
+					}
+				}
+				else if (token == QXmlStreamReader::StartElement)
+				{
+					if (xml.name() == literal::coord)
 					{
 						if (coords.size() == 1)
 						{
@@ -300,34 +553,15 @@ void XmlElementReader::readForText(MapCoordVector& coords)
 							offset.commit();
 							MapCoord::boundsOffset().reset(false);
 						}
-						coords.emplace_back(text);
+						coords.emplace_back(MapCoord::load(xml));
 					}
-				}
-				catch (std::exception& e)
-				{
-					Q_UNUSED(e)
-					qDebug("Could not parse the coordinates: %s", e.what());
-					throw FileFormatException(::OpenOrienteering::ImportExport::tr("Could not parse the coordinates."));
-				}
-			}
-			else if (token == QXmlStreamReader::StartElement)
-			{
-				if (xml.name() == literal::coord)
-				{
-					if (coords.size() == 1)
+					else
 					{
-						// Don't apply an offset to text box size.
-						offset.commit();
-						MapCoord::boundsOffset().reset(false);
+						xml.skipCurrentElement();
 					}
-					coords.emplace_back(MapCoord::load(xml));
-				}
-				else
-				{
-					xml.skipCurrentElement();
 				}
+				// otherwise: ignore element
 			}
-			// otherwise: ignore element
 		}
 	}
 	catch (std::range_error &e)
@@ -342,5 +576,37 @@ void XmlElementReader::readForText(MapCoordVector& coords)
 }
 
 
+void XmlElementReader::read(ObjectTags& tags)
+{
+	namespace literal = XmlStreamLiteral;
+	
+	tags.clear();
+	while (xml.readNextStartElement())
+	{
+		if (xml.name() == literal::t)
+		{
+			const QString key(xml.attributes().value(literal::k).toString());
+			tags.insert(key, xml.readElementText());
+		}
+		else if (xml.name() == literal::tag)
+		{
+			// Full keywords were used in pre-0.6.0 master branch
+			// TODO Remove after Mapper 0.6.x releases
+			const QString key(xml.attributes().value(literal::key).toString());
+			tags.insert(key, xml.readElementText());
+		}
+		else if (xml.name() == literal::tags)
+		{
+			// Fix for broken Object::save in pre-0.6.0 master branch
+			// TODO Remove after Mapper 0.6.x releases
+			const QString key(xml.attributes().value(literal::key).toString());
+			tags.insert(key, xml.readElementText());
+		}
+		else
+			xml.skipCurrentElement();
+	}
+}
+
+
 
 }  // namespace OpenOrienteering
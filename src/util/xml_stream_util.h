@@ -40,6 +40,8 @@ class QXmlStreamWriter;
 
 namespace OpenOrienteering {
 
+class ObjectTags;
+
 
 /**
  * Writes a line break to the XML stream unless auto formatting is active.
@@ -243,15 +245,27 @@ public:
 	/**
 	 * Writes the coordinates vector as a simple text format.
 	 * This is much more efficient than saving each coordinate as rich XML.
+	 * 
+	 * From format version 10, the coordinates are written in a compact
+	 * binary encoding, as base64 text with attribute encoding="base64".
 	 */
 	void write(const MapCoordVector& coords);
 	
 	/**
 	 * Writes tags.
 	 */
-	void write(const QHash<QString, QString>& tags);
+	void write(const ObjectTags& tags);
 	
 private:
+	/**
+	 * Writes an attribute with the given name and a decimal integer value.
+	 * 
+	 * Name and value are formatted into buffers on the stack and passed to
+	 * the stream writer as raw data, without allocating temporary strings.
+	 */
+	void writeInteger(const QLatin1String& qualifiedName, qint64 value);
+	void writeInteger(const QLatin1String& qualifiedName, quint64 value);
+	
 	QXmlStreamWriter& xml;
 };
 
@@ -341,6 +355,7 @@ public:
 	/**
 	 * Reads the coordinates vector from a simple text format.
 	 * This is much more efficient than loading each coordinate from rich XML.
+	 * The compact binary encoding is supported, too.
 	 */
 	void read(MapCoordVector& coords);
 	
@@ -360,7 +375,7 @@ public:
 	/**
 	 * Read tags.
 	 */
-	void read(QHash<QString, QString>& tags);
+	void read(ObjectTags& tags);
 	
 private:
 	QXmlStreamReader& xml;
@@ -433,6 +448,8 @@ namespace XmlStreamLiteral
 	static const QLatin1String k("k");
 	
 	static const QLatin1String coord("coord");
+	static const QLatin1String encoding("encoding");
+	static const QLatin1String base64("base64");
 }
 
 
@@ -491,31 +508,31 @@ void XmlElementWriter::writeAttribute(const QLatin1String& qualifiedName, const
 inline
 void XmlElementWriter::writeAttribute(const QLatin1String& qualifiedName, const qint64 value)
 {
-	xml.writeAttribute(qualifiedName, QString::number(value));
+	writeInteger(qualifiedName, value);
 }
 
 inline
 void XmlElementWriter::writeAttribute(const QLatin1String& qualifiedName, const int value)
 {
-	xml.writeAttribute(qualifiedName, QString::number(value));
+	writeInteger(qualifiedName, qint64(value));
 }
 
 inline
 void XmlElementWriter::writeAttribute(const QLatin1String& qualifiedName, const unsigned int value)
 {
-	xml.writeAttribute(qualifiedName, QString::number(value));
+	writeInteger(qualifiedName, quint64(value));
 }
 
 inline
 void XmlElementWriter::writeAttribute(const QLatin1String& qualifiedName, const long unsigned int value)
 {
-	xml.writeAttribute(qualifiedName, QString::number(value));
+	writeInteger(qualifiedName, quint64(value));
 }
 
 inline
 void XmlElementWriter::writeAttribute(const QLatin1String& qualifiedName, const quint64 value)
 {
-	xml.writeAttribute(qualifiedName, QString::number(value));
+	writeInteger(qualifiedName, value);
 }
 
 inline
@@ -567,20 +584,6 @@ void XmlElementWriter::write(const QSizeF& size, int precision)
 	writeAttribute( literal::height, size.height(), precision );
 }
 
-inline
-void XmlElementWriter::write(const QHash<QString, QString> &tags)
-{
-	namespace literal = XmlStreamLiteral;
-	typedef QHash<QString, QString> Tags;
-	
-	for (Tags::const_iterator tag = tags.constBegin(), end = tags.constEnd(); tag != end; ++tag)
-	{
-		XmlElementWriter tag_element(xml, literal::t);
-		tag_element.writeAttribute(literal::k, tag.key());
-		xml.writeCharacters(tag.value());
-	}
-}
-
 //### XmlElementReader inline implemenentation ###
 
 inline
@@ -736,37 +739,6 @@ void XmlElementReader::read(QSizeF& size)
 	size.setHeight(QString::fromRawData(ref.data(), ref.size()).toDouble());
 }
 
-inline
-void XmlElementReader::read(QHash<QString, QString> &tags)
-{
-	namespace literal = XmlStreamLiteral;
-	
-	tags.clear();
-	while (xml.readNextStartElement())
-	{
-		if (xml.name() == literal::t)
-		{
-			const QString key(xml.attributes().value(literal::k).toString());
-			tags.insert(key, xml.readElementText());
-		}
-		else if (xml.name() == literal::tag)
-		{
-			// Full keywords were used in pre-0.6.0 master branch
-			// TODO Remove after Mapper 0.6.x releases
-			const QString key(xml.attributes().value(literal::key).toString());
-			tags.insert(key, xml.readElementText());
-		}
-		else if (xml.name() == literal::tags)
-		{
-			// Fix for broken Object::save in pre-0.6.0 master branch
-			// TODO Remove after Mapper 0.6.x releases
-			const QString key(xml.attributes().value(literal::key).toString());
-			tags.insert(key, xml.readElementText());
-		}
-		else
-			xml.skipCurrentElement();
-	}
-}
 
 
 }  // namespace OpenOrienteering
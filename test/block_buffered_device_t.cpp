@@ -0,0 +1,136 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QtTest>
+#include <QBuffer>
+#include <QByteArray>
+#include <QIODevice>
+#include <QObject>
+
+#include "util/block_buffered_device.h"
+
+
+namespace OpenOrienteering
+{
+
+namespace {
+
+QByteArray testData(int size)
+{
+	QByteArray data;
+	data.reserve(size);
+	for (int i = 0; i < size; ++i)
+		data.append(char('a' + i % 26));
+	return data;
+}
+
+}  // namespace
+
+
+/**
+ * @test Unit test for BlockBufferedDevice.
+ */
+class BlockBufferedDeviceTest : public QObject
+{
+Q_OBJECT
+
+private slots:
+	void readTest_data()
+	{
+		QTest::addColumn<bool>("read_ahead");
+		QTest::newRow("plain") << false;
+		QTest::newRow("read-ahead") << true;
+	}
+	
+	void readTest()
+	{
+		QFETCH(bool, read_ahead);
+		auto const data = testData(3 * 4096 + 100);
+		QBuffer source;
+		source.setData(data);
+		
+		BlockBufferedDevice device(&source, 4096);
+		device.setReadAhead(read_ahead);
+		QVERIFY(device.open(QIODevice::ReadOnly));
+		QCOMPARE(device.size(), qint64(data.size()));
+		
+		// Small reads across block boundaries
+		QByteArray result;
+		while (!device.atEnd())
+			result.append(device.read(1000));
+		QCOMPARE(result, data);
+		QCOMPARE(device.pos(), qint64(data.size()));
+		
+		// Seek within a block, and to another block
+		QVERIFY(device.seek(4096 + 10));
+		QVERIFY(device.seek(4096 + 5));
+		QCOMPARE(device.read(10), data.mid(4096 + 5, 10));
+		QVERIFY(device.seek(20));
+		QCOMPARE(device.read(10), data.mid(20, 10));
+		
+		// Large reads
+		QCOMPARE(device.readAll(), data.mid(30));
+		QVERIFY(device.atEnd());
+		
+		device.close();
+		QVERIFY(source.isOpen());
+	}
+	
+	void writeTest()
+	{
+		auto const data = testData(3 * 4096 + 100);
+		QBuffer target;
+		
+		BlockBufferedDevice device(&target, 4096);
+		QVERIFY(device.open(QIODevice::WriteOnly));
+		QCOMPARE(device.write(data.constData(), 100), qint64(100));
+		QVERIFY(target.data().isEmpty());
+		QCOMPARE(device.size(), qint64(100));
+		
+		QCOMPARE(device.write(data.mid(100, 5000)), qint64(5000));
+		QCOMPARE(device.write(data.mid(5100)), qint64(data.size() - 5100));
+		QVERIFY(device.flush());
+		QCOMPARE(target.data(), data);
+		
+		// Seeking writes the pending data first
+		QCOMPARE(device.write("XYZ", 3), qint64(3));
+		QVERIFY(device.seek(1));
+		QCOMPARE(device.write("B", 1), qint64(1));
+		device.close();
+		QCOMPARE(target.data(), QByteArray(data).replace(1, 1, "B").append("XYZ"));
+	}
+	
+	void unsupportedModeTest()
+	{
+		QBuffer source;
+		BlockBufferedDevice device(&source);
+		QVERIFY(!device.open(QIODevice::ReadWrite));
+		QVERIFY(!source.isOpen());
+	}
+	
+};  // class BlockBufferedDeviceTest
+
+
+}  // namespace OpenOrienteering
+
+
+
+QTEST_GUILESS_MAIN(OpenOrienteering::BlockBufferedDeviceTest)
+
+#include "block_buffered_device_t.moc"  // IWYU pragma: keep
@@ -0,0 +1,107 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include <QtTest>
+#include <QObject>
+
+#include "util/cache_manager.h"
+
+
+namespace OpenOrienteering
+{
+
+/**
+ * @test Unit test for the cache manager.
+ */
+class CacheManagerTest : public QObject
+{
+Q_OBJECT
+
+private slots:
+	void registrationTest()
+	{
+		auto const initial = CacheManager::memoryUsage();
+		{
+			auto registration = CacheManager::add({ []() { return qint64(100); }, {} });
+			QCOMPARE(CacheManager::memoryUsage(), initial + 100);
+			
+			auto moved = std::move(registration);
+			QCOMPARE(CacheManager::memoryUsage(), initial + 100);
+			
+			registration = CacheManager::add({ []() { return qint64(10); }, {} });
+			QCOMPARE(CacheManager::memoryUsage(), initial + 110);
+			
+			moved.reset();
+			QCOMPARE(CacheManager::memoryUsage(), initial + 10);
+		}
+		QCOMPARE(CacheManager::memoryUsage(), initial);
+	}
+	
+	void trimTest()
+	{
+		std::vector<int> calls;
+		qint64 small = 10;
+		qint64 large = 1000;
+		auto small_registration = CacheManager::add({
+			[&small]() { return small; },
+			[&small, &calls](CacheManager::TrimLevel level) {
+				calls.push_back(1);
+				small = CacheManager::trimTarget(level, small);
+			}
+		});
+		auto large_registration = CacheManager::add({
+			[&large]() { return large; },
+			[&large, &calls](CacheManager::TrimLevel level) {
+				calls.push_back(2);
+				large = CacheManager::trimTarget(level, large);
+			}
+		});
+		
+		// Largest first
+		CacheManager::trim(CacheManager::TrimModerate);
+		QCOMPARE(calls, (std::vector<int>{ 2, 1 }));
+		QCOMPARE(large, qint64(500));
+		QCOMPARE(small, qint64(5));
+		
+		CacheManager::trim(CacheManager::TrimLow);
+		QCOMPARE(large, qint64(125));
+		
+		// Delivered by the event loop
+		calls.clear();
+		CacheManager::requestTrim(CacheManager::TrimCritical);
+		QVERIFY(calls.empty());
+		QTRY_COMPARE(calls.size(), std::size_t(2));
+		QCOMPARE(large, qint64(0));
+		QCOMPARE(small, qint64(0));
+	}
+	
+};  // class CacheManagerTest
+
+
+}  // namespace OpenOrienteering
+
+
+
+QTEST_GUILESS_MAIN(OpenOrienteering::CacheManagerTest)
+
+#include "cache_manager_t.moc"  // IWYU pragma: keep
@@ -0,0 +1,111 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <atomic>
+#include <vector>
+
+#include <QtTest>
+#include <QObject>
+#include <QSemaphore>
+
+#include "util/concurrency.h"
+
+
+namespace OpenOrienteering
+{
+
+/**
+ * @test Unit test for the concurrency utilities.
+ */
+class ConcurrencyTest : public QObject
+{
+Q_OBJECT
+
+private slots:
+	void parallelForTest()
+	{
+		std::vector<std::atomic<int>> calls(1000);
+		for (auto& value : calls)
+			value = 0;
+
+		Concurrency::parallelFor(0, int(calls.size()), [&calls](int i) {
+			++calls[std::size_t(i)];
+		}, 7);
+		for (const auto& value : calls)
+			QCOMPARE(value.load(), 1);
+
+		// Empty ranges
+		Concurrency::parallelFor(5, 5, [](int) { QFAIL("Unexpected call"); });
+		Concurrency::parallelFor(5, 0, [](int) { QFAIL("Unexpected call"); });
+	}
+
+	void progressTest()
+	{
+		Concurrency::Progress progress;
+		std::atomic<int> count { 0 };
+		QVERIFY(Concurrency::parallelFor(0, 100, [&count](int) { ++count; }, &progress, 10));
+		QCOMPARE(count.load(), 100);
+
+		// Copies share the state.
+		auto copy = progress;
+		copy.setPercentage(120);
+		QCOMPARE(progress.percentage(), 100);
+
+		progress.requestInterruption();
+		QVERIFY(copy.isInterruptionRequested());
+		count = 0;
+		QVERIFY(!Concurrency::parallelFor(0, 100000, [&count](int) { ++count; }, &progress, 10));
+		QVERIFY(count.load() < 100000);
+	}
+
+	void priorityTest()
+	{
+		QCOMPARE(Concurrency::currentPriority(), Concurrency::Priority::Normal);
+
+		std::atomic<int> mismatches { 0 };
+		Concurrency::parallelFor(0, 100, [&mismatches](int) {
+			// Nested work inherits the priority.
+			Concurrency::parallelFor(0, 10, [&mismatches](int) {
+				if (Concurrency::currentPriority() != Concurrency::Priority::Background)
+					++mismatches;
+			});
+		}, 1, Concurrency::Priority::Background);
+		QCOMPARE(mismatches.load(), 0);
+		QCOMPARE(Concurrency::currentPriority(), Concurrency::Priority::Normal);
+
+		QSemaphore done;
+		auto priority = Concurrency::Priority::Normal;
+		Concurrency::runInBackground([&done, &priority]() {
+			priority = Concurrency::currentPriority();
+			done.release();
+		});
+		done.acquire();
+		QCOMPARE(priority, Concurrency::Priority::Background);
+	}
+
+};  // class ConcurrencyTest
+
+
+}  // namespace OpenOrienteering
+
+
+
+QTEST_APPLESS_MAIN(OpenOrienteering::ConcurrencyTest)
+
+#include "concurrency_t.moc"  // IWYU pragma: keep
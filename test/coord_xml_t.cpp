@@ -20,6 +20,7 @@
 #include "coord_xml_t.h"
 
 #include <algorithm>
+#include <limits>
 
 #include <QtTest>
 
@@ -371,6 +372,33 @@ void CoordXmlTest::writeFastImplementation()
 }
 
 
+void CoordXmlTest::writeCompactImplementation_data()
+{
+	common_data();
+}
+
+void CoordXmlTest::writeCompactImplementation()
+{
+	buffer.open(QBuffer::ReadWrite);
+	QXmlStreamWriter xml(&buffer);
+	xml.setAutoFormatting(false);
+	xml.writeStartDocument();
+	
+	XMLFileFormat::active_version = 10; // Activate compact encoding.
+	XmlElementWriter element(xml, QLatin1String("root"));
+	
+	QFETCH(int, num_coords);
+	MapCoordVector coords(num_coords, proto_coord);
+	QBENCHMARK
+	{
+		element.write(coords);
+	}
+	
+	xml.writeEndDocument();
+	buffer.close();
+}
+
+
 void CoordXmlTest::readXml_data()
 {
 	common_data();
@@ -1062,6 +1090,137 @@ void CoordXmlTest::readFastImplementation()
 }
 
 
+void CoordXmlTest::readCompactImplementation_data()
+{
+	common_data();
+}
+
+void CoordXmlTest::readCompactImplementation()
+{
+	QFETCH(int, num_coords);
+	MapCoordVector coords(num_coords, proto_coord);
+	
+	buffer.buffer().truncate(0);
+	QBuffer header;
+	{
+		QXmlStreamWriter xml(&header);
+		
+		header.open(QBuffer::ReadWrite);
+		xml.setAutoFormatting(false);
+		xml.writeStartDocument();
+		
+		XMLFileFormat::active_version = 10; // Activate compact encoding.
+		
+		xml.writeStartElement(QString::fromLatin1("root"));
+		xml.writeCharacters(QString{}); // flush root start element
+		
+		buffer.open(QBuffer::ReadWrite);
+		xml.setDevice(&buffer);
+		{
+			XmlElementWriter element(xml, QLatin1String("coords"));
+			element.write(coords);
+		}
+		
+		xml.setDevice(nullptr);
+		
+		buffer.close();
+		header.close();
+	}
+	
+	header.open(QBuffer::ReadOnly);
+	buffer.open(QBuffer::ReadOnly);
+	QXmlStreamReader xml;
+	xml.addData(header.buffer());
+	xml.readNextStartElement();
+	QCOMPARE(xml.name().toString(), QString::fromLatin1("root"));
+	
+	bool failed = false;
+	QBENCHMARK
+	{
+		// benchmark iteration overhead
+		coords.clear();
+		xml.addData(buffer.data());
+		
+		xml.readNextStartElement();
+		if (xml.name() != QLatin1String("coords"))
+		{
+			failed = true;
+			break;
+		}
+		
+		XmlElementReader element(xml);
+		element.read(coords);
+	}
+		
+	QVERIFY(!failed);
+	QCOMPARE((int)coords.size(), num_coords);
+	QVERIFY(compare_all(coords, proto_coord));
+	
+	header.close();
+	buffer.close();
+}
+
+
+void CoordXmlTest::compactEncodingTest()
+{
+	MapCoordVector coords;
+	coords.push_back(MapCoord::fromNative(0, 0));
+	coords.push_back(MapCoord::fromNative(-49999999, 49999999, MapCoord::ClosePoint));
+	coords.push_back(MapCoord::fromNative(49999999, -49999999, MapCoord::Flags(MapCoord::CurveStart) | MapCoord::HolePoint));
+	coords.push_back(MapCoord::fromNative(1, -1, MapCoord::DashPoint));
+	coords.push_back(MapCoord::fromNative(-63, 64));
+	
+	QBuffer data;
+	data.open(QBuffer::ReadWrite);
+	{
+		QXmlStreamWriter xml(&data);
+		xml.setAutoFormatting(false);
+		xml.writeStartDocument();
+		XMLFileFormat::active_version = 10;
+		{
+			XmlElementWriter element(xml, QLatin1String("coords"));
+			element.write(coords);
+		}
+		xml.writeEndDocument();
+	}
+	QVERIFY(data.data().contains("encoding=\"base64\""));
+	
+	data.seek(0);
+	QXmlStreamReader xml(&data);
+	xml.readNextStartElement();
+	QCOMPARE(xml.name().toString(), QString::fromLatin1("coords"));
+	MapCoordVector loaded;
+	{
+		XmlElementReader element(xml);
+		element.read(loaded);
+	}
+	QVERIFY(!xml.hasError());
+	QVERIFY(loaded == coords);
+}
+
+
+void CoordXmlTest::integerAttributesTest()
+{
+	QBuffer data;
+	data.open(QBuffer::ReadWrite);
+	{
+		QXmlStreamWriter xml(&data);
+		xml.setAutoFormatting(false);
+		XmlElementWriter element(xml, QLatin1String("root"));
+		element.writeAttribute(QLatin1String("zero"), 0);
+		element.writeAttribute(QLatin1String("int"), -1234567);
+		element.writeAttribute(QLatin1String("uint"), 4294967295u);
+		element.writeAttribute(QLatin1String("min"), std::numeric_limits<qint64>::min());
+		element.writeAttribute(QLatin1String("max"), std::numeric_limits<quint64>::max());
+		element.writeAttribute(QLatin1String("a_rather_long_attribute_name_for_the_buffer"), 7);
+	}
+	QCOMPARE(QString::fromUtf8(data.data()),
+	         QString::fromLatin1("<root zero=\"0\" int=\"-1234567\" uint=\"4294967295\""
+	                             " min=\"-9223372036854775808\" max=\"18446744073709551615\""
+	                             " a_rather_long_attribute_name_for_the_buffer=\"7\"/>"));
+}
+
+
 bool CoordXmlTest::compare_all(MapCoordVector& coords, MapCoord& expected) const
 {
 	return std::all_of(begin(coords), end(coords), [expected](const MapCoord& coord){ return coord == expected; });
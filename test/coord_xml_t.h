@@ -62,6 +62,10 @@ private slots:
 	void writeFastImplementation();
 	void writeFastImplementation_data();
 	
+	/** Calls the actual implementation of the compact encoding. */
+	void writeCompactImplementation();
+	void writeCompactImplementation_data();
+	
 	/** Reads rich XML. */
 	void readXml();
 	void readXml_data();
@@ -82,6 +86,16 @@ private slots:
 	void readFastImplementation();
 	void readFastImplementation_data();
 	
+	/** Calls the actual implementation of the compact encoding. */
+	void readCompactImplementation();
+	void readCompactImplementation_data();
+	
+	/** Tests that the compact encoding preserves arbitrary coordinates. */
+	void compactEncodingTest();
+	
+	/** Tests the formatting of integer attributes. */
+	void integerAttributesTest();
+	
 private:
 	/** The common test data setup. */
 	void common_data();
@@ -21,6 +21,8 @@
 #include "encoding_t.h"
 
 #include <QtTest>
+#include <QByteArray>
+#include <QChar>
 #include <QLatin1String>
 #include <QLocale>
 #include <QString>
@@ -68,4 +70,53 @@ void EncodingTest::testCodecForName()
 }
 
 
+void EncodingTest::testToUnicode_data()
+{
+	QTest::addColumn<QByteArray>("codec_name");
+	QTest::addColumn<QByteArray>("data");
+	QTest::newRow("1252 empty")    << QByteArray("Windows-1252") << QByteArray();
+	QTest::newRow("1252 ascii")    << QByteArray("Windows-1252") << QByteArray("Forest\r\n401.0\t~");
+	QTest::newRow("1252 umlaut")   << QByteArray("Windows-1252") << QByteArray("Gr\xfcn");
+	QTest::newRow("1251 cyrillic") << QByteArray("Windows-1251") << QByteArray("\xcb\xe5\xf1");
+	QTest::newRow("SJIS ascii")    << QByteArray("Shift-JIS") << QByteArray("Path\\name");
+	QTest::newRow("UTF-16LE")      << QByteArray("UTF-16LE") << QByteArray("G\0r\0\xfc\0n\0", 8);
+	QTest::newRow("UTF-16LE odd")  << QByteArray("UTF-16LE") << QByteArray("G\0r", 3);
+	QTest::newRow("UTF-16LE surrogates") << QByteArray("UTF-16LE") << QByteArray("\x3d\xd8\x00\xde", 4);
+}
+
+void EncodingTest::testToUnicode()
+{
+	QFETCH(QByteArray, codec_name);
+	QFETCH(QByteArray, data);
+	auto const* codec = QTextCodec::codecForName(codec_name);
+	if (!codec)
+		QSKIP("Codec not available");
+	
+	QCOMPARE(Util::toUnicode(codec, data.constData(), data.length()), codec->toUnicode(data));
+	// Again, with a cached result for the codec.
+	QCOMPARE(Util::toUnicode(codec, data.constData(), data.length()), codec->toUnicode(data));
+}
+
+
+void EncodingTest::testFromUtf16LE()
+{
+	QCOMPARE(Util::fromUtf16LE(nullptr, 0), QString());
+	
+	auto const simple = QByteArray("xG\0r\0\xfc\0n\0", 9);
+	// Intentionally unaligned data
+	QCOMPARE(Util::fromUtf16LE(simple.constData() + 1, 4), QString::fromLatin1("Gr\xfcn"));
+	
+	auto const with_bom = QByteArray("\xff\xfeO\0", 4);
+	QCOMPARE(Util::fromUtf16LE(with_bom.constData(), 2), QString::fromLatin1("O"));
+	
+	auto const surrogates = QByteArray("\x3d\xd8\x00\xde", 4);
+	auto const* codec = QTextCodec::codecForName("UTF-16LE");
+	QCOMPARE(Util::fromUtf16LE(surrogates.constData(), 2), codec->toUnicode(surrogates));
+	
+	auto const invalid = QByteArray("\x00\xde", 2);
+	QTextCodec::ConverterState state(QTextCodec::ConvertInvalidToNull);
+	QCOMPARE(Util::fromUtf16LE(invalid.constData(), 1), codec->toUnicode(invalid.constData(), 2, &state));
+}
+
+
 QTEST_APPLESS_MAIN(EncodingTest)
@@ -44,6 +44,17 @@ private slots:
 	 */
 	void testCodecForName();
 	
+	/**
+	 * Tests Util::toUnicode against QTextCodec::toUnicode.
+	 */
+	void testToUnicode();
+	void testToUnicode_data();
+	
+	/**
+	 * Tests Util::fromUtf16LE for simple and for special data.
+	 */
+	void testFromUtf16LE();
+	
 };
 
 #endif
@@ -0,0 +1,243 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "file_format_benchmark_t.h"
+
+#include <memory>
+
+#include <QtGlobal>
+#include <QtTest>
+#include <QByteArray>
+#include <QDir>
+#include <QFile>
+#include <QIODevice>
+#include <QLatin1String>
+#include <QString>
+#include <QTemporaryDir>
+
+#include "test_config.h"
+
+#include "global.h"
+#include "core/map.h"
+#include "core/map_generator.h"
+#include "fileformats/file_format.h"
+#include "fileformats/file_format_registry.h"
+#include "fileformats/file_import_export.h"
+
+using namespace OpenOrienteering;
+
+
+namespace
+{
+	QDir symbol_set_dir;  // clazy:exclude=non-pod-global-static
+	
+	/// The symbol set used for generated maps.
+	const auto symbol_set = QLatin1String("15000/ISOM 2017-2_15000.omap");
+	
+	/**
+	 * Generates a map with the given number of objects.
+	 */
+	std::unique_ptr<Map> generateMap(int num_objects)
+	{
+		auto map = std::make_unique<Map>();
+		if (!map->loadFrom(symbol_set_dir.absoluteFilePath(symbol_set))
+		    || !MapGenerator(MapGenerator::mixedOptions(num_objects)).generate(*map))
+			return {};
+		return map;
+	}
+	
+	/**
+	 * Returns a generated map with the given number of objects.
+	 * 
+	 * The map is reused while the number of objects does not change.
+	 */
+	const Map* cachedMap(int num_objects)
+	{
+		static int cached_num_objects = 0;
+		static std::unique_ptr<Map> cached_map;
+		if (num_objects != cached_num_objects)
+		{
+			cached_map.reset();  // Release the memory first.
+			cached_map = generateMap(num_objects);
+			cached_num_objects = cached_map ? num_objects : 0;
+		}
+		return cached_map.get();
+	}
+	
+	/**
+	 * Resets the process' peak memory figure, if supported.
+	 */
+	void resetPeakMemory()
+	{
+#ifdef Q_OS_LINUX
+		QFile clear_refs(QStringLiteral("/proc/self/clear_refs"));
+		if (clear_refs.open(QIODevice::WriteOnly))
+			clear_refs.write("5");
+#endif
+	}
+	
+	/**
+	 * Reports the process' peak memory since the last reset, if supported.
+	 */
+	void reportPeakMemory()
+	{
+#ifdef Q_OS_LINUX
+		QFile status(QStringLiteral("/proc/self/status"));
+		if (!status.open(QIODevice::ReadOnly))
+			return;
+		for (auto line = status.readLine(); !line.isEmpty(); line = status.readLine())
+		{
+			if (line.startsWith("VmHWM:"))
+			{
+				qInfo("Peak memory: %s", line.mid(6).trimmed().constData());
+				break;
+			}
+		}
+#endif
+	}
+	
+}  // namespace
+
+
+
+void FileFormatBenchmarkTest::initTestCase()
+{
+	doStaticInitializations();
+	
+	symbol_set_dir.cd(QDir(QString::fromUtf8(MAPPER_TEST_SOURCE_DIR)).absoluteFilePath(QStringLiteral("../symbol sets")));
+	QVERIFY(symbol_set_dir.exists());
+	
+	// Static map initializations
+	Map map;
+}
+
+
+void FileFormatBenchmarkTest::common_data()
+{
+	QTest::addColumn<QByteArray>("export_format");
+	QTest::addColumn<QByteArray>("import_format");
+	QTest::addColumn<QString>("extension");
+	QTest::addColumn<int>("num_objects");
+	
+	struct
+	{
+		const char* export_format;
+		const char* import_format;
+		const char* extension;
+	} const formats[] = {
+	    { "XML",        "XML",  "omap" },
+	    { "OCD8",       "OCD",  "ocd"  },
+	    { "OCD9",       "OCD",  "ocd"  },
+	    { "OCD10",      "OCD",  "ocd"  },
+	    { "OCD11",      "OCD",  "ocd"  },
+	    { "OCD12",      "OCD",  "ocd"  },
+	    { "OCD",        "OCD",  "ocd"  },
+	    { "OGR-export", "OGR",  "gpkg" },
+	};
+	
+	// The number of objects is the outer loop, so that maps can be reused.
+	for (auto num_objects : { 10000, 100000, 1000000 })
+	{
+		for (auto const& format : formats)
+		{
+			QTest::newRow(QByteArray(format.export_format) + ", " + QByteArray::number(num_objects))
+			        << QByteArray(format.export_format)
+			        << QByteArray(format.import_format)
+			        << QString::fromLatin1(format.extension)
+			        << num_objects;
+		}
+	}
+}
+
+
+
+void FileFormatBenchmarkTest::saveMap_data()
+{
+	common_data();
+}
+
+void FileFormatBenchmarkTest::saveMap()
+{
+	QFETCH(QByteArray, export_format);
+	QFETCH(QString, extension);
+	QFETCH(int, num_objects);
+	
+	auto const* format = FileFormats.findFormat(export_format.constData());
+	if (!format)
+		QSKIP("File format not available");
+	
+	auto const* map = cachedMap(num_objects);
+	QVERIFY(map);
+	
+	QTemporaryDir dir;
+	QVERIFY(dir.isValid());
+	auto const path = dir.filePath(QLatin1String("benchmark.") + extension);
+	
+	resetPeakMemory();
+	QBENCHMARK
+	{
+		auto exporter = format->makeExporter(path, map, nullptr);
+		QVERIFY(bool(exporter));
+		QVERIFY(exporter->doExport());
+	}
+	reportPeakMemory();
+}
+
+
+void FileFormatBenchmarkTest::loadMap_data()
+{
+	common_data();
+}
+
+void FileFormatBenchmarkTest::loadMap()
+{
+	QFETCH(QByteArray, export_format);
+	QFETCH(QByteArray, import_format);
+	QFETCH(QString, extension);
+	QFETCH(int, num_objects);
+	
+	auto const* exporter_format = FileFormats.findFormat(export_format.constData());
+	auto const* importer_format = FileFormats.findFormat(import_format.constData());
+	if (!exporter_format || !importer_format)
+		QSKIP("File format not available");
+	
+	QTemporaryDir dir;
+	QVERIFY(dir.isValid());
+	auto const path = dir.filePath(QLatin1String("benchmark.") + extension);
+	{
+		auto const* map = cachedMap(num_objects);
+		QVERIFY(map);
+		auto exporter = exporter_format->makeExporter(path, map, nullptr);
+		QVERIFY(bool(exporter));
+		QVERIFY(exporter->doExport());
+	}
+	
+	resetPeakMemory();
+	QBENCHMARK
+	{
+		Map loaded;
+		auto importer = importer_format->makeImporter(path, &loaded, nullptr);
+		QVERIFY(bool(importer));
+		QVERIFY(importer->doImport());
+	}
+	reportPeakMemory();
+}
+
+
+QTEST_GUILESS_MAIN(FileFormatBenchmarkTest)
@@ -0,0 +1,63 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef OPENORIENTEERING_FILE_FORMAT_BENCHMARK_T_H
+#define OPENORIENTEERING_FILE_FORMAT_BENCHMARK_T_H
+
+#include <QObject>
+
+
+namespace OpenOrienteering {
+
+
+/**
+ * @test Benchmarks loading and saving generated maps in the registered
+ *       file formats.
+ * 
+ * The maps are generated from the symbols of an ISOM symbol set, with areas,
+ * lines, points, texts and object tags. On Linux, the peak memory use of each
+ * benchmark is reported, too. As this figure is measured for the process,
+ * it is most meaningful when running a single data row.
+ */
+class FileFormatBenchmarkTest : public QObject
+{
+Q_OBJECT
+	
+private slots:
+	/** Initialization. */
+	void initTestCase();
+	
+	/** Saves a generated map. */
+	void saveMap();
+	void saveMap_data();
+	
+	/** Loads a saved generated map. */
+	void loadMap();
+	void loadMap_data();
+	
+private:
+	/** The file formats and the numbers of objects. */
+	void common_data();
+	
+};
+
+
+}  // namespace OpenOrienteering
+
+#endif
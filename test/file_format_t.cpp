@@ -20,8 +20,10 @@
 
 #include "file_format_t.h"
 
+#include <algorithm>
 #include <array>
 #include <initializer_list>
+#include <iterator>
 #include <limits>
 #include <memory>
 // IWYU pragma: no_include <type_traits>
@@ -37,6 +39,7 @@
 #include <QFile>
 #include <QFileInfo>
 #include <QIODevice>
+#include <QImage>
 #include <QLatin1String>
 #include <QPageSize>
 #include <QPoint>
@@ -45,6 +48,7 @@
 #include <QSize>
 #include <QSizeF>
 #include <QString>
+#include <QStringList>
 #include <QTemporaryDir>
 #include <QVariant>
 
@@ -66,6 +70,8 @@
 #include "fileformats/file_import_export.h"
 #include "fileformats/ocd_file_export.h"
 #include "fileformats/ocd_file_format.h"
+#include "fileformats/ocd_icon.h"
+#include "fileformats/ocd_types_v9.h"
 #include "fileformats/xml_file_format.h"
 #include "templates/template.h"
 #include "undo/undo.h"
@@ -416,6 +422,8 @@ void FileFormatTest::understandsTest_data()
 	quint8 ocd_start_raw[2] = { 0xAD, 0x0C };
 	auto ocd_start   = QByteArray::fromRawData(reinterpret_cast<const char*>(ocd_start_raw), 2).append("random data");
 	auto omap_start  = QByteArray("OMAP plus random data");
+	auto binary_start = QByteArray("OOMB plus random data");
+	auto compressed_start = QByteArray("OOMZ plus random data");
 	auto xml_start   = QByteArray("<?xml version=\"1.0\" encoding=\"UTF-8\"?>");
 	auto xml_legacy  = QByteArray(xml_start + "\r\n<map xmlns=\"http://oorienteering.sourceforge.net/mapper/xml/v2\">");
 	auto xml_regular = QByteArray(xml_start + "\n<map xmlns=\"http://openorienteering.org/apps/mapper/xml/v2\" version=\"7\">");
@@ -435,6 +443,15 @@ void FileFormatTest::understandsTest_data()
 	QTest::newRow("XML < xml other")        << QByteArray("XML") << xml_gpx           << int(FileFormat::NotSupported);
 	QTest::newRow("XML < 'OMAPxxx'")        << QByteArray("XML") << omap_start        << int(FileFormat::FullySupported);
 	QTest::newRow("XML < 0x0CADxxx")        << QByteArray("XML") << ocd_start         << int(FileFormat::NotSupported);
+	QTest::newRow("XML < 'OOMZxxx'")        << QByteArray("XML") << compressed_start  << int(FileFormat::FullySupported);
+	QTest::newRow("XML < 'OOM'")            << QByteArray("XML") << compressed_start.left(3) << int(FileFormat::NotSupported);
+	
+	QTest::newRow("Binary < 'OOMBxxx'")     << QByteArray("Binary") << binary_start   << int(FileFormat::FullySupported);
+	QTest::newRow("Binary < 'OOM'")         << QByteArray("Binary") << binary_start.left(3) << int(FileFormat::Unknown);
+	QTest::newRow("Binary < xml regular")   << QByteArray("Binary") << xml_regular    << int(FileFormat::NotSupported);
+	QTest::newRow("Binary < 'OMAPxxx'")     << QByteArray("Binary") << omap_start     << int(FileFormat::NotSupported);
+	QTest::newRow("Binary < 'OOMZxxx'")     << QByteArray("Binary") << compressed_start << int(FileFormat::NotSupported);
+	QTest::newRow("XML < 'OOMBxxx'")        << QByteArray("XML") << binary_start      << int(FileFormat::NotSupported);
 	
 	QTest::newRow("OCD < 0x0CADxxx")        << QByteArray("OCD") << ocd_start         << int(FileFormat::FullySupported);
 	QTest::newRow("OCD < 0x0CAD")           << QByteArray("OCD") << ocd_start.left(2) << int(FileFormat::FullySupported);
@@ -508,6 +525,40 @@ void FileFormatTest::formatForDataTest()
 }
 
 
+void FileFormatTest::deferredExtensionsTest()
+{
+	struct DeferredFormat : public FileFormat
+	{
+		int calls = 0;
+		
+		DeferredFormat()
+		: FileFormat(MapFile, "deferred", QStringLiteral("Deferred"), QString{}, Feature::FileOpen)
+		{
+			deferExtensions([this]() {
+				++calls;
+				return QStringList{ QStringLiteral("def"), QStringLiteral("dfr") };
+			});
+		}
+	};
+	
+	DeferredFormat format;
+	QVERIFY(format.hasDeferredExtensions());
+	QCOMPARE(format.calls, 0);
+	QCOMPARE(format.fileExtensions(), (QStringList{ QStringLiteral("def"), QStringLiteral("dfr") }));
+	QCOMPARE(format.primaryExtension(), QStringLiteral("def"));
+	QCOMPARE(format.filter(), QStringLiteral("Deferred (*.def *.dfr)"));
+	QCOMPARE(format.calls, 1);
+	
+#ifdef MAPPER_USE_GDAL
+	// The OGR formats defer the GDAL setup.
+	auto const* ogr_format = FileFormats.findFormat("OGR");
+	QVERIFY(ogr_format);
+	QVERIFY(ogr_format->hasDeferredExtensions());
+	QVERIFY(!ogr_format->fileExtensions().isEmpty());
+#endif
+}
+
+
 
 void FileFormatTest::issue_513_high_coordinates_data()
 {
@@ -584,6 +635,7 @@ void FileFormatTest::saveAndLoad_data()
 	// Add all file formats which support import and export
 	static const auto format_ids = {
 	    "XML",
+	    "Binary",
 #ifndef MAPPER_BIG_ENDIAN
 	    "OCD",
 #endif
@@ -696,6 +748,196 @@ void FileFormatTest::saveAndLoad()
 
 
 
+void FileFormatTest::parallelXmlImport_data()
+{
+	QTest::addColumn<QString>("filepath");
+	
+	for (auto const* files : { &xml_test_files, &example_files, &issue_513_files })
+	{
+		for (auto const* raw_path : *files)
+			QTest::newRow(raw_path) << QString::fromUtf8(raw_path);
+	}
+}
+
+void FileFormatTest::parallelXmlImport()
+{
+	QFETCH(QString, filepath);
+	
+	QVERIFY(QFileInfo::exists(filepath));
+	
+	XMLFileFormat format;
+	auto load = [&format, &filepath](Map& map, qint64 threshold) {
+		auto importer = format.makeImporter(filepath, &map, nullptr);
+		importer->setOption(QStringLiteral("parallelThreshold"), threshold);
+		return importer->doImport();
+	};
+	
+	Map serial_map;
+	QVERIFY(load(serial_map, std::numeric_limits<qint64>::max()));
+	
+	Map parallel_map;
+	QVERIFY(load(parallel_map, 0));
+	
+	compareMaps(parallel_map, serial_map);
+	QCOMPARE(parallel_map.undoManager().undoStepCount(), serial_map.undoManager().undoStepCount());
+}
+
+
+
+void FileFormatTest::ocdImportAreaTest()
+{
+	Map original;
+	QVERIFY(original.loadFrom(QStringLiteral("data:/examples/forest sample.omap")));
+	
+	auto const* format = FileFormats.findFormat("OCD");
+	QVERIFY(format);
+	QBuffer buffer;
+	QVERIFY(buffer.open(QIODevice::ReadWrite));
+	auto exporter = format->makeExporter({}, &original, nullptr);
+	exporter->setDevice(&buffer);
+	QVERIFY(exporter->doExport());
+	
+	auto load = [format, &buffer](Map& map, const QRectF& area) {
+		if (!buffer.seek(0))
+			return false;
+		auto importer = format->makeImporter({}, &map, nullptr);
+		importer->setOption(QStringLiteral("importArea"), area);
+		importer->setDevice(&buffer);
+		return importer->doImport();
+	};
+	
+	Map full_map;
+	QVERIFY(load(full_map, {}));
+	QVERIFY(full_map.getNumObjects() >= original.getNumObjects());
+	
+	auto extent = full_map.calculateExtent();
+	extent.setWidth(extent.width() / 2);
+	Map area_map;
+	QVERIFY(load(area_map, extent));
+	QVERIFY(area_map.getNumObjects() > 0);
+	QVERIFY(area_map.getNumObjects() < full_map.getNumObjects());
+	QCOMPARE(area_map.getNumSymbols(), full_map.getNumSymbols());
+	
+	for (int i = 0; i < area_map.getPart(0)->getNumObjects(); ++i)
+	{
+		auto const* object = area_map.getPart(0)->getObject(i);
+		QVERIFY(object->getExtent().left() <= extent.right() + 0.1);
+	}
+}
+
+
+void FileFormatTest::ocdIconCacheTest()
+{
+	Map map;
+	QVERIFY(map.loadFrom(QStringLiteral("data:/examples/forest sample.omap")));
+	QVERIFY(map.getNumSymbols() > 0);
+	
+	auto* symbol = map.getSymbol(0);
+	Ocd::IconV9 const icon = OcdIcon{map, *symbol};
+	OcdIcon::prepareIcons(map);
+	Ocd::IconV9 const prepared_icon = OcdIcon{map, *symbol};
+	QVERIFY(std::equal(std::begin(icon.bits), std::end(icon.bits), std::begin(prepared_icon.bits)));
+	
+	// A changed symbol definition must not return the cached icon.
+	auto image = QImage(icon.width(), icon.height(), QImage::Format_ARGB32_Premultiplied);
+	image.fill(Qt::white);
+	symbol->setCustomIcon(image);
+	Ocd::IconV9 const white_icon = OcdIcon{map, *symbol};
+	QVERIFY(std::all_of(std::begin(white_icon.bits), std::end(white_icon.bits), [](quint8 bits) { return bits == 124; }));
+	
+	image.fill(Qt::black);
+	symbol->setCustomIcon(image);
+	Ocd::IconV9 const black_icon = OcdIcon{map, *symbol};
+	QVERIFY(std::none_of(std::begin(black_icon.bits), std::end(black_icon.bits), [](quint8 bits) { return bits == 124; }));
+}
+
+
+
+void FileFormatTest::compressedXmlTest_data()
+{
+	QTest::addColumn<QString>("filepath");
+	
+	for (auto const* raw_path : example_files)
+		QTest::newRow(raw_path) << QString::fromUtf8(raw_path);
+}
+
+void FileFormatTest::compressedXmlTest()
+{
+	QFETCH(QString, filepath);
+	
+	QVERIFY(QFileInfo::exists(filepath));
+	
+	Map original;
+	QVERIFY(original.loadFrom(filepath));
+	
+	XMLFileFormat format;
+	QBuffer buffer;
+	QVERIFY(buffer.open(QIODevice::ReadWrite));
+	auto exporter = format.makeExporter({}, &original, nullptr);
+	exporter->setOption(QStringLiteral("compressed"), true);
+	exporter->setDevice(&buffer);
+	QVERIFY(exporter->doExport());
+	
+	QVERIFY(buffer.data().startsWith("OOMZ"));
+	QCOMPARE(int(format.understands(buffer.data().constData(), buffer.data().size())), int(FileFormat::FullySupported));
+	
+	Map reloaded;
+	QVERIFY(buffer.seek(0));
+	auto importer = format.makeImporter({}, &reloaded, nullptr);
+	importer->setDevice(&buffer);
+	QVERIFY(importer->doImport());
+	compareMaps(reloaded, original);
+	
+	// Truncated data must be rejected.
+	QBuffer truncated;
+	truncated.setData(buffer.data().left(buffer.data().size() / 2));
+	QVERIFY(truncated.open(QIODevice::ReadOnly));
+	Map broken;
+	importer = format.makeImporter({}, &broken, nullptr);
+	importer->setDevice(&truncated);
+	QVERIFY(!importer->doImport());
+}
+
+
+
+void FileFormatTest::symbolsOnlyImportTest_data()
+{
+	QTest::addColumn<QString>("filepath");
+	
+	for (auto const* raw_path : example_files)
+		QTest::newRow(raw_path) << QString::fromUtf8(raw_path);
+}
+
+void FileFormatTest::symbolsOnlyImportTest()
+{
+	QFETCH(QString, filepath);
+	
+	QVERIFY(QFileInfo::exists(filepath));
+	
+	Map original;
+	QVERIFY(original.loadFrom(filepath));
+	
+	Map symbol_set;
+	auto importer = FileFormats.makeImporter(filepath, symbol_set);
+	QVERIFY(importer);
+	importer->setLoadSymbolsOnly(true);
+	QVERIFY(importer->doImport());
+	
+	QCOMPARE(symbol_set.getScaleDenominator(), original.getScaleDenominator());
+	QCOMPARE(symbol_set.getNumColors(), original.getNumColors());
+	QCOMPARE(symbol_set.getNumSymbols(), original.getNumSymbols());
+	for (int i = 0; i < original.getNumSymbols(); ++i)
+	{
+		QCOMPARE(symbol_set.getSymbol(i)->getNumberAsString(), original.getSymbol(i)->getNumberAsString());
+		QCOMPARE(symbol_set.getSymbol(i)->getName(), original.getSymbol(i)->getName());
+	}
+	QCOMPARE(symbol_set.getNumObjects(), 0);
+	QCOMPARE(symbol_set.getNumTemplates(), 0);
+	QVERIFY(!symbol_set.undoManager().canUndo());
+}
+
+
+
 void FileFormatTest::pristineMapTest()
 {
 	auto spot_color = std::make_unique<MapColor>(QString::fromLatin1("spot color"), 0);
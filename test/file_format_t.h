@@ -54,6 +54,11 @@ private slots:
 	void formatForDataTest();
 	void formatForDataTest_data();
 	
+	/**
+	 * Tests FileFormat::deferExtensions().
+	 */
+	void deferredExtensionsTest();
+	
 	/**
 	 * Tests that high coordinates are correctly moved to the central region
 	 * of the map.
@@ -70,6 +75,35 @@ private slots:
 	void saveAndLoad();
 	void saveAndLoad_data();
 	
+	/**
+	 * Tests that loading the objects of XML maps concurrently gives the same
+	 * result as loading them serially.
+	 */
+	void parallelXmlImport();
+	void parallelXmlImport_data();
+	
+	/**
+	 * Tests importing only the objects in an area from an OCD file.
+	 */
+	void ocdImportAreaTest();
+	
+	/**
+	 * Tests that converted OCD icons are cached per symbol definition.
+	 */
+	void ocdIconCacheTest();
+	
+	/**
+	 * Tests saving and loading the compressed variant of the XML format.
+	 */
+	void compressedXmlTest();
+	void compressedXmlTest_data();
+	
+	/**
+	 * Tests loading only the symbols of a map, for a new map from a symbol set.
+	 */
+	void symbolsOnlyImportTest();
+	void symbolsOnlyImportTest_data();
+	
 	/**
 	 * Tests saving and loading a map which is created in memory and does not go
 	 * through an implicit export-import-cycle before the test.
@@ -0,0 +1,402 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#include "geometry_benchmark_t.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include <QtGlobal>
+#include <QtMath>
+#include <QtTest>
+#include <QPointF>
+#include <QString>
+
+#include "global.h"
+#include "core/map.h"
+#include "core/map_color.h"
+#include "core/map_coord.h"
+#include "core/path_coord.h"
+#include "core/virtual_path.h"
+#include "core/objects/boolean_tool.h"
+#include "core/objects/object.h"
+#include "core/symbols/area_symbol.h"
+#include "core/symbols/line_symbol.h"
+#include "core/symbols/point_symbol.h"
+
+using namespace OpenOrienteering;
+
+
+namespace
+{
+	/// The radius of the synthetic rings, in mm.
+	constexpr qreal ring_radius = 100;
+	
+	/// The number of positions for the queries.
+	constexpr int num_positions = 100;
+	
+	/**
+	 * Returns the coordinates of a closed ring with a wavy outline.
+	 * 
+	 * For curved rings, each segment is a bezier curve with control points
+	 * slightly outside of the outline. The phase shifts the waves, so that
+	 * two rings with different phases cross each other many times.
+	 */
+	MapCoordVector makeRing(int num_coords, bool curved, const QPointF& center = {}, qreal phase = 0)
+	{
+		auto const num_segments = std::max(3, curved ? (num_coords - 1) / 3 : num_coords - 1);
+		auto const outline = [center, phase](qreal t, qreal scale) {
+			auto const angle = 2 * M_PI * t;
+			auto const radius = scale * ring_radius * (1 + 0.05 * std::sin(37 * angle + phase));
+			return center + QPointF(radius * std::cos(angle), radius * std::sin(angle));
+		};
+		
+		MapCoordVector coords;
+		coords.reserve(std::size_t(num_coords));
+		for (int i = 0; i < num_segments; ++i)
+		{
+			auto const t = qreal(i) / num_segments;
+			if (curved)
+			{
+				auto const dt = qreal(1) / num_segments;
+				coords.emplace_back(outline(t, 1), MapCoord::CurveStart);
+				coords.emplace_back(outline(t + dt / 3, 1.01));
+				coords.emplace_back(outline(t + 2 * dt / 3, 1.01));
+			}
+			else
+			{
+				coords.emplace_back(outline(t, 1));
+			}
+		}
+		auto closing = MapCoord(coords.front());
+		closing.setCurveStart(false);
+		closing.setHolePoint(true);
+		closing.setClosePoint(true);
+		coords.push_back(closing);
+		return coords;
+	}
+	
+	/**
+	 * Returns positions on a grid covering the rings.
+	 */
+	std::vector<MapCoordF> makePositions()
+	{
+		std::vector<MapCoordF> positions;
+		positions.reserve(num_positions);
+		auto const per_side = int(std::sqrt(num_positions));
+		for (int i = 0; i < num_positions; ++i)
+		{
+			positions.emplace_back(ring_radius * (2.4 * (i % per_side) / per_side - 1.2),
+			                       ring_radius * (2.4 * (i / per_side) / per_side - 1.2));
+		}
+		return positions;
+	}
+	
+	
+	/**
+	 * A map with the symbols for the benchmarks.
+	 */
+	struct BenchmarkMap
+	{
+		Map map;
+		LineSymbol* line_symbol;
+		LineSymbol* dashed_symbol;
+		AreaSymbol* area_symbol;
+		AreaSymbol* pattern_symbol;
+		
+		BenchmarkMap();
+		
+		/** Returns a ring object with the given symbol, ready for use. */
+		std::unique_ptr<PathObject> makeObject(const Symbol* symbol, const QPointF& center = {}, qreal phase = 0) const;
+	};
+	
+	BenchmarkMap::BenchmarkMap()
+	{
+		auto* black = new MapColor(QStringLiteral("black"), 0);
+		black->setCmyk(MapColorCmyk(0.0f, 0.0f, 0.0f, 1.0f));
+		map.addColor(black, 0);
+		
+		line_symbol = new LineSymbol();
+		line_symbol->setLineWidth(0.5);
+		line_symbol->setColor(black);
+		map.addSymbol(line_symbol, 0);
+		
+		dashed_symbol = new LineSymbol();
+		dashed_symbol->setLineWidth(0.5);
+		dashed_symbol->setColor(black);
+		dashed_symbol->setDashed(true);
+		dashed_symbol->setDashLength(2000);
+		dashed_symbol->setBreakLength(500);
+		map.addSymbol(dashed_symbol, 1);
+		
+		area_symbol = new AreaSymbol();
+		area_symbol->setColor(black);
+		map.addSymbol(area_symbol, 2);
+		
+		pattern_symbol = new AreaSymbol();
+		pattern_symbol->setNumFillPatterns(2);
+		auto& lines = pattern_symbol->getFillPattern(0);
+		lines.type = AreaSymbol::FillPattern::LinePattern;
+		lines.angle = qDegreesToRadians(30.0);
+		lines.line_spacing = 1000;
+		lines.line_offset = 0;
+		lines.line_color = black;
+		lines.line_width = 200;
+		auto& points = pattern_symbol->getFillPattern(1);
+		points.type = AreaSymbol::FillPattern::PointPattern;
+		points.angle = 0;
+		points.line_spacing = 2000;
+		points.line_offset = 0;
+		points.offset_along_line = 0;
+		points.point_distance = 2000;
+		points.point = new PointSymbol();
+		points.point->setInnerRadius(300);
+		points.point->setInnerColor(black);
+		map.addSymbol(pattern_symbol, 3);
+	}
+	
+	std::unique_ptr<PathObject> BenchmarkMap::makeObject(const Symbol* symbol, const QPointF& center, qreal phase) const
+	{
+		QFETCH(int, coords);
+		QFETCH(bool, curved);
+		auto object = std::make_unique<PathObject>(symbol, makeRing(coords, curved, center, phase));
+		object->update();
+		return object;
+	}
+	
+	
+	/**
+	 * Benchmarks a boolean operation on two overlapping rings.
+	 */
+	void benchmarkBooleanTool(BooleanTool::Operation operation)
+	{
+		BenchmarkMap benchmark_map;
+		auto subject = benchmark_map.makeObject(benchmark_map.area_symbol);
+		auto other = benchmark_map.makeObject(benchmark_map.area_symbol, { ring_radius / 2, 0 }, 1);
+		BooleanTool tool(operation, &benchmark_map.map);
+		BooleanTool::PathObjects in_objects = { subject.get(), other.get() };
+		
+		QBENCHMARK
+		{
+			BooleanTool::PathObjects out_objects;
+			QVERIFY(tool.executeForObjects(subject.get(), in_objects, out_objects));
+			for (auto* object : out_objects)
+				delete object;
+		}
+	}
+	
+	
+}  // namespace
+
+
+
+void GeometryBenchmarkTest::initTestCase()
+{
+	doStaticInitializations();
+}
+
+
+void GeometryBenchmarkTest::common_data()
+{
+	QTest::addColumn<int>("coords");
+	QTest::addColumn<bool>("curved");
+	
+	for (auto coords : { 100, 1000, 10000, 100000 })
+	{
+		auto const straight_tag = QString::fromLatin1("%1 coords, straight").arg(coords);
+		QTest::newRow(qPrintable(straight_tag)) << coords << false;
+		auto const curved_tag = QString::fromLatin1("%1 coords, curved").arg(coords);
+		QTest::newRow(qPrintable(curved_tag)) << coords << true;
+	}
+}
+
+
+
+void GeometryBenchmarkTest::pathCoordUpdate_data()
+{
+	common_data();
+}
+
+void GeometryBenchmarkTest::pathCoordUpdate()
+{
+	QFETCH(int, coords);
+	QFETCH(bool, curved);
+	
+	auto const flags = makeRing(coords, curved);
+	MapCoordVectorF ring_coords(begin(flags), end(flags));
+	
+	QBENCHMARK
+	{
+		PathCoordVector path_coords(flags, ring_coords);
+		path_coords.update(0);
+	}
+}
+
+
+void GeometryBenchmarkTest::pathCoordUpdateIncremental_data()
+{
+	common_data();
+}
+
+void GeometryBenchmarkTest::pathCoordUpdateIncremental()
+{
+	QFETCH(int, coords);
+	QFETCH(bool, curved);
+	
+	auto const flags = makeRing(coords, curved);
+	MapCoordVectorF ring_coords(begin(flags), end(flags));
+	PathCoordVector path_coords(flags, ring_coords);
+	path_coords.update(0);
+	
+	auto const index = ring_coords.size() / 2;
+	auto const original = ring_coords[index];
+	auto offset = MapCoordF(0.1, 0.1);
+	QBENCHMARK
+	{
+		ring_coords[index] = original + offset;
+		offset = -offset;
+		path_coords.update(0);
+	}
+}
+
+
+void GeometryBenchmarkTest::calcAllIntersectionsWith_data()
+{
+	common_data();
+}
+
+void GeometryBenchmarkTest::calcAllIntersectionsWith()
+{
+	BenchmarkMap benchmark_map;
+	auto subject = benchmark_map.makeObject(benchmark_map.line_symbol);
+	auto other = benchmark_map.makeObject(benchmark_map.line_symbol, {}, 1);
+	
+	PathObject::Intersections intersections;
+	QBENCHMARK
+	{
+		intersections.clear();
+		subject->calcAllIntersectionsWith(other.get(), intersections);
+	}
+	QVERIFY(!intersections.empty());
+}
+
+
+void GeometryBenchmarkTest::findClosestPointTo_data()
+{
+	common_data();
+}
+
+void GeometryBenchmarkTest::findClosestPointTo()
+{
+	BenchmarkMap benchmark_map;
+	auto object = benchmark_map.makeObject(benchmark_map.line_symbol);
+	auto const positions = makePositions();
+	
+	QBENCHMARK
+	{
+		for (auto const& position : positions)
+			object->findClosestPointTo(position);
+	}
+}
+
+
+void GeometryBenchmarkTest::isPointInsideArea_data()
+{
+	common_data();
+}
+
+void GeometryBenchmarkTest::isPointInsideArea()
+{
+	BenchmarkMap benchmark_map;
+	auto object = benchmark_map.makeObject(benchmark_map.area_symbol);
+	auto const positions = makePositions();
+	
+	int inside = 0;
+	QBENCHMARK
+	{
+		inside = 0;
+		for (auto const& position : positions)
+			inside += object->isPointInsideArea(position) ? 1 : 0;
+	}
+	QVERIFY(inside > 0);
+	QVERIFY(inside < num_positions);
+}
+
+
+void GeometryBenchmarkTest::booleanUnion_data()
+{
+	common_data();
+}
+
+void GeometryBenchmarkTest::booleanUnion()
+{
+	benchmarkBooleanTool(BooleanTool::Union);
+}
+
+
+void GeometryBenchmarkTest::booleanDifference_data()
+{
+	common_data();
+}
+
+void GeometryBenchmarkTest::booleanDifference()
+{
+	benchmarkBooleanTool(BooleanTool::Difference);
+}
+
+
+void GeometryBenchmarkTest::dashedLine_data()
+{
+	common_data();
+}
+
+void GeometryBenchmarkTest::dashedLine()
+{
+	BenchmarkMap benchmark_map;
+	auto object = benchmark_map.makeObject(benchmark_map.dashed_symbol);
+	
+	QBENCHMARK
+	{
+		object->forceUpdate();
+	}
+}
+
+
+void GeometryBenchmarkTest::fillPatterns_data()
+{
+	common_data();
+}
+
+void GeometryBenchmarkTest::fillPatterns()
+{
+	BenchmarkMap benchmark_map;
+	auto object = benchmark_map.makeObject(benchmark_map.pattern_symbol);
+	
+	QBENCHMARK
+	{
+		object->forceUpdate();
+	}
+}
+
+
+QTEST_GUILESS_MAIN(GeometryBenchmarkTest)
@@ -0,0 +1,91 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#ifndef OPENORIENTEERING_GEOMETRY_BENCHMARK_T_H
+#define OPENORIENTEERING_GEOMETRY_BENCHMARK_T_H
+
+#include <QObject>
+
+
+namespace OpenOrienteering {
+
+
+/**
+ * @test Benchmarks the geometry core on synthetic paths.
+ * 
+ * The paths are closed rings with a wavy outline, made of straight or of
+ * curved segments. Each benchmark runs on rings of growing size, in order to
+ * show how the algorithms scale with the number of coordinates.
+ */
+class GeometryBenchmarkTest : public QObject
+{
+Q_OBJECT
+	
+private slots:
+	/** Initialization. */
+	void initTestCase();
+	
+	/** Builds the path coords of a ring from scratch. */
+	void pathCoordUpdate();
+	void pathCoordUpdate_data();
+	
+	/** Updates the path coords of a ring after moving a single coordinate. */
+	void pathCoordUpdateIncremental();
+	void pathCoordUpdateIncremental_data();
+	
+	/** Calculates the intersections of two overlapping rings. */
+	void calcAllIntersectionsWith();
+	void calcAllIntersectionsWith_data();
+	
+	/** Finds the closest points on a ring for a set of positions. */
+	void findClosestPointTo();
+	void findClosestPointTo_data();
+	
+	/** Tests a set of positions for being inside a ring. */
+	void isPointInsideArea();
+	void isPointInsideArea_data();
+	
+	/** Unites two overlapping rings. */
+	void booleanUnion();
+	void booleanUnion_data();
+	
+	/** Subtracts one ring from another overlapping ring. */
+	void booleanDifference();
+	void booleanDifference_data();
+	
+	/** Creates the renderables of a dashed line along a ring. */
+	void dashedLine();
+	void dashedLine_data();
+	
+	/** Creates the renderables of an area with line and point patterns. */
+	void fillPatterns();
+	void fillPatterns_data();
+	
+private:
+	/** The number of coordinates and the type of segments. */
+	void common_data();
+	
+};
+
+
+}  // namespace OpenOrienteering
+
+#endif
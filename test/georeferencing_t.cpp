@@ -21,6 +21,7 @@
 
 #include <cmath>
 #include <cstddef>
+#include <vector>
 
 #include <QtMath>
 #include <QtTest>
@@ -262,6 +263,12 @@ void GeoreferencingTest::testCRS()
 
 void GeoreferencingTest::testCRSTemplates()
 {
+	auto const& crs_templates = CRSTemplateRegistry().list();
+	QVERIFY(!crs_templates.empty());
+	for (auto const& crs_template : crs_templates)
+		QCOMPARE(CRSTemplateRegistry().find(crs_template->id()), crs_template.get());
+	QVERIFY(!CRSTemplateRegistry().find(QStringLiteral("Local")));
+	
 	auto epsg_template = CRSTemplateRegistry().find(QStringLiteral("EPSG"));
 	QCOMPARE(epsg_template->parameters().size(), static_cast<std::size_t>(1));
 	
@@ -338,6 +345,13 @@ void GeoreferencingTest::testProjection()
 	if (std::fabs(proj_coord.y() - northing) > max_dist_error)
 		QCOMPARE(QString::number(proj_coord.y(), 'f'), QString::number(northing, 'f'));
 	
+	// geographic to projected, batch
+	auto const batch = georef.toProjectedCoords(std::vector<LatLon>(3, lat_lon), &ok);
+	QVERIFY(ok);
+	QCOMPARE(batch.size(), std::size_t(3));
+	for (auto const& batch_coord : batch)
+		QCOMPARE(batch_coord, proj_coord);
+	
 	// projected to geographic
 	proj_coord = QPointF(easting, northing);
 	lat_lon = georef.toGeographicCoords(proj_coord, &ok);
@@ -347,6 +361,24 @@ void GeoreferencingTest::testProjection()
 	if (std::fabs(lat_lon.longitude() - longitude) > (max_angl_error * std::cos(qDegreesToRadians(latitude))))
 		QCOMPARE(QString::number(lat_lon.longitude(), 'f'), QString::number(longitude, 'f'));
 	
+	// projected to geographic, batch
+	auto const lat_lon_batch = georef.toGeographicCoords(std::vector<QPointF>(3, proj_coord), &ok);
+	QVERIFY(ok);
+	QCOMPARE(lat_lon_batch.size(), std::size_t(3));
+	for (auto const& batch_coord : lat_lon_batch)
+		QCOMPARE(batch_coord, lat_lon);
+	
+	// map to geographic, batch
+	auto const map_coord = georef.toMapCoordF(proj_coord);
+	auto const map_batch = georef.toGeographicCoords(std::vector<MapCoordF>(3, map_coord), &ok);
+	QVERIFY(ok);
+	QCOMPARE(map_batch.size(), std::size_t(3));
+	for (auto const& batch_coord : map_batch)
+	{
+		QVERIFY(std::fabs(batch_coord.latitude() - lat_lon.latitude()) < max_angl_error);
+		QVERIFY(std::fabs(batch_coord.longitude() - lat_lon.longitude()) < max_angl_error);
+	}
+	
 #ifdef MAPPER_USE_GDAL
 	// Cf. OgrFileExport::setupGeoreferencing
 	auto* map_srs = OSRNewSpatialReference(nullptr);
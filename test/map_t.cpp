@@ -19,22 +19,47 @@
 
 #include "map_t.h"
 
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include <QtMath>
 #include <QtTest>
 #include <QBuffer>
+#include <QIODevice>
 #include <QMessageBox>
+#include <QRectF>
+#include <QStandardPaths>
+#include <QTemporaryDir>
 #include <QTextStream>
+#include <QXmlStreamWriter>
 
 #include "test_config.h"
 
 #include "global.h"
 #include "core/map.h"
+#include "core/map_check.h"
 #include "core/map_color.h"
+#include "core/map_coord.h"
+#include "core/map_diff.h"
+#include "core/map_generator.h"
+#include "core/map_memory_statistics.h"
+#include "core/map_part.h"
+#include "core/map_preview.h"
 #include "core/map_printer.h" // IWYU pragma: keep
+#include "core/map_snapshot.h"
 #include "core/map_view.h"
 #include "core/objects/object.h"
 #include "core/objects/symbol_rule_set.h"
+#include "core/symbols/area_symbol.h"
+#include "core/symbols/combined_symbol.h"
 #include "core/symbols/symbol.h"
+#include "core/symbols/line_symbol.h"
 #include "core/symbols/point_symbol.h"
+#include "undo/object_undo.h"
 
 using namespace OpenOrienteering;
 
@@ -292,6 +317,706 @@ void MapTest::hasAlpha()
 
 
 
+void MapTest::colorUsageTest()
+{
+	Map map;
+	MapView view{ &map };
+	QVERIFY(map.loadFrom(examples_dir.absoluteFilePath(QStringLiteral("complete map.omap")), &view));
+	QVERIFY(map.getNumColors() > 1);
+	
+	auto const is_used_by_a_symbol = [&map](const MapColor* color) {
+		for (int i = 0; i < map.getNumSymbols(); ++i)
+		{
+			if (map.getSymbol(i)->containsColor(color))
+				return true;
+		}
+		return false;
+	};
+	
+	for (int c = 0; c < map.getNumColors(); ++c)
+		QCOMPARE(map.isColorUsedByASymbol(map.getColor(c)), is_used_by_a_symbol(map.getColor(c)));
+	
+	// Delete all symbols with the first color
+	auto const* color = map.getColor(0);
+	QVERIFY(map.isColorUsedByASymbol(color));
+	for (int i = map.getNumSymbols() - 1; i >= 0; --i)
+	{
+		if (map.getSymbol(i)->containsColor(color))
+			map.deleteSymbol(i);
+	}
+	QVERIFY(!map.isColorUsedByASymbol(color));
+	for (int c = 0; c < map.getNumColors(); ++c)
+		QCOMPARE(map.isColorUsedByASymbol(map.getColor(c)), is_used_by_a_symbol(map.getColor(c)));
+	
+	// Add a symbol with this color
+	auto* symbol = new LineSymbol();
+	symbol->setColor(color);
+	map.addSymbol(symbol, 0);
+	QVERIFY(map.isColorUsedByASymbol(color));
+	
+	// Delete the color
+	map.deleteColor(0);
+	for (int c = 0; c < map.getNumColors(); ++c)
+		QCOMPARE(map.isColorUsedByASymbol(map.getColor(c)), is_used_by_a_symbol(map.getColor(c)));
+}
+
+
+
+void MapTest::colorPriorityRemapTest()
+{
+	Map map;
+	QVERIFY(map.loadFrom(examples_dir.absoluteFilePath(QStringLiteral("complete map.omap"))));
+	QVERIFY(map.getNumColors() > 3);
+	(void)MapPreview::render(map);
+	
+	// Swap the first and the third color.
+	auto* first = map.getMapColor(0);
+	auto* third = map.getMapColor(2);
+	map.setColor(third, 0);
+	map.setColor(first, 2);
+	
+	std::vector<int> priorities(std::size_t(map.getNumColors()));
+	for (std::size_t i = 0; i < priorities.size(); ++i)
+		priorities[i] = int(i);
+	std::swap(priorities[0], priorities[2]);
+	map.remapColorPriorities(priorities);
+	
+	// The objects are not regenerated.
+	auto num_dirty = 0;
+	map.applyOnAllObjects([&num_dirty](const Object* object) {
+		if (object->isOutputDirty())
+			++num_dirty;
+	});
+	QCOMPARE(num_dirty, 0);
+	auto const remapped = MapPreview::render(map);
+	
+	map.updateAllObjects();
+	auto const regenerated = MapPreview::render(map);
+	QCOMPARE(remapped, regenerated);
+}
+
+
+
+void MapTest::symbolIndexTest()
+{
+	Map map;
+	MapView view{ &map };
+	QVERIFY(map.loadFrom(examples_dir.absoluteFilePath(QStringLiteral("complete map.omap")), &view));
+	
+	auto* part = map.getPart(0);
+	QVERIFY(part->getNumObjects() > 1);
+	
+	auto const count_objects = [part](const Symbol* symbol) {
+		std::size_t count = 0;
+		for (int i = 0; i < part->getNumObjects(); ++i)
+		{
+			if (part->getObject(i)->getSymbol() == symbol)
+				++count;
+		}
+		return count;
+	};
+	
+	auto* object = part->getObject(0);
+	auto const* symbol = object->getSymbol();
+	QCOMPARE(part->objectsWithSymbol(symbol).size(), count_objects(symbol));
+	QVERIFY(part->existsObjectWithSymbol(symbol));
+	QVERIFY(map.existsObjectWithSymbol(symbol));
+	
+	// Change the symbol of one object
+	auto* new_symbol = duplicate(*symbol).release();
+	map.addSymbol(new_symbol, 0);
+	QVERIFY(!map.existsObjectWithSymbol(new_symbol));
+	QVERIFY(object->setSymbol(new_symbol, true));
+	QCOMPARE(part->objectsWithSymbol(new_symbol).size(), std::size_t(1));
+	QCOMPARE(part->objectsWithSymbol(new_symbol).front(), object);
+	QCOMPARE(part->objectsWithSymbol(symbol).size(), count_objects(symbol));
+	
+	// Delete the object
+	part->deleteObject(object);
+	QVERIFY(!map.existsObjectWithSymbol(new_symbol));
+	QCOMPARE(part->objectsWithSymbol(symbol).size(), count_objects(symbol));
+}
+
+
+void MapTest::addObjectsTest()
+{
+	Map map;
+	auto* part = map.getCurrentPart();
+	auto* symbol = map.getUndefinedLine();
+	map.addObject(new PathObject(symbol, { MapCoord(0, 0), MapCoord(10, 10) }));
+	
+	// More objects than needed for concurrent creation of renderables
+	std::vector<Object*> objects;
+	for (int i = 0; i < 200; ++i)
+		objects.push_back(new PathObject(symbol, { MapCoord(i, 100), MapCoord(i, 110) }));
+	
+	QCOMPARE(map.addObjects(objects), 1);
+	QCOMPARE(part->getNumObjects(), 201);
+	QCOMPARE(part->getObject(1), objects.front());
+	QCOMPARE(part->getObject(200), objects.back());
+	QCOMPARE(part->objectsWithSymbol(symbol).size(), std::size_t(201));
+	for (auto const* object : objects)
+	{
+		QCOMPARE(object->getMap(), &map);
+		QVERIFY(!object->isOutputDirty());
+		QVERIFY(object->getExtent().isValid());
+	}
+	QCOMPARE(part->countObjectsInRect(QRectF(0, 100, 200, 10), true), 200);
+	QCOMPARE(part->countObjectsInRect(QRectF(0, 0, 10, 10), true), 1);
+	
+	QCOMPARE(map.addObjects({}), 201);
+	QCOMPARE(part->getNumObjects(), 201);
+}
+
+void MapTest::findObjectsOrderTest()
+{
+	Map map;
+	auto* part = map.getCurrentPart();
+	auto* symbol = map.getUndefinedLine();
+	auto make_object = [symbol]() {
+		return new PathObject(symbol, { MapCoord(0, 5), MapCoord(10, 5) });
+	};
+	
+	// Inserting at the front makes the part order differ from allocation order.
+	for (int i = 0; i < 20; ++i)
+		part->addObject(make_object(), 0);
+	
+	auto expect_part_order = [part]() {
+		std::vector<Object*> found;
+		part->findObjectsAtBox(MapCoordF(4, 4), MapCoordF(6, 6), true, true, found);
+		if (found.size() != std::size_t(part->getNumObjects()))
+			return false;
+		for (std::size_t i = 0; i < found.size(); ++i)
+		{
+			if (found[i] != part->getObject(int(i)))
+				return false;
+		}
+		return true;
+	};
+	QVERIFY(expect_part_order());
+	
+	part->addObject(make_object(), 5);
+	QVERIFY(expect_part_order());
+	
+	part->addObject(make_object());
+	QVERIFY(expect_part_order());
+	
+	part->setObject(make_object(), 10, true);
+	QVERIFY(expect_part_order());
+	
+	part->deleteObject(3);
+	QVERIFY(expect_part_order());
+	QCOMPARE(part->getNumObjects(), 21);
+}
+
+
+
+void MapTest::savePartTest()
+{
+	Map map;
+	auto* part = map.getCurrentPart();
+	auto* symbol = map.getUndefinedLine();
+	std::vector<Object*> objects;
+	for (int i = 0; i < 2000; ++i)
+	{
+		auto* object = new PathObject(symbol, { MapCoord(i, 100), MapCoord(i, 110 + i % 7) });
+		if (i % 3 == 0)
+			object->setTag(QStringLiteral("i"), QString::number(i));
+		objects.push_back(object);
+	}
+	map.addObjects(objects);
+	
+	// Without a device, the objects are written sequentially.
+	QString expected;
+	{
+		QXmlStreamWriter xml(&expected);
+		part->save(xml);
+	}
+	
+	QBuffer buffer;
+	buffer.open(QIODevice::WriteOnly);
+	{
+		QXmlStreamWriter xml(&buffer);
+		part->save(xml);
+	}
+	QCOMPARE(QString::fromUtf8(buffer.data()), expected);
+}
+
+
+void MapTest::transformAllObjectsTest()
+{
+	Map map;
+	auto* symbol = map.getUndefinedLine();
+	// More objects than needed for concurrent transformation
+	std::vector<Object*> objects;
+	for (int i = 0; i < 200; ++i)
+		objects.push_back(new PathObject(symbol, { MapCoord(i, 100), MapCoord(i, 110) }));
+	map.addObjects(objects);
+	map.addPart(new MapPart(QStringLiteral("second"), &map), 1);
+	map.addObject(new PathObject(symbol, { MapCoord(0, 0), MapCoord(10, 0) }), 1);
+	
+	map.scaleAllObjects(2.0, MapCoord(0, 0));
+	QCOMPARE(objects.back()->getRawCoordinateVector().front(), MapCoord(398, 200));
+	QCOMPARE(map.getPart(1)->getObject(0)->getRawCoordinateVector().back(), MapCoord(20, 0));
+	
+	map.rotateAllObjects(M_PI / 2, MapCoord(0, 0));
+	for (auto const* object : objects)
+	{
+		QVERIFY(!object->isOutputDirty());
+		QVERIFY(object->getExtent().isValid());
+	}
+	QCOMPARE(map.getPart(0)->countObjectsInRect(QRectF(200, -400, 20, 400), true), 200);
+	QCOMPARE(map.getPart(1)->countObjectsInRect(QRectF(-1, -21, 2, 22), true), 1);
+}
+
+
+void MapTest::snapshotTest()
+{
+	Map map;
+	QVERIFY(map.loadFrom(symbol_set_dir.absoluteFilePath(QStringLiteral("15000/ISOM 2017-2_15000.omap"))));
+	MapGenerator::Options options;
+	options.areas = 40;
+	options.lines = 40;
+	options.points = 40;
+	options.texts = 10;
+	QVERIFY(MapGenerator(options).generate(map));
+	map.addPart(new MapPart(QStringLiteral("second"), &map), 1);
+	map.addObject(new PathObject(map.getUndefinedLine(), { MapCoord(0, 0), MapCoord(10, 0) }), 1);
+	
+	auto snapshot = map.snapshot();
+	QVERIFY(snapshot);
+	QCOMPARE(snapshot->generation(), map.changeCount());
+	QCOMPARE(map.snapshot(), snapshot);
+	
+	const auto& copy = snapshot->map();
+	QCOMPARE(copy.getScaleDenominator(), map.getScaleDenominator());
+	QCOMPARE(copy.getNumColors(), map.getNumColors());
+	QCOMPARE(copy.getNumSymbols(), map.getNumSymbols());
+	QCOMPARE(copy.getNumParts(), 2);
+	QCOMPARE(copy.getPart(1)->getName(), QStringLiteral("second"));
+	QCOMPARE(copy.getNumObjects(), map.getNumObjects());
+	for (int i = 0; i < copy.getPart(0)->getNumObjects(); ++i)
+	{
+		const auto* object = copy.getPart(0)->getObject(i);
+		QVERIFY(object->getMap() == &copy);
+		QVERIFY(!object->isOutputDirty());
+		QCOMPARE(copy.findSymbolIndex(object->getSymbol()), map.findSymbolIndex(map.getPart(0)->getObject(i)->getSymbol()));
+	}
+	
+	// Changing the map does not affect the snapshot.
+	auto const num_objects = map.getNumObjects();
+	map.deleteObject(map.getPart(0)->getObject(0));
+	map.setObjectsDirty();
+	QVERIFY(map.changeCount() != snapshot->generation());
+	QCOMPARE(snapshot->map().getNumObjects(), num_objects);
+	
+	auto current = map.snapshot();
+	QVERIFY(current != snapshot);
+	QCOMPARE(current->map().getNumObjects(), num_objects - 1);
+	QCOMPARE(current->generation(), map.changeCount());
+}
+
+
+void MapTest::symbolDependencyTest()
+{
+	Map map;
+	auto* line = duplicate(*Map::getUndefinedLine()).release();
+	line->setLineWidth(0.1);
+	auto* mid = new PointSymbol();
+	line->setMidSymbol(mid);
+	map.addSymbol(line, 0);
+	
+	auto* inner = new CombinedSymbol();
+	inner->setNumParts(1);
+	inner->setPart(0, line, false);
+	map.addSymbol(inner, 1);
+	
+	auto* outer = new CombinedSymbol();
+	outer->setNumParts(1);
+	outer->setPart(0, inner, false);
+	map.addSymbol(outer, 2);
+	
+	auto* other = new AreaSymbol();
+	map.addSymbol(other, 3);
+	
+	auto as_set = [](const std::vector<const Symbol*>& symbols) {
+		return std::set<const Symbol*>(begin(symbols), end(symbols));
+	};
+	QCOMPARE(as_set(map.dependentSymbols(mid)), (std::set<const Symbol*>{ line, inner, outer }));
+	QCOMPARE(as_set(map.dependentSymbols(line)), (std::set<const Symbol*>{ inner, outer }));
+	QCOMPARE(as_set(map.dependentSymbols(inner)), (std::set<const Symbol*>{ outer }));
+	QVERIFY(map.dependentSymbols(outer).empty());
+	QVERIFY(map.dependentSymbols(other).empty());
+	
+	// Replacing the line symbol updates objects of nested combined symbols.
+	auto* object = new PathObject(outer, { MapCoord(0, 0), MapCoord(10, 0) });
+	map.addObject(object);
+	map.updateObjects();
+	QVERIFY(object->getExtent().height() < 0.5);
+	
+	auto* wide_line = duplicate(*line).release();
+	wide_line->setLineWidth(2.0);
+	map.setSymbol(wide_line, 0);
+	QVERIFY(inner->getPart(0) == wide_line);
+	QVERIFY(!object->isOutputDirty());
+	QVERIFY(object->getExtent().height() > 1.5);
+}
+
+
+void MapTest::generatorTest()
+{
+	Map map;
+	QVERIFY(map.loadFrom(symbol_set_dir.absoluteFilePath(QStringLiteral("15000/ISOM 2017-2_15000.omap"))));
+	
+	MapGenerator::Options options;
+	options.areas = 40;
+	options.lines = 30;
+	options.dashed_lines = 20;
+	options.points = 20;
+	options.texts = 10;
+	options.tags = 3;
+	QCOMPARE(options.numObjects(), 120);
+	QVERIFY(MapGenerator(options).generate(map));
+	
+	QCOMPARE(map.getNumParts(), 1);
+	auto* part = map.getPart(0);
+	QCOMPARE(part->getNumObjects(), options.numObjects());
+	
+	int areas = 0, lines = 0, dashed_lines = 0, points = 0, texts = 0;
+	for (int i = 0; i < part->getNumObjects(); ++i)
+	{
+		const auto* object = part->getObject(i);
+		QCOMPARE(object->tags().size(), options.tags);
+		const auto* symbol = object->getSymbol();
+		QVERIFY(!symbol->isHelperSymbol());
+		switch (symbol->getType())
+		{
+		case Symbol::Area:
+			++areas;
+			break;
+		case Symbol::Line:
+			if (symbol->asLine()->isDashed())
+				++dashed_lines;
+			else
+				++lines;
+			break;
+		case Symbol::Point:
+			++points;
+			break;
+		case Symbol::Text:
+			++texts;
+			break;
+		default:
+			QFAIL("Unexpected symbol type");
+		}
+	}
+	QCOMPARE(areas, options.areas);
+	QCOMPARE(lines, options.lines);
+	QCOMPARE(dashed_lines, options.dashed_lines);
+	QCOMPARE(points, options.points);
+	QCOMPARE(texts, options.texts);
+	
+	// The kinds of objects are interleaved.
+	QCOMPARE(part->getObject(0)->getSymbol()->getType(), Symbol::Area);
+	QCOMPARE(part->getObject(1)->getSymbol()->getType(), Symbol::Line);
+	
+	// Without matching symbols, generation fails.
+	Map empty_map;
+	QVERIFY(!MapGenerator(options).generate(empty_map));
+	QVERIFY(MapGenerator(MapGenerator::Options{}).generate(empty_map));
+}
+
+
+
+void MapTest::memoryStatisticsTest()
+{
+	Map map;
+	MapView view{ &map };
+	QVERIFY(map.loadFrom(examples_dir.absoluteFilePath(QStringLiteral("complete map.omap")), &view));
+	map.updateObjects();
+	
+	auto const stats = MapMemoryStatistics::collect(map);
+	QVERIFY(stats.objects > 0);
+	QVERIFY(stats.renderables > 0);
+	QVERIFY(stats.renderables_index > 0);
+	QCOMPARE(stats.total(), stats.objects + stats.renderables + stats.renderables_index + stats.undo + stats.templates + stats.icons);
+	
+	int num_objects = 0;
+	std::size_t objects = 0;
+	std::size_t renderables = 0;
+	for (const auto& usage : stats.symbols)
+	{
+		QVERIFY(usage.num_objects > 0);
+		num_objects += usage.num_objects;
+		objects += usage.objects;
+		renderables += usage.renderables;
+	}
+	QCOMPARE(num_objects, map.getNumObjects());
+	QCOMPARE(objects, stats.objects);
+	QCOMPARE(renderables, stats.renderables);
+	QVERIFY(std::is_sorted(begin(stats.symbols), end(stats.symbols), [](const auto& a, const auto& b) {
+		return a.total() > b.total();
+	}));
+	
+	// Undo steps add to the statistics.
+	auto* step = new ReplaceObjectsUndoStep(&map);
+	step->addObject(0);
+	map.push(step);
+	QVERIFY(MapMemoryStatistics::collect(map).undo > stats.undo);
+}
+
+
+
+void MapTest::mapCheckTest()
+{
+	Map map;
+	auto* line_symbol = map.getUndefinedLine();
+	auto* area_symbol = new AreaSymbol();
+	map.addSymbol(area_symbol, 0);
+	
+	auto* line = new PathObject(line_symbol, { MapCoord(0, 0), MapCoord(100, 0) });
+	map.addObject(line);
+	// Connected to the end of the first line
+	map.addObject(new PathObject(line_symbol, { MapCoord(100, 0), MapCoord(100, 30) }));
+	// Ends 0.2 mm before the first line
+	auto* gap = new PathObject(line_symbol, { MapCoord(50, 0.2), MapCoord(50, 20) });
+	map.addObject(gap);
+	// Overshoots the first line by 0.3 mm
+	auto* dangling = new PathObject(line_symbol, { MapCoord(70, -0.3), MapCoord(70, 20) });
+	map.addObject(dangling);
+	// Almost closed
+	auto* loop = new PathObject(line_symbol, { MapCoord(0, 100), MapCoord(20, 100), MapCoord(20, 120), MapCoord(0, 120), MapCoord(0, 100.3) });
+	map.addObject(loop);
+	// Far away from other lines
+	map.addObject(new PathObject(line_symbol, { MapCoord(0, 50), MapCoord(100, 50) }));
+	
+	auto* unclosed = new PathObject(area_symbol, { MapCoord(200, 0), MapCoord(210, 0), MapCoord(210, 10) });
+	map.addObject(unclosed);
+	
+	auto square = [area_symbol](qreal x, qreal y) {
+		auto* object = new PathObject(area_symbol, { MapCoord(x, y), MapCoord(x + 10, y), MapCoord(x + 10, y + 10), MapCoord(x, y + 10) });
+		object->closeAllParts();
+		return object;
+	};
+	auto* square1 = square(300, 0);
+	auto* square2 = square(305, 5);
+	map.addObject(square1);
+	map.addObject(square2);
+	// Adjacent to the first square
+	map.addObject(square(300, -10));
+	
+	auto const check = MapCheck::run(map, MapCheck::Options{});
+	QCOMPARE(check.issues.size(), std::size_t(5));
+	QCOMPARE(check.count(MapCheck::Gap), std::size_t(2));
+	QCOMPARE(check.count(MapCheck::DanglingLine), std::size_t(1));
+	QCOMPARE(check.count(MapCheck::UnclosedArea), std::size_t(1));
+	QCOMPARE(check.count(MapCheck::OverlappingAreas), std::size_t(1));
+	
+	for (auto const& issue : check.issues)
+	{
+		QCOMPARE(issue.part, 0);
+		QVERIFY(issue.extent.isValid());
+		switch (issue.type)
+		{
+		case MapCheck::Gap:
+			if (issue.object == gap)
+				QCOMPARE(issue.other, line);
+			else
+				QCOMPARE(issue.object, loop);
+			break;
+		case MapCheck::DanglingLine:
+			QCOMPARE(issue.object, dangling);
+			QCOMPARE(issue.other, line);
+			break;
+		case MapCheck::UnclosedArea:
+			QCOMPARE(issue.object, unclosed);
+			break;
+		case MapCheck::OverlappingAreas:
+			QCOMPARE(issue.object, square1);
+			QCOMPARE(issue.other, square2);
+			QVERIFY(issue.extent.contains(QRectF(306, 6, 3, 3)));
+			break;
+		case MapCheck::DuplicateObject:
+			QFAIL("Unexpected duplicate object");
+		}
+	}
+	
+	// A smaller tolerance ignores the gaps and the overshoot.
+	MapCheck::Options options;
+	options.tolerance = 0.1;
+	QCOMPARE(MapCheck::run(map, options).issues.size(), std::size_t(2));
+}
+
+
+void MapTest::mapDuplicatesTest()
+{
+	Map map;
+	auto* line_symbol = map.getUndefinedLine();
+	auto* point_symbol = map.getUndefinedPoint();
+	
+	auto line = [line_symbol](qreal offset) {
+		return new PathObject(line_symbol, { MapCoord(0, 50 + offset), MapCoord(100, 50 + offset) });
+	};
+	auto point = [point_symbol](qreal rotation) {
+		auto* object = new PointObject(point_symbol);
+		object->setPosition(MapCoord(10, 10));
+		object->setRotation(rotation);
+		return object;
+	};
+	
+	auto* original_line = line(0);
+	map.addObject(original_line);
+	map.addObject(line(0));      // exact duplicate
+	map.addObject(line(0.005));  // near duplicate
+	map.addObject(line(0.1));    // distinct
+	auto* reversed = new PathObject(line_symbol, { MapCoord(100, 50), MapCoord(0, 50) });
+	map.addObject(reversed);     // distinct direction
+	
+	auto* original_point = point(0);
+	map.addObject(original_point);
+	map.addObject(point(0));     // exact duplicate
+	map.addObject(point(0));     // exact duplicate
+	map.addObject(point(1));     // rotated
+	
+	auto const num_objects = map.getNumObjects();
+	auto check = MapCheck::run(map, MapCheck::Options{});
+	QCOMPARE(check.count(MapCheck::DuplicateObject), std::size_t(4));
+	for (auto const& issue : check.issues)
+	{
+		if (issue.type != MapCheck::DuplicateObject)
+			continue;
+		if (issue.object->getType() == Object::Path)
+			QCOMPARE(issue.other, original_line);
+		else
+			QCOMPARE(issue.other, original_point);
+	}
+	
+	MapCheck::Options exact;
+	exact.duplicate_tolerance = 0;
+	QCOMPARE(MapCheck::run(map, exact).count(MapCheck::DuplicateObject), std::size_t(3));
+	
+	QCOMPARE(check.removeDuplicates(map), std::size_t(4));
+	QCOMPARE(map.getNumObjects(), num_objects - 4);
+	QVERIFY(map.getPart(0)->findObjectIndex(original_line) >= 0);
+	QVERIFY(map.getPart(0)->findObjectIndex(reversed) >= 0);
+	QCOMPARE(MapCheck::run(map, MapCheck::Options{}).count(MapCheck::DuplicateObject), std::size_t(0));
+	
+	// A single undo step restores all objects, in their original order.
+	QVERIFY(map.undoManager().undo());
+	QCOMPARE(map.getNumObjects(), num_objects);
+	QCOMPARE(map.getPart(0)->findObjectIndex(original_point), 5);
+	QCOMPARE(MapCheck::run(map, MapCheck::Options{}).count(MapCheck::DuplicateObject), std::size_t(4));
+}
+
+
+void MapTest::mapDiffTest()
+{
+	Map base;
+	auto* line_symbol = new LineSymbol();
+	base.addSymbol(line_symbol, 0);
+	for (int i = 0; i < 4; ++i)
+		base.addObject(new PathObject(line_symbol, { MapCoord(0, 10 * i), MapCoord(100, 10 * i) }));
+	
+	Map ours;
+	ours.importMap(base, Map::ObjectImport);
+	Map theirs;
+	theirs.importMap(base, Map::ObjectImport);
+	{
+		auto const diff = MapDiff::compare(base, ours);
+		QCOMPARE(diff.unchanged, std::size_t(4));
+		QVERIFY(diff.changes.empty());
+	}
+	
+	auto* our_part = ours.getPart(0);
+	our_part->getObject(0)->setTag(QStringLiteral("name"), QStringLiteral("a"));
+	our_part->getObject(3)->setTag(QStringLiteral("name"), QStringLiteral("ours"));
+	
+	auto* their_part = theirs.getPart(0);
+	their_part->getObject(0)->setTag(QStringLiteral("name"), QStringLiteral("b"));
+	their_part->getObject(1)->setTag(QStringLiteral("name"), QStringLiteral("theirs"));
+	their_part->deleteObject(3);
+	their_part->deleteObject(2);
+	auto* added = new PathObject(theirs.getSymbol(0), { MapCoord(0, 50), MapCoord(100, 50) });
+	theirs.addObject(added);
+	
+	auto const diff = MapDiff::compare(base, theirs);
+	QCOMPARE(diff.unchanged, std::size_t(0));
+	QCOMPARE(diff.count(MapDiff::Modified), std::size_t(2));
+	QCOMPARE(diff.count(MapDiff::Deleted), std::size_t(2));
+	QCOMPARE(diff.count(MapDiff::Added), std::size_t(1));
+	QCOMPARE(diff.counterpart(base.getPart(0)->getObject(1)), their_part->getObject(1));
+	QVERIFY(!diff.counterpart(base.getPart(0)->getObject(2)));
+	QCOMPARE(diff.changes.back().new_object, added);
+	
+	// Object 0 is modified by both sides, object 3 is modified by us and
+	// deleted by them.
+	auto const merge = MapMerge::run(base, ours, theirs);
+	QCOMPARE(merge.changes.size(), std::size_t(3));
+	QCOMPARE(merge.conflicts.size(), std::size_t(2));
+	QCOMPARE(merge.conflicts[0].our_object, our_part->getObject(0));
+	QCOMPARE(merge.conflicts[0].their_object, their_part->getObject(0));
+	QCOMPARE(merge.conflicts[1].our_object, our_part->getObject(3));
+	QVERIFY(!merge.conflicts[1].their_object);
+	
+	QVERIFY(merge.apply(ours, theirs));
+	QCOMPARE(ours.getNumObjects(), 4);
+	QCOMPARE(our_part->getObject(0)->getTag(QStringLiteral("name")), QStringLiteral("a"));
+	QCOMPARE(our_part->getObject(1)->getTag(QStringLiteral("name")), QStringLiteral("theirs"));
+	QCOMPARE(our_part->getObject(2)->getTag(QStringLiteral("name")), QStringLiteral("ours"));
+	QVERIFY(our_part->getObject(3)->equals(added, true));
+	QCOMPARE(ours.getNumSymbols(), 1);
+	
+	// The merge is a single undo step.
+	QVERIFY(ours.undoManager().undo());
+	{
+		auto const diff = MapDiff::compare(base, ours);
+		QCOMPARE(diff.unchanged, std::size_t(2));
+		QCOMPARE(diff.count(MapDiff::Modified), std::size_t(2));
+		QCOMPARE(diff.changes.size(), std::size_t(2));
+	}
+	
+	// Applying a diff makes the maps equal.
+	QVERIFY(MapDiff::apply(ours, theirs, MapDiff::compare(ours, theirs).changes));
+	QVERIFY(MapDiff::compare(ours, theirs).changes.empty());
+}
+
+
+
+void MapTest::previewTest()
+{
+	QStandardPaths::setTestModeEnabled(true);
+	QDir(MapPreview::directory()).removeRecursively();
+	
+	QTemporaryDir dir;
+	QVERIFY(dir.isValid());
+	auto const path = dir.filePath(QStringLiteral("preview.omap"));
+	QVERIFY(QFile::copy(examples_dir.absoluteFilePath(QStringLiteral("complete map.omap")), path));
+	QVERIFY(MapPreview::load(path).isNull());
+	
+	Map map;
+	QVERIFY(map.loadFrom(path));
+	auto const image = MapPreview::render(map);
+	QCOMPARE(image.size(), QSize(MapPreview::size, MapPreview::size));
+	
+	MapPreview::store(path, image, map);
+	auto const preview = MapPreview::load(path);
+	QVERIFY(!preview.isNull());
+	QCOMPARE(preview.image.size(), image.size());
+	QCOMPARE(preview.scale_denominator, map.getScaleDenominator());
+	QCOMPARE(preview.num_objects, map.getNumObjects());
+	
+	// A modified file invalidates the preview.
+	QFile file(path);
+	QVERIFY(file.open(QIODevice::Append));
+	file.write("\n");
+	file.close();
+	QVERIFY(MapPreview::load(path).isNull());
+	
+	QDir(MapPreview::directory()).removeRecursively();
+}
+
+
+
 void MapTest::crtFileTest()
 {
 	auto original =  symbol_set_dir.absoluteFilePath(QString::fromLatin1("src/ISOM2000_15000.xmap"));
@@ -345,6 +1070,53 @@ void MapTest::crtFileTest()
 
 
 
+void MapTest::symbolRuleSetApplyTest()
+{
+	Map map;
+	auto* symbol_a = new PointSymbol();
+	auto* symbol_b = new PointSymbol();
+	auto* symbol_c = new PointSymbol();
+	map.addSymbol(symbol_a, 0);
+	map.addSymbol(symbol_b, 1);
+	map.addSymbol(symbol_c, 2);
+	
+	auto* tagged_a = new PointObject(symbol_a);
+	tagged_a->setTag(QStringLiteral("x"), QStringLiteral("1"));
+	auto* plain_a = new PointObject(symbol_a);
+	auto* tagged_b = new PointObject(symbol_b);
+	tagged_b->setTag(QStringLiteral("x"), QStringLiteral("2"));
+	auto* plain_c = new PointObject(symbol_c);
+	map.addObject(tagged_a);
+	map.addObject(plain_a);
+	map.addObject(tagged_b);
+	map.addObject(plain_c);
+	
+	// The first matching rule wins.
+	SymbolRuleSet rules;
+	rules.push_back({ ObjectQuery(symbol_b), symbol_c, SymbolRule::ManualAssignment });
+	rules.push_back({ ObjectQuery(QStringLiteral("x"), ObjectQuery::OperatorIs, QStringLiteral("1")), symbol_c, SymbolRule::ManualAssignment });
+	rules.push_back({ ObjectQuery(symbol_a), symbol_b, SymbolRule::ManualAssignment });
+	rules.push_back({ ObjectQuery(QStringLiteral("x"), ObjectQuery::OperatorIs, QStringLiteral("2")), symbol_a, SymbolRule::ManualAssignment });
+	rules.push_back({ ObjectQuery(symbol_c), nullptr, SymbolRule::NoAssignment });
+	rules.push_back({ ObjectQuery(symbol_c), symbol_a, SymbolRule::ManualAssignment });
+	
+	std::vector<const Symbol*> expected;
+	for (auto const* object : { tagged_a, plain_a, tagged_b, plain_c })
+		expected.push_back(rules.match(object));
+	QCOMPARE(expected[0], static_cast<const Symbol*>(symbol_c));
+	QCOMPARE(expected[1], static_cast<const Symbol*>(symbol_b));
+	QCOMPARE(expected[2], static_cast<const Symbol*>(symbol_c));
+	QCOMPARE(expected[3], static_cast<const Symbol*>(symbol_a));
+	
+	rules.apply(map, map);
+	QCOMPARE(tagged_a->getSymbol(), expected[0]);
+	QCOMPARE(plain_a->getSymbol(), expected[1]);
+	QCOMPARE(tagged_b->getSymbol(), expected[2]);
+	QCOMPARE(plain_c->getSymbol(), expected[3]);
+}
+
+
+
 void MapTest::matchQuerySymbolNumberTest_data()
 {
 	QTest::addColumn<QString>("original");
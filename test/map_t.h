@@ -51,9 +51,59 @@ private slots:
 	/** Tests hasAlpha() functions. */
 	void hasAlpha();
 	
+	/** Tests the tracking of colors used by symbols. */
+	void colorUsageTest();
+	
+	/** Tests moving renderables to new color priorities. */
+	void colorPriorityRemapTest();
+	
+	/** Tests the lookup of objects by symbol. */
+	void symbolIndexTest();
+	
+	/** Tests adding many objects at once. */
+	void addObjectsTest();
+	
+	/** Tests that objects found at a location are in the order of the part. */
+	void findObjectsOrderTest();
+	
+	/** Tests that saving a large part concurrently gives the same output. */
+	void savePartTest();
+	
+	/** Tests transforming all objects at once. */
+	void transformAllObjectsTest();
+	
+	/** Tests read-only snapshots of a map. */
+	void snapshotTest();
+	
+	/** Tests the dependencies between symbols. */
+	void symbolDependencyTest();
+	
+	/** Tests the generation of synthetic maps. */
+	void generatorTest();
+	
+	/** Tests the memory statistics. */
+	void memoryStatisticsTest();
+	
+	/** Tests the topology check. */
+	void mapCheckTest();
+	
+	/** Tests the detection and removal of duplicate objects. */
+	void mapDuplicatesTest();
+	
+	/** Tests the comparison and merging of map versions. */
+	void mapDiffTest();
+	
+	/** Tests the cache of map previews. */
+	void previewTest();
+	
 	/** Basic tests for symbol set replacements. */
 	void crtFileTest();
 	
+	/**
+	 * Tests applying a rule set which mixes symbol and tag rules.
+	 */
+	void symbolRuleSetApplyTest();
+	
 	/** Tests symbol set replacements with example files. */
 	void matchQuerySymbolNumberTest_data();
 	void matchQuerySymbolNumberTest();
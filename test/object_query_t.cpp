@@ -27,11 +27,16 @@
 #include <QtTest>
 #include <QByteArray>
 #include <QLatin1String>
+#include <QRegularExpression>
 #include <QString>
 
+#include "core/map.h"
+#include "core/map_part.h"
 #include "core/objects/object.h"
 #include "core/objects/text_object.h"
 #include "core/objects/object_query.h"
+#include "core/objects/object_tags.h"
+#include "core/objects/tags_edit.h"
 #include "core/symbols/point_symbol.h"
 
 using namespace OpenOrienteering;
@@ -287,6 +292,122 @@ void ObjectQueryTest::testSymbol()
 }
 
 
+void ObjectQueryTest::testTagIndex()
+{
+	Map map;
+	for (int i = 0; i < 10; ++i)
+	{
+		auto* object = new PointObject(Map::getUndefinedPoint());
+		object->setTag(QStringLiteral("n"), QString::number(i));
+		object->setTag(QStringLiteral("parity"), (i % 2) ? QStringLiteral("odd") : QStringLiteral("even"));
+		map.addObject(object);
+	}
+	
+	auto count = [&map](const ObjectQuery& query) {
+		int result = 0;
+		map.applyOnMatchingObjects([&result](Object* /*unused*/) { ++result; }, query);
+		return result;
+	};
+	
+	auto const is_odd = ObjectQuery(QStringLiteral("parity"), ObjectQuery::OperatorIs, QStringLiteral("odd"));
+	auto const is_3 = ObjectQuery(QStringLiteral("n"), ObjectQuery::OperatorIs, QStringLiteral("3"));
+	auto const is_4 = ObjectQuery(QStringLiteral("n"), ObjectQuery::OperatorIs, QStringLiteral("4"));
+	auto const is_not_3 = ObjectQuery(QStringLiteral("n"), ObjectQuery::OperatorIsNot, QStringLiteral("3"));
+	auto const contains_d = ObjectQuery(QStringLiteral("parity"), ObjectQuery::OperatorContains, QStringLiteral("d"));
+	
+	QVERIFY(is_odd.isIndexable());
+	QVERIFY(contains_d.isIndexable());
+	QVERIFY(!is_not_3.isIndexable());
+	QVERIFY(!ObjectQuery(ObjectQuery::OperatorSearch, QStringLiteral("odd")).isIndexable());
+	QVERIFY(ObjectQuery(is_odd, ObjectQuery::OperatorAnd, is_not_3).isIndexable());
+	QVERIFY(!ObjectQuery(is_odd, ObjectQuery::OperatorOr, is_not_3).isIndexable());
+	
+	QCOMPARE(count(is_odd), 5);
+	QCOMPARE(count(contains_d), 5);
+	QCOMPARE(count({is_odd, ObjectQuery::OperatorAnd, is_3}), 1);
+	QCOMPARE(count({is_odd, ObjectQuery::OperatorAnd, is_4}), 0);
+	QCOMPARE(count({is_odd, ObjectQuery::OperatorOr, is_4}), 6);
+	QCOMPARE(count({is_odd, ObjectQuery::OperatorAnd, is_not_3}), 4);
+	QCOMPARE(count({is_odd, ObjectQuery::OperatorOr, is_not_3}), 10);
+	
+	// The index follows changes of tags and objects.
+	auto* part = map.getCurrentPart();
+	auto* object = part->getObject(0);
+	object->setTag(QStringLiteral("parity"), QStringLiteral("odd"));
+	QCOMPARE(count(is_odd), 6);
+	object->removeTag(QStringLiteral("parity"));
+	QCOMPARE(count(is_odd), 5);
+	object->setTags({ { QStringLiteral("parity"), QStringLiteral("odd") } });
+	QCOMPARE(count(is_odd), 6);
+	QCOMPARE(count({is_odd, ObjectQuery::OperatorAnd, is_3}), 1);
+	map.deleteObject(part->getObject(3));
+	QCOMPARE(count(is_odd), 5);
+	QCOMPARE(count({is_odd, ObjectQuery::OperatorAnd, is_3}), 0);
+}
+
+
+void ObjectQueryTest::testTagsEdit()
+{
+	auto const a = QStringLiteral("a");
+	auto const b = QStringLiteral("b");
+	
+	ObjectTags tags { { a, QStringLiteral("1") } };
+	QVERIFY(!TagsEdit(TagsEdit::SetValue, a, QStringLiteral("1")).apply(tags));
+	QVERIFY(TagsEdit(TagsEdit::SetValue, b, QStringLiteral("2")).apply(tags));
+	QCOMPARE(tags.value(b), QStringLiteral("2"));
+	QVERIFY(TagsEdit(TagsEdit::RenameKey, b, QStringLiteral("c")).apply(tags));
+	QVERIFY(!tags.contains(b));
+	QCOMPARE(tags.value(QStringLiteral("c")), QStringLiteral("2"));
+	QVERIFY(!TagsEdit(TagsEdit::RenameKey, b, QStringLiteral("c")).apply(tags));
+	QVERIFY(TagsEdit(TagsEdit::RemoveKey, QStringLiteral("c")).apply(tags));
+	QVERIFY(!TagsEdit(TagsEdit::RemoveKey, QStringLiteral("c")).apply(tags));
+	QCOMPARE(tags.size(), 1);
+	
+	tags.insert(b, QStringLiteral("x1y"));
+	QVERIFY(TagsEdit(b, QRegularExpression(QStringLiteral("([0-9])")), QStringLiteral("<\\1>")).apply(tags));
+	QCOMPARE(tags.value(b), QStringLiteral("x<1>y"));
+	QCOMPARE(tags.value(a), QStringLiteral("1"));
+	QVERIFY(TagsEdit(QString{}, QRegularExpression(QStringLiteral("1")), QStringLiteral("2")).apply(tags));
+	QCOMPARE(tags.value(a), QStringLiteral("2"));
+	QCOMPARE(tags.value(b), QStringLiteral("x<2>y"));
+	
+	QVERIFY(!TagsEdit(TagsEdit::SetValue, {}).isValid());
+	QVERIFY(!TagsEdit(TagsEdit::RenameKey, a).isValid());
+	QVERIFY(!TagsEdit(a, QRegularExpression(QStringLiteral("(")), {}).isValid());
+	
+	Map map;
+	for (int i = 0; i < 1000; ++i)
+	{
+		auto* object = new PointObject(Map::getUndefinedPoint());
+		object->setTag(QStringLiteral("parity"), (i % 2) ? QStringLiteral("odd") : QStringLiteral("even"));
+		map.addObject(object);
+	}
+	auto* part = map.getCurrentPart();
+	auto const is_odd = ObjectQuery(QStringLiteral("parity"), ObjectQuery::OperatorIs, QStringLiteral("odd"));
+	auto const rename = TagsEdit(TagsEdit::RenameKey, QStringLiteral("parity"), QStringLiteral("kind"));
+	QCOMPARE(rename.apply(map, is_odd), 500);
+	QCOMPARE(map.undoManager().undoStepCount(), 1);
+	QCOMPARE(part->getObject(1)->getTag(QStringLiteral("kind")), QStringLiteral("odd"));
+	QCOMPARE(part->getObject(0)->getTag(QStringLiteral("parity")), QStringLiteral("even"));
+	QCOMPARE(rename.apply(map, is_odd), 0);
+	QCOMPARE(map.undoManager().undoStepCount(), 1);
+	
+	map.addObjectToSelection(part->getObject(0), false);
+	map.addObjectToSelection(part->getObject(1), false);
+	QCOMPARE(TagsEdit(TagsEdit::SetValue, QStringLiteral("selected"), QStringLiteral("yes")).applyToSelection(map), 2);
+	QCOMPARE(part->getObject(0)->getTag(QStringLiteral("selected")), QStringLiteral("yes"));
+	QVERIFY(!part->getObject(2)->tags().contains(QStringLiteral("selected")));
+	
+	QVERIFY(map.undoManager().undo());
+	QVERIFY(!part->getObject(0)->tags().contains(QStringLiteral("selected")));
+	QVERIFY(map.undoManager().undo());
+	QCOMPARE(part->getObject(1)->getTag(QStringLiteral("parity")), QStringLiteral("odd"));
+	QVERIFY(!part->getObject(1)->tags().contains(QStringLiteral("kind")));
+	QVERIFY(map.undoManager().redo());
+	QCOMPARE(part->getObject(1)->getTag(QStringLiteral("kind")), QStringLiteral("odd"));
+}
+
+
 void ObjectQueryTest::testToString()
 {
 	auto q = ObjectQuery(ObjectQuery::OperatorSearch, QStringLiteral("1"));
@@ -45,6 +45,8 @@ private slots:
 	void testSearch();
 	void testObjectText();
 	void testSymbol();
+	void testTagIndex();
+	void testTagsEdit();
 	void testToString();
 	void testParser();
 
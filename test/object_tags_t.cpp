@@ -0,0 +1,126 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QtTest>
+#include <QLatin1Char>
+#include <QObject>
+#include <QString>
+
+#include "core/objects/object_tags.h"
+
+
+namespace OpenOrienteering
+{
+
+/**
+ * @test Unit test for object tags.
+ */
+class ObjectTagsTest : public QObject
+{
+Q_OBJECT
+
+private slots:
+	void containerTest()
+	{
+		ObjectTags tags;
+		QVERIFY(tags.isEmpty());
+		QVERIFY(!tags.contains(QStringLiteral("a")));
+		QVERIFY(tags.value(QStringLiteral("a")).isNull());
+		
+		tags.insert(QStringLiteral("c"), QStringLiteral("3"));
+		tags.insert(QStringLiteral("a"), QStringLiteral("1"));
+		tags.insert(QStringLiteral("b"), QStringLiteral("2"));
+		QCOMPARE(tags.size(), 3);
+		QVERIFY(tags.contains(QStringLiteral("a")));
+		QCOMPARE(tags.value(QStringLiteral("b")), QStringLiteral("2"));
+		
+		// Sorted by key
+		auto tag = tags.begin();
+		QCOMPARE(tag.key(), QStringLiteral("a"));
+		++tag;
+		QCOMPARE(tag.key(), QStringLiteral("b"));
+		QCOMPARE(tag.value(), QStringLiteral("2"));
+		++tag;
+		QCOMPARE(tag.key(), QStringLiteral("c"));
+		++tag;
+		QVERIFY(tag == tags.end());
+		
+		tags.insert(QStringLiteral("b"), QStringLiteral("22"));
+		QCOMPARE(tags.size(), 3);
+		QCOMPARE(tags.value(QStringLiteral("b")), QStringLiteral("22"));
+		
+		QCOMPARE(tags.remove(QStringLiteral("d")), 0);
+		QCOMPARE(tags.remove(QStringLiteral("b")), 1);
+		QCOMPARE(tags.size(), 2);
+		QVERIFY(!tags.contains(QStringLiteral("b")));
+		
+		tags.clear();
+		QVERIFY(tags.empty());
+	}
+	
+	void equalityTest()
+	{
+		auto const a = ObjectTags{ { QStringLiteral("x"), QStringLiteral("1") }, { QStringLiteral("y"), QStringLiteral("2") } };
+		auto const b = ObjectTags{ { QStringLiteral("y"), QStringLiteral("2") }, { QStringLiteral("x"), QStringLiteral("1") } };
+		QCOMPARE(a, b);
+		
+		auto c = b;
+		c.insert(QStringLiteral("y"), QStringLiteral("3"));
+		QVERIFY(a != c);
+		QCOMPARE(b.value(QStringLiteral("y")), QStringLiteral("2"));
+		
+		c.remove(QStringLiteral("y"));
+		QVERIFY(a != c);
+		QVERIFY(ObjectTags{} != c);
+	}
+	
+	void internTest()
+	{
+		// Distinct string data, equal contents
+		auto const key_1 = QString::fromLatin1("highway");
+		auto const key_2 = QString::fromLatin1("highway");
+		QVERIFY(key_1.constData() != key_2.constData());
+		QCOMPARE(ObjectTags::internKey(key_1).constData(), ObjectTags::internKey(key_2).constData());
+		
+		auto const short_1 = QString::fromLatin1("residential");
+		auto const short_2 = QString::fromLatin1("residential");
+		QCOMPARE(ObjectTags::internValue(short_1).constData(), ObjectTags::internValue(short_2).constData());
+		
+		auto const long_1 = QString(100, QLatin1Char('x'));
+		auto const long_2 = QString(100, QLatin1Char('x'));
+		QVERIFY(ObjectTags::internValue(long_1).constData() != ObjectTags::internValue(long_2).constData());
+		
+		ObjectTags tags_1;
+		tags_1.insert(key_1, short_1);
+		ObjectTags tags_2;
+		tags_2.insert(key_2, short_2);
+		QCOMPARE(tags_1.begin().key().constData(), tags_2.begin().key().constData());
+		QCOMPARE(tags_1.begin().value().constData(), tags_2.begin().value().constData());
+	}
+	
+};
+
+
+}  // namespace OpenOrienteering
+
+
+
+QTEST_GUILESS_MAIN(OpenOrienteering::ObjectTagsTest)
+
+#include "object_tags_t.moc"  // IWYU pragma: keep
@@ -20,12 +20,16 @@
 
 #include "path_object_t.h"
 
+#include <cmath>
+
 #include <QtTest>
+#include <QtMath>
 
 #include "global.h"
 #include "core/map.h"
 #include "core/objects/object.h"
 #include "core/symbols/line_symbol.h"
+#include "core/symbols/symbol.h"
 
 using namespace OpenOrienteering;
 
@@ -1150,6 +1154,221 @@ void PathObjectTest::atypicalPathTest()
 
 
 
+void PathObjectTest::longPathTest()
+{
+	// A zigzag line: (0,0), (1,1), (2,0), (3,1), ...
+	PathObject zigzag{Map::getCoveringRedLine()};
+	for (int i = 0; i < 1000; ++i)
+		zigzag.addCoordinate(MapCoord(i, i % 2));
+	
+	auto closest = zigzag.findClosestPointTo(MapCoordF(500.5, 2.0));
+	QCOMPARE(closest.distance_squared, 1.25);
+	QCOMPARE(closest.path_coord.pos, MapCoordF(501, 1));
+	QCOMPARE(closest.path_coord.param, 0.0f);
+	
+	closest = zigzag.findClosestPointTo(MapCoordF(700.25, 0.25));
+	QVERIFY(closest.distance_squared < 0.000001);
+	QCOMPARE(closest.path_coord.index, PathCoord::size_type(700));
+	
+	closest = zigzag.findClosestPointTo(MapCoordF(700.25, 0.25), 800, 999);
+	QCOMPARE(closest.path_coord.pos, MapCoordF(800, 0));
+	
+	QCOMPARE(zigzag.isPointOnPath(MapCoordF(700.25, 0.3), 0.1, false, false), int(Symbol::Line));
+	QCOMPARE(zigzag.isPointOnPath(MapCoordF(700.25, 2.0), 0.1, false, false), int(Symbol::NoSymbol));
+	
+	PathObject vertical{Map::getCoveringRedLine()};
+	vertical.addCoordinate(MapCoord(600.5, -1));
+	vertical.addCoordinate(MapCoord(600.5, 2));
+	auto intersections = calculateIntersections(zigzag, vertical);
+	QCOMPARE(intersections.size(), std::size_t(1));
+	QCOMPARE(intersections.front().coord, MapCoordF(600.5, 0.5));
+	QCOMPARE(calculateIntersections(vertical, zigzag).size(), std::size_t(1));
+	
+	PathObject horizontal{Map::getCoveringRedLine()};
+	horizontal.addCoordinate(MapCoord(-1, 0.5));
+	horizontal.addCoordinate(MapCoord(1000, 0.5));
+	QCOMPARE(calculateIntersections(zigzag, horizontal).size(), std::size_t(999));
+	QCOMPARE(calculateIntersections(horizontal, zigzag).size(), std::size_t(999));
+	
+	// A closed polygon approximating a circle with radius 10
+	PathObject circle{Map::getCoveringRedLine()};
+	for (int i = 0; i < 360; ++i)
+		circle.addCoordinate(MapCoord(10 * std::cos(qDegreesToRadians(double(i))), 10 * std::sin(qDegreesToRadians(double(i)))));
+	circle.closeAllParts();
+	QVERIFY(circle.isPointInsideArea(MapCoordF(0, 0)));
+	QVERIFY(circle.isPointInsideArea(MapCoordF(0, 9.5)));
+	QVERIFY(circle.isPointInsideArea(MapCoordF(-9.5, 0)));
+	QVERIFY(!circle.isPointInsideArea(MapCoordF(0, 10.5)));
+	QVERIFY(!circle.isPointInsideArea(MapCoordF(20, 0)));
+	QVERIFY(!circle.isPointInsideArea(MapCoordF(-8, 8)));
+	
+	closest = circle.findClosestPointTo(MapCoordF(0, 0));
+	QVERIFY(std::abs(std::sqrt(closest.distance_squared) - 10) < 0.01);
+	
+	// Coordinate changes must invalidate the tree.
+	circle.setCoordinate(180, MapCoord(-20, 0));
+	QVERIFY(circle.isPointInsideArea(MapCoordF(-15, 0)));
+}
+
+void PathObjectTest::incrementalUpdateTest()
+{
+	// A line of 30 curves, with a straight edge in the middle
+	MapCoordVector coords;
+	for (int i = 0; i < 30; ++i)
+	{
+		coords.emplace_back(3 * i, 0);
+		if (i != 15)
+			coords.back().setCurveStart(true);
+		coords.emplace_back(3 * i + 1, 2);
+		coords.emplace_back(3 * i + 2, -2);
+	}
+	coords.emplace_back(90, 0);
+	coords.erase(coords.begin() + 46, coords.begin() + 48);  // straight edge 45 -> 46
+	
+	PathObject path{Map::getCoveringRedLine(), coords};
+	path.update();
+	
+	auto const check = [](const PathObject& actual) {
+		PathObject expected{Map::getCoveringRedLine(), actual.getRawCoordinateVector()};
+		expected.update();
+		const auto& actual_coords = actual.parts().front().path_coords;
+		const auto& expected_coords = expected.parts().front().path_coords;
+		QCOMPARE(actual_coords.size(), expected_coords.size());
+		for (std::size_t i = 0; i < expected_coords.size(); ++i)
+		{
+			QCOMPARE(actual_coords[i].pos, expected_coords[i].pos);
+			QCOMPARE(actual_coords[i].index, expected_coords[i].index);
+			QCOMPARE(actual_coords[i].param, expected_coords[i].param);
+			QCOMPARE(actual_coords[i].clen, expected_coords[i].clen);
+		}
+	};
+	
+	// Moving keeps the flags.
+	auto const move = [&path](MapCoordVector::size_type index, qreal x, qreal y) {
+		auto coord = path.getCoordinate(index);
+		coord.setX(x);
+		coord.setY(y);
+		path.setCoordinate(index, coord);
+	};
+	
+	// A curve handle
+	move(31, 32, 10);
+	path.update();
+	check(path);
+	
+	// A vertex between two curves
+	move(30, 30, 5);
+	path.update();
+	check(path);
+	
+	// The straight edge and the last vertex
+	move(46, 47, 1);
+	move(path.getCoordinateCount() - 1, 91, 1);
+	path.update();
+	check(path);
+	
+	// The first vertex
+	move(0, -1, -1);
+	path.update();
+	check(path);
+	
+	// Changed flags
+	path.setCoordinate(61, MapCoord(61, 0));
+	path.update();
+	check(path);
+}
+
+void PathObjectTest::releasePathCoordsTest()
+{
+	PathObject zigzag{Map::getCoveringRedLine()};
+	for (int i = 0; i < 1000; ++i)
+		zigzag.addCoordinate(MapCoord(i, i % 2));
+	
+	// Nothing is released while the output is dirty.
+	zigzag.releasePathCoords();
+	QVERIFY(!zigzag.hasReleasedPathCoords());
+	
+	zigzag.update();
+	auto const expected = zigzag.findClosestPointTo(MapCoordF(700.25, 0.25));
+	auto const length = zigzag.parts().front().length();
+	auto const bytes = zigzag.pathCoordsMemoryUsage();
+	QVERIFY(bytes > 1000 * sizeof(PathCoord));
+	
+	zigzag.releasePathCoords();
+	QVERIFY(zigzag.hasReleasedPathCoords());
+	QVERIFY(zigzag.pathCoordsMemoryUsage() < bytes / 10);
+	QVERIFY(!zigzag.isOutputDirty());
+	
+	// Queries rebuild the path coords.
+	auto const closest = zigzag.findClosestPointTo(MapCoordF(700.25, 0.25));
+	QVERIFY(!zigzag.hasReleasedPathCoords());
+	QCOMPARE(closest.path_coord.index, expected.path_coord.index);
+	QCOMPARE(closest.path_coord.pos, expected.path_coord.pos);
+	QCOMPARE(zigzag.parts().front().length(), length);
+	
+	zigzag.releasePathCoords();
+	QCOMPARE(zigzag.parts().front().length(), length);
+	
+	zigzag.releasePathCoords();
+	auto const& const_zigzag = zigzag;
+	QCOMPARE(const_zigzag.findPartForIndex(500)->length(), length);
+	QVERIFY(!zigzag.hasReleasedPathCoords());
+	
+	// Copies get the full path coords.
+	zigzag.releasePathCoords();
+	PathObject copy{zigzag};
+	QVERIFY(!copy.hasReleasedPathCoords());
+	QCOMPARE(copy.parts().front().path_coords.size(), zigzag.parts().front().path_coords.size());
+}
+
+void PathObjectTest::simplifyPolylineTest()
+{
+	// A square with 1000 slightly noisy points on each side
+	PathObject square{Map::getCoveringRedLine()};
+	auto const noise = [](int i) { return 0.01 * ((i * 7) % 5 - 2); };
+	for (int i = 0; i < 1000; ++i)
+		square.addCoordinate(MapCoord(i * 0.1, noise(i)));
+	for (int i = 0; i < 1000; ++i)
+		square.addCoordinate(MapCoord(100 + noise(i), i * 0.1));
+	for (int i = 0; i < 1000; ++i)
+		square.addCoordinate(MapCoord(100 - i * 0.1, 100 + noise(i)));
+	for (int i = 0; i < 1000; ++i)
+		square.addCoordinate(MapCoord(noise(i), 100 - i * 0.1));
+	square.closeAllParts();
+	
+	PathObject* undo_duplicate = nullptr;
+	QVERIFY(square.simplify(&undo_duplicate, 0.1));
+	QVERIFY(undo_duplicate);
+	QCOMPARE(undo_duplicate->getCoordinateCount(), MapCoordVector::size_type(4001));
+	delete undo_duplicate;
+	
+	square.update();
+	QCOMPARE(square.parts().size(), std::size_t(1));
+	QVERIFY(square.parts().front().isClosed());
+	QVERIFY(square.getCoordinateCount() >= 5);
+	QVERIFY(square.getCoordinateCount() <= 10);
+	QVERIFY(square.isPointInsideArea(MapCoordF(99, 99)));
+	QVERIFY(square.isPointInsideArea(MapCoordF(1, 99)));
+	QVERIFY(!square.isPointInsideArea(MapCoordF(101, 50)));
+	QVERIFY(std::abs(square.parts().front().length() - 400) < 0.5);
+	
+	// Nothing to remove with a tiny threshold
+	PathObject line{Map::getCoveringRedLine()};
+	line.addCoordinate(MapCoord(0, 0));
+	line.addCoordinate(MapCoord(1, 1));
+	line.addCoordinate(MapCoord(2, 0));
+	QVERIFY(!line.simplify(nullptr, 0.01));
+	QCOMPARE(line.getCoordinateCount(), MapCoordVector::size_type(3));
+	
+	// An open line keeps its end points.
+	QVERIFY(line.simplify(nullptr, 2));
+	QCOMPARE(line.getCoordinateCount(), MapCoordVector::size_type(2));
+	QCOMPARE(line.getCoordinate(0), MapCoord(0, 0));
+	QCOMPARE(MapCoordF(line.getCoordinate(1)), MapCoordF(2, 0));
+}
+
+
+
 /*
  * We don't need a real GUI window.
  */
@@ -75,6 +75,18 @@ private slots:
 	/** Tests PathCoord and SplitPathCoord for a non-trivial zero-length path. */
 	void atypicalPathTest();
 	
+	/** Tests queries on paths which are long enough for a PathCoordTree. */
+	void longPathTest();
+	
+	/** Tests that updates after moving coordinates match full updates. */
+	void incrementalUpdateTest();
+	
+	/** Tests releasing and rebuilding the path coords. */
+	void releasePathCoordsTest();
+	
+	/** Tests the simplification of long polylines. */
+	void simplifyPolylineTest();
+	
 };
 
 #endif
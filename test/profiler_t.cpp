@@ -0,0 +1,132 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QtTest>
+#include <QBuffer>
+#include <QByteArray>
+#include <QIODevice>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QObject>
+#include <QString>
+
+#include "util/profiler.h"
+
+
+namespace OpenOrienteering
+{
+
+/**
+ * @test Unit test for the profiler.
+ */
+class ProfilerTest : public QObject
+{
+Q_OBJECT
+
+private slots:
+	void init()
+	{
+		Profiler::reset();
+	}
+	
+	void cleanup()
+	{
+		Profiler::setEnabled(false);
+		Profiler::reset();
+	}
+	
+	void disabledTest()
+	{
+		Profiler::setEnabled(false);
+		{
+			Profiler::Scope scope(Profiler::ObjectUpdate);
+		}
+		QCOMPARE(Profiler::totals(Profiler::ObjectUpdate).count, qint64(0));
+		QVERIFY(Profiler::recentFrames().empty());
+	}
+	
+	void scopeTest()
+	{
+		Profiler::setEnabled(true);
+		{
+			Profiler::Scope frame(Profiler::Frame);
+			for (int i = 0; i < 3; ++i)
+				Profiler::Scope scope(Profiler::ObjectUpdate);
+		}
+		
+		auto const updates = Profiler::totals(Profiler::ObjectUpdate);
+		QCOMPARE(updates.count, qint64(3));
+		QVERIFY(updates.total_ns >= updates.max_ns);
+		auto const frames = Profiler::totals(Profiler::Frame);
+		QCOMPARE(frames.count, qint64(1));
+		QVERIFY(frames.total_ns >= updates.total_ns);
+		
+		Profiler::record(Profiler::Frame, 0, 20);
+		Profiler::record(Profiler::Frame, 0, 10);
+		QCOMPARE(Profiler::totals(Profiler::Frame).max_ns, qMax(qint64(20), frames.max_ns));
+		
+		auto const recent = Profiler::recentFrames();
+		QCOMPARE(recent.size(), std::size_t(3));
+		QCOMPARE(recent[0].phases[Profiler::ObjectUpdate].count, qint64(3));
+		QCOMPARE(recent[1].phases[Profiler::ObjectUpdate].count, qint64(0));
+		QCOMPARE(recent[2].duration_ns, qint64(10));
+	}
+	
+	void exportTest()
+	{
+		Profiler::setEnabled(true);
+		Profiler::record(Profiler::MapCache, 1000, 3000);
+		Profiler::record(Profiler::ObjectUpdate, 1000, 2000);
+		Profiler::record(Profiler::Frame, 0, 4000);
+		
+		QBuffer buffer;
+		QVERIFY(buffer.open(QIODevice::WriteOnly));
+		QVERIFY(Profiler::writeJson(buffer));
+		auto phases = QJsonDocument::fromJson(buffer.data()).object().value(QStringLiteral("phases")).toObject();
+		auto map_cache = phases.value(QStringLiteral("Map cache")).toObject();
+		QCOMPARE(map_cache.value(QStringLiteral("count")).toInt(), 1);
+		QCOMPARE(map_cache.value(QStringLiteral("total_ms")).toDouble(), 0.002);
+		
+		buffer.close();
+		buffer.setData({});
+		QVERIFY(buffer.open(QIODevice::WriteOnly));
+		QVERIFY(Profiler::writeChromeTrace(buffer));
+		auto const trace = QJsonDocument::fromJson(buffer.data()).object();
+		QVERIFY(trace.contains(QStringLiteral("otherData")));
+		
+		// Object updates are accumulated, but not traced.
+		auto const events = trace.value(QStringLiteral("traceEvents")).toArray();
+		QCOMPARE(events.size(), 2);
+		auto const frame = events.at(1).toObject();
+		QCOMPARE(frame.value(QStringLiteral("name")).toString(), QStringLiteral("Frame"));
+		QCOMPARE(frame.value(QStringLiteral("ph")).toString(), QStringLiteral("X"));
+		QCOMPARE(frame.value(QStringLiteral("dur")).toDouble(), 4.0);
+		QCOMPARE(frame.value(QStringLiteral("args")).toObject().value(QStringLiteral("object_updates")).toInt(), 1);
+	}
+	
+};
+
+
+}  // namespace OpenOrienteering
+
+
+QTEST_GUILESS_MAIN(OpenOrienteering::ProfilerTest)
+
+#include "profiler_t.moc"  // IWYU pragma: keep
@@ -0,0 +1,267 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "rendering_benchmark_t.h"
+
+#include <memory>
+
+#include <Qt>
+#include <QtGlobal>
+#include <QtTest>
+#include <QDir>
+#include <QImage>
+#include <QPainter>
+#include <QRectF>
+#include <QSize>
+#include <QSizeF>
+#include <QString>
+#include <QTransform>
+
+#include "test_config.h"
+
+#include "global.h"
+#include "core/map.h"
+#include "core/map_printer.h"
+#include "core/map_view.h"
+#include "core/renderables/renderable.h"
+#include "undo/undo_manager.h"
+
+using namespace OpenOrienteering;
+
+
+namespace
+{
+	QDir examples_dir;  // clazy:exclude=non-pod-global-static
+	
+	/// The size of the image used for screen rendering.
+	const QSize screen_size{ 1280, 800 };
+	
+	/// The screen resolution at zoom level 1.
+	constexpr qreal pixels_per_mm = 96 / 25.4;
+	
+	/**
+	 * Loads an example map, and tiles the given number of copies per side.
+	 * 
+	 * The copies are placed to the right of and below the original objects.
+	 */
+	std::unique_ptr<Map> loadMap(const QString& filename, int copies)
+	{
+		auto map = std::make_unique<Map>();
+		MapView view{ map.get() };
+		if (!map->loadFrom(examples_dir.absoluteFilePath(filename), &view))
+			return {};
+		
+		if (copies > 1)
+		{
+			Map original;
+			MapView original_view{ &original };
+			if (!original.loadFrom(examples_dir.absoluteFilePath(filename), &original_view))
+				return {};
+			
+			auto const extent = original.calculateExtent(true);
+			for (int row = 0; row < copies; ++row)
+			{
+				for (int column = 0; column < copies; ++column)
+				{
+					if (row == 0 && column == 0)
+						continue;
+					auto const offset = QTransform::fromTranslate(column * extent.width(), row * extent.height());
+					map->importMap(original, Map::ObjectImport, offset);
+				}
+			}
+			map->undoManager().clear();
+		}
+		
+		map->updateObjects();
+		return map;
+	}
+	
+	/**
+	 * Returns the extent of the original objects in a map from loadMap().
+	 */
+	QRectF originalExtent(const Map& map, int copies)
+	{
+		auto extent = map.calculateExtent(true);
+		extent.setSize(extent.size() / copies);
+		return extent;
+	}
+	
+	/**
+	 * Benchmarks one of the drawing functions of Map for a screen-sized image.
+	 * 
+	 * The viewed area is centered on the original objects.
+	 */
+	void benchmarkScreenDrawing(void (Map::*draw)(QPainter*, const RenderConfig&))
+	{
+		QFETCH(QString, filename);
+		QFETCH(int, copies);
+		QFETCH(qreal, zoom);
+		
+		auto map = loadMap(filename, copies);
+		QVERIFY(map);
+		
+		auto const scaling = zoom * pixels_per_mm;
+		auto viewed_rect = QRectF{ 0, 0, screen_size.width() / scaling, screen_size.height() / scaling };
+		viewed_rect.moveCenter(originalExtent(*map, copies).center());
+		RenderConfig config = { *map, viewed_rect, scaling, RenderConfig::Screen | RenderConfig::HelperSymbols, 1.0 };
+		
+		QImage image{ screen_size, QImage::Format_ARGB32_Premultiplied };
+		QBENCHMARK
+		{
+			image.fill(Qt::white);
+			QPainter painter(&image);
+			painter.setRenderHint(QPainter::Antialiasing);
+			painter.scale(scaling, scaling);
+			painter.translate(-viewed_rect.topLeft());
+			((*map).*draw)(&painter, config);
+		}
+	}
+	
+}  // namespace
+
+
+
+void RenderingBenchmarkTest::initTestCase()
+{
+	Q_INIT_RESOURCE(resources);
+	
+	doStaticInitializations();
+	
+	examples_dir.cd(QDir(QString::fromUtf8(MAPPER_TEST_SOURCE_DIR)).absoluteFilePath(QStringLiteral("../examples")));
+	QVERIFY(examples_dir.exists());
+	
+	// Static map initializations
+	Map map;
+}
+
+
+void RenderingBenchmarkTest::maps_data()
+{
+	QTest::addColumn<QString>("filename");
+	QTest::addColumn<int>("copies");
+	
+	for (auto const* filename : { "complete map.omap", "forest sample.omap", "overprinting.omap" })
+	{
+		for (auto copies : { 1, 3 })
+		{
+			QTest::newRow(QStringLiteral("%1, %2x%2").arg(QString::fromLatin1(filename)).arg(copies).toUtf8())
+			        << QString::fromLatin1(filename) << copies;
+		}
+	}
+}
+
+
+void RenderingBenchmarkTest::zoom_data()
+{
+	QTest::addColumn<QString>("filename");
+	QTest::addColumn<int>("copies");
+	QTest::addColumn<qreal>("zoom");
+	
+	for (auto const* filename : { "complete map.omap", "forest sample.omap", "overprinting.omap" })
+	{
+		for (auto copies : { 1, 3 })
+		{
+			for (auto zoom : { 0.25, 1.0, 4.0 })
+			{
+				QTest::newRow(QStringLiteral("%1, %2x%2, zoom %3").arg(QString::fromLatin1(filename)).arg(copies).arg(zoom).toUtf8())
+				        << QString::fromLatin1(filename) << copies << qreal(zoom);
+			}
+		}
+	}
+}
+
+
+
+void RenderingBenchmarkTest::drawMap_data()
+{
+	zoom_data();
+}
+
+void RenderingBenchmarkTest::drawMap()
+{
+	benchmarkScreenDrawing(&Map::draw);
+}
+
+
+void RenderingBenchmarkTest::drawOverprintingSimulation_data()
+{
+	zoom_data();
+}
+
+void RenderingBenchmarkTest::drawOverprintingSimulation()
+{
+	benchmarkScreenDrawing(&Map::drawOverprintingSimulation);
+}
+
+
+void RenderingBenchmarkTest::drawPage_data()
+{
+	maps_data();
+}
+
+void RenderingBenchmarkTest::drawPage()
+{
+	QFETCH(QString, filename);
+	QFETCH(int, copies);
+	
+	auto map = loadMap(filename, copies);
+	QVERIFY(map);
+	
+	MapView view{ map.get() };
+	MapPrinter printer(*map, &view);
+	printer.setResolution(300);
+	printer.setPrintArea(originalExtent(*map, copies));
+	
+	auto const pixel_per_mm = printer.getOptions().resolution / 25.4;
+	auto const size = (printer.getPrintAreaPaperSize() * pixel_per_mm).toSize();
+	QImage image{ size, QImage::Format_ARGB32_Premultiplied };
+	QVERIFY(!image.isNull());
+	image.setDotsPerMeterX(qRound(pixel_per_mm * 1000));
+	image.setDotsPerMeterY(qRound(pixel_per_mm * 1000));
+	
+	QBENCHMARK
+	{
+		image.fill(Qt::white);
+		QPainter painter(&image);
+		printer.drawPage(&painter, printer.getPrintArea(), &image);
+	}
+}
+
+
+void RenderingBenchmarkTest::updateAllObjects_data()
+{
+	maps_data();
+}
+
+void RenderingBenchmarkTest::updateAllObjects()
+{
+	QFETCH(QString, filename);
+	QFETCH(int, copies);
+	
+	auto map = loadMap(filename, copies);
+	QVERIFY(map);
+	
+	QBENCHMARK
+	{
+		map->updateAllObjects();
+	}
+}
+
+
+QTEST_MAIN(RenderingBenchmarkTest)
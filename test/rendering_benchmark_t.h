@@ -0,0 +1,72 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef OPENORIENTEERING_RENDERING_BENCHMARK_T_H
+#define OPENORIENTEERING_RENDERING_BENCHMARK_T_H
+
+#include <QObject>
+
+
+namespace OpenOrienteering {
+
+
+/**
+ * @test Benchmarks the rendering of the example maps.
+ * 
+ * Each benchmark runs on the example maps as they are, and on synthetic
+ * variants which tile copies of the objects side by side, in order to show
+ * how rendering scales with the number of objects.
+ */
+class RenderingBenchmarkTest : public QObject
+{
+Q_OBJECT
+	
+private slots:
+	/** Initialization. */
+	void initTestCase();
+	
+	/** Draws the map to a screen-sized image. */
+	void drawMap();
+	void drawMap_data();
+	
+	/** Draws the overprinting simulation to a screen-sized image. */
+	void drawOverprintingSimulation();
+	void drawOverprintingSimulation_data();
+	
+	/** Draws the original map extent as a print page. */
+	void drawPage();
+	void drawPage_data();
+	
+	/** Regenerates the renderables of all objects. */
+	void updateAllObjects();
+	void updateAllObjects_data();
+	
+private:
+	/** The example maps and the number of copies per side. */
+	void maps_data();
+	
+	/** The example maps, the number of copies per side and the zoom levels. */
+	void zoom_data();
+	
+};
+
+
+}  // namespace OpenOrienteering
+
+#endif
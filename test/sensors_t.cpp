@@ -39,7 +39,10 @@ using namespace OpenOrienteering;
 #endif
 
 #ifdef MAPPER_USE_NMEA_POSITION_PLUGIN
+#include <QGeoCoordinate>           // IWYU pragma: keep
+#include <QGeoPositionInfo>         // IWYU pragma: keep
 #include <QNmeaPositionInfoSource>  // IWYU pragma: keep
+#include "sensors/nmea_parser.h"
 #include "sensors/nmea_position_plugin.h"
 Q_IMPORT_PLUGIN(NmeaPositionPlugin)
 #endif
@@ -61,6 +64,51 @@ private slots:
 	}
 	
 #if defined(MAPPER_USE_NMEA_POSITION_PLUGIN)
+	void nmeaParserTest()
+	{
+		auto parse = [](NmeaParser& parser, const char* sentence, QGeoPositionInfo& info, bool& has_fix) {
+			return parser.parse(sentence, int(qstrlen(sentence)), info, has_fix);
+		};
+		
+		QVERIFY(NmeaParser::hasValidChecksum("$GNVTG,,T,,M,0.341,N,0.631,K,A*3F\r\n", 37));
+		QVERIFY(!NmeaParser::hasValidChecksum("$GNVTG,,T,,M,0.341,N,0.631,K,A*3E\r\n", 37));
+		
+		NmeaParser parser;
+		QGeoPositionInfo info;
+		auto has_fix = false;
+		
+		// Without GGA, RMC provides the position.
+		QVERIFY(parse(parser, "$GNRMC,065901.00,A,3018.94658,S,13920.03591,E,0.341,,050420,,,A*76", info, has_fix));
+		QVERIFY(has_fix);
+		QVERIFY(info.isValid());
+		QCOMPARE(info.timestamp(), QDateTime(QDate(2020, 4, 5), QTime(6, 59, 1), Qt::UTC));
+		
+		QVERIFY(!parse(parser, "$GNVTG,,T,,M,0.341,N,0.631,K,A*3F", info, has_fix));
+		
+		QVERIFY(parse(parser, "$GNGGA,065901.00,3018.94658,S,13920.03591,E,1,11,0.79,362.4,M,10.3,M,,*50", info, has_fix));
+		QVERIFY(has_fix);
+		QCOMPARE(parser.fixQuality(), NmeaParser::GpsFix);
+		QVERIFY(qAbs(info.coordinate().latitude() - -30.3157763) < 0.0000001);
+		QVERIFY(qAbs(info.coordinate().longitude() - 139.3339318) < 0.0000001);
+		QCOMPARE(info.coordinate().altitude(), 362.4);
+		QCOMPARE(info.attribute(QGeoPositionInfo::HorizontalAccuracy), 0.79 * 5);
+		QVERIFY(!info.hasAttribute(QGeoPositionInfo::VerticalAccuracy));
+		QCOMPARE(info.attribute(QGeoPositionInfo::GroundSpeed), 0.631 / 3.6);
+		
+		// With GGA, RMC no longer completes an update.
+		QVERIFY(!parse(parser, "$GNRMC,065902.00,A,3018.94658,S,13920.03591,E,0.341,,050420,,,A*75", info, has_fix));
+		
+		// RTK fix with GST error estimates
+		QVERIFY(!parse(parser, "$GNGST,065902.00,0.05,0.04,0.03,45.0,0.030,0.040,0.050*40", info, has_fix));
+		QVERIFY(parse(parser, "$GNGGA,065902.00,3018.94658,S,13920.03591,E,4,11,0.79,362.4,M,10.3,M,,*56", info, has_fix));
+		QCOMPARE(parser.fixQuality(), NmeaParser::RtkFixed);
+		QCOMPARE(info.attribute(QGeoPositionInfo::HorizontalAccuracy), 0.05);
+		QCOMPARE(info.attribute(QGeoPositionInfo::VerticalAccuracy), 0.05);
+		
+		// Invalid checksum
+		QVERIFY(!parse(parser, "$GNGGA,065903.00,3018.94658,S,13920.03591,E,4,11,0.79,362.4,M,10.3,M,,*56", info, has_fix));
+	}
+	
 	void nmeaPositionSourcePluginTest()
 	{
 		auto nmea_position_source = QStringLiteral("NMEA (OpenOrienteering)");
@@ -0,0 +1,150 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <vector>
+
+#include <QtTest>
+#include <QObject>
+#include <QRectF>
+
+#include "core/spatial_index.h"
+
+
+namespace OpenOrienteering
+{
+
+namespace
+{
+
+std::vector<int> sorted(std::vector<int> values)
+{
+	std::sort(begin(values), end(values));
+	return values;
+}
+
+}  // namespace
+
+
+/**
+ * @test Unit test for the spatial index.
+ */
+class SpatialIndexTest : public QObject
+{
+Q_OBJECT
+
+private slots:
+	void basicTest()
+	{
+		SpatialIndex<int> index(1.0);
+		QVERIFY(index.empty());
+
+		index.insert(1, { 0.0, 0.0, 0.5, 0.5 });
+		index.insert(2, { 10.0, 10.0, 0.5, 0.5 });
+		index.insert(3, { -100.0, -100.0, 400.0, 400.0 });
+		QCOMPARE(int(index.size()), 3);
+		QCOMPARE(index.extent(2), QRectF(10.0, 10.0, 0.5, 0.5));
+
+		QCOMPARE(sorted(index.find({ -1.0, -1.0, 2.0, 2.0 })), (std::vector<int>{ 1, 3 }));
+		QCOMPARE(sorted(index.find({ 9.0, 9.0, 5.0, 5.0 })), (std::vector<int>{ 2, 3 }));
+		QCOMPARE(sorted(index.find({ 500.0, 500.0, 1.0, 1.0 })), (std::vector<int>{ }));
+
+		// Re-inserting replaces the entry.
+		index.insert(1, { 10.2, 10.2, 0.2, 0.2 });
+		QCOMPARE(int(index.size()), 3);
+		QCOMPARE(sorted(index.find({ -1.0, -1.0, 2.0, 2.0 })), (std::vector<int>{ 3 }));
+		QCOMPARE(sorted(index.find({ 10.0, 10.0, 1.0, 1.0 })), (std::vector<int>{ 1, 2, 3 }));
+
+		QVERIFY(index.remove(3));
+		QVERIFY(!index.remove(3));
+		QVERIFY(!index.contains(3));
+		QCOMPARE(sorted(index.find({ -1.0, -1.0, 2.0, 2.0 })), (std::vector<int>{ }));
+
+		index.clear();
+		QVERIFY(index.empty());
+		QVERIFY(index.find({ -1000.0, -1000.0, 2000.0, 2000.0 }).empty());
+	}
+
+	void unboundedTest()
+	{
+		SpatialIndex<int> index;
+		index.insert(1, {});
+		index.insert(2, { 0.0, 0.0, 1.0, 1.0 });
+		QCOMPARE(sorted(index.find({ 100.0, 100.0, 1.0, 1.0 })), (std::vector<int>{ 1 }));
+		QVERIFY(index.remove(1));
+		QVERIFY(index.find({ 100.0, 100.0, 1.0, 1.0 }).empty());
+	}
+
+	void bruteForceTest()
+	{
+		// Deterministic pseudo-random rectangles of varying sizes
+		auto seed = 1u;
+		auto random = [&seed](double range) {
+			seed = seed * 1103515245u + 12345u;
+			return range * double((seed >> 8) & 0xffff) / 0xffff;
+		};
+
+		std::vector<QRectF> extents;
+		SpatialIndex<int> index(2.0);
+		for (int i = 0; i < 2000; ++i)
+		{
+			auto const size = (i % 10 == 0) ? random(200.0) : random(3.0);
+			extents.emplace_back(random(1000.0) - 500.0, random(1000.0) - 500.0, size + 0.01, size / 2 + 0.01);
+			index.insert(i, extents.back());
+		}
+		for (int i = 0; i < 2000; i += 3)
+		{
+			index.remove(i);
+			extents[std::size_t(i)] = {};
+		}
+
+		for (int q = 0; q < 200; ++q)
+		{
+			auto const query = QRectF(random(1000.0) - 500.0, random(1000.0) - 500.0, random(100.0) + 1, random(20.0) + 1);
+			std::vector<int> expected;
+			for (int i = 0; i < 2000; ++i)
+			{
+				if (extents[std::size_t(i)].intersects(query))
+					expected.push_back(i);
+			}
+
+			std::vector<int> actual;
+			for (auto value : sorted(index.find(query)))
+			{
+				QVERIFY(value % 3 != 0);
+				if (extents[std::size_t(value)].intersects(query))
+					actual.push_back(value);
+			}
+			QCOMPARE(actual, expected);
+
+			auto all = sorted(index.find(query));
+			QVERIFY(std::adjacent_find(begin(all), end(all)) == end(all));
+		}
+	}
+
+};  // class SpatialIndexTest
+
+
+}  // namespace OpenOrienteering
+
+
+
+QTEST_APPLESS_MAIN(OpenOrienteering::SpatialIndexTest)
+
+#include "spatial_index_t.moc"  // IWYU pragma: keep
@@ -32,11 +32,14 @@
 #include <QLatin1String>
 #include <QObject>
 #include <QPainter>
+#include <QPainterPath>
 #include <QPoint>
+#include <QPointF>
 #include <QRect>
 #include <QRectF>
 #include <QRgb>
 #include <QSize>
+#include <QStandardPaths>
 #include <QString>
 
 #include "global.h"
@@ -44,7 +47,9 @@
 #include "core/map.h"
 #include "core/map_color.h"
 #include "core/renderables/renderable.h"
+#include "core/renderables/renderable_implementation.h"
 #include "core/symbols/symbol.h"
+#include "core/symbols/symbol_icon_cache.h"
 
 using namespace OpenOrienteering;
 
@@ -136,6 +141,16 @@ QPoint fuzzyDifference(const QImage& lhs, const QImage& rhs)
 }
 
 
+/**
+ * Provides access to the lines of a LinePatternRenderable.
+ */
+struct TestLinePattern : public LinePatternRenderable
+{
+	using LinePatternRenderable::LinePatternRenderable;
+	using LinePatternRenderable::path;
+};
+
+
 }  // namespace
 
 
@@ -297,6 +312,75 @@ private slots:
 	}
 	
 	
+	void linePatternClipToTest()
+	{
+		// A square with a hole
+		QPainterPath area;
+		area.addRect(0, 0, 10, 10);
+		area.addRect(4, 4, 2, 2);
+		
+		TestLinePattern lines(nullptr, 0.1, 4, false);
+		for (auto y : { 1.0, 5.0, 9.0, 20.0 })
+			lines.addLine({-5, y}, {15, y});
+		lines.clipTo(area);
+		
+		QCOMPARE(lines.path.elementCount(), 8);
+		QCOMPARE(lines.getExtent(), QRectF(0, 1, 10, 8));
+		QCOMPARE(QPointF(lines.path.elementAt(2)), QPointF(0, 5));
+		QCOMPARE(QPointF(lines.path.elementAt(3)), QPointF(4, 5));
+		QCOMPARE(QPointF(lines.path.elementAt(4)), QPointF(6, 5));
+		QCOMPARE(QPointF(lines.path.elementAt(5)), QPointF(10, 5));
+		
+		TestLinePattern outside(nullptr, 0.1, 4, false);
+		outside.addLine({-5, 20}, {15, 20});
+		outside.clipTo(area);
+		QVERIFY(outside.isEmpty());
+	}
+	
+	void geometricPatternClippingTest()
+	{
+		Map map;
+		QVERIFY(map.loadFrom(QStringLiteral("testdata:symbols/area-symbol-line-pattern.omap")));
+		
+		const auto pixel_per_mm = 20;
+		const auto extent = map.calculateExtent().toAlignedRect().adjusted(-1, -1, +1, +1);
+		auto const render = [&map, &extent, pixel_per_mm]() {
+			auto image = QImage{pixel_per_mm * extent.size(), QImage::Format_ARGB32_Premultiplied};
+			image.fill(QColor(Qt::white));
+			QPainter painter{&image};
+			painter.setRenderHint(QPainter::Antialiasing, false);
+			painter.scale(pixel_per_mm, pixel_per_mm);
+			painter.translate(-extent.topLeft());
+			painter.setClipRect(extent);
+			map.draw(&painter, RenderConfig{map, extent, pixel_per_mm, RenderConfig::DisableAntialiasing, 1});
+			return image;
+		};
+		
+		auto const expected_image = render();
+		map.setGeometricPatternClippingEnabled(true);
+		map.updateAllObjects();
+		auto const image = render();
+		QCOMPARE(image.size(), expected_image.size());
+		
+		// Line ends at the boundary may differ slightly.
+		auto non_white = 0;
+		auto different = 0;
+		for (auto y = 0; y < image.height(); ++y)
+		{
+			for (auto x = 0; x < image.width(); ++x)
+			{
+				auto const expected = expected_image.pixel(x, y);
+				if (expected != qRgb(255, 255, 255))
+					++non_white;
+				if (image.pixel(x, y) != expected)
+					++different;
+			}
+		}
+		QVERIFY(non_white > 0);
+		QVERIFY(different * 20 < non_white);
+	}
+	
+	
 	void invariantTest_data()
 	{
 		QTest::addColumn<QString>("map_filename");
@@ -323,6 +407,37 @@ private slots:
 			
 		}
 	}
+	
+	
+	void iconCacheTest()
+	{
+		QStandardPaths::setTestModeEnabled(true);
+		QDir(SymbolIconCache::directory()).removeRecursively();
+		
+		Map map {};
+		QVERIFY(map.loadFrom(QString::fromUtf8(*example_files.begin())));
+		QVERIFY(map.getNumSymbols() > 0);
+		
+		const auto side_length = 32;
+		map.prepareSymbolIcons(side_length, false);
+		for (int i = 0; i < map.getNumSymbols(); ++i)
+			QVERIFY(map.getSymbol(i)->hasIcon());
+		
+		const auto* symbol = map.getSymbol(0);
+		const auto zoom = map.symbolIconZoom();
+		const auto key = SymbolIconCache::key(*symbol, map, side_length, zoom);
+		QCOMPARE(SymbolIconCache::key(*symbol, map, side_length, zoom), key);
+		QVERIFY(SymbolIconCache::key(*symbol, map, side_length + 1, zoom) != key);
+		QVERIFY(SymbolIconCache::key(*symbol, map, side_length, 2 * zoom) != key);
+		QVERIFY(SymbolIconCache::key(*map.getSymbol(1), map, side_length, zoom) != key);
+		
+		auto const cached = SymbolIconCache::load(key);
+		QCOMPARE(cached.size(), QSize(side_length, side_length));
+		QCOMPARE(cached, symbol->createIcon(map, side_length, true, zoom));
+		
+		QDir(SymbolIconCache::directory()).removeRecursively();
+		QVERIFY(SymbolIconCache::load(key).isNull());
+	}
 };
 
 
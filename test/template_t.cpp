@@ -18,24 +18,52 @@
  */
 
 
+#include <cstddef>
+
+#include <Qt>
 #include <QtGlobal>
 #include <QtMath>
 #include <QtTest>
+#include <QColor>
 #include <QDir>
+#include <QFile>
 #include <QFileInfo>
+#include <QImage>
+#include <QIODevice>
+#include <QLatin1String>
 #include <QObject>
+#include <QRect>
+#include <QSize>
 #include <QString>
+#include <QTemporaryDir>
+#include <QTextStream>
 #include <QTransform>
 
+#ifdef MAPPER_USE_GDAL
+#  include <gdal.h>
+#  include <ogr_api.h>
+#endif
+
 #include "test_config.h"
 
 #include "global.h"
 #include "core/georeferencing.h"
+#include "core/latlon.h"
 #include "core/map.h"
+#include "core/map_coord.h"
+#include "core/map_part.h"
 #include "core/map_view.h"
+#include "core/objects/object.h"
 #include "fileformats/xml_file_format_p.h"
+#include "gdal/gdal_contours.h"
+#include "gdal/gdal_image_reader.h"
+#include "gdal/gdal_image_writer.h"
+#include "gdal/gdal_warped_raster.h"
 #include "gdal/ogr_template.h"
 #include "templates/template.h"
+#include "templates/template_image.h"
+#include "templates/template_sketch.h"
+#include "templates/template_web_tiles.h"
 #include "templates/world_file.h"
 
 using namespace OpenOrienteering;
@@ -203,6 +231,77 @@ private slots:
 #endif
 	}
 	
+	void sketchTemplateTest()
+	{
+		QTemporaryDir dir;
+		QVERIFY(dir.isValid());
+		auto const path = dir.filePath(QStringLiteral("test.sketch"));
+		QVERIFY(TemplateSketch::createFile(path));
+		
+		Map map;
+		auto temp = Template::templateForPath(path, &map);
+		QVERIFY(temp);
+		QCOMPARE(temp->getTemplateType(), "TemplateSketch");
+		QVERIFY(temp->loadTemplateFile(false));
+		auto* sketch = static_cast<TemplateSketch*>(temp.get());
+		QCOMPARE(sketch->strokeCount(), std::size_t(0));
+		QVERIFY(sketch->canBeDrawnOnto());
+		
+		MapCoordF stroke[] = { { 0.0, 0.0 }, { 1.0, 0.0 }, { 3.0, 0.0 }, { 7.0, 0.0 }, { 9.0, 0.0 }, { 10.0, 0.0 } };
+		sketch->drawOntoTemplate(stroke, 6, Qt::red, 1, {});
+		QCOMPARE(sketch->strokeCount(), std::size_t(1));
+		
+		// Erasing across the middle of the stroke leaves two pieces.
+		MapCoordF eraser[] = { { 5.0, -5.0 }, { 5.0, 5.0 } };
+		sketch->drawOntoTemplate(eraser, 2, QColor(255, 255, 255, 0), 1, {});
+		QCOMPARE(sketch->strokeCount(), std::size_t(2));
+		
+		sketch->drawOntoTemplateUndo(false);
+		QCOMPARE(sketch->strokeCount(), std::size_t(1));
+		sketch->drawOntoTemplateUndo(true);
+		QCOMPARE(sketch->strokeCount(), std::size_t(2));
+		
+		QVERIFY(sketch->saveTemplateFile());
+		sketch->unloadTemplateFile();
+		QVERIFY(sketch->loadTemplateFile(false));
+		QCOMPARE(sketch->strokeCount(), std::size_t(2));
+		QVERIFY(sketch->getTemplateExtent().contains(QPointF(1.0, 0.0)));
+	}
+	
+	void webTilesTemplateTest()
+	{
+		auto const xyz = QStringLiteral("https://tile.example.org/{z}/{x}/{y}.png");
+		QCOMPARE(TemplateWebTiles::tileUrl(xyz, 3, 4, 2), QStringLiteral("https://tile.example.org/3/4/2.png"));
+		auto const tms = QStringLiteral("https://tile.example.org/{z}/{x}/{-y}.png");
+		QCOMPARE(TemplateWebTiles::tileUrl(tms, 3, 4, 2), QStringLiteral("https://tile.example.org/3/4/5.png"));
+		auto const wmts = QStringLiteral("https://wmts.example.org/{TileMatrix}/{TileRow}/{TileCol}.jpg");
+		QCOMPARE(TemplateWebTiles::tileUrl(wmts, 3, 4, 2), QStringLiteral("https://wmts.example.org/3/2/4.jpg"));
+		
+		QTemporaryDir dir;
+		QVERIFY(dir.isValid());
+		auto const path = dir.filePath(QStringLiteral("test.tiles"));
+		QVERIFY(TemplateWebTiles::createFile(path, xyz, 2, 17));
+		
+		Map map;
+		auto temp = Template::templateForPath(path, &map);
+		QVERIFY(temp);
+		QCOMPARE(temp->getTemplateType(), "TemplateWebTiles");
+		QVERIFY(temp->isTemplateGeoreferenced());
+		
+		// Tiles need a map with a projected CRS.
+		QVERIFY(map.getGeoreferencing().isLocal());
+		QVERIFY(!temp->loadTemplateFile(false));
+		
+		Georeferencing georef;
+		QVERIFY(georef.setProjectedCRS(QStringLiteral("UTM"), QStringLiteral("+proj=utm +zone=32 +datum=WGS84")));
+		georef.setGeographicRefPoint(LatLon(50.0, 8.0));
+		map.setGeoreferencing(georef);
+		QVERIFY(!map.getGeoreferencing().isLocal());
+		QVERIFY(temp->loadTemplateFile(false));
+		auto* tiles = static_cast<TemplateWebTiles*>(temp.get());
+		QCOMPARE(tiles->urlPattern(), xyz);
+	}
+	
 #ifdef MAPPER_USE_GDAL
 	void ogrTemplateGeoreferencingTest()
 	{
@@ -214,6 +313,173 @@ private slots:
 		QCOMPARE(qRound(latlon.latitude()), 50);
 		QCOMPARE(qRound(latlon.longitude()), 8);
 	}
+	
+	void ogrTemplateUpdateTest()
+	{
+		QTemporaryDir dir;
+		QVERIFY(dir.isValid());
+		auto const path = dir.filePath(QStringLiteral("features.geojson"));
+		auto const write_features = [&path](const QByteArray& features) {
+			QFile file(path);
+			return file.open(QIODevice::WriteOnly | QIODevice::Truncate)
+			       && file.write("{\"type\":\"FeatureCollection\",\"features\":[" + features + "]}") > 0;
+		};
+		auto const point = [](int id, const char* name, const char* coordinates) {
+			return QByteArray("{\"type\":\"Feature\",\"id\":") + QByteArray::number(id)
+			       + ",\"properties\":{\"name\":\"" + name + "\"},"
+			       + "\"geometry\":{\"type\":\"Point\",\"coordinates\":[" + coordinates + "]}}";
+		};
+		
+		QVERIFY(write_features(point(1, "a", "8.000,50.0") + ',' + point(2, "b", "8.001,50.0") + ',' + point(3, "c", "8.002,50.0")));
+		
+		Map map;
+		Georeferencing georef;
+		QVERIFY(georef.setProjectedCRS(QStringLiteral("UTM"), QStringLiteral("+proj=utm +zone=32 +datum=WGS84")));
+		georef.setGeographicRefPoint(LatLon(50.0, 8.0));
+		map.setGeoreferencing(georef);
+		
+		auto temp = Template::templateForPath(path, &map);
+		QVERIFY(temp);
+		QCOMPARE(temp->getTemplateType(), "OgrTemplate");
+		QVERIFY(temp->loadTemplateFile(false));
+		auto* ogr_template = static_cast<OgrTemplate*>(temp.get());
+		auto const* template_map = ogr_template->templateMap();
+		QCOMPARE(template_map->getNumObjects(), 3);
+		auto const* unchanged = template_map->getPart(0)->getObject(0);
+		QCOMPARE(unchanged->getTag(QStringLiteral("name")), QStringLiteral("a"));
+		
+		// Change feature 2, remove feature 3, add feature 4
+		QVERIFY(write_features(point(1, "a", "8.000,50.0") + ',' + point(2, "b", "8.001,50.001") + ',' + point(4, "d", "8.003,50.0")));
+		ogr_template->updateChangedFeatures();
+		QCOMPARE(ogr_template->getTemplateState(), Template::Loaded);
+		QCOMPARE(template_map->getNumObjects(), 3);
+		auto const* part = template_map->getPart(0);
+		QCOMPARE(part->getObject(0), unchanged);
+		QCOMPARE(part->getObject(1)->getTag(QStringLiteral("name")), QStringLiteral("b"));
+		QCOMPARE(part->getObject(2)->getTag(QStringLiteral("name")), QStringLiteral("d"));
+		QVERIFY(part->getObject(1)->getExtent().center().y() < unchanged->getExtent().center().y());
+	}
+	
+	void gdalWarpedRasterTest()
+	{
+		QTemporaryDir dir;
+		QVERIFY(dir.isValid());
+		
+		// A raster in geographic coordinates
+		auto const path = dir.filePath(QStringLiteral("geographic.tif"));
+		{
+			QImage image(64, 64, QImage::Format_RGB32);
+			image.fill(Qt::green);
+			GdalImageWriter writer(path);
+			QVERIFY(writer.open(image.size(), 0));
+			QVERIFY(writer.setGeoreferencing(QTransform(0.001, 0, 0, -0.001, 8.0, 50.0), QStringLiteral("+proj=longlat +datum=WGS84")));
+			QVERIFY(writer.write(image, 0));
+			QVERIFY2(writer.finish(), qPrintable(writer.errorString()));
+		}
+		
+		auto const utm32_spec = QStringLiteral("+proj=utm +zone=32 +datum=WGS84");
+		QVERIFY(GdalWarpedRaster::needsWarping(path, utm32_spec));
+		QVERIFY(!GdalWarpedRaster::needsWarping(path, QStringLiteral("+proj=longlat +datum=WGS84")));
+		
+		GdalWarpedRaster warped(path, utm32_spec);
+		QVERIFY2(warped.isValid(), qPrintable(warped.errorString()));
+		
+		// The warped raster is in the target CRS, with pixels of roughly 100 m.
+		GdalImageReader reader(warped.path());
+		QVERIFY(reader.canRead());
+		auto const georef = reader.readGeoTransform();
+		QVERIFY(georef.crs_spec.contains(QLatin1String("+proj=utm")));
+		QVERIFY(georef.transform.pixel_to_world.m11() > 50);
+		QVERIFY(georef.transform.pixel_to_world.m11() < 150);
+		
+		auto const raster = reader.readRasterInfo();
+		QImage tile(16, 16, raster.image_format);
+		QVERIFY(reader.read(&tile, raster, QRect(8, 8, 16, 16)));
+		QCOMPARE(QColor(tile.pixel(8, 8)).green(), 255);
+	}
+	
+	void gdalDocumentTest()
+	{
+		auto const pdf_driver = GDALGetDriverByName("PDF");
+		if (!pdf_driver || !GDALGetMetadataItem(pdf_driver, GDAL_DCAP_CREATECOPY, nullptr))
+			QSKIP("GDAL cannot create PDF files");
+		
+		QTemporaryDir dir;
+		QVERIFY(dir.isValid());
+		auto const tiff_path = dir.filePath(QStringLiteral("page.tif"));
+		{
+			QImage image(72, 144, QImage::Format_RGB32);
+			image.fill(Qt::blue);
+			GdalImageWriter writer(tiff_path);
+			QVERIFY(writer.open(image.size(), 0));
+			QVERIFY(writer.write(image, 0));
+			QVERIFY2(writer.finish(), qPrintable(writer.errorString()));
+		}
+		
+		// A page of 1 x 2 inch
+		auto const pdf_path = dir.filePath(QStringLiteral("page.pdf"));
+		{
+			auto source = GDALOpen(tiff_path.toUtf8(), GA_ReadOnly);
+			QVERIFY(source);
+			const char* const options[] = { "DPI=72", nullptr };
+			auto pdf = GDALCreateCopy(pdf_driver, pdf_path.toUtf8(), source, FALSE, const_cast<char**>(options), nullptr, nullptr);
+			GDALClose(source);
+			QVERIFY(pdf);
+			GDALClose(pdf);
+		}
+		
+		// The document is rasterized at the requested resolution.
+		GdalImageReader reader_72(pdf_path, 72);
+		QVERIFY(reader_72.canRead());
+		QCOMPARE(reader_72.readRasterInfo().size, QSize(72, 144));
+		GdalImageReader reader_144(pdf_path, 144);
+		QVERIFY(reader_144.canRead());
+		QCOMPARE(reader_144.readRasterInfo().size, QSize(144, 288));
+		
+		Map map;
+		auto temp = Template::templateForPath(pdf_path, &map);
+		QVERIFY(temp);
+		QCOMPARE(temp->getTemplateType(), "GdalTemplate");
+		QVERIFY(temp->loadTemplateFile(false));
+		auto* document = static_cast<TemplateImage*>(temp.get());
+		QVERIFY(document->imageDpi() > 72);
+		QCOMPARE(document->imageSize().height(), 2 * document->imageSize().width());
+	}
+	
+	void gdalContoursTest()
+	{
+		QTemporaryDir dir;
+		QVERIFY(dir.isValid());
+		
+		// A slope across two tiles, rising by 1 per pixel from left to right
+		auto const dem_path = dir.filePath(QStringLiteral("dem.asc"));
+		{
+			QFile dem(dem_path);
+			QVERIFY(dem.open(QIODevice::WriteOnly | QIODevice::Text));
+			QTextStream out(&dem);
+			auto const width = GdalContourGenerator::tile_size + 76;
+			out << "ncols " << width << "\nnrows 3\nxllcorner 0\nyllcorner 0\ncellsize 1\n";
+			for (int y = 0; y < 3; ++y)
+			{
+				for (int x = 0; x < width; ++x)
+					out << x + 0.5 << ' ';
+				out << '\n';
+			}
+		}
+		
+		auto const contours_path = dir.filePath(QStringLiteral("contours.gpkg"));
+		GdalContourGenerator generator(dem_path);
+		generator.setInterval(10);
+		QVERIFY2(generator.generate(contours_path), qPrintable(generator.errorString()));
+		
+		// One line for each level from 10 to 1090, and none at the tile boundary
+		auto data_source = GDALOpenEx(contours_path.toUtf8(), GDAL_OF_VECTOR, nullptr, nullptr, nullptr);
+		QVERIFY(data_source);
+		auto layer = GDALDatasetGetLayer(data_source, 0);
+		QVERIFY(layer);
+		QCOMPARE(OGR_L_GetFeatureCount(layer, 1), GIntBig(109));
+		GDALClose(data_source);
+	}
 #endif
 };
 
@@ -0,0 +1,497 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "tools_benchmark_t.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+#include <Qt>
+#include <QtGlobal>
+#include <QtTest>
+#include <QApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QEvent>
+#include <QKeyEvent>
+#include <QLatin1String>
+#include <QLineF>
+#include <QMouseEvent>
+#include <QPoint>
+#include <QPointF>
+#include <QRectF>
+#include <QSize>
+#include <QSizeF>
+#include <QString>
+
+#include "test_config.h"
+
+#include "global.h"
+#include "core/map.h"
+#include "core/map_coord.h"
+#include "core/map_generator.h"
+#include "core/map_part.h"
+#include "core/map_view.h"
+#include "core/objects/object.h"
+#include "core/symbols/symbol.h"
+#include "gui/main_window.h"
+#include "gui/map/map_editor.h"
+#include "gui/map/map_widget.h"
+#include "gui/widgets/symbol_widget.h"
+#include "tools/cut_tool.h"
+#include "tools/draw_path_tool.h"
+#include "tools/edit_point_tool.h"
+#include "tools/object_selector.h"
+#include "tools/tool.h"
+
+using namespace OpenOrienteering;
+
+
+namespace
+{
+	QDir symbol_set_dir;  // clazy:exclude=non-pod-global-static
+	
+	const auto symbol_set = QLatin1String("15000/ISOM 2017-2_15000.omap");
+	
+	/// The size of the map widget.
+	const QSize viewport_size{ 1280, 800 };
+	
+	/// The number of events in each sequence.
+	constexpr int num_events = 500;
+	
+	
+	/**
+	 * Measures the latency of single events, and reports percentiles.
+	 */
+	class LatencyRecorder
+	{
+	public:
+		LatencyRecorder()
+		{
+			latencies.reserve(num_events);
+		}
+		
+		template <class Function>
+		void measure(Function&& function)
+		{
+			QElapsedTimer timer;
+			timer.start();
+			function();
+			latencies.push_back(timer.nsecsElapsed());
+		}
+		
+		/**
+		 * Prints the percentiles, and sets the median as benchmark result.
+		 */
+		void report()
+		{
+			QVERIFY(!latencies.empty());
+			std::sort(begin(latencies), end(latencies));
+			
+			// Nearest-rank percentiles, in milliseconds
+			auto const percentile = [this](std::size_t p) {
+				auto const rank = std::max(std::size_t(1), (latencies.size() * p + 99) / 100);
+				return latencies[rank - 1] / 1000000.0;
+			};
+			qInfo("%s: %d events, p50 %.3f ms, p90 %.3f ms, p99 %.3f ms, max %.3f ms",
+			      QTest::currentDataTag(), int(latencies.size()),
+			      percentile(50), percentile(90), percentile(99), percentile(100));
+			QTest::setBenchmarkResult(percentile(50), QTest::WalltimeMilliseconds);
+		}
+		
+	private:
+		std::vector<qint64> latencies;
+	};
+	
+	
+	/**
+	 * A map editor for a generated map.
+	 * 
+	 * The view is centered on the generated objects.
+	 */
+	struct BenchmarkEditor
+	{
+		Map* map;  ///< Owned by the editor
+		MainWindow* window;
+		MapEditorController* editor;
+		MapWidget* map_widget;
+		bool valid;
+		
+		explicit BenchmarkEditor(int num_objects);
+		BenchmarkEditor(const BenchmarkEditor&) = delete;
+		BenchmarkEditor& operator=(const BenchmarkEditor&) = delete;
+		~BenchmarkEditor();
+		
+		/** Returns the area of the map widget. */
+		QRectF viewport() const { return { QPointF{}, QSizeF(viewport_size) }; }
+		
+		/** Selects all objects in the viewport. */
+		void selectVisibleObjects();
+		
+		/** Returns the path object of the given symbol type which is closest to the viewport center. */
+		PathObject* findCentralPath(Symbol::Type type) const;
+		
+		/** Makes the given symbol the active symbol. */
+		void setActiveSymbol(const Symbol* symbol);
+		
+		void mousePress(const QPointF& pos);
+		void mouseMove(const QPointF& pos, Qt::MouseButtons buttons);
+		void mouseRelease(const QPointF& pos);
+		void key(QEvent::Type type, int key, Qt::KeyboardModifiers modifiers);
+	};
+	
+	
+	BenchmarkEditor::BenchmarkEditor(int num_objects)
+	: map(new Map())
+	{
+		valid = map->loadFrom(symbol_set_dir.absoluteFilePath(symbol_set))
+		        && MapGenerator(MapGenerator::mixedOptions(num_objects)).generate(*map);
+		map->updateObjects();
+		
+		window = new MainWindow();
+		editor = new MapEditorController(MapEditorController::MapEditor, map);
+		window->setController(editor);
+		map_widget = editor->getMainWidget();
+		map_widget->resize(viewport_size);
+		map_widget->getMapView()->setZoom(1);
+		map_widget->getMapView()->setCenter(MapCoord(map->calculateExtent().center()));
+	}
+	
+	BenchmarkEditor::~BenchmarkEditor()
+	{
+		editor->setTool(nullptr);
+		// The window may still be referred to by tools which are scheduled for
+		// deleteLater(), so we need to postpone the window deletion, too.
+		window->deleteLater();
+	}
+	
+	void BenchmarkEditor::selectVisibleObjects()
+	{
+		auto const area = viewport();
+		ObjectSelector(map).selectBox(map_widget->viewportToMapF(area.topLeft()), map_widget->viewportToMapF(area.bottomRight()), false);
+	}
+	
+	PathObject* BenchmarkEditor::findCentralPath(Symbol::Type type) const
+	{
+		auto const center = QPointF(map_widget->viewportToMapF(viewport().center()));
+		auto best_distance = std::numeric_limits<qreal>::max();
+		PathObject* best = nullptr;
+		auto* part = map->getCurrentPart();
+		for (int i = 0; i < part->getNumObjects(); ++i)
+		{
+			auto* object = part->getObject(i);
+			if (object->getType() != Object::Path || object->getSymbol()->getType() != type)
+				continue;
+			auto const distance = QLineF(object->getExtent().center(), center).length();
+			if (distance < best_distance)
+			{
+				best_distance = distance;
+				best = object->asPath();
+			}
+		}
+		return best;
+	}
+	
+	void BenchmarkEditor::setActiveSymbol(const Symbol* symbol)
+	{
+		editor->getSymbolWidget()->selectSingleSymbol(symbol);
+	}
+	
+	void BenchmarkEditor::mousePress(const QPointF& pos)
+	{
+		QTest::mousePress(map_widget, Qt::LeftButton, nullptr, pos.toPoint());
+	}
+	
+	void BenchmarkEditor::mouseMove(const QPointF& pos, Qt::MouseButtons buttons)
+	{
+		// QTest::mouseMove() tries to set the real cursor position.
+		// Like in tools_t, the event is sent directly instead.
+		auto const point = pos.toPoint();
+		QMouseEvent event(QEvent::MouseMove, point, map_widget->mapToGlobal(point), Qt::NoButton, buttons, Qt::NoModifier);
+		QApplication::sendEvent(map_widget, &event);
+	}
+	
+	void BenchmarkEditor::mouseRelease(const QPointF& pos)
+	{
+		QTest::mouseRelease(map_widget, Qt::LeftButton, nullptr, pos.toPoint());
+	}
+	
+	void BenchmarkEditor::key(QEvent::Type type, int key, Qt::KeyboardModifiers modifiers)
+	{
+		QKeyEvent event(type, key, modifiers);
+		if (type == QEvent::KeyPress)
+			editor->getTool()->keyPressEvent(&event);
+		else
+			editor->getTool()->keyReleaseEvent(&event);
+	}
+	
+	
+	/**
+	 * Returns mouse positions which sweep the given area in rows.
+	 */
+	std::vector<QPointF> sweep(const QRectF& area)
+	{
+		constexpr int rows = 10;
+		constexpr int columns = num_events / rows;
+		std::vector<QPointF> positions;
+		positions.reserve(num_events);
+		for (int i = 0; i < num_events; ++i)
+		{
+			auto const row = i / columns;
+			auto const column = (row % 2) ? (columns - 1 - i % columns) : (i % columns);
+			positions.emplace_back(area.left() + area.width() * column / (columns - 1),
+			                       area.top() + area.height() * (row + 0.5) / rows);
+		}
+		return positions;
+	}
+	
+	/**
+	 * Returns mouse positions which trace the coordinates of the given path.
+	 */
+	std::vector<QPointF> trace(const PathObject& path, const MapWidget& map_widget)
+	{
+		std::vector<QPointF> positions;
+		auto const num_segments = path.getCoordinateCount() - 1;
+		if (num_segments < 1)
+			return positions;
+		
+		positions.reserve(num_events);
+		for (int i = 0; i < num_events; ++i)
+		{
+			auto const t = qreal(i) * num_segments / num_events;
+			auto const segment = int(t);
+			auto const start = map_widget.mapToViewport(path.getCoordinate(segment));
+			auto const end = map_widget.mapToViewport(path.getCoordinate(segment + 1));
+			positions.push_back(start + (end - start) * (t - segment));
+		}
+		return positions;
+	}
+	
+}  // namespace
+
+
+
+void ToolsBenchmarkTest::initTestCase()
+{
+	Q_INIT_RESOURCE(resources);
+	
+	doStaticInitializations();
+	
+	symbol_set_dir.cd(QDir(QString::fromUtf8(MAPPER_TEST_SOURCE_DIR)).absoluteFilePath(QStringLiteral("../symbol sets")));
+	QVERIFY(symbol_set_dir.exists());
+}
+
+
+void ToolsBenchmarkTest::maps_data()
+{
+	QTest::addColumn<int>("num_objects");
+	
+	for (auto num_objects : { 1000, 10000, 50000 })
+	{
+		QTest::newRow(QStringLiteral("%1 objects").arg(num_objects).toUtf8()) << num_objects;
+	}
+}
+
+
+
+void ToolsBenchmarkTest::editPointToolHover_data()
+{
+	maps_data();
+}
+
+void ToolsBenchmarkTest::editPointToolHover()
+{
+	QFETCH(int, num_objects);
+	BenchmarkEditor editor(num_objects);
+	QVERIFY(editor.valid);
+	
+	editor.selectVisibleObjects();
+	QVERIFY(!editor.map->selectedObjects().empty());
+	editor.editor->setTool(new EditPointTool(editor.editor, nullptr));
+	
+	LatencyRecorder recorder;
+	for (auto const& pos : sweep(editor.viewport()))
+		recorder.measure([&]() { editor.mouseMove(pos, Qt::NoButton); });
+	recorder.report();
+}
+
+
+void ToolsBenchmarkTest::drawPathToolSnapping_data()
+{
+	maps_data();
+}
+
+void ToolsBenchmarkTest::drawPathToolSnapping()
+{
+	QFETCH(int, num_objects);
+	BenchmarkEditor editor(num_objects);
+	QVERIFY(editor.valid);
+	
+	auto const* line = editor.findCentralPath(Symbol::Line);
+	QVERIFY(line);
+	editor.setActiveSymbol(line->getSymbol());
+	QCOMPARE(editor.editor->activeSymbol(), line->getSymbol());
+	editor.editor->setTool(new DrawPathTool(editor.editor, nullptr, false, true));
+	
+	// Start a path, so that hovering snaps the next point.
+	editor.mousePress(editor.viewport().topLeft() + QPointF(5, 5));
+	editor.mouseRelease(editor.viewport().topLeft() + QPointF(5, 5));
+	editor.key(QEvent::KeyPress, Qt::Key_Shift, Qt::ShiftModifier);
+	
+	LatencyRecorder recorder;
+	for (auto const& pos : sweep(editor.viewport()))
+		recorder.measure([&]() { editor.mouseMove(pos, Qt::NoButton); });
+	recorder.report();
+	
+	editor.key(QEvent::KeyRelease, Qt::Key_Shift, Qt::NoModifier);
+	editor.key(QEvent::KeyPress, Qt::Key_Escape, Qt::NoModifier);
+}
+
+
+void ToolsBenchmarkTest::drawPathToolFollowing_data()
+{
+	maps_data();
+}
+
+void ToolsBenchmarkTest::drawPathToolFollowing()
+{
+	QFETCH(int, num_objects);
+	BenchmarkEditor editor(num_objects);
+	QVERIFY(editor.valid);
+	
+	auto const* line = editor.findCentralPath(Symbol::Line);
+	QVERIFY(line);
+	auto const positions = trace(*line, *editor.map_widget);
+	QVERIFY(!positions.empty());
+	editor.setActiveSymbol(line->getSymbol());
+	editor.editor->setTool(new DrawPathTool(editor.editor, nullptr, false, true));
+	
+	// Start a path, then start following the line with a shift-press on it.
+	editor.mousePress(positions.front() + QPointF(-30, -30));
+	editor.mouseRelease(positions.front() + QPointF(-30, -30));
+	editor.key(QEvent::KeyPress, Qt::Key_Shift, Qt::ShiftModifier);
+	editor.mousePress(positions.front());
+	editor.key(QEvent::KeyRelease, Qt::Key_Shift, Qt::NoModifier);
+	
+	LatencyRecorder recorder;
+	for (auto const& pos : positions)
+		recorder.measure([&]() { editor.mouseMove(pos, Qt::LeftButton); });
+	recorder.report();
+	
+	editor.mouseRelease(positions.back());
+	editor.key(QEvent::KeyPress, Qt::Key_Escape, Qt::NoModifier);
+}
+
+
+void ToolsBenchmarkTest::cutToolHover_data()
+{
+	maps_data();
+}
+
+void ToolsBenchmarkTest::cutToolHover()
+{
+	QFETCH(int, num_objects);
+	BenchmarkEditor editor(num_objects);
+	QVERIFY(editor.valid);
+	
+	editor.selectVisibleObjects();
+	QVERIFY(!editor.map->selectedObjects().empty());
+	editor.editor->setTool(new CutTool(editor.editor, nullptr));
+	
+	LatencyRecorder recorder;
+	for (auto const& pos : sweep(editor.viewport()))
+		recorder.measure([&]() { editor.mouseMove(pos, Qt::NoButton); });
+	recorder.report();
+}
+
+
+void ToolsBenchmarkTest::cutToolDrag_data()
+{
+	maps_data();
+}
+
+void ToolsBenchmarkTest::cutToolDrag()
+{
+	QFETCH(int, num_objects);
+	BenchmarkEditor editor(num_objects);
+	QVERIFY(editor.valid);
+	
+	auto* line = editor.findCentralPath(Symbol::Line);
+	QVERIFY(line);
+	auto const positions = trace(*line, *editor.map_widget);
+	QVERIFY(!positions.empty());
+	editor.selectVisibleObjects();
+	QVERIFY(editor.map->isObjectSelected(line));
+	editor.editor->setTool(new CutTool(editor.editor, nullptr));
+	
+	editor.mousePress(positions.front());
+	LatencyRecorder recorder;
+	for (auto const& pos : positions)
+		recorder.measure([&]() { editor.mouseMove(pos, Qt::LeftButton); });
+	recorder.report();
+	editor.mouseRelease(positions.back());
+}
+
+
+void ToolsBenchmarkTest::objectSelectorBox_data()
+{
+	maps_data();
+}
+
+void ToolsBenchmarkTest::objectSelectorBox()
+{
+	QFETCH(int, num_objects);
+	BenchmarkEditor editor(num_objects);
+	QVERIFY(editor.valid);
+	
+	editor.editor->setTool(new EditPointTool(editor.editor, nullptr));
+	
+	// The box grows from the center to the full viewport.
+	ObjectSelector selector(editor.map);
+	auto const area = editor.viewport();
+	LatencyRecorder recorder;
+	for (int i = 1; i <= num_events; ++i)
+	{
+		auto box = QRectF(QPointF{}, area.size() * qreal(i) / num_events);
+		box.moveCenter(area.center());
+		recorder.measure([&]() {
+			selector.selectBox(editor.map_widget->viewportToMapF(box.topLeft()), editor.map_widget->viewportToMapF(box.bottomRight()), false);
+		});
+	}
+	recorder.report();
+	QVERIFY(!editor.map->selectedObjects().empty());
+}
+
+
+
+/*
+ * We select a non-standard QPA because we don't need a real GUI window.
+ * 
+ * Normally, the "offscreen" plugin would be the correct one.
+ * However, it bails out with a QFontDatabase error (cf. QTBUG-33674)
+ */
+namespace  {
+	auto Q_DECL_UNUSED qpa_selected = qputenv("QT_QPA_PLATFORM", "minimal");  // clazy:exclude=non-pod-global-static
+}
+
+
+QTEST_MAIN(ToolsBenchmarkTest)
@@ -0,0 +1,82 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef OPENORIENTEERING_TOOLS_BENCHMARK_T_H
+#define OPENORIENTEERING_TOOLS_BENCHMARK_T_H
+
+#include <QObject>
+
+
+namespace OpenOrienteering {
+
+
+/**
+ * @test Benchmarks the latency of editing tools on large maps.
+ * 
+ * Each benchmark sends a sequence of synthetic mouse events to a map editor
+ * for a generated map, measures the time needed to handle each single event,
+ * and reports the median and the upper percentiles of these latencies.
+ * The median is also reported as the benchmark result.
+ * 
+ * The latencies cover the event handling by the tool, but not the repainting
+ * of the map widget which is scheduled by the tool.
+ */
+class ToolsBenchmarkTest : public QObject
+{
+Q_OBJECT
+	
+private slots:
+	/** Initialization. */
+	void initTestCase();
+	
+	/** Moves the mouse over selected objects with the EditPointTool. */
+	void editPointToolHover();
+	void editPointToolHover_data();
+	
+	/** Moves the mouse with the DrawPathTool while snapping to objects. */
+	void drawPathToolSnapping();
+	void drawPathToolSnapping_data();
+	
+	/** Drags the mouse along an existing line with the DrawPathTool's follow mode. */
+	void drawPathToolFollowing();
+	void drawPathToolFollowing_data();
+	
+	/** Moves the mouse over selected objects with the CutTool. */
+	void cutToolHover();
+	void cutToolHover_data();
+	
+	/** Drags a cutting line along a selected line with the CutTool. */
+	void cutToolDrag();
+	void cutToolDrag_data();
+	
+	/** Applies growing selection boxes like a box selection drag does. */
+	void objectSelectorBox();
+	void objectSelectorBox_data();
+	
+private:
+	/** The number of objects in the generated maps. */
+	void maps_data();
+	
+};
+
+
+}  // namespace OpenOrienteering
+
+#endif
@@ -21,6 +21,9 @@
 
 #include "tools_t.h"
 
+#include <cstddef>
+#include <initializer_list>
+
 #include <Qt>
 #include <QtGlobal>
 #include <QtTest>
@@ -35,7 +38,9 @@
 #include "core/map_color.h"
 #include "core/map_coord.h"
 #include "core/objects/object.h"
+#include "core/objects/text_object.h"
 #include "core/symbols/line_symbol.h"
+#include "core/symbols/text_symbol.h"
 #include "global.h"
 #include "gui/main_window.h"
 #include "gui/map/map_editor.h"
@@ -198,6 +203,89 @@ void ToolsTest::editTool()
 	// Check position deviation
 	QPointF difference = map_widget->mapToViewport(object->getCoordinate(0)) - drag_end_pos;
 	QCOMPARE(qMax(qAbs(difference.x()), 0.1), 0.1);
+}
+
+
+void ToolsTest::textObjectLayout_data()
+{
+	QTest::addColumn<int>("position");
+	QTest::addColumn<int>("removed");
+	QTest::addColumn<QString>("inserted");
+	
+	QTest::newRow("append")          << -1 << 0 << QStringLiteral("x");
+	QTest::newRow("insert at start") <<  0 << 0 << QStringLiteral("x");
+	QTest::newRow("insert word")     << 60 << 0 << QStringLiteral("lorem ipsum ");
+	QTest::newRow("insert newline")  << 60 << 0 << QStringLiteral("\n");
+	QTest::newRow("insert tab")      << 60 << 0 << QStringLiteral("\t");
+	QTest::newRow("remove newline")  << 73 << 1 << QString{};
+	QTest::newRow("remove all")      <<  0 << -1 << QString{};
+}
+
+
+void ToolsTest::textObjectLayout()
+{
+	QFETCH(int, position);
+	QFETCH(int, removed);
+	QFETCH(QString, inserted);
+	
+	TextSymbol symbol;
+	
+	auto paragraph = QStringLiteral("Some words\tand a tab in a paragraph.\n");
+	QString text;
+	for (int i = 0; i < 20; ++i)
+		text += paragraph;
+	
+	for (auto h_align : { TextObject::AlignLeft, TextObject::AlignHCenter, TextObject::AlignRight })
+	{
+		for (auto word_wrap : { false, true })
+		{
+			auto setup = [&](TextObject& object) {
+				object.setHorizontalAlignment(h_align);
+				if (word_wrap)
+					object.setBox(0, 0, 20.0, 100.0);
+			};
+			
+			// Incremental relayout after editing
+			TextObject edited { &symbol };
+			setup(edited);
+			edited.setText(text);
+			edited.prepareLineInfos();
+			auto new_text = text;
+			if (position < 0)
+				new_text.append(inserted);
+			else
+				new_text.replace(position, removed < 0 ? new_text.length() : removed, inserted);
+			edited.setText(new_text);
+			edited.prepareLineInfos();
+			
+			// Full layout
+			TextObject fresh { &symbol };
+			setup(fresh);
+			fresh.setText(new_text);
+			fresh.prepareLineInfos();
+			
+			QCOMPARE(edited.getNumLines(), fresh.getNumLines());
+			for (int i = 0; i < fresh.getNumLines(); ++i)
+			{
+				auto const* actual = edited.getLineInfo(i);
+				auto const* expected = fresh.getLineInfo(i);
+				QCOMPARE(actual->start_index, expected->start_index);
+				QCOMPARE(actual->end_index, expected->end_index);
+				QCOMPARE(actual->paragraph_end, expected->paragraph_end);
+				QCOMPARE(actual->line_x, expected->line_x);
+				QCOMPARE(actual->line_y, expected->line_y);
+				QCOMPARE(actual->width, expected->width);
+				QCOMPARE(actual->part_infos.size(), expected->part_infos.size());
+				for (std::size_t j = 0; j < expected->part_infos.size(); ++j)
+				{
+					QCOMPARE(actual->part_infos[j].part_text, expected->part_infos[j].part_text);
+					QCOMPARE(actual->part_infos[j].start_index, expected->part_infos[j].start_index);
+					QCOMPARE(actual->part_infos[j].end_index, expected->part_infos[j].end_index);
+					QCOMPARE(actual->part_infos[j].part_x, expected->part_infos[j].part_x);
+				}
+			}
+		}
+	}
 	QCOMPARE(qMax(qAbs(difference.y()), 0.1), 0.1);
 	
 	// Cleanup
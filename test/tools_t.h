@@ -34,6 +34,9 @@ private slots:
 	void initTestCase();
 	
 	void editTool();
+	
+	void textObjectLayout_data();
+	void textObjectLayout();
 };
 
 #endif
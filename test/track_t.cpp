@@ -130,6 +130,47 @@ private slots:
 	}
 	
 	
+	void journalTest()
+	{
+		const auto track_path = QStringLiteral("journal-test.gpx");
+		QFile::remove(TrackJournal::pathFor(track_path));
+		
+		const auto tp0 = TrackPoint{ {50.0, 7.0}, base_datetime.addSecs(1), 100 };
+		const auto tp1 = TrackPoint{ {50.1, 7.0}, base_datetime.addSecs(2), NAN, 28 };
+		const auto tp2 = TrackPoint{ {50.1, 7.1} };
+		
+		auto expected_track = Track{};
+		expected_track.appendTrackPoint(tp0);
+		expected_track.appendTrackPoint(tp1);
+		expected_track.finishCurrentSegment();
+		expected_track.appendTrackPoint(tp2);
+		
+		{
+			TrackJournal journal(track_path);
+			QVERIFY(journal.finishCurrentSegment());
+			QVERIFY(journal.append(tp0));
+			QVERIFY(journal.append(tp1));
+			QVERIFY(journal.finishCurrentSegment());
+			QVERIFY(journal.append(tp2));
+		}
+		
+		// An incomplete line, as left by a crash while writing
+		{
+			QFile file(TrackJournal::pathFor(track_path));
+			QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Append));
+			file.write("p 50.2 7.");
+		}
+		
+		auto actual_track = Track{};
+		QCOMPARE(TrackJournal::recover(track_path, actual_track), 3);
+		QCOMPARE(actual_track, expected_track);
+		
+		TrackJournal(track_path).remove();
+		QVERIFY(!QFile::exists(TrackJournal::pathFor(track_path)));
+		QCOMPARE(TrackJournal::recover(track_path, actual_track), 0);
+	}
+	
+	
 };
 
 
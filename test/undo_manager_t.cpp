@@ -19,13 +19,23 @@
 
 #include "undo_manager_t.h"
 
+#include <memory>
+
 #include <QtTest>
+#include <QByteArray>
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
 
+#include "core/map.h"
+#include "core/map_coord.h"
+#include "core/map_part.h"
+#include "core/objects/object.h"
+#include "core/symbols/line_symbol.h"
+#include "core/symbols/symbol.h"
+#include "undo/object_undo.h"
 #include "undo/undo.h"
 #include "undo/undo_manager.h"
 
-namespace OpenOrienteering { class Map; }
-
 using namespace OpenOrienteering;
 
 
@@ -207,6 +217,238 @@ void UndoManagerTest::testUndoRedo()
 	QVERIFY(!undo_manager.canRedo());
 }
 
+void UndoManagerTest::testObjectCoordsUndoStep()
+{
+	Map map;
+	auto* symbol = new LineSymbol();
+	map.addSymbol(symbol, 0);
+	
+	auto* object = new PathObject(symbol);
+	for (int i = 0; i < 1000; ++i)
+		object->addCoordinate(MapCoord(i, i % 7));
+	map.addObject(object);
+	
+	std::unique_ptr<Object> original { object->duplicate() };
+	object->setCoordinate(500, MapCoord(500, 100));
+	object->deleteCoordinate(100, false);
+	auto const modified_coords = object->getRawCoordinateVector();
+	
+	auto undo_step = std::make_unique<ObjectCoordsUndoStep>(&map);
+	QVERIFY(undo_step->addObject(object, *original));
+	QVERIFY(!undo_step->addObject(object, *original));
+	map.push(undo_step.release());
+	
+	QVERIFY(map.undoManager().undo());
+	QVERIFY(object->getRawCoordinateVector() == original->getRawCoordinateVector());
+	QCOMPARE(object->parts().size(), std::size_t(1));
+	
+	QVERIFY(map.undoManager().redo());
+	QVERIFY(object->getRawCoordinateVector() == modified_coords);
+	
+	// Other properties cannot be restored by this step.
+	original->setTag(QStringLiteral("name"), QStringLiteral("value"));
+	auto tags_step = std::make_unique<ObjectCoordsUndoStep>(&map);
+	QVERIFY(!tags_step->addObject(object, *original));
+	QVERIFY(tags_step->isEmpty());
+}
+
+void UndoManagerTest::testDeferredSteps()
+{
+	Map map;
+	auto* symbol = new LineSymbol();
+	map.addSymbol(symbol, 0);
+	
+	for (int i = 0; i < 3; ++i)
+	{
+		auto* object = new PathObject(symbol);
+		object->addCoordinate(MapCoord(i, 0));
+		object->addCoordinate(MapCoord(i, 10));
+		map.addObject(object);
+		
+		auto* step = new DeleteObjectsUndoStep(&map);
+		step->addObject(map.getCurrentPart()->findObjectIndex(object));
+		map.push(step);
+	}
+	
+	auto& undo_manager = map.undoManager();
+	QVERIFY(undo_manager.undo());
+	QCOMPARE(map.getNumObjects(), 2);
+	QCOMPARE(undo_manager.undoStepCount(), 2);
+	QCOMPARE(undo_manager.redoStepCount(), 1);
+	
+	auto const save = [&undo_manager]() {
+		QByteArray data;
+		QXmlStreamWriter xml(&data);
+		xml.writeStartElement(QStringLiteral("history"));
+		undo_manager.saveUndo(xml);
+		undo_manager.saveRedo(xml);
+		xml.writeEndElement();
+		return data;
+	};
+	SymbolDictionary symbol_dict;
+	symbol_dict[0] = symbol;
+	auto const defer = [&undo_manager, &symbol_dict](const QByteArray& data) {
+		QXmlStreamReader xml(data);
+		QVERIFY(xml.readNextStartElement());
+		QVERIFY(xml.readNextStartElement());
+		undo_manager.deferUndo(xml, symbol_dict);
+		QVERIFY(xml.readNextStartElement());
+		undo_manager.deferRedo(xml, symbol_dict);
+	};
+	
+	defer(save());
+	QVERIFY(undo_manager.hasDeferredSteps());
+	QCOMPARE(undo_manager.undoStepCount(), 2);
+	QCOMPARE(undo_manager.redoStepCount(), 1);
+	QVERIFY(undo_manager.canUndo());
+	QVERIFY(undo_manager.canRedo());
+	QVERIFY(undo_manager.isLoaded());
+	
+	// Saving keeps the steps deferred.
+	defer(save());
+	QVERIFY(undo_manager.hasDeferredSteps());
+	QCOMPARE(undo_manager.undoStepCount(), 2);
+	QCOMPARE(undo_manager.redoStepCount(), 1);
+	
+	// The first redo loads the steps.
+	QVERIFY(undo_manager.redo());
+	QVERIFY(!undo_manager.hasDeferredSteps());
+	QCOMPARE(map.getNumObjects(), 3);
+	QCOMPARE(undo_manager.undoStepCount(), 3);
+	QCOMPARE(undo_manager.redoStepCount(), 0);
+	QVERIFY(!undo_manager.isLoaded());
+	
+	// New steps are pushed after the deferred undo steps,
+	// and they discard the deferred redo steps.
+	QVERIFY(undo_manager.undo());
+	defer(save());
+	auto* object = new PathObject(symbol);
+	object->addCoordinate(MapCoord(5, 0));
+	object->addCoordinate(MapCoord(5, 10));
+	map.addObject(object);
+	auto* step = new DeleteObjectsUndoStep(&map);
+	step->addObject(map.getCurrentPart()->findObjectIndex(object));
+	map.push(step);
+	QVERIFY(undo_manager.hasDeferredSteps());
+	QCOMPARE(undo_manager.undoStepCount(), 3);
+	QCOMPARE(undo_manager.redoStepCount(), 0);
+	QVERIFY(!undo_manager.canRedo());
+	
+	QVERIFY(undo_manager.undo());
+	QVERIFY(!undo_manager.hasDeferredSteps());
+	QCOMPARE(map.getNumObjects(), 2);
+	QCOMPARE(undo_manager.undoStepCount(), 2);
+	QCOMPARE(undo_manager.redoStepCount(), 1);
+	QVERIFY(undo_manager.isLoaded());
+	QCOMPARE(undo_manager.nextUndoStep()->getType(), UndoStep::DeleteObjectsUndoStepType);
+}
+
+void UndoManagerTest::testSpilledSteps()
+{
+	Map map;
+	auto* symbol = new LineSymbol();
+	map.addSymbol(symbol, 0);
+	
+	auto& undo_manager = map.undoManager();
+	undo_manager.setMemoryBudget(1);
+	undo_manager.setClean();
+	
+	for (int i = 0; i < 5; ++i)
+	{
+		auto* object = new PathObject(symbol);
+		object->addCoordinate(MapCoord(i, 0));
+		object->addCoordinate(MapCoord(i, 10));
+		map.addObject(object);
+		
+		auto* step = new DeleteObjectsUndoStep(&map);
+		step->addObject(map.getCurrentPart()->findObjectIndex(object));
+		map.push(step);
+	}
+	
+	// Only the latest step stays in memory.
+	QVERIFY(undo_manager.hasSpilledSteps());
+	QCOMPARE(undo_manager.undoStepCount(), 5);
+	QVERIFY(undo_manager.canUndo());
+	QVERIFY(!undo_manager.isClean());
+	
+	// The first undo doesn't need the spilled steps.
+	QVERIFY(undo_manager.undo());
+	QVERIFY(undo_manager.hasSpilledSteps());
+	QCOMPARE(map.getNumObjects(), 4);
+	
+	// Undoing further loads the spilled steps.
+	QVERIFY(undo_manager.undo());
+	QVERIFY(!undo_manager.hasSpilledSteps());
+	QCOMPARE(map.getNumObjects(), 3);
+	
+	while (undo_manager.canUndo())
+		QVERIFY(undo_manager.undo());
+	QCOMPARE(map.getNumObjects(), 0);
+	QVERIFY(undo_manager.isClean());
+	QCOMPARE(undo_manager.redoStepCount(), 5);
+	
+	for (int i = 0; i < 5; ++i)
+		QVERIFY(undo_manager.redo());
+	QCOMPARE(map.getNumObjects(), 5);
+	QVERIFY(!undo_manager.isClean());
+	QCOMPARE(map.getPart(0)->getObject(4)->getRawCoordinateVector().front(), MapCoord(4, 0));
+}
+
+void UndoManagerTest::testCoalescedSteps()
+{
+	Map map;
+	auto* symbol = new LineSymbol();
+	map.addSymbol(symbol, 0);
+	for (int i = 0; i < 2; ++i)
+	{
+		auto* object = new PathObject(symbol);
+		object->addCoordinate(MapCoord(i, 0));
+		object->addCoordinate(MapCoord(i, 10));
+		map.addObject(object);
+	}
+	auto* object = map.getPart(0)->getObject(0);
+	auto* other = map.getPart(0)->getObject(1);
+	
+	auto& undo_manager = map.undoManager();
+	auto const edit = [&map](Object* object, const QString& value, const QString& operation) {
+		auto* step = new ObjectTagsUndoStep(&map);
+		step->addObject(map.getPart(0)->findObjectIndex(object));
+		map.push(step, operation);
+		object->setTag(QStringLiteral("name"), value);
+	};
+	
+	// Steps are not coalesced across the clean state.
+	edit(object, QStringLiteral("a"), QStringLiteral("tags"));
+	undo_manager.setClean();
+	edit(object, QStringLiteral("b"), QStringLiteral("tags"));
+	QCOMPARE(undo_manager.undoStepCount(), 2);
+	edit(object, QStringLiteral("c"), QStringLiteral("tags"));
+	QCOMPARE(undo_manager.undoStepCount(), 2);
+	
+	// Another object or operation starts a new step.
+	edit(other, QStringLiteral("x"), QStringLiteral("tags"));
+	QCOMPARE(undo_manager.undoStepCount(), 3);
+	edit(other, QStringLiteral("y"), QString{});
+	QCOMPARE(undo_manager.undoStepCount(), 4);
+	edit(other, QStringLiteral("z"), QString{});
+	QCOMPARE(undo_manager.undoStepCount(), 5);
+	
+	QVERIFY(undo_manager.undo());
+	QVERIFY(undo_manager.undo());
+	QVERIFY(undo_manager.undo());
+	QVERIFY(other->getTag(QStringLiteral("name")).isEmpty());
+	
+	// Undo reverts the burst at once.
+	QCOMPARE(object->getTag(QStringLiteral("name")), QStringLiteral("c"));
+	QVERIFY(undo_manager.undo());
+	QCOMPARE(object->getTag(QStringLiteral("name")), QStringLiteral("a"));
+	QVERIFY(undo_manager.isClean());
+	QVERIFY(undo_manager.undo());
+	QVERIFY(object->getTag(QStringLiteral("name")).isEmpty());
+	QVERIFY(!undo_manager.canUndo());
+}
+
+
 void UndoManagerTest::resetAllChanged()
 {
 	loaded_changed   = false;
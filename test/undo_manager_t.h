@@ -36,6 +36,26 @@ private slots:
 	 */
 	void testUndoRedo();
 	
+	/**
+	 * Tests undo and redo of coordinate changes via ObjectCoordsUndoStep.
+	 */
+	void testObjectCoordsUndoStep();
+	
+	/**
+	 * Tests undo and redo steps which are loaded on demand.
+	 */
+	void testDeferredSteps();
+	
+	/**
+	 * Tests undo steps which are spilled to disk when exceeding the memory budget.
+	 */
+	void testSpilledSteps();
+	
+	/**
+	 * Tests the coalescing of consecutive steps of the same operation.
+	 */
+	void testCoalescedSteps();
+	
 private:
 	bool clean_changed;
 	bool clean;